@@ -21,6 +21,7 @@ MCU_EXCLUDES = \
             drivers/bus_i2c_config.c \
             drivers/bus_spi.c \
             drivers/bus_spi_config.c \
+            drivers/bus_spi_queue.c \
             drivers/bus_spi_pinconfig.c \
             drivers/dma.c \
             drivers/pwm_output.c \
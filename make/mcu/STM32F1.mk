@@ -63,6 +63,7 @@ VCP_SRC = \
 MCU_COMMON_SRC = \
             drivers/adc_stm32f10x.c \
             drivers/bus_i2c_stm32f10x.c \
+            drivers/bus_i2c_queue.c \
             drivers/bus_spi_stdperiph.c \
             drivers/dma.c \
             drivers/inverter.c \
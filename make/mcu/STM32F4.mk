@@ -171,8 +171,10 @@ DEVICE_FLAGS    += -DHSE_VALUE=$(HSE_VALUE)
 MCU_COMMON_SRC = \
             startup/system_stm32f4xx.c \
             drivers/accgyro/accgyro_mpu.c \
+            drivers/accgyro/accgyro_spi_dma.c \
             drivers/adc_stm32f4xx.c \
             drivers/bus_i2c_stm32f10x.c \
+            drivers/bus_i2c_queue.c \
             drivers/bus_spi_stdperiph.c \
             drivers/dma_stm32f4xx.c \
             drivers/dshot_bitbang.c \
@@ -159,16 +159,20 @@ VCP_SRC = \
             vcp_hal/usbd_desc.c \
             vcp_hal/usbd_conf_stm32f7xx.c \
             vcp_hal/usbd_cdc_hid.c \
+            vcp_hal/usbd_cdc_msp.c \
             vcp_hal/usbd_cdc_interface.c \
             drivers/serial_usb_vcp.c \
+            drivers/serial_usb_msp.c \
             drivers/usb_io.c
 
 MCU_COMMON_SRC = \
             startup/system_stm32f7xx.c \
             drivers/accgyro/accgyro_mpu.c \
+            drivers/accgyro/accgyro_spi_dma.c \
             drivers/adc_stm32f7xx.c \
             drivers/audio_stm32f7xx.c \
             drivers/bus_i2c_hal.c \
+            drivers/bus_i2c_queue.c \
             drivers/dma_stm32f7xx.c \
             drivers/light_ws2811strip_hal.c \
             drivers/transponder_ir_io_hal.c \
@@ -224,8 +224,10 @@ VCP_SRC = \
             vcp_hal/usbd_desc.c \
             vcp_hal/usbd_conf_stm32h7xx.c \
             vcp_hal/usbd_cdc_hid.c \
+            vcp_hal/usbd_cdc_msp.c \
             vcp_hal/usbd_cdc_interface.c \
             drivers/serial_usb_vcp.c \
+            drivers/serial_usb_msp.c \
             drivers/usb_io.c
 
 MCU_COMMON_SRC = \
@@ -241,6 +243,7 @@ MCU_COMMON_SRC = \
             drivers/light_ws2811strip_hal.c \
             drivers/adc_stm32h7xx.c \
             drivers/bus_i2c_hal.c \
+            drivers/bus_i2c_queue.c \
             drivers/pwm_output_dshot_hal.c \
             drivers/pwm_output_dshot_shared.c \
             drivers/persistent.c \
@@ -1,6 +1,10 @@
 COMMON_SRC = \
+            build/benchmark.c \
             build/build_config.c \
+            build/clock_test.c \
+            build/crash_log.c \
             build/debug.c \
+            build/trace.c \
             build/version.c \
             $(TARGET_DIR_SRC) \
             main.c \
@@ -21,15 +25,18 @@ COMMON_SRC = \
             drivers/bus_quadspi.c \
             drivers/bus_spi.c \
             drivers/bus_spi_config.c \
+            drivers/bus_spi_queue.c \
             drivers/bus_spi_pinconfig.c \
             drivers/buttons.c \
             drivers/display.c \
             drivers/dma_reqmap.c \
             drivers/exti.c \
             drivers/io.c \
+            drivers/irq_load.c \
             drivers/light_led.c \
             drivers/mco.c \
             drivers/motor.c \
+            drivers/pendsv.c \
             drivers/pinio.c \
             drivers/pin_pull_up_down.c \
             drivers/resource.c \
@@ -69,6 +76,7 @@ COMMON_SRC = \
             sensors/adcinternal.c \
             sensors/battery.c \
             sensors/current.c \
+            sensors/sample_bus.c \
             sensors/voltage.c \
             target/config_helper.c \
             fc/init.c \
@@ -85,8 +93,11 @@ COMMON_SRC = \
             fc/rc.c \
             fc/rc_adjustments.c \
             fc/rc_controls.c \
+            fc/loop_timing.c \
+            fc/rc_latency.c \
             fc/rc_modes.c \
             flight/position.c \
+            flight/altitude_kf.c \
             flight/failsafe.c \
             flight/gps_rescue.c \
             flight/gyroanalyse.c \
@@ -162,6 +173,7 @@ COMMON_SRC = \
             io/pidaudio.c \
             osd/osd.c \
             osd/osd_elements.c \
+            osd/osd_warnings.c \
             sensors/barometer.c \
             sensors/rangefinder.c \
             telemetry/telemetry.c \
@@ -209,6 +221,7 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             common/encoding.c \
             common/filter.c \
             common/maths.c \
+            common/sdft.c \
             common/typeconversion.c \
             drivers/accgyro/accgyro_fake.c \
             drivers/accgyro/accgyro_mpu.c \
@@ -216,6 +229,7 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             drivers/accgyro/accgyro_mpu6050.c \
             drivers/accgyro/accgyro_mpu6500.c \
             drivers/accgyro/accgyro_spi_bmi160.c \
+            drivers/accgyro/accgyro_spi_dma.c \
             drivers/accgyro/accgyro_spi_icm20689.c \
             drivers/accgyro/accgyro_spi_mpu6000.c \
             drivers/accgyro/accgyro_spi_mpu6500.c \
@@ -231,8 +245,11 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             drivers/bus.c \
             drivers/bus_quadspi.c \
             drivers/bus_spi.c \
+            drivers/bus_spi_queue.c \
             drivers/exti.c \
+            build/trace.c \
             drivers/io.c \
+            drivers/irq_load.c \
             drivers/pwm_output.c \
             drivers/rcc.c \
             drivers/serial.c \
@@ -243,6 +260,8 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             fc/tasks.c \
             fc/rc.c \
             fc/rc_controls.c \
+            fc/loop_timing.c \
+            fc/rc_latency.c \
             fc/runtime_config.c \
             flight/gyroanalyse.c \
             flight/imu.c \
@@ -264,6 +283,7 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             sensors/acceleration.c \
             sensors/boardalignment.c \
             sensors/gyro.c \
+            sensors/sample_bus.c \
             $(CMSIS_SRC) \
             $(DEVICE_STDPERIPH_SRC) \
 
@@ -338,12 +358,14 @@ SIZE_OPTIMISED_SRC := $(SIZE_OPTIMISED_SRC) \
             io/spektrum_vtx_control.c \
             osd/osd.c \
             osd/osd_elements.c \
+            osd/osd_warnings.c \
             pg/pg.h
 
 # F4 and F7 optimizations
 ifneq ($(TARGET),$(filter $(TARGET),$(F3_TARGETS)))
 SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             drivers/bus_i2c_hal.c \
+            drivers/bus_i2c_queue.c \
             drivers/bus_spi_ll.c \
             drivers/max7456.c \
             drivers/pwm_output_dshot.c \
@@ -38,6 +38,7 @@
 
 #include "common/axis.h"
 #include "common/encoding.h"
+#include "common/huffman.h"
 #include "common/maths.h"
 #include "common/time.h"
 #include "common/utils.h"
@@ -54,6 +55,7 @@
 
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
+#include "fc/loop_timing.h"
 #include "fc/rc.h"
 #include "fc/rc_controls.h"
 #include "fc/rc_modes.h"
@@ -75,6 +77,7 @@
 #include "sensors/barometer.h"
 #include "sensors/battery.h"
 #include "sensors/compass.h"
+#include "sensors/esc_sensor.h"
 #include "sensors/gyro.h"
 #include "sensors/rangefinder.h"
 
@@ -86,13 +89,17 @@
 #define DEFAULT_BLACKBOX_DEVICE     BLACKBOX_DEVICE_SERIAL
 #endif
 
-PG_REGISTER_WITH_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 1);
+PG_REGISTER_WITH_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 5);
 
 PG_RESET_TEMPLATE(blackboxConfig_t, blackboxConfig,
     .p_ratio = 32,
     .device = DEFAULT_BLACKBOX_DEVICE,
     .record_acc = 1,
-    .mode = BLACKBOX_MODE_NORMAL
+    .mode = BLACKBOX_MODE_NORMAL,
+    .packed_encoding = 0,
+    .compression = BLACKBOX_COMPRESSION_NONE,
+    .fields_disabled_mask = 0,
+    .adaptive_rate = 0
 );
 
 #define BLACKBOX_SHUTDOWN_TIMEOUT_MILLIS 200
@@ -161,6 +168,7 @@ typedef struct blackboxDeltaFieldDefinition_s {
     uint8_t Ppredict;
     uint8_t Pencode;
     uint8_t condition; // Decide whether this field should appear in the log
+    bool Ppacked; // With packed_encoding the P-frame encoding is BITPACK_8S32 instead of Pencode
 } blackboxDeltaFieldDefinition_t;
 
 /**
@@ -174,30 +182,30 @@ static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     {"loopIteration",-1, UNSIGNED, .Ipredict = PREDICT(0),     .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(INC),           .Pencode = FLIGHT_LOG_FIELD_ENCODING_NULL, CONDITION(ALWAYS)},
     /* Time advances pretty steadily so the P-frame prediction is a straight line */
     {"time",       -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(STRAIGHT_LINE), .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisP",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisP",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisP",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
+    {"axisP",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(PID), .Ppacked = true},
+    {"axisP",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(PID), .Ppacked = true},
+    {"axisP",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(PID), .Ppacked = true},
     /* I terms get special packed encoding in P frames: */
-    {"axisI",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS)},
-    {"axisI",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS)},
-    {"axisI",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(ALWAYS)},
-    {"axisD",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_0)},
-    {"axisD",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_1)},
-    {"axisD",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_2)},
-    {"axisF",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisF",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"axisF",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
+    {"axisI",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(PID)},
+    {"axisI",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(PID)},
+    {"axisI",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG2_3S32), CONDITION(PID)},
+    {"axisD",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_0), .Ppacked = true},
+    {"axisD",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_1), .Ppacked = true},
+    {"axisD",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(NONZERO_PID_D_2), .Ppacked = true},
+    {"axisF",       0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(PID), .Ppacked = true},
+    {"axisF",       1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(PID), .Ppacked = true},
+    {"axisF",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(PID), .Ppacked = true},
     /* rcCommands are encoded together as a group in P-frames: */
-    {"rcCommand",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
-    {"rcCommand",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
-    {"rcCommand",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
-    {"rcCommand",   3, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
+    {"rcCommand",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(RC_COMMANDS)},
+    {"rcCommand",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(RC_COMMANDS)},
+    {"rcCommand",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(RC_COMMANDS)},
+    {"rcCommand",   3, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(RC_COMMANDS)},
 
     // setpoint - define 4 fields like rcCommand to use the same encoding. setpoint[4] contains the mixer throttle
-    {"setpoint",    0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
-    {"setpoint",    1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
-    {"setpoint",    2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
-    {"setpoint",    3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(ALWAYS)},
+    {"setpoint",    0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(SETPOINT)},
+    {"setpoint",    1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(SETPOINT)},
+    {"setpoint",    2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(SETPOINT)},
+    {"setpoint",    3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_4S16), CONDITION(SETPOINT)},
 
     {"vbatLatest",    -1, UNSIGNED, .Ipredict = PREDICT(VBATREF),  .Iencode = ENCODING(NEG_14BIT),   .Ppredict = PREDICT(PREVIOUS),  .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_VBAT},
     {"amperageLatest",-1, SIGNED,   .Ipredict = PREDICT(0),        .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),  .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_AMPERAGE_ADC},
@@ -216,9 +224,9 @@ static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     {"rssi",       -1, UNSIGNED, .Ipredict = PREDICT(0),       .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(TAG8_8SVB), FLIGHT_LOG_FIELD_CONDITION_RSSI},
 
     /* Gyros and accelerometers base their P-predictions on the average of the previous 2 frames to reduce noise impact */
-    {"gyroADC",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"gyroADC",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
-    {"gyroADC",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(ALWAYS)},
+    {"gyroADC",     0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(GYRO), .Ppacked = true},
+    {"gyroADC",     1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(GYRO), .Ppacked = true},
+    {"gyroADC",     2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(GYRO), .Ppacked = true},
     {"accSmooth",   0, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC},
     {"accSmooth",   1, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC},
     {"accSmooth",   2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_ACC},
@@ -227,15 +235,15 @@ static const blackboxDeltaFieldDefinition_t blackboxMainFields[] = {
     {"debug",       2, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
     {"debug",       3, SIGNED,   .Ipredict = PREDICT(0),       .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), FLIGHT_LOG_FIELD_CONDITION_DEBUG},
     /* Motors only rarely drops under minthrottle (when stick falls below mincommand), so predict minthrottle for it and use *unsigned* encoding (which is large for negative numbers but more compact for positive ones): */
-    {"motor",       0, UNSIGNED, .Ipredict = PREDICT(MINMOTOR), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(AVERAGE_2), .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_1)},
+    {"motor",       0, UNSIGNED, .Ipredict = PREDICT(MINMOTOR), .Iencode = ENCODING(UNSIGNED_VB), .Ppredict = PREDICT(AVERAGE_2), .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_1), .Ppacked = true},
     /* Subsequent motors base their I-frame values on the first one, P-frame values on the average of last two frames: */
-    {"motor",       1, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_2)},
-    {"motor",       2, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_3)},
-    {"motor",       3, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_4)},
-    {"motor",       4, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_5)},
-    {"motor",       5, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_6)},
-    {"motor",       6, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_7)},
-    {"motor",       7, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_8)},
+    {"motor",       1, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_2), .Ppacked = true},
+    {"motor",       2, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_3), .Ppacked = true},
+    {"motor",       3, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_4), .Ppacked = true},
+    {"motor",       4, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_5), .Ppacked = true},
+    {"motor",       5, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_6), .Ppacked = true},
+    {"motor",       6, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_7), .Ppacked = true},
+    {"motor",       7, UNSIGNED, .Ipredict = PREDICT(MOTOR_0), .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(AVERAGE_2),     .Pencode = ENCODING(SIGNED_VB), CONDITION(AT_LEAST_MOTORS_8), .Ppacked = true},
 
     /* Tricopter tail servo */
     {"servo",       5, UNSIGNED, .Ipredict = PREDICT(1500),    .Iencode = ENCODING(SIGNED_VB),   .Ppredict = PREDICT(PREVIOUS),      .Pencode = ENCODING(SIGNED_VB), CONDITION(TRICOPTER)}
@@ -267,7 +275,30 @@ static const blackboxSimpleFieldDefinition_t blackboxSlowFields[] = {
 
     {"failsafePhase",         -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)},
     {"rxSignalReceived",      -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)},
-    {"rxFlightChannelsValid", -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)}
+    {"rxFlightChannelsValid", -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)},
+    {"droppedFrames",         -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+#ifdef USE_LOOP_TIMING
+    // min, avg, max and 99th percentile over the last second, in the order of loopTimingMetric_e
+    {"loopJitterUs",           0, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"loopJitterUs",           1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"loopJitterUs",           2, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"loopJitterUs",           3, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"gyroToPidUs",            0, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"gyroToPidUs",            1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"gyroToPidUs",            2, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"gyroToPidUs",            3, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"pidToMotorUs",           0, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"pidToMotorUs",           1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"pidToMotorUs",           2, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"pidToMotorUs",           3, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+#endif
+#ifdef USE_ESC_SENSOR
+    // missed ESC sensor polls since the last good frame of each motor, 255 when there is no data
+    {"escDataAge",             0, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"escDataAge",             1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"escDataAge",             2, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+    {"escDataAge",             3, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
+#endif
 };
 
 typedef enum BlackboxState {
@@ -324,8 +355,11 @@ typedef struct blackboxGpsState_s {
     int32_t GPS_home[2];
     int32_t GPS_coord[2];
     uint8_t GPS_numSat;
+    uint32_t homeIteration;
 } blackboxGpsState_t;
 
+#define BLACKBOX_ESC_DATA_AGE_COUNT 4
+
 // This data is updated really infrequently:
 typedef struct blackboxSlowState_s {
     uint32_t flightModeFlags; // extend this data size (from uint16_t)
@@ -333,6 +367,13 @@ typedef struct blackboxSlowState_s {
     uint8_t failsafePhase;
     bool rxSignalReceived;
     bool rxFlightChannelsValid;
+    uint32_t droppedFrames;
+#ifdef USE_LOOP_TIMING
+    loopTimingStats_t loopTiming[LOOP_TIMING_COUNT];
+#endif
+#ifdef USE_ESC_SENSOR
+    uint8_t escDataAge[BLACKBOX_ESC_DATA_AGE_COUNT];
+#endif
 } __attribute__((__packed__)) blackboxSlowState_t; // We pack this struct so that padding doesn't interfere with memcmp()
 
 //From rc_controls.c
@@ -355,6 +396,14 @@ static struct {
     } u;
 } xmitState;
 
+#ifdef USE_BLACKBOX_HEADER_CACHE
+// The complete header is rendered here when a log is started and then written as fast as the device takes it,
+// instead of line by line over hundreds of iterations during which no frames could be logged
+#define BLACKBOX_HEADER_CACHE_SIZE 8192
+static uint8_t blackboxHeaderCache[BLACKBOX_HEADER_CACHE_SIZE];
+static int blackboxHeaderCacheLength; // zero when the header didn't fit and is sent line by line
+#endif
+
 // Cache for FLIGHT_LOG_FIELD_CONDITION_* test results:
 static uint32_t blackboxConditionCache;
 
@@ -370,6 +419,11 @@ STATIC_UNIT_TESTED int16_t blackboxIInterval = 0;
 // number of flight loop iterations before logging P-frame
 STATIC_UNIT_TESTED int16_t blackboxPInterval = 0;
 STATIC_UNIT_TESTED int32_t blackboxSInterval = 0;
+// with blackbox_adaptive_rate, P-frames are logged every blackboxPInterval << blackboxPRateShift iterations
+STATIC_UNIT_TESTED uint8_t blackboxPRateShift;
+// set by blackboxUpdatePRate(), the PID loop takes it up at the next I-frame
+STATIC_UNIT_TESTED volatile uint8_t blackboxPRateShiftRequested;
+static uint8_t blackboxPRateShiftMax;
 STATIC_UNIT_TESTED int32_t blackboxSlowFrameIterationTimer;
 static bool blackboxLoggedAnyFrames;
 
@@ -389,6 +443,69 @@ static blackboxMainState_t blackboxHistoryRing[3];
 // These point into blackboxHistoryRing, use them to know where to store history of a given age (0, 1 or 2 generations old)
 static blackboxMainState_t* blackboxHistory[3];
 
+#ifdef USE_HUFFMAN
+/*
+ * A compressed P-frame is the 'P' marker, the byte count of the uncompressed body as an unsigned VB, then the body
+ * coded with huffmanTable MSB first and padded with zero bits to a byte. The decoder decodes that many bytes of
+ * codes and parses them as the regular P-frame body.
+ *
+ * No field takes more than 5 bytes in any encoding, plus a tag byte for the group of optional fields, which is
+ * covered by the loop iteration field that P-frames don't write.
+ */
+#define BLACKBOX_FRAME_BUFFER_SIZE (ARRAYLEN(blackboxMainFields) * 5)
+
+static uint8_t blackboxFrameBuffer[BLACKBOX_FRAME_BUFFER_SIZE];
+static uint8_t blackboxCompressedFrameBuffer[(BLACKBOX_FRAME_BUFFER_SIZE * HUFFMAN_MAX_CODE_LEN + 7) / 8];
+#endif
+
+/*
+ * The PID loop only snapshots the main state of the iterations that log a main frame into this ring, the frames are
+ * encoded and written to the device by blackboxUpdate() in its own lower priority task. The PID loop is the only writer
+ * of blackboxSnapshotHead and the blackbox task the only writer of blackboxSnapshotTail, so the ring needs no locking
+ * even when the PID loop runs from an interrupt.
+ */
+#define BLACKBOX_SNAPSHOT_RING_SIZE 16 // must be a power of 2
+
+// Keeps the compiler from moving the snapshot accesses across the updates of the ring indices
+#define BLACKBOX_SNAPSHOT_BARRIER() __asm__ volatile ("" : : : "memory")
+
+typedef struct blackboxSnapshot_s {
+    blackboxMainState_t state;
+    uint32_t iteration;
+    bool intraframe;
+    uint8_t pRateShift;
+} blackboxSnapshot_t;
+
+static blackboxSnapshot_t blackboxSnapshotRing[BLACKBOX_SNAPSHOT_RING_SIZE];
+static volatile uint8_t blackboxSnapshotHead;
+static volatile uint8_t blackboxSnapshotTail;
+
+// Main frames that were due but found the ring full, logged in the slow frames
+STATIC_UNIT_TESTED uint32_t blackboxDroppedFrames;
+// Set after a dropped frame, the next snapshot is logged as an I-frame so the decoder does not lose sync
+STATIC_UNIT_TESTED bool blackboxSnapshotResync;
+
+// Size of the largest I and P-frame written so far, the device must have that much room before we encode the next one
+static uint16_t blackboxFrameSizeMax[2];
+
+/*
+ * blackboxUpdatePRate() lowers the P-frame rate once per BLACKBOX_P_RATE_LOWER_UPDATES calls while the device is
+ * behind, which gives the last change an I-frame interval to take effect. It raises the rate again once the device
+ * has kept up for BLACKBOX_P_RATE_RAISE_UPDATES calls.
+ */
+#define BLACKBOX_P_RATE_SHIFT_MAX       4                                   // down to 1/16 of the configured rate
+#define BLACKBOX_P_RATE_LOWER_UPDATES   (100000 / BLACKBOX_UPDATE_INTERVAL_US)
+#define BLACKBOX_P_RATE_RAISE_UPDATES   (2000000 / BLACKBOX_UPDATE_INTERVAL_US)
+
+static uint32_t blackboxPRateDroppedFrames;
+static uint16_t blackboxPRateUpdatesSinceChange;
+static uint16_t blackboxPRateUpdatesSinceBehind;
+// the P-frame rate shift of the last encoded snapshot
+static uint8_t blackboxLoggedPRateShift;
+
+static bool blackboxFinishPending;
+static bool blackboxResumePending;
+
 static bool blackboxModeActivationConditionPresent = false;
 
 /**
@@ -404,12 +521,29 @@ static bool blackboxIsOnlyLoggingIntraframes(void)
     return blackboxConfig()->p_ratio == 0;
 }
 
+static bool isFieldEnabled(FlightLogFieldSelect_e field)
+{
+    return (blackboxConfig()->fields_disabled_mask & (1 << field)) == 0;
+}
+
 static bool testBlackboxConditionUncached(FlightLogFieldCondition condition)
 {
     switch (condition) {
     case FLIGHT_LOG_FIELD_CONDITION_ALWAYS:
         return true;
 
+    case FLIGHT_LOG_FIELD_CONDITION_PID:
+        return isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_PID);
+
+    case FLIGHT_LOG_FIELD_CONDITION_RC_COMMANDS:
+        return isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_RC_COMMANDS);
+
+    case FLIGHT_LOG_FIELD_CONDITION_SETPOINT:
+        return isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_SETPOINT);
+
+    case FLIGHT_LOG_FIELD_CONDITION_GYRO:
+        return isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_GYRO);
+
     case FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_1:
     case FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_2:
     case FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_3:
@@ -418,7 +552,8 @@ static bool testBlackboxConditionUncached(FlightLogFieldCondition condition)
     case FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_6:
     case FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_7:
     case FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_8:
-        return getMotorCount() >= condition - FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_1 + 1;
+        return getMotorCount() >= condition - FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_1 + 1
+            && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_MOTOR);
 
     case FLIGHT_LOG_FIELD_CONDITION_TRICOPTER:
         return mixerConfig()->mixerMode == MIXER_TRI || mixerConfig()->mixerMode == MIXER_CUSTOM_TRI;
@@ -426,46 +561,48 @@ static bool testBlackboxConditionUncached(FlightLogFieldCondition condition)
     case FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0:
     case FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_1:
     case FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_2:
-        return currentPidProfile->pid[condition - FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0].D != 0;
+        return currentPidProfile->pid[condition - FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0].D != 0
+            && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_PID);
 
     case FLIGHT_LOG_FIELD_CONDITION_MAG:
 #ifdef USE_MAG
-        return sensors(SENSOR_MAG);
+        return sensors(SENSOR_MAG) && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_MAG);
 #else
         return false;
 #endif
 
     case FLIGHT_LOG_FIELD_CONDITION_BARO:
 #ifdef USE_BARO
-        return sensors(SENSOR_BARO);
+        return sensors(SENSOR_BARO) && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_ALTITUDE);
 #else
         return false;
 #endif
 
     case FLIGHT_LOG_FIELD_CONDITION_VBAT:
-        return batteryConfig()->voltageMeterSource != VOLTAGE_METER_NONE;
+        return batteryConfig()->voltageMeterSource != VOLTAGE_METER_NONE && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_BATTERY);
 
     case FLIGHT_LOG_FIELD_CONDITION_AMPERAGE_ADC:
-        return (batteryConfig()->currentMeterSource != CURRENT_METER_NONE) && (batteryConfig()->currentMeterSource != CURRENT_METER_VIRTUAL);
+        return (batteryConfig()->currentMeterSource != CURRENT_METER_NONE) && (batteryConfig()->currentMeterSource != CURRENT_METER_VIRTUAL)
+            && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_BATTERY);
 
     case FLIGHT_LOG_FIELD_CONDITION_RANGEFINDER:
 #ifdef USE_RANGEFINDER
-        return sensors(SENSOR_RANGEFINDER);
+        return sensors(SENSOR_RANGEFINDER) && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_ALTITUDE);
 #else
         return false;
 #endif
 
     case FLIGHT_LOG_FIELD_CONDITION_RSSI:
-        return isRssiConfigured();
+        return isRssiConfigured() && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_RSSI);
 
     case FLIGHT_LOG_FIELD_CONDITION_NOT_LOGGING_EVERY_FRAME:
         return blackboxConfig()->p_ratio != 1;
 
     case FLIGHT_LOG_FIELD_CONDITION_ACC:
-        return sensors(SENSOR_ACC) && blackboxConfig()->record_acc;
+        return sensors(SENSOR_ACC) && blackboxConfig()->record_acc && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_ACC);
 
     case FLIGHT_LOG_FIELD_CONDITION_DEBUG:
-        return debugMode != DEBUG_NONE;
+        return debugMode != DEBUG_NONE && isFieldEnabled(FLIGHT_LOG_FIELD_SELECT_DEBUG_LOG);
 
     case FLIGHT_LOG_FIELD_CONDITION_NEVER:
         return false;
@@ -524,38 +661,44 @@ static void blackboxSetState(BlackboxState newState)
     blackboxState = newState;
 }
 
-static void writeIntraframe(void)
+static void writeIntraframe(uint32_t iteration)
 {
     blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
 
     blackboxWrite('I');
 
-    blackboxWriteUnsignedVB(blackboxIteration);
+    blackboxWriteUnsignedVB(iteration);
     blackboxWriteUnsignedVB(blackboxCurrent->time);
 
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_P, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_I, XYZ_AXIS_COUNT);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_PID)) {
+        blackboxWriteSignedVBArray(blackboxCurrent->axisPID_P, XYZ_AXIS_COUNT);
+        blackboxWriteSignedVBArray(blackboxCurrent->axisPID_I, XYZ_AXIS_COUNT);
 
-    // Don't bother writing the current D term if the corresponding PID setting is zero
-    for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-        if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + x)) {
-            blackboxWriteSignedVB(blackboxCurrent->axisPID_D[x]);
+        // Don't bother writing the current D term if the corresponding PID setting is zero
+        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
+            if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + x)) {
+                blackboxWriteSignedVB(blackboxCurrent->axisPID_D[x]);
+            }
         }
-    }
 
-    blackboxWriteSignedVBArray(blackboxCurrent->axisPID_F, XYZ_AXIS_COUNT);
+        blackboxWriteSignedVBArray(blackboxCurrent->axisPID_F, XYZ_AXIS_COUNT);
+    }
 
-    // Write roll, pitch and yaw first:
-    blackboxWriteSigned16VBArray(blackboxCurrent->rcCommand, 3);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_COMMANDS)) {
+        // Write roll, pitch and yaw first:
+        blackboxWriteSigned16VBArray(blackboxCurrent->rcCommand, 3);
 
-    /*
-     * Write the throttle separately from the rest of the RC data as it's unsigned.
-     * Throttle lies in range [PWM_RANGE_MIN..PWM_RANGE_MAX]:
-     */
-    blackboxWriteUnsignedVB(blackboxCurrent->rcCommand[THROTTLE]);
+        /*
+         * Write the throttle separately from the rest of the RC data as it's unsigned.
+         * Throttle lies in range [PWM_RANGE_MIN..PWM_RANGE_MAX]:
+         */
+        blackboxWriteUnsignedVB(blackboxCurrent->rcCommand[THROTTLE]);
+    }
 
-    // Write setpoint roll, pitch, yaw, and throttle
-    blackboxWriteSigned16VBArray(blackboxCurrent->setpoint, 4);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SETPOINT)) {
+        // Write setpoint roll, pitch, yaw, and throttle
+        blackboxWriteSigned16VBArray(blackboxCurrent->setpoint, 4);
+    }
 
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_VBAT)) {
         /*
@@ -594,7 +737,9 @@ static void writeIntraframe(void)
         blackboxWriteUnsignedVB(blackboxCurrent->rssi);
     }
 
-    blackboxWriteSigned16VBArray(blackboxCurrent->gyroADC, XYZ_AXIS_COUNT);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO)) {
+        blackboxWriteSigned16VBArray(blackboxCurrent->gyroADC, XYZ_AXIS_COUNT);
+    }
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ACC)) {
         blackboxWriteSigned16VBArray(blackboxCurrent->accADC, XYZ_AXIS_COUNT);
     }
@@ -603,13 +748,15 @@ static void writeIntraframe(void)
         blackboxWriteSigned16VBArray(blackboxCurrent->debug, DEBUG16_VALUE_COUNT);
     }
 
-    //Motors can be below minimum output when disarmed, but that doesn't happen much
-    blackboxWriteUnsignedVB(blackboxCurrent->motor[0] - motorOutputLow);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_1)) {
+        //Motors can be below minimum output when disarmed, but that doesn't happen much
+        blackboxWriteUnsignedVB(blackboxCurrent->motor[0] - motorOutputLow);
 
-    //Motors tend to be similar to each other so use the first motor's value as a predictor of the others
-    const int motorCount = getMotorCount();
-    for (int x = 1; x < motorCount; x++) {
-        blackboxWriteSignedVB(blackboxCurrent->motor[x] - blackboxCurrent->motor[0]);
+        //Motors tend to be similar to each other so use the first motor's value as a predictor of the others
+        const int motorCount = getMotorCount();
+        for (int x = 1; x < motorCount; x++) {
+            blackboxWriteSignedVB(blackboxCurrent->motor[x] - blackboxCurrent->motor[0]);
+        }
     }
 
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_TRICOPTER)) {
@@ -629,17 +776,26 @@ static void writeIntraframe(void)
     blackboxLoggedAnyFrames = true;
 }
 
-static void blackboxWriteMainStateArrayUsingAveragePredictor(int arrOffsetInHistory, int count)
+STATIC_ASSERT(DEBUG16_VALUE_COUNT <= MAX_SUPPORTED_MOTORS, average_predictor_deltas_too_small);
+
+static void blackboxWriteMainStateArrayUsingAveragePredictor(int arrOffsetInHistory, int count, bool packed)
 {
     int16_t *curr  = (int16_t*) ((char*) (blackboxHistory[0]) + arrOffsetInHistory);
     int16_t *prev1 = (int16_t*) ((char*) (blackboxHistory[1]) + arrOffsetInHistory);
     int16_t *prev2 = (int16_t*) ((char*) (blackboxHistory[2]) + arrOffsetInHistory);
+    int32_t deltas[MAX_SUPPORTED_MOTORS];
 
     for (int i = 0; i < count; i++) {
         // Predictor is the average of the previous two history states
         int32_t predictor = (prev1[i] + prev2[i]) / 2;
 
-        blackboxWriteSignedVB(curr[i] - predictor);
+        deltas[i] = curr[i] - predictor;
+    }
+
+    if (packed) {
+        blackboxWriteBitpackS32Array(deltas, count);
+    } else {
+        blackboxWriteSignedVBArray(deltas, count);
     }
 }
 
@@ -650,6 +806,13 @@ static void writeInterframe(void)
 
     blackboxWrite('P');
 
+#ifdef USE_HUFFMAN
+    const bool compressed = blackboxConfig()->compression == BLACKBOX_COMPRESSION_HUFFMAN;
+    if (compressed) {
+        blackboxBeginCapture(blackboxFrameBuffer, sizeof(blackboxFrameBuffer));
+    }
+#endif
+
     //No need to store iteration count since its delta is always 1
 
     /*
@@ -660,41 +823,63 @@ static void writeInterframe(void)
 
     int32_t deltas[8];
     int32_t setpointDeltas[4];
-    
-    arraySubInt32(deltas, blackboxCurrent->axisPID_P, blackboxLast->axisPID_P, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
 
-    /*
-     * The PID I field changes very slowly, most of the time +-2, so use an encoding
-     * that can pack all three fields into one byte in that situation.
-     */
-    arraySubInt32(deltas, blackboxCurrent->axisPID_I, blackboxLast->axisPID_I, XYZ_AXIS_COUNT);
-    blackboxWriteTag2_3S32(deltas);
+    // Packed encoding writes each run of BITPACK_8S32 fields in the header as one bit width block
+    const bool packed = blackboxConfig()->packed_encoding;
 
-    /*
-     * The PID D term is frequently set to zero for yaw, which makes the result from the calculation
-     * always zero. So don't bother recording D results when PID D terms are zero.
-     */
-    for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
-        if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + x)) {
-            blackboxWriteSignedVB(blackboxCurrent->axisPID_D[x] - blackboxLast->axisPID_D[x]);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_PID)) {
+        arraySubInt32(deltas, blackboxCurrent->axisPID_P, blackboxLast->axisPID_P, XYZ_AXIS_COUNT);
+        if (packed) {
+            blackboxWriteBitpackS32Array(deltas, XYZ_AXIS_COUNT);
+        } else {
+            blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
+        }
+
+        /*
+         * The PID I field changes very slowly, most of the time +-2, so use an encoding
+         * that can pack all three fields into one byte in that situation.
+         */
+        arraySubInt32(deltas, blackboxCurrent->axisPID_I, blackboxLast->axisPID_I, XYZ_AXIS_COUNT);
+        blackboxWriteTag2_3S32(deltas);
+
+        /*
+         * The PID D term is frequently set to zero for yaw, which makes the result from the calculation
+         * always zero. So don't bother recording D results when PID D terms are zero.
+         */
+        int pidDeltaCount = 0;
+        for (int x = 0; x < XYZ_AXIS_COUNT; x++) {
+            if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + x)) {
+                deltas[pidDeltaCount++] = blackboxCurrent->axisPID_D[x] - blackboxLast->axisPID_D[x];
+            }
         }
-    }
 
-    arraySubInt32(deltas, blackboxCurrent->axisPID_F, blackboxLast->axisPID_F, XYZ_AXIS_COUNT);
-    blackboxWriteSignedVBArray(deltas, XYZ_AXIS_COUNT);
+        // The D and F fields follow each other, so they form a single packed block
+        arraySubInt32(deltas + pidDeltaCount, blackboxCurrent->axisPID_F, blackboxLast->axisPID_F, XYZ_AXIS_COUNT);
+        pidDeltaCount += XYZ_AXIS_COUNT;
+        if (packed) {
+            blackboxWriteBitpackS32Array(deltas, pidDeltaCount);
+        } else {
+            blackboxWriteSignedVBArray(deltas, pidDeltaCount);
+        }
+    }
 
     /*
      * RC tends to stay the same or fairly small for many frames at a time, so use an encoding that
      * can pack multiple values per byte:
      */
-    for (int x = 0; x < 4; x++) {
-        deltas[x] = blackboxCurrent->rcCommand[x] - blackboxLast->rcCommand[x];
-        setpointDeltas[x] = blackboxCurrent->setpoint[x] - blackboxLast->setpoint[x];
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_COMMANDS)) {
+        for (int x = 0; x < 4; x++) {
+            deltas[x] = blackboxCurrent->rcCommand[x] - blackboxLast->rcCommand[x];
+        }
+        blackboxWriteTag8_4S16(deltas);
     }
 
-    blackboxWriteTag8_4S16(deltas);
-    blackboxWriteTag8_4S16(setpointDeltas);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SETPOINT)) {
+        for (int x = 0; x < 4; x++) {
+            setpointDeltas[x] = blackboxCurrent->setpoint[x] - blackboxLast->setpoint[x];
+        }
+        blackboxWriteTag8_4S16(setpointDeltas);
+    }
 
     //Check for sensors that are updated periodically (so deltas are normally zero)
     int optionalFieldCount = 0;
@@ -734,19 +919,34 @@ static void writeInterframe(void)
     blackboxWriteTag8_8SVB(deltas, optionalFieldCount);
 
     //Since gyros, accs and motors are noisy, base their predictions on the average of the history:
-    blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, gyroADC),   XYZ_AXIS_COUNT);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO)) {
+        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, gyroADC), XYZ_AXIS_COUNT, packed);
+    }
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ACC)) {
-        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, accADC), XYZ_AXIS_COUNT);
+        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, accADC), XYZ_AXIS_COUNT, false);
     }
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_DEBUG)) {
-        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, debug), DEBUG16_VALUE_COUNT);
+        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, debug), DEBUG16_VALUE_COUNT, false);
+    }
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_1)) {
+        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, motor), getMotorCount(), packed);
     }
-    blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, motor),     getMotorCount());
 
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_TRICOPTER)) {
         blackboxWriteSignedVB(blackboxCurrent->servo[5] - blackboxLast->servo[5]);
     }
 
+#ifdef USE_HUFFMAN
+    if (compressed) {
+        const int frameLength = blackboxEndCapture();
+        const int compressedLength = huffmanEncodeBuf(blackboxCompressedFrameBuffer, sizeof(blackboxCompressedFrameBuffer),
+            blackboxFrameBuffer, frameLength, huffmanTable);
+
+        blackboxWriteUnsignedVB(frameLength);
+        blackboxWriteBuf(blackboxCompressedFrameBuffer, compressedLength);
+    }
+#endif
+
     //Rotate our history buffers
     blackboxHistory[2] = blackboxHistory[1];
     blackboxHistory[1] = blackboxHistory[0];
@@ -774,6 +974,22 @@ static void writeSlowFrame(void)
     values[2] = slowHistory.rxFlightChannelsValid ? 1 : 0;
     blackboxWriteTag2_3S32(values);
 
+    blackboxWriteUnsignedVB(slowHistory.droppedFrames);
+
+#ifdef USE_LOOP_TIMING
+    for (int i = 0; i < LOOP_TIMING_COUNT; i++) {
+        blackboxWriteUnsignedVB(slowHistory.loopTiming[i].minUs);
+        blackboxWriteUnsignedVB(slowHistory.loopTiming[i].avgUs);
+        blackboxWriteUnsignedVB(slowHistory.loopTiming[i].maxUs);
+        blackboxWriteUnsignedVB(slowHistory.loopTiming[i].p99Us);
+    }
+#endif
+#ifdef USE_ESC_SENSOR
+    for (int i = 0; i < BLACKBOX_ESC_DATA_AGE_COUNT; i++) {
+        blackboxWriteUnsignedVB(slowHistory.escDataAge[i]);
+    }
+#endif
+
     blackboxSlowFrameIterationTimer = 0;
 }
 
@@ -787,6 +1003,19 @@ static void loadSlowState(blackboxSlowState_t *slow)
     slow->failsafePhase = failsafePhase();
     slow->rxSignalReceived = rxIsReceivingSignal();
     slow->rxFlightChannelsValid = rxAreFlightChannelsValid();
+    slow->droppedFrames = blackboxDroppedFrames;
+#ifdef USE_LOOP_TIMING
+    // the stats change once a second, which writes a slow frame with them
+    for (int i = 0; i < LOOP_TIMING_COUNT; i++) {
+        slow->loopTiming[i] = *loopTimingGetStats(i);
+    }
+#endif
+#ifdef USE_ESC_SENSOR
+    for (int i = 0; i < BLACKBOX_ESC_DATA_AGE_COUNT; i++) {
+        const escSensorData_t *escData = getEscSensorData(i);
+        slow->escDataAge[i] = escData ? escData->dataAge : ESC_DATA_INVALID;
+    }
+#endif
 }
 
 /**
@@ -849,6 +1078,22 @@ static void blackboxResetIterationTimers(void)
     blackboxSlowFrameIterationTimer = 0;
 }
 
+static void blackboxResetSnapshots(void)
+{
+    blackboxSnapshotHead = 0;
+    blackboxSnapshotTail = 0;
+    blackboxSnapshotResync = false;
+    blackboxDroppedFrames = 0;
+
+    blackboxPRateShift = 0;
+    blackboxPRateShiftRequested = 0;
+    blackboxLoggedPRateShift = 0;
+    blackboxPRateDroppedFrames = 0;
+    // a device that is behind from the start lowers the rate straight away
+    blackboxPRateUpdatesSinceChange = UINT16_MAX;
+    blackboxPRateUpdatesSinceBehind = 0;
+}
+
 /**
  * Start Blackbox logging if it is not already running. Intended to be called upon arming.
  */
@@ -881,6 +1126,9 @@ static void blackboxStart(void)
     blackboxModeActivationConditionPresent = isModeActivationConditionPresent(BOXBLACKBOX);
 
     blackboxResetIterationTimers();
+    blackboxResetSnapshots();
+    blackboxFrameSizeMax[0] = 0;
+    blackboxFrameSizeMax[1] = 0;
 
     /*
      * Record the beeper's current idea of the last arming beep time, so that we can detect it changing when
@@ -892,10 +1140,9 @@ static void blackboxStart(void)
     blackboxSetState(BLACKBOX_STATE_PREPARE_LOG_FILE);
 }
 
-/**
- * Begin Blackbox shutdown.
- */
-void blackboxFinish(void)
+static bool blackboxEncodeSnapshots(bool waitForBufferSpace);
+
+static void blackboxShutdown(void)
 {
     switch (blackboxState) {
     case BLACKBOX_STATE_DISABLED:
@@ -905,6 +1152,8 @@ void blackboxFinish(void)
         break;
     case BLACKBOX_STATE_RUNNING:
     case BLACKBOX_STATE_PAUSED:
+        // Write out the frames still waiting in the ring so that the end of log marker follows them
+        blackboxEncodeSnapshots(false);
         blackboxLogEvent(FLIGHT_LOG_EVENT_LOG_END, NULL);
         FALLTHROUGH;
     default:
@@ -912,6 +1161,14 @@ void blackboxFinish(void)
     }
 }
 
+/**
+ * Begin Blackbox shutdown. May be called from the PID loop, the log is closed by the next blackboxUpdate().
+ */
+void blackboxFinish(void)
+{
+    blackboxFinishPending = true;
+}
+
 /**
  * Test Motors Blackbox Logging
  */
@@ -972,6 +1229,7 @@ static void writeGPSHomeFrame(void)
 
     gpsHistory.GPS_home[0] = GPS_home[0];
     gpsHistory.GPS_home[1] = GPS_home[1];
+    gpsHistory.homeIteration = blackboxIteration;
 }
 
 static void writeGPSFrame(timeUs_t currentTimeUs)
@@ -1003,68 +1261,103 @@ static void writeGPSFrame(timeUs_t currentTimeUs)
 #endif
 
 /**
- * Fill the current state of the blackbox using values read from the flight controller
+ * Fill the given state of the blackbox using values read from the flight controller
  */
-static void loadMainState(timeUs_t currentTimeUs)
+static void loadMainState(blackboxMainState_t *blackboxCurrent, timeUs_t currentTimeUs)
 {
 #ifndef UNIT_TEST
-    blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
-
+    // Only what the log will contain is loaded, this runs in the PID loop
     blackboxCurrent->time = currentTimeUs;
 
-    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
-        blackboxCurrent->axisPID_P[i] = pidData[i].P;
-        blackboxCurrent->axisPID_I[i] = pidData[i].I;
-        blackboxCurrent->axisPID_D[i] = pidData[i].D;
-        blackboxCurrent->axisPID_F[i] = pidData[i].F;
-        blackboxCurrent->gyroADC[i] = lrintf(gyro.gyroADCf[i]);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_PID)) {
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            blackboxCurrent->axisPID_P[i] = pidData[i].P;
+            blackboxCurrent->axisPID_I[i] = pidData[i].I;
+            blackboxCurrent->axisPID_D[i] = pidData[i].D;
+            blackboxCurrent->axisPID_F[i] = pidData[i].F;
+        }
+    }
+
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_GYRO)) {
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            blackboxCurrent->gyroADC[i] = lrintf(gyro.gyroADCf[i]);
+        }
+    }
+
 #if defined(USE_ACC)
-        blackboxCurrent->accADC[i] = lrintf(acc.accADC[i]);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_ACC)) {
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            blackboxCurrent->accADC[i] = lrintf(acc.accADC[i]);
+        }
+    }
 #endif
+
 #ifdef USE_MAG
-        blackboxCurrent->magADC[i] = mag.magADC[i];
-#endif
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_MAG)) {
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            blackboxCurrent->magADC[i] = mag.magADC[i];
+        }
     }
+#endif
 
-    for (int i = 0; i < 4; i++) {
-        blackboxCurrent->rcCommand[i] = lrintf(rcCommand[i]);
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RC_COMMANDS)) {
+        for (int i = 0; i < 4; i++) {
+            blackboxCurrent->rcCommand[i] = lrintf(rcCommand[i]);
+        }
     }
 
-    // log the currentPidSetpoint values applied to the PID controller
-    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
-        blackboxCurrent->setpoint[i] = lrintf(pidGetPreviousSetpoint(i));
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_SETPOINT)) {
+        // log the currentPidSetpoint values applied to the PID controller
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            blackboxCurrent->setpoint[i] = lrintf(pidGetPreviousSetpoint(i));
+        }
+        // log the final throttle value used in the mixer
+        blackboxCurrent->setpoint[3] = lrintf(mixerGetLoggingThrottle() * 1000);
     }
-    // log the final throttle value used in the mixer
-    blackboxCurrent->setpoint[3] = lrintf(mixerGetLoggingThrottle() * 1000);
 
-    for (int i = 0; i < DEBUG16_VALUE_COUNT; i++) {
-        blackboxCurrent->debug[i] = debug[i];
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_DEBUG)) {
+        for (int i = 0; i < DEBUG16_VALUE_COUNT; i++) {
+            blackboxCurrent->debug[i] = debug[i];
+        }
     }
 
-    const int motorCount = getMotorCount();
-    for (int i = 0; i < motorCount; i++) {
-        blackboxCurrent->motor[i] = motor[i];
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_AT_LEAST_MOTORS_1)) {
+        const int motorCount = getMotorCount();
+        for (int i = 0; i < motorCount; i++) {
+            blackboxCurrent->motor[i] = motor[i];
+        }
     }
 
-    blackboxCurrent->vbatLatest = getBatteryVoltageLatest();
-    blackboxCurrent->amperageLatest = getAmperageLatest();
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_VBAT)) {
+        blackboxCurrent->vbatLatest = getBatteryVoltageLatest();
+    }
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_AMPERAGE_ADC)) {
+        blackboxCurrent->amperageLatest = getAmperageLatest();
+    }
 
 #ifdef USE_BARO
-    blackboxCurrent->BaroAlt = baro.BaroAlt;
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_BARO)) {
+        blackboxCurrent->BaroAlt = baro.BaroAlt;
+    }
 #endif
 
 #ifdef USE_RANGEFINDER
-    // Store the raw sonar value without applying tilt correction
-    blackboxCurrent->surfaceRaw = rangefinderGetLatestAltitude();
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RANGEFINDER)) {
+        // Store the raw sonar value without applying tilt correction
+        blackboxCurrent->surfaceRaw = rangefinderGetLatestAltitude();
+    }
 #endif
 
-    blackboxCurrent->rssi = getRssi();
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_RSSI)) {
+        blackboxCurrent->rssi = getRssi();
+    }
 
 #ifdef USE_SERVOS
     //Tail servo for tricopters
     blackboxCurrent->servo[5] = servo[5];
 #endif
 #else
+    UNUSED(blackboxCurrent);
     UNUSED(currentTimeUs);
 #endif // UNIT_TEST
 }
@@ -1169,7 +1462,13 @@ static bool sendFieldDefinition(char mainFrameChar, char deltaFrameChar, const v
                 }
             } else {
                 //The other headers are integers
-                blackboxPrintf("%d", def->arr[xmitState.headerIndex - 1]);
+                uint8_t value = def->arr[xmitState.headerIndex - 1];
+                // The last header of the main fields is the P-frame encoding
+                if (deltaFrameChar && xmitState.headerIndex == BLACKBOX_DELTA_FIELD_HEADER_COUNT - 1
+                    && blackboxConfig()->packed_encoding && ((const blackboxDeltaFieldDefinition_t *)def)->Ppacked) {
+                    value = ENCODING(BITPACK_8S32);
+                }
+                blackboxPrintf("%d", value);
             }
         }
     }
@@ -1241,6 +1540,11 @@ static bool blackboxWriteSysinfo(void)
         BLACKBOX_PRINT_HEADER_LINE("I interval", "%d",                      blackboxIInterval);
         BLACKBOX_PRINT_HEADER_LINE("P interval", "%d",                      blackboxPInterval);
         BLACKBOX_PRINT_HEADER_LINE("P ratio", "%d",                         blackboxConfig()->p_ratio);
+        BLACKBOX_PRINT_HEADER_LINE("fields_disabled_mask", "%d",            blackboxConfig()->fields_disabled_mask);
+        BLACKBOX_PRINT_HEADER_LINE("P adaptive rate", "%d",                 blackboxConfig()->adaptive_rate);
+#ifdef USE_HUFFMAN
+        BLACKBOX_PRINT_HEADER_LINE("P compression", "%d",                   blackboxConfig()->compression);
+#endif
         BLACKBOX_PRINT_HEADER_LINE("minthrottle", "%d",                     motorConfig()->minthrottle);
         BLACKBOX_PRINT_HEADER_LINE("maxthrottle", "%d",                     motorConfig()->maxthrottle);
         BLACKBOX_PRINT_HEADER_LINE("gyro_scale","0x%x",                     castFloatBytesToInt(1.0f));
@@ -1375,14 +1679,17 @@ static bool blackboxWriteSysinfo(void)
         BLACKBOX_PRINT_HEADER_LINE("dyn_notch_width_percent", "%d",         gyroConfig()->dyn_notch_width_percent);
         BLACKBOX_PRINT_HEADER_LINE("dyn_notch_q", "%d",                     gyroConfig()->dyn_notch_q);
         BLACKBOX_PRINT_HEADER_LINE("dyn_notch_min_hz", "%d",                gyroConfig()->dyn_notch_min_hz);
+        BLACKBOX_PRINT_HEADER_LINE("dyn_notch_count", "%d",                 gyroConfig()->dyn_notch_count);
 #endif
 #ifdef USE_RPM_FILTER
         BLACKBOX_PRINT_HEADER_LINE("gyro_rpm_notch_harmonics", "%d",        rpmFilterConfig()->gyro_rpm_notch_harmonics);
         BLACKBOX_PRINT_HEADER_LINE("gyro_rpm_notch_q", "%d",                rpmFilterConfig()->gyro_rpm_notch_q);
         BLACKBOX_PRINT_HEADER_LINE("gyro_rpm_notch_min", "%d",              rpmFilterConfig()->gyro_rpm_notch_min);
+        BLACKBOX_PRINT_HEADER_LINE("gyro_rpm_notch_mask", "%d",             rpmFilterConfig()->gyro_rpm_notch_mask);
         BLACKBOX_PRINT_HEADER_LINE("dterm_rpm_notch_harmonics", "%d",       rpmFilterConfig()->dterm_rpm_notch_harmonics);
         BLACKBOX_PRINT_HEADER_LINE("dterm_rpm_notch_q", "%d",               rpmFilterConfig()->dterm_rpm_notch_q);
         BLACKBOX_PRINT_HEADER_LINE("dterm_rpm_notch_min", "%d",             rpmFilterConfig()->dterm_rpm_notch_min);
+        BLACKBOX_PRINT_HEADER_LINE("dterm_rpm_notch_mask", "%d",            rpmFilterConfig()->dterm_rpm_notch_mask);
         BLACKBOX_PRINT_HEADER_LINE("rpm_notch_lpf", "%d",                   rpmFilterConfig()->rpm_lpf);
 #endif
 #if defined(USE_ACC)
@@ -1404,6 +1711,7 @@ static bool blackboxWriteSysinfo(void)
         BLACKBOX_PRINT_HEADER_LINE("use_unsynced_pwm", "%d",                motorConfig()->dev.useUnsyncedPwm);
         BLACKBOX_PRINT_HEADER_LINE("motor_pwm_protocol", "%d",              motorConfig()->dev.motorPwmProtocol);
         BLACKBOX_PRINT_HEADER_LINE("motor_pwm_rate", "%d",                  motorConfig()->dev.motorPwmRate);
+        BLACKBOX_PRINT_HEADER_LINE("motor_pwm_sync_offset", "%d",           motorConfig()->dev.motorPwmSyncOffsetUs);
         BLACKBOX_PRINT_HEADER_LINE("dshot_idle_value", "%d",                motorConfig()->digitalIdleOffsetValue);
         BLACKBOX_PRINT_HEADER_LINE("debug_mode", "%d",                      debugMode);
         BLACKBOX_PRINT_HEADER_LINE("features", "%d",                        featureConfig()->enabledFeatures);
@@ -1431,6 +1739,67 @@ static bool blackboxWriteSysinfo(void)
     return false;
 }
 
+#ifdef USE_BLACKBOX_HEADER_CACHE
+// Runs through all the header states at once into the cache, returns false if the header doesn't fit
+static bool blackboxRenderHeaderCache(void)
+{
+    blackboxBeginCapture(blackboxHeaderCache, sizeof(blackboxHeaderCache));
+    // Nothing goes to the device, so every line can be written straight away
+    blackboxHeaderBudget = INT32_MAX;
+
+    blackboxWriteString(blackboxHeader);
+
+    xmitState.headerIndex = 0;
+    xmitState.u.fieldIndex = -1;
+    while (sendFieldDefinition('I', 'P', blackboxMainFields, blackboxMainFields + 1, ARRAYLEN(blackboxMainFields),
+            &blackboxMainFields[0].condition, &blackboxMainFields[1].condition));
+
+#ifdef USE_GPS
+    if (featureIsEnabled(FEATURE_GPS)) {
+        xmitState.headerIndex = 0;
+        xmitState.u.fieldIndex = -1;
+        while (sendFieldDefinition('H', 0, blackboxGpsHFields, blackboxGpsHFields + 1, ARRAYLEN(blackboxGpsHFields),
+                NULL, NULL));
+
+        xmitState.headerIndex = 0;
+        xmitState.u.fieldIndex = -1;
+        while (sendFieldDefinition('G', 0, blackboxGpsGFields, blackboxGpsGFields + 1, ARRAYLEN(blackboxGpsGFields),
+                &blackboxGpsGFields[0].condition, &blackboxGpsGFields[1].condition));
+    }
+#endif
+
+    xmitState.headerIndex = 0;
+    xmitState.u.fieldIndex = -1;
+    while (sendFieldDefinition('S', 0, blackboxSlowFields, blackboxSlowFields + 1, ARRAYLEN(blackboxSlowFields),
+            NULL, NULL));
+
+    xmitState.headerIndex = 0;
+    while (!blackboxWriteSysinfo());
+
+    const int length = blackboxEndCapture();
+    blackboxHeaderBudget = 0;
+    blackboxHeaderCacheLength = length <= (int)sizeof(blackboxHeaderCache) ? length : 0;
+
+    return blackboxHeaderCacheLength > 0;
+}
+
+// Writes as much of the cached header as the device takes, returns true once all of it is written
+static bool blackboxWriteHeaderCache(void)
+{
+    blackboxReplenishCachedHeaderBudget();
+
+    const int length = MIN(blackboxHeaderBudget, blackboxHeaderCacheLength - (int)xmitState.headerIndex);
+    if (length > 0) {
+        blackboxWriteBuf(&blackboxHeaderCache[xmitState.headerIndex], length);
+        xmitState.headerIndex += length;
+        blackboxHeaderBudget -= length;
+    }
+    blackboxDeviceFlush();
+
+    return (int)xmitState.headerIndex == blackboxHeaderCacheLength;
+}
+#endif
+
 /**
  * Write the given event to the log immediately
  */
@@ -1467,6 +1836,10 @@ void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
         blackboxWriteUnsignedVB(data->loggingResume.logIteration);
         blackboxWriteUnsignedVB(data->loggingResume.currentTime);
         break;
+    case FLIGHT_LOG_EVENT_LOGGING_RATE:
+        blackboxWriteUnsignedVB(data->loggingRate.logIteration);
+        blackboxWriteUnsignedVB(data->loggingRate.pInterval);
+        break;
     case FLIGHT_LOG_EVENT_LOG_END:
         blackboxWriteString("End of log");
         blackboxWrite(0);
@@ -1510,7 +1883,7 @@ STATIC_UNIT_TESTED bool blackboxShouldLogIFrame(void)
 }
 
 /*
- * If the GPS home point has been updated, or every 128 I-frames (~10 seconds), write the
+ * If the GPS home point has been updated, or every 128 I-frame intervals (~4 seconds), write the
  * GPS home position.
  *
  * We write it periodically so that if one Home Frame goes missing, the GPS coordinates can
@@ -1520,7 +1893,7 @@ STATIC_UNIT_TESTED bool blackboxShouldLogIFrame(void)
 STATIC_UNIT_TESTED bool blackboxShouldLogGpsHomeFrame(void)
 {
     if (GPS_home[0] != gpsHistory.GPS_home[0] || GPS_home[1] != gpsHistory.GPS_home[1]
-        || (blackboxPFrameIndex == blackboxIInterval / 2 && blackboxIFrameIndex % 128 == 0)) {
+        || blackboxIteration - gpsHistory.homeIteration >= (uint32_t)blackboxIInterval * 128) {
         return true;
     }
     return false;
@@ -1537,64 +1910,214 @@ STATIC_UNIT_TESTED void blackboxAdvanceIterationTimers(void)
         blackboxLoopIndex = 0;
         blackboxIFrameIndex++;
         blackboxPFrameIndex = 0;
-    } else if (++blackboxPFrameIndex >= blackboxPInterval) {
+        // the decoder learns of the new P-frame interval ahead of this I-frame
+        blackboxPRateShift = blackboxPRateShiftRequested;
+    } else if (++blackboxPFrameIndex >= (blackboxPInterval << blackboxPRateShift)) {
         blackboxPFrameIndex = 0;
     }
 }
 
-// Called once every FC loop in order to log the current state
-STATIC_UNIT_TESTED void blackboxLogIteration(timeUs_t currentTimeUs)
+// Copy the main state into the ring, or count the frame as dropped if blackboxUpdate() hasn't caught up
+STATIC_UNIT_TESTED void blackboxSnapshotMainState(timeUs_t currentTimeUs, bool intraframe)
 {
-    // Write a keyframe every blackboxIInterval frames so we can resynchronise upon missing frames
-    if (blackboxShouldLogIFrame()) {
-        /*
-         * Don't log a slow frame if the slow data didn't change ("I" frames are already large enough without adding
-         * an additional item to write at the same time). Unless we're *only* logging "I" frames, then we have no choice.
-         */
-        if (blackboxIsOnlyLoggingIntraframes()) {
-            writeSlowFrameIfNeeded();
+    const uint8_t head = blackboxSnapshotHead;
+    const uint8_t nextHead = (head + 1) & (BLACKBOX_SNAPSHOT_RING_SIZE - 1);
+
+    if (nextHead == blackboxSnapshotTail) {
+        blackboxDroppedFrames++;
+        blackboxSnapshotResync = true;
+        return;
+    }
+
+    blackboxSnapshot_t *snapshot = &blackboxSnapshotRing[head];
+    loadMainState(&snapshot->state, currentTimeUs);
+    snapshot->iteration = blackboxIteration;
+    snapshot->intraframe = intraframe || blackboxSnapshotResync;
+    snapshot->pRateShift = blackboxPRateShift;
+    blackboxSnapshotResync = false;
+
+    // Only publish the snapshot to the encoder once it is complete
+    BLACKBOX_SNAPSHOT_BARRIER();
+    blackboxSnapshotHead = nextHead;
+}
+
+/**
+ * Called once every PID loop iteration in order to snapshot the current state, blackboxUpdate() encodes it later.
+ */
+void blackboxLogIteration(timeUs_t currentTimeUs)
+{
+    switch (blackboxState) {
+    case BLACKBOX_STATE_RUNNING:
+        // Write a keyframe every blackboxIInterval frames so we can resynchronise upon missing frames
+        if (blackboxShouldLogIFrame()) {
+            blackboxSnapshotMainState(currentTimeUs, true);
+        } else if (blackboxShouldLogPFrame()) {
+            blackboxSnapshotMainState(currentTimeUs, false);
         }
+        break;
+    case BLACKBOX_STATE_PAUSED:
+        // Restart with an I-frame on resume, so that we have an "I" base to work from
+        blackboxSnapshotResync = true;
+        break;
+    default:
+        return;
+    }
+
+    // Keep the logging timers ticking so our log iteration continues to advance
+    blackboxAdvanceIterationTimers();
+}
 
-        loadMainState(currentTimeUs);
-        writeIntraframe();
+static void blackboxLogSnapshot(const blackboxSnapshot_t *snapshot)
+{
+    if (blackboxResumePending) {
+        // Write a log entry so the decoder is aware that our large time/iteration skip is intended
+        flightLogEvent_loggingResume_t resume;
+
+        resume.logIteration = snapshot->iteration;
+        resume.currentTime = snapshot->state.time;
+
+        blackboxLogEvent(FLIGHT_LOG_EVENT_LOGGING_RESUME, (flightLogEventData_t *) &resume);
+        blackboxResumePending = false;
+    }
+
+    if (snapshot->pRateShift != blackboxLoggedPRateShift) {
+        // The rate changes at an I-frame, this snapshot is the first one logged at the new rate
+        flightLogEvent_loggingRate_t rate;
+
+        rate.logIteration = snapshot->iteration;
+        rate.pInterval = blackboxPInterval << snapshot->pRateShift;
+
+        blackboxLogEvent(FLIGHT_LOG_EVENT_LOGGING_RATE, (flightLogEventData_t *) &rate);
+        blackboxLoggedPRateShift = snapshot->pRateShift;
+    }
+
+    /*
+     * We assume that slow frames are only interesting in that they aid the interpretation of the main data stream.
+     * So only log slow frames during loop iterations where we log a main frame.
+     *
+     * Don't log a slow frame with an "I" frame if the slow data didn't change ("I" frames are already large enough
+     * without adding an additional item to write at the same time). Unless we're *only* logging "I" frames, then we
+     * have no choice.
+     */
+    if (!snapshot->intraframe || blackboxIsOnlyLoggingIntraframes()) {
+        writeSlowFrameIfNeeded();
+    }
+
+    const uint32_t frameStart = blackboxDeviceGetWrittenBytes();
+
+    memcpy(blackboxHistory[0], &snapshot->state, sizeof(*blackboxHistory[0]));
+    if (snapshot->intraframe) {
+        writeIntraframe(snapshot->iteration);
     } else {
-        blackboxCheckAndLogArmingBeep();
-        blackboxCheckAndLogFlightMode(); // Check for FlightMode status change event
+        writeInterframe();
+    }
 
-        if (blackboxShouldLogPFrame()) {
-            /*
-             * We assume that slow frames are only interesting in that they aid the interpretation of the main data stream.
-             * So only log slow frames during loop iterations where we log a main frame.
-             */
-            writeSlowFrameIfNeeded();
+    const uint32_t frameSize = blackboxDeviceGetWrittenBytes() - frameStart;
+    if (frameSize > blackboxFrameSizeMax[snapshot->intraframe]) {
+        blackboxFrameSizeMax[snapshot->intraframe] = frameSize;
+    }
+}
+
+/*
+ * Encode the snapshots waiting in the ring, in order. Unless waitForBufferSpace is false, a frame is only encoded once
+ * the device has room for it, the remaining snapshots then wait for the next call.
+ *
+ * Returns true if the ring has been emptied.
+ */
+static bool blackboxEncodeSnapshots(bool waitForBufferSpace)
+{
+    const uint8_t head = blackboxSnapshotHead;
+    BLACKBOX_SNAPSHOT_BARRIER();
+
+    uint8_t tail = blackboxSnapshotTail;
+    while (tail != head) {
+        const blackboxSnapshot_t *snapshot = &blackboxSnapshotRing[tail];
 
-            loadMainState(currentTimeUs);
-            writeInterframe();
+        if (waitForBufferSpace && !blackboxDeviceHasBufferSpace(blackboxFrameSizeMax[snapshot->intraframe])) {
+            return false;
         }
-#ifdef USE_GPS
-        if (featureIsEnabled(FEATURE_GPS)) {
-            if (blackboxShouldLogGpsHomeFrame()) {
-                writeGPSHomeFrame();
-                writeGPSFrame(currentTimeUs);
-            } else if (gpsSol.numSat != gpsHistory.GPS_numSat
-                    || gpsSol.llh.lat != gpsHistory.GPS_coord[LAT]
-                    || gpsSol.llh.lon != gpsHistory.GPS_coord[LON]) {
-                //We could check for velocity changes as well but I doubt it changes independent of position
-                writeGPSFrame(currentTimeUs);
-            }
+        blackboxDeviceBeginFrame();
+        blackboxLogSnapshot(snapshot);
+        blackboxDeviceEndFrame();
+
+        tail = (tail + 1) & (BLACKBOX_SNAPSHOT_RING_SIZE - 1);
+        BLACKBOX_SNAPSHOT_BARRIER();
+        blackboxSnapshotTail = tail;
+    }
+
+    return head == blackboxSnapshotHead;
+}
+
+/*
+ * Lower the P-frame rate while the device can't keep up with the log, so that the log thins out evenly instead of
+ * losing runs of frames, and raise it back once the device has caught up. The device is behind when frames were
+ * dropped since the last call or half the snapshot ring is still waiting to be encoded.
+ */
+STATIC_UNIT_TESTED void blackboxUpdatePRate(void)
+{
+    const uint8_t backlog = (blackboxSnapshotHead - blackboxSnapshotTail) & (BLACKBOX_SNAPSHOT_RING_SIZE - 1);
+    const bool behind = blackboxDroppedFrames != blackboxPRateDroppedFrames || backlog >= BLACKBOX_SNAPSHOT_RING_SIZE / 2;
+    blackboxPRateDroppedFrames = blackboxDroppedFrames;
+
+    if (blackboxPRateUpdatesSinceChange < UINT16_MAX) {
+        blackboxPRateUpdatesSinceChange++;
+    }
+    if (behind) {
+        blackboxPRateUpdatesSinceBehind = 0;
+    } else if (blackboxPRateUpdatesSinceBehind < UINT16_MAX) {
+        blackboxPRateUpdatesSinceBehind++;
+    }
+
+    uint8_t shift = blackboxPRateShiftRequested;
+    if (behind) {
+        if (shift < blackboxPRateShiftMax && blackboxPRateUpdatesSinceChange >= BLACKBOX_P_RATE_LOWER_UPDATES) {
+            shift++;
         }
-#endif
+    } else if (shift > 0 && blackboxPRateUpdatesSinceBehind >= BLACKBOX_P_RATE_RAISE_UPDATES
+        && blackboxPRateUpdatesSinceChange >= BLACKBOX_P_RATE_RAISE_UPDATES) {
+        shift--;
     }
 
-    //Flush every iteration so that our runtime variance is minimized
-    blackboxDeviceFlush();
+    if (shift != blackboxPRateShiftRequested) {
+        blackboxPRateShiftRequested = shift;
+        blackboxPRateUpdatesSinceChange = 0;
+    }
+}
+
+// Write the frames that don't follow the main frame schedule
+static void blackboxLogAsyncFrames(timeUs_t currentTimeUs)
+{
+    blackboxCheckAndLogArmingBeep();
+    blackboxCheckAndLogFlightMode(); // Check for FlightMode status change event
+
+#ifdef USE_GPS
+    // GPS frames are written relative to the last main frame, so wait for the first one
+    if (featureIsEnabled(FEATURE_GPS) && blackboxLoggedAnyFrames) {
+        if (blackboxShouldLogGpsHomeFrame()) {
+            writeGPSHomeFrame();
+            writeGPSFrame(currentTimeUs);
+        } else if (gpsSol.numSat != gpsHistory.GPS_numSat
+                || gpsSol.llh.lat != gpsHistory.GPS_coord[LAT]
+                || gpsSol.llh.lon != gpsHistory.GPS_coord[LON]) {
+            //We could check for velocity changes as well but I doubt it changes independent of position
+            writeGPSFrame(currentTimeUs);
+        }
+    }
+#else
+    UNUSED(currentTimeUs);
+#endif
 }
 
 /**
- * Call each flight loop iteration to perform blackbox logging.
+ * Call periodically from the blackbox task to run the logging state machine and encode the logged frames.
  */
 void blackboxUpdate(timeUs_t currentTimeUs)
 {
+    if (blackboxFinishPending) {
+        blackboxFinishPending = false;
+        blackboxShutdown();
+    }
+
     switch (blackboxState) {
     case BLACKBOX_STATE_STOPPED:
         if (ARMING_FLAG(ARMED)) {
@@ -1604,15 +2127,31 @@ void blackboxUpdate(timeUs_t currentTimeUs)
 #ifdef USE_FLASHFS
         if (IS_RC_MODE_ACTIVE(BOXBLACKBOXERASE)) {
             blackboxSetState(BLACKBOX_STATE_START_ERASE);
+        } else {
+            blackboxDeviceEraseAhead(false);
         }
 #endif
         break;
     case BLACKBOX_STATE_PREPARE_LOG_FILE:
         if (blackboxDeviceBeginLog()) {
+#ifdef USE_BLACKBOX_HEADER_CACHE
+            blackboxRenderHeaderCache();
+#endif
             blackboxSetState(BLACKBOX_STATE_SEND_HEADER);
         }
         break;
     case BLACKBOX_STATE_SEND_HEADER:
+#ifdef USE_BLACKBOX_HEADER_CACHE
+        if (blackboxHeaderCacheLength) {
+            // Only a serial logger needs the time to init
+            const bool deviceReady = blackboxConfig()->device != BLACKBOX_DEVICE_SERIAL || millis() > xmitState.u.startTime + 100;
+            // As at the end of the system info, let the device drain before the first frame
+            if (deviceReady && blackboxWriteHeaderCache() && blackboxDeviceFlushForce()) {
+                blackboxSetState(BLACKBOX_STATE_RUNNING);
+            }
+            break;
+        }
+#endif
         blackboxReplenishHeaderBudget();
         //On entry of this state, xmitState.headerIndex is 0 and startTime is intialised
 
@@ -1688,31 +2227,33 @@ void blackboxUpdate(timeUs_t currentTimeUs)
         }
         break;
     case BLACKBOX_STATE_PAUSED:
-        // Only allow resume to occur during an I-frame iteration, so that we have an "I" base to work from
-        if (IS_RC_MODE_ACTIVE(BOXBLACKBOX) && blackboxShouldLogIFrame()) {
-            // Write a log entry so the decoder is aware that our large time/iteration skip is intended
-            flightLogEvent_loggingResume_t resume;
-
-            resume.logIteration = blackboxIteration;
-            resume.currentTime = currentTimeUs;
-
-            blackboxLogEvent(FLIGHT_LOG_EVENT_LOGGING_RESUME, (flightLogEventData_t *) &resume);
+        // Finish writing the frames logged before the pause first, the resume event must follow them
+        if (blackboxEncodeSnapshots(true) && IS_RC_MODE_ACTIVE(BOXBLACKBOX)) {
+            // The resume event is written ahead of the first snapshot, which blackboxLogIteration() makes an I-frame
+            blackboxResumePending = true;
             blackboxSetState(BLACKBOX_STATE_RUNNING);
-
-            blackboxLogIteration(currentTimeUs);
         }
-        // Keep the logging timers ticking so our log iteration continues to advance
-        blackboxAdvanceIterationTimers();
+        blackboxDeviceFlush();
         break;
     case BLACKBOX_STATE_RUNNING:
         // On entry to this state, blackboxIteration, blackboxPFrameIndex and blackboxIFrameIndex are reset to 0
         // Prevent the Pausing of the log on the mode switch if in Motor Test Mode
         if (blackboxModeActivationConditionPresent && !IS_RC_MODE_ACTIVE(BOXBLACKBOX) && !startedLoggingInTestMode) {
             blackboxSetState(BLACKBOX_STATE_PAUSED);
-        } else {
-            blackboxLogIteration(currentTimeUs);
         }
-        blackboxAdvanceIterationTimers();
+        blackboxEncodeSnapshots(true);
+        if (blackboxConfig()->adaptive_rate) {
+            blackboxUpdatePRate();
+        }
+        blackboxDeviceBeginFrame();
+        blackboxLogAsyncFrames(currentTimeUs);
+        blackboxDeviceEndFrame();
+
+        //Flush every update so that our runtime variance is minimized
+        blackboxDeviceFlush();
+#ifdef USE_FLASHFS
+        blackboxDeviceEraseAhead(true);
+#endif
         break;
     case BLACKBOX_STATE_SHUTTING_DOWN:
         //On entry of this state, startTime is set
@@ -1810,9 +2351,10 @@ uint8_t blackboxGetRateDenom(void)
 void blackboxInit(void)
 {
     blackboxResetIterationTimers();
+    blackboxResetSnapshots();
 
     // an I-frame is written every 32ms
-    // blackboxUpdate() is run in synchronisation with the PID loop
+    // blackboxLogIteration() is run in synchronisation with the PID loop
     // targetPidLooptime is 1000 for 1kHz loop, 500 for 2kHz loop etc, targetPidLooptime is rounded for short looptimes
     if (targetPidLooptime == 31) { // rounded from 31.25us
         blackboxIInterval = 1024;
@@ -1830,6 +2372,12 @@ void blackboxInit(void)
     } else {
         blackboxPInterval = blackboxIInterval /  blackboxConfig()->p_ratio;
     }
+    // at the lowest rate only I-frames are logged
+    blackboxPRateShiftMax = 0;
+    while (blackboxPInterval && blackboxPRateShiftMax < BLACKBOX_P_RATE_SHIFT_MAX
+        && (blackboxPInterval << blackboxPRateShiftMax) < blackboxIInterval) {
+        blackboxPRateShiftMax++;
+    }
     if (blackboxConfig()->device) {
         blackboxSetState(BLACKBOX_STATE_STOPPED);
     } else {
@@ -42,10 +42,32 @@ typedef enum BlackboxMode {
     BLACKBOX_MODE_ALWAYS_ON
 } BlackboxMode;
 
+typedef enum BlackboxCompression {
+    BLACKBOX_COMPRESSION_NONE = 0,
+    BLACKBOX_COMPRESSION_HUFFMAN   // P-frame bodies coded with the huffmanTable shared with the MSP dataflash reads
+} BlackboxCompression;
+
+// Groups of main frame fields that blackbox_fields_disabled_mask can leave out of the log
+typedef enum FlightLogFieldSelect_e {
+    FLIGHT_LOG_FIELD_SELECT_PID = 0,
+    FLIGHT_LOG_FIELD_SELECT_RC_COMMANDS,
+    FLIGHT_LOG_FIELD_SELECT_SETPOINT,
+    FLIGHT_LOG_FIELD_SELECT_BATTERY,
+    FLIGHT_LOG_FIELD_SELECT_MAG,
+    FLIGHT_LOG_FIELD_SELECT_ALTITUDE,
+    FLIGHT_LOG_FIELD_SELECT_RSSI,
+    FLIGHT_LOG_FIELD_SELECT_GYRO,
+    FLIGHT_LOG_FIELD_SELECT_ACC,
+    FLIGHT_LOG_FIELD_SELECT_DEBUG_LOG,
+    FLIGHT_LOG_FIELD_SELECT_MOTOR,
+    FLIGHT_LOG_FIELD_SELECT_COUNT
+} FlightLogFieldSelect_e;
+
 typedef enum FlightLogEvent {
     FLIGHT_LOG_EVENT_SYNC_BEEP = 0,
     FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT = 13,
     FLIGHT_LOG_EVENT_LOGGING_RESUME = 14,
+    FLIGHT_LOG_EVENT_LOGGING_RATE = 16, // The P-frame interval changed with blackbox_adaptive_rate
     FLIGHT_LOG_EVENT_FLIGHTMODE = 30, // Add new event type for flight mode status.
     FLIGHT_LOG_EVENT_LOG_END = 255
 } FlightLogEvent;
@@ -55,6 +77,10 @@ typedef struct blackboxConfig_s {
     uint8_t device;
     uint8_t record_acc;
     uint8_t mode;
+    uint8_t packed_encoding; // bit pack the PID, gyro and motor deltas of P-frames
+    uint8_t compression;     // entropy code P-frames, see BlackboxCompression
+    uint32_t fields_disabled_mask; // bit per FlightLogFieldSelect_e group left out of the main frames
+    uint8_t adaptive_rate;   // lower the P-frame rate while the device can't keep up
 } blackboxConfig_t;
 
 PG_DECLARE(blackboxConfig_t, blackboxConfig);
@@ -62,7 +88,11 @@ PG_DECLARE(blackboxConfig_t, blackboxConfig);
 union flightLogEventData_u;
 void blackboxLogEvent(FlightLogEvent event, union flightLogEventData_u *data);
 
+// blackboxUpdate() runs in its own task with this period, encoding the frames snapshotted by blackboxLogIteration()
+#define BLACKBOX_UPDATE_INTERVAL_US 1000
+
 void blackboxInit(void);
+void blackboxLogIteration(timeUs_t currentTimeUs);
 void blackboxUpdate(timeUs_t currentTimeUs);
 void blackboxSetStartDateTime(const char *dateTime, timeMs_t timeNowMs);
 int blackboxCalculatePDenom(int rateNum, int rateDenom);
@@ -71,13 +101,18 @@ void blackboxValidateConfig(void);
 void blackboxFinish(void);
 bool blackboxMayEditConfig(void);
 #ifdef UNIT_TEST
-STATIC_UNIT_TESTED void blackboxLogIteration(timeUs_t currentTimeUs);
+STATIC_UNIT_TESTED void blackboxSnapshotMainState(timeUs_t currentTimeUs, bool intraframe);
 STATIC_UNIT_TESTED bool blackboxShouldLogPFrame(void);
 STATIC_UNIT_TESTED bool blackboxShouldLogIFrame(void);
 STATIC_UNIT_TESTED bool blackboxShouldLogGpsHomeFrame(void);
 STATIC_UNIT_TESTED bool writeSlowFrameIfNeeded(void);
 // Called once every FC loop in order to keep track of how many FC loop iterations have passed
 STATIC_UNIT_TESTED void blackboxAdvanceIterationTimers(void);
+STATIC_UNIT_TESTED void blackboxUpdatePRate(void);
 extern int32_t blackboxSInterval;
 extern int32_t blackboxSlowFrameIterationTimer;
+extern uint32_t blackboxDroppedFrames;
+extern bool blackboxSnapshotResync;
+extern uint8_t blackboxPRateShift;
+extern volatile uint8_t blackboxPRateShiftRequested;
 #endif
@@ -32,6 +32,7 @@
 #include "blackbox_io.h"
 
 #include "common/encoding.h"
+#include "common/maths.h"
 #include "common/printf.h"
 
 
@@ -493,6 +494,59 @@ void blackboxWriteTag8_8SVB(int32_t *values, int valueCount)
     }
 }
 
+/**
+ * Pack a group of up to BLACKBOX_BITPACK_GROUP_SIZE signed values into the buffer using the BITPACK_8S32 encoding.
+ * Each value is ZigZag encoded and stored at the bit width of the largest one.
+ *
+ * Returns the number of bytes written to the buffer, at most BLACKBOX_BITPACK_GROUP_MAX_BYTES.
+ */
+int blackboxBitpackS32Group(uint8_t *buffer, const int32_t *values, int valueCount)
+{
+    uint32_t zigzag[BLACKBOX_BITPACK_GROUP_SIZE];
+    uint32_t allBits = 0;
+
+    // The whole array is encoded at once without branches, which the compiler can vectorise
+    for (int i = 0; i < valueCount; i++) {
+        zigzag[i] = ((uint32_t)values[i] << 1) ^ (uint32_t)(values[i] >> 31);
+        allBits |= zigzag[i];
+    }
+    const int bitWidth = allBits ? 32 - __builtin_clz(allBits) : 0;
+
+    uint8_t *pos = buffer;
+    *pos++ = bitWidth;
+
+    // At most 7 bits are left over from the previous value, so a 64 bit accumulator never overflows
+    uint64_t bits = 0;
+    int bitCount = 0;
+    for (int i = 0; i < valueCount; i++) {
+        bits |= (uint64_t)zigzag[i] << bitCount;
+        bitCount += bitWidth;
+        while (bitCount >= 8) {
+            *pos++ = bits;
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    }
+    if (bitCount > 0) {
+        *pos++ = bits;
+    }
+
+    return pos - buffer;
+}
+
+/**
+ * Write an array of signed values using the BITPACK_8S32 encoding, handing each group to the device in one write.
+ */
+void blackboxWriteBitpackS32Array(const int32_t *values, int valueCount)
+{
+    uint8_t buffer[BLACKBOX_BITPACK_GROUP_MAX_BYTES];
+
+    for (int i = 0; i < valueCount; i += BLACKBOX_BITPACK_GROUP_SIZE) {
+        const int groupCount = MIN(valueCount - i, BLACKBOX_BITPACK_GROUP_SIZE);
+        blackboxWriteBuf(buffer, blackboxBitpackS32Group(buffer, values + i, groupCount));
+    }
+}
+
 /** Write unsigned integer **/
 void blackboxWriteU32(int32_t value)
 {
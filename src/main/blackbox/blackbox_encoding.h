@@ -32,5 +32,12 @@ void blackboxWriteTag2_3S32(int32_t *values);
 int blackboxWriteTag2_3SVariable(int32_t *values);
 void blackboxWriteTag8_4S16(int32_t *values);
 void blackboxWriteTag8_8SVB(int32_t *values, int valueCount);
+
+#define BLACKBOX_BITPACK_GROUP_SIZE 8
+// A bit width byte followed by the largest group of values at 32 bits each
+#define BLACKBOX_BITPACK_GROUP_MAX_BYTES (1 + BLACKBOX_BITPACK_GROUP_SIZE * sizeof(uint32_t))
+
+int blackboxBitpackS32Group(uint8_t *buffer, const int32_t *values, int valueCount);
+void blackboxWriteBitpackS32Array(const int32_t *values, int valueCount);
 void blackboxWriteU32(int32_t value);
 void blackboxWriteFloat(float value);
@@ -39,12 +39,16 @@ typedef enum FlightLogFieldCondition {
     FLIGHT_LOG_FIELD_CONDITION_RANGEFINDER,
     FLIGHT_LOG_FIELD_CONDITION_RSSI,
 
+    FLIGHT_LOG_FIELD_CONDITION_PID,
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0,
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_1,
     FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_2,
 
     FLIGHT_LOG_FIELD_CONDITION_NOT_LOGGING_EVERY_FRAME,
 
+    FLIGHT_LOG_FIELD_CONDITION_RC_COMMANDS,
+    FLIGHT_LOG_FIELD_CONDITION_SETPOINT,
+    FLIGHT_LOG_FIELD_CONDITION_GYRO,
     FLIGHT_LOG_FIELD_CONDITION_ACC,
     FLIGHT_LOG_FIELD_CONDITION_DEBUG,
 
@@ -101,7 +105,12 @@ typedef enum FlightLogFieldEncoding {
     FLIGHT_LOG_FIELD_ENCODING_TAG2_3S32       = 7,
     FLIGHT_LOG_FIELD_ENCODING_TAG8_4S16       = 8,
     FLIGHT_LOG_FIELD_ENCODING_NULL            = 9, // Nothing is written to the file, take value to be zero
-    FLIGHT_LOG_FIELD_ENCODING_TAG2_3SVARIABLE = 10
+    FLIGHT_LOG_FIELD_ENCODING_TAG2_3SVARIABLE = 10,
+    /*
+     * Runs of up to 8 consecutive fields with this encoding are written as one group: a byte holding a bit width,
+     * followed by the ZigZag encoded values packed at that width from the least significant bit up, padded to a byte
+     */
+    FLIGHT_LOG_FIELD_ENCODING_BITPACK_8S32    = 11
 } FlightLogFieldEncoding;
 
 typedef enum FlightLogFieldSign {
@@ -130,6 +139,11 @@ typedef struct flightLogEvent_loggingResume_s {
     uint32_t currentTime;
 } flightLogEvent_loggingResume_t;
 
+typedef struct flightLogEvent_loggingRate_s {
+    uint32_t logIteration;  // iteration of the first frame logged at the new rate
+    uint32_t pInterval;     // iterations between P-frames from then on
+} flightLogEvent_loggingRate_t;
+
 #define FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT_FUNCTION_FLOAT_VALUE_FLAG 128
 
 typedef union flightLogEventData_u {
@@ -137,6 +151,7 @@ typedef union flightLogEventData_u {
     flightLogEvent_flightMode_t flightMode; // New event data
     flightLogEvent_inflightAdjustment_t inflightAdjustment;
     flightLogEvent_loggingResume_t loggingResume;
+    flightLogEvent_loggingRate_t loggingRate;
 } flightLogEventData_t;
 
 typedef struct flightLogEvent_s {
@@ -33,8 +33,6 @@
 
 #include "common/maths.h"
 
-#include "flight/pid.h"
-
 #include "io/asyncfatfs/asyncfatfs.h"
 #include "io/flashfs.h"
 #include "io/serial.h"
@@ -50,12 +48,38 @@
 // How many bytes can we transmit per loop iteration when writing headers?
 static uint8_t blackboxMaxHeaderBytesPerIteration;
 
+// Set when the logger can take whatever fits in the transmit buffer, the header budget is then only limited by that
+static bool blackboxHeaderFastMode;
+
 // How many bytes can we write *this* iteration without overflowing transmit buffers or overstressing the OpenLog?
 int32_t blackboxHeaderBudget;
 
+// Total number of bytes handed to the device, used to measure the size of the frames we write
+static uint32_t blackboxWrittenBytes;
+
+#if defined(USE_HUFFMAN) || defined(USE_BLACKBOX_HEADER_CACHE)
+// While set, writes are collected here instead of going to the device, so a frame can be compressed or the header cached
+static uint8_t *blackboxCaptureBuffer = NULL;
+static int blackboxCaptureSize;
+static int blackboxCaptureLength;
+#endif
+
 static serialPort_t *blackboxPort = NULL;
 static portSharing_e blackboxPortSharing;
 
+// Between blackboxDeviceBeginFrame() and blackboxDeviceEndFrame() serial writes are collected here, so the frame is
+// copied into the transmit buffer in one go and a single DMA transfer is started for it
+#define BLACKBOX_SERIAL_FRAME_BUFFER_SIZE 256
+static uint8_t blackboxSerialFrameBuffer[BLACKBOX_SERIAL_FRAME_BUFFER_SIZE];
+static int blackboxSerialFrameLength;
+static bool blackboxSerialFrameOpen;
+
+#ifdef USE_FLASHFS
+// Where the log being written to flash starts, it's added to the flashfs log index when the log ends
+static uint32_t blackboxFlashLogStart;
+static bool blackboxFlashLogOpen;
+#endif
+
 #ifdef USE_SDCARD
 
 static struct {
@@ -87,8 +111,83 @@ void blackboxOpen(void)
     }
 }
 
+#if defined(USE_HUFFMAN) || defined(USE_BLACKBOX_HEADER_CACHE)
+void blackboxBeginCapture(uint8_t *buf, int size)
+{
+    blackboxCaptureBuffer = buf;
+    blackboxCaptureSize = size;
+    blackboxCaptureLength = 0;
+}
+
+// Returns the number of bytes written since blackboxBeginCapture(), which is larger than the buffer if it overflowed
+int blackboxEndCapture(void)
+{
+    blackboxCaptureBuffer = NULL;
+    return blackboxCaptureLength;
+}
+
+static void blackboxCapture(const uint8_t *buf, int length)
+{
+    for (int i = 0; i < length; i++) {
+        if (blackboxCaptureLength < blackboxCaptureSize) {
+            blackboxCaptureBuffer[blackboxCaptureLength] = buf[i];
+        }
+        blackboxCaptureLength++;
+    }
+}
+#endif
+
+static void blackboxSerialFrameFlush(void)
+{
+    if (blackboxSerialFrameLength) {
+        serialWriteBuf(blackboxPort, blackboxSerialFrameBuffer, blackboxSerialFrameLength);
+        blackboxSerialFrameLength = 0;
+    }
+}
+
+static void blackboxSerialWriteBuf(const uint8_t *buf, int length)
+{
+    if (!blackboxSerialFrameOpen) {
+        serialWriteBuf(blackboxPort, buf, length);
+        return;
+    }
+
+    while (length > 0) {
+        if (blackboxSerialFrameLength == BLACKBOX_SERIAL_FRAME_BUFFER_SIZE) {
+            blackboxSerialFrameFlush();
+        }
+        const int chunk = MIN(length, BLACKBOX_SERIAL_FRAME_BUFFER_SIZE - blackboxSerialFrameLength);
+        memcpy(&blackboxSerialFrameBuffer[blackboxSerialFrameLength], buf, chunk);
+        blackboxSerialFrameLength += chunk;
+        buf += chunk;
+        length -= chunk;
+    }
+}
+
+void blackboxDeviceBeginFrame(void)
+{
+    blackboxSerialFrameOpen = blackboxConfig()->device == BLACKBOX_DEVICE_SERIAL;
+}
+
+void blackboxDeviceEndFrame(void)
+{
+    if (blackboxSerialFrameOpen) {
+        blackboxSerialFrameFlush();
+        blackboxSerialFrameOpen = false;
+    }
+}
+
 void blackboxWrite(uint8_t value)
 {
+#if defined(USE_HUFFMAN) || defined(USE_BLACKBOX_HEADER_CACHE)
+    if (blackboxCaptureBuffer) {
+        blackboxCapture(&value, 1);
+        return;
+    }
+#endif
+
+    blackboxWrittenBytes++;
+
     switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
@@ -102,7 +201,11 @@ void blackboxWrite(uint8_t value)
 #endif
     case BLACKBOX_DEVICE_SERIAL:
     default:
-        serialWrite(blackboxPort, value);
+        if (blackboxSerialFrameOpen) {
+            blackboxSerialWriteBuf(&value, 1);
+        } else {
+            serialWrite(blackboxPort, value);
+        }
         break;
     }
 }
@@ -111,7 +214,14 @@ void blackboxWrite(uint8_t value)
 int blackboxWriteString(const char *s)
 {
     int length;
-    const uint8_t *pos;
+
+#if defined(USE_HUFFMAN) || defined(USE_BLACKBOX_HEADER_CACHE)
+    if (blackboxCaptureBuffer) {
+        length = strlen(s);
+        blackboxCapture((const uint8_t*) s, length);
+        return length;
+    }
+#endif
 
     switch (blackboxConfig()->device) {
 
@@ -131,19 +241,46 @@ int blackboxWriteString(const char *s)
 
     case BLACKBOX_DEVICE_SERIAL:
     default:
-        pos = (uint8_t*) s;
-        while (*pos) {
-            serialWrite(blackboxPort, *pos);
-            pos++;
-        }
-
-        length = pos - (uint8_t*) s;
+        length = strlen(s);
+        blackboxSerialWriteBuf((const uint8_t*) s, length);
         break;
     }
 
+    blackboxWrittenBytes += length;
+
     return length;
 }
 
+// Write the buffer to the blackbox device in one go
+void blackboxWriteBuf(const uint8_t *buf, int length)
+{
+#if defined(USE_HUFFMAN) || defined(USE_BLACKBOX_HEADER_CACHE)
+    if (blackboxCaptureBuffer) {
+        blackboxCapture(buf, length);
+        return;
+    }
+#endif
+
+    switch (blackboxConfig()->device) {
+#ifdef USE_FLASHFS
+    case BLACKBOX_DEVICE_FLASH:
+        flashfsWrite(buf, length, false); // Write asynchronously
+        break;
+#endif
+#ifdef USE_SDCARD
+    case BLACKBOX_DEVICE_SDCARD:
+        afatfs_fwrite(blackboxSDCard.logFile, buf, length); // Ignore failures due to buffers filling up
+        break;
+#endif
+    case BLACKBOX_DEVICE_SERIAL:
+    default:
+        blackboxSerialWriteBuf(buf, length);
+        break;
+    }
+
+    blackboxWrittenBytes += length;
+}
+
 /**
  * If there is data waiting to be written to the blackbox device, attempt to write (a portion of) that now.
  *
@@ -252,9 +389,11 @@ bool blackboxDeviceOpen(void)
             case BAUD_2470000:
                 // assume OpenLager in use, so do not constrain writes
                 blackboxMaxHeaderBytesPerIteration = BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION;
+                blackboxHeaderFastMode = true;
                 break;
             default:
-                blackboxMaxHeaderBytesPerIteration = constrain((targetPidLooptime * 3) / 500, 1, BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION);
+                blackboxMaxHeaderBytesPerIteration = constrain((BLACKBOX_UPDATE_INTERVAL_US * 3) / 500, 1, BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION);
+                blackboxHeaderFastMode = false;
                 break;
             };
 
@@ -304,6 +443,21 @@ void blackboxEraseAll(void)
     }
 }
 
+/**
+ * When logging to a flash ring, keep erasing the oldest data ahead of the write head while the flash is idle
+ */
+void blackboxDeviceEraseAhead(bool logging)
+{
+    switch (blackboxConfig()->device) {
+    case BLACKBOX_DEVICE_FLASH:
+        flashfsEraseAheadAsync(logging);
+        break;
+    default:
+        //not supported
+        break;
+    }
+}
+
 /**
  * Check to see if erasing is done
  */
@@ -478,6 +632,12 @@ static bool blackboxSDCardBeginLog(void)
 bool blackboxDeviceBeginLog(void)
 {
     switch (blackboxConfig()->device) {
+#ifdef USE_FLASHFS
+    case BLACKBOX_DEVICE_FLASH:
+        blackboxFlashLogStart = flashfsGetOffset();
+        blackboxFlashLogOpen = true;
+        return true;
+#endif // USE_FLASHFS
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
         return blackboxSDCardBeginLog();
@@ -502,6 +662,15 @@ bool blackboxDeviceEndLog(bool retainLog)
 #endif
 
     switch (blackboxConfig()->device) {
+#ifdef USE_FLASHFS
+    case BLACKBOX_DEVICE_FLASH:
+        // Flash can't discard the log, so it's indexed either way. This is called until the shutdown completes
+        if (blackboxFlashLogOpen) {
+            flashfsLogIndexAppend(blackboxFlashLogStart, flashfsGetOffset() - blackboxFlashLogStart);
+            blackboxFlashLogOpen = false;
+        }
+        return true;
+#endif // USE_FLASHFS
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
         // Keep retrying until the close operation queues
@@ -575,30 +744,52 @@ unsigned int blackboxGetLogNumber(void)
  * Call once every loop iteration in order to maintain the global blackboxHeaderBudget with the number of bytes we can
  * transmit this iteration.
  */
-void blackboxReplenishHeaderBudget(void)
+static int32_t blackboxDeviceGetBufferFreeSpace(void)
 {
-    int32_t freeSpace;
-
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
-        freeSpace = serialTxBytesFree(blackboxPort);
-        break;
+        return serialTxBytesFree(blackboxPort);
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
-        freeSpace = flashfsGetWriteBufferFreeSpace();
-        break;
+        return flashfsGetWriteBufferFreeSpace();
 #endif
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        freeSpace = afatfs_getFreeBufferSpace();
-        break;
+        return afatfs_getFreeBufferSpace();
 #endif
     default:
-        freeSpace = 0;
+        return 0;
     }
+}
+
+void blackboxReplenishHeaderBudget(void)
+{
+    const int32_t freeSpace = blackboxDeviceGetBufferFreeSpace();
+
+    if (blackboxHeaderFastMode && blackboxConfig()->device == BLACKBOX_DEVICE_SERIAL) {
+        // the port drains faster than the headers are written, don't pace them
+        blackboxHeaderBudget = freeSpace;
+        return;
+    }
+
     blackboxHeaderBudget = MIN(MIN(freeSpace, blackboxHeaderBudget + blackboxMaxHeaderBytesPerIteration), BLACKBOX_MAX_ACCUMULATED_HEADER_BUDGET);
 }
 
+#ifdef USE_BLACKBOX_HEADER_CACHE
+/**
+ * Like blackboxReplenishHeaderBudget() for a header that is already rendered. Writing it only costs a copy, so the
+ * budget is all the free buffer space, except on a serial logger that has to be paced like the OpenLog.
+ */
+void blackboxReplenishCachedHeaderBudget(void)
+{
+    if (blackboxConfig()->device == BLACKBOX_DEVICE_SERIAL && !blackboxHeaderFastMode) {
+        blackboxReplenishHeaderBudget();
+    } else {
+        blackboxHeaderBudget = blackboxDeviceGetBufferFreeSpace();
+    }
+}
+#endif
+
 /**
  * You must call this function before attempting to write Blackbox header bytes to ensure that the write will not
  * cause buffers to overflow. The number of bytes you can write is capped by the blackboxHeaderBudget. Calling this
@@ -662,4 +853,36 @@ blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
         return BLACKBOX_RESERVE_PERMANENT_FAILURE;
     }
 }
+
+/**
+ * Returns true if a frame of the given size can be written to the device now without overflowing its buffers.
+ *
+ * A frame that is larger than the whole buffer can never fit, so it is allowed once the buffer is empty rather
+ * than never being written at all.
+ */
+bool blackboxDeviceHasBufferSpace(int32_t bytes)
+{
+    switch (blackboxConfig()->device) {
+    case BLACKBOX_DEVICE_SERIAL:
+        // The USB VCP reports a txBufferSize of zero, its free space is that of the CDC buffer which is far larger
+        if (blackboxPort->txBufferSize) {
+            bytes = MIN(bytes, (int32_t) blackboxPort->txBufferSize - 1);
+        }
+        break;
+#ifdef USE_FLASHFS
+    case BLACKBOX_DEVICE_FLASH:
+        bytes = MIN(bytes, (int32_t) flashfsGetWriteBufferSize());
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return bytes <= blackboxDeviceGetBufferFreeSpace();
+}
+
+uint32_t blackboxDeviceGetWrittenBytes(void)
+{
+    return blackboxWrittenBytes;
+}
 #endif // BLACKBOX
@@ -43,6 +43,13 @@ extern int32_t blackboxHeaderBudget;
 void blackboxOpen(void);
 void blackboxWrite(uint8_t value);
 int blackboxWriteString(const char *s);
+void blackboxWriteBuf(const uint8_t *buf, int length);
+void blackboxDeviceBeginFrame(void);
+void blackboxDeviceEndFrame(void);
+#if defined(USE_HUFFMAN) || defined(USE_BLACKBOX_HEADER_CACHE)
+void blackboxBeginCapture(uint8_t *buf, int size);
+int blackboxEndCapture(void);
+#endif
 
 void blackboxDeviceFlush(void);
 bool blackboxDeviceFlushForce(void);
@@ -50,6 +57,7 @@ bool blackboxDeviceOpen(void);
 void blackboxDeviceClose(void);
 
 void blackboxEraseAll(void);
+void blackboxDeviceEraseAhead(bool logging);
 bool isBlackboxErased(void);
 
 bool blackboxDeviceBeginLog(void);
@@ -60,4 +68,9 @@ bool isBlackboxDeviceWorking(void);
 unsigned int blackboxGetLogNumber(void);
 
 void blackboxReplenishHeaderBudget(void);
+#ifdef USE_BLACKBOX_HEADER_CACHE
+void blackboxReplenishCachedHeaderBudget(void);
+#endif
 blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes);
+bool blackboxDeviceHasBufferSpace(int32_t bytes);
+uint32_t blackboxDeviceGetWrittenBytes(void);
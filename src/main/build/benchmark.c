@@ -0,0 +1,308 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_BENCHMARK
+
+#include "blackbox/blackbox_encoding.h"
+
+#include "common/crc.h"
+#include "common/filter.h"
+#include "common/maths.h"
+#include "common/sdft.h"
+#include "common/utils.h"
+
+#include "drivers/dshot.h"
+#include "drivers/dshot_bitbang_decode.h"
+#include "drivers/system.h"
+#include "drivers/time.h"
+
+#include "fc/config.h"
+
+#include "flight/mixer.h"
+#include "flight/pid.h"
+
+#include "osd/osd.h"
+#include "osd/osd_elements.h"
+
+#include "benchmark.h"
+
+// Each kernel runs in short batches with interrupts masked, so the PID loop
+// interrupt cannot run alongside the pid and mixer kernels and preemption
+// does not inflate the count. The fastest batch is the kernel's cost, the
+// average shows how much cache and flash wait states vary between batches.
+#ifdef SIMULATOR_BUILD
+#define BENCHMARK_BLOCK                 // nothing to mask, the PID loop runs in this thread
+#else
+#include "build/atomic.h"
+#include "drivers/nvic.h"
+#define BENCHMARK_BLOCK ATOMIC_BLOCK(NVIC_PRIO_MAX)
+#endif
+
+#define BENCHMARK_BATCH_CALLS   16
+#define BENCHMARK_BATCH_COUNT   64
+
+#define BENCHMARK_LOOP_US       125
+#define BENCHMARK_NOTCH_COUNT   12      // 3 harmonics of 4 motors on one axis
+#define BENCHMARK_FRAME_SIZE    26      // CRSF rc channels frame
+#define BENCHMARK_BB_SAMPLES    140     // bitbang dshot telemetry capture
+
+typedef struct benchmarkKernel_s {
+    const char *name;
+    void (*init)(void);
+    void (*run)(uint32_t i);
+} benchmarkKernel_t;
+
+static volatile float floatSink;
+static volatile uint32_t intSink;
+
+static biquadFilter_t biquad;
+static biquadFilter_t notch;
+static pt1Filter_t pt1;
+static biquadNotchCoeffs_t notchCoeffs[BENCHMARK_NOTCH_COUNT];
+static biquadNotchState_t notchState[BENCHMARK_NOTCH_COUNT + 1];
+static uint8_t frame[BENCHMARK_FRAME_SIZE];
+
+static float benchmarkSample(uint32_t i)
+{
+    return (i & 0xff) * 0.25f - 32.0f;
+}
+
+static void emptyInit(void)
+{
+}
+
+static void emptyRun(uint32_t i)
+{
+    intSink = i;
+}
+
+static void biquadInit(void)
+{
+    biquadFilterInitLPF(&biquad, 100, BENCHMARK_LOOP_US);
+}
+
+static void biquadRun(uint32_t i)
+{
+    floatSink = biquadFilterApply(&biquad, benchmarkSample(i));
+}
+
+static void notchInit(void)
+{
+    biquadFilterInit(&notch, 260, BENCHMARK_LOOP_US, filterGetNotchQ(260, 160), FILTER_NOTCH);
+}
+
+static void notchRun(uint32_t i)
+{
+    floatSink = biquadFilterApplyDF1(&notch, benchmarkSample(i));
+}
+
+static void pt1Init(void)
+{
+    pt1FilterInit(&pt1, pt1FilterGain(150, BENCHMARK_LOOP_US * 1e-6f));
+}
+
+static void pt1Run(uint32_t i)
+{
+    floatSink = pt1FilterApply(&pt1, benchmarkSample(i));
+}
+
+static void notchBankInit(void)
+{
+    for (int i = 0; i < BENCHMARK_NOTCH_COUNT; i++) {
+        biquadNotchCoeffsUpdate(&notchCoeffs[i], 150 + 40 * i, BENCHMARK_LOOP_US, 5.0f);
+    }
+    biquadNotchStateInit(notchState, BENCHMARK_NOTCH_COUNT);
+}
+
+static void notchBankRun(uint32_t i)
+{
+    floatSink = biquadNotchBankApply(notchCoeffs, notchState, BENCHMARK_NOTCH_COUNT, benchmarkSample(i));
+}
+
+// The pid and mixer run on the live state, which is harmless as the CLI is only entered disarmed
+static void pidRun(uint32_t i)
+{
+    UNUSED(i);
+    pidController(currentPidProfile, micros());
+}
+
+static void mixerRun(uint32_t i)
+{
+    UNUSED(i);
+    mixTable(micros(), currentPidProfile->vbatPidCompensation);
+}
+
+#ifdef USE_GYRO_DATA_ANALYSE
+static sdft_t sdft;
+static float sdftOutput[SDFT_BIN_COUNT_MAX];
+
+static void sdftBenchInit(void)
+{
+    sdftInit(&sdft, 64, 0, 32);
+}
+
+static void sdftPushRun(uint32_t i)
+{
+    sdftPush(&sdft, benchmarkSample(i));
+}
+
+static void sdftMagnitudeRun(uint32_t i)
+{
+    UNUSED(i);
+    sdftWinMagnitude(&sdft, sdftOutput);
+    floatSink = sdftOutput[1];
+}
+#endif
+
+#ifdef USE_DSHOT
+static void dshotEncodeRun(uint32_t i)
+{
+    dshotProtocolControl_t pcb = { .value = 48 + (i & 0x3ff), .requestTelemetry = false };
+    intSink = prepareDshotPacket(&pcb);
+}
+#endif
+
+#if defined(USE_DSHOT_BITBANG) && defined(USE_DSHOT_TELEMETRY)
+static uint16_t bbBuffer[BENCHMARK_BB_SAMPLES];
+
+// Four pins toggling every three samples, so every pin has an edge throughout the capture
+static void dshotDecodeInit(void)
+{
+    for (int i = 0; i < BENCHMARK_BB_SAMPLES; i++) {
+        bbBuffer[i] = ((i / 3) & 1) ? 0x000f : 0x0000;
+    }
+}
+
+static void dshotDecodeRun(uint32_t i)
+{
+    UNUSED(i);
+    uint32_t values[BB_PORT_PIN_COUNT];
+    decode_bb_port(bbBuffer, BENCHMARK_BB_SAMPLES, 0x000f, values);
+    intSink = values[0];
+}
+#endif
+
+#ifdef USE_BLACKBOX
+static void blackboxEncodeRun(uint32_t i)
+{
+    const int32_t values[BLACKBOX_BITPACK_GROUP_SIZE] = { i, -i, 3, -7, i >> 2, 120, -300, 0 };
+    uint8_t buffer[BLACKBOX_BITPACK_GROUP_MAX_BYTES];
+    intSink = blackboxBitpackS32Group(buffer, values, BLACKBOX_BITPACK_GROUP_SIZE);
+}
+#endif
+
+#ifdef USE_OSD
+static void osdFormatRun(uint32_t i)
+{
+    char buffer[OSD_ELEMENT_BUFFER_LENGTH];
+    osdFormatTime(buffer, OSD_TIMER_PREC_HUNDREDTHS, i * 12345);
+    osdFormatDistanceString(buffer, i & 0x3fff, 'D');
+    intSink = buffer[0];
+}
+#endif
+
+static void frameInit(void)
+{
+    for (unsigned i = 0; i < sizeof(frame); i++) {
+        frame[i] = i * 13 + 5;
+    }
+}
+
+static void crc8Run(uint32_t i)
+{
+    intSink = crc8_dvb_s2_update(i, frame, sizeof(frame));
+}
+
+static void crc16Run(uint32_t i)
+{
+    intSink = crc16_ccitt_update(i, frame, sizeof(frame));
+}
+
+// Every kernel the bench command times, one call is one sample, loop or frame
+static const benchmarkKernel_t kernels[] = {
+    { "empty",              emptyInit,      emptyRun },
+    { "biquad_lpf",         biquadInit,     biquadRun },
+    { "biquad_notch_df1",   notchInit,      notchRun },
+    { "pt1",                pt1Init,        pt1Run },
+    { "notch_bank_12",      notchBankInit,  notchBankRun },
+    { "pid_controller",     emptyInit,      pidRun },
+    { "mix_table",          emptyInit,      mixerRun },
+#ifdef USE_GYRO_DATA_ANALYSE
+    { "sdft_push",          sdftBenchInit,  sdftPushRun },
+    { "sdft_magnitude",     sdftBenchInit,  sdftMagnitudeRun },
+#endif
+#ifdef USE_DSHOT
+    { "dshot_encode",       emptyInit,      dshotEncodeRun },
+#endif
+#if defined(USE_DSHOT_BITBANG) && defined(USE_DSHOT_TELEMETRY)
+    { "dshot_bb_decode_4",  dshotDecodeInit, dshotDecodeRun },
+#endif
+#ifdef USE_BLACKBOX
+    { "blackbox_bitpack_8", emptyInit,      blackboxEncodeRun },
+#endif
+#ifdef USE_OSD
+    { "osd_format",         emptyInit,      osdFormatRun },
+#endif
+    { "crc8_dvb_s2_26",     frameInit,      crc8Run },
+    { "crc16_ccitt_26",     frameInit,      crc16Run },
+};
+
+int benchmarkCount(void)
+{
+    return ARRAYLEN(kernels);
+}
+
+const char *benchmarkName(int index)
+{
+    return kernels[index].name;
+}
+
+void benchmarkRun(int index, benchmarkResult_t *result)
+{
+    const benchmarkKernel_t *kernel = &kernels[index];
+    uint32_t minCycles = UINT32_MAX;
+    uint32_t totalCycles = 0;
+    uint32_t call = 0;
+
+    kernel->init();
+
+    for (int batch = 0; batch < BENCHMARK_BATCH_COUNT; batch++) {
+        uint32_t cycles;
+        BENCHMARK_BLOCK {
+            const uint32_t start = getCycleCounter();
+            for (int i = 0; i < BENCHMARK_BATCH_CALLS; i++) {
+                kernel->run(call++);
+            }
+            cycles = getCycleCounter() - start;
+        }
+        minCycles = MIN(minCycles, cycles);
+        totalCycles += cycles;
+    }
+
+    result->minCycles = minCycles / BENCHMARK_BATCH_CALLS;
+    result->avgCycles = totalCycles / (BENCHMARK_BATCH_COUNT * BENCHMARK_BATCH_CALLS);
+}
+
+#endif // USE_BENCHMARK
@@ -0,0 +1,35 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// On target cycle counts of the hot kernels, run from the CLI `bench` command.
+// Not part of any default build, enable with EXTRA_FLAGS=-DUSE_BENCHMARK.
+
+typedef struct benchmarkResult_s {
+    uint32_t minCycles;         // per call, fastest batch
+    uint32_t avgCycles;         // per call, all batches
+} benchmarkResult_t;
+
+int benchmarkCount(void);
+const char *benchmarkName(int index);
+void benchmarkRun(int index, benchmarkResult_t *result);
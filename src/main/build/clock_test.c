@@ -0,0 +1,94 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_OVERCLOCK
+
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "drivers/system.h"
+
+#include "clock_test.h"
+
+#define CLOCK_TEST_SAMPLES      256
+#define CLOCK_TEST_LOOP_US      125
+
+// A gyro like signal through the filters of the gyro path, mixed with square
+// roots and trigonometry, so the FPU, the multiply accumulate path and the
+// flash prefetch all get exercised. Float results are folded bit exactly.
+static uint32_t clockTestRound(void)
+{
+    biquadFilter_t lpf;
+    biquadFilter_t notch;
+    pt1Filter_t pt1;
+    uint32_t checksum = 0;
+
+    biquadFilterInitLPF(&lpf, 100, CLOCK_TEST_LOOP_US);
+    biquadFilterInit(&notch, 260, CLOCK_TEST_LOOP_US, filterGetNotchQ(260, 160), FILTER_NOTCH);
+    pt1FilterInit(&pt1, pt1FilterGain(150, CLOCK_TEST_LOOP_US * 1e-6f));
+
+    for (int i = 0; i < CLOCK_TEST_SAMPLES; i++) {
+        const float sample = 500.0f * sin_approx(i * 0.07f) + 80.0f * cos_approx(i * 1.3f) + (i & 0x1f);
+        float value = biquadFilterApply(&lpf, sample);
+        value = biquadFilterApplyDF1(&notch, value);
+        value = pt1FilterApply(&pt1, value) + sqrtf(fabsf(value)) * atan2_approx(value, sample + 1.0f);
+
+        union { float f; uint32_t u; } bits = { .f = value };
+        checksum = ((checksum << 5) | (checksum >> 27)) ^ bits.u;
+    }
+
+    return checksum;
+}
+
+// Returns true when every round matched the first
+bool clockTestRun(clockTestResult_t *result)
+{
+    uint32_t reference = 0;
+
+    result->rounds = CLOCK_TEST_ROUNDS;
+    result->mismatches = 0;
+    result->minCycles = UINT32_MAX;
+    result->maxCycles = 0;
+
+    for (int round = 0; round < CLOCK_TEST_ROUNDS; round++) {
+        const uint32_t start = getCycleCounter();
+        const uint32_t checksum = clockTestRound();
+        const uint32_t cycles = getCycleCounter() - start;
+
+        if (round == 0) {
+            reference = checksum;
+        } else if (checksum != reference) {
+            result->mismatches++;
+        }
+        result->minCycles = MIN(result->minCycles, cycles);
+        result->maxCycles = MAX(result->maxCycles, cycles);
+    }
+
+    return result->mismatches == 0;
+}
+
+#endif // USE_OVERCLOCK
@@ -0,0 +1,41 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Stability check of an overclocked core, run from the CLI `clocktest`
+// command. The same filter and maths workload runs round after round with
+// the flight controller's interrupts live; a core or flash running too fast
+// shows as a round whose checksum differs from the first.
+
+#define CLOCK_TEST_ROUNDS       200
+
+typedef struct clockTestResult_s {
+    uint16_t rounds;
+    uint16_t mismatches;        // rounds whose checksum differed from the first round's
+    uint32_t minCycles;         // per round
+    uint32_t maxCycles;
+} clockTestResult_t;
+
+bool clockTestRun(clockTestResult_t *result);
@@ -0,0 +1,169 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_CRASH_LOG
+
+#include "common/maths.h"
+
+#include "drivers/time.h"
+
+#include "fc/runtime_config.h"
+
+#include "crash_log.h"
+
+// Written from the scheduler, the gyro and the hard fault handler
+#ifdef SIMULATOR_BUILD
+#define CRASH_LOG_BLOCK
+#else
+#include "build/atomic.h"
+#include "drivers/nvic.h"
+#define CRASH_LOG_BLOCK ATOMIC_BLOCK(NVIC_PRIO_MAX)
+#endif
+
+// Changes with the layout, so an older log is discarded rather than misread
+#define CRASH_LOG_MAGIC (('C' << 24) | ('L' << 16) | (sizeof(crashLogEntry_t) << 8) | CRASH_LOG_ENTRIES)
+
+typedef struct crashLog_s {
+    uint32_t magic;
+    uint16_t boot;
+    uint8_t head;                   // next slot written
+    uint8_t count;
+    crashLogEntry_t entries[CRASH_LOG_ENTRIES];
+} crashLog_t;
+
+static PERSISTENT crashLog_t crashLog;
+
+static const char * const crashLogTypeNames[CRASH_LOG_TYPE_COUNT] = {
+    [CRASH_LOG_LOOP_OVERRUN] = "LOOP_OVERRUN",
+    [CRASH_LOG_GYRO_OVERFLOW] = "GYRO_OVERFLOW",
+    [CRASH_LOG_HARD_FAULT] = "HARD_FAULT",
+};
+
+void crashLogClear(void)
+{
+    CRASH_LOG_BLOCK {
+        crashLog.head = 0;
+        crashLog.count = 0;
+    }
+}
+
+// PERSISTENT RAM is not initialised at startup, after a power cycle it holds garbage
+void crashLogInit(void)
+{
+    if (crashLog.magic != CRASH_LOG_MAGIC || crashLog.head >= CRASH_LOG_ENTRIES || crashLog.count > CRASH_LOG_ENTRIES) {
+        memset(&crashLog, 0, sizeof(crashLog));
+        crashLog.magic = CRASH_LOG_MAGIC;
+    }
+    crashLog.boot++;
+}
+
+static crashLogEntry_t *crashLogNewest(void)
+{
+    return crashLog.count ? &crashLog.entries[(crashLog.head + CRASH_LOG_ENTRIES - 1) % CRASH_LOG_ENTRIES] : NULL;
+}
+
+static crashLogEntry_t *crashLogAppend(crashLogType_e type, uint8_t task, uint32_t value)
+{
+    crashLogEntry_t *entry = &crashLog.entries[crashLog.head];
+    crashLog.head = (crashLog.head + 1) % CRASH_LOG_ENTRIES;
+    if (crashLog.count < CRASH_LOG_ENTRIES) {
+        crashLog.count++;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->timeMs = millis();
+    entry->boot = crashLog.boot;
+    entry->count = 1;
+    entry->type = type;
+    entry->task = task;
+    entry->flags = ARMING_FLAG(ARMED) ? CRASH_LOG_FLAG_ARMED : 0;
+    entry->value = value;
+
+    return entry;
+}
+
+void crashLogRecord(crashLogType_e type, uint8_t task, uint32_t value)
+{
+    if (crashLog.magic != CRASH_LOG_MAGIC) {
+        return;
+    }
+
+    CRASH_LOG_BLOCK {
+        crashLogEntry_t *newest = crashLogNewest();
+        if (newest && newest->type == type && newest->task == task && newest->boot == crashLog.boot) {
+            if (newest->count < UINT16_MAX) {
+                newest->count++;
+            }
+            newest->value = MAX(newest->value, value);
+            if (ARMING_FLAG(ARMED)) {
+                newest->flags |= CRASH_LOG_FLAG_ARMED;
+            }
+        } else {
+            crashLogAppend(type, task, value);
+        }
+    }
+}
+
+// stackedFrame is the exception frame: r0, r1, r2, r3, r12, lr, pc, psr
+void crashLogRecordFault(const uint32_t *stackedFrame, uint32_t cfsr)
+{
+    if (crashLog.magic != CRASH_LOG_MAGIC) {
+        return;
+    }
+
+    CRASH_LOG_BLOCK {
+        crashLogEntry_t *entry = crashLogAppend(CRASH_LOG_HARD_FAULT, CRASH_LOG_NO_TASK, cfsr);
+        entry->lr = stackedFrame[5];
+        entry->pc = stackedFrame[6];
+        entry->psr = stackedFrame[7];
+    }
+}
+
+uint16_t crashLogGetBoot(void)
+{
+    return crashLog.boot;
+}
+
+uint8_t crashLogGetCount(void)
+{
+    return crashLog.count;
+}
+
+// Entries in the order they were recorded, index 0 is the oldest
+const crashLogEntry_t *crashLogGetEntry(uint8_t index)
+{
+    if (index >= crashLog.count) {
+        return NULL;
+    }
+    return &crashLog.entries[(crashLog.head + CRASH_LOG_ENTRIES - crashLog.count + index) % CRASH_LOG_ENTRIES];
+}
+
+const char *crashLogTypeName(crashLogType_e type)
+{
+    return type < CRASH_LOG_TYPE_COUNT ? crashLogTypeNames[type] : "UNKNOWN";
+}
+
+#endif // USE_CRASH_LOG
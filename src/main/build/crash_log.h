@@ -0,0 +1,66 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Ring of the last loop overruns, gyro overflows and hard faults, kept in
+// PERSISTENT RAM so it survives the reboot that follows a fault. Read with
+// the CLI `crashlog` command or MSP_CRASH_LOG. Repeats of the newest event
+// are counted in its entry, so a run of overruns takes a single slot.
+
+#define CRASH_LOG_ENTRIES       16
+#define CRASH_LOG_NO_TASK       0xff
+
+typedef enum {
+    CRASH_LOG_LOOP_OVERRUN = 0,     // value: lateness in us
+    CRASH_LOG_GYRO_OVERFLOW,        // value: overflowing axis mask
+    CRASH_LOG_HARD_FAULT,           // value: CFSR, pc/lr/psr from the stacked frame
+    CRASH_LOG_TYPE_COUNT
+} crashLogType_e;
+
+#define CRASH_LOG_FLAG_ARMED    (1 << 0)
+
+typedef struct crashLogEntry_s {
+    uint32_t timeMs;                // time since boot of the first occurrence
+    uint16_t boot;                  // boot the event happened in, see crashLogGetBoot()
+    uint16_t count;                 // occurrences coalesced into this entry
+    uint8_t type;
+    uint8_t task;                   // cfTaskId_e, or CRASH_LOG_NO_TASK
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t value;                 // worst value of the coalesced occurrences
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t psr;
+} crashLogEntry_t;
+
+#ifdef USE_CRASH_LOG
+void crashLogInit(void);
+void crashLogRecord(crashLogType_e type, uint8_t task, uint32_t value);
+void crashLogRecordFault(const uint32_t *stackedFrame, uint32_t cfsr);
+void crashLogClear(void);
+uint16_t crashLogGetBoot(void);
+uint8_t crashLogGetCount(void);
+const crashLogEntry_t *crashLogGetEntry(uint8_t index);
+const char *crashLogTypeName(crashLogType_e type);
+#endif
@@ -93,4 +93,11 @@ const char * const debugModeNames[DEBUG_COUNT] = {
     "DYN_IDLE",
     "FF_LIMIT",
     "FF_INTERPOLATED",
+    "GYRO_FIFO",
+    "MAX7456_SPI",
+    "CRSF_TELEMETRY",
+    "ALTITUDE_KF",
+    "RC_LATENCY",
+    "RX_DIVERSITY",
+    "SRXL2",
 };
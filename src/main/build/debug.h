@@ -109,6 +109,13 @@ typedef enum {
     DEBUG_DYN_IDLE,
     DEBUG_FF_LIMIT,
     DEBUG_FF_INTERPOLATED,
+    DEBUG_GYRO_FIFO,
+    DEBUG_MAX7456_SPI,
+    DEBUG_CRSF_TELEMETRY,
+    DEBUG_ALTITUDE_KF,
+    DEBUG_RC_LATENCY,
+    DEBUG_RX_DIVERSITY,
+    DEBUG_SRXL2,
     DEBUG_COUNT
 } debugType_e;
 
@@ -0,0 +1,119 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_TRACE
+
+#include "common/utils.h"
+
+#include "drivers/system.h"
+
+#include "trace.h"
+
+// Events are recorded from interrupts of every priority, the slot is taken
+// with interrupts masked so a preempting event cannot get the same one.
+#ifdef SIMULATOR_BUILD
+#define TRACE_BLOCK
+#else
+#include "build/atomic.h"
+#include "drivers/nvic.h"
+#define TRACE_BLOCK ATOMIC_BLOCK(NVIC_PRIO_MAX)
+#endif
+
+#define TRACE_BUFFER_MASK (TRACE_BUFFER_EVENTS - 1)
+
+STATIC_ASSERT((TRACE_BUFFER_EVENTS & TRACE_BUFFER_MASK) == 0, trace_buffer_events_must_be_a_power_of_two);
+
+static FAST_RAM_ZERO_INIT traceEvent_t traceBuffer[TRACE_BUFFER_EVENTS];
+static FAST_RAM_ZERO_INIT uint16_t traceHead;                  // next slot written
+static FAST_RAM_ZERO_INIT uint16_t traceCount;
+static FAST_RAM_ZERO_INIT uint16_t tracePostTriggerEvents;
+static FAST_RAM_ZERO_INIT volatile traceState_e traceState;
+
+FAST_CODE uint32_t traceRecord(traceEventType_e type, uint8_t id, uint16_t arg)
+{
+    uint32_t cycles = 0;
+
+    TRACE_BLOCK {
+        if (traceState != TRACE_STATE_FROZEN) {
+            cycles = getCycleCounter();
+
+            traceEvent_t *event = &traceBuffer[traceHead];
+            event->cycles = cycles;
+            event->type = type;
+            event->id = id;
+            event->arg = arg;
+
+            traceHead = (traceHead + 1) & TRACE_BUFFER_MASK;
+            if (traceCount < TRACE_BUFFER_EVENTS) {
+                traceCount++;
+            }
+            if (traceState == TRACE_STATE_TRIGGERED && --tracePostTriggerEvents == 0) {
+                traceState = TRACE_STATE_FROZEN;
+            }
+        }
+    }
+
+    return cycles;
+}
+
+// Keeps recording for half a buffer, so the buffer holds the events either side of the trigger
+void traceTrigger(traceTrigger_e reason, uint16_t arg)
+{
+    if (traceState == TRACE_STATE_RUNNING) {
+        tracePostTriggerEvents = TRACE_BUFFER_EVENTS / 2;
+        traceState = TRACE_STATE_TRIGGERED;
+        traceRecord(TRACE_TRIGGER, reason, arg);
+    }
+}
+
+void traceRearm(void)
+{
+    TRACE_BLOCK {
+        traceHead = 0;
+        traceCount = 0;
+        traceState = TRACE_STATE_RUNNING;
+    }
+}
+
+traceState_e traceGetState(void)
+{
+    return traceState;
+}
+
+uint16_t traceGetEventCount(void)
+{
+    return traceCount;
+}
+
+// Events in the order they were recorded, index 0 is the oldest
+const traceEvent_t *traceGetEvent(uint16_t index)
+{
+    if (index >= traceCount) {
+        return NULL;
+    }
+    return &traceBuffer[(traceHead - traceCount + index) & TRACE_BUFFER_MASK];
+}
+
+#endif // USE_TRACE
@@ -0,0 +1,76 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Timeline of scheduler and driver activity for diagnosing rare overruns.
+// Events go to a circular buffer in FAST_RAM, an overrun trigger freezes it
+// half a buffer later so the events around the overrun are kept. Read over
+// MSP_TRACE, src/utils/trace_to_perfetto.py converts the download to a
+// Chrome trace file. Not part of any default build, enable with
+// EXTRA_FLAGS=-DUSE_TRACE.
+
+#define TRACE_BUFFER_EVENTS     512     // power of two
+#define TRACE_MSP_CHUNK_EVENTS  30      // events per MSP_TRACE reply, fits an MSP v1 frame
+
+typedef enum {
+    TRACE_TASK_START = 0,       // id: task
+    TRACE_TASK_END,             // id: task
+    TRACE_ISR_ENTER,            // id: irqLoadSource_e
+    TRACE_ISR_EXIT,             // id: irqLoadSource_e
+    TRACE_DMA_COMPLETE,         // id: DMA descriptor index
+    TRACE_RX_FRAME,
+    TRACE_GYRO_SAMPLE,
+    TRACE_TRIGGER,              // id: traceTrigger_e, arg: task
+} traceEventType_e;
+
+typedef enum {
+    TRACE_TRIGGER_MANUAL = 0,
+    TRACE_TRIGGER_LOOP_OVERRUN, // a realtime task ran more than one period late
+    TRACE_TRIGGER_TASK_BUDGET,  // a task ran longer than its execution budget
+} traceTrigger_e;
+
+typedef enum {
+    TRACE_STATE_RUNNING = 0,
+    TRACE_STATE_TRIGGERED,      // recording the events after the trigger
+    TRACE_STATE_FROZEN,
+} traceState_e;
+
+typedef struct traceEvent_s {
+    uint32_t cycles;            // cycle counter when the event was recorded
+    uint8_t type;
+    uint8_t id;
+    uint16_t arg;
+} traceEvent_t;
+
+#ifdef USE_TRACE
+uint32_t traceRecord(traceEventType_e type, uint8_t id, uint16_t arg);
+void traceTrigger(traceTrigger_e reason, uint16_t arg);
+void traceRearm(void);
+traceState_e traceGetState(void);
+uint16_t traceGetEventCount(void);
+const traceEvent_t *traceGetEvent(uint16_t index);
+
+#define TRACE_EVENT(type, id, arg) traceRecord(type, id, arg)
+#else
+#define TRACE_EVENT(type, id, arg) do {} while (0)
+#endif
@@ -36,7 +36,10 @@ bool cliMode = false;
 
 #include "blackbox/blackbox.h"
 
+#include "build/benchmark.h"
 #include "build/build_config.h"
+#include "build/clock_test.h"
+#include "build/crash_log.h"
 #include "build/debug.h"
 #include "build/version.h"
 
@@ -75,6 +78,7 @@ bool cliMode = false;
 #include "drivers/inverter.h"
 #include "drivers/io.h"
 #include "drivers/io_impl.h"
+#include "drivers/irq_load.h"
 #include "drivers/light_led.h"
 #include "drivers/motor.h"
 #include "drivers/rangefinder/rangefinder_hcsr04.h"
@@ -83,6 +87,7 @@ bool cliMode = false;
 #include "drivers/sensor.h"
 #include "drivers/serial.h"
 #include "drivers/serial_escserial.h"
+#include "drivers/serial_uart.h"
 #include "drivers/sound_beeper.h"
 #include "drivers/stack_check.h"
 #include "drivers/system.h"
@@ -97,6 +102,7 @@ bool cliMode = false;
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
 #include "fc/core.h"
+#include "fc/init.h"
 #include "fc/rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
@@ -182,7 +188,12 @@ static serialPort_t *cliPort = NULL;
 // Space required to set array parameters
 #define CLI_IN_BUFFER_SIZE 256
 #endif
+#ifdef STM32F1
 #define CLI_OUT_BUFFER_SIZE 64
+#else
+// The output is only flushed when the buffer is full or a command has completed
+#define CLI_OUT_BUFFER_SIZE 256
+#endif
 
 static bufWriter_t *cliWriter = NULL;
 static uint8_t cliWriteBuffer[sizeof(*cliWriter) + CLI_OUT_BUFFER_SIZE];
@@ -202,6 +213,13 @@ static uint32_t featureMaskCopy;
 #ifdef USE_CLI_BATCH
 static bool commandBatchActive = false;
 static bool commandBatchError = false;
+// pins, timers and dma options changed in the batch, checked for conflicts once at 'batch end'
+#if defined(USE_RESOURCE_MGMT)
+#define BATCH_RESOURCE_SLOT_COUNT 256
+static uint8_t commandBatchResourceSet[BATCH_RESOURCE_SLOT_COUNT / 8];
+static bool commandBatchResourceChanged = false;
+#endif
+static bool commandBatchTimerDmaChanged = false;
 #endif
 
 #if defined(USE_BOARD_INFO)
@@ -316,7 +334,6 @@ static void cliPrint(const char *str)
         while (*str) {
             bufWriterAppend(cliWriter, *str++);
         }
-        cliWriterFlush();
     }
 }
 
@@ -350,7 +367,6 @@ static void cliPrintfva(const char *format, va_list va)
 {
     if (cliWriter) {
         tfp_format(cliWriter, cliPutp, format, va);
-        cliWriterFlush();
     }
 }
 
@@ -375,6 +391,31 @@ static void cliWrite(uint8_t ch)
     }
 }
 
+// Numbers are formatted directly instead of through tfp_format(), a dump prints thousands of them
+static void cliPrintUnsigned(uint32_t value)
+{
+    char digits[10];
+    unsigned count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    while (count) {
+        cliWrite(digits[--count]);
+    }
+}
+
+static void cliPrintInt(int32_t value)
+{
+    if (value < 0) {
+        cliWrite('-');
+        cliPrintUnsigned(-(uint32_t)value);
+    } else {
+        cliPrintUnsigned(value);
+    }
+}
+
 static bool cliDefaultPrintLinef(dumpFlags_t dumpMask, bool equalsDefault, const char *format, ...)
 {
     if ((dumpMask & SHOW_DEFAULTS) && !equalsDefault) {
@@ -463,32 +504,32 @@ static void printValuePointer(const clivalue_t *var, const void *valuePointer, b
             default:
             case VAR_UINT8:
                 // uint8_t array
-                cliPrintf("%d", ((uint8_t *)valuePointer)[i]);
+                cliPrintUnsigned(((uint8_t *)valuePointer)[i]);
                 break;
 
             case VAR_INT8:
                 // int8_t array
-                cliPrintf("%d", ((int8_t *)valuePointer)[i]);
+                cliPrintInt(((int8_t *)valuePointer)[i]);
                 break;
 
             case VAR_UINT16:
                 // uin16_t array
-                cliPrintf("%d", ((uint16_t *)valuePointer)[i]);
+                cliPrintUnsigned(((uint16_t *)valuePointer)[i]);
                 break;
 
             case VAR_INT16:
                 // int16_t array
-                cliPrintf("%d", ((int16_t *)valuePointer)[i]);
+                cliPrintInt(((int16_t *)valuePointer)[i]);
                 break;
 
             case VAR_UINT32:
                 // uin32_t array
-                cliPrintf("%u", ((uint32_t *)valuePointer)[i]);
+                cliPrintUnsigned(((uint32_t *)valuePointer)[i]);
                 break;
             }
 
             if (i < var->config.array.length - 1) {
-                cliPrint(",");
+                cliWrite(',');
             }
         }
     } else {
@@ -521,7 +562,7 @@ static void printValuePointer(const clivalue_t *var, const void *valuePointer, b
         switch (var->type & VALUE_MODE_MASK) {
         case MODE_DIRECT:
             if ((var->type & VALUE_TYPE_MASK) == VAR_UINT32) {
-                cliPrintf("%u", (uint32_t)value);
+                cliPrintUnsigned((uint32_t)value);
                 if ((uint32_t)value > var->config.u32Max) {
                     valueIsCorrupted = true;
                 } else if (full) {
@@ -532,7 +573,7 @@ static void printValuePointer(const clivalue_t *var, const void *valuePointer, b
                 int max;
                 getMinMax(var, &min, &max);
 
-                cliPrintf("%d", value);
+                cliPrintInt(value);
                 if ((value < min) || (value > max)) {
                     valueIsCorrupted = true;
                 } else if (full) {
@@ -549,13 +590,13 @@ static void printValuePointer(const clivalue_t *var, const void *valuePointer, b
             break;
         case MODE_BITSET:
             if (value & 1 << var->config.bitpos) {
-                cliPrintf("ON");
+                cliPrint("ON");
             } else {
-                cliPrintf("OFF");
+                cliPrint("OFF");
             }
             break;
         case MODE_STRING:
-            cliPrintf("%s", (strlen((char *)valuePointer) == 0) ? "-" : (char *)valuePointer);
+            cliPrint((strlen((char *)valuePointer) == 0) ? "-" : (char *)valuePointer);
             break;
         }
 
@@ -734,19 +775,22 @@ static const char *dumpPgValue(const clivalue_t *value, dumpFlags_t dumpMask, co
     }
 #endif
 
-    const char *format = "set %s = ";
-    const char *defaultFormat = "#set %s = ";
     const int valueOffset = getValueOffset(value);
     const bool equalsDefault = valuePtrEqualsDefault(value, pg->copy + valueOffset, pg->address + valueOffset);
 
     headingStr = cliPrintSectionHeading(dumpMask, !equalsDefault, headingStr);
     if (((dumpMask & DO_DIFF) == 0) || !equalsDefault) {
+        // "set <name> = <value>" lines are most of a dump, they are put together without tfp_format()
         if (dumpMask & SHOW_DEFAULTS && !equalsDefault) {
-            cliPrintf(defaultFormat, value->name);
+            cliPrint("#set ");
+            cliPrint(value->name);
+            cliPrint(" = ");
             printValuePointer(value, (uint8_t*)pg->address + valueOffset, false);
             cliPrintLinefeed();
         }
-        cliPrintf(format, value->name);
+        cliPrint("set ");
+        cliPrint(value->name);
+        cliPrint(" = ");
         printValuePointer(value, pg->copy + valueOffset, false);
         cliPrintLinefeed();
     }
@@ -759,7 +803,6 @@ static void dumpAllValues(uint16_t valueSection, dumpFlags_t dumpMask, const cha
 
     for (uint32_t i = 0; i < valueTableEntryCount; i++) {
         const clivalue_t *value = &valueTable[i];
-        cliWriterFlush();
         if ((value->type & VALUE_SECTION_MASK) == valueSection || ((valueSection == MASTER_VALUE) && (value->type & VALUE_SECTION_MASK) == HARDWARE_VALUE)) {
             headingStr = dumpPgValue(value, dumpMask, headingStr);
         }
@@ -1531,6 +1574,7 @@ static void cliSerialPassthrough(char *cmdline)
     }
 #endif
 
+    cliWriterFlush();
     serialPassthrough(ports[0].port, ports[1].port, NULL, NULL);
 }
 #endif
@@ -2376,6 +2420,24 @@ static void cliSdInfo(char *cmdline)
         break;
     }
     cliPrintLinefeed();
+
+    const afatfsWriteStats_t *writeStats = afatfs_getWriteStats();
+
+    cliPrintLinef("Cache: %d sectors, written=%u, streamed=%u, maxLatency=%uus",
+        afatfs_getCacheSectorCount(),
+        writeStats->sectorsWritten,
+        writeStats->streamedSectors,
+        writeStats->maxLatencyUs
+    );
+
+    cliPrint("Write latency:");
+    for (int bucket = 0; bucket < AFATFS_WRITE_LATENCY_BUCKET_COUNT - 1; bucket++) {
+        cliPrintf(" <%uus=%u", AFATFS_WRITE_LATENCY_BUCKET_LIMIT_US(bucket), writeStats->latencyHistogram[bucket]);
+    }
+    cliPrintLinef(" >=%uus=%u",
+        AFATFS_WRITE_LATENCY_BUCKET_LIMIT_US(AFATFS_WRITE_LATENCY_BUCKET_COUNT - 2),
+        writeStats->latencyHistogram[AFATFS_WRITE_LATENCY_BUCKET_COUNT - 1]
+    );
 }
 
 #endif
@@ -2409,6 +2471,13 @@ static void cliFlashInfo(char *cmdline)
             FLASH_PARTITION_SECTOR_COUNT(flashPartition) * layout->sectorSize,
             flashfsGetOffset()
     );
+
+    const uint32_t writeTimeUs = flashfsGetWriteTimeUs();
+    cliPrintLinef("FlashFS written=%u, writeTime=%ums, throughput=%ukB/s",
+            flashfsGetBytesWritten(),
+            writeTimeUs / 1000,
+            writeTimeUs ? (uint32_t)((uint64_t)flashfsGetBytesWritten() * 1000 / writeTimeUs) : 0
+    );
 #endif
 }
 
@@ -3544,6 +3613,7 @@ static void cliGpsPassthrough(char *cmdline)
 {
     UNUSED(cmdline);
 
+    cliWriterFlush();
     gpsEnablePassthrough(cliPort);
 }
 #endif
@@ -3794,7 +3864,6 @@ static void cliDshotProg(char *cmdline)
     char *pch = strtok_r(cmdline, " ", &saveptr);
     int pos = 0;
     int escIndex = 0;
-    bool firstCommand = true;
     while (pch != NULL) {
         switch (pos) {
         case 0:
@@ -3808,24 +3877,20 @@ static void cliDshotProg(char *cmdline)
             {
                 int command = atoi(pch);
                 if (command >= 0 && command < DSHOT_MIN_THROTTLE) {
-                    if (firstCommand) {
-                        // pwmDisableMotors();
-                        motorDisable();
+                    if (command != DSHOT_CMD_ESC_INFO) {
+                        // Queued and sent by the motor output of the following PID loops
+                        if (!dshotCommandWrite(escIndex, getMotorCount(), command, false)) {
+                            cliPrintErrorLinef("COMMAND QUEUE FULL.");
 
-                        if (command == DSHOT_CMD_ESC_INFO) {
-                            delay(5); // Wait for potential ESC telemetry transmission to finish
-                        } else {
-                            delay(1);
+                            return;
                         }
-
-                        firstCommand = false;
-                    }
-
-                    if (command != DSHOT_CMD_ESC_INFO) {
-                        dshotCommandWrite(escIndex, getMotorCount(), command, true);
                     } else {
 #if defined(USE_ESC_SENSOR) && defined(USE_ESC_SENSOR_INFO)
                         if (featureIsEnabled(FEATURE_ESC_SENSOR)) {
+                            // The info frame is read back here, so this command is sent synchronously
+                            motorDisable();
+                            delay(5); // Wait for potential ESC telemetry transmission to finish
+
                             if (escIndex != ALL_MOTORS) {
                                 executeEscInfoCommand(escIndex);
                             } else {
@@ -3833,6 +3898,8 @@ static void cliDshotProg(char *cmdline)
                                     executeEscInfoCommand(i);
                                 }
                             }
+
+                            motorEnable();
                         } else
 #endif
                         {
@@ -3853,8 +3920,6 @@ static void cliDshotProg(char *cmdline)
         pos++;
         pch = strtok_r(NULL, " ", &saveptr);
     }
-
-    motorEnable();
 }
 #endif // USE_DSHOT
 
@@ -3908,6 +3973,7 @@ static void cliEscPassthrough(char *cmdline)
         pch = strtok_r(NULL, " ", &saveptr);
     }
 
+    cliWriterFlush();
     if (!escEnablePassthrough(cliPort, &motorConfig()->dev, escIndex, mode)) {
         cliPrintErrorLinef("Error starting ESC connection");
     }
@@ -4123,17 +4189,32 @@ static void resetCommandBatch(void)
 {
     commandBatchActive = false;
     commandBatchError = false;
+#if defined(USE_RESOURCE_MGMT)
+    memset(commandBatchResourceSet, 0, sizeof(commandBatchResourceSet));
+    commandBatchResourceChanged = false;
+#endif
+    commandBatchTimerDmaChanged = false;
+}
+
+static void cliBatchCheckConflicts(void);
+
+static inline void cliBatchTimerDmaChanged(void)
+{
+    commandBatchTimerDmaChanged = commandBatchTimerDmaChanged || commandBatchActive;
 }
 
 static void cliBatch(char *cmdline)
 {
     if (strncasecmp(cmdline, "start", 5) == 0) {
         if (!commandBatchActive) {
+            resetCommandBatch();
             commandBatchActive = true;
-            commandBatchError = false;
         }
         cliPrintLine("Command batch started");
     } else if (strncasecmp(cmdline, "end", 3) == 0) {
+        if (commandBatchActive) {
+            cliBatchCheckConflicts();
+        }
         if (commandBatchActive && commandBatchError) {
             cliPrintCommandBatchWarning(NULL);
         } else {
@@ -4144,6 +4225,10 @@ static void cliBatch(char *cmdline)
         cliPrintErrorLinef("Invalid option");
     }
 }
+#else
+static inline void cliBatchTimerDmaChanged(void)
+{
+}
 #endif
 
 static bool prepareSave(void)
@@ -4227,9 +4312,136 @@ static bool isCustomDefaults(char *ptr)
     return strncmp(ptr, "# " FC_FIRMWARE_NAME, 12) == 0;
 }
 
+/*
+ * Custom defaults can be stored pre-parsed, as the changes they make to the parameter groups:
+ *
+ *   "BFCD"
+ *   uint16_t pgn, uint8_t version, uint16_t offset, uint8_t length, uint8_t data[length]
+ *   ...
+ *   uint16_t 0
+ *
+ * all little endian. The records are copied into the parameter groups instead of replaying the
+ * CLI text. The text may follow the terminator, it is replayed instead if any record does not
+ * match the parameter groups of this firmware and is what 'defaults show' prints.
+ * 'defaults export' generates the records from the text.
+ */
+#define CUSTOM_DEFAULTS_BLOB_MAGIC "BFCD"
+#define CUSTOM_DEFAULTS_BLOB_MAGIC_LENGTH 4
+#define CUSTOM_DEFAULTS_BLOB_RECORD_HEADER_SIZE 6
+#define CUSTOM_DEFAULTS_BLOB_RECORD_MAX_LENGTH 255
+
+static bool isCustomDefaultsBlob(const char *ptr)
+{
+    return memcmp(ptr, CUSTOM_DEFAULTS_BLOB_MAGIC, CUSTOM_DEFAULTS_BLOB_MAGIC_LENGTH) == 0;
+}
+
+// Walks the records of the blob at ptr and copies them into the parameter groups if apply is set.
+// Returns the end of the blob, or NULL if it is truncated. matches is cleared if a record does not
+// fit the parameter groups of this firmware.
+static char *processCustomDefaultsBlob(char *ptr, bool apply, bool *matches)
+{
+    ptr += CUSTOM_DEFAULTS_BLOB_MAGIC_LENGTH;
+    while (ptr + sizeof(pgn_t) <= customDefaultsEnd) {
+        const uint8_t *record = (const uint8_t *)ptr;
+        const pgn_t pgn = record[0] | record[1] << 8;
+        if (pgn == 0) {
+            return ptr + sizeof(pgn_t);
+        }
+        if (ptr + CUSTOM_DEFAULTS_BLOB_RECORD_HEADER_SIZE > customDefaultsEnd) {
+            break;
+        }
+        const uint8_t version = record[2];
+        const uint16_t offset = record[3] | record[4] << 8;
+        const uint8_t length = record[5];
+        if (ptr + CUSTOM_DEFAULTS_BLOB_RECORD_HEADER_SIZE + length > customDefaultsEnd) {
+            break;
+        }
+
+        const pgRegistry_t *pg = pgFind(pgn);
+        if (!pg || pgVersion(pg) != version || offset + length > pgSize(pg)) {
+            *matches = false;
+        } else if (apply) {
+            memcpy(pg->address + offset, record + CUSTOM_DEFAULTS_BLOB_RECORD_HEADER_SIZE, length);
+        }
+
+        ptr += CUSTOM_DEFAULTS_BLOB_RECORD_HEADER_SIZE + length;
+    }
+
+    return NULL;
+}
+
+// Returns the CLI text of the custom defaults, which follows the blob if there is one
+static char *getCustomDefaultsText(void)
+{
+    char *ptr = customDefaultsStart;
+    if (isCustomDefaultsBlob(ptr)) {
+        bool matches = true;
+        ptr = processCustomDefaultsBlob(ptr, false, &matches);
+    }
+
+    return ptr && isCustomDefaults(ptr) ? ptr : NULL;
+}
+
 bool hasCustomDefaults(void)
 {
-    return isCustomDefaults(customDefaultsStart);
+    return isCustomDefaultsBlob(customDefaultsStart) || isCustomDefaults(customDefaultsStart);
+}
+
+static void printCustomDefaultsBlobRecord(pgn_t pgn, uint8_t version, uint16_t offset, const uint8_t *data, uint8_t length)
+{
+    cliPrintf("%02x%02x%02x%02x%02x%02x", pgn & 0xff, pgn >> 8, version, offset & 0xff, offset >> 8, length);
+    for (unsigned i = 0; i < length; i++) {
+        cliPrintf("%02x", data[i]);
+    }
+    cliPrintLinefeed();
+}
+
+// Prints the changes the custom defaults text makes to the reset defaults as a blob in hex,
+// one record per line. Like 'defaults nosave' it leaves the custom defaults in place unsaved.
+static void cliExportCustomDefaults(void)
+{
+    if (!hasCustomDefaults()) {
+        cliPrintError("NO CUSTOM DEFAULTS FOUND");
+
+        return;
+    }
+
+    // the reset defaults go into the copies, the custom defaults are applied on top of them
+    resetConfig();
+    backupConfigs();
+    if (!cliProcessCustomDefaults()) {
+        configIsInCopy = false;
+        cliPrintError("NO CUSTOM DEFAULTS FOUND");
+
+        return;
+    }
+
+    cliPrintHashLine("custom defaults blob, convert with 'xxd -r -p'");
+    cliPrintLine("42464344");
+    PG_FOREACH(pg) {
+        const uint16_t size = pgSize(pg);
+        uint16_t offset = 0;
+        while (offset < size) {
+            if (pg->address[offset] == pg->copy[offset]) {
+                offset++;
+                continue;
+            }
+            // a run of equal bytes shorter than a record header is cheaper to keep in the record
+            uint16_t end = offset + 1;
+            uint16_t equalCount = 0;
+            while (end < size && end - offset < CUSTOM_DEFAULTS_BLOB_RECORD_MAX_LENGTH && equalCount < CUSTOM_DEFAULTS_BLOB_RECORD_HEADER_SIZE) {
+                equalCount = pg->address[end] == pg->copy[end] ? equalCount + 1 : 0;
+                end++;
+            }
+            end -= equalCount;
+            printCustomDefaultsBlobRecord(pgN(pg), pgVersion(pg), offset, pg->address + offset, end - offset);
+            offset = end;
+        }
+    }
+    cliPrintLine("0000");
+
+    // the copies are scratch from here on
+    configIsInCopy = false;
 }
 #endif
 
@@ -4252,8 +4464,8 @@ static void cliDefaults(char *cmdline)
     } else if (strncasecmp(cmdline, "bare", 4) == 0) {
         useCustomDefaults = false;
     } else if (strncasecmp(cmdline, "show", 4) == 0) {
-        char *customDefaultsPtr = customDefaultsStart;
-        if (isCustomDefaults(customDefaultsPtr)) {
+        char *customDefaultsPtr = getCustomDefaultsText();
+        if (customDefaultsPtr) {
             while (*customDefaultsPtr && *customDefaultsPtr != 0xFF && customDefaultsPtr < customDefaultsEnd) {
                 if (*customDefaultsPtr != '\n') {
                     cliPrintf("%c", *customDefaultsPtr++);
@@ -4266,6 +4478,10 @@ static void cliDefaults(char *cmdline)
             cliPrintError("NO CUSTOM DEFAULTS FOUND");
         }
 
+        return;
+    } else if (strncasecmp(cmdline, "export", 6) == 0) {
+        cliExportCustomDefaults();
+
         return;
 #endif
     } else {
@@ -4377,8 +4593,10 @@ uint16_t cliGetSettingIndex(char *name, uint8_t length)
     for (uint32_t i = 0; i < valueTableEntryCount; i++) {
         const char *settingName = valueTable[i].name;
 
-        // ensure exact match when setting to prevent setting variables with shorter names
-        if (strncasecmp(name, settingName, strlen(settingName)) == 0 && length == strlen(settingName)) {
+        // ensure exact match when setting to prevent setting variables with shorter names,
+        // the first character rules out most of the table before the string comparison
+        if (tolower((unsigned char)name[0]) == tolower((unsigned char)settingName[0])
+            && strncasecmp(name, settingName, length) == 0 && settingName[length] == '\0') {
             return i;
         }
     }
@@ -4597,7 +4815,7 @@ static void cliStatus(char *cmdline)
         pllSource = SystemPLLSource();
     }
 
-    cliPrintf(" (%s%s)", SYSCLKSource[sysclkSource], (sysclkSource < 2) ? "" : PLLSource[pllSource]);
+    cliPrintf(" (%s%s), Flash=%dWS", SYSCLKSource[sysclkSource], (sysclkSource < 2) ? "" : PLLSource[pllSource], (int)(FLASH->ACR & FLASH_ACR_LATENCY));
 #endif
 
 #ifdef USE_ADC_INTERNAL
@@ -4612,7 +4830,8 @@ static void cliStatus(char *cmdline)
 
     cliPrintf("Stack size: %d, Stack address: 0x%x", stackTotalSize(), stackHighMem());
 #ifdef STACK_CHECK
-    cliPrintf(", Stack used: %d", stackUsedSize());
+    const stackIsrStats_t *isrStats = stackCheckGetIsrStats();
+    cliPrintf(", Stack used: %d, ISR depth: %d, ISR nesting: %d", stackUsedSize(), isrStats->maxDepth, isrStats->maxNesting);
 #endif
     cliPrintLinefeed();
 
@@ -4658,6 +4877,14 @@ static void cliStatus(char *cmdline)
 #endif
     cliPrintLinefeed();
 
+    // Boot time to the scheduler start, the stages marked with * were run after it by fast_boot
+    cliPrintf("Boot time: %dms", getBootSchedulerStartUs() / 1000);
+    for (int stage = 0; stage < BOOT_STAGE_COUNT; stage++) {
+        const bootStageTime_t *stageTime = getBootStageTime(stage);
+        cliPrintf(", %s %dms%s", stageTime->name, stageTime->durationUs / 1000, stageTime->deferred ? "*" : "");
+    }
+    cliPrintLinefeed();
+
     // Run status
 
     const int gyroRate = getTaskDeltaTime(TASK_GYROPID) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_GYROPID)));
@@ -4666,6 +4893,42 @@ static void cliStatus(char *cmdline)
     cliPrintLinef("CPU:%d%%, cycle time: %d, GYRO rate: %d, RX rate: %d, System rate: %d",
             constrain(averageSystemLoadPercent, 0, 100), getTaskDeltaTime(TASK_GYROPID), gyroRate, rxRate, systemRate);
 
+    // What is left of each gyro cycle after the gyro/PID task, the margin a faster clock buys
+    cfTaskInfo_t pidTaskInfo;
+    getTaskInfo(TASK_GYROPID, &pidTaskInfo);
+    if (pidTaskInfo.isEnabled && pidTaskInfo.averageExecutionTime && gyro.targetLooptime) {
+        cliPrintLinef("PID loop: avg %dus of %dus, headroom %d%%", pidTaskInfo.averageExecutionTime, gyro.targetLooptime,
+            100 - (int)(pidTaskInfo.averageExecutionTime * 100 / gyro.targetLooptime));
+    }
+
+#ifdef USE_IRQ_LOAD
+    cliPrint("IRQ load:");
+    for (irqLoadSource_e source = 0; source < IRQ_LOAD_COUNT; source++) {
+        const int load = irqLoadGetPermille(source);
+        cliPrintf("%s %s %d.%1d%%", source ? "," : "", irqLoadSourceName(source), load / 10, load % 10);
+    }
+    cliPrintLinefeed();
+#endif
+
+#ifdef USE_DSHOT
+    if (isMotorProtocolDshot()) {
+        const motorPwmProtocolTypes_e protocol = getMotorPwmProtocol();
+        bool bidirectional = false;
+#ifdef USE_DSHOT_TELEMETRY
+        bidirectional = useDshotTelemetry;
+#endif
+        const timeUs_t windowUs = dshotGetUpdateWindowUs(protocol, bidirectional);
+        cliPrintf("Motor protocol: %s%s, update window: %dus, margin: %dus", lookupTables[TABLE_MOTOR_PWM_PROTOCOL].values[protocol],
+            motorConfig()->dshotAutoRate ? " (auto)" : "", windowUs, (int)targetPidLooptime - (int)windowUs);
+#ifdef USE_DSHOT_TELEMETRY
+        if (bidirectional) {
+            cliPrintf(", skipped updates: %d", dshotTelemetryState.skippedUpdateCount);
+        }
+#endif
+        cliPrintLinefeed();
+    }
+#endif
+
     // Battery meter
 
     cliPrintLinef("Voltage: %d * 0.01V (%dS battery - %s)", getBatteryVoltage(), getBatteryCellCount(), getBatteryStateString());
@@ -4694,14 +4957,57 @@ static void cliStatus(char *cmdline)
 }
 
 #if defined(USE_TASK_STATISTICS)
+#if defined(USE_TASK_PROFILER)
+static void cliTasksProfile(const char *cmdline)
+{
+    const bool reset = strcasestr(cmdline, "reset") != NULL;
+
+    if (!reset) {
+        cliPrintLine("Task profile            exec/cycles: p50      p99      max    late/us: p50      p99      max");
+    }
+    for (cfTaskId_e taskId = 0; taskId < TASK_COUNT; taskId++) {
+        cfTaskInfo_t taskInfo;
+        getTaskInfo(taskId, &taskInfo);
+        if (!taskInfo.isEnabled) {
+            continue;
+        }
+        if (reset) {
+            schedulerResetTaskProfile(taskId);
+            continue;
+        }
+        const cfTaskProfile_t *profile = getTaskProfile(taskId);
+        cliPrintLinef("%02d - (%15s) %16u %8u %8u %16u %8u %8u", taskId, taskInfo.taskName,
+            taskProfileBucketUpperBound(taskProfilePercentileBucket(profile->executionCycles, 50), TASK_PROFILER_EXECUTION_SHIFT),
+            taskProfileBucketUpperBound(taskProfilePercentileBucket(profile->executionCycles, 99), TASK_PROFILER_EXECUTION_SHIFT),
+            taskProfileBucketUpperBound(taskProfilePercentileBucket(profile->executionCycles, 100), TASK_PROFILER_EXECUTION_SHIFT),
+            taskProfileBucketUpperBound(taskProfilePercentileBucket(profile->startLateness, 50), TASK_PROFILER_LATENESS_SHIFT),
+            taskProfileBucketUpperBound(taskProfilePercentileBucket(profile->startLateness, 99), TASK_PROFILER_LATENESS_SHIFT),
+            taskProfileBucketUpperBound(taskProfilePercentileBucket(profile->startLateness, 100), TASK_PROFILER_LATENESS_SHIFT));
+    }
+    if (reset) {
+        cliPrintLine("Task profiles reset");
+    }
+}
+#endif
+
 static void cliTasks(char *cmdline)
 {
+#if defined(USE_TASK_PROFILER)
+    if (strncasecmp(cmdline, "profile", 7) == 0) {
+        cliTasksProfile(cmdline + 7);
+        return;
+    }
+#else
     UNUSED(cmdline);
+#endif
     int maxLoadSum = 0;
     int averageLoadSum = 0;
+    const bool showDeferrals = systemConfig()->task_statistics && schedulerIsDeadlineAware();
 
 #ifndef MINIMAL_CLI
-    if (systemConfig()->task_statistics) {
+    if (showDeferrals) {
+        cliPrintLine("Task list             rate/hz  max/us  avg/us maxload avgload     total/ms budget/us deferred");
+    } else if (systemConfig()->task_statistics) {
         cliPrintLine("Task list             rate/hz  max/us  avg/us maxload avgload     total/ms");
     } else {
         cliPrintLine("Task list");
@@ -4732,7 +5038,12 @@ static void cliTasks(char *cmdline)
                 maxLoadSum += maxLoad;
                 averageLoadSum += averageLoad;
             }
-            if (systemConfig()->task_statistics) {
+            if (showDeferrals) {
+                cliPrintLinef("%6d %7d %7d %4d.%1d%% %4d.%1d%% %9d %9d %8d",
+                        taskFrequency, taskInfo.maxExecutionTime, taskInfo.averageExecutionTime,
+                        maxLoad/10, maxLoad%10, averageLoad/10, averageLoad%10, taskInfo.totalExecutionTime / 1000,
+                        taskInfo.executionBudget, taskInfo.deferredCount);
+            } else if (systemConfig()->task_statistics) {
                 cliPrintLinef("%6d %7d %7d %4d.%1d%% %4d.%1d%% %9d",
                         taskFrequency, taskInfo.maxExecutionTime, taskInfo.averageExecutionTime,
                         maxLoad/10, maxLoad%10, averageLoad/10, averageLoad%10, taskInfo.totalExecutionTime / 1000);
@@ -4751,6 +5062,103 @@ static void cliTasks(char *cmdline)
         getCheckFuncInfo(&checkFuncInfo);
         cliPrintLinef("RX Check Function %19d %7d %25d", checkFuncInfo.maxExecutionTime, checkFuncInfo.averageExecutionTime, checkFuncInfo.totalExecutionTime / 1000);
         cliPrintLinef("Total (excluding SERIAL) %25d.%1d%% %4d.%1d%%", maxLoadSum/10, maxLoadSum%10, averageLoadSum/10, averageLoadSum%10);
+#ifdef USE_IRQ_LOAD
+        // Task times above exclude interrupts, the PID loop run from PendSV is already listed as a task
+        int irqLoad = 0;
+        for (irqLoadSource_e source = 0; source < IRQ_LOAD_COUNT; source++) {
+            if (source != IRQ_LOAD_PID_LOOP) {
+                irqLoad += irqLoadGetPermille(source);
+            }
+        }
+        cliPrintLinef("Interrupts %47d.%1d%%", irqLoad/10, irqLoad%10);
+#endif
+    }
+}
+#endif
+
+#ifdef USE_BENCHMARK
+static void cliBench(char *cmdline)
+{
+    const bool runAll = isEmpty(cmdline);
+
+    cliPrintLinef("# %s %s at %dMHz, cycles per call", MCU_TYPE_NAME, targetName, SystemCoreClock / 1000000);
+    cliPrintLine("Kernel                 min     avg");
+    for (int i = 0; i < benchmarkCount(); i++) {
+        if (!runAll && strcasecmp(cmdline, benchmarkName(i))) {
+            continue;
+        }
+        benchmarkResult_t result;
+        benchmarkRun(i, &result);
+        cliPrintLinef("%-18s %7d %7d", benchmarkName(i), result.minCycles, result.avgCycles);
+    }
+}
+#endif
+
+#ifdef USE_OVERCLOCK
+static void cliClockTest(char *cmdline)
+{
+    UNUSED(cmdline);
+
+    clockTestResult_t result;
+
+    cliPrintLinef("Running %d rounds at %dMHz", CLOCK_TEST_ROUNDS, SystemCoreClock / 1000000);
+    const bool stable = clockTestRun(&result);
+    cliPrintLinef("%s: %d of %d rounds differed, %d to %d cycles per round", stable ? "Stable" : "UNSTABLE",
+        result.mismatches, result.rounds, result.minCycles, result.maxCycles);
+    if (!stable) {
+        cliPrintLine("Lower cpu_overclock and save");
+    }
+}
+#endif
+
+#ifdef USE_CRASH_LOG
+static void cliCrashLog(char *cmdline)
+{
+    if (strcasestr(cmdline, "clear")) {
+        crashLogClear();
+        cliPrintLine("Crash log cleared");
+        return;
+    }
+
+    cliPrintLinef("Boot %d, %d entries, oldest first", crashLogGetBoot(), crashLogGetCount());
+    for (int i = 0; i < crashLogGetCount(); i++) {
+        const crashLogEntry_t *entry = crashLogGetEntry(i);
+        const char *taskName = "";
+        if (entry->task < TASK_COUNT) {
+            cfTaskInfo_t taskInfo;
+            getTaskInfo(entry->task, &taskInfo);
+            taskName = taskInfo.taskName;
+        }
+        cliPrintf("boot %d %9dms %-13s %-10s x%-5d %s value %u", entry->boot, entry->timeMs, crashLogTypeName(entry->type),
+            taskName, entry->count, entry->flags & CRASH_LOG_FLAG_ARMED ? "ARMED" : "     ", entry->value);
+        if (entry->type == CRASH_LOG_HARD_FAULT) {
+            cliPrintf(" pc 0x%08x lr 0x%08x psr 0x%08x", entry->pc, entry->lr, entry->psr);
+        }
+        cliPrintLinefeed();
+    }
+}
+#endif
+
+#ifdef USE_SPI
+static void cliSpiInfo(char *cmdline)
+{
+    static const char * const priorityNames[SPI_PRIORITY_COUNT] = { "normal", "high" };
+    const bool reset = strcasestr(cmdline, "reset") != NULL;
+
+    for (SPIDevice device = 0; device < SPIDEV_COUNT; device++) {
+        spiBusStats_t stats;
+        if (!spiBusGetStats(device, &stats)) {
+            continue;
+        }
+        if (reset) {
+            spiBusResetStats(device);
+            continue;
+        }
+        cliPrintLinef("SPI%d: busy %d.%d%%, preemptions %u", SPI_DEV_TO_CFG(device), stats.busyPermille / 10, stats.busyPermille % 10, stats.preemptionCount);
+        for (int priority = SPI_PRIORITY_COUNT - 1; priority >= 0; priority--) {
+            cliPrintLinef("  %-6s sequences %u, wait avg %uus max %uus", priorityNames[priority],
+                stats.sequenceCount[priority], stats.averageWaitUs[priority], stats.maxWaitUs[priority]);
+        }
     }
 }
 #endif
@@ -5067,6 +5475,96 @@ static void resourceCheck(uint8_t resourceIndex, uint8_t index, ioTag_t newTag)
     }
 }
 
+#ifdef USE_CLI_BATCH
+// Inside a batch the pin is only marked as set, the batch end checks all of them in one pass
+static bool resourceCheckDeferred(uint8_t resourceIndex, uint8_t index)
+{
+    if (!commandBatchActive) {
+        return false;
+    }
+
+    unsigned slot = index;
+    for (unsigned r = 0; r < resourceIndex; r++) {
+        slot += MAX_RESOURCE_INDEX(resourceTable[r].maxIndex);
+    }
+    if (slot >= BATCH_RESOURCE_SLOT_COUNT) {
+        return false;
+    }
+
+    commandBatchResourceSet[slot / 8] |= BIT(slot % 8);
+    commandBatchResourceChanged = true;
+
+    return true;
+}
+
+static bool resourceSetInBatch(unsigned slot)
+{
+    return slot < BATCH_RESOURCE_SLOT_COUNT && (commandBatchResourceSet[slot / 8] & BIT(slot % 8));
+}
+
+// Same outcome as resourceCheck() for every pin set in the batch: a pin set for a resource clears
+// it from other indexes of that resource, a pin shared with another resource gets a note
+static void resourceCheckBatch(void)
+{
+    unsigned slot = 0;
+    for (unsigned r = 0; r < ARRAYLEN(resourceTable); r++) {
+        for (int i = 0; i < MAX_RESOURCE_INDEX(resourceTable[r].maxIndex); i++, slot++) {
+            const ioTag_t tag = *getIoTag(resourceTable[r], i);
+            if (!tag) {
+                continue;
+            }
+
+            unsigned otherSlot = slot + 1;
+            int otherIndex = i + 1;
+            for (unsigned r2 = r; r2 < ARRAYLEN(resourceTable); r2++, otherIndex = 0) {
+                for (; otherIndex < MAX_RESOURCE_INDEX(resourceTable[r2].maxIndex); otherIndex++, otherSlot++) {
+                    ioTag_t *otherTag = getIoTag(resourceTable[r2], otherIndex);
+                    const bool setInBatch = resourceSetInBatch(slot);
+                    const bool otherSetInBatch = resourceSetInBatch(otherSlot);
+                    if (*otherTag != tag || !(setInBatch || otherSetInBatch)) {
+                        continue;
+                    }
+
+                    if (r2 == r && setInBatch && otherSetInBatch) {
+                        cliPrintErrorLinef("%c%02d SET FOR BOTH %s %d AND %d", DEFIO_TAG_GPIOID(tag) + 'A', DEFIO_TAG_PIN(tag), ownerNames[resourceTable[r].owner], RESOURCE_INDEX(i), RESOURCE_INDEX(otherIndex));
+
+                        continue;
+                    }
+
+                    cliPrintf("NOTE: %c%02d assigned to ", DEFIO_TAG_GPIOID(tag) + 'A', DEFIO_TAG_PIN(tag));
+                    printResourceOwner(r, i);
+                    cliPrintf(" and ");
+                    printResourceOwner(r2, otherIndex);
+
+                    if (r2 == r) {
+                        // the one not set in this batch gives way, as it would have line by line
+                        cliPrintf(". ");
+                        if (setInBatch) {
+                            *otherTag = IO_TAG_NONE;
+                            printResourceOwner(r2, otherIndex);
+                        } else {
+                            *getIoTag(resourceTable[r], i) = IO_TAG_NONE;
+                            printResourceOwner(r, i);
+                        }
+                        cliPrintf(" disabled");
+                    }
+
+                    cliPrintLine(".");
+
+                    if (!*getIoTag(resourceTable[r], i)) {
+                        break;
+                    }
+                }
+
+                if (!*getIoTag(resourceTable[r], i)) {
+                    break;
+                }
+            }
+        }
+    }
+}
+#endif
+
 static bool strToPin(char *pch, ioTag_t *tag)
 {
     if (strcasecmp(pch, "NONE") == 0) {
@@ -5344,6 +5842,174 @@ static void printDmaopt(dumpFlags_t dumpMask, const char *headingStr)
 #endif
 }
 
+// How much DMA is worth to each user when `dma auto` has to leave some without
+#define DMA_PLAN_WEIGHT_GYRO_SPI    8
+#define DMA_PLAN_WEIGHT_MOTOR       6
+#define DMA_PLAN_WEIGHT_SPI         3
+#define DMA_PLAN_WEIGHT_LED_STRIP   3
+#define DMA_PLAN_WEIGHT_SDIO        3
+#define DMA_PLAN_WEIGHT_ADC         2
+#define DMA_PLAN_WEIGHT_UART        1
+
+static dmaoptEntry_t *dmaoptEntryByPeripheral(dmaPeripheral_e peripheral)
+{
+    for (unsigned i = 0; i < ARRAYLEN(dmaoptEntryTable); i++) {
+        if (dmaoptEntryTable[i].peripheral == peripheral) {
+            return &dmaoptEntryTable[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void dmaAutoSetPeripheral(dmaPeripheral_e peripheral, int index, dmaoptValue_t optval)
+{
+    dmaoptEntry_t *entry = dmaoptEntryByPeripheral(peripheral);
+    if (!entry) {
+        return;
+    }
+
+    const pgRegistry_t* pg = pgFind(entry->pgn);
+    void *currentConfig = isWritingConfigToCopy() ? pg->copy : pg->address;
+    dmaoptValue_t *optaddr = (dmaoptValue_t *)((uint8_t *)currentConfig + entry->stride * index + entry->offset);
+
+    char optvalString[DMA_OPT_STRING_BUFSIZE];
+    optToString(optval, optvalString);
+    char orgvalString[DMA_OPT_STRING_BUFSIZE];
+    optToString(*optaddr, orgvalString);
+
+    if (*optaddr != optval) {
+        *optaddr = optval;
+        cliBatchTimerDmaChanged();
+        cliPrintLinef("# dma %s %d: changed from %s to %s", entry->device, DMA_OPT_UI_INDEX(index), orgvalString, optvalString);
+    } else {
+        cliPrintLinef("# dma %s %d: no change: %s", entry->device, DMA_OPT_UI_INDEX(index), orgvalString);
+    }
+}
+
+#if defined(USE_TIMER_MGMT)
+static void dmaAutoSetTimer(ioTag_t ioTag, dmaoptValue_t optval)
+{
+    timerIOConfig_t *timerIoConfig = timerIoConfigByTag(ioTag);
+
+    char optvalString[DMA_OPT_STRING_BUFSIZE];
+    optToString(optval, optvalString);
+    char orgvalString[DMA_OPT_STRING_BUFSIZE];
+    optToString(timerIoConfig->dmaopt, orgvalString);
+
+    if (timerIoConfig->dmaopt != optval) {
+        timerIoConfig->dmaopt = optval;
+        cliBatchTimerDmaChanged();
+        cliPrintLinef("# dma pin %c%02d: changed from %s to %s", IO_GPIOPortIdxByTag(ioTag) + 'A', IO_GPIOPinIdxByTag(ioTag), orgvalString, optvalString);
+    } else {
+        cliPrintLinef("# dma %c%02d: no change: %s", IO_GPIOPortIdxByTag(ioTag) + 'A', IO_GPIOPinIdxByTag(ioTag), orgvalString);
+    }
+}
+
+static unsigned dmaAutoAddTimer(dmaPlanRequest_t *requests, unsigned count, ioTag_t ioTag, uint8_t weight)
+{
+    const timerHardware_t *timer = timerGetByTag(ioTag);
+
+    // only pins in the timer configuration have a dmaopt to set
+    if (count < DMA_PLAN_MAX_REQUESTS && timer && timerIoConfigByTag(ioTag)) {
+        requests[count++] = (dmaPlanRequest_t) { .timer = timer, .weight = weight };
+    }
+
+    return count;
+}
+#endif
+
+static unsigned dmaAutoAddPeripheral(dmaPlanRequest_t *requests, unsigned count, dmaPeripheral_e peripheral, int index, uint8_t weight)
+{
+    if (count < DMA_PLAN_MAX_REQUESTS) {
+        requests[count++] = (dmaPlanRequest_t) { .peripheral = peripheral, .index = index, .spiPair = peripheral == DMA_PERIPH_SPI_TX, .weight = weight };
+    }
+
+    return count;
+}
+
+// Assigns streams to everything enabled that can use DMA, so no two of them share a stream
+static void cliDmaAuto(void)
+{
+    dmaPlanRequest_t requests[DMA_PLAN_MAX_REQUESTS];
+    unsigned count = 0;
+
+#if defined(USE_SPI) && defined(USE_SPI_DMA)
+    for (int device = 0; device < SPIDEV_COUNT; device++) {
+        if (spiPinConfig(device)->ioTagSck) {
+            const bool gyroBus = SPI_CFG_TO_DEV(gyroDeviceConfig(0)->spiBus) == device;
+            count = dmaAutoAddPeripheral(requests, count, DMA_PERIPH_SPI_TX, device, gyroBus ? DMA_PLAN_WEIGHT_GYRO_SPI : DMA_PLAN_WEIGHT_SPI);
+        }
+    }
+#endif
+
+#if defined(USE_TIMER_MGMT) && defined(USE_DSHOT)
+    const motorDevConfig_t *motorDevConfig = &motorConfig()->dev;
+    bool timerDshot = motorDevConfig->motorPwmProtocol >= PWM_TYPE_DSHOT150 && motorDevConfig->motorPwmProtocol < PWM_TYPE_MAX;
+#ifdef USE_DSHOT_BITBANG
+    // bitbanged dshot takes the streams it needs itself
+    timerDshot = timerDshot && !isDshotBitbangActive(motorDevConfig);
+#endif
+    for (int i = 0; timerDshot && i < MAX_SUPPORTED_MOTORS; i++) {
+        if (motorDevConfig->ioTags[i]) {
+            count = dmaAutoAddTimer(requests, count, motorDevConfig->ioTags[i], DMA_PLAN_WEIGHT_MOTOR);
+        }
+    }
+#endif
+
+#if defined(USE_TIMER_MGMT) && defined(USE_LED_STRIP)
+    if (featureIsEnabled(FEATURE_LED_STRIP) && ledStripConfig()->ioTag) {
+        count = dmaAutoAddTimer(requests, count, ledStripConfig()->ioTag, DMA_PLAN_WEIGHT_LED_STRIP);
+    }
+#endif
+
+#if defined(USE_SDCARD_SDIO) && !defined(STM32H7)
+    if (sdcardConfig()->mode == SDCARD_MODE_SDIO) {
+        count = dmaAutoAddPeripheral(requests, count, DMA_PERIPH_SDIO, 0, DMA_PLAN_WEIGHT_SDIO);
+    }
+#endif
+
+#ifdef USE_ADC
+    if (adcConfig()->device) {
+        count = dmaAutoAddPeripheral(requests, count, DMA_PERIPH_ADC, ADC_CFG_TO_DEV(adcConfig()->device), DMA_PLAN_WEIGHT_ADC);
+    }
+#endif
+
+#ifdef USE_UART
+    for (int i = 0; i < SERIAL_PORT_COUNT; i++) {
+        const serialPortConfig_t *portConfig = &serialConfig()->portConfigs[i];
+        const int device = SERIAL_PORT_IDENTIFIER_TO_UARTDEV(portConfig->identifier);
+        if (portConfig->functionMask && portConfig->identifier <= SERIAL_PORT_USART8 && device < UARTDEV_CONFIG_MAX) {
+            count = dmaAutoAddPeripheral(requests, count, DMA_PERIPH_UART_RX, device, DMA_PLAN_WEIGHT_UART);
+            count = dmaAutoAddPeripheral(requests, count, DMA_PERIPH_UART_TX, device, DMA_PLAN_WEIGHT_UART);
+        }
+    }
+#endif
+
+    dmaPlan(requests, count);
+
+    unsigned served = 0;
+    for (unsigned i = 0; i < count; i++) {
+        const dmaPlanRequest_t *request = &requests[i];
+        if (request->opt != DMA_OPT_UNUSED) {
+            served++;
+        }
+
+#if defined(USE_TIMER_MGMT)
+        if (request->timer) {
+            dmaAutoSetTimer(request->timer->tag, request->opt);
+            continue;
+        }
+#endif
+        dmaAutoSetPeripheral(request->peripheral, request->index, request->opt);
+        if (request->spiPair) {
+            dmaAutoSetPeripheral(DMA_PERIPH_SPI_RX, request->index, request->rxOpt);
+        }
+    }
+
+    cliPrintLinef("# %d of %d DMA users assigned a stream, save to keep", served, count);
+}
+
 static void cliDmaopt(char *cmdline)
 {
     char *pch = NULL;
@@ -5358,6 +6024,10 @@ static void cliDmaopt(char *cmdline)
     } else if (strcasecmp(pch, "list") == 0) {
         cliPrintErrorLinef("NOT IMPLEMENTED YET");
 
+        return;
+    } else if (strcasecmp(pch, "auto") == 0) {
+        cliDmaAuto();
+
         return;
     }
 
@@ -5472,6 +6142,7 @@ static void cliDmaopt(char *cmdline)
         optToString(orgval, orgvalString);
 
         if (optval != orgval) {
+            cliBatchTimerDmaChanged();
             if (entry) {
                 *optaddr = optval;
 
@@ -5770,6 +6441,7 @@ static void cliTimer(char *cmdline)
         if (timerIndex == oldTimerIndex) {
             cliPrintLinef("# timer %c%02d: no change: %s", IO_GPIOPortIdxByTag(ioTag) + 'A', IO_GPIOPinIdxByTag(ioTag), orgvalString);
         } else {
+            cliBatchTimerDmaChanged();
             cliPrintLinef("# timer %c%02d: changed from %s to %s", IO_GPIOPortIdxByTag(ioTag) + 'A', IO_GPIOPinIdxByTag(ioTag), orgvalString, optvalString);
         }
 
@@ -5865,7 +6537,12 @@ static void cliResource(char *cmdline)
             } else {
                 ioRec_t *rec = IO_Rec(IOGetByTag(*tag));
                 if (rec) {
-                    resourceCheck(resourceIndex, index, *tag);
+#ifdef USE_CLI_BATCH
+                    if (!resourceCheckDeferred(resourceIndex, index))
+#endif
+                    {
+                        resourceCheck(resourceIndex, index, *tag);
+                    }
 #ifdef MINIMAL_CLI
                     cliPrintLinef(" %c%02d set", IO_GPIOPortIdx(rec) + 'A', IO_GPIOPinIdx(rec));
 #else
@@ -5883,6 +6560,114 @@ static void cliResource(char *cmdline)
 }
 #endif
 
+#ifdef USE_CLI_BATCH
+#if defined(USE_DMA_SPEC)
+typedef struct dmaBatchUser_s {
+    const dmaResource_t *ref;
+    const char *device;
+    uint8_t index;
+    ioTag_t ioTag;
+} dmaBatchUser_t;
+
+static void printDmaBatchUser(const dmaBatchUser_t *user)
+{
+    if (user->ioTag) {
+        cliPrintf("pin %c%02d", IO_GPIOPortIdxByTag(user->ioTag) + 'A', IO_GPIOPinIdxByTag(user->ioTag));
+    } else {
+        cliPrintf("%s %d", user->device, DMA_OPT_UI_INDEX(user->index));
+    }
+}
+
+static void dmaCheckBatch(void)
+{
+    dmaBatchUser_t users[DMA_PLAN_MAX_REQUESTS];
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < ARRAYLEN(dmaoptEntryTable); i++) {
+        const dmaoptEntry_t *entry = &dmaoptEntryTable[i];
+        const pgRegistry_t* pg = pgFind(entry->pgn);
+        const void *currentConfig = isWritingConfigToCopy() ? pg->copy : pg->address;
+        for (int index = 0; index < entry->maxIndex && count < ARRAYLEN(users); index++) {
+            const dmaoptValue_t optval = *(const dmaoptValue_t *)((const uint8_t *)currentConfig + entry->stride * index + entry->offset);
+            const dmaChannelSpec_t *dmaChannelSpec = optval == DMA_OPT_UNUSED ? NULL : dmaGetChannelSpecByPeripheral(entry->peripheral, index, optval);
+            if (dmaChannelSpec) {
+                users[count++] = (dmaBatchUser_t) { .ref = dmaChannelSpec->ref, .device = entry->device, .index = index };
+            }
+        }
+    }
+
+#if defined(USE_TIMER_MGMT)
+    for (unsigned i = 0; i < MAX_TIMER_PINMAP_COUNT && count < ARRAYLEN(users); i++) {
+        const timerIOConfig_t *config = timerIOConfig(i);
+        if (!config->ioTag || config->dmaopt == DMA_OPT_UNUSED) {
+            continue;
+        }
+        const timerHardware_t *timer = timerGetByTagAndIndex(config->ioTag, config->index);
+        const dmaChannelSpec_t *dmaChannelSpec = timer ? dmaGetChannelSpecByTimerValue(timer->tim, timer->channel, config->dmaopt) : NULL;
+        if (dmaChannelSpec) {
+            users[count++] = (dmaBatchUser_t) { .ref = dmaChannelSpec->ref, .ioTag = config->ioTag };
+        }
+    }
+#endif
+
+    for (unsigned i = 0; i < count; i++) {
+        for (unsigned j = i + 1; j < count; j++) {
+            if (users[i].ref == users[j].ref) {
+                cliPrintf("NOTE: ");
+                printDmaBatchUser(&users[i]);
+                cliPrintf(" and ");
+                printDmaBatchUser(&users[j]);
+                cliPrintLine(" use the same DMA stream.");
+            }
+        }
+    }
+}
+#endif
+
+#if defined(USE_TIMER_MGMT)
+static void timerCheckBatch(void)
+{
+    for (unsigned i = 0; i < MAX_TIMER_PINMAP_COUNT; i++) {
+        const timerIOConfig_t *config = timerIOConfig(i);
+        const timerHardware_t *timer = config->ioTag ? timerGetByTagAndIndex(config->ioTag, config->index) : NULL;
+        if (!timer) {
+            continue;
+        }
+
+        for (unsigned j = i + 1; j < MAX_TIMER_PINMAP_COUNT; j++) {
+            const timerIOConfig_t *otherConfig = timerIOConfig(j);
+            const timerHardware_t *otherTimer = otherConfig->ioTag ? timerGetByTagAndIndex(otherConfig->ioTag, otherConfig->index) : NULL;
+            if (otherTimer && otherTimer->tim == timer->tim && otherTimer->channel == timer->channel) {
+                cliPrintLinef("NOTE: %c%02d and %c%02d use the same channel TIM%d CH%d.",
+                    IO_GPIOPortIdxByTag(config->ioTag) + 'A', IO_GPIOPinIdxByTag(config->ioTag),
+                    IO_GPIOPortIdxByTag(otherConfig->ioTag) + 'A', IO_GPIOPinIdxByTag(otherConfig->ioTag),
+                    timerGetTIMNumber(timer->tim), CC_INDEX_FROM_CHANNEL(timer->channel) + 1);
+            }
+        }
+    }
+}
+#endif
+
+// Runs the conflict checks the commands of the batch skipped, once for all of its lines
+static void cliBatchCheckConflicts(void)
+{
+#if defined(USE_RESOURCE_MGMT)
+    if (commandBatchResourceChanged) {
+        resourceCheckBatch();
+    }
+#endif
+
+    if (commandBatchTimerDmaChanged) {
+#if defined(USE_TIMER_MGMT)
+        timerCheckBatch();
+#endif
+#if defined(USE_DMA_SPEC)
+        dmaCheckBatch();
+#endif
+    }
+}
+#endif
+
 #ifdef USE_DSHOT_TELEMETRY
 static void cliDshotTelemetryInfo(char *cmdline)
 {
@@ -6230,6 +7015,9 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("beeper", "enable/disable beeper for a condition", "list\r\n"
         "\t<->[name]", cliBeeper),
 #endif // USE_BEEPER
+#ifdef USE_BENCHMARK
+    CLI_COMMAND_DEF("bench", "show cycles per call of the hot kernels", "[<kernel>]", cliBench),
+#endif
 #if defined(USE_RX_SPI) || defined (USE_SERIALRX_SRXL2)
     CLI_COMMAND_DEF("bind_rx", "initiate binding for RX SPI or SRXL2", NULL, cliRxBind),
 #endif
@@ -6241,11 +7029,17 @@ const clicmd_t cmdTable[] = {
 #if defined(USE_BOARD_INFO)
     CLI_COMMAND_DEF("board_name", "get / set the name of the board model", "[board name]", cliBoardName),
 #endif
+#ifdef USE_OVERCLOCK
+    CLI_COMMAND_DEF("clocktest", "check the core is stable at the current clock", NULL, cliClockTest),
+#endif
 #ifdef USE_LED_STRIP_STATUS_MODE
         CLI_COMMAND_DEF("color", "configure colors", NULL, cliColor),
 #endif
+#ifdef USE_CRASH_LOG
+    CLI_COMMAND_DEF("crashlog", "show the overruns and faults kept across reboots", "[clear]", cliCrashLog),
+#endif
 #if defined(USE_CUSTOM_DEFAULTS)
-    CLI_COMMAND_DEF("defaults", "reset to defaults and reboot", "[nosave|bare|show]", cliDefaults),
+    CLI_COMMAND_DEF("defaults", "reset to defaults and reboot", "[nosave|bare|show|export]", cliDefaults),
 #else
     CLI_COMMAND_DEF("defaults", "reset to defaults and reboot", "[nosave|show]", cliDefaults),
 #endif
@@ -6254,7 +7048,7 @@ const clicmd_t cmdTable[] = {
 
 #ifdef USE_DMA
 #ifdef USE_DMA_SPEC
-    CLI_COMMAND_DEF("dma", "show/set DMA assignments", "<> | <device> <index> list | <device> <index> [<option>|none] | list | show", cliDma),
+    CLI_COMMAND_DEF("dma", "show/set DMA assignments", "<> | <device> <index> list | <device> <index> [<option>|none] | list | show | auto", cliDma),
 #else
     CLI_COMMAND_DEF("dma", "show DMA assignments", "show", cliDma),
 #endif
@@ -6354,11 +7148,18 @@ const clicmd_t cmdTable[] = {
         "\treset\r\n"
         "\tload <mixer>\r\n"
         "\treverse <servo> <source> r|n", cliServoMix),
+#endif
+#ifdef USE_SPI
+    CLI_COMMAND_DEF("spi_info", "show SPI bus usage and wait times", "[reset]", cliSpiInfo),
 #endif
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
 #if defined(USE_TASK_STATISTICS)
+#if defined(USE_TASK_PROFILER)
+    CLI_COMMAND_DEF("tasks", "show task stats", "[profile [reset]]", cliTasks),
+#else
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
 #endif
+#endif
 #ifdef USE_TIMER_MGMT
     CLI_COMMAND_DEF("timer", "show/set timers", "<> | <pin> list | <pin> [af<alternate function>|none|<option(deprecated)>] | list | show", cliTimer),
 #endif
@@ -6393,6 +7194,39 @@ static void cliHelp(char *cmdline)
     }
 }
 
+// cmdTable is sorted, so the command named by the first word of the line is found with a binary search
+static const clicmd_t *findCommand(char *cmdline, char **options)
+{
+    char *end = cmdline;
+    while (*end && !isspace((unsigned)*end)) {
+        end++;
+    }
+    const size_t length = end - cmdline;
+
+    size_t low = 0;
+    size_t high = ARRAYLEN(cmdTable);
+    while (low < high) {
+        const size_t mid = (low + high) / 2;
+        const char *name = cmdTable[mid].name;
+        int result = strncasecmp(cmdline, name, length);
+        if (result == 0 && name[length]) {
+            // the word is a prefix of the name, it sorts before it
+            result = -1;
+        }
+
+        if (result == 0) {
+            *options = *end ? skipSpace(end + 1) : end;
+            return &cmdTable[mid];
+        } else if (result < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    return NULL;
+}
+
 static void processCharacter(const char c)
 {
     if (bufferIndex && (c == '\n' || c == '\r')) {
@@ -6421,14 +7255,9 @@ static void processCharacter(const char c)
         if (bufferIndex > 0) {
             cliBuffer[bufferIndex] = 0; // null terminate
 
-            const clicmd_t *cmd;
             char *options;
-            for (cmd = cmdTable; cmd < cmdTable + ARRAYLEN(cmdTable); cmd++) {
-                if ((options = checkCommand(cliBuffer, cmd->name))) {
-                    break;
-                }
-            }
-            if (cmd < cmdTable + ARRAYLEN(cmdTable)) {
+            const clicmd_t *cmd = findCommand(cliBuffer, &options);
+            if (cmd) {
                 cmd->func(options);
             } else {
                 cliPrintError("UNKNOWN COMMAND, TRY 'HELP'");
@@ -6524,13 +7353,30 @@ void cliProcess(void)
 
         processCharacterInteractive(c);
     }
+
+    // the output of a command is buffered, send what is left of it
+    cliWriterFlush();
 }
 
 #if defined(USE_CUSTOM_DEFAULTS)
 bool cliProcessCustomDefaults(void)
 {
-    char *customDefaultsPtr = customDefaultsStart;
-    if (processingCustomDefaults || !isCustomDefaults(customDefaultsPtr)) {
+    if (processingCustomDefaults) {
+        return false;
+    }
+
+    if (isCustomDefaultsBlob(customDefaultsStart)) {
+        bool matches = true;
+        if (processCustomDefaultsBlob(customDefaultsStart, false, &matches) && matches) {
+            processCustomDefaultsBlob(customDefaultsStart, true, &matches);
+            systemConfigMutable()->configurationState = CONFIGURATION_STATE_DEFAULTS_CUSTOM;
+
+            return true;
+        }
+    }
+
+    char *customDefaultsPtr = getCustomDefaultsText();
+    if (!customDefaultsPtr) {
         return false;
     }
 
@@ -6565,7 +7411,10 @@ void cliEnter(serialPort_t *serialPort)
     cliMode = true;
     cliPort = serialPort;
     setPrintfSerialPort(cliPort);
-    cliWriter = bufWriterInit(cliWriteBuffer, sizeof(cliWriteBuffer), (bufWrite_t)serialWriteBufShim, serialPort);
+    // Flush in chunks that fit in the transmit buffer of the port, so that a flush does not wait for the port
+    const uint32_t txBufferFree = serialTxBytesFree(serialPort);
+    const uint32_t writerSize = txBufferFree ? MIN(sizeof(cliWriteBuffer), sizeof(bufWriter_t) + txBufferFree) : sizeof(cliWriteBuffer);
+    cliWriter = bufWriterInit(cliWriteBuffer, writerSize, (bufWrite_t)serialWriteBufShim, serialPort);
 
     schedulerSetCalulateTaskStatistics(systemConfig()->task_statistics);
 
@@ -40,6 +40,7 @@ typedef enum {
 #ifdef USE_BLACKBOX
     TABLE_BLACKBOX_DEVICE,
     TABLE_BLACKBOX_MODE,
+    TABLE_BLACKBOX_COMPRESSION,
 #endif
     TABLE_CURRENT_METER,
     TABLE_VOLTAGE_METER,
@@ -115,6 +116,8 @@ typedef enum {
 #endif // USE_RC_SMOOTHING_FILTER
 #ifdef USE_GYRO_DATA_ANALYSE
     TABLE_DYNAMIC_FILTER_RANGE,
+    TABLE_DYNAMIC_FILTER_WINDOW_SIZE,
+    TABLE_DYNAMIC_FILTER_LEARN,
 #endif // USE_GYRO_DATA_ANALYSE
 #ifdef USE_VTX_COMMON
     TABLE_VTX_LOW_POWER_DISARM,
@@ -247,6 +247,15 @@ static uint8_t cmsCursorAbsolute(displayPort_t *instance)
 
 uint8_t runtimeEntryFlags[CMS_MAX_ROWS] = { 0 };
 
+#define CMS_DRAW_BUFFER_LEN 12
+#define CMS_NUM_FIELD_LEN 5
+#define CMS_CURSOR_BLINK_DELAY_MS 500
+
+// Values written to each display row since the screen was last cleared. Polled entries and
+// entries flagged for redraw are only sent to the display when their text changed, which
+// matters for the telemetry displayports (CRSF, HoTT, SRXL) where every write costs frames.
+static char runtimeEntryValues[CMS_MAX_ROWS][CMS_DRAW_BUFFER_LEN + 1];
+
 static void cmsPageSelect(displayPort_t *instance, int8_t newpage)
 {
     currentCtx.page = (newpage + pageCount) % pageCount;
@@ -273,29 +282,13 @@ static void cmsPagePrev(displayPort_t *instance)
 
 static void cmsFormatFloat(int32_t value, char *floatString)
 {
-    uint8_t k;
-    // np. 3450
-
-    itoa(100000 + value, floatString, 10); // Create string from abs of integer value
-
-    // 103450
-
-    floatString[0] = floatString[1];
-    floatString[1] = floatString[2];
-    floatString[2] = '.';
+    // 3450 -> " 3.450", the value has three decimals and two integer digits
+    char *end = fixed2a(value, 3, 6, ' ', floatString);
 
-    // 03.450
-    // usuwam koncowe zera i kropke
-    // Keep the first decimal place
-    for (k = 5; k > 3; k--)
-        if (floatString[k] == '0' || floatString[k] == '.')
-            floatString[k] = 0;
-        else
-            break;
-
-    // oraz zero wiodonce
-    if (floatString[0] == '0')
-        floatString[0] = ' ';
+    // Strip the trailing zeros, keeping the first decimal place
+    while (end[-1] == '0' && end[-2] != '.') {
+        *--end = 0;
+    }
 }
 
 // CMS on OSD legacy was to use LEFT aligned values, not the RIGHT way ;-)
@@ -350,10 +343,25 @@ static void cmsPadToSize(char *buf, int size)
 #endif
 }
 
+static int cmsDrawRowValue(displayPort_t *pDisplay, uint8_t col, uint8_t row, const char *value)
+{
+    if (row < CMS_MAX_ROWS) {
+        if (strlen(value) > CMS_DRAW_BUFFER_LEN) {
+            // Too long to be cached, always written
+            runtimeEntryValues[row][0] = '\0';
+        } else if (strcmp(runtimeEntryValues[row], value) == 0) {
+            return 0;
+        } else {
+            strcpy(runtimeEntryValues[row], value);
+        }
+    }
+
+    return displayWrite(pDisplay, col, row, value);
+}
+
 static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row, uint8_t maxSize)
 {
     int colpos;
-    int cnt;
 
     cmsPadToSize(buff, maxSize);
 #ifdef CMS_OSD_RIGHT_ALIGNED_VALUES
@@ -361,16 +369,11 @@ static int cmsDrawMenuItemValue(displayPort_t *pDisplay, char *buff, uint8_t row
 #else
     colpos = smallScreen ? rightMenuColumn - maxSize : rightMenuColumn;
 #endif
-    cnt = displayWrite(pDisplay, colpos, row, buff);
-    return cnt;
+    return cmsDrawRowValue(pDisplay, colpos, row, buff);
 }
 
 static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t row, bool selectedRow, uint8_t *flags)
 {
-    #define CMS_DRAW_BUFFER_LEN 12
-    #define CMS_NUM_FIELD_LEN 5
-    #define CMS_CURSOR_BLINK_DELAY_MS 500
-
     char buff[CMS_DRAW_BUFFER_LEN +1]; // Make room for null terminator.
     int cnt = 0;
 
@@ -464,7 +467,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
     case OME_UINT8:
         if (IS_PRINTVALUE(*flags) && p->data) {
             OSD_UINT8_t *ptr = p->data;
-            itoa(*ptr->val, buff, 10);
+            i2aPadded(*ptr->val, 0, ' ', buff);
             cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(*flags);
         }
@@ -473,7 +476,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
     case OME_INT8:
         if (IS_PRINTVALUE(*flags) && p->data) {
             OSD_INT8_t *ptr = p->data;
-            itoa(*ptr->val, buff, 10);
+            i2aPadded(*ptr->val, 0, ' ', buff);
             cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(*flags);
         }
@@ -482,7 +485,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
     case OME_UINT16:
         if (IS_PRINTVALUE(*flags) && p->data) {
             OSD_UINT16_t *ptr = p->data;
-            itoa(*ptr->val, buff, 10);
+            i2aPadded(*ptr->val, 0, ' ', buff);
             cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(*flags);
         }
@@ -491,7 +494,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
     case OME_INT16:
         if (IS_PRINTVALUE(*flags) && p->data) {
             OSD_UINT16_t *ptr = p->data;
-            itoa(*ptr->val, buff, 10);
+            i2aPadded(*ptr->val, 0, ' ', buff);
             cnt = cmsDrawMenuItemValue(pDisplay, buff, row, CMS_NUM_FIELD_LEN);
             CLR_PRINTVALUE(*flags);
         }
@@ -509,7 +512,7 @@ static int cmsDrawMenuEntry(displayPort_t *pDisplay, const OSD_Entry *p, uint8_t
     case OME_Label:
         if (IS_PRINTVALUE(*flags) && p->data) {
             // A label with optional string, immediately following text
-            cnt = displayWrite(pDisplay, leftMenuColumn + 1 + (uint8_t)strlen(p->text), row, p->data);
+            cnt = cmsDrawRowValue(pDisplay, leftMenuColumn + 1 + (uint8_t)strlen(p->text), row, p->data);
             CLR_PRINTVALUE(*flags);
         }
         break;
@@ -562,6 +565,7 @@ static void cmsDrawMenu(displayPort_t *pDisplay, uint32_t currentTimeUs)
             SET_PRINTLABEL(runtimeEntryFlags[i]);
             SET_PRINTVALUE(runtimeEntryFlags[i]);
         }
+        memset(runtimeEntryValues, 0, sizeof(runtimeEntryValues));
         pDisplay->cleared = false;
     } else if (drawPolled) {
         for (p = pageTop, i = 0; (p <= pageTop + pageMaxRow); p++, i++) {
@@ -1236,6 +1240,7 @@ static void cmsUpdate(uint32_t currentTimeUs)
         }
 
         cmsDrawMenu(pCurrentDisplay, currentTimeUs);
+        displayDrawScreen(pCurrentDisplay);
 
         if (currentTimeMs > lastCmsHeartBeatMs + 500) {
             // Heart beat for external CMS display device @ 500msec
@@ -529,6 +529,9 @@ static long cmsx_menuGyro_onExit(const OSD_Entry *self)
     gyroConfigMutable()->gyro_soft_notch_cutoff_2 = gyroConfig_gyro_soft_notch_cutoff_2;
     gyroConfigMutable()->gyro_to_use = gyroConfig_gyro_to_use;
 
+    // apply the new filter settings right away, so that they can be tried out while hovering
+    gyroRetuneFilters();
+
     return 0;
 }
 
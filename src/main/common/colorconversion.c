@@ -27,11 +27,19 @@
 
 /*
  * Source below found here: http://www.kasperkamperman.com/blog/arduino/arduino-programming-hsb-to-rgb/
+ *
+ * The last conversion is kept, as the LEDs of a strip are mostly set in runs of the same colour.
  */
 
 rgbColor24bpp_t* hsvToRgb24(const hsvColor_t* c)
 {
     static rgbColor24bpp_t r;
+    static hsvColor_t last = { 0, 255, 0 }; // black, as r starts out
+
+    if (c->h == last.h && c->s == last.s && c->v == last.v) {
+        return &r;
+    }
+    last = *c;
 
     uint16_t val = c->v;
     uint16_t sat = 255 - c->s;
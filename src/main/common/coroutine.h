@@ -0,0 +1,97 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Stackless coroutines for multi step driver sequences, in the style of protothreads.
+ *
+ * A coroutine is a function that returns coroutineState_e and is stepped from the task of its driver.
+ * Every wait returns to the caller, and so to the scheduler, instead of blocking the main loop, and the
+ * next step resumes after the wait. The resume point is the only state kept, so:
+ * - local variables do not survive a wait, keep the state in static or context variables
+ * - the body must not wait from inside a switch statement of its own
+ *
+ *  static coroutine_t co;
+ *
+ *  static coroutineState_e deviceInitStep(timeUs_t currentTimeUs)
+ *  {
+ *      COROUTINE_BEGIN(&co);
+ *      sendReset();
+ *      COROUTINE_DELAY_US(&co, currentTimeUs, 10000);
+ *      sendRequest();
+ *      COROUTINE_WAIT_UNTIL_TIMEOUT(&co, responseReceived, currentTimeUs, 100000);
+ *      if (!responseReceived) {
+ *          COROUTINE_RESTART(&co);
+ *      }
+ *      COROUTINE_END(&co);
+ *  }
+ *
+ * A wait for a DMA transfer is a COROUTINE_WAIT_UNTIL() on the flag or state its completion interrupt sets.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/time.h"
+#include "common/utils.h"
+
+typedef enum {
+    COROUTINE_RUNNING = 0,      // waiting, step it again later
+    COROUTINE_DONE              // reached COROUTINE_END(), further steps return straight away
+} coroutineState_e;
+
+typedef struct coroutine_s {
+    uint16_t resumeLine;        // source line to resume at, 0 to start from the beginning
+    timeUs_t deadlineUs;        // end of the current delay or timeout
+} coroutine_t;
+
+#define COROUTINE_INIT(co) do { (co)->resumeLine = 0; } while (0)
+
+#define COROUTINE_BEGIN(co) switch ((co)->resumeLine) { case 0:
+
+#define COROUTINE_END(co) \
+    (co)->resumeLine = __LINE__; FALLTHROUGH; case __LINE__: ; } \
+    return COROUTINE_DONE
+
+// return to the caller and resume here on the next step
+#define COROUTINE_YIELD(co) \
+    do { (co)->resumeLine = __LINE__; return COROUTINE_RUNNING; case __LINE__: ; } while (0)
+
+// resume once cond is true, it is evaluated on every step
+#define COROUTINE_WAIT_UNTIL(co, cond) \
+    do { (co)->resumeLine = __LINE__; FALLTHROUGH; case __LINE__: if (!(cond)) { return COROUTINE_RUNNING; } } while (0)
+
+// currentTimeUs must be the time of the step, so that it is current each time the wait is evaluated
+#define COROUTINE_DELAY_US(co, currentTimeUs, delayUs) \
+    do { \
+        (co)->deadlineUs = (currentTimeUs) + (delayUs); \
+        COROUTINE_WAIT_UNTIL(co, cmpTimeUs((currentTimeUs), (co)->deadlineUs) >= 0); \
+    } while (0)
+
+// resume once cond is true or the timeout has elapsed, check cond again to tell which
+#define COROUTINE_WAIT_UNTIL_TIMEOUT(co, cond, currentTimeUs, timeoutUs) \
+    do { \
+        (co)->deadlineUs = (currentTimeUs) + (timeoutUs); \
+        COROUTINE_WAIT_UNTIL(co, (cond) || cmpTimeUs((currentTimeUs), (co)->deadlineUs) >= 0); \
+    } while (0)
+
+// start from the beginning on the next step
+#define COROUTINE_RESTART(co) \
+    do { (co)->resumeLine = 0; return COROUTINE_RUNNING; } while (0)
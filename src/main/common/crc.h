@@ -30,5 +30,9 @@ void crc16_ccitt_sbuf_append(struct sbuf_s *dst, uint8_t *start);
 uint8_t crc8_dvb_s2(uint8_t crc, unsigned char a);
 uint8_t crc8_dvb_s2_update(uint8_t crc, const void *data, uint32_t length);
 void crc8_dvb_s2_sbuf_append(struct sbuf_s *dst, uint8_t *start);
+uint8_t crc8_poly_0x07(uint8_t crc, unsigned char a);
+uint8_t crc8_poly_0x07_update(uint8_t crc, const void *data, uint32_t length);
+uint8_t crc8_poly_0x31(uint8_t crc, unsigned char a);
+uint8_t crc8_poly_0x31_update(uint8_t crc, const void *data, uint32_t length);
 uint8_t crc8_xor_update(uint8_t crc, const void *data, uint32_t length);
 void crc8_xor_sbuf_append(struct sbuf_s *dst, uint8_t *start);
@@ -203,6 +203,218 @@ FAST_CODE float biquadFilterApply(biquadFilter_t *filter, float input)
     return result;
 }
 
+// Three axis filters, filter the values in place
+
+void pt1Filter3Init(pt1Filter3_t *filter, float k)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        filter->state[axis] = 0.0f;
+    }
+    filter->k = k;
+}
+
+void pt1Filter3UpdateCutoff(pt1Filter3_t *filter, float k)
+{
+    filter->k = k;
+}
+
+FAST_CODE void pt1Filter3Apply(pt1Filter3_t *filter, float *values)
+{
+    const float k = filter->k;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        filter->state[axis] = filter->state[axis] + k * (values[axis] - filter->state[axis]);
+        values[axis] = filter->state[axis];
+    }
+}
+
+static void biquadFilter3SetCoefficients(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter_t coefficients;
+    biquadFilterInit(&coefficients, filterFreq, refreshRate, Q, filterType);
+
+    filter->b0 = coefficients.b0;
+    filter->b1 = coefficients.b1;
+    filter->b2 = coefficients.b2;
+    filter->a1 = coefficients.a1;
+    filter->a2 = coefficients.a2;
+}
+
+void biquadFilter3InitLPF(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate)
+{
+    biquadFilter3Init(filter, filterFreq, refreshRate, BIQUAD_Q, FILTER_LPF);
+}
+
+void biquadFilter3Init(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter3SetCoefficients(filter, filterFreq, refreshRate, Q, filterType);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        filter->x1[axis] = filter->x2[axis] = 0;
+        filter->y1[axis] = filter->y2[axis] = 0;
+    }
+}
+
+// the state is kept, only use with biquadFilter3ApplyDF1
+FAST_CODE void biquadFilter3UpdateLPF(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate)
+{
+    biquadFilter3SetCoefficients(filter, filterFreq, refreshRate, BIQUAD_Q, FILTER_LPF);
+}
+
+FAST_CODE void biquadFilter3ApplyDF1(biquadFilter3_t *filter, float *values)
+{
+    const float b0 = filter->b0, b1 = filter->b1, b2 = filter->b2, a1 = filter->a1, a2 = filter->a2;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float input = values[axis];
+        const float result = b0 * input + b1 * filter->x1[axis] + b2 * filter->x2[axis] - a1 * filter->y1[axis] - a2 * filter->y2[axis];
+
+        filter->x2[axis] = filter->x1[axis];
+        filter->x1[axis] = input;
+
+        filter->y2[axis] = filter->y1[axis];
+        filter->y1[axis] = result;
+
+        values[axis] = result;
+    }
+}
+
+// direct form 2 transposed, x1 and x2 hold the two delay elements
+FAST_CODE void biquadFilter3Apply(biquadFilter3_t *filter, float *values)
+{
+    const float b0 = filter->b0, b1 = filter->b1, b2 = filter->b2, a1 = filter->a1, a2 = filter->a2;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float input = values[axis];
+        const float result = b0 * input + filter->x1[axis];
+        filter->x1[axis] = b1 * input - a1 * result + filter->x2[axis];
+        filter->x2[axis] = b2 * input - a2 * result;
+
+        values[axis] = result;
+    }
+}
+
+// Coefficient crossfades, move the coefficients of a running three axis filter to new ones over
+// a number of steps while keeping its state, so that retuning does not make the output jump.
+// A biquad moved in small steps stays stable, the stable coefficients are a convex set.
+// The step functions are called once per sample and return false when there is nothing to do.
+
+void pt1Filter3CrossfadeStart(pt1Crossfade_t *crossfade, float k, uint16_t steps)
+{
+    crossfade->k = k;
+    crossfade->steps = steps;
+}
+
+FAST_CODE bool pt1Filter3CrossfadeStep(pt1Filter3_t *filter, pt1Crossfade_t *crossfade)
+{
+    if (crossfade->steps == 0) {
+        return false;
+    }
+
+    // the last step lands on the target exactly
+    filter->k += (crossfade->k - filter->k) / crossfade->steps;
+    crossfade->steps--;
+
+    return true;
+}
+
+void biquadFilter3CrossfadeStart(biquadCrossfade_t *crossfade, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType, uint16_t steps)
+{
+    biquadFilter_t coefficients;
+    biquadFilterInit(&coefficients, filterFreq, refreshRate, Q, filterType);
+
+    crossfade->b0 = coefficients.b0;
+    crossfade->b1 = coefficients.b1;
+    crossfade->b2 = coefficients.b2;
+    crossfade->a1 = coefficients.a1;
+    crossfade->a2 = coefficients.a2;
+    crossfade->steps = steps;
+}
+
+void biquadFilter3CrossfadeStartLPF(biquadCrossfade_t *crossfade, float filterFreq, uint32_t refreshRate, uint16_t steps)
+{
+    biquadFilter3CrossfadeStart(crossfade, filterFreq, refreshRate, BIQUAD_Q, FILTER_LPF, steps);
+}
+
+FAST_CODE bool biquadFilter3CrossfadeStep(biquadFilter3_t *filter, biquadCrossfade_t *crossfade)
+{
+    if (crossfade->steps == 0) {
+        return false;
+    }
+
+    const float fraction = 1.0f / crossfade->steps;
+    filter->b0 += (crossfade->b0 - filter->b0) * fraction;
+    filter->b1 += (crossfade->b1 - filter->b1) * fraction;
+    filter->b2 += (crossfade->b2 - filter->b2) * fraction;
+    filter->a1 += (crossfade->a1 - filter->a1) * fraction;
+    filter->a2 += (crossfade->a2 - filter->a2) * fraction;
+    crossfade->steps--;
+
+    return true;
+}
+
+// Precomputed lowpass coefficients, loading them into a running filter costs no trigonometry
+
+// same coefficients as biquadFilter3InitLPF()
+void biquadLowpassCoeffsInit(biquadLowpassCoeffs_t *coeffs, float filterFreq, uint32_t refreshRate)
+{
+    biquadFilter_t coefficients;
+    biquadFilterInitLPF(&coefficients, filterFreq, refreshRate);
+
+    coeffs->b0 = coefficients.b0;
+    coeffs->a1 = coefficients.a1;
+    coeffs->a2 = coefficients.a2;
+}
+
+// the state is kept, only use with biquadFilter3ApplyDF1
+FAST_CODE void biquadFilter3SetLowpassCoeffs(biquadFilter3_t *filter, const biquadLowpassCoeffs_t *coeffs)
+{
+    filter->b0 = coeffs->b0;
+    filter->b1 = 2.0f * coeffs->b0;
+    filter->b2 = coeffs->b0;
+    filter->a1 = coeffs->a1;
+    filter->a2 = coeffs->a2;
+}
+
+// Notch bank, the coefficients can be shared by several delay lines (one per axis)
+
+// same response as biquadFilterInit() with FILTER_NOTCH, the state is kept so it can be used while running
+FAST_CODE void biquadNotchCoeffsUpdate(biquadNotchCoeffs_t *coeffs, float filterFreq, uint32_t refreshRate, float Q)
+{
+    const float omega = 2.0f * M_PI_FLOAT * filterFreq * refreshRate * 0.000001f;
+    const float sn = sin_approx(omega);
+    const float cs = cos_approx(omega);
+    const float alpha = sn / (2.0f * Q);
+    const float a0r = 1.0f / (1.0f + alpha);
+
+    coeffs->b0 = a0r;
+    coeffs->a1 = -2.0f * cs * a0r;
+    coeffs->a2 = (1.0f - alpha) * a0r;
+}
+
+void biquadNotchStateInit(biquadNotchState_t *state, int count)
+{
+    for (int i = 0; i <= count; i++) {
+        state[i].z1 = state[i].z2 = 0;
+    }
+}
+
+// direct form 1, as the coefficients change while running, y = b0 * (x + x2) + a1 * (x1 - y1) - a2 * y2
+FAST_CODE float biquadNotchBankApply(const biquadNotchCoeffs_t *coeffs, biquadNotchState_t *state, int count, float input)
+{
+    for (int i = 0; i < count; i++) {
+        const float result = coeffs[i].b0 * (input + state[i].z2) + coeffs[i].a1 * (state[i].z1 - state[i + 1].z1) - coeffs[i].a2 * state[i + 1].z2;
+
+        state[i].z2 = state[i].z1;
+        state[i].z1 = input;
+
+        input = result;
+    }
+    state[count].z2 = state[count].z1;
+    state[count].z1 = input;
+
+    return input;
+}
+
 void laggedMovingAverageInit(laggedMovingAverage_t *filter, uint16_t windowSize, float *buf)
 {
     filter->movingWindowIndex = 0;
@@ -225,3 +437,107 @@ FAST_CODE float laggedMovingAverageUpdate(laggedMovingAverage_t *filter, float i
     const uint16_t denom = filter->primed ? filter->windowSize : filter->movingWindowIndex;
     return filter->movingSum  / denom;
 }
+
+void intMovingAverageInit(intMovingAverage_t *filter, uint8_t windowSize, uint16_t *buf)
+{
+    memset(buf, 0, windowSize * sizeof(*buf));
+    filter->movingSum = 0;
+    filter->movingWindowIndex = 0;
+    filter->windowSize = windowSize;
+    filter->buf = buf;
+}
+
+uint16_t intMovingAverageUpdate(intMovingAverage_t *filter, uint16_t input)
+{
+    filter->movingSum += input - filter->buf[filter->movingWindowIndex];
+    filter->buf[filter->movingWindowIndex] = input;
+
+    if (++filter->movingWindowIndex == filter->windowSize) {
+        filter->movingWindowIndex = 0;
+    }
+
+    return filter->movingSum / filter->windowSize;
+}
+
+// Fixed point filters, for MCUs without an FPU where every float operation is a library call.
+// The coefficients are computed in float by the float filters, only the per sample work is integer.
+
+#define FILTER_FIXED_PT1_SHIFT    31
+#define FILTER_FIXED_BIQUAD_SHIFT 30
+
+static int32_t pt1FilterFixedGain(float k)
+{
+    const float gain = k * (float)(1UL << FILTER_FIXED_PT1_SHIFT);
+    return gain >= (float)INT32_MAX ? INT32_MAX : (int32_t)lrintf(gain);
+}
+
+static int32_t biquadFilterFixedCoeff(float coeff)
+{
+    const float scaled = coeff * (float)(1UL << FILTER_FIXED_BIQUAD_SHIFT);
+    return (int32_t)lrintf(constrainf(scaled, (float)INT32_MIN, (float)INT32_MAX));
+}
+
+void pt1FilterFixedInit(pt1FilterFixed_t *filter, float k)
+{
+    filter->state = 0;
+    filter->k = pt1FilterFixedGain(k);
+}
+
+void pt1FilterFixedUpdateCutoff(pt1FilterFixed_t *filter, float k)
+{
+    filter->k = pt1FilterFixedGain(k);
+}
+
+// the state stops moving once the correction rounds to zero, so it settles within 0.5 / k LSB of a constant input
+FAST_CODE int32_t pt1FilterFixedApply(pt1FilterFixed_t *filter, int32_t input)
+{
+    const int64_t delta = (int64_t)(input - filter->state) * filter->k;
+    filter->state += (int32_t)((delta + (1LL << (FILTER_FIXED_PT1_SHIFT - 1))) >> FILTER_FIXED_PT1_SHIFT);
+    return filter->state;
+}
+
+void biquadFilterFixedInitLPF(biquadFilterFixed_t *filter, float filterFreq, uint32_t refreshRate)
+{
+    biquadFilterFixedInit(filter, filterFreq, refreshRate, BIQUAD_Q, FILTER_LPF);
+}
+
+void biquadFilterFixedInit(biquadFilterFixed_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilterFixedUpdate(filter, filterFreq, refreshRate, Q, filterType);
+
+    filter->x1 = filter->x2 = 0;
+    filter->y1 = filter->y2 = 0;
+}
+
+// updates the coefficients and keeps the state, the filter is direct form 1 so it may be retuned while running
+void biquadFilterFixedUpdate(biquadFilterFixed_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter_t coeffs;
+    biquadFilterInit(&coeffs, filterFreq, refreshRate, Q, filterType);
+
+    filter->b0 = biquadFilterFixedCoeff(coeffs.b0);
+    filter->b1 = biquadFilterFixedCoeff(coeffs.b1);
+    filter->b2 = biquadFilterFixedCoeff(coeffs.b2);
+    filter->a1 = biquadFilterFixedCoeff(coeffs.a1);
+    filter->a2 = biquadFilterFixedCoeff(coeffs.a2);
+}
+
+// direct form 1, the five products are accumulated in 64 bits (SMLAL on Cortex-M3) and rounded once
+FAST_CODE int32_t biquadFilterFixedApply(biquadFilterFixed_t *filter, int32_t input)
+{
+    int64_t acc = (int64_t)filter->b0 * input;
+    acc += (int64_t)filter->b1 * filter->x1;
+    acc += (int64_t)filter->b2 * filter->x2;
+    acc -= (int64_t)filter->a1 * filter->y1;
+    acc -= (int64_t)filter->a2 * filter->y2;
+
+    const int32_t result = (int32_t)((acc + (1LL << (FILTER_FIXED_BIQUAD_SHIFT - 1))) >> FILTER_FIXED_BIQUAD_SHIFT);
+
+    filter->x2 = filter->x1;
+    filter->x1 = input;
+
+    filter->y2 = filter->y1;
+    filter->y1 = result;
+
+    return result;
+}
@@ -21,6 +21,8 @@
 #pragma once
 #include <stdbool.h>
 
+#include "common/axis.h"
+
 struct filter_s;
 typedef struct filter_s filter_t;
 
@@ -41,6 +43,61 @@ typedef struct biquadFilter_s {
     float x1, x2, y1, y2;
 } biquadFilter_t;
 
+/* three axis versions, the axes share the coefficients and their state is kept side by side
+ * so that the three independent computations can be interleaved */
+typedef struct pt1Filter3_s {
+    float state[XYZ_AXIS_COUNT];
+    float k;
+} pt1Filter3_t;
+
+typedef struct biquadFilter3_s {
+    float b0, b1, b2, a1, a2;
+    float x1[XYZ_AXIS_COUNT], x2[XYZ_AXIS_COUNT];
+    float y1[XYZ_AXIS_COUNT], y2[XYZ_AXIS_COUNT];
+} biquadFilter3_t;
+
+/* target coefficients of a crossfade and the number of steps left to reach them */
+typedef struct pt1Crossfade_s {
+    float k;
+    uint16_t steps;
+} pt1Crossfade_t;
+
+typedef struct biquadCrossfade_s {
+    float b0, b1, b2, a1, a2;
+    uint16_t steps;
+} biquadCrossfade_t;
+
+/* bank of notches applied in series, see biquadNotchBankApply().
+ * A notch has b0 == b2 and b1 == a1, so three coefficients describe it. */
+typedef struct biquadNotchCoeffs_s {
+    float b0, a1, a2;
+} biquadNotchCoeffs_t;
+
+/* delay line of a bank, entry 0 holds the last two inputs and entry n + 1 the last two outputs of notch n,
+ * which are also the inputs of notch n + 1. A bank of count notches needs count + 1 entries. */
+typedef struct biquadNotchState_s {
+    float z1, z2;
+} biquadNotchState_t;
+
+/* coefficients of a lowpass, which has b1 == 2 * b0 and b2 == b0 so three coefficients describe it.
+ * Precomputed for filters that retune at run time, see biquadFilter3SetLowpassCoeffs(). */
+typedef struct biquadLowpassCoeffs_s {
+    float b0, a1, a2;
+} biquadLowpassCoeffs_t;
+
+/* fixed point versions for MCUs without an FPU. The samples are plain int32_t in a scale of the
+ * caller's choosing, Q16.16 for example, and must stay within +-2^30 so differences do not overflow.
+ * The pt1 gain is Q31 and the biquad coefficients are Q2.30, products are accumulated in 64 bits. */
+typedef struct pt1FilterFixed_s {
+    int32_t state;
+    int32_t k;
+} pt1FilterFixed_t;
+
+typedef struct biquadFilterFixed_s {
+    int32_t b0, b1, b2, a1, a2;
+    int32_t x1, x2, y1, y2;
+} biquadFilterFixed_t;
+
 typedef struct laggedMovingAverage_s {
     uint16_t movingWindowIndex;
     uint16_t windowSize;
@@ -49,6 +106,14 @@ typedef struct laggedMovingAverage_s {
     bool primed;
 } laggedMovingAverage_t;
 
+// Integer running sum over a window that starts out filled with zeros
+typedef struct intMovingAverage_s {
+    uint32_t movingSum;
+    uint16_t *buf;
+    uint8_t movingWindowIndex;
+    uint8_t windowSize;
+} intMovingAverage_t;
+
 typedef enum {
     FILTER_PT1 = 0,
     FILTER_BIQUAD,
@@ -76,6 +141,9 @@ float filterGetNotchQ(float centerFreq, float cutoffFreq);
 void laggedMovingAverageInit(laggedMovingAverage_t *filter, uint16_t windowSize, float *buf);
 float laggedMovingAverageUpdate(laggedMovingAverage_t *filter, float input);
 
+void intMovingAverageInit(intMovingAverage_t *filter, uint8_t windowSize, uint16_t *buf);
+uint16_t intMovingAverageUpdate(intMovingAverage_t *filter, uint16_t input);
+
 float pt1FilterGain(float f_cut, float dT);
 void pt1FilterInit(pt1Filter_t *filter, float k);
 void pt1FilterUpdateCutoff(pt1Filter_t *filter, float k);
@@ -83,3 +151,35 @@ float pt1FilterApply(pt1Filter_t *filter, float input);
 
 void slewFilterInit(slewFilter_t *filter, float slewLimit, float threshold);
 float slewFilterApply(slewFilter_t *filter, float input);
+
+void pt1Filter3Init(pt1Filter3_t *filter, float k);
+void pt1Filter3UpdateCutoff(pt1Filter3_t *filter, float k);
+void pt1Filter3Apply(pt1Filter3_t *filter, float *values);
+
+void biquadFilter3InitLPF(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate);
+void biquadFilter3Init(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+void biquadFilter3UpdateLPF(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate);
+void biquadFilter3ApplyDF1(biquadFilter3_t *filter, float *values);
+void biquadFilter3Apply(biquadFilter3_t *filter, float *values);
+
+void pt1Filter3CrossfadeStart(pt1Crossfade_t *crossfade, float k, uint16_t steps);
+bool pt1Filter3CrossfadeStep(pt1Filter3_t *filter, pt1Crossfade_t *crossfade);
+void biquadFilter3CrossfadeStart(biquadCrossfade_t *crossfade, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType, uint16_t steps);
+void biquadFilter3CrossfadeStartLPF(biquadCrossfade_t *crossfade, float filterFreq, uint32_t refreshRate, uint16_t steps);
+bool biquadFilter3CrossfadeStep(biquadFilter3_t *filter, biquadCrossfade_t *crossfade);
+
+void biquadLowpassCoeffsInit(biquadLowpassCoeffs_t *coeffs, float filterFreq, uint32_t refreshRate);
+void biquadFilter3SetLowpassCoeffs(biquadFilter3_t *filter, const biquadLowpassCoeffs_t *coeffs);
+
+void pt1FilterFixedInit(pt1FilterFixed_t *filter, float k);
+void pt1FilterFixedUpdateCutoff(pt1FilterFixed_t *filter, float k);
+int32_t pt1FilterFixedApply(pt1FilterFixed_t *filter, int32_t input);
+
+void biquadFilterFixedInitLPF(biquadFilterFixed_t *filter, float filterFreq, uint32_t refreshRate);
+void biquadFilterFixedInit(biquadFilterFixed_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+void biquadFilterFixedUpdate(biquadFilterFixed_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+int32_t biquadFilterFixedApply(biquadFilterFixed_t *filter, int32_t input);
+
+void biquadNotchCoeffsUpdate(biquadNotchCoeffs_t *coeffs, float filterFreq, uint32_t refreshRate, float Q);
+void biquadNotchStateInit(biquadNotchState_t *state, int count);
+float biquadNotchBankApply(const biquadNotchCoeffs_t *coeffs, biquadNotchState_t *state, int count, float input);
@@ -22,9 +22,13 @@
 #include <stdint.h>
 #include <ctype.h>
 #include <string.h>
+#include <math.h>
 
 #include "platform.h"
 
+#include "common/gps_conversion.h"
+#include "common/maths.h"
+
 #ifdef USE_GPS
 
 
@@ -68,4 +72,151 @@ uint32_t GPS_coord_to_degrees(const char* coordinateString)
     }
     return degress * 10000000UL + (minutes * 1000000UL + fractionalMinutes * 100UL) / 6;
 }
+
+void nmeaFieldReset(nmeaField_t *field)
+{
+    memset(field, 0, sizeof(*field));
+}
+
+void nmeaFieldAddChar(nmeaField_t *field, char c)
+{
+    if (field->length == 0) {
+        field->first = c;
+        if (c == '-') {
+            field->negative = true;
+        }
+    }
+    field->length++;
+    field->text = (field->text << 8) | (uint8_t)c;
+
+    if (c >= '0' && c <= '9') {
+        if (!field->decimal) {
+            if (field->integer >= 100000000UL) {
+                field->overflow = true;     // more than NMEA_FIELD_MAX_INTEGER_DIGITS digits
+            }
+            field->integer = field->integer * 10 + DIGIT_TO_VAL(c);
+        } else if (field->fractionDigits < NMEA_FIELD_MAX_FRACTION_DIGITS) {
+            field->fraction = field->fraction * 10 + DIGIT_TO_VAL(c);
+            field->fractionDigits++;
+        }
+    } else if (c == '.') {
+        field->decimal = true;
+    }
+}
+
+// The value * 10^decimals, further decimals are truncated
+int32_t nmeaFieldToFixed(const nmeaField_t *field, uint8_t decimals)
+{
+    if (field->overflow) {
+        return 0;
+    }
+
+    int32_t value = field->integer;
+    uint32_t fraction = field->fraction;
+    uint8_t fractionDigits = field->fractionDigits;
+    for (uint8_t i = 0; i < decimals; i++) {
+        value *= 10;
+        if (fractionDigits < decimals - i) {
+            fraction *= 10;
+        }
+    }
+    while (fractionDigits > decimals) {
+        fraction /= 10;
+        fractionDigits--;
+    }
+    value += fraction;
+
+    return field->negative ? -value : value;
+}
+
+// dddmm.mmmm to degrees * 10^7, as GPS_coord_to_degrees()
+uint32_t nmeaFieldToDegrees(const nmeaField_t *field)
+{
+    if (field->overflow) {
+        return 0;
+    }
+
+    const uint32_t degrees = field->integer / 100;
+    const uint32_t minutes = field->integer % 100;
+    uint32_t fractionalMinutes = field->fraction;
+    for (uint8_t i = field->fractionDigits; i < NMEA_FIELD_MAX_FRACTION_DIGITS; i++) {
+        fractionalMinutes *= 10;
+    }
+    return degrees * 10000000UL + (minutes * 1000000UL + fractionalMinutes * 100UL) / 6;
+}
+
+float gpsLongitudeScale(int32_t lat)
+{
+    const float rads = (fabsf((float)lat) / 10000000.0f) * 0.0174532925f;
+    return cos_approx(rads);
+}
+
+void gpsLocalOffset(int32_t fromLat, int32_t fromLon, int32_t toLat, int32_t toLon, float lonScale, gpsLocalOffset_t *offset)
+{
+    const int32_t dLat = toLat - fromLat;
+    int64_t dLon = (int64_t)toLon - fromLon;
+    // the short way across the antimeridian
+    if (dLon > 1800000000LL) {
+        dLon -= 3600000000LL;
+    } else if (dLon < -1800000000LL) {
+        dLon += 3600000000LL;
+    }
+
+    offset->northCm = (float)dLat * GPS_CM_PER_DEGREE_E7;
+    offset->eastCm = (float)dLon * lonScale * GPS_CM_PER_DEGREE_E7;
+}
+
+uint32_t gpsLocalDistanceCm(const gpsLocalOffset_t *offset)
+{
+    return sqrtf(sq(offset->northCm) + sq(offset->eastCm));
+}
+
+// Bearing of the offset from north, clockwise in degrees * 100, 0 to 35999
+int32_t gpsLocalBearing(const gpsLocalOffset_t *offset)
+{
+    int32_t bearing = lrintf(atan2_approx(offset->eastCm, offset->northCm) * (18000.0f / M_PIf));
+    if (bearing < 0) {
+        bearing += 36000;
+    }
+    return bearing % 36000;
+}
+
+// Parses "[-]ddd.ddddddd" straight to degrees * 10^7, float parsing keeps ~7 significant digits only
+int32_t gpsDegreesToE7(const char *degrees)
+{
+    bool negative = false;
+    int32_t value = 0;
+    uint8_t fractionDigits = 0;
+    bool decimal = false;
+
+    while (*degrees == ' ') {
+        degrees++;
+    }
+    if (*degrees == '-' || *degrees == '+') {
+        negative = *degrees == '-';
+        degrees++;
+    }
+    for (; *degrees; degrees++) {
+        if (*degrees == '.') {
+            decimal = true;
+        } else if (isdigit((unsigned char)*degrees)) {
+            if (!decimal) {
+                value = value * 10 + DIGIT_TO_VAL(*degrees);
+                if (value > 180) {
+                    return 0;
+                }
+            } else if (fractionDigits < 7) {
+                value = value * 10 + DIGIT_TO_VAL(*degrees);
+                fractionDigits++;
+            }
+        } else {
+            break;
+        }
+    }
+    for (; fractionDigits < 7; fractionDigits++) {
+        value *= 10;
+    }
+
+    return negative ? -value : value;
+}
 #endif
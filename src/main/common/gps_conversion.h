@@ -20,4 +20,47 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 uint32_t GPS_coord_to_degrees(const char* coordinateString);
+
+// Streaming decoder of a NMEA field, the value is accumulated as the characters arrive
+// so that the field does not need to be copied and scanned again when it ends.
+#define NMEA_FIELD_MAX_INTEGER_DIGITS 9
+#define NMEA_FIELD_MAX_FRACTION_DIGITS 4
+
+typedef struct nmeaField_s {
+    uint32_t integer;           // digits before the decimal point
+    uint16_t fraction;          // first NMEA_FIELD_MAX_FRACTION_DIGITS digits after the decimal point
+    uint8_t fractionDigits;
+    uint8_t length;
+    uint32_t text;              // last four characters, packed with the last one in the low byte
+    bool decimal;
+    bool negative;
+    bool overflow;
+    char first;
+} nmeaField_t;
+
+#define NMEA_ID(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+void nmeaFieldReset(nmeaField_t *field);
+void nmeaFieldAddChar(nmeaField_t *field, char c);
+int32_t nmeaFieldToFixed(const nmeaField_t *field, uint8_t decimals);
+uint32_t nmeaFieldToDegrees(const nmeaField_t *field);
+
+// Local tangent plane navigation, positions are in degrees * 10^7. The coordinate differences
+// are taken in integers before any float math, so centimetre resolution is kept anywhere on
+// earth without double precision. lonScale is cos(latitude), see gpsLongitudeScale().
+#define GPS_CM_PER_DEGREE_E7 1.113195f  // length of 10^-7 degree of latitude in cm
+
+typedef struct gpsLocalOffset_s {
+    float northCm;
+    float eastCm;
+} gpsLocalOffset_t;
+
+float gpsLongitudeScale(int32_t lat);
+void gpsLocalOffset(int32_t fromLat, int32_t fromLon, int32_t toLat, int32_t toLon, float lonScale, gpsLocalOffset_t *offset);
+uint32_t gpsLocalDistanceCm(const gpsLocalOffset_t *offset);
+int32_t gpsLocalBearing(const gpsLocalOffset_t *offset);
+int32_t gpsDegreesToE7(const char *degrees);
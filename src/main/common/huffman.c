@@ -28,80 +28,156 @@
 #include "huffman.h"
 
 
-int huffmanEncodeBuf(uint8_t *outBuf, int outBufLen, const uint8_t *inBuf, int inLen, const huffmanTable_t *huffmanTable)
+/*
+ * The codes are collected MSB first in a 32 bit accumulator and written out a 16 bit word at a time, instead of
+ * bit by bit. huffmanTable holds the codes MSB aligned in 16 bits, so a code is placed with a single shift.
+ */
+int huffmanEncodeBufStreaming(huffmanState_t *state, const uint8_t *inBuf, int inLen, const huffmanTable_t *huffmanTable)
 {
-    int ret = 0;
-
-    uint8_t *outByte = outBuf;
-    *outByte = 0;
-    uint8_t outBit = 0x80;
-
-    for (int ii = 0; ii < inLen; ++ii) {
-        const int huffCodeLen = huffmanTable[*inBuf].codeLen;
-        const uint16_t huffCode = huffmanTable[*inBuf].code;
-        ++inBuf;
-        uint16_t testBit = 0x8000;
+    uint8_t *outByte = state->outByte;
+    int bytesWritten = state->bytesWritten;
+    const int outBufLen = state->outBufLen;
+    const uint8_t savedOutByte = *outByte;
 
-        for (int jj = 0; jj < huffCodeLen; ++jj) {
-            if (huffCode & testBit) {
-                *outByte |= outBit;
-            }
-
-            testBit >>= 1;
-            outBit >>= 1;
-            if (outBit == 0) {
-                outBit = 0x80;
-                ++outByte;
-                *outByte = 0;
-                ++ret;
-            }
+    // continue from the bits already in the partly written byte
+    int bitCount = __builtin_clz(state->outBit) - 24;
+    uint32_t bits = bitCount ? (uint32_t)*outByte << 24 : 0;
 
-            if (ret >= outBufLen && ii < inLen - 1 && jj < huffCodeLen - 1) {
+    for (const uint8_t *pos = inBuf, *end = inBuf + inLen; pos < end; ++pos) {
+        const huffmanTable_t *entry = &huffmanTable[*pos];
+        bits |= (uint32_t)entry->code << (16 - bitCount);
+        bitCount += entry->codeLen;
+
+        if (bitCount >= 16) {
+            if (bytesWritten + 2 > outBufLen) {
+                // leave the state as it was, with the data of the earlier calls intact
+                *state->outByte = savedOutByte;
                 return -1;
             }
+            outByte[0] = bits >> 24;
+            outByte[1] = bits >> 16;
+            outByte += 2;
+            bytesWritten += 2;
+            bits <<= 16;
+            bitCount -= 16;
         }
     }
-    if (outBit != 0x80) {
-        // ensure last character in output buffer is counted
-        ++ret;
+
+    if (bitCount >= 8) {
+        if (bytesWritten + 1 > outBufLen) {
+            *state->outByte = savedOutByte;
+            return -1;
+        }
+        *outByte++ = bits >> 24;
+        ++bytesWritten;
+        bits <<= 8;
+        bitCount -= 8;
+    }
+    if (bitCount) {
+        // the partly written byte needs room as well
+        if (bytesWritten + 1 > outBufLen) {
+            *state->outByte = savedOutByte;
+            return -1;
+        }
+        *outByte = bits >> 24;
     }
-    return ret;
+
+    state->outByte = outByte;
+    state->bytesWritten = bytesWritten;
+    state->outBit = 0x80 >> bitCount;
+
+    return 0;
 }
 
-int huffmanEncodeBufStreaming(huffmanState_t *state, const uint8_t *inBuf, int inLen, const huffmanTable_t *huffmanTable)
+// Returns the length of the output including a partly written last byte, -1 if it does not fit in outBufLen
+int huffmanEncodeBuf(uint8_t *outBuf, int outBufLen, const uint8_t *inBuf, int inLen, const huffmanTable_t *huffmanTable)
 {
-    uint8_t *savedOutBytePtr = state->outByte;
-    uint8_t savedOutByte = *savedOutBytePtr;
+    huffmanState_t state = {
+        .bytesWritten = 0,
+        .outByte = outBuf,
+        .outBufLen = outBufLen,
+        .outBit = 0x80,
+    };
+
+    if (huffmanEncodeBufStreaming(&state, inBuf, inLen, huffmanTable) < 0) {
+        return -1;
+    }
+    if (state.outBit != 0x80) {
+        // ensure last character in output buffer is counted
+        ++state.bytesWritten;
+    }
+    return state.bytesWritten;
+}
 
-    for (const uint8_t *pos = inBuf, *end = inBuf + inLen; pos < end; ++pos) {
-        const int huffCodeLen = huffmanTable[*pos].codeLen;
-        const uint16_t huffCode = huffmanTable[*pos].code;
-        uint16_t testBit = 0x8000;
+// Fills in the symbol and length for every HUFFMAN_MAX_CODE_LEN bit value that starts with each code
+void huffmanInitDecodeTable(huffmanDecodeTable_t *decodeTable, const huffmanTable_t *huffmanTable)
+{
+    for (int symbol = 0; symbol < HUFFMAN_TABLE_SIZE; ++symbol) {
+        const int codeLen = huffmanTable[symbol].codeLen;
+        const int first = huffmanTable[symbol].code >> (16 - HUFFMAN_MAX_CODE_LEN);
+        const int count = 1 << (HUFFMAN_MAX_CODE_LEN - codeLen);
+        for (int ii = first; ii < first + count; ++ii) {
+            decodeTable->entry[ii].symbol = symbol;
+            decodeTable->entry[ii].codeLen = codeLen;
+        }
+    }
+}
 
-        for (int jj = 0; jj < huffCodeLen; ++jj) {
-            if (huffCode & testBit) {
-                *state->outByte |= state->outBit;
-            }
+/*
+ * Decodes the symbols that are complete in the input of the state, the bits of an incomplete symbol are kept until
+ * the caller adds more input. Stops at the EOF code or when outBufLen symbols have been decoded, returns the number
+ * decoded. The zero bits that pad the end of the encoded data decode as symbols, so the caller limits the count.
+ */
+int huffmanDecodeBufStreaming(huffmanDecodeState_t *state, uint8_t *outBuf, int outBufLen, const huffmanDecodeTable_t *decodeTable)
+{
+    uint32_t bits = state->bits;
+    int bitCount = state->bitCount;
+    int outCount = 0;
+
+    while (outCount < outBufLen && !state->eof) {
+        while (bitCount <= 24 && state->inLen > 0) {
+            bits |= (uint32_t)*state->inByte++ << (24 - bitCount);
+            bitCount += 8;
+            --state->inLen;
+        }
 
-            testBit >>= 1;
-            state->outBit >>= 1;
-            if (state->outBit == 0) {
-                state->outBit = 0x80;
-                ++state->outByte;
-                *state->outByte = 0;
-                ++state->bytesWritten;
-            }
+        const huffmanDecodeEntry_t *entry = &decodeTable->entry[bits >> (32 - HUFFMAN_MAX_CODE_LEN)];
+        if (entry->codeLen > bitCount) {
+            // the rest of the code is in the next input
+            break;
+        }
+        bits <<= entry->codeLen;
+        bitCount -= entry->codeLen;
 
-            // if buffer is filled and we haven't finished compressing
-            if (state->bytesWritten >= state->outBufLen && (pos < end - 1 || jj < huffCodeLen - 1)) {
-                // restore savedOutByte
-                *savedOutBytePtr = savedOutByte;
-                return -1;
-            }
+        if (entry->symbol == HUFFMAN_EOF_SYMBOL) {
+            state->eof = true;
+        } else {
+            outBuf[outCount++] = entry->symbol;
         }
     }
 
-    return 0;
+    state->bits = bits;
+    state->bitCount = bitCount;
+
+    return outCount;
+}
+
+// Decodes inCharacterCount symbols, returns the number decoded or -1 if they do not fit in outBufLen
+int huffmanDecodeBuf(uint8_t *outBuf, int outBufLen, const uint8_t *inBuf, int inLen, int inCharacterCount, const huffmanDecodeTable_t *decodeTable)
+{
+    if (inCharacterCount > outBufLen) {
+        return -1;
+    }
+
+    huffmanDecodeState_t state = {
+        .inByte = inBuf,
+        .inLen = inLen,
+        .bits = 0,
+        .bitCount = 0,
+        .eof = false,
+    };
+
+    return huffmanDecodeBufStreaming(&state, outBuf, inCharacterCount, decodeTable);
 }
 
 #endif
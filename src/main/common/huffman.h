@@ -20,9 +20,11 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define HUFFMAN_TABLE_SIZE 257 // 256 characters plus EOF
+#define HUFFMAN_MAX_CODE_LEN 12 // longest code in huffmanTable, bounds the size of the encoded output
 typedef struct huffmanTable_s {
     uint8_t     codeLen;
     uint16_t    code;
@@ -43,5 +45,31 @@ struct huffmanInfo_s {
 
 #define HUFFMAN_INFO_SIZE sizeof(struct huffmanInfo_s)
 
+#define HUFFMAN_EOF_SYMBOL 256 // index of the EOF code in huffmanTable
+
+// Every code is a prefix of HUFFMAN_MAX_CODE_LEN bits, so the next symbol is a single lookup of that many bits
+#define HUFFMAN_DECODE_TABLE_SIZE (1 << HUFFMAN_MAX_CODE_LEN)
+
+typedef struct huffmanDecodeEntry_s {
+    uint16_t    symbol;
+    uint8_t     codeLen;
+} huffmanDecodeEntry_t;
+
+typedef struct huffmanDecodeTable_s {
+    huffmanDecodeEntry_t entry[HUFFMAN_DECODE_TABLE_SIZE];
+} huffmanDecodeTable_t;
+
+typedef struct huffmanDecodeState_s {
+    const uint8_t *inByte;  // next input byte, set together with inLen by the caller when there is more input
+    int         inLen;
+    uint32_t    bits;       // input taken but not decoded yet, MSB aligned
+    uint8_t     bitCount;
+    bool        eof;        // the EOF code has been decoded
+} huffmanDecodeState_t;
+
 int huffmanEncodeBuf(uint8_t *outBuf, int outBufLen, const uint8_t *inBuf, int inLen, const huffmanTable_t *huffmanTable);
 int huffmanEncodeBufStreaming(huffmanState_t *state, const uint8_t *inBuf, int inLen, const huffmanTable_t *huffmanTable);
+
+void huffmanInitDecodeTable(huffmanDecodeTable_t *decodeTable, const huffmanTable_t *huffmanTable);
+int huffmanDecodeBuf(uint8_t *outBuf, int outBufLen, const uint8_t *inBuf, int inLen, int inCharacterCount, const huffmanDecodeTable_t *decodeTable);
+int huffmanDecodeBufStreaming(huffmanDecodeState_t *state, uint8_t *outBuf, int outBufLen, const huffmanDecodeTable_t *decodeTable);
@@ -106,6 +106,67 @@ float acos_approx(float x)
 }
 #endif
 
+#ifdef USE_FAST_MATH_TABLES
+// One turn of sin() with linear interpolation between the entries
+// sin_table maximum absolute error = 7.6e-05
+#define SIN_TABLE_SIZE 256
+// atan() of the ratio of the smaller to the larger coordinate, from 0 to 1
+// atan2_table maximum absolute error = 5.3e-06 rads
+#define ATAN_TABLE_SIZE 128
+
+static FAST_RAM_ZERO_INIT float sinTable[SIN_TABLE_SIZE + 1];
+static FAST_RAM_ZERO_INIT float atanTable[ATAN_TABLE_SIZE + 1];
+
+void fastMathTablesInit(void)
+{
+    for (int i = 0; i <= SIN_TABLE_SIZE; i++) {
+        sinTable[i] = sin_approx(2.0f * M_PIf * i / SIN_TABLE_SIZE);
+    }
+    for (int i = 0; i <= ATAN_TABLE_SIZE; i++) {
+        atanTable[i] = atan2_approx(i, ATAN_TABLE_SIZE);
+    }
+}
+
+// position is the angle in table entries, any turn
+static float sinTableLookup(float position)
+{
+    int32_t index = position;
+    if (index > position) {
+        index--;
+    }
+    const float fraction = position - index;
+    index &= SIN_TABLE_SIZE - 1;
+    return sinTable[index] + (sinTable[index + 1] - sinTable[index]) * fraction;
+}
+
+float sin_table(float x)
+{
+    return sinTableLookup(x * (SIN_TABLE_SIZE / (2.0f * M_PIf)));
+}
+
+float cos_table(float x)
+{
+    return sinTableLookup(x * (SIN_TABLE_SIZE / (2.0f * M_PIf)) + SIN_TABLE_SIZE / 4);
+}
+
+float atan2_table(float y, float x)
+{
+    const float absX = fabsf(x);
+    const float absY = fabsf(y);
+    const float maxXY = MAX(absX, absY);
+    float res = 0.0f;
+    if (maxXY) {
+        const float position = MIN(absX, absY) / maxXY * ATAN_TABLE_SIZE;
+        const int index = MIN((int)position, ATAN_TABLE_SIZE - 1);
+        res = atanTable[index] + (atanTable[index + 1] - atanTable[index]) * (position - index);
+    }
+    if (absY > absX) res = (M_PIf / 2.0f) - res;
+    if (x < 0) res = M_PIf - res;
+    if (y < 0) res = -res;
+    return res;
+}
+#endif
+
 int gcd(int num, int denom)
 {
     if (denom == 0) {
@@ -227,7 +288,7 @@ void buildRotationMatrix(fp_angles_t *delta, fp_rotationMatrix_t *rotation)
     rotation->m[2][Z] = cosy * cosx;
 }
 
-FAST_CODE void applyRotation(float *v, fp_rotationMatrix_t *rotationMatrix)
+FAST_CODE void applyRotation(float *v, const fp_rotationMatrix_t *rotationMatrix)
 {
     struct fp_vector *vDest = (struct fp_vector *)v;
     struct fp_vector vTmp = *vDest;
@@ -115,7 +115,7 @@ void normalizeV(struct fp_vector *src, struct fp_vector *dest);
 
 void rotateV(struct fp_vector *v, fp_angles_t *delta);
 void buildRotationMatrix(fp_angles_t *delta, fp_rotationMatrix_t *rotation);
-void applyRotation(float *v, fp_rotationMatrix_t *rotationMatrix);
+void applyRotation(float *v, const fp_rotationMatrix_t *rotationMatrix);
 
 int32_t quickMedianFilter3(int32_t * v);
 int32_t quickMedianFilter5(int32_t * v);
@@ -147,6 +147,21 @@ float pow_approx(float a, float b);
 #define pow_approx(a, b)    powf(b, a)
 #endif
 
+// Table driven versions of the approximations above for the attitude loop,
+// they trade some accuracy and RAM for speed, see fastMathTablesInit().
+// acos_approx() is already cheaper than a table, acos() is too steep near +-1 to interpolate.
+#ifdef USE_FAST_MATH_TABLES
+void fastMathTablesInit(void);
+float sin_table(float x);
+float cos_table(float x);
+float atan2_table(float y, float x);
+#else
+#define fastMathTablesInit()
+#define sin_table(x)        sin_approx(x)
+#define cos_table(x)        cos_approx(x)
+#define atan2_table(y,x)    atan2_approx(y,x)
+#endif
+
 void arraySubInt32(int32_t *dest, int32_t *array1, int32_t *array2, int count);
 
 int16_t qPercent(fix12_t q);
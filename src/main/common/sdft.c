@@ -0,0 +1,85 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+#include "common/sdft.h"
+
+#define SDFT_R 0.9999f  // damping factor, keeps the sliding DFT stable despite rounding errors
+
+static uint16_t FAST_RAM_ZERO_INIT sdftSampleCount;
+static float FAST_RAM_ZERO_INIT    rPowerN;
+static float FAST_RAM_ZERO_INIT    twiddleRe[SDFT_BIN_COUNT_MAX];
+static float FAST_RAM_ZERO_INIT    twiddleIm[SDFT_BIN_COUNT_MAX];
+
+void sdftInit(sdft_t *sdft, uint16_t sampleCount, uint16_t startBin, uint16_t endBin)
+{
+    sampleCount = MIN(sampleCount, SDFT_SAMPLE_SIZE_MAX);
+
+    if (sampleCount != sdftSampleCount) {
+        sdftSampleCount = sampleCount;
+        rPowerN = powf(SDFT_R, sampleCount);
+        const float c = 2.0f * M_PIf / sampleCount;
+        for (int i = 0; i <= sampleCount / 2; i++) {
+            twiddleRe[i] = cos_approx(c * i);
+            twiddleIm[i] = sin_approx(c * i);
+        }
+    }
+
+    memset(sdft, 0, sizeof(*sdft));
+    sdft->sampleCount = sampleCount;
+    sdft->endBin = MIN(endBin, sampleCount / 2);
+    sdft->startBin = MIN(startBin, sdft->endBin);
+}
+
+// Only the bins from startBin to endBin are updated
+FAST_CODE void sdftPush(sdft_t *sdft, float sample)
+{
+    const float delta = sample - rPowerN * sdft->samples[sdft->idx];
+
+    sdft->samples[sdft->idx] = sample;
+    if (++sdft->idx == sdft->sampleCount) {
+        sdft->idx = 0;
+    }
+
+    for (int i = sdft->startBin; i <= sdft->endBin; i++) {
+        const float re = SDFT_R * sdft->re[i] + delta;
+        const float im = SDFT_R * sdft->im[i];
+        sdft->re[i] = twiddleRe[i] * re - twiddleIm[i] * im;
+        sdft->im[i] = twiddleRe[i] * im + twiddleIm[i] * re;
+    }
+}
+
+// Hann windowed magnitude of the bins from startBin + 1 to endBin - 1, the window is applied
+// in the frequency domain as a convolution with its three non-zero bins so the samples are never copied.
+// The result is scaled by 2 compared to windowing the samples.
+FAST_CODE void sdftWinMagnitude(const sdft_t *sdft, float *output)
+{
+    for (int i = sdft->startBin + 1; i < sdft->endBin; i++) {
+        const float re = sdft->re[i] - 0.5f * (sdft->re[i - 1] + sdft->re[i + 1]);
+        const float im = sdft->im[i] - 0.5f * (sdft->im[i - 1] + sdft->im[i + 1]);
+        output[i] = sqrtf(re * re + im * im);
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Sliding DFT, updates the spectrum of the latest sampleCount samples with each new sample
+// at a cost proportional to the number of bins computed, rather than recalculating a full FFT.
+
+#ifdef STM32F3
+#define SDFT_SAMPLE_SIZE_MAX 32     // max for F3 targets
+#else
+#define SDFT_SAMPLE_SIZE_MAX 256
+#endif
+#define SDFT_BIN_COUNT_MAX   (SDFT_SAMPLE_SIZE_MAX / 2 + 1) // includes the Nyquist bin
+
+typedef struct sdft_s {
+    uint16_t sampleCount;
+    uint16_t startBin;
+    uint16_t endBin;
+    uint16_t idx;                           // ring buffer index of the oldest sample
+    float samples[SDFT_SAMPLE_SIZE_MAX];    // ring buffer of the samples in the window
+    float re[SDFT_BIN_COUNT_MAX];
+    float im[SDFT_BIN_COUNT_MAX];
+} sdft_t;
+
+// all the sliding DFTs in use must have the same sampleCount, which must be even
+void sdftInit(sdft_t *sdft, uint16_t sampleCount, uint16_t startBin, uint16_t endBin);
+void sdftPush(sdft_t *sdft, float sample);
+void sdftWinMagnitude(const sdft_t *sdft, float *output);
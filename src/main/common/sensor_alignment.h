@@ -60,6 +60,12 @@ typedef union sensorAlignment_u {
     .yaw = DEGREES_TO_DECIDEGREES(YAW), \
 })
 
+// Sensor alignment combined with the board alignment, see buildSensorRotation()
+typedef struct sensorRotation_s {
+    fp_rotationMatrix_t matrix;
+    int8_t permutation[XYZ_AXIS_COUNT];     // source axis + 1 of each axis, negative when inverted, 0 when the rotation is not a multiple of 90 degrees
+} sensorRotation_t;
+
 #define CUSTOM_ALIGN_CW0_DEG         SENSOR_ALIGNMENT(  0,   0,   0)
 #define CUSTOM_ALIGN_CW90_DEG        SENSOR_ALIGNMENT(  0,   0,  90)
 #define CUSTOM_ALIGN_CW180_DEG       SENSOR_ALIGNMENT(  0,   0, 180)
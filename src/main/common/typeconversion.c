@@ -18,6 +18,7 @@
  * If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
@@ -85,6 +86,59 @@ void i2a(int num, char *bf)
     ui2a(num, 10, 0, bf);
 }
 
+// Writes a decimal number padded to width, with decimals digits after the decimal point.
+// Zero padding is inserted after the sign and space padding before it, as with printf.
+// Returns a pointer to the terminating NUL so that fields can be appended without a strlen.
+static char *decimal2a(unsigned int num, bool negative, unsigned int decimals, unsigned int width, char pad, char *bf)
+{
+    char digits[12];
+    unsigned int count = 0;
+
+    for (unsigned int i = 0; i < decimals; i++) {
+        digits[count++] = '0' + num % 10;
+        num /= 10;
+    }
+    if (decimals) {
+        digits[count++] = '.';
+    }
+    do {
+        digits[count++] = '0' + num % 10;
+        num /= 10;
+    } while (num);
+
+    const unsigned int length = count + (negative ? 1 : 0);
+    if (negative && pad == '0') {
+        *bf++ = '-';
+    }
+    for (unsigned int i = length; i < width; i++) {
+        *bf++ = pad;
+    }
+    if (negative && pad != '0') {
+        *bf++ = '-';
+    }
+    while (count) {
+        *bf++ = digits[--count];
+    }
+    *bf = 0;
+
+    return bf;
+}
+
+char *ui2aPadded(unsigned int num, unsigned int width, char pad, char *bf)
+{
+    return decimal2a(num, false, 0, width, pad, bf);
+}
+
+char *i2aPadded(int num, unsigned int width, char pad, char *bf)
+{
+    return decimal2a(num < 0 ? -(unsigned int)num : (unsigned int)num, num < 0, 0, width, pad, bf);
+}
+
+char *fixed2a(int num, unsigned int decimals, unsigned int width, char pad, char *bf)
+{
+    return decimal2a(num < 0 ? -(unsigned int)num : (unsigned int)num, num < 0, MIN(decimals, 9u), width, pad, bf);
+}
+
 int a2d(char ch)
 {
     if (ch >= '0' && ch <= '9')
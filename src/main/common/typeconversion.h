@@ -26,6 +26,11 @@ void uli2a(unsigned long int num, unsigned int base, int uc, char *bf);
 void li2a(long num, char *bf);
 void ui2a(unsigned int num, unsigned int base, int uc, char *bf);
 void i2a(int num, char *bf);
+// printf free equivalents of "%*u" / "%0*u", "%*d" / "%0*d" and of a fixed point number
+// num / 10^decimals, pad is ' ' or '0'. They return the end of the string for chaining.
+char *ui2aPadded(unsigned int num, unsigned int width, char pad, char *bf);
+char *i2aPadded(int num, unsigned int width, char pad, char *bf);
+char *fixed2a(int num, unsigned int decimals, unsigned int width, char pad, char *bf);
 char a2i(char ch, const char **src, int base, int *nump);
 char *ftoa(float x, char *floatString);
 float fastA2F(const char *p);
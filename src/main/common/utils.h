@@ -54,6 +54,9 @@
 // PP_CALL(TAKE3, MULTI2, C) expands to ABC
 #define PP_CALL(macro, ...) macro(__VA_ARGS__)
 
+// Call through fnPtr, but directly when it points to fn, so that the call can be inlined
+#define CALL_DIRECT_IF(fnPtr, fn, ...) ((fnPtr) == (fn) ? (fn)(__VA_ARGS__) : (fnPtr)(__VA_ARGS__))
+
 #if !defined(UNUSED)
 #define UNUSED(x) (void)(x) // Variables and parameters that are not used
 #endif
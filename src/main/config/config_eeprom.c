@@ -27,6 +27,7 @@
 #include "build/build_config.h"
 
 #include "common/crc.h"
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "config/config_eeprom.h"
@@ -320,7 +321,7 @@ bool isEEPROMStructureValid(void)
     // include stored CRC in the CRC calculation
     const uint16_t *storedCrc = (const uint16_t *)p;
     crc = crc16_ccitt_update(crc, storedCrc, sizeof(*storedCrc));
-    p += sizeof(storedCrc);
+    p += sizeof(*storedCrc);
 
     eepromConfigSize = p - &__config_start;
 
@@ -347,11 +348,69 @@ size_t getEEPROMStorageSize(void)
 #endif
 }
 
+#ifdef USE_CONFIG_JOURNAL
+// The PGs changed since the last full write are appended after the saved copy as journal entries.
+// An entry is a record followed by its inverted big endian CRC, padded to the flash write size,
+// and supersedes the earlier entries and the record in the saved copy for its PG.
+// The journal is limited to the rest of the flash page holding the end of the saved copy, which
+// the full write leaves erased. Once it is full the next save is a full write which compacts it.
+
+#define CONFIG_WRITE_ALIGN(size) (((size) + CONFIG_STREAMER_BUFFER_SIZE - 1) & ~(CONFIG_STREAMER_BUFFER_SIZE - 1))
+#define JOURNAL_ENTRY_SIZE(recordSize) CONFIG_WRITE_ALIGN((recordSize) + sizeof(uint16_t))
+
+static const uint8_t *journalStart(void)
+{
+    return &__config_start + CONFIG_WRITE_ALIGN(eepromConfigSize);
+}
+
+static const uint8_t *journalEnd(void)
+{
+    const uintptr_t pageEnd = config_streamer_page_end((uintptr_t)&__config_start + eepromConfigSize - 1);
+
+    return (const uint8_t *)MIN(pageEnd, (uintptr_t)&__config_end);
+}
+
+// Returns the record of the entry at p, or NULL at the end of the journal.
+// The CRC is only checked when the caller is going to use the record.
+static const configRecord_t *journalEntry(const uint8_t *p, const uint8_t *end, bool checkCrc)
+{
+    const configRecord_t *record = (const configRecord_t *)p;
+
+    if (p + sizeof(*record) > end
+        || record->size == 0xFFFF   // erased flash
+        || record->size < sizeof(*record)
+        || p + JOURNAL_ENTRY_SIZE(record->size) > end) {
+        return NULL;
+    }
+
+    if (checkCrc && crc16_ccitt_update(CRC_START_VALUE, p, record->size + sizeof(uint16_t)) != CRC_CHECK_VALUE) {
+        return NULL;
+    }
+
+    return record;
+}
+
+static const uint8_t *journalAppendPosition(void)
+{
+    const uint8_t *end = journalEnd();
+    const uint8_t *p = journalStart();
+    const configRecord_t *record;
+
+    while ((record = journalEntry(p, end, true))) {
+        p += JOURNAL_ENTRY_SIZE(record->size);
+    }
+
+    return p;
+}
+#endif
+
 // find config record for reg + classification (profile info) in EEPROM
 // return NULL when record is not found
 // this function assumes that EEPROM content is valid
 static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFlags_e classification)
 {
+    const configRecord_t *found = NULL;
+
     const uint8_t *p = &__config_start;
     p += sizeof(configHeader_t);             // skip header
     while (true) {
@@ -361,12 +420,31 @@ static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFla
             || record->size < sizeof(*record))
             break;
         if (pgN(reg) == record->pgn
-            && (record->flags & CR_CLASSIFICATION_MASK) == classification)
-            return record;
+            && (record->flags & CR_CLASSIFICATION_MASK) == classification) {
+            found = record;
+            break;
+        }
         p += record->size;
     }
-    // record not found
-    return NULL;
+
+#ifdef USE_CONFIG_JOURNAL
+    // the latest journal entry for the PG wins
+    const uint8_t *end = journalEnd();
+    p = journalStart();
+    const configRecord_t *record;
+    while ((record = journalEntry(p, end, false))) {
+        if (pgN(reg) == record->pgn
+            && (record->flags & CR_CLASSIFICATION_MASK) == classification) {
+            if (!journalEntry(p, end, true)) {
+                break;
+            }
+            found = record;
+        }
+        p += JOURNAL_ENTRY_SIZE(record->size);
+    }
+#endif
+
+    return found;
 }
 
 // Initialize all PG records from EEPROM.
@@ -442,9 +520,109 @@ static bool writeSettingsToEEPROM(void)
     return success;
 }
 
+#ifdef USE_CONFIG_JOURNAL
+static bool isPgSaved(const pgRegistry_t *reg)
+{
+    const configRecord_t *rec = findEEPROM(reg, CR_CLASSICATION_SYSTEM);
+
+    return rec
+        && rec->version == pgVersion(reg)
+        && rec->size - offsetof(configRecord_t, pg) == pgSize(reg)
+        && memcmp(rec->pg, reg->address, pgSize(reg)) == 0;
+}
+
+static bool isConfigSaved(void)
+{
+    PG_FOREACH(reg) {
+        if (!isPgSaved(reg)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Appends the PGs that differ from the saved config to the journal, or only onlyReg when it is not NULL.
+// Returns false if there is no valid saved config to append to or not enough room for the change.
+static bool appendSettingsToEEPROM(const pgRegistry_t *onlyReg)
+{
+    if (!isEEPROMVersionValid() || !isEEPROMStructureValid()) {
+        return false;
+    }
+
+    const uint8_t *end = journalEnd();
+    const uint8_t *p = journalAppendPosition();
+
+    uint32_t requiredSize = 0;
+    PG_FOREACH(reg) {
+        if ((!onlyReg || reg == onlyReg) && !isPgSaved(reg)) {
+            requiredSize += JOURNAL_ENTRY_SIZE(sizeof(configRecord_t) + pgSize(reg));
+        }
+    }
+    if (requiredSize == 0) {
+        return true;
+    }
+    if (p + requiredSize > end) {
+        return false;
+    }
+
+    config_streamer_t streamer;
+    config_streamer_init(&streamer);
+
+    config_streamer_start(&streamer, (uintptr_t)p, end - p);
+
+    PG_FOREACH(reg) {
+        if ((onlyReg && reg != onlyReg) || isPgSaved(reg)) {
+            continue;
+        }
+
+        const uint16_t regSize = pgSize(reg);
+        configRecord_t record = {
+            .size = sizeof(configRecord_t) + regSize,
+            .pgn = pgN(reg),
+            .version = pgVersion(reg),
+            .flags = CR_CLASSICATION_SYSTEM
+        };
+
+        config_streamer_write(&streamer, (uint8_t *)&record, sizeof(record));
+        uint16_t crc = crc16_ccitt_update(CRC_START_VALUE, (uint8_t *)&record, sizeof(record));
+        config_streamer_write(&streamer, reg->address, regSize);
+        crc = crc16_ccitt_update(crc, reg->address, regSize);
+
+        const uint16_t invertedBigEndianCrc = ~(((crc & 0xFF) << 8) | (crc >> 8));
+        config_streamer_write(&streamer, (uint8_t *)&invertedBigEndianCrc, sizeof(crc));
+
+        // entries start on a flash word, each word can only be programmed once
+        config_streamer_flush(&streamer);
+    }
+
+    const bool success = config_streamer_finish(&streamer) == 0;
+
+    return success && (onlyReg ? isPgSaved(onlyReg) : isConfigSaved());
+}
+
+// Saves a single PG by appending it to the journal, the other PGs keep their saved values even if they
+// were changed since. Unlike writeConfigToEEPROM() this never erases the flash, it returns false
+// when the journal has no room left, which the next full write frees up.
+bool writePgToEEPROM(pgn_t pgn)
+{
+    const pgRegistry_t *reg = pgFind(pgn);
+
+    return reg && appendSettingsToEEPROM(reg);
+}
+#endif
+
 void writeConfigToEEPROM(void)
 {
     bool success = false;
+
+#ifdef USE_CONFIG_JOURNAL
+    // erasing the flash takes hundreds of milliseconds, only do it when the journal is full
+    if (appendSettingsToEEPROM(NULL)) {
+        return;
+    }
+#endif
+
     // write it
     for (int attempt = 0; attempt < 3 && !success; attempt++) {
         if (writeSettingsToEEPROM()) {
@@ -23,12 +23,17 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "pg/pg.h"
+
 #define EEPROM_CONF_VERSION 172
 
 bool isEEPROMVersionValid(void);
 bool isEEPROMStructureValid(void);
 bool loadEEPROM(void);
 void writeConfigToEEPROM(void);
+#ifdef USE_CONFIG_JOURNAL
+bool writePgToEEPROM(pgn_t pgn);
+#endif
 
 uint16_t getEEPROMConfigSize(void);
 size_t getEEPROMStorageSize(void);
@@ -515,6 +515,13 @@ int config_streamer_flush(config_streamer_t *c)
     return c-> err;
 }
 
+// Returns the end of the flash page holding address. A write starting within a page only erases
+// the following pages, so the rest of the page is left erased for appending to.
+uintptr_t config_streamer_page_end(uintptr_t address)
+{
+    return address - (address % FLASH_PAGE_SIZE) + FLASH_PAGE_SIZE;
+}
+
 int config_streamer_finish(config_streamer_t *c)
 {
     if (c->unlocked) {
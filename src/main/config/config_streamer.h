@@ -57,3 +57,5 @@ int config_streamer_flush(config_streamer_t *c);
 
 int config_streamer_finish(config_streamer_t *c);
 int config_streamer_status(config_streamer_t *c);
+
+uintptr_t config_streamer_page_end(uintptr_t address);
@@ -25,6 +25,7 @@
 #include "common/axis.h"
 #include "common/maths.h"
 #include "common/sensor_alignment.h"
+#include "common/time.h"
 #include "drivers/exti.h"
 #include "drivers/bus.h"
 #include "drivers/sensor.h"
@@ -78,6 +79,10 @@ typedef enum {
     GYRO_RATE_32_kHz,
 } gyroRateKHz_e;
 
+#ifdef USE_GYRO_FIFO
+#define GYRO_FIFO_MAX_SAMPLES 16
+#endif
+
 typedef struct gyroDev_s {
 #if defined(SIMULATOR_BUILD) && defined(SIMULATOR_MULTITHREAD)
     pthread_mutex_t lock;
@@ -85,6 +90,13 @@ typedef struct gyroDev_s {
     sensorGyroInitFuncPtr initFn;                             // initialize function
     sensorGyroReadFuncPtr readFn;                             // read 3 axis data function
     sensorGyroReadDataFuncPtr temperatureFn;                  // read temperature if available
+    sensorGyroDataReadyFuncPtr dataReadyFn;                   // called from the data ready interrupt if set
+    sensorGyroReadFuncPtr dmaInitFn;                          // hand the reads over to the DMA, if supported
+    sensorGyroReadFuncPtr readStartFn;                        // start an asynchronous read from the data ready interrupt
+    struct gyroSpiDma_s *spiDma;
+#ifdef USE_GYRO_FIFO
+    sensorGyroReadFuncPtr fifoReadFn;                         // batch read of the samples queued in the gyro FIFO, if supported
+#endif
     extiCallbackRec_t exti;
     busDevice_t bus;
     float scale;                                             // scalefactor
@@ -92,11 +104,22 @@ typedef struct gyroDev_s {
     float gyroADC[XYZ_AXIS_COUNT];                           // gyro data after calibration and alignment
     int32_t gyroADCRawPrevious[XYZ_AXIS_COUNT];
     int16_t gyroADCRaw[XYZ_AXIS_COUNT];                      // raw data from sensor
+#ifdef USE_GYRO_FIFO
+    int16_t fifoADCRaw[GYRO_FIFO_MAX_SAMPLES][XYZ_AXIS_COUNT]; // raw samples of the last FIFO batch read
+    uint8_t fifoSampleCount;
+    bool fifoEnabled;
+#endif
     int16_t temperature;
     mpuDetectionResult_t mpuDetectionResult;
     sensor_align_e gyroAlign;
     gyroRateKHz_e gyroRateKHz;
     bool dataReady;
+#ifdef USE_LOOP_TIMING
+    timeUs_t dataReadyTimeUs;                                // when the data ready interrupt last fired
+#endif
+#ifdef USE_GYRO_ODR_TRACKING
+    uint32_t dataReadyCount;                                 // data ready interrupts since startup
+#endif
     bool gyro_high_fsr;
     uint8_t hardware_lpf;
     uint8_t hardware_32khz_lpf;
@@ -104,7 +127,7 @@ typedef struct gyroDev_s {
     ioTag_t mpuIntExtiTag;
     uint8_t gyroHasOverflowProtection;
     gyroHardware_e gyroHardware;
-    fp_rotationMatrix_t rotationMatrix;
+    sensorRotation_t rotation;
 } gyroDev_t;
 
 typedef struct accDev_s {
@@ -114,6 +137,8 @@ typedef struct accDev_s {
     float acc_1G_rec;
     sensorAccInitFuncPtr initFn;                              // initialize function
     sensorAccReadFuncPtr readFn;                              // read 3 axis data function
+    sensorAccReadFuncPtr dmaReadFn;                           // read 3 axis data from the gyro's DMA transfer, if supported
+    struct gyroSpiDma_s *spiDma;
     busDevice_t bus;
     uint16_t acc_1G;
     int16_t ADCRaw[XYZ_AXIS_COUNT];
@@ -123,7 +148,7 @@ typedef struct accDev_s {
     bool acc_high_fsr;
     char revisionCode;                                      // a revision code for the sensor, if known
     uint8_t filler[2];
-    fp_rotationMatrix_t rotationMatrix;
+    sensorRotation_t rotation;
 } accDev_t;
 
 static inline void accDevLock(accDev_t *acc)
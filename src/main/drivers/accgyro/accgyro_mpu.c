@@ -47,6 +47,7 @@
 #include "drivers/accgyro/accgyro_mpu6050.h"
 #include "drivers/accgyro/accgyro_mpu6500.h"
 #include "drivers/accgyro/accgyro_spi_bmi160.h"
+#include "drivers/accgyro/accgyro_spi_dma.h"
 #include "drivers/accgyro/accgyro_spi_icm20649.h"
 #include "drivers/accgyro/accgyro_spi_icm20689.h"
 #include "drivers/accgyro/accgyro_spi_mpu6000.h"
@@ -114,6 +115,18 @@ static void mpuIntExtiHandler(extiCallbackRec_t *cb)
 #endif
     gyroDev_t *gyro = container_of(cb, gyroDev_t, exti);
     gyro->dataReady = true;
+#ifdef USE_LOOP_TIMING
+    gyro->dataReadyTimeUs = microsISR();
+#endif
+#ifdef USE_GYRO_ODR_TRACKING
+    gyro->dataReadyCount++;
+#endif
+    if (gyro->readStartFn) {
+        // dataReadyFn is called once the read has completed
+        gyro->readStartFn(gyro);
+    } else if (gyro->dataReadyFn) {
+        gyro->dataReadyFn(gyro);
+    }
 #ifdef DEBUG_MPU_DATA_READY_INTERRUPT
     const uint32_t now2Us = micros();
     debug[1] = (uint16_t)(now2Us - nowUs);
@@ -192,6 +205,157 @@ bool mpuGyroReadSPI(gyroDev_t *gyro)
     return true;
 }
 
+#ifdef USE_GYRO_FIFO
+/*
+ * Queues the gyro samples in the FIFO at the native rate, so the loop can read all samples
+ * taken since the last loop in one burst instead of only the latest one.
+ * Must be called at the end of the gyro init, with the bus still at the register write speed.
+ */
+void mpuGyroFifoInit(gyroDev_t *gyro)
+{
+    // The samples are picked up by the loop, the per sample data ready interrupt is not needed
+    busWriteRegister(&gyro->bus, MPU_RA_INT_ENABLE, 0);
+    delay(15);
+    busWriteRegister(&gyro->bus, MPU_RA_CONFIG, busReadRegister(&gyro->bus, MPU_RA_CONFIG) | MPU_BIT_CONFIG_FIFO_MODE);
+    delay(15);
+    busWriteRegister(&gyro->bus, MPU_RA_FIFO_EN, MPU_BIT_FIFO_EN_GYRO);
+    delay(15);
+    busWriteRegister(&gyro->bus, MPU_RA_USER_CTRL, busReadRegister(&gyro->bus, MPU_RA_USER_CTRL) | MPU_BIT_USER_CTRL_FIFO_EN | MPU_BIT_USER_CTRL_FIFO_RST);
+    delay(15);
+
+    gyro->fifoSampleCount = 0;
+    gyro->readFn = gyro->fifoReadFn;
+}
+
+FAST_CODE bool mpuGyroReadFifo(gyroDev_t *gyro)
+{
+    uint8_t data[GYRO_FIFO_MAX_SAMPLES * MPU_FIFO_SAMPLE_SIZE];
+
+    if (!busReadRegisterBuffer(&gyro->bus, MPU_RA_FIFO_COUNTH, data, 2)) {
+        return false;
+    }
+
+    const unsigned fifoSampleCount = (((data[0] & 0x1f) << 8) | data[1]) / MPU_FIFO_SAMPLE_SIZE;
+    if (fifoSampleCount == 0) {
+        return false;
+    }
+
+    const unsigned sampleCount = MIN(fifoSampleCount, GYRO_FIFO_MAX_SAMPLES);
+
+    // The loop has fallen behind, read past the backlog so that the filters run on the newest samples
+    for (unsigned skipCount = fifoSampleCount - sampleCount; skipCount; ) {
+        const unsigned chunk = MIN(skipCount, GYRO_FIFO_MAX_SAMPLES);
+        if (!busReadRegisterBuffer(&gyro->bus, MPU_RA_FIFO_R_W, data, chunk * MPU_FIFO_SAMPLE_SIZE)) {
+            return false;
+        }
+        skipCount -= chunk;
+    }
+
+    if (!busReadRegisterBuffer(&gyro->bus, MPU_RA_FIFO_R_W, data, sampleCount * MPU_FIFO_SAMPLE_SIZE)) {
+        return false;
+    }
+
+    for (unsigned i = 0; i < sampleCount; i++) {
+        const uint8_t *sample = &data[i * MPU_FIFO_SAMPLE_SIZE];
+        gyro->fifoADCRaw[i][X] = (int16_t)((sample[0] << 8) | sample[1]);
+        gyro->fifoADCRaw[i][Y] = (int16_t)((sample[2] << 8) | sample[3]);
+        gyro->fifoADCRaw[i][Z] = (int16_t)((sample[4] << 8) | sample[5]);
+    }
+    gyro->fifoSampleCount = sampleCount;
+
+    return true;
+}
+#endif // USE_GYRO_FIFO
+
+#ifdef USE_GYRO_SPI_DMA
+// The DMA reads the acc, temperature and gyro registers in one burst, so the acc shares the transfer
+#define MPU_SPI_DMA_IDX_ACCEL   0
+#define MPU_SPI_DMA_IDX_TEMP    6
+#define MPU_SPI_DMA_IDX_GYRO    8
+#define MPU_SPI_DMA_LENGTH      14
+
+bool mpuGyroDmaInit(gyroDev_t *gyro)
+{
+    if (!gyroSpiDmaInit(gyro, MPU_RA_ACCEL_XOUT_H, MPU_SPI_DMA_LENGTH)) {
+        return false;
+    }
+    gyro->readFn = mpuGyroReadSPIDma;
+
+    return true;
+}
+
+FAST_CODE bool mpuGyroReadSPIDma(gyroDev_t *gyro)
+{
+    uint8_t data[MPU_SPI_DMA_LENGTH];
+
+    if (!gyroSpiDmaGetSample(gyro->spiDma, data, MPU_SPI_DMA_LENGTH)) {
+        return false;
+    }
+
+    gyro->gyroADCRaw[X] = (int16_t)((data[MPU_SPI_DMA_IDX_GYRO + 0] << 8) | data[MPU_SPI_DMA_IDX_GYRO + 1]);
+    gyro->gyroADCRaw[Y] = (int16_t)((data[MPU_SPI_DMA_IDX_GYRO + 2] << 8) | data[MPU_SPI_DMA_IDX_GYRO + 3]);
+    gyro->gyroADCRaw[Z] = (int16_t)((data[MPU_SPI_DMA_IDX_GYRO + 4] << 8) | data[MPU_SPI_DMA_IDX_GYRO + 5]);
+
+    return true;
+}
+
+bool mpuAccReadSPIDma(accDev_t *acc)
+{
+    uint8_t data[MPU_SPI_DMA_LENGTH];
+
+    if (!gyroSpiDmaGetSample(acc->spiDma, data, MPU_SPI_DMA_LENGTH)) {
+        return false;
+    }
+
+    acc->ADCRaw[X] = (int16_t)((data[MPU_SPI_DMA_IDX_ACCEL + 0] << 8) | data[MPU_SPI_DMA_IDX_ACCEL + 1]);
+    acc->ADCRaw[Y] = (int16_t)((data[MPU_SPI_DMA_IDX_ACCEL + 2] << 8) | data[MPU_SPI_DMA_IDX_ACCEL + 3]);
+    acc->ADCRaw[Z] = (int16_t)((data[MPU_SPI_DMA_IDX_ACCEL + 4] << 8) | data[MPU_SPI_DMA_IDX_ACCEL + 5]);
+
+    return true;
+}
+#endif // USE_GYRO_SPI_DMA
+
+// The temperature sensors of the family differ in scale and offset, degrees are only approximate
+static int16_t mpuTemperatureDegrees(const gyroDev_t *gyro, int16_t raw)
+{
+    switch (gyro->mpuDetectionResult.sensor) {
+    case MPU_60x0:
+    case MPU_60x0_SPI:
+        return (raw + 12420) / 340;                 // 36.53 + raw / 340
+    case ICM_20601_SPI:
+    case ICM_20602_SPI:
+    case ICM_20608_SPI:
+    case ICM_20689_SPI:
+        return 25 + (int32_t)raw * 10 / 3268;       // 25 + raw / 326.8
+    default:
+        return 21 + (int32_t)raw * 100 / 33387;     // 21 + raw / 333.87
+    }
+}
+
+bool mpuGyroReadTemperature(gyroDev_t *gyro, int16_t *temperature)
+{
+    uint8_t data[2];
+
+#ifdef USE_GYRO_SPI_DMA
+    // the burst of the DMA includes the temperature, a register read could collide with the transfer
+    if (gyro->spiDma) {
+        uint8_t burst[MPU_SPI_DMA_LENGTH];
+        if (!gyroSpiDmaGetSample(gyro->spiDma, burst, MPU_SPI_DMA_LENGTH)) {
+            return false;
+        }
+        data[0] = burst[MPU_SPI_DMA_IDX_TEMP + 0];
+        data[1] = burst[MPU_SPI_DMA_IDX_TEMP + 1];
+    } else
+#endif
+    if (!busReadRegisterBuffer(&gyro->bus, MPU_RA_TEMP_OUT_H, data, 2)) {
+        return false;
+    }
+
+    *temperature = mpuTemperatureDegrees(gyro, (int16_t)((data[0] << 8) | data[1]));
+
+    return true;
+}
+
 typedef uint8_t (*gyroSpiDetectFn_t)(const busDevice_t *bus);
 
 static gyroSpiDetectFn_t gyroSpiDetectFnTable[] = {
@@ -227,6 +391,8 @@ static bool detectSPISensorsAndUpdateDetectionResult(gyroDev_t *gyro, const gyro
         return false;
     }
     spiBusSetInstance(&gyro->bus, instance);
+    // Gyro reads go ahead of the other devices on a shared bus
+    spiBusSetPriority(&gyro->bus, SPI_PRIORITY_HIGH);
 
     gyro->bus.busdev_u.spi.csnPin = IOGetByTag(config->csnTag);
     IOInit(gyro->bus.busdev_u.spi.csnPin, OWNER_GYRO_CS, RESOURCE_INDEX(config->index));
@@ -321,10 +487,9 @@ bool mpuDetect(gyroDev_t *gyro, const gyroDeviceConfig_t *config)
 
 void mpuGyroInit(gyroDev_t *gyro)
 {
+    gyro->temperatureFn = mpuGyroReadTemperature;
 #ifdef USE_GYRO_EXTI
     mpuIntExtiInit(gyro);
-#else
-    UNUSED(gyro);
 #endif
 }
 
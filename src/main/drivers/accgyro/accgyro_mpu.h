@@ -140,6 +140,18 @@
 // RF = Register Flag
 #define MPU_RF_DATA_RDY_EN (1 << 0)
 
+// Register 0x1A/26 - CONFIG
+#define MPU_BIT_CONFIG_FIFO_MODE    (1 << 6)    // stop writing once the FIFO is full, so the records stay aligned
+
+// Register 0x23/35 - FIFO_EN
+#define MPU_BIT_FIFO_EN_GYRO        ((1 << 6) | (1 << 5) | (1 << 4))    // XG, YG and ZG
+
+// Register 0x6a/106 - USER_CTRL
+#define MPU_BIT_USER_CTRL_FIFO_EN   (1 << 6)
+#define MPU_BIT_USER_CTRL_FIFO_RST  (1 << 2)
+
+#define MPU_FIFO_SAMPLE_SIZE        6           // bytes per record with only the gyro in the FIFO
+
 enum gyro_fsr_e {
     INV_FSR_250DPS = 0,
     INV_FSR_500DPS,
@@ -217,6 +229,11 @@ struct gyroDeviceConfig_s;
 void mpuGyroInit(struct gyroDev_s *gyro);
 bool mpuGyroRead(struct gyroDev_s *gyro);
 bool mpuGyroReadSPI(struct gyroDev_s *gyro);
+bool mpuGyroReadTemperature(struct gyroDev_s *gyro, int16_t *temperature);
+bool mpuGyroDmaInit(struct gyroDev_s *gyro);
+bool mpuGyroReadSPIDma(struct gyroDev_s *gyro);
+void mpuGyroFifoInit(struct gyroDev_s *gyro);
+bool mpuGyroReadFifo(struct gyroDev_s *gyro);
 void mpuPreInit(const struct gyroDeviceConfig_s *config);
 bool mpuDetect(struct gyroDev_s *gyro, const struct gyroDeviceConfig_s *config);
 uint8_t mpuGyroDLPF(struct gyroDev_s *gyro);
@@ -224,3 +241,4 @@ uint8_t mpuGyroReadRegister(const busDevice_t *bus, uint8_t reg);
 
 struct accDev_s;
 bool mpuAccRead(struct accDev_s *acc);
+bool mpuAccReadSPIDma(struct accDev_s *acc);
@@ -48,6 +48,7 @@
 
 #include "accgyro.h"
 #include "accgyro_spi_bmi160.h"
+#include "accgyro_spi_dma.h"
 
 
 /* BMI160 Registers */
@@ -240,6 +241,18 @@ void bmi160ExtiHandler(extiCallbackRec_t *cb)
 {
     gyroDev_t *gyro = container_of(cb, gyroDev_t, exti);
     gyro->dataReady = true;
+#ifdef USE_LOOP_TIMING
+    gyro->dataReadyTimeUs = microsISR();
+#endif
+#ifdef USE_GYRO_ODR_TRACKING
+    gyro->dataReadyCount++;
+#endif
+    if (gyro->readStartFn) {
+        // dataReadyFn is called once the read has completed
+        gyro->readStartFn(gyro);
+    } else if (gyro->dataReadyFn) {
+        gyro->dataReadyFn(gyro);
+    }
 }
 
 static void bmi160IntExtiInit(gyroDev_t *gyro)
@@ -312,6 +325,52 @@ bool bmi160GyroRead(gyroDev_t *gyro)
     return true;
 }
 
+#ifdef USE_GYRO_SPI_DMA
+// The gyro data registers are directly followed by the acc ones, so one burst covers both
+#define BMI160_SPI_DMA_IDX_GYRO     0
+#define BMI160_SPI_DMA_IDX_ACCEL    6
+#define BMI160_SPI_DMA_LENGTH       12
+
+static FAST_CODE bool bmi160GyroReadSPIDma(gyroDev_t *gyro)
+{
+    uint8_t data[BMI160_SPI_DMA_LENGTH];
+
+    if (!gyroSpiDmaGetSample(gyro->spiDma, data, BMI160_SPI_DMA_LENGTH)) {
+        return false;
+    }
+
+    gyro->gyroADCRaw[X] = (int16_t)((data[BMI160_SPI_DMA_IDX_GYRO + 1] << 8) | data[BMI160_SPI_DMA_IDX_GYRO + 0]);
+    gyro->gyroADCRaw[Y] = (int16_t)((data[BMI160_SPI_DMA_IDX_GYRO + 3] << 8) | data[BMI160_SPI_DMA_IDX_GYRO + 2]);
+    gyro->gyroADCRaw[Z] = (int16_t)((data[BMI160_SPI_DMA_IDX_GYRO + 5] << 8) | data[BMI160_SPI_DMA_IDX_GYRO + 4]);
+
+    return true;
+}
+
+static bool bmi160AccReadSPIDma(accDev_t *acc)
+{
+    uint8_t data[BMI160_SPI_DMA_LENGTH];
+
+    if (!gyroSpiDmaGetSample(acc->spiDma, data, BMI160_SPI_DMA_LENGTH)) {
+        return false;
+    }
+
+    acc->ADCRaw[X] = (int16_t)((data[BMI160_SPI_DMA_IDX_ACCEL + 1] << 8) | data[BMI160_SPI_DMA_IDX_ACCEL + 0]);
+    acc->ADCRaw[Y] = (int16_t)((data[BMI160_SPI_DMA_IDX_ACCEL + 3] << 8) | data[BMI160_SPI_DMA_IDX_ACCEL + 2]);
+    acc->ADCRaw[Z] = (int16_t)((data[BMI160_SPI_DMA_IDX_ACCEL + 5] << 8) | data[BMI160_SPI_DMA_IDX_ACCEL + 4]);
+
+    return true;
+}
+
+static bool bmi160GyroDmaInit(gyroDev_t *gyro)
+{
+    if (!gyroSpiDmaInit(gyro, BMI160_REG_GYR_DATA_X_LSB, BMI160_SPI_DMA_LENGTH)) {
+        return false;
+    }
+    gyro->readFn = bmi160GyroReadSPIDma;
+
+    return true;
+}
+#endif // USE_GYRO_SPI_DMA
 
 void bmi160SpiGyroInit(gyroDev_t *gyro)
 {
@@ -337,6 +396,9 @@ bool bmi160SpiAccDetect(accDev_t *acc)
 
     acc->initFn = bmi160SpiAccInit;
     acc->readFn = bmi160AccRead;
+#ifdef USE_GYRO_SPI_DMA
+    acc->dmaReadFn = bmi160AccReadSPIDma;
+#endif
 
     return true;
 }
@@ -350,6 +412,9 @@ bool bmi160SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->initFn = bmi160SpiGyroInit;
     gyro->readFn = bmi160GyroRead;
+#ifdef USE_GYRO_SPI_DMA
+    gyro->dmaInitFn = bmi160GyroDmaInit;
+#endif
     gyro->scale = 1.0f / 16.4f;
 
     return true;
@@ -0,0 +1,159 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Asynchronous gyro reads.
+ *
+ * The data ready interrupt queues a full duplex SPI DMA transfer of the sensor
+ * registers on the gyro's bus, the transfers land alternately in one of two buffers. Once a transfer
+ * has completed the buffer is published and the gyro's dataReadyFn is called, the
+ * consumer then picks up the latest completed sample without touching the bus.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_GYRO_SPI_DMA
+
+#include "common/maths.h"
+
+#include "drivers/bus_spi.h"
+
+#include "drivers/accgyro/accgyro.h"
+#include "drivers/accgyro/accgyro_spi_dma.h"
+
+#if defined(STM32F7)
+// DTCM is not cached, so no cache maintenance is needed around the transfers
+#define GYRO_SPI_DMA_RAM FAST_RAM_ZERO_INIT
+#else
+// CCM can not be reached by the DMA, so keep the buffers in main RAM
+#define GYRO_SPI_DMA_RAM
+#endif
+
+// One per gyro, both gyros are read when they are used together
+#define GYRO_SPI_DMA_COUNT 2
+
+static GYRO_SPI_DMA_RAM gyroSpiDma_t gyroSpiDmaInstances[GYRO_SPI_DMA_COUNT];
+
+// Called from the SPI DMA interrupt once the sample has been received
+static FAST_CODE busStatus_e gyroSpiDmaReadComplete(uint32_t arg)
+{
+    gyroSpiDma_t *spiDma = (gyroSpiDma_t *)arg;
+    gyroDev_t *gyro = spiDma->gyro;
+
+    spiDma->completedIndex = spiDma->writeIndex;
+    spiDma->writeIndex ^= 1;
+    spiDma->sampleCount++;
+    spiDma->busy = false;
+
+    if (gyro->dataReadyFn) {
+        gyro->dataReadyFn(gyro);
+    }
+
+    return BUS_READY;
+}
+
+/*
+ * Takes over the reads of a gyro that has finished its blocking initialisation.
+ * Needs the gyro's data ready interrupt and the gyro's SPI bus to use DMA. The bus must not be
+ * shared, a device that drives its chip select itself could start a transfer in the middle of a
+ * gyro transfer, so the gyro stays on polled reads if any other device is set to its bus.
+ */
+bool gyroSpiDmaInit(gyroDev_t *gyro, uint8_t readRegister, uint8_t readLength)
+{
+    const uint8_t length = readLength + 1;
+
+    gyroSpiDma_t *spiDma = NULL;
+    for (int i = 0; i < GYRO_SPI_DMA_COUNT; i++) {
+        if (!gyroSpiDmaInstances[i].gyro) {
+            spiDma = &gyroSpiDmaInstances[i];
+            break;
+        }
+    }
+
+    if (!spiDma || gyro->bus.bustype != BUSTYPE_SPI || !gyro->exti.fn || length > GYRO_SPI_DMA_BUFFER_SIZE
+        || length < SPI_DMA_THRESHOLD || !spiBusUsesDma(&gyro->bus) || spiBusIsShared(&gyro->bus)) {
+        return false;
+    }
+
+    spiDma->writeIndex = 0;
+    spiDma->completedIndex = 0;
+    spiDma->sampleCount = 0;
+    spiDma->busy = false;
+    memset(spiDma->txBuffer, 0xFF, sizeof(spiDma->txBuffer));
+    spiDma->txBuffer[0] = readRegister | 0x80;
+
+    spiDma->segments[0] = (busSegment_t){ spiDma->txBuffer, spiDma->rxBuffer[0], length, true, gyroSpiDmaReadComplete };
+    spiDma->segments[1] = (busSegment_t){ NULL, NULL, 0, true, NULL };
+
+    spiDma->gyro = gyro;
+    gyro->spiDma = spiDma;
+    // Set last, the data ready interrupt may start a transfer as soon as this is visible
+    gyro->readStartFn = gyroSpiDmaReadStart;
+
+    return true;
+}
+
+// Called from the data ready interrupt
+FAST_CODE bool gyroSpiDmaReadStart(gyroDev_t *gyro)
+{
+    gyroSpiDma_t *spiDma = gyro->spiDma;
+
+    if (spiDma->busy) {
+        // The previous transfer is still running, this sample is skipped
+        return false;
+    }
+    spiDma->busy = true;
+
+    spiDma->segments[0].rxData = spiDma->rxBuffer[spiDma->writeIndex];
+
+    if (!spiBusSequence(&gyro->bus, spiDma->segments, (uint32_t)spiDma)) {
+        // The bus queue is full, this sample is skipped
+        spiDma->busy = false;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Copies the latest completed sample, without its register address byte.
+ * Returns false until the first transfer has completed.
+ */
+FAST_CODE bool gyroSpiDmaGetSample(const gyroSpiDma_t *spiDma, uint8_t *data, uint8_t length)
+{
+    uint32_t sampleCount;
+
+    do {
+        sampleCount = spiDma->sampleCount;
+        if (sampleCount == 0) {
+            return false;
+        }
+        memcpy(data, &spiDma->rxBuffer[spiDma->completedIndex][1], MIN(length, spiDma->segments[0].len - 1));
+        // A transfer that completed during the copy may have reused the buffer, so copy again
+    } while (sampleCount != spiDma->sampleCount);
+
+    return true;
+}
+
+#endif // USE_GYRO_SPI_DMA
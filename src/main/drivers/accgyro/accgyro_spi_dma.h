@@ -0,0 +1,43 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "drivers/bus_spi.h"
+
+// Largest burst read, register address byte included
+#define GYRO_SPI_DMA_BUFFER_SIZE 16
+
+struct gyroDev_s;
+
+typedef struct gyroSpiDma_s {
+    struct gyroDev_s *gyro;
+    busSegment_t segments[2];           // the read, register address byte included, and the end of the sequence
+    uint8_t writeIndex;                 // buffer the transfer in progress lands in
+    volatile uint8_t completedIndex;    // buffer holding the latest completed sample
+    volatile bool busy;
+    volatile uint32_t sampleCount;      // number of completed transfers
+    uint8_t txBuffer[GYRO_SPI_DMA_BUFFER_SIZE];
+    uint8_t rxBuffer[2][GYRO_SPI_DMA_BUFFER_SIZE];
+} gyroSpiDma_t;
+
+bool gyroSpiDmaInit(struct gyroDev_s *gyro, uint8_t readRegister, uint8_t readLength);
+bool gyroSpiDmaReadStart(struct gyroDev_s *gyro);
+bool gyroSpiDmaGetSample(const gyroSpiDma_t *spiDma, uint8_t *data, uint8_t length);
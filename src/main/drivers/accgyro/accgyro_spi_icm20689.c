@@ -111,6 +111,9 @@ bool icm20689SpiAccDetect(accDev_t *acc)
 
     acc->initFn = icm20689AccInit;
     acc->readFn = mpuAccRead;
+#ifdef USE_GYRO_SPI_DMA
+    acc->dmaReadFn = mpuAccReadSPIDma;
+#endif
 
     return true;
 }
@@ -148,6 +151,12 @@ void icm20689GyroInit(gyroDev_t *gyro)
     spiBusWriteRegister(&gyro->bus, MPU_RA_INT_ENABLE, 0x01); // RAW_RDY_EN interrupt enable
 #endif
 
+#ifdef USE_GYRO_FIFO
+    if (gyro->fifoEnabled) {
+        mpuGyroFifoInit(gyro);
+    }
+#endif
+
     spiSetDivisor(gyro->bus.busdev_u.spi.instance, SPI_CLOCK_STANDARD);
 }
 
@@ -165,6 +174,12 @@ bool icm20689SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->initFn = icm20689GyroInit;
     gyro->readFn = mpuGyroReadSPI;
+#ifdef USE_GYRO_SPI_DMA
+    gyro->dmaInitFn = mpuGyroDmaInit;
+#endif
+#ifdef USE_GYRO_FIFO
+    gyro->fifoReadFn = mpuGyroReadFifo;
+#endif
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -79,6 +79,15 @@ static void l3gd20ExtiHandler(extiCallbackRec_t *cb)
 {
     gyroDev_t *gyro = container_of(cb, gyroDev_t, exti);
     gyro->dataReady = true;
+#ifdef USE_LOOP_TIMING
+    gyro->dataReadyTimeUs = microsISR();
+#endif
+#ifdef USE_GYRO_ODR_TRACKING
+    gyro->dataReadyCount++;
+#endif
+    if (gyro->dataReadyFn) {
+        gyro->dataReadyFn(gyro);
+    }
 }
 
 static void l3gd20IntExtiInit(gyroDev_t *gyro)
@@ -223,6 +223,9 @@ bool mpu6000SpiAccDetect(accDev_t *acc)
 
     acc->initFn = mpu6000SpiAccInit;
     acc->readFn = mpuAccRead;
+#ifdef USE_GYRO_SPI_DMA
+    acc->dmaReadFn = mpuAccReadSPIDma;
+#endif
 
     return true;
 }
@@ -235,6 +238,9 @@ bool mpu6000SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->initFn = mpu6000SpiGyroInit;
     gyro->readFn = mpuGyroReadSPI;
+#ifdef USE_GYRO_SPI_DMA
+    gyro->dmaInitFn = mpuGyroDmaInit;
+#endif
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
 
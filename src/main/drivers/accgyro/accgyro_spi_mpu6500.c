@@ -91,6 +91,12 @@ void mpu6500SpiGyroInit(gyroDev_t *gyro)
     spiBusWriteRegister(&gyro->bus, MPU_RA_USER_CTRL, MPU6500_BIT_I2C_IF_DIS);
     delay(100);
 
+#ifdef USE_GYRO_FIFO
+    if (gyro->fifoEnabled) {
+        mpuGyroFifoInit(gyro);
+    }
+#endif
+
     spiSetDivisor(gyro->bus.busdev_u.spi.instance, SPI_CLOCK_FAST);
     delayMicroseconds(1);
 }
@@ -135,6 +141,9 @@ bool mpu6500SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->initFn = mpu6500SpiGyroInit;
     gyro->readFn = mpuGyroReadSPI;
+#ifdef USE_GYRO_FIFO
+    gyro->fifoReadFn = mpuGyroReadFifo;
+#endif
 
     return true;
 }
@@ -27,6 +27,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <math.h>
 
 #include "platform.h"
 
@@ -47,6 +48,56 @@ bool gyroSyncCheckUpdate(gyroDev_t *gyro)
     return ret;
 }
 
+#ifdef USE_GYRO_ODR_TRACKING
+// Long enough for the latency of the data ready interrupt to average out
+#define GYRO_ODR_WINDOW_US          1000000
+// Windows further off the nominal rate had data ready interrupts blocked or missed
+#define GYRO_ODR_MAX_ERROR          0.02f
+#define GYRO_ODR_SMOOTHING          0.25f
+
+/*
+ * The gyro samples on its own oscillator, which drifts from the MCU clock, so the actual output data rate differs
+ * slightly from the nominal one. It's measured from the data ready interrupts counted over a window. Returns true when
+ * the measured sample period has been updated.
+ */
+bool gyroSyncTrackOdr(gyroOdrTracker_t *tracker, const gyroDev_t *gyro, float nominalSamplePeriodUs)
+{
+    const uint32_t count = gyro->dataReadyCount;
+    const timeUs_t timeUs = gyro->dataReadyTimeUs;
+    if (count != gyro->dataReadyCount || count == 0) {
+        // The interrupt fired between the reads or never did, e.g. the samples are read from the FIFO
+        return false;
+    }
+
+    if (tracker->windowStartCount == 0) {
+        tracker->windowStartUs = timeUs;
+        tracker->windowStartCount = count;
+        return false;
+    }
+
+    const timeDelta_t windowUs = cmpTimeUs(timeUs, tracker->windowStartUs);
+    if (windowUs < GYRO_ODR_WINDOW_US) {
+        return false;
+    }
+
+    const float samplePeriodUs = (float)windowUs / (count - tracker->windowStartCount);
+    tracker->windowStartUs = timeUs;
+    tracker->windowStartCount = count;
+
+    if (fabsf(samplePeriodUs - nominalSamplePeriodUs) > nominalSamplePeriodUs * GYRO_ODR_MAX_ERROR) {
+        return false;
+    }
+
+    if (tracker->samplePeriodUs == 0) {
+        tracker->samplePeriodUs = samplePeriodUs;
+    } else {
+        tracker->samplePeriodUs += GYRO_ODR_SMOOTHING * (samplePeriodUs - tracker->samplePeriodUs);
+    }
+
+    return true;
+}
+#endif
+
 uint32_t gyroSetSampleRate(gyroDev_t *gyro, uint8_t lpf, uint8_t gyroSyncDenominator)
 {
     float gyroSamplePeriod;
@@ -31,3 +31,13 @@
 
 bool gyroSyncCheckUpdate(gyroDev_t *gyro);
 uint32_t gyroSetSampleRate(gyroDev_t *gyro, uint8_t lpf, uint8_t gyroSyncDenominator);
+
+#ifdef USE_GYRO_ODR_TRACKING
+typedef struct gyroOdrTracker_s {
+    timeUs_t windowStartUs;
+    uint32_t windowStartCount;
+    float samplePeriodUs;       // measured time between gyro samples, 0 until measured
+} gyroOdrTracker_t;
+
+bool gyroSyncTrackOdr(gyroOdrTracker_t *tracker, const gyroDev_t *gyro, float nominalSamplePeriodUs);
+#endif
@@ -101,6 +101,25 @@ uint16_t adcGetChannel(uint8_t channel)
     return adcValues[adcOperatingConfig[channel].dmaIndex];
 }
 
+#if defined(STM32F4) || defined(STM32F7)
+void adcAverageConversions(const volatile uint16_t *conversionBuffer, uint8_t channelCount)
+{
+    if (!channelCount) {
+        return;
+    }
+
+    const unsigned scanCount = ADC_SCAN_COUNT(channelCount);
+
+    for (unsigned dmaIndex = 0; dmaIndex < channelCount; dmaIndex++) {
+        uint32_t sum = 0;
+        for (unsigned scan = 0; scan < scanCount; scan++) {
+            sum += conversionBuffer[scan * channelCount + dmaIndex];
+        }
+        adcValues[dmaIndex] = (sum + scanCount / 2) / scanCount;
+    }
+}
+#endif
+
 // Verify a pin designated by tag has connection to an ADC instance designated by device
 
 bool adcVerifyPin(ioTag_t tag, ADCDevice device)
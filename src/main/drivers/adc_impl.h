@@ -99,6 +99,15 @@ bool adcVerifyPin(ioTag_t tag, ADCDevice device);
 // Required for multi DMA instance implementation
 void adcGetChannelValues(void);
 
+#if defined(STM32F4) || defined(STM32F7)
+// The DMA runs continuously over a buffer of consecutive scans of the channels, about 20ms of
+// conversions, that is averaged when the values are read so that spikes between reads count
+#define ADC_CONVERSION_BUFFER_LENGTH 512
+#define ADC_SCAN_COUNT(channelCount) (ADC_CONVERSION_BUFFER_LENGTH / (channelCount))
+
+void adcAverageConversions(const volatile uint16_t *conversionBuffer, uint8_t channelCount);
+#endif
+
 //
 // VREFINT and TEMPSENSOR related definitions
 // These are shared among common adc.c and MCU dependent adc_stm32XXX.c
@@ -208,6 +208,9 @@ uint16_t adcInternalReadTempsensor(void)
 }
 #endif
 
+static volatile uint16_t adcConversionBuffer[ADC_CONVERSION_BUFFER_LENGTH];
+static uint8_t adcScanChannelCount;
+
 void adcInit(const adcConfig_t *config)
 {
     uint8_t i;
@@ -328,11 +331,13 @@ void adcInit(const adcConfig_t *config)
     DMA_InitStructure.DMA_Channel = adc.channel;
 #endif
 
-    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)adcValues;
+    adcScanChannelCount = configuredAdcChannels;
+
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)adcConversionBuffer;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
-    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels;
+    DMA_InitStructure.DMA_BufferSize = ADC_SCAN_COUNT(configuredAdcChannels) * configuredAdcChannels;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = configuredAdcChannels > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -351,6 +356,6 @@ void adcInit(const adcConfig_t *config)
 
 void adcGetChannelValues(void)
 {
-    // Nothing to do
+    adcAverageConversions(adcConversionBuffer, adcScanChannelCount);
 }
 #endif
@@ -202,6 +202,9 @@ uint16_t adcInternalReadTempsensor(void)
 }
 #endif
 
+static volatile FAST_RAM_ZERO_INIT uint16_t adcConversionBuffer[ADC_CONVERSION_BUFFER_LENGTH];
+static uint8_t adcScanChannelCount;
+
 void adcInit(const adcConfig_t *config)
 {
     uint8_t i;
@@ -303,7 +306,7 @@ void adcInit(const adcConfig_t *config)
 
     adc.DmaHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
     adc.DmaHandle.Init.PeriphInc = DMA_PINC_DISABLE;
-    adc.DmaHandle.Init.MemInc = configuredAdcChannels > 1 ? DMA_MINC_ENABLE : DMA_MINC_DISABLE;
+    adc.DmaHandle.Init.MemInc = DMA_MINC_ENABLE;
     adc.DmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
     adc.DmaHandle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
     adc.DmaHandle.Init.Mode = DMA_CIRCULAR;
@@ -321,9 +324,9 @@ void adcInit(const adcConfig_t *config)
 
     __HAL_LINKDMA(&adc.ADCHandle, DMA_Handle, adc.DmaHandle);
 
-    //HAL_CLEANINVALIDATECACHE((uint32_t*)&adcValues, configuredAdcChannels);
+    adcScanChannelCount = configuredAdcChannels;
 
-    if (HAL_ADC_Start_DMA(&adc.ADCHandle, (uint32_t*)&adcValues, configuredAdcChannels) != HAL_OK)
+    if (HAL_ADC_Start_DMA(&adc.ADCHandle, (uint32_t*)&adcConversionBuffer, ADC_SCAN_COUNT(configuredAdcChannels) * configuredAdcChannels) != HAL_OK)
     {
         /* Start Conversion Error */
     }
@@ -331,6 +334,6 @@ void adcInit(const adcConfig_t *config)
 
 void adcGetChannelValues(void)
 {
-    // Nothing to do
+    adcAverageConversions(adcConversionBuffer, adcScanChannelCount);
 }
 #endif
@@ -25,7 +25,7 @@
 
 struct baroDev_s;
 
-typedef void (*baroOpFuncPtr)(struct baroDev_s *baro);                       // baro start operation
+typedef bool (*baroOpFuncPtr)(struct baroDev_s *baro);                       // baro start operation, false if the bus was busy
 typedef bool (*baroGetFuncPtr)(struct baroDev_s *baro);                       // baro read/get operation
 typedef void (*baroCalculateFuncPtr)(int32_t *pressure, int32_t *temperature); // baro calculation (filled params are pressure and temperature)
 
@@ -125,10 +125,10 @@ STATIC_UNIT_TESTED uint16_t bmp085_ut;  // static result of temperature measurem
 STATIC_UNIT_TESTED uint32_t bmp085_up;  // static result of pressure measurement
 
 static void bmp085ReadCalibrarionParameters(busDevice_t *busdev);
-static void bmp085StartUT(baroDev_t *baro);
+static bool bmp085StartUT(baroDev_t *baro);
 static bool bmp085ReadUT(baroDev_t *baro);
 static bool bmp085GetUT(baroDev_t *baro);
-static void bmp085StartUP(baroDev_t *baro);
+static bool bmp085StartUP(baroDev_t *baro);
 static bool bmp085ReadUP(baroDev_t *baro);
 static bool bmp085GetUP(baroDev_t *baro);
 static int32_t bmp085GetTemperature(uint32_t ut);
@@ -278,11 +278,11 @@ static int32_t bmp085GetPressure(uint32_t up)
     return pressure;
 }
 
-static void bmp085StartUT(baroDev_t *baro)
+static bool bmp085StartUT(baroDev_t *baro)
 {
     isConversionComplete = false;
 
-    busWriteRegisterStart(&baro->busdev, BMP085_CTRL_MEAS_REG, BMP085_T_MEASURE);
+    return busWriteRegisterStart(&baro->busdev, BMP085_CTRL_MEAS_REG, BMP085_T_MEASURE);
 }
 
 static bool bmp085ReadUT(baroDev_t *baro)
@@ -312,7 +312,7 @@ static bool bmp085GetUT(baroDev_t *baro)
     return true;
 }
 
-static void bmp085StartUP(baroDev_t *baro)
+static bool bmp085StartUP(baroDev_t *baro)
 {
     uint8_t ctrl_reg_data;
 
@@ -320,7 +320,7 @@ static void bmp085StartUP(baroDev_t *baro)
 
     isConversionComplete = false;
 
-    busWriteRegisterStart(&baro->busdev, BMP085_CTRL_MEAS_REG, ctrl_reg_data);
+    return busWriteRegisterStart(&baro->busdev, BMP085_CTRL_MEAS_REG, ctrl_reg_data);
 }
 
 static bool bmp085ReadUP(baroDev_t *baro)
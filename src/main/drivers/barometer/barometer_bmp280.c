@@ -105,10 +105,10 @@ int32_t bmp280_up = 0;
 int32_t bmp280_ut = 0;
 static uint8_t sensor_data[BMP280_DATA_FRAME_SIZE];
 
-static void bmp280StartUT(baroDev_t *baro);
+static bool bmp280StartUT(baroDev_t *baro);
 static bool bmp280ReadUT(baroDev_t *baro);
 static bool bmp280GetUT(baroDev_t *baro);
-static void bmp280StartUP(baroDev_t *baro);
+static bool bmp280StartUP(baroDev_t *baro);
 static bool bmp280ReadUP(baroDev_t *baro);
 static bool bmp280GetUP(baroDev_t *baro);
 
@@ -192,10 +192,11 @@ bool bmp280Detect(baroDev_t *baro)
     return true;
 }
 
-static void bmp280StartUT(baroDev_t *baro)
+static bool bmp280StartUT(baroDev_t *baro)
 {
     UNUSED(baro);
     // dummy
+    return true;
 }
 
 static bool bmp280ReadUT(baroDev_t *baro)
@@ -212,11 +213,11 @@ static bool bmp280GetUT(baroDev_t *baro)
     return true;
 }
 
-static void bmp280StartUP(baroDev_t *baro)
+static bool bmp280StartUP(baroDev_t *baro)
 {
     // start measurement
     // set oversampling + power mode (forced), and start sampling
-    busWriteRegisterStart(&baro->busdev, BMP280_CTRL_MEAS_REG, BMP280_MODE);
+    return busWriteRegisterStart(&baro->busdev, BMP280_CTRL_MEAS_REG, BMP280_MODE);
 }
 
 static bool bmp280ReadUP(baroDev_t *baro)
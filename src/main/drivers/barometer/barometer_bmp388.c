@@ -169,10 +169,10 @@ static uint8_t sensor_data[BMP388_DATA_FRAME_SIZE];
 
 STATIC_UNIT_TESTED int64_t t_lin = 0;
 
-static void bmp388StartUT(baroDev_t *baro);
+static bool bmp388StartUT(baroDev_t *baro);
 static bool bmp388GetUT(baroDev_t *baro);
 static bool bmp388ReadUT(baroDev_t *baro);
-static void bmp388StartUP(baroDev_t *baro);
+static bool bmp388StartUP(baroDev_t *baro);
 static bool bmp388GetUP(baroDev_t *baro);
 static bool bmp388ReadUP(baroDev_t *baro);
 
@@ -219,11 +219,11 @@ void bmp388BusDeinit(busDevice_t *busdev)
 #endif
 }
 
-void bmp388BeginForcedMeasurement(busDevice_t *busdev)
+bool bmp388BeginForcedMeasurement(busDevice_t *busdev)
 {
     // enable pressure measurement, temperature measurement, set power mode and start sampling
     uint8_t mode = BMP388_MODE_FORCED << 4 | 1 << 1 | 1 << 0;
-    busWriteRegisterStart(busdev, BMP388_PWR_CTRL_REG, mode);
+    return busWriteRegisterStart(busdev, BMP388_PWR_CTRL_REG, mode);
 }
 
 bool bmp388Detect(const bmp388Config_t *config, baroDev_t *baro)
@@ -309,10 +309,11 @@ bool bmp388Detect(const bmp388Config_t *config, baroDev_t *baro)
     return true;
 }
 
-static void bmp388StartUT(baroDev_t *baro)
+static bool bmp388StartUT(baroDev_t *baro)
 {
     UNUSED(baro);
     // dummy
+    return true;
 }
 
 static bool bmp388ReadUT(baroDev_t *baro)
@@ -329,10 +330,10 @@ static bool bmp388GetUT(baroDev_t *baro)
     return true;
 }
 
-static void bmp388StartUP(baroDev_t *baro)
+static bool bmp388StartUP(baroDev_t *baro)
 {
     // start measurement
-    bmp388BeginForcedMeasurement(&baro->busdev);
+    return bmp388BeginForcedMeasurement(&baro->busdev);
 }
 
 static bool bmp388ReadUP(baroDev_t *baro)
@@ -35,9 +35,11 @@ static int32_t fakePressure;
 static int32_t fakeTemperature;
 
 
-static void fakeBaroStart(baroDev_t *baro)
+static bool fakeBaroStart(baroDev_t *baro)
 {
     UNUSED(baro);
+
+    return true;
 }
 
 static bool fakeBaroReadGet(baroDev_t *baro)
@@ -56,10 +56,10 @@ static void ms5611Reset(busDevice_t *busdev);
 static uint16_t ms5611Prom(busDevice_t *busdev, int8_t coef_num);
 STATIC_UNIT_TESTED int8_t ms5611CRC(uint16_t *prom);
 static void ms5611ReadAdc(busDevice_t *busdev);
-static void ms5611StartUT(baroDev_t *baro);
+static bool ms5611StartUT(baroDev_t *baro);
 static bool ms5611ReadUT(baroDev_t *baro);
 static bool ms5611GetUT(baroDev_t *baro);
-static void ms5611StartUP(baroDev_t *baro);
+static bool ms5611StartUP(baroDev_t *baro);
 static bool ms5611ReadUP(baroDev_t *baro);
 static bool ms5611GetUP(baroDev_t *baro);
 STATIC_UNIT_TESTED void ms5611Calculate(int32_t *pressure, int32_t *temperature);
@@ -207,9 +207,9 @@ static void ms5611ReadAdc(busDevice_t *busdev)
     busReadRegisterBufferStart(busdev, CMD_ADC_READ, sensor_data, MS5611_DATA_FRAME_SIZE); // read ADC
 }
 
-static void ms5611StartUT(baroDev_t *baro)
+static bool ms5611StartUT(baroDev_t *baro)
 {
-    busWriteRegisterStart(&baro->busdev, CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr, 1); // D2 (temperature) conversion start!
+    return busWriteRegisterStart(&baro->busdev, CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr, 1); // D2 (temperature) conversion start!
 }
 
 static bool ms5611ReadUT(baroDev_t *baro)
@@ -231,9 +231,9 @@ static bool ms5611GetUT(baroDev_t *baro)
     return true;
 }
 
-static void ms5611StartUP(baroDev_t *baro)
+static bool ms5611StartUP(baroDev_t *baro)
 {
-    busWriteRegister(&baro->busdev, CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr, 1); // D1 (pressure) conversion start!
+    return busWriteRegisterStart(&baro->busdev, CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr, 1); // D1 (pressure) conversion start!
 }
 
 static bool ms5611ReadUP(baroDev_t *baro)
@@ -93,10 +93,10 @@ int32_t qmp6988_up = 0;
 int32_t qmp6988_ut = 0;
 static uint8_t sensor_data[QMP6988_DATA_FRAME_SIZE];
 
-static void qmp6988StartUT(baroDev_t *baro);
+static bool qmp6988StartUT(baroDev_t *baro);
 static bool qmp6988ReadUT(baroDev_t *baro);
 static bool qmp6988GetUT(baroDev_t *baro);
-static void qmp6988StartUP(baroDev_t *baro);
+static bool qmp6988StartUP(baroDev_t *baro);
 static bool qmp6988ReadUP(baroDev_t *baro);
 static bool qmp6988GetUP(baroDev_t *baro);
 
@@ -278,10 +278,11 @@ bool qmp6988Detect(baroDev_t *baro)
     return true;
 }
 
-static void qmp6988StartUT(baroDev_t *baro)
+static bool qmp6988StartUT(baroDev_t *baro)
 {
     UNUSED(baro);
     // dummy
+    return true;
 }
 
 static bool qmp6988ReadUT(baroDev_t *baro)
@@ -298,10 +299,10 @@ static bool qmp6988GetUT(baroDev_t *baro)
     return true;
 }
 
-static void qmp6988StartUP(baroDev_t *baro)
+static bool qmp6988StartUP(baroDev_t *baro)
 {
     // start measurement
-    busWriteRegister(&baro->busdev, QMP6988_CTRL_MEAS_REG, QMP6988_PWR_SAMPLE_MODE);
+    return busWriteRegisterStart(&baro->busdev, QMP6988_CTRL_MEAS_REG, QMP6988_PWR_SAMPLE_MODE);
 }
 
 static bool qmp6988ReadUP(baroDev_t *baro)
@@ -49,6 +49,7 @@ typedef struct busDevice_s {
             SPI_HandleTypeDef* handle; // cached here for efficiency
 #endif
             IO_t csnPin;
+            uint8_t priority;          // spiPriority_e, the queue the device's sequences wait in
         } spi;
         struct deviceI2C_s {
             I2CDevice device;
@@ -36,12 +36,8 @@ bool i2cBusWriteRegister(const busDevice_t *busdev, uint8_t reg, uint8_t data)
 
 bool i2cBusWriteRegisterStart(const busDevice_t *busdev, uint8_t reg, uint8_t data)
 {
-    // Need a static value, not on the stack
-    static uint8_t byte;
-
-    byte = data;
-
-    return i2cWriteBuffer(busdev->busdev_u.i2c.device, busdev->busdev_u.i2c.address, reg, sizeof (byte), &byte);
+    // The drivers have sent or taken a copy of a short write on return, so the value can be on the stack
+    return i2cWriteBuffer(busdev->busdev_u.i2c.device, busdev->busdev_u.i2c.address, reg, sizeof (data), &data);
 }
 
 bool i2cBusReadRegisterBuffer(const busDevice_t *busdev, uint8_t reg, uint8_t *data, uint8_t length)
@@ -26,6 +26,8 @@
 
 #if defined(USE_I2C) && !defined(SOFT_I2C)
 
+#include "common/utils.h"
+
 #include "drivers/io.h"
 #include "drivers/io_impl.h"
 #include "drivers/nvic.h"
@@ -210,135 +212,73 @@ static bool i2cHandleHardwareFailure(I2CDevice device)
     return false;
 }
 
-// Blocking write
-bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
+bool i2cStartTransfer(I2CDevice device, const i2cTransfer_t *transfer)
 {
-    if (device == I2CINVALID || device > I2CDEV_COUNT) {
-        return false;
-    }
-
     I2C_HandleTypeDef *pHandle = &i2cDevice[device].handle;
-
-    if (!pHandle->Instance) {
-        return false;
-    }
+    const uint16_t addr = transfer->addr << 1;
 
     HAL_StatusTypeDef status;
 
-    if (reg_ == 0xFF)
-        status = HAL_I2C_Master_Transmit(pHandle ,addr_ << 1, &data, 1, I2C_DEFAULT_TIMEOUT);
-    else
-        status = HAL_I2C_Mem_Write(pHandle ,addr_ << 1, reg_, I2C_MEMADD_SIZE_8BIT, &data, 1, I2C_DEFAULT_TIMEOUT);
-
-    if (status != HAL_OK)
-        return i2cHandleHardwareFailure(device);
-
-    return true;
-}
-
-// Non-blocking write
-bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
-{
-    if (device == I2CINVALID || device > I2CDEV_COUNT) {
-        return false;
-    }
-
-    I2C_HandleTypeDef *pHandle = &i2cDevice[device].handle;
-
-    if (!pHandle->Instance) {
-        return false;
-    }
-
-    HAL_StatusTypeDef status;
-
-    status = HAL_I2C_Mem_Write_IT(pHandle ,addr_ << 1, reg_, I2C_MEMADD_SIZE_8BIT,data, len_);
-
-    if (status == HAL_BUSY) {
-        return false;
+    if (transfer->reading) {
+        if (transfer->reg == 0xFF)
+            status = HAL_I2C_Master_Receive_IT(pHandle, addr, transfer->data, transfer->len);
+        else
+            status = HAL_I2C_Mem_Read_IT(pHandle, addr, transfer->reg, I2C_MEMADD_SIZE_8BIT, transfer->data, transfer->len);
+    } else {
+        if (transfer->reg == 0xFF)
+            status = HAL_I2C_Master_Transmit_IT(pHandle, addr, transfer->data, transfer->len);
+        else
+            status = HAL_I2C_Mem_Write_IT(pHandle, addr, transfer->reg, I2C_MEMADD_SIZE_8BIT, transfer->data, transfer->len);
     }
 
-    if (status != HAL_OK)
-    {
+    if (status != HAL_OK) {
         return i2cHandleHardwareFailure(device);
     }
 
     return true;
 }
 
-// Blocking read
-bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
+void i2cResetBus(I2CDevice device)
 {
-    if (device == I2CINVALID || device > I2CDEV_COUNT) {
-        return false;
-    }
-
-    I2C_HandleTypeDef *pHandle = &i2cDevice[device].handle;
-
-    if (!pHandle->Instance) {
-        return false;
-    }
-
-    HAL_StatusTypeDef status;
-
-    if (reg_ == 0xFF)
-        status = HAL_I2C_Master_Receive(pHandle ,addr_ << 1, buf, len, I2C_DEFAULT_TIMEOUT);
-    else
-        status = HAL_I2C_Mem_Read(pHandle, addr_ << 1, reg_, I2C_MEMADD_SIZE_8BIT,buf, len, I2C_DEFAULT_TIMEOUT);
-
-    if (status != HAL_OK) {
-        return i2cHandleHardwareFailure(device);
-    }
+    const i2cHardware_t *hardware = i2cDevice[device].hardware;
 
-    return true;
+    // keep the handlers off the handle while it is reset, i2cInit enables them again
+    HAL_NVIC_DisableIRQ(hardware->ev_irq);
+    HAL_NVIC_DisableIRQ(hardware->er_irq);
+    i2cHandleHardwareFailure(device);
+    i2cInit(device);
 }
 
-// Non-blocking read
-bool i2cReadBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
+static I2CDevice i2cDeviceFromHandle(I2C_HandleTypeDef *hi2c)
 {
-    if (device == I2CINVALID || device > I2CDEV_COUNT) {
-        return false;
-    }
-
-    I2C_HandleTypeDef *pHandle = &i2cDevice[device].handle;
-
-    if (!pHandle->Instance) {
-        return false;
-    }
-
-    HAL_StatusTypeDef status;
-
-    status = HAL_I2C_Mem_Read_IT(pHandle, addr_ << 1, reg_, I2C_MEMADD_SIZE_8BIT,buf, len);
+    return container_of(hi2c, i2cDevice_t, handle) - i2cDevice;
+}
 
-    if (status == HAL_BUSY) {
-        return false;
-    }
+// The HAL calls these from the interrupt handlers with the handle ready for the next transfer
 
-    if (status != HAL_OK) {
-        return i2cHandleHardwareFailure(device);
-    }
-
-    return true;
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cTransferComplete(i2cDeviceFromHandle(hi2c), false);
 }
 
-bool i2cBusy(I2CDevice device, bool *error)
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
-    I2C_HandleTypeDef *pHandle = &i2cDevice[device].handle;
-
-    if (error) {
-        *error = pHandle->ErrorCode;
-    }
+    i2cTransferComplete(i2cDeviceFromHandle(hi2c), false);
+}
 
-    if (pHandle->State == HAL_I2C_STATE_READY)
-    {
-        if (__HAL_I2C_GET_FLAG(pHandle, I2C_FLAG_BUSY) == SET)
-        {
-            return true;
-        }
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cTransferComplete(i2cDeviceFromHandle(hi2c), false);
+}
 
-        return false;
-    }
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cTransferComplete(i2cDeviceFromHandle(hi2c), false);
+}
 
-    return true;
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    i2cTransferComplete(i2cDeviceFromHandle(hi2c), true);
 }
 
 void i2cInit(I2CDevice device)
@@ -22,6 +22,8 @@
 
 #include "platform.h"
 
+#include "common/time.h"
+
 #include "drivers/io_types.h"
 #include "drivers/rcc_types.h"
 
@@ -74,6 +76,37 @@ typedef struct i2cState_s {
 } i2cState_t;
 #endif
 
+#if defined(STM32F1) || defined(STM32F4) || defined(USE_HAL_DRIVER)
+// The interrupt driven drivers queue the transfers of all the devices on a bus, so that a
+// task starts a transfer and carries on while the transfers queued before it complete
+#define I2C_QUEUE_LENGTH            8   // power of 2
+#define I2C_TRANSFER_COPY_LENGTH    8   // writes up to this length are copied into the queue
+#define I2C_TRANSFER_TIMEOUT_US     10000
+
+typedef struct i2cTransfer_s {
+    uint8_t *data;
+    uint8_t copy[I2C_TRANSFER_COPY_LENGTH];
+    uint8_t addr;
+    uint8_t reg;
+    uint8_t len;
+    bool reading;
+    volatile bool error;
+} i2cTransfer_t;
+
+typedef struct i2cQueue_s {
+    i2cTransfer_t transfer[I2C_QUEUE_LENGTH];
+    volatile uint8_t head;          // transfer on the bus, advanced by the interrupt handlers
+    volatile uint8_t tail;          // next free entry, advanced by the tasks
+    volatile bool active;
+    volatile bool error;            // a transfer failed since the queue was last idle
+    volatile uint32_t completed;
+    uint32_t queued;
+    // progress supervision, task side only
+    uint32_t lastCompleted;
+    timeUs_t lastProgressUs;
+} i2cQueue_t;
+#endif
+
 typedef struct i2cDevice_s {
     const i2cHardware_t *hardware;
     I2C_TypeDef *reg;
@@ -93,6 +126,18 @@ typedef struct i2cDevice_s {
 #ifdef USE_HAL_DRIVER
     I2C_HandleTypeDef handle;
 #endif
+#if defined(STM32F1) || defined(STM32F4) || defined(USE_HAL_DRIVER)
+    i2cQueue_t queue;
+#endif
 } i2cDevice_t;
 
 extern i2cDevice_t i2cDevice[];
+
+#if defined(STM32F1) || defined(STM32F4) || defined(USE_HAL_DRIVER)
+// Implemented by the MCU driver, start the transfer on an idle bus, or reset a stuck bus
+bool i2cStartTransfer(I2CDevice device, const i2cTransfer_t *transfer);
+void i2cResetBus(I2CDevice device);
+
+// Called by the MCU driver when the transfer on the bus has finished, starts the next one
+void i2cTransferComplete(I2CDevice device, bool error);
+#endif
@@ -0,0 +1,207 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if defined(USE_I2C) && !defined(SOFT_I2C)
+
+#include "drivers/time.h"
+
+#include "drivers/bus_i2c.h"
+#include "drivers/bus_i2c_impl.h"
+
+#define I2C_QUEUE_NEXT(index) (((index) + 1) & (I2C_QUEUE_LENGTH - 1))
+
+// The queue always has a single producer and a single consumer. Transfers are added at the tail
+// by the tasks only, and removed at the head by the interrupt handlers only. A task only starts
+// a transfer itself when the queue is not active, when no interrupt is touching the queue.
+
+static bool i2cDeviceValid(I2CDevice device)
+{
+    return device != I2CINVALID && device < I2CDEV_COUNT && i2cDevice[device].hardware;
+}
+
+// Called with the transfer at the head finished, starts the next queued transfer if there is one
+void i2cTransferComplete(I2CDevice device, bool error)
+{
+    i2cQueue_t *queue = &i2cDevice[device].queue;
+
+    while (true) {
+        queue->transfer[queue->head].error = error;
+        queue->error |= error;
+        queue->head = I2C_QUEUE_NEXT(queue->head);
+        queue->completed++;
+
+        if (queue->head == queue->tail) {
+            queue->active = false;
+            return;
+        }
+        if (i2cStartTransfer(device, &queue->transfer[queue->head])) {
+            return;
+        }
+        error = true;
+    }
+}
+
+// A transfer that does not complete in time leaves the bus busy for good, so reset the bus
+// and fail the transfer. Only called from the tasks, the reset leaves the interrupts of the
+// bus disabled so the queue is the task's until the next transfer is started.
+static void i2cCheckProgress(I2CDevice device)
+{
+    i2cQueue_t *queue = &i2cDevice[device].queue;
+    const timeUs_t currentTimeUs = micros();
+
+    if (!queue->active || queue->completed != queue->lastCompleted) {
+        queue->lastCompleted = queue->completed;
+        queue->lastProgressUs = currentTimeUs;
+    } else if (cmpTimeUs(currentTimeUs, queue->lastProgressUs) >= I2C_TRANSFER_TIMEOUT_US) {
+        i2cResetBus(device);
+        if (queue->active) {
+            i2cTransferComplete(device, true);
+        }
+        queue->lastCompleted = queue->completed;
+        queue->lastProgressUs = currentTimeUs;
+    }
+}
+
+static i2cTransfer_t *i2cQueueTransfer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t *data, bool reading)
+{
+    if (!i2cDeviceValid(device)) {
+        return NULL;
+    }
+
+    i2cQueue_t *queue = &i2cDevice[device].queue;
+
+    const uint8_t tail = queue->tail;
+    if (I2C_QUEUE_NEXT(tail) == queue->head) {
+        i2cCheckProgress(device);
+        return NULL;
+    }
+
+    i2cTransfer_t *transfer = &queue->transfer[tail];
+    transfer->addr = addr_;
+    transfer->reg = reg_;
+    transfer->len = len;
+    transfer->reading = reading;
+    transfer->error = false;
+    if (!reading && len <= I2C_TRANSFER_COPY_LENGTH) {
+        // the caller's buffer is free as soon as the transfer is queued
+        memcpy(transfer->copy, data, len);
+        transfer->data = transfer->copy;
+    } else {
+        transfer->data = data;
+    }
+    queue->queued++;
+
+    // publish the transfer before looking at the queue state, if the queue is still active the
+    // interrupt handler that completes the transfer before it sees this one and starts it
+    __DMB();
+    queue->tail = I2C_QUEUE_NEXT(tail);
+
+    if (!queue->active) {
+        queue->error = false;
+        queue->active = true;
+        if (!i2cStartTransfer(device, transfer)) {
+            i2cTransferComplete(device, true);
+        }
+    }
+
+    return transfer;
+}
+
+// Waits for the transfer, and the ones queued before it, to complete
+static bool i2cWaitTransfer(I2CDevice device, const i2cTransfer_t *transfer)
+{
+    i2cQueue_t *queue = &i2cDevice[device].queue;
+    const uint32_t ticket = queue->queued;
+
+    while ((int32_t)(queue->completed - ticket) < 0) {
+        i2cCheckProgress(device);
+    }
+
+    return !transfer->error;
+}
+
+// Non-blocking write, false if the queue is full
+bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+{
+    return i2cQueueTransfer(device, addr_, reg_, len_, data, false) != NULL;
+}
+
+// Non-blocking read, the buffer must stay valid until the transfer completes
+bool i2cReadBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
+{
+    return i2cQueueTransfer(device, addr_, reg_, len, buf, true) != NULL;
+}
+
+// Blocking write
+bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
+{
+    const i2cTransfer_t *transfer;
+
+    while (!(transfer = i2cQueueTransfer(device, addr_, reg_, 1, &data, false))) {
+        if (!i2cDeviceValid(device)) {
+            return false;
+        }
+    }
+
+    return i2cWaitTransfer(device, transfer);
+}
+
+// Blocking read
+bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
+{
+    const i2cTransfer_t *transfer;
+
+    while (!(transfer = i2cQueueTransfer(device, addr_, reg_, len, buf, true))) {
+        if (!i2cDeviceValid(device)) {
+            return false;
+        }
+    }
+
+    return i2cWaitTransfer(device, transfer);
+}
+
+// Busy until all the queued transfers have completed, the error is set if any of them failed
+bool i2cBusy(I2CDevice device, bool *error)
+{
+    if (!i2cDeviceValid(device)) {
+        if (error) {
+            *error = true;
+        }
+        return false;
+    }
+
+    i2cQueue_t *queue = &i2cDevice[device].queue;
+
+    i2cCheckProgress(device);
+
+    if (error) {
+        *error = queue->error;
+    }
+
+    return queue->active;
+}
+
+#endif
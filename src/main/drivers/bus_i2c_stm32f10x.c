@@ -161,32 +161,20 @@ static bool i2cHandleHardwareFailure(I2CDevice device)
     return false;
 }
 
-bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+bool i2cStartTransfer(I2CDevice device, const i2cTransfer_t *transfer)
 {
-    if (device == I2CINVALID || device > I2CDEV_COUNT) {
-        return false;
-    }
-
     I2C_TypeDef *I2Cx = i2cDevice[device].reg;
-
-    if (!I2Cx) {
-        return false;
-    }
-
     i2cState_t *state = &i2cDevice[device].state;
-    if (state->busy) {
-        return false;
-    }
 
     uint32_t timeout = I2C_DEFAULT_TIMEOUT;
 
-    state->addr = addr_ << 1;
-    state->reg = reg_;
-    state->writing = 1;
-    state->reading = 0;
-    state->write_p = data;
-    state->read_p = data;
-    state->bytes = len_;
+    state->addr = transfer->addr << 1;
+    state->reg = transfer->reg;
+    state->writing = !transfer->reading;
+    state->reading = transfer->reading;
+    state->write_p = transfer->data;
+    state->read_p = transfer->data;
+    state->bytes = transfer->len;
     state->busy = 1;
     state->error = false;
 
@@ -203,77 +191,14 @@ bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_,
     return true;
 }
 
-bool i2cBusy(I2CDevice device, bool *error)
+void i2cResetBus(I2CDevice device)
 {
-    i2cState_t *state = &i2cDevice[device].state;
-
-    if (error) {
-        *error = state->error;
-    }
-    return state->busy;
-}
-
-bool i2cWait(I2CDevice device)
-{
-    i2cState_t *state = &i2cDevice[device].state;
-    uint32_t timeout = I2C_DEFAULT_TIMEOUT;
-
-    while (state->busy && --timeout > 0) {; }
-    if (timeout == 0)
-        return i2cHandleHardwareFailure(device) && i2cWait(device);
-
-    return !(state->error);
-}
-
-bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
-{
-    return i2cWriteBuffer(device, addr_, reg_, 1, &data) && i2cWait(device);
-}
-
-bool i2cReadBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
-{
-    if (device == I2CINVALID || device > I2CDEV_COUNT) {
-        return false;
-    }
-
-    I2C_TypeDef *I2Cx = i2cDevice[device].reg;
-    if (!I2Cx) {
-        return false;
-    }
-
-    i2cState_t *state = &i2cDevice[device].state;
-    if (state->busy) {
-        return false;
-    }
+    const i2cHardware_t *hw = i2cDevice[device].hardware;
 
-    uint32_t timeout = I2C_DEFAULT_TIMEOUT;
-
-    state->addr = addr_ << 1;
-    state->reg = reg_;
-    state->writing = 0;
-    state->reading = 1;
-    state->read_p = buf;
-    state->write_p = buf;
-    state->bytes = len;
-    state->busy = 1;
-    state->error = false;
-
-    if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
-        if (!(I2Cx->CR1 & I2C_CR1_START)) {                             // ensure sending a start
-            while (I2Cx->CR1 & I2C_CR1_STOP && --timeout > 0) {; }     // wait for any stop to finish sending
-            if (timeout == 0)
-                return i2cHandleHardwareFailure(device);
-            I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
-        }
-        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
-    }
-
-    return true;
-}
-
-bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
-{
-    return i2cReadBuffer(device, addr_, reg_, len, buf) && i2cWait(device);
+    // keep the handlers off the state while it is reset, i2cInit enables them again
+    NVIC_DisableIRQ(hw->ev_irq);
+    NVIC_DisableIRQ(hw->er_irq);
+    i2cHandleHardwareFailure(device);
 }
 
 static void i2c_er_handler(I2CDevice device) {
@@ -281,6 +206,7 @@ static void i2c_er_handler(I2CDevice device) {
     I2C_TypeDef *I2Cx = i2cDevice[device].hardware->reg;
 
     i2cState_t *state = &i2cDevice[device].state;
+    const bool busy = state->busy;
 
     // Read the I2C1 status register
     volatile uint32_t SR1Register = I2Cx->SR1;
@@ -306,7 +232,10 @@ static void i2c_er_handler(I2CDevice device) {
         }
     }
     I2Cx->SR1 &= ~(I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR);     // reset all the error bits to clear the interrupt
-    state->busy = 0;
+    if (busy && (SR1Register & (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF))) {   // the job was abandoned, commence the next one
+        state->busy = 0;
+        i2cTransferComplete(device, true);
+    }
 }
 
 void i2c_ev_handler(I2CDevice device) {
@@ -421,6 +350,7 @@ void i2c_ev_handler(I2CDevice device) {
         if (final_stop)                                                 // If there is a final stop and no more jobs, bus is inactive, disable interrupts to prevent BTF
             I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, DISABLE);       // Disable EVT and ERR interrupts while bus inactive
         state->busy = 0;
+        i2cTransferComplete(device, state->error);                      // commence the next job if there is one
     }
 }
 
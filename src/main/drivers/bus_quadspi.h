@@ -115,10 +115,18 @@ bool quadSpiInstructionWithData1LINE(QUADSPI_TypeDef *instance, uint8_t instruct
 bool quadSpiReceiveWithAddress1LINE(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize, uint8_t *in, int length);
 bool quadSpiReceiveWithAddress4LINES(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize, uint8_t *in, int length);
 bool quadSpiTransmitWithAddress1LINE(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize, const uint8_t *out, int length);
+bool quadSpiTransmitWithAddress4LINES(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize, const uint8_t *out, int length);
 
 
 bool quadSpiInstructionWithAddress1LINE(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize);
 
+// Memory-mapped mode issues the given read instruction for every access to the mapped window, with
+// the offset into the window as the address. Only available with hardware chip select, any indirect
+// mode transfer leaves memory-mapped mode first.
+bool quadSpiEnableMemoryMapped4LINES(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint8_t addressSize);
+void quadSpiDisableMemoryMapped(QUADSPI_TypeDef *instance);
+const uint8_t *quadSpiMemoryMappedWindow(QUADSPI_TypeDef *instance);
+
 //bool quadSpiIsBusBusy(SPI_TypeDef *instance);
 
 uint16_t quadSpiGetErrorCounter(QUADSPI_TypeDef *instance);
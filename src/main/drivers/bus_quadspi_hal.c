@@ -27,6 +27,8 @@
 
 #ifdef USE_QUADSPI
 
+#include "common/utils.h"
+
 #include "bus_quadspi.h"
 #include "bus_quadspi_impl.h"
 #include "dma.h"
@@ -144,10 +146,85 @@ bool quadSpiIsBusBusy(QUADSPI_TypeDef *instance)
 
 #define QUADSPI_DEFAULT_TIMEOUT 10
 
+#define QUADSPI_MEMORY_MAPPED_TIMEOUT_CYCLES 32 // release CS this long after the last access, so the flash is not held selected by a prefetch
+
+static bool quadSpiHasHardwareCS(QUADSPIDevice device)
+{
+    const uint8_t csFlags = quadSpiConfig(device)->csFlags;
+    const bool bk1Hardware = (csFlags & QUADSPI_BK1_CS_MASK) == QUADSPI_BK1_CS_HARDWARE;
+    const bool bk2Hardware = (csFlags & QUADSPI_BK2_CS_MASK) == QUADSPI_BK2_CS_HARDWARE;
+
+    switch(quadSpiConfig(device)->mode) {
+    case QUADSPI_MODE_DUAL_FLASH:
+        return bk1Hardware && bk2Hardware;
+    case QUADSPI_MODE_BK1_ONLY:
+        return bk1Hardware;
+    case QUADSPI_MODE_BK2_ONLY:
+        return bk2Hardware;
+    }
+
+    return false;
+}
+
+void quadSpiDisableMemoryMapped(QUADSPI_TypeDef *instance)
+{
+    QUADSPIDevice device = quadSpiDeviceByInstance(instance);
+
+    if (quadSpiDevice[device].hquadSpi.State == HAL_QSPI_STATE_BUSY_MEM_MAPPED) {
+        HAL_QSPI_Abort(&quadSpiDevice[device].hquadSpi);
+    }
+}
+
+bool quadSpiEnableMemoryMapped4LINES(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint8_t addressSize)
+{
+    QUADSPIDevice device = quadSpiDeviceByInstance(instance);
+
+    // a software CS cannot follow the accesses the core makes to the window
+    if (!quadSpiHasHardwareCS(device)) {
+        return false;
+    }
+
+    quadSpiDisableMemoryMapped(instance);
+
+    QSPI_CommandTypeDef cmd;
+    cmd.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    cmd.AddressMode       = QSPI_ADDRESS_1_LINE;
+    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    cmd.DataMode          = QSPI_DATA_4_LINES;
+    cmd.DummyCycles       = dummyCycles;
+    cmd.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    cmd.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    cmd.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+    cmd.Instruction       = instruction;
+    cmd.AddressSize       = quadSpi_addressSizeFromValue(addressSize);
+
+    QSPI_MemoryMappedTypeDef memoryMapped;
+    memoryMapped.TimeOutActivation = QSPI_TIMEOUT_COUNTER_ENABLE;
+    memoryMapped.TimeOutPeriod     = QUADSPI_MEMORY_MAPPED_TIMEOUT_CYCLES;
+
+    if (HAL_QSPI_MemoryMapped(&quadSpiDevice[device].hquadSpi, &cmd, &memoryMapped) != HAL_OK) {
+        quadSpiTimeoutUserCallback(instance);
+        return false;
+    }
+
+    return true;
+}
+
+const uint8_t *quadSpiMemoryMappedWindow(QUADSPI_TypeDef *instance)
+{
+    UNUSED(instance);
+
+    return (const uint8_t *)QSPI_BASE;
+}
+
 void quadSpiSelectDevice(QUADSPI_TypeDef *instance)
 {
     QUADSPIDevice device = quadSpiDeviceByInstance(instance);
 
+    // every indirect mode transfer selects the device first
+    quadSpiDisableMemoryMapped(instance);
+
     IO_t bk1CS = IOGetByTag(quadSpiDevice[device].bk1CS);
     IO_t bk2CS = IOGetByTag(quadSpiDevice[device].bk2CS);
 
@@ -404,6 +481,46 @@ bool quadSpiTransmitWithAddress1LINE(QUADSPI_TypeDef *instance, uint8_t instruct
     return true;
 }
 
+bool quadSpiTransmitWithAddress4LINES(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize, const uint8_t *out, int length)
+{
+    QUADSPIDevice device = quadSpiDeviceByInstance(instance);
+    HAL_StatusTypeDef status;
+
+    QSPI_CommandTypeDef cmd;
+    cmd.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    cmd.AddressMode       = QSPI_ADDRESS_1_LINE;
+    cmd.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    cmd.DataMode          = QSPI_DATA_4_LINES;
+    cmd.DummyCycles       = dummyCycles;
+    cmd.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    cmd.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    cmd.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+    cmd.Instruction       = instruction;
+    cmd.Address           = address;
+    cmd.AddressSize       = quadSpi_addressSizeFromValue(addressSize);
+    cmd.NbData            = length;
+
+    quadSpiSelectDevice(instance);
+
+    status = HAL_QSPI_Command(&quadSpiDevice[device].hquadSpi, &cmd, QUADSPI_DEFAULT_TIMEOUT);
+    bool timeout = (status != HAL_OK);
+
+    if (!timeout) {
+        status = HAL_QSPI_Transmit(&quadSpiDevice[device].hquadSpi, (uint8_t *)out, QUADSPI_DEFAULT_TIMEOUT);
+        timeout = (status != HAL_OK);
+    }
+
+    quadSpiDeselectDevice(instance);
+
+    if (timeout) {
+        quadSpiTimeoutUserCallback(instance);
+        return false;
+    }
+
+    return true;
+}
+
 bool quadSpiInstructionWithAddress1LINE(QUADSPI_TypeDef *instance, uint8_t instruction, uint8_t dummyCycles, uint32_t address, uint8_t addressSize)
 {
     QUADSPIDevice device = quadSpiDeviceByInstance(instance);
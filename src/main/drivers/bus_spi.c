@@ -26,6 +26,8 @@
 
 #ifdef USE_SPI
 
+#include "common/maths.h"
+
 #include "drivers/bus.h"
 #include "drivers/bus_spi.h"
 #include "drivers/bus_spi_impl.h"
@@ -69,6 +71,12 @@ SPI_TypeDef *spiInstanceByDevice(SPIDevice device)
     return spiDevice[device].dev;
 }
 
+static void spiInitBus(SPIDevice device)
+{
+    spiInitDevice(device);
+    spiInitBusDma(device);
+}
+
 bool spiInit(SPIDevice device)
 {
     switch (device) {
@@ -77,7 +85,7 @@ bool spiInit(SPIDevice device)
 
     case SPIDEV_1:
 #ifdef USE_SPI_DEVICE_1
-        spiInitDevice(device);
+        spiInitBus(device);
         return true;
 #else
         break;
@@ -85,7 +93,7 @@ bool spiInit(SPIDevice device)
 
     case SPIDEV_2:
 #ifdef USE_SPI_DEVICE_2
-        spiInitDevice(device);
+        spiInitBus(device);
         return true;
 #else
         break;
@@ -93,7 +101,7 @@ bool spiInit(SPIDevice device)
 
     case SPIDEV_3:
 #if defined(USE_SPI_DEVICE_3) && !defined(STM32F1)
-        spiInitDevice(device);
+        spiInitBus(device);
         return true;
 #else
         break;
@@ -101,7 +109,7 @@ bool spiInit(SPIDevice device)
 
     case SPIDEV_4:
 #if defined(USE_SPI_DEVICE_4)
-        spiInitDevice(device);
+        spiInitBus(device);
         return true;
 #else
         break;
@@ -109,7 +117,7 @@ bool spiInit(SPIDevice device)
 
     case SPIDEV_5:
 #if defined(USE_SPI_DEVICE_5)
-        spiInitDevice(device);
+        spiInitBus(device);
         return true;
 #else
         break;
@@ -117,7 +125,7 @@ bool spiInit(SPIDevice device)
 
     case SPIDEV_6:
 #if defined(USE_SPI_DEVICE_6)
-        spiInitDevice(device);
+        spiInitBus(device);
         return true;
 #else
         break;
@@ -136,12 +144,17 @@ uint32_t spiTimeoutUserCallback(SPI_TypeDef *instance)
     return spiDevice[device].errorCount;
 }
 
+// The functions that drive the chip select run as sequences, so they wait for the
+// sequences queued on the bus and do not interleave with them
+
 bool spiBusTransfer(const busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int length)
 {
-    IOLo(bus->busdev_u.spi.csnPin);
-    spiTransfer(bus->busdev_u.spi.instance, txData, rxData, length);
-    IOHi(bus->busdev_u.spi.csnPin);
-    return true;
+    const busSegment_t segments[] = {
+        { txData, rxData, length, true, NULL },
+        { NULL, NULL, 0, true, NULL },
+    };
+
+    return spiBusRunSequence(bus, segments);
 }
 
 uint16_t spiGetErrorCounter(SPI_TypeDef *instance)
@@ -173,9 +186,7 @@ uint8_t spiBusTransferByte(const busDevice_t *bus, uint8_t data)
 
 void spiBusWriteByte(const busDevice_t *bus, uint8_t data)
 {
-    IOLo(bus->busdev_u.spi.csnPin);
-    spiBusTransferByte(bus, data);
-    IOHi(bus->busdev_u.spi.csnPin);
+    spiBusTransfer(bus, &data, NULL, 1);
 }
 
 bool spiBusRawTransfer(const busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int len)
@@ -185,22 +196,20 @@ bool spiBusRawTransfer(const busDevice_t *bus, const uint8_t *txData, uint8_t *r
 
 bool spiBusWriteRegister(const busDevice_t *bus, uint8_t reg, uint8_t data)
 {
-    IOLo(bus->busdev_u.spi.csnPin);
-    spiTransferByte(bus->busdev_u.spi.instance, reg);
-    spiTransferByte(bus->busdev_u.spi.instance, data);
-    IOHi(bus->busdev_u.spi.csnPin);
+    const uint8_t txData[] = { reg, data };
 
-    return true;
+    return spiBusTransfer(bus, txData, NULL, sizeof(txData));
 }
 
 bool spiBusRawReadRegisterBuffer(const busDevice_t *bus, uint8_t reg, uint8_t *data, uint8_t length)
 {
-    IOLo(bus->busdev_u.spi.csnPin);
-    spiTransferByte(bus->busdev_u.spi.instance, reg);
-    spiTransfer(bus->busdev_u.spi.instance, NULL, data, length);
-    IOHi(bus->busdev_u.spi.csnPin);
+    const busSegment_t segments[] = {
+        { &reg, NULL, 1, false, NULL },
+        { NULL, data, length, true, NULL },
+        { NULL, NULL, 0, true, NULL },
+    };
 
-    return true;
+    return spiBusRunSequence(bus, segments);
 }
 
 bool spiBusReadRegisterBuffer(const busDevice_t *bus, uint8_t reg, uint8_t *data, uint8_t length)
@@ -210,19 +219,20 @@ bool spiBusReadRegisterBuffer(const busDevice_t *bus, uint8_t reg, uint8_t *data
 
 void spiBusWriteRegisterBuffer(const busDevice_t *bus, uint8_t reg, const uint8_t *data, uint8_t length)
 {
-    IOLo(bus->busdev_u.spi.csnPin);
-    spiTransferByte(bus->busdev_u.spi.instance, reg);
-    spiTransfer(bus->busdev_u.spi.instance, data, NULL, length);
-    IOHi(bus->busdev_u.spi.csnPin);
+    const busSegment_t segments[] = {
+        { &reg, NULL, 1, false, NULL },
+        { data, NULL, length, true, NULL },
+        { NULL, NULL, 0, true, NULL },
+    };
+
+    spiBusRunSequence(bus, segments);
 }
 
 uint8_t spiBusRawReadRegister(const busDevice_t *bus, uint8_t reg)
 {
-    uint8_t data;
-    IOLo(bus->busdev_u.spi.csnPin);
-    spiTransferByte(bus->busdev_u.spi.instance, reg);
-    spiTransfer(bus->busdev_u.spi.instance, NULL, &data, 1);
-    IOHi(bus->busdev_u.spi.csnPin);
+    uint8_t data = 0;
+
+    spiBusRawReadRegisterBuffer(bus, reg, &data, 1);
 
     return data;
 }
@@ -232,10 +242,59 @@ uint8_t spiBusReadRegister(const busDevice_t *bus, uint8_t reg)
     return spiBusRawReadRegister(bus, reg | 0x80);
 }
 
+// A device may be probed on several buses, it is only kept on the one it was last set to
+static void spiBusUnregisterDevice(const busDevice_t *bus)
+{
+    for (int device = 0; device < SPIDEV_COUNT; device++) {
+        spiDevice_t *spi = &spiDevice[device];
+        for (int i = 0; i < MIN(spi->busDeviceCount, SPI_BUS_MAX_DEVICES); i++) {
+            if (spi->busDevices[i] == bus) {
+                memmove(&spi->busDevices[i], &spi->busDevices[i + 1], (SPI_BUS_MAX_DEVICES - i - 1) * sizeof(spi->busDevices[0]));
+                spi->busDeviceCount--;
+                break;
+            }
+        }
+    }
+}
+
+static void spiBusRegisterDevice(const busDevice_t *bus)
+{
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+    if (device == SPIINVALID) {
+        return;
+    }
+
+    spiDevice_t *spi = &spiDevice[device];
+    if (spi->busDeviceCount < SPI_BUS_MAX_DEVICES) {
+        spi->busDevices[spi->busDeviceCount] = bus;
+    }
+    if (spi->busDeviceCount < UINT8_MAX) {
+        spi->busDeviceCount++;
+    }
+}
+
 void spiBusSetInstance(busDevice_t *bus, SPI_TypeDef *instance)
 {
+    spiBusUnregisterDevice(bus);
+
     bus->bustype = BUSTYPE_SPI;
     bus->busdev_u.spi.instance = instance;
+    bus->busdev_u.spi.priority = SPI_PRIORITY_NORMAL;
+
+    spiBusRegisterDevice(bus);
+}
+
+// True if any device other than this one has been set to its bus, whether or not it was detected
+bool spiBusIsShared(const busDevice_t *bus)
+{
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+    if (device == SPIINVALID) {
+        return false;
+    }
+
+    const spiDevice_t *spi = &spiDevice[device];
+
+    return spi->busDeviceCount > 1 || (spi->busDeviceCount == 1 && spi->busDevices[0] != bus);
 }
 
 void spiBusSetDivisor(busDevice_t *bus, uint16_t divisor)
@@ -154,6 +154,7 @@ void spiBusWriteRegisterBuffer(const busDevice_t *bus, uint8_t reg, const uint8_
 uint8_t spiBusRawReadRegister(const busDevice_t *bus, uint8_t reg);
 uint8_t spiBusReadRegister(const busDevice_t *bus, uint8_t reg);
 void spiBusSetInstance(busDevice_t *bus, SPI_TypeDef *instance);
+bool spiBusIsShared(const busDevice_t *bus);
 void spiBusSetDivisor(busDevice_t *bus, SPIClockDivider_e divider);
 
 void spiBusTransactionInit(busDevice_t *bus, SPIMode_e mode, SPIClockDivider_e divider);
@@ -165,6 +166,64 @@ uint8_t spiBusTransactionReadRegister(const busDevice_t *bus, uint8_t reg);
 bool spiBusTransactionReadRegisterBuffer(const busDevice_t *bus, uint8_t reg, uint8_t *data, uint8_t length);
 bool spiBusTransactionTransfer(const busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int length);
 
+//
+// Segment API
+//
+// A sequence is an array of segments ending with a segment of zero length, each segment is one
+// transfer. The chip select is asserted from the first segment until the end of the sequence, or
+// until a segment with negateCS set, and is asserted again for the segment that follows it.
+// The sequences of all the devices on a bus are queued and run one after the other, segments of
+// at least SPI_DMA_THRESHOLD bytes are transferred by DMA on a bus with DMA streams configured.
+// A device's sequences wait in the queue of its priority, and a sequence waiting at a higher
+// priority preempts the sequence in progress after its next segment with negateCS set.
+//
+// A segment's callback is called once it has completed, from the DMA interrupt for a segment
+// transferred by DMA, and returns whether to carry on, to run the segment again or to end the
+// sequence. The segments and their buffers must stay valid until the sequence has completed.
+//
+// spiBusRunSequence() and the blocking functions above wait for the queue, so from an interrupt
+// they may only be used on a bus that no task uses at the same time.
+
+// Shorter transfers are polled, setting up the DMA would take longer than the transfer
+#define SPI_DMA_THRESHOLD   8
+
+typedef enum {
+    BUS_READY,      // carry on with the next segment
+    BUS_BUSY,       // run this segment again, toggling the chip select if negateCS is set
+    BUS_ABORT       // end the sequence here
+} busStatus_e;
+
+typedef struct busSegment_s {
+    const uint8_t *txData;      // NULL sends 0xFF
+    uint8_t *rxData;            // NULL discards the received bytes
+    int len;
+    bool negateCS;
+    busStatus_e (*callback)(uint32_t arg);
+} busSegment_t;
+
+typedef enum {
+    SPI_PRIORITY_NORMAL,
+    SPI_PRIORITY_HIGH,      // gyro reads, which the PID loop waits for
+    SPI_PRIORITY_COUNT
+} spiPriority_e;
+
+typedef struct spiBusStats_s {
+    uint16_t busyPermille;      // of the time since the statistics were reset
+    uint32_t preemptionCount;
+    uint32_t sequenceCount[SPI_PRIORITY_COUNT];
+    uint32_t averageWaitUs[SPI_PRIORITY_COUNT];     // from queued to started
+    uint32_t maxWaitUs[SPI_PRIORITY_COUNT];
+} spiBusStats_t;
+
+void spiBusSetPriority(busDevice_t *bus, spiPriority_e priority);
+bool spiBusSequence(const busDevice_t *bus, const busSegment_t *segments, uint32_t callbackArg);
+bool spiBusRunSequence(const busDevice_t *bus, const busSegment_t *segments);
+bool spiBusSequenceBusy(const busDevice_t *bus);
+void spiBusWait(const busDevice_t *bus);
+bool spiBusUsesDma(const busDevice_t *bus);
+bool spiBusGetStats(SPIDevice device, spiBusStats_t *stats);
+void spiBusResetStats(SPIDevice device);
+
 //
 // Config
 //
@@ -54,6 +54,43 @@ typedef struct spiHardware_s {
 
 extern const spiHardware_t spiHardware[];
 
+// Sequences waiting for the bus, one ring per priority, see the segment API in bus_spi.h
+#define SPI_QUEUE_LENGTH    4   // must be a power of 2
+
+typedef struct spiSequence_s {
+    const busDevice_t *bus;
+    const busSegment_t *segments;
+    uint32_t callbackArg;
+    uint32_t queuedCycles;
+} spiSequence_t;
+
+typedef struct spiRing_s {
+    spiSequence_t sequence[SPI_QUEUE_LENGTH];
+    volatile uint8_t head;          // oldest sequence, in progress or preempted
+    volatile uint8_t tail;          // next free entry
+    const busSegment_t *resume;     // segment the preempted sequence at the head carries on from
+    uint32_t queued;
+    volatile uint32_t completed;
+} spiRing_t;
+
+typedef struct spiQueue_s {
+    spiRing_t ring[SPI_PRIORITY_COUNT];
+    volatile bool active;           // a sequence is in progress, the queue belongs to whoever runs it
+    spiRing_t *current;             // ring with the sequence in progress at its head
+    const busSegment_t *segment;    // segment in progress
+    // Statistics since resetTimeUs
+    uint32_t resetTimeUs;
+    uint32_t activeCycles;          // cycle counter when the bus last became active
+    uint64_t busyCycles;
+    uint64_t waitCycles[SPI_PRIORITY_COUNT];
+    uint32_t maxWaitCycles[SPI_PRIORITY_COUNT];
+    uint32_t sequenceCount[SPI_PRIORITY_COUNT];
+    uint32_t preemptionCount;
+} spiQueue_t;
+
+// Devices registered on a bus by spiBusSetInstance()
+#define SPI_BUS_MAX_DEVICES 8
+
 typedef struct SPIDevice_s {
     SPI_TypeDef *dev;
     ioTag_t sck;
@@ -78,10 +115,22 @@ typedef struct SPIDevice_s {
 #endif
 #ifdef USE_SPI_TRANSACTION
     uint16_t cr1SoftCopy;   // Copy of active CR1 value for this SPI instance
+#endif
+    spiQueue_t queue;
+    const busDevice_t *busDevices[SPI_BUS_MAX_DEVICES];
+    uint8_t busDeviceCount;     // may exceed SPI_BUS_MAX_DEVICES, the excess devices are counted but not kept
+#ifdef USE_SPI_DMA
+    struct dmaChannelDescriptor_s *txDma;
+    struct dmaChannelDescriptor_s *rxDma;
 #endif
 } spiDevice_t;
 
 extern spiDevice_t spiDevice[SPIDEV_COUNT];
 
 void spiInitDevice(SPIDevice device);
+#ifdef USE_SPI_DMA
+void spiInitBusDma(SPIDevice device);
+#else
+#define spiInitBusDma(device) do {} while (0)
+#endif
 uint32_t spiTimeoutUserCallback(SPI_TypeDef *instance);
@@ -0,0 +1,574 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_SPI
+
+#include "build/atomic.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/bus.h"
+#include "drivers/bus_spi.h"
+#include "drivers/bus_spi_impl.h"
+#include "drivers/dma.h"
+#include "drivers/dma_reqmap.h"
+#include "drivers/io.h"
+#include "drivers/nvic.h"
+#include "drivers/resource.h"
+#include "drivers/system.h"
+#include "drivers/time.h"
+
+#include "pg/bus_spi.h"
+
+#define SPI_QUEUE_NEXT(index) (((index) + 1) & (SPI_QUEUE_LENGTH - 1))
+
+// Sequences are queued by the tasks and by interrupt handlers, so the rings are only changed with
+// the interrupts masked. The sequence in progress is run by whoever finds the queue idle when
+// queuing, and carried on by the DMA interrupt, so the bus is only ever driven from one place.
+//
+// Each priority has a ring of its own, and the blocking calls wait for the completion count of
+// their ring, as sequences of different priorities do not complete in the order they are queued.
+
+static const busSegment_t spiSequenceEnd = { NULL, NULL, 0, true, NULL };
+
+static FAST_CODE spiDevice_t *spiBusDevice(const busDevice_t *bus)
+{
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+
+    return device == SPIINVALID ? NULL : &spiDevice[device];
+}
+
+static FAST_CODE spiPriority_e spiBusPriority(const busDevice_t *bus)
+{
+    const uint8_t priority = bus->busdev_u.spi.priority;
+
+    return priority < SPI_PRIORITY_COUNT ? priority : SPI_PRIORITY_NORMAL;
+}
+
+// The ring of highest priority with a sequence waiting, NULL if they are all empty
+static FAST_CODE spiRing_t *spiNextRing(spiQueue_t *queue)
+{
+    for (int priority = SPI_PRIORITY_COUNT - 1; priority >= 0; priority--) {
+        spiRing_t *ring = &queue->ring[priority];
+        if (ring->head != ring->tail) {
+            return ring;
+        }
+    }
+
+    return NULL;
+}
+
+// Starts the sequence at the head of the current ring, or carries on with it if it was preempted
+static FAST_CODE void spiSequenceBegin(spiQueue_t *queue)
+{
+    spiRing_t *ring = queue->current;
+    const spiSequence_t *sequence = &ring->sequence[ring->head];
+
+#ifdef USE_SPI_TRANSACTION
+    spiBusTransactionSetup(sequence->bus);
+#endif
+
+    if (ring->resume) {
+        queue->segment = ring->resume;
+        ring->resume = NULL;
+    } else {
+        const int priority = ring - queue->ring;
+        const uint32_t waitCycles = getCycleCounter() - sequence->queuedCycles;
+
+        queue->segment = sequence->segments;
+        queue->waitCycles[priority] += waitCycles;
+        queue->maxWaitCycles[priority] = MAX(queue->maxWaitCycles[priority], waitCycles);
+        queue->sequenceCount[priority]++;
+    }
+}
+
+// Switches to a sequence of higher priority if one is waiting, with the chip select released
+static FAST_CODE void spiPreempt(spiQueue_t *queue)
+{
+    // A sequence queued meanwhile is picked up at the next boundary, so the rings are read unmasked
+    spiRing_t *next = spiNextRing(queue);
+
+    // The current ring is not empty, so only a ring of higher priority is picked over it
+    if (next != queue->current) {
+        queue->current->resume = queue->segment;
+        queue->current = next;
+        queue->preemptionCount++;
+        spiSequenceBegin(queue);
+    }
+}
+
+// Moves on from the segment that has just been transferred, as its callback says
+static FAST_CODE void spiSegmentDone(spiQueue_t *queue)
+{
+    const spiRing_t *ring = queue->current;
+    const spiSequence_t *sequence = &ring->sequence[ring->head];
+    const busSegment_t *segment = queue->segment;
+    const busStatus_e status = segment->callback ? segment->callback(sequence->callbackArg) : BUS_READY;
+
+    if (status == BUS_ABORT) {
+        queue->segment = &spiSequenceEnd;
+    } else if (status == BUS_READY) {
+        queue->segment = segment + 1;
+    }
+
+    if (segment->negateCS) {
+        // asserted again when the next segment starts
+        IOHi(sequence->bus->busdev_u.spi.csnPin);
+
+        if (queue->segment->len) {
+            spiPreempt(queue);
+        }
+    }
+}
+
+#ifdef USE_SPI_DMA
+static bool spiStartDma(spiDevice_t *spi, const busSegment_t *segment);
+#endif
+
+// Runs the queue until it is empty, or until a segment is handed over to the DMA
+static FAST_CODE void spiProcessQueue(spiDevice_t *spi)
+{
+    spiQueue_t *queue = &spi->queue;
+
+    while (true) {
+        spiRing_t *ring = queue->current;
+        const spiSequence_t *sequence = &ring->sequence[ring->head];
+        const busSegment_t *segment = queue->segment;
+        const IO_t csnPin = sequence->bus->busdev_u.spi.csnPin;
+
+        if (segment->len == 0) {
+            IOHi(csnPin);
+
+            ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+                ring->head = SPI_QUEUE_NEXT(ring->head);
+                ring->completed++;
+                queue->current = spiNextRing(queue);
+                if (!queue->current) {
+                    queue->active = false;
+                    queue->busyCycles += getCycleCounter() - queue->activeCycles;
+                }
+            }
+
+            if (!queue->current) {
+                return;
+            }
+            spiSequenceBegin(queue);
+            continue;
+        }
+
+        IOLo(csnPin);
+
+#ifdef USE_SPI_DMA
+        if (spiStartDma(spi, segment)) {
+            // carried on by the DMA interrupt
+            return;
+        }
+#endif
+
+        spiTransfer(sequence->bus->busdev_u.spi.instance, segment->txData, segment->rxData, segment->len);
+        spiSegmentDone(queue);
+    }
+}
+
+// Returns the ring the sequence was queued in, NULL if it is full. The ticket is the completion
+// count of the ring at which this sequence has completed.
+static FAST_CODE spiRing_t *spiQueueSequence(spiDevice_t *spi, const busDevice_t *bus, const busSegment_t *segments, uint32_t callbackArg, uint32_t *ticket)
+{
+    spiQueue_t *queue = &spi->queue;
+    spiRing_t *ring = &queue->ring[spiBusPriority(bus)];
+    bool queued = false;
+    bool start = false;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        const uint8_t tail = ring->tail;
+        if (SPI_QUEUE_NEXT(tail) != ring->head) {
+            spiSequence_t *sequence = &ring->sequence[tail];
+            sequence->bus = bus;
+            sequence->segments = segments;
+            sequence->callbackArg = callbackArg;
+            sequence->queuedCycles = getCycleCounter();
+            *ticket = ++ring->queued;
+            ring->tail = SPI_QUEUE_NEXT(tail);
+            queued = true;
+
+            if (!queue->active) {
+                queue->active = true;
+                queue->activeCycles = sequence->queuedCycles;
+                queue->current = ring;
+                start = true;
+            }
+        }
+    }
+
+    if (start) {
+        spiSequenceBegin(queue);
+        spiProcessQueue(spi);
+    }
+
+    return queued ? ring : NULL;
+}
+
+void spiBusSetPriority(busDevice_t *bus, spiPriority_e priority)
+{
+    bus->busdev_u.spi.priority = priority;
+}
+
+// Non-blocking, false if the queue is full
+FAST_CODE bool spiBusSequence(const busDevice_t *bus, const busSegment_t *segments, uint32_t callbackArg)
+{
+    spiDevice_t *spi = spiBusDevice(bus);
+    uint32_t ticket;
+
+    return spi && spiQueueSequence(spi, bus, segments, callbackArg, &ticket);
+}
+
+// Blocking, waits for the sequence and the ones queued before it at its priority to complete
+bool spiBusRunSequence(const busDevice_t *bus, const busSegment_t *segments)
+{
+    spiDevice_t *spi = spiBusDevice(bus);
+    const spiRing_t *ring;
+    uint32_t ticket;
+
+    if (!spi) {
+        return false;
+    }
+
+    while (!(ring = spiQueueSequence(spi, bus, segments, 0, &ticket)));
+
+    while ((int32_t)(ring->completed - ticket) < 0);
+
+    return true;
+}
+
+bool spiBusSequenceBusy(const busDevice_t *bus)
+{
+    const spiDevice_t *spi = spiBusDevice(bus);
+
+    return spi && spi->queue.active;
+}
+
+void spiBusWait(const busDevice_t *bus)
+{
+    while (spiBusSequenceBusy(bus));
+}
+
+bool spiBusGetStats(SPIDevice device, spiBusStats_t *stats)
+{
+    if (device == SPIINVALID || device >= SPIDEV_COUNT || !spiDevice[device].dev) {
+        return false;
+    }
+
+    const spiQueue_t *queue = &spiDevice[device].queue;
+    const uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+    uint64_t busyCycles = 0;
+    uint32_t elapsedUs = 0;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        busyCycles = queue->busyCycles;
+        if (queue->active) {
+            busyCycles += getCycleCounter() - queue->activeCycles;
+        }
+        elapsedUs = micros() - queue->resetTimeUs;
+    }
+
+    stats->busyPermille = elapsedUs ? MIN(busyCycles * 1000 / ((uint64_t)elapsedUs * cyclesPerUs), 1000U) : 0;
+    stats->preemptionCount = queue->preemptionCount;
+    for (int priority = 0; priority < SPI_PRIORITY_COUNT; priority++) {
+        const uint32_t count = queue->sequenceCount[priority];
+        stats->sequenceCount[priority] = count;
+        stats->averageWaitUs[priority] = count ? queue->waitCycles[priority] / count / cyclesPerUs : 0;
+        stats->maxWaitUs[priority] = queue->maxWaitCycles[priority] / cyclesPerUs;
+    }
+
+    return true;
+}
+
+void spiBusResetStats(SPIDevice device)
+{
+    if (device == SPIINVALID || device >= SPIDEV_COUNT) {
+        return;
+    }
+
+    spiQueue_t *queue = &spiDevice[device].queue;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        queue->resetTimeUs = micros();
+        queue->activeCycles = getCycleCounter();
+        queue->busyCycles = 0;
+        memset(queue->waitCycles, 0, sizeof(queue->waitCycles));
+        memset(queue->maxWaitCycles, 0, sizeof(queue->maxWaitCycles));
+        memset(queue->sequenceCount, 0, sizeof(queue->sequenceCount));
+        queue->preemptionCount = 0;
+    }
+}
+
+#ifdef USE_SPI_DMA
+
+#if defined(STM32F7)
+// DTCM is not cached, the rest of the RAM is. Data is sent from anywhere in RAM, written back
+// from the cache first, and received into DTCM or into buffers that own their cache lines.
+#define SPI_DMA_RAM             FAST_RAM
+#define SPI_DMA_DTCM(address)   ((address) >= 0x20000000 && (address) < 0x20010000)
+#define SPI_DMA_SRAM(address)   ((address) >= 0x20010000 && (address) < 0x20080000)
+#else
+// CCM can not be reached by the DMA
+#define SPI_DMA_RAM
+#define SPI_DMA_SRAM(address)   (((address) & 0xF0000000) == 0x20000000)
+#endif
+
+#define DMA_ALL_FLAGS (DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF)
+
+// Stand in for the buffer of a segment without one
+static SPI_DMA_RAM uint8_t spiDmaDummyTx = 0xFF;
+static SPI_DMA_RAM uint8_t spiDmaDummyRx;
+
+// Checks the DMA can reach the buffers, writing the data to send back from the cache
+static FAST_CODE bool spiDmaPrepareBuffers(const busSegment_t *segment)
+{
+    const uint32_t txAddress = (uint32_t)segment->txData;
+    const uint32_t rxAddress = (uint32_t)segment->rxData;
+
+#if defined(STM32F7)
+    if (segment->rxData && !SPI_DMA_DTCM(rxAddress)) {
+        if (!SPI_DMA_SRAM(rxAddress) || !dmaBufferOwnsCacheLines(segment->rxData, segment->len)) {
+            return false;
+        }
+        // a dirty line evicted during the transfer would overwrite the received data
+        dmaBufferInvalidate(segment->rxData, segment->len);
+    }
+    if (segment->txData && !SPI_DMA_DTCM(txAddress)) {
+        if (!SPI_DMA_SRAM(txAddress)) {
+            return false;
+        }
+        dmaBufferClean(segment->txData, segment->len);
+    }
+#else
+    if ((segment->rxData && !SPI_DMA_SRAM(rxAddress)) || (segment->txData && !SPI_DMA_SRAM(txAddress))) {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+static FAST_CODE bool spiStartDma(spiDevice_t *spi, const busSegment_t *segment)
+{
+    dmaChannelDescriptor_t *txDma = spi->txDma;
+    dmaChannelDescriptor_t *rxDma = spi->rxDma;
+
+    // The streams may have been taken over since, by the SD card driver for one
+    if (!rxDma || segment->len < SPI_DMA_THRESHOLD || segment->len > 0xffff
+        || rxDma->owner.owner != OWNER_SPI_MISO || txDma->owner.owner != OWNER_SPI_MOSI
+        || !spiDmaPrepareBuffers(segment)) {
+        return false;
+    }
+
+    SPI_TypeDef *instance = spi->dev;
+    const uint32_t txAddress = segment->txData ? (uint32_t)segment->txData : (uint32_t)&spiDmaDummyTx;
+    const uint32_t rxAddress = segment->rxData ? (uint32_t)segment->rxData : (uint32_t)&spiDmaDummyRx;
+
+#if defined(USE_HAL_DRIVER)
+    // Drop anything left in the Rx FIFO, it would end up at the start of the data
+    while (LL_SPI_IsActiveFlag_RXNE(instance)) {
+        instance->DR;
+    }
+
+    LL_DMA_SetMemoryAddress(rxDma->dma, rxDma->stream, rxAddress);
+    LL_DMA_SetMemoryIncMode(rxDma->dma, rxDma->stream, segment->rxData ? LL_DMA_MEMORY_INCREMENT : LL_DMA_MEMORY_NOINCREMENT);
+    LL_DMA_SetDataLength(rxDma->dma, rxDma->stream, segment->len);
+
+    LL_DMA_SetMemoryAddress(txDma->dma, txDma->stream, txAddress);
+    LL_DMA_SetMemoryIncMode(txDma->dma, txDma->stream, segment->txData ? LL_DMA_MEMORY_INCREMENT : LL_DMA_MEMORY_NOINCREMENT);
+    LL_DMA_SetDataLength(txDma->dma, txDma->stream, segment->len);
+
+    LL_SPI_EnableDMAReq_RX(instance);
+    LL_DMA_EnableStream(rxDma->dma, rxDma->stream);
+    LL_DMA_EnableStream(txDma->dma, txDma->stream);
+    LL_SPI_EnableDMAReq_TX(instance);
+#else
+    // Drop anything left in the Rx register, it would end up at the start of the data
+    while (SPI_I2S_GetFlagStatus(instance, SPI_I2S_FLAG_RXNE) == SET) {
+        instance->DR;
+    }
+
+    DMA_ARCH_TYPE *rxStream = (DMA_ARCH_TYPE *)rxDma->ref;
+    DMA_ARCH_TYPE *txStream = (DMA_ARCH_TYPE *)txDma->ref;
+
+    xDMA_MemoryTargetConfig(rxDma->ref, rxAddress, DMA_Memory_0);
+    rxStream->CR = segment->rxData ? rxStream->CR | DMA_SxCR_MINC : rxStream->CR & ~DMA_SxCR_MINC;
+    xDMA_SetCurrDataCounter(rxDma->ref, segment->len);
+
+    xDMA_MemoryTargetConfig(txDma->ref, txAddress, DMA_Memory_0);
+    txStream->CR = segment->txData ? txStream->CR | DMA_SxCR_MINC : txStream->CR & ~DMA_SxCR_MINC;
+    xDMA_SetCurrDataCounter(txDma->ref, segment->len);
+
+    SPI_I2S_DMACmd(instance, SPI_I2S_DMAReq_Rx, ENABLE);
+    xDMA_Cmd(rxDma->ref, ENABLE);
+    xDMA_Cmd(txDma->ref, ENABLE);
+    SPI_I2S_DMACmd(instance, SPI_I2S_DMAReq_Tx, ENABLE);
+#endif
+
+    return true;
+}
+
+static FAST_CODE void spiDmaRxComplete(dmaChannelDescriptor_t *descriptor)
+{
+    if (!DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        return;
+    }
+
+    spiDevice_t *spi = &spiDevice[descriptor->userParam];
+
+    // Both streams have disabled themselves, the flags must be clear before they are enabled again
+    DMA_CLEAR_FLAG(descriptor, DMA_ALL_FLAGS);
+    DMA_CLEAR_FLAG(spi->txDma, DMA_ALL_FLAGS);
+
+#if defined(USE_HAL_DRIVER)
+    LL_SPI_DisableDMAReq_TX(spi->dev);
+    LL_SPI_DisableDMAReq_RX(spi->dev);
+#else
+    SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Tx | SPI_I2S_DMAReq_Rx, DISABLE);
+#endif
+
+#if defined(STM32F7)
+    // drop lines the core fetched while the transfer ran, before the callback reads the data
+    const busSegment_t *segment = spi->queue.segment;
+    if (segment->rxData && !SPI_DMA_DTCM((uint32_t)segment->rxData)) {
+        dmaBufferInvalidate(segment->rxData, segment->len);
+    }
+#endif
+
+    // Reception completes after the last bit has been clocked, so the bus is idle
+    spiSegmentDone(&spi->queue);
+    spiProcessQueue(spi);
+}
+
+static void spiDmaInitStream(dmaChannelDescriptor_t *dma, uint32_t channel, SPI_TypeDef *instance, bool rx)
+{
+#if defined(USE_HAL_DRIVER)
+    LL_DMA_InitTypeDef init;
+
+    LL_DMA_StructInit(&init);
+
+    init.Channel = dmaGetChannel(channel);
+    init.Mode = LL_DMA_MODE_NORMAL;
+    init.Direction = rx ? LL_DMA_DIRECTION_PERIPH_TO_MEMORY : LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+
+    init.PeriphOrM2MSrcAddress = (uint32_t)&instance->DR;
+    // Reception must keep up with the bus, otherwise the SPI overruns
+    init.Priority = rx ? LL_DMA_PRIORITY_VERYHIGH : LL_DMA_PRIORITY_HIGH;
+    init.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
+    init.PeriphOrM2MSrcDataSize = LL_DMA_PDATAALIGN_BYTE;
+
+    // The memory address, increment and length are set per segment
+    init.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
+    init.MemoryOrM2MDstDataSize = LL_DMA_MDATAALIGN_BYTE;
+
+    LL_DMA_DeInit(dma->dma, dma->stream);
+    LL_DMA_Init(dma->dma, dma->stream, &init);
+
+    if (rx) {
+        LL_DMA_EnableIT_TC(dma->dma, dma->stream);
+    }
+#else
+    DMA_InitTypeDef init;
+
+    DMA_StructInit(&init);
+
+    init.DMA_Channel = dmaGetChannel(channel);
+    init.DMA_DIR = rx ? DMA_DIR_PeripheralToMemory : DMA_DIR_MemoryToPeripheral;
+
+    init.DMA_PeripheralBaseAddr = (uint32_t)&instance->DR;
+    // Reception must keep up with the bus, otherwise the SPI overruns
+    init.DMA_Priority = rx ? DMA_Priority_VeryHigh : DMA_Priority_High;
+    init.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    init.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+
+    // The memory address, increment and length are set per segment
+    init.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    init.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+
+    init.DMA_Mode = DMA_Mode_Normal;
+
+    xDMA_DeInit(dma->ref);
+    xDMA_Init(dma->ref, &init);
+
+    if (rx) {
+        xDMA_ITConfig(dma->ref, DMA_IT_TC, ENABLE);
+    }
+#endif
+}
+
+// Claims the DMA streams configured for the bus, when both are configured and free
+void spiInitBusDma(SPIDevice device)
+{
+    spiDevice_t *spi = &spiDevice[device];
+
+    const dmaChannelSpec_t *txSpec = dmaGetChannelSpecByPeripheral(DMA_PERIPH_SPI_TX, device, spiPinConfig(device)->txDmaopt);
+    const dmaChannelSpec_t *rxSpec = dmaGetChannelSpecByPeripheral(DMA_PERIPH_SPI_RX, device, spiPinConfig(device)->rxDmaopt);
+    if (!txSpec || !rxSpec) {
+        return;
+    }
+
+    const dmaIdentifier_e txIdentifier = dmaGetIdentifier(txSpec->ref);
+    const dmaIdentifier_e rxIdentifier = dmaGetIdentifier(rxSpec->ref);
+    if (dmaGetOwner(txIdentifier)->owner != OWNER_FREE || dmaGetOwner(rxIdentifier)->owner != OWNER_FREE) {
+        return;
+    }
+
+    dmaInit(txIdentifier, OWNER_SPI_MOSI, RESOURCE_INDEX(device));
+    spi->txDma = dmaGetDescriptorByIdentifier(txIdentifier);
+    spiDmaInitStream(spi->txDma, txSpec->channel, spi->dev, false);
+
+    dmaInit(rxIdentifier, OWNER_SPI_MISO, RESOURCE_INDEX(device));
+    dmaChannelDescriptor_t *rxDma = dmaGetDescriptorByIdentifier(rxIdentifier);
+    spiDmaInitStream(rxDma, rxSpec->channel, spi->dev, true);
+    dmaSetHandler(rxIdentifier, spiDmaRxComplete, NVIC_PRIO_SPI_DMA, device);
+
+    // Set last, segments are only handed to the DMA once this is set
+    spi->rxDma = rxDma;
+}
+
+bool spiBusUsesDma(const busDevice_t *bus)
+{
+    const spiDevice_t *spi = spiBusDevice(bus);
+
+    return spi && spi->rxDma;
+}
+
+#else
+
+bool spiBusUsesDma(const busDevice_t *bus)
+{
+    UNUSED(bus);
+
+    return false;
+}
+
+#endif // USE_SPI_DMA
+#endif // USE_SPI
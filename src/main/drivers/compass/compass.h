@@ -21,6 +21,7 @@
 #pragma once
 
 #include "common/sensor_alignment.h"
+#include "common/time.h"
 
 #include "drivers/bus.h"
 #include "drivers/sensor.h"
@@ -32,7 +33,11 @@ typedef struct magDev_s {
     extiCallbackRec_t exti;
     busDevice_t busdev;
     sensor_align_e magAlignment;
-    fp_rotationMatrix_t rotationMatrix;
+    sensorRotation_t rotation;
     ioTag_t magIntExtiTag;
     int16_t magGain[3];
+    bool dataReadyEnabled;                                  // the data ready pin is connected, reads follow its interrupt
+    volatile bool dataReady;
+    volatile timeUs_t dataReadyAtUs;                        // time of the last data ready interrupt
+    bool readPending;                                       // a non-blocking read has been started but not collected
 } magDev_t;
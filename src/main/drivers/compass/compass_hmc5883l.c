@@ -36,10 +36,8 @@
 #include "drivers/bus_i2c.h"
 #include "drivers/bus_i2c_busdev.h"
 #include "drivers/bus_spi.h"
-#include "drivers/exti.h"
 #include "drivers/io.h"
 #include "drivers/light_led.h"
-#include "drivers/nvic.h"
 #include "drivers/sensor.h"
 #include "drivers/time.h"
 
@@ -47,8 +45,6 @@
 
 #include "compass_hmc5883l.h"
 
-//#define DEBUG_MAG_DATA_READY_INTERRUPT
-
 // HMC5883L, default address 0x1E
 // NAZE Target connections
 // PB12 connected to MAG_DRDY on rev4 hardware
@@ -134,54 +130,6 @@
 #define SELF_TEST_LOW_LIMIT         (243.0f / 390.0f)   // Low limit when gain is 5.
 #define SELF_TEST_HIGH_LIMIT        (575.0f / 390.0f)   // High limit when gain is 5.
 
-#ifdef USE_MAG_DATA_READY_SIGNAL
-
-static void hmc5883_extiHandler(extiCallbackRec_t* cb)
-{
-    UNUSED(cb);
-#ifdef DEBUG_MAG_DATA_READY_INTERRUPT
-    // Measure the delta between calls to the interrupt handler
-    // currently should be around 65/66 milli seconds / 15hz output rate
-    static uint32_t lastCalledAt = 0;
-    static int32_t callDelta = 0;
-
-    uint32_t now = millis();
-    callDelta = now - lastCalledAt;
-
-    //UNUSED(callDelta);
-    debug[0] = callDelta;
-
-    lastCalledAt = now;
-#endif
-}
-#endif
-
-static void hmc5883lConfigureDataReadyInterruptHandling(magDev_t* mag)
-{
-#ifdef USE_MAG_DATA_READY_SIGNAL
-    if (mag->magIntExtiTag == IO_TAG_NONE) {
-        return;
-    }
-
-    const IO_t magIntIO = IOGetByTag(mag->magIntExtiTag);
-
-#ifdef ENSURE_MAG_DATA_READY_IS_HIGH
-    uint8_t status = IORead(magIntIO);
-    if (!status) {
-        return;
-    }
-#endif
-
-    IOInit(magIntIO, OWNER_COMPASS_EXTI, 0);
-    EXTIHandlerInit(&mag->exti, hmc5883_extiHandler);
-    EXTIConfig(magIntIO, &mag->exti, NVIC_PRIO_MPU_INT_EXTI, IOCFG_IN_FLOATING, EXTI_TRIGGER_RISING);
-    EXTIEnable(magIntIO, true);
-    EXTIEnable(magIntIO, true);
-#else
-    UNUSED(mag);
-#endif
-}
-
 #ifdef USE_MAG_SPI_HMC5883
 static void hmc5883SpiInit(busDevice_t *busdev)
 {
@@ -230,7 +178,6 @@ static bool hmc5883lInit(magDev_t *mag)
 
     delay(100);
 
-    hmc5883lConfigureDataReadyInterruptHandling(mag);
     return true;
 }
 
@@ -103,13 +103,25 @@
 
 static bool lis3mdlRead(magDev_t * mag, int16_t *magData)
 {
-    uint8_t buf[6];
+    static uint8_t buf[6];
 
     busDevice_t *busdev = &mag->busdev;
 
-    bool ack = busReadRegisterBuffer(busdev, LIS3MDL_REG_OUT_X_L, buf, 6);
-
-    if (!ack) {
+    if (mag->dataReadyEnabled) {
+        // started on the data ready interrupt and collected on a later call, without waiting on the bus
+        if (!mag->readPending) {
+            mag->readPending = busReadRegisterBufferStart(busdev, LIS3MDL_REG_OUT_X_L, buf, sizeof(buf));
+            return false;
+        }
+        bool error = false;
+        if (busBusy(busdev, &error)) {
+            return false;
+        }
+        mag->readPending = false;
+        if (error) {
+            return false;
+        }
+    } else if (!busReadRegisterBuffer(busdev, LIS3MDL_REG_OUT_X_L, buf, sizeof(buf))) {
         return false;
     }
 
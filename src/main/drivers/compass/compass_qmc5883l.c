@@ -69,6 +69,10 @@
 #define QMC5883L_REG_DATA_OUTPUT_X 0x00
 #define QMC5883L_REG_STATUS 0x06
 
+// STATUS
+#define QMC5883L_STATUS_DRDY 0x01
+#define QMC5883L_STATUS_DOR  0x04   // data skipped, the previous sample was not read
+
 #define QMC5883L_REG_ID 0x0D
 #define QMC5883_ID_VAL 0xFF
 
@@ -91,25 +95,37 @@ static bool qmc5883lInit(magDev_t *magDev)
 
 static bool qmc5883lRead(magDev_t *magDev, int16_t *magData)
 {
-    uint8_t status;
-    uint8_t buf[6];
-
-    // set magData to zero for case of failed read
-    magData[X] = 0;
-    magData[Y] = 0;
-    magData[Z] = 0;
+    static uint8_t buf[6];
 
     busDevice_t *busdev = &magDev->busdev;
 
-    bool ack = busReadRegisterBuffer(busdev, QMC5883L_REG_STATUS, &status, 1);
+    if (magDev->dataReadyEnabled) {
+        // the data ready interrupt says there is a sample, so the status is not read and the bus is not waited on.
+        // The read is started on one call and collected on a later one.
+        if (!magDev->readPending) {
+            magDev->readPending = busReadRegisterBufferStart(busdev, QMC5883L_REG_DATA_OUTPUT_X, buf, sizeof(buf));
+            return false;
+        }
+        bool error = false;
+        if (busBusy(busdev, &error)) {
+            return false;
+        }
+        magDev->readPending = false;
+        if (error) {
+            return false;
+        }
+    } else {
+        uint8_t status;
+        bool ack = busReadRegisterBuffer(busdev, QMC5883L_REG_STATUS, &status, 1);
 
-    if (!ack || (status & 0x04) == 0) {
-        return false;
-    }
+        if (!ack || (status & (QMC5883L_STATUS_DRDY | QMC5883L_STATUS_DOR)) == 0) {
+            return false;
+        }
 
-    ack = busReadRegisterBuffer(busdev, QMC5883L_REG_DATA_OUTPUT_X, buf, 6);
-    if (!ack) {
-        return false;
+        ack = busReadRegisterBuffer(busdev, QMC5883L_REG_DATA_OUTPUT_X, buf, sizeof(buf));
+        if (!ack) {
+            return false;
+        }
     }
 
     magData[X] = (int16_t)(buf[1] << 8 | buf[0]);
@@ -52,14 +52,17 @@ void displayGrab(displayPort_t *instance)
     ++instance->grabCount;
 }
 
+// The screen is left cleared so that the next owner redraws all of it
 void displayRelease(displayPort_t *instance)
 {
+    displayClearScreen(instance);
     instance->vTable->release(instance);
     --instance->grabCount;
 }
 
 void displayReleaseAll(displayPort_t *instance)
 {
+    displayClearScreen(instance);
     instance->vTable->release(instance);
     instance->grabCount = 0;
 }
@@ -115,9 +118,22 @@ uint16_t displayTxBytesFree(const displayPort_t *instance)
     return instance->vTable->txBytesFree(instance);
 }
 
+// Scale a position of the OSD layout to the same relative place on a canvas larger than the layout
+void displayLayoutToScreen(const displayPort_t *instance, uint8_t *x, uint8_t *y)
+{
+    if (instance->layoutCols && instance->layoutCols != instance->cols) {
+        *x = *x * instance->cols / instance->layoutCols;
+    }
+    if (instance->layoutRows && instance->layoutRows != instance->rows) {
+        *y = *y * instance->rows / instance->layoutRows;
+    }
+}
+
 void displayInit(displayPort_t *instance, const displayPortVTable_t *vTable)
 {
     instance->vTable = vTable;
+    instance->layoutRows = 0;
+    instance->layoutCols = 0;
     instance->vTable->clearScreen(instance);
     instance->useFullscreen = false;
     instance->cleared = true;
@@ -29,6 +29,9 @@ typedef struct displayPort_s {
     uint8_t cols;
     uint8_t posX;
     uint8_t posY;
+    // grid the OSD element positions are configured on when the screen is a larger canvas, zero otherwise
+    uint8_t layoutRows;
+    uint8_t layoutCols;
 
     // CMS state
     bool useFullscreen;
@@ -60,6 +63,9 @@ typedef struct displayPortProfile_s {
     bool invert;
     uint8_t blackBrightness;
     uint8_t whiteBrightness;
+    bool compactEncoding;   // MSP displayport: send the changes of a frame as run-length encoded spans
+    uint8_t canvasRows;     // MSP displayport: size of the canvas of an HD receiver, zero for the SD screen
+    uint8_t canvasCols;
 } displayPortProfile_t;
 
 // Note: displayPortProfile_t used as a parameter group for CMS over CRSF (io/displayport_crsf)
@@ -79,4 +85,5 @@ void displayHeartbeat(displayPort_t *instance);
 void displayResync(displayPort_t *instance);
 bool displayIsSynced(const displayPort_t *instance);
 uint16_t displayTxBytesFree(const displayPort_t *instance);
+void displayLayoutToScreen(const displayPort_t *instance, uint8_t *x, uint8_t *y);
 void displayInit(displayPort_t *instance, const displayPortVTable_t *vTable);
@@ -20,6 +20,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -173,15 +174,38 @@ static const uint8_t multiWiiFont[][5] = { // Refer to "Times New Roman" Font Da
                 { 0x7A, 0x7E, 0x7E, 0x7E, 0x7A }, //   (131)    - 0x00C8 Vertical Bargraph - 6 (full)
         };
 
+#define OLED_PAGE_COUNT (SCREEN_HEIGHT / 8)
+
+// The screen is drawn into a framebuffer, each page of 8 pixel rows that has changed since it was
+// last sent is marked dirty and sent with one queued write by i2c_OLED_update(). The queued page
+// writes are sent from the framebuffer, a page drawn while it is on the bus is sent again.
+static uint8_t oledFrame[OLED_PAGE_COUNT][SCREEN_WIDTH];
+static uint8_t oledDirtyPages;
+static uint8_t oledCursorX;
+static uint8_t oledCursorPage;
+
 static bool i2c_OLED_send_cmd(busDevice_t *bus, uint8_t command)
 {
     return i2cWrite(bus->busdev_u.i2c.device, bus->busdev_u.i2c.address, 0x80, command);
 }
 
+// Queues a write on the bus and returns, only waits while the queue of the bus is full
+static bool i2c_OLED_send(busDevice_t *bus, uint8_t control, uint8_t *data, uint8_t len)
+{
+    while (!i2cWriteBuffer(bus->busdev_u.i2c.device, bus->busdev_u.i2c.address, control, len, data)) {
+        if (!i2cBusy(bus->busdev_u.i2c.device, NULL)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static bool i2c_OLED_send_cmdarray(busDevice_t *bus, const uint8_t *commands, size_t len)
 {
     for (size_t i = 0 ; i < len ; i++) {
-        if (!i2c_OLED_send_cmd(bus, commands[i])) {
+        uint8_t command = commands[i];
+        if (!i2c_OLED_send(bus, 0x80, &command, 1)) {
             return false;
         }
     }
@@ -189,24 +213,56 @@ static bool i2c_OLED_send_cmdarray(busDevice_t *bus, const uint8_t *commands, si
     return true;
 }
 
-static bool i2c_OLED_send_byte(busDevice_t *bus, uint8_t val)
+// Queues the address window and the data of a page without waiting, false if the queue of the bus is full
+static bool i2c_OLED_queue_page(busDevice_t *bus, uint8_t page)
 {
-    return i2cWrite(bus->busdev_u.i2c.device, bus->busdev_u.i2c.address, 0x40, val);
+    uint8_t i2c_OLED_cmd_set_page[] = {
+        0x21, // Set Column Address
+        0,
+        SCREEN_WIDTH - 1,
+        0x22, // Set Page Address
+        page,
+        page,
+    };
+
+    // control byte 0x00, a stream of commands
+    if (!i2cWriteBuffer(bus->busdev_u.i2c.device, bus->busdev_u.i2c.address, 0x00, sizeof(i2c_OLED_cmd_set_page), i2c_OLED_cmd_set_page)) {
+        return false;
+    }
+
+    return i2cWriteBuffer(bus->busdev_u.i2c.device, bus->busdev_u.i2c.address, 0x40, SCREEN_WIDTH, oledFrame[page]);
 }
 
-void i2c_OLED_clear_display_quick(busDevice_t *bus)
+// Queues the dirty pages while the queue of the bus has room, the pages left are sent by the next call
+void i2c_OLED_update(busDevice_t *bus)
 {
-    static const uint8_t i2c_OLED_cmd_clear_display_quick[] = {
-        0xb0, // set page address to 0
-        0x40, // Display start line register to 0
-        0,    // Set low col address to 0
-        0x10, // Set high col address to 0
-    };
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT && oledDirtyPages; page++) {
+        if (!(oledDirtyPages & (1 << page))) {
+            continue;
+        }
+        if (!i2c_OLED_queue_page(bus, page)) {
+            return;
+        }
+        oledDirtyPages &= ~(1 << page);
+    }
+}
 
-    i2c_OLED_send_cmdarray(bus, i2c_OLED_cmd_clear_display_quick, ARRAYLEN(i2c_OLED_cmd_clear_display_quick));
+bool i2c_OLED_update_pending(void)
+{
+    return oledDirtyPages != 0;
+}
 
-    for (uint16_t i = 0; i < 1024; i++) {      // fill the display's RAM with graphic... 128*64 pixel picture
-        i2c_OLED_send_byte(bus, 0x00);  // clear
+void i2c_OLED_clear_display_quick(busDevice_t *bus)
+{
+    UNUSED(bus);
+
+    for (uint8_t page = 0; page < OLED_PAGE_COUNT; page++) {
+        for (unsigned x = 0; x < SCREEN_WIDTH; x++) {
+            if (oledFrame[page][x]) {
+                oledFrame[page][x] = 0;
+                oledDirtyPages |= 1 << page;
+            }
+        }
     }
 }
 
@@ -221,7 +277,15 @@ void i2c_OLED_clear_display(busDevice_t *bus)
 
     i2c_OLED_send_cmdarray(bus, i2c_OLED_cmd_clear_display_pre, ARRAYLEN(i2c_OLED_cmd_clear_display_pre));
 
-    i2c_OLED_clear_display_quick(bus);
+    // The RAM of the display is unknown, send every page before the display is switched on
+    memset(oledFrame, 0, sizeof(oledFrame));
+    oledDirtyPages = (1 << OLED_PAGE_COUNT) - 1;
+    while (oledDirtyPages) {
+        i2c_OLED_update(bus);
+        if (oledDirtyPages && !i2cBusy(bus->busdev_u.i2c.device, NULL)) {
+            break;
+        }
+    }
 
     static const uint8_t i2c_OLED_cmd_clear_display_post[] = {
         0x81, // Setup CONTRAST CONTROL, following byte is the contrast Value... always a 2 byte instruction
@@ -234,13 +298,10 @@ void i2c_OLED_clear_display(busDevice_t *bus)
 
 void i2c_OLED_set_xy(busDevice_t *bus, uint8_t col, uint8_t row)
 {
-    uint8_t i2c_OLED_cmd_set_xy[] = {
-        0xb0 + row,                                            //set page address
-        0x00 + ((CHARACTER_WIDTH_TOTAL * col) & 0x0f),         //set low col address
-        0x10 + (((CHARACTER_WIDTH_TOTAL * col) >> 4) & 0x0f)   //set high col address
-    };
+    UNUSED(bus);
 
-    i2c_OLED_send_cmdarray(bus, i2c_OLED_cmd_set_xy, ARRAYLEN(i2c_OLED_cmd_set_xy));
+    oledCursorX = CHARACTER_WIDTH_TOTAL * col;
+    oledCursorPage = row;
 }
 
 void i2c_OLED_set_line(busDevice_t *bus, uint8_t row)
@@ -250,14 +311,25 @@ void i2c_OLED_set_line(busDevice_t *bus, uint8_t row)
 
 void i2c_OLED_send_char(busDevice_t *bus, unsigned char ascii)
 {
-    unsigned char i;
-    uint8_t buffer;
-    for (i = 0; i < 5; i++) {
-        buffer = multiWiiFont[ascii - 32][i];
-        buffer ^= CHAR_FORMAT;  // apply
-        i2c_OLED_send_byte(bus, buffer);
+    UNUSED(bus);
+
+    if (oledCursorPage >= OLED_PAGE_COUNT || oledCursorX > SCREEN_WIDTH - CHARACTER_WIDTH_TOTAL) {
+        return;
     }
-    i2c_OLED_send_byte(bus, CHAR_FORMAT);    // the gap
+
+    uint8_t *column = &oledFrame[oledCursorPage][oledCursorX];
+    uint8_t changed = 0;
+    for (unsigned i = 0; i < CHARACTER_WIDTH_TOTAL; i++) {
+        // the last column is the gap
+        const uint8_t bits = (i < FONT_WIDTH ? multiWiiFont[ascii - 32][i] : 0) ^ CHAR_FORMAT;
+        changed |= column[i] ^ bits;
+        column[i] = bits;
+    }
+    if (changed) {
+        oledDirtyPages |= 1 << oledCursorPage;
+    }
+
+    oledCursorX += CHARACTER_WIDTH_TOTAL;
 }
 
 void i2c_OLED_send_string(busDevice_t *bus, const char *string)
@@ -20,7 +20,11 @@
 
 #pragma once
 
+#include "build/trace.h"
+
+#include "drivers/irq_load.h"
 #include "drivers/resource.h"
+#include "drivers/stack_check.h"
 
 // dmaResource_t is a opaque data type which represents a single DMA engine,
 // called and implemented differently in different families of STM32s.
@@ -57,11 +61,40 @@ typedef struct dmaChannelDescriptor_s {
     uint32_t                    completeFlag;
 } dmaChannelDescriptor_t;
 
-#if defined(STM32F7)
-//#define HAL_CLEANINVALIDATECACHE(addr, size) (SCB_CleanInvalidateDCache_by_Addr((uint32_t*)((uint32_t)addr & ~0x1f), ((uint32_t)(addr + size + 0x1f) & ~0x1f) - ((uint32_t)addr & ~0x1f)))
-//#define HAL_CLEANCACHE(addr, size) (SCB_CleanDCache_by_Addr((uint32_t*)((uint32_t)addr & ~0x1f), ((uint32_t)(addr + size + 0x1f) & ~0x1f) - ((uint32_t)addr & ~0x1f)))
-
+// Buffers the DMA writes own whole D-cache lines, so invalidating them never discards a neighbour's data.
+// Declare them with DMA_BUFFER_ALIGNED and round their size up with DMA_BUFFER_SIZE().
+#if defined(STM32F7) || defined(STM32H7)
+#define DMA_BUFFER_ALIGNMENT        32
+#else
+#define DMA_BUFFER_ALIGNMENT        4
 #endif
+#define DMA_BUFFER_ALIGNED          __attribute__ ((aligned(DMA_BUFFER_ALIGNMENT)))
+#define DMA_BUFFER_SIZE(size)       (((size) + DMA_BUFFER_ALIGNMENT - 1) & ~(DMA_BUFFER_ALIGNMENT - 1))
+
+// D-cache maintenance around DMA transfers. Clean a buffer before the DMA reads it, invalidate it
+// before the core reads what the DMA wrote. Only invalidate buffers that own their cache lines,
+// see DMA_BUFFER_ALIGNED, anything sharing a line with the buffer would be lost.
+#if defined(STM32F7) || defined(STM32H7)
+static inline void dmaBufferClean(const void *buffer, uint32_t length)
+{
+    const uint32_t alignedAddress = (uint32_t)buffer & ~(DMA_BUFFER_ALIGNMENT - 1);
+    SCB_CleanDCache_by_Addr((uint32_t *)alignedAddress, length + (uint32_t)buffer - alignedAddress);
+}
+
+static inline void dmaBufferInvalidate(void *buffer, uint32_t length)
+{
+    const uint32_t alignedAddress = (uint32_t)buffer & ~(DMA_BUFFER_ALIGNMENT - 1);
+    SCB_InvalidateDCache_by_Addr((uint32_t *)alignedAddress, length + (uint32_t)buffer - alignedAddress);
+}
+#else
+#define dmaBufferClean(buffer, length)      do {} while (0)
+#define dmaBufferInvalidate(buffer, length) do {} while (0)
+#endif
+
+static inline bool dmaBufferOwnsCacheLines(const void *buffer, uint32_t length)
+{
+    return (((uintptr_t)buffer | length) & (DMA_BUFFER_ALIGNMENT - 1)) == 0;
+}
 
 #define DMA_IDENTIFIER_TO_INDEX(x) ((x) - 1)
 
@@ -107,10 +140,15 @@ typedef enum {
     } 
 
 #define DEFINE_DMA_IRQ_HANDLER(d, s, i) void DMA ## d ## _Stream ## s ## _IRQHandler(void) {\
+                                                                STACK_CHECK_ISR_ENTER(); \
+                                                                IRQ_LOAD_ENTER(IRQ_LOAD_DMA); \
                                                                 const uint8_t index = DMA_IDENTIFIER_TO_INDEX(i); \
                                                                 dmaCallbackHandlerFuncPtr handler = dmaDescriptors[index].irqHandlerCallback; \
                                                                 if (handler) \
                                                                     handler(&dmaDescriptors[index]); \
+                                                                TRACE_EVENT(TRACE_DMA_COMPLETE, index, 0); \
+                                                                IRQ_LOAD_EXIT(IRQ_LOAD_DMA); \
+                                                                STACK_CHECK_ISR_EXIT(); \
                                                             }
 
 #define DMA_CLEAR_FLAG(d, flag) if (d->flagsShift > 31) d->dma->HIFCR = (flag << (d->flagsShift - 32)); else d->dma->LIFCR = (flag << d->flagsShift)
@@ -169,10 +207,15 @@ typedef enum {
     }
 
 #define DEFINE_DMA_IRQ_HANDLER(d, c, i) void DMA ## d ## _Channel ## c ## _IRQHandler(void) {\
+                                                                        STACK_CHECK_ISR_ENTER(); \
+                                                                        IRQ_LOAD_ENTER(IRQ_LOAD_DMA); \
                                                                         const uint8_t index = DMA_IDENTIFIER_TO_INDEX(i); \
                                                                         dmaCallbackHandlerFuncPtr handler = dmaDescriptors[index].irqHandlerCallback; \
                                                                         if (handler) \
                                                                             handler(&dmaDescriptors[index]); \
+                                                                        TRACE_EVENT(TRACE_DMA_COMPLETE, index, 0); \
+                                                                        IRQ_LOAD_EXIT(IRQ_LOAD_DMA); \
+                                                                        STACK_CHECK_ISR_EXIT(); \
                                                                     }
 
 #define DMA_CLEAR_FLAG(d, flag) d->dma->IFCR = (flag << d->flagsShift)
@@ -24,6 +24,8 @@
 
 #ifdef USE_DMA_SPEC
 
+#include "common/maths.h"
+
 #include "drivers/adc.h"
 #include "drivers/bus_spi.h"
 #include "drivers/serial.h"
@@ -501,4 +503,132 @@ dmaoptValue_t dmaGetUpOptionByTimer(const timerHardware_t *timer)
 }
 #endif
 
+// Assignment of streams to the planned users maximising the weight served. A depth first search
+// over the options of each user, heaviest first, giving up a branch once the weight left cannot beat
+// the best plan found. Each user can also go without DMA, so there always is a plan.
+
+#define DMA_PLAN_MAX_STEPS 50000    // keeps the CLI responsive, the best plan so far is used past this
+
+typedef struct dmaPlanState_s {
+    dmaPlanRequest_t *requests;
+    uint8_t order[DMA_PLAN_MAX_REQUESTS];
+    unsigned count;
+    dmaResource_t *used[DMA_PLAN_MAX_REQUESTS * 2];
+    unsigned usedCount;
+    dmaoptValue_t opt[DMA_PLAN_MAX_REQUESTS][2];
+    int bestWeight;                 // -1 until the first plan is found
+    unsigned steps;
+} dmaPlanState_t;
+
+static dmaPlanState_t dmaPlanState;
+
+static dmaResource_t *dmaPlanRef(const dmaPlanRequest_t *request, dmaPeripheral_e peripheral, dmaoptValue_t opt)
+{
+    const dmaChannelSpec_t *spec;
+
+    if (request->timer) {
+        spec = dmaGetChannelSpecByTimerValue(request->timer->tim, request->timer->channel, opt);
+    } else {
+        spec = dmaGetChannelSpecByPeripheral(peripheral, request->index, opt);
+    }
+
+    return spec ? spec->ref : NULL;
+}
+
+static bool dmaPlanClaim(dmaResource_t *ref)
+{
+    for (unsigned i = 0; i < dmaPlanState.usedCount; i++) {
+        if (dmaPlanState.used[i] == ref) {
+            return false;
+        }
+    }
+    dmaPlanState.used[dmaPlanState.usedCount++] = ref;
+
+    return true;
+}
+
+static void dmaPlanSearch(unsigned depth, unsigned weight, unsigned weightLeft)
+{
+    dmaPlanState_t *state = &dmaPlanState;
+
+    if ((int)(weight + weightLeft) <= state->bestWeight || ++state->steps > DMA_PLAN_MAX_STEPS) {
+        return;
+    }
+
+    if (depth == state->count) {
+        state->bestWeight = weight;
+        for (unsigned i = 0; i < state->count; i++) {
+            dmaPlanRequest_t *request = &state->requests[state->order[i]];
+            request->opt = state->opt[i][0];
+            request->rxOpt = state->opt[i][1];
+        }
+        return;
+    }
+
+    dmaPlanRequest_t *request = &state->requests[state->order[depth]];
+    const unsigned maxOpt = request->timer ? MAX_TIMER_DMA_OPTIONS : MAX_PERIPHERAL_DMA_OPTIONS;
+    const unsigned usedCount = state->usedCount;
+
+    for (unsigned opt = 0; opt < maxOpt; opt++) {
+        dmaResource_t *ref = dmaPlanRef(request, request->peripheral, opt);
+        if (!ref) {
+            continue;
+        }
+        if (!dmaPlanClaim(ref)) {
+            continue;
+        }
+        state->opt[depth][0] = opt;
+
+        if (request->spiPair) {
+            for (unsigned rxOpt = 0; rxOpt < maxOpt; rxOpt++) {
+                dmaResource_t *rxRef = dmaPlanRef(request, DMA_PERIPH_SPI_RX, rxOpt);
+                if (rxRef && dmaPlanClaim(rxRef)) {
+                    state->opt[depth][1] = rxOpt;
+                    dmaPlanSearch(depth + 1, weight + request->weight, weightLeft - request->weight);
+                    state->usedCount = usedCount + 1;
+                }
+            }
+        } else {
+            dmaPlanSearch(depth + 1, weight + request->weight, weightLeft - request->weight);
+        }
+        state->usedCount = usedCount;
+    }
+
+    // and without DMA
+    state->opt[depth][0] = DMA_OPT_UNUSED;
+    state->opt[depth][1] = DMA_OPT_UNUSED;
+    dmaPlanSearch(depth + 1, weight, weightLeft - request->weight);
+}
+
+// Fills in opt and rxOpt of every request, returns the weight of the requests given DMA
+unsigned dmaPlan(dmaPlanRequest_t *requests, unsigned count)
+{
+    dmaPlanState_t *state = &dmaPlanState;
+
+    state->requests = requests;
+    state->count = MIN(count, (unsigned)DMA_PLAN_MAX_REQUESTS);
+    state->usedCount = 0;
+    state->bestWeight = -1;
+    state->steps = 0;
+
+    unsigned weightLeft = 0;
+    for (unsigned i = 0; i < state->count; i++) {
+        requests[i].opt = DMA_OPT_UNUSED;
+        requests[i].rxOpt = DMA_OPT_UNUSED;
+        weightLeft += requests[i].weight;
+
+        // heaviest first, so the search settles the users that matter most before the rest
+        unsigned j = i;
+        while (j > 0 && requests[state->order[j - 1]].weight < requests[i].weight) {
+            state->order[j] = state->order[j - 1];
+            j--;
+        }
+        state->order[j] = i;
+    }
+
+    dmaPlanSearch(0, 0, weightLeft);
+
+    return state->bestWeight;
+}
+
 #endif // USE_DMA_SPEC
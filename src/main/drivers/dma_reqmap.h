@@ -69,3 +69,19 @@ const dmaChannelSpec_t *dmaGetChannelSpecByTimerValue(TIM_TypeDef *tim, uint8_t
 const dmaChannelSpec_t *dmaGetChannelSpecByTimer(const timerHardware_t *timer);
 dmaoptValue_t dmaGetOptionByTimer(const timerHardware_t *timer);
 dmaoptValue_t dmaGetUpOptionByTimer(const timerHardware_t *timer);
+
+// A user of DMA for dmaPlan() to find streams for. SPI buses need their TX and RX streams together
+// and are planned as one pair, the TX option goes in opt and the RX option in rxOpt.
+typedef struct dmaPlanRequest_s {
+    const timerHardware_t *timer;   // timer channel, NULL for a peripheral
+    dmaPeripheral_e peripheral;
+    uint8_t index;
+    bool spiPair;
+    uint8_t weight;                 // how much serving this user is worth
+    dmaoptValue_t opt;
+    dmaoptValue_t rxOpt;
+} dmaPlanRequest_t;
+
+#define DMA_PLAN_MAX_REQUESTS 24
+
+unsigned dmaPlan(dmaPlanRequest_t *requests, unsigned count);
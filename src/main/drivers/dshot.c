@@ -29,6 +29,7 @@
 #ifdef USE_DSHOT
 
 #include "build/atomic.h"
+#include "build/debug.h"
 
 #include "common/maths.h"
 #include "common/time.h"
@@ -133,6 +134,51 @@ FAST_CODE uint16_t prepareDshotPacket(dshotProtocolControl_t *pcb)
     return packet;
 }
 
+// Time from the start of a frame until the next frame can be sent. With bidirectional
+// DShot this includes the line turnaround and the telemetry response of the ESC.
+timeUs_t dshotGetUpdateWindowUs(motorPwmProtocolTypes_e protocol, bool bidirectional)
+{
+    uint32_t symbolRate;
+    uint32_t symbolCount = 17;  // 16 bits and the reset gap
+
+    switch (protocol) {
+    case PWM_TYPE_PROSHOT1000:
+        symbolRate = 250000;
+        symbolCount = 4;
+        break;
+    case PWM_TYPE_DSHOT600:
+        symbolRate = 600000;
+        break;
+    case PWM_TYPE_DSHOT300:
+        symbolRate = 300000;
+        break;
+    default:
+    case PWM_TYPE_DSHOT150:
+        symbolRate = 150000;
+        break;
+    }
+
+    const timeUs_t frameUs = 1000000 * symbolCount / symbolRate;
+    if (!bidirectional) {
+        return frameUs;
+    }
+    // Same window as the bitbang driver waits for before the next update
+    return 40 + 2 * frameUs;
+}
+
+// Returns the configured DShot rate if its update window fits in the update period,
+// otherwise the fastest rate, stopping at the first one that fits.
+motorPwmProtocolTypes_e dshotSelectProtocol(motorPwmProtocolTypes_e protocol, bool bidirectional, timeUs_t updatePeriodUs)
+{
+    if (protocol != PWM_TYPE_DSHOT150 && protocol != PWM_TYPE_DSHOT300) {
+        return protocol;
+    }
+    while (protocol < PWM_TYPE_DSHOT600 && dshotGetUpdateWindowUs(protocol, bidirectional) > updatePeriodUs) {
+        protocol++;
+    }
+    return protocol;
+}
+
 #ifdef USE_DSHOT_TELEMETRY
 FAST_RAM_ZERO_INIT dshotTelemetryState_t dshotTelemetryState;
 
@@ -141,6 +187,40 @@ uint16_t getDshotTelemetry(uint8_t index)
     return dshotTelemetryState.motorState[index].telemetryValue;
 }
 
+// Stores a valid value returned by the telemetry decoders, either eRPM or an extended telemetry frame
+FAST_CODE void dshotUpdateTelemetryData(uint8_t motorIndex, uint32_t value)
+{
+    dshotTelemetryMotorState_t *motorState = &dshotTelemetryState.motorState[motorIndex];
+
+    if (value & DSHOT_TELEMETRY_EXTENDED_FRAME) {
+        const uint8_t data = value & 0xff;
+
+        switch ((value >> 8) & 0x0f) {
+        case DSHOT_EDT_TEMPERATURE:
+            motorState->temperature = data;
+            break;
+        case DSHOT_EDT_VOLTAGE:
+            motorState->voltage = data * 25;
+            break;
+        case DSHOT_EDT_CURRENT:
+            motorState->current = data * 100;
+            break;
+        default:
+            // debug, stress and status frames are not used
+            return;
+        }
+        motorState->edtUpdated = true;
+
+        return;
+    }
+
+    motorState->telemetryValue = value;
+    motorState->telemetryActive = true;
+    if (motorIndex < 4) {
+        DEBUG_SET(DEBUG_DSHOT_RPM_TELEMETRY, motorIndex, value);
+    }
+}
+
 #endif
 
 #ifdef USE_DSHOT_TELEMETRY_STATS
@@ -22,6 +22,8 @@
 
 #include "common/time.h"
 
+#include "drivers/motor.h"
+
 #define DSHOT_MIN_THROTTLE       48
 #define DSHOT_MAX_THROTTLE     2047
 #define DSHOT_3D_FORWARD_MIN_THROTTLE 1048
@@ -59,12 +61,34 @@ uint16_t dshotConvertToExternal(float motorValue);
 
 FAST_CODE uint16_t prepareDshotPacket(dshotProtocolControl_t *pcb);
 
+timeUs_t dshotGetUpdateWindowUs(motorPwmProtocolTypes_e protocol, bool bidirectional);
+motorPwmProtocolTypes_e dshotSelectProtocol(motorPwmProtocolTypes_e protocol, bool bidirectional, timeUs_t updatePeriodUs);
+
 #ifdef USE_DSHOT_TELEMETRY
 extern bool useDshotTelemetry;
+extern bool useDshotEdt;
+
+// Returned by the telemetry decoders together with the 12 bit frame for extended telemetry frames
+#define DSHOT_TELEMETRY_EXTENDED_FRAME 0x80000000
+
+// Extended DShot telemetry frame types, the frame is tttt dddd dddd
+typedef enum {
+    DSHOT_EDT_TEMPERATURE = 0x02,   // C degrees
+    DSHOT_EDT_VOLTAGE = 0x04,       // 0.25V per step
+    DSHOT_EDT_CURRENT = 0x06,       // A
+    DSHOT_EDT_DEBUG1 = 0x08,
+    DSHOT_EDT_DEBUG2 = 0x0a,
+    DSHOT_EDT_STRESS = 0x0c,
+    DSHOT_EDT_STATUS = 0x0e,
+} dshotEdtType_e;
 
 typedef struct dshotTelemetryMotorState_s {
     uint16_t telemetryValue;
     bool telemetryActive;
+    bool edtUpdated;                // extended telemetry received since it was last read
+    int8_t temperature;             // C degrees
+    uint16_t voltage;               // 0.01V
+    uint16_t current;               // 0.01A
 } dshotTelemetryMotorState_t;
 
 
@@ -72,12 +96,22 @@ typedef struct dshotTelemetryState_s {
     bool useDshotTelemetry;
     uint32_t invalidPacketCount;
     uint32_t readCount;
+    uint32_t skippedUpdateCount;    // motor updates dropped while the telemetry window was still open
     dshotTelemetryMotorState_t motorState[MAX_SUPPORTED_MOTORS];
     uint32_t inputBuffer[MAX_GCR_EDGES];
 } dshotTelemetryState_t;
 
 extern dshotTelemetryState_t dshotTelemetryState;
 
+// eRPM frames are eeem mmmm mmmm with a normalised mantissa, so a frame with a
+// non zero exponent and the mantissa MSB clear is an extended telemetry frame
+static inline bool dshotIsExtendedTelemetryFrame(uint32_t frame)
+{
+    return useDshotEdt && (frame & 0x100) == 0 && (frame & 0xe00) != 0;
+}
+
+void dshotUpdateTelemetryData(uint8_t motorIndex, uint32_t value);
+
 #ifdef USE_DSHOT_TELEMETRY_STATS
 void updateDshotTelemetryQuality(dshotTelemetryQuality_t *qualityStats, bool packetValid, timeMs_t currentTimeMs);
 #endif
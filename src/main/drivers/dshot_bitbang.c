@@ -36,6 +36,7 @@
 #include "drivers/dshot_bitbang.h"
 #include "drivers/dshot_bitbang_impl.h"
 #include "drivers/dshot_command.h"
+#include "drivers/irq_load.h"
 #include "drivers/motor.h"
 #include "drivers/nvic.h"
 #include "drivers/pwm_output.h" // XXX for pwmOutputPort_t motors[]; should go away with refactoring
@@ -80,7 +81,7 @@ dshotBitbangStatus_e bbStatus;
 #endif
 
 BB_OUTPUT_BUFFER_ATTRIBUTE uint32_t bbOutputBuffer[MOTOR_DSHOT_BUFFER_SIZE * MAX_SUPPORTED_MOTOR_PORTS];
-BB_INPUT_BUFFER_ATTRIBUTE uint16_t bbInputBuffer[DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH * MAX_SUPPORTED_MOTOR_PORTS];
+BB_INPUT_BUFFER_ATTRIBUTE uint16_t bbInputBuffer[2 * DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH * MAX_SUPPORTED_MOTOR_PORTS];
 
 uint8_t bbPuPdMode;
 FAST_RAM_ZERO_INIT timeUs_t dshotFrameUs;
@@ -128,19 +129,12 @@ static void bbOutputDataInit(uint32_t *buffer, uint16_t portMask, bool inverted)
 
 static void bbOutputDataSet(uint32_t *buffer, int pinNumber, uint16_t value, bool inverted)
 {
-    uint32_t middleBit;
-
-    if (inverted) {
-        middleBit = (1 << (pinNumber + 0));
-    } else {
-        middleBit = (1 << (pinNumber + 16));
-    }
+    // Zero bits get the middle (port dependent) transition, computed without a branch per bit
+    const int middleBitShift = inverted ? pinNumber : pinNumber + 16;
+    const uint32_t zeroBits = ~value & 0xffff;
 
     for (int pos = 0; pos < 16; pos++) {
-        if (!(value & 0x8000)) {
-            buffer[pos * 3 + 1] |= middleBit;
-        }
-        value <<= 1;
+        buffer[pos * 3 + 1] |= ((zeroBits >> (15 - pos)) & 1) << middleBitShift;
     }
 }
 
@@ -263,6 +257,7 @@ static void bbAllocDma(bbPort_t *bbPort)
 
 void bbDMAIrqHandler(dmaChannelDescriptor_t *descriptor)
 {
+    IRQ_LOAD_ENTER(IRQ_LOAD_DSHOT_BITBANG);
     dbgPinHi(0);
 
     bbPort_t *bbPort = (bbPort_t *)descriptor->userParam;
@@ -297,6 +292,7 @@ void bbDMAIrqHandler(dmaChannelDescriptor_t *descriptor)
     }
 #endif
     dbgPinLo(0);
+    IRQ_LOAD_EXIT(IRQ_LOAD_DSHOT_BITBANG);
 }
 
 // Setup bbPorts array elements so that they each have a TIM1 or TIM8 channel
@@ -382,7 +378,8 @@ static bool bbMotorConfig(IO_t io, uint8_t motorIndex, motorPwmProtocolTypes_e p
         bbPort->portOutputBuffer = &bbOutputBuffer[(bbPort - bbPorts) * MOTOR_DSHOT_BUFFER_SIZE];
 
         bbPort->portInputCount = DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH;
-        bbPort->portInputBuffer = &bbInputBuffer[(bbPort - bbPorts) * DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH];
+        bbPort->portInputBuffer = &bbInputBuffer[(bbPort - bbPorts) * 2 * DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH];
+        bbPort->portDecodeBuffer = bbPort->portInputBuffer + DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH;
 
         bbTimebaseSetup(bbPort, pwmProtocolType);
         bbTIM_TimeBaseInit(bbPort, bbPort->outputARR);
@@ -399,6 +396,7 @@ static bool bbMotorConfig(IO_t io, uint8_t motorIndex, motorPwmProtocolTypes_e p
     bbMotors[motorIndex].io = io;
     bbMotors[motorIndex].output = output;
     bbMotors[motorIndex].bbPort = bbPort;
+    bbPort->portPinMask |= (1 << pinIndex);
 
     IOInit(io, OWNER_MOTOR, RESOURCE_INDEX(motorIndex));
 
@@ -425,49 +423,79 @@ static bool bbMotorConfig(IO_t io, uint8_t motorIndex, motorPwmProtocolTypes_e p
 static FAST_RAM_ZERO_INIT motorDevice_t bbDevice;
 static FAST_RAM_ZERO_INIT timeUs_t lastSendUs;
 
+#ifdef USE_DSHOT_TELEMETRY
+static FAST_RAM_ZERO_INIT bool telemetryDecodePending;
+
+// Hands the completed telemetry capture of each port to the decoder and
+// points the input DMA at the other buffer for the next capture.
+static void bbSwapInputBuffers(void)
+{
+    for (int i = 0; i < usedMotorPorts; i++) {
+        bbPort_t *bbPort = &bbPorts[i];
+        uint16_t *capturedBuffer = bbPort->portInputBuffer;
+
+        bbPort->portDecodeCount = bbPort->portInputCount - bbDMA_Count(bbPort);
+        bbPort->portInputBuffer = bbPort->portDecodeBuffer;
+        bbPort->portDecodeBuffer = capturedBuffer;
+#ifdef USE_DMA_REGISTER_CACHE
+        bbPort->dmaRegInput.M0AR = (uint32_t)bbPort->portInputBuffer;
+#else
+        bbDMAPreconfigure(bbPort, DSHOT_BITBANG_DIRECTION_INPUT);
+#endif
+    }
+
+    telemetryDecodePending = true;
+}
+
+static void bbDecodeTelemetry(void)
+{
+#ifdef USE_DSHOT_TELEMETRY_STATS
+    const timeMs_t currentTimeMs = millis();
+#endif
+    // All pins of a port are decoded from one pass over its samples
+    uint32_t portValues[MAX_SUPPORTED_MOTOR_PORTS][BB_PORT_PIN_COUNT];
+
+    for (int i = 0; i < usedMotorPorts; i++) {
+        decode_bb_port(bbPorts[i].portDecodeBuffer, bbPorts[i].portDecodeCount, bbPorts[i].portPinMask, portValues[i]);
+    }
+
+    for (int motorIndex = 0; motorIndex < MAX_SUPPORTED_MOTORS && motorIndex < motorCount; motorIndex++) {
+        const uint32_t value = portValues[bbMotors[motorIndex].bbPort - bbPorts][bbMotors[motorIndex].pinIndex];
+        if (value == BB_NOEDGE) {
+            continue;
+        }
+        dshotTelemetryState.readCount++;
+
+        if (value != BB_INVALID) {
+            dshotUpdateTelemetryData(motorIndex, value);
+        } else {
+            dshotTelemetryState.invalidPacketCount++;
+        }
+#ifdef USE_DSHOT_TELEMETRY_STATS
+        updateDshotTelemetryQuality(&dshotTelemetryQuality[motorIndex], value != BB_INVALID, currentTimeMs);
+#endif
+    }
+
+    telemetryDecodePending = false;
+}
+#endif
+
 static bool bbUpdateStart(void)
 {
 #ifdef USE_DSHOT_TELEMETRY
     if (useDshotTelemetry) {
-#ifdef USE_DSHOT_TELEMETRY_STATS
-        const timeMs_t currentTimeMs = millis();
-#endif
         timeUs_t currentUs = micros();
         // don't send while telemetry frames might still be incoming
         if (cmpTimeUs(currentUs, lastSendUs) < (timeDelta_t)(40 + 2 * dshotFrameUs)) {
             return false;
         }
 
-        for (int motorIndex = 0; motorIndex < MAX_SUPPORTED_MOTORS && motorIndex < motorCount; motorIndex++) {
-#ifdef STM32F4
-            uint32_t value = decode_bb_bitband(
-                bbMotors[motorIndex].bbPort->portInputBuffer,
-                bbMotors[motorIndex].bbPort->portInputCount - bbDMA_Count(bbMotors[motorIndex].bbPort),
-                bbMotors[motorIndex].pinIndex);
-#else
-            uint32_t value = decode_bb(
-                bbMotors[motorIndex].bbPort->portInputBuffer,
-                bbMotors[motorIndex].bbPort->portInputCount - bbDMA_Count(bbMotors[motorIndex].bbPort),
-                bbMotors[motorIndex].pinIndex);
-#endif
-            if (value == BB_NOEDGE) {
-                continue;
-            }
-            dshotTelemetryState.readCount++;
-
-            if (value != BB_INVALID) {
-                dshotTelemetryState.motorState[motorIndex].telemetryValue = value;
-                dshotTelemetryState.motorState[motorIndex].telemetryActive = true;
-                if (motorIndex < 4) {
-                    DEBUG_SET(DEBUG_DSHOT_RPM_TELEMETRY, motorIndex, value);
-                }
-            } else {
-                dshotTelemetryState.invalidPacketCount++;
-            }
-#ifdef USE_DSHOT_TELEMETRY_STATS
-            updateDshotTelemetryQuality(&dshotTelemetryQuality[motorIndex], value != BB_INVALID, currentTimeMs);
-#endif
+        // The previous capture is normally decoded after the last update was sent,
+        // only decode it here if that update was held back
+        if (telemetryDecodePending) {
+            bbDecodeTelemetry();
         }
+        bbSwapInputBuffers();
     }
 #endif
     for (int i = 0; i < usedMotorPorts; i++) {
@@ -515,7 +543,7 @@ static void bbWriteInt(uint8_t motorIndex, uint16_t value)
     }
 }
 
-static void bbWrite(uint8_t motorIndex, float value)
+void bbWrite(uint8_t motorIndex, float value)
 {
     bbWriteInt(motorIndex, value);
 }
@@ -551,6 +579,14 @@ static void bbUpdateComplete(void)
         bbPacer_t *bbPacer = &bbPacers[i];
         bbTIM_DMACmd(bbPacer->tim, bbPacer->dmaSources, ENABLE);
     }
+
+#ifdef USE_DSHOT_TELEMETRY
+    // Decode the previous capture while this update is being transmitted,
+    // the input DMA of the next capture writes to the other buffer
+    if (telemetryDecodePending) {
+        bbDecodeTelemetry();
+    }
+#endif
 }
 
 static bool bbEnableMotors(void)
@@ -629,6 +665,7 @@ motorDevice_t *dshotBitbangDevInit(const motorDevConfig_t *motorConfig, uint8_t
 
 #ifdef USE_DSHOT_TELEMETRY
     useDshotTelemetry = motorConfig->useDshotTelemetry;
+    useDshotEdt = useDshotTelemetry && motorConfig->useDshotEdt;
 #endif
 
     for (int motorIndex = 0; motorIndex < MAX_SUPPORTED_MOTORS && motorIndex < motorCount; motorIndex++) {
@@ -72,7 +72,10 @@ static uint32_t decode_bb_value(uint32_t value, uint16_t buffer[], uint32_t coun
         value = BB_INVALID;
     } else {
         value = decodedValue >> 4;
-        
+
+        if (dshotIsExtendedTelemetryFrame(value)) {
+            return DSHOT_TELEMETRY_EXTENDED_FRAME | value;
+        }
         if (value == 0x0fff) {
             return 0;
         }
@@ -292,4 +295,129 @@ FAST_CODE uint32_t decode_bb( uint16_t buffer[], uint32_t count, uint32_t bit)
     return decode_bb_value(value, buffer, count, bit);
 }
 
+// Decodes the frame completed by the pin's edges, the last level has no edge.
+static uint32_t decode_bb_frame(uint32_t value, uint32_t bits, uint16_t buffer[], uint32_t count, uint32_t bit)
+{
+    if (bits < 18) {
+        return BB_NOEDGE;
+    }
+
+    const int nlen = 21 - bits;
+    if (nlen < 0) {
+        value = BB_INVALID;
+    }
+    if (nlen > 0) {
+        value <<= nlen;
+        value |= 1 << (nlen - 1);
+    }
+    return decode_bb_value(value, buffer, count, bit);
+}
+
+typedef struct bbPinDecode_s {
+    uint32_t value;
+    uint32_t bits;
+    uint32_t lastEdge;
+    uint32_t endIndex;
+} bbPinDecode_t;
+
+typedef struct bbPortDecode_s {
+    bbPinDecode_t pin[BB_PORT_PIN_COUNT];
+    uint16_t active;            // pins inside their frame
+    uint16_t level;             // last level of the active pins
+} bbPortDecode_t;
+
+static inline void decode_bb_edges(bbPortDecode_t *port, uint16_t edges, uint32_t index)
+{
+    for (; edges; edges &= edges - 1) {
+        const int pin = __builtin_ctz(edges);
+        bbPinDecode_t *state = &port->pin[pin];
+
+        if (index >= state->endIndex) {
+            port->active &= ~(1 << pin);
+            continue;
+        }
+        // A level of length n gets decoded to a sequence of bits of
+        // the form 1000 with a length of (n+1) / 3 to account for 3x
+        // oversampling.
+        const int len = MAX((index + 2 - state->lastEdge) / 3, 1u);
+        state->bits += len;
+        state->value <<= len;
+        state->value |= 1 << (len - 1);
+        state->lastEdge = index + 1;
+        port->level ^= 1 << pin;
+    }
+}
+
+// Decodes the telemetry of every pin in pinMask in a single pass over the port samples.
+// Each sample is read once for all pins and only the pins that changed level are
+// handled, instead of one scan of the whole buffer per pin.
+// The result for each pin is the same as decode_bb() on that pin, values[] is indexed by pin.
+FAST_CODE void decode_bb_port(uint16_t buffer[], uint32_t count, uint16_t pinMask, uint32_t values[BB_PORT_PIN_COUNT])
+{
+    for (int pin = 0; pin < BB_PORT_PIN_COUNT; pin++) {
+        values[pin] = BB_NOEDGE;
+    }
+
+    if (count < MIN_VALID_BBSAMPLES + 4) {
+        return;
+    }
+
+    bbPortDecode_t port;
+    port.active = 0;
+    port.level = 0;
+
+    // decode_bb() looks for the leading zero in groups of 4 samples up to this index
+    const uint32_t searchEnd = (count - MIN_VALID_BBSAMPLES + 3) & ~3;
+
+    uint16_t waiting = pinMask; // pins still looking for the leading zero
+    uint16_t started = 0;
+    uint32_t frameEnd = 0;
+    uint32_t i = 0;
+
+    for (; i <= searchEnd && waiting; i++) {
+        const uint16_t sample = buffer[i];
+
+        const uint16_t edges = (sample ^ port.level) & port.active;
+        if (edges) {
+            decode_bb_edges(&port, edges, i);
+        }
+
+        uint16_t low = ~sample & waiting;
+        uint32_t start = i;
+        if (i == searchEnd) {
+            // No leading zero found, the frame may still start on this sample
+            waiting = 0;
+        } else if (low) {
+            waiting &= ~low;
+            // The frame starts after the leading zero if the next sample is low as well
+            low &= ~buffer[i + 1];
+            start = i + 1;
+        }
+
+        started |= low;
+        port.active |= low;
+        for (; low; low &= low - 1) {
+            bbPinDecode_t *state = &port.pin[__builtin_ctz(low)];
+            state->value = 0;
+            state->bits = 0;
+            state->lastEdge = start;
+            state->endIndex = start + MIN(count - start, (unsigned int)MAX_VALID_BBSAMPLES) - 1;
+            frameEnd = MAX(frameEnd, state->endIndex);
+        }
+    }
+
+    // Every pin has started, only level changes are left to handle
+    for (; i < frameEnd && port.active; i++) {
+        const uint16_t edges = (buffer[i] ^ port.level) & port.active;
+        if (edges) {
+            decode_bb_edges(&port, edges, i);
+        }
+    }
+
+    for (; started; started &= started - 1) {
+        const int pin = __builtin_ctz(started);
+        values[pin] = decode_bb_frame(port.pin[pin].value, port.pin[pin].bits, buffer, count, pin);
+    }
+}
+
 #endif
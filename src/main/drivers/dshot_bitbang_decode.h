@@ -23,7 +23,10 @@
 #define BB_NOEDGE 0xfffe
 #define BB_INVALID 0xffff
 
+#define BB_PORT_PIN_COUNT 16
+
 uint32_t decode_bb(uint16_t buffer[], uint32_t count, uint32_t mask);
 uint32_t decode_bb_bitband( uint16_t buffer[], uint32_t count, uint32_t bit);
+void decode_bb_port(uint16_t buffer[], uint32_t count, uint16_t pinMask, uint32_t values[BB_PORT_PIN_COUNT]);
 
 #endif
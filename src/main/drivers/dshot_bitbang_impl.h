@@ -109,6 +109,7 @@ typedef struct bbPort_s {
     uint32_t dmaChannel;        // DMA channel or peripheral request
 
     uint8_t direction;
+    uint16_t portPinMask;       // GPIO pins of the motors on this port
 
 #ifdef USE_DMA_REGISTER_CACHE 
     // DMA resource register cache
@@ -149,6 +150,8 @@ typedef struct bbPort_s {
 #endif
     uint16_t *portInputBuffer;
     uint32_t portInputCount;
+    uint16_t *portDecodeBuffer; // previous capture, decoded while the next one is in progress
+    uint32_t portDecodeCount;
     bool inputActive;
 
     // Misc
@@ -200,8 +203,9 @@ extern uint32_t bbOutputBuffer[MOTOR_DSHOT_BUFFER_SIZE * MAX_SUPPORTED_MOTOR_POR
 // <slack> = 10%
 // (30 + 26 + 3) / 0.44 = 134
 // In some cases this was not enough, so we add 6 extra samples
+// Each port has two input buffers, one is captured into while the other is decoded
 #define DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH 140
-extern uint16_t bbInputBuffer[DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH * MAX_SUPPORTED_MOTOR_PORTS];
+extern uint16_t bbInputBuffer[2 * DSHOT_BITBANG_PORT_INPUT_BUFFER_LENGTH * MAX_SUPPORTED_MOTOR_PORTS];
 
 void bbGpioSetup(bbMotor_t *bbMotor);
 void bbTimerChannelInit(bbPort_t *bbPort);
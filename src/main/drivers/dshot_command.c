@@ -25,6 +25,7 @@
 
 #ifdef USE_DSHOT
 
+#include "common/maths.h"
 #include "common/time.h"
 
 #include "drivers/io.h"
@@ -35,13 +36,14 @@
 #include "drivers/dshot.h"
 #include "drivers/dshot_dpwm.h"
 #include "drivers/dshot_command.h"
+#include "drivers/pendsv.h"
 #include "drivers/pwm_output.h"
 
 #define DSHOT_INITIAL_DELAY_US 10000
 #define DSHOT_COMMAND_DELAY_US 1000
-#define DSHOT_ESCINFO_DELAY_US 12000
-#define DSHOT_BEEP_DELAY_US 100000
-#define DSHOT_MAX_COMMANDS 3
+#define DSHOT_ESCINFO_DELAY_US 12000u
+#define DSHOT_BEEP_DELAY_US 100000u
+#define DSHOT_MAX_COMMANDS 6
 
 typedef enum {
     DSHOT_COMMAND_STATE_IDLEWAIT,   // waiting for motors to go idle
@@ -127,15 +129,14 @@ static FAST_CODE uint32_t dshotCommandCyclesFromTime(timeUs_t delayUs)
     return (delayUs + dshotCommandPidLoopTimeUs - 1) / dshotCommandPidLoopTimeUs;
 }
 
+// Returns the free entry at the head of the queue, dshotCommandQueue() only moves the head past it once it is filled
 static dshotCommandControl_t* addCommand()
 {
     int newHead = (commandQueueHead + 1) % (DSHOT_MAX_COMMANDS + 1);
     if (newHead == commandQueueTail) {
         return NULL;
     }
-    dshotCommandControl_t* control = &commandQueue[commandQueueHead];
-    commandQueueHead = newHead;
-    return control;
+    return &commandQueue[commandQueueHead];
 }
 
 static bool allMotorsAreIdle(void)
@@ -150,83 +151,133 @@ static bool allMotorsAreIdle(void)
     return true;
 }
 
-void dshotCommandWrite(uint8_t index, uint8_t motorCount, uint8_t command, bool blocking)
+static void dshotCommandTiming(uint8_t command, uint8_t *repeats, timeUs_t *delayAfterCommandUs)
 {
-    UNUSED(motorCount);
-
-    if (!isMotorProtocolDshot() || (command > DSHOT_MAX_COMMAND) || dshotCommandQueueFull()) {
-        return;
-    }
-
-    uint8_t repeats = 1;
-    timeUs_t delayAfterCommandUs = DSHOT_COMMAND_DELAY_US;
-
     switch (command) {
     case DSHOT_CMD_SPIN_DIRECTION_1:
     case DSHOT_CMD_SPIN_DIRECTION_2:
     case DSHOT_CMD_3D_MODE_OFF:
     case DSHOT_CMD_3D_MODE_ON:
     case DSHOT_CMD_SAVE_SETTINGS:
+    case DSHOT_CMD_EXTENDED_TELEMETRY_ENABLE:
+    case DSHOT_CMD_EXTENDED_TELEMETRY_DISABLE:
     case DSHOT_CMD_SPIN_DIRECTION_NORMAL:
     case DSHOT_CMD_SPIN_DIRECTION_REVERSED:
     case DSHOT_CMD_SIGNAL_LINE_TELEMETRY_DISABLE:
     case DSHOT_CMD_SIGNAL_LINE_CONTINUOUS_ERPM_TELEMETRY:
-        repeats = 10;
+        *repeats = MAX(*repeats, 10);
         break;
     case DSHOT_CMD_BEACON1:
     case DSHOT_CMD_BEACON2:
     case DSHOT_CMD_BEACON3:
     case DSHOT_CMD_BEACON4:
     case DSHOT_CMD_BEACON5:
-        delayAfterCommandUs = DSHOT_BEEP_DELAY_US;
+        *delayAfterCommandUs = MAX(*delayAfterCommandUs, DSHOT_BEEP_DELAY_US);
+        break;
+    case DSHOT_CMD_ESC_INFO:
+        // leave the ESC time to send its info frame before the next command
+        *delayAfterCommandUs = MAX(*delayAfterCommandUs, DSHOT_ESCINFO_DELAY_US);
         break;
     default:
         break;
     }
+}
+
+static void dshotCommandQueue(const uint8_t *commands, uint8_t motorCount, uint8_t repeats, timeUs_t delayAfterCommandUs)
+{
+    // The queue is read by the PID loop, which may run from PendSV
+    PENDSV_BLOCK {
+        dshotCommandControl_t *commandControl = addCommand();
+
+        commandControl->repeats = repeats;
+        commandControl->delayAfterCommandUs = delayAfterCommandUs;
+        for (unsigned i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+            commandControl->command[i] = i < motorCount ? commands[i] : DSHOT_CMD_MOTOR_STOP;
+        }
+        if (allMotorsAreIdle()) {
+            // we can skip the motors idle wait state
+            commandControl->state = DSHOT_COMMAND_STATE_STARTDELAY;
+            commandControl->nextCommandCycleDelay = dshotCommandCyclesFromTime(DSHOT_INITIAL_DELAY_US);
+        } else {
+            commandControl->state = DSHOT_COMMAND_STATE_IDLEWAIT;
+            commandControl->nextCommandCycleDelay = 0;  // will be set after idle wait completes
+        }
+
+        commandQueueHead = (commandQueueHead + 1) % (DSHOT_MAX_COMMANDS + 1);
+    }
+}
+
+bool dshotCommandWrite(uint8_t index, uint8_t motorCount, uint8_t command, bool blocking)
+{
+    if (!isMotorProtocolDshot() || (command > DSHOT_MAX_COMMAND) || dshotCommandQueueFull()) {
+        return false;
+    }
+
+    uint8_t repeats = 1;
+    timeUs_t delayAfterCommandUs = DSHOT_COMMAND_DELAY_US;
+
+    dshotCommandTiming(command, &repeats, &delayAfterCommandUs);
 
     if (blocking) {
-        delayMicroseconds(DSHOT_INITIAL_DELAY_US - DSHOT_COMMAND_DELAY_US);
-        for (; repeats; repeats--) {
-            delayMicroseconds(DSHOT_COMMAND_DELAY_US);
+        // Keep the PID loop from writing to the motors in between
+        PENDSV_BLOCK {
+            delayMicroseconds(DSHOT_INITIAL_DELAY_US - DSHOT_COMMAND_DELAY_US);
+            for (; repeats; repeats--) {
+                delayMicroseconds(DSHOT_COMMAND_DELAY_US);
 
 #ifdef USE_DSHOT_TELEMETRY
-            timeUs_t timeoutUs = micros() + 1000;
-            while (!pwmStartDshotMotorUpdate() &&
-                   cmpTimeUs(timeoutUs, micros()) > 0);
+                timeUs_t timeoutUs = micros() + 1000;
+                while (!pwmStartDshotMotorUpdate() &&
+                       cmpTimeUs(timeoutUs, micros()) > 0);
 #endif
-            for (uint8_t i = 0; i < dshotPwmDevice.count; i++) {
-                if ((i == index) || (index == ALL_MOTORS)) {
-                    motorDmaOutput_t *const motor = getMotorDmaOutput(i);
-                    motor->protocolControl.requestTelemetry = true;
-                    dshotPwmDevice.vTable.writeInt(i, command);
+                for (uint8_t i = 0; i < dshotPwmDevice.count; i++) {
+                    if ((i == index) || (index == ALL_MOTORS)) {
+                        motorDmaOutput_t *const motor = getMotorDmaOutput(i);
+                        motor->protocolControl.requestTelemetry = true;
+                        dshotPwmDevice.vTable.writeInt(i, command);
+                    }
                 }
-            }
 
-            dshotPwmDevice.vTable.updateComplete();
+                dshotPwmDevice.vTable.updateComplete();
+            }
+            delayMicroseconds(delayAfterCommandUs);
         }
-        delayMicroseconds(delayAfterCommandUs);
     } else {
-        dshotCommandControl_t *commandControl = addCommand();
-        if (commandControl) {
-            commandControl->repeats = repeats;
-            commandControl->delayAfterCommandUs = delayAfterCommandUs;
-            for (unsigned i = 0; i < motorCount; i++) {
-                if (index == i || index == ALL_MOTORS) {
-                    commandControl->command[i] = command;
-                } else {
-                    commandControl->command[i] = DSHOT_CMD_MOTOR_STOP;
-                }
-            }
-            if (allMotorsAreIdle()) {
-                // we can skip the motors idle wait state
-                commandControl->state = DSHOT_COMMAND_STATE_STARTDELAY;
-                commandControl->nextCommandCycleDelay = dshotCommandCyclesFromTime(DSHOT_INITIAL_DELAY_US);
-            } else {
-                commandControl->state = DSHOT_COMMAND_STATE_IDLEWAIT;
-                commandControl->nextCommandCycleDelay = 0;  // will be set after idle wait completes
-            }
+        uint8_t commands[MAX_SUPPORTED_MOTORS];
+        motorCount = MIN(motorCount, MAX_SUPPORTED_MOTORS);
+        for (unsigned i = 0; i < motorCount; i++) {
+            commands[i] = (index == i || index == ALL_MOTORS) ? command : DSHOT_CMD_MOTOR_STOP;
+        }
+        dshotCommandQueue(commands, motorCount, repeats, delayAfterCommandUs);
+    }
+
+    return true;
+}
+
+// Queues a different command for each motor, sent together in one command
+// sequence. The sequence uses the longest repeat count and post command delay
+// of the individual commands. Use DSHOT_CMD_MOTOR_STOP for motors that should
+// not receive a command.
+bool dshotCommandWriteMotors(const uint8_t *commands, uint8_t motorCount)
+{
+    if (!isMotorProtocolDshot() || dshotCommandQueueFull()) {
+        return false;
+    }
+
+    uint8_t repeats = 1;
+    timeUs_t delayAfterCommandUs = DSHOT_COMMAND_DELAY_US;
+
+    motorCount = MIN(motorCount, MAX_SUPPORTED_MOTORS);
+    for (unsigned i = 0; i < motorCount; i++) {
+        if (commands[i] > DSHOT_MAX_COMMAND) {
+            return false;
         }
+        dshotCommandTiming(commands[i], &repeats, &delayAfterCommandUs);
     }
+
+    dshotCommandQueue(commands, motorCount, repeats, delayAfterCommandUs);
+
+    return true;
 }
 
 uint8_t dshotCommandGetCurrent(uint8_t index)
@@ -45,6 +45,8 @@ typedef enum {
     DSHOT_CMD_3D_MODE_ON,
     DSHOT_CMD_SETTINGS_REQUEST, // Currently not implemented
     DSHOT_CMD_SAVE_SETTINGS,
+    DSHOT_CMD_EXTENDED_TELEMETRY_ENABLE,
+    DSHOT_CMD_EXTENDED_TELEMETRY_DISABLE,
     DSHOT_CMD_SPIN_DIRECTION_NORMAL = 20,
     DSHOT_CMD_SPIN_DIRECTION_REVERSED = 21,
     DSHOT_CMD_LED0_ON, // BLHeli32 only
@@ -62,7 +64,8 @@ typedef enum {
     DSHOT_CMD_MAX = 47
 } dshotCommands_e;
 
-void dshotCommandWrite(uint8_t index, uint8_t motorCount, uint8_t command, bool blocking);
+bool dshotCommandWrite(uint8_t index, uint8_t motorCount, uint8_t command, bool blocking);
+bool dshotCommandWriteMotors(const uint8_t *commands, uint8_t motorCount);
 void dshotSetPidLoopTime(uint32_t pidLoopTime);
 bool dshotCommandQueueEmpty(void);
 bool dshotCommandIsProcessing(void);
@@ -49,6 +49,7 @@ FAST_RAM_ZERO_INIT bool useBurstDshot = false;
 #endif
 #ifdef USE_DSHOT_TELEMETRY
 FAST_RAM_ZERO_INIT bool useDshotTelemetry = false;
+FAST_RAM_ZERO_INIT bool useDshotEdt = false;
 #endif
 
 FAST_RAM_ZERO_INIT loadDmaBufferFn *loadDmaBuffer;
@@ -130,7 +131,7 @@ static FAST_CODE void dshotWriteInt(uint8_t index, uint16_t value)
     pwmWriteDshotInt(index, value);
 }
 
-static FAST_CODE void dshotWrite(uint8_t index, float value)
+FAST_CODE void dshotWrite(uint8_t index, float value)
 {
     pwmWriteDshotInt(index, lrintf(value));
 }
@@ -160,6 +161,7 @@ motorDevice_t *dshotPwmDevInit(const motorDevConfig_t *motorConfig, uint16_t idl
 
 #ifdef USE_DSHOT_TELEMETRY
     useDshotTelemetry = motorConfig->useDshotTelemetry;
+    useDshotEdt = useDshotTelemetry && motorConfig->useDshotEdt;
     dshotPwmDevice.vTable.updateStart = pwmStartDshotMotorUpdate;
 #endif
 
@@ -26,7 +26,9 @@
 
 #ifdef USE_EXTI
 
+#include "drivers/irq_load.h"
 #include "drivers/nvic.h"
+#include "drivers/stack_check.h"
 #include "io_impl.h"
 #include "drivers/exti.h"
 
@@ -231,6 +233,9 @@ void EXTIEnable(IO_t io, bool enable)
 
 void EXTI_IRQHandler(void)
 {
+    STACK_CHECK_ISR_ENTER();
+    IRQ_LOAD_ENTER(IRQ_LOAD_EXTI);
+
     uint32_t exti_active = EXTI_REG_IMR & EXTI_REG_PR;
 
     while (exti_active) {
@@ -240,6 +245,9 @@ void EXTI_IRQHandler(void)
         EXTI_REG_PR = mask;  // clear pending mask (by writing 1)
         exti_active &= ~mask;
     }
+
+    IRQ_LOAD_EXIT(IRQ_LOAD_EXTI);
+    STACK_CHECK_ISR_EXIT();
 }
 
 #define _EXTI_IRQ_HANDLER(name)                 \
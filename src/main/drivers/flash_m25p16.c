@@ -83,29 +83,9 @@ STATIC_ASSERT(M25P16_PAGESIZE < FLASH_MAX_PAGE_SIZE, M25P16_PAGESIZE_too_small);
 
 const flashVTable_t m25p16_vTable;
 
-#ifndef USE_SPI_TRANSACTION
-static void m25p16_disable(busDevice_t *bus)
-{
-    IOHi(bus->busdev_u.spi.csnPin);
-    __NOP();
-}
-
-static void m25p16_enable(busDevice_t *bus)
-{
-    __NOP();
-    IOLo(bus->busdev_u.spi.csnPin);
-}
-#endif
-
 static void m25p16_transfer(busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int len)
 {
-#ifdef USE_SPI_TRANSACTION
-    spiBusTransactionTransfer(bus, txData, rxData, len);
-#else
-    m25p16_enable(bus);
-    spiTransfer(bus->busdev_u.spi.instance, txData, rxData, len);
-    m25p16_disable(bus);
-#endif
+    spiBusTransfer(bus, txData, rxData, len);
 }
 
 /**
@@ -113,13 +93,7 @@ static void m25p16_transfer(busDevice_t *bus, const uint8_t *txData, uint8_t *rx
  */
 static void m25p16_performOneByteCommand(busDevice_t *bus, uint8_t command)
 {
-#ifdef USE_SPI_TRANSACTION
     m25p16_transfer(bus, &command, NULL, 1);
-#else
-    m25p16_enable(bus);
-    spiTransferByte(bus->busdev_u.spi.instance, command);
-    m25p16_disable(bus);
-#endif
 }
 
 /**
@@ -290,22 +264,19 @@ static void m25p16_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *da
 
     m25p16_waitForReady(fdevice);
 
-    m25p16_writeEnable(fdevice);
-
-#ifdef USE_SPI_TRANSACTION
-    spiBusTransactionBegin(fdevice->io.handle.busdev);
-#else
-    m25p16_enable(fdevice->io.handle.busdev);
-#endif
+    // The write enable and the program are one sequence, so nothing else gets on the bus between them
+    const uint8_t writeEnable = M25P16_INSTRUCTION_WRITE_ENABLE;
+    const busSegment_t segments[] = {
+        { &writeEnable, NULL, 1, true, NULL },
+        { command, NULL, fdevice->isLargeFlash ? 5 : 4, false, NULL },
+        { data, NULL, length, true, NULL },
+        { NULL, NULL, 0, true, NULL },
+    };
 
-    spiTransfer(fdevice->io.handle.busdev->busdev_u.spi.instance, command, NULL, fdevice->isLargeFlash ? 5 : 4);
-    spiTransfer(fdevice->io.handle.busdev->busdev_u.spi.instance, data, NULL, length);
+    // The data buffer is reused as soon as this returns, so wait for the sequence
+    spiBusRunSequence(fdevice->io.handle.busdev, segments);
 
-#ifdef USE_SPI_TRANSACTION
-    spiBusTransactionEnd(fdevice->io.handle.busdev);
-#else
-    m25p16_disable(fdevice->io.handle.busdev);
-#endif
+    fdevice->couldBeBusy = true;
 
     fdevice->currentWriteAddress += length;
 
@@ -357,20 +328,13 @@ static int m25p16_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *b
         return 0;
     }
 
-#ifdef USE_SPI_TRANSACTION
-    spiBusTransactionBegin(fdevice->io.handle.busdev);
-#else
-    m25p16_enable(fdevice->io.handle.busdev);
-#endif
-
-    spiTransfer(fdevice->io.handle.busdev->busdev_u.spi.instance, command, NULL, fdevice->isLargeFlash ? 5 : 4);
-    spiTransfer(fdevice->io.handle.busdev->busdev_u.spi.instance, NULL, buffer, length);
+    const busSegment_t segments[] = {
+        { command, NULL, fdevice->isLargeFlash ? 5 : 4, false, NULL },
+        { NULL, buffer, length, true, NULL },
+        { NULL, NULL, 0, true, NULL },
+    };
 
-#ifdef USE_SPI_TRANSACTION
-    spiBusTransactionEnd(fdevice->io.handle.busdev);
-#else
-    m25p16_disable(fdevice->io.handle.busdev);
-#endif
+    spiBusRunSequence(fdevice->io.handle.busdev, segments);
 
     m25p16_setTimeout(fdevice, DEFAULT_TIMEOUT_MILLIS);
 
@@ -21,6 +21,10 @@
 /*
  * Winbond W25M series stacked die flash driver.
  * Handles homogeneous stack of identical dies by calling die drivers.
+ *
+ * Consecutive pages are striped across the dies, so that one die accepts the next page while the other is still
+ * programming the previous one. A sector of the stack is made of the sector with the same index on every die, which
+ * are erased concurrently.
  * 
  * Author: jflyper
  */
@@ -58,6 +62,13 @@ static flashDevice_t dieDevice[MAX_DIE_COUNT];
 
 static int dieCount;
 static uint32_t dieSize;
+static uint16_t diePageSize;
+
+// Dies erasing have to be done before the stack reports ready, a die programming only if the next page goes to it
+static bool dieErasing[MAX_DIE_COUNT];
+
+// Stack address of the byte following the last one programmed, which tells the die the next page goes to
+static uint32_t nextWriteAddress;
 
 static void w25m_dieSelect(busDevice_t *busdev, int die)
 {
@@ -78,14 +89,30 @@ static void w25m_dieSelect(busDevice_t *busdev, int die)
     activeDie = die;
 }
 
+/*
+ * Translate a stack address into the die holding it and the address on that die.
+ */
+static uint32_t w25m_dieAddress(uint32_t address, int *die)
+{
+    const uint32_t page = address / diePageSize;
+
+    *die = page % dieCount;
+
+    return (page / dieCount) * diePageSize + address % diePageSize;
+}
+
 static bool w25m_isReady(flashDevice_t *fdevice)
 {
+    int nextWriteDie;
+    w25m_dieAddress(nextWriteAddress, &nextWriteDie);
+
     for (int die = 0 ; die < dieCount ; die++) {
-        if (dieDevice[die].couldBeBusy) {
+        if (dieDevice[die].couldBeBusy && (dieErasing[die] || die == nextWriteDie)) {
             w25m_dieSelect(fdevice->io.handle.busdev, die);
             if (!dieDevice[die].vTable->isReady(&dieDevice[die])) {
                 return false;
             }
+            dieErasing[die] = false;
         }
     }
 
@@ -99,6 +126,7 @@ static bool w25m_waitForReady(flashDevice_t *fdevice)
         if (!dieDevice[die].vTable->waitForReady(&dieDevice[die])) {
             return false;
         }
+        dieErasing[die] = false;
     }
 
     return true;
@@ -132,9 +160,10 @@ bool w25m_detect(flashDevice_t *fdevice, uint32_t chipID)
     }
 
     fdevice->geometry.sectors = dieDevice[0].geometry.sectors;
-    fdevice->geometry.sectorSize = dieDevice[0].geometry.sectorSize;
-    fdevice->geometry.pagesPerSector = dieDevice[0].geometry.pagesPerSector;
+    fdevice->geometry.sectorSize = dieDevice[0].geometry.sectorSize * dieCount;
+    fdevice->geometry.pagesPerSector = dieDevice[0].geometry.pagesPerSector * dieCount;
     fdevice->geometry.pageSize = dieDevice[0].geometry.pageSize;
+    diePageSize = dieDevice[0].geometry.pageSize;
     dieSize = dieDevice[0].geometry.totalSize;
     fdevice->geometry.totalSize = dieSize * dieCount;
     fdevice->vTable = &w25m_vTable;
@@ -144,11 +173,14 @@ bool w25m_detect(flashDevice_t *fdevice, uint32_t chipID)
 
 void w25m_eraseSector(flashDevice_t *fdevice, uint32_t address)
 {
-    int dieNumber = address / dieSize;
-
-    w25m_dieSelect(fdevice->io.handle.busdev, dieNumber);
+    const uint32_t dieSectorAddress = address / fdevice->geometry.sectorSize * dieDevice[0].geometry.sectorSize;
 
-    dieDevice[dieNumber].vTable->eraseSector(&dieDevice[dieNumber], address % dieSize);
+    // Start the erase on every die before waiting for any of them
+    for (int dieNumber = 0 ; dieNumber < dieCount ; dieNumber++) {
+        w25m_dieSelect(fdevice->io.handle.busdev, dieNumber);
+        dieDevice[dieNumber].vTable->eraseSector(&dieDevice[dieNumber], dieSectorAddress);
+        dieErasing[dieNumber] = true;
+    }
 }
 
 void w25m_eraseCompletely(flashDevice_t *fdevice)
@@ -156,27 +188,26 @@ void w25m_eraseCompletely(flashDevice_t *fdevice)
     for (int dieNumber = 0 ; dieNumber < dieCount ; dieNumber++) {
         w25m_dieSelect(fdevice->io.handle.busdev, dieNumber);
         dieDevice[dieNumber].vTable->eraseCompletely(&dieDevice[dieNumber]);
+        dieErasing[dieNumber] = true;
     }
 }
 
-static uint32_t currentWriteAddress;
 static int currentWriteDie;
 
 void w25m_pageProgramBegin(flashDevice_t *fdevice, uint32_t address)
 {
-    UNUSED(fdevice);
+    const uint32_t dieAddress = w25m_dieAddress(address, &currentWriteDie);
 
-    currentWriteDie = address / dieSize;
     w25m_dieSelect(fdevice->io.handle.busdev, currentWriteDie);
-    currentWriteAddress = address % dieSize;
-    dieDevice[currentWriteDie].vTable->pageProgramBegin(&dieDevice[currentWriteDie], currentWriteAddress);
+    dieDevice[currentWriteDie].vTable->pageProgramBegin(&dieDevice[currentWriteDie], dieAddress);
+    nextWriteAddress = address;
 }
 
 void w25m_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *data, int length)
 {
-    UNUSED(fdevice);
-
+    w25m_dieSelect(fdevice->io.handle.busdev, currentWriteDie);
     dieDevice[currentWriteDie].vTable->pageProgramContinue(&dieDevice[currentWriteDie], data, length);
+    nextWriteAddress += length;
 }
 
 void w25m_pageProgramFinish(flashDevice_t *fdevice)
@@ -201,13 +232,12 @@ int w25m_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer, in
     int tlen; // transfer length for a round
     int rbytes;
 
-    // Divide a read that spans multiple dies into two.
-    // The loop is executed twice at the most for decent 'length'.
+    // Divide the read at page boundaries, as consecutive pages are on different dies
 
     for (rlen = length; rlen; rlen -= tlen) {
-        int dieNumber = address / dieSize;
-        uint32_t dieAddress = address % dieSize;
-        tlen = MIN(dieAddress + rlen, dieSize) - dieAddress;
+        int dieNumber;
+        uint32_t dieAddress = w25m_dieAddress(address, &dieNumber);
+        tlen = MIN(rlen, (int)(diePageSize - address % diePageSize));
 
         w25m_dieSelect(fdevice->io.handle.busdev, dieNumber);
 
@@ -22,6 +22,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -82,6 +83,8 @@ serialPort_t *debugSerialPort = NULL;
 #define W25N01G_INSTRUCTION_BB_MANAGEMENT    0xA1
 #define W25N01G_INSTRUCTION_PROGRAM_DATA_LOAD        0x02
 #define W25N01G_INSTRUCTION_RANDOM_PROGRAM_DATA_LOAD 0x84
+#define W25N01G_INSTRUCTION_QUAD_PROGRAM_DATA_LOAD        0x32
+#define W25N01G_INSTRUCTION_RANDOM_QUAD_PROGRAM_DATA_LOAD 0x34
 #define W25N01G_INSTRUCTION_PROGRAM_EXECUTE  0x10
 #define W25N01G_INSTRUCTION_PAGE_DATA_READ   0x13
 #define W25N01G_INSTRUCTION_READ_DATA        0x03
@@ -146,6 +149,30 @@ typedef struct bblut_s {
 #define ENABLE(busdev)        __NOP(); IOLo((busdev)->busdev_u.spi.csnPin)
 
 static bool w25n01g_waitForReady(flashDevice_t *fdevice);
+void w25n01g_writeBBLUT(flashDevice_t *fdevice, uint16_t lba, uint16_t pba);
+
+/*
+ * Program and erase failures are handled inline as the busy flag clears: the failing block is replaced through the
+ * bad block LUT, the replacement is erased and a failed page program is executed again from the data buffer, which
+ * still holds the page. Earlier pages of a block replaced because of a program failure are lost.
+ */
+typedef enum {
+    W25N01G_OPERATION_NONE = 0,
+    W25N01G_OPERATION_PROGRAM,
+    W25N01G_OPERATION_ERASE,
+    W25N01G_OPERATION_REPLACE_FOR_PROGRAM,
+    W25N01G_OPERATION_REPLACE_FOR_ERASE,
+    W25N01G_OPERATION_ERASE_FOR_PROGRAM,
+} w25n01gOperation_e;
+
+static w25n01gOperation_e pendingOperation = W25N01G_OPERATION_NONE;
+static uint32_t pendingPage;
+
+// The next block of the replacement area to map in place of a bad block, W25N01G_BLOCKS_PER_DIE if none is left
+static uint16_t replacementBlock = W25N01G_BLOCKS_PER_DIE;
+
+// The page held in the data buffer of the device
+static uint32_t currentPage = UINT32_MAX;
 
 static void w25n01g_setTimeout(flashDevice_t *fdevice, uint32_t timeoutMillis)
 {
@@ -272,24 +299,66 @@ static void w25n01g_deviceReset(flashDevice_t *fdevice)
     w25n01g_writeRegister(io, W25N01G_CONF_REG, W25N01G_CONFIG_ECC_ENABLE|W25N01G_CONFIG_BUFFER_READ_MODE);
 }
 
-bool w25n01g_isReady(flashDevice_t *fdevice)
+static void w25n01g_writeEnable(flashDevice_t *fdevice);
+
+/*
+ * Start the next step of replacing the block of pendingPage, or of the operation on it, without waiting.
+ * Returns false if there is nothing left to do.
+ */
+static bool w25n01g_continueOperation(flashDevice_t *fdevice, w25n01gOperation_e operation, uint8_t status)
 {
-    // XXX Study device busy behavior and reinstate couldBeBusy facility.
+    const uint16_t block = pendingPage / W25N01G_PAGES_PER_BLOCK;
 
-#if 0
-    // If couldBeBusy is false, don't bother to poll the flash chip for its status
-    fdevice->couldBeBusy = fdevice->couldBeBusy && ((w25n01g_readRegister(fdevice->handle.busdev, W25N01G_STAT_REG) & W25N01G_STATUS_FLAG_BUSY) != 0);
+    switch (operation) {
+    case W25N01G_OPERATION_PROGRAM:
+    case W25N01G_OPERATION_ERASE:
+        if (!(status & (W25N01G_STATUS_PROGRAM_FAIL | W25N01G_STATUS_ERASE_FAIL))) {
+            return false;
+        }
 
-    return !couldBeBusy;
-#else
-    uint8_t status = w25n01g_readRegister(&fdevice->io, W25N01G_STAT_REG);
+        DPRINTF(("*** %s FAIL block %d\r\n", operation == W25N01G_OPERATION_PROGRAM ? "PROGRAM" : "ERASE", block));
+        if (replacementBlock >= W25N01G_BLOCKS_PER_DIE || (status & W25N01G_STATUS_BBM_LUT_FULL)) {
+            // Out of replacement blocks, the data is lost
+            return false;
+        }
+
+        w25n01g_writeBBLUT(fdevice, block, replacementBlock);
+
+        // Checking the next replacement for a factory bad block marker would overwrite the data buffer, so it's
+        // left for the next boot
+        replacementBlock = W25N01G_BLOCKS_PER_DIE;
+        pendingOperation = (operation == W25N01G_OPERATION_PROGRAM) ? W25N01G_OPERATION_REPLACE_FOR_PROGRAM : W25N01G_OPERATION_REPLACE_FOR_ERASE;
+        break;
 
-    if (status & W25N01G_STATUS_PROGRAM_FAIL) {
-        DPRINTF(("*** PROGRAM_FAIL\r\n"));
+    case W25N01G_OPERATION_REPLACE_FOR_PROGRAM:
+    case W25N01G_OPERATION_REPLACE_FOR_ERASE:
+        // The block now maps to the replacement, which has to be erased before use
+        w25n01g_writeEnable(fdevice);
+        w25n01g_performCommandWithPageAddress(&fdevice->io, W25N01G_INSTRUCTION_BLOCK_ERASE, W25N01G_BLOCK_TO_PAGE(block));
+        w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_BLOCK_ERASE_MS);
+        pendingOperation = (operation == W25N01G_OPERATION_REPLACE_FOR_PROGRAM) ? W25N01G_OPERATION_ERASE_FOR_PROGRAM : W25N01G_OPERATION_ERASE;
+        break;
+
+    case W25N01G_OPERATION_ERASE_FOR_PROGRAM:
+        w25n01g_writeEnable(fdevice);
+        w25n01g_performCommandWithPageAddress(&fdevice->io, W25N01G_INSTRUCTION_PROGRAM_EXECUTE, pendingPage);
+        w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
+        pendingOperation = W25N01G_OPERATION_PROGRAM;
+        break;
+
+    default:
+        return false;
     }
 
-    if (status & W25N01G_STATUS_ERASE_FAIL) {
-        DPRINTF(("*** ERASE_FAIL\r\n"));
+    return true;
+}
+
+bool w25n01g_isReady(flashDevice_t *fdevice)
+{
+    uint8_t status = w25n01g_readRegister(&fdevice->io, W25N01G_STAT_REG);
+
+    if (status & W25N01G_STATUS_FLAG_BUSY) {
+        return false;
     }
 
     uint8_t eccCode;
@@ -297,8 +366,11 @@ bool w25n01g_isReady(flashDevice_t *fdevice)
         DPRINTF(("*** ECC %x\r\n", eccCode));
     }
 
-    return ((status & W25N01G_STATUS_FLAG_BUSY) == 0);
-#endif
+    const w25n01gOperation_e operation = pendingOperation;
+    pendingOperation = W25N01G_OPERATION_NONE;
+
+    // Each step of a block replacement keeps the device busy
+    return !w25n01g_continueOperation(fdevice, operation, status);
 }
 
 static bool w25n01g_waitForReady(flashDevice_t *fdevice)
@@ -436,6 +508,9 @@ void w25n01g_eraseSector(flashDevice_t *fdevice, uint32_t address)
     w25n01g_performCommandWithPageAddress(&fdevice->io, W25N01G_INSTRUCTION_BLOCK_ERASE, W25N01G_LINEAR_TO_PAGE(address));
 
     w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_BLOCK_ERASE_MS);
+
+    pendingOperation = W25N01G_OPERATION_ERASE;
+    pendingPage = W25N01G_LINEAR_TO_PAGE(address);
 }
 
 //
@@ -451,12 +526,7 @@ void w25n01g_eraseCompletely(flashDevice_t *fdevice)
 
 static void w25n01g_programDataLoad(flashDevice_t *fdevice, uint16_t columnAddress, const uint8_t *data, int length)
 {
-
-    //DPRINTF(("    load WaitForReady\r\n"));
-    w25n01g_waitForReady(fdevice);
-
-    //DPRINTF(("    load Issuing command\r\n"));
-
+    // The caller has waited for the device, loading the data buffer doesn't make it busy
     if (fdevice->io.mode == FLASHIO_SPI) {
         busDevice_t *busdev = fdevice->io.handle.busdev;
         const uint8_t cmd[] = { W25N01G_INSTRUCTION_PROGRAM_DATA_LOAD, columnAddress >> 8, columnAddress & 0xff };
@@ -470,22 +540,17 @@ static void w25n01g_programDataLoad(flashDevice_t *fdevice, uint16_t columnAddre
    else if (fdevice->io.mode == FLASHIO_QUADSPI) {
        QUADSPI_TypeDef *quadSpi = fdevice->io.handle.quadSpi;
 
-       quadSpiTransmitWithAddress1LINE(quadSpi, W25N01G_INSTRUCTION_PROGRAM_DATA_LOAD, 0, columnAddress, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, data, length);
+       quadSpiTransmitWithAddress4LINES(quadSpi, W25N01G_INSTRUCTION_QUAD_PROGRAM_DATA_LOAD, 0, columnAddress, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, data, length);
     }
 #endif
     //DPRINTF(("    load Done\r\n"));
-
-    w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
 }
 
 static void w25n01g_randomProgramDataLoad(flashDevice_t *fdevice, uint16_t columnAddress, const uint8_t *data, int length)
 {
     const uint8_t cmd[] = { W25N01G_INSTRUCTION_RANDOM_PROGRAM_DATA_LOAD, columnAddress >> 8, columnAddress & 0xff };
 
-    //DPRINTF(("    random WaitForReady\r\n"));
-    w25n01g_waitForReady(fdevice);
-
-    //DPRINTF(("    random Issuing command\r\n"));
+    // The caller has waited for the device, loading the data buffer doesn't make it busy
     if (fdevice->io.mode == FLASHIO_SPI) {
         busDevice_t *busdev = fdevice->io.handle.busdev;
 
@@ -499,14 +564,11 @@ static void w25n01g_randomProgramDataLoad(flashDevice_t *fdevice, uint16_t colum
     else if (fdevice->io.mode == FLASHIO_QUADSPI) {
         QUADSPI_TypeDef *quadSpi = fdevice->io.handle.quadSpi;
 
-        quadSpiTransmitWithAddress1LINE(quadSpi, W25N01G_INSTRUCTION_RANDOM_PROGRAM_DATA_LOAD, 0, columnAddress, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, data, length);
+        quadSpiTransmitWithAddress4LINES(quadSpi, W25N01G_INSTRUCTION_RANDOM_QUAD_PROGRAM_DATA_LOAD, 0, columnAddress, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, data, length);
      }
 #endif
 
     //DPRINTF(("    random Done\r\n"));
-
-    w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
-
 }
 
 static void w25n01g_programExecute(flashDevice_t *fdevice, uint32_t pageAddress)
@@ -520,6 +582,9 @@ static void w25n01g_programExecute(flashDevice_t *fdevice, uint32_t pageAddress)
 
     //DPRINTF(("    execute Done\r\n"));
     w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
+
+    pendingOperation = W25N01G_OPERATION_PROGRAM;
+    pendingPage = pageAddress;
 }
 
 //
@@ -623,12 +688,13 @@ void w25n01g_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *data, in
 
     // XXX Test if write enable is reset after each data loading.
 
+    // The data buffer no longer holds a page read from the array
+    currentPage = UINT32_MAX;
+
     bufferDirty = true;
     programLoadAddress += length;
 }
 
-static uint32_t currentPage = UINT32_MAX;
-
 void w25n01g_pageProgramFinish(flashDevice_t *fdevice)
 {
     PAGEPROG_DPRINTF(("pageProgramFinish: (loaded 0x%x bytes)\r\n", programLoadAddress - programStartAddress));
@@ -713,22 +779,31 @@ void w25n01g_addError(uint32_t address, uint8_t code)
 // (2) "Read Data" command is executed for bytes not requested and data are discarded
 // (3) "Read Data" command is executed and data are stored directly into caller's buffer
 //
-// Buffered read mode (BUF = 1), non-read ahead
+// Buffered read mode (BUF = 1), with read ahead
 // (1) If currentBufferPage != requested page, then issue PAGE_DATA_READ on requested page.
 // (2) Compute transferLength as smaller of remaining length and requested length.
 // (3) Issue READ_DATA on column address.
-// (4) Return transferLength.
+// (4) Repeat for the following pages until the requested length is read.
+// (5) If the read ended on a page boundary, issue PAGE_DATA_READ on the next page without waiting.
+//
+// Continuous read mode would stream pages within a single READ_DATA, but it can't address a column and the
+// caller's reads end with the transfer, so the read ahead overlaps the page load with the caller instead.
 
 //#define READBYTES_DPRINTF DPRINTF
 #define READBYTES_DPRINTF(x)
 
-int w25n01g_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer, int length)
+static int w25n01g_readPageBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer, int length)
 {
     READBYTES_DPRINTF(("readBytes: address 0x%x length %d\r\n", address, length));
 
     uint32_t targetPage = W25N01G_LINEAR_TO_PAGE(address);
 
-    if (currentPage != targetPage) {
+    if (currentPage == targetPage) {
+        // The page may still be loading from a read ahead
+        if (!w25n01g_waitForReady(fdevice)) {
+            return 0;
+        }
+    } else {
         READBYTES_DPRINTF(("readBytes: PAGE_DATA_READ page 0x%x\r\n", targetPage));
 
 
@@ -770,7 +845,7 @@ int w25n01g_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer,
 
         ENABLE(busdev);
         spiTransfer(busdev->busdev_u.spi.instance, cmd, NULL, sizeof(cmd));
-        spiTransfer(busdev->busdev_u.spi.instance, NULL, buffer, length);
+        spiTransfer(busdev->busdev_u.spi.instance, NULL, buffer, transferLength);
         DISABLE(busdev);
 
     }
@@ -778,8 +853,14 @@ int w25n01g_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer,
     else if (fdevice->io.mode == FLASHIO_QUADSPI) {
         QUADSPI_TypeDef *quadSpi = fdevice->io.handle.quadSpi;
 
-        //quadSpiReceiveWithAddress1LINE(quadSpi, W25N01G_INSTRUCTION_READ_DATA, 8, column, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, buffer, length);
-        quadSpiReceiveWithAddress4LINES(quadSpi, W25N01G_INSTRUCTION_FAST_READ_QUAD_OUTPUT, 8, column, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, buffer, length);
+        // The page buffer is mapped with the column as the address, copying from the window lets the
+        // controller prefetch instead of the core draining the FIFO a word at a time
+        if (quadSpiEnableMemoryMapped4LINES(quadSpi, W25N01G_INSTRUCTION_FAST_READ_QUAD_OUTPUT, 8, W28N01G_STATUS_COLUMN_ADDRESS_SIZE)) {
+            memcpy(buffer, quadSpiMemoryMappedWindow(quadSpi) + column, transferLength);
+        } else {
+            //quadSpiReceiveWithAddress1LINE(quadSpi, W25N01G_INSTRUCTION_READ_DATA, 8, column, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, buffer, transferLength);
+            quadSpiReceiveWithAddress4LINES(quadSpi, W25N01G_INSTRUCTION_FAST_READ_QUAD_OUTPUT, 8, column, W28N01G_STATUS_COLUMN_ADDRESS_SIZE, buffer, transferLength);
+        }
     }
 #endif
 
@@ -802,6 +883,7 @@ int w25n01g_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer,
     case 3: // Uncorrectable ECC in multiple pages
         w25n01g_addError(address, eccCode);
         w25n01g_deviceReset(fdevice);
+        currentPage = UINT32_MAX;
         break;
     }
 
@@ -810,6 +892,35 @@ int w25n01g_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer,
     return transferLength;
 }
 
+int w25n01g_readBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer, int length)
+{
+    int bytesRead = 0;
+
+    while (bytesRead < length) {
+        const int transferLength = w25n01g_readPageBytes(fdevice, address + bytesRead, buffer + bytesRead, length - bytesRead);
+
+        if (!transferLength) {
+            return bytesRead;
+        }
+
+        bytesRead += transferLength;
+    }
+
+    // Downloads read sequentially, so load the next page while the caller handles this one. Not if the data buffer
+    // holds data waiting to be programmed.
+    const uint32_t nextAddress = address + bytesRead;
+    const uint32_t nextPage = W25N01G_LINEAR_TO_PAGE(nextAddress);
+    if (bytesRead > 0 && W25N01G_LINEAR_TO_COLUMN(nextAddress) == 0 && !bufferDirty && nextAddress < fdevice->geometry.totalSize) {
+        READBYTES_DPRINTF(("readBytes: read ahead PAGE_DATA_READ page 0x%x\r\n", nextPage));
+
+        w25n01g_performCommandWithPageAddress(&fdevice->io, W25N01G_INSTRUCTION_PAGE_DATA_READ, nextPage);
+        w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_READ_MS);
+        currentPage = nextPage;
+    }
+
+    return bytesRead;
+}
+
 int w25n01g_readExtensionBytes(flashDevice_t *fdevice, uint32_t address, uint8_t *buffer, int length)
 {
 
@@ -819,6 +930,13 @@ int w25n01g_readExtensionBytes(flashDevice_t *fdevice, uint32_t address, uint8_t
 
     w25n01g_performCommandWithPageAddress(&fdevice->io, W25N01G_INSTRUCTION_PAGE_DATA_READ, W25N01G_LINEAR_TO_PAGE(address));
 
+    w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_READ_MS);
+    if (!w25n01g_waitForReady(fdevice)) {
+        return 0;
+    }
+
+    currentPage = W25N01G_LINEAR_TO_PAGE(address);
+
     uint32_t column = 2048;
 
     if (fdevice->io.mode == FLASHIO_SPI) {
@@ -892,8 +1010,8 @@ void w25n01g_readBBLUT(flashDevice_t *fdevice, bblut_t *bblut, int lutsize)
 
         for (int i = 0 ; i < lutsize ; i++) {
             spiTransfer(busdev->busdev_u.spi.instance, NULL, in, 4);
-            bblut[i].pba = (in[0] << 16)|in[1];
-            bblut[i].lba = (in[2] << 16)|in[3];
+            bblut[i].pba = (in[0] << 8)|in[1];
+            bblut[i].lba = (in[2] << 8)|in[3];
         }
 
         DISABLE(busdev);
@@ -910,8 +1028,8 @@ void w25n01g_readBBLUT(flashDevice_t *fdevice, bblut_t *bblut, int lutsize)
 
         for (int i = 0, offset = 0 ; i < lutsize ; i++, offset += 4) {
             if (i < W25N01G_BBLUT_TABLE_ENTRY_COUNT) {
-                bblut[i].pba = (in[offset + 0] << 16)|in[offset + 1];
-                bblut[i].lba = (in[offset + 2] << 16)|in[offset + 3];
+                bblut[i].pba = (bblutBuffer[offset + 0] << 8)|bblutBuffer[offset + 1];
+                bblut[i].lba = (bblutBuffer[offset + 2] << 8)|bblutBuffer[offset + 3];
             }
         }
     }
@@ -922,6 +1040,8 @@ void w25n01g_writeBBLUT(flashDevice_t *fdevice, uint16_t lba, uint16_t pba)
 {
     w25n01g_waitForReady(fdevice);
 
+    w25n01g_writeEnable(fdevice);
+
     if (fdevice->io.mode == FLASHIO_SPI) {
         busDevice_t *busdev = fdevice->io.handle.busdev;
 
@@ -943,8 +1063,34 @@ void w25n01g_writeBBLUT(flashDevice_t *fdevice, uint16_t lba, uint16_t pba)
     w25n01g_setTimeout(fdevice, W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
 }
 
+/**
+ * A block marked bad at the factory has a non 0xff first byte in the spare area of its first page.
+ */
+static bool w25n01g_isBlockGood(flashDevice_t *fdevice, uint16_t block)
+{
+    uint8_t marker;
+
+    return w25n01g_readExtensionBytes(fdevice, W25N01G_BLOCK_TO_LINEAR(block), &marker, 1) == 1 && marker == 0xff;
+}
+
 static void w25n01g_deviceInit(flashDevice_t *flashdev)
 {
-    UNUSED(flashdev);
+    bblut_t bblut[W25N01G_BBLUT_TABLE_ENTRY_COUNT];
+
+    w25n01g_readBBLUT(flashdev, bblut, W25N01G_BBLUT_TABLE_ENTRY_COUNT);
+
+    // Replacement blocks are used in order, so continue after the last one mapped
+    uint16_t block = W25N01G_BB_REPLACEMENT_START_BLOCK;
+    for (int i = 0; i < W25N01G_BBLUT_TABLE_ENTRY_COUNT; i++) {
+        if ((bblut[i].lba & W25N01G_BBLUT_STATUS_ENABLED) && bblut[i].pba >= block) {
+            block = bblut[i].pba + 1;
+        }
+    }
+
+    while (block < W25N01G_BLOCKS_PER_DIE && !w25n01g_isBlockGood(flashdev, block)) {
+        block++;
+    }
+
+    replacementBlock = block;
 }
 #endif
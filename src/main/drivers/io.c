@@ -232,6 +232,47 @@ void IOLo(IO_t io)
 #endif
 }
 
+void IOGroupInit(ioGroup_t *group)
+{
+    group->portCount = 0;
+}
+
+// An inverted pin is driven low for the group's logical high. Fails when the
+// pin is on a port beyond the first IO_GROUP_MAX_PORTS of the group.
+bool IOGroupAdd(ioGroup_t *group, IO_t io, bool inverted)
+{
+    if (!io) {
+        return false;
+    }
+
+#if defined(STM32F4) && !defined(USE_HAL_DRIVER) && !defined(USE_FULL_LL_DRIVER)
+    volatile uint32_t *bsrr = (volatile uint32_t *)&IO_GPIO(io)->BSRRL;
+#else
+    volatile uint32_t *bsrr = &IO_GPIO(io)->BSRR;
+#endif
+    const uint32_t set = IO_Pin(io);
+    const uint32_t reset = set << 16;
+
+    unsigned i = 0;
+    while (i < group->portCount && group->port[i].bsrr != bsrr) {
+        i++;
+    }
+    if (i == group->portCount) {
+        if (i == IO_GROUP_MAX_PORTS) {
+            return false;
+        }
+        group->port[i].bsrr = bsrr;
+        group->port[i].setHi = 0;
+        group->port[i].setLo = 0;
+        group->portCount++;
+    }
+
+    group->port[i].setHi |= inverted ? reset : set;
+    group->port[i].setLo |= inverted ? set : reset;
+
+    return true;
+}
+
 void IOToggle(IO_t io)
 {
     if (!io) {
@@ -115,6 +115,31 @@ void IOHi(IO_t io);
 void IOLo(IO_t io);
 void IOToggle(IO_t io);
 
+// A set of output pins resolved once into per-port BSRR masks, so a bitbanged
+// protocol drives all of them with one register write per port and bit
+#define IO_GROUP_MAX_PORTS 4
+
+typedef struct ioGroupPort_s {
+    volatile uint32_t *bsrr;
+    uint32_t setHi;                 // BSRR value driving the group's logical high
+    uint32_t setLo;                 // BSRR value driving the group's logical low
+} ioGroupPort_t;
+
+typedef struct ioGroup_s {
+    uint8_t portCount;
+    ioGroupPort_t port[IO_GROUP_MAX_PORTS];
+} ioGroup_t;
+
+void IOGroupInit(ioGroup_t *group);
+bool IOGroupAdd(ioGroup_t *group, IO_t io, bool inverted);
+
+static inline void IOGroupWrite(const ioGroup_t *group, bool hi)
+{
+    for (unsigned i = 0; i < group->portCount; i++) {
+        *group->port[i].bsrr = hi ? group->port[i].setHi : group->port[i].setLo;
+    }
+}
+
 void IOInit(IO_t io, resourceOwner_e owner, uint8_t index);
 void IORelease(IO_t io);  // unimplemented
 resourceOwner_e IOGetOwner(IO_t io);
@@ -0,0 +1,128 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_IRQ_LOAD
+
+#include "build/trace.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/system.h"
+
+#include "irq_load.h"
+
+#define IRQ_LOAD_MAX_NESTING 8
+
+typedef struct irqLoadFrame_s {
+    uint32_t startCycles;
+    uint32_t nestedCycles;      // spent in interrupts that preempted this one
+} irqLoadFrame_t;
+
+static const char * const sourceNames[IRQ_LOAD_COUNT] = {
+    [IRQ_LOAD_EXTI] = "EXTI",
+    [IRQ_LOAD_DMA] = "DMA",
+    [IRQ_LOAD_DSHOT_BITBANG] = "DSHOT_BB",
+    [IRQ_LOAD_MAX7456_DMA] = "MAX7456",
+    [IRQ_LOAD_UART] = "UART",
+    [IRQ_LOAD_TIMER] = "TIMER",
+    [IRQ_LOAD_PID_LOOP] = "PID_LOOP",
+};
+
+static FAST_RAM_ZERO_INIT irqLoadFrame_t frames[IRQ_LOAD_MAX_NESTING];
+static FAST_RAM_ZERO_INIT volatile uint8_t nesting;
+static FAST_RAM_ZERO_INIT volatile uint32_t sourceCycles[IRQ_LOAD_COUNT];
+static FAST_RAM_ZERO_INIT volatile uint32_t totalCycles;
+
+static uint32_t lastSourceCycles[IRQ_LOAD_COUNT];
+static uint32_t lastUpdateCycles;
+static uint16_t sourcePermille[IRQ_LOAD_COUNT];
+
+// Interrupts nest strictly, a preempting handler exits before the one it
+// preempted resumes, so the frames form a stack indexed by the nesting level.
+FAST_CODE void irqLoadEnter(irqLoadSource_e source)
+{
+    UNUSED(source);
+    TRACE_EVENT(TRACE_ISR_ENTER, source, 0);
+
+    const uint8_t level = nesting++;
+    if (level < IRQ_LOAD_MAX_NESTING) {
+        frames[level].nestedCycles = 0;
+        frames[level].startCycles = getCycleCounter();
+    }
+}
+
+// Each handler is charged its own cycles only, the time of the handlers that
+// preempted it is charged to them. totalCycles grows as each handler exits, so
+// a task sees every interrupt taken while it ran, also those nested in the PID loop.
+FAST_CODE void irqLoadExit(irqLoadSource_e source)
+{
+    const uint8_t level = --nesting;
+    if (level < IRQ_LOAD_MAX_NESTING) {
+        const uint32_t elapsedCycles = getCycleCounter() - frames[level].startCycles;
+        // A handler preempting this one between the two stores in irqLoadEnter() may be counted before the start
+        const uint32_t ownCycles = elapsedCycles - MIN(frames[level].nestedCycles, elapsedCycles);
+        sourceCycles[source] += ownCycles;
+        totalCycles += ownCycles;
+        if (level > 0) {
+            frames[level - 1].nestedCycles += elapsedCycles;
+        }
+    }
+
+    TRACE_EVENT(TRACE_ISR_EXIT, source, 0);
+}
+
+uint32_t irqLoadGetTotalCycles(void)
+{
+    return totalCycles;
+}
+
+// Called from the system load task, the load of each source over the time since the last call
+void irqLoadUpdate(void)
+{
+    const uint32_t nowCycles = getCycleCounter();
+    const uint32_t intervalCycles = nowCycles - lastUpdateCycles;
+    lastUpdateCycles = nowCycles;
+
+    for (int i = 0; i < IRQ_LOAD_COUNT; i++) {
+        const uint32_t cycles = sourceCycles[i];
+        const uint32_t deltaCycles = cycles - lastSourceCycles[i];
+        lastSourceCycles[i] = cycles;
+        const uint32_t permille = intervalCycles ? (uint64_t)deltaCycles * 1000 / intervalCycles : 0;
+        sourcePermille[i] = MIN(permille, 1000u);
+    }
+}
+
+uint16_t irqLoadGetPermille(irqLoadSource_e source)
+{
+    return source < IRQ_LOAD_COUNT ? sourcePermille[source] : 0;
+}
+
+const char *irqLoadSourceName(irqLoadSource_e source)
+{
+    return source < IRQ_LOAD_COUNT ? sourceNames[source] : "";
+}
+
+#endif // USE_IRQ_LOAD
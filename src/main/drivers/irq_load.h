@@ -0,0 +1,56 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Cycle accounting of the main interrupt handlers, so that interrupt time is
+// shown as interrupt load instead of being charged to whichever task was
+// interrupted. Not part of any default build, enable with
+// EXTRA_FLAGS=-DUSE_IRQ_LOAD. USE_TRACE enables it as well, the same hooks
+// record the interrupt enter and exit trace events.
+
+typedef enum {
+    IRQ_LOAD_EXTI = 0,          // gyro data ready and other external interrupts
+    IRQ_LOAD_DMA,               // DMA not listed below, including the gyro and dshot DMA
+    IRQ_LOAD_DSHOT_BITBANG,
+    IRQ_LOAD_MAX7456_DMA,
+    IRQ_LOAD_UART,
+    IRQ_LOAD_TIMER,
+    IRQ_LOAD_PID_LOOP,          // the PID loop run from PendSV, also listed as the GYROPID task
+    IRQ_LOAD_COUNT
+} irqLoadSource_e;
+
+#ifdef USE_IRQ_LOAD
+void irqLoadEnter(irqLoadSource_e source);
+void irqLoadExit(irqLoadSource_e source);
+uint32_t irqLoadGetTotalCycles(void);
+void irqLoadUpdate(void);
+uint16_t irqLoadGetPermille(irqLoadSource_e source);
+const char *irqLoadSourceName(irqLoadSource_e source);
+
+#define IRQ_LOAD_ENTER(source) irqLoadEnter(source)
+#define IRQ_LOAD_EXIT(source) irqLoadExit(source)
+#else
+#define irqLoadGetTotalCycles() 0
+#define IRQ_LOAD_ENTER(source) do {} while (0)
+#define IRQ_LOAD_EXIT(source) do {} while (0)
+#endif
@@ -59,11 +59,14 @@ static bool ws2811Initialised = false;
 volatile bool ws2811LedDataTransferInProgress = false;
 static unsigned usedLedCount = 0;
 static bool needsFullRefresh = true;
+static ledStripFormatRGB_e lastLedFormat;
 
 uint16_t BIT_COMPARE_1 = 0;
 uint16_t BIT_COMPARE_0 = 0;
 
 static hsvColor_t ledColorBuffer[WS2811_DATA_BUFFER_SIZE];
+// Colours the DMA buffer currently holds, LEDs that still match are not converted again
+static hsvColor_t ledColorSent[WS2811_DATA_BUFFER_SIZE];
 
 #if !defined(USE_WS2811_SINGLE_COLOUR)
 void setLedHsv(uint16_t index, const hsvColor_t *color)
@@ -138,6 +141,46 @@ bool isWS2811LedStripReady(void)
     return ws2811Initialised && !ws2811LedDataTransferInProgress;
 }
 
+#if defined(USE_WS2811_HALF_BUFFER)
+// LED colours as they go out on the wire, the DMA buffer only holds the bits of two of them
+static uint8_t ledStripWireData[WS2811_DATA_BUFFER_SIZE][3];
+static unsigned ledStripHalvesSent;
+
+static void fillDMABufferHalf(unsigned half, unsigned ledIndex)
+{
+    unsigned dmaBufferOffset = half * WS2811_BITS_PER_LED;
+    if (ledIndex < WS2811_DATA_BUFFER_SIZE) {
+        for (unsigned byteIndex = 0; byteIndex < 3; byteIndex++) {
+            const uint8_t byte = ledStripWireData[ledIndex][byteIndex];
+            for (int index = 7; index >= 0; index--) {
+                ledStripDMABuffer[dmaBufferOffset++] = (byte & (1 << index)) ? BIT_COMPARE_1 : BIT_COMPARE_0;
+            }
+        }
+    } else {
+        for (unsigned bit = 0; bit < WS2811_BITS_PER_LED; bit++) {
+            ledStripDMABuffer[dmaBufferOffset++] = 0;
+        }
+    }
+}
+
+/*
+ * Called from the DMA interrupt once a half of the buffer has been sent.
+ * Returns true when the strip and the delay after it have been sent and the transfer has to be stopped.
+ */
+bool ws2811LedStripRefillHalf(unsigned half)
+{
+    ledStripHalvesSent++;
+    if (ledStripHalvesSent >= WS2811_DATA_BUFFER_SIZE + WS2811_DELAY_ITERATIONS) {
+        return true;
+    }
+
+    // The other half is being sent, this one takes the LED after it
+    fillDMABufferHalf(half, ledStripHalvesSent + 1);
+
+    return false;
+}
+#endif
+
 STATIC_UNIT_TESTED void updateLEDDMABuffer(ledStripFormatRGB_e ledFormat, rgbColor24bpp_t *color, unsigned ledIndex)
 {
 
@@ -154,10 +197,16 @@ STATIC_UNIT_TESTED void updateLEDDMABuffer(ledStripFormatRGB_e ledFormat, rgbCol
         break;
     }
 
+#if defined(USE_WS2811_HALF_BUFFER)
+    ledStripWireData[ledIndex][0] = packed_colour >> 16;
+    ledStripWireData[ledIndex][1] = packed_colour >> 8;
+    ledStripWireData[ledIndex][2] = packed_colour;
+#else
     unsigned dmaBufferOffset = 0;
     for (int index = 23; index >= 0; index--) {
         ledStripDMABuffer[ledIndex * WS2811_BITS_PER_LED + dmaBufferOffset++] = (packed_colour & (1 << index)) ? BIT_COMPARE_1 : BIT_COMPARE_0;
     }
+#endif
 }
 
 /*
@@ -171,18 +220,30 @@ void ws2811UpdateStrip(ledStripFormatRGB_e ledFormat)
         return;
     }
 
-    unsigned ledIndex = 0;              // reset led index
-
     // fill transmit buffer with correct compare values to achieve
-    // correct pulse widths according to color values
-    const unsigned ledUpdateCount = needsFullRefresh ? WS2811_DATA_BUFFER_SIZE : usedLedCount;
+    // correct pulse widths according to color values, the DMA buffer keeps
+    // the bits of the LEDs that did not change since the last update
+    const bool fullRefresh = needsFullRefresh || ledFormat != lastLedFormat;
+    const unsigned ledUpdateCount = fullRefresh ? WS2811_DATA_BUFFER_SIZE : usedLedCount;
     const hsvColor_t hsvBlack = { 0, 0, 0 };
-    while (ledIndex < ledUpdateCount) {
-        rgbColor24bpp_t *rgb24 = hsvToRgb24(ledIndex < usedLedCount ? &ledColorBuffer[ledIndex] : &hsvBlack);
+    for (unsigned ledIndex = 0; ledIndex < ledUpdateCount; ledIndex++) {
+        const hsvColor_t *hsv = ledIndex < usedLedCount ? &ledColorBuffer[ledIndex] : &hsvBlack;
+        hsvColor_t *sent = &ledColorSent[ledIndex];
+        if (!fullRefresh && hsv->h == sent->h && hsv->s == sent->s && hsv->v == sent->v) {
+            continue;
+        }
+        *sent = *hsv;
 
-        updateLEDDMABuffer(ledFormat, rgb24, ledIndex++);
+        updateLEDDMABuffer(ledFormat, hsvToRgb24(hsv), ledIndex);
     }
     needsFullRefresh = false;
+    lastLedFormat = ledFormat;
+
+#if defined(USE_WS2811_HALF_BUFFER)
+    fillDMABufferHalf(0, 0);
+    fillDMABufferHalf(1, 1);
+    ledStripHalvesSent = 0;
+#endif
 
     ws2811LedDataTransferInProgress = true;
     ws2811LedStripDMAEnable();
@@ -33,6 +33,12 @@
 #define WS2811_DMA_BUFFER_SIZE     (WS2811_DATA_BUFFER_SIZE * WS2811_BITS_PER_LED)
 // Do 2 extra iterations of the DMA transfer with the ouptut set to low to generate the > 50us delay.
 #define WS2811_DELAY_ITERATIONS    2
+#elif defined(USE_WS2811_HALF_BUFFER)
+#define WS2811_DATA_BUFFER_SIZE    WS2811_LED_STRIP_LENGTH
+// The circular DMA buffer holds two LEDs, each half is refilled with the next LED once it has been sent
+#define WS2811_DMA_BUFFER_SIZE     (2 * WS2811_BITS_PER_LED)
+// Halves of low output after the last LED for the > 50us delay
+#define WS2811_DELAY_ITERATIONS    2
 #else
 #define WS2811_DATA_BUFFER_SIZE    WS2811_LED_STRIP_LENGTH
 // for 50us delay
@@ -71,6 +77,10 @@ void setUsedLedCount(unsigned ledCount);
 
 bool isWS2811LedStripReady(void);
 
+#if defined(USE_WS2811_HALF_BUFFER)
+bool ws2811LedStripRefillHalf(unsigned half);
+#endif
+
 #if defined(STM32F1) || defined(STM32F3)
 extern uint8_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
 #else
@@ -26,6 +26,7 @@
 #ifdef USE_LED_STRIP
 
 #include "common/color.h"
+#include "common/utils.h"
 
 #include "drivers/dma.h"
 #include "drivers/dma_reqmap.h"
@@ -42,9 +43,27 @@ static IO_t ws2811IO = IO_NONE;
 static TIM_HandleTypeDef TimHandle;
 static uint16_t timerChannel = 0;
 
+#if defined(USE_WS2811_HALF_BUFFER)
+static void WS2811_DMA_HalfCpltCallback(DMA_HandleTypeDef *hdma)
+{
+    UNUSED(hdma);
+}
+#endif
+
 void WS2811_DMA_IRQHandler(dmaChannelDescriptor_t* descriptor)
 {
+#if defined(USE_WS2811_HALF_BUFFER)
+    // The transfer runs circular, each half is refilled with the next LED while the other one is being sent
+    const unsigned sentHalf = DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF) ? 0 : 1;
     HAL_DMA_IRQHandler(TimHandle.hdma[descriptor->userParam]);
+    if (!ws2811LedStripRefillHalf(sentHalf)) {
+        return;
+    }
+    HAL_DMA_Abort(TimHandle.hdma[descriptor->userParam]);
+    TimHandle.State = HAL_TIM_STATE_READY;
+#else
+    HAL_DMA_IRQHandler(TimHandle.hdma[descriptor->userParam]);
+#endif
     TIM_DMACmd(&TimHandle, timerChannel, DISABLE);
     ws2811LedDataTransferInProgress = false;
 }
@@ -121,7 +140,13 @@ bool ws2811LedStripHardwareInit(ioTag_t ioTag)
     hdma_tim.Init.MemInc = DMA_MINC_ENABLE;
     hdma_tim.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
     hdma_tim.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+#if defined(USE_WS2811_HALF_BUFFER)
+    hdma_tim.Init.Mode = DMA_CIRCULAR;
+    // The half transfer interrupt is only enabled when there is a callback for it
+    hdma_tim.XferHalfCpltCallback = WS2811_DMA_HalfCpltCallback;
+#else
     hdma_tim.Init.Mode = DMA_NORMAL;
+#endif
     hdma_tim.Init.Priority = DMA_PRIORITY_HIGH;
     hdma_tim.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     hdma_tim.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
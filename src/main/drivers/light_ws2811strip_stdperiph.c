@@ -49,6 +49,22 @@ static TIM_TypeDef *timer = NULL;
 
 static void WS2811_DMA_IRQHandler(dmaChannelDescriptor_t *descriptor)
 {
+#if defined(USE_WS2811_HALF_BUFFER)
+    // The transfer runs circular, each half is refilled with the next LED while the other one is being sent
+    bool done = false;
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+        done = ws2811LedStripRefillHalf(0);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+        done = done || ws2811LedStripRefillHalf(1);
+    }
+    if (done) {
+        ws2811LedDataTransferInProgress = false;
+        xDMA_Cmd(descriptor->ref, DISABLE);
+    }
+#else
 #if defined(USE_WS2811_SINGLE_COLOUR)
     static uint32_t counter = 0;
 #endif
@@ -71,6 +87,7 @@ static void WS2811_DMA_IRQHandler(dmaChannelDescriptor_t *descriptor)
 
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
     }
+#endif
 }
 
 bool ws2811LedStripHardwareInit(ioTag_t ioTag)
@@ -201,7 +218,7 @@ bool ws2811LedStripHardwareInit(ioTag_t ioTag)
     DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
 #endif
 
-#if defined(USE_WS2811_SINGLE_COLOUR)
+#if defined(USE_WS2811_SINGLE_COLOUR) || defined(USE_WS2811_HALF_BUFFER)
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
 #else
     DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
@@ -209,7 +226,11 @@ bool ws2811LedStripHardwareInit(ioTag_t ioTag)
 
     xDMA_Init(dmaRef, &DMA_InitStructure);
     TIM_DMACmd(timer, timerDmaSource(timerHardware->channel), ENABLE);
+#if defined(USE_WS2811_HALF_BUFFER)
+    xDMA_ITConfig(dmaRef, DMA_IT_HT | DMA_IT_TC, ENABLE);
+#else
     xDMA_ITConfig(dmaRef, DMA_IT_TC, ENABLE);
+#endif
 
     return true;
 }
@@ -28,12 +28,15 @@
 
 #include "build/debug.h"
 
+#include "common/maths.h"
+
 #include "pg/max7456.h"
 #include "pg/vcd.h"
 
 #include "drivers/bus_spi.h"
 #include "drivers/dma.h"
 #include "drivers/io.h"
+#include "drivers/irq_load.h"
 #include "drivers/light_led.h"
 #include "drivers/max7456.h"
 #include "drivers/max7456_symbols.h"
@@ -171,12 +174,13 @@
 #define CHARS_PER_LINE      30 // XXX Should be related to VIDEO_BUFFER_CHARS_*?
 
 // On shared SPI bus we want to change clock for OSD chip and restore for other devices.
+// The chip select is driven directly, so wait for the sequences queued on the bus first.
 
 #ifdef USE_SPI_TRANSACTION
-    #define __spiBusTransactionBegin(busdev)        spiBusTransactionBegin(busdev)
+    #define __spiBusTransactionBegin(busdev)        {spiBusWait(busdev);spiBusTransactionBegin(busdev);}
     #define __spiBusTransactionEnd(busdev)          spiBusTransactionEnd(busdev)
 #else
-    #define __spiBusTransactionBegin(busdev)        {spiBusSetDivisor(busdev, max7456SpiClock);IOLo((busdev)->busdev_u.spi.csnPin);}
+    #define __spiBusTransactionBegin(busdev)        {spiBusWait(busdev);spiBusSetDivisor(busdev, max7456SpiClock);IOLo((busdev)->busdev_u.spi.csnPin);}
     #define __spiBusTransactionEnd(busdev)       {IOHi((busdev)->busdev_u.spi.csnPin);spiSetDivisor((busdev)->busdev_u.spi.instance, MAX7456_RESTORE_CLK);}
 #endif
 
@@ -197,12 +201,41 @@ static uint8_t shadowBuffer[VIDEO_BUFFER_CHARS_PAL];
 //Max chars to update in one idle
 
 #define MAX_CHARS2UPDATE    100
+
+// Runs of at least this many changed characters are sent in auto-increment mode, which costs
+// 10 bytes to start and end the run and 2 bytes per character, instead of 6 per character
+#define AUTO_INCREMENT_MIN_RUN  3
+// Room needed in spiBuff to start encoding another run
+#define SPI_BUFF_RUN_HEADROOM   (10 + 2 * AUTO_INCREMENT_MIN_RUN)
 #ifdef MAX7456_DMA_CHANNEL_TX
 volatile bool dmaTransactionInProgress = false;
 #endif
 
 static uint8_t spiBuff[MAX_CHARS2UPDATE*6];
 
+#ifndef MAX7456_DMA_CHANNEL_TX
+static volatile bool spiBuffSending = false;
+
+static busStatus_e max7456SpiBuffSent(uint32_t arg)
+{
+    UNUSED(arg);
+
+#ifndef USE_SPI_TRANSACTION
+    spiSetDivisor(busdev->busdev_u.spi.instance, MAX7456_RESTORE_CLK);
+#endif
+    spiBuffSending = false;
+
+    return BUS_READY;
+}
+
+// spiBuff is sent in chunks with the chip select released in between, so a gyro read on the
+// same bus waits for one chunk at most. The writes are two bytes each, any even length will do.
+#define SPI_BUFF_CHUNK_LENGTH   64
+#define SPI_BUFF_CHUNK_COUNT    ((sizeof(spiBuff) + SPI_BUFF_CHUNK_LENGTH - 1) / SPI_BUFF_CHUNK_LENGTH)
+
+static busSegment_t spiBuffSegments[SPI_BUFF_CHUNK_COUNT + 1];
+#endif
+
 static uint8_t  videoSignalCfg;
 static uint8_t  videoSignalReg  = OSD_ENABLE; // OSD_ENABLE required to trigger first ReInit
 static uint8_t  displayMemoryModeReg = 0;
@@ -236,8 +269,6 @@ static void max7456SendDma(void* tx_buffer, void* rx_buffer, uint16_t buffer_siz
 #else
     UNUSED(rx_buffer);
 #endif
-    while (dmaTransactionInProgress); // Wait for prev DMA transaction
-
     DMA_DeInit(MAX7456_DMA_CHANNEL_TX);
 #ifdef MAX7456_DMA_CHANNEL_RX
     DMA_DeInit(MAX7456_DMA_CHANNEL_RX);
@@ -303,6 +334,8 @@ static void max7456SendDma(void* tx_buffer, void* rx_buffer, uint16_t buffer_siz
 
 void max7456_dma_irq_handler(dmaChannelDescriptor_t* descriptor)
 {
+    IRQ_LOAD_ENTER(IRQ_LOAD_MAX7456_DMA);
+
     if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
 #ifdef MAX7456_DMA_CHANNEL_RX
         DMA_Cmd(MAX7456_DMA_CHANNEL_RX, DISABLE);
@@ -339,6 +372,8 @@ void max7456_dma_irq_handler(dmaChannelDescriptor_t* descriptor)
     if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF)) {
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TEIF);
     }
+
+    IRQ_LOAD_EXIT(IRQ_LOAD_MAX7456_DMA);
 }
 
 #endif
@@ -578,7 +613,7 @@ bool max7456DmaInProgress(void)
 #ifdef MAX7456_DMA_CHANNEL_TX
     return dmaTransactionInProgress;
 #else
-    return false;
+    return spiBuffSending;
 #endif
 }
 
@@ -642,43 +677,111 @@ void max7456ReInitIfRequired(void)
     //------------   end of (re)init-------------------------------------
 }
 
+// Changed characters are sent as runs in auto-increment mode where they are contiguous,
+// so each call pushes as much of the difference between the buffers as fits in spiBuff.
+// The "escape" character 0xFF ends auto-increment mode, it is always sent with direct addressing.
 void max7456DrawScreen(void)
 {
     static uint16_t pos = 0;
+    static uint16_t frameBytes = 0;
+    static uint16_t frameChars = 0;
+    static uint16_t frameRuns = 0;
+
+    // spiBuff is still being sent, carry on at the next call instead of waiting
+    if (fontIsLoading || max7456DmaInProgress()) {
+        return;
+    }
+
+    // (Re)Initialize MAX7456 at startup or stall is detected.
 
-    if (!fontIsLoading) {
+    max7456ReInitIfRequired();
 
-        // (Re)Initialize MAX7456 at startup or stall is detected.
+    int buff_len = 0;
+    bool frameComplete = false;
 
-        max7456ReInitIfRequired();
+    while (!frameComplete && buff_len <= (int)sizeof(spiBuff) - SPI_BUFF_RUN_HEADROOM) {
+        uint16_t runLength = 0;
+        const uint16_t maxRunLength = (sizeof(spiBuff) - buff_len - 10) / 2;
+        while (pos + runLength < maxScreenSize && runLength < maxRunLength
+            && screenBuffer[pos + runLength] != shadowBuffer[pos + runLength]
+            && screenBuffer[pos + runLength] != END_STRING) {
+            runLength++;
+        }
 
-        int buff_len = 0;
-        for (int k = 0; k < MAX_CHARS2UPDATE; k++) {
-            if (screenBuffer[pos] != shadowBuffer[pos]) {
-                spiBuff[buff_len++] = MAX7456ADD_DMAH;
-                spiBuff[buff_len++] = pos >> 8;
-                spiBuff[buff_len++] = MAX7456ADD_DMAL;
-                spiBuff[buff_len++] = pos & 0xff;
+        if (runLength >= AUTO_INCREMENT_MIN_RUN) {
+            spiBuff[buff_len++] = MAX7456ADD_DMAH;
+            spiBuff[buff_len++] = pos >> 8;
+            spiBuff[buff_len++] = MAX7456ADD_DMAL;
+            spiBuff[buff_len++] = pos & 0xff;
+            spiBuff[buff_len++] = MAX7456ADD_DMM;
+            spiBuff[buff_len++] = displayMemoryModeReg | 1;
+            for (int i = 0; i < runLength; i++) {
                 spiBuff[buff_len++] = MAX7456ADD_DMDI;
                 spiBuff[buff_len++] = screenBuffer[pos];
                 shadowBuffer[pos] = screenBuffer[pos];
+                pos++;
             }
-
-            if (++pos >= maxScreenSize) {
-                pos = 0;
-                break;
+            spiBuff[buff_len++] = MAX7456ADD_DMDI;
+            spiBuff[buff_len++] = END_STRING;
+            spiBuff[buff_len++] = MAX7456ADD_DMM;
+            spiBuff[buff_len++] = displayMemoryModeReg;
+            frameChars += runLength;
+            frameRuns++;
+        } else {
+            // A short run, or an unchanged or escape character when the run is empty
+            const uint16_t count = runLength ? runLength : 1;
+            for (int i = 0; i < count; i++) {
+                if (screenBuffer[pos] != shadowBuffer[pos]) {
+                    spiBuff[buff_len++] = MAX7456ADD_DMAH;
+                    spiBuff[buff_len++] = pos >> 8;
+                    spiBuff[buff_len++] = MAX7456ADD_DMAL;
+                    spiBuff[buff_len++] = pos & 0xff;
+                    spiBuff[buff_len++] = MAX7456ADD_DMDI;
+                    spiBuff[buff_len++] = screenBuffer[pos];
+                    shadowBuffer[pos] = screenBuffer[pos];
+                    frameChars++;
+                }
+                pos++;
             }
         }
 
-        if (buff_len) {
+        if (pos >= maxScreenSize) {
+            pos = 0;
+            frameComplete = true;
+        }
+    }
+
+    frameBytes += buff_len;
+    DEBUG_SET(DEBUG_MAX7456_SPI, 0, buff_len);
+    if (frameComplete) {
+        DEBUG_SET(DEBUG_MAX7456_SPI, 1, frameBytes);
+        DEBUG_SET(DEBUG_MAX7456_SPI, 2, frameChars);
+        DEBUG_SET(DEBUG_MAX7456_SPI, 3, frameRuns);
+        frameBytes = 0;
+        frameChars = 0;
+        frameRuns = 0;
+    }
+
+    if (buff_len) {
 #ifdef MAX7456_DMA_CHANNEL_TX
-            max7456SendDma(spiBuff, NULL, buff_len);
+        max7456SendDma(spiBuff, NULL, buff_len);
 #else
-            __spiBusTransactionBegin(busdev);
-            spiTransfer(busdev->busdev_u.spi.instance, spiBuff, NULL, buff_len);
-            __spiBusTransactionEnd(busdev);
-#endif // MAX7456_DMA_CHANNEL_TX
+        // The clock is changed for the whole bus, so wait for the other devices' sequences
+        spiBusWait(busdev);
+#ifndef USE_SPI_TRANSACTION
+        spiBusSetDivisor(busdev, max7456SpiClock);
+#endif
+        int segmentCount = 0;
+        for (int offset = 0; offset < buff_len; offset += SPI_BUFF_CHUNK_LENGTH) {
+            spiBuffSegments[segmentCount++] = (busSegment_t){ &spiBuff[offset], NULL, MIN(buff_len - offset, SPI_BUFF_CHUNK_LENGTH), true, NULL };
         }
+        spiBuffSegments[segmentCount - 1].callback = max7456SpiBuffSent;
+        spiBuffSegments[segmentCount] = (busSegment_t){ NULL, NULL, 0, true, NULL };
+        spiBuffSending = true;
+        if (!spiBusSequence(busdev, spiBuffSegments, 0)) {
+            spiBusRunSequence(busdev, spiBuffSegments);
+        }
+#endif // MAX7456_DMA_CHANNEL_TX
     }
 }
 
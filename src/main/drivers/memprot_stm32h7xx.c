@@ -70,6 +70,32 @@ mpuRegion_t mpuRegions[] = {
         .bufferable = MPU_ACCESS_NOT_BUFFERABLE,
     },
 #endif
+#ifdef USE_QUADSPI
+    {
+        // The whole QUADSPI bank, so speculative reads by the core do not reach the controller
+        // while it is not in memory-mapped mode
+        .start      = QSPI_BASE,
+        .end        = 0, // Size defined by "size"
+        .size       = MPU_REGION_SIZE_256MB,
+        .perm       = MPU_REGION_NO_ACCESS,
+        .exec       = MPU_INSTRUCTION_ACCESS_DISABLE,
+        .shareable  = MPU_ACCESS_NOT_SHAREABLE,
+        .cacheable  = MPU_ACCESS_NOT_CACHEABLE,
+        .bufferable = MPU_ACCESS_NOT_BUFFERABLE,
+    },
+    {
+        // Memory-mapped window onto the flash page buffer, read only and not cached as
+        // its content changes with every page the flash loads
+        .start      = QSPI_BASE,
+        .end        = 0, // Size defined by "size"
+        .size       = MPU_REGION_SIZE_4KB,
+        .perm       = MPU_REGION_PRIV_RO_URO,
+        .exec       = MPU_INSTRUCTION_ACCESS_DISABLE,
+        .shareable  = MPU_ACCESS_NOT_SHAREABLE,
+        .cacheable  = MPU_ACCESS_NOT_CACHEABLE,
+        .bufferable = MPU_ACCESS_NOT_BUFFERABLE,
+    },
+#endif
 };
 
 unsigned mpuRegionCount = ARRAYLEN(mpuRegions);
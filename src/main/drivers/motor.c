@@ -29,6 +29,7 @@
 #ifdef USE_MOTOR
 
 #include "common/maths.h"
+#include "common/utils.h"
 
 #include "config/feature.h"
 
@@ -46,6 +47,13 @@
 
 static FAST_RAM_ZERO_INIT motorDevice_t *motorDevice;
 
+#ifdef SPECIALIZED_MOTOR_WRITE_FN
+void SPECIALIZED_MOTOR_WRITE_FN(uint8_t index, float value);
+#define MOTOR_WRITE(index, value) CALL_DIRECT_IF(motorDevice->vTable.write, SPECIALIZED_MOTOR_WRITE_FN, index, value)
+#else
+#define MOTOR_WRITE(index, value) motorDevice->vTable.write(index, value)
+#endif
+
 void motorShutdown(void)
 {
     motorDevice->vTable.shutdown();
@@ -60,11 +68,12 @@ void motorWriteAll(float *values)
     if (motorDevice->enabled) {
 #if defined(USE_DSHOT) && defined(USE_DSHOT_TELEMETRY)
         if (!motorDevice->vTable.updateStart()) {
+            dshotTelemetryState.skippedUpdateCount++;
             return;
         }
 #endif
         for (int i = 0; i < motorDevice->count; i++) {
-            motorDevice->vTable.write(i, values[i]);
+            MOTOR_WRITE(i, values[i]);
         }
         motorDevice->vTable.updateComplete();
     }
@@ -65,6 +65,8 @@
 #define NVIC_PRIO_MAG_DATA_READY           NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_CALLBACK                 NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_MAX7456_DMA              NVIC_BUILD_PRIORITY(3, 0)
+#define NVIC_PRIO_PID_LOOP                 NVIC_BUILD_PRIORITY(0x0f, 0x0f)
+#define NVIC_PRIO_SPI_DMA                  NVIC_BUILD_PRIORITY(2, 2)  // must be able to preempt the PID loop
 
 #ifdef USE_HAL_DRIVER
 // utility macros to join/split priority
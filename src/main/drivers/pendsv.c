@@ -0,0 +1,55 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_PID_LOOP_INTERRUPT
+
+#include "drivers/nvic.h"
+
+#include "pendsv.h"
+
+static pendSVCallbackPtr pendSVCallback = NULL;
+
+// PendSV runs at the lowest priority, so every peripheral interrupt can preempt the work it performs
+void pendSVInit(pendSVCallbackPtr callback)
+{
+    pendSVCallback = callback;
+    NVIC_SetPriority(PendSV_IRQn, NVIC_PRIO_PID_LOOP >> (8 - __NVIC_PRIO_BITS));
+}
+
+void pendSVTrigger(void)
+{
+    if (pendSVCallback) {
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+}
+
+void PendSV_Handler(void)
+{
+    if (pendSVCallback) {
+        pendSVCallback();
+    }
+}
+
+#endif // USE_PID_LOOP_INTERRUPT
@@ -0,0 +1,37 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef USE_PID_LOOP_INTERRUPT
+#include "build/atomic.h"
+#include "drivers/nvic.h"
+
+// Holds off a PID loop run from PendSV while the state it reads is re-initialised. PendSV can not
+// be disabled on its own, so BASEPRI is raised to its priority, higher priority interrupts still run.
+#define PENDSV_BLOCK ATOMIC_BLOCK(NVIC_PRIO_PID_LOOP)
+#else
+#define PENDSV_BLOCK
+#endif
+
+typedef void (*pendSVCallbackPtr)(void);
+
+void pendSVInit(pendSVCallbackPtr callback);
+void pendSVTrigger(void);
@@ -116,7 +116,7 @@ static void pwmWriteUnused(uint8_t index, float value)
     UNUSED(value);
 }
 
-static void pwmWriteStandard(uint8_t index, float value)
+void pwmWriteStandard(uint8_t index, float value)
 {
     /* TODO: move value to be a number between 0-1 (i.e. percent throttle from mixer) */
     *motors[index].channel.ccr = lrintf((value * motors[index].pulseScale) + motors[index].pulseOffset);
@@ -149,12 +149,32 @@ bool pwmIsMotorEnabled(uint8_t index)
     return motors[index].enabled;
 }
 
+// timers driving the motors, each listed once, whose forced overflow starts the oneshot pulses
+static FAST_RAM_ZERO_INIT TIM_TypeDef *oneshotTimers[MAX_SUPPORTED_MOTORS];
+static FAST_RAM_ZERO_INIT uint8_t oneshotTimerCount;
+static FAST_RAM_ZERO_INIT timeDelta_t oneshotSyncOffsetUs;
+static FAST_RAM_ZERO_INIT timeUs_t oneshotSyncReferenceUs;
+
+// Sets the time the oneshot sync offset counts from, the start of the PID loop which follows the gyro samples
+void pwmSetOneshotSyncReference(timeUs_t currentTimeUs)
+{
+    oneshotSyncReferenceUs = currentTimeUs;
+}
+
 static void pwmCompleteOneshotMotorUpdate(void)
 {
-    for (int index = 0; index < motorPwmDevice.count; index++) {
-        if (motors[index].forceOverflow) {
-            timerForceOverflow(motors[index].channel.tim);
+    if (oneshotSyncOffsetUs) {
+        // hold the pulses until the offset so that their start keeps the same phase to the gyro samples
+        // however long the PID loop took, a loop that overran the offset starts them immediately
+        const timeUs_t syncTimeUs = oneshotSyncReferenceUs + oneshotSyncOffsetUs;
+        while (cmpTimeUs(syncTimeUs, micros()) > 0) {
         }
+    }
+
+    // all timers update together so the motors get their pulses at the same time
+    timerForceOverflowGroup(oneshotTimers, oneshotTimerCount);
+
+    for (int index = 0; index < motorPwmDevice.count; index++) {
         // Set the compare register to 0, which stops the output pulsing if the timer overflows before the main loop completes again.
         // This compare register will be set to the output value on the next main loop.
         *motors[index].channel.ccr = 0;
@@ -217,6 +237,8 @@ motorDevice_t *motorPwmDevInit(const motorDevConfig_t *motorConfig, uint16_t idl
     motorPwmDevice.vTable.write = pwmWriteStandard;
     motorPwmDevice.vTable.updateStart = motorUpdateStartNull;
     motorPwmDevice.vTable.updateComplete = useUnsyncedPwm ? motorUpdateCompleteNull : pwmCompleteOneshotMotorUpdate;
+    oneshotTimerCount = 0;
+    oneshotSyncOffsetUs = useUnsyncedPwm ? 0 : motorConfig->motorPwmSyncOffsetUs;
 
     for (int motorIndex = 0; motorIndex < MAX_SUPPORTED_MOTORS && motorIndex < motorCount; motorIndex++) {
         const ioTag_t tag = motorConfig->ioTags[motorIndex];
@@ -267,6 +289,9 @@ motorDevice_t *motorPwmDevInit(const motorDevConfig_t *motorConfig, uint16_t idl
             }
         }
         motors[motorIndex].forceOverflow = !timerAlreadyUsed;
+        if (!timerAlreadyUsed) {
+            oneshotTimers[oneshotTimerCount++] = motors[motorIndex].channel.tim;
+        }
         motors[motorIndex].enabled = true;
     }
 
@@ -280,11 +305,21 @@ pwmOutputPort_t *pwmGetMotors(void)
 
 #ifdef USE_SERVOS
 static pwmOutputPort_t servos[MAX_SUPPORTED_SERVOS];
+static uint8_t servoCount;
+// pulses written since the last pwmCompleteServoUpdate(), so that all outputs change together
+static uint16_t servoPulse[MAX_SUPPORTED_SERVOS];
 
 void pwmWriteServo(uint8_t index, float value)
 {
-    if (index < MAX_SUPPORTED_SERVOS && servos[index].channel.ccr) {
-        *servos[index].channel.ccr = lrintf(value);
+    if (index < MAX_SUPPORTED_SERVOS) {
+        servoPulse[index] = lrintf(value);
+    }
+}
+
+void pwmCompleteServoUpdate(void)
+{
+    for (int index = 0; index < servoCount; index++) {
+        *servos[index].channel.ccr = servoPulse[index];
     }
 }
 
@@ -316,6 +351,8 @@ void servoDevInit(const servoDevConfig_t *servoConfig)
 
         pwmOutConfig(&servos[servoIndex].channel, timer, PWM_TIMER_1MHZ, PWM_TIMER_1MHZ / servoConfig->servoPwmRate, servoConfig->servoCenterPulse, 0);
         servos[servoIndex].enabled = true;
+        servoPulse[servoIndex] = servoConfig->servoCenterPulse;
+        servoCount = servoIndex + 1;
     }
 }
 #endif // USE_SERVOS
@@ -59,6 +59,7 @@ extern FAST_RAM_ZERO_INIT pwmOutputPort_t motors[MAX_SUPPORTED_MOTORS];
 
 struct motorDevConfig_s;
 motorDevice_t *motorPwmDevInit(const struct motorDevConfig_s *motorDevConfig, uint16_t idlePulse, uint8_t motorCount, bool useUnsyncedPwm);
+void pwmSetOneshotSyncReference(timeUs_t currentTimeUs);
 
 typedef struct servoDevConfig_s {
     // PWM values, in milliseconds, common range is 1000-2000 (1ms to 2ms)
@@ -74,6 +75,7 @@ void pwmServoConfig(const struct timerHardware_s *timerHardware, uint8_t servoIn
 void pwmOutConfig(timerChannel_t *channel, const timerHardware_t *timerHardware, uint32_t hz, uint16_t period, uint16_t value, uint8_t inversion);
 
 void pwmWriteServo(uint8_t index, float value);
+void pwmCompleteServoUpdate(void);
 
 pwmOutputPort_t *pwmGetMotors(void);
 bool pwmIsSynced(void);
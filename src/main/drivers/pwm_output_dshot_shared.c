@@ -180,6 +180,9 @@ static uint32_t decodeTelemetryPacket(uint32_t buffer[], uint32_t count)
     }
     decodedValue >>= 4;
 
+    if (dshotIsExtendedTelemetryFrame(decodedValue)) {
+        return DSHOT_TELEMETRY_EXTENDED_FRAME | decodedValue;
+    }
     if (decodedValue == 0x0fff) {
         return 0;
     }
@@ -203,11 +206,16 @@ FAST_CODE_NOINLINE bool pwmStartDshotMotorUpdate(void)
     const timeMs_t currentTimeMs = millis();
 #endif
     const timeUs_t currentUs = micros();
+    const timeDelta_t usSinceInput = cmpTimeUs(currentUs, inputStampUs);
+    // All motors share the input window, so check every deadtime before any
+    // channel is switched back; bailing out part way through the decode
+    // loop would turn the first motors around while the rest keep capturing.
     for (int i = 0; i < dshotPwmDevice.count; i++) {
-        timeDelta_t usSinceInput = cmpTimeUs(currentUs, inputStampUs);
         if (usSinceInput >= 0 && usSinceInput < dmaMotors[i].dshotTelemetryDeadtimeUs) {
             return false;
         }
+    }
+    for (int i = 0; i < dshotPwmDevice.count; i++) {
         if (dmaMotors[i].isInput) {
 #ifdef USE_FULL_LL_DRIVER
             uint32_t edges = GCR_TELEMETRY_INPUT_LEN - xLL_EX_DMA_GetDataLength(dmaMotors[i].dmaRef);
@@ -221,7 +229,7 @@ FAST_CODE_NOINLINE bool pwmStartDshotMotorUpdate(void)
             TIM_DMACmd(dmaMotors[i].timerHardware->tim, dmaMotors[i].timerDmaSource, DISABLE);
 #endif
 
-            uint16_t value = 0xffff;
+            uint32_t value = 0xffff;
 
             if (edges > MIN_GCR_EDGES) {
                 dshotTelemetryState.readCount++;
@@ -231,11 +239,7 @@ FAST_CODE_NOINLINE bool pwmStartDshotMotorUpdate(void)
                 bool validTelemetryPacket = false;
 #endif
                 if (value != 0xffff) {
-                    dshotTelemetryState.motorState[i].telemetryValue = value;
-                    dshotTelemetryState.motorState[i].telemetryActive = true;
-                    if (i < 4) {
-                        DEBUG_SET(DEBUG_DSHOT_RPM_TELEMETRY, i, value);
-                    }
+                    dshotUpdateTelemetryData(i, value);
 #ifdef USE_DSHOT_TELEMETRY_STATS
                     validTelemetryPacket = true;
 #endif
@@ -47,7 +47,7 @@ void a7105extiHandler(extiCallbackRec_t* cb)
     UNUSED(cb);
 
     if (IORead(rxIntIO) != 0) {
-        timeEvent = micros();
+        timeEvent = microsISR();
         occurEvent = true;
     }
 }
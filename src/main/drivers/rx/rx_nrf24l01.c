@@ -32,10 +32,13 @@
 #include "build/build_config.h"
 
 #include "pg/rx.h"
+#include "pg/rx_spi.h"
 
 #include "drivers/bus_spi.h"
+#include "drivers/exti.h"
 #include "drivers/io.h"
 #include "drivers/io_impl.h"
+#include "drivers/nvic.h"
 #include "drivers/rx/rx_spi.h"
 #include "drivers/time.h"
 
@@ -60,6 +63,24 @@
 #define REUSE_TX_PL   0xE3
 #define NOP           0xFF
 
+#ifdef USE_EXTI
+// The IRQ pin is optional, it is low while an interrupt flag that is not masked is set
+static IO_t irqPin = IO_NONE;
+static extiCallbackRec_t irqExtiCallbackRec;
+static volatile timeUs_t irqAssertedAtUs;
+static volatile bool irqAsserted;
+// The RX FIFO holds up to three packets, but the IRQ pin only falls for the first of them
+static bool rxFifoMayHoldPacket;
+
+static void NRF24L01_IrqHandler(extiCallbackRec_t *cb)
+{
+    UNUSED(cb);
+
+    irqAssertedAtUs = microsISR();
+    irqAsserted = true;
+}
+#endif
+
 static void NRF24L01_InitGpio(void)
 {
     // CE as OUTPUT
@@ -67,6 +88,16 @@ static void NRF24L01_InitGpio(void)
     IOInit(DEFIO_IO(RX_CE_PIN), OWNER_RX_SPI_CS, rxSPIDevice + 1);
     IOConfigGPIO(DEFIO_IO(RX_CE_PIN), SPI_IO_CS_CFG);
     NRF24_CE_LO();
+
+#ifdef USE_EXTI
+    irqPin = IOGetByTag(rxSpiConfig()->extiIoTag);
+    if (irqPin) {
+        IOInit(irqPin, OWNER_RX_SPI_EXTI, 0);
+        EXTIHandlerInit(&irqExtiCallbackRec, NRF24L01_IrqHandler);
+        EXTIConfig(irqPin, &irqExtiCallbackRec, NVIC_PRIO_MPU_INT_EXTI, IOCFG_IPU, EXTI_TRIGGER_FALLING);
+        EXTIEnable(irqPin, true);
+    }
+#endif
 }
 
 void NRF24L01_WriteReg(uint8_t reg, uint8_t data)
@@ -215,15 +246,65 @@ void NRF24L01_SetChannel(uint8_t channel)
     NRF24L01_WriteReg(NRF24L01_05_RF_CH, channel);
 }
 
+// False without a SPI transfer while the IRQ pin shows that no interrupt flag is set
+static bool NRF24L01_IrqPending(void)
+{
+#ifdef USE_EXTI
+    return !irqPin || !IORead(irqPin);
+#else
+    return true;
+#endif
+}
+
+bool NRF24L01_IsRxDataReady(void)
+{
+    return NRF24L01_IrqPending() && (NRF24L01_ReadReg(NRF24L01_07_STATUS) & BV(NRF24L01_07_STATUS_RX_DR));
+}
+
 bool NRF24L01_ReadPayloadIfAvailable(uint8_t *data, uint8_t length)
 {
+#ifdef USE_EXTI
+    if (!rxFifoMayHoldPacket && !NRF24L01_IrqPending()) {
+        return false;
+    }
+#endif
     if (NRF24L01_ReadReg(NRF24L01_17_FIFO_STATUS) & BV(NRF24L01_17_FIFO_STATUS_RX_EMPTY)) {
+#ifdef USE_EXTI
+        rxFifoMayHoldPacket = false;
+        if (irqPin && !IORead(irqPin)) {
+            // release the pin if it was left low by a packet that has been flushed
+            NRF24L01_WriteReg(NRF24L01_07_STATUS, BV(NRF24L01_07_STATUS_RX_DR));
+        }
+#endif
         return false;
     }
     NRF24L01_ReadPayload(data, length);
+#ifdef USE_EXTI
+    if (irqPin) {
+        // clear RX_DR so that the pin falls again for the next packet, look in the FIFO for one next time
+        NRF24L01_WriteReg(NRF24L01_07_STATUS, BV(NRF24L01_07_STATUS_RX_DR));
+        rxFifoMayHoldPacket = true;
+    }
+#endif
     return true;
 }
 
+// The time the IRQ pin fell for the packet that has been read, which the hop timing is based on.
+// Without the IRQ pin the packet is timed when it is found.
+timeUs_t NRF24L01_GetPacketTimeUs(void)
+{
+#ifdef USE_EXTI
+    if (irqAsserted) {
+        const timeUs_t assertedAtUs = irqAssertedAtUs;
+        irqAsserted = false;
+
+        return assertedAtUs;
+    }
+#endif
+
+    return micros();
+}
+
 #ifndef UNIT_TEST
 #define DISABLE_RX()    {IOHi(DEFIO_IO(RX_NSS_PIN));}
 #define ENABLE_RX()     {IOLo(DEFIO_IO(RX_NSS_PIN));}
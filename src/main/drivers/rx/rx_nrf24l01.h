@@ -26,6 +26,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "common/time.h"
+
 #include "rx/rx_spi.h"
 
 #define NRF24L01_MAX_PAYLOAD_SIZE 32
@@ -200,4 +202,6 @@ void NRF24L01_SetRxMode(void);
 void NRF24L01_SetTxMode(void);
 void NRF24L01_ClearAllInterrupts(void);
 void NRF24L01_SetChannel(uint8_t channel);
+bool NRF24L01_IsRxDataReady(void);
 bool NRF24L01_ReadPayloadIfAvailable(uint8_t *data, uint8_t length);
+timeUs_t NRF24L01_GetPacketTimeUs(void);
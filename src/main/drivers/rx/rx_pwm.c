@@ -30,9 +30,14 @@
 
 #include "common/utils.h"
 
+#ifdef USE_PPM_DMA
+#include "drivers/dma.h"
+#include "drivers/dma_reqmap.h"
+#endif
 #include "drivers/io.h"
 #include "drivers/nvic.h"
 #include "drivers/pwm_output.h"
+#include "drivers/time.h"
 #include "drivers/timer.h"
 
 #include "pg/rx_pwm.h"
@@ -88,6 +93,20 @@ static uint8_t ppmFrameCount = 0;
 static uint8_t lastPPMFrameCount = 0;
 static uint8_t ppmCountDivisor = 1;
 
+#ifdef USE_PPM_DMA
+// With DMA the rising edges are captured into a ring of 16 bit timestamps without any interrupts,
+// and the frames are decoded in one pass when the rx task checks for data.
+#define PPM_DMA_EDGES               64      // several frames, so a late poll doesn't lose edges
+#define PPM_DMA_MAX_EDGE_GAP_US     50000   // the 1MHz capture wraps after 65ms, a longer gap can't be measured
+
+static dmaResource_t *ppmDmaRef;
+static volatile uint16_t ppmDmaBuffer[PPM_DMA_EDGES];
+static uint16_t ppmDmaTail;
+static uint16_t ppmDmaPreviousCapture;
+static timeUs_t ppmDmaLastEdgeUs;
+static bool ppmTimerShared = false;
+#endif
+
 typedef struct ppmDevice_s {
     //uint32_t previousTime;
     uint32_t currentCapture;
@@ -113,8 +132,18 @@ static ppmDevice_t ppmDev;
 #define PPM_IN_MIN_NUM_CHANNELS     4
 #define PPM_IN_MAX_NUM_CHANNELS     PWM_PORTS_OR_PPM_CAPTURE_COUNT
 
+#ifdef USE_PPM_DMA
+static void ppmDmaPoll(void);
+#endif
+
 bool isPPMDataBeingReceived(void)
 {
+#ifdef USE_PPM_DMA
+    if (ppmDmaRef) {
+        ppmDmaPoll();
+    }
+#endif
+
     return (ppmFrameCount != lastPPMFrameCount);
 }
 
@@ -175,45 +204,11 @@ static void ppmOverflowCallback(timerOvrHandlerRec_t* cbRec, captureCompare_t ca
     }
 }
 
-static void ppmEdgeCallback(timerCCHandlerRec_t* cbRec, captureCompare_t capture)
+// Takes the pulse that ended with the latest edge, ppmDev.deltaTime, and completes a frame on the sync pulse
+static void ppmDecodePulse(void)
 {
-    UNUSED(cbRec);
-    ppmISREvent(SOURCE_EDGE, capture);
-
     int32_t i;
 
-    uint32_t previousTime = ppmDev.currentTime;
-    uint32_t previousCapture = ppmDev.currentCapture;
-
-    /* Grab the new count */
-    uint32_t currentTime = capture;
-
-    /* Convert to 32-bit timer result */
-    currentTime += ppmDev.largeCounter;
-
-    if (capture < previousCapture) {
-        if (ppmDev.overflowed) {
-            currentTime += PPM_TIMER_PERIOD;
-        }
-    }
-
-    // Divide value if Oneshot, Multishot or brushed motors are active and the timer is shared
-    currentTime = currentTime / ppmCountDivisor;
-
-    /* Capture computation */
-    if (currentTime > previousTime) {
-        ppmDev.deltaTime    = currentTime - (previousTime + (ppmDev.overflowed ? (PPM_TIMER_PERIOD / ppmCountDivisor) : 0));
-    } else {
-        ppmDev.deltaTime    = (PPM_TIMER_PERIOD / ppmCountDivisor) + currentTime - previousTime;
-    }
-
-    ppmDev.overflowed = false;
-
-
-    /* Store the current measurement */
-    ppmDev.currentTime = currentTime;
-    ppmDev.currentCapture = capture;
-
     /* Sync pulse detection */
     if (ppmDev.deltaTime > PPM_IN_MIN_SYNC_PULSE_US) {
         if (ppmDev.pulseIndex == ppmDev.numChannelsPrevFrame
@@ -265,6 +260,46 @@ static void ppmEdgeCallback(timerCCHandlerRec_t* cbRec, captureCompare_t capture
     }
 }
 
+static void ppmEdgeCallback(timerCCHandlerRec_t* cbRec, captureCompare_t capture)
+{
+    UNUSED(cbRec);
+    ppmISREvent(SOURCE_EDGE, capture);
+
+    uint32_t previousTime = ppmDev.currentTime;
+    uint32_t previousCapture = ppmDev.currentCapture;
+
+    /* Grab the new count */
+    uint32_t currentTime = capture;
+
+    /* Convert to 32-bit timer result */
+    currentTime += ppmDev.largeCounter;
+
+    if (capture < previousCapture) {
+        if (ppmDev.overflowed) {
+            currentTime += PPM_TIMER_PERIOD;
+        }
+    }
+
+    // Divide value if Oneshot, Multishot or brushed motors are active and the timer is shared
+    currentTime = currentTime / ppmCountDivisor;
+
+    /* Capture computation */
+    if (currentTime > previousTime) {
+        ppmDev.deltaTime    = currentTime - (previousTime + (ppmDev.overflowed ? (PPM_TIMER_PERIOD / ppmCountDivisor) : 0));
+    } else {
+        ppmDev.deltaTime    = (PPM_TIMER_PERIOD / ppmCountDivisor) + currentTime - previousTime;
+    }
+
+    ppmDev.overflowed = false;
+
+
+    /* Store the current measurement */
+    ppmDev.currentTime = currentTime;
+    ppmDev.currentCapture = capture;
+
+    ppmDecodePulse();
+}
+
 #define MAX_MISSED_PWM_EVENTS 10
 
 bool isPWMDataBeingReceived(void)
@@ -417,11 +452,81 @@ void ppmAvoidPWMTimerClash(TIM_TypeDef *pwmTimer)
         }
 
         ppmCountDivisor = timerClock(pwmTimer) / (pwmTimer->PSC + 1);
+#ifdef USE_PPM_DMA
+        ppmTimerShared = true;
+#endif
         return;
     }
 }
 #endif
 
+#ifdef USE_PPM_DMA
+static void ppmDmaPoll(void)
+{
+    const uint16_t head = PPM_DMA_EDGES - xDMA_GetCurrDataCounter(ppmDmaRef);
+    if (ppmDmaTail == head) {
+        return;
+    }
+
+    const timeUs_t currentTimeUs = micros();
+    if (cmpTimeUs(currentTimeUs, ppmDmaLastEdgeUs) > PPM_DMA_MAX_EDGE_GAP_US) {
+        // the signal was lost, measure from the first new edge and wait for a sync pulse
+        ppmDmaPreviousCapture = ppmDmaBuffer[ppmDmaTail];
+        ppmDmaTail = (ppmDmaTail + 1) % PPM_DMA_EDGES;
+        ppmDev.tracking = false;
+    }
+    ppmDmaLastEdgeUs = currentTimeUs;
+
+    while (ppmDmaTail != head) {
+        const uint16_t capture = ppmDmaBuffer[ppmDmaTail];
+        ppmDev.deltaTime = (uint16_t)(capture - ppmDmaPreviousCapture);
+        ppmDmaPreviousCapture = capture;
+        ppmDecodePulse();
+        ppmDmaTail = (ppmDmaTail + 1) % PPM_DMA_EDGES;
+    }
+}
+
+// Captures by DMA when the channel has a free stream and a 1MHz free running timer of its own,
+// otherwise PPM is left to the edge interrupts
+static bool ppmDmaInit(const timerHardware_t *timer)
+{
+    const dmaChannelSpec_t *dmaSpec = dmaGetChannelSpecByTimer(timer);
+    if (ppmTimerShared || !dmaSpec || dmaGetOwner(dmaGetIdentifier(dmaSpec->ref))->owner != OWNER_FREE) {
+        return false;
+    }
+
+    ppmDmaRef = dmaSpec->ref;
+    dmaInit(dmaGetIdentifier(ppmDmaRef), OWNER_PPMINPUT, 0);
+
+    DMA_InitTypeDef dmaInitStruct;
+    DMA_StructInit(&dmaInitStruct);
+    dmaInitStruct.DMA_Channel = dmaSpec->channel;
+    dmaInitStruct.DMA_PeripheralBaseAddr = (uint32_t)timerChCCR(timer);
+    dmaInitStruct.DMA_Memory0BaseAddr = (uint32_t)ppmDmaBuffer;
+    dmaInitStruct.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    dmaInitStruct.DMA_BufferSize = PPM_DMA_EDGES;
+    dmaInitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    dmaInitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    dmaInitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    dmaInitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    dmaInitStruct.DMA_Mode = DMA_Mode_Circular;
+    dmaInitStruct.DMA_Priority = DMA_Priority_Medium;
+
+    xDMA_Cmd(ppmDmaRef, DISABLE);
+    xDMA_DeInit(ppmDmaRef);
+    xDMA_Init(ppmDmaRef, &dmaInitStruct);
+    xDMA_Cmd(ppmDmaRef, ENABLE);
+
+    ppmDmaTail = 0;
+    ppmDmaLastEdgeUs = micros() - PPM_DMA_MAX_EDGE_GAP_US - 1;
+
+    pwmICConfig(timer->tim, timer->channel, TIM_ICPolarity_Rising);
+    TIM_DMACmd(timer->tim, timerDmaSource(timer->channel), ENABLE);
+
+    return true;
+}
+#endif
+
 void ppmRxInit(const ppmConfig_t *ppmConfig)
 {
     ppmResetDevice();
@@ -450,6 +555,13 @@ void ppmRxInit(const ppmConfig_t *ppmConfig)
 #endif
 
     timerConfigure(timer, (uint16_t)PPM_TIMER_PERIOD, PWM_TIMER_1MHZ);
+
+#ifdef USE_PPM_DMA
+    if (ppmConfig->dmaCapture && ppmDmaInit(timer)) {
+        return;
+    }
+#endif
+
     timerChCCHandlerInit(&port->edgeCb, ppmEdgeCallback);
     timerChOvrHandlerInit(&port->overflowCb, ppmOverflowCallback);
     timerChConfigCallbacks(timer, &port->edgeCb, &port->overflowCb);
@@ -141,6 +141,18 @@ bool sdcard_readBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationComp
     return sdcardVTable->sdcard_readBlock(blockIndex, buffer, callback, callbackData);
 }
 
+/**
+ * Drivers without multiple block reads simply read the blocks one at a time.
+ */
+sdcardOperationStatus_e sdcard_beginReadBlocks(uint32_t blockIndex)
+{
+    if (sdcardVTable->sdcard_beginReadBlocks) {
+        return sdcardVTable->sdcard_beginReadBlocks(blockIndex);
+    }
+
+    return SDCARD_OPERATION_SUCCESS;
+}
+
 sdcardOperationStatus_e sdcard_beginWriteBlocks(uint32_t blockIndex, uint32_t blockCount)
 {
     return sdcardVTable->sdcard_beginWriteBlocks(blockIndex, blockCount);
@@ -50,7 +50,8 @@ typedef enum {
     SDCARD_STATE_SENDING_WRITE,
     SDCARD_STATE_WAITING_FOR_WRITE,
     SDCARD_STATE_WRITING_MULTIPLE_BLOCKS,
-    SDCARD_STATE_STOPPING_MULTIPLE_BLOCK_WRITE
+    SDCARD_STATE_STOPPING_MULTIPLE_BLOCK_WRITE,
+    SDCARD_STATE_READING_MULTIPLE_BLOCKS
 } sdcardState_e;
 
 typedef struct sdcard_t {
@@ -77,6 +78,10 @@ typedef struct sdcard_t {
     uint32_t multiWriteNextBlock;
     uint32_t multiWriteBlocksRemain;
 
+    // While multiReadActive the card is streaming consecutive blocks to us, starting at multiReadNextBlock
+    uint32_t multiReadNextBlock;
+    bool multiReadActive;
+
     sdcardState_e state;
 
     sdcardMetadata_t metadata;
@@ -114,6 +119,7 @@ typedef struct sdcardVTable_s {
     void (*sdcard_init)(const sdcardConfig_t *config, const spiPinConfig_t *spiConfig);
     bool (*sdcard_readBlock)(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData);
     sdcardOperationStatus_e (*sdcard_beginWriteBlocks)(uint32_t blockIndex, uint32_t blockCount);
+    sdcardOperationStatus_e (*sdcard_beginReadBlocks)(uint32_t blockIndex);
     sdcardOperationStatus_e (*sdcard_writeBlock)(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData);
     bool (*sdcard_poll)(void);
     bool (*sdcard_isFunctional)(void);
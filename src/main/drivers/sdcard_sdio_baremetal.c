@@ -43,29 +43,57 @@
 #include "drivers/sdcard_standard.h"
 #include "drivers/sdmmc_sdio.h"
 
-// Use this to speed up writing to SDCARD... asyncfatfs has limited support for multiblock write
-#define FATFS_BLOCK_CACHE_SIZE 16
-uint8_t writeCache[512 * FATFS_BLOCK_CACHE_SIZE] __attribute__ ((aligned (4)));
-uint32_t cacheCount = 0;
+/*
+ * With sdio_use_cache enabled, consecutive blocks of a multi-block write whose buffers also follow each other in
+ * memory are held back and then sent by a single DMA transfer straight out of the caller's buffers. The caller keeps
+ * those buffers until their completion callbacks are called, so nothing needs to be copied.
+ */
+#define SDCARD_SDIO_MAX_CHAIN_BLOCKS 16
+
+typedef struct sdcardSdioWriteChain_s {
+    uint8_t *buffer;        // Buffer of the first block in the chain
+    uint32_t blockIndex;    // Index of the first block in the chain
+    uint8_t count;
+    uint8_t idlePolls;      // Polls since the chain last grew
+    bool inFlight;          // The chain has been handed to the DMA and the card hasn't finished committing it yet
 
-void cache_write(uint8_t *buffer)
+    sdcard_operationCompleteCallback_c callback[SDCARD_SDIO_MAX_CHAIN_BLOCKS];
+    uint32_t callbackData[SDCARD_SDIO_MAX_CHAIN_BLOCKS];
+} sdcardSdioWriteChain_t;
+
+static sdcardSdioWriteChain_t writeChain;
+
+static bool sdcardSdio_chainAppend(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData)
 {
-    if (cacheCount == sizeof(writeCache)) {
-        // Prevents overflow
-        return;
+    if (writeChain.count == 0) {
+        writeChain.buffer = buffer;
+        writeChain.blockIndex = blockIndex;
+    } else if (writeChain.count == SDCARD_SDIO_MAX_CHAIN_BLOCKS || buffer != writeChain.buffer + writeChain.count * SDCARD_BLOCK_SIZE) {
+        return false;
     }
-    memcpy(&writeCache[cacheCount], buffer, 512);
-    cacheCount += 512;
-}
 
-uint16_t cache_getCount(void)
-{
-    return (cacheCount / 512);
+    writeChain.callback[writeChain.count] = callback;
+    writeChain.callbackData[writeChain.count] = callbackData;
+    writeChain.count++;
+    writeChain.idlePolls = 0;
+
+    return true;
 }
 
-void cache_reset(void)
+/**
+ * Tell the callers that the blocks of the chain have been transmitted, or have been lost if success is false.
+ */
+static void sdcardSdio_chainComplete(bool success)
 {
-    cacheCount = 0;
+    const uint8_t count = writeChain.count;
+
+    writeChain.count = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (writeChain.callback[i]) {
+            writeChain.callback[i](SDCARD_BLOCK_OPERATION_WRITE, writeChain.blockIndex + i, success ? writeChain.buffer + i * SDCARD_BLOCK_SIZE : NULL, writeChain.callbackData[i]);
+        }
+    }
 }
 
 /**
@@ -85,6 +113,10 @@ static bool sdcardSdio_isFunctional(void)
  */
 static void sdcard_reset(void)
 {
+    // Whatever part of the chain the card hasn't confirmed yet is lost
+    writeChain.inFlight = false;
+    sdcardSdio_chainComplete(false);
+
     if (SD_Init() != 0) {
         sdcard.failureCount++;
         if (sdcard.failureCount >= SDCARD_MAX_CONSECUTIVE_FAILURES || !sdcard_isInserted()) {
@@ -267,11 +299,15 @@ static bool sdcard_isReady()
  *                                    the SDCARD_READY state.
  *
  */
+static sdcardOperationStatus_e sdcardSdio_chainDispatch(void);
+
 static sdcardOperationStatus_e sdcard_endWriteBlocks()
 {
     sdcard.multiWriteBlocksRemain = 0;
-    if (sdcard.useCache) {
-        cache_reset();
+
+    // Blocks held back in the chain still have to be written before we can leave the multi-block write
+    if (writeChain.count > 0 && !writeChain.inFlight) {
+        return sdcardSdio_chainDispatch();
     }
 
     // 8 dummy clocks to guarantee N_WR clocks between the last card response and this token
@@ -303,6 +339,11 @@ static bool sdcardSdio_poll(void)
     bool profilingComplete;
 #endif
 
+    // Don't keep the chain waiting if the caller has run out of blocks to add to it
+    if (sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS && writeChain.count > 0 && ++writeChain.idlePolls > 1) {
+        sdcardSdio_chainDispatch();
+    }
+
     doMore:
     switch (sdcard.state) {
         case SDCARD_STATE_RESET:
@@ -349,7 +390,9 @@ static bool sdcardSdio_poll(void)
                 sdcard.operationStartTime = millis();
 
                 // Since we've transmitted the buffer we can go ahead and tell the caller their operation is complete
-                if (sdcard.pendingOperation.callback) {
+                if (writeChain.inFlight) {
+                    sdcardSdio_chainComplete(true);
+                } else if (sdcard.pendingOperation.callback) {
                     sdcard.pendingOperation.callback(SDCARD_BLOCK_OPERATION_WRITE, sdcard.pendingOperation.blockIndex, sdcard.pendingOperation.buffer, sdcard.pendingOperation.callbackData);
                 }
             }
@@ -363,12 +406,13 @@ static bool sdcardSdio_poll(void)
                 sdcard.failureCount = 0; // Assume the card is good if it can complete a write
 
                 // Still more blocks left to write in a multi-block chain?
-                if (sdcard.multiWriteBlocksRemain > 1) {
+                if (writeChain.inFlight) {
+                    // The blocks of the chain were accounted for as they were added to it
+                    writeChain.inFlight = false;
+                    sdcard.state = sdcard.multiWriteBlocksRemain > 0 ? SDCARD_STATE_WRITING_MULTIPLE_BLOCKS : SDCARD_STATE_READY;
+                } else if (sdcard.multiWriteBlocksRemain > 1) {
                     sdcard.multiWriteBlocksRemain--;
                     sdcard.multiWriteNextBlock++;
-                    if (sdcard.useCache) {
-                        cache_reset();
-                    }
                     sdcard.state = SDCARD_STATE_WRITING_MULTIPLE_BLOCKS;
                 } else if (sdcard.multiWriteBlocksRemain == 1) {
                     // This function changes the sd card state for us whether immediately succesful or delayed:
@@ -495,33 +539,32 @@ static sdcardOperationStatus_e sdcardSdio_writeBlock(uint32_t blockIndex, uint8_
             return SDCARD_OPERATION_BUSY;
     }
 
-    sdcard.pendingOperation.buffer = buffer;
-    sdcard.pendingOperation.blockIndex = blockIndex;
+    if (sdcard.useCache && sdcard.multiWriteBlocksRemain > 0) {
+        if (!sdcardSdio_chainAppend(blockIndex, buffer, callback, callbackData)) {
+            // This buffer doesn't follow the chain in memory, send the chain first and take this block afterwards
+            sdcardSdio_chainDispatch();
+            return SDCARD_OPERATION_BUSY;
+        }
 
-    uint16_t block_count = 1;
-    if ((cache_getCount() < FATFS_BLOCK_CACHE_SIZE) &&
-        (sdcard.multiWriteBlocksRemain != 0) && sdcard.useCache) {
-        cache_write(buffer);
-        if (cache_getCount() == FATFS_BLOCK_CACHE_SIZE || sdcard.multiWriteBlocksRemain == 1) {
-            //Relocate buffer
-            buffer = (uint8_t*)writeCache;
-            //Recalculate block index
-            blockIndex -= cache_getCount() - 1;
-            block_count = cache_getCount();
-        } else {
-            sdcard.multiWriteBlocksRemain--;
-            sdcard.multiWriteNextBlock++;
-            sdcard.state = SDCARD_STATE_READY;
-            return SDCARD_OPERATION_SUCCESS;
+        sdcard.multiWriteBlocksRemain--;
+        sdcard.multiWriteNextBlock++;
+
+        if (sdcard.multiWriteBlocksRemain == 0 || writeChain.count == SDCARD_SDIO_MAX_CHAIN_BLOCKS) {
+            return sdcardSdio_chainDispatch();
         }
+
+        // There's a good chance that the next block follows this one, so hold the chain back until it arrives
+        return SDCARD_OPERATION_IN_PROGRESS;
     }
 
+    sdcard.pendingOperation.buffer = buffer;
+    sdcard.pendingOperation.blockIndex = blockIndex;
     sdcard.pendingOperation.callback = callback;
     sdcard.pendingOperation.callbackData = callbackData;
     sdcard.pendingOperation.chunkIndex = 1; // (for non-DMA transfers) we've sent chunk #0 already
     sdcard.state = SDCARD_STATE_SENDING_WRITE;
 
-    if (SD_WriteBlocks_DMA(blockIndex, (uint32_t*) buffer, 512, block_count) != SD_OK) {
+    if (SD_WriteBlocks_DMA(blockIndex, (uint32_t*) buffer, 512, 1) != SD_OK) {
         /* Our write was rejected! This could be due to a bad address but we hope not to attempt that, so assume
          * the card is broken and needs reset.
          */
@@ -537,6 +580,28 @@ static sdcardOperationStatus_e sdcardSdio_writeBlock(uint32_t blockIndex, uint8_
     return SDCARD_OPERATION_IN_PROGRESS;
 }
 
+/**
+ * Send all the blocks held back in the write chain to the card with a single DMA transfer.
+ */
+static sdcardOperationStatus_e sdcardSdio_chainDispatch(void)
+{
+    sdcard.pendingOperation.buffer = writeChain.buffer;
+    sdcard.pendingOperation.blockIndex = writeChain.blockIndex;
+    sdcard.pendingOperation.callback = NULL;
+    sdcard.state = SDCARD_STATE_SENDING_WRITE;
+
+    writeChain.inFlight = true;
+
+    if (SD_WriteBlocks_DMA(writeChain.blockIndex, (uint32_t*) writeChain.buffer, SDCARD_BLOCK_SIZE, writeChain.count) != SD_OK) {
+        // Announces the failure of the chain's blocks to their callers
+        sdcard_reset();
+
+        return SDCARD_OPERATION_FAILURE;
+    }
+
+    return SDCARD_OPERATION_IN_PROGRESS;
+}
+
 /**
  * Begin writing a series of consecutive blocks beginning at the given block index. This will allow (but not require)
  * the SD card to pre-erase the number of blocks you specifiy, which can allow the writes to complete faster.
@@ -654,6 +719,7 @@ sdcardVTable_t sdcardSdioVTable = {
     sdcardSdio_init,
     sdcardSdio_readBlock,
     sdcardSdio_beginWriteBlocks,
+    NULL,
     sdcardSdio_writeBlock,
     sdcardSdio_poll,
     sdcardSdio_isFunctional,
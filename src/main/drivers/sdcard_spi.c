@@ -105,6 +105,8 @@ static void sdcard_deselect(void)
  */
 static void sdcard_reset(void)
 {
+    sdcard.multiReadActive = false;
+
     if (!sdcard_isInserted()) {
         sdcard.state = SDCARD_STATE_NOT_PRESENT;
         return;
@@ -357,6 +359,8 @@ static void sdcard_sendDataBlockBegin(const uint8_t *buffer, bool multiBlockWrit
 
         init.NbData = SDCARD_BLOCK_SIZE;
 
+        dmaBufferClean(buffer, SDCARD_BLOCK_SIZE);
+
         LL_DMA_DeInit(sdcard.dma->dma, sdcard.dma->stream);
         LL_DMA_Init(sdcard.dma->dma, sdcard.dma->stream, &init);
 
@@ -588,7 +592,50 @@ static bool sdcard_setBlockLength(uint32_t blockLen)
  */
 static bool sdcard_isReady(void)
 {
-    return sdcard.state == SDCARD_STATE_READY || sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS;
+    return sdcard.state == SDCARD_STATE_READY || sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS
+        || sdcard.state == SDCARD_STATE_READING_MULTIPLE_BLOCKS;
+}
+
+/**
+ * Send the stop transmission command to end a multiple block read, and wait for the card to leave its busy state.
+ *
+ * Returns true if the card is in the SDCARD_STATE_READY state afterwards, otherwise the card has been reset.
+ */
+static bool sdcard_endReadBlocks(void)
+{
+    const uint8_t command[6] = { 0x40 | SDCARD_COMMAND_STOP_TRANSMISSION, 0, 0, 0, 0, 0x95 };
+
+    sdcard.multiReadActive = false;
+
+    // The card may be in the middle of sending us the next block, so don't wait for the bus to go idle first
+    spiBusRawTransfer(&sdcard.busdev, command, NULL, sizeof(command));
+
+    // Skip the stuff byte that follows the stop command, then find the R1 response (its top bit is clear)
+    spiBusTransferByte(&sdcard.busdev, 0xFF);
+
+    uint8_t status = 0xFF;
+    for (int i = 0; i < SDCARD_MAXIMUM_BYTE_DELAY_FOR_CMD_REPLY && (status & 0x80); i++) {
+        status = spiBusTransferByte(&sdcard.busdev, 0xFF);
+    }
+
+    // R1b, the card holds the bus low while it is busy
+    bool idle = false;
+    if (status == 0) {
+        const uint32_t startTime = millis();
+        do {
+            idle = sdcard_waitForIdle(SDCARD_MAXIMUM_BYTE_DELAY_FOR_CMD_REPLY);
+        } while (!idle && millis() <= startTime + SDCARD_TIMEOUT_READ_MSEC);
+    }
+
+    sdcard_deselect();
+
+    if (status != 0 || !idle) {
+        sdcard_reset();
+        return false;
+    }
+
+    sdcard.state = SDCARD_STATE_READY;
+    return true;
 }
 
 /**
@@ -853,9 +900,15 @@ static bool sdcardSpi_poll(void)
         case SDCARD_STATE_READING:
             switch (sdcard_receiveDataBlock(sdcard.pendingOperation.buffer, SDCARD_BLOCK_SIZE)) {
                 case SDCARD_RECEIVE_SUCCESS:
-                    sdcard_deselect();
+                    if (sdcard.multiReadActive) {
+                        // Leave the card selected, it carries on with the next block
+                        sdcard.multiReadNextBlock = sdcard.pendingOperation.blockIndex + 1;
+                        sdcard.state = SDCARD_STATE_READING_MULTIPLE_BLOCKS;
+                    } else {
+                        sdcard_deselect();
 
-                    sdcard.state = SDCARD_STATE_READY;
+                        sdcard.state = SDCARD_STATE_READY;
+                    }
                     sdcard.failureCount = 0; // Assume the card is good if it can complete a read
 
 #ifdef SDCARD_PROFILING
@@ -952,6 +1005,12 @@ static sdcardOperationStatus_e sdcardSpi_writeBlock(uint32_t blockIndex, uint8_t
 
     doMore:
     switch (sdcard.state) {
+        case SDCARD_STATE_READING_MULTIPLE_BLOCKS:
+            if (sdcard_endReadBlocks()) {
+                goto doMore;
+            } else {
+                return SDCARD_OPERATION_FAILURE;
+            }
         case SDCARD_STATE_WRITING_MULTIPLE_BLOCKS:
             // Do we need to cancel the previous multi-block write?
             if (blockIndex != sdcard.multiWriteNextBlock) {
@@ -1011,6 +1070,10 @@ static sdcardOperationStatus_e sdcardSpi_writeBlock(uint32_t blockIndex, uint8_t
  */
 static sdcardOperationStatus_e sdcardSpi_beginWriteBlocks(uint32_t blockIndex, uint32_t blockCount)
 {
+    if (sdcard.state == SDCARD_STATE_READING_MULTIPLE_BLOCKS && !sdcard_endReadBlocks()) {
+        return SDCARD_OPERATION_FAILURE;
+    }
+
     if (sdcard.state != SDCARD_STATE_READY) {
         if (sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS) {
             if (blockIndex == sdcard.multiWriteNextBlock) {
@@ -1045,6 +1108,57 @@ static sdcardOperationStatus_e sdcardSpi_beginWriteBlocks(uint32_t blockIndex, u
     }
 }
 
+/**
+ * Begin reading a series of consecutive blocks beginning at the given block index with a single multiple block read
+ * command. This saves the command and the card's access time for every block after the first.
+ *
+ * Afterwards, just call sdcard_readBlock() as normal to read those blocks in order. The card keeps sending blocks
+ * until you read a block out of sequence, or begin a write.
+ *
+ * Returns:
+ *     SDCARD_OPERATION_SUCCESS     - Multi-block read has been started
+ *     SDCARD_OPERATION_BUSY        - The card is already busy and cannot accept your read
+ *     SDCARD_OPERATION_FAILURE     - A fatal error occured, card will be reset
+ */
+static sdcardOperationStatus_e sdcardSpi_beginReadBlocks(uint32_t blockIndex)
+{
+    if (sdcard.state == SDCARD_STATE_READING_MULTIPLE_BLOCKS) {
+        if (blockIndex == sdcard.multiReadNextBlock) {
+            // Assume that the caller wants to continue the multi-block read they already have in progress!
+            return SDCARD_OPERATION_SUCCESS;
+        } else if (!sdcard_endReadBlocks()) {
+            return SDCARD_OPERATION_FAILURE;
+        }
+    }
+
+    if (sdcard.state != SDCARD_STATE_READY) {
+        if (sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS) {
+            if (sdcard_endWriteBlocks() != SDCARD_OPERATION_SUCCESS) {
+                return SDCARD_OPERATION_BUSY;
+            }
+        } else {
+            return SDCARD_OPERATION_BUSY;
+        }
+    }
+
+    sdcard_select();
+
+    if (sdcard_sendCommand(SDCARD_COMMAND_READ_MULTIPLE_BLOCK, sdcard.highCapacity ? blockIndex : blockIndex * SDCARD_BLOCK_SIZE) == 0) {
+        sdcard.state = SDCARD_STATE_READING_MULTIPLE_BLOCKS;
+        sdcard.multiReadActive = true;
+        sdcard.multiReadNextBlock = blockIndex;
+
+        // Leave the card selected
+        return SDCARD_OPERATION_SUCCESS;
+    } else {
+        sdcard_deselect();
+
+        sdcard_reset();
+
+        return SDCARD_OPERATION_FAILURE;
+    }
+}
+
 /**
  * Read the 512-byte block with the given index into the given 512-byte buffer.
  *
@@ -1059,6 +1173,26 @@ static sdcardOperationStatus_e sdcardSpi_beginWriteBlocks(uint32_t blockIndex, u
  */
 static bool sdcardSpi_readBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData)
 {
+    if (sdcard.state == SDCARD_STATE_READING_MULTIPLE_BLOCKS) {
+        if (blockIndex == sdcard.multiReadNextBlock) {
+#ifdef SDCARD_PROFILING
+            sdcard.pendingOperation.profileStartTime = micros();
+#endif
+            // The card is already sending us this block, so there's no command to send
+            sdcard.pendingOperation.buffer = buffer;
+            sdcard.pendingOperation.blockIndex = blockIndex;
+            sdcard.pendingOperation.callback = callback;
+            sdcard.pendingOperation.callbackData = callbackData;
+
+            sdcard.state = SDCARD_STATE_READING;
+            sdcard.operationStartTime = millis();
+
+            return true;
+        } else if (!sdcard_endReadBlocks()) {
+            return false;
+        }
+    }
+
     if (sdcard.state != SDCARD_STATE_READY) {
         if (sdcard.state == SDCARD_STATE_WRITING_MULTIPLE_BLOCKS) {
             if (sdcard_endWriteBlocks() != SDCARD_OPERATION_SUCCESS) {
@@ -1125,6 +1259,7 @@ sdcardVTable_t sdcardSpiVTable = {
     sdcardSpi_init,
     sdcardSpi_readBlock,
     sdcardSpi_beginWriteBlocks,
+    sdcardSpi_beginReadBlocks,
     sdcardSpi_writeBlock,
     sdcardSpi_poll,
     sdcardSpi_isFunctional,
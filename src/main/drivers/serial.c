@@ -74,6 +74,25 @@ uint8_t serialRead(serialPort_t *instance)
     return instance->vTable->serialRead(instance);
 }
 
+// Reads up to count of the bytes received, returns the number read
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count)
+{
+    const uint32_t waiting = serialRxBytesWaiting(instance);
+    if (count > waiting) {
+        count = waiting;
+    }
+
+    if (instance->vTable->readBuf) {
+        instance->vTable->readBuf(instance, data, count);
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            data[i] = serialRead(instance);
+        }
+    }
+
+    return count;
+}
+
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
 {
     instance->vTable->serialSetBaudRate(instance, baudRate);
@@ -123,3 +142,37 @@ void serialEndWrite(serialPort_t *instance)
     if (instance->vTable->endWrite)
         instance->vTable->endWrite(instance);
 }
+
+static uint8_t serialWriteReserveBuffer[SERIAL_WRITE_RESERVE_MAX];
+static bool serialWriteReserveBuffered;
+
+// Reserves count bytes to be written directly and sent by serialCommitWrite(), so that an encoder builds its
+// frame in place and the transmission is started once per frame. Falls back to a buffer that is copied with
+// serialWriteBuf() when the port cannot reserve, NULL only for more than SERIAL_WRITE_RESERVE_MAX bytes.
+// One reservation at a time, from task context.
+uint8_t *serialReserveWrite(serialPort_t *instance, uint32_t count)
+{
+    if (instance->vTable->reserveWrite) {
+        uint8_t *buf = instance->vTable->reserveWrite(instance, count);
+        if (buf) {
+            serialWriteReserveBuffered = false;
+            return buf;
+        }
+    }
+
+    if (count > sizeof(serialWriteReserveBuffer)) {
+        return NULL;
+    }
+    serialWriteReserveBuffered = true;
+    return serialWriteReserveBuffer;
+}
+
+// Sends the first count bytes of the last reservation, count must not exceed the reserved count
+void serialCommitWrite(serialPort_t *instance, uint32_t count)
+{
+    if (serialWriteReserveBuffered) {
+        serialWriteBuf(instance, serialWriteReserveBuffer, count);
+    } else {
+        instance->vTable->commitWrite(instance, count);
+    }
+}
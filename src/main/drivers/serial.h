@@ -126,13 +126,22 @@ struct serialPortVTable {
     // Optional functions used to buffer large writes.
     void (*beginWrite)(serialPort_t *instance);
     void (*endWrite)(serialPort_t *instance);
+    // Optional zero copy writes, returns count contiguous bytes of the transmit buffer or NULL if there are not enough.
+    uint8_t *(*reserveWrite)(serialPort_t *instance, uint32_t count);
+    void (*commitWrite)(serialPort_t *instance, uint32_t count);
+    // Optional block reads, count is at most the number of bytes waiting.
+    void (*readBuf)(serialPort_t *instance, uint8_t *data, uint32_t count);
 };
 
+// Largest reservation serialReserveWrite() can always satisfy, by buffering when the port cannot reserve directly
+#define SERIAL_WRITE_RESERVE_MAX 64
+
 void serialWrite(serialPort_t *instance, uint8_t ch);
 uint32_t serialRxBytesWaiting(const serialPort_t *instance);
 uint32_t serialTxBytesFree(const serialPort_t *instance);
 void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count);
 uint8_t serialRead(serialPort_t *instance);
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count);
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
 void serialSetMode(serialPort_t *instance, portMode_e mode);
 void serialSetCtrlLineStateCb(serialPort_t *instance, void (*cb)(void *context, uint16_t ctrlLineState), void *context);
@@ -145,3 +154,5 @@ uint32_t serialGetBaudRate(serialPort_t *instance);
 void serialWriteBufShim(void *instance, const uint8_t *data, int count);
 void serialBeginWrite(serialPort_t *instance);
 void serialEndWrite(serialPort_t *instance);
+uint8_t *serialReserveWrite(serialPort_t *instance, uint32_t count);
+void serialCommitWrite(serialPort_t *instance, uint32_t count);
@@ -69,6 +69,7 @@ typedef struct escSerial_s {
 
     IO_t rxIO;
     IO_t txIO;
+    ioGroup_t txGroup;
 
     const timerHardware_t *rxTimerHardware;
     volatile uint8_t rxBuffer[ESCSERIAL_BUFFER_SIZE];
@@ -145,33 +146,7 @@ static void TIM_DeInit(TIM_TypeDef *tim)
 
 static void setTxSignalEsc(escSerial_t *escSerial, uint8_t state)
 {
-    if (escSerial->mode == PROTOCOL_KISSALL)
-    {
-        for (volatile uint8_t i = 0; i < escSerial->outputCount; i++) {
-            uint8_t state_temp = state;
-            if (escOutputs[i].inverted) {
-                state_temp ^= ENABLE;
-            }
-
-            if (state_temp) {
-                IOHi(escOutputs[i].io);
-            } else {
-                IOLo(escOutputs[i].io);
-            }
-        }
-    }
-    else
-    {
-        if (escSerial->rxTimerHardware->output & TIMER_OUTPUT_INVERTED) {
-            state ^= ENABLE;
-        }
-
-        if (state) {
-            IOHi(escSerial->txIO);
-        } else {
-            IOLo(escSerial->txIO);
-        }
-    }
+    IOGroupWrite(&escSerial->txGroup, state);
 }
 
 static void escSerialGPIOConfig(const timerHardware_t *timhw, ioConfig_t cfg)
@@ -714,9 +689,12 @@ static serialPort_t *openEscSerial(const motorDevConfig_t *motorConfig, escSeria
 
     escSerial->escSerialPortIndex = portIndex;
 
+    IOGroupInit(&escSerial->txGroup);
+
     if (mode != PROTOCOL_KISSALL)
     {
         escSerial->txIO = IOGetByTag(escSerial->rxTimerHardware->tag);
+        IOGroupAdd(&escSerial->txGroup, escSerial->txIO, escSerial->rxTimerHardware->output & TIMER_OUTPUT_INVERTED);
         escSerialInputPortConfig(escSerial->rxTimerHardware);
         setTxSignalEsc(escSerial, ENABLE);
     }
@@ -752,6 +730,7 @@ static serialPort_t *openEscSerial(const motorDevConfig_t *motorConfig, escSeria
                         if (timerHardware->output & TIMER_OUTPUT_INVERTED) {
                             escOutputs[escSerial->outputCount].inverted = 1;
                         }
+                        IOGroupAdd(&escSerial->txGroup, pwmMotors[i].io, escOutputs[escSerial->outputCount].inverted);
                         escSerial->outputCount++;
                     }
                 }
@@ -866,7 +845,10 @@ const struct serialPortVTable escSerialVTable[] = {
         .setBaudRateCb = NULL,
         .writeBuf = NULL,
         .beginWrite = NULL,
-        .endWrite = NULL
+        .endWrite = NULL,
+        .reserveWrite = NULL,
+        .commitWrite = NULL,
+        .readBuf = NULL
     }
 };
 
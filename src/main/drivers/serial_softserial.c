@@ -21,6 +21,11 @@
 /*
  * Cleanflight (or Baseflight): original
  * jflyper: Mono-timer and single-wire half-duplex
+ *
+ * With USE_SOFTSERIAL_DMA a port whose timers and DMA streams allow it runs
+ * without per bit interrupts: the timer update DMA writes the transmitted
+ * bits as PWM duty cycles, and the received edges are captured by DMA into
+ * a ring of timestamps that is decoded when the port is polled.
  */
 
 #include <stdbool.h>
@@ -35,10 +40,15 @@
 
 #include "build/debug.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/nvic.h"
 #include "drivers/io.h"
+#ifdef USE_SOFTSERIAL_DMA
+#include "drivers/dma.h"
+#include "drivers/dma_reqmap.h"
+#endif
 #include "timer.h"
 
 #include "serial.h"
@@ -63,11 +73,19 @@ typedef enum {
 #define ICPOLARITY_RISING true
 #define ICPOLARITY_FALLING false
 
+#ifdef USE_SOFTSERIAL_DMA
+#define SOFTSERIAL_DMA_TX_BYTES     16
+#define SOFTSERIAL_DMA_TX_IDLE_BITS 2      // the preloaded duty cycle lags the DMA by a bit, the stop bit needs another
+#define SOFTSERIAL_DMA_RX_EDGES     128
+#define SOFTSERIAL_DMA_BIT_TICKS    64     // at least this many timer ticks per bit
+#endif
+
 typedef struct softSerial_s {
     serialPort_t     port;
 
     IO_t rxIO;
     IO_t txIO;
+    ioGroup_t txGroup;
 
     const timerHardware_t *timerHardware;
 #ifdef USE_HAL_DRIVER
@@ -98,6 +116,21 @@ typedef struct softSerial_s {
 
     timerOvrHandlerRec_t overCb;
     timerCCHandlerRec_t edgeCb;
+
+#ifdef USE_SOFTSERIAL_DMA
+    bool             useDma;
+    const timerHardware_t *txTimerHardware;
+    dmaResource_t    *txDmaRef;
+    dmaResource_t    *rxDmaRef;
+    uint16_t         txBitTicks;
+    uint16_t         rxBitTicks;
+    uint16_t         rxByteStart;
+    uint16_t         rxDmaTail;
+    uint8_t          rxLevel;
+
+    uint32_t         txDmaBuffer[SOFTSERIAL_DMA_TX_BYTES * TX_TOTAL_BITS + SOFTSERIAL_DMA_TX_IDLE_BITS];
+    volatile uint16_t rxDmaBuffer[SOFTSERIAL_DMA_RX_EDGES];
+#endif
 } softSerial_t;
 
 static const struct serialPortVTable softSerialVTable; // Forward
@@ -109,15 +142,7 @@ void onSerialRxPinChange(timerCCHandlerRec_t *cbRec, captureCompare_t capture);
 
 static void setTxSignal(softSerial_t *softSerial, uint8_t state)
 {
-    if (softSerial->port.options & SERIAL_INVERTED) {
-        state = !state;
-    }
-
-    if (state) {
-        IOHi(softSerial->txIO);
-    } else {
-        IOLo(softSerial->txIO);
-    }
+    IOGroupWrite(&softSerial->txGroup, state);
 }
 
 static void serialEnableCC(softSerial_t *softSerial)
@@ -233,6 +258,331 @@ static void resetBuffers(softSerial_t *softSerial)
     softSerial->port.txBufferHead = 0;
 }
 
+#ifdef USE_SOFTSERIAL_DMA
+// The bit clock of a DMA port is prescaled to 64 to 127 ticks per bit. That
+// places the received edges precisely enough, and the 16 bit capture counter
+// still spans 512 bits, the longest a port may go unpolled while receiving.
+static uint32_t softSerialDmaTimerHz(const timerHardware_t *timerHardware, uint32_t baud)
+{
+    const uint32_t clock = timerClock(timerHardware->tim);
+
+    return clock / MAX(clock / (baud * SOFTSERIAL_DMA_BIT_TICKS), 1U);
+}
+
+// Single wire ports turn the one timer channel around between capture and PWM
+static bool softSerialDmaIsHalfDuplex(const softSerial_t *softSerial)
+{
+    return softSerial->rxDmaRef && softSerial->txTimerHardware == softSerial->timerHardware;
+}
+
+static void softSerialDmaConfigureTimebase(softSerial_t *softSerial, uint32_t baud)
+{
+    if (softSerial->rxDmaRef) {
+        // The receiver captures on a free running counter, a transmitter on the same timer sets its own period
+        const uint32_t hz = softSerialDmaTimerHz(softSerial->timerHardware, baud);
+        softSerial->rxBitTicks = (hz + baud / 2) / baud;
+        configTimeBase(softSerial->timerHardware->tim, 0, hz);
+        TIM_Cmd(softSerial->timerHardware->tim, ENABLE);
+    }
+
+    if (softSerial->txDmaRef) {
+        const uint32_t hz = softSerialDmaTimerHz(softSerial->txTimerHardware, baud);
+        softSerial->txBitTicks = (hz + baud / 2) / baud;
+        if (!softSerialDmaIsHalfDuplex(softSerial)) {
+            configTimeBase(softSerial->txTimerHardware->tim, softSerial->txBitTicks, hz);
+            TIM_Cmd(softSerial->txTimerHardware->tim, ENABLE);
+        }
+    }
+}
+
+// The transmitter drives the pin with PWM, a duty cycle of 0 for a space and
+// beyond the period for a mark, so the line holds its level for whole bits
+static void softSerialDmaOutputActivate(softSerial_t *softSerial)
+{
+    const timerHardware_t *timerHardware = softSerial->txTimerHardware;
+    TIM_TypeDef *tim = timerHardware->tim;
+    TIM_OCInitTypeDef ocInit;
+
+    TIM_OCStructInit(&ocInit);
+    ocInit.TIM_OCMode = TIM_OCMode_PWM1;
+    ocInit.TIM_OutputState = TIM_OutputState_Enable;
+    ocInit.TIM_OCPolarity = (softSerial->port.options & SERIAL_INVERTED) ? TIM_OCPolarity_Low : TIM_OCPolarity_High;
+    ocInit.TIM_Pulse = softSerial->txBitTicks;
+
+    timerOCInit(tim, timerHardware->channel, &ocInit);
+    timerOCPreloadConfig(tim, timerHardware->channel, TIM_OCPreload_Enable);
+    TIM_SetAutoreload(tim, softSerial->txBitTicks - 1);
+    TIM_GenerateEvent(tim, TIM_EventSource_Update);
+    TIM_CtrlPWMOutputs(tim, ENABLE);
+
+    IOConfigGPIOAF(softSerial->txIO, IOCFG_AF_PP, timerHardware->alternateFunction);
+}
+
+static void softSerialDmaInputActivate(softSerial_t *softSerial)
+{
+    const timerHardware_t *timerHardware = softSerial->timerHardware;
+    TIM_TypeDef *tim = timerHardware->tim;
+    TIM_ICInitTypeDef icInit;
+
+    if (softSerial->port.options & SERIAL_INVERTED) {
+        IOConfigGPIOAF(softSerial->rxIO, (softSerial->port.options & SERIAL_BIDIR_NOPULL) ? IOCFG_AF_PP : IOCFG_AF_PP_PD, timerHardware->alternateFunction);
+    } else {
+        IOConfigGPIOAF(softSerial->rxIO, (softSerial->port.options & SERIAL_BIDIR_NOPULL) ? IOCFG_AF_PP : IOCFG_AF_PP_UP, timerHardware->alternateFunction);
+    }
+
+    TIM_ICStructInit(&icInit);
+    icInit.TIM_Channel = timerHardware->channel;
+    icInit.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    icInit.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInit(tim, &icInit);
+    TIM_SetAutoreload(tim, 0xFFFF);
+
+    // Edges captured while transmitting are the port's own echo
+    softSerial->rxDmaTail = SOFTSERIAL_DMA_RX_EDGES - xDMA_GetCurrDataCounter(softSerial->rxDmaRef);
+    softSerial->isSearchingForStartBit = true;
+    softSerial->rxActive = true;
+
+    TIM_DMACmd(tim, timerDmaSource(timerHardware->channel), ENABLE);
+}
+
+// Called with the transmit DMA idle, from the task writing or the transfer complete interrupt
+static void softSerialDmaStartTx(softSerial_t *softSerial)
+{
+    serialPort_t *port = &softSerial->port;
+
+    if (isSoftSerialTransmitBufferEmpty(port)) {
+        if (softSerialDmaIsHalfDuplex(softSerial)) {
+            TIM_DMACmd(softSerial->timerHardware->tim, TIM_DMA_Update, DISABLE);
+            softSerialDmaInputActivate(softSerial);
+        }
+        return;
+    }
+
+    const uint32_t mark = softSerial->txBitTicks;
+    uint32_t *duty = softSerial->txDmaBuffer;
+
+    for (int i = 0; i < SOFTSERIAL_DMA_TX_BYTES && !isSoftSerialTransmitBufferEmpty(port); i++) {
+        // Stop bit (1) + data bits (MSB to LSB) + start bit (0), sent LSB first
+        const uint16_t frame = (1 << (TX_TOTAL_BITS - 1)) | (port->txBuffer[port->txBufferTail] << 1);
+        port->txBufferTail = (port->txBufferTail + 1) % port->txBufferSize;
+
+        for (int bit = 0; bit < TX_TOTAL_BITS; bit++) {
+            *duty++ = (frame & (1 << bit)) ? mark : 0;
+        }
+    }
+    for (int i = 0; i < SOFTSERIAL_DMA_TX_IDLE_BITS; i++) {
+        *duty++ = mark;
+    }
+
+    if (softSerial->rxActive && softSerialDmaIsHalfDuplex(softSerial)) {
+        TIM_DMACmd(softSerial->timerHardware->tim, timerDmaSource(softSerial->timerHardware->channel), DISABLE);
+        softSerial->rxActive = false;
+        softSerialDmaOutputActivate(softSerial);
+    }
+
+    softSerial->isTransmittingData = true;
+
+    xDMA_SetCurrDataCounter(softSerial->txDmaRef, duty - softSerial->txDmaBuffer);
+    xDMA_Cmd(softSerial->txDmaRef, ENABLE);
+    TIM_DMACmd(softSerial->txTimerHardware->tim, TIM_DMA_Update, ENABLE);
+}
+
+static void softSerialDmaTxComplete(dmaChannelDescriptor_t *descriptor)
+{
+    softSerial_t *softSerial = (softSerial_t *)descriptor->userParam;
+
+    DMA_CLEAR_FLAG(descriptor, (DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF));
+    TIM_DMACmd(softSerial->txTimerHardware->tim, TIM_DMA_Update, DISABLE);
+
+    softSerial->isTransmittingData = false;
+    softSerialDmaStartTx(softSerial);
+}
+
+static void softSerialDmaStoreRxByte(softSerial_t *softSerial)
+{
+    const uint16_t frame = softSerial->internalRxBuffer;
+
+    softSerial->isSearchingForStartBit = true;
+
+    if ((frame & (1 << 0)) || !(frame & (1 << (RX_TOTAL_BITS - 1)))) {
+        softSerial->receiveErrors++;
+        return;
+    }
+
+    softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = (frame >> 1) & 0xFF;
+    softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
+}
+
+// The bits up to an edge, or the end of the frame, hold the level since the previous edge
+static void softSerialDmaFillRxBits(softSerial_t *softSerial, unsigned bitIndex)
+{
+    bitIndex = MIN(bitIndex, (unsigned)RX_TOTAL_BITS);
+
+    if (softSerial->rxLevel && bitIndex > softSerial->rxBitIndex) {
+        softSerial->internalRxBuffer |= ((1 << bitIndex) - 1) & ~((1 << softSerial->rxBitIndex) - 1);
+    }
+    softSerial->rxBitIndex = MAX(bitIndex, softSerial->rxBitIndex);
+}
+
+// Both edges are captured, so each one flips the level. Out of a frame the line idles at mark, the next edge is a start bit.
+static void softSerialDmaRxEdge(softSerial_t *softSerial, uint16_t capture)
+{
+    if (!softSerial->isSearchingForStartBit) {
+        const uint16_t elapsed = capture - softSerial->rxByteStart;
+        softSerialDmaFillRxBits(softSerial, (elapsed + softSerial->rxBitTicks / 2) / softSerial->rxBitTicks);
+        softSerial->rxLevel = !softSerial->rxLevel;
+
+        if (softSerial->rxBitIndex < RX_TOTAL_BITS) {
+            return;
+        }
+
+        softSerialDmaStoreRxByte(softSerial);
+        if (softSerial->rxLevel) {
+            return;
+        }
+    }
+
+    softSerial->isSearchingForStartBit = false;
+    softSerial->rxByteStart = capture;
+    softSerial->rxBitIndex = 0;
+    softSerial->rxLevel = 0;
+    softSerial->internalRxBuffer = 0;
+}
+
+static void softSerialDmaRxPoll(softSerial_t *softSerial)
+{
+    // The counter is read first, every edge before this instant is then in the ring
+    const uint16_t now = softSerial->timerHardware->tim->CNT;
+    const uint16_t head = SOFTSERIAL_DMA_RX_EDGES - xDMA_GetCurrDataCounter(softSerial->rxDmaRef);
+
+    while (softSerial->rxDmaTail != head) {
+        softSerialDmaRxEdge(softSerial, softSerial->rxDmaBuffer[softSerial->rxDmaTail]);
+        softSerial->rxDmaTail = (softSerial->rxDmaTail + 1) % SOFTSERIAL_DMA_RX_EDGES;
+    }
+
+    // A frame ending in marks has no closing edge, it is complete once the middle of the stop bit has passed
+    if (!softSerial->isSearchingForStartBit && (uint16_t)(now - softSerial->rxByteStart) >= softSerial->rxBitTicks * (2 * RX_TOTAL_BITS - 1) / 2) {
+        softSerialDmaFillRxBits(softSerial, RX_TOTAL_BITS);
+        softSerialDmaStoreRxByte(softSerial);
+    }
+}
+
+static bool softSerialDmaIsFree(const dmaResource_t *dmaRef)
+{
+    return dmaRef && dmaGetOwner(dmaGetIdentifier(dmaRef))->owner == OWNER_FREE;
+}
+
+// Sets the port up for DMA when its timers and streams allow it, otherwise leaves it to the interrupt driven engine
+static bool softSerialDmaInit(softSerial_t *softSerial)
+{
+    const portMode_e mode = softSerial->port.mode;
+    const bool bidir = softSerial->port.options & SERIAL_BIDIR;
+    const timerHardware_t *txTimerHardware = NULL;
+    dmaResource_t *txDmaRef = NULL;
+    dmaResource_t *rxDmaRef = NULL;
+    uint32_t rxDmaChannel = 0;
+
+    if (mode & MODE_TX) {
+        if (bidir || !(mode & MODE_RX)) {
+            txTimerHardware = softSerial->timerHardware;
+        } else if (softSerial->exTimerHardware && softSerial->exTimerHardware->tim != softSerial->timerHardware->tim) {
+            txTimerHardware = softSerial->exTimerHardware;
+        } else {
+            // The transmit bit clock would stop the free running counter the receiver captures on
+            return false;
+        }
+
+        if ((txTimerHardware->output & TIMER_OUTPUT_N_CHANNEL) || !softSerialDmaIsFree(txTimerHardware->dmaTimUPRef)) {
+            return false;
+        }
+        txDmaRef = txTimerHardware->dmaTimUPRef;
+    }
+
+    if (mode & MODE_RX) {
+        // Bytes are only decoded when the port is polled, a receive callback needs the edge interrupts
+        if (softSerial->port.rxCallback) {
+            return false;
+        }
+
+        const dmaChannelSpec_t *dmaSpec = dmaGetChannelSpecByTimer(softSerial->timerHardware);
+        if (!dmaSpec || !softSerialDmaIsFree(dmaSpec->ref) || dmaSpec->ref == txDmaRef) {
+            return false;
+        }
+        rxDmaRef = dmaSpec->ref;
+        rxDmaChannel = dmaSpec->channel;
+    }
+
+    const uint8_t resourceIndex = RESOURCE_INDEX(softSerial->softSerialPortIndex + RESOURCE_SOFT_OFFSET);
+    DMA_InitTypeDef dmaInitStruct;
+
+    softSerial->useDma = true;
+    softSerial->txTimerHardware = txTimerHardware;
+    softSerial->txDmaRef = txDmaRef;
+    softSerial->rxDmaRef = rxDmaRef;
+
+    timerChConfigCallbacks(softSerial->timerHardware, NULL, NULL);
+    if (softSerial->exTimerHardware) {
+        timerChConfigCallbacks(softSerial->exTimerHardware, NULL, NULL);
+    }
+    softSerialDmaConfigureTimebase(softSerial, softSerial->port.baudRate);
+
+    if (rxDmaRef) {
+        dmaInit(dmaGetIdentifier(rxDmaRef), OWNER_SERIAL_RX, resourceIndex);
+
+        DMA_StructInit(&dmaInitStruct);
+        dmaInitStruct.DMA_Channel = rxDmaChannel;
+        dmaInitStruct.DMA_PeripheralBaseAddr = (uint32_t)timerChCCR(softSerial->timerHardware);
+        dmaInitStruct.DMA_Memory0BaseAddr = (uint32_t)softSerial->rxDmaBuffer;
+        dmaInitStruct.DMA_DIR = DMA_DIR_PeripheralToMemory;
+        dmaInitStruct.DMA_BufferSize = SOFTSERIAL_DMA_RX_EDGES;
+        dmaInitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+        dmaInitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+        dmaInitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+        dmaInitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+        dmaInitStruct.DMA_Mode = DMA_Mode_Circular;
+        dmaInitStruct.DMA_Priority = DMA_Priority_Medium;
+
+        xDMA_Cmd(rxDmaRef, DISABLE);
+        xDMA_DeInit(rxDmaRef);
+        xDMA_Init(rxDmaRef, &dmaInitStruct);
+        xDMA_Cmd(rxDmaRef, ENABLE);
+    }
+
+    if (txDmaRef) {
+        const dmaIdentifier_e dmaIdentifier = dmaGetIdentifier(txDmaRef);
+        dmaInit(dmaIdentifier, OWNER_SERIAL_TX, resourceIndex);
+
+        DMA_StructInit(&dmaInitStruct);
+        dmaInitStruct.DMA_Channel = txTimerHardware->dmaTimUPChannel;
+        dmaInitStruct.DMA_PeripheralBaseAddr = (uint32_t)timerChCCR(txTimerHardware);
+        dmaInitStruct.DMA_Memory0BaseAddr = (uint32_t)softSerial->txDmaBuffer;
+        dmaInitStruct.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+        dmaInitStruct.DMA_BufferSize = ARRAYLEN(softSerial->txDmaBuffer);
+        dmaInitStruct.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+        dmaInitStruct.DMA_MemoryInc = DMA_MemoryInc_Enable;
+        dmaInitStruct.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+        dmaInitStruct.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+        dmaInitStruct.DMA_Mode = DMA_Mode_Normal;
+        dmaInitStruct.DMA_Priority = DMA_Priority_High;
+
+        xDMA_Cmd(txDmaRef, DISABLE);
+        xDMA_DeInit(txDmaRef);
+        xDMA_Init(txDmaRef, &dmaInitStruct);
+        xDMA_ITConfig(txDmaRef, DMA_IT_TC, ENABLE);
+        dmaSetHandler(dmaIdentifier, softSerialDmaTxComplete, NVIC_PRIO_TIMER, (uint32_t)softSerial);
+    }
+
+    if (txDmaRef && !softSerialDmaIsHalfDuplex(softSerial)) {
+        softSerialDmaOutputActivate(softSerial);
+    }
+    if (rxDmaRef) {
+        softSerialDmaInputActivate(softSerial);
+    }
+
+    return true;
+}
+#endif
+
 serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr rxCallback, void *rxCallbackData, uint32_t baud, portMode_e mode, portOptions_e options)
 {
     softSerial_t *softSerial = &(softSerialPorts[portIndex]);
@@ -301,6 +651,9 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     softSerial->port.rxCallback = rxCallback;
     softSerial->port.rxCallbackData = rxCallbackData;
 
+    IOGroupInit(&softSerial->txGroup);
+    IOGroupAdd(&softSerial->txGroup, softSerial->txIO, options & SERIAL_INVERTED);
+
     resetBuffers(softSerial);
 
     softSerial->softSerialPortIndex = portIndex;
@@ -311,6 +664,16 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     softSerial->rxActive = false;
     softSerial->isTransmittingData = false;
 
+#ifdef USE_SOFTSERIAL_DMA
+    softSerial->useDma = false;
+    softSerial->txDmaRef = NULL;
+    softSerial->rxDmaRef = NULL;
+
+    if (softSerialDmaInit(softSerial)) {
+        return &softSerial->port;
+    }
+#endif
+
     // Configure master timer (on RX); time base and input capture
 
     serialTimerConfigureTimebase(softSerial->timerHardware, baud);
@@ -570,6 +933,12 @@ uint32_t softSerialRxBytesWaiting(const serialPort_t *instance)
 
     softSerial_t *s = (softSerial_t *)instance;
 
+#ifdef USE_SOFTSERIAL_DMA
+    if (s->rxDmaRef && s->rxActive) {
+        softSerialDmaRxPoll(s);
+    }
+#endif
+
     return (s->port.rxBufferHead - s->port.rxBufferTail) & (s->port.rxBufferSize - 1);
 }
 
@@ -611,6 +980,18 @@ void softSerialWriteByte(serialPort_t *s, uint8_t ch)
 
     s->txBuffer[s->txBufferHead] = ch;
     s->txBufferHead = (s->txBufferHead + 1) % s->txBufferSize;
+
+#ifdef USE_SOFTSERIAL_DMA
+    softSerial_t *softSerial = (softSerial_t *)s;
+
+    if (softSerial->txDmaRef) {
+        ATOMIC_BLOCK(NVIC_PRIO_TIMER) {
+            if (!softSerial->isTransmittingData) {
+                softSerialDmaStartTx(softSerial);
+            }
+        }
+    }
+#endif
 }
 
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
@@ -619,6 +1000,16 @@ void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
 
     softSerial->port.baudRate = baudRate;
 
+#ifdef USE_SOFTSERIAL_DMA
+    if (softSerial->useDma) {
+        softSerialDmaConfigureTimebase(softSerial, baudRate);
+        if (softSerialDmaIsHalfDuplex(softSerial) && !softSerial->rxActive) {
+            TIM_SetAutoreload(softSerial->txTimerHardware->tim, softSerial->txBitTicks - 1);
+        }
+        return;
+    }
+#endif
+
     serialTimerConfigureTimebase(softSerial->timerHardware, baudRate);
 }
 
@@ -644,7 +1035,10 @@ static const struct serialPortVTable softSerialVTable = {
     .setBaudRateCb = NULL,
     .writeBuf = NULL,
     .beginWrite = NULL,
-    .endWrite = NULL
+    .endWrite = NULL,
+    .reserveWrite = NULL,
+    .commitWrite = NULL,
+    .readBuf = NULL
 };
 
 #endif
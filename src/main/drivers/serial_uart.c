@@ -27,16 +27,21 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
 #ifdef USE_UART
 
+#include "build/atomic.h"
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/dma.h"
+#include "drivers/irq_load.h"
+#include "drivers/nvic.h"
 #include "drivers/rcc.h"
 
 #include "drivers/serial.h"
@@ -57,7 +62,7 @@ serialPort_t *uartOpen(UARTDevice_e device, serialReceiveCallbackPtr rxCallback,
     // common serial initialisation code should move to serialPort::init()
     s->port.rxBufferHead = s->port.rxBufferTail = 0;
     s->port.txBufferHead = s->port.txBufferTail = 0;
-    // callback works for IRQ-based RX ONLY
+    // with RX DMA the callback is fed from the idle line and DMA interrupts, see uartRxDMADeliver()
     s->port.rxCallback = rxCallback;
     s->port.rxCallbackData = rxCallbackData;
     s->port.mode = mode;
@@ -83,24 +88,32 @@ static void uartSetMode(serialPort_t *instance, portMode_e mode)
     uartReconfigure(uartPort);
 }
 
+#ifdef USE_DMA
+static uint32_t uartRxDMABytesWaiting(const uartPort_t *s)
+{
+    // XXX Could be consolidated
+#ifdef USE_HAL_DRIVER
+    uint32_t rxDMAHead = __HAL_DMA_GET_COUNTER(s->Handle.hdmarx);
+#else
+    uint32_t rxDMAHead = xDMA_GetCurrDataCounter(s->rxDMAResource);
+#endif
+
+    // s->rxDMAPos and rxDMAHead are distances from the end of the buffer, they count down as they advance
+    if (s->rxDMAPos >= rxDMAHead) {
+        return s->rxDMAPos - rxDMAHead;
+    } else {
+        return s->port.rxBufferSize + s->rxDMAPos - rxDMAHead;
+    }
+}
+#endif
+
 static uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance)
 {
     const uartPort_t *s = (const uartPort_t*)instance;
 
 #ifdef USE_DMA
     if (s->rxDMAResource) {
-        // XXX Could be consolidated
-#ifdef USE_HAL_DRIVER
-        uint32_t rxDMAHead = __HAL_DMA_GET_COUNTER(s->Handle.hdmarx);
-#else
-        uint32_t rxDMAHead = xDMA_GetCurrDataCounter(s->rxDMAResource);
-#endif
-
-        if (rxDMAHead >= s->rxDMAPos) {
-            return rxDMAHead - s->rxDMAPos;
-        } else {
-            return s->port.rxBufferSize + rxDMAHead - s->rxDMAPos;
-        }
+        return uartRxDMABytesWaiting(s);
     }
 #endif
 
@@ -189,18 +202,54 @@ static uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
-static void uartWrite(serialPort_t *instance, uint8_t ch)
+// Copies in at most two runs around the end of the buffer
+static void uartReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count)
 {
     uartPort_t *s = (uartPort_t *)instance;
 
-    s->port.txBuffer[s->port.txBufferHead] = ch;
+    while (count) {
+#ifdef USE_DMA
+        if (s->rxDMAResource) {
+            const uint32_t length = MIN(count, s->rxDMAPos);
+            memcpy(data, (uint8_t *)&s->port.rxBuffer[s->port.rxBufferSize - s->rxDMAPos], length);
+            s->rxDMAPos -= length;
+            if (s->rxDMAPos == 0) {
+                s->rxDMAPos = s->port.rxBufferSize;
+            }
+            data += length;
+            count -= length;
+        } else
+#endif
+        {
+            const uint32_t length = MIN(count, s->port.rxBufferSize - s->port.rxBufferTail);
+            memcpy(data, (uint8_t *)&s->port.rxBuffer[s->port.rxBufferTail], length);
+            const uint32_t tail = s->port.rxBufferTail + length;
+            s->port.rxBufferTail = tail >= s->port.rxBufferSize ? 0 : tail;
+            data += length;
+            count -= length;
+        }
+    }
+}
 
-    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
-        s->port.txBufferHead = 0;
-    } else {
-        s->port.txBufferHead++;
+#ifdef USE_DMA
+// Passes everything the circular RX DMA has received since the last call to the receive callback.
+// Called from the idle line interrupt at the end of each frame and from the DMA half and full
+// transfer interrupts during longer bursts, both at the RX priority of the port so they do not
+// preempt each other. A frame costs one or two interrupts instead of one per byte.
+void uartRxDMADeliver(uartPort_t *s)
+{
+    if (!s->port.rxCallback) {
+        return;
     }
 
+    for (uint32_t count = uartRxDMABytesWaiting(s); count; count--) {
+        s->port.rxCallback(uartRead(&s->port), s->port.rxCallbackData);
+    }
+}
+#endif
+
+static void uartStartTx(uartPort_t *s)
+{
 #ifdef USE_DMA
     if (s->txDMAResource) {
         uartTryStartTxDMA(s);
@@ -215,6 +264,96 @@ static void uartWrite(serialPort_t *instance, uint8_t ch)
     }
 }
 
+static void uartWrite(serialPort_t *instance, uint8_t ch)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    s->port.txBuffer[s->port.txBufferHead] = ch;
+
+    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
+        s->port.txBufferHead = 0;
+    } else {
+        s->port.txBufferHead++;
+    }
+
+    uartStartTx(s);
+}
+
+// Free space of the transmit buffer that follows the head without wrapping
+static uint32_t uartTxContiguousFree(const uartPort_t *s)
+{
+    uint32_t tail;
+
+#ifdef USE_DMA
+    if (s->txDMAResource) {
+        // The tail is advanced when a DMA transfer is queued, the bytes still to be sent end at the tail.
+        // Read both together, the DMA interrupt can queue the next transfer in between.
+        ATOMIC_BLOCK(NVIC_PRIO_SERIALUART_TXDMA) {
+#ifdef USE_HAL_DRIVER
+            const uint32_t inFlight = __HAL_DMA_GET_COUNTER(s->Handle.hdmatx);
+#else
+            const uint32_t inFlight = xDMA_GetCurrDataCounter(s->txDMAResource);
+#endif
+            tail = (s->port.txBufferTail + s->port.txBufferSize - inFlight) % s->port.txBufferSize;
+        }
+    } else
+#endif
+    {
+        tail = s->port.txBufferTail;
+    }
+
+    const uint32_t head = s->port.txBufferHead;
+    // one byte is kept free to tell a full buffer from an empty one
+    if (tail > head) {
+        return tail - head - 1;
+    } else {
+        return s->port.txBufferSize - head - (tail == 0 ? 1 : 0);
+    }
+}
+
+static uint8_t *uartReserveWrite(serialPort_t *instance, uint32_t count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    if (uartTxContiguousFree(s) < count) {
+        return NULL;
+    }
+    return (uint8_t *)&s->port.txBuffer[s->port.txBufferHead];
+}
+
+static void uartAdvanceTxHead(uartPort_t *s, uint32_t count)
+{
+    const uint32_t head = s->port.txBufferHead + count;
+    s->port.txBufferHead = head >= s->port.txBufferSize ? head - s->port.txBufferSize : head;
+}
+
+static void uartCommitWrite(serialPort_t *instance, uint32_t count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    uartAdvanceTxHead(s, count);
+    uartStartTx(s);
+}
+
+// Copies in at most two runs around the end of the buffer and starts the transmission once per run,
+// blocks like the byte by byte fallback of serialWriteBuf() while the buffer is full
+static void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        const uint32_t length = MIN(uartTxContiguousFree(s), (uint32_t)count);
+        if (length) {
+            memcpy((uint8_t *)&s->port.txBuffer[s->port.txBufferHead], p, length);
+            uartAdvanceTxHead(s, length);
+            p += length;
+            count -= length;
+        }
+        uartStartTx(s);
+    }
+}
+
 const struct serialPortVTable uartVTable[] = {
     {
         .serialWrite = uartWrite,
@@ -226,17 +365,22 @@ const struct serialPortVTable uartVTable[] = {
         .setMode = uartSetMode,
         .setCtrlLineStateCb = NULL,
         .setBaudRateCb = NULL,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
         .beginWrite = NULL,
         .endWrite = NULL,
+        .reserveWrite = uartReserveWrite,
+        .commitWrite = uartCommitWrite,
+        .readBuf = uartReadBuf,
     }
 };
 
 #define UART_IRQHandler(type, dev)                            \
     void type ## dev ## _IRQHandler(void)                     \
     {                                                         \
+        IRQ_LOAD_ENTER(IRQ_LOAD_UART);                        \
         uartPort_t *s = &(uartDevmap[UARTDEV_ ## dev]->port); \
         uartIrqHandler(s);                                    \
+        IRQ_LOAD_EXIT(IRQ_LOAD_UART);                         \
     }
 
 #ifdef USE_UART1
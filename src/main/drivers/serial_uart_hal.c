@@ -111,7 +111,7 @@ void uartReconfigure(uartPort_t *uartPort)
 #if !defined(STM32H7)
             uartPort->rxDMAHandle.Init.Channel = uartPort->rxDMAChannel;
 #else 
-            uartPort->txDMAHandle.Init.Request = uartPort->rxDMARequest;
+            uartPort->rxDMAHandle.Init.Request = uartPort->rxDMARequest;
 #endif
             uartPort->rxDMAHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
             uartPort->rxDMAHandle.Init.PeriphInc = DMA_PINC_DISABLE;
@@ -134,6 +134,12 @@ void uartReconfigure(uartPort_t *uartPort)
             HAL_UART_Receive_DMA(&uartPort->Handle, (uint8_t*)uartPort->port.rxBuffer, uartPort->port.rxBufferSize);
 
             uartPort->rxDMAPos = __HAL_DMA_GET_COUNTER(&uartPort->rxDMAHandle);
+
+            if (uartPort->port.rxCallback) {
+                // the received bytes are delivered at the end of each frame by the idle line interrupt, and
+                // every half buffer for longer bursts by the DMA interrupts HAL_UART_Receive_DMA() enabled
+                SET_BIT(uartPort->USARTx->CR1, USART_CR1_IDLEIE);
+            }
         } else
 #endif
         {
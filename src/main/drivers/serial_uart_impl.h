@@ -203,6 +203,7 @@ extern uartDevice_t *uartDevmap[];
 extern const struct serialPortVTable uartVTable[];
 
 void uartTryStartTxDMA(uartPort_t *s);
+void uartRxDMADeliver(uartPort_t *s);
 
 uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode, portOptions_e options);
 
@@ -150,6 +150,13 @@ void uartReconfigure(uartPort_t *uartPort)
             xDMA_Cmd(uartPort->rxDMAResource, ENABLE);
             USART_DMACmd(uartPort->USARTx, USART_DMAReq_Rx, ENABLE);
             uartPort->rxDMAPos = xDMA_GetCurrDataCounter(uartPort->rxDMAResource);
+#ifdef STM32F4
+            if (uartPort->port.rxCallback) {
+                // the received bytes are delivered at the end of each frame, and every half buffer for longer bursts
+                xDMA_ITConfig(uartPort->rxDMAResource, DMA_IT_HT | DMA_IT_TC, ENABLE);
+                USART_ITConfig(uartPort->USARTx, USART_IT_IDLE, ENABLE);
+            }
+#endif
         } else {
             USART_ClearITPendingBit(uartPort->USARTx, USART_IT_RXNE);
             USART_ITConfig(uartPort->USARTx, USART_IT_RXNE, ENABLE);
@@ -215,6 +215,18 @@ void dmaIRQHandler(dmaChannelDescriptor_t* descriptor)
     }
 }
 
+static void uartRxDmaIrqHandler(dmaChannelDescriptor_t* descriptor)
+{
+    uartPort_t *s = &(((uartDevice_t*)(descriptor->userParam))->port);
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+    }
+    uartRxDMADeliver(s);
+}
+
 // XXX Should serialUART be consolidated?
 
 uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode, portOptions_e options)
@@ -239,7 +251,10 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
     s->USARTx = hardware->reg;
 
     if (hardware->rxDMAResource) {
-        dmaInit(dmaGetIdentifier(hardware->rxDMAResource), OWNER_SERIAL_RX, RESOURCE_INDEX(device));
+        const dmaIdentifier_e identifier = dmaGetIdentifier(hardware->rxDMAResource);
+        dmaInit(identifier, OWNER_SERIAL_RX, RESOURCE_INDEX(device));
+        // same priority as the UART interrupt, the two deliver the received bytes in turn
+        dmaSetHandler(identifier, uartRxDmaIrqHandler, hardware->rxPriority, (uint32_t)uart);
         s->rxDMAChannel = hardware->DMAChannel;
         s->rxDMAResource = hardware->rxDMAResource;
         s->rxDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->DR;
@@ -276,15 +291,14 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
         }
     }
 
-    if (!(s->rxDMAChannel)) {
-        NVIC_InitTypeDef NVIC_InitStructure;
+    // with RX DMA the interrupt is still needed for the idle line, it only fires for the enabled sources
+    NVIC_InitTypeDef NVIC_InitStructure;
 
-        NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
-        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-        NVIC_Init(&NVIC_InitStructure);
-    }
+    NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 
     return s;
 }
@@ -314,6 +328,9 @@ void uartIrqHandler(uartPort_t *s)
     }
 
     if (USART_GetITStatus(s->USARTx, USART_IT_IDLE) == SET) {
+        if (s->rxDMAResource) {
+            uartRxDMADeliver(s);
+        }
         if (s->port.idleCallback) {
             s->port.idleCallback();
         }
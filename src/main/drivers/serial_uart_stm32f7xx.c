@@ -376,6 +376,9 @@ void uartIrqHandler(uartPort_t *s)
     }
 
     if (__HAL_UART_GET_IT(huart, UART_IT_IDLE)) {
+        if (s->rxDMAResource) {
+            uartRxDMADeliver(s);
+        }
         if (s->port.idleCallback) {
             s->port.idleCallback();
         }
@@ -395,6 +398,13 @@ void dmaIRQHandler(dmaChannelDescriptor_t* descriptor)
     HAL_DMA_IRQHandler(&s->txDMAHandle);
 }
 
+static void uartRxDmaIrqHandler(dmaChannelDescriptor_t* descriptor)
+{
+    uartPort_t *s = &(((uartDevice_t*)(descriptor->userParam))->port);
+    HAL_DMA_IRQHandler(&s->rxDMAHandle);
+    uartRxDMADeliver(s);
+}
+
 // XXX Should serialUART be consolidated?
 
 uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode, portOptions_e options)
@@ -422,6 +432,11 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
     if (hardware->rxDMAResource) {
         s->rxDMAChannel = hardware->DMAChannel;
         s->rxDMAResource = hardware->rxDMAResource;
+
+        // DMA RX Interrupt, same priority as the UART interrupt, the two deliver the received bytes in turn
+        dmaIdentifier_e identifier = dmaGetIdentifier(hardware->rxDMAResource);
+        dmaInit(identifier, OWNER_SERIAL_RX, RESOURCE_INDEX(device));
+        dmaSetHandler(identifier, uartRxDmaIrqHandler, hardware->rxPriority, (uint32_t)uartdev);
     }
 
     if (hardware->txDMAResource) {
@@ -464,10 +479,9 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
         }
     }
 
-    if (!s->rxDMAChannel) {
-        HAL_NVIC_SetPriority(hardware->rxIrq, NVIC_PRIORITY_BASE(hardware->rxPriority), NVIC_PRIORITY_SUB(hardware->rxPriority));
-        HAL_NVIC_EnableIRQ(hardware->rxIrq);
-    }
+    // with RX DMA the interrupt is still needed for the idle line, it only fires for the enabled sources
+    HAL_NVIC_SetPriority(hardware->rxIrq, NVIC_PRIORITY_BASE(hardware->rxPriority), NVIC_PRIORITY_SUB(hardware->rxPriority));
+    HAL_NVIC_EnableIRQ(hardware->rxIrq);
 
     return s;
 }
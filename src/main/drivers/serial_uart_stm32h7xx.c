@@ -453,6 +453,11 @@ void uartIrqHandler(uartPort_t *s)
     }
 
     if (__HAL_UART_GET_IT(huart, UART_IT_IDLE)) {
+#ifdef USE_DMA
+        if (s->rxDMAResource) {
+            uartRxDMADeliver(s);
+        }
+#endif
         if (s->port.idleCallback) {
             s->port.idleCallback();
         }
@@ -473,6 +478,13 @@ static void dmaIRQHandler(dmaChannelDescriptor_t* descriptor)
     uartPort_t *s = &(((uartDevice_t*)(descriptor->userParam))->port);
     HAL_DMA_IRQHandler(&s->txDMAHandle);
 }
+
+static void uartRxDmaIrqHandler(dmaChannelDescriptor_t* descriptor)
+{
+    uartPort_t *s = &(((uartDevice_t*)(descriptor->userParam))->port);
+    HAL_DMA_IRQHandler(&s->rxDMAHandle);
+    uartRxDMADeliver(s);
+}
 #endif
 
 // XXX Should serialUART be consolidated?
@@ -509,6 +521,11 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
 #else // F4 & F7
         s->rxDMAChannel = hardware->DMAChannel;
 #endif
+
+        // DMA RX Interrupt, same priority as the UART interrupt, the two deliver the received bytes in turn
+        dmaIdentifier_e identifier = dmaGetIdentifier(hardware->rxDMAResource);
+        dmaInit(identifier, OWNER_SERIAL_RX, RESOURCE_INDEX(device));
+        dmaSetHandler(identifier, uartRxDmaIrqHandler, hardware->rxPriority, (uint32_t)uartdev);
     }
 
     if (hardware->txDMAResource) {
@@ -555,17 +572,9 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
         }
     }
 
-#ifdef USE_DMA
-#if defined(STM32H7)
-    if (!s->rxDMAResource)
-#else
-    if (!s->rxDMAChannel)
-#endif
-#endif
-    {
-        HAL_NVIC_SetPriority(hardware->rxIrq, NVIC_PRIORITY_BASE(hardware->rxPriority), NVIC_PRIORITY_SUB(hardware->rxPriority));
-        HAL_NVIC_EnableIRQ(hardware->rxIrq);
-    }
+    // with RX DMA the interrupt is still needed for the idle line, it only fires for the enabled sources
+    HAL_NVIC_SetPriority(hardware->rxIrq, NVIC_PRIORITY_BASE(hardware->rxPriority), NVIC_PRIORITY_SUB(hardware->rxPriority));
+    HAL_NVIC_EnableIRQ(hardware->rxIrq);
 
     return s;
 }
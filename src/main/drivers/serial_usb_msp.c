@@ -0,0 +1,144 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "platform.h"
+
+#ifdef USE_USB_MSP_BULK
+
+#include "common/utils.h"
+
+#include "drivers/time.h"
+
+#include "io/serial.h"
+
+#include "vcp_hal/usbd_cdc_msp.h"
+
+#include "serial.h"
+#include "serial_usb_msp.h"
+
+#define USB_MSP_TIMEOUT  50
+
+static serialPort_t usbMspPort;
+
+static void usbMspSetBaudRate(serialPort_t *instance, uint32_t baudRate)
+{
+    UNUSED(instance);
+    UNUSED(baudRate);
+}
+
+static void usbMspSetMode(serialPort_t *instance, portMode_e mode)
+{
+    UNUSED(instance);
+    UNUSED(mode);
+}
+
+static bool isUsbMspTransmitBufferEmpty(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return usbMspTxIdle();
+}
+
+static uint32_t usbMspAvailable(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return usbMspRxBytesAvailable();
+}
+
+static uint8_t usbMspReadByte(serialPort_t *instance)
+{
+    UNUSED(instance);
+
+    uint8_t c = 0;
+    usbMspRead(&c, 1);
+    return c;
+}
+
+static void usbMspReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count)
+{
+    UNUSED(instance);
+    usbMspRead(data, count);
+}
+
+static uint32_t usbMspTxFree(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return usbMspTxBytesFree();
+}
+
+// Frames larger than the transmit ring, e.g. jumbo dataflash reads, wait for the host to drain it
+static void usbMspWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    UNUSED(instance);
+
+    if (!usbMspIsConfigured()) {
+        return;
+    }
+
+    const uint32_t start = millis();
+    const uint8_t *p = data;
+    while (count > 0) {
+        const uint32_t txed = usbMspWrite(p, count);
+        count -= txed;
+        p += txed;
+
+        if (millis() - start > USB_MSP_TIMEOUT) {
+            break;
+        }
+    }
+}
+
+static void usbMspWriteByte(serialPort_t *instance, uint8_t c)
+{
+    usbMspWriteBuf(instance, &c, 1);
+}
+
+static const struct serialPortVTable usbMspVTable[] = {
+    {
+        .serialWrite = usbMspWriteByte,
+        .serialTotalRxWaiting = usbMspAvailable,
+        .serialTotalTxFree = usbMspTxFree,
+        .serialRead = usbMspReadByte,
+        .serialSetBaudRate = usbMspSetBaudRate,
+        .isSerialTransmitBufferEmpty = isUsbMspTransmitBufferEmpty,
+        .setMode = usbMspSetMode,
+        .setCtrlLineStateCb = NULL,
+        .setBaudRateCb = NULL,
+        .writeBuf = usbMspWriteBuf,
+        .beginWrite = NULL,
+        .endWrite = NULL,
+        .reserveWrite = NULL,
+        .commitWrite = NULL,
+        .readBuf = usbMspReadBuf
+    }
+};
+
+// The USB device itself is started by usbVcpOpen(), this only binds the port to the bulk interface
+serialPort_t *usbMspOpen(void)
+{
+    usbMspPort.vTable = usbMspVTable;
+    usbMspPort.mode = MODE_RXTX;
+    usbMspPort.identifier = SERIAL_PORT_NONE;
+
+    return &usbMspPort;
+}
+#endif
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -30,6 +31,7 @@
 #include "common/utils.h"
 
 #include "drivers/io.h"
+#include "drivers/usb_io.h"
 
 #include "pg/usb.h"
 
@@ -48,6 +50,9 @@
 
 extern USBD_ClassTypeDef  USBD_HID_CDC;
 #endif
+#ifdef USE_USB_MSP_BULK
+#include "vcp_hal/usbd_cdc_msp.h"
+#endif
 USBD_HandleTypeDef USBD_Device;
 #else
 #include "usb_core.h"
@@ -122,16 +127,32 @@ static uint8_t usbVcpRead(serialPort_t *instance)
     }
 }
 
-static void usbVcpWriteBuf(serialPort_t *instance, const void *data, int count)
+static void usbVcpReadBuf(serialPort_t *instance, uint8_t *data, uint32_t count)
 {
     UNUSED(instance);
 
-    if (!(usbIsConnected() && usbIsConfigured())) {
-        return;
+    while (count) {
+        const uint32_t received = CDC_Receive_DATA(data, count);
+        data += received;
+        count -= received;
+    }
+}
+
+static bool usbVcpFlush(vcpPort_t *port)
+{
+    uint32_t count = port->txAt;
+    port->txAt = 0;
+
+    if (count == 0) {
+        return true;
+    }
+
+    if (!usbIsConnected() || !usbIsConfigured()) {
+        return false;
     }
 
     uint32_t start = millis();
-    const uint8_t *p = data;
+    uint8_t *p = port->txBuf;
     while (count > 0) {
         uint32_t txed = CDC_Send_DATA(p, count);
         count -= txed;
@@ -141,23 +162,32 @@ static void usbVcpWriteBuf(serialPort_t *instance, const void *data, int count)
             break;
         }
     }
+    return count == 0;
 }
 
-static bool usbVcpFlush(vcpPort_t *port)
+static void usbVcpWriteBuf(serialPort_t *instance, const void *data, int count)
 {
-    uint32_t count = port->txAt;
-    port->txAt = 0;
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
 
-    if (count == 0) {
-        return true;
+    // Small writes between beginWrite() and endWrite() are gathered into full packets
+    if (port->buffering && port->txAt + count <= (int)sizeof(port->txBuf)) {
+        memcpy(&port->txBuf[port->txAt], data, count);
+        port->txAt += count;
+        if (port->txAt >= sizeof(port->txBuf)) {
+            usbVcpFlush(port);
+        }
+        return;
     }
 
-    if (!usbIsConnected() || !usbIsConfigured()) {
-        return false;
+    // Send what is buffered first to keep the byte order
+    usbVcpFlush(port);
+
+    if (!(usbIsConnected() && usbIsConfigured())) {
+        return;
     }
 
     uint32_t start = millis();
-    uint8_t *p = port->txBuf;
+    const uint8_t *p = data;
     while (count > 0) {
         uint32_t txed = CDC_Send_DATA(p, count);
         count -= txed;
@@ -167,7 +197,6 @@ static bool usbVcpFlush(vcpPort_t *port)
             break;
         }
     }
-    return count == 0;
 }
 
 static void usbVcpWrite(serialPort_t *instance, uint8_t c)
@@ -199,6 +228,30 @@ static void usbVcpEndWrite(serialPort_t *instance)
     usbVcpFlush(port);
 }
 
+// Frames up to one packet are built in place in the packet buffer and sent with a single CDC_Send_DATA()
+static uint8_t *usbVcpReserveWrite(serialPort_t *instance, uint32_t count)
+{
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
+
+    if (count > sizeof(port->txBuf)) {
+        return NULL;
+    }
+    if (port->txAt + count > sizeof(port->txBuf)) {
+        usbVcpFlush(port);
+    }
+    return &port->txBuf[port->txAt];
+}
+
+static void usbVcpCommitWrite(serialPort_t *instance, uint32_t count)
+{
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
+
+    port->txAt += count;
+    if (!port->buffering || port->txAt >= sizeof(port->txBuf)) {
+        usbVcpFlush(port);
+    }
+}
+
 static const struct serialPortVTable usbVTable[] = {
     {
         .serialWrite = usbVcpWrite,
@@ -212,7 +265,10 @@ static const struct serialPortVTable usbVTable[] = {
         .setBaudRateCb = usbVcpSetBaudRateCb,
         .writeBuf = usbVcpWriteBuf,
         .beginWrite = usbVcpBeginWrite,
-        .endWrite = usbVcpEndWrite
+        .endWrite = usbVcpEndWrite,
+        .reserveWrite = usbVcpReserveWrite,
+        .commitWrite = usbVcpCommitWrite,
+        .readBuf = usbVcpReadBuf
     }
 };
 
@@ -220,8 +276,10 @@ serialPort_t *usbVcpOpen(void)
 {
     vcpPort_t *s;
 
-    IOInit(IOGetByTag(IO_TAG(PA11)), OWNER_USB, 0);
-    IOInit(IOGetByTag(IO_TAG(PA12)), OWNER_USB, 0);
+#ifdef USB_DP_PIN
+    IOInit(IOGetByTag(IO_TAG(USB_DM_PIN)), OWNER_USB, 0);
+    IOInit(IOGetByTag(IO_TAG(USB_DP_PIN)), OWNER_USB, 0);
+#endif
 
 #if defined(STM32F4)
     usbGenerateDisconnectPulse();
@@ -251,6 +309,12 @@ serialPort_t *usbVcpOpen(void)
         break;
 #endif
     default:
+#ifdef USE_USB_MSP_BULK
+        if (usbDevConfig()->mspBulk) {
+            USBD_RegisterClass(&USBD_Device, &USBD_CDC_MSP);
+            break;
+        }
+#endif
         USBD_RegisterClass(&USBD_Device, USBD_CDC_CLASS);
         break;
     }
@@ -38,8 +38,8 @@ extern USBD_HandleTypeDef  USBD_Device;
 typedef struct {
     serialPort_t port;
 
-    // Buffer used during bulk writes.
-    uint8_t txBuf[20];
+    // Buffer used during bulk writes and for reserved writes, one full speed USB packet.
+    uint8_t txBuf[64];
     uint8_t txAt;
     // Set if the port is in bulk write mode and can buffer.
     bool buffering;
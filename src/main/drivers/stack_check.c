@@ -30,11 +30,15 @@
 
 #include "drivers/stack_check.h"
 
-#define STACK_FILL_CHAR 0xa5
+#include "scheduler/scheduler.h"
 
 extern char _estack; // end of stack, declared in .LD file
 extern char _Min_Stack_Size; // declared in .LD file
 
+#ifdef UNIT_TEST
+uint32_t __get_MSP(void); // CMSIS intrinsic, provided by the test on the host
+#endif
+
 /*
  * The ARM processor uses a full descending stack. This means the stack pointer holds the address
  * of the last stacked item in memory. When the processor pushes a new item onto the stack,
@@ -60,36 +64,120 @@ extern char _Min_Stack_Size; // declared in .LD file
 
 #ifdef STACK_CHECK
 
+#define STACK_FILL_WORD 0xa5a5a5a5
+
+// The painted stack is checked a slice per run, word by word, from the bottom
+// up to the lowest used word found so far. When a pass finds a used word below
+// that mark the mark moves down and the next pass starts from the bottom again,
+// so the high-water mark only ever grows and a pass costs at most one slice.
+typedef struct stackScan_s {
+    const uint32_t *low;
+    const uint32_t *high;
+    const uint32_t *pos;
+    const uint32_t *mark;               // lowest word seen in use
+} stackScan_t;
+
+static stackScan_t scan;
 static uint32_t usedStackSize;
 
+static FAST_RAM_ZERO_INIT volatile uint8_t isrNesting;
+static FAST_RAM_ZERO_INIT stackIsrStats_t isrStats;
+static FAST_RAM_ZERO_INIT uint32_t taskDepth[TASK_COUNT];
+
+STATIC_UNIT_TESTED void stackScanInit(const uint32_t *low, const uint32_t *high)
+{
+    scan.low = low;
+    scan.high = high;
+    scan.pos = low;
+    scan.mark = high;
+}
+
+// Returns the bytes in use from the top of the stack down to the high-water mark
+STATIC_UNIT_TESTED uint32_t stackScanSlice(unsigned words)
+{
+    for (; words && scan.pos < scan.mark; words--, scan.pos++) {
+        if (*scan.pos != STACK_FILL_WORD) {
+            scan.mark = scan.pos;
+            break;
+        }
+    }
+    if (scan.pos >= scan.mark) {
+        scan.pos = scan.low;
+    }
+
+    return (uint32_t)((const char *)scan.high - (const char *)scan.mark);
+}
+
 void taskStackCheck(timeUs_t currentTimeUs)
 {
     UNUSED(currentTimeUs);
 
     char * const stackHighMem = &_estack;
-    const uint32_t stackSize = (uint32_t)&_Min_Stack_Size;
+    const uint32_t stackSize = (uint32_t)(uintptr_t)&_Min_Stack_Size;
     char * const stackLowMem = stackHighMem - stackSize;
     const char * const stackCurrent = (char *)&stackLowMem;
 
-    char *p;
-    for (p = stackLowMem; p < stackCurrent; ++p) {
-        if (*p != STACK_FILL_CHAR) {
-            break;
-        }
+    if (!scan.high) {
+        stackScanInit((const uint32_t *)(((uintptr_t)stackLowMem + 3) & ~(uintptr_t)3), (const uint32_t *)stackHighMem);
     }
+    usedStackSize = stackScanSlice(STACK_CHECK_SLICE_BYTES / sizeof(uint32_t));
 
-    usedStackSize = (uint32_t)stackHighMem - (uint32_t)p;
-
-    DEBUG_SET(DEBUG_STACK, 0, (uint32_t)stackHighMem & 0xffff);
-    DEBUG_SET(DEBUG_STACK, 1, (uint32_t)stackLowMem & 0xffff);
-    DEBUG_SET(DEBUG_STACK, 2, (uint32_t)stackCurrent & 0xffff);
-    DEBUG_SET(DEBUG_STACK, 3, (uint32_t)p & 0xffff);
+    DEBUG_SET(DEBUG_STACK, 0, (uint32_t)((uintptr_t)stackHighMem & 0xffff));
+    DEBUG_SET(DEBUG_STACK, 1, (uint32_t)((uintptr_t)stackLowMem & 0xffff));
+    DEBUG_SET(DEBUG_STACK, 2, (uint32_t)((uintptr_t)stackCurrent & 0xffff));
+    DEBUG_SET(DEBUG_STACK, 3, (uint32_t)((uintptr_t)scan.mark & 0xffff));
 }
 
 uint32_t stackUsedSize(void)
 {
     return usedStackSize;
 }
+
+// Called first thing in the shared EXTI, DMA and timer interrupt handlers. The
+// stack depth on entry to an interrupt that did not preempt another one belongs
+// to the task the scheduler is running, so each task gets a sampled lower bound
+// of its own stack use. Nested interrupts run to completion before the one they
+// preempted resumes, so the plain increment and decrement below stay balanced.
+FAST_CODE void stackCheckIsrEnter(void)
+{
+    const uint8_t nesting = ++isrNesting;
+    const uint32_t depth = (uint32_t)(uintptr_t)&_estack - __get_MSP();
+
+    if (nesting > isrStats.maxNesting) {
+        isrStats.maxNesting = nesting;
+    }
+    if (depth > isrStats.maxDepth) {
+        isrStats.maxDepth = depth;
+    }
+    if (nesting == 1) {
+        const cfTaskId_e taskId = getCurrentTaskId();
+        if (taskId < TASK_COUNT && depth > taskDepth[taskId]) {
+            taskDepth[taskId] = depth;
+        }
+    }
+}
+
+FAST_CODE void stackCheckIsrExit(void)
+{
+    isrNesting--;
+}
+
+const stackIsrStats_t *stackCheckGetIsrStats(void)
+{
+    return &isrStats;
+}
+
+uint32_t stackCheckGetTaskDepth(int taskId)
+{
+    return taskId >= 0 && taskId < TASK_COUNT ? taskDepth[taskId] : 0;
+}
+
+void stackCheckResetIsrStats(void)
+{
+    isrStats.maxNesting = 0;
+    isrStats.maxDepth = 0;
+    memset(taskDepth, 0, sizeof(taskDepth));
+}
 #endif
 
 uint32_t stackTotalSize(void)
@@ -22,7 +22,28 @@
 
 #include "common/time.h"
 
+#define STACK_CHECK_SLICE_BYTES 256     // painted stack checked per task run
+
+typedef struct stackIsrStats_s {
+    uint8_t maxNesting;                 // deepest instrumented interrupt nesting seen
+    uint32_t maxDepth;                  // deepest stack seen on entry to an instrumented interrupt
+} stackIsrStats_t;
+
 void taskStackCheck(timeUs_t currentTimeUs);
 uint32_t stackUsedSize(void);
 uint32_t stackTotalSize(void);
 uint32_t stackHighMem(void);
+
+#ifdef STACK_CHECK
+void stackCheckIsrEnter(void);
+void stackCheckIsrExit(void);
+const stackIsrStats_t *stackCheckGetIsrStats(void);
+uint32_t stackCheckGetTaskDepth(int taskId);
+void stackCheckResetIsrStats(void);
+
+#define STACK_CHECK_ISR_ENTER() stackCheckIsrEnter()
+#define STACK_CHECK_ISR_EXIT() stackCheckIsrExit()
+#else
+#define STACK_CHECK_ISR_ENTER() do {} while (0)
+#define STACK_CHECK_ISR_EXIT() do {} while (0)
+#endif
@@ -34,7 +34,9 @@
 #include "drivers/nvic.h"
 
 #include "drivers/io.h"
+#include "drivers/irq_load.h"
 #include "rcc.h"
+#include "drivers/stack_check.h"
 #include "drivers/system.h"
 
 #include "timer.h"
@@ -698,14 +700,22 @@ static void timCCxHandler(TIM_TypeDef *tim, timerConfig_t *timerConfig)
 #define _TIM_IRQ_HANDLER2(name, i, j)                                   \
     void name(void)                                                     \
     {                                                                   \
+        STACK_CHECK_ISR_ENTER();                                        \
+        IRQ_LOAD_ENTER(IRQ_LOAD_TIMER);                                 \
         timCCxHandler(TIM ## i, &timerConfig[TIMER_INDEX(i)]);          \
         timCCxHandler(TIM ## j, &timerConfig[TIMER_INDEX(j)]);          \
+        IRQ_LOAD_EXIT(IRQ_LOAD_TIMER);                                  \
+        STACK_CHECK_ISR_EXIT();                                         \
     } struct dummy
 
 #define _TIM_IRQ_HANDLER(name, i)                                       \
     void name(void)                                                     \
     {                                                                   \
+        STACK_CHECK_ISR_ENTER();                                        \
+        IRQ_LOAD_ENTER(IRQ_LOAD_TIMER);                                 \
         timCCxHandler(TIM ## i, &timerConfig[TIMER_INDEX(i)]);          \
+        IRQ_LOAD_EXIT(IRQ_LOAD_TIMER);                                  \
+        STACK_CHECK_ISR_EXIT();                                         \
     } struct dummy
 
 #if USED_TIMERS & TIM_N(1)
@@ -851,6 +861,19 @@ void timerForceOverflow(TIM_TypeDef *tim)
     }
 }
 
+// Forces an overflow of several timers with interrupts masked, so that their update events follow each other within a few cycles
+void timerForceOverflowGroup(TIM_TypeDef *const *tims, uint8_t count)
+{
+    ATOMIC_BLOCK(NVIC_PRIO_TIMER) {
+        for (int i = 0; i < count; i++) {
+            timerConfig[lookupTimerIndex((const TIM_TypeDef *)tims[i])].forcedOverflowTimerValue = tims[i]->CNT + 1;
+        }
+        for (int i = 0; i < count; i++) {
+            tims[i]->EGR |= TIM_EGR_UG;
+        }
+    }
+}
+
 #if !defined(USE_HAL_DRIVER)
 void timerOCInit(TIM_TypeDef *tim, uint8_t channel, TIM_OCInitTypeDef *init)
 {
@@ -265,6 +265,7 @@ void timerChInit(const timerHardware_t *timHw, channelType_t type, int irqPriori
 void timerInit(void);
 void timerStart(void);
 void timerForceOverflow(TIM_TypeDef *tim);
+void timerForceOverflowGroup(TIM_TypeDef *const *tims, uint8_t count);
 
 uint32_t timerClock(TIM_TypeDef *tim);
 
@@ -35,6 +35,8 @@
 
 #include "drivers/io.h"
 #include "drivers/dma.h"
+#include "drivers/irq_load.h"
+#include "drivers/stack_check.h"
 
 #include "rcc.h"
 
@@ -769,14 +771,22 @@ static void timCCxHandler(TIM_TypeDef *tim, timerConfig_t *timerConfig)
 #define _TIM_IRQ_HANDLER2(name, i, j)                                   \
     void name(void)                                                     \
     {                                                                   \
+        STACK_CHECK_ISR_ENTER();                                        \
+        IRQ_LOAD_ENTER(IRQ_LOAD_TIMER);                                 \
         timCCxHandler(TIM ## i, &timerConfig[TIMER_INDEX(i)]);          \
         timCCxHandler(TIM ## j, &timerConfig[TIMER_INDEX(j)]);          \
+        IRQ_LOAD_EXIT(IRQ_LOAD_TIMER);                                  \
+        STACK_CHECK_ISR_EXIT();                                         \
     } struct dummy
 
 #define _TIM_IRQ_HANDLER(name, i)                                       \
     void name(void)                                                     \
     {                                                                   \
+        STACK_CHECK_ISR_ENTER();                                        \
+        IRQ_LOAD_ENTER(IRQ_LOAD_TIMER);                                 \
         timCCxHandler(TIM ## i, &timerConfig[TIMER_INDEX(i)]);          \
+        IRQ_LOAD_EXIT(IRQ_LOAD_TIMER);                                  \
+        STACK_CHECK_ISR_EXIT();                                         \
     } struct dummy
 
 #if USED_TIMERS & TIM_N(1)
@@ -973,6 +983,19 @@ void timerForceOverflow(TIM_TypeDef *tim)
     }
 }
 
+// Forces an overflow of several timers with interrupts masked, so that their update events follow each other within a few cycles
+void timerForceOverflowGroup(TIM_TypeDef *const *tims, uint8_t count)
+{
+    ATOMIC_BLOCK(NVIC_PRIO_TIMER) {
+        for (int i = 0; i < count; i++) {
+            timerConfig[lookupTimerIndex((const TIM_TypeDef *)tims[i])].forcedOverflowTimerValue = tims[i]->CNT + 1;
+        }
+        for (int i = 0; i < count; i++) {
+            tims[i]->EGR |= TIM_EGR_UG;
+        }
+    }
+}
+
 // DMA_Handle_index
 uint16_t timerDmaIndex(uint8_t channel)
 {
@@ -80,7 +80,31 @@
         uint8_t erlt[TRANSPONDER_DMA_BUFFER_SIZE_ERLT]; // 91-200
     } transponderIrDMABuffer_t;
 
-#elif defined(STM32F4) || defined(STM32F7) || defined(STM32H7)
+#elif defined(STM32F7) || defined(STM32H7)
+
+/*
+ * On the HAL targets the packet is followed by its quiet gap in the same buffer and the DMA runs in circular mode,
+ * so repeats cost no CPU time and the gap between packets is exact. Packets start every transmit delay, a packet
+ * that is longer than the transmit delay is followed by a transmit delay of quiet instead.
+ */
+#define TRANSPONDER_IR_REPEAT_IN_HARDWARE
+
+#define TRANSPONDER_DELAY_LENGTH(delayUs, carrierHz) ((delayUs) * ((carrierHz) / 1000) / 1000)
+#define TRANSPONDER_GAP_LENGTH(delayUs, carrierHz, packetLength) \
+    (TRANSPONDER_DELAY_LENGTH(delayUs, carrierHz) > (packetLength) ? \
+    TRANSPONDER_DELAY_LENGTH(delayUs, carrierHz) - (packetLength) : TRANSPONDER_DELAY_LENGTH(delayUs, carrierHz))
+
+#define TRANSPONDER_GAP_LENGTH_ARCITIMER TRANSPONDER_GAP_LENGTH(TRANSPONDER_TRANSMIT_DELAY_ARCITIMER, TRANSPONDER_CARRIER_HZ_ARCITIMER, TRANSPONDER_DMA_BUFFER_SIZE_ARCITIMER) // 184
+#define TRANSPONDER_GAP_LENGTH_ILAP TRANSPONDER_GAP_LENGTH(TRANSPONDER_TRANSMIT_DELAY_ILAP, TRANSPONDER_CARRIER_HZ_ILAP, TRANSPONDER_DMA_BUFFER_SIZE_ILAP) // 1350
+#define TRANSPONDER_GAP_LENGTH_ERLT TRANSPONDER_GAP_LENGTH(TRANSPONDER_TRANSMIT_DELAY_ERLT, TRANSPONDER_CARRIER_HZ_ERLT, TRANSPONDER_DMA_BUFFER_SIZE_ERLT) // 655
+
+    typedef union transponderIrDMABuffer_s {
+        uint32_t arcitimer[TRANSPONDER_DMA_BUFFER_SIZE_ARCITIMER + TRANSPONDER_GAP_LENGTH_ARCITIMER]; // 804
+        uint32_t ilap[TRANSPONDER_DMA_BUFFER_SIZE_ILAP + TRANSPONDER_GAP_LENGTH_ILAP]; // 2070
+        uint32_t erlt[TRANSPONDER_DMA_BUFFER_SIZE_ERLT + TRANSPONDER_GAP_LENGTH_ERLT]; // 855
+    } transponderIrDMABuffer_t;
+
+#elif defined(STM32F4)
 
     typedef union transponderIrDMABuffer_s {
         uint32_t arcitimer[TRANSPONDER_DMA_BUFFER_SIZE_ARCITIMER]; // 620
@@ -129,4 +153,9 @@ void transponderIrTransmit(void);
 
 bool isTransponderIrReady(void);
 
+#ifdef TRANSPONDER_IR_REPEAT_IN_HARDWARE
+bool transponderIrStartRepeating(void);
+void transponderIrStopRepeating(void);
+#endif
+
 extern volatile uint8_t transponderIrDataTransferInProgress;
@@ -47,6 +47,9 @@ static TIM_HandleTypeDef TimHandle;
 static uint16_t timerChannel = 0;
 static uint8_t output;
 static uint8_t alternateFunction;
+static DMA_HandleTypeDef hdma_tim;
+static uint16_t gapLength;
+static bool transponderIrRepeating = false;
 
 #if !(defined(STM32F7) || defined(STM32H7))
 #error "Transponder (via HAL) not supported on this MCU."
@@ -116,8 +119,6 @@ void transponderIrHardwareInit(ioTag_t ioTag, transponder_t *transponder)
 
     /* IO configuration */
 
-    static DMA_HandleTypeDef hdma_tim;
-
     transponderIO = IOGetByTag(ioTag);
     IOInit(transponderIO, OWNER_TRANSPONDER, 0);
     IOConfigGPIOAF(transponderIO, IO_CONFIG(GPIO_MODE_AF_PP, GPIO_SPEED_FREQ_VERY_HIGH, GPIO_PULLDOWN), timerHardware->alternateFunction);
@@ -201,12 +202,15 @@ bool transponderIrInit(const ioTag_t ioTag, const transponderProvider_e provider
     switch (provider) {
         case TRANSPONDER_ARCITIMER:
             transponderIrInitArcitimer(&transponder);
+            gapLength = TRANSPONDER_GAP_LENGTH_ARCITIMER;
             break;
         case TRANSPONDER_ILAP:
             transponderIrInitIlap(&transponder);
+            gapLength = TRANSPONDER_GAP_LENGTH_ILAP;
             break;
         case TRANSPONDER_ERLT:
             transponderIrInitERLT(&transponder);
+            gapLength = TRANSPONDER_GAP_LENGTH_ERLT;
             break;
         default:
             return false;
@@ -237,8 +241,19 @@ void transponderIrWaitForTransmitComplete(void)
 
 void transponderIrUpdateData(const uint8_t* transponderData)
 {
-     transponderIrWaitForTransmitComplete();
-     transponder.vTable->updateTransponderDMABuffer(&transponder, transponderData);
+    const bool repeating = transponderIrRepeating;
+    if (repeating) {
+        transponderIrStopRepeating();
+    }
+
+    transponderIrWaitForTransmitComplete();
+    transponder.vTable->updateTransponderDMABuffer(&transponder, transponderData);
+    // the packet length of ERLT depends on the id, keep the gap after it quiet
+    memset(&transponder.transponderIrDMABuffer.ilap[transponder.dma_buffer_size], 0, gapLength * sizeof(transponder.transponderIrDMABuffer.ilap[0]));
+
+    if (repeating) {
+        transponderIrStartRepeating();
+    }
 }
 
 void transponderIrDMAEnable(transponder_t *transponder)
@@ -259,12 +274,67 @@ void transponderIrDMAEnable(transponder_t *transponder)
     TIM_DMACmd(&TimHandle, timerChannel, ENABLE);
 }
 
+static bool transponderIrSetDMAMode(uint32_t mode)
+{
+    hdma_tim.Init.Mode = mode;
+    return HAL_DMA_Init(&hdma_tim) == HAL_OK;
+}
+
+// Sends the packet and its gap over and over from the DMA, with no further CPU time or interrupts
+bool transponderIrStartRepeating(void)
+{
+    if (!transponderInitialised) {
+        return false;
+    }
+    if (transponderIrRepeating) {
+        return true;
+    }
+
+    transponderIrWaitForTransmitComplete();
+
+    if (!transponderIrSetDMAMode(DMA_CIRCULAR)) {
+        transponderIrSetDMAMode(DMA_NORMAL);
+        return false;
+    }
+
+    if (DMA_SetCurrDataCounter(&TimHandle, timerChannel, transponder.transponderIrDMABuffer.ilap, transponder.dma_buffer_size + gapLength) != HAL_OK) {
+        transponderIrSetDMAMode(DMA_NORMAL);
+        return false;
+    }
+    // the transfer never completes, the interrupts would only cost time on every repeat
+    __HAL_DMA_DISABLE_IT(&hdma_tim, DMA_IT_TC | DMA_IT_HT);
+
+    transponderIrRepeating = true;
+
+    __HAL_TIM_SET_COUNTER(&TimHandle, 0);
+    TIM_DMACmd(&TimHandle, timerChannel, ENABLE);
+
+    return true;
+}
+
+void transponderIrStopRepeating(void)
+{
+    if (!transponderIrRepeating) {
+        return;
+    }
+
+    TIM_DMACmd(&TimHandle, timerChannel, DISABLE);
+    HAL_DMA_Abort(&hdma_tim);
+    __HAL_TIM_SET_COMPARE(&TimHandle, timerChannel, 0);
+    TimHandle.State = HAL_TIM_STATE_READY;
+
+    transponderIrSetDMAMode(DMA_NORMAL);
+    transponderIrRepeating = false;
+}
+
 void transponderIrDisable(void)
 {
     if (!transponderInitialised) {
         return;
     }
 
+    transponderIrStopRepeating();
+
     TIM_DMACmd(&TimHandle, timerChannel, DISABLE);
     if (output & TIMER_OUTPUT_N_CHANNEL) {
         HAL_TIMEx_PWMN_Stop(&TimHandle, timerChannel);
@@ -286,6 +356,11 @@ void transponderIrDisable(void)
 
 void transponderIrTransmit(void)
 {
+    if (transponderIrRepeating) {
+        // already on the air
+        return;
+    }
+
     transponderIrWaitForTransmitComplete();
 
     transponderIrDataTransferInProgress = 1;
@@ -68,8 +68,9 @@ bool usbCableIsInserted(void)
 
 void usbGenerateDisconnectPulse(void)
 {
-    /* Pull down PA12 to create USB disconnect pulse */
-    IO_t usbPin = IOGetByTag(IO_TAG(PA12));
+#ifdef USB_DP_PIN
+    /* Pull down D+ to create USB disconnect pulse */
+    IO_t usbPin = IOGetByTag(IO_TAG(USB_DP_PIN));
     IOConfigGPIO(usbPin, IOCFG_OUT_OD);
 
     IOLo(usbPin);
@@ -77,5 +78,6 @@ void usbGenerateDisconnectPulse(void)
     delay(200);
 
     IOHi(usbPin);
+#endif
 }
 #endif
@@ -20,6 +20,16 @@
 
 #pragma once
 
+// Data pins of the USB port, the OTG_HS core uses its own pins with the embedded full speed PHY.
+// There are none to claim for an external ULPI PHY.
+#if !defined(USE_USB_HS)
+#define USB_DM_PIN PA11
+#define USB_DP_PIN PA12
+#elif defined(USE_USB_HS_IN_FS)
+#define USB_DM_PIN PB14
+#define USB_DP_PIN PB15
+#endif
+
 void usbGenerateDisconnectPulse(void);
 
 void usbCableDetectDeinit(void);
@@ -79,8 +79,10 @@ uint8_t mscStart(void)
     //Start USB
     usbGenerateDisconnectPulse();
 
-    IOInit(IOGetByTag(IO_TAG(PA11)), OWNER_USB, 0);
-    IOInit(IOGetByTag(IO_TAG(PA12)), OWNER_USB, 0);
+#ifdef USB_DP_PIN
+    IOInit(IOGetByTag(IO_TAG(USB_DM_PIN)), OWNER_USB, 0);
+    IOInit(IOGetByTag(IO_TAG(USB_DP_PIN)), OWNER_USB, 0);
+#endif
 
     USBD_Init(&USBD_Device, &VCP_Desc, 0);
 
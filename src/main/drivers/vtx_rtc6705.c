@@ -33,11 +33,11 @@
 #if defined(USE_VTX_RTC6705)
 
 #include "common/maths.h"
+#include "common/utils.h"
 
 #include "drivers/bus_spi.h"
 #include "drivers/bus_spi_impl.h"
 #include "drivers/io.h"
-#include "drivers/time.h"
 #include "drivers/vtx_rtc6705_soft_spi.h"
 
 #include "vtx_rtc6705.h"
@@ -56,7 +56,6 @@ static IO_t vtxPowerPin     = IO_NONE;
 static busDevice_t *busdev = NULL;
 
 #define DISABLE_RTC6705()   IOHi(busdev->busdev_u.spi.csnPin)
-#define ENABLE_RTC6705()    IOLo(busdev->busdev_u.spi.csnPin)
 
 #define DP_5G_MASK          0x7000 // b111000000000000
 #define PA5G_BS_MASK        0x0E00 // b000111000000000
@@ -70,21 +69,12 @@ static busDevice_t *busdev = NULL;
 #define RTC6705_RW_CONTROL_BIT      (1 << 4)
 #define RTC6705_ADDRESS             (0x07)
 
-/**
- * Reverse a uint32_t (LSB to MSB)
- * This is easier for when generating the frequency to then
- * reverse the bits afterwards
- */
-static uint32_t reverse32(uint32_t in)
-{
-    uint32_t out = 0;
+// A command and the chip select toggled after it
+#define RTC6705_COMMAND_LENGTH      4
+#define RTC6705_MAX_COMMANDS        2
 
-    for (uint8_t i = 0 ; i < 32 ; i++) {
-        out |= ((in>>i) & 1)<<(31-i);
-    }
-
-    return out;
-}
+static uint8_t rtc6705CommandBuffer[RTC6705_MAX_COMMANDS][RTC6705_COMMAND_LENGTH];
+static busSegment_t rtc6705Segments[RTC6705_MAX_COMMANDS + 1];
 
 /**
  * Start chip if available
@@ -133,26 +123,32 @@ bool rtc6705IOInit(const vtxIOConfig_t *vtxIOConfig)
 }
 
 /**
- * Transfer a 25bit packet to RTC6705
- * This will just send it as a 32bit packet LSB meaning
- * extra 0's get truncated on RTC6705 end
+ * Queue 25bit packets to RTC6705, each as a transfer of its own
+ * They are sent as 32bit packets LSB first, the bits are reversed to
+ * send them MSB first, extra 0's get truncated on RTC6705 end
  */
-static void rtc6705Transfer(uint32_t command)
+static void rtc6705Transfer(const uint32_t *commands, int count)
 {
-    command = reverse32(command);
+    // The buffers belong to the previous sequence until it has completed, and the clock is changed for the whole bus
+    spiBusWait(busdev);
+    spiBusSetDivisor(busdev, SPI_CLOCK_SLOW);
 
-    ENABLE_RTC6705();
+    for (int i = 0; i < count; i++) {
+        const uint32_t command = __RBIT(commands[i]);
+        uint8_t *buffer = rtc6705CommandBuffer[i];
 
-    spiTransferByte(busdev->busdev_u.spi.instance, (command >> 24) & 0xFF);
-    spiTransferByte(busdev->busdev_u.spi.instance, (command >> 16) & 0xFF);
-    spiTransferByte(busdev->busdev_u.spi.instance, (command >> 8) & 0xFF);
-    spiTransferByte(busdev->busdev_u.spi.instance, (command >> 0) & 0xFF);
+        buffer[0] = command >> 24;
+        buffer[1] = command >> 16;
+        buffer[2] = command >> 8;
+        buffer[3] = command;
 
-    delayMicroseconds(2);
-
-    DISABLE_RTC6705();
+        rtc6705Segments[i] = (busSegment_t){ buffer, NULL, RTC6705_COMMAND_LENGTH, true, NULL };
+    }
+    rtc6705Segments[count] = (busSegment_t){ NULL, NULL, 0, true, NULL };
 
-    delayMicroseconds(2);
+    if (!spiBusSequence(busdev, rtc6705Segments, 0)) {
+        spiBusRunSequence(busdev, rtc6705Segments);
+    }
 }
 
  /**
@@ -178,11 +174,8 @@ void rtc6705SetFrequency(uint16_t frequency)
     val_hex |= (val_a << 5);
     val_hex |= (val_n << 12);
 
-    spiSetDivisor(busdev->busdev_u.spi.instance, SPI_CLOCK_SLOW);
-
-    rtc6705Transfer(RTC6705_SET_HEAD);
-    delayMicroseconds(10);
-    rtc6705Transfer(val_hex);
+    const uint32_t commands[] = { RTC6705_SET_HEAD, val_hex };
+    rtc6705Transfer(commands, ARRAYLEN(commands));
 }
 
 void rtc6705SetRFPower(uint8_t rf_power)
@@ -202,9 +195,7 @@ void rtc6705SetRFPower(uint8_t rf_power)
     const uint32_t data = rf_power > 1 ? PA_CONTROL_DEFAULT : (PA_CONTROL_DEFAULT | PD_Q5G_MASK) & (~(PA5G_PW_MASK | PA5G_BS_MASK));
     val_hex |= data << 5; // 4 address bits and 1 rw bit.
 
-    spiSetDivisor(busdev->busdev_u.spi.instance, SPI_CLOCK_SLOW);
-
-    rtc6705Transfer(val_hex);
+    rtc6705Transfer(&val_hex, 1);
 }
 
 void rtc6705Disable(void)
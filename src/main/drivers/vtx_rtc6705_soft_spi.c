@@ -41,6 +41,9 @@
 
 #define PA_CONTROL_DEFAULT          0x4FBD
 
+// Half a clock period, about the clock of the hardware SPI path at SPI_CLOCK_SLOW
+#define RTC6705_SOFT_SPI_HALF_PERIOD_US 1
+
 #define RTC6705_SPICLK_ON()   IOHi(rtc6705ClkPin)
 #define RTC6705_SPICLK_OFF()  IOLo(rtc6705ClkPin)
 
@@ -84,7 +87,7 @@ bool rtc6705SoftSpiIOInit(const vtxIOConfig_t *vtxIOConfig, const IO_t csnPin)
 static void rtc6705_write_register(uint8_t addr, uint32_t data)
 {
     ENABLE_RTC6705();
-    delay(1);
+    delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
     // send address
     for (int i = 0; i < 4; i++) {
         if ((addr >> i) & 1) {
@@ -94,16 +97,16 @@ static void rtc6705_write_register(uint8_t addr, uint32_t data)
         }
 
         RTC6705_SPICLK_ON();
-        delay(1);
+        delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
         RTC6705_SPICLK_OFF();
-        delay(1);
+        delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
     }
     // Write bit
     RTC6705_SPIDATA_ON();
     RTC6705_SPICLK_ON();
-    delay(1);
+    delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
     RTC6705_SPICLK_OFF();
-    delay(1);
+    delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
     for (int i = 0; i < 20; i++) {
         if ((data >> i) & 1) {
             RTC6705_SPIDATA_ON();
@@ -111,9 +114,9 @@ static void rtc6705_write_register(uint8_t addr, uint32_t data)
             RTC6705_SPIDATA_OFF();
         }
         RTC6705_SPICLK_ON();
-        delay(1);
+        delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
         RTC6705_SPICLK_OFF();
-        delay(1);
+        delayMicroseconds(RTC6705_SOFT_SPI_HALF_PERIOD_US);
     }
     DISABLE_RTC6705();
 }
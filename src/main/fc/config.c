@@ -35,13 +35,16 @@
 #include "config/config_eeprom.h"
 #include "config/feature.h"
 
+#include "drivers/dshot.h"
 #include "drivers/dshot_command.h"
 #include "drivers/motor.h"
+#include "drivers/pendsv.h"
 #include "drivers/system.h"
 
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
 #include "fc/core.h"
+#include "fc/init.h"
 #include "fc/rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
@@ -86,6 +89,8 @@ static bool configIsDirty; /* someone indicated that the config is modified and
 
 static bool rebootRequired = false;  // set if a config change requires a reboot to take effect
 
+static uint8_t motorPwmProtocol;  // protocol the motors are initialised with, dshot_auto_rate may pick a faster one than configured
+
 pidProfile_t *currentPidProfile;
 
 #ifndef RX_SPI_DEFAULT_PROTOCOL
@@ -101,7 +106,7 @@ PG_RESET_TEMPLATE(pilotConfig_t, pilotConfig,
     .displayName = { 0 },
 );
 
-PG_REGISTER_WITH_RESET_TEMPLATE(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 2);
+PG_REGISTER_WITH_RESET_TEMPLATE(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 5);
 
 PG_RESET_TEMPLATE(systemConfig_t, systemConfig,
     .pidProfileIndex = 0,
@@ -114,6 +119,9 @@ PG_RESET_TEMPLATE(systemConfig_t, systemConfig,
     .hseMhz = SYSTEM_HSE_VALUE,  // Not used for non-F4 targets
     .configurationState = CONFIGURATION_STATE_DEFAULTS_BARE,
     .schedulerOptimizeRate = SCHEDULER_OPTIMIZE_RATE_AUTO,
+    .schedulerDeadlineAware = false,
+    .pidLoopInterrupt = false,
+    .fastBoot = false,
 );
 
 uint8_t getCurrentPidProfileIndex(void)
@@ -136,6 +144,11 @@ uint16_t getCurrentMinthrottle(void)
     return motorConfig()->minthrottle;
 }
 
+uint8_t getMotorPwmProtocol(void)
+{
+    return motorPwmProtocol;
+}
+
 void resetConfig(void)
 {
     pgResetAll();
@@ -148,6 +161,7 @@ void resetConfig(void)
 static void activateConfig(void)
 {
     schedulerOptimizeRate(systemConfig()->schedulerOptimizeRate == SCHEDULER_OPTIMIZE_RATE_ON || (systemConfig()->schedulerOptimizeRate == SCHEDULER_OPTIMIZE_RATE_AUTO && motorConfig()->dev.useDshotTelemetry));
+    schedulerSetDeadlineAware(systemConfig()->schedulerDeadlineAware);
     loadPidProfile();
     loadControlRateProfile();
 
@@ -614,9 +628,25 @@ void validateAndFixGyroConfig(void)
     }
 
 
+    if (!(systemState & SYSTEM_STATE_MOTORS_READY)) {
+        // The protocol can only change before the motors are initialised, the gyro sampling time is
+        // the default one at that point
+        motorPwmProtocol = motorConfig()->dev.motorPwmProtocol;
+#ifdef USE_DSHOT
+        if (motorConfig()->dshotAutoRate) {
+            bool bidirectional = false;
+#ifdef USE_DSHOT_TELEMETRY
+            bidirectional = motorConfig()->dev.useDshotTelemetry;
+#endif
+            const timeUs_t pidLooptimeUs = lrintf(samplingTime * 1e6f * gyroConfig()->gyro_sync_denom * pidConfig()->pid_process_denom);
+            motorPwmProtocol = dshotSelectProtocol(motorPwmProtocol, bidirectional, pidLooptimeUs);
+        }
+#endif
+    }
+
     // check for looptime restrictions based on motor protocol. Motor times have safety margin
     float motorUpdateRestriction;
-    switch (motorConfig()->dev.motorPwmProtocol) {
+    switch (motorPwmProtocol) {
     case PWM_TYPE_STANDARD:
             motorUpdateRestriction = 1.0f / BRUSHLESS_MOTORS_PWM_RATE;
             break;
@@ -794,11 +824,15 @@ void changePidProfileFromCellCount(uint8_t cellCount)
 void changePidProfile(uint8_t pidProfileIndex)
 {
     if (pidProfileIndex < PID_PROFILE_COUNT) {
+        const pidProfile_t *previousPidProfile = currentPidProfile;
         systemConfigMutable()->pidProfileIndex = pidProfileIndex;
         loadPidProfile();
 
-        pidInit(currentPidProfile);
-        initEscEndpoints();
+        PENDSV_BLOCK {
+            pidChangeProfile(previousPidProfile, currentPidProfile);
+            initEscEndpoints();
+            mixerInitProfile();
+        }
     }
 
     beeperConfirmationBeeps(pidProfileIndex + 1);
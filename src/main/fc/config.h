@@ -60,6 +60,9 @@ typedef struct systemConfig_s {
     uint8_t hseMhz; // Not used for non-F4 targets
     uint8_t configurationState; // The state of the configuration (defaults / configured)
     uint8_t schedulerOptimizeRate;
+    uint8_t schedulerDeadlineAware; // only start tasks that are expected to finish before the next realtime task is due
+    uint8_t pidLoopInterrupt;       // run the gyro/PID loop from the gyro data ready interrupt instead of the scheduler
+    uint8_t fastBoot;               // start the scheduler as soon as the gyro is up, the other devices are initialised by a task
 } systemConfig_t;
 
 PG_DECLARE(systemConfig_t, systemConfig);
@@ -93,6 +96,7 @@ void changeControlRateProfile(uint8_t profileIndex);
 bool canSoftwareSerialBeUsed(void);
 
 uint16_t getCurrentMinthrottle(void);
+uint8_t getMotorPwmProtocol(void);
 
 void resetConfig(void);
 void targetConfiguration(void);
@@ -44,6 +44,7 @@
 #include "drivers/dshot_command.h"
 #include "drivers/light_led.h"
 #include "drivers/motor.h"
+#include "drivers/pwm_output.h"
 #include "drivers/sound_beeper.h"
 #include "drivers/system.h"
 #include "drivers/time.h"
@@ -52,9 +53,12 @@
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
 #include "fc/core.h"
+#include "fc/init.h"
 #include "fc/rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
+#include "fc/loop_timing.h"
+#include "fc/rc_latency.h"
 #include "fc/runtime_config.h"
 #include "fc/stats.h"
 
@@ -81,6 +85,8 @@
 #include "io/vtx_control.h"
 #include "io/vtx_rtc6705.h"
 
+#include "msp/msp.h"
+#include "msp/msp_protocol.h"
 #include "msp/msp_serial.h"
 
 #include "osd/osd.h"
@@ -214,13 +220,68 @@ void resetArmingDisabled(void)
     lastArmingDisabledReason = 0;
 }
 
+// The arming restrictions that follow the flight modes, re-evaluated only when the modes or their
+// configuration change rather than on every RX frame
+static void updateArmingStatusForModes(void)
+{
+    if (IS_RC_MODE_ACTIVE(BOXFAILSAFE)) {
+        setArmingDisabled(ARMING_DISABLED_BOXFAILSAFE);
+    } else {
+        unsetArmingDisabled(ARMING_DISABLED_BOXFAILSAFE);
+    }
+
+    if (isModeActivationConditionPresent(BOXPREARM)) {
+        if (IS_RC_MODE_ACTIVE(BOXPREARM) && !ARMING_FLAG(WAS_ARMED_WITH_PREARM)) {
+            unsetArmingDisabled(ARMING_DISABLED_NOPREARM);
+        } else {
+            setArmingDisabled(ARMING_DISABLED_NOPREARM);
+        }
+    }
+
+#ifdef USE_GPS_RESCUE
+    if (gpsRescueIsConfigured()) {
+        if (IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) {
+            setArmingDisabled(ARMING_DISABLED_RESC);
+        } else {
+            unsetArmingDisabled(ARMING_DISABLED_RESC);
+        }
+    }
+#endif
+
+    if (IS_RC_MODE_ACTIVE(BOXPARALYZE)) {
+        setArmingDisabled(ARMING_DISABLED_PARALYZE);
+    }
+}
+
+#ifdef USE_MSP_STREAMING
+// Sends the arming disable flags to the MSP ports subscribed to them as soon as they change, so that
+// a ground station does not need to poll MSP_STATUS_EX for them
+static void publishArmingDisableFlags(void)
+{
+    static armingDisableFlags_e publishedFlags;
+
+    const armingDisableFlags_e flags = getArmingDisableFlags();
+    if (flags == publishedFlags) {
+        return;
+    }
+    publishedFlags = flags;
+
+    mspFcSubscriptionTrigger(MSP_ARMING_DISABLE_FLAGS);
+}
+#endif
+
 void updateArmingStatus(void)
 {
+    static bool modesEvaluated = false;
+    static uint8_t evaluatedModeChangeCount;
+
     if (ARMING_FLAG(ARMED)) {
         LED0_ON;
+        // arming changes WAS_ARMED_WITH_PREARM
+        modesEvaluated = false;
     } else {
         // Check if the power on arming grace time has elapsed
-        if ((getArmingDisableFlags() & ARMING_DISABLED_BOOT_GRACE_TIME) && (millis() >= systemConfig()->powerOnArmingGraceTime * 1000)) {
+        if ((getArmingDisableFlags() & ARMING_DISABLED_BOOT_GRACE_TIME) && (millis() >= systemConfig()->powerOnArmingGraceTime * 1000) && isInitDeferredComplete()) {
             // If so, unset the grace time arming disable flag
             unsetArmingDisabled(ARMING_DISABLED_BOOT_GRACE_TIME);
         }
@@ -246,10 +307,10 @@ void updateArmingStatus(void)
             hadRx = haveRx;
         }
 
-        if (IS_RC_MODE_ACTIVE(BOXFAILSAFE)) {
-            setArmingDisabled(ARMING_DISABLED_BOXFAILSAFE);
-        } else {
-            unsetArmingDisabled(ARMING_DISABLED_BOXFAILSAFE);
+        if (!modesEvaluated || evaluatedModeChangeCount != getRcModeChangeCount()) {
+            updateArmingStatusForModes();
+            evaluatedModeChangeCount = getRcModeChangeCount();
+            modesEvaluated = true;
         }
 
         if (calculateThrottleStatus() != THROTTLE_LOW) {
@@ -264,26 +325,12 @@ void updateArmingStatus(void)
             unsetArmingDisabled(ARMING_DISABLED_ANGLE);
         }
 
-        if (averageSystemLoadPercent > 100) {
-            setArmingDisabled(ARMING_DISABLED_LOAD);
-        } else {
-            unsetArmingDisabled(ARMING_DISABLED_LOAD);
-        }
-
         if (isCalibrating()) {
             setArmingDisabled(ARMING_DISABLED_CALIBRATING);
         } else {
             unsetArmingDisabled(ARMING_DISABLED_CALIBRATING);
         }
 
-        if (isModeActivationConditionPresent(BOXPREARM)) {
-            if (IS_RC_MODE_ACTIVE(BOXPREARM) && !ARMING_FLAG(WAS_ARMED_WITH_PREARM)) {
-                unsetArmingDisabled(ARMING_DISABLED_NOPREARM);
-            } else {
-                setArmingDisabled(ARMING_DISABLED_NOPREARM);
-            }
-        }
-
 #ifdef USE_GPS_RESCUE
         if (gpsRescueIsConfigured()) {
             if (gpsRescueConfig()->allowArmingWithoutFix || STATE(GPS_FIX) || ARMING_FLAG(WAS_EVER_ARMED)) {
@@ -291,11 +338,6 @@ void updateArmingStatus(void)
             } else {
                 setArmingDisabled(ARMING_DISABLED_GPS);
             }
-            if (IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) {
-                setArmingDisabled(ARMING_DISABLED_RESC);
-            } else {
-                unsetArmingDisabled(ARMING_DISABLED_RESC);
-            }
         }
 #endif
 
@@ -317,10 +359,6 @@ void updateArmingStatus(void)
         }
 #endif
 
-        if (IS_RC_MODE_ACTIVE(BOXPARALYZE)) {
-            setArmingDisabled(ARMING_DISABLED_PARALYZE);
-        }
-
         if (!isUsingSticksForArming()) {
           /* Ignore ARMING_DISABLED_CALIBRATING if we are going to calibrate gyro on first arm */
           bool ignoreGyro = armingConfig()->gyro_cal_on_first_arm
@@ -358,6 +396,10 @@ void updateArmingStatus(void)
 
         warningLedUpdate();
     }
+
+#ifdef USE_MSP_STREAMING
+    publishArmingDisableFlags();
+#endif
 }
 
 void disarm(void)
@@ -388,6 +430,9 @@ void disarm(void)
 #ifdef USE_PERSISTENT_STATS
         statsOnDisarm();
 #endif
+#ifdef USE_GYRO_DATA_ANALYSE
+        gyroDataAnalyseOnDisarm(&gyro.gyroAnalyseState);
+#endif
 
         // if ARMING_DISABLED_RUNAWAY_TAKEOFF is set then we want to play it's beep pattern instead
         if (!(getArmingDisableFlags() & (ARMING_DISABLED_RUNAWAY_TAKEOFF | ARMING_DISABLED_CRASH_DETECTED))) {
@@ -1003,6 +1048,12 @@ static FAST_CODE void subTaskPidController(timeUs_t currentTimeUs)
 {
     uint32_t startTime = 0;
     if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+#ifdef USE_ACC
+    imuPropagateAttitude();
+#endif
+#ifdef USE_LOOP_TIMING
+    loopTimingPidStarted(micros(), gyroGetDataReadyTimeUs());
+#endif
     // PID - note this is function pointer set by setPIDController()
     pidController(currentPidProfile, currentTimeUs);
     DEBUG_SET(DEBUG_PIDLOOP, 1, micros() - startTime);
@@ -1067,7 +1118,7 @@ static FAST_CODE_NOINLINE void subTaskPidSubprocesses(timeUs_t currentTimeUs)
 
 #ifdef USE_BLACKBOX
     if (!cliMode && blackboxConfig()->device) {
-        blackboxUpdate(currentTimeUs);
+        blackboxLogIteration(currentTimeUs);
     }
 #else
     UNUSED(currentTimeUs);
@@ -1109,8 +1160,20 @@ static FAST_CODE void subTaskMotorUpdate(timeUs_t currentTimeUs)
     }
 #endif
 
+#ifdef USE_PWM_OUTPUT
+    pwmSetOneshotSyncReference(currentTimeUs);
+#endif
+
     writeMotors();
 
+#ifdef USE_LOOP_TIMING
+    loopTimingMotorsWritten(micros());
+#endif
+
+#ifdef USE_RC_LATENCY
+    rcLatencyStageReached(RC_LATENCY_STAGE_MOTOR, micros());
+#endif
+
 #ifdef USE_DSHOT_TELEMETRY_STATS
     if (debugMode == DEBUG_DSHOT_RPM_ERRORS && useDshotTelemetry) {
         const uint8_t motorCount = MIN(getMotorCount(), 4);
@@ -1160,6 +1223,9 @@ FAST_CODE void taskMainPidLoop(timeUs_t currentTimeUs)
     // 1 - subTaskPidController()
     // 2 - subTaskMotorUpdate()
     // 3 - subTaskPidSubprocesses()
+#ifdef USE_LOOP_TIMING
+    loopTimingLoopStarted(currentTimeUs, gyro.targetLooptime);
+#endif
     gyroUpdate(currentTimeUs);
     DEBUG_SET(DEBUG_PIDLOOP, 0, micros() - currentTimeUs);
 
@@ -24,14 +24,20 @@
 
 #include "platform.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/time.h"
 
 #include "fc/dispatch.h"
 
+#include "scheduler/scheduler.h"
+
+#define DISPATCH_IDLE_PERIOD_US 1000000 // nothing queued, dispatchAdd() brings the task forward
+
 static dispatchEntry_t *head = NULL;
 static bool dispatchEnabled = false;
+static uint32_t lastProcessUs;
 
 bool dispatchIsEnabled(void)
 {
@@ -43,8 +49,17 @@ void dispatchEnable(void)
     dispatchEnabled = true;
 }
 
+// The task runs when the first entry falls due instead of polling the queue.
+// The period counts from the last run, as the scheduler does.
+static void dispatchReschedule(void)
+{
+    const uint32_t periodUs = head ? MAX(cmp32(head->delayedUntil, lastProcessUs), 0) : DISPATCH_IDLE_PERIOD_US;
+    rescheduleTask(TASK_DISPATCH, periodUs);
+}
+
 void dispatchProcess(uint32_t currentTime)
 {
+    lastProcessUs = currentTime;
     for (dispatchEntry_t **p = &head; *p; ) {
         if (cmp32(currentTime, (*p)->delayedUntil) < 0)
             break;
@@ -54,6 +69,7 @@ void dispatchProcess(uint32_t currentTime)
         current->inQue = false;
         (*current->dispatch)(current);
     }
+    dispatchReschedule();
 }
 
 void dispatchAdd(dispatchEntry_t *entry, int delayUs)
@@ -72,4 +88,8 @@ void dispatchAdd(dispatchEntry_t *entry, int delayUs)
     entry->delayedUntil = delayedUntil;
     entry->inQue = true;
     *p = entry;
+
+    if (entry == head) {
+        dispatchReschedule();
+    }
 }
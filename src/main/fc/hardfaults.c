@@ -23,7 +23,10 @@
 
 #include "platform.h"
 
+#include "build/crash_log.h"
+
 #include "drivers/light_led.h"
+#include "drivers/system.h"
 #include "drivers/time.h"
 #include "drivers/transponder_ir.h"
 
@@ -122,9 +125,32 @@ void hard_fault_handler_c(unsigned long *hardfault_args)
   __asm("BKPT #0\n") ; // Break into the debugger
 }
 
+#else
+#ifdef USE_CRASH_LOG
+#define HARD_FAULT_REBOOT_BLINKS 100 // reboot after about 5 seconds, the crash log keeps the fault
+
+// Only referenced from the assembly below, kept for LTO
+void hardFaultHandlerC(uint32_t *stackedFrame) __attribute__((used));
+
+// Passes the exception frame, from whichever stack was in use, to hardFaultHandlerC
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile (
+        "tst lr, #4         \n"
+        "ite eq             \n"
+        "mrseq r0, msp      \n"
+        "mrsne r0, psp      \n"
+        "b hardFaultHandlerC \n"
+    );
+}
+
+void hardFaultHandlerC(uint32_t *stackedFrame)
+{
+    crashLogRecordFault(stackedFrame, SCB->CFSR);
 #else
 void HardFault_Handler(void)
 {
+#endif
     LED0_ON;
     LED1_ON;
     LED2_ON;
@@ -147,11 +173,18 @@ void HardFault_Handler(void)
     LED1_OFF;
     LED2_OFF;
 
+#ifdef USE_CRASH_LOG
+    for (int i = 0; i < HARD_FAULT_REBOOT_BLINKS; i++) {
+#else
     while (1) {
+#endif
         delay(50);
         LED0_TOGGLE;
         LED1_TOGGLE;
         LED2_TOGGLE;
     }
+#ifdef USE_CRASH_LOG
+    systemReset();
+#endif
 }
 #endif
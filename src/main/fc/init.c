@@ -28,6 +28,7 @@
 #include "blackbox/blackbox.h"
 
 #include "build/build_config.h"
+#include "build/crash_log.h"
 #include "build/debug.h"
 
 #include "cms/cms.h"
@@ -51,6 +52,8 @@
 #include "drivers/camera_control.h"
 #include "drivers/compass/compass.h"
 #include "drivers/dma.h"
+#include "drivers/dshot.h"
+#include "drivers/dshot_command.h"
 #include "drivers/exti.h"
 #include "drivers/flash.h"
 #include "drivers/inverter.h"
@@ -95,6 +98,7 @@
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
+#include "flight/position.h"
 #include "flight/rpm_filter.h"
 #include "flight/servos.h"
 
@@ -182,6 +186,98 @@ serialPort_t *loopbackPort;
 
 uint8_t systemState = SYSTEM_STATE_INITIALISING;
 
+enum {
+    FLASH_INIT_ATTEMPTED            = (1 << 0),
+    SD_INIT_ATTEMPTED               = (1 << 1),
+    SPI_AND_QSPI_INIT_ATTEMPTED      = (1 << 2),
+};
+static uint8_t initFlags = 0;
+
+static bootStageTime_t bootStageTimes[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_CONFIG]         = { .name = "CONFIG" },
+    [BOOT_STAGE_GYRO]           = { .name = "GYRO" },
+    [BOOT_STAGE_MAG]            = { .name = "MAG" },
+    [BOOT_STAGE_BARO]           = { .name = "BARO" },
+    [BOOT_STAGE_RANGEFINDER]    = { .name = "RANGEFINDER" },
+    [BOOT_STAGE_SIGNAL]         = { .name = "SIGNAL" },
+    [BOOT_STAGE_RX]             = { .name = "RX" },
+    [BOOT_STAGE_OSD]            = { .name = "OSD" },
+    [BOOT_STAGE_STORAGE]        = { .name = "STORAGE" },
+};
+
+static timeUs_t bootSchedulerStartUs;
+
+typedef void (*initStepFn)(void);
+
+typedef struct deferredInitStep_s {
+    bootStage_e stage;
+    initStepFn fn;
+} deferredInitStep_t;
+
+static deferredInitStep_t deferredInitSteps[BOOT_STAGE_COUNT];
+static uint8_t deferredInitStepCount;
+static uint8_t deferredInitStepIndex;
+
+const bootStageTime_t *getBootStageTime(bootStage_e stage)
+{
+    return &bootStageTimes[stage];
+}
+
+timeUs_t getBootSchedulerStartUs(void)
+{
+    return bootSchedulerStartUs;
+}
+
+bool isInitDeferredComplete(void)
+{
+    return deferredInitStepIndex >= deferredInitStepCount;
+}
+
+static void bootStageEnd(bootStage_e stage, timeUs_t startUs)
+{
+    bootStageTimes[stage].durationUs += cmpTimeUs(micros(), startUs);
+}
+
+static void initStepRun(bootStage_e stage, initStepFn fn)
+{
+    const timeUs_t startUs = micros();
+    fn();
+    bootStageEnd(stage, startUs);
+}
+
+// With fast_boot the steps that the flight loop does not depend on are queued for
+// TASK_DEFERRED_INIT, so that the gyro, PID and RX tasks start without waiting for them.
+static void initStep(bootStage_e stage, initStepFn fn)
+{
+    if (systemConfig()->fastBoot && deferredInitStepCount < ARRAYLEN(deferredInitSteps)) {
+        bootStageTimes[stage].deferred = true;
+        deferredInitSteps[deferredInitStepCount].stage = stage;
+        deferredInitSteps[deferredInitStepCount].fn = fn;
+        deferredInitStepCount++;
+    } else {
+        initStepRun(stage, fn);
+    }
+}
+
+// Runs one deferred step per call, to keep the scheduler responsive between them
+void initDeferredUpdate(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    if (deferredInitStepIndex < deferredInitStepCount) {
+        const deferredInitStep_t *step = &deferredInitSteps[deferredInitStepIndex++];
+        initStepRun(step->stage, step->fn);
+    }
+
+    if (isInitDeferredComplete()) {
+#ifdef USE_GYRO_SPI_DMA
+        sensorsGyroSpiDmaStart();
+#endif
+        fcTasksEnableDetectedDevices();
+        setTaskEnabled(TASK_SELF, false);
+    }
+}
+
 void processLoopback(void)
 {
 #ifdef SOFTSERIAL_LOOPBACK
@@ -255,6 +351,70 @@ void sdCardAndFSInit()
     afatfs_init();
 }
 
+static void initBaro(void)
+{
+    sensorsAutodetectBaro();
+#ifdef USE_BARO
+    baroSetCalibrationCycles(CALIBRATING_BARO_CYCLES);
+#endif
+}
+
+#if (defined(USE_OSD) || (defined(USE_MSP_DISPLAYPORT) && defined(USE_CMS)))
+static void initOsdDisplay(void)
+{
+    displayPort_t *osdDisplayPort = NULL;
+
+#if defined(USE_OSD)
+    //The OSD need to be initialised after GYRO to avoid GYRO initialisation failure on some targets
+
+    if (featureIsEnabled(FEATURE_OSD)) {
+#if defined(USE_MAX7456)
+        // If there is a max7456 chip for the OSD then use it
+        osdDisplayPort = max7456DisplayPortInit(vcdProfile());
+#elif defined(USE_CMS) && defined(USE_MSP_DISPLAYPORT) && defined(USE_OSD_OVER_MSP_DISPLAYPORT) // OSD over MSP; not supported (yet)
+        osdDisplayPort = displayPortMspInit();
+#endif
+        // osdInit  will register with CMS by itself.
+        osdInit(osdDisplayPort);
+    }
+#endif
+
+#if defined(USE_CMS) && defined(USE_MSP_DISPLAYPORT)
+    // If BFOSD is not active, then register MSP_DISPLAYPORT as a CMS device.
+    if (!osdDisplayPort)
+        cmsDisplayPortRegister(displayPortMspInit());
+#endif
+}
+#endif
+
+static void initStorage(void)
+{
+#ifdef USE_FLASH_CHIP
+    if (!(initFlags & FLASH_INIT_ATTEMPTED)) {
+        flashInit(flashConfig());
+        initFlags |= FLASH_INIT_ATTEMPTED;
+    }
+#endif
+#ifdef USE_FLASHFS
+    flashfsInit();
+#endif
+
+#ifdef USE_BLACKBOX
+#ifdef USE_SDCARD
+    if (blackboxConfig()->device == BLACKBOX_DEVICE_SDCARD) {
+        if (sdcardConfig()->mode) {
+            if (!(initFlags & SD_INIT_ATTEMPTED)) {
+                initFlags |= SD_INIT_ATTEMPTED;
+                sdCardAndFSInit();
+            }
+        } else {
+            blackboxConfigMutable()->device = BLACKBOX_DEVICE_NONE;
+        }
+    }
+#endif
+    blackboxInit();
+#endif
+}
 
 void init(void)
 {
@@ -264,6 +424,10 @@ void init(void)
 
     systemInit();
 
+#ifdef USE_CRASH_LOG
+    crashLogInit();
+#endif
+
     // initialize IO (needed for all IO operations)
     IOInitGlobal();
 
@@ -281,13 +445,6 @@ void init(void)
     }
 #endif
 
-    enum {
-        FLASH_INIT_ATTEMPTED            = (1 << 0),
-        SD_INIT_ATTEMPTED               = (1 << 1),
-        SPI_AND_QSPI_INIT_ATTEMPTED      = (1 << 2),
-    };
-    uint8_t initFlags = 0;
-
 
 #ifdef CONFIG_IN_SDCARD
 
@@ -380,6 +537,8 @@ void init(void)
 
 #endif // CONFIG_IN_EXTERNAL_FLASH
 
+    timeUs_t stageStartUs = micros();
+
     initEEPROM();
 
     ensureEEPROMStructureIsValid();
@@ -396,6 +555,8 @@ void init(void)
 
     systemState |= SYSTEM_STATE_CONFIG_LOADED;
 
+    bootStageEnd(BOOT_STAGE_CONFIG, stageStartUs);
+
 #ifdef USE_BRUSHED_ESC_AUTODETECT
     // Now detect again with the actually configured pin for motor 1, if it is not the default pin.
     ioTag_t configuredMotorIoTag = motorConfig()->dev.ioTags[0];
@@ -533,7 +694,12 @@ void init(void)
     /* Motors needs to be initialized soon as posible because hardware initialization
      * may send spurious pulses to esc's causing their early initialization. Also ppm
      * receiver may share timer with motors so motors MUST be initialized here. */
-    motorDevInit(&motorConfig()->dev, idlePulse, getMotorCount());
+    // The selected protocol is applied to a copy, so that a save keeps the configured one. The copy
+    // stays valid after init as the motor drivers keep a pointer to it.
+    static motorDevConfig_t motorDevConfig;
+    motorDevConfig = motorConfig()->dev;
+    motorDevConfig.motorPwmProtocol = getMotorPwmProtocol();
+    motorDevInit(&motorDevConfig, idlePulse, getMotorCount());
     systemState |= SYSTEM_STATE_MOTORS_READY;
 #else
     UNUSED(idlePulse);
@@ -660,6 +826,7 @@ void init(void)
 
     initBoardAlignment(boardAlignment());
 
+    stageStartUs = micros();
     if (!sensorsAutodetect()) {
         // if gyro was not detected due to whatever reason, notify and don't arm.
         if (true
@@ -672,6 +839,12 @@ void init(void)
         setArmingDisabled(ARMING_DISABLED_NO_GYRO);
     }
 
+    bootStageEnd(BOOT_STAGE_GYRO, stageStartUs);
+
+    initStep(BOOT_STAGE_MAG, sensorsAutodetectMag);
+    initStep(BOOT_STAGE_BARO, initBaro);
+    initStep(BOOT_STAGE_RANGEFINDER, sensorsAutodetectRangefinder);
+
     systemState |= SYSTEM_STATE_SENSORS_READY;
 
     // gyro.targetLooptime set in sensorsAutodetect(),
@@ -712,7 +885,9 @@ void init(void)
     LED0_OFF;
     LED2_OFF;
 
-    for (int i = 0; i < 10; i++) {
+    // The boot signal only delays the start, fast_boot skips it
+    stageStartUs = micros();
+    for (int i = 0; i < (systemConfig()->fastBoot ? 0 : 10); i++) {
         LED1_TOGGLE;
         LED0_TOGGLE;
 #if defined(USE_BEEPER)
@@ -728,15 +903,22 @@ void init(void)
     }
     LED0_OFF;
     LED1_OFF;
+    bootStageEnd(BOOT_STAGE_SIGNAL, stageStartUs);
 
+    fastMathTablesInit();
     imuInit();
+#if defined(USE_BARO) || defined(USE_GPS)
+    positionInit();
+#endif
 
     mspInit();
     mspSerialInit();
 
     failsafeInit();
 
+    stageStartUs = micros();
     rxInit();
+    bootStageEnd(BOOT_STAGE_RX, stageStartUs);
 
 /*
  * CMS, display devices and OSD
@@ -746,28 +928,7 @@ void init(void)
 #endif
 
 #if (defined(USE_OSD) || (defined(USE_MSP_DISPLAYPORT) && defined(USE_CMS)))
-    displayPort_t *osdDisplayPort = NULL;
-#endif
-
-#if defined(USE_OSD)
-    //The OSD need to be initialised after GYRO to avoid GYRO initialisation failure on some targets
-
-    if (featureIsEnabled(FEATURE_OSD)) {
-#if defined(USE_MAX7456)
-        // If there is a max7456 chip for the OSD then use it
-        osdDisplayPort = max7456DisplayPortInit(vcdProfile());
-#elif defined(USE_CMS) && defined(USE_MSP_DISPLAYPORT) && defined(USE_OSD_OVER_MSP_DISPLAYPORT) // OSD over MSP; not supported (yet)
-        osdDisplayPort = displayPortMspInit();
-#endif
-        // osdInit  will register with CMS by itself.
-        osdInit(osdDisplayPort);
-    }
-#endif
-
-#if defined(USE_CMS) && defined(USE_MSP_DISPLAYPORT)
-    // If BFOSD is not active, then register MSP_DISPLAYPORT as a CMS device.
-    if (!osdDisplayPort)
-        cmsDisplayPortRegister(displayPortMspInit());
+    initStep(BOOT_STAGE_OSD, initOsdDisplay);
 #endif
 
 #ifdef USE_DASHBOARD
@@ -820,41 +981,16 @@ void init(void)
     }
 #endif
 
-#ifdef USE_FLASH_CHIP
-    if (!(initFlags & FLASH_INIT_ATTEMPTED)) {
-        flashInit(flashConfig());
-        initFlags |= FLASH_INIT_ATTEMPTED;
-    }
-#endif
-#ifdef USE_FLASHFS
-    flashfsInit();
-#endif
-
-#ifdef USE_BLACKBOX
-#ifdef USE_SDCARD
-    if (blackboxConfig()->device == BLACKBOX_DEVICE_SDCARD) {
-        if (sdcardConfig()->mode) {
-            if (!(initFlags & SD_INIT_ATTEMPTED)) {
-                initFlags |= SD_INIT_ATTEMPTED;
-                sdCardAndFSInit();
-            }
-        } else {
-            blackboxConfigMutable()->device = BLACKBOX_DEVICE_NONE;
-        }
-    }
-#endif
-    blackboxInit();
-#endif
+    initStep(BOOT_STAGE_STORAGE, initStorage);
 
 #ifdef USE_ACC
     if (mixerConfig()->mixerMode == MIXER_GIMBAL) {
         accSetCalibrationCycles(CALIBRATING_ACC_CYCLES);
     }
 #endif
-    gyroStartCalibration(false);
-#ifdef USE_BARO
-    baroSetCalibrationCycles(CALIBRATING_BARO_CYCLES);
-#endif
+    if (!gyroRestoreCalibration()) {
+        gyroStartCalibration(false);
+    }
 
 #if defined(USE_VTX_COMMON) || defined(USE_VTX_CONTROL)
     vtxTableInit();
@@ -922,13 +1058,28 @@ void init(void)
     motorEnable();
 #endif
 
+#ifdef USE_DSHOT_TELEMETRY
+    if (useDshotEdt) {
+        dshotCommandWrite(ALL_MOTORS, getMotorCount(), DSHOT_CMD_EXTENDED_TELEMETRY_ENABLE, false);
+    }
+#endif
+
 #ifdef USE_PERSISTENT_STATS
     statsInit();
 #endif
 
     setArmingDisabled(ARMING_DISABLED_BOOT_GRACE_TIME);
 
+#ifdef USE_GYRO_SPI_DMA
+    // Needs every device on the gyro bus to have been initialised, with fast_boot that is after the deferred steps
+    if (isInitDeferredComplete()) {
+        sensorsGyroSpiDmaStart();
+    }
+#endif
+
     fcTasksInit();
 
+    bootSchedulerStartUs = micros();
+
     systemState |= SYSTEM_STATE_READY;
 }
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "common/time.h"
+
 typedef enum {
     SYSTEM_STATE_INITIALISING   = 0,
     SYSTEM_STATE_CONFIG_LOADED  = (1 << 0),
@@ -31,5 +33,28 @@ typedef enum {
 
 extern uint8_t systemState;
 
+typedef enum {
+    BOOT_STAGE_CONFIG = 0,
+    BOOT_STAGE_GYRO,
+    BOOT_STAGE_MAG,
+    BOOT_STAGE_BARO,
+    BOOT_STAGE_RANGEFINDER,
+    BOOT_STAGE_SIGNAL,          // LED and beeper boot signal
+    BOOT_STAGE_RX,
+    BOOT_STAGE_OSD,
+    BOOT_STAGE_STORAGE,
+    BOOT_STAGE_COUNT
+} bootStage_e;
+
+typedef struct bootStageTime_s {
+    const char *name;
+    uint32_t durationUs;
+    bool deferred;              // run by the fast boot after the scheduler started
+} bootStageTime_t;
+
 void init(void);
+const bootStageTime_t *getBootStageTime(bootStage_e stage);
+timeUs_t getBootSchedulerStartUs(void);
+bool isInitDeferredComplete(void);
+void initDeferredUpdate(timeUs_t currentTimeUs);
 void processLoopback(void);
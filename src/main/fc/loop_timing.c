@@ -0,0 +1,138 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_LOOP_TIMING
+
+#include "common/maths.h"
+
+#include "fc/loop_timing.h"
+
+typedef struct loopTimingWindow_s {
+    uint32_t count;
+    uint32_t sumUs;
+    timeDelta_t minUs;
+    timeDelta_t maxUs;
+    uint16_t histogram[LOOP_TIMING_BUCKET_COUNT];
+} loopTimingWindow_t;
+
+static loopTimingWindow_t loopTimingWindows[LOOP_TIMING_COUNT];
+// Only written by the PID loop at the end of a window, readers may see a mix of two windows
+static loopTimingStats_t loopTimingStats[LOOP_TIMING_COUNT];
+
+static timeUs_t windowStartUs;
+static timeUs_t lastLoopStartUs;
+static timeUs_t pidStartUs;
+
+static FAST_CODE void loopTimingRecord(loopTimingMetric_e metric, timeDelta_t timeUs)
+{
+    loopTimingWindow_t *window = &loopTimingWindows[metric];
+
+    timeUs = MAX(timeUs, 0);
+    if (window->count == 0 || timeUs < window->minUs) {
+        window->minUs = timeUs;
+    }
+    if (timeUs > window->maxUs) {
+        window->maxUs = timeUs;
+    }
+    window->sumUs += timeUs;
+    window->count++;
+    window->histogram[MIN(timeUs, LOOP_TIMING_BUCKET_COUNT - 1)]++;
+}
+
+static void loopTimingPublish(loopTimingMetric_e metric)
+{
+    loopTimingWindow_t *window = &loopTimingWindows[metric];
+    loopTimingStats_t *stats = &loopTimingStats[metric];
+
+    if (window->count == 0) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    // the first bucket at which 99% of the samples are accounted for
+    const uint32_t rank = window->count - window->count / 100;
+    uint32_t samples = 0;
+    int bucket = 0;
+    while (bucket < LOOP_TIMING_BUCKET_COUNT - 1 && (samples += window->histogram[bucket]) < rank) {
+        bucket++;
+    }
+
+    stats->minUs = MIN(window->minUs, UINT16_MAX);
+    stats->avgUs = MIN(window->sumUs / window->count, (uint32_t)UINT16_MAX);
+    stats->maxUs = MIN(window->maxUs, UINT16_MAX);
+    // the open ended bucket only bounds the percentile by the maximum
+    stats->p99Us = bucket == LOOP_TIMING_BUCKET_COUNT - 1 ? stats->maxUs : bucket;
+
+    memset(window, 0, sizeof(*window));
+}
+
+FAST_CODE void loopTimingLoopStarted(timeUs_t currentTimeUs, timeDelta_t targetLooptimeUs)
+{
+    if (lastLoopStartUs) {
+        loopTimingRecord(LOOP_TIMING_JITTER, abs(cmpTimeUs(currentTimeUs, lastLoopStartUs) - targetLooptimeUs));
+    } else {
+        windowStartUs = currentTimeUs;
+    }
+    lastLoopStartUs = currentTimeUs;
+
+    if (cmpTimeUs(currentTimeUs, windowStartUs) >= LOOP_TIMING_WINDOW_US) {
+        for (int metric = 0; metric < LOOP_TIMING_COUNT; metric++) {
+            loopTimingPublish(metric);
+        }
+        windowStartUs = currentTimeUs;
+    }
+}
+
+// gyroSampleTimeUs is 0 when the gyro has no data ready interrupt to timestamp its samples
+FAST_CODE void loopTimingPidStarted(timeUs_t currentTimeUs, timeUs_t gyroSampleTimeUs)
+{
+    if (gyroSampleTimeUs) {
+        loopTimingRecord(LOOP_TIMING_GYRO_TO_PID, cmpTimeUs(currentTimeUs, gyroSampleTimeUs));
+    }
+    pidStartUs = currentTimeUs;
+}
+
+FAST_CODE void loopTimingMotorsWritten(timeUs_t currentTimeUs)
+{
+    loopTimingRecord(LOOP_TIMING_PID_TO_MOTOR, cmpTimeUs(currentTimeUs, pidStartUs));
+}
+
+const loopTimingStats_t *loopTimingGetStats(loopTimingMetric_e metric)
+{
+    return metric < LOOP_TIMING_COUNT ? &loopTimingStats[metric] : NULL;
+}
+
+void loopTimingReset(void)
+{
+    memset(loopTimingWindows, 0, sizeof(loopTimingWindows));
+    memset(loopTimingStats, 0, sizeof(loopTimingStats));
+    lastLoopStartUs = 0;
+    pidStartUs = 0;
+}
+
+#endif
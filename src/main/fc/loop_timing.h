@@ -0,0 +1,50 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "common/time.h"
+
+// Timings taken on every pass of the gyro and PID loop
+typedef enum {
+    LOOP_TIMING_JITTER = 0,     // difference between the loop period and the gyro looptime
+    LOOP_TIMING_GYRO_TO_PID,    // gyro data ready interrupt to the start of the PID controller
+    LOOP_TIMING_PID_TO_MOTOR,   // start of the PID controller to the motor outputs being handed to the DMA
+    LOOP_TIMING_COUNT
+} loopTimingMetric_e;
+
+#define LOOP_TIMING_WINDOW_US       1000000
+// Bucket n of the window histogram holds n us, the last bucket is open ended
+#define LOOP_TIMING_BUCKET_COUNT    128
+
+// Summary of the last complete window, all 0 until the first window completes
+typedef struct loopTimingStats_s {
+    uint16_t minUs;
+    uint16_t avgUs;
+    uint16_t maxUs;
+    uint16_t p99Us;
+} loopTimingStats_t;
+
+void loopTimingLoopStarted(timeUs_t currentTimeUs, timeDelta_t targetLooptimeUs);
+void loopTimingPidStarted(timeUs_t currentTimeUs, timeUs_t gyroSampleTimeUs);
+void loopTimingMotorsWritten(timeUs_t currentTimeUs);
+const loopTimingStats_t *loopTimingGetStats(loopTimingMetric_e metric);
+void loopTimingReset(void);
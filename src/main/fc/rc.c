@@ -38,6 +38,7 @@
 #include "fc/core.h"
 #include "fc/rc.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
 
@@ -66,6 +67,7 @@ static float throttlePIDAttenuation;
 static bool reverseMotors = false;
 static applyRatesFn *applyRates;
 uint16_t currentRxRefreshRate;
+timeUs_t currentRxFrameTimeUs;      // arrival time of the latest rx frame, as timestamped by the receiver driver when it can
 
 FAST_RAM_ZERO_INIT uint8_t interpolationChannels;
 static FAST_RAM_ZERO_INIT uint32_t rcFrameNumber;
@@ -81,10 +83,9 @@ enum {
 #define RC_SMOOTHING_IDENTITY_FREQUENCY         80    // Used in the formula to convert a BIQUAD cutoff frequency to PT1
 #define RC_SMOOTHING_FILTER_STARTUP_DELAY_MS    5000  // Time to wait after power to let the PID loop stabilize before starting average frame rate calculation
 #define RC_SMOOTHING_FILTER_TRAINING_SAMPLES    50    // Number of rx frame rate samples to average during initial training
-#define RC_SMOOTHING_FILTER_RETRAINING_SAMPLES  20    // Number of rx frame rate samples to average during frame rate changes
 #define RC_SMOOTHING_FILTER_TRAINING_DELAY_MS   1000  // Additional time to wait after receiving first valid rx frame before initial training starts
-#define RC_SMOOTHING_FILTER_RETRAINING_DELAY_MS 2000  // Guard time to wait after retraining to prevent retraining again too quickly
-#define RC_SMOOTHING_RX_RATE_CHANGE_PERCENT     20    // Look for samples varying this much from the current detected frame rate to initiate retraining
+#define RC_SMOOTHING_RX_RATE_TRACKING_GAIN      0.05f // Weight of each rx frame interval in the continuously tracked frame time, a single dropped frame moves it 5%
+#define RC_SMOOTHING_RX_RATE_CHANGE_PERCENT     20    // Re-derive the cutoffs once the tracked frame time moves this much from the one they were calculated for
 #define RC_SMOOTHING_RX_RATE_MIN_US             1000  // 1ms
 #define RC_SMOOTHING_RX_RATE_MAX_US             50000 // 50ms or 20hz
 
@@ -191,9 +192,38 @@ float applyKissRates(const int axis, float rcCommandf, const float rcCommandfAbs
     return kissAngle;
 }
 
+// The rate curves are odd functions of the stick deflection, the lookup covers
+// deflections [0;1] in RATES_LOOKUP_LENGTH - 1 segments, interpolated linearly
+#define RATES_LOOKUP_LENGTH 129
+static FAST_RAM_ZERO_INIT float lookupRatesRC[XYZ_AXIS_COUNT][RATES_LOOKUP_LENGTH];
+static FAST_RAM_ZERO_INIT uint8_t lookupRatesPending;    // axes whose lookup table is out of date
+
+static void generateRatesLookup(int axis)
+{
+    for (int i = 0; i < RATES_LOOKUP_LENGTH; i++) {
+        const float rcCommandfAbs = (float)i / (RATES_LOOKUP_LENGTH - 1);
+        lookupRatesRC[axis][i] = applyRates(axis, rcCommandfAbs, rcCommandfAbs);
+    }
+    lookupRatesPending &= ~(1 << axis);
+}
+
+static float rcLookupRates(int axis, float rcCommandf, float rcCommandfAbs)
+{
+    // the table is rebuilt from updateRcCommands(), until then use the curve itself
+    if (lookupRatesPending & (1 << axis)) {
+        return applyRates(axis, rcCommandf, rcCommandfAbs);
+    }
+
+    const float position = MIN(rcCommandfAbs, 1.0f) * (RATES_LOOKUP_LENGTH - 1);
+    const int index = MIN((int)position, RATES_LOOKUP_LENGTH - 2);
+    const float angleRate = lookupRatesRC[axis][index] + (lookupRatesRC[axis][index + 1] - lookupRatesRC[axis][index]) * (position - index);
+
+    return rcCommandf < 0 ? -angleRate : angleRate;
+}
+
 float applyCurve(int axis, float deflection)
 {
-    return applyRates(axis, deflection, fabsf(deflection));
+    return rcLookupRates(axis, deflection, fabsf(deflection));
 }
 
 float getRcCurveSlope(int axis, float deflection)
@@ -223,7 +253,7 @@ static void calculateSetpointRate(int axis)
         const float rcCommandfAbs = fabsf(rcCommandf);
         rcDeflectionAbs[axis] = rcCommandfAbs;
 
-        angleRate = applyRates(axis, rcCommandf, rcCommandfAbs);
+        angleRate = rcLookupRates(axis, rcCommandf, rcCommandfAbs);
     }
     // Rate limit from profile (deg/sec)
     setpointRate[axis] = constrainf(angleRate, -1.0f * currentControlRateProfile->rate_limit[axis], 1.0f * currentControlRateProfile->rate_limit[axis]);
@@ -282,6 +312,7 @@ FAST_CODE uint8_t processRcInterpolation(void)
 {
     static FAST_RAM_ZERO_INIT float rcCommandInterp[4];
     static FAST_RAM_ZERO_INIT float rcStepSize[4];
+    static FAST_RAM_ZERO_INIT float rcCommandPreviousFrame[4];
     static FAST_RAM_ZERO_INIT int16_t rcInterpolationStepCount;
 
     uint16_t rxRefreshRate;
@@ -296,6 +327,9 @@ FAST_CODE uint8_t processRcInterpolation(void)
         case RC_SMOOTHING_MANUAL:
             rxRefreshRate = 1000 * rxConfig()->rcInterpolationInterval;
             break;
+        case RC_SMOOTHING_PREDICT:
+            rxRefreshRate = currentRxRefreshRate;
+            break;
         case RC_SMOOTHING_OFF:
         case RC_SMOOTHING_DEFAULT:
         default:
@@ -305,9 +339,28 @@ FAST_CODE uint8_t processRcInterpolation(void)
         if (isRXDataNew && rxRefreshRate > 0) {
             rcInterpolationStepCount = rxRefreshRate / targetPidLooptime;
 
-            for (int channel = 0; channel < PRIMARY_CHANNEL_COUNT; channel++) {
-                if ((1 << channel) & interpolationChannels) {
-                    rcStepSize[channel] = (rcCommand[channel] - rcCommandInterp[channel]) / (float)rcInterpolationStepCount;
+            if (rxConfig()->rcInterpolation == RC_SMOOTHING_PREDICT) {
+                // Rather than ramping towards the new frame over the next frame interval, continue
+                // along the slope of the last frame until the next one is due. The extrapolation
+                // starts from the time the receiver driver reports the frame actually arrived.
+                timeDelta_t frameAgeUs = 0;
+                rxGetFrameDelta(&frameAgeUs);
+                const float frameAge = constrainf((float)frameAgeUs / rxRefreshRate, 0.0f, 1.0f);
+
+                for (int channel = 0; channel < PRIMARY_CHANNEL_COUNT; channel++) {
+                    if ((1 << channel) & interpolationChannels) {
+                        const float frameChange = rcCommand[channel] - rcCommandPreviousFrame[channel];
+                        rcCommandPreviousFrame[channel] = rcCommand[channel];
+                        rcCommandInterp[channel] = rcCommand[channel] + frameChange * frameAge;
+                        rcStepSize[channel] = frameChange / (float)rcInterpolationStepCount;
+                    }
+                }
+                rcInterpolationStepCount -= lrintf(frameAge * rcInterpolationStepCount);
+            } else {
+                for (int channel = 0; channel < PRIMARY_CHANNEL_COUNT; channel++) {
+                    if ((1 << channel) & interpolationChannels) {
+                        rcStepSize[channel] = (rcCommand[channel] - rcCommandInterp[channel]) / (float)rcInterpolationStepCount;
+                    }
                 }
             }
 
@@ -431,16 +484,31 @@ FAST_CODE bool rcSmoothingAccumulateSample(rcSmoothingFilter_t *smoothingData, i
     smoothingData->training.min = MIN(smoothingData->training.min, rxFrameTimeUs);
 
     // if we've collected enough samples then calculate the average and reset the accumulation
-    const int sampleLimit = (rcSmoothingData.filterInitialized) ? RC_SMOOTHING_FILTER_RETRAINING_SAMPLES : RC_SMOOTHING_FILTER_TRAINING_SAMPLES;
-    if (smoothingData->training.count >= sampleLimit) {
+    if (smoothingData->training.count >= RC_SMOOTHING_FILTER_TRAINING_SAMPLES) {
         smoothingData->training.sum = smoothingData->training.sum - smoothingData->training.min - smoothingData->training.max; // Throw out high and low samples
         smoothingData->averageFrameTimeUs = lrintf(smoothingData->training.sum / (smoothingData->training.count - 2));
+        smoothingData->trackedFrameTimeUs = smoothingData->averageFrameTimeUs;
         rcSmoothingResetAccumulation(smoothingData);
         return true;
     }
     return false;
 }
 
+// Once trained keep following the rx frame time, so that link rate changes (like CRSF switching
+// between 50/150/500Hz) are picked up within a few frames. Returns true when the tracked frame time
+// has moved far enough from the one the cutoffs were calculated for that they need to be recalculated.
+FAST_CODE bool rcSmoothingTrackSample(rcSmoothingFilter_t *smoothingData, int rxFrameTimeUs)
+{
+    smoothingData->trackedFrameTimeUs += RC_SMOOTHING_RX_RATE_TRACKING_GAIN * (rxFrameTimeUs - smoothingData->trackedFrameTimeUs);
+
+    const float percentChange = (fabsf(smoothingData->trackedFrameTimeUs - smoothingData->averageFrameTimeUs) / smoothingData->averageFrameTimeUs) * 100;
+    if (percentChange >= RC_SMOOTHING_RX_RATE_CHANGE_PERCENT) {
+        smoothingData->averageFrameTimeUs = lrintf(smoothingData->trackedFrameTimeUs);
+        return true;
+    }
+    return false;
+}
+
 // Determine if we need to caclulate filter cutoffs. If not then we can avoid
 // examining the rx frame times completely 
 FAST_CODE_NOINLINE bool rcSmoothingAutoCalculate(void)
@@ -516,40 +584,25 @@ FAST_CODE uint8_t processRcSmoothingFilter(void)
             if ((currentTimeMs > RC_SMOOTHING_FILTER_STARTUP_DELAY_MS) && (targetPidLooptime > 0)) { // skip during FC initialization
                 if (rxIsReceivingSignal()  && rcSmoothingRxRateValid(currentRxRefreshRate)) {
 
-                    // set the guard time expiration if it's not set
-                    if (validRxFrameTimeMs == 0) {
-                        validRxFrameTimeMs = currentTimeMs + (rcSmoothingData.filterInitialized ? RC_SMOOTHING_FILTER_RETRAINING_DELAY_MS : RC_SMOOTHING_FILTER_TRAINING_DELAY_MS);
-                    } else {
-                        sampleState = 1;
-                    }
-
-                    // if the guard time has expired then process the rx frame time
-                    if (currentTimeMs > validRxFrameTimeMs) {
-                        sampleState = 2;
-                        bool accumulateSample = true;
-
-                        // During initial training process all samples.
-                        // During retraining check samples to determine if they vary by more than the limit percentage.
-                        if (rcSmoothingData.filterInitialized) {
-                            const float percentChange = (ABS(currentRxRefreshRate - rcSmoothingData.averageFrameTimeUs) / (float)rcSmoothingData.averageFrameTimeUs) * 100;
-                            if (percentChange < RC_SMOOTHING_RX_RATE_CHANGE_PERCENT) {
-                                // We received a sample that wasn't more than the limit percent so reset the accumulation
-                                // During retraining we need a contiguous block of samples that are all significantly different than the current average
-                                rcSmoothingResetAccumulation(&rcSmoothingData);
-                                accumulateSample = false;
-                            }
+                    if (rcSmoothingData.filterInitialized) {
+                        // the filters are trained, follow the link rate with every frame
+                        sampleState = 3;
+                        if (rcSmoothingTrackSample(&rcSmoothingData, currentRxRefreshRate)) {
+                            rcSmoothingSetFilterCutoffs(&rcSmoothingData);
                         }
-
-                        // accumlate the sample into the average
-                        if (accumulateSample) {
-                            if (rcSmoothingAccumulateSample(&rcSmoothingData, currentRxRefreshRate)) {
-                                // the required number of samples were collected so set the filter cutoffs
-                                rcSmoothingSetFilterCutoffs(&rcSmoothingData);
-                                rcSmoothingData.filterInitialized = true;
-                                validRxFrameTimeMs = 0;
-                            }
+                    } else if (validRxFrameTimeMs == 0) {
+                        // set the guard time expiration if it's not set
+                        validRxFrameTimeMs = currentTimeMs + RC_SMOOTHING_FILTER_TRAINING_DELAY_MS;
+                    } else if (currentTimeMs > validRxFrameTimeMs) {
+                        // the guard time has expired so accumulate the rx frame time into the initial average
+                        sampleState = 2;
+                        if (rcSmoothingAccumulateSample(&rcSmoothingData, currentRxRefreshRate)) {
+                            // the required number of samples were collected so set the filter cutoffs
+                            rcSmoothingSetFilterCutoffs(&rcSmoothingData);
+                            rcSmoothingData.filterInitialized = true;
                         }
-
+                    } else {
+                        sampleState = 1;
                     }
                 } else {
                     // we have either stopped receiving rx samples (failsafe?) or the sample time is unreasonable so reset the accumulation
@@ -562,7 +615,7 @@ FAST_CODE uint8_t processRcSmoothingFilter(void)
                 DEBUG_SET(DEBUG_RC_SMOOTHING_RATE, 0, currentRxRefreshRate);              // log each rx frame interval
                 DEBUG_SET(DEBUG_RC_SMOOTHING_RATE, 1, rcSmoothingData.training.count);    // log the training step count
                 DEBUG_SET(DEBUG_RC_SMOOTHING_RATE, 2, rcSmoothingData.averageFrameTimeUs);// the current calculated average
-                DEBUG_SET(DEBUG_RC_SMOOTHING_RATE, 3, sampleState);                       // indicates whether guard time is active
+                DEBUG_SET(DEBUG_RC_SMOOTHING_RATE, 3, sampleState);                       // indicates whether guard time is active or the rate is being tracked
             }
         }
     }
@@ -621,7 +674,7 @@ FAST_CODE void processRcCommand(void)
             oldRcCommand[i] = rcCommand[i];
             const float rcCommandf = rcCommand[i] / 500.0f;
             const float rcCommandfAbs = fabsf(rcCommandf);
-            rawSetpoint[i] = applyRates(i, rcCommandf, rcCommandfAbs);
+            rawSetpoint[i] = rcLookupRates(i, rcCommandf, rcCommandfAbs);
             rawDeflection[i] = rcCommandf;
         }
     }
@@ -662,11 +715,22 @@ FAST_CODE void processRcCommand(void)
 
     if (isRXDataNew) {
         isRXDataNew = false;
+#ifdef USE_RC_LATENCY
+        rcLatencyStageReached(RC_LATENCY_STAGE_SETPOINT, micros());
+#endif
     }
 }
 
 FAST_CODE_NOINLINE void updateRcCommands(void)
 {
+    // rebuild the rate curve lookup left out of date by initRcProcessing(), one axis per rx frame
+    for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+        if (lookupRatesPending & (1 << axis)) {
+            generateRatesLookup(axis);
+            break;
+        }
+    }
+
     // PITCH & ROLL only dynamic PID adjustment,  depending on throttle value
     int32_t prop;
     if (rcData[THROTTLE] < currentControlRateProfile->tpa_breakpoint) {
@@ -796,6 +860,7 @@ void initRcProcessing(void)
 
         break;
     }
+    lookupRatesPending = (1 << XYZ_AXIS_COUNT) - 1;
 
     interpolationChannels = 0;
     switch (rxConfig()->rcInterpolationChannels) {
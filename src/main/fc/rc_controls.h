@@ -58,7 +58,8 @@ typedef enum {
     RC_SMOOTHING_OFF = 0,
     RC_SMOOTHING_DEFAULT,
     RC_SMOOTHING_AUTO,
-    RC_SMOOTHING_MANUAL
+    RC_SMOOTHING_MANUAL,
+    RC_SMOOTHING_PREDICT
 } rcSmoothing_t;
 
 typedef enum {
@@ -126,6 +127,7 @@ typedef struct rcSmoothingFilter_s {
     uint8_t derivativeCutoffSetting;
     uint16_t derivativeCutoffFrequency;
     int averageFrameTimeUs;
+    float trackedFrameTimeUs;
     rcSmoothingFilterTraining_t training;
     uint8_t debugAxis;
     uint8_t autoSmoothnessFactor;
@@ -0,0 +1,94 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_RC_LATENCY
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+
+#include "fc/rc_latency.h"
+
+// DEBUG_RC_LATENCY, latency of the last frame in us to:
+// 0 - RC_LATENCY_STAGE_RX
+// 1 - RC_LATENCY_STAGE_SETPOINT
+// 2 - RC_LATENCY_STAGE_MOTOR
+
+#define RC_LATENCY_ALL_STAGES ((1 << RC_LATENCY_STAGE_COUNT) - 1)
+
+static rcLatencyStats_t rcLatencyStats[RC_LATENCY_STAGE_COUNT];
+
+static volatile timeUs_t frameTimeUs;
+// Stages the last frame has not reached yet, one bit per stage
+static volatile uint8_t pendingStages;
+
+// Called with the time the receiver driver timestamped the frame, or the time it was found complete
+void rcLatencyFrameReceived(timeUs_t timeUs)
+{
+    // The PID loop may run from the gyro interrupt, so the frame is withdrawn while its time changes
+    pendingStages = 0;
+    frameTimeUs = timeUs;
+    pendingStages = RC_LATENCY_ALL_STAGES;
+}
+
+FAST_CODE void rcLatencyStageReached(rcLatencyStage_e stage, timeUs_t currentTimeUs)
+{
+    const uint8_t stageMask = 1 << stage;
+
+    // A stage only counts once all the stages before it were reached with the same frame
+    if ((pendingStages & (stageMask | (stageMask - 1))) != stageMask) {
+        return;
+    }
+    pendingStages &= ~stageMask;
+
+    rcLatencyStats_t *stats = &rcLatencyStats[stage];
+    const timeDelta_t latencyUs = MAX(cmpTimeUs(currentTimeUs, frameTimeUs), 0);
+    const int bucket = MIN(latencyUs / RC_LATENCY_BUCKET_WIDTH_US, RC_LATENCY_BUCKET_COUNT - 1);
+
+    if (stats->histogram[bucket] == UINT16_MAX) {
+        // Halving all buckets when one saturates keeps the shape of the distribution
+        for (int i = 0; i < RC_LATENCY_BUCKET_COUNT; i++) {
+            stats->histogram[i] >>= 1;
+        }
+    }
+    stats->histogram[bucket]++;
+    stats->lastLatencyUs = latencyUs;
+
+    DEBUG_SET(DEBUG_RC_LATENCY, stage, latencyUs);
+}
+
+const rcLatencyStats_t *rcLatencyGetStats(rcLatencyStage_e stage)
+{
+    return stage < RC_LATENCY_STAGE_COUNT ? &rcLatencyStats[stage] : NULL;
+}
+
+void rcLatencyReset(void)
+{
+    memset(rcLatencyStats, 0, sizeof(rcLatencyStats));
+}
+
+#endif
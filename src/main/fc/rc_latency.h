@@ -0,0 +1,46 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "common/time.h"
+
+// Stages an RC frame goes through between its arrival and the motor outputs it affects
+typedef enum {
+    RC_LATENCY_STAGE_RX = 0,    // channels read and rcCommand updated by the RX task
+    RC_LATENCY_STAGE_SETPOINT,  // setpoint rate calculated for the PID controller
+    RC_LATENCY_STAGE_MOTOR,     // motor outputs written
+    RC_LATENCY_STAGE_COUNT
+} rcLatencyStage_e;
+
+// Bucket n holds latencies of [n, n + 1) * RC_LATENCY_BUCKET_WIDTH_US since the frame arrived, the last bucket is open ended
+#define RC_LATENCY_BUCKET_COUNT     32
+#define RC_LATENCY_BUCKET_WIDTH_US  100
+
+typedef struct rcLatencyStats_s {
+    timeDelta_t lastLatencyUs;
+    uint16_t histogram[RC_LATENCY_BUCKET_COUNT];
+} rcLatencyStats_t;
+
+void rcLatencyFrameReceived(timeUs_t frameTimeUs);
+void rcLatencyStageReached(rcLatencyStage_e stage, timeUs_t currentTimeUs);
+const rcLatencyStats_t *rcLatencyGetStats(rcLatencyStage_e stage);
+void rcLatencyReset(void);
@@ -46,11 +46,37 @@ boxBitmask_t rcModeActivationMask; // one bit per mode defined in boxId_e
 static boxBitmask_t stickyModesEverDisabled;
 
 static bool airmodeEnabled;
+static uint8_t rcModeChangeCount;
 
 static int activeMacCount = 0;
 static uint8_t activeMacArray[MAX_MODE_ACTIVATION_CONDITION_COUNT];
 static int activeLinkedMacCount = 0;
 static uint8_t activeLinkedMacArray[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+static int activeStickyMacCount = 0;
+static uint8_t activeStickyMacArray[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+
+// The range conditions compiled by analyzeModeActivationConditions(), grouped by aux channel
+typedef struct modeRange_s {
+    uint8_t modeId;
+    bool andLogic;
+    bool active;
+    uint16_t minValue;      // active for channel values in [minValue, maxValue)
+    uint16_t maxValue;
+} modeRange_t;
+
+static modeRange_t modeRanges[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+static uint8_t auxChannelRangeStart[MAX_AUX_CHANNEL_COUNT + 1];    // the ranges of channel i are [start[i], start[i + 1])
+static int activeAuxChannelCount;
+static uint8_t activeAuxChannels[MAX_AUX_CHANNEL_COUNT];
+static uint16_t auxChannelValue[MAX_AUX_CHANNEL_COUNT];            // value the ranges of the channel were last evaluated at
+
+// Number of active OR, AND and inactive AND conditions per mode, they give the masks the ranges
+// contribute without going through all of them
+static uint8_t modeOrActiveCount[CHECKBOX_ITEM_COUNT];
+static uint8_t modeAndCount[CHECKBOX_ITEM_COUNT];
+static uint8_t modeAndInactiveCount[CHECKBOX_ITEM_COUNT];
+static boxBitmask_t rangeAndMask;
+static boxBitmask_t rangeNewMask;
 
 PG_REGISTER_ARRAY(modeActivationCondition_t, MAX_MODE_ACTIVATION_CONDITION_COUNT, modeActivationConditions, PG_MODE_ACTIVATION_PROFILE, 2);
 
@@ -61,7 +87,17 @@ bool IS_RC_MODE_ACTIVE(boxId_e boxId)
 
 void rcModeUpdate(boxBitmask_t *newState)
 {
-    rcModeActivationMask = *newState;
+    if (memcmp(&rcModeActivationMask, newState, sizeof(rcModeActivationMask))) {
+        rcModeActivationMask = *newState;
+        rcModeChangeCount++;
+    }
+}
+
+// Changes when a mode or the mode activation conditions change, for the checks that only
+// depend on them
+uint8_t getRcModeChangeCount(void)
+{
+    return rcModeChangeCount;
 }
 
 bool airmodeIsEnabled(void) {
@@ -126,25 +162,69 @@ void updateMasksForStickyModes(const modeActivationCondition_t *mac, boxBitmask_
     }
 }
 
-void updateActivatedModes(void)
+static bool isStickyMode(boxId_e modeId)
 {
-    boxBitmask_t newMask, andMask, stickyModes;
-    memset(&andMask, 0, sizeof(andMask));
-    memset(&newMask, 0, sizeof(newMask));
-    memset(&stickyModes, 0, sizeof(stickyModes));
-    bitArraySet(&stickyModes, BOXPARALYZE);
+    return modeId == BOXPARALYZE;
+}
 
-    // determine which conditions set/clear the mode
-    for (int i = 0; i < activeMacCount; i++) {
-        const modeActivationCondition_t *mac = modeActivationConditions(activeMacArray[i]);
+static void bitArrayAssign(boxBitmask_t *mask, boxId_e modeId, bool value)
+{
+    if (value) {
+        bitArraySet(mask, modeId);
+    } else {
+        bitArrayClr(mask, modeId);
+    }
+}
 
-        if (bitArrayGet(&stickyModes, mac->modeId)) {
-            updateMasksForStickyModes(mac, &andMask, &newMask);
-        } else if (mac->modeId < CHECKBOX_ITEM_COUNT) {
-            bool bActive = isRangeActive(mac->auxChannelIndex, &mac->range);
-            updateMasksForMac(mac, &andMask, &newMask, bActive);
+// The masks updateMasksForMac() leaves for the range conditions of a mode, whatever their order
+static void updateRangeMasks(boxId_e modeId)
+{
+    const bool orActive = modeOrActiveCount[modeId] > 0;
+    const bool andLatched = !orActive && modeAndCount[modeId] > 0;
+
+    bitArrayAssign(&rangeAndMask, modeId, andLatched);
+    bitArrayAssign(&rangeNewMask, modeId, orActive || (andLatched && modeAndInactiveCount[modeId] > 0));
+}
+
+// Only the ranges of the aux channels that moved since the last frame are evaluated
+static void updateRangeModes(void)
+{
+    for (int i = 0; i < activeAuxChannelCount; i++) {
+        const int auxChannelIndex = activeAuxChannels[i];
+        const uint16_t channelValue = constrain(rcData[auxChannelIndex + NON_AUX_CHANNEL_COUNT], CHANNEL_RANGE_MIN, CHANNEL_RANGE_MAX - 1);
+        if (channelValue == auxChannelValue[auxChannelIndex]) {
+            continue;
+        }
+        auxChannelValue[auxChannelIndex] = channelValue;
+
+        for (int j = auxChannelRangeStart[auxChannelIndex]; j < auxChannelRangeStart[auxChannelIndex + 1]; j++) {
+            modeRange_t *range = &modeRanges[j];
+            const bool active = channelValue >= range->minValue && channelValue < range->maxValue;
+            if (active == range->active) {
+                continue;
+            }
+            range->active = active;
+
+            if (range->andLogic) {
+                modeAndInactiveCount[range->modeId] += active ? -1 : 1;
+            } else {
+                modeOrActiveCount[range->modeId] += active ? 1 : -1;
+            }
+            updateRangeMasks(range->modeId);
         }
     }
+}
+
+void updateActivatedModes(void)
+{
+    updateRangeModes();
+
+    boxBitmask_t newMask = rangeNewMask;
+    boxBitmask_t andMask = rangeAndMask;
+
+    for (int i = 0; i < activeStickyMacCount; i++) {
+        updateMasksForStickyModes(modeActivationConditions(activeStickyMacArray[i]), &andMask, &newMask);
+    }
 
     // Update linked modes
     for (int i = 0; i < activeLinkedMacCount; i++) {
@@ -220,6 +300,58 @@ bool isModeActivationConditionConfigured(const modeActivationCondition_t *mac, c
     }
 }
 
+// Compiles the range conditions into a table per aux channel, all inactive until their channel
+// is first evaluated, with the counts updateRangeModes() keeps from there
+static void compileModeRanges(void)
+{
+    uint8_t channelRangeCount[MAX_AUX_CHANNEL_COUNT];
+    memset(channelRangeCount, 0, sizeof(channelRangeCount));
+    memset(modeOrActiveCount, 0, sizeof(modeOrActiveCount));
+    memset(modeAndCount, 0, sizeof(modeAndCount));
+    memset(modeAndInactiveCount, 0, sizeof(modeAndInactiveCount));
+
+    for (int i = 0; i < activeMacCount; i++) {
+        const modeActivationCondition_t *mac = modeActivationConditions(activeMacArray[i]);
+        if (mac->modeLogic == MODELOGIC_AND) {
+            modeAndCount[mac->modeId]++;
+            modeAndInactiveCount[mac->modeId]++;
+        }
+        // a condition on a channel that does not exist stays inactive
+        if (mac->auxChannelIndex < MAX_AUX_CHANNEL_COUNT) {
+            channelRangeCount[mac->auxChannelIndex]++;
+        }
+    }
+
+    activeAuxChannelCount = 0;
+    auxChannelRangeStart[0] = 0;
+    for (int i = 0; i < MAX_AUX_CHANNEL_COUNT; i++) {
+        auxChannelRangeStart[i + 1] = auxChannelRangeStart[i] + channelRangeCount[i];
+        if (channelRangeCount[i]) {
+            activeAuxChannels[activeAuxChannelCount++] = i;
+        }
+        auxChannelValue[i] = 0;
+    }
+
+    for (int i = 0; i < activeMacCount; i++) {
+        const modeActivationCondition_t *mac = modeActivationConditions(activeMacArray[i]);
+        if (mac->auxChannelIndex < MAX_AUX_CHANNEL_COUNT) {
+            // an unusable range has minValue >= maxValue and is never active, as in isRangeActive()
+            modeRange_t *range = &modeRanges[auxChannelRangeStart[mac->auxChannelIndex + 1] - channelRangeCount[mac->auxChannelIndex]--];
+            range->modeId = mac->modeId;
+            range->andLogic = mac->modeLogic == MODELOGIC_AND;
+            range->active = false;
+            range->minValue = MODE_STEP_TO_CHANNEL_VALUE(mac->range.startStep);
+            range->maxValue = MODE_STEP_TO_CHANNEL_VALUE(mac->range.endStep);
+        }
+    }
+
+    memset(&rangeAndMask, 0, sizeof(rangeAndMask));
+    memset(&rangeNewMask, 0, sizeof(rangeNewMask));
+    for (int i = 0; i < CHECKBOX_ITEM_COUNT; i++) {
+        updateRangeMasks(i);
+    }
+}
+
 // Build the list of used modeActivationConditions indices
 // We can then use this to speed up processing by only evaluating used conditions
 void analyzeModeActivationConditions(void)
@@ -229,13 +361,19 @@ void analyzeModeActivationConditions(void)
 
     activeMacCount = 0;
     activeLinkedMacCount = 0;
+    activeStickyMacCount = 0;
 
     for (uint8_t i = 0; i < MAX_MODE_ACTIVATION_CONDITION_COUNT; i++) {
         const modeActivationCondition_t *mac = modeActivationConditions(i);
         if (mac->linkedTo) {
             activeLinkedMacArray[activeLinkedMacCount++] = i;
-        } else if (isModeActivationConditionConfigured(mac, &emptyMac)) {
+        } else if (isStickyMode(mac->modeId)) {
+            activeStickyMacArray[activeStickyMacCount++] = i;
+        } else if (mac->modeId < CHECKBOX_ITEM_COUNT && isModeActivationConditionConfigured(mac, &emptyMac)) {
             activeMacArray[activeMacCount++] = i;
         }
     }
+
+    compileModeRanges();
+    rcModeChangeCount++;
 }
@@ -123,6 +123,7 @@ typedef struct modeActivationProfile_s {
 
 bool IS_RC_MODE_ACTIVE(boxId_e boxId);
 void rcModeUpdate(boxBitmask_t *newState);
+uint8_t getRcModeChangeCount(void);
 
 bool airmodeIsEnabled(void);
 
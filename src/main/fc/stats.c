@@ -22,6 +22,8 @@
 
 #ifdef USE_PERSISTENT_STATS
 
+#include "config/config_eeprom.h"
+
 #include "drivers/time.h"
 
 #include "fc/config.h"
@@ -32,8 +34,11 @@
 #include "io/beeper.h"
 #include "io/gps.h"
 
+#include "pg/pg_ids.h"
 #include "pg/stats.h"
 
+#include "rx/rx.h"
+
 
 #define MIN_FLIGHT_TIME_TO_RECORD_STATS_S 10 // Prevent recording stats for that short "flights" [s]
 #define STATS_SAVE_DELAY_US 500000 // Let disarming complete and save stats after this time
@@ -54,20 +59,38 @@ void statsInit(void)
     dispatchEnable();
 }
 
+static bool saveStats(void)
+{
+#ifdef USE_CONFIG_JOURNAL
+    // Only the stats are appended to the config journal, which programs a few flash words. A full config write
+    // erases the flash and stalls for hundreds of ms, if the journal is full the stats wait for the next full write.
+    suspendRxPwmPpmSignal();
+    const bool saved = writePgToEEPROM(PG_STATS_CONFIG);
+    resumeRxPwmPpmSignal();
+
+    return saved;
+#else
+    // Don't save if the user made config changes that have not yet been saved.
+    if (isConfigDirty()) {
+        return false;
+    }
+    writeEEPROM();
+
+    return true;
+#endif
+}
+
 void writeStats(struct dispatchEntry_s* self)
 {
     UNUSED(self);
 
     if (!ARMING_FLAG(ARMED)) {
-        // Don't save if the user made config changes that have not yet been saved.
-        if (!isConfigDirty()) {
-            writeEEPROM();
-
+        if (saveStats()) {
             // Repeat disarming beep indicating the stats save is complete
             beeper(BEEPER_DISARMING);
-        }
 
-        saveRequired = false;
+            saveRequired = false;
+        }
     }
 }
 
@@ -23,3 +23,4 @@
 #define LOOPTIME_SUSPEND_TIME 3  // Prevent too long busy wait times
 
 void fcTasksInit(void);
+void fcTasksEnableDetectedDevices(void);
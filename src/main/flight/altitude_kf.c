@@ -0,0 +1,110 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "flight/altitude_kf.h"
+
+// uncertainty at startup, before the first measurement
+#define ALTITUDE_KF_INITIAL_ALTITUDE_SD  1000.0f   // cm
+#define ALTITUDE_KF_INITIAL_VELOCITY_SD  100.0f    // cm/s
+#define ALTITUDE_KF_INITIAL_ACC_BIAS_SD  50.0f     // cm/s/s
+
+void altitudeKfInit(altitudeKf_t *kf, float accNoise, float accBiasNoise)
+{
+    memset(kf, 0, sizeof(*kf));
+
+    kf->P[ALTITUDE_KF_ALTITUDE][ALTITUDE_KF_ALTITUDE] = sq(ALTITUDE_KF_INITIAL_ALTITUDE_SD);
+    kf->P[ALTITUDE_KF_VELOCITY][ALTITUDE_KF_VELOCITY] = sq(ALTITUDE_KF_INITIAL_VELOCITY_SD);
+    kf->P[ALTITUDE_KF_ACC_BIAS][ALTITUDE_KF_ACC_BIAS] = sq(ALTITUDE_KF_INITIAL_ACC_BIAS_SD);
+    kf->accVariance = sq(accNoise);
+    kf->accBiasVariance = sq(accBiasNoise);
+}
+
+// x = F * x + B * a, P = F * P * F' + Q, with the measured acceleration less the bias as input
+void altitudeKfPredict(altitudeKf_t *kf, float verticalAcceleration, float dt)
+{
+    const float dt2 = 0.5f * dt * dt;
+    const float F[ALTITUDE_KF_STATE_COUNT][ALTITUDE_KF_STATE_COUNT] = {
+        { 1.0f, dt,   -dt2 },
+        { 0.0f, 1.0f, -dt  },
+        { 0.0f, 0.0f, 1.0f },
+    };
+
+    const float acceleration = verticalAcceleration - kf->x[ALTITUDE_KF_ACC_BIAS];
+    kf->x[ALTITUDE_KF_ALTITUDE] += kf->x[ALTITUDE_KF_VELOCITY] * dt + acceleration * dt2;
+    kf->x[ALTITUDE_KF_VELOCITY] += acceleration * dt;
+
+    float FP[ALTITUDE_KF_STATE_COUNT][ALTITUDE_KF_STATE_COUNT];
+    for (int i = 0; i < ALTITUDE_KF_STATE_COUNT; i++) {
+        for (int j = 0; j < ALTITUDE_KF_STATE_COUNT; j++) {
+            FP[i][j] = F[i][0] * kf->P[0][j] + F[i][1] * kf->P[1][j] + F[i][2] * kf->P[2][j];
+        }
+    }
+    for (int i = 0; i < ALTITUDE_KF_STATE_COUNT; i++) {
+        for (int j = 0; j < ALTITUDE_KF_STATE_COUNT; j++) {
+            kf->P[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2];
+        }
+    }
+
+    // the acceleration noise enters through G = [dt^2 / 2, dt, 0], the bias is a random walk
+    const float G[ALTITUDE_KF_STATE_COUNT] = { dt2, dt, 0.0f };
+    for (int i = 0; i < ALTITUDE_KF_STATE_COUNT; i++) {
+        for (int j = 0; j < ALTITUDE_KF_STATE_COUNT; j++) {
+            kf->P[i][j] += G[i] * G[j] * kf->accVariance;
+        }
+    }
+    kf->P[ALTITUDE_KF_ACC_BIAS][ALTITUDE_KF_ACC_BIAS] += kf->accBiasVariance * dt;
+}
+
+// Measurement of the altitude, H = [1, 0, 0], with the variance of the measurement in cm^2
+void altitudeKfUpdate(altitudeKf_t *kf, float altitude, float variance)
+{
+    const float S = kf->P[ALTITUDE_KF_ALTITUDE][ALTITUDE_KF_ALTITUDE] + variance;
+    if (S <= 0.0f) {
+        return;
+    }
+
+    const float innovation = altitude - kf->x[ALTITUDE_KF_ALTITUDE];
+    float PH[ALTITUDE_KF_STATE_COUNT];
+    for (int i = 0; i < ALTITUDE_KF_STATE_COUNT; i++) {
+        PH[i] = kf->P[i][ALTITUDE_KF_ALTITUDE];
+    }
+
+    for (int i = 0; i < ALTITUDE_KF_STATE_COUNT; i++) {
+        const float K = PH[i] / S;
+        kf->x[i] += K * innovation;
+        for (int j = 0; j < ALTITUDE_KF_STATE_COUNT; j++) {
+            kf->P[i][j] -= K * PH[j];
+        }
+    }
+}
+
+// Moves the altitude reference, e.g. to the arming point, without disturbing the rest of the estimate
+void altitudeKfSetAltitude(altitudeKf_t *kf, float altitude)
+{
+    kf->x[ALTITUDE_KF_ALTITUDE] = altitude;
+}
@@ -0,0 +1,43 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Altitude estimator: altitude, vertical velocity and accelerometer bias, predicted with the
+// earth frame vertical acceleration and corrected with altitude measurements (baro, GPS)
+
+typedef enum {
+    ALTITUDE_KF_ALTITUDE = 0,
+    ALTITUDE_KF_VELOCITY,
+    ALTITUDE_KF_ACC_BIAS,
+    ALTITUDE_KF_STATE_COUNT
+} altitudeKfState_e;
+
+typedef struct altitudeKf_s {
+    float x[ALTITUDE_KF_STATE_COUNT];                           // cm, cm/s, cm/s/s
+    float P[ALTITUDE_KF_STATE_COUNT][ALTITUDE_KF_STATE_COUNT];  // covariance of x
+    float accVariance;                                          // of the acceleration input, (cm/s/s)^2
+    float accBiasVariance;                                      // growth of the bias variance, (cm/s/s)^2 per s
+} altitudeKf_t;
+
+void altitudeKfInit(altitudeKf_t *kf, float accNoise, float accBiasNoise);
+void altitudeKfPredict(altitudeKf_t *kf, float verticalAcceleration, float dt);
+void altitudeKfUpdate(altitudeKf_t *kf, float altitude, float variance);
+void altitudeKfSetAltitude(altitudeKf_t *kf, float altitude);
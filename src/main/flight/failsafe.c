@@ -193,6 +193,12 @@ void failsafeOnValidDataFailed(void)
     }
 }
 
+// The time at which the RX link is declared down, unless valid data arrives before then
+uint32_t failsafeRxLinkDownAtMs(void)
+{
+    return failsafeState.validRxDataReceivedAt + failsafeState.rxDataFailurePeriod + 1;
+}
+
 void failsafeUpdateState(void)
 {
     if (!failsafeIsMonitoring()) {
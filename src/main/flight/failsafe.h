@@ -108,3 +108,4 @@ void failsafeOnRxResume(void);
 
 void failsafeOnValidDataReceived(void);
 void failsafeOnValidDataFailed(void);
+uint32_t failsafeRxLinkDownAtMs(void);
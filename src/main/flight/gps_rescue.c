@@ -25,6 +25,7 @@
 #include "build/debug.h"
 
 #include "common/axis.h"
+#include "common/gps_conversion.h"
 #include "common/maths.h"
 #include "common/utils.h"
 #include "common/typeconversion.h"
@@ -154,22 +155,22 @@ int32_t         gpsRescueAngle[ANGLE_INDEX_COUNT] = { 0, 0 };
 static bool newGPSData = false;
 rescueState_s rescueState;
 
-double gps_latitude = 0;
-double gps_longitude = 0;
-double gps_home_altitude_cm = 0;
-double gps_home_latitude = 0;
-double gps_home_longitude = 0;
+int32_t gps_latitude = 0;
+int32_t gps_longitude = 0;
+int32_t gps_home_altitude_cm = 0;
+int32_t gps_home_latitude = 0;
+int32_t gps_home_longitude = 0;
 
-double gps_altitude_cm = 0;
-double last_gps_altitude_cm;
+int32_t gps_altitude_cm = 0;
+int32_t last_gps_altitude_cm;
 uint32_t last_gps_altitudeTimeUs = 0;
 int gps_Z_velocity_cm = 0;
 
-double gps_callibration_latitude = 0;
-double gps_callibration_longitude = 0;
+int32_t gps_callibration_latitude = 0;
+int32_t gps_callibration_longitude = 0;
 
-double flight_plan_latitude [FLIGHTPLAN_MAX_WAYPOINT_COUNT];
-double flight_plan_longitude[FLIGHTPLAN_MAX_WAYPOINT_COUNT];
+int32_t flight_plan_latitude [FLIGHTPLAN_MAX_WAYPOINT_COUNT];
+int32_t flight_plan_longitude[FLIGHTPLAN_MAX_WAYPOINT_COUNT];
 float  flight_plan_altitudeM[FLIGHTPLAN_MAX_WAYPOINT_COUNT];
 
 static int flight_plan_target = 0;
@@ -185,27 +186,27 @@ void rescueNewGpsData(void)
 
 static void rescueStart()
 {    
-    flight_plan_latitude[0]  = (double)fastA2F (gpsRescueConfig()->fp_lat_01) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[1]  = (double)fastA2F (gpsRescueConfig()->fp_lat_02) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[2]  = (double)fastA2F (gpsRescueConfig()->fp_lat_03) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[3]  = (double)fastA2F (gpsRescueConfig()->fp_lat_04) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[4]  = (double)fastA2F (gpsRescueConfig()->fp_lat_05) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[5]  = (double)fastA2F (gpsRescueConfig()->fp_lat_06) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[6]  = (double)fastA2F (gpsRescueConfig()->fp_lat_07) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[7]  = (double)fastA2F (gpsRescueConfig()->fp_lat_08) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[8]  = (double)fastA2F (gpsRescueConfig()->fp_lat_09) * GPS_DEGREES_DIVIDER;
-    flight_plan_latitude[9]  = (double)fastA2F (gpsRescueConfig()->fp_lat_10) * GPS_DEGREES_DIVIDER;
+    flight_plan_latitude[0]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_01);
+    flight_plan_latitude[1]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_02);
+    flight_plan_latitude[2]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_03);
+    flight_plan_latitude[3]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_04);
+    flight_plan_latitude[4]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_05);
+    flight_plan_latitude[5]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_06);
+    flight_plan_latitude[6]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_07);
+    flight_plan_latitude[7]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_08);
+    flight_plan_latitude[8]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_09);
+    flight_plan_latitude[9]  = gpsDegreesToE7(gpsRescueConfig()->fp_lat_10);
     
-    flight_plan_longitude[0] = (double)fastA2F (gpsRescueConfig()->fp_lon_01) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[1] = (double)fastA2F (gpsRescueConfig()->fp_lon_02) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[2] = (double)fastA2F (gpsRescueConfig()->fp_lon_03) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[3] = (double)fastA2F (gpsRescueConfig()->fp_lon_04) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[4] = (double)fastA2F (gpsRescueConfig()->fp_lon_05) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[5] = (double)fastA2F (gpsRescueConfig()->fp_lon_06) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[6] = (double)fastA2F (gpsRescueConfig()->fp_lon_07) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[7] = (double)fastA2F (gpsRescueConfig()->fp_lon_08) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[8] = (double)fastA2F (gpsRescueConfig()->fp_lon_09) * GPS_DEGREES_DIVIDER;
-    flight_plan_longitude[9] = (double)fastA2F (gpsRescueConfig()->fp_lon_10) * GPS_DEGREES_DIVIDER;
+    flight_plan_longitude[0] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_01);
+    flight_plan_longitude[1] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_02);
+    flight_plan_longitude[2] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_03);
+    flight_plan_longitude[3] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_04);
+    flight_plan_longitude[4] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_05);
+    flight_plan_longitude[5] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_06);
+    flight_plan_longitude[6] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_07);
+    flight_plan_longitude[7] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_08);
+    flight_plan_longitude[8] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_09);
+    flight_plan_longitude[9] = gpsDegreesToE7(gpsRescueConfig()->fp_lon_10);
     
     flight_plan_altitudeM[0] = fastA2F (gpsRescueConfig()->fp_alt_01);
     flight_plan_altitudeM[1] = fastA2F (gpsRescueConfig()->fp_alt_02);
@@ -226,26 +227,26 @@ static void rescueStop()
     rescueState.phase = RESCUE_IDLE;
 }
 
-#define DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS 1.113195f
-#define TAN_89_99_DEGREES 5729.57795f
 // Get distance between two points in cm
 // Get bearing from pos1 to pos2, returns an 1deg = 100 precision
-void GPS_cm_bearing(double currentLat1, double currentLon1, double destinationLat2, double destinationLon2, uint32_t *dist, int32_t *bearing)
+// lead is where the quad will be relative to pos1 by the time it reacts, may be NULL
+static void GPS_cm_bearing(int32_t currentLat1, int32_t currentLon1, int32_t destinationLat2, int32_t destinationLon2, const gpsLocalOffset_t *lead, uint32_t *dist, int32_t *bearing)
 {
-    double dLat = destinationLat2 - currentLat1; // difference of latitude in 1/10 000 000 degrees
-    double dLon = destinationLon2 - currentLon1; // * GPS_scaleLonDown;
-    *dist = sqrtf(sq(dLat) + sq(dLon)) * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS;
-
-    *bearing = 9000.0f + atan2_approx(-dLat, dLon) * TAN_89_99_DEGREES;      // Convert the output radians to 100xdeg
-    if (*bearing < 0)
-        *bearing += 36000;
+    gpsLocalOffset_t offset;
+    gpsLocalOffset(currentLat1, currentLon1, destinationLat2, destinationLon2, GPS_scaleLonDown, &offset);
+    if (lead) {
+        offset.northCm -= lead->northCm;
+        offset.eastCm -= lead->eastCm;
+    }
+    *dist = gpsLocalDistanceCm(&offset);
+    *bearing = gpsLocalBearing(&offset);
 }
 
-void GPS_cm_distance (double Lat1, double Lon1, double Lat2, double Lon2, uint32_t *dist)
+static void GPS_cm_distance(int32_t Lat1, int32_t Lon1, int32_t Lat2, int32_t Lon2, uint32_t *dist)
 {
-    double dLat = Lat2 - Lat1; // difference of latitude in 1/10 000 000 degrees
-    double dLon = Lon2 - Lon1; // * GPS_scaleLonDown;
-    *dist = sqrtf(sq(dLat) + sq(dLon)) * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS;
+    gpsLocalOffset_t offset;
+    gpsLocalOffset(Lat1, Lon1, Lat2, Lon2, GPS_scaleLonDown, &offset);
+    *dist = gpsLocalDistanceCm(&offset);
 }
 
 // Things that need to run regardless of GPS rescue mode being enabled or not
@@ -257,21 +258,21 @@ static void idleTasks()
     
     if (!ARMING_FLAG(ARMED)) 
     {
-        gps_callibration_latitude =  (double)fastA2F (gpsRescueConfig()->gps_callibration_latitude) * GPS_DEGREES_DIVIDER;
-        gps_callibration_longitude = (double)fastA2F (gpsRescueConfig()->gps_callibration_longitude) * GPS_DEGREES_DIVIDER;
+        gps_callibration_latitude =  gpsDegreesToE7(gpsRescueConfig()->gps_callibration_latitude);
+        gps_callibration_longitude = gpsDegreesToE7(gpsRescueConfig()->gps_callibration_longitude);
         gps_home_altitude_cm = gpsSol.llh.altCm;
         gps_home_latitude = gpsSol.llh.lat;
         gps_home_longitude = gpsSol.llh.lon;
-        altitude_from_takeoff_cm = (int32_t)(gps_home_altitude_cm);
+        altitude_from_takeoff_cm = gps_home_altitude_cm;
     }
     else
     {
-        altitude_from_takeoff_cm = (int32_t)(gps_altitude_cm - gps_home_altitude_cm);
+        altitude_from_takeoff_cm = gps_altitude_cm - gps_home_altitude_cm;
     }
 
     uint32_t dist;
     int32_t dir;
-    GPS_cm_bearing (gps_latitude, gps_longitude, gps_callibration_latitude, gps_callibration_longitude, &dist, &dir);    
+    GPS_cm_bearing (gps_latitude, gps_longitude, gps_callibration_latitude, gps_callibration_longitude, NULL, &dist, &dir);
     gps_distance_to_home = dist / 100;
     gps_direction_to_home = dir / 100;
     
@@ -347,11 +348,11 @@ static void rescueAttainPosition()
         courseOverGround += (2.0f * M_PIf);
     }
 
-    float d_lat = cos_approx(courseOverGround) * gpsSol.groundSpeed / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS;
-    float d_lon = sin_approx(courseOverGround) * gpsSol.groundSpeed / DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS;
-    
-    gps_latitude  += (double)d_lat;
-    gps_longitude += (double)d_lon;
+    // distance covered in the next second, in the local tangent plane
+    const gpsLocalOffset_t lead = {
+        .northCm = cos_approx(courseOverGround) * gpsSol.groundSpeed,
+        .eastCm = sin_approx(courseOverGround) * gpsSol.groundSpeed,
+    };
     
     // XXX = Experimental ================================================================== */
 
@@ -367,7 +368,7 @@ static void rescueAttainPosition()
             
         // follow flight plan
         int p = flight_plan_target % gpsRescueConfig()->total_waypoints;
-        GPS_cm_bearing (gps_latitude, gps_longitude, flight_plan_latitude[p], flight_plan_longitude[p], &dist_to_target_cm, &direction_to_target);
+        GPS_cm_bearing (gps_latitude, gps_longitude, flight_plan_latitude[p], flight_plan_longitude[p], &lead, &dist_to_target_cm, &direction_to_target);
         
         if (flight_plan_target == 0 || gpsRescueConfig()->total_waypoints == 1)
         {
@@ -378,22 +379,22 @@ static void rescueAttainPosition()
             int p0 = (flight_plan_target-1) % gpsRescueConfig()->total_waypoints;
             uint32_t waypoint_dist;
             GPS_cm_distance  (flight_plan_latitude[p0], flight_plan_longitude[p0], flight_plan_latitude[p], flight_plan_longitude[p], &waypoint_dist);            
-            float ratio = constrainf ((float)dist_to_target_cm / (float)waypoint_dist, 0.0, 1.0);
-            target_altitude_cm = ((flight_plan_altitudeM[p0] * ratio) + (flight_plan_altitudeM[p] * (1.0 - ratio))) * 100;
+            float ratio = constrainf ((float)dist_to_target_cm / (float)waypoint_dist, 0.0f, 1.0f);
+            target_altitude_cm = ((flight_plan_altitudeM[p0] * ratio) + (flight_plan_altitudeM[p] * (1.0f - ratio))) * 100;
         }
     }
     else
     {
-        safe_approach_distance_cm = gpsRescueConfig()->descentDistanceM * 100.0;
+        safe_approach_distance_cm = gpsRescueConfig()->descentDistanceM * 100.0f;
 
         flight_plan_target = 0; // reset flight plan
-        GPS_cm_bearing (gps_latitude, gps_longitude, gps_home_latitude, gps_home_longitude, &dist_to_target_cm, &direction_to_target);
-        target_altitude_cm = constrainf (dist_to_target_cm/2.0, gpsRescueConfig()->targetLandingAltitudeM * 100, gpsRescueConfig()->initialAltitudeM * 100);
+        GPS_cm_bearing (gps_latitude, gps_longitude, gps_home_latitude, gps_home_longitude, &lead, &dist_to_target_cm, &direction_to_target);
+        target_altitude_cm = constrainf (dist_to_target_cm / 2.0f, gpsRescueConfig()->targetLandingAltitudeM * 100, gpsRescueConfig()->initialAltitudeM * 100);
     }
                              
     gps_distance_to_home = dist_to_target_cm / 100;
     gps_direction_to_home = direction_to_target / 100;
-    altitude_from_takeoff_cm = (int32_t)(gps_altitude_cm - gps_home_altitude_cm);
+    altitude_from_takeoff_cm = gps_altitude_cm - gps_home_altitude_cm;
         
     setBearing (gps_direction_to_home);
             
@@ -405,13 +406,13 @@ static void rescueAttainPosition()
     
     if (IS_FLIGHT_PLAN_MODE)
     {
-        throttle_distance_cm = sqrt (sq(altitude_offset_cm) + sq(dist_to_target_cm)); // - gpsSol.groundSpeed)); // XXX
+        throttle_distance_cm = sqrtf (sq(altitude_offset_cm) + sq((float)dist_to_target_cm)); // - gpsSol.groundSpeed)); // XXX
         if (throttle_distance_cm < WAYPOINT_PROXIMITY) flight_plan_target++;
         if (!failsafeIsActive())
         {
             // apply throttle control to flight plan
             float throttle_range = motorConfig()->maxthrottle - motorConfig()->minthrottle;
-            speed = constrainf ((float)(rcCommand[THROTTLE] - motorConfig()->minthrottle) / throttle_range, 0.0, 1.0);
+            speed = constrainf ((float)(rcCommand[THROTTLE] - motorConfig()->minthrottle) / throttle_range, 0.0f, 1.0f);
         }
     }    
     
@@ -425,11 +426,11 @@ static void rescueAttainPosition()
         // We may still be moving away from the next waypoint - we need to adjust the roll value accordingly
         if (dir * course_error_degrees > 90) course_error_degrees = dir * (180 - (dir * course_error_degrees));
         roll = constrainf (course_error_degrees * (-GET_DIRECTION(rcControlsConfig()->yaw_control_reversed)), -GPS_RESCUE_MAX_ROLL, GPS_RESCUE_MAX_ROLL);
-        roll_adjust = constrainf ((gpsSol.groundSpeed - GPS_RESCUE_MIN_ROLL_ADJUST_SPEED) / GPS_RESCUE_MAX_ROLL_ADJUST_SPEED, 0.0, 1.0);
+        roll_adjust = constrainf ((gpsSol.groundSpeed - GPS_RESCUE_MIN_ROLL_ADJUST_SPEED) / GPS_RESCUE_MAX_ROLL_ADJUST_SPEED, 0.0f, 1.0f);
     }
     
     // set angle based on distance away
-    float angle_adjust = speed * constrainf (2.0f * (float)dist_to_target_cm / safe_approach_distance_cm, 0.0, 1.0);
+    float angle_adjust = speed * constrainf (2.0f * (float)dist_to_target_cm / safe_approach_distance_cm, 0.0f, 1.0f);
     
     float throttle_adjust;
     if (altitude_offset_cm > safe_approach_distance_cm)
@@ -439,14 +440,14 @@ static void rescueAttainPosition()
     }
     else
     {
-        throttle_adjust = speed * (gpsRescueConfig()->throttleMax - gpsRescueConfig()->throttleHover) * constrainf (throttle_distance_cm / safe_approach_distance_cm, 0.0, 1.0);
+        throttle_adjust = speed * (gpsRescueConfig()->throttleMax - gpsRescueConfig()->throttleHover) * constrainf (throttle_distance_cm / safe_approach_distance_cm, 0.0f, 1.0f);
         if (throttle_adjust < GPS_RESCUE_MIN_THROTTLE_ADJUST) throttle_adjust = GPS_RESCUE_MIN_THROTTLE_ADJUST;
         if (altitude_offset_cm > 0) throttle_adjust *= -1.0f;
     }
          
     // final result
-    gpsRescueAngle[AI_ROLL] = roll * roll_adjust * 100.0;
-    gpsRescueAngle[AI_PITCH] = angle_adjust * gpsRescueConfig()->angle * 100.0;        
+    gpsRescueAngle[AI_ROLL] = roll * roll_adjust * 100.0f;
+    gpsRescueAngle[AI_PITCH] = angle_adjust * gpsRescueConfig()->angle * 100.0f;        
     rescueThrottle = constrain (gpsRescueConfig()->throttleHover + throttle_adjust, gpsRescueConfig()->throttleMin, gpsRescueConfig()->throttleMax);
 }
 
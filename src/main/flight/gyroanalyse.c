@@ -23,6 +23,7 @@
  * coding assistance and advice from DieHertz, Rav, eTracer
  * test pilots icr4sh, UAV Tech, Flint723
  */
+#include <math.h>
 #include <stdint.h>
 
 #include "platform.h"
@@ -32,34 +33,48 @@
 
 #include "common/filter.h"
 #include "common/maths.h"
+#include "common/sdft.h"
 #include "common/time.h"
 #include "common/utils.h"
 
 #include "drivers/accgyro/accgyro.h"
 #include "drivers/time.h"
 
+#include "pg/pg.h"
+#include "pg/pg_ids.h"
+
 #include "sensors/gyro.h"
 
+#include "fc/config.h"
 #include "fc/core.h"
+#include "fc/dispatch.h"
+#include "fc/runtime_config.h"
 
 #include "gyroanalyse.h"
 
-// The FFT splits the frequency domain into an number of bins
+// The sliding DFT splits the frequency domain into an number of bins
 // A sampling frequency of 1000 and max frequency of 500 at a window size of 32 gives 16 frequency bins each 31.25Hz wide
 // Eg [0,31), [31,62), [62, 93) etc
 // for gyro loop >= 4KHz, sample rate 2000 defines FFT range to 1000Hz, 16 bins each 62.5 Hz wide
-// NB  FFT_WINDOW_SIZE is set to 32 in gyroanalyse.h
-#define FFT_BIN_COUNT             (FFT_WINDOW_SIZE / 2)
+// the window size is set by dyn_notch_window_size, each doubling halves the bin width and doubles the time the window spans
 // smoothing frequency for FFT centre frequency
 #define DYN_NOTCH_SMOOTH_FREQ_HZ  50
-// we need 4 steps for each axis
-#define DYN_NOTCH_CALC_TICKS      (XYZ_AXIS_COUNT * 4)
+// we need 3 steps for each axis
+#define DYN_NOTCH_CALC_TICKS      (XYZ_AXIS_COUNT * 3)
 
 #define DYN_NOTCH_OSD_MIN_THROTTLE 20
 
+// a band's learned peak follows the smoothed peak with this weight per update, about 0.1s at 4kHz
+#define DYN_NOTCH_LEARN_RATE      0.02f
+#define DYN_NOTCH_MAP_SAVE_DELAY_US 500000 // let the disarm beep finish before the flash write
+
+PG_REGISTER(dynNotchMapConfig_t, dynNotchMapConfig, PG_DYN_NOTCH_MAP_CONFIG, 0);
+
 static uint16_t FAST_RAM_ZERO_INIT   fftSamplingRateHz;
+static uint16_t FAST_RAM_ZERO_INIT   fftWindowSize;
+static uint16_t FAST_RAM_ZERO_INIT   fftBinCount;
 static float FAST_RAM_ZERO_INIT      fftResolution;
-static uint8_t FAST_RAM_ZERO_INIT    fftStartBin;
+static uint16_t FAST_RAM_ZERO_INIT   fftStartBin;
 static uint16_t FAST_RAM_ZERO_INIT   dynNotchMaxCtrHz;
 static uint8_t dynamicFilterRange;
 static float FAST_RAM_ZERO_INIT      dynNotchQ;
@@ -67,10 +82,9 @@ static float FAST_RAM_ZERO_INIT      dynNotch1Ctr;
 static float FAST_RAM_ZERO_INIT      dynNotch2Ctr;
 static uint16_t FAST_RAM_ZERO_INIT   dynNotchMinHz;
 static bool FAST_RAM dualNotch = true;
+static uint8_t FAST_RAM_ZERO_INIT    dynNotchCount;
 static uint16_t FAST_RAM_ZERO_INIT dynNotchMaxFFT;
-
-// Hanning window, see https://en.wikipedia.org/wiki/Window_function#Hann_.28Hanning.29_window
-static FAST_RAM_ZERO_INIT float hanningWindow[FFT_WINDOW_SIZE];
+static uint8_t FAST_RAM_ZERO_INIT    dynNotchLearn;
 
 void gyroDataAnalyseInit(uint32_t targetLooptimeUs)
 {
@@ -88,8 +102,15 @@ void gyroDataAnalyseInit(uint32_t targetLooptimeUs)
     dynNotch2Ctr = 1 + gyroConfig()->dyn_notch_width_percent / 100.0f;
     dynNotchQ = gyroConfig()->dyn_notch_q / 100.0f;
     dynNotchMinHz = gyroConfig()->dyn_notch_min_hz;
+    dynNotchLearn = dynNotchMapConfig()->learn;
+    if (dynNotchLearn == DYN_NOTCH_LEARN_STORE) {
+        // the dispatch task is only started when it has users at init
+        dispatchEnable();
+    }
 
-    if (gyroConfig()->dyn_notch_width_percent == 0) {
+    dynNotchCount = constrain(gyroConfig()->dyn_notch_count, 1, DYN_NOTCH_COUNT_MAX);
+    // the notch pair either side of the peak is only used when tracking a single peak
+    if (gyroConfig()->dyn_notch_width_percent == 0 || dynNotchCount > 1) {
         dualNotch = false;
     }
 
@@ -114,15 +135,15 @@ void gyroDataAnalyseInit(uint32_t targetLooptimeUs)
     
     fftSamplingRateHz = MIN((gyroLoopRateHz / 3), fftSamplingRateHz);
 
-    fftResolution = (float)fftSamplingRateHz / FFT_WINDOW_SIZE;
+    fftWindowSize = MIN(32 << gyroConfig()->dyn_notch_window_size, SDFT_SAMPLE_SIZE_MAX);
+    fftBinCount = fftWindowSize / 2;
 
-    fftStartBin = dynNotchMinHz / lrintf(fftResolution);
+    fftResolution = (float)fftSamplingRateHz / fftWindowSize;
 
-    dynNotchMaxCtrHz = fftSamplingRateHz / 2; //Nyquist
+    // the peak search compares each bin with the one below and the Hann window needs the bin below that
+    fftStartBin = MAX(2, lrintf(dynNotchMinHz / fftResolution));
 
-    for (int i = 0; i < FFT_WINDOW_SIZE; i++) {
-        hanningWindow[i] = (0.5f - 0.5f * cos_approx(2 * M_PIf * i / (FFT_WINDOW_SIZE - 1)));
-    }
+    dynNotchMaxCtrHz = fftSamplingRateHz / 2; //Nyquist
 }
 
 void gyroDataAnalyseStateInit(gyroAnalyseState_t *state, uint32_t targetLooptimeUs)
@@ -135,17 +156,30 @@ void gyroDataAnalyseStateInit(gyroAnalyseState_t *state, uint32_t targetLooptime
     state->maxSampleCount = samplingFrequency / fftSamplingRateHz;
     state->maxSampleCountRcp = 1.f / state->maxSampleCount;
 
-    arm_rfft_fast_init_f32(&state->fftInstance, FFT_WINDOW_SIZE);
+    state->sdftPushAxis = XYZ_AXIS_COUNT;
 
-//    recalculation of filters takes 4 calls per axis => each filter gets updated every DYN_NOTCH_CALC_TICKS calls
-//    at 4khz gyro loop rate this means 4khz / 4 / 3 = 333Hz => update every 3ms
+//    recalculation of filters takes 3 calls per axis => each filter gets updated every DYN_NOTCH_CALC_TICKS calls
+//    at 4khz gyro loop rate this means 4khz / 3 / 3 = 444Hz => update every 2.25ms
 //    for gyro rate > 16kHz, we have update frequency of 1kHz => 1ms
     const float looptime = MAX(1000000u / fftSamplingRateHz, targetLooptimeUs * DYN_NOTCH_CALC_TICKS);
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        // any init value
-        state->centerFreq[axis] = dynNotchMaxCtrHz;
-        state->prevCenterFreq[axis] = dynNotchMaxCtrHz;
-        biquadFilterInitLPF(&state->detectedFrequencyFilter[axis], DYN_NOTCH_SMOOTH_FREQ_HZ, looptime);
+        sdftInit(&state->sdft[axis], fftWindowSize, fftStartBin - 2, fftBinCount);
+        for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+            // any init value
+            state->centerFreq[axis][i] = dynNotchMaxCtrHz;
+            state->prevCenterFreq[axis][i] = dynNotchMaxCtrHz;
+            biquadFilterInitLPF(&state->detectedFrequencyFilter[axis][i], DYN_NOTCH_SMOOTH_FREQ_HZ, looptime);
+        }
+        state->throttleBand[axis] = DYN_NOTCH_THROTTLE_BANDS;
+    }
+
+    // the map of the previous flights, or of this one if the filters are retuned after a disarm
+    for (int band = 0; band < DYN_NOTCH_THROTTLE_BANDS; band++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+                state->throttleMap[band][axis][i] = dynNotchMapConfig()->centerHz[band][axis][i];
+            }
+        }
     }
 }
 
@@ -154,12 +188,12 @@ void gyroDataAnalysePush(gyroAnalyseState_t *state, const int axis, const float
     state->oversampledGyroAccumulator[axis] += sample;
 }
 
-static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn, biquadFilter_t *notchFilterDyn2);
+static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX]);
 
 /*
  * Collect gyro data, to be analysed in gyroDataAnalyseUpdate function
  */
-void gyroDataAnalyse(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn, biquadFilter_t *notchFilterDyn2)
+void gyroDataAnalyse(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
 {
     // samples should have been pushed by `gyroDataAnalysePush`
     // if gyro sampling is > 1kHz, accumulate multiple samples
@@ -172,171 +206,253 @@ void gyroDataAnalyse(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn,
         // calculate mean value of accumulated samples
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             float sample = state->oversampledGyroAccumulator[axis] * state->maxSampleCountRcp;
-            state->downsampledGyroData[axis][state->circularBufferIdx] = sample;
+            state->downsampledGyroData[axis] = sample;
             if (axis == 0) {
                 DEBUG_SET(DEBUG_FFT, 2, lrintf(sample));
             }
 
             state->oversampledGyroAccumulator[axis] = 0;
         }
-
-        state->circularBufferIdx = (state->circularBufferIdx + 1) % FFT_WINDOW_SIZE;
+        state->sdftPushAxis = 0;
 
         // We need DYN_NOTCH_CALC_TICKS tick to update all axis with newly sampled value
         state->updateTicks = DYN_NOTCH_CALC_TICKS;
     }
 
-    // calculate FFT and update filters
+    // update the sliding DFT of one axis per call, there are at least 3 calls per downsampled sample
+    if (state->sdftPushAxis < XYZ_AXIS_COUNT) {
+        sdftPush(&state->sdft[state->sdftPushAxis], state->downsampledGyroData[state->sdftPushAxis]);
+        state->sdftPushAxis++;
+    }
+
+    // analyse the spectrum and update filters
     if (state->updateTicks > 0) {
-        gyroDataAnalyseUpdate(state, notchFilterDyn, notchFilterDyn2);
+        gyroDataAnalyseUpdate(state, notchFilterDyn);
         --state->updateTicks;
     }
 }
 
-void stage_rfft_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut);
-void arm_cfft_radix8by2_f32(arm_cfft_instance_f32 *S, float32_t *p1);
-void arm_cfft_radix8by4_f32(arm_cfft_instance_f32 *S, float32_t *p1);
-void arm_radix8_butterfly_f32(float32_t *pSrc, uint16_t fftLen, const float32_t *pCoef, uint16_t twidCoefModifier);
-void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable);
+/*
+ * Single peak: weighted center of the tallest peak and its shoulders,
+ * returns 0 if the spectrum is empty
+ */
+static FAST_CODE float findPeakCentroid(const float *fftData, float *fftMeanIndex)
+{
+    bool fftIncreased = false;
+    float dataMax = 0;
+    uint16_t binStart = 0;
+    uint16_t binMax = 0;
+    //for bins after initial decline, identify start bin and max bin 
+    for (int i = fftStartBin; i < fftBinCount; i++) {
+        if (fftIncreased || (fftData[i] > fftData[i - 1])) {
+            if (!fftIncreased) {
+                binStart = i; // first up-step bin
+                fftIncreased = true;
+            }
+            if (fftData[i] > dataMax) {
+                dataMax = fftData[i];
+                binMax = i;  // tallest bin
+            }
+        }
+    }
+    // accumulate fftSum and fftWeightedSum from peak bin, and shoulder bins either side of peak
+    float cubedData = fftData[binMax] * fftData[binMax] * fftData[binMax];
+    float fftSum = cubedData;
+    float fftWeightedSum = cubedData * (binMax + 1);
+    // accumulate upper shoulder
+    for (int i = binMax; i < fftBinCount - 1; i++) {
+        if (fftData[i] > fftData[i + 1]) {
+            cubedData = fftData[i] * fftData[i] * fftData[i];
+            fftSum += cubedData;
+            fftWeightedSum += cubedData * (i + 1);
+        } else {
+        break;
+        }
+    }
+    // accumulate lower shoulder
+    for (int i = binMax; i > binStart + 1; i--) {
+        if (fftData[i] > fftData[i - 1]) {
+            cubedData = fftData[i] * fftData[i] * fftData[i];
+            fftSum += cubedData;
+            fftWeightedSum += cubedData * (i + 1);
+        } else {
+        break;
+        }
+    }
+    // get weighted center of relevant frequency range (this way we have a better resolution than 31.25Hz)
+    *fftMeanIndex = 0;
+     // idx was shifted by 1 to start at 1, not 0
+    if (fftSum > 0) {
+        *fftMeanIndex = (fftWeightedSum / fftSum) - 1;
+        // the index points at the center frequency of each bin so index 0 is actually 16.125Hz
+        return *fftMeanIndex * fftResolution;
+    }
+    return 0;
+}
+
+/*
+ * Multiple peaks: the dynNotchCount tallest local maxima above the mean magnitude,
+ * each refined by fitting a parabola through the peak bin and its neighbours.
+ * Returns the number of peaks found, their frequencies are sorted in ascending order
+ * so that each peak tends to keep the same smoothing filter and notch.
+ */
+static FAST_CODE int findPeaks(const float *fftData, float *peakFreq)
+{
+    float peakMagnitude[DYN_NOTCH_COUNT_MAX];
+    uint16_t peakBin[DYN_NOTCH_COUNT_MAX];
+    int peakCount = 0;
+
+    float threshold = 0;
+    for (int i = fftStartBin; i < fftBinCount - 1; i++) {
+        threshold += fftData[i];
+    }
+    threshold /= MAX(1, fftBinCount - 1 - fftStartBin);
+
+    for (int i = fftStartBin; i < fftBinCount - 1; i++) {
+        if (fftData[i] <= threshold || fftData[i] <= fftData[i - 1] || fftData[i] < fftData[i + 1]) {
+            continue;
+        }
+        // insert into the peaks sorted by magnitude, tallest first, dropping the smallest when full
+        int j = MIN(peakCount, dynNotchCount - 1);
+        if (peakCount == dynNotchCount && fftData[i] <= peakMagnitude[j]) {
+            continue;
+        }
+        if (peakCount < dynNotchCount) {
+            peakCount++;
+        }
+        for (; j > 0 && peakMagnitude[j - 1] < fftData[i]; j--) {
+            peakMagnitude[j] = peakMagnitude[j - 1];
+            peakBin[j] = peakBin[j - 1];
+        }
+        peakMagnitude[j] = fftData[i];
+        peakBin[j] = i;
+    }
+
+    for (int p = 0; p < peakCount; p++) {
+        const int bin = peakBin[p];
+        const float y0 = fftData[bin - 1];
+        const float y1 = fftData[bin];
+        const float y2 = fftData[bin + 1];
+        // the denominator is negative as y1 is a local maximum
+        const float delta = 0.5f * (y0 - y2) / (y0 - 2.0f * y1 + y2);
+        const float freq = (bin + delta) * fftResolution;
+
+        int j = p;
+        for (; j > 0 && peakFreq[j - 1] > freq; j--) {
+            peakFreq[j] = peakFreq[j - 1];
+        }
+        peakFreq[j] = freq;
+    }
+
+    return peakCount;
+}
+
+/*
+ * Sets the state of a smoothing filter as if its input had been at freq for a long time,
+ * so that its output starts there. The filter runs in the transposed direct form 2.
+ */
+static void dynNotchPresetFrequencyFilter(biquadFilter_t *filter, float freq)
+{
+    filter->x2 = (filter->b2 - filter->a2) * freq;
+    filter->x1 = (filter->b1 - filter->a1) * freq + filter->x2;
+}
 
 /*
- * Analyse last gyro data from the last FFT_WINDOW_SIZE milliseconds
+ * On entering a throttle band, the notches of the axis jump to the peaks learned for it
+ * rather than slewing there through the smoothing filter
  */
-static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn, biquadFilter_t *notchFilterDyn2)
+static FAST_CODE bool dynNotchUpdateThrottleBand(gyroAnalyseState_t *state, int axis)
+{
+    const int band = MIN(calculateThrottlePercentAbs() * DYN_NOTCH_THROTTLE_BANDS / 100, DYN_NOTCH_THROTTLE_BANDS - 1);
+    if (band == state->throttleBand[axis]) {
+        return true;
+    }
+    state->throttleBand[axis] = band;
+
+    for (int i = 0; i < dynNotchCount; i++) {
+        const float learnedFreq = state->throttleMap[band][axis][i];
+        if (learnedFreq != 0) {
+            dynNotchPresetFrequencyFilter(&state->detectedFrequencyFilter[axis][i], learnedFreq);
+        }
+    }
+    return false;
+}
+
+/*
+ * Analyse the gyro data of the last fftWindowSize downsampled samples
+ */
+static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
 {
     enum {
-        STEP_ARM_CFFT_F32,
-        STEP_BITREVERSAL,
-        STEP_STAGE_RFFT_F32,
-        STEP_ARM_CMPLX_MAG_F32,
+        STEP_WINDOW,
         STEP_CALC_FREQUENCIES,
         STEP_UPDATE_FILTERS,
-        STEP_HANNING,
         STEP_COUNT
     };
 
-    arm_cfft_instance_f32 *Sint = &(state->fftInstance.Sint);
-
     uint32_t startTime = 0;
     if (debugMode == (DEBUG_FFT_TIME)) {
         startTime = micros();
     }
 
+    const int axis = state->updateAxis;
+
     DEBUG_SET(DEBUG_FFT_TIME, 0, state->updateStep);
     switch (state->updateStep) {
-        case STEP_ARM_CFFT_F32:
+        case STEP_WINDOW:
         {
-            switch (FFT_BIN_COUNT) {
-            case 16:
-                // 16us
-                arm_cfft_radix8by2_f32(Sint, state->fftData);
-                break;
-            case 32:
-                // 35us
-                arm_cfft_radix8by4_f32(Sint, state->fftData);
-                break;
-            case 64:
-                // 70us
-                arm_radix8_butterfly_f32(state->fftData, FFT_BIN_COUNT, Sint->pTwiddle, 1);
-                break;
-            }
+            // apply the hann window and calculate the magnitude of the bins searched for the peak
+            sdftWinMagnitude(&state->sdft[axis], state->fftData);
             DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
             break;
         }
-        case STEP_BITREVERSAL:
-        {
-            // 6us
-            arm_bitreversal_32((uint32_t*) state->fftData, Sint->bitRevLength, Sint->pBitRevTable);
-            DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
-            state->updateStep++;
-            FALLTHROUGH;
-        }
-        case STEP_STAGE_RFFT_F32:
-        {
-            // 14us
-            // this does not work in place => fftData AND rfftData needed
-            stage_rfft_f32(&state->fftInstance, state->fftData, state->rfftData);
-            DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
-            break;
-        }
-        case STEP_ARM_CMPLX_MAG_F32:
-        {
-            // 8us
-            arm_cmplx_mag_f32(state->rfftData, state->fftData, FFT_BIN_COUNT);
-            DEBUG_SET(DEBUG_FFT_TIME, 2, micros() - startTime);
-            state->updateStep++;
-            FALLTHROUGH;
-        }
         case STEP_CALC_FREQUENCIES:
         {
-            bool fftIncreased = false;
-            float dataMax = 0;
-            uint8_t binStart = 0;
-            uint8_t binMax = 0;
-            //for bins after initial decline, identify start bin and max bin 
-            for (int i = fftStartBin; i < FFT_BIN_COUNT; i++) {
-                if (fftIncreased || (state->fftData[i] > state->fftData[i - 1])) {
-                    if (!fftIncreased) {
-                        binStart = i; // first up-step bin
-                        fftIncreased = true;
-                    }
-                    if (state->fftData[i] > dataMax) {
-                        dataMax = state->fftData[i];
-                        binMax = i;  // tallest bin
-                    }
+            float peakFreq[DYN_NOTCH_COUNT_MAX];
+            int peakCount;
+            float fftMeanIndex = 0;
+
+            if (dynNotchCount == 1) {
+                peakFreq[0] = findPeakCentroid(state->fftData, &fftMeanIndex);
+                if (peakFreq[0] == 0) {
+                    peakFreq[0] = state->prevCenterFreq[axis][0];
                 }
+                peakCount = 1;
+            } else {
+                peakCount = findPeaks(state->fftData, peakFreq);
             }
-            // accumulate fftSum and fftWeightedSum from peak bin, and shoulder bins either side of peak
-            float cubedData = state->fftData[binMax] * state->fftData[binMax] * state->fftData[binMax];
-            float fftSum = cubedData;
-            float fftWeightedSum = cubedData * (binMax + 1);
-            // accumulate upper shoulder
-            for (int i = binMax; i < FFT_BIN_COUNT - 1; i++) {
-                if (state->fftData[i] > state->fftData[i + 1]) {
-                    cubedData = state->fftData[i] * state->fftData[i] * state->fftData[i];
-                    fftSum += cubedData;
-                    fftWeightedSum += cubedData * (i + 1);
-                } else {
-                break;
-                }
+
+            // learn only while flying and settled in a band, the disarmed spectrum has no motor noise
+            bool learn = false;
+            if (dynNotchLearn != DYN_NOTCH_LEARN_OFF) {
+                learn = dynNotchUpdateThrottleBand(state, axis) && ARMING_FLAG(ARMED);
             }
-            // accumulate lower shoulder
-            for (int i = binMax; i > binStart + 1; i--) {
-                if (state->fftData[i] > state->fftData[i - 1]) {
-                    cubedData = state->fftData[i] * state->fftData[i] * state->fftData[i];
-                    fftSum += cubedData;
-                    fftWeightedSum += cubedData * (i + 1);
-                } else {
-                break;
+
+            for (int i = 0; i < dynNotchCount; i++) {
+                // a notch keeps its frequency while fewer peaks are found
+                float centerFreq = i < peakCount ? peakFreq[i] : state->centerFreq[axis][i];
+                centerFreq = fmax(centerFreq, dynNotchMinHz);
+                centerFreq = biquadFilterApply(&state->detectedFrequencyFilter[axis][i], centerFreq);
+                state->prevCenterFreq[axis][i] = state->centerFreq[axis][i];
+                state->centerFreq[axis][i] = centerFreq;
+
+                if (learn && i < peakCount) {
+                    float *learnedFreq = &state->throttleMap[state->throttleBand[axis]][axis][i];
+                    *learnedFreq = *learnedFreq == 0 ? centerFreq : *learnedFreq + DYN_NOTCH_LEARN_RATE * (centerFreq - *learnedFreq);
                 }
-            }
-            // get weighted center of relevant frequency range (this way we have a better resolution than 31.25Hz)
-            float centerFreq = dynNotchMaxCtrHz;
-            float fftMeanIndex = 0;
-             // idx was shifted by 1 to start at 1, not 0
-            if (fftSum > 0) {
-                fftMeanIndex = (fftWeightedSum / fftSum) - 1;
-                // the index points at the center frequency of each bin so index 0 is actually 16.125Hz
-                centerFreq = fftMeanIndex * fftResolution;
-            } else {
-                centerFreq = state->prevCenterFreq[state->updateAxis];
-            }
-            centerFreq = fmax(centerFreq, dynNotchMinHz);
-            centerFreq = biquadFilterApply(&state->detectedFrequencyFilter[state->updateAxis], centerFreq);
-            state->prevCenterFreq[state->updateAxis] = state->centerFreq[state->updateAxis];
-            state->centerFreq[state->updateAxis] = centerFreq;
 
-            if(calculateThrottlePercentAbs() > DYN_NOTCH_OSD_MIN_THROTTLE) {
-                dynNotchMaxFFT = MAX(dynNotchMaxFFT, state->centerFreq[state->updateAxis]);
+                if(calculateThrottlePercentAbs() > DYN_NOTCH_OSD_MIN_THROTTLE) {
+                    dynNotchMaxFFT = MAX(dynNotchMaxFFT, state->centerFreq[axis][i]);
+                }
             }
 
-            if (state->updateAxis == 0) {
+            if (axis == 0) {
                 DEBUG_SET(DEBUG_FFT, 3, lrintf(fftMeanIndex * 100));
-                DEBUG_SET(DEBUG_FFT_FREQ, 0, state->centerFreq[state->updateAxis]);
-                DEBUG_SET(DEBUG_DYN_LPF, 1, state->centerFreq[state->updateAxis]);
+                DEBUG_SET(DEBUG_FFT_FREQ, 0, state->centerFreq[axis][0]);
+                DEBUG_SET(DEBUG_DYN_LPF, 1, state->centerFreq[axis][0]);
             }
-            if (state->updateAxis == 1) {
-                DEBUG_SET(DEBUG_FFT_FREQ, 1, state->centerFreq[state->updateAxis]);
+            if (axis == 1) {
+                DEBUG_SET(DEBUG_FFT_FREQ, 1, state->centerFreq[axis][0]);
             }
             // Debug FFT_Freq carries raw gyro, gyro after first filter set, FFT centre for roll and for pitch
             DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
@@ -344,40 +460,71 @@ static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state,
         }
         case STEP_UPDATE_FILTERS:
         {
-            // 7us
+            // 7us per notch
             // calculate cutoffFreq and notch Q, update notch filter  =1.8+((A2-150)*0.004)
-            if (state->prevCenterFreq[state->updateAxis] != state->centerFreq[state->updateAxis]) {
-                if (dualNotch) {
-                    biquadFilterUpdate(&notchFilterDyn[state->updateAxis], state->centerFreq[state->updateAxis] * dynNotch1Ctr, gyro.targetLooptime, dynNotchQ, FILTER_NOTCH);
-                    biquadFilterUpdate(&notchFilterDyn2[state->updateAxis], state->centerFreq[state->updateAxis] * dynNotch2Ctr, gyro.targetLooptime, dynNotchQ, FILTER_NOTCH);
-                } else {
-                    biquadFilterUpdate(&notchFilterDyn[state->updateAxis], state->centerFreq[state->updateAxis], gyro.targetLooptime, dynNotchQ, FILTER_NOTCH);
+            if (dualNotch) {
+                if (state->prevCenterFreq[axis][0] != state->centerFreq[axis][0]) {
+                    biquadFilterUpdate(&notchFilterDyn[axis][0], state->centerFreq[axis][0] * dynNotch1Ctr, gyro.filterLooptime, dynNotchQ, FILTER_NOTCH);
+                    biquadFilterUpdate(&notchFilterDyn[axis][1], state->centerFreq[axis][0] * dynNotch2Ctr, gyro.filterLooptime, dynNotchQ, FILTER_NOTCH);
+                }
+            } else {
+                for (int i = 0; i < dynNotchCount; i++) {
+                    if (state->prevCenterFreq[axis][i] != state->centerFreq[axis][i]) {
+                        biquadFilterUpdate(&notchFilterDyn[axis][i], state->centerFreq[axis][i], gyro.filterLooptime, dynNotchQ, FILTER_NOTCH);
+                    }
                 }
             }
             DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
 
             state->updateAxis = (state->updateAxis + 1) % XYZ_AXIS_COUNT;
-            state->updateStep++;
-            FALLTHROUGH;
-        }
-        case STEP_HANNING:
-        {
-            // 5us
-            // apply hanning window to gyro samples and store result in fftData
-            // hanning starts and ends with 0, could be skipped for minor speed improvement
-            const uint8_t ringBufIdx = FFT_WINDOW_SIZE - state->circularBufferIdx;
-            arm_mult_f32(&state->downsampledGyroData[state->updateAxis][state->circularBufferIdx], &hanningWindow[0], &state->fftData[0], ringBufIdx);
-            if (state->circularBufferIdx > 0) {
-                arm_mult_f32(&state->downsampledGyroData[state->updateAxis][0], &hanningWindow[ringBufIdx], &state->fftData[ringBufIdx], state->circularBufferIdx);
-            }
-
-            DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
         }
     }
 
     state->updateStep = (state->updateStep + 1) % STEP_COUNT;
 }
 
+static void dynNotchMapSave(dispatchEntry_t *self)
+{
+    UNUSED(self);
+
+    // Don't save if the user made config changes that have not yet been saved.
+    if (!ARMING_FLAG(ARMED) && !isConfigDirty()) {
+        writeEEPROM();
+    }
+}
+
+static dispatchEntry_t dynNotchMapSaveEntry = {
+    dynNotchMapSave, 0, NULL, false
+};
+
+/*
+ * Keeps the map learned in flight in the config, where a filter retune picks it up again.
+ * With DYN_NOTCH_LEARN_STORE it is saved when a peak moved by more than a bin.
+ */
+void gyroDataAnalyseOnDisarm(gyroAnalyseState_t *state)
+{
+    if (dynNotchLearn == DYN_NOTCH_LEARN_OFF) {
+        return;
+    }
+
+    bool changed = false;
+    dynNotchMapConfig_t *config = dynNotchMapConfigMutable();
+    for (int band = 0; band < DYN_NOTCH_THROTTLE_BANDS; band++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+                const uint16_t learnedFreq = lrintf(state->throttleMap[band][axis][i]);
+                if (ABS(learnedFreq - config->centerHz[band][axis][i]) > fftResolution) {
+                    changed = true;
+                }
+                config->centerHz[band][axis][i] = learnedFreq;
+            }
+        }
+    }
+
+    if (changed && dynNotchLearn == DYN_NOTCH_LEARN_STORE) {
+        dispatchAdd(&dynNotchMapSaveEntry, DYN_NOTCH_MAP_SAVE_DELAY_US);
+    }
+}
 
 uint16_t getMaxFFT(void) {
     return dynNotchMaxFFT;
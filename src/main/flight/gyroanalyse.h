@@ -20,13 +20,30 @@
 
 #pragma once
 
-#include "arm_math.h"
-
 #include "common/filter.h"
+#include "common/sdft.h"
+
+#include "pg/pg.h"
+
+// maximum number of peaks tracked per axis, each with its own dynamic notch
+#define DYN_NOTCH_COUNT_MAX 5
+
+// throttle bands of the learned noise map, the peaks move with motor speed
+#define DYN_NOTCH_THROTTLE_BANDS 8
 
+typedef enum {
+    DYN_NOTCH_LEARN_OFF = 0,
+    DYN_NOTCH_LEARN_ON,         // learn the peaks per throttle band while armed, kept until reboot
+    DYN_NOTCH_LEARN_STORE,      // as ON, and save the map on disarm so that the next flight starts from it
+} dynNotchLearn_e;
 
-// max for F3 targets
-#define FFT_WINDOW_SIZE 32
+// Noise peak of each notch per throttle band, 0 = not learned yet
+typedef struct dynNotchMapConfig_s {
+    uint8_t  learn;
+    uint16_t centerHz[DYN_NOTCH_THROTTLE_BANDS][XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+} dynNotchMapConfig_t;
+
+PG_DECLARE(dynNotchMapConfig_t, dynNotchMapConfig);
 
 typedef struct gyroAnalyseState_s {
     // accumulator for oversampled data => no aliasing and less noise
@@ -35,28 +52,30 @@ typedef struct gyroAnalyseState_s {
     float maxSampleCountRcp;
     float oversampledGyroAccumulator[XYZ_AXIS_COUNT];
 
-    // downsampled gyro data circular buffer for frequency analysis
-    uint8_t circularBufferIdx;
-    float downsampledGyroData[XYZ_AXIS_COUNT][FFT_WINDOW_SIZE];
+    // downsampled gyro data, pushed into the sliding DFT of each axis one axis per call
+    float downsampledGyroData[XYZ_AXIS_COUNT];
+    uint8_t sdftPushAxis;
 
     // update state machine step information
     uint8_t updateTicks;
     uint8_t updateStep;
     uint8_t updateAxis;
 
-    arm_rfft_fast_instance_f32 fftInstance;
-    float fftData[FFT_WINDOW_SIZE];
-    float rfftData[FFT_WINDOW_SIZE];
+    sdft_t sdft[XYZ_AXIS_COUNT];
+    float fftData[SDFT_BIN_COUNT_MAX];
 
-    biquadFilter_t detectedFrequencyFilter[XYZ_AXIS_COUNT];
-    uint16_t centerFreq[XYZ_AXIS_COUNT];
-    uint16_t prevCenterFreq[XYZ_AXIS_COUNT];
-} gyroAnalyseState_t;
+    biquadFilter_t detectedFrequencyFilter[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    uint16_t centerFreq[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    uint16_t prevCenterFreq[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
 
-STATIC_ASSERT(FFT_WINDOW_SIZE <= (uint8_t) -1, window_size_greater_than_underlying_type);
+    // learned peaks per throttle band, the smoothing filters are preset from them on a band change
+    float throttleMap[DYN_NOTCH_THROTTLE_BANDS][XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    uint8_t throttleBand[XYZ_AXIS_COUNT];
+} gyroAnalyseState_t;
 
 void gyroDataAnalyseStateInit(gyroAnalyseState_t *gyroAnalyse, uint32_t targetLooptime);
 void gyroDataAnalysePush(gyroAnalyseState_t *gyroAnalyse, int axis, float sample);
-void gyroDataAnalyse(gyroAnalyseState_t *gyroAnalyse, biquadFilter_t *notchFilterDyn, biquadFilter_t *notchFilterDyn2);
+void gyroDataAnalyse(gyroAnalyseState_t *gyroAnalyse, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX]);
+void gyroDataAnalyseOnDisarm(gyroAnalyseState_t *gyroAnalyse);
 uint16_t getMaxFFT(void);
 void resetMaxFFT(void);
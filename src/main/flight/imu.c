@@ -42,6 +42,7 @@
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
+#include "flight/position.h"
 
 #include "io/gps.h"
 
@@ -49,6 +50,7 @@
 #include "sensors/barometer.h"
 #include "sensors/compass.h"
 #include "sensors/gyro.h"
+#include "sensors/sample_bus.h"
 #include "sensors/sensors.h"
 
 #if defined(SIMULATOR_BUILD) && defined(SIMULATOR_MULTITHREAD)
@@ -84,6 +86,8 @@ static bool imuUpdated = false;
 #define ATTITUDE_RESET_KP_GAIN    25.0     // dcmKpGain value to use during attitude reset
 #define ATTITUDE_RESET_ACTIVE_TIME 500000  // 500ms - Time to wait for attitude to converge at high gain
 #define GPS_COG_MIN_GROUNDSPEED 200        // 500cm/s minimum groundspeed for a gps heading to be considered valid
+#define GRAVITY_CMSS 980.665f
+#define MAG_SAMPLE_MAX_AGE_US 500000     // 500ms - older compass samples, e.g. of a stalled read, are not used
 
 int32_t accSum[XYZ_AXIS_COUNT];
 float accAverage[XYZ_AXIS_COUNT];
@@ -111,12 +115,13 @@ quaternion offset = QUATERNION_INITIALIZE;
 // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
 attitudeEulerAngles_t attitude = EULER_INITIALIZE;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(imuConfig_t, imuConfig, PG_IMU_CONFIG, 1);
+PG_REGISTER_WITH_RESET_TEMPLATE(imuConfig_t, imuConfig, PG_IMU_CONFIG, 2);
 
 PG_RESET_TEMPLATE(imuConfig_t, imuConfig,
     .dcm_kp = 2500,                // 1.0 * 10000
     .dcm_ki = 0,                   // 0.003 * 10000
     .small_angle = 25,
+    .fast_propagation = false,
 );
 
 STATIC_UNIT_TESTED void imuComputeRotationMatrix(void){
@@ -157,6 +162,7 @@ void imuConfigure(uint16_t throttle_correction_angle, uint8_t throttle_correctio
 {
     imuRuntimeConfig.dcm_kp = imuConfig()->dcm_kp / 10000.0f;
     imuRuntimeConfig.dcm_ki = imuConfig()->dcm_ki / 10000.0f;
+    imuRuntimeConfig.fast_propagation = imuConfig()->fast_propagation;
 
     smallAngleCosZ = cos_approx(degreesToRadians(imuConfig()->small_angle));
 
@@ -198,6 +204,31 @@ static float invSqrt(float x)
     return 1.0f / sqrtf(x);
 }
 
+// Integrate the rate of change of the quaternion, the rates are scaled by dt / 2
+static FAST_CODE void imuIntegrateQuaternion(float gx, float gy, float gz)
+{
+    quaternion buffer;
+    buffer.w = q.w;
+    buffer.x = q.x;
+    buffer.y = q.y;
+    buffer.z = q.z;
+
+    q.w += (-buffer.x * gx - buffer.y * gy - buffer.z * gz);
+    q.x += (+buffer.w * gx + buffer.y * gz - buffer.z * gy);
+    q.y += (+buffer.w * gy - buffer.x * gz + buffer.z * gx);
+    q.z += (+buffer.w * gz + buffer.x * gy - buffer.y * gx);
+
+    // Normalise quaternion
+    float recipNorm = invSqrt(sq(q.w) + sq(q.x) + sq(q.y) + sq(q.z));
+    q.w *= recipNorm;
+    q.x *= recipNorm;
+    q.y *= recipNorm;
+    q.z *= recipNorm;
+
+    // Pre-compute rotation matrix from quaternion
+    imuComputeRotationMatrix();
+}
+
 static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
                                 bool useAcc, float ax, float ay, float az,
                                 bool useMag, float mx, float my, float mz,
@@ -219,7 +250,7 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
             courseOverGround += (2.0f * M_PIf);
         }
 
-        const float ez_ef = (- sin_approx(courseOverGround) * rMat[0][0] - cos_approx(courseOverGround) * rMat[1][0]);
+        const float ez_ef = (- sin_table(courseOverGround) * rMat[0][0] - cos_table(courseOverGround) * rMat[1][0]);
 
         ex = rMat[2][0] * ez_ef;
         ey = rMat[2][1] * ez_ef;
@@ -290,36 +321,20 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
         integralFBz = 0.0f;
     }
 
+    if (imuRuntimeConfig.fast_propagation) {
+        // The gyro has been integrated by imuPropagateAttitude() every PID loop, only the feedback is left
+        gx = 0.0f;
+        gy = 0.0f;
+        gz = 0.0f;
+    }
+
     // Apply proportional and integral feedback
     gx += dcmKpGain * ex + integralFBx;
     gy += dcmKpGain * ey + integralFBy;
     gz += dcmKpGain * ez + integralFBz;
 
     // Integrate rate of change of quaternion
-    gx *= (0.5f * dt);
-    gy *= (0.5f * dt);
-    gz *= (0.5f * dt);
-
-    quaternion buffer;
-    buffer.w = q.w;
-    buffer.x = q.x;
-    buffer.y = q.y;
-    buffer.z = q.z;
-
-    q.w += (-buffer.x * gx - buffer.y * gy - buffer.z * gz);
-    q.x += (+buffer.w * gx + buffer.y * gz - buffer.z * gy);
-    q.y += (+buffer.w * gy - buffer.x * gz + buffer.z * gx);
-    q.z += (+buffer.w * gz + buffer.x * gy - buffer.y * gx);
-
-    // Normalise quaternion
-    float recipNorm = invSqrt(sq(q.w) + sq(q.x) + sq(q.y) + sq(q.z));
-    q.w *= recipNorm;
-    q.x *= recipNorm;
-    q.y *= recipNorm;
-    q.z *= recipNorm;
-
-    // Pre-compute rotation matrix from quaternion
-    imuComputeRotationMatrix();
+    imuIntegrateQuaternion(gx * (0.5f * dt), gy * (0.5f * dt), gz * (0.5f * dt));
 }
 
 STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
@@ -329,13 +344,13 @@ STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
     if (FLIGHT_MODE(HEADFREE_MODE)) {
        imuQuaternionComputeProducts(&headfree, &buffer);
 
-       attitude.values.roll = lrintf(atan2_approx((+2.0f * (buffer.wx + buffer.yz)), (+1.0f - 2.0f * (buffer.xx + buffer.yy))) * (1800.0f / M_PIf));
+       attitude.values.roll = lrintf(atan2_table((+2.0f * (buffer.wx + buffer.yz)), (+1.0f - 2.0f * (buffer.xx + buffer.yy))) * (1800.0f / M_PIf));
        attitude.values.pitch = lrintf(((0.5f * M_PIf) - acos_approx(+2.0f * (buffer.wy - buffer.xz))) * (1800.0f / M_PIf));
-       attitude.values.yaw = lrintf((-atan2_approx((+2.0f * (buffer.wz + buffer.xy)), (+1.0f - 2.0f * (buffer.yy + buffer.zz))) * (1800.0f / M_PIf)));
+       attitude.values.yaw = lrintf((-atan2_table((+2.0f * (buffer.wz + buffer.xy)), (+1.0f - 2.0f * (buffer.yy + buffer.zz))) * (1800.0f / M_PIf)));
     } else {
-       attitude.values.roll = lrintf(atan2_approx(rMat[2][1], rMat[2][2]) * (1800.0f / M_PIf));
+       attitude.values.roll = lrintf(atan2_table(rMat[2][1], rMat[2][2]) * (1800.0f / M_PIf));
        attitude.values.pitch = lrintf(((0.5f * M_PIf) - acos_approx(-rMat[2][0])) * (1800.0f / M_PIf));
-       attitude.values.yaw = lrintf((-atan2_approx(rMat[1][0], rMat[0][0]) * (1800.0f / M_PIf)));
+       attitude.values.yaw = lrintf((-atan2_table(rMat[1][0], rMat[0][0]) * (1800.0f / M_PIf)));
     }
 
     if (attitude.values.yaw < 0)
@@ -440,7 +455,7 @@ static void imuCalculateEstimatedAttitude(timeUs_t currentTimeUs)
     previousIMUUpdateTime = currentTimeUs;
 
 #ifdef USE_MAG
-    if (sensors(SENSOR_MAG) && compassIsHealthy()
+    if (sensors(SENSOR_MAG) && compassIsHealthy() && cmpTimeUs(currentTimeUs, mag.sampleTimeUs) < MAG_SAMPLE_MAX_AGE_US
 #ifdef USE_GPS_RESCUE
         && !gpsRescueDisableMag()
 #endif
@@ -488,7 +503,8 @@ static void imuCalculateEstimatedAttitude(timeUs_t currentTimeUs)
     float gyroAverage[XYZ_AXIS_COUNT];
     gyroGetAccumulationAverage(gyroAverage);
 
-    if (accGetAccumulationAverage(accAverage)) {
+    const bool haveAcc = accGetAccumulationAverage(accAverage);
+    if (haveAcc) {
         useAcc = imuIsAccelerometerHealthy(accAverage);
     }
 
@@ -499,6 +515,14 @@ static void imuCalculateEstimatedAttitude(timeUs_t currentTimeUs)
                         useCOG, courseOverGround,  imuCalcKpGain(currentTimeUs, useAcc, gyroAverage));
 
     imuUpdateEulerAngles();
+
+#if defined(USE_BARO) || defined(USE_GPS)
+    if (haveAcc) {
+        // the third row of rMat takes the body frame acceleration to the earth Z axis, less 1G of gravity
+        const float accZ = rMat[2][0] * accAverage[X] + rMat[2][1] * accAverage[Y] + rMat[2][2] * accAverage[Z];
+        predictEstimatedAltitude((accZ * acc.dev.acc_1G_rec - 1.0f) * GRAVITY_CMSS, deltaT * 1e-6f);
+    }
+#endif
 #endif
 }
 
@@ -515,7 +539,7 @@ static int calculateThrottleAngleCorrection(void)
     int angle = lrintf(acos_approx(rMat[2][2]) * throttleAngleScale);
     if (angle > 900)
         angle = 900;
-    return lrintf(throttleAngleValue * sin_approx(angle / (900.0f * M_PIf / 2.0f)));
+    return lrintf(throttleAngleValue * sin_table(angle / (900.0f * M_PIf / 2.0f)));
 }
 
 void imuUpdateAttitude(timeUs_t currentTimeUs)
@@ -531,6 +555,13 @@ void imuUpdateAttitude(timeUs_t currentTimeUs)
 #endif
         imuCalculateEstimatedAttitude(currentTimeUs);
         IMU_UNLOCK;
+
+        const attitudeSample_t sample = {
+            .roll = attitude.values.roll,
+            .pitch = attitude.values.pitch,
+            .yaw = attitude.values.yaw,
+        };
+        samplePublish(SAMPLE_ATTITUDE, &sample, currentTimeUs);
         
         // Update the throttle correction for angle and supply it to the mixer
         int throttleAngleCorrection = 0;
@@ -545,6 +576,28 @@ void imuUpdateAttitude(timeUs_t currentTimeUs)
         acc.accADC[Z] = 0;
     }
 }
+
+// With imu_fast_propagation, integrate the filtered gyro every PID loop so that the attitude
+// used by the level modes lags by one loop instead of one attitude task period
+FAST_CODE void imuPropagateAttitude(void)
+{
+#if !defined(SIMULATOR_BUILD) || defined(USE_IMU_CALC)
+    if (!imuRuntimeConfig.fast_propagation || !sensors(SENSOR_ACC) || !acc.isAccelUpdatedAtLeastOnce) {
+        return;
+    }
+
+    const float halfDt = 0.5f * pidGetDT();
+
+    IMU_LOCK;
+    imuIntegrateQuaternion(DEGREES_TO_RADIANS(gyro.gyroADCf[X]) * halfDt,
+                           DEGREES_TO_RADIANS(gyro.gyroADCf[Y]) * halfDt,
+                           DEGREES_TO_RADIANS(gyro.gyroADCf[Z]) * halfDt);
+    if (FLIGHT_MODE(ANGLE_MODE | HORIZON_MODE)) {
+        imuUpdateEulerAngles();
+    }
+    IMU_UNLOCK;
+#endif
+}
 #endif // USE_ACC
 
 bool shouldInitializeGPSHeading()
@@ -37,6 +37,18 @@ static float prevSetpointSpeed[XYZ_AXIS_COUNT];
 static float prevRawSetpoint[XYZ_AXIS_COUNT];
 static float prevSetpointAcceleration[XYZ_AXIS_COUNT];
 
+#define FF_FIT_FRAME_COUNT      4
+#define FF_FIT_MAX_FRAME_GAP_US 50000   // older frames are dropped from the fit after a gap in the link
+
+typedef struct ffFitFrames_s {
+    float setpoint[FF_FIT_FRAME_COUNT];
+    timeUs_t frameTimeUs[FF_FIT_FRAME_COUNT];
+    uint8_t newest;
+    uint8_t count;
+} ffFitFrames_t;
+
+static ffFitFrames_t ffFitFrames[XYZ_AXIS_COUNT];
+
 
 // Configuration
 static float ffMaxRateLimit[XYZ_AXIS_COUNT];
@@ -50,6 +62,67 @@ void interpolatedSpInit(const pidProfile_t *pidProfile) {
     }
 }
 
+static void ffFitAddFrame(ffFitFrames_t *frames, float setpoint, timeUs_t frameTimeUs)
+{
+    if (frames->count) {
+        const timeDelta_t frameGapUs = cmpTimeUs(frameTimeUs, frames->frameTimeUs[frames->newest]);
+        if (frameGapUs <= 0) {
+            // the receiver driver has not timestamped a new frame, keep the previous one
+            frames->setpoint[frames->newest] = setpoint;
+            return;
+        }
+        if (frameGapUs > FF_FIT_MAX_FRAME_GAP_US) {
+            frames->count = 0;
+        }
+    }
+
+    frames->newest = (frames->newest + 1) % FF_FIT_FRAME_COUNT;
+    frames->setpoint[frames->newest] = setpoint;
+    frames->frameTimeUs[frames->newest] = frameTimeUs;
+    frames->count = MIN(frames->count + 1, FF_FIT_FRAME_COUNT);
+}
+
+// Least squares fit of a quadratic through the last frames, placed at the time each frame arrived
+// rather than on the nominal frame interval so the jitter of the link does not show up as setpoint
+// speed. Speed (per s) and acceleration (per s^2) are those of the fit at the newest frame.
+static bool ffFitSetpoint(const ffFitFrames_t *frames, float *speed, float *acceleration)
+{
+    if (frames->count < FF_FIT_FRAME_COUNT) {
+        return false;
+    }
+
+    // times in ms and setpoints relative to the newest frame keep the sums well conditioned
+    const timeUs_t newestTimeUs = frames->frameTimeUs[frames->newest];
+    const float newestSetpoint = frames->setpoint[frames->newest];
+    float st = 0, st2 = 0, st3 = 0, st4 = 0;
+    float sy = 0, sty = 0, st2y = 0;
+    for (int i = 0; i < FF_FIT_FRAME_COUNT; i++) {
+        const float t = cmpTimeUs(frames->frameTimeUs[i], newestTimeUs) * 1e-3f;
+        const float y = frames->setpoint[i] - newestSetpoint;
+        const float t2 = t * t;
+        st += t;
+        st2 += t2;
+        st3 += t2 * t;
+        st4 += t2 * t2;
+        sy += y;
+        sty += t * y;
+        st2y += t2 * y;
+    }
+
+    // solve the normal equations for y = a + b * t + c * t^2 by Cramer's rule
+    const float n = FF_FIT_FRAME_COUNT;
+    const float det = n * (st2 * st4 - st3 * st3) - st * (st * st4 - st2 * st3) + st2 * (st * st3 - st2 * st2);
+    if (det < 1e-3f) {
+        return false;
+    }
+    const float b = (n * (sty * st4 - st3 * st2y) - sy * (st * st4 - st3 * st2) + st2 * (st * st2y - sty * st2)) / det;
+    const float c = (n * (st2 * st2y - sty * st3) - st * (st * st2y - sty * st2) + sy * (st * st3 - st2 * st2)) / det;
+
+    *speed = b * 1e3f;
+    *acceleration = 2.0f * c * 1e6f;
+    return true;
+}
+
 FAST_CODE_NOINLINE float interpolatedSpApply(int axis, bool newRcFrame, ffInterpolationType_t type) {
 
     if (newRcFrame) {
@@ -58,8 +131,18 @@ FAST_CODE_NOINLINE float interpolatedSpApply(int axis, bool newRcFrame, ffInterp
         const float rxInterval = currentRxRefreshRate * 1e-6f;
         const float rxRate = 1.0f / rxInterval;
 
-        const float setpointSpeed = (rawSetpoint - prevRawSetpoint[axis]) * rxRate;
-        const float setpointAcceleration = (setpointSpeed - prevSetpointSpeed[axis]) * pidGetDT();
+        float setpointSpeed = (rawSetpoint - prevRawSetpoint[axis]) * rxRate;
+        float setpointAcceleration = (setpointSpeed - prevSetpointSpeed[axis]) * pidGetDT();
+
+        if (type == FF_INTERPOLATE_FIT) {
+            ffFitAddFrame(&ffFitFrames[axis], rawSetpoint, currentRxFrameTimeUs);
+            float fitSpeed, fitAcceleration;
+            if (ffFitSetpoint(&ffFitFrames[axis], &fitSpeed, &fitAcceleration)) {
+                setpointSpeed = fitSpeed;
+                // scaled like the speed change over one frame used above
+                setpointAcceleration = fitAcceleration * rxInterval * pidGetDT();
+            }
+        }
 
         setpointDeltaImpl[axis] = setpointSpeed * pidGetDT();
         
@@ -88,7 +171,7 @@ FAST_CODE_NOINLINE float interpolatedSpApply(int axis, bool newRcFrame, ffInterp
             DEBUG_SET(DEBUG_FF_INTERPOLATED, 3, clip * 100);
         }
         setpointDeltaImpl[axis] += boostAmount * clip;
-        if (type == FF_INTERPOLATE_ON) {
+        if (type == FF_INTERPOLATE_ON || type == FF_INTERPOLATE_FIT) {
             setpointDelta[axis] = setpointDeltaImpl[axis];
         } else {
             setpointDelta[axis] = 0.5f * (setpointDeltaImpl[axis] + prevSetpointDeltaImpl[axis]);
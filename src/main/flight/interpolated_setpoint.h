@@ -28,7 +28,8 @@
 typedef enum ffInterpolationType_e {
     FF_INTERPOLATE_OFF,
     FF_INTERPOLATE_ON,
-    FF_INTERPOLATE_AVG
+    FF_INTERPOLATE_AVG,
+    FF_INTERPOLATE_FIT
 } ffInterpolationType_t;
 
 void interpolatedSpInit(const pidProfile_t *pidProfile);
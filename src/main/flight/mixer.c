@@ -67,8 +67,7 @@
 
 PG_REGISTER_WITH_RESET_TEMPLATE(mixerConfig_t, mixerConfig, PG_MIXER_CONFIG, 0);
 
-#define DYN_LPF_THROTTLE_STEPS           100
-#define DYN_LPF_THROTTLE_UPDATE_DELAY_US 5000 // minimum of 5ms between updates
+#define DYN_LPF_THROTTLE_HYSTERESIS 0.2f // of a throttle step, so a noisy throttle does not toggle the cutoffs
 
 PG_RESET_TEMPLATE(mixerConfig_t, mixerConfig,
     .mixerMode = DEFAULT_MIXER,
@@ -93,6 +92,12 @@ static motorMixer_t currentMixer[MAX_SUPPORTED_MOTORS];
 static motorMixer_t launchControlMixer[MAX_SUPPORTED_MOTORS];
 #endif
 
+// The mixers applied by mixTable(), with the PID mixer scaling folded in, see mixerInitMixMatrix()
+static FAST_RAM_ZERO_INIT motorMixer_t mixMatrix[MAX_SUPPORTED_MOTORS];
+#ifdef USE_LAUNCH_CONTROL
+static FAST_RAM_ZERO_INIT motorMixer_t launchControlMixMatrix[MAX_SUPPORTED_MOTORS];
+#endif
+
 static FAST_RAM_ZERO_INIT int throttleAngleCorrection;
 
 static const motorMixer_t mixerQuadX[] = {
@@ -289,6 +294,7 @@ FAST_RAM_ZERO_INIT float motorOutputHigh, motorOutputLow;
 
 static FAST_RAM_ZERO_INIT float disarmMotorOutput, deadbandMotor3dHigh, deadbandMotor3dLow;
 static FAST_RAM_ZERO_INIT float rcCommandThrottleRange;
+static FAST_RAM_ZERO_INIT bool motorEndpointsPending;   // the endpoints need to be worked out again
 #ifdef USE_DYN_IDLE
 static FAST_RAM_ZERO_INIT float idleMaxIncrease;
 static FAST_RAM_ZERO_INIT float idleThrottleOffset;
@@ -344,6 +350,7 @@ void initEscEndpoints(void)
     motorInitEndpoints(motorOutputLimit, &motorOutputLow, &motorOutputHigh, &disarmMotorOutput, &deadbandMotor3dHigh, &deadbandMotor3dLow);
 
     rcCommandThrottleRange = PWM_RANGE_MAX - PWM_RANGE_MIN;
+    motorEndpointsPending = true;
 }
 
 void mixerInit(mixerMode_e mixerMode)
@@ -356,14 +363,41 @@ void mixerInit(mixerMode_e mixerMode)
         mixerTricopterInit();
     }
 #endif
+    mixerInitProfile();
+}
+
+// Loads the settings of the current pid profile, also when the profile is changed
+void mixerInitProfile(void)
+{
 #ifdef USE_DYN_IDLE
-    idleMinMotorRps = currentPidProfile->idle_min_rpm * 100.0f / 60.0f;
+    // the motor speeds come from the DShot telemetry, without it the idle would only ever be raised
+    if (motorConfig()->dev.useDshotTelemetry) {
+        idleMinMotorRps = currentPidProfile->idle_min_rpm * 100.0f / 60.0f;
+    } else {
+        idleMinMotorRps = 0.0f;
+    }
     idleMaxIncrease = currentPidProfile->idle_max_increase * 0.001f;
     idleThrottleOffset = motorConfig()->digitalIdleOffsetValue * 0.0001f;
     idleP = currentPidProfile->idle_p * 0.0001f;
 #endif
 }
 
+static void mixerInitMixMatrix(void)
+{
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        mixMatrix[i].throttle = currentMixer[i].throttle;
+        mixMatrix[i].roll = currentMixer[i].roll / PID_MIXER_SCALING;
+        mixMatrix[i].pitch = currentMixer[i].pitch / PID_MIXER_SCALING;
+        mixMatrix[i].yaw = currentMixer[i].yaw / PID_MIXER_SCALING;
+#ifdef USE_LAUNCH_CONTROL
+        launchControlMixMatrix[i].throttle = launchControlMixer[i].throttle;
+        launchControlMixMatrix[i].roll = launchControlMixer[i].roll / PID_MIXER_SCALING;
+        launchControlMixMatrix[i].pitch = launchControlMixer[i].pitch / PID_MIXER_SCALING;
+        launchControlMixMatrix[i].yaw = launchControlMixer[i].yaw / PID_MIXER_SCALING;
+#endif
+    }
+}
+
 #ifdef USE_LAUNCH_CONTROL
 // Create a custom mixer for launch control based on the current settings
 // but disable the front motors. We don't care about roll or yaw because they
@@ -411,6 +445,7 @@ void mixerConfigureOutput(void)
 #ifdef USE_LAUNCH_CONTROL
     loadLaunchControlMixer();
 #endif
+    mixerInitMixMatrix();
     mixerResetDisarmedMotors();
 }
 
@@ -439,6 +474,7 @@ void mixerConfigureOutput(void)
 #ifdef USE_LAUNCH_CONTROL
     loadLaunchControlMixer();
 #endif
+    mixerInitMixMatrix();
     mixerResetDisarmedMotors();
 }
 #endif // USE_QUAD_MIXER_ONLY
@@ -591,33 +627,45 @@ static void calculateThrottleAndCurrentMotorEndpoints(timeUs_t currentTimeUs)
             // keep iterm zero for 250ms after motor reversal
             pidResetIterm();
         }
+        motorEndpointsPending = true;
     } else {
         throttle = rcCommand[THROTTLE] - PWM_RANGE_MIN + throttleAngleCorrection;
 #ifdef USE_DYN_IDLE
         if (idleMinMotorRps > 0.0f) {
             motorOutputLow = DSHOT_MIN_THROTTLE;
-            const float maxIncrease = isAirmodeActivated() ? idleMaxIncrease : 0.04f;
-            const float minRps = rpmMinMotorFrequency();
-            const float targetRpsChangeRate = (idleMinMotorRps - minRps) * currentPidProfile->idle_adjustment_speed;
-            const float error = targetRpsChangeRate - (minRps - oldMinRps) * pidGetPidFrequency();
-            const float pidSum = constrainf(idleP * error, -currentPidProfile->idle_pid_limit, currentPidProfile->idle_pid_limit);
-            motorRangeMinIncrease = constrainf(motorRangeMinIncrease + pidSum * pidGetDT(), 0.0f, maxIncrease);
-            oldMinRps = minRps;
+            if (ARMING_FLAG(ARMED)) {
+                const float maxIncrease = isAirmodeActivated() ? idleMaxIncrease : 0.04f;
+                const float minRps = rpmMinMotorFrequency();
+                const float targetRpsChangeRate = (idleMinMotorRps - minRps) * currentPidProfile->idle_adjustment_speed;
+                const float error = targetRpsChangeRate - (minRps - oldMinRps) * pidGetPidFrequency();
+                const float pidSum = constrainf(idleP * error, -currentPidProfile->idle_pid_limit, currentPidProfile->idle_pid_limit);
+                motorRangeMinIncrease = constrainf(motorRangeMinIncrease + pidSum * pidGetDT(), 0.0f, maxIncrease);
+                oldMinRps = minRps;
+
+                DEBUG_SET(DEBUG_DYN_IDLE, 1, targetRpsChangeRate);
+                DEBUG_SET(DEBUG_DYN_IDLE, 2, error);
+                DEBUG_SET(DEBUG_DYN_IDLE, 3, minRps);
+            } else {
+                // the motors are stopped, the idle starts from the configured value when armed
+                motorRangeMinIncrease = 0.0f;
+                oldMinRps = 0.0f;
+            }
             throttle += idleThrottleOffset * rcCommandThrottleRange;
-
             DEBUG_SET(DEBUG_DYN_IDLE, 0, motorRangeMinIncrease * 1000);
-            DEBUG_SET(DEBUG_DYN_IDLE, 1, targetRpsChangeRate);
-            DEBUG_SET(DEBUG_DYN_IDLE, 2, error);
-            DEBUG_SET(DEBUG_DYN_IDLE, 3, minRps);
-            
+
+            motorEndpointsPending = true;
         }
 #endif
         currentThrottleInputRange = rcCommandThrottleRange;
-        motorRangeMin = motorOutputLow + motorRangeMinIncrease * (motorOutputHigh - motorOutputLow);
-        motorRangeMax = motorOutputHigh;
-        motorOutputMin = motorRangeMin;
-        motorOutputRange = motorOutputHigh - motorOutputMin;
-        motorOutputMixSign = 1;
+        // outside 3D mode the endpoints only change with the configuration and dynamic idle
+        if (motorEndpointsPending) {
+            motorRangeMin = motorOutputLow + motorRangeMinIncrease * (motorOutputHigh - motorOutputLow);
+            motorRangeMax = motorOutputHigh;
+            motorOutputMin = motorRangeMin;
+            motorOutputRange = motorOutputHigh - motorOutputMin;
+            motorOutputMixSign = 1;
+            motorEndpointsPending = false;
+        }
     }
 
     throttle = constrainf(throttle / currentThrottleInputRange, 0.0f, 1.0f);
@@ -693,8 +741,18 @@ static void applyFlipOverAfterCrashModeToMotors(void)
     }
 }
 
-static void applyMixToMotors(float motorMix[MAX_SUPPORTED_MOTORS], motorMixer_t *activeMixer)
+static void applyMixToMotors(float motorMix[MAX_SUPPORTED_MOTORS], const motorMixer_t *activeMixer)
 {
+    // the limits are the same for all the motors, only the failsafe state changes them
+    const bool failsafeActive = failsafeIsActive();
+    const float motorOutputLimitLow = failsafeActive ? disarmMotorOutput : motorRangeMin;
+#ifdef USE_DSHOT
+    const bool preventReservedRange = failsafeActive && isMotorProtocolDshot();
+#endif
+#ifdef USE_SERVOS
+    const bool tricopter = mixerIsTricopter();
+#endif
+
     // Now add in the desired throttle, but keep in a range that doesn't clip adjusted
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
     for (int i = 0; i < motorCount; i++) {
@@ -705,21 +763,16 @@ static void applyMixToMotors(float motorMix[MAX_SUPPORTED_MOTORS], motorMixer_t
         motorOutput = motorOutputMin + motorOutputRange * motorOutput;
 
 #ifdef USE_SERVOS
-        if (mixerIsTricopter()) {
+        if (tricopter) {
             motorOutput += mixerTricopterMotorCorrection(i);
         }
 #endif
-        if (failsafeIsActive()) {
 #ifdef USE_DSHOT
-            if (isMotorProtocolDshot()) {
-                motorOutput = (motorOutput < motorRangeMin) ? disarmMotorOutput : motorOutput; // Prevent getting into special reserved range
-            }
-#endif
-            motorOutput = constrain(motorOutput, disarmMotorOutput, motorRangeMax);
-        } else {
-            motorOutput = constrain(motorOutput, motorRangeMin, motorRangeMax);
+        if (preventReservedRange) {
+            motorOutput = (motorOutput < motorRangeMin) ? disarmMotorOutput : motorOutput; // Prevent getting into special reserved range
         }
-        motor[i] = motorOutput;
+#endif
+        motor[i] = constrain(motorOutput, motorOutputLimitLow, motorRangeMax);
     }
 
     // Disarmed mode
@@ -753,21 +806,17 @@ static void applyMotorStop(void)
 }
 
 #ifdef USE_DYN_LPF
-static void updateDynLpfCutoffs(timeUs_t currentTimeUs, float throttle)
+// The cutoffs follow the throttle every loop, updating them is a table lookup. A step is only
+// taken once the throttle has clearly moved past the middle between two steps.
+static void updateDynLpfCutoffs(float throttle)
 {
-    static timeUs_t lastDynLpfUpdateUs = 0;
-    static int dynLpfPreviousQuantizedThrottle = -1;  // to allow an initial zero throttle to set the filter cutoff
-
-    if (cmpTimeUs(currentTimeUs, lastDynLpfUpdateUs) >= DYN_LPF_THROTTLE_UPDATE_DELAY_US) {
-        const int quantizedThrottle = lrintf(throttle * DYN_LPF_THROTTLE_STEPS); // quantize the throttle reduce the number of filter updates
-        if (quantizedThrottle != dynLpfPreviousQuantizedThrottle) {
-            // scale the quantized value back to the throttle range so the filter cutoff steps are repeatable
-            const float dynLpfThrottle = (float)quantizedThrottle / DYN_LPF_THROTTLE_STEPS;
-            dynLpfGyroUpdate(dynLpfThrottle);
-            dynLpfDTermUpdate(dynLpfThrottle);
-            dynLpfPreviousQuantizedThrottle = quantizedThrottle;
-            lastDynLpfUpdateUs = currentTimeUs;
-        }
+    static int dynLpfThrottleStep = -1;  // to allow an initial zero throttle to set the filter cutoff
+
+    const float throttleSteps = throttle * DYN_LPF_THROTTLE_STEPS;
+    if (dynLpfThrottleStep < 0 || fabsf(throttleSteps - dynLpfThrottleStep) > 0.5f + DYN_LPF_THROTTLE_HYSTERESIS) {
+        dynLpfThrottleStep = lrintf(throttleSteps);
+        dynLpfGyroUpdate(dynLpfThrottleStep);
+        dynLpfDTermUpdate(dynLpfThrottleStep);
     }
 }
 #endif
@@ -785,18 +834,21 @@ FAST_CODE_NOINLINE void mixTable(timeUs_t currentTimeUs, uint8_t vbatPidCompensa
 
     const bool launchControlActive = isLaunchControlActive();
 
-    motorMixer_t * activeMixer = &currentMixer[0];
+    const motorMixer_t *activeMixer = &mixMatrix[0];
 #ifdef USE_LAUNCH_CONTROL
     if (launchControlActive && (currentPidProfile->launchControlMode == LAUNCH_CONTROL_MODE_PITCHONLY)) {
-        activeMixer = &launchControlMixer[0];
+        activeMixer = &launchControlMixMatrix[0];
     }
 #endif
-    
-    // Calculate and Limit the PID sum
+
+    // Calculate voltage compensation
+    const float vbatCompensationFactor = vbatPidCompensation ? calculateVbatPidCompensation() : 1.0f;
+
+    // Calculate and Limit the PID sum, the mix matrix includes the PID mixer scaling
     const float scaledAxisPidRoll =
-        constrainf(pidData[FD_ROLL].Sum, -currentPidProfile->pidSumLimit, currentPidProfile->pidSumLimit) / PID_MIXER_SCALING;
+        constrainf(pidData[FD_ROLL].Sum, -currentPidProfile->pidSumLimit, currentPidProfile->pidSumLimit) * vbatCompensationFactor;
     const float scaledAxisPidPitch =
-        constrainf(pidData[FD_PITCH].Sum, -currentPidProfile->pidSumLimit, currentPidProfile->pidSumLimit) / PID_MIXER_SCALING;
+        constrainf(pidData[FD_PITCH].Sum, -currentPidProfile->pidSumLimit, currentPidProfile->pidSumLimit) * vbatCompensationFactor;
 
     uint16_t yawPidSumLimit = currentPidProfile->pidSumLimitYaw;
 
@@ -808,15 +860,12 @@ FAST_CODE_NOINLINE void mixTable(timeUs_t currentTimeUs, uint8_t vbatPidCompensa
 #endif // USE_YAW_SPIN_RECOVERY
 
     float scaledAxisPidYaw =
-        constrainf(pidData[FD_YAW].Sum, -yawPidSumLimit, yawPidSumLimit) / PID_MIXER_SCALING;
+        constrainf(pidData[FD_YAW].Sum, -yawPidSumLimit, yawPidSumLimit) * vbatCompensationFactor;
 
     if (!mixerConfig()->yaw_motors_reversed) {
         scaledAxisPidYaw = -scaledAxisPidYaw;
     }
 
-    // Calculate voltage compensation
-    const float vbatCompensationFactor = vbatPidCompensation ? calculateVbatPidCompensation() : 1.0f;
-
     // Apply the throttle_limit_percent to scale or limit the throttle based on throttle_limit_type
     if (currentControlRateProfile->throttle_limit_type != THROTTLE_LIMIT_TYPE_OFF) {
         throttle = applyThrottleLimit(throttle);
@@ -850,8 +899,6 @@ FAST_CODE_NOINLINE void mixTable(timeUs_t currentTimeUs, uint8_t vbatPidCompensa
             scaledAxisPidPitch * activeMixer[i].pitch +
             scaledAxisPidYaw   * activeMixer[i].yaw;
 
-        mix *= vbatCompensationFactor;  // Add voltage compensation
-
         if (mix > motorMixMax) {
             motorMixMax = mix;
         } else if (mix < motorMixMin) {
@@ -863,7 +910,7 @@ FAST_CODE_NOINLINE void mixTable(timeUs_t currentTimeUs, uint8_t vbatPidCompensa
     pidUpdateAntiGravityThrottleFilter(throttle);
 
 #ifdef USE_DYN_LPF
-    updateDynLpfCutoffs(currentTimeUs, throttle);
+    updateDynLpfCutoffs(throttle);
 #endif
 
 #ifdef USE_THRUST_LINEARIZATION
@@ -35,6 +35,7 @@
 #include "config/config_reset.h"
 
 #include "drivers/dshot_command.h"
+#include "drivers/pendsv.h"
 #include "drivers/pwm_output.h"
 #include "drivers/sound_beeper.h"
 #include "drivers/time.h"
@@ -240,6 +241,15 @@ static void pidSetTargetLooptime(uint32_t pidLooptime)
 #endif
 }
 
+#ifdef USE_GYRO_ODR_TRACKING
+// The pid loop runs off the gyro samples, so its actual period follows the output data rate of the gyro
+void pidSetLooptimeScale(float scale)
+{
+    dT = targetPidLooptime * 1e-6f * scale;
+    pidFrequency = 1.0f / dT;
+}
+#endif
+
 static FAST_RAM float itermAccelerator = 1.0f;
 
 void pidSetItermAccelerator(float newItermAccelerator)
@@ -259,19 +269,27 @@ void pidStabilisationState(pidStabilisationState_e pidControllerState)
 
 const angle_index_t rcAliasToAngleIndexMap[] = { AI_ROLL, AI_PITCH };
 
+typedef enum {
+    DTERM_FILTER_STAGE_NONE = 0,
+    DTERM_FILTER_STAGE_PT1,
+    DTERM_FILTER_STAGE_BIQUAD,
+    DTERM_FILTER_STAGE_BIQUAD_DF1,
+} dtermFilterStage_e;
+
+// the D term filters run on all three axes at once, see pidDtermFilterApply()
 typedef union dtermLowpass_u {
-    pt1Filter_t pt1Filter;
-    biquadFilter_t biquadFilter;
+    pt1Filter3_t pt1Filter;
+    biquadFilter3_t biquadFilter;
 } dtermLowpass_t;
 
 static FAST_RAM_ZERO_INIT float previousPidSetpoint[XYZ_AXIS_COUNT];
 
-static FAST_RAM_ZERO_INIT filterApplyFnPtr dtermNotchApplyFn;
-static FAST_RAM_ZERO_INIT biquadFilter_t dtermNotch[XYZ_AXIS_COUNT];
-static FAST_RAM_ZERO_INIT filterApplyFnPtr dtermLowpassApplyFn;
-static FAST_RAM_ZERO_INIT dtermLowpass_t dtermLowpass[XYZ_AXIS_COUNT];
-static FAST_RAM_ZERO_INIT filterApplyFnPtr dtermLowpass2ApplyFn;
-static FAST_RAM_ZERO_INIT dtermLowpass_t dtermLowpass2[XYZ_AXIS_COUNT];
+static FAST_RAM_ZERO_INIT bool dtermNotchEnabled;
+static FAST_RAM_ZERO_INIT biquadFilter3_t dtermNotch;
+static FAST_RAM_ZERO_INIT dtermFilterStage_e dtermLowpassStage;
+static FAST_RAM_ZERO_INIT dtermLowpass_t dtermLowpass;
+static FAST_RAM_ZERO_INIT dtermFilterStage_e dtermLowpass2Stage;
+static FAST_RAM_ZERO_INIT dtermLowpass_t dtermLowpass2;
 static FAST_RAM_ZERO_INIT filterApplyFnPtr ptermYawLowpassApplyFn;
 static FAST_RAM_ZERO_INIT pt1Filter_t ptermYawLowpass;
 
@@ -328,18 +346,8 @@ float pidGetFfBoostFactor()
 }
 
 
-void pidInitFilters(const pidProfile_t *pidProfile)
+static void pidInitDtermNotch(const pidProfile_t *pidProfile)
 {
-    STATIC_ASSERT(FD_YAW == 2, FD_YAW_incorrect); // ensure yaw axis is 2
-
-    if (targetPidLooptime == 0) {
-        // no looptime set, so set all the filters to null
-        dtermNotchApplyFn = nullFilterApply;
-        dtermLowpassApplyFn = nullFilterApply;
-        ptermYawLowpassApplyFn = nullFilterApply;
-        return;
-    }
-
     const uint32_t pidFrequencyNyquist = pidFrequency / 2; // No rounding needed
 
     uint16_t dTermNotchHz;
@@ -354,14 +362,17 @@ void pidInitFilters(const pidProfile_t *pidProfile)
     }
 
     if (dTermNotchHz != 0 && pidProfile->dterm_notch_cutoff != 0) {
-        dtermNotchApplyFn = (filterApplyFnPtr)biquadFilterApply;
+        dtermNotchEnabled = true;
         const float notchQ = filterGetNotchQ(dTermNotchHz, pidProfile->dterm_notch_cutoff);
-        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-            biquadFilterInit(&dtermNotch[axis], dTermNotchHz, targetPidLooptime, notchQ, FILTER_NOTCH);
-        }
+        biquadFilter3Init(&dtermNotch, dTermNotchHz, targetPidLooptime, notchQ, FILTER_NOTCH);
     } else {
-        dtermNotchApplyFn = nullFilterApply;
+        dtermNotchEnabled = false;
     }
+}
+
+static void pidInitDtermLowpass(const pidProfile_t *pidProfile)
+{
+    const uint32_t pidFrequencyNyquist = pidFrequency / 2;
 
     //1st Dterm Lowpass Filter
     uint16_t dterm_lowpass_hz = pidProfile->dterm_lowpass_hz;
@@ -375,51 +386,53 @@ void pidInitFilters(const pidProfile_t *pidProfile)
     if (dterm_lowpass_hz > 0 && dterm_lowpass_hz < pidFrequencyNyquist) {
         switch (pidProfile->dterm_filter_type) {
         case FILTER_PT1:
-            dtermLowpassApplyFn = (filterApplyFnPtr)pt1FilterApply;
-            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                pt1FilterInit(&dtermLowpass[axis].pt1Filter, pt1FilterGain(dterm_lowpass_hz, dT));
-            }
+            dtermLowpassStage = DTERM_FILTER_STAGE_PT1;
+            pt1Filter3Init(&dtermLowpass.pt1Filter, pt1FilterGain(dterm_lowpass_hz, dT));
             break;
         case FILTER_BIQUAD:
 #ifdef USE_DYN_LPF
-            dtermLowpassApplyFn = (filterApplyFnPtr)biquadFilterApplyDF1;
+            dtermLowpassStage = DTERM_FILTER_STAGE_BIQUAD_DF1;
 #else
-            dtermLowpassApplyFn = (filterApplyFnPtr)biquadFilterApply;
+            dtermLowpassStage = DTERM_FILTER_STAGE_BIQUAD;
 #endif
-            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                biquadFilterInitLPF(&dtermLowpass[axis].biquadFilter, dterm_lowpass_hz, targetPidLooptime);
-            }
+            biquadFilter3InitLPF(&dtermLowpass.biquadFilter, dterm_lowpass_hz, targetPidLooptime);
             break;
         default:
-            dtermLowpassApplyFn = nullFilterApply;
+            dtermLowpassStage = DTERM_FILTER_STAGE_NONE;
             break;
         }
     } else {
-        dtermLowpassApplyFn = nullFilterApply;
+        dtermLowpassStage = DTERM_FILTER_STAGE_NONE;
     }
+}
+
+static void pidInitDtermLowpass2(const pidProfile_t *pidProfile)
+{
+    const uint32_t pidFrequencyNyquist = pidFrequency / 2;
 
     //2nd Dterm Lowpass Filter
     if (pidProfile->dterm_lowpass2_hz == 0 || pidProfile->dterm_lowpass2_hz > pidFrequencyNyquist) {
-    	dtermLowpass2ApplyFn = nullFilterApply;
+    	dtermLowpass2Stage = DTERM_FILTER_STAGE_NONE;
     } else {
         switch (pidProfile->dterm_filter2_type) {
         case FILTER_PT1:
-            dtermLowpass2ApplyFn = (filterApplyFnPtr)pt1FilterApply;
-            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                pt1FilterInit(&dtermLowpass2[axis].pt1Filter, pt1FilterGain(pidProfile->dterm_lowpass2_hz, dT));
-            }
+            dtermLowpass2Stage = DTERM_FILTER_STAGE_PT1;
+            pt1Filter3Init(&dtermLowpass2.pt1Filter, pt1FilterGain(pidProfile->dterm_lowpass2_hz, dT));
             break;
         case FILTER_BIQUAD:
-            dtermLowpass2ApplyFn = (filterApplyFnPtr)biquadFilterApply;
-            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                biquadFilterInitLPF(&dtermLowpass2[axis].biquadFilter, pidProfile->dterm_lowpass2_hz, targetPidLooptime);
-            }
+            dtermLowpass2Stage = DTERM_FILTER_STAGE_BIQUAD;
+            biquadFilter3InitLPF(&dtermLowpass2.biquadFilter, pidProfile->dterm_lowpass2_hz, targetPidLooptime);
             break;
         default:
-            dtermLowpass2ApplyFn = nullFilterApply;
+            dtermLowpass2Stage = DTERM_FILTER_STAGE_NONE;
             break;
         }
     }
+}
+
+static void pidInitYawLowpass(const pidProfile_t *pidProfile)
+{
+    const uint32_t pidFrequencyNyquist = pidFrequency / 2;
 
     if (pidProfile->yaw_lowpass_hz == 0 || pidProfile->yaw_lowpass_hz > pidFrequencyNyquist) {
         ptermYawLowpassApplyFn = nullFilterApply;
@@ -427,6 +440,31 @@ void pidInitFilters(const pidProfile_t *pidProfile)
         ptermYawLowpassApplyFn = (filterApplyFnPtr)pt1FilterApply;
         pt1FilterInit(&ptermYawLowpass, pt1FilterGain(pidProfile->yaw_lowpass_hz, dT));
     }
+}
+
+static void pidInitFeedForwardBoost(const pidProfile_t *pidProfile)
+{
+    ffBoostFactor = (float)pidProfile->ff_boost / 10.0f;
+    ffSpikeLimitInverse = pidProfile->ff_spike_limit ? 1.0f / ((float)pidProfile->ff_spike_limit / 10.0f) : 0.0f;
+}
+
+void pidInitFilters(const pidProfile_t *pidProfile)
+{
+    STATIC_ASSERT(FD_YAW == 2, FD_YAW_incorrect); // ensure yaw axis is 2
+
+    if (targetPidLooptime == 0) {
+        // no looptime set, so set all the filters to null
+        dtermNotchEnabled = false;
+        dtermLowpassStage = DTERM_FILTER_STAGE_NONE;
+        dtermLowpass2Stage = DTERM_FILTER_STAGE_NONE;
+        ptermYawLowpassApplyFn = nullFilterApply;
+        return;
+    }
+
+    pidInitDtermNotch(pidProfile);
+    pidInitDtermLowpass(pidProfile);
+    pidInitDtermLowpass2(pidProfile);
+    pidInitYawLowpass(pidProfile);
 
 #if defined(USE_THROTTLE_BOOST)
     pt1FilterInit(&throttleLpf, pt1FilterGain(pidProfile->throttle_boost_cutoff, dT));
@@ -465,8 +503,7 @@ void pidInitFilters(const pidProfile_t *pidProfile)
 
     pt1FilterInit(&antiGravityThrottleLpf, pt1FilterGain(ANTI_GRAVITY_THROTTLE_FILTER_CUTOFF, dT));
 
-    ffBoostFactor = (float)pidProfile->ff_boost / 10.0f;
-    ffSpikeLimitInverse = pidProfile->ff_spike_limit ? 1.0f / ((float)pidProfile->ff_spike_limit / 10.0f) : 0.0f;
+    pidInitFeedForwardBoost(pidProfile);
 }
 
 #ifdef USE_RC_SMOOTHING_FILTER
@@ -581,6 +618,8 @@ void pidUpdateAntiGravityThrottleFilter(float throttle)
 static FAST_RAM uint8_t dynLpfFilter = DYN_LPF_NONE;
 static FAST_RAM_ZERO_INIT uint16_t dynLpfMin;
 static FAST_RAM_ZERO_INIT uint16_t dynLpfMax;
+static dynLpfCoeffs_t dynLpfCoeffs[DYN_LPF_THROTTLE_STEPS + 1];
+static uint32_t dynLpfLooptime;
 #endif
 
 #ifdef USE_D_MIN
@@ -591,9 +630,23 @@ static FAST_RAM_ZERO_INIT float dMinSetpointGain;
 
 #ifdef USE_INTERPOLATED_SP
 static FAST_RAM_ZERO_INIT ffInterpolationType_t ffFromInterpolatedSetpoint;
+static FAST_RAM_ZERO_INIT uint32_t lastFrameNumber;
 #endif
 
-void pidInitConfig(const pidProfile_t *pidProfile)
+// The controller loop state is kept in file scope, so that the controller variants built from pid_impl.c
+// share it and the variant can change with the profile without resetting the controller
+static FAST_RAM_ZERO_INIT float previousGyroRateDterm[XYZ_AXIS_COUNT];
+#if defined(USE_ACC)
+static FAST_RAM_ZERO_INIT timeUs_t levelModeStartTimeUs;
+static FAST_RAM_ZERO_INIT bool gpsRescuePreviousState;
+#endif
+
+typedef void (*pidControllerFnPtr)(const pidProfile_t *pidProfile, timeUs_t currentTimeUs);
+STATIC_UNIT_TESTED void pidControllerGeneric(const pidProfile_t *pidProfile, timeUs_t currentTimeUs);
+static FAST_RAM pidControllerFnPtr pidControllerFn = pidControllerGeneric;
+static void pidInitController(void);
+
+static void pidConfigure(const pidProfile_t *pidProfile)
 {
     if (pidProfile->feedForwardTransition == 0) {
         feedForwardTransition = 0;
@@ -679,6 +732,9 @@ void pidInitConfig(const pidProfile_t *pidProfile)
 #endif
 
 #ifdef USE_DYN_LPF
+    const uint8_t previousDynLpfFilter = dynLpfFilter;
+    const uint16_t previousDynLpfMin = dynLpfMin;
+    const uint16_t previousDynLpfMax = dynLpfMax;
     if (pidProfile->dyn_lpf_dterm_min_hz > 0) {
         switch (pidProfile->dterm_filter_type) {
         case FILTER_PT1:
@@ -696,6 +752,12 @@ void pidInitConfig(const pidProfile_t *pidProfile)
     }
     dynLpfMin = pidProfile->dyn_lpf_dterm_min_hz;
     dynLpfMax = pidProfile->dyn_lpf_dterm_max_hz;
+    // in-flight adjustments get here for unrelated changes, only recalculate the table when it changes
+    if (dynLpfFilter != previousDynLpfFilter || dynLpfMin != previousDynLpfMin || dynLpfMax != previousDynLpfMax
+        || targetPidLooptime != dynLpfLooptime) {
+        dynLpfCoeffsInit(dynLpfCoeffs, dynLpfFilter, dynLpfMin, dynLpfMax, targetPidLooptime);
+        dynLpfLooptime = targetPidLooptime;
+    }
 #endif
 
 #ifdef USE_LAUNCH_CONTROL
@@ -740,16 +802,94 @@ void pidInitConfig(const pidProfile_t *pidProfile)
     ffFromInterpolatedSetpoint = pidProfile->ff_interpolate_sp;
     interpolatedSpInit(pidProfile);
 #endif
+    pidInitController();
+}
+
+// Called while running e.g. from the in flight adjustments, so the PID loop run from PendSV is held
+// off until all of the coefficients and the controller function agree with each other again
+void pidInitConfig(const pidProfile_t *pidProfile)
+{
+    PENDSV_BLOCK {
+        pidConfigure(pidProfile);
+    }
 }
 
 void pidInit(const pidProfile_t *pidProfile)
 {
-    pidSetTargetLooptime(gyro.targetLooptime * pidConfig()->pid_process_denom); // Initialize pid looptime
-    pidInitFilters(pidProfile);
-    pidInitConfig(pidProfile);
+    PENDSV_BLOCK {
+        pidSetTargetLooptime(gyro.targetLooptime * pidConfig()->pid_process_denom); // Initialize pid looptime
+        pidInitFilters(pidProfile);
+        pidInitConfig(pidProfile);
 #ifdef USE_RPM_FILTER
-    rpmFilterInit(rpmFilterConfig());
+        rpmFilterInit(rpmFilterConfig());
 #endif
+    }
+}
+
+// Switches the controller from previousProfile to pidProfile, without the stall of pidInit():
+// the loop time and the RPM filter do not depend on the profile, and the filters are only
+// reinitialised where the two profiles differ, the others keep their state so that an in
+// flight switch does not kick the D term. Filters with a constant cutoff are left alone.
+void pidChangeProfile(const pidProfile_t *previousProfile, const pidProfile_t *pidProfile)
+{
+    pidInitConfig(pidProfile);
+
+    if (targetPidLooptime == 0) {
+        return;
+    }
+
+    if (pidProfile->dterm_notch_hz != previousProfile->dterm_notch_hz
+        || pidProfile->dterm_notch_cutoff != previousProfile->dterm_notch_cutoff) {
+        pidInitDtermNotch(pidProfile);
+    }
+    if (pidProfile->dterm_lowpass_hz != previousProfile->dterm_lowpass_hz
+#ifdef USE_DYN_LPF
+        || pidProfile->dyn_lpf_dterm_min_hz != previousProfile->dyn_lpf_dterm_min_hz
+#endif
+        || pidProfile->dterm_filter_type != previousProfile->dterm_filter_type) {
+        pidInitDtermLowpass(pidProfile);
+    }
+    if (pidProfile->dterm_lowpass2_hz != previousProfile->dterm_lowpass2_hz
+        || pidProfile->dterm_filter2_type != previousProfile->dterm_filter2_type) {
+        pidInitDtermLowpass2(pidProfile);
+    }
+    if (pidProfile->yaw_lowpass_hz != previousProfile->yaw_lowpass_hz) {
+        pidInitYawLowpass(pidProfile);
+    }
+
+#if defined(USE_THROTTLE_BOOST)
+    pt1FilterUpdateCutoff(&throttleLpf, pt1FilterGain(pidProfile->throttle_boost_cutoff, dT));
+#endif
+#if defined(USE_ITERM_RELAX)
+    if (itermRelax) {
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            if (previousProfile->iterm_relax) {
+                pt1FilterUpdateCutoff(&windupLpf[i], pt1FilterGain(itermRelaxCutoff, dT));
+            } else {
+                pt1FilterInit(&windupLpf[i], pt1FilterGain(itermRelaxCutoff, dT));
+            }
+        }
+    }
+#endif
+#if defined(USE_ABSOLUTE_CONTROL)
+    if (itermRelax) {
+        for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+            if (previousProfile->iterm_relax) {
+                pt1FilterUpdateCutoff(&acLpf[i], pt1FilterGain(acCutoff, dT));
+            } else {
+                pt1FilterInit(&acLpf[i], pt1FilterGain(acCutoff, dT));
+            }
+        }
+    }
+#endif
+#if defined(USE_AIRMODE_LPF)
+    if (pidProfile->transient_throttle_limit && !previousProfile->transient_throttle_limit) {
+        pt1FilterInit(&airmodeThrottleLpf1, pt1FilterGain(7.0f, dT));
+        pt1FilterInit(&airmodeThrottleLpf2, pt1FilterGain(20.0f, dT));
+    }
+#endif
+
+    pidInitFeedForwardBoost(pidProfile);
 }
 
 #ifdef USE_ACRO_TRAINER
@@ -869,11 +1009,12 @@ STATIC_UNIT_TESTED float pidLevel(int axis, const pidProfile_t *pidProfile, cons
 
 static timeUs_t crashDetectedAtUs;
 
+// only called while inCrashRecoveryMode
 static void handleCrashRecovery(
     const pidCrashRecovery_e crash_recovery, const rollAndPitchTrims_t *angleTrim,
     const int axis, const timeUs_t currentTimeUs, const float gyroRate, float *currentPidSetpoint, float *errorRate)
 {
-    if (inCrashRecoveryMode && cmpTimeUs(currentTimeUs, crashDetectedAtUs) > crashTimeDelayUs) {
+    if (cmpTimeUs(currentTimeUs, crashDetectedAtUs) > crashTimeDelayUs) {
         if (crash_recovery == PID_CRASH_RECOVERY_BEEP) {
             BEEP_ON;
         }
@@ -911,35 +1052,33 @@ static void handleCrashRecovery(
     }
 }
 
+// Only called if crash recovery is on or GPS rescue is active and there is no gyro overflow, there is
+// no point in trying to recover if the crash is so severe that the gyro overflows
 static void detectAndSetCrashRecovery(
     const pidCrashRecovery_e crash_recovery, const int axis,
     const timeUs_t currentTimeUs, const float delta, const float errorRate)
 {
-    // if crash recovery is on and accelerometer enabled and there is no gyro overflow, then check for a crash
-    // no point in trying to recover if the crash is so severe that the gyro overflows
-    if ((crash_recovery || FLIGHT_MODE(GPS_RESCUE_MODE)) && !gyroOverflowDetected()) {
-        if (ARMING_FLAG(ARMED)) {
-            if (getMotorMixRange() >= 1.0f && !inCrashRecoveryMode
-                && fabsf(delta) > crashDtermThreshold
-                && fabsf(errorRate) > crashGyroThreshold
-                && fabsf(getSetpointRate(axis)) < crashSetpointThreshold) {
-                if (crash_recovery == PID_CRASH_RECOVERY_DISARM) {
-                    setArmingDisabled(ARMING_DISABLED_CRASH_DETECTED);
-                    disarm();
-                } else {
-                    inCrashRecoveryMode = true;
-                    crashDetectedAtUs = currentTimeUs;
-                }
-            }
-            if (inCrashRecoveryMode && cmpTimeUs(currentTimeUs, crashDetectedAtUs) < crashTimeDelayUs && (fabsf(errorRate) < crashGyroThreshold
-                || fabsf(getSetpointRate(axis)) > crashSetpointThreshold)) {
-                inCrashRecoveryMode = false;
-                BEEP_OFF;
+    if (ARMING_FLAG(ARMED)) {
+        if (getMotorMixRange() >= 1.0f && !inCrashRecoveryMode
+            && fabsf(delta) > crashDtermThreshold
+            && fabsf(errorRate) > crashGyroThreshold
+            && fabsf(getSetpointRate(axis)) < crashSetpointThreshold) {
+            if (crash_recovery == PID_CRASH_RECOVERY_DISARM) {
+                setArmingDisabled(ARMING_DISABLED_CRASH_DETECTED);
+                disarm();
+            } else {
+                inCrashRecoveryMode = true;
+                crashDetectedAtUs = currentTimeUs;
             }
-        } else if (inCrashRecoveryMode) {
+        }
+        if (inCrashRecoveryMode && cmpTimeUs(currentTimeUs, crashDetectedAtUs) < crashTimeDelayUs && (fabsf(errorRate) < crashGyroThreshold
+            || fabsf(getSetpointRate(axis)) > crashSetpointThreshold)) {
             inCrashRecoveryMode = false;
             BEEP_OFF;
         }
+    } else if (inCrashRecoveryMode) {
+        inCrashRecoveryMode = false;
+        BEEP_OFF;
     }
 }
 #endif // USE_ACC
@@ -1239,320 +1378,102 @@ static float applyLaunchControl(int axis, const rollAndPitchTrims_t *angleTrim)
 }
 #endif
 
-// Betaflight pid controller, which will be maintained in the future with additional features specialised for current (mini) multirotor usage.
-// Based on 2DOF reference design (matlab)
-void FAST_CODE pidController(const pidProfile_t *pidProfile, timeUs_t currentTimeUs)
+static inline void dtermLowpassFilterApply(dtermFilterStage_e stage, dtermLowpass_t *filter, float *values)
 {
-    static float previousGyroRateDterm[XYZ_AXIS_COUNT];
-#ifdef USE_INTERPOLATED_SP
-    static FAST_RAM_ZERO_INIT uint32_t lastFrameNumber;
-#endif
-
-#if defined(USE_ACC)
-    static timeUs_t levelModeStartTimeUs = 0;
-    static bool gpsRescuePreviousState = false;
-#endif
-
-    const float tpaFactor = getThrottlePIDAttenuation();
-
-#if defined(USE_ACC)
-    const rollAndPitchTrims_t *angleTrim = &accelerometerConfig()->accelerometerTrims;
-#else
-    UNUSED(pidProfile);
-    UNUSED(currentTimeUs);
-#endif
-
-#ifdef USE_TPA_MODE
-    const float tpaFactorKp = (currentControlRateProfile->tpaMode == TPA_MODE_PD) ? tpaFactor : 1.0f;
-#else
-    const float tpaFactorKp = tpaFactor;
-#endif
-
-#ifdef USE_YAW_SPIN_RECOVERY
-    const bool yawSpinActive = gyroYawSpinDetected();
-#endif
-
-    const bool launchControlActive = isLaunchControlActive();
-
-#if defined(USE_ACC)
-    const bool gpsRescueIsActive = FLIGHT_MODE(GPS_RESCUE_MODE);
-    const bool levelModeActive = FLIGHT_MODE(ANGLE_MODE) || FLIGHT_MODE(HORIZON_MODE) || gpsRescueIsActive;
-
-    // Keep track of when we entered a self-level mode so that we can
-    // add a guard time before crash recovery can activate.
-    // Also reset the guard time whenever GPS Rescue is activated.
-    if (levelModeActive) {
-        if ((levelModeStartTimeUs == 0) || (gpsRescueIsActive && !gpsRescuePreviousState)) {
-            levelModeStartTimeUs = currentTimeUs;
-        }
-    } else {
-        levelModeStartTimeUs = 0;
-    }
-    gpsRescuePreviousState = gpsRescueIsActive;
-#endif
-
-    // Dynamic i component,
-    if ((antiGravityMode == ANTI_GRAVITY_SMOOTH) && antiGravityEnabled) {
-        itermAccelerator = 1 + fabsf(antiGravityThrottleHpf) * 0.01f * (itermAcceleratorGain - 1000);
-        DEBUG_SET(DEBUG_ANTI_GRAVITY, 1, lrintf(antiGravityThrottleHpf * 1000));
-    }
-    DEBUG_SET(DEBUG_ANTI_GRAVITY, 0, lrintf(itermAccelerator * 1000));
-
-    // gradually scale back integration when above windup point
-    float dynCi = dT * itermAccelerator;
-    if (itermWindupPointInv > 1.0f) {
-        dynCi *= constrainf((1.0f - getMotorMixRange()) * itermWindupPointInv, 0.0f, 1.0f);
+    switch (stage) {
+    case DTERM_FILTER_STAGE_PT1:
+        pt1Filter3Apply(&filter->pt1Filter, values);
+        break;
+    case DTERM_FILTER_STAGE_BIQUAD:
+        biquadFilter3Apply(&filter->biquadFilter, values);
+        break;
+    case DTERM_FILTER_STAGE_BIQUAD_DF1:
+        biquadFilter3ApplyDF1(&filter->biquadFilter, values);
+        break;
+    default:
+        break;
     }
+}
 
-    // Precalculate gyro deta for D-term here, this allows loop unrolling
-    float gyroRateDterm[XYZ_AXIS_COUNT];
-    for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
-        gyroRateDterm[axis] = gyro.gyroADCf[axis];
+// Filters the gyro rates the D term is calculated from in place. Like the gyro filter chain each
+// stage filters all three axes in one call, sharing its coefficients across the axes.
+STATIC_UNIT_TESTED FAST_CODE void pidDtermFilterApply(float *values)
+{
 #ifdef USE_RPM_FILTER
-        gyroRateDterm[axis] = rpmFilterDterm(axis,gyroRateDterm[axis]);
+    rpmFilterDtermApply(values);
 #endif
-        gyroRateDterm[axis] = dtermNotchApplyFn((filter_t *) &dtermNotch[axis], gyroRateDterm[axis]);
-        gyroRateDterm[axis] = dtermLowpassApplyFn((filter_t *) &dtermLowpass[axis], gyroRateDterm[axis]);
-        gyroRateDterm[axis] = dtermLowpass2ApplyFn((filter_t *) &dtermLowpass2[axis], gyroRateDterm[axis]);
+    if (dtermNotchEnabled) {
+        biquadFilter3Apply(&dtermNotch, values);
     }
+    dtermLowpassFilterApply(dtermLowpassStage, &dtermLowpass, values);
+    dtermLowpassFilterApply(dtermLowpass2Stage, &dtermLowpass2, values);
+}
 
-    rotateItermAndAxisError();
-#ifdef USE_RPM_FILTER
-    rpmFilterUpdate();
-#endif
-
-#ifdef USE_INTERPOLATED_SP
-    bool newRcFrame = false;
-    if (lastFrameNumber != getRcFrameNumber()) {
-        lastFrameNumber = getRcFrameNumber();
-        newRcFrame = true;
-    }
-#endif
-
-    // ----------PID controller----------
-    for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
-
-        float currentPidSetpoint = getSetpointRate(axis);
-        if (maxVelocity[axis]) {
-            currentPidSetpoint = accelerationLimit(axis, currentPidSetpoint);
-        }
-        // Yaw control is GYRO based, direct sticks control is applied to rate PID
-#if defined(USE_ACC)
-        if (levelModeActive && (axis != FD_YAW)) {
-            currentPidSetpoint = pidLevel(axis, pidProfile, angleTrim, currentPidSetpoint);
-        }
-#endif
-
-#ifdef USE_ACRO_TRAINER
-        if ((axis != FD_YAW) && acroTrainerActive && !inCrashRecoveryMode && !launchControlActive) {
-            currentPidSetpoint = applyAcroTrainer(axis, angleTrim, currentPidSetpoint);
-        }
-#endif // USE_ACRO_TRAINER
-
-#ifdef USE_LAUNCH_CONTROL
-        if (launchControlActive) {
-#if defined(USE_ACC)
-            currentPidSetpoint = applyLaunchControl(axis, angleTrim);
+// The modes that are rarely active, gathered once per loop so that in plain acro the axis loop
+// tests a single mask instead of the conditions of every mode
+typedef enum {
+    PID_LOOP_MODE_LEVEL             = (1 << 0),
+    PID_LOOP_MODE_ACRO_TRAINER      = (1 << 1),
+    PID_LOOP_MODE_LAUNCH_CONTROL    = (1 << 2),
+    PID_LOOP_MODE_YAW_SPIN          = (1 << 3),
+    PID_LOOP_MODE_CRASH_DETECTION   = (1 << 4),
+} pidLoopMode_e;
+
+#define PID_LOOP_MODES_SETPOINT (PID_LOOP_MODE_LEVEL | PID_LOOP_MODE_ACRO_TRAINER | PID_LOOP_MODE_LAUNCH_CONTROL | PID_LOOP_MODE_YAW_SPIN)
+
+#define PID_CONTROLLER_FUNCTION_NAME pidControllerGeneric
+#define PID_ITERM_RELAX true
+#define PID_ABSOLUTE_CONTROL true
+#ifdef USE_INTEGRATED_YAW_CONTROL
+#define PID_INTEGRATED_YAW useIntegratedYaw
 #else
-            currentPidSetpoint = applyLaunchControl(axis, NULL);
-#endif
-        }
-#endif
-
-        // Handle yaw spin recovery - zero the setpoint on yaw to aid in recovery
-        // It's not necessary to zero the set points for R/P because the PIDs will be zeroed below
-#ifdef USE_YAW_SPIN_RECOVERY
-        if ((axis == FD_YAW) && yawSpinActive) {
-            currentPidSetpoint = 0.0f;
-        }
-#endif // USE_YAW_SPIN_RECOVERY
-
-        // -----calculate error rate
-        const float gyroRate = gyro.gyroADCf[axis]; // Process variable from gyro output in deg/sec
-        float errorRate = currentPidSetpoint - gyroRate; // r - y
-#if defined(USE_ACC)
-        handleCrashRecovery(
-            pidProfile->crash_recovery, angleTrim, axis, currentTimeUs, gyroRate,
-            &currentPidSetpoint, &errorRate);
-#endif
-
-        const float previousIterm = pidData[axis].I;
-        float itermErrorRate = errorRate;
-#ifdef USE_ABSOLUTE_CONTROL
-        float uncorrectedSetpoint = currentPidSetpoint;
-#endif
+#define PID_INTEGRATED_YAW false
+#endif
+#include "pid_impl.c"
+#undef PID_CONTROLLER_FUNCTION_NAME
+#undef PID_ITERM_RELAX
+#undef PID_ABSOLUTE_CONTROL
+#undef PID_INTEGRATED_YAW
+
+// Variant for the default profile, with iterm relax but without absolute control and integrated yaw,
+// see pidInitController()
+#define PID_CONTROLLER_FUNCTION_NAME pidControllerItermRelax
+#define PID_ITERM_RELAX true
+#define PID_ABSOLUTE_CONTROL false
+#define PID_INTEGRATED_YAW false
+#include "pid_impl.c"
+#undef PID_CONTROLLER_FUNCTION_NAME
+#undef PID_ITERM_RELAX
+#undef PID_ABSOLUTE_CONTROL
+#undef PID_INTEGRATED_YAW
+
+// Picks the controller variant for the current configuration, must be called once the configuration has been initialised
+static void pidInitController(void)
+{
+    pidControllerFn = pidControllerGeneric;
 
 #if defined(USE_ITERM_RELAX)
-        if (!launchControlActive && !inCrashRecoveryMode) {
-            applyItermRelax(axis, previousIterm, gyroRate, &itermErrorRate, &currentPidSetpoint);
-            errorRate = currentPidSetpoint - gyroRate;
-        }
-#endif
-#ifdef USE_ABSOLUTE_CONTROL
-        float setpointCorrection = currentPidSetpoint - uncorrectedSetpoint;
-#endif
-
-        // --------low-level gyro-based PID based on 2DOF PID controller. ----------
-        // 2-DOF PID controller with optional filter on derivative term.
-        // b = 1 and only c (feedforward weight) can be tuned (amount derivative on measurement or error).
-
-        // -----calculate P component
-        pidData[axis].P = pidCoefficient[axis].Kp * errorRate * tpaFactorKp;
-        if (axis == FD_YAW) {
-            pidData[axis].P = ptermYawLowpassApplyFn((filter_t *) &ptermYawLowpass, pidData[axis].P);
-        }
-
-        // -----calculate I component
-#ifdef USE_LAUNCH_CONTROL
-        // if launch control is active override the iterm gains
-        const float Ki = launchControlActive ? launchControlKi : pidCoefficient[axis].Ki;
-#else
-        const float Ki = pidCoefficient[axis].Ki;
-#endif
-        pidData[axis].I = constrainf(previousIterm + Ki * itermErrorRate * dynCi, -itermLimit, itermLimit);
-
-        // -----calculate pidSetpointDelta
-        float pidSetpointDelta = 0;
-#ifdef USE_INTERPOLATED_SP
-        if (ffFromInterpolatedSetpoint) {
-            pidSetpointDelta = interpolatedSpApply(axis, newRcFrame, ffFromInterpolatedSetpoint);
-        } else {
-            pidSetpointDelta = currentPidSetpoint - previousPidSetpoint[axis];
-        }
-#else
-        pidSetpointDelta = currentPidSetpoint - previousPidSetpoint[axis];
-#endif
-        previousPidSetpoint[axis] = currentPidSetpoint;
-
-
-#ifdef USE_RC_SMOOTHING_FILTER
-        pidSetpointDelta = applyRcSmoothingDerivativeFilter(axis, pidSetpointDelta);
-#endif // USE_RC_SMOOTHING_FILTER
-
-        // -----calculate D component
-        // disable D if launch control is active
-        if ((pidCoefficient[axis].Kd > 0) && !launchControlActive){
-
-            // Divide rate change by dT to get differential (ie dr/dt).
-            // dT is fixed and calculated from the target PID loop time
-            // This is done to avoid DTerm spikes that occur with dynamically
-            // calculated deltaT whenever another task causes the PID
-            // loop execution to be delayed.
-            const float delta =
-                - (gyroRateDterm[axis] - previousGyroRateDterm[axis]) * pidFrequency;
-
-#if defined(USE_ACC)
-            if (cmpTimeUs(currentTimeUs, levelModeStartTimeUs) > CRASH_RECOVERY_DETECTION_DELAY_US) {
-                detectAndSetCrashRecovery(pidProfile->crash_recovery, axis, currentTimeUs, delta, errorRate);
-            }
-#endif
-
-            float dMinFactor = 1.0f;
-#if defined(USE_D_MIN)
-            if (dMinPercent[axis] > 0) {
-                float dMinGyroFactor = biquadFilterApply(&dMinRange[axis], delta);
-                dMinGyroFactor = fabsf(dMinGyroFactor) * dMinGyroGain;
-                const float dMinSetpointFactor = (fabsf(pidSetpointDelta)) * dMinSetpointGain;
-                dMinFactor = MAX(dMinGyroFactor, dMinSetpointFactor);
-                dMinFactor = dMinPercent[axis] + (1.0f - dMinPercent[axis]) * dMinFactor;
-                dMinFactor = pt1FilterApply(&dMinLowpass[axis], dMinFactor);
-                dMinFactor = MIN(dMinFactor, 1.0f);
-                if (axis == FD_ROLL) {
-                    DEBUG_SET(DEBUG_D_MIN, 0, lrintf(dMinGyroFactor * 100));
-                    DEBUG_SET(DEBUG_D_MIN, 1, lrintf(dMinSetpointFactor * 100));
-                    DEBUG_SET(DEBUG_D_MIN, 2, lrintf(pidCoefficient[axis].Kd * dMinFactor * 10 / DTERM_SCALE));
-                } else if (axis == FD_PITCH) {
-                    DEBUG_SET(DEBUG_D_MIN, 3, lrintf(pidCoefficient[axis].Kd * dMinFactor * 10 / DTERM_SCALE));
-                }
-            }
-#endif
-            pidData[axis].D = pidCoefficient[axis].Kd * delta * tpaFactor * dMinFactor;
-        } else {
-            pidData[axis].D = 0;
-        }
-        previousGyroRateDterm[axis] = gyroRateDterm[axis];
-
-        // -----calculate feedforward component
-#ifdef USE_ABSOLUTE_CONTROL
-        // include abs control correction in FF
-        pidSetpointDelta += setpointCorrection - oldSetpointCorrection[axis];
-        oldSetpointCorrection[axis] = setpointCorrection;
-#endif
-
-        // Only enable feedforward for rate mode and if launch control is inactive
-        const float feedforwardGain = (flightModeFlags || launchControlActive) ? 0.0f : pidCoefficient[axis].Kf;
-        if (feedforwardGain > 0) {
-            // no transition if feedForwardTransition == 0
-            float transition = feedForwardTransition > 0 ? MIN(1.f, getRcDeflectionAbs(axis) * feedForwardTransition) : 1;
-            float feedForward = feedforwardGain * transition * pidSetpointDelta * pidFrequency;
-
-#ifdef USE_INTERPOLATED_SP
-            pidData[axis].F = shouldApplyFfLimits(axis) ?
-                applyFfLimit(axis, feedForward, pidCoefficient[axis].Kp, currentPidSetpoint) : feedForward;
-#else
-            pidData[axis].F = feedForward;
+    if (!itermRelax) {
+        return;
+    }
 #endif
-        } else {
-            pidData[axis].F = 0;
-        }
-
-#ifdef USE_YAW_SPIN_RECOVERY
-        if (yawSpinActive) {
-            pidData[axis].I = 0;  // in yaw spin always disable I
-            if (axis <= FD_PITCH)  {
-                // zero PIDs on pitch and roll leaving yaw P to correct spin 
-                pidData[axis].P = 0;
-                pidData[axis].D = 0;
-                pidData[axis].F = 0;
-            }
-        }
-#endif // USE_YAW_SPIN_RECOVERY
-
-#ifdef USE_LAUNCH_CONTROL
-        // Disable P/I appropriately based on the launch control mode
-        if (launchControlActive) {
-            // if not using FULL mode then disable I accumulation on yaw as
-            // yaw has a tendency to windup. Otherwise limit yaw iterm accumulation.
-            const int launchControlYawItermLimit = (launchControlMode == LAUNCH_CONTROL_MODE_FULL) ? LAUNCH_CONTROL_YAW_ITERM_LIMIT : 0;
-            pidData[FD_YAW].I = constrainf(pidData[FD_YAW].I, -launchControlYawItermLimit, launchControlYawItermLimit);
-
-            // for pitch-only mode we disable everything except pitch P/I
-            if (launchControlMode == LAUNCH_CONTROL_MODE_PITCHONLY) {
-                pidData[FD_ROLL].P = 0;
-                pidData[FD_ROLL].I = 0;
-                pidData[FD_YAW].P = 0;
-                // don't let I go negative (pitch backwards) as front motors are limited in the mixer
-                pidData[FD_PITCH].I = MAX(0.0f, pidData[FD_PITCH].I);
-            }
-        }
+#if defined(USE_ABSOLUTE_CONTROL)
+    if (acGain > 0) {
+        return;
+    }
 #endif
-        // calculating the PID sum
-        const float pidSum = pidData[axis].P + pidData[axis].I + pidData[axis].D + pidData[axis].F;
 #ifdef USE_INTEGRATED_YAW_CONTROL
-        if (axis == FD_YAW && useIntegratedYaw) {
-            pidData[axis].Sum += pidSum * dT * 100.0f;
-            pidData[axis].Sum -= pidData[axis].Sum * integratedYawRelax / 100000.0f * dT / 0.000125f;
-        } else
-#endif
-        {
-            pidData[axis].Sum = pidSum;
-        }
+    if (useIntegratedYaw) {
+        return;
     }
+#endif
 
-    // Disable PID control if at zero throttle or if gyro overflow detected
-    // This may look very innefficient, but it is done on purpose to always show real CPU usage as in flight
-    if (!pidStabilisationEnabled || gyroOverflowDetected()) {
-        for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
-            pidData[axis].P = 0;
-            pidData[axis].I = 0;
-            pidData[axis].D = 0;
-            pidData[axis].F = 0;
+    pidControllerFn = pidControllerItermRelax;
+}
 
-            pidData[axis].Sum = 0;
-        }
-    } else if (zeroThrottleItermReset) {
-        pidResetIterm();
-    }
+void FAST_CODE pidController(const pidProfile_t *pidProfile, timeUs_t currentTimeUs)
+{
+    pidControllerFn(pidProfile, currentTimeUs);
 }
 
 bool crashRecoveryModeActive(void)
@@ -1587,19 +1508,15 @@ bool pidAntiGravityEnabled(void)
 }
 
 #ifdef USE_DYN_LPF
-void dynLpfDTermUpdate(float throttle)
+void dynLpfDTermUpdate(int throttleStep)
 {
     if (dynLpfFilter != DYN_LPF_NONE) {
-        const unsigned int cutoffFreq = fmax(dynThrottle(throttle) * dynLpfMax, dynLpfMin);
+        throttleStep = constrain(throttleStep, 0, DYN_LPF_THROTTLE_STEPS);
 
-         if (dynLpfFilter == DYN_LPF_PT1) {
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                pt1FilterUpdateCutoff(&dtermLowpass[axis].pt1Filter, pt1FilterGain(cutoffFreq, dT));
-            }
+        if (dynLpfFilter == DYN_LPF_PT1) {
+            pt1Filter3UpdateCutoff(&dtermLowpass.pt1Filter, dynLpfCoeffs[throttleStep].pt1Gain);
         } else if (dynLpfFilter == DYN_LPF_BIQUAD) {
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                biquadFilterUpdateLPF(&dtermLowpass[axis].biquadFilter, cutoffFreq, targetPidLooptime);
-            }
+            biquadFilter3SetLowpassCoeffs(&dtermLowpass.biquadFilter, &dynLpfCoeffs[throttleStep].biquad);
         }
     }
 }
@@ -0,0 +1,362 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Template for the PID controller, included once per variant by pid.c.
+ *
+ * PID_CONTROLLER_FUNCTION_NAME name of the controller function
+ * PID_ITERM_RELAX              whether the controller applies iterm relax
+ * PID_ABSOLUTE_CONTROL         whether the controller adds the absolute control correction to the feedforward
+ * PID_INTEGRATED_YAW           whether the yaw PID sum is integrated
+ *
+ * Features whose condition is a compile time constant cost nothing when disabled, the rarely active
+ * modes are gathered in loopModes once per loop and skipped with one test per axis when none is active.
+ */
+
+#include "platform.h"
+
+// Betaflight pid controller, which will be maintained in the future with additional features specialised for current (mini) multirotor usage.
+// Based on 2DOF reference design (matlab)
+STATIC_UNIT_TESTED FAST_CODE void PID_CONTROLLER_FUNCTION_NAME(const pidProfile_t *pidProfile, timeUs_t currentTimeUs)
+{
+    const float tpaFactor = getThrottlePIDAttenuation();
+
+#if defined(USE_ACC)
+    const rollAndPitchTrims_t *angleTrim = &accelerometerConfig()->accelerometerTrims;
+#else
+    UNUSED(pidProfile);
+    UNUSED(currentTimeUs);
+#endif
+
+#ifdef USE_TPA_MODE
+    const float tpaFactorKp = (currentControlRateProfile->tpaMode == TPA_MODE_PD) ? tpaFactor : 1.0f;
+#else
+    const float tpaFactorKp = tpaFactor;
+#endif
+
+#ifdef USE_YAW_SPIN_RECOVERY
+    const bool yawSpinActive = gyroYawSpinDetected();
+#endif
+
+    const bool launchControlActive = isLaunchControlActive();
+
+#if defined(USE_ACC)
+    const bool gpsRescueIsActive = FLIGHT_MODE(GPS_RESCUE_MODE);
+    const bool levelModeActive = FLIGHT_MODE(ANGLE_MODE) || FLIGHT_MODE(HORIZON_MODE) || gpsRescueIsActive;
+
+    // Keep track of when we entered a self-level mode so that we can
+    // add a guard time before crash recovery can activate.
+    // Also reset the guard time whenever GPS Rescue is activated.
+    if (levelModeActive) {
+        if ((levelModeStartTimeUs == 0) || (gpsRescueIsActive && !gpsRescuePreviousState)) {
+            levelModeStartTimeUs = currentTimeUs;
+        }
+    } else {
+        levelModeStartTimeUs = 0;
+    }
+    gpsRescuePreviousState = gpsRescueIsActive;
+#endif
+
+    uint8_t loopModes = 0;
+#if defined(USE_ACC)
+    if (levelModeActive) {
+        loopModes |= PID_LOOP_MODE_LEVEL;
+    }
+    if ((pidProfile->crash_recovery || gpsRescueIsActive) && !gyroOverflowDetected()
+        && cmpTimeUs(currentTimeUs, levelModeStartTimeUs) > CRASH_RECOVERY_DETECTION_DELAY_US) {
+        loopModes |= PID_LOOP_MODE_CRASH_DETECTION;
+    }
+#endif
+#ifdef USE_ACRO_TRAINER
+    if (acroTrainerActive && !launchControlActive) {
+        loopModes |= PID_LOOP_MODE_ACRO_TRAINER;
+    }
+#endif
+    if (launchControlActive) {
+        loopModes |= PID_LOOP_MODE_LAUNCH_CONTROL;
+    }
+#ifdef USE_YAW_SPIN_RECOVERY
+    if (yawSpinActive) {
+        loopModes |= PID_LOOP_MODE_YAW_SPIN;
+    }
+#endif
+
+    // Dynamic i component,
+    if ((antiGravityMode == ANTI_GRAVITY_SMOOTH) && antiGravityEnabled) {
+        itermAccelerator = 1 + fabsf(antiGravityThrottleHpf) * 0.01f * (itermAcceleratorGain - 1000);
+        DEBUG_SET(DEBUG_ANTI_GRAVITY, 1, lrintf(antiGravityThrottleHpf * 1000));
+    }
+    DEBUG_SET(DEBUG_ANTI_GRAVITY, 0, lrintf(itermAccelerator * 1000));
+
+    // gradually scale back integration when above windup point
+    float dynCi = dT * itermAccelerator;
+    if (itermWindupPointInv > 1.0f) {
+        dynCi *= constrainf((1.0f - getMotorMixRange()) * itermWindupPointInv, 0.0f, 1.0f);
+    }
+
+    // Precalculate gyro deta for D-term here, this allows loop unrolling
+    float gyroRateDterm[XYZ_AXIS_COUNT];
+    for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
+        gyroRateDterm[axis] = gyro.gyroADCf[axis];
+    }
+    pidDtermFilterApply(gyroRateDterm);
+
+    rotateItermAndAxisError();
+#ifdef USE_RPM_FILTER
+    rpmFilterUpdate();
+#endif
+
+#ifdef USE_INTERPOLATED_SP
+    bool newRcFrame = false;
+    if (lastFrameNumber != getRcFrameNumber()) {
+        lastFrameNumber = getRcFrameNumber();
+        newRcFrame = true;
+    }
+#endif
+
+    // ----------PID controller----------
+    for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
+
+        float currentPidSetpoint = getSetpointRate(axis);
+        if (maxVelocity[axis]) {
+            currentPidSetpoint = accelerationLimit(axis, currentPidSetpoint);
+        }
+        if (loopModes & PID_LOOP_MODES_SETPOINT) {
+            // Yaw control is GYRO based, direct sticks control is applied to rate PID
+#if defined(USE_ACC)
+            if ((loopModes & PID_LOOP_MODE_LEVEL) && (axis != FD_YAW)) {
+                currentPidSetpoint = pidLevel(axis, pidProfile, angleTrim, currentPidSetpoint);
+            }
+#endif
+
+#ifdef USE_ACRO_TRAINER
+            if ((loopModes & PID_LOOP_MODE_ACRO_TRAINER) && (axis != FD_YAW) && !inCrashRecoveryMode) {
+                currentPidSetpoint = applyAcroTrainer(axis, angleTrim, currentPidSetpoint);
+            }
+#endif // USE_ACRO_TRAINER
+
+#ifdef USE_LAUNCH_CONTROL
+            if (loopModes & PID_LOOP_MODE_LAUNCH_CONTROL) {
+#if defined(USE_ACC)
+                currentPidSetpoint = applyLaunchControl(axis, angleTrim);
+#else
+                currentPidSetpoint = applyLaunchControl(axis, NULL);
+#endif
+            }
+#endif
+
+            // Handle yaw spin recovery - zero the setpoint on yaw to aid in recovery
+            // It's not necessary to zero the set points for R/P because the PIDs will be zeroed below
+#ifdef USE_YAW_SPIN_RECOVERY
+            if ((loopModes & PID_LOOP_MODE_YAW_SPIN) && (axis == FD_YAW)) {
+                currentPidSetpoint = 0.0f;
+            }
+#endif // USE_YAW_SPIN_RECOVERY
+        }
+
+        // -----calculate error rate
+        const float gyroRate = gyro.gyroADCf[axis]; // Process variable from gyro output in deg/sec
+        float errorRate = currentPidSetpoint - gyroRate; // r - y
+#if defined(USE_ACC)
+        if (inCrashRecoveryMode) {
+            handleCrashRecovery(
+                pidProfile->crash_recovery, angleTrim, axis, currentTimeUs, gyroRate,
+                &currentPidSetpoint, &errorRate);
+        }
+#endif
+
+        const float previousIterm = pidData[axis].I;
+        float itermErrorRate = errorRate;
+#ifdef USE_ABSOLUTE_CONTROL
+        float uncorrectedSetpoint = currentPidSetpoint;
+#endif
+
+#if defined(USE_ITERM_RELAX)
+        if (PID_ITERM_RELAX && !launchControlActive && !inCrashRecoveryMode) {
+            applyItermRelax(axis, previousIterm, gyroRate, &itermErrorRate, &currentPidSetpoint);
+            errorRate = currentPidSetpoint - gyroRate;
+        }
+#endif
+
+        // --------low-level gyro-based PID based on 2DOF PID controller. ----------
+        // 2-DOF PID controller with optional filter on derivative term.
+        // b = 1 and only c (feedforward weight) can be tuned (amount derivative on measurement or error).
+
+        // -----calculate P component
+        pidData[axis].P = pidCoefficient[axis].Kp * errorRate * tpaFactorKp;
+        if (axis == FD_YAW) {
+            pidData[axis].P = ptermYawLowpassApplyFn((filter_t *) &ptermYawLowpass, pidData[axis].P);
+        }
+
+        // -----calculate I component
+#ifdef USE_LAUNCH_CONTROL
+        // if launch control is active override the iterm gains
+        const float Ki = launchControlActive ? launchControlKi : pidCoefficient[axis].Ki;
+#else
+        const float Ki = pidCoefficient[axis].Ki;
+#endif
+        pidData[axis].I = constrainf(previousIterm + Ki * itermErrorRate * dynCi, -itermLimit, itermLimit);
+
+        // -----calculate pidSetpointDelta
+        float pidSetpointDelta = 0;
+#ifdef USE_INTERPOLATED_SP
+        if (ffFromInterpolatedSetpoint) {
+            pidSetpointDelta = interpolatedSpApply(axis, newRcFrame, ffFromInterpolatedSetpoint);
+        } else {
+            pidSetpointDelta = currentPidSetpoint - previousPidSetpoint[axis];
+        }
+#else
+        pidSetpointDelta = currentPidSetpoint - previousPidSetpoint[axis];
+#endif
+        previousPidSetpoint[axis] = currentPidSetpoint;
+
+
+#ifdef USE_RC_SMOOTHING_FILTER
+        pidSetpointDelta = applyRcSmoothingDerivativeFilter(axis, pidSetpointDelta);
+#endif // USE_RC_SMOOTHING_FILTER
+
+        // -----calculate D component
+        // disable D if launch control is active
+        if ((pidCoefficient[axis].Kd > 0) && !launchControlActive){
+
+            // Divide rate change by dT to get differential (ie dr/dt).
+            // dT is fixed and calculated from the target PID loop time
+            // This is done to avoid DTerm spikes that occur with dynamically
+            // calculated deltaT whenever another task causes the PID
+            // loop execution to be delayed.
+            const float delta =
+                - (gyroRateDterm[axis] - previousGyroRateDterm[axis]) * pidFrequency;
+
+#if defined(USE_ACC)
+            if (loopModes & PID_LOOP_MODE_CRASH_DETECTION) {
+                detectAndSetCrashRecovery(pidProfile->crash_recovery, axis, currentTimeUs, delta, errorRate);
+            }
+#endif
+
+            float dMinFactor = 1.0f;
+#if defined(USE_D_MIN)
+            if (dMinPercent[axis] > 0) {
+                float dMinGyroFactor = biquadFilterApply(&dMinRange[axis], delta);
+                dMinGyroFactor = fabsf(dMinGyroFactor) * dMinGyroGain;
+                const float dMinSetpointFactor = (fabsf(pidSetpointDelta)) * dMinSetpointGain;
+                dMinFactor = MAX(dMinGyroFactor, dMinSetpointFactor);
+                dMinFactor = dMinPercent[axis] + (1.0f - dMinPercent[axis]) * dMinFactor;
+                dMinFactor = pt1FilterApply(&dMinLowpass[axis], dMinFactor);
+                dMinFactor = MIN(dMinFactor, 1.0f);
+                if (axis == FD_ROLL) {
+                    DEBUG_SET(DEBUG_D_MIN, 0, lrintf(dMinGyroFactor * 100));
+                    DEBUG_SET(DEBUG_D_MIN, 1, lrintf(dMinSetpointFactor * 100));
+                    DEBUG_SET(DEBUG_D_MIN, 2, lrintf(pidCoefficient[axis].Kd * dMinFactor * 10 / DTERM_SCALE));
+                } else if (axis == FD_PITCH) {
+                    DEBUG_SET(DEBUG_D_MIN, 3, lrintf(pidCoefficient[axis].Kd * dMinFactor * 10 / DTERM_SCALE));
+                }
+            }
+#endif
+            pidData[axis].D = pidCoefficient[axis].Kd * delta * tpaFactor * dMinFactor;
+        } else {
+            pidData[axis].D = 0;
+        }
+        previousGyroRateDterm[axis] = gyroRateDterm[axis];
+
+        // -----calculate feedforward component
+#ifdef USE_ABSOLUTE_CONTROL
+        if (PID_ABSOLUTE_CONTROL) {
+            // include abs control correction in FF
+            const float setpointCorrection = currentPidSetpoint - uncorrectedSetpoint;
+            pidSetpointDelta += setpointCorrection - oldSetpointCorrection[axis];
+            oldSetpointCorrection[axis] = setpointCorrection;
+        }
+#endif
+
+        // Only enable feedforward for rate mode and if launch control is inactive
+        const float feedforwardGain = (flightModeFlags || launchControlActive) ? 0.0f : pidCoefficient[axis].Kf;
+        if (feedforwardGain > 0) {
+            // no transition if feedForwardTransition == 0
+            float transition = feedForwardTransition > 0 ? MIN(1.f, getRcDeflectionAbs(axis) * feedForwardTransition) : 1;
+            float feedForward = feedforwardGain * transition * pidSetpointDelta * pidFrequency;
+
+#ifdef USE_INTERPOLATED_SP
+            pidData[axis].F = shouldApplyFfLimits(axis) ?
+                applyFfLimit(axis, feedForward, pidCoefficient[axis].Kp, currentPidSetpoint) : feedForward;
+#else
+            pidData[axis].F = feedForward;
+#endif
+        } else {
+            pidData[axis].F = 0;
+        }
+
+#ifdef USE_YAW_SPIN_RECOVERY
+        if (yawSpinActive) {
+            pidData[axis].I = 0;  // in yaw spin always disable I
+            if (axis <= FD_PITCH)  {
+                // zero PIDs on pitch and roll leaving yaw P to correct spin 
+                pidData[axis].P = 0;
+                pidData[axis].D = 0;
+                pidData[axis].F = 0;
+            }
+        }
+#endif // USE_YAW_SPIN_RECOVERY
+
+#ifdef USE_LAUNCH_CONTROL
+        // Disable P/I appropriately based on the launch control mode
+        if (launchControlActive) {
+            // if not using FULL mode then disable I accumulation on yaw as
+            // yaw has a tendency to windup. Otherwise limit yaw iterm accumulation.
+            const int launchControlYawItermLimit = (launchControlMode == LAUNCH_CONTROL_MODE_FULL) ? LAUNCH_CONTROL_YAW_ITERM_LIMIT : 0;
+            pidData[FD_YAW].I = constrainf(pidData[FD_YAW].I, -launchControlYawItermLimit, launchControlYawItermLimit);
+
+            // for pitch-only mode we disable everything except pitch P/I
+            if (launchControlMode == LAUNCH_CONTROL_MODE_PITCHONLY) {
+                pidData[FD_ROLL].P = 0;
+                pidData[FD_ROLL].I = 0;
+                pidData[FD_YAW].P = 0;
+                // don't let I go negative (pitch backwards) as front motors are limited in the mixer
+                pidData[FD_PITCH].I = MAX(0.0f, pidData[FD_PITCH].I);
+            }
+        }
+#endif
+        // calculating the PID sum
+        const float pidSum = pidData[axis].P + pidData[axis].I + pidData[axis].D + pidData[axis].F;
+#ifdef USE_INTEGRATED_YAW_CONTROL
+        if (axis == FD_YAW && PID_INTEGRATED_YAW) {
+            pidData[axis].Sum += pidSum * dT * 100.0f;
+            pidData[axis].Sum -= pidData[axis].Sum * integratedYawRelax / 100000.0f * dT / 0.000125f;
+        } else
+#endif
+        {
+            pidData[axis].Sum = pidSum;
+        }
+    }
+
+    // Disable PID control if at zero throttle or if gyro overflow detected
+    // This may look very innefficient, but it is done on purpose to always show real CPU usage as in flight
+    if (!pidStabilisationEnabled || gyroOverflowDetected()) {
+        for (int axis = FD_ROLL; axis <= FD_YAW; ++axis) {
+            pidData[axis].P = 0;
+            pidData[axis].I = 0;
+            pidData[axis].D = 0;
+            pidData[axis].F = 0;
+
+            pidData[axis].Sum = 0;
+        }
+    } else if (zeroThrottleItermReset) {
+        pidResetIterm();
+    }
+}
@@ -29,9 +29,11 @@
 #include "build/debug.h"
 
 #include "common/maths.h"
+#include "common/utils.h"
 
 #include "fc/runtime_config.h"
 
+#include "flight/altitude_kf.h"
 #include "flight/position.h"
 #include "flight/imu.h"
 #include "flight/pid.h"
@@ -40,6 +42,7 @@
 
 #include "sensors/sensors.h"
 #include "sensors/barometer.h"
+#include "sensors/sample_bus.h"
 
 #include "pg/pg.h"
 #include "pg/pg_ids.h"
@@ -50,127 +53,164 @@ typedef enum {
     GPS_ONLY
 } altSource_e;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(positionConfig_t, positionConfig, PG_POSITION, 1);
+PG_REGISTER_WITH_RESET_TEMPLATE(positionConfig_t, positionConfig, PG_POSITION, 2);
 
 PG_RESET_TEMPLATE(positionConfig_t, positionConfig,
     .altSource = DEFAULT,
+    .altKfAccNoise = 50,
+    .altKfBaroNoise = 50,
+    .altKfGpsNoise = 300,
 );
 
 static int32_t estimatedAltitudeCm = 0;                // in cm
 
-#define BARO_UPDATE_FREQUENCY_40HZ (1000 * 25)
+#define ALTITUDE_UPDATE_INTERVAL_US (1000 * 25)     // without a baro the estimate is updated at 40Hz
+#define BARO_SAMPLE_TIMEOUT_US (1000 * 100)         // keeps the GPS altitude going should the baro stop sampling
 
 #ifdef USE_VARIO
 static int16_t estimatedVario = 0;                   // in cm/s
+#endif
 
-int16_t calculateEstimatedVario(int32_t baroAlt, const uint32_t dTime) {
-    static float vel = 0;
-    static int32_t lastBaroAlt = 0;
+#if defined(USE_BARO) || defined(USE_GPS)
+#define ALTITUDE_KF_ACC_BIAS_NOISE 2.0f              // cm/s/s per sqrt(s), drift of the accelerometer Z offset
+#define ALTITUDE_KF_MAX_DT 0.1f                      // s, longer gaps, e.g. at startup, are predicted as this
 
-    int32_t baroVel = 0;
+static altitudeKf_t altitudeKf;
+static bool altitudeKfPredicted = false;
+static bool altitudeOffsetSet = false;
 
-    baroVel = (baroAlt - lastBaroAlt) * 1000000.0f / dTime;
-    lastBaroAlt = baroAlt;
+void positionInit(void)
+{
+    altitudeKfInit(&altitudeKf, positionConfig()->altKfAccNoise, ALTITUDE_KF_ACC_BIAS_NOISE);
+}
 
-    baroVel = constrain(baroVel, -1500.0f, 1500.0f);
-    baroVel = applyDeadband(baroVel, 10.0f);
+// Called by the attitude task with the earth frame vertical acceleration in cm/s/s, gravity removed
+void predictEstimatedAltitude(float verticalAcceleration, float dt)
+{
+    altitudeKfPredict(&altitudeKf, verticalAcceleration, MIN(dt, ALTITUDE_KF_MAX_DT));
+    altitudeKfPredicted = true;
+}
 
-    vel = vel * CONVERT_PARAMETER_TO_FLOAT(barometerConfig()->baro_cf_vel) + baroVel * (1.0f - CONVERT_PARAMETER_TO_FLOAT(barometerConfig()->baro_cf_vel));
-    int32_t vel_tmp = lrintf(vel);
-    vel_tmp = applyDeadband(vel_tmp, 5.0f);
+// With a baro the estimate runs once per pressure sample, i.e. at the output rate of the sensor
+bool calculateEstimatedAltitudeCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
 
-    return constrain(vel_tmp, SHRT_MIN, SHRT_MAX);
-}
+#ifdef USE_BARO
+    if (sensors(SENSOR_BARO)) {
+        return isBaroSampleReady() || currentDeltaTimeUs >= BARO_SAMPLE_TIMEOUT_US;
+    }
 #endif
 
-#if defined(USE_BARO) || defined(USE_GPS)
-static bool altitudeOffsetSet = false;
+    return currentDeltaTimeUs >= ALTITUDE_UPDATE_INTERVAL_US;
+}
 
 void calculateEstimatedAltitude(timeUs_t currentTimeUs)
 {
     static timeUs_t previousTimeUs = 0;
     static int32_t baroAltOffset = 0;
     static int32_t gpsAltOffset = 0;
+    static bool gpsAltAligned = false;
 
-    const uint32_t dTime = currentTimeUs - previousTimeUs;
-    if (dTime < BARO_UPDATE_FREQUENCY_40HZ) {
-        return;
+    // without an accelerometer, or before the attitude task has run, the velocity is held
+    if (!altitudeKfPredicted) {
+        altitudeKfPredict(&altitudeKf, altitudeKf.x[ALTITUDE_KF_ACC_BIAS], MIN((currentTimeUs - previousTimeUs) * 1e-6f, ALTITUDE_KF_MAX_DT));
     }
+    altitudeKfPredicted = false;
     previousTimeUs = currentTimeUs;
 
     int32_t baroAlt = 0;
     int32_t gpsAlt = 0;
-
-#if defined(USE_GPS) && defined(USE_VARIO)
-    int16_t gpsVertSpeed = 0;
-#endif
-    float gpsTrust = 0.3; //conservative default
     bool haveBaroAlt = false;
+    bool newBaroAlt = false;
     bool haveGpsAlt = false;
+    bool newGpsAlt = false;
+    float gpsVariance = 0.0f;
+
 #ifdef USE_BARO
     if (sensors(SENSOR_BARO)) {
-        if (!isBaroCalibrationComplete()) {
-            performBaroCalibrationCycle();
-        } else {
-            baroAlt = baroCalculateAltitude();
+        if (isBaroSampleReady()) {
+            clearBaroSampleReady();
+            if (!isBaroCalibrationComplete()) {
+                performBaroCalibrationCycle();
+            } else {
+                baroCalculateAltitude();
+                newBaroAlt = true;
+            }
+        }
+        if (isBaroCalibrationComplete()) {
+            baroAlt = baro.BaroAlt;
             haveBaroAlt = true;
         }
     }
 #endif
 
 #ifdef USE_GPS
+    static uint8_t previousGpsUpdate = 0;
     if (sensors(SENSOR_GPS) && STATE(GPS_FIX)) {
         gpsAlt = gpsSol.llh.altCm;
-#ifdef USE_VARIO
-        gpsVertSpeed = GPS_verticalSpeedInCmS;
-#endif
         haveGpsAlt = true;
-
-        if (gpsSol.hdop != 0) {
-            gpsTrust = 100.0 / gpsSol.hdop;
-        }
-        // always use at least 10% of other sources besides gps if available
-        gpsTrust = MIN(gpsTrust, 0.9f);
+        // one measurement per GPS message, the horizontal dilution of precision (x100) scales the noise
+        newGpsAlt = GPS_update != previousGpsUpdate;
+        const float gpsNoise = positionConfig()->altKfGpsNoise * MAX(gpsSol.hdop, 100) / 100.0f;
+        gpsVariance = sq(gpsNoise);
     }
+    previousGpsUpdate = GPS_update;
 #endif
 
+    if (haveGpsAlt && haveBaroAlt && !gpsAltAligned && !altitudeOffsetSet) {
+        // until the first arming both sources are fused relative to the baro ground level
+        gpsAltOffset = gpsAlt - baroAlt;
+        gpsAltAligned = true;
+    }
+
     if (ARMING_FLAG(ARMED) && !altitudeOffsetSet) {
         baroAltOffset = baroAlt;
         gpsAltOffset = gpsAlt;
         altitudeOffsetSet = true;
+        altitudeKfSetAltitude(&altitudeKf, 0.0f);
     } else if (!ARMING_FLAG(ARMED) && altitudeOffsetSet) {
         altitudeOffsetSet = false;
     }
     baroAlt -= baroAltOffset;
     gpsAlt -= gpsAltOffset;
-    
-    
-    if (haveGpsAlt && haveBaroAlt && positionConfig()->altSource == DEFAULT) {
-        estimatedAltitudeCm = gpsAlt * gpsTrust + baroAlt * (1 - gpsTrust);
+
+    const bool useBaro = haveBaroAlt && (positionConfig()->altSource == BARO_ONLY || positionConfig()->altSource == DEFAULT);
+    const bool useGps = haveGpsAlt && (positionConfig()->altSource == GPS_ONLY || positionConfig()->altSource == DEFAULT);
+
+    if (useBaro && newBaroAlt) {
+        altitudeKfUpdate(&altitudeKf, baroAlt, sq((float)positionConfig()->altKfBaroNoise));
+    }
+    if (useGps && newGpsAlt) {
+        altitudeKfUpdate(&altitudeKf, gpsAlt, gpsVariance);
+    }
+
+    if (useBaro || useGps) {
+        estimatedAltitudeCm = lrintf(altitudeKf.x[ALTITUDE_KF_ALTITUDE]);
 #ifdef USE_VARIO
-        // baro is a better source for vario, so ignore gpsVertSpeed
-        estimatedVario = calculateEstimatedVario(baroAlt, dTime);
+        estimatedVario = constrainf(altitudeKf.x[ALTITUDE_KF_VELOCITY], SHRT_MIN, SHRT_MAX);
 #endif
-    } else if (haveGpsAlt && (positionConfig()->altSource == GPS_ONLY || positionConfig()->altSource == DEFAULT )) {
-        estimatedAltitudeCm = gpsAlt;
-#if defined(USE_VARIO) && defined(USE_GPS)
-        estimatedVario = gpsVertSpeed;
-#endif
-    } else if (haveBaroAlt && (positionConfig()->altSource == BARO_ONLY || positionConfig()->altSource == DEFAULT)) {
-        estimatedAltitudeCm = baroAlt;
+
+        const altitudeSample_t sample = {
+            .estimatedAltitudeCm = estimatedAltitudeCm,
 #ifdef USE_VARIO
-        estimatedVario = calculateEstimatedVario(baroAlt, dTime);
+            .varioCms = estimatedVario,
 #endif
+        };
+        samplePublish(SAMPLE_ALTITUDE, &sample, currentTimeUs);
     }
-    
-	
-    
-    DEBUG_SET(DEBUG_ALTITUDE, 0, (int32_t)(100 * gpsTrust));
+
+    DEBUG_SET(DEBUG_ALTITUDE, 0, lrintf(altitudeKf.x[ALTITUDE_KF_ACC_BIAS]));
     DEBUG_SET(DEBUG_ALTITUDE, 1, baroAlt);
     DEBUG_SET(DEBUG_ALTITUDE, 2, gpsAlt);
 #ifdef USE_VARIO
     DEBUG_SET(DEBUG_ALTITUDE, 3, estimatedVario);
 #endif
+
+    DEBUG_SET(DEBUG_ALTITUDE_KF, 0, lrintf(altitudeKf.x[ALTITUDE_KF_ALTITUDE]));
+    DEBUG_SET(DEBUG_ALTITUDE_KF, 1, lrintf(altitudeKf.x[ALTITUDE_KF_VELOCITY]));
+    DEBUG_SET(DEBUG_ALTITUDE_KF, 2, lrintf(sqrtf(altitudeKf.P[ALTITUDE_KF_ALTITUDE][ALTITUDE_KF_ALTITUDE])));
+    DEBUG_SET(DEBUG_ALTITUDE_KF, 3, lrintf(sqrtf(altitudeKf.P[ALTITUDE_KF_VELOCITY][ALTITUDE_KF_VELOCITY])));
 }
 
 bool isAltitudeOffset(void)
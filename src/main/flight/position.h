@@ -24,11 +24,17 @@
 
 typedef struct positionConfig_s {
     uint8_t altSource;
+    uint16_t altKfAccNoise;                 // cm/s/s, of the earth frame vertical acceleration
+    uint16_t altKfBaroNoise;                // cm, of the baro altitude
+    uint16_t altKfGpsNoise;                 // cm, of the GPS altitude at a HDOP of 1
 } positionConfig_t;
 
 PG_DECLARE(positionConfig_t, positionConfig);
 
 bool isAltitudeOffset(void);
+void positionInit(void);
+void predictEstimatedAltitude(float verticalAcceleration, float dt);
+bool calculateEstimatedAltitudeCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 void calculateEstimatedAltitude(timeUs_t currentTimeUs);
 int32_t getEstimatedAltitudeCm(void);
 int16_t getEstimatedVario(void);
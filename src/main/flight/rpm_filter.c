@@ -48,28 +48,38 @@
 #define SECONDS_PER_MINUTE      60.0f
 #define ERPM_PER_LSB            100.0f
 #define MIN_UPDATE_T            0.001f
+#define RPM_FILTER_MAXNOTCHES   (MAX_SUPPORTED_MOTORS * RPM_FILTER_MAXHARMONICS)
+// a motor's notches are only recalculated once its frequency moved by this fraction of the narrowest notch bandwidth
+#define RPM_FILTER_UPDATE_BANDWIDTH_FRACTION 0.1f
 
 
 static pt1Filter_t rpmFilters[MAX_SUPPORTED_MOTORS];
 
 typedef struct rpmNotchFilter_s
 {
-    uint8_t harmonics;
+    uint8_t harmonics;                                  // number of enabled harmonics
+    uint8_t harmonicNumber[RPM_FILTER_MAXHARMONICS];    // 1 for the fundamental, 2 for the second harmonic...
     float   minHz;
     float   maxHz;
     float   q;
     float   loopTime;
+    uint8_t notchCount;
 
-    biquadFilter_t notch[XYZ_AXIS_COUNT][MAX_SUPPORTED_MOTORS][RPM_FILTER_MAXHARMONICS];
+    // all the notches of an axis are applied in one pass, the axes share the coefficients
+    // notch motor * harmonics + harmonic is the given harmonic of the given motor
+    biquadNotchCoeffs_t coeffs[RPM_FILTER_MAXNOTCHES];
+    biquadNotchState_t state[XYZ_AXIS_COUNT][RPM_FILTER_MAXNOTCHES + 1];
 } rpmNotchFilter_t;
 
 FAST_RAM_ZERO_INIT static float   erpmToHz;
 FAST_RAM_ZERO_INIT static float   filteredMotorErpm[MAX_SUPPORTED_MOTORS];
-FAST_RAM_ZERO_INIT static float   minMotorFrequency;
+FAST_RAM_ZERO_INIT static bool    motorTracking;
+FAST_RAM_ZERO_INIT static float   motorFrequency[MAX_SUPPORTED_MOTORS];
 FAST_RAM_ZERO_INIT static uint8_t numberFilters;
 FAST_RAM_ZERO_INIT static uint8_t numberRpmNotchFilters;
 FAST_RAM_ZERO_INIT static uint8_t filterUpdatesPerIteration;
 FAST_RAM_ZERO_INIT static float   pidLooptime;
+FAST_RAM_ZERO_INIT static float   motorUpdateThreshold;
 FAST_RAM_ZERO_INIT static rpmNotchFilter_t filters[2];
 FAST_RAM_ZERO_INIT static rpmNotchFilter_t* gyroFilter;
 FAST_RAM_ZERO_INIT static rpmNotchFilter_t* dtermFilter;
@@ -77,39 +87,59 @@ FAST_RAM_ZERO_INIT static rpmNotchFilter_t* dtermFilter;
 FAST_RAM_ZERO_INIT static uint8_t currentMotor;
 FAST_RAM_ZERO_INIT static uint8_t currentHarmonic;
 FAST_RAM_ZERO_INIT static uint8_t currentFilterNumber;
+FAST_RAM_ZERO_INIT static bool    currentMotorPending;
 FAST_RAM static rpmNotchFilter_t* currentFilter = &filters[0];
 
 
 
-PG_REGISTER_WITH_RESET_FN(rpmFilterConfig_t, rpmFilterConfig, PG_RPM_FILTER_CONFIG, 3);
+PG_REGISTER_WITH_RESET_FN(rpmFilterConfig_t, rpmFilterConfig, PG_RPM_FILTER_CONFIG, 4);
 
 void pgResetFn_rpmFilterConfig(rpmFilterConfig_t *config)
 {
     config->gyro_rpm_notch_harmonics = 3;
     config->gyro_rpm_notch_min = 100;
     config->gyro_rpm_notch_q = 500;
+    config->gyro_rpm_notch_mask = RPM_FILTER_HARMONICS_MASK_ALL;
 
     config->dterm_rpm_notch_harmonics = 0;
     config->dterm_rpm_notch_min = 100;
     config->dterm_rpm_notch_q = 500;
+    config->dterm_rpm_notch_mask = RPM_FILTER_HARMONICS_MASK_ALL;
 
     config->rpm_lpf = 150;
 }
 
-static void rpmNotchFilterInit(rpmNotchFilter_t* filter, int harmonics, int minHz, int q, float looptime)
+// the number of harmonics that have a notch, the first harmonics are enabled by the mask
+static int rpmNotchHarmonicCount(int harmonics, uint8_t mask)
 {
-    filter->harmonics = harmonics;
+    int count = 0;
+    for (int i = 0; i < MIN(harmonics, RPM_FILTER_MAXHARMONICS); i++) {
+        if (mask & (1 << i)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void rpmNotchFilterInit(rpmNotchFilter_t* filter, int harmonics, uint8_t mask, int minHz, int q, float looptime)
+{
+    filter->harmonics = 0;
+    for (int i = 0; i < MIN(harmonics, RPM_FILTER_MAXHARMONICS); i++) {
+        if (mask & (1 << i)) {
+            filter->harmonicNumber[filter->harmonics++] = i + 1;
+        }
+    }
     filter->minHz = minHz;
     filter->q = q / 100.0f;
     filter->loopTime = looptime;
+    filter->notchCount = getMotorCount() * filter->harmonics;
 
+    // start at the frequency of a stopped motor, a motor that never changes speed is not updated
+    for (int i = 0; i < filter->notchCount; i++) {
+        biquadNotchCoeffsUpdate(&filter->coeffs[i], minHz, looptime, filter->q);
+    }
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        for (int motor = 0; motor < getMotorCount(); motor++) {
-            for (int i = 0; i < harmonics; i++) {
-                biquadFilterInit(
-                    &filter->notch[axis][motor][i], minHz * i, looptime, filter->q, FILTER_NOTCH);
-            }
-        }
+        biquadNotchStateInit(filter->state[axis], filter->notchCount);
     }
 }
 
@@ -117,26 +147,31 @@ void rpmFilterInit(const rpmFilterConfig_t *config)
 {
     currentFilter = &filters[0];
     currentMotor = currentHarmonic = currentFilterNumber = 0;
+    currentMotorPending = false;
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        motorFrequency[i] = 0.0f;
+    }
 
     numberRpmNotchFilters = 0;
-    if (!motorConfig()->dev.useDshotTelemetry) {
+    motorTracking = motorConfig()->dev.useDshotTelemetry;
+    if (!motorTracking) {
         gyroFilter = dtermFilter = NULL;
         return;
     }
 
     pidLooptime = gyro.targetLooptime * pidConfig()->pid_process_denom;
-    if (config->gyro_rpm_notch_harmonics) {
+    if (rpmNotchHarmonicCount(config->gyro_rpm_notch_harmonics, config->gyro_rpm_notch_mask)) {
         gyroFilter = &filters[numberRpmNotchFilters++];
-        rpmNotchFilterInit(gyroFilter, config->gyro_rpm_notch_harmonics,
-                           config->gyro_rpm_notch_min, config->gyro_rpm_notch_q, gyro.targetLooptime);
+        rpmNotchFilterInit(gyroFilter, config->gyro_rpm_notch_harmonics, config->gyro_rpm_notch_mask,
+                           config->gyro_rpm_notch_min, config->gyro_rpm_notch_q, gyro.filterLooptime);
         // don't go quite to nyquist to avoid oscillations
-        gyroFilter->maxHz = 0.48f / (gyro.targetLooptime * 1e-6f);
+        gyroFilter->maxHz = 0.48f / (gyro.filterLooptime * 1e-6f);
     } else {
         gyroFilter = NULL;
     }
-    if (config->dterm_rpm_notch_harmonics) {
+    if (rpmNotchHarmonicCount(config->dterm_rpm_notch_harmonics, config->dterm_rpm_notch_mask)) {
         dtermFilter = &filters[numberRpmNotchFilters++];
-        rpmNotchFilterInit(dtermFilter, config->dterm_rpm_notch_harmonics,
+        rpmNotchFilterInit(dtermFilter, config->dterm_rpm_notch_harmonics, config->dterm_rpm_notch_mask,
                            config->dterm_rpm_notch_min, config->dterm_rpm_notch_q, pidLooptime);
         // don't go quite to nyquist to avoid oscillations
         dtermFilter->maxHz = 0.48f / (pidLooptime * 1e-6f);
@@ -150,8 +185,18 @@ void rpmFilterInit(const rpmFilterConfig_t *config)
 
     erpmToHz = ERPM_PER_LSB / SECONDS_PER_MINUTE  / (motorConfig()->motorPoleCount / 2.0f);
 
+    // the -3dB bandwidth of a notch is its frequency / q
+    float maxQ = 0.0f;
+    for (int i = 0; i < numberRpmNotchFilters; i++) {
+        maxQ = MAX(maxQ, filters[i].q);
+    }
+    motorUpdateThreshold = maxQ > 0.0f ? RPM_FILTER_UPDATE_BANDWIDTH_FRACTION / maxQ : 0.0f;
+
     const float loopIterationsPerUpdate = MIN_UPDATE_T / (pidLooptime * 1e-6f);
-    numberFilters = getMotorCount() * (filters[0].harmonics + filters[1].harmonics);
+    numberFilters = 0;
+    for (int i = 0; i < numberRpmNotchFilters; i++) {
+        numberFilters += filters[i].notchCount;
+    }
     const float filtersPerLoopIteration = numberFilters / loopIterationsPerUpdate;
     filterUpdatesPerIteration = rintf(filtersPerLoopIteration + 0.49f);
 }
@@ -161,12 +206,7 @@ static float applyFilter(rpmNotchFilter_t* filter, int axis, float value)
     if (filter == NULL) {
         return value;
     }
-    for (int motor = 0; motor < getMotorCount(); motor++) {
-        for (int i = 0; i < filter->harmonics; i++) {
-            value = biquadFilterApplyDF1(&filter->notch[axis][motor][i], value);
-        }
-    }
-    return value;
+    return biquadNotchBankApply(filter->coeffs, filter->state[axis], filter->notchCount, value);
 }
 
 float rpmFilterGyro(int axis, float value)
@@ -174,16 +214,56 @@ float rpmFilterGyro(int axis, float value)
     return applyFilter(gyroFilter, axis, value);
 }
 
-float rpmFilterDterm(int axis, float value)
+// Filters the three axes in place, notch by notch, so every notch loads its coefficients once for all
+// the axes and the axes' independent computations can be interleaved. The result for each axis is
+// the same as biquadNotchBankApply() on its own.
+FAST_CODE void rpmFilterDtermApply(float *values)
 {
-    return applyFilter(dtermFilter, axis, value);
+    if (dtermFilter == NULL) {
+        return;
+    }
+
+    const int count = dtermFilter->notchCount;
+    for (int i = 0; i < count; i++) {
+        const float b0 = dtermFilter->coeffs[i].b0, a1 = dtermFilter->coeffs[i].a1, a2 = dtermFilter->coeffs[i].a2;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadNotchState_t *state = dtermFilter->state[axis];
+            const float input = values[axis];
+            values[axis] = b0 * (input + state[i].z2) + a1 * (state[i].z1 - state[i + 1].z1) - a2 * state[i + 1].z2;
+
+            state[i].z2 = state[i].z1;
+            state[i].z1 = input;
+        }
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadNotchState_t *state = dtermFilter->state[axis];
+        state[count].z2 = state[count].z1;
+        state[count].z1 = values[axis];
+    }
 }
 
-FAST_RAM_ZERO_INIT static float motorFrequency[MAX_SUPPORTED_MOTORS];
 
+// Finds the next motor whose frequency moved enough since its notches were last calculated.
+// Returns false if none did, all the notches are then still accurate and nothing needs updating.
+static bool rpmFilterSelectNextMotor(void)
+{
+    for (int i = 0; i < getMotorCount(); i++) {
+        if (++currentMotor == getMotorCount()) {
+            currentMotor = 0;
+        }
+        const float frequency = erpmToHz * filteredMotorErpm[currentMotor];
+        if (fabsf(frequency - motorFrequency[currentMotor]) > motorUpdateThreshold * motorFrequency[currentMotor]) {
+            motorFrequency[currentMotor] = frequency;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The motor speeds are followed whenever there is telemetry, dynamic idle uses them without the notches
 FAST_CODE_NOINLINE void rpmFilterUpdate()
 {
-    if (gyroFilter == NULL && dtermFilter == NULL) {
+    if (!motorTracking) {
         return;
     }
 
@@ -194,39 +274,43 @@ FAST_CODE_NOINLINE void rpmFilterUpdate()
         }
     }
 
+    if (gyroFilter == NULL && dtermFilter == NULL) {
+        return;
+    }
+
     for (int i = 0; i < filterUpdatesPerIteration; i++) {
+        if (!currentMotorPending) {
+            currentMotorPending = rpmFilterSelectNextMotor();
+            if (!currentMotorPending) {
+                break;
+            }
+        }
+
         float frequency = constrainf(
-            (currentHarmonic + 1) * motorFrequency[currentMotor], currentFilter->minHz, currentFilter->maxHz);
-        biquadFilter_t* template = &currentFilter->notch[0][currentMotor][currentHarmonic];
+            currentFilter->harmonicNumber[currentHarmonic] * motorFrequency[currentMotor], currentFilter->minHz, currentFilter->maxHz);
         // uncomment below to debug filter stepping. Need to also comment out motor rpm DEBUG_SET above
         /* DEBUG_SET(DEBUG_RPM_FILTER, 0, harmonic); */
         /* DEBUG_SET(DEBUG_RPM_FILTER, 1, motor); */
         /* DEBUG_SET(DEBUG_RPM_FILTER, 2, currentFilter == &gyroFilter); */
         /* DEBUG_SET(DEBUG_RPM_FILTER, 3, frequency) */
-        biquadFilterUpdate(
-            template, frequency, currentFilter->loopTime, currentFilter->q, FILTER_NOTCH);
-        for (int axis = 1; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilter_t* clone = &currentFilter->notch[axis][currentMotor][currentHarmonic];
-            clone->b0 = template->b0;
-            clone->b1 = template->b1;
-            clone->b2 = template->b2;
-            clone->a1 = template->a1;
-            clone->a2 = template->a2;
-        }
+#ifdef USE_GYRO_ODR_TRACKING
+        // the motor frequencies are in real time, the notches run at the actual sample rate of the gyro
+        const float loopTime = currentFilter->loopTime * gyro.odrScale;
+#else
+        const float loopTime = currentFilter->loopTime;
+#endif
+        biquadNotchCoeffsUpdate(&currentFilter->coeffs[currentMotor * currentFilter->harmonics + currentHarmonic],
+            frequency, loopTime, currentFilter->q);
 
         if (++currentHarmonic == currentFilter->harmonics) {
             currentHarmonic = 0;
             if (++currentFilterNumber == numberRpmNotchFilters) {
                 currentFilterNumber = 0;
-                if (++currentMotor == getMotorCount()) {
-                    currentMotor = 0;
-                }
-                motorFrequency[currentMotor] = erpmToHz * filteredMotorErpm[currentMotor];
-                minMotorFrequency = 0.0f;
+                // all the notches of this motor are done
+                currentMotorPending = false;
             }
             currentFilter = &filters[currentFilterNumber];
         }
-
     }
 }
 
@@ -235,17 +319,20 @@ bool isRpmFilterEnabled(void)
     return (motorConfig()->dev.useDshotTelemetry && (rpmFilterConfig()->gyro_rpm_notch_harmonics || rpmFilterConfig()->dterm_rpm_notch_harmonics));
 }
 
+// Configuration based, so it can be used before rpmFilterInit() has been called
+bool isRpmFilterGyroEnabled(void)
+{
+    return motorConfig()->dev.useDshotTelemetry && rpmFilterConfig()->gyro_rpm_notch_harmonics;
+}
+
+// From the filtered telemetry of this loop, unlike the notch frequencies which only follow larger changes
 float rpmMinMotorFrequency()
 {
-    if (minMotorFrequency == 0.0f) {
-        minMotorFrequency = 10000.0f;
-        for (int i = getMotorCount(); i--;) {
-            if (motorFrequency[i] < minMotorFrequency) {
-                minMotorFrequency = motorFrequency[i];
-            }
-        }
+    float minErpm = filteredMotorErpm[0];
+    for (int i = 1; i < getMotorCount(); i++) {
+        minErpm = MIN(minErpm, filteredMotorErpm[i]);
     }
-    return minMotorFrequency;
+    return minErpm * erpmToHz;
 }
 
 
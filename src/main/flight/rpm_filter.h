@@ -23,15 +23,19 @@
 #include "common/axis.h"
 #include "pg/pg.h"
 
+#define RPM_FILTER_HARMONICS_MASK_ALL 0x07
+
 typedef struct rpmFilterConfig_s
 {
     uint8_t  gyro_rpm_notch_harmonics;   // how many harmonics should be covered with notches? 0 means filter off
     uint8_t  gyro_rpm_notch_min;         // minimum frequency of the notches
     uint16_t gyro_rpm_notch_q;           // q of the notches
+    uint8_t  gyro_rpm_notch_mask;        // bit n enables the notch on harmonic n + 1, within the first gyro_rpm_notch_harmonics
 
     uint8_t  dterm_rpm_notch_harmonics;  // how many harmonics should be covered with notches? 0 means filter off
     uint8_t  dterm_rpm_notch_min;        // minimum frequency of the notches
     uint16_t dterm_rpm_notch_q;          // q of the notches
+    uint8_t  dterm_rpm_notch_mask;       // bit n enables the notch on harmonic n + 1, within the first dterm_rpm_notch_harmonics
 
     uint16_t rpm_lpf;                    // the cutoff of the lpf on reported motor rpm
 } rpmFilterConfig_t;
@@ -40,7 +44,8 @@ PG_DECLARE(rpmFilterConfig_t, rpmFilterConfig);
 
 void  rpmFilterInit(const rpmFilterConfig_t *config);
 float rpmFilterGyro(int axis, float values);
-float rpmFilterDterm(int axis, float values);
+void  rpmFilterDtermApply(float *values);
 void  rpmFilterUpdate();
 bool isRpmFilterEnabled(void);
+bool isRpmFilterGyroEnabled(void);
 float rpmMinMotorFrequency();
@@ -98,6 +98,22 @@ static uint8_t servoRuleCount = 0;
 static servoMixer_t currentServoMixer[MAX_SERVO_RULES];
 static int useServo;
 
+// A rule of currentServoMixer with the parts that only depend on the configuration
+// worked out, so servoMixer() does not look up the servo parameters every loop
+typedef struct servoMixerRule_s {
+    uint8_t target;
+    uint8_t from;
+    uint8_t speed;
+    uint8_t box;
+    int8_t rate;
+    int8_t direction;
+    int16_t min;
+    int16_t max;
+} servoMixerRule_t;
+
+static uint8_t servoMixerRuleCount;
+static servoMixerRule_t servoMixerRules[MAX_SERVO_RULES];
+
 
 #define COUNT_SERVO_RULES(rules) (sizeof(rules) / sizeof(servoMixer_t))
 // mixer rule format servo, input, rate, speed, min, max, box
@@ -253,6 +269,31 @@ void loadCustomServoMixer(void)
         currentServoMixer[i] = *customServoMixers(i);
         servoRuleCount++;
     }
+
+    servoMixerCompile();
+}
+
+void servoMixerCompile(void)
+{
+    servoMixerRuleCount = 0;
+
+    for (int i = 0; i < servoRuleCount; i++) {
+        const servoMixer_t *rule = &currentServoMixer[i];
+        if (rule->targetChannel >= MAX_SUPPORTED_SERVOS || rule->inputSource >= INPUT_SOURCE_COUNT) {
+            continue;
+        }
+
+        const uint16_t servoWidth = servoParams(rule->targetChannel)->max - servoParams(rule->targetChannel)->min;
+        servoMixerRule_t *compiled = &servoMixerRules[servoMixerRuleCount++];
+        compiled->target = rule->targetChannel;
+        compiled->from = rule->inputSource;
+        compiled->speed = rule->speed;
+        compiled->box = rule->box;
+        compiled->rate = rule->rate;
+        compiled->direction = servoDirection(rule->targetChannel, rule->inputSource);
+        compiled->min = rule->min * servoWidth / 100 - servoWidth / 2;
+        compiled->max = rule->max * servoWidth / 100 - servoWidth / 2;
+    }
 }
 
 void servoConfigureOutput(void)
@@ -263,6 +304,7 @@ void servoConfigureOutput(void)
             for (int i = 0; i < servoRuleCount; i++)
                 currentServoMixer[i] = servoMixers[currentMixerMode].rule[i];
         }
+        servoMixerCompile();
     }
 
     // set flag that we're on something with wings
@@ -403,6 +445,8 @@ void writeServos(void)
         forwardAuxChannelsToServos(servoIndex);
         servoIndex += MAX_AUX_CHANNEL_COUNT;
     }
+
+    pwmCompleteServoUpdate();
 }
 
 void servoMixer(void)
@@ -452,25 +496,22 @@ void servoMixer(void)
     }
 
     // mix servos according to rules
-    for (int i = 0; i < servoRuleCount; i++) {
+    for (int i = 0; i < servoMixerRuleCount; i++) {
+        const servoMixerRule_t *rule = &servoMixerRules[i];
         // consider rule if no box assigned or box is active
-        if (currentServoMixer[i].box == 0 || IS_RC_MODE_ACTIVE(BOXSERVO1 + currentServoMixer[i].box - 1)) {
-            uint8_t target = currentServoMixer[i].targetChannel;
-            uint8_t from = currentServoMixer[i].inputSource;
-            uint16_t servo_width = servoParams(target)->max - servoParams(target)->min;
-            int16_t min = currentServoMixer[i].min * servo_width / 100 - servo_width / 2;
-            int16_t max = currentServoMixer[i].max * servo_width / 100 - servo_width / 2;
-
-            if (currentServoMixer[i].speed == 0)
-                currentOutput[i] = input[from];
+        if (rule->box == 0 || IS_RC_MODE_ACTIVE(BOXSERVO1 + rule->box - 1)) {
+            const int16_t from = input[rule->from];
+
+            if (rule->speed == 0)
+                currentOutput[i] = from;
             else {
-                if (currentOutput[i] < input[from])
-                    currentOutput[i] = constrain(currentOutput[i] + currentServoMixer[i].speed, currentOutput[i], input[from]);
-                else if (currentOutput[i] > input[from])
-                    currentOutput[i] = constrain(currentOutput[i] - currentServoMixer[i].speed, input[from], currentOutput[i]);
+                if (currentOutput[i] < from)
+                    currentOutput[i] = constrain(currentOutput[i] + rule->speed, currentOutput[i], from);
+                else if (currentOutput[i] > from)
+                    currentOutput[i] = constrain(currentOutput[i] - rule->speed, from, currentOutput[i]);
             }
 
-            servo[target] += servoDirection(target, from) * constrain(((int32_t)currentOutput[i] * currentServoMixer[i].rate) / 100, min, max);
+            servo[rule->target] += rule->direction * constrain(((int32_t)currentOutput[i] * rule->rate) / 100, rule->min, rule->max);
         } else {
             currentOutput[i] = 0;
         }
@@ -541,14 +582,18 @@ bool isMixerUsingServos(void)
     return useServo;
 }
 
-static biquadFilter_t servoFilter[MAX_SUPPORTED_SERVOS];
+// All servos share the lowpass, so there is one set of coefficients and the
+// servos only keep their own state, as the three axis filters do
+static biquadLowpassCoeffs_t servoFilterCoeffs;
+static float servoFilterX1[MAX_SUPPORTED_SERVOS];
+static float servoFilterX2[MAX_SUPPORTED_SERVOS];
 
 void servosFilterInit(void)
 {
     if (servoConfig()->servo_lowpass_freq) {
-        for (int servoIdx = 0; servoIdx < MAX_SUPPORTED_SERVOS; servoIdx++) {
-            biquadFilterInitLPF(&servoFilter[servoIdx], servoConfig()->servo_lowpass_freq, targetPidLooptime);
-        }
+        biquadLowpassCoeffsInit(&servoFilterCoeffs, servoConfig()->servo_lowpass_freq, targetPidLooptime);
+        memset(servoFilterX1, 0, sizeof(servoFilterX1));
+        memset(servoFilterX2, 0, sizeof(servoFilterX2));
     }
 
 }
@@ -558,8 +603,15 @@ static void filterServos(void)
     uint32_t startTime = micros();
 #endif
     if (servoConfig()->servo_lowpass_freq) {
+        const float b0 = servoFilterCoeffs.b0, a1 = servoFilterCoeffs.a1, a2 = servoFilterCoeffs.a2;
+
         for (int servoIdx = 0; servoIdx < MAX_SUPPORTED_SERVOS; servoIdx++) {
-            servo[servoIdx] = lrintf(biquadFilterApply(&servoFilter[servoIdx], (float)servo[servoIdx]));
+            // direct form 2 transposed lowpass, b1 == 2 * b0 and b2 == b0
+            const float input = b0 * servo[servoIdx];
+            const float result = input + servoFilterX1[servoIdx];
+            servoFilterX1[servoIdx] = 2.0f * input - a1 * result + servoFilterX2[servoIdx];
+            servoFilterX2[servoIdx] = input - a2 * result;
+            servo[servoIdx] = lrintf(result);
             // Sanity check
             servo[servoIdx] = constrain(servo[servoIdx], servoParams(servoIdx)->min, servoParams(servoIdx)->max);
         }
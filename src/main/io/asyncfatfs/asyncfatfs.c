@@ -47,7 +47,9 @@
 #include "asyncfatfs.h"
 
 #include "fat_standard.h"
+#include "drivers/dma.h"
 #include "drivers/sdcard.h"
+#include "drivers/time.h"
 #include "common/maths.h"
 #include "common/time.h"
 #include "common/utils.h"
@@ -58,7 +60,14 @@
     #define ONLY_EXPOSE_FOR_TESTING static
 #endif
 
+// Targets with RAM to spare can buffer more of the blackbox stream to ride out slow card writes
+#ifndef AFATFS_NUM_CACHE_SECTORS
+#if defined(STM32F7) || defined(STM32H7)
+#define AFATFS_NUM_CACHE_SECTORS 16
+#else
 #define AFATFS_NUM_CACHE_SECTORS 10
+#endif
+#endif
 
 // FAT filesystems are allowed to differ from these parameters, but we choose not to support those weird filesystems:
 #define AFATFS_SECTOR_SIZE  512
@@ -75,6 +84,18 @@
  */
 #define AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT 4
 
+/*
+ * How many times afatfs_flush() will hold back other dirty sectors while the next sector of a multi-block write is
+ * still being filled by the application. Flushing anything else would end the multi-block write.
+ */
+#define AFATFS_MAX_DEFERRED_STREAM_FLUSHES 8
+
+/*
+ * How long afatfs_poll() may keep driving the card while the filesystem is being mounted. Scanning the FAT of a large
+ * card takes thousands of sector operations, at one per call this delays the mount by many seconds.
+ */
+#define AFATFS_INIT_POLL_BUDGET_US 500
+
 #define AFATFS_FILES_PER_DIRECTORY_SECTOR (AFATFS_SECTOR_SIZE / sizeof(fatDirectoryEntry_t))
 
 #define AFATFS_FAT32_FAT_ENTRIES_PER_SECTOR  (AFATFS_SECTOR_SIZE / sizeof(uint32_t))
@@ -425,6 +446,7 @@ typedef struct afatfsFile_t {
 typedef enum {
     AFATFS_INITIALIZATION_READ_MBR,
     AFATFS_INITIALIZATION_READ_VOLUME_ID,
+    AFATFS_INITIALIZATION_READ_FSINFO,
 
 #ifdef AFATFS_USE_FREEFILE
     AFATFS_INITIALIZATION_FREEFILE_CREATE,
@@ -457,16 +479,22 @@ typedef struct afatfs_t {
     } initState;
 #endif
 
-#ifdef STM32H7
     uint8_t *cache;
-#else
-    uint8_t cache[AFATFS_SECTOR_SIZE * AFATFS_NUM_CACHE_SECTORS];
-#endif
     afatfsCacheBlockDescriptor_t cacheDescriptor[AFATFS_NUM_CACHE_SECTORS];
     uint32_t cacheTimer;
 
     int cacheDirtyEntries; // The number of cache entries in the AFATFS_CACHE_STATE_DIRTY state
     bool cacheFlushInProgress;
+    timeUs_t cacheFlushStartTime;
+
+#ifdef AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT
+    // While streamSectorsRemain is non-zero the card is in a multi-block write which continues at streamNextSector
+    uint32_t streamNextSector;
+    uint32_t streamSectorsRemain;
+    uint8_t streamDeferredFlushes;
+#endif
+
+    afatfsWriteStats_t writeStats;
 
     afatfsFile_t openFiles[AFATFS_MAX_OPEN_FILES];
 
@@ -509,11 +537,12 @@ typedef struct afatfs_t {
 
     uint32_t rootDirectoryCluster; // Present on FAT32 and set to zero for FAT16
     uint32_t rootDirectorySectors; // Zero on FAT32, for FAT16 the number of sectors that the root directory occupies
+
+    uint32_t fsInfoSector; // The physical sector of the FAT32 FSINFO structure, or zero if there isn't one
 } afatfs_t;
 
-#ifdef STM32H7
-static DMA_RW_AXI uint8_t afatfs_cache[AFATFS_SECTOR_SIZE * AFATFS_NUM_CACHE_SECTORS] __attribute__((aligned(32)));
-#endif
+// Sectors are read into the cache by DMA, on H7 it has to be in AXI RAM for the SDMMC to reach it
+static DMA_RW_AXI DMA_BUFFER_ALIGNED uint8_t afatfs_cache[AFATFS_SECTOR_SIZE * AFATFS_NUM_CACHE_SECTORS];
 
 static afatfs_t afatfs;
 
@@ -671,6 +700,19 @@ static void afatfs_sdcardReadComplete(sdcardBlockOperation_e operation, uint32_t
     }
 }
 
+static void afatfs_recordWriteLatency(timeDelta_t latencyUs)
+{
+    int bucket = 0;
+
+    while (bucket < AFATFS_WRITE_LATENCY_BUCKET_COUNT - 1 && (uint32_t)latencyUs >= AFATFS_WRITE_LATENCY_BUCKET_LIMIT_US(bucket)) {
+        bucket++;
+    }
+
+    afatfs.writeStats.latencyHistogram[bucket]++;
+    afatfs.writeStats.maxLatencyUs = MAX(afatfs.writeStats.maxLatencyUs, (uint32_t)latencyUs);
+    afatfs.writeStats.sectorsWritten++;
+}
+
 /**
  * Called by the SD card driver when one of our write operations completes.
  */
@@ -692,16 +734,43 @@ static void afatfs_sdcardWriteComplete(sdcardBlockOperation_e operation, uint32_
                 // Write failed, remark the sector as dirty
                 afatfs.cacheDescriptor[i].state = AFATFS_CACHE_STATE_DIRTY;
                 afatfs.cacheDirtyEntries++;
+#ifdef AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT
+                // The card is reset after a failed write, so the multi-block write is gone too
+                afatfs.streamSectorsRemain = 0;
+#endif
             } else {
                 afatfs_assert(afatfs_cacheSectorGetMemory(i) == buffer);
 
                 afatfs.cacheDescriptor[i].state = AFATFS_CACHE_STATE_IN_SYNC;
+                afatfs_recordWriteLatency(cmpTimeUs(micros(), afatfs.cacheFlushStartTime));
             }
             break;
         }
     }
 }
 
+/**
+ * Track the multi-block write the card is performing after it accepted a write of the given sector.
+ */
+static void afatfs_cacheFlushStreamAdvance(afatfsCacheBlockDescriptor_t *cacheDescriptor)
+{
+#ifdef AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT
+    if (afatfs.streamSectorsRemain > 0 && cacheDescriptor->sectorIndex == afatfs.streamNextSector) {
+        afatfs.streamNextSector++;
+        afatfs.streamSectorsRemain--;
+        afatfs.writeStats.streamedSectors++;
+    } else if (cacheDescriptor->consecutiveEraseBlockCount) {
+        afatfs.streamNextSector = cacheDescriptor->sectorIndex + 1;
+        afatfs.streamSectorsRemain = cacheDescriptor->consecutiveEraseBlockCount - 1;
+    } else {
+        // A single block write ends any multi-block write in progress
+        afatfs.streamSectorsRemain = 0;
+    }
+#else
+    UNUSED(cacheDescriptor);
+#endif
+}
+
 /**
  * Attempt to flush the dirty cache entry with the given index to the SDcard.
  */
@@ -715,18 +784,23 @@ static void afatfs_cacheFlushSector(int cacheIndex)
     }
 #endif
 
+    afatfs.cacheFlushStartTime = micros();
+
     switch (sdcard_writeBlock(cacheDescriptor->sectorIndex, afatfs_cacheSectorGetMemory(cacheIndex), afatfs_sdcardWriteComplete, 0)) {
         case SDCARD_OPERATION_IN_PROGRESS:
             // The card will call us back later when the buffer transmission finishes
             afatfs.cacheDirtyEntries--;
             cacheDescriptor->state = AFATFS_CACHE_STATE_WRITING;
             afatfs.cacheFlushInProgress = true;
+            afatfs_cacheFlushStreamAdvance(cacheDescriptor);
             break;
 
         case SDCARD_OPERATION_SUCCESS:
             // Buffer is already transmitted
             afatfs.cacheDirtyEntries--;
             cacheDescriptor->state = AFATFS_CACHE_STATE_IN_SYNC;
+            afatfs_cacheFlushStreamAdvance(cacheDescriptor);
+            afatfs_recordWriteLatency(cmpTimeUs(micros(), afatfs.cacheFlushStartTime));
             break;
 
         case SDCARD_OPERATION_BUSY:
@@ -839,6 +913,32 @@ static int afatfs_allocateCacheSector(uint32_t sectorIndex)
 bool afatfs_flush(void)
 {
     if (afatfs.cacheDirtyEntries > 0) {
+#ifdef AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT
+        // Keep a multi-block write going by flushing its next sector ahead of anything older
+        if (afatfs.streamSectorsRemain > 0) {
+            afatfsCacheBlockDescriptor_t *streamDescriptor = afatfs_findCacheSector(afatfs.streamNextSector);
+
+            if (streamDescriptor && streamDescriptor->state == AFATFS_CACHE_STATE_DIRTY && !streamDescriptor->locked) {
+                afatfs.streamDeferredFlushes = 0;
+                afatfs_cacheFlushSector(streamDescriptor - afatfs.cacheDescriptor);
+
+                return false;
+            }
+
+            if (
+                streamDescriptor && streamDescriptor->locked
+                && afatfs.streamDeferredFlushes < AFATFS_MAX_DEFERRED_STREAM_FLUSHES
+                && afatfs.cacheDirtyEntries < AFATFS_NUM_CACHE_SECTORS / 2
+            ) {
+                // The application is still filling the next sector, give it a chance to finish
+                afatfs.streamDeferredFlushes++;
+
+                return false;
+            }
+        }
+        afatfs.streamDeferredFlushes = 0;
+#endif
+
         // Flush the oldest flushable sector
         uint32_t earliestSectorTime = 0xFFFFFFFF;
         int earliestSectorIndex = -1;
@@ -946,6 +1046,10 @@ static afatfsOperationStatus_e afatfs_cacheSector(uint32_t physicalSectorIndex,
             if ((sectorFlags & AFATFS_CACHE_READ) != 0) {
                 if (sdcard_readBlock(physicalSectorIndex, afatfs_cacheSectorGetMemory(cacheSectorIndex), afatfs_sdcardReadComplete, 0)) {
                     afatfs.cacheDescriptor[cacheSectorIndex].state = AFATFS_CACHE_STATE_READING;
+#ifdef AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT
+                    // Reads end any multi-block write in progress
+                    afatfs.streamSectorsRemain = 0;
+#endif
                 }
                 return AFATFS_OPERATION_IN_PROGRESS;
             }
@@ -1064,9 +1168,13 @@ static bool afatfs_parseVolumeID(const uint8_t *sector)
 
     if (afatfs.filesystemType == FAT_FILESYSTEM_TYPE_FAT32) {
         afatfs.rootDirectoryCluster = volume->fatDescriptor.fat32.rootCluster;
+
+        const uint16_t fsInfo = volume->fatDescriptor.fat32.fsInfo;
+        afatfs.fsInfoSector = fsInfo != 0 && fsInfo != 0xFFFF ? afatfs.partitionStartSector + fsInfo : 0;
     } else {
         // FAT16 doesn't store the root directory in clusters
         afatfs.rootDirectoryCluster = 0;
+        afatfs.fsInfoSector = 0;
     }
 
     uint32_t endOfFATs = afatfs.fatStartSector + AFATFS_NUM_FATS * afatfs.fatSectors;
@@ -1076,6 +1184,25 @@ static bool afatfs_parseVolumeID(const uint8_t *sector)
     return true;
 }
 
+/**
+ * Take the next free cluster hint from the FAT32 FSINFO sector, so that the first search for a free cluster can skip
+ * over the occupied start of the volume instead of reading its FAT sectors one by one.
+ */
+static void afatfs_parseFSInfo(const uint8_t *sector)
+{
+    const fatFSInfo_t *fsInfo = (const fatFSInfo_t *) sector;
+
+    if (fsInfo->leadSignature != FAT_FSINFO_LEAD_SIGNATURE || fsInfo->structSignature != FAT_FSINFO_STRUCT_SIGNATURE
+            || fsInfo->trailSignature != FAT_FSINFO_TRAIL_SIGNATURE) {
+        return;
+    }
+
+    if (fsInfo->nextFree != FAT_FSINFO_UNKNOWN && fsInfo->nextFree >= FAT_SMALLEST_LEGAL_CLUSTER_NUMBER
+            && fsInfo->nextFree < afatfs.numClusters + FAT_SMALLEST_LEGAL_CLUSTER_NUMBER) {
+        afatfs.lastClusterAllocated = fsInfo->nextFree;
+    }
+}
+
 /**
  * Get the position of the FAT entry for the cluster with the given number.
  */
@@ -1546,8 +1673,15 @@ static afatfsOperationStatus_e afatfs_appendRegularFreeClusterContinue(afatfsFil
                     opState->phase = AFATFS_APPEND_FREE_CLUSTER_PHASE_UPDATE_FAT1;
                     goto doMore;
                 break;
-                case AFATFS_FIND_CLUSTER_FATAL:
                 case AFATFS_FIND_CLUSTER_NOT_FOUND:
+                    // The search starts from a hint, so there may still be free clusters before it
+                    if (afatfs.lastClusterAllocated > FAT_SMALLEST_LEGAL_CLUSTER_NUMBER) {
+                        afatfs.lastClusterAllocated = FAT_SMALLEST_LEGAL_CLUSTER_NUMBER;
+                        opState->searchCluster = FAT_SMALLEST_LEGAL_CLUSTER_NUMBER;
+                        goto doMore;
+                    }
+                    FALLTHROUGH;
+                case AFATFS_FIND_CLUSTER_FATAL:
                     // We couldn't find an empty cluster to append to the file
                     opState->phase = AFATFS_APPEND_FREE_CLUSTER_PHASE_FAILURE;
                     goto doMore;
@@ -3442,6 +3576,19 @@ static void afatfs_initContinue(void)
                 }
             }
         break;
+        case AFATFS_INITIALIZATION_READ_FSINFO:
+            if (afatfs.fsInfoSector == 0) {
+                afatfs.initPhase++;
+                goto doMore;
+            }
+
+            // The hint is optional, so a card that won't read it is no reason to give up on the volume
+            if (afatfs_cacheSector(afatfs.fsInfoSector, &sector, AFATFS_CACHE_READ | AFATFS_CACHE_DISCARDABLE, 0) == AFATFS_OPERATION_SUCCESS) {
+                afatfs_parseFSInfo(sector);
+                afatfs.initPhase++;
+                goto doMore;
+            }
+        break;
 
 #ifdef AFATFS_USE_FREEFILE
         case AFATFS_INITIALIZATION_FREEFILE_CREATE:
@@ -3539,21 +3686,27 @@ static void afatfs_initContinue(void)
  */
 void afatfs_poll(void)
 {
-    // Only attempt to continue FS operations if the card is present & ready, otherwise we would just be wasting time
-    if (sdcard_poll()) {
-        afatfs_flush();
+    const timeUs_t startTimeUs = micros();
 
-        switch (afatfs.filesystemState) {
-            case AFATFS_FILESYSTEM_STATE_INITIALIZATION:
-                afatfs_initContinue();
-            break;
-            case AFATFS_FILESYSTEM_STATE_READY:
-                afatfs_fileOperationsPoll();
-            break;
-            default:
-                ;
+    do {
+        // Only attempt to continue FS operations if the card is present & ready, otherwise we would just be wasting time
+        if (sdcard_poll()) {
+            afatfs_flush();
+
+            switch (afatfs.filesystemState) {
+                case AFATFS_FILESYSTEM_STATE_INITIALIZATION:
+                    afatfs_initContinue();
+                break;
+                case AFATFS_FILESYSTEM_STATE_READY:
+                    afatfs_fileOperationsPoll();
+                break;
+                default:
+                    ;
+            }
         }
-    }
+        // Mounting reads and writes the FAT sector by sector, so keep the card busy rather than waiting for the next call
+    } while (afatfs.filesystemState == AFATFS_FILESYSTEM_STATE_INITIALIZATION && sdcard_isFunctional()
+        && cmpTimeUs(micros(), startTimeUs) < AFATFS_INIT_POLL_BUDGET_US);
 }
 
 #ifdef AFATFS_USE_INTROSPECTIVE_LOGGING
@@ -3610,11 +3763,19 @@ afatfsError_e afatfs_getLastError(void)
     return afatfs.lastError;
 }
 
+const afatfsWriteStats_t *afatfs_getWriteStats(void)
+{
+    return &afatfs.writeStats;
+}
+
+int afatfs_getCacheSectorCount(void)
+{
+    return AFATFS_NUM_CACHE_SECTORS;
+}
+
 void afatfs_init(void)
 {
-#ifdef STM32H7
     afatfs.cache = afatfs_cache;
-#endif
     afatfs.filesystemState = AFATFS_FILESYSTEM_STATE_INITIALIZATION;
     afatfs.initPhase = AFATFS_INITIALIZATION_READ_MBR;
     afatfs.lastClusterAllocated = FAT_SMALLEST_LEGAL_CLUSTER_NUMBER;
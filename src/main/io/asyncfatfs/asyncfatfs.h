@@ -60,6 +60,17 @@ typedef enum {
     AFATFS_SEEK_END
 } afatfsSeek_e;
 
+// Sector write latencies are counted in power of two buckets, the last bucket holds everything slower
+#define AFATFS_WRITE_LATENCY_BUCKET_COUNT 8
+#define AFATFS_WRITE_LATENCY_BUCKET_LIMIT_US(bucket) (250U << (bucket))
+
+typedef struct afatfsWriteStats_s {
+    uint32_t sectorsWritten;
+    uint32_t streamedSectors;   // Sectors which continued a multi-block write
+    uint32_t maxLatencyUs;
+    uint32_t latencyHistogram[AFATFS_WRITE_LATENCY_BUCKET_COUNT];
+} afatfsWriteStats_t;
+
 typedef void (*afatfsFileCallback_t)(afatfsFilePtr_t file);
 typedef void (*afatfsCallback_t)(void);
 
@@ -93,3 +104,6 @@ bool afatfs_isFull(void);
 
 afatfsFilesystemState_e afatfs_getFilesystemState(void);
 afatfsError_e afatfs_getLastError(void);
+
+const afatfsWriteStats_t *afatfs_getWriteStats(void);
+int afatfs_getCacheSectorCount(void);
@@ -32,6 +32,11 @@
 #define FAT_VOLUME_ID_SIGNATURE_1 0x55
 #define FAT_VOLUME_ID_SIGNATURE_2 0xAA
 
+#define FAT_FSINFO_LEAD_SIGNATURE   0x41615252
+#define FAT_FSINFO_STRUCT_SIGNATURE 0x61417272
+#define FAT_FSINFO_TRAIL_SIGNATURE  0xAA550000
+#define FAT_FSINFO_UNKNOWN          0xFFFFFFFF
+
 #define FAT_DIRECTORY_ENTRY_SIZE 32
 #define FAT_SMALLEST_LEGAL_CLUSTER_NUMBER 2
 
@@ -115,6 +120,17 @@ typedef struct fatVolumeID_t {
     } fatDescriptor;
 } __attribute__((packed)) fatVolumeID_t;
 
+// FAT32 only, the free space hints the filesystem keeps in the sector named by fat32Descriptor_t.fsInfo
+typedef struct fatFSInfo_t {
+    uint32_t leadSignature;
+    uint8_t reserved1[480];
+    uint32_t structSignature;
+    uint32_t freeCount;
+    uint32_t nextFree;
+    uint8_t reserved2[12];
+    uint32_t trailSignature;
+} __attribute__((packed)) fatFSInfo_t;
+
 typedef struct fatDirectoryEntry_t {
     char filename[FAT_FILENAME_LENGTH];
     uint8_t attrib;
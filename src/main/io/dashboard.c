@@ -621,6 +621,11 @@ void dashboardUpdate(timeUs_t currentTimeUs)
     }
 #endif
 
+    if (dashboardPresent) {
+        // queue the pages the last update could not queue
+        i2c_OLED_update(bus);
+    }
+
     const bool updateNow = (int32_t)(currentTimeUs - nextDisplayUpdateAt) >= 0L;
     if (!updateNow) {
         return;
@@ -682,6 +687,8 @@ void dashboardUpdate(timeUs_t currentTimeUs)
         updateTicker();
     }
 
+    // only the pages that changed are sent, in the background
+    i2c_OLED_update(bus);
 }
 
 void dashboardInit(void)
@@ -43,7 +43,7 @@
 
 displayPort_t max7456DisplayPort;
 
-PG_REGISTER_WITH_RESET_FN(displayPortProfile_t, displayPortProfileMax7456, PG_DISPLAY_PORT_MAX7456_CONFIG, 0);
+PG_REGISTER_WITH_RESET_FN(displayPortProfile_t, displayPortProfileMax7456, PG_DISPLAY_PORT_MAX7456_CONFIG, 2);
 
 void pgResetFn_displayPortProfileMax7456(displayPortProfile_t *displayPortProfile)
 {
@@ -54,6 +54,7 @@ void pgResetFn_displayPortProfileMax7456(displayPortProfile_t *displayPortProfil
     displayPortProfile->invert = false;
     displayPortProfile->blackBrightness = 0;
     displayPortProfile->whiteBrightness = 2;
+    displayPortProfile->compactEncoding = false;
 }
 
 static int grab(displayPort_t *displayPort)
@@ -27,12 +27,14 @@
 
 #ifdef USE_MSP_DISPLAYPORT
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "pg/pg.h"
 #include "pg/pg_ids.h"
 
 #include "drivers/display.h"
+#include "drivers/time.h"
 
 #include "io/displayport_msp.h"
 
@@ -41,7 +43,7 @@
 #include "msp/msp_serial.h"
 
 // no template required since defaults are zero
-PG_REGISTER(displayPortProfile_t, displayPortProfileMsp, PG_DISPLAY_PORT_MSP_CONFIG, 0);
+PG_REGISTER(displayPortProfile_t, displayPortProfileMsp, PG_DISPLAY_PORT_MSP_CONFIG, 2);
 
 static displayPort_t mspDisplayPort;
 
@@ -62,6 +64,191 @@ static int output(displayPort_t *displayPort, uint8_t cmd, uint8_t *buf, int len
     return mspSerialPush(cmd, buf, len, MSP_DIRECTION_REPLY);
 }
 
+#ifdef USE_MSP_DISPLAYPORT_COMPACT
+// Compact encoding, enabled with displayport_msp_compact.
+//
+// Writes only update a copy of the screen. drawScreen() compares it with what the receiver
+// was last sent and batches the differences of the frame into subcommand 5 packets:
+//
+//   5, { row, col, length, PackBits data }...
+//
+// PackBits data decodes to exactly length characters, a header byte h of 0..127 is followed
+// by h + 1 literal characters, h of 128..255 by one character repeated h - 125 times.
+// Subcommand 4 then commits the frame. A receiver starts from a cleared screen (subcommand 2),
+// which is sent again whenever the copy held by the receiver has to be assumed lost.
+//
+// A frame is sent over as many drawScreen() calls as its size takes at MSP_DP_COMPACT_DRAW_BUDGET
+// bytes per call, which bounds the serial traffic of each run of the OSD task on an HD canvas.
+
+#define MSP_DP_COMPACT_ROWS             MSP_DP_CANVAS_MAX_ROWS
+#define MSP_DP_COMPACT_COLS             MSP_DP_CANVAS_MAX_COLS
+#define MSP_DP_COMPACT_MAX_PAYLOAD      128
+#define MSP_DP_COMPACT_SPAN_HEADER      3
+// Unchanged characters between two changes that are cheaper to resend than a new span
+#define MSP_DP_COMPACT_MAX_GAP          MSP_DP_COMPACT_SPAN_HEADER
+#define MSP_DP_COMPACT_MIN_REPEAT       3
+#define MSP_DP_COMPACT_MAX_REPEAT       130
+#define MSP_DP_COMPACT_MAX_LITERAL      128
+// Protocol overhead of an MSP v1 packet, used when checking the space left in the serial buffer
+#define MSP_DP_PACKET_OVERHEAD          6
+#define MSP_DP_COMPACT_DRAW_BUDGET      (2 * (MSP_DP_COMPACT_MAX_PAYLOAD + MSP_DP_PACKET_OVERHEAD))
+// The whole screen is sent again now and then in case the receiver lost it, e.g. by a power cycle
+#define MSP_DP_COMPACT_RESYNC_INTERVAL_MS 5000
+
+static uint8_t compactScreen[MSP_DP_COMPACT_ROWS][MSP_DP_COMPACT_COLS];
+static uint8_t compactSent[MSP_DP_COMPACT_ROWS][MSP_DP_COMPACT_COLS];
+static bool compactResyncRequired = true;
+
+static bool compactEnabled(void)
+{
+    return displayPortProfileMsp()->compactEncoding;
+}
+
+// Appends the PackBits encoding of the characters to buf, returns the number of bytes written
+static int compactPackBits(uint8_t *buf, const uint8_t *data, int len)
+{
+    int out = 0;
+    int literalStart = 0;
+
+    for (int i = 0; i <= len; ) {
+        int repeat = 1;
+        while (i + repeat < len && data[i + repeat] == data[i] && repeat < MSP_DP_COMPACT_MAX_REPEAT) {
+            repeat++;
+        }
+
+        // Flush pending literals before a repeat, at the end, or when the literal is full
+        const bool flushLiterals = (i == len) || (repeat >= MSP_DP_COMPACT_MIN_REPEAT) || (i - literalStart == MSP_DP_COMPACT_MAX_LITERAL);
+        if (flushLiterals && i > literalStart) {
+            buf[out++] = i - literalStart - 1;
+            memcpy(&buf[out], &data[literalStart], i - literalStart);
+            out += i - literalStart;
+            literalStart = i;
+        }
+        if (i == len) {
+            break;
+        }
+
+        if (repeat >= MSP_DP_COMPACT_MIN_REPEAT) {
+            buf[out++] = repeat + 125;
+            buf[out++] = data[i];
+            i += repeat;
+            literalStart = i;
+        } else {
+            i++;
+        }
+    }
+
+    return out;
+}
+
+// Worst case encoding of a span, all literals
+#define MSP_DP_COMPACT_SPAN_MAX_BYTES(len) (MSP_DP_COMPACT_SPAN_HEADER + (len) + ((len) + MSP_DP_COMPACT_MAX_LITERAL - 1) / MSP_DP_COMPACT_MAX_LITERAL)
+
+static int compactFlushPacket(displayPort_t *displayPort, uint8_t *buf, int *len);
+
+static int compactDrawScreen(displayPort_t *displayPort)
+{
+    uint8_t buf[MSP_DP_COMPACT_MAX_PAYLOAD];
+    int len = 0;
+    int written = 0;
+    bool changed = false;
+
+    static timeMs_t lastResyncMs = 0;
+    const timeMs_t nowMs = millis();
+    if (nowMs - lastResyncMs >= MSP_DP_COMPACT_RESYNC_INTERVAL_MS) {
+        compactResyncRequired = true;
+    }
+
+    if (compactResyncRequired) {
+        uint8_t subcmd[] = { 2 };
+        if (output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd)) == 0) {
+            return 0;
+        }
+        memset(compactSent, ' ', sizeof(compactSent));
+        compactResyncRequired = false;
+        lastResyncMs = nowMs;
+        changed = true;
+    }
+
+    const int rows = MIN(displayPort->rows, MSP_DP_COMPACT_ROWS);
+    const int cols = MIN(displayPort->cols, MSP_DP_COMPACT_COLS);
+
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            if (compactScreen[row][col] == compactSent[row][col]) {
+                continue;
+            }
+
+            // Extend the span over short gaps of unchanged characters
+            int end = col + 1;
+            for (int next = end; next < cols && next - end <= MSP_DP_COMPACT_MAX_GAP; next++) {
+                if (compactScreen[row][next] != compactSent[row][next]) {
+                    end = next + 1;
+                }
+            }
+            const int spanLength = end - col;
+
+            if (len + MSP_DP_COMPACT_SPAN_MAX_BYTES(spanLength) > (int)sizeof(buf) - 1) {
+                written += compactFlushPacket(displayPort, buf, &len);
+                if (compactResyncRequired) {
+                    return written;
+                }
+            }
+            if (len == 0) {
+                // Leave the rest of the frame for the next call if the budget is spent or the serial buffer is full
+                if (written >= MSP_DP_COMPACT_DRAW_BUDGET || mspSerialTxBytesFree() < sizeof(buf) + MSP_DP_PACKET_OVERHEAD) {
+                    return written;
+                }
+                buf[len++] = 5;
+            }
+
+            buf[len++] = row;
+            buf[len++] = col;
+            buf[len++] = spanLength;
+            len += compactPackBits(&buf[len], &compactScreen[row][col], spanLength);
+            memcpy(&compactSent[row][col], &compactScreen[row][col], spanLength);
+            changed = true;
+
+            col = end - 1;
+        }
+    }
+
+    written += compactFlushPacket(displayPort, buf, &len);
+
+    if (changed && !compactResyncRequired) {
+        uint8_t subcmd[] = { 4 };
+        written += output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
+    }
+
+    return written;
+}
+
+static int compactFlushPacket(displayPort_t *displayPort, uint8_t *buf, int *len)
+{
+    int written = 0;
+
+    if (*len) {
+        written = output(displayPort, MSP_DISPLAYPORT, buf, *len);
+        if (written == 0) {
+            // The spans are already marked as sent, start again from a cleared screen
+            compactResyncRequired = true;
+        }
+        *len = 0;
+    }
+
+    return written;
+}
+
+static void compactWrite(uint8_t col, uint8_t row, const char *string)
+{
+    if (row < MSP_DP_COMPACT_ROWS) {
+        for (int i = 0; string[i] && col + i < MSP_DP_COMPACT_COLS; i++) {
+            compactScreen[row][col + i] = string[i];
+        }
+    }
+}
+#endif // USE_MSP_DISPLAYPORT_COMPACT
+
 static int heartbeat(displayPort_t *displayPort)
 {
     uint8_t subcmd[] = { 0 };
@@ -86,6 +273,13 @@ static int release(displayPort_t *displayPort)
 
 static int clearScreen(displayPort_t *displayPort)
 {
+#ifdef USE_MSP_DISPLAYPORT_COMPACT
+    if (compactEnabled()) {
+        memset(compactScreen, ' ', sizeof(compactScreen));
+        return 0;
+    }
+#endif
+
     uint8_t subcmd[] = { 2 };
 
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
@@ -93,6 +287,12 @@ static int clearScreen(displayPort_t *displayPort)
 
 static int drawScreen(displayPort_t *displayPort)
 {
+#ifdef USE_MSP_DISPLAYPORT_COMPACT
+    if (compactEnabled()) {
+        return compactDrawScreen(displayPort);
+    }
+#endif
+
     uint8_t subcmd[] = { 4 };
     return output(displayPort, MSP_DISPLAYPORT, subcmd, sizeof(subcmd));
 }
@@ -107,6 +307,13 @@ static int writeString(displayPort_t *displayPort, uint8_t col, uint8_t row, con
 #define MSP_OSD_MAX_STRING_LENGTH 30 // FIXME move this
     uint8_t buf[MSP_OSD_MAX_STRING_LENGTH + 4];
 
+#ifdef USE_MSP_DISPLAYPORT_COMPACT
+    if (compactEnabled()) {
+        compactWrite(col, row, string);
+        return 0;
+    }
+#endif
+
     int len = strlen(string);
     if (len >= MSP_OSD_MAX_STRING_LENGTH) {
         len = MSP_OSD_MAX_STRING_LENGTH;
@@ -144,8 +351,24 @@ static bool isSynced(const displayPort_t *displayPort)
 
 static void resync(displayPort_t *displayPort)
 {
-    displayPort->rows = 13 + displayPortProfileMsp()->rowAdjust; // XXX Will reflect NTSC/PAL in the future
-    displayPort->cols = 30 + displayPortProfileMsp()->colAdjust;
+    const uint8_t rows = 13 + displayPortProfileMsp()->rowAdjust; // XXX Will reflect NTSC/PAL in the future
+    const uint8_t cols = 30 + displayPortProfileMsp()->colAdjust;
+
+    if (displayPortProfileMsp()->canvasRows && displayPortProfileMsp()->canvasCols) {
+        // The OSD layout stays configured on the SD screen and is scaled to the canvas
+        displayPort->rows = MIN(displayPortProfileMsp()->canvasRows, MSP_DP_CANVAS_MAX_ROWS);
+        displayPort->cols = MIN(displayPortProfileMsp()->canvasCols, MSP_DP_CANVAS_MAX_COLS);
+        displayPort->layoutRows = rows;
+        displayPort->layoutCols = cols;
+    } else {
+        displayPort->rows = rows;
+        displayPort->cols = cols;
+        displayPort->layoutRows = 0;
+        displayPort->layoutCols = 0;
+    }
+#ifdef USE_MSP_DISPLAYPORT_COMPACT
+    compactResyncRequired = true;
+#endif
     drawScreen(displayPort);
 }
 
@@ -172,6 +395,9 @@ static const displayPortVTable_t mspDisplayPortVTable = {
 
 displayPort_t *displayPortMspInit(void)
 {
+#ifdef USE_MSP_DISPLAYPORT_COMPACT
+    memset(compactScreen, ' ', sizeof(compactScreen));
+#endif
     displayInit(&mspDisplayPort, &mspDisplayPortVTable);
     resync(&mspDisplayPort);
     return &mspDisplayPort;
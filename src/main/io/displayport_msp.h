@@ -23,6 +23,10 @@
 #include "pg/pg.h"
 #include "drivers/display.h"
 
+// Largest canvas of an HD receiver, displayport_msp_canvas_rows and _cols
+#define MSP_DP_CANVAS_MAX_ROWS  20
+#define MSP_DP_CANVAS_MAX_COLS  60
+
 PG_DECLARE(displayPortProfile_t, displayPortProfileMsp);
 
 struct displayPort_s;
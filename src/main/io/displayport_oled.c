@@ -50,7 +50,7 @@ static int oledClearScreen(displayPort_t *displayPort)
 
 static int oledDrawScreen(displayPort_t *displayPort)
 {
-    UNUSED(displayPort);
+    i2c_OLED_update(displayPort->device);
     return 0;
 }
 
@@ -76,7 +76,7 @@ static int oledWriteChar(displayPort_t *displayPort, uint8_t x, uint8_t y, uint8
 static bool oledIsTransferInProgress(const displayPort_t *displayPort)
 {
     UNUSED(displayPort);
-    return false;
+    return i2c_OLED_update_pending();
 }
 
 static bool oledIsSynced(const displayPort_t *displayPort)
@@ -40,9 +40,12 @@
 
 #include "common/printf.h"
 #include "drivers/flash.h"
+#include "drivers/time.h"
 
 #include "io/flashfs.h"
 
+#include "pg/flash.h"
+
 static const flashPartition_t *flashPartition = NULL;
 static const flashGeometry_t *flashGeometry = NULL;
 static uint32_t flashfsSize = 0;
@@ -56,11 +59,43 @@ static uint8_t flashWriteBuffer[FLASHFS_WRITE_BUFFER_SIZE];
  *
  * When the circular buffer is empty, head == tail
  */
-static uint8_t bufferHead = 0, bufferTail = 0;
+static uint16_t bufferHead = 0, bufferTail = 0;
 
 // The position of the buffer's tail in the overall flash address space:
 static uint32_t tailAddress = 0;
 
+// The bytes handed to the flash and the time spent doing so since startup, to report the write throughput
+static uint32_t bytesWritten = 0;
+static uint32_t writeTimeUs = 0;
+
+/*
+ * In ring mode the volume holds the newest data up to the tail, followed by the sectors erased ahead of it and then
+ * the oldest data. The tail wraps around the end of the volume and erasedAhead counts the bytes known to be erased
+ * from the tail onwards, it always ends on a sector boundary.
+ */
+static bool ringMode = false;
+static uint32_t erasedAhead = 0;
+
+/*
+ * Outside of ring mode on NOR flash the last sector of the partition is taken from the volume to hold an index of the
+ * logs, so that the free space and the logs can be found without searching the volume. The sector starts with a header
+ * and holds one entry per log, appended as each log ends. If the sector holds anything else, such as logs written
+ * before it was reserved, the index is not used until the next full erase.
+ */
+typedef struct flashfsLogIndexEntry_s {
+    uint32_t start;
+    uint32_t length;
+} flashfsLogIndexEntry_t;
+
+#define FLASHFS_LOG_INDEX_MAGIC     0x58444942 // "BIDX"
+#define FLASHFS_LOG_INDEX_VERSION   1
+#define FLASHFS_LOG_INDEX_ERASED    0xFFFFFFFF
+
+static bool logIndexReserved = false;
+static bool logIndexValid = false;
+static uint32_t logIndexAddress = 0;
+static int logIndexCount = 0;
+
 static void flashfsClearBuffer(void)
 {
     bufferTail = bufferHead = 0;
@@ -101,6 +136,11 @@ void flashfsEraseCompletely(void)
     flashfsClearBuffer();
 
     flashfsSetTailAddress(0);
+    erasedAhead = flashfsSize;
+
+    // The index sector is erased along with the volume
+    logIndexValid = logIndexReserved;
+    logIndexCount = 0;
 }
 
 /**
@@ -206,6 +246,7 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
         return 0;
     }
 
+    const timeUs_t startTimeUs = micros();
     uint32_t bytesTotalRemaining = bytesTotal;
 
     uint16_t pageSize = flashGeometry->pageSize;
@@ -214,6 +255,11 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
         uint32_t bytesTotalThisIteration;
         uint32_t bytesRemainThisIteration;
 
+        if (ringMode && tailAddress >= flashfsSize) {
+            // Continue over the oldest data at the start of the volume, which has been erased ahead of us
+            flashfsSetTailAddress(0);
+        }
+
         /*
          * Each page needs to be saved in a separate program operation, so
          * if we would cross a page boundary, only write up to the boundary in this iteration:
@@ -232,6 +278,13 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
             break;
         }
 
+        // Never program over data that hasn't been erased yet, the buffered data is lost until the erase catches up
+        if (ringMode && bytesTotalThisIteration > erasedAhead) {
+            flashfsClearBuffer();
+
+            break;
+        }
+
         flashPageProgramBegin(tailAddress);
 
         bytesRemainThisIteration = bytesTotalThisIteration;
@@ -265,15 +318,22 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
 
         // Advance the cursor in the file system to match the bytes we wrote
         flashfsSetTailAddress(tailAddress + bytesTotalThisIteration);
+        if (ringMode) {
+            erasedAhead -= bytesTotalThisIteration;
+        }
 
         /*
-         * We'll have to wait for that write to complete before we can issue the next one, so if
-         * the user requested asynchronous writes, break now.
+         * If the page was programmed we'll have to wait for that write to complete before we can issue the next one,
+         * so if the user requested asynchronous writes, break now. A NAND device only loads the data into its page
+         * buffer until the page is full, so it stays ready and the whole buffer goes in one call.
          */
-        if (!sync)
+        if (!sync && !flashIsReady())
             break;
     }
 
+    bytesWritten += bytesTotal - bytesTotalRemaining;
+    writeTimeUs += micros() - startTimeUs;
+
     return bytesTotal - bytesTotalRemaining;
 }
 
@@ -374,6 +434,16 @@ void flashfsFlushSync(void)
     flashfsClearBuffer();
 }
 
+uint32_t flashfsGetBytesWritten(void)
+{
+    return bytesWritten;
+}
+
+uint32_t flashfsGetWriteTimeUs(void)
+{
+    return writeTimeUs;
+}
+
 void flashfsSeekAbs(uint32_t offset)
 {
     flashfsFlushSync();
@@ -511,62 +581,65 @@ int flashfsReadAbs(uint32_t address, uint8_t *buffer, unsigned int len)
     return bytesRead;
 }
 
-/**
- * Find the offset of the start of the free space on the device (or the size of the device if it is full).
- */
-int flashfsIdentifyStartOfFreeSpace(void)
-{
-    /* Find the start of the free space on the device by examining the beginning of blocks with a binary search,
-     * looking for ones that appear to be erased. We can achieve this with good accuracy because an erased block
-     * is all bits set to 1, which pretty much never appears in reasonable size substrings of blackbox logs.
-     *
-     * To do better we might write a volume header instead, which would mark how much free space remains. But keeping
-     * a header up to date while logging would incur more writes to the flash, which would consume precious write
-     * bandwidth and block more often.
+enum {
+    /* We can choose whatever power of 2 size we like, which determines how much wastage of free space we'll have
+     * at the end of the last written data. But smaller blocksizes will require more searching.
      */
+    FREE_BLOCK_SIZE = 2048, // XXX This can't be smaller than page size for underlying flash device.
 
-    enum {
-        /* We can choose whatever power of 2 size we like, which determines how much wastage of free space we'll have
-         * at the end of the last written data. But smaller blocksizes will require more searching.
-         */
-        FREE_BLOCK_SIZE = 2048, // XXX This can't be smaller than page size for underlying flash device.
-
-        /* We don't expect valid data to ever contain this many consecutive uint32_t's of all 1 bits: */
-        FREE_BLOCK_TEST_SIZE_INTS = 4, // i.e. 16 bytes
-        FREE_BLOCK_TEST_SIZE_BYTES = FREE_BLOCK_TEST_SIZE_INTS * sizeof(uint32_t)
-    };
-
-    STATIC_ASSERT(FREE_BLOCK_SIZE >= FLASH_MAX_PAGE_SIZE, FREE_BLOCK_SIZE_too_small);
+    /* We don't expect valid data to ever contain this many consecutive uint32_t's of all 1 bits: */
+    FREE_BLOCK_TEST_SIZE_INTS = 4, // i.e. 16 bytes
+    FREE_BLOCK_TEST_SIZE_BYTES = FREE_BLOCK_TEST_SIZE_INTS * sizeof(uint32_t)
+};
 
+/**
+ * Check whether the block at the given address appears to be erased.
+ *
+ * Returns false if the flash timed out, in which case blockErased is not set.
+ */
+static bool flashfsReadBlockErased(uint32_t address, bool *blockErased)
+{
     union {
         uint8_t bytes[FREE_BLOCK_TEST_SIZE_BYTES];
         uint32_t ints[FREE_BLOCK_TEST_SIZE_INTS];
     } testBuffer;
 
-    int left = 0; // Smallest block index in the search region
-    int right = flashfsSize / FREE_BLOCK_SIZE; // One past the largest block index in the search region
+    if (flashReadBytes(address, testBuffer.bytes, FREE_BLOCK_TEST_SIZE_BYTES) < FREE_BLOCK_TEST_SIZE_BYTES) {
+        return false;
+    }
+
+    // Checking the buffer 4 bytes at a time like this is probably faster than byte-by-byte, but I didn't benchmark it :)
+    *blockErased = true;
+    for (int i = 0; i < FREE_BLOCK_TEST_SIZE_INTS; i++) {
+        if (testBuffer.ints[i] != 0xFFFFFFFF) {
+            *blockErased = false;
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Find the offset of the start of the free space in the range [start...end), which must lie on block boundaries
+ * and hold all of its data ahead of its free space. Returns end if the range is full.
+ */
+static uint32_t flashfsIdentifyStartOfFreeSpaceInRange(uint32_t start, uint32_t end)
+{
+    int left = start / FREE_BLOCK_SIZE; // Smallest block index in the search region
+    int right = end / FREE_BLOCK_SIZE; // One past the largest block index in the search region
     int mid;
     int result = right;
-    int i;
     bool blockErased;
 
     while (left < right) {
         mid = (left + right) / 2;
 
-        if (flashReadBytes(mid * FREE_BLOCK_SIZE, testBuffer.bytes, FREE_BLOCK_TEST_SIZE_BYTES) < FREE_BLOCK_TEST_SIZE_BYTES) {
+        if (!flashfsReadBlockErased(mid * FREE_BLOCK_SIZE, &blockErased)) {
             // Unexpected timeout from flash, so bail early (reporting the device fuller than it really is)
             break;
         }
 
-        // Checking the buffer 4 bytes at a time like this is probably faster than byte-by-byte, but I didn't benchmark it :)
-        blockErased = true;
-        for (i = 0; i < FREE_BLOCK_TEST_SIZE_INTS; i++) {
-            if (testBuffer.ints[i] != 0xFFFFFFFF) {
-                blockErased = false;
-                break;
-            }
-        }
-
         if (blockErased) {
             /* This erased block might be the leftmost erased block in the volume, but we'll need to continue the
              * search leftwards to find out:
@@ -582,12 +655,248 @@ int flashfsIdentifyStartOfFreeSpace(void)
     return result * FREE_BLOCK_SIZE;
 }
 
+static int flashfsLogIndexSlots(void)
+{
+    return flashGeometry->sectorSize / sizeof(flashfsLogIndexEntry_t);
+}
+
+static bool flashfsLogIndexRead(int slot, flashfsLogIndexEntry_t *entry)
+{
+    const int length = sizeof(*entry);
+
+    return flashReadBytes(logIndexAddress + slot * length, (uint8_t *)entry, length) == length;
+}
+
+static void flashfsLogIndexWrite(int slot, const flashfsLogIndexEntry_t *entry)
+{
+    flashWaitForReady();
+    flashPageProgram(logIndexAddress + slot * sizeof(*entry), (const uint8_t *)entry, sizeof(*entry));
+}
+
+/**
+ * Reserve the index sector and count the logs in it. Slot 0 holds the header, the entries follow.
+ */
+static void flashfsLogIndexInit(void)
+{
+    logIndexReserved = false;
+    logIndexValid = false;
+    logIndexCount = 0;
+
+    if (ringMode || flashGeometry->flashType != FLASH_TYPE_NOR || FLASH_PARTITION_SECTOR_COUNT(flashPartition) < 2) {
+        return;
+    }
+
+    flashfsSize -= flashGeometry->sectorSize;
+    logIndexAddress = flashfsSize;
+    logIndexReserved = true;
+
+    flashfsLogIndexEntry_t header;
+    bool blockErased;
+    if (!flashfsLogIndexRead(0, &header)) {
+        return;
+    }
+
+    if (header.start == FLASHFS_LOG_INDEX_ERASED && header.length == FLASHFS_LOG_INDEX_ERASED) {
+        // An empty index only describes the volume if the volume is empty too
+        logIndexValid = flashfsReadBlockErased(0, &blockErased) && blockErased;
+        return;
+    }
+
+    if (header.start != FLASHFS_LOG_INDEX_MAGIC || header.length != FLASHFS_LOG_INDEX_VERSION) {
+        return;
+    }
+
+    // Entries are appended in order, so the first free slot is found with a binary search
+    int left = 1;
+    int right = flashfsLogIndexSlots();
+    while (left < right) {
+        const int mid = (left + right) / 2;
+        flashfsLogIndexEntry_t entry;
+
+        if (!flashfsLogIndexRead(mid, &entry)) {
+            return;
+        }
+
+        if (entry.start == FLASHFS_LOG_INDEX_ERASED) {
+            right = mid;
+        } else {
+            left = mid + 1;
+        }
+    }
+
+    logIndexCount = left - 1;
+    logIndexValid = true;
+}
+
+/**
+ * Returns the number of logs in the index, 0 if there is no usable index.
+ */
+int flashfsLogIndexCount(void)
+{
+    return logIndexValid ? logIndexCount : 0;
+}
+
+/**
+ * Get the volume offset and length of the log at the given position in the index.
+ */
+bool flashfsLogIndexGet(int index, uint32_t *start, uint32_t *length)
+{
+    flashfsLogIndexEntry_t entry;
+
+    if (index < 0 || index >= flashfsLogIndexCount() || !flashfsLogIndexRead(index + 1, &entry)) {
+        return false;
+    }
+
+    *start = entry.start;
+    *length = entry.length;
+
+    return true;
+}
+
+/**
+ * Record a log that has ended in the index. The buffered data of the log is flushed first, so that the index never
+ * describes data that isn't on the flash yet.
+ */
+void flashfsLogIndexAppend(uint32_t start, uint32_t length)
+{
+    if (!logIndexValid || length == 0 || logIndexCount + 1 >= flashfsLogIndexSlots()) {
+        return;
+    }
+
+    flashfsFlushSync();
+
+    if (logIndexCount == 0) {
+        const flashfsLogIndexEntry_t header = { FLASHFS_LOG_INDEX_MAGIC, FLASHFS_LOG_INDEX_VERSION };
+        flashfsLogIndexWrite(0, &header);
+    }
+
+    const flashfsLogIndexEntry_t entry = { start, length };
+    flashfsLogIndexWrite(logIndexCount + 1, &entry);
+    logIndexCount++;
+}
+
+/**
+ * Find the offset of the start of the free space on the device (or the size of the device if it is full).
+ */
+int flashfsIdentifyStartOfFreeSpace(void)
+{
+    /* Without a log index, find the start of the free space on the device by examining the beginning of blocks with
+     * a binary search, looking for ones that appear to be erased. We can achieve this with good accuracy because an
+     * erased block is all bits set to 1, which pretty much never appears in reasonable size substrings of blackbox logs.
+     *
+     * The index is only written when a log ends rather than kept up to date while logging, which would consume
+     * precious write bandwidth and block more often.
+     */
+
+    STATIC_ASSERT(FREE_BLOCK_SIZE >= FLASH_MAX_PAGE_SIZE, FREE_BLOCK_SIZE_too_small);
+
+    uint32_t start;
+    uint32_t length;
+    if (flashfsLogIndexGet(flashfsLogIndexCount() - 1, &start, &length)) {
+        // The free space normally starts where the last indexed log ends
+        const uint32_t end = start + length;
+        bool blockErased;
+
+        if (end >= flashfsSize) {
+            return flashfsSize;
+        }
+
+        if (end + FREE_BLOCK_TEST_SIZE_BYTES <= flashfsSize && flashfsReadBlockErased(end, &blockErased) && blockErased) {
+            return end;
+        }
+
+        // Data follows the last indexed log, e.g. a log that wasn't closed, so only search the space after it
+        return flashfsIdentifyStartOfFreeSpaceInRange(end - end % FREE_BLOCK_SIZE, flashfsSize);
+    }
+
+    return flashfsIdentifyStartOfFreeSpaceInRange(0, flashfsSize);
+}
+
+static bool flashfsSectorIsErased(int sectorIndex)
+{
+    bool blockErased;
+
+    // A sector is erased as a whole and written from its start, so its first block tells whether it is in use
+    return flashfsReadBlockErased(sectorIndex * flashGeometry->sectorSize, &blockErased) && blockErased;
+}
+
+/**
+ * Find the tail of a ring mode volume and the space erased ahead of it. The tail is in the last written sector
+ * before the first erased one.
+ */
+static void flashfsRingInit(void)
+{
+    const uint32_t sectorSize = flashGeometry->sectorSize;
+    const int sectorCount = flashfsSize / sectorSize;
+
+    int firstErasedSector = -1;
+    bool previousSectorErased = flashfsSectorIsErased(sectorCount - 1);
+    for (int sectorIndex = 0; sectorIndex < sectorCount; sectorIndex++) {
+        const bool sectorErased = flashfsSectorIsErased(sectorIndex);
+        if (sectorErased && !previousSectorErased) {
+            firstErasedSector = sectorIndex;
+            break;
+        }
+        previousSectorErased = sectorErased;
+    }
+
+    if (firstErasedSector < 0) {
+        // Every sector is erased, or none is and the next sector has to be erased before we can write
+        flashfsSetTailAddress(0);
+        erasedAhead = previousSectorErased ? flashfsSize : 0;
+
+        return;
+    }
+
+    const int lastWrittenSector = (firstErasedSector + sectorCount - 1) % sectorCount;
+    const uint32_t lastWrittenSectorEnd = (lastWrittenSector + 1) * sectorSize;
+    flashfsSetTailAddress(flashfsIdentifyStartOfFreeSpaceInRange(lastWrittenSector * sectorSize, lastWrittenSectorEnd));
+
+    erasedAhead = lastWrittenSectorEnd - tailAddress;
+    for (int i = 0; i < sectorCount - 1 && flashfsSectorIsErased((firstErasedSector + i) % sectorCount); i++) {
+        erasedAhead += sectorSize;
+    }
+}
+
+/**
+ * In ring mode, start erasing the sector that follows the space erased ahead of the tail if the flash is idle and
+ * there is less erased space than wanted. Returns immediately, the erase completes in the background.
+ *
+ * While logging only a single sector is kept erased ahead, since the flash can't accept writes while erasing. Before
+ * logging ringEraseAhead percent of the volume is erased, so logging can start right away on arming.
+ */
+void flashfsEraseAheadAsync(bool logging)
+{
+    if (!ringMode || !flashIsReady()) {
+        return;
+    }
+
+    const uint32_t sectorSize = flashGeometry->sectorSize;
+    const uint32_t erasedAheadTarget = logging ? sectorSize : flashfsSize / 100 * flashConfig()->ringEraseAhead;
+
+    // The sector holding the tail is never erased
+    if (erasedAhead >= erasedAheadTarget || erasedAhead + sectorSize > flashfsSize - tailAddress % sectorSize) {
+        return;
+    }
+
+    flashEraseSector((tailAddress + erasedAhead) % flashfsSize);
+    erasedAhead += sectorSize;
+}
+
+/**
+ * Returns true if a ring mode volume has wrapped around, so data is stored beyond the tail as well.
+ */
+bool flashfsRingHasWrapped(void)
+{
+    return ringMode && tailAddress + erasedAhead < flashfsSize;
+}
+
 /**
  * Returns true if the file pointer is at the end of the device.
  */
 bool flashfsIsEOF(void)
 {
-    return tailAddress >= flashfsSize;
+    return !ringMode && tailAddress >= flashfsSize;
 }
 
 void flashfsClose(void)
@@ -601,7 +910,11 @@ void flashfsClose(void)
 
         // Advance tailAddress to next page boundary.
         uint32_t pageSize = flashGeometry->pageSize;
-        flashfsSetTailAddress((tailAddress + pageSize - 1) & ~(pageSize - 1));
+        const uint32_t pageAlignedTailAddress = (tailAddress + pageSize - 1) & ~(pageSize - 1);
+        if (ringMode) {
+            erasedAhead -= pageAlignedTailAddress - tailAddress;
+        }
+        flashfsSetTailAddress(pageAlignedTailAddress);
 
         break;
     }
@@ -623,8 +936,16 @@ void flashfsInit(void)
 
     flashfsSize = FLASH_PARTITION_SECTOR_COUNT(flashPartition) * flashGeometry->sectorSize;
 
-    // Start the file pointer off at the beginning of free space so caller can start writing immediately
-    flashfsSeekAbs(flashfsIdentifyStartOfFreeSpace());
+    ringMode = flashConfig()->ring;
+    if (ringMode) {
+        flashfsFlushSync();
+        flashfsRingInit();
+    } else {
+        flashfsLogIndexInit();
+
+        // Start the file pointer off at the beginning of free space so caller can start writing immediately
+        flashfsSeekAbs(flashfsIdentifyStartOfFreeSpace());
+    }
 }
 
 #ifdef USE_FLASH_TOOLS
@@ -20,11 +20,18 @@
 
 #pragma once
 
+#ifndef FLASHFS_WRITE_BUFFER_SIZE
+#ifdef USE_FLASH_W25N01G
+// NAND pages take up to 700us to program, the buffer has to absorb the writes made in the meantime
+#define FLASHFS_WRITE_BUFFER_SIZE 512
+#else
 #define FLASHFS_WRITE_BUFFER_SIZE 128
+#endif
+#endif
 #define FLASHFS_WRITE_BUFFER_USABLE (FLASHFS_WRITE_BUFFER_SIZE - 1)
 
 // Automatically trigger a flush when this much data is in the buffer
-#define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN 64
+#define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN (FLASHFS_WRITE_BUFFER_SIZE / 2)
 
 void flashfsEraseCompletely(void);
 void flashfsEraseRange(uint32_t start, uint32_t end);
@@ -34,6 +41,9 @@ uint32_t flashfsGetOffset(void);
 uint32_t flashfsGetWriteBufferFreeSpace(void);
 uint32_t flashfsGetWriteBufferSize(void);
 int flashfsIdentifyStartOfFreeSpace(void);
+int flashfsLogIndexCount(void);
+bool flashfsLogIndexGet(int index, uint32_t *start, uint32_t *length);
+void flashfsLogIndexAppend(uint32_t start, uint32_t length);
 struct flashGeometry_s;
 const struct flashGeometry_s* flashfsGetGeometry(void);
 
@@ -48,6 +58,9 @@ int flashfsReadAbs(uint32_t offset, uint8_t *data, unsigned int len);
 bool flashfsFlushAsync(void);
 void flashfsFlushSync(void);
 
+uint32_t flashfsGetBytesWritten(void);
+uint32_t flashfsGetWriteTimeUs(void);
+
 void flashfsClose(void);
 void flashfsInit(void);
 bool flashfsIsSupported(void);
@@ -55,5 +68,8 @@ bool flashfsIsSupported(void);
 bool flashfsIsReady(void);
 bool flashfsIsEOF(void);
 
+void flashfsEraseAheadAsync(bool logging);
+bool flashfsRingHasWrapped(void);
+
 bool flashfsVerifyEntireFlash(void);
 
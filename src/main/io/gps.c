@@ -32,6 +32,7 @@
 #include "build/debug.h"
 
 #include "common/axis.h"
+#include "common/coroutine.h"
 #include "common/gps_conversion.h"
 #include "common/maths.h"
 #include "common/utils.h"
@@ -54,6 +55,7 @@
 #include "flight/pid.h"
 #include "flight/gps_rescue.h"
 
+#include "sensors/sample_bus.h"
 #include "sensors/sensors.h"
 
 #define LOG_ERROR        '?'
@@ -66,6 +68,7 @@
 #define LOG_UBLOX_SVINFO 'I'
 #define LOG_UBLOX_POSLLH 'P'
 #define LOG_UBLOX_VELNED 'V'
+#define LOG_UBLOX_PVT    'T'
 
 #define GPS_SV_MAXSATS   16
 
@@ -139,7 +142,9 @@ static const uint8_t ubloxInit[] = {
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0xF0, 0x00, 0x00, 0xFA, 0x0F,           // GGA: Global positioning system fix data
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0xF0, 0x02, 0x00, 0xFC, 0x13,           // GSA: GNSS DOP and Active Satellites
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0xF0, 0x04, 0x00, 0xFE, 0x17,           // RMC: Recommended Minimum data
+};
 
+static const uint8_t ubloxLegacyMessages[] = {
     // Enable UBLOX messages
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x02, 0x01, 0x0E, 0x47,           // set POSLLH MSG rate
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x03, 0x01, 0x0F, 0x49,           // set STATUS MSG rate
@@ -147,8 +152,23 @@ static const uint8_t ubloxInit[] = {
     //0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x30, 0x01, 0x3C, 0xA3,           // set SVINFO MSG rate (every cycle - high bandwidth)
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x30, 0x05, 0x40, 0xA7,           // set SVINFO MSG rate (evey 5 cycles - low bandwidth)
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x12, 0x01, 0x1E, 0x67,           // set VELNED MSG rate
+};
+
+// A single NAV-PVT message carries the position, velocity, fix and time of a navigation
+// solution, so one frame per fix replaces the four legacy messages above.
+static const uint8_t ubloxNavPvtMessages[] = {
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x02, 0x00, 0x0D, 0x46,           // disable POSLLH
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x03, 0x00, 0x0E, 0x48,           // disable STATUS
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x06, 0x00, 0x11, 0x4E,           // disable SOL
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x30, 0x00, 0x3B, 0xA2,           // disable SVINFO
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x12, 0x00, 0x1D, 0x66,           // disable VELNED
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51,           // set PVT MSG rate (every cycle)
+};
 
-    0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xC8, 0x00, 0x01, 0x00, 0x01, 0x00, 0xDE, 0x6A,             // set rate to 5Hz (measurement period: 200ms, navigation rate: 1 cycle)
+// CFG-RATE, the measurement period is filled in from gps_update_rate_hz by ubloxBuildRateMessage()
+#define UBLOX_RATE_MESSAGE_LENGTH 14
+static uint8_t ubloxRateMessage[UBLOX_RATE_MESSAGE_LENGTH] = {
+    0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xC8, 0x00, 0x01, 0x00, 0x01, 0x00, 0xDE, 0x6A,             // measurement period: 200ms, navigation rate: 1 cycle, GPS time
 };
 
 static const uint8_t ubloxAirborne[] = {
@@ -224,7 +244,7 @@ typedef enum {
 gpsData_t gpsData;
 
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gpsConfig_t, gpsConfig, PG_GPS_CONFIG, 0);
+PG_REGISTER_WITH_RESET_TEMPLATE(gpsConfig_t, gpsConfig, PG_GPS_CONFIG, 1);
 
 PG_RESET_TEMPLATE(gpsConfig_t, gpsConfig,
     .provider = GPS_NMEA,
@@ -233,7 +253,9 @@ PG_RESET_TEMPLATE(gpsConfig_t, gpsConfig,
     .autoBaud = GPS_AUTOBAUD_OFF,
     .gps_ublox_use_galileo = false,
     .gps_set_home_point_once = false,
-    .gps_use_3d_speed = false
+    .gps_use_3d_speed = false,
+    .gps_ublox_use_nav_pvt = false,
+    .gps_update_rate_hz = 5,
 );
 
 static void shiftPacketLog(void)
@@ -251,6 +273,11 @@ static bool gpsNewFrameNMEA(char c);
 #endif
 #ifdef USE_GPS_UBLOX
 static bool gpsNewFrameUBLOX(uint8_t data);
+void _update_checksum(uint8_t *data, uint16_t len, uint8_t *ck_a, uint8_t *ck_b);
+
+// the init and configuration sequence, stepped from gpsUpdate() while the GPS is initialising
+static coroutine_t ubloxInitCoroutine;
+static uint8_t ubloxInitEntry;
 #endif
 
 static void gpsSetState(gpsState_e state)
@@ -259,6 +286,11 @@ static void gpsSetState(gpsState_e state)
     gpsData.state_position = 0;
     gpsData.state_ts = millis();
     gpsData.messageState = GPS_MESSAGE_STATE_IDLE;
+#ifdef USE_GPS_UBLOX
+    if (state == GPS_INITIALIZING) {
+        COROUTINE_INIT(&ubloxInitCoroutine);
+    }
+#endif
 }
 
 void gpsInit(void)
@@ -362,99 +394,91 @@ void gpsInitNmea(void)
 #endif // USE_GPS_NMEA
 
 #ifdef USE_GPS_UBLOX
-void gpsInitUblox(void)
+static void ubloxBuildRateMessage(uint8_t rateHz)
 {
-    uint32_t now;
-    // UBX will run at the serial port's baudrate, it shouldn't be "autodetected". So here we force it to that rate
-
-    // Wait until GPS transmit buffer is empty
-    if (!isSerialTransmitBufferEmpty(gpsPort))
-        return;
+    const uint16_t measurementPeriodMs = 1000 / constrain(rateHz, GPS_UPDATE_RATE_HZ_MIN, GPS_UPDATE_RATE_HZ_MAX);
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    ubloxRateMessage[6] = measurementPeriodMs & 0xFF;
+    ubloxRateMessage[7] = measurementPeriodMs >> 8;
+    // the checksum covers everything between the sync chars and the checksum itself
+    _update_checksum(&ubloxRateMessage[2], UBLOX_RATE_MESSAGE_LENGTH - 4, &ck_a, &ck_b);
+    ubloxRateMessage[UBLOX_RATE_MESSAGE_LENGTH - 2] = ck_a;
+    ubloxRateMessage[UBLOX_RATE_MESSAGE_LENGTH - 1] = ck_b;
+}
 
+// Writes as much of the message as the transmit buffer takes, gpsData.state_position keeps the progress
+// between steps. Returns true once all of the message is written.
+static bool ubloxWriteMessage(const uint8_t *message, uint32_t length)
+{
+    const uint32_t count = MIN(length - gpsData.state_position, serialTxBytesFree(gpsPort));
 
-    switch (gpsData.state) {
-        case GPS_INITIALIZING:
-            now = millis();
-            if (now - gpsData.state_ts < GPS_BAUDRATE_CHANGE_DELAY)
-                return;
+    serialWriteBuf(gpsPort, message + gpsData.state_position, count);
+    gpsData.state_position += count;
+    if (gpsData.state_position < length) {
+        return false;
+    }
+    gpsData.state_position = 0;
+    return true;
+}
 
-            if (gpsData.state_position < GPS_INIT_ENTRIES) {
-                // try different speed to INIT
-                baudRate_e newBaudRateIndex = gpsInitData[gpsData.state_position].baudrateIndex;
+static coroutineState_e ubloxInitStep(timeUs_t currentTimeUs)
+{
+    COROUTINE_BEGIN(&ubloxInitCoroutine);
 
-                gpsData.state_ts = now;
+    // UBX will run at the serial port's baudrate, it shouldn't be "autodetected". So here we force it to that rate
+    for (ubloxInitEntry = 0; ubloxInitEntry < GPS_INIT_ENTRIES; ubloxInitEntry++) {
+        COROUTINE_DELAY_US(&ubloxInitCoroutine, currentTimeUs, GPS_BAUDRATE_CHANGE_DELAY * 1000);
+
+        // try different speed to INIT
+        if (lookupBaudRateIndex(serialGetBaudRate(gpsPort)) != gpsInitData[ubloxInitEntry].baudrateIndex) {
+            // change the rate if needed and wait a little
+            COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, isSerialTransmitBufferEmpty(gpsPort));
+            serialSetBaudRate(gpsPort, baudRates[gpsInitData[ubloxInitEntry].baudrateIndex]);
+            COROUTINE_DELAY_US(&ubloxInitCoroutine, currentTimeUs, GPS_BAUDRATE_CHANGE_DELAY * 1000);
+        }
 
-                if (lookupBaudRateIndex(serialGetBaudRate(gpsPort)) != newBaudRateIndex) {
-                    // change the rate if needed and wait a little
-                    serialSetBaudRate(gpsPort, baudRates[newBaudRateIndex]);
-                    return;
-                }
+        // print our FIXED init string for the baudrate we want to be at
+        serialPrint(gpsPort, gpsInitData[gpsData.baudrateIndex].ubx);
+        COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, isSerialTransmitBufferEmpty(gpsPort));
+    }
 
-                // print our FIXED init string for the baudrate we want to be at
-                serialPrint(gpsPort, gpsInitData[gpsData.baudrateIndex].ubx);
+    // we're now (hopefully) at the correct rate, switch to it
+    gpsSetState(GPS_CHANGE_BAUD);
+    serialSetBaudRate(gpsPort, baudRates[gpsInitData[gpsData.baudrateIndex].baudrateIndex]);
+    gpsSetState(GPS_CONFIGURE);
 
-                gpsData.state_position++;
-            } else {
-                // we're now (hopefully) at the correct rate, next state will switch to it
-                gpsSetState(GPS_CHANGE_BAUD);
-            }
-            break;
-        case GPS_CHANGE_BAUD:
-            serialSetBaudRate(gpsPort, baudRates[gpsInitData[gpsData.baudrateIndex].baudrateIndex]);
-            gpsSetState(GPS_CONFIGURE);
-            break;
-        case GPS_CONFIGURE:
+    // Either use specific config file for GPS or let dynamically upload config
+    if (gpsConfig()->autoConfig == GPS_AUTOCONFIG_ON) {
+        COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxInit, sizeof(ubloxInit)));
 
-            // Either use specific config file for GPS or let dynamically upload config
-            if ( gpsConfig()->autoConfig == GPS_AUTOCONFIG_OFF ) {
-                gpsSetState(GPS_RECEIVING_DATA);
-                break;
-            }
+        if (gpsConfig()->gps_ublox_use_nav_pvt) {
+            COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxNavPvtMessages, sizeof(ubloxNavPvtMessages)));
+        } else {
+            COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxLegacyMessages, sizeof(ubloxLegacyMessages)));
+        }
 
-            if (gpsData.messageState == GPS_MESSAGE_STATE_IDLE) {
-                gpsData.messageState++;
-            }
+        ubloxBuildRateMessage(gpsConfig()->gps_update_rate_hz);
+        COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxRateMessage, UBLOX_RATE_MESSAGE_LENGTH));
 
-            if (gpsData.messageState == GPS_MESSAGE_STATE_INIT) {
+        COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxSbasPrefix, UBLOX_SBAS_PREFIX_LENGTH));
+        COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxSbas[gpsConfig()->sbasMode].message, UBLOX_SBAS_MESSAGE_LENGTH));
 
-                if (gpsData.state_position < sizeof(ubloxInit)) {
-                    serialWrite(gpsPort, ubloxInit[gpsData.state_position]);
-                    gpsData.state_position++;
-                } else {
-                    gpsData.state_position = 0;
-                    gpsData.messageState++;
-                }
-            }
+        if (gpsConfig()->gps_ublox_use_galileo) {
+            COROUTINE_WAIT_UNTIL(&ubloxInitCoroutine, ubloxWriteMessage(ubloxGalileoInit, sizeof(ubloxGalileoInit)));
+        }
+    }
 
-            if (gpsData.messageState == GPS_MESSAGE_STATE_SBAS) {
-                if (gpsData.state_position < UBLOX_SBAS_PREFIX_LENGTH) {
-                    serialWrite(gpsPort, ubloxSbasPrefix[gpsData.state_position]);
-                    gpsData.state_position++;
-                } else if (gpsData.state_position < UBLOX_SBAS_PREFIX_LENGTH + UBLOX_SBAS_MESSAGE_LENGTH) {
-                    serialWrite(gpsPort, ubloxSbas[gpsConfig()->sbasMode].message[gpsData.state_position - UBLOX_SBAS_PREFIX_LENGTH]);
-                    gpsData.state_position++;
-                } else {
-                    gpsData.state_position = 0;
-                    gpsData.messageState++;
-                }
-            }
+    // ublox should be initialised, try receiving
+    gpsSetState(GPS_RECEIVING_DATA);
 
-            if (gpsData.messageState == GPS_MESSAGE_STATE_GALILEO) {
-                if ((gpsConfig()->gps_ublox_use_galileo) && (gpsData.state_position < sizeof(ubloxGalileoInit))) {
-                    serialWrite(gpsPort, ubloxGalileoInit[gpsData.state_position]);
-                    gpsData.state_position++;
-                } else {
-                    gpsData.state_position = 0;
-                    gpsData.messageState++;
-                }
-            }
+    COROUTINE_END(&ubloxInitCoroutine);
+}
 
-            if (gpsData.messageState >= GPS_MESSAGE_STATE_INITIALIZED) {
-                // ublox should be initialised, try receiving
-                gpsSetState(GPS_RECEIVING_DATA);
-            }
-            break;
-    }
+void gpsInitUblox(void)
+{
+    ubloxInitStep(micros());
 }
 #endif // USE_GPS_UBLOX
 
@@ -667,37 +691,7 @@ static uint32_t GPS_coord_to_degrees(char *coordinateString)
 }
 */
 
-// helper functions
 #ifdef USE_GPS_NMEA
-static uint32_t grab_fields(char *src, uint8_t mult)
-{                               // convert string to uint32
-    uint32_t i;
-    uint32_t tmp = 0;
-    int isneg = 0;
-    for (i = 0; src[i] != 0; i++) {
-        if ((i == 0) && (src[0] == '-')) { // detect negative sign
-            isneg = 1;
-            continue; // jump to next character if the first one was a negative sign
-        }
-        if (src[i] == '.') {
-            i++;
-            if (mult == 0) {
-                break;
-            } else {
-                src[i + mult] = 0;
-            }
-        }
-        tmp *= 10;
-        if (src[i] >= '0' && src[i] <= '9') {
-            tmp += src[i] - '0';
-        }
-        if (i >= 15) {
-            return 0; // out of bounds
-        }
-    }
-    return isneg ? -tmp : tmp;    // handle negative altitudes
-}
-
 typedef struct gpsDataNmea_s {
     int32_t latitude;
     int32_t longitude;
@@ -715,8 +709,8 @@ static bool gpsNewFrameNMEA(char c)
     static gpsDataNmea_t gps_Msg;
 
     uint8_t frameOK = 0;
-    static uint8_t param = 0, offset = 0, parity = 0;
-    static char string[15];
+    static uint8_t param = 0, parity = 0;
+    static nmeaField_t field;
     static uint8_t checksum_param, gps_frame = NO_FRAME;
     static uint8_t svMessageNum = 0;
     uint8_t svSatNum = 0, svPacketIdx = 0, svSatParam = 0;
@@ -724,20 +718,24 @@ static bool gpsNewFrameNMEA(char c)
     switch (c) {
         case '$':
             param = 0;
-            offset = 0;
             parity = 0;
+            checksum_param = 0;
+            nmeaFieldReset(&field);
             break;
         case ',':
         case '*':
-            string[offset] = 0;
-            if (param == 0) {       //frame identification
+            if (param == 0) {       //frame identification, talker and sentence packed in the last four characters
                 gps_frame = NO_FRAME;
-                if (0 == strcmp(string, "GPGGA") || 0 == strcmp(string, "GNGGA")) {
-                    gps_frame = FRAME_GGA;
-                } else if (0 == strcmp(string, "GPRMC") || 0 == strcmp(string, "GNRMC")) {
-                    gps_frame = FRAME_RMC;
-                } else if (0 == strcmp(string, "GPGSV")) {
-                    gps_frame = FRAME_GSV;
+                if (field.length == 5) {
+                    const char talker = field.first;
+                    const uint32_t sentence = field.text;
+                    if (talker == 'G' && (sentence == NMEA_ID('P', 'G', 'G', 'A') || sentence == NMEA_ID('N', 'G', 'G', 'A'))) {
+                        gps_frame = FRAME_GGA;
+                    } else if (talker == 'G' && (sentence == NMEA_ID('P', 'R', 'M', 'C') || sentence == NMEA_ID('N', 'R', 'M', 'C'))) {
+                        gps_frame = FRAME_RMC;
+                    } else if (talker == 'G' && sentence == NMEA_ID('P', 'G', 'S', 'V')) {
+                        gps_frame = FRAME_GSV;
+                    }
                 }
             }
 
@@ -747,50 +745,50 @@ static bool gpsNewFrameNMEA(char c)
             //          case 1:             // Time information
             //              break;
                         case 2:
-                            gps_Msg.latitude = GPS_coord_to_degrees(string);
+                            gps_Msg.latitude = nmeaFieldToDegrees(&field);
                             break;
                         case 3:
-                            if (string[0] == 'S')
+                            if (field.first == 'S')
                                 gps_Msg.latitude *= -1;
                             break;
                         case 4:
-                            gps_Msg.longitude = GPS_coord_to_degrees(string);
+                            gps_Msg.longitude = nmeaFieldToDegrees(&field);
                             break;
                         case 5:
-                            if (string[0] == 'W')
+                            if (field.first == 'W')
                                 gps_Msg.longitude *= -1;
                             break;
                         case 6:
-                            if (string[0] > '0') {
+                            if (field.length && field.first > '0') {
                                 ENABLE_STATE(GPS_FIX);
                             } else {
                                 DISABLE_STATE(GPS_FIX);
                             }
                             break;
                         case 7:
-                            gps_Msg.numSat = grab_fields(string, 0);
+                            gps_Msg.numSat = nmeaFieldToFixed(&field, 0);
                             break;
                         case 8:
-                            gps_Msg.hdop = grab_fields(string, 1) * 100;          // hdop
+                            gps_Msg.hdop = nmeaFieldToFixed(&field, 1) * 100;          // hdop
                             break;
                         case 9:
-                            gps_Msg.altitudeCm = grab_fields(string, 1) * 10;     // altitude in centimeters. Note: NMEA delivers altitude with 1 or 3 decimals. It's safer to cut at 0.1m and multiply by 10
+                            gps_Msg.altitudeCm = nmeaFieldToFixed(&field, 1) * 10;     // altitude in centimeters. Note: NMEA delivers altitude with 1 or 3 decimals. It's safer to cut at 0.1m and multiply by 10
                             break;
                     }
                     break;
                 case FRAME_RMC:        //************* GPRMC FRAME parsing
                     switch (param) {
                         case 1:
-                            gps_Msg.time = grab_fields(string, 2); // UTC time hhmmss.ss
+                            gps_Msg.time = nmeaFieldToFixed(&field, 2); // UTC time hhmmss.ss
                             break;
                         case 7:
-                            gps_Msg.speed = ((grab_fields(string, 1) * 5144L) / 1000L);    // speed in cm/s added by Mis
+                            gps_Msg.speed = ((nmeaFieldToFixed(&field, 1) * 5144L) / 1000L);    // speed in cm/s added by Mis
                             break;
                         case 8:
-                            gps_Msg.ground_course = (grab_fields(string, 1));      // ground course deg * 10
+                            gps_Msg.ground_course = (nmeaFieldToFixed(&field, 1));      // ground course deg * 10
                             break;
                         case 9:
-                            gps_Msg.date = grab_fields(string, 0); // date dd/mm/yy
+                            gps_Msg.date = nmeaFieldToFixed(&field, 0); // date dd/mm/yy
                             break;
                     }
                     break;
@@ -801,11 +799,11 @@ static bool gpsNewFrameNMEA(char c)
                             break; */
                         case 2:
                             // Message number
-                            svMessageNum = grab_fields(string, 0);
+                            svMessageNum = nmeaFieldToFixed(&field, 0);
                             break;
                         case 3:
                             // Total number of SVs visible
-                            GPS_numCh = grab_fields(string, 0);
+                            GPS_numCh = nmeaFieldToFixed(&field, 0);
                             break;
                     }
                     if (param < 4)
@@ -822,7 +820,7 @@ static bool gpsNewFrameNMEA(char c)
                         case 1:
                             // SV PRN number
                             GPS_svinfo_chn[svSatNum - 1]  = svSatNum;
-                            GPS_svinfo_svid[svSatNum - 1] = grab_fields(string, 0);
+                            GPS_svinfo_svid[svSatNum - 1] = nmeaFieldToFixed(&field, 0);
                             break;
                       /*case 2:
                             // Elevation, in degrees, 90 maximum
@@ -832,7 +830,7 @@ static bool gpsNewFrameNMEA(char c)
                             break; */
                         case 4:
                             // SNR, 00 through 99 dB (null when not tracking)
-                            GPS_svinfo_cno[svSatNum - 1] = grab_fields(string, 0);
+                            GPS_svinfo_cno[svSatNum - 1] = nmeaFieldToFixed(&field, 0);
                             GPS_svinfo_quality[svSatNum - 1] = 0; // only used by ublox
                             break;
                     }
@@ -843,7 +841,7 @@ static bool gpsNewFrameNMEA(char c)
             }
 
             param++;
-            offset = 0;
+            nmeaFieldReset(&field);
             if (c == '*')
                 checksum_param = 1;
             else
@@ -853,7 +851,9 @@ static bool gpsNewFrameNMEA(char c)
         case '\n':
             if (checksum_param) {   //parity checksum
                 shiftPacketLog();
-                uint8_t checksum = 16 * ((string[0] >= 'A') ? string[0] - 'A' + 10 : string[0] - '0') + ((string[1] >= 'A') ? string[1] - 'A' + 10 : string[1] - '0');
+                const char checksumHigh = (field.text >> 8) & 0xFF;
+                const char checksumLow = field.text & 0xFF;
+                uint8_t checksum = 16 * ((checksumHigh >= 'A') ? checksumHigh - 'A' + 10 : checksumHigh - '0') + ((checksumLow >= 'A') ? checksumLow - 'A' + 10 : checksumLow - '0');
                 if (checksum == parity) {
                     *gpsPacketLogChar = LOG_IGNORED;
                     GPS_packetCount++;
@@ -896,8 +896,10 @@ static bool gpsNewFrameNMEA(char c)
             checksum_param = 0;
             break;
         default:
-            if (offset < 15)
-                string[offset++] = c;
+            // sentences that are not decoded only need the parity until their checksum
+            if (param == 0 || gps_frame != NO_FRAME || checksum_param) {
+                nmeaFieldAddChar(&field, c);
+            }
             if (!checksum_param)
                 parity ^= c;
     }
@@ -986,6 +988,43 @@ typedef struct {
     ubx_nav_svinfo_channel channel[16];         // 16 satellites * 12 byte
 } ubx_nav_svinfo;
 
+typedef struct {
+    uint32_t time;              // GPS msToW
+    uint16_t year;              // UTC
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    uint8_t valid;              // Validity flags, see ubx_nav_pvt_valid_bits
+    uint32_t time_accuracy;     // ns
+    int32_t time_nsec;          // Fraction of second, -1e9..1e9
+    uint8_t fix_type;
+    uint8_t fix_status;         // Fix status flags, bit 0 is gnssFixOK
+    uint8_t fix_status2;
+    uint8_t satellites;
+    int32_t longitude;          // deg * 1e7
+    int32_t latitude;           // deg * 1e7
+    int32_t altitude_ellipsoid; // mm
+    int32_t altitudeMslMm;
+    uint32_t horizontal_accuracy;
+    uint32_t vertical_accuracy;
+    int32_t ned_north;          // mm/s
+    int32_t ned_east;
+    int32_t ned_down;
+    int32_t speed_2d;           // mm/s
+    int32_t heading_2d;         // Heading of motion, deg * 1e5
+    uint32_t speed_accuracy;
+    uint32_t heading_accuracy;
+    uint16_t position_DOP;      // * 100
+    uint8_t res[6];
+    int32_t heading_vehicle;
+    int16_t magnetic_declination;
+    uint16_t magnetic_declination_accuracy;
+} ubx_nav_pvt;
+
+STATIC_ASSERT(sizeof(ubx_nav_pvt) == 92, ubx_nav_pvt_size_mismatch);
+
 enum {
     PREAMBLE1 = 0xb5,
     PREAMBLE2 = 0x62,
@@ -997,6 +1036,7 @@ enum {
     MSG_POSLLH = 0x2,
     MSG_STATUS = 0x3,
     MSG_SOL = 0x6,
+    MSG_PVT = 0x7,
     MSG_VELNED = 0x12,
     MSG_SVINFO = 0x30,
     MSG_CFG_PRT = 0x00,
@@ -1020,6 +1060,12 @@ enum {
     NAV_STATUS_TIME_SECOND_VALID = 8
 } ubx_nav_status_bits;
 
+enum {
+    NAV_PVT_VALID_DATE = 1,
+    NAV_PVT_VALID_TIME = 2,
+    NAV_PVT_FULLY_RESOLVED = 4
+} ubx_nav_pvt_valid_bits;
+
 // Packet checksum accumulators
 static uint8_t _ck_a;
 static uint8_t _ck_b;
@@ -1064,10 +1110,11 @@ static union {
     ubx_nav_solution solution;
     ubx_nav_velned velned;
     ubx_nav_svinfo svinfo;
+    ubx_nav_pvt pvt;
     uint8_t bytes[UBLOX_PAYLOAD_SIZE];
 } _buffer;
 
-void _update_checksum(uint8_t *data, uint8_t len, uint8_t *ck_a, uint8_t *ck_b)
+void _update_checksum(uint8_t *data, uint16_t len, uint8_t *ck_a, uint8_t *ck_b)
 {
     while (len--) {
         *ck_a += *data;
@@ -1126,6 +1173,40 @@ static bool UBLOX_parse_gps(void)
         gpsSol.groundCourse = (uint16_t) (_buffer.velned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
         _new_speed = true;
         break;
+    case MSG_PVT:
+        // decoded straight from the receive buffer, a complete solution in one frame
+        *gpsPacketLogChar = LOG_UBLOX_PVT;
+        next_fix = (_buffer.pvt.fix_status & NAV_STATUS_FIX_VALID) && (_buffer.pvt.fix_type == FIX_3D);
+        if (next_fix) {
+            ENABLE_STATE(GPS_FIX);
+        } else {
+            DISABLE_STATE(GPS_FIX);
+        }
+        gpsSol.llh.lon = _buffer.pvt.longitude;
+        gpsSol.llh.lat = _buffer.pvt.latitude;
+        gpsSol.llh.altCm = _buffer.pvt.altitudeMslMm / 10;  //alt in cm
+        gpsSol.numSat = _buffer.pvt.satellites;
+        gpsSol.hdop = _buffer.pvt.position_DOP;     // NAV-PVT has no HDOP, PDOP is the closest
+        gpsSol.groundSpeed = _buffer.pvt.speed_2d / 10;    // cm/s
+        gpsSol.speed3d = (uint16_t)(sqrtf(sq((float)_buffer.pvt.speed_2d) + sq((float)_buffer.pvt.ned_down)) / 10);   // cm/s
+        gpsSol.groundCourse = (uint16_t) (_buffer.pvt.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
+#ifdef USE_RTC_TIME
+        //set clock, when gps time is available
+        if (!rtcHasTime() && (_buffer.pvt.valid & NAV_PVT_VALID_DATE) && (_buffer.pvt.valid & NAV_PVT_VALID_TIME) && (_buffer.pvt.valid & NAV_PVT_FULLY_RESOLVED)) {
+            dateTime_t dt = {
+                .year = _buffer.pvt.year,
+                .month = _buffer.pvt.month,
+                .day = _buffer.pvt.day,
+                .hours = _buffer.pvt.hour,
+                .minutes = _buffer.pvt.min,
+                .seconds = _buffer.pvt.sec,
+                .millis = (_buffer.pvt.time_nsec > 0) ? _buffer.pvt.time_nsec / 1000000 : 0,
+            };
+            rtcSetDateTime(&dt);
+        }
+#endif
+        _new_speed = _new_position = false;
+        return true;
     case MSG_SVINFO:
         *gpsPacketLogChar = LOG_UBLOX_SVINFO;
         GPS_numCh = _buffer.svinfo.numCh;
@@ -1173,21 +1254,17 @@ static bool gpsNewFrameUBLOX(uint8_t data)
         case 2: // Class
             _step++;
             _class = data;
-            _ck_b = _ck_a = data;   // reset the checksum accumulators
             break;
         case 3: // Id
             _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
             _msg_id = data;
             break;
         case 4: // Payload length (part 1)
             _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
             _payload_length = data; // payload length low byte
             break;
         case 5: // Payload length (part 2)
             _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
             _payload_length += (uint16_t)(data << 8);
             if (_payload_length > UBLOX_PAYLOAD_SIZE) {
                 _skip_packet = true;
@@ -1198,7 +1275,6 @@ static bool gpsNewFrameUBLOX(uint8_t data)
             }
             break;
         case 6:
-            _ck_b += (_ck_a += data);       // checksum byte
             if (_payload_counter < UBLOX_PAYLOAD_SIZE) {
                 _buffer.bytes[_payload_counter] = data;
             }
@@ -1208,6 +1284,17 @@ static bool gpsNewFrameUBLOX(uint8_t data)
             break;
         case 7:
             _step++;
+            // the checksum is run once over the whole frame rather than per byte received,
+            // frames too large for the buffer cannot be checked and are skipped
+            if (_payload_length > UBLOX_PAYLOAD_SIZE) {
+                break;
+            }
+            {
+                uint8_t header[4] = { _class, _msg_id, _payload_length & 0xFF, _payload_length >> 8 };
+                _ck_a = _ck_b = 0;
+                _update_checksum(header, sizeof(header), &_ck_a, &_ck_b);
+                _update_checksum(_buffer.bytes, _payload_length, &_ck_a, &_ck_b);
+            }
             if (_ck_a != data) {
                 _skip_packet = true;          // bad checksum
                 gpsData.errors++;
@@ -1218,7 +1305,7 @@ static bool gpsNewFrameUBLOX(uint8_t data)
 
             shiftPacketLog();
 
-            if (_ck_b != data) {
+            if (_payload_length <= UBLOX_PAYLOAD_SIZE && _ck_b != data) {
                 *gpsPacketLogChar = LOG_ERROR;
                 gpsData.errors++;
                 break;              // bad checksum
@@ -1271,8 +1358,7 @@ float GPS_scaleLonDown = 1.0f;  // this is used to offset the shrinking longitud
 
 void GPS_calc_longitude_scaling(int32_t lat)
 {
-    float rads = (fabsf((float)lat) / 10000000.0f) * 0.0174532925f;
-    GPS_scaleLonDown = cos_approx(rads);
+    GPS_scaleLonDown = gpsLongitudeScale(lat);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -1327,19 +1413,14 @@ void GPS_reset_home_position(void)
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-#define DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS 1.113195f
-#define TAN_89_99_DEGREES 5729.57795f
 // Get distance between two points in cm
 // Get bearing from pos1 to pos2, returns an 1deg = 100 precision
 void GPS_distance_cm_bearing(int32_t *currentLat1, int32_t *currentLon1, int32_t *destinationLat2, int32_t *destinationLon2, uint32_t *dist, int32_t *bearing)
 {
-    float dLat = *destinationLat2 - *currentLat1; // difference of latitude in 1/10 000 000 degrees
-    float dLon = (float)(*destinationLon2 - *currentLon1) * GPS_scaleLonDown;
-    *dist = sqrtf(sq(dLat) + sq(dLon)) * DISTANCE_BETWEEN_TWO_LONGITUDE_POINTS_AT_EQUATOR_IN_HUNDREDS_OF_KILOMETERS;
-
-    *bearing = 9000.0f + atan2_approx(-dLat, dLon) * TAN_89_99_DEGREES;      // Convert the output radians to 100xdeg
-    if (*bearing < 0)
-        *bearing += 36000;
+    gpsLocalOffset_t offset;
+    gpsLocalOffset(*currentLat1, *currentLon1, *destinationLat2, *destinationLon2, GPS_scaleLonDown, &offset);
+    *dist = gpsLocalDistanceCm(&offset);
+    *bearing = gpsLocalBearing(&offset);
 }
 
 void GPS_calculateDistanceAndDirectionToHome(void)
@@ -1358,6 +1439,17 @@ void GPS_calculateDistanceAndDirectionToHome(void)
 
 void onGpsNewData(void)
 {
+    const gpsSample_t sample = {
+        .lat = gpsSol.llh.lat,
+        .lon = gpsSol.llh.lon,
+        .altCm = gpsSol.llh.altCm,
+        .groundSpeed = gpsSol.groundSpeed,
+        .groundCourse = gpsSol.groundCourse,
+        .numSat = gpsSol.numSat,
+        .fix = STATE(GPS_FIX),
+    };
+    samplePublish(SAMPLE_GPS, &sample, micros());
+
     if (!(STATE(GPS_FIX) && gpsSol.numSat >= 5)) {
         return;
     }
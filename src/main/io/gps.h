@@ -68,6 +68,11 @@ typedef enum {
 
 #define GPS_BAUDRATE_MAX GPS_BAUDRATE_9600
 
+// Navigation solution rate set by the UBLOX auto config, NAV-PVT needs a u-blox 7 or later.
+// The legacy messages take ~200 bytes per fix, more than 57600 baud can carry at 25Hz.
+#define GPS_UPDATE_RATE_HZ_MIN 1
+#define GPS_UPDATE_RATE_HZ_MAX 25
+
 typedef struct gpsConfig_s {
     gpsProvider_e provider;
     sbasMode_e sbasMode;
@@ -76,6 +81,8 @@ typedef struct gpsConfig_s {
     uint8_t gps_ublox_use_galileo;
     uint8_t gps_set_home_point_once;
     uint8_t gps_use_3d_speed;
+    uint8_t gps_ublox_use_nav_pvt;
+    uint8_t gps_update_rate_hz;
 } gpsConfig_t;
 
 PG_DECLARE(gpsConfig_t, gpsConfig);
@@ -103,10 +110,6 @@ typedef struct gpsSolutionData_s {
 
 typedef enum {
     GPS_MESSAGE_STATE_IDLE = 0,
-    GPS_MESSAGE_STATE_INIT,
-    GPS_MESSAGE_STATE_SBAS,
-    GPS_MESSAGE_STATE_GALILEO,
-    GPS_MESSAGE_STATE_INITIALIZED,
     GPS_MESSAGE_STATE_AIRBORNE,
     GPS_MESSAGE_STATE_ENTRY_COUNT
 } gpsMessageState_e;
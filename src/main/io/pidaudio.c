@@ -35,8 +35,18 @@
 
 #include "io/pidaudio.h"
 
+// The tone target is worked out at this rate, and the output steps towards it on every loop in between
+#define PID_AUDIO_UPDATE_HZ 500
+#define PID_AUDIO_TONE_SHIFT 8  // fractional bits of the interpolated tone
+
 static bool pidAudioEnabled = false;
 
+static uint16_t pidAudioDecimation = 1;
+static uint16_t pidAudioCount;
+static int32_t pidAudioTone;        // current tone, fixed point
+static int32_t pidAudioToneStep;    // change of the tone per loop, fixed point
+static uint8_t pidAudioToneOutput;  // tone last written to the output
+
 static pidAudioModes_e pidAudioMode = PID_AUDIO_PIDSUM_XY;
 
 void pidAudioInit(void)
@@ -46,7 +56,14 @@ void pidAudioInit(void)
 
 void pidAudioStart(void)
 {
+    pidAudioDecimation = MAX(lrintf(pidGetPidFrequency() / PID_AUDIO_UPDATE_HZ), 1);
+    pidAudioCount = 0;
+    pidAudioTone = TONE_MID << PID_AUDIO_TONE_SHIFT;
+    pidAudioToneStep = 0;
+    pidAudioToneOutput = TONE_MID;
+
     audioGenerateWhiteNoise();
+    audioPlayTone(pidAudioToneOutput);
 }
 
 void pidAudioStop(void)
@@ -81,30 +98,45 @@ void FAST_CODE_NOINLINE pidAudioUpdate(void)
         return;
     }
 
-    uint8_t tone = TONE_MID;
-
-    switch (pidAudioMode) {
-    case PID_AUDIO_PIDSUM_X:
-        {
-            const uint32_t pidSumX = MIN(fabsf(pidData[FD_ROLL].Sum), PIDSUM_LIMIT);
-            tone = scaleRange(pidSumX, 0, PIDSUM_LIMIT, TONE_MAX, TONE_MIN);
-            break;
-        }
-    case PID_AUDIO_PIDSUM_Y:
-        {
-            const uint32_t pidSumY = MIN(fabsf(pidData[FD_PITCH].Sum), PIDSUM_LIMIT);
-            tone = scaleRange(pidSumY, 0, PIDSUM_LIMIT, TONE_MAX, TONE_MIN);
+    if (pidAudioCount == 0) {
+        pidAudioCount = pidAudioDecimation;
+
+        uint8_t tone = TONE_MID;
+
+        switch (pidAudioMode) {
+        case PID_AUDIO_PIDSUM_X:
+            {
+                const uint32_t pidSumX = MIN(fabsf(pidData[FD_ROLL].Sum), PIDSUM_LIMIT);
+                tone = scaleRange(pidSumX, 0, PIDSUM_LIMIT, TONE_MAX, TONE_MIN);
+                break;
+            }
+        case PID_AUDIO_PIDSUM_Y:
+            {
+                const uint32_t pidSumY = MIN(fabsf(pidData[FD_PITCH].Sum), PIDSUM_LIMIT);
+                tone = scaleRange(pidSumY, 0, PIDSUM_LIMIT, TONE_MAX, TONE_MIN);
+                break;
+            }
+        case PID_AUDIO_PIDSUM_XY:
+            {
+                const uint32_t pidSumXY = MIN((fabsf(pidData[FD_ROLL].Sum) + fabsf(pidData[FD_PITCH].Sum)) / 2, PIDSUM_LIMIT);
+                tone = scaleRange(pidSumXY, 0, PIDSUM_LIMIT, TONE_MAX, TONE_MIN);
+                break;
+            }
+        default:
             break;
         }
-    case PID_AUDIO_PIDSUM_XY:
-        {
-            const uint32_t pidSumXY = MIN((fabsf(pidData[FD_ROLL].Sum) + fabsf(pidData[FD_PITCH].Sum)) / 2, PIDSUM_LIMIT);
-            tone = scaleRange(pidSumXY, 0, PIDSUM_LIMIT, TONE_MAX, TONE_MIN);
-            break;
-        }
-    default:
-        break;
+
+        // reach the new target by the time the next one is worked out
+        pidAudioToneStep = ((tone << PID_AUDIO_TONE_SHIFT) - pidAudioTone) / pidAudioDecimation;
     }
+    pidAudioCount--;
 
-    audioPlayTone(tone);
+    pidAudioTone += pidAudioToneStep;
+
+    // only touch the timer when the audible tone actually changes
+    const uint8_t toneOutput = (pidAudioTone + (1 << (PID_AUDIO_TONE_SHIFT - 1))) >> PID_AUDIO_TONE_SHIFT;
+    if (toneOutput != pidAudioToneOutput) {
+        pidAudioToneOutput = toneOutput;
+        audioPlayTone(toneOutput);
+    }
 }
@@ -151,9 +151,13 @@ static void runcamDeviceSendPacket(runcamDevice_t *device, uint8_t command, uint
 }
 
 // a common way to send a packet to device, and get response from the device.
+// Requests are pipelined, the packet goes out straight away even if earlier requests are still waiting
+// for their responses. The device answers in order, so the responses are matched up in queue order.
 static void runcamDeviceSendRequestAndWaitingResp(runcamDevice_t *device, uint8_t commandID, uint8_t *paramData, uint8_t paramDataLen, timeMs_t tiemout, int maxRetryTimes, void *userInfo, rcdeviceRespParseFunc parseFunc)
 {
-    runcamDeviceFlushRxBuffer(device);
+    if (waitingResponseQueue.itemCount == 0) {
+        runcamDeviceFlushRxBuffer(device);
+    }
 
     rcdeviceResponseParseContext_t responseCtx;
     memset(&responseCtx, 0, sizeof(rcdeviceResponseParseContext_t));
@@ -190,21 +194,6 @@ static void runcamDeviceParseV1DeviceInfo(rcdeviceResponseParseContext_t *ctx)
     device->isReady = true;
 }
 
-static uint8_t crc8HighFirst(uint8_t *ptr, uint8_t len)
-{
-    uint8_t crc = 0x00;
-    while (len--) {
-        crc ^= *ptr++;
-        for (unsigned i = 8; i > 0; --i) {
-            if (crc & 0x80)
-                crc = (crc << 1) ^ 0x31;
-            else
-                crc = (crc << 1);
-        }
-    }
-    return (crc);
-}
-
 // for the rcsplits that firmware <= 1.1.0
 static void runcamSplitSendCommand(runcamDevice_t *device, uint8_t argument)
 {
@@ -219,7 +208,7 @@ static void runcamSplitSendCommand(runcamDevice_t *device, uint8_t argument)
     uart_buffer[1] = RCSPLIT_PACKET_CMD_CTRL;
     uart_buffer[2] = argument;
     uart_buffer[3] = RCSPLIT_PACKET_TAIL;
-    crc = crc8HighFirst(uart_buffer, 4);
+    crc = crc8_poly_0x31_update(0, uart_buffer, 4);
 
     // build up a full request [header]+[command]+[argument]+[crc]+[tail]
     uart_buffer[3] = crc;
@@ -232,7 +221,9 @@ static void runcamSplitSendCommand(runcamDevice_t *device, uint8_t argument)
 static void runcamDeviceParseV2DeviceInfo(rcdeviceResponseParseContext_t *ctx)
 {
     if (ctx->result != RCDEVICE_RESP_SUCCESS) {
-        runcamDeviceFlushRxBuffer(ctx->device);
+        if (waitingResponseQueue.itemCount == 1) {
+            runcamDeviceFlushRxBuffer(ctx->device);
+        }
 
         rcdeviceResponseParseContext_t responseCtx;
         memset(&responseCtx, 0, sizeof(rcdeviceResponseParseContext_t));
@@ -327,15 +318,39 @@ void runcamDeviceSimulate5KeyOSDCableButtonRelease(runcamDevice_t *device, rcdev
     runcamDeviceSendRequestAndWaitingResp(device, RCDEVICE_PROTOCOL_COMMAND_5KEY_SIMULATION_RELEASE, NULL, 0, 400, 2, NULL, parseFunc);
 }
 
+static void runcamDeviceResendRequest(rcdeviceResponseParseContext_t *respCtx)
+{
+    if (respCtx->protocolVersion == RCDEVICE_PROTOCOL_VERSION_1_0) {
+        runcamDeviceSendPacket(respCtx->device, respCtx->command, respCtx->paramData, respCtx->paramDataLen);
+    } else if (respCtx->protocolVersion == RCDEVICE_PROTOCOL_RCSPLIT_VERSION) {
+        runcamSplitSendCommand(respCtx->device, respCtx->command);
+    }
+}
+
+// drop the front of the queue, the timeout of the next request starts once it's the one being answered
+static rcdeviceResponseParseContext_t* rcdeviceRespCtxQueueNext(timeMs_t currentTimeMs)
+{
+    rcdeviceRespCtxQueueShift(&waitingResponseQueue);
+
+    rcdeviceResponseParseContext_t *respCtx = rcdeviceRespCtxQueuePeekFront(&waitingResponseQueue);
+    if (respCtx != NULL && respCtx->timeoutTimestamp != 0) {
+        respCtx->timeoutTimestamp = currentTimeMs + respCtx->timeout;
+    }
+
+    return respCtx;
+}
+
 static rcdeviceResponseParseContext_t* getWaitingResponse(timeMs_t currentTimeMs)
 {
     rcdeviceResponseParseContext_t *respCtx = rcdeviceRespCtxQueuePeekFront(&waitingResponseQueue);
     while (respCtx != NULL && respCtx->timeoutTimestamp != 0 && currentTimeMs > respCtx->timeoutTimestamp) {
         if (respCtx->maxRetryTimes > 0) {
-            if (respCtx->protocolVersion == RCDEVICE_PROTOCOL_VERSION_1_0) {
-                runcamDeviceSendPacket(respCtx->device, respCtx->command, respCtx->paramData, respCtx->paramDataLen);
-            } else if (respCtx->protocolVersion == RCDEVICE_PROTOCOL_RCSPLIT_VERSION) {
-                runcamSplitSendCommand(respCtx->device, respCtx->command);
+            // the responses to the requests behind this one may be lost or out of step as well, so
+            // start over and send all of them again in order
+            runcamDeviceFlushRxBuffer(respCtx->device);
+            for (unsigned i = 0, pos = waitingResponseQueue.headPos; i < waitingResponseQueue.itemCount; i++) {
+                runcamDeviceResendRequest(&waitingResponseQueue.buffer[pos]);
+                pos = (pos + 1 < MAX_WAITING_RESPONSES) ? pos + 1 : 0;
             }
 
             respCtx->recvRespLen = 0;
@@ -350,8 +365,7 @@ static rcdeviceResponseParseContext_t* getWaitingResponse(timeMs_t currentTimeMs
             }
 
             // dequeue and get next waiting response context
-            rcdeviceRespCtxQueueShift(&waitingResponseQueue);
-            respCtx = rcdeviceRespCtxQueuePeekFront(&waitingResponseQueue);
+            respCtx = rcdeviceRespCtxQueueNext(currentTimeMs);
         }
     }
 
@@ -382,17 +396,14 @@ void rcdeviceReceive(timeUs_t currentTimeUs)
         // if data received done, trigger callback to parse response data, and update rcdevice state
         if (respCtx->recvRespLen == respCtx->expectedRespLen) {
             if (respCtx->protocolVersion == RCDEVICE_PROTOCOL_VERSION_1_0) {
-                uint8_t crc = 0;
-                for (int i = 0; i < respCtx->recvRespLen; i++) {
-                    crc = crc8_dvb_s2(crc, respCtx->recvBuf[i]);
-                }
+                const uint8_t crc = crc8_dvb_s2_update(0, respCtx->recvBuf, respCtx->recvRespLen);
 
                 respCtx->result = (crc == 0) ? RCDEVICE_RESP_SUCCESS : RCDEVICE_RESP_INCORRECT_CRC;
             } else if (respCtx->protocolVersion == RCDEVICE_PROTOCOL_RCSPLIT_VERSION) {
                 if (respCtx->recvBuf[0] == RCSPLIT_PACKET_HEADER && respCtx->recvBuf[1] == RCSPLIT_PACKET_CMD_CTRL && respCtx->recvBuf[2] == 0xFF && respCtx->recvBuf[4] == RCSPLIT_PACKET_TAIL) {
                     uint8_t crcFromPacket = respCtx->recvBuf[3];
                     respCtx->recvBuf[3] = respCtx->recvBuf[4]; // move packet tail field to crc field, and calc crc with first 4 bytes
-                    uint8_t crc = crc8HighFirst(respCtx->recvBuf, 4);
+                    uint8_t crc = crc8_poly_0x31_update(0, respCtx->recvBuf, 4);
                     
                     respCtx->result = crc == crcFromPacket ? RCDEVICE_RESP_SUCCESS : RCDEVICE_RESP_INCORRECT_CRC;
                 } else {
@@ -405,7 +416,11 @@ void rcdeviceReceive(timeUs_t currentTimeUs)
             }
 
             if (respCtx->result == RCDEVICE_RESP_SUCCESS) {
-                rcdeviceRespCtxQueueShift(&waitingResponseQueue);
+                rcdeviceRespCtxQueueNext(millis());
+            } else {
+                // don't wait for the timeout, resend on the next pass
+                respCtx->recvRespLen = 0;
+                respCtx->timeoutTimestamp = millis() - 1;
             }
         }
     }
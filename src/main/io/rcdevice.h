@@ -115,7 +115,7 @@ typedef struct runcamDevice_s {
     bool isReady;
 } runcamDevice_t;
 
-#define MAX_WAITING_RESPONSES 1
+#define MAX_WAITING_RESPONSES 4 // requests in flight at once, see runcamDeviceSendRequestAndWaitingResp()
 
 typedef enum {
     RCDEVICE_RESP_SUCCESS = 0,
@@ -53,6 +53,7 @@ rcdeviceSwitchState_t switchStates[BOXCAMERA3 - BOXCAMERA1 + 1];
 bool rcdeviceInMenu = false;
 bool isButtonPressed = false;
 bool waitingDeviceResponse = false;
+static bool isReleaseQueued = false; // the release goes out behind the press, without waiting for its response
 
 
 static bool isFeatureSupported(uint8_t feature)
@@ -133,6 +134,10 @@ static void rcdeviceSimulationOSDCableFailed(rcdeviceResponseParseContext_t *ctx
 
 static void rcdeviceSimulationRespHandle(rcdeviceResponseParseContext_t *ctx)
 {
+    if (ctx->command == RCDEVICE_PROTOCOL_COMMAND_5KEY_SIMULATION_RELEASE) {
+        isReleaseQueued = false;
+    }
+
     if (ctx->result != RCDEVICE_RESP_SUCCESS) {
         rcdeviceSimulationOSDCableFailed(ctx);
         waitingDeviceResponse = false;
@@ -241,9 +246,10 @@ static void rcdevice5KeySimulationProcess(timeUs_t currentTimeUs)
     }
 
     if (isButtonPressed) {
-        if (IS_MID(YAW) && IS_MID(PITCH) && IS_MID(ROLL)) {
+        if (IS_MID(YAW) && IS_MID(PITCH) && IS_MID(ROLL) && !isReleaseQueued) {
             rcdeviceSend5KeyOSDCableSimualtionEvent(RCDEVICE_CAM_KEY_RELEASE);
             waitingDeviceResponse = true;
+            isReleaseQueued = true;
         }
     } else {
         if (waitingDeviceResponse) {
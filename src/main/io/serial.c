@@ -28,6 +28,7 @@
 
 #include "cli/cli.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/time.h"
@@ -510,9 +511,26 @@ void waitForSerialPortToFinishTransmitting(serialPort_t *serialPort)
 
 #if defined(USE_GPS) || defined(USE_SERIAL_PASSTHROUGH)
 // Default data consumer for serialPassThrough.
-static void nopConsumer(uint8_t data)
+#define SERIAL_PASSTHROUGH_BLOCK_SIZE 64
+
+// Forwards what one port has received to the other in blocks, as much as its transmit buffer takes
+static void serialPassthroughForward(serialPort_t *from, serialPort_t *to, serialConsumer *consumer)
 {
-    UNUSED(data);
+    uint8_t block[SERIAL_PASSTHROUGH_BLOCK_SIZE];
+
+    const uint32_t count = serialReadBuf(from, block, MIN(serialTxBytesFree(to), (uint32_t)sizeof(block)));
+    if (!count) {
+        return;
+    }
+
+    LED0_ON;
+    serialWriteBuf(to, block, count);
+    if (consumer) {
+        for (uint32_t i = 0; i < count; i++) {
+            consumer(block[i]);
+        }
+    }
+    LED0_OFF;
 }
 
 /*
@@ -525,11 +543,6 @@ void serialPassthrough(serialPort_t *left, serialPort_t *right, serialConsumer *
     waitForSerialPortToFinishTransmitting(left);
     waitForSerialPortToFinishTransmitting(right);
 
-    if (!leftC)
-        leftC = &nopConsumer;
-    if (!rightC)
-        rightC = &nopConsumer;
-
     LED0_OFF;
     LED1_OFF;
 
@@ -541,24 +554,8 @@ void serialPassthrough(serialPort_t *left, serialPort_t *right, serialConsumer *
         // implement a guard interval and check for `+++` as an escape sequence
         // to return to CLI command mode.
         // https://en.wikipedia.org/wiki/Escape_sequence#Modem_control
-        if (serialRxBytesWaiting(left)) {
-            LED0_ON;
-            uint8_t c = serialRead(left);
-            // Make sure there is space in the tx buffer
-            while (!serialTxBytesFree(right));
-            serialWrite(right, c);
-            leftC(c);
-            LED0_OFF;
-         }
-         if (serialRxBytesWaiting(right)) {
-             LED0_ON;
-             uint8_t c = serialRead(right);
-             // Make sure there is space in the tx buffer
-             while (!serialTxBytesFree(left));
-             serialWrite(left, c);
-             rightC(c);
-             LED0_OFF;
-         }
-     }
- }
+        serialPassthroughForward(left, right, leftC);
+        serialPassthroughForward(right, left, rightC);
+    }
+}
  #endif
@@ -116,6 +116,9 @@ void transponderInit(void)
 void transponderStopRepeating(void)
 {
     transponderRepeat = false;
+#ifdef TRANSPONDER_IR_REPEAT_IN_HARDWARE
+    transponderIrStopRepeating();
+#endif
 }
 
 void transponderStartRepeating(void)
@@ -124,6 +127,18 @@ void transponderStartRepeating(void)
         return;
     }
 
+#ifdef TRANSPONDER_IR_REPEAT_IN_HARDWARE
+    // the DMA repeats the packet by itself, the task has nothing left to do
+#ifdef REDUCE_TRANSPONDER_CURRENT_DRAW_WHEN_USB_CABLE_PRESENT
+    if (!usbCableIsInserted())
+#endif
+    {
+        if (transponderIrStartRepeating()) {
+            return;
+        }
+    }
+#endif
+
     transponderRepeat = true;
 }
 
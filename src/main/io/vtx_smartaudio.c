@@ -34,6 +34,8 @@
 #include "cms/cms.h"
 #include "cms/cms_menu_vtx_smartaudio.h"
 
+#include "common/coroutine.h"
+#include "common/crc.h"
 #include "common/maths.h"
 #include "common/printf.h"
 #include "common/utils.h"
@@ -141,34 +143,6 @@ bool saDeferred = true; // saCms variable?
 #define SA_MAX_RCVLEN 21
 static uint8_t sa_rbuf[SA_MAX_RCVLEN + 4]; // XXX delete 4 byte guard
 
-//
-// CRC8 computations
-//
-
-#define POLYGEN 0xd5
-
-static uint8_t CRC8(const uint8_t *data, const int8_t len)
-{
-    uint8_t crc = 0; /* start with 0 so first byte can be 'xored' in */
-    uint8_t currByte;
-
-    for (int i = 0 ; i < len ; i++) {
-        currByte = data[i];
-
-        crc ^= currByte; /* XOR-in the next input byte */
-
-        for (int i = 0; i < 8; i++) {
-            if ((crc & 0x80) != 0) {
-                crc = (uint8_t)((crc << 1) ^ POLYGEN);
-            } else {
-                crc <<= 1;
-            }
-        }
-    }
-    return crc;
-}
-
-
 #ifdef USE_SMARTAUDIO_DPRINTF
 static void saPrintSettings(void)
 {
@@ -474,7 +448,7 @@ static void saReceiveFrame(uint8_t c)
         break;
 
     case S_WAITCRC:
-        if (CRC8(sa_rbuf, 2 + len) == c) {
+        if (crc8_dvb_s2_update(0, sa_rbuf, 2 + len) == c) {
             // Got a response
             saProcessResponse(sa_rbuf, len + 2);
             saStat.pktrcvd++;
@@ -558,7 +532,7 @@ typedef struct saCmdQueue_s {
     int len;
 } saCmdQueue_t;
 
-#define SA_QSIZE 6     // 1 heartbeat (GetSettings) + 2 commands + 1 slack
+#define SA_QSIZE 8     // 2 heartbeats (GetSettings) + 5 coalesced commands + 1 slack
 static saCmdQueue_t sa_queue[SA_QSIZE];
 static uint8_t sa_qhead = 0;
 static uint8_t sa_qtail = 0;
@@ -573,9 +547,51 @@ static bool saQueueFull(void)
     return ((sa_qhead + 1) % SA_QSIZE) == sa_qtail;
 }
 
+// A setting that is already waiting in the queue is updated in place instead
+// of being queued again, so a burst of changes (e.g. stepping through power
+// levels from the OSD) results in a single frame per setting on the wire.
+// Frequency frames are only merged when they share a buffer, as the
+// user-freq workaround in saSetFreq() relies on two distinct frames, and a
+// GetSettings heartbeat only merges with the most recently queued frame so it
+// keeps its position between those.
+static bool saQueueCoalesce(uint8_t *buf, int len)
+{
+    const uint8_t cmd = buf[2];
+
+    for (uint8_t i = sa_qtail; i != sa_qhead; i = (i + 1) % SA_QSIZE) {
+        saCmdQueue_t *entry = &sa_queue[i];
+
+        if (entry->buf[2] != cmd) {
+            continue;
+        }
+
+        switch (cmd) {
+        case SACMD(SA_CMD_GET_SETTINGS):
+            if ((i + 1) % SA_QSIZE != sa_qhead) {
+                continue;
+            }
+            break;
+        case SACMD(SA_CMD_SET_FREQ):
+            if (entry->buf != buf) {
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+
+        entry->buf = buf;
+        entry->len = len;
+
+        return true;
+    }
+
+    return false;
+}
+
 static void saQueueCmd(uint8_t *buf, int len)
 {
-    if (saQueueFull()) {
+    if (saQueueCoalesce(buf, len) || saQueueFull()) {
         return;
     }
 
@@ -624,7 +640,7 @@ void saSetFreq(uint16_t freq)
 
     buf[4] = (freq >> 8) & 0xff;
     buf[5] = freq & 0xff;
-    buf[6] = CRC8(buf, 6);
+    buf[6] = crc8_dvb_s2_update(0, buf, 6);
 
     // Need to work around apparent SmartAudio bug when going from 'channel'
     // to 'user-freq' mode, where the set-freq command will fail if the freq
@@ -634,7 +650,7 @@ void saSetFreq(uint16_t freq)
         const uint16_t switchFreq = freq + ((freq == VTX_SMARTAUDIO_MAX_FREQUENCY_MHZ) ? -1 : 1);
         switchBuf[4] = (switchFreq >> 8);
         switchBuf[5] = switchFreq & 0xff;
-        switchBuf[6] = CRC8(switchBuf, 6);
+        switchBuf[6] = crc8_dvb_s2_update(0, switchBuf, 6);
 
         saQueueCmd(switchBuf, 7);
 
@@ -670,7 +686,7 @@ void saSetMode(int mode)
     }
     dprintf(("saSetMode(0x%x): pir=%s por=%s pitdsbl=%s %s\r\n", mode, (mode & 1) ? "on " : "off", (mode & 2) ? "on " : "off",
             (mode & 4)? "on " : "off", (mode & 8) ? "locked" : "unlocked"));
-    buf[5] = CRC8(buf, 5);
+    buf[5] = crc8_dvb_s2_update(0, buf, 5);
 
     saQueueCmd(buf, 6);
 }
@@ -727,18 +743,68 @@ bool vtxSmartAudioInit(void)
     return true;
 }
 
-#define SA_INITPHASE_START         0
-#define SA_INITPHASE_WAIT_SETTINGS 1 // SA_CMD_GET_SETTINGS was sent and waiting for reply.
-#define SA_INITPHASE_WAIT_PITFREQ  2 // SA_FREQ_GETPIT sent and waiting for reply.
-#define SA_INITPHASE_DONE          3
+// the device initialisation, stepped from vtxSAProcess() until it is done
+static coroutine_t saInitCoroutine;
+
+static coroutineState_e saInitStep(void)
+{
+    COROUTINE_BEGIN(&saInitCoroutine);
+
+    saGetSettings();
+    COROUTINE_WAIT_UNTIL(&saInitCoroutine, saDevice.version);
+
+#if !defined(USE_VTX_TABLE)
+    if (saDevice.version == 1) {//this is kind of ugly. use fixed tables and set a pointer to them instead?
+        saSupportedPowerValues[0] = 7;
+        saSupportedPowerValues[1] = 16;
+        saSupportedPowerValues[2] = 25;
+        saSupportedPowerValues[3] = 40;
+    } else if (saDevice.version == 2) {
+        saSupportedPowerValues[0] = 0;
+        saSupportedPowerValues[1] = 1;
+        saSupportedPowerValues[2] = 2;
+        saSupportedPowerValues[3] = 3;
+    }
+
+    //without USE_VTX_TABLE, fill vtxTable variables with default settings (instead of loading them from PG)
+    vtxTablePowerLevels = constrain(saSupportedNumPowerLevels, 0, VTX_SMARTAUDIO_POWER_COUNT);
+    if (saDevice.version >= 3) {
+        for (int8_t i = 0; i < vtxTablePowerLevels; i++) {
+            //ideally we would convert dbm to mW here
+            tfp_sprintf(saSupportedPowerLabels[i + 1], "%3d", constrain(saSupportedPowerValues[i], 0, 999));
+        }
+    }
+    for (int8_t i = 0; i < vtxTablePowerLevels; i++) {
+        vtxTablePowerValues[i] = saSupportedPowerValues[i];
+    }
+    for (int8_t i = 0; i < vtxTablePowerLevels + 1; i++) {
+        vtxTablePowerLabels[i] = saSupportedPowerLabels[i];
+    }
+    dprintf(("vtxSAProcess init phase vtxTablePowerLevels set to %d\r\n", vtxTablePowerLevels));
+#endif
+
+    if (saDevice.version >= 2 ) {
+        //did the device boot up in pit mode on its own?
+        saDevice.willBootIntoPitMode = (saDevice.mode & SA_MODE_GET_PITMODE) ? true : false;
+        dprintf(("sainit: willBootIntoPitMode is %s\r\n", saDevice.willBootIntoPitMode ? "true" : "false"));
+    }
+
+    // Don't send SA_FREQ_GETPIT to V1 device; it act as plain SA_CMD_SET_FREQ,
+    // and put the device into user frequency mode with uninitialized freq.
+    // Also don't send it to V2.1 for the same reason.
+    if (saDevice.version == 2) {
+        saSetFreq(SA_FREQ_GETPIT);
+        COROUTINE_WAIT_UNTIL(&saInitCoroutine, saDevice.orfreq);
+    }
+
+    COROUTINE_END(&saInitCoroutine);
+}
 
 static void vtxSAProcess(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
 {
     UNUSED(vtxDevice);
     UNUSED(currentTimeUs);
 
-    static char initPhase = SA_INITPHASE_START;
-
     if (smartAudioSerialPort == NULL) {
         return;
     }
@@ -751,72 +817,7 @@ static void vtxSAProcess(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
     // Re-evaluate baudrate after each frame reception
     saAutobaud();
 
-    switch (initPhase) {
-    case SA_INITPHASE_START:
-        saGetSettings();
-        //saSendQueue();
-        initPhase = SA_INITPHASE_WAIT_SETTINGS;
-        break;
-
-    case SA_INITPHASE_WAIT_SETTINGS:
-        // Don't send SA_FREQ_GETPIT to V1 device; it act as plain SA_CMD_SET_FREQ,
-        // and put the device into user frequency mode with uninitialized freq.
-        // Also don't send it to V2.1 for the same reason.
-        if (saDevice.version) {
-            if (saDevice.version == 2) {
-                saSetFreq(SA_FREQ_GETPIT);
-                initPhase = SA_INITPHASE_WAIT_PITFREQ;
-            } else {
-                initPhase = SA_INITPHASE_DONE;
-            }
-
-#if !defined(USE_VTX_TABLE)
-            if (saDevice.version == 1) {//this is kind of ugly. use fixed tables and set a pointer to them instead?
-                saSupportedPowerValues[0] = 7;
-                saSupportedPowerValues[1] = 16;
-                saSupportedPowerValues[2] = 25;
-                saSupportedPowerValues[3] = 40;
-            } else if (saDevice.version == 2) {
-                saSupportedPowerValues[0] = 0;
-                saSupportedPowerValues[1] = 1;
-                saSupportedPowerValues[2] = 2;
-                saSupportedPowerValues[3] = 3;
-            }
-
-            //without USE_VTX_TABLE, fill vtxTable variables with default settings (instead of loading them from PG)
-            vtxTablePowerLevels = constrain(saSupportedNumPowerLevels, 0, VTX_SMARTAUDIO_POWER_COUNT);
-            if (saDevice.version >= 3) {
-                for (int8_t i = 0; i < vtxTablePowerLevels; i++) {
-                    //ideally we would convert dbm to mW here
-                    tfp_sprintf(saSupportedPowerLabels[i + 1], "%3d", constrain(saSupportedPowerValues[i], 0, 999));
-                }
-            }
-            for (int8_t i = 0; i < vtxTablePowerLevels; i++) {
-                vtxTablePowerValues[i] = saSupportedPowerValues[i];
-            }
-            for (int8_t i = 0; i < vtxTablePowerLevels + 1; i++) {
-                vtxTablePowerLabels[i] = saSupportedPowerLabels[i];
-            }
-            dprintf(("vtxSAProcess init phase vtxTablePowerLevels set to %d\r\n", vtxTablePowerLevels));
-#endif
-
-            if (saDevice.version >= 2 ) {
-                //did the device boot up in pit mode on its own?
-                saDevice.willBootIntoPitMode = (saDevice.mode & SA_MODE_GET_PITMODE) ? true : false;
-                dprintf(("sainit: willBootIntoPitMode is %s\r\n", saDevice.willBootIntoPitMode ? "true" : "false"));
-            }
-        }
-        break;
-
-    case SA_INITPHASE_WAIT_PITFREQ:
-        if (saDevice.orfreq) {
-            initPhase = SA_INITPHASE_DONE;
-        }
-        break;
-
-    case SA_INITPHASE_DONE:
-        break;
-    }
+    saInitStep();
 
     // Command queue control
 
@@ -880,7 +881,7 @@ static void vtxSASetBandAndChannel(vtxDevice_t *vtxDevice, uint8_t band, uint8_t
         static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_CHAN), 1 };
 
         buf[4] = SA_BANDCHAN_TO_DEVICE_CHVAL(band, channel);
-        buf[5] = CRC8(buf, 5);
+        buf[5] = crc8_dvb_s2_update(0, buf, 5);
         dprintf(("vtxSASetBandAndChannel set index band %d channel %d value sent 0x%x\r\n", band, channel, buf[4]));
 
         //this will clear saDevice.mode & SA_MODE_GET_FREQ_BY_FREQ
@@ -908,7 +909,7 @@ static void vtxSASetPowerByIndex(vtxDevice_t *vtxDevice, uint8_t index)
     if (saDevice.version == 3) {
         buf[4] |= 128;//set MSB to indicate set power by dbm
     }
-    buf[5] = CRC8(buf, 5);
+    buf[5] = crc8_dvb_s2_update(0, buf, 5);
     saQueueCmd(buf, 6);
 }
 
@@ -929,7 +930,7 @@ static void vtxSASetPitMode(vtxDevice_t *vtxDevice, uint8_t onoff)
             // This enables pitmode without causing the device to boot into pitmode next power-up
             static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_POWER), 1 };
             buf[4] = 0 | 128;
-            buf[5] = CRC8(buf, 5);
+            buf[5] = crc8_dvb_s2_update(0, buf, 5);
             saQueueCmd(buf, 6);
             dprintf(("vtxSASetPitMode: set power to 0 dbm\r\n"));
         } else {
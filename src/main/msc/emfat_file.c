@@ -300,21 +300,126 @@ static void emfat_add_log(emfat_entry_t *entry, int number, uint32_t offset, uin
     entry->cma_time[2] = entry->cma_time[0];
 }
 
+static const char logHeader[] = "H Product:Blackbox";
+
+/*
+ * Set the creation time of a log entry from the "Log start datetime" header of the log at logOffset, example encoding
+ * "H Log start datetime:2019-08-15T13:18:22.199+00:00". The buffer holds the start of the log and the search stops at
+ * limit.
+ */
+static void emfat_set_log_time(emfat_entry_t *entry, uint8_t *buffer, int logOffset, int limit)
+{
+    const char *timeHeader = "H Log start datetime:";
+    const int lenTimeHeader = strlen(timeHeader);
+    int timeHeaderMatched = 0;
+    int buffOffset = strlen(logHeader);
+    int hdrOffset = logOffset;
+
+    // Set the default timestamp for this log entry in case the timestamp is not found
+    entry->cma_time[0] = cmaTime;
+
+    // Search for the timestamp record
+    while (true) {
+        if (buffer[buffOffset++] == timeHeader[timeHeaderMatched]) {
+            // This matches the header we're looking for so far
+            if (++timeHeaderMatched == lenTimeHeader) {
+                // Complete match so read date/time into buffer
+                flashfsReadAbs(hdrOffset + buffOffset, buffer, HDR_BUF_SIZE);
+
+                // Extract the time values to create the CMA time
+                char *nextToken = (char *)buffer;
+                int year = strtoul(nextToken, &nextToken, 10);
+                int month = strtoul(++nextToken, &nextToken, 10);
+                int day = strtoul(++nextToken, &nextToken, 10);
+                int hour = strtoul(++nextToken, &nextToken, 10);
+                int min = strtoul(++nextToken, &nextToken, 10);
+                int sec = strtoul(++nextToken, NULL, 10);
+
+                // Set the file creation time
+                if (year) {
+                    entry->cma_time[0] = EMFAT_ENCODE_CMA_TIME(day, month, year, hour, min, sec);
+                }
+
+                break;
+            }
+        } else {
+            timeHeaderMatched = 0;
+        }
+
+        if (buffOffset == HDR_BUF_SIZE) {
+            // Read the next portion of the header
+            hdrOffset += HDR_BUF_SIZE;
+
+            // Check for flash overflow
+            if (hdrOffset > limit) {
+                break;
+            }
+
+            flashfsReadAbs(hdrOffset, buffer, HDR_BUF_SIZE);
+            buffOffset = 0;
+        }
+    }
+}
+
+static void emfat_add_log_range(emfat_entry_t *entry, int number, uint32_t start, uint32_t end)
+{
+    uint8_t buffer[HDR_BUF_SIZE];
+
+    flashfsReadAbs(start, buffer, HDR_BUF_SIZE);
+    emfat_set_log_time(entry, buffer, start, end);
+    emfat_add_log(entry, number, start, end - start);
+}
+
+/*
+ * Create the log entries from the flashfs log index, without having to search the flash for the logs.
+ */
+static int emfat_find_log_indexed(emfat_entry_t *entry, int maxCount, uint32_t limit)
+{
+    const int indexCount = flashfsLogIndexCount();
+    uint32_t offset = 0;
+    int fileNumber = 0;
+
+    for (int i = 0; i < indexCount && fileNumber < maxCount; i++) {
+        uint32_t start;
+        uint32_t length;
+
+        if (!flashfsLogIndexGet(i, &start, &length)) {
+            break;
+        }
+
+        // Data that isn't in the index, such as a log that wasn't closed, gets an entry of its own
+        if (start > offset) {
+            emfat_add_log_range(entry++, fileNumber++, offset, start);
+
+            if (fileNumber == maxCount) {
+                return fileNumber;
+            }
+        }
+
+        emfat_add_log_range(entry++, fileNumber++, start, start + length);
+        offset = start + length;
+    }
+
+    if (fileNumber < maxCount && limit > offset) {
+        emfat_add_log_range(entry, fileNumber++, offset, limit);
+    }
+
+    return fileNumber;
+}
+
 static int emfat_find_log(emfat_entry_t *entry, int maxCount)
 {
     int limit = flashfsIdentifyStartOfFreeSpace();
     int lastOffset = 0;
     int currOffset = 0;
-    int buffOffset;
-    int hdrOffset;
     int fileNumber = 0;
     uint8_t buffer[HDR_BUF_SIZE];
     int logCount = 0;
-    char *logHeader = "H Product:Blackbox";
     int lenLogHeader = strlen(logHeader);
-    char *timeHeader = "H Log start datetime:";
-    int lenTimeHeader = strlen(timeHeader);
-    int timeHeaderMatched = 0;
+
+    if (flashfsLogIndexCount() > 0) {
+        return emfat_find_log_indexed(entry, maxCount, limit);
+    }
 
     for ( ; currOffset < limit ; currOffset += 2048) { // XXX 2048 = FREE_BLOCK_SIZE in io/flashfs.c
 
@@ -332,55 +437,7 @@ static int emfat_find_log(emfat_entry_t *entry, int maxCount)
             logCount++;
         }
 
-        // Find the "Log start datetime" entry, example encoding "H Log start datetime:2019-08-15T13:18:22.199+00:00"
-
-        buffOffset = lenLogHeader;
-        hdrOffset = currOffset;
-
-        // Set the default timestamp for this log entry in case the timestamp is not found
-        entry->cma_time[0] = cmaTime;
-
-        // Search for the timestamp record
-        while (true) {
-            if (buffer[buffOffset++] == timeHeader[timeHeaderMatched]) {
-                // This matches the header we're looking for so far
-                if (++timeHeaderMatched == lenTimeHeader) {
-                    // Complete match so read date/time into buffer
-                    flashfsReadAbs(hdrOffset + buffOffset, buffer, HDR_BUF_SIZE);
-
-                    // Extract the time values to create the CMA time
-                    char *nextToken = (char *)buffer;
-                    int year = strtoul(nextToken, &nextToken, 10);
-                    int month = strtoul(++nextToken, &nextToken, 10);
-                    int day = strtoul(++nextToken, &nextToken, 10);
-                    int hour = strtoul(++nextToken, &nextToken, 10);
-                    int min = strtoul(++nextToken, &nextToken, 10);
-                    int sec = strtoul(++nextToken, NULL, 10);
-
-                    // Set the file creation time
-                    if (year) {
-                        entry->cma_time[0] = EMFAT_ENCODE_CMA_TIME(day, month, year, hour, min, sec);
-                    }
-
-                    break;
-                }
-            } else {
-                timeHeaderMatched = 0;
-            }
-
-            if (buffOffset == HDR_BUF_SIZE) {
-                // Read the next portion of the header
-                hdrOffset += HDR_BUF_SIZE;
-
-                // Check for flash overflow
-                if (hdrOffset > limit) {
-                    break;
-                }
-
-                flashfsReadAbs(hdrOffset, buffer, HDR_BUF_SIZE);
-                buffOffset = 0;
-            }
-        }
+        emfat_set_log_time(entry, buffer, currOffset, limit);
 
         if (fileNumber == maxCount) {
             break;
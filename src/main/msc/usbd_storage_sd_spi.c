@@ -215,6 +215,10 @@ static int8_t STORAGE_Read (uint8_t lun,
 {
 	UNUSED(lun);
 	LED1_ON;
+	// Hosts read sequentially, so the card is left streaming after this request to serve the next one
+	while (sdcard_beginReadBlocks(blk_addr) == SDCARD_OPERATION_BUSY) {
+		sdcard_poll();
+	}
 	for (int i = 0; i < blk_len; i++) {
 	    while (sdcard_readBlock(blk_addr + i, buf + (512 * i), NULL, NULL) == 0);
 		while (sdcard_poll() == 0);
@@ -31,10 +31,13 @@
 #include "blackbox/blackbox.h"
 
 #include "build/build_config.h"
+#include "build/crash_log.h"
 #include "build/debug.h"
+#include "build/trace.h"
 #include "build/version.h"
 
 #include "cli/cli.h"
+#include "cli/settings.h"
 
 #include "common/axis.h"
 #include "common/bitarray.h"
@@ -55,11 +58,13 @@
 #include "drivers/flash.h"
 #include "drivers/io.h"
 #include "drivers/max7456.h"
+#include "drivers/pendsv.h"
 #include "drivers/motor.h"
 #include "drivers/pwm_output.h"
 #include "drivers/sdcard.h"
 #include "drivers/serial.h"
 #include "drivers/serial_escserial.h"
+#include "drivers/stack_check.h"
 #include "drivers/system.h"
 #include "drivers/transponder_ir.h"
 #include "drivers/usb_msc.h"
@@ -73,6 +78,7 @@
 #include "fc/rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
 
@@ -172,6 +178,14 @@ typedef enum {
     MSP_FLASHFS_FLAG_SUPPORTED  = 2
 } mspFlashFsFlags_e;
 
+typedef enum {
+    MSP_TRACE_READ = 0,
+    MSP_TRACE_FREEZE,
+    MSP_TRACE_REARM,
+} mspTraceAction_e;
+
+#define MSP_CRASH_LOG_CHUNK_ENTRIES 8   // entries per MSP_CRASH_LOG reply, fits an MSP v1 frame
+
 #define RATEPROFILE_MASK (1 << 7)
 
 #define RTC_NOT_SUPPORTED 0xff
@@ -377,7 +391,8 @@ static void serializeDataflashSummaryReply(sbuf_t *dst)
         sbufWriteU8(dst, flags);
         sbufWriteU32(dst, FLASH_PARTITION_SECTOR_COUNT(flashPartition));
         sbufWriteU32(dst, flashfsGetSize());
-        sbufWriteU32(dst, flashfsGetOffset()); // Effectively the current number of bytes stored on the volume
+        // Effectively the current number of bytes stored on the volume, a ring that wrapped has data all over it
+        sbufWriteU32(dst, flashfsRingHasWrapped() ? flashfsGetSize() : flashfsGetOffset());
     } else
 #endif
 
@@ -396,7 +411,8 @@ enum compressionType_e {
     HUFFMAN
 };
 
-static void serializeDataflashReadReply(sbuf_t *dst, uint32_t address, const uint16_t size, bool useLegacyFormat, bool allowCompression)
+// Returns the number of bytes read from the flash
+static uint16_t serializeDataflashReadReply(sbuf_t *dst, uint32_t address, const uint16_t size, bool useLegacyFormat, bool allowCompression)
 {
     STATIC_ASSERT(MSP_PORT_DATAFLASH_INFO_SIZE >= 16, MSP_PORT_DATAFLASH_INFO_SIZE_invalid);
 
@@ -445,6 +461,8 @@ static void serializeDataflashReadReply(sbuf_t *dst, uint32_t address, const uin
                 sbufWriteU8(dst, 0);
             }
         }
+
+        return bytesRead;
     } else {
 #ifdef USE_HUFFMAN
         // compress in 256-byte chunks
@@ -484,8 +502,12 @@ static void serializeDataflashReadReply(sbuf_t *dst, uint32_t address, const uin
         // payload
         sbufWriteU16(dst, bytesReadTotal);
         sbufAdvance(dst, state.bytesWritten);
+
+        return bytesReadTotal;
 #endif
     }
+
+    return 0;
 }
 #endif // USE_FLASHFS
 
@@ -918,6 +940,11 @@ static bool mspProcessOutCommand(uint8_t cmdMSP, sbuf_t *dst)
         }
         break;
 
+    case MSP_ARMING_DISABLE_FLAGS:
+        sbufWriteU8(dst, ARMING_DISABLE_FLAGS_COUNT);
+        sbufWriteU32(dst, getArmingDisableFlags());
+        break;
+
     case MSP_RAW_IMU:
         {
 #if defined(USE_ACC)
@@ -1764,6 +1791,140 @@ static mspResult_e mspFcProcessOutCommandWithArg(uint8_t cmdMSP, sbuf_t *src, sb
             serializeBoxReply(dst, page, &serializeBoxPermanentIdFn);
         }
         break;
+#if defined(USE_TASK_PROFILER)
+    case MSP_TASK_PROFILE:
+        {
+            const cfTaskId_e taskId = sbufBytesRemaining(src) ? sbufReadU8(src) : TASK_COUNT;
+            if (taskId >= TASK_COUNT) {
+                return MSP_RESULT_ERROR;
+            }
+            cfTaskInfo_t taskInfo;
+            getTaskInfo(taskId, &taskInfo);
+            const cfTaskProfile_t *profile = getTaskProfile(taskId);
+
+            sbufWriteU8(dst, taskId);
+            sbufWriteU8(dst, taskInfo.isEnabled);
+            sbufWriteU32(dst, SystemCoreClock);
+            sbufWriteU8(dst, TASK_PROFILER_BUCKET_COUNT);
+            sbufWriteU8(dst, TASK_PROFILER_EXECUTION_SHIFT);
+            sbufWriteU8(dst, TASK_PROFILER_LATENESS_SHIFT);
+            for (int i = 0; i < TASK_PROFILER_BUCKET_COUNT; i++) {
+                sbufWriteU16(dst, profile->executionCycles[i]);
+            }
+            for (int i = 0; i < TASK_PROFILER_BUCKET_COUNT; i++) {
+                sbufWriteU16(dst, profile->startLateness[i]);
+            }
+        }
+        break;
+#endif
+#if defined(USE_RC_LATENCY)
+    case MSP_RC_LATENCY:
+        {
+            const rcLatencyStage_e stage = sbufBytesRemaining(src) ? sbufReadU8(src) : RC_LATENCY_STAGE_COUNT;
+            if (stage >= RC_LATENCY_STAGE_COUNT) {
+                return MSP_RESULT_ERROR;
+            }
+            const bool reset = sbufBytesRemaining(src) && sbufReadU8(src);
+            const rcLatencyStats_t *stats = rcLatencyGetStats(stage);
+
+            sbufWriteU8(dst, stage);
+            sbufWriteU8(dst, RC_LATENCY_STAGE_COUNT);
+            sbufWriteU8(dst, RC_LATENCY_BUCKET_COUNT);
+            sbufWriteU16(dst, RC_LATENCY_BUCKET_WIDTH_US);
+            sbufWriteU16(dst, MIN(stats->lastLatencyUs, UINT16_MAX));
+            for (int i = 0; i < RC_LATENCY_BUCKET_COUNT; i++) {
+                sbufWriteU16(dst, stats->histogram[i]);
+            }
+
+            if (reset) {
+                rcLatencyReset();
+            }
+        }
+        break;
+#endif
+#if defined(STACK_CHECK)
+    case MSP_STACK_INFO:
+        {
+            const bool reset = sbufBytesRemaining(src) && sbufReadU8(src);
+            const stackIsrStats_t *isrStats = stackCheckGetIsrStats();
+
+            sbufWriteU32(dst, stackTotalSize());
+            sbufWriteU32(dst, stackUsedSize());
+            sbufWriteU8(dst, isrStats->maxNesting);
+            sbufWriteU16(dst, MIN(isrStats->maxDepth, (uint32_t)UINT16_MAX));
+            sbufWriteU8(dst, TASK_COUNT);
+            for (int i = 0; i < TASK_COUNT; i++) {
+                sbufWriteU16(dst, MIN(stackCheckGetTaskDepth(i), (uint32_t)UINT16_MAX));
+            }
+
+            if (reset) {
+                stackCheckResetIsrStats();
+            }
+        }
+        break;
+#endif
+#if defined(USE_TRACE)
+    case MSP_TRACE:
+        {
+            const uint16_t offset = sbufBytesRemaining(src) >= 2 ? sbufReadU16(src) : 0;
+            const uint8_t action = sbufBytesRemaining(src) ? sbufReadU8(src) : MSP_TRACE_READ;
+            if (action == MSP_TRACE_FREEZE) {
+                traceTrigger(TRACE_TRIGGER_MANUAL, 0);
+            } else if (action == MSP_TRACE_REARM) {
+                traceRearm();
+            }
+
+            const uint16_t eventCount = traceGetEventCount();
+            const uint8_t chunkEvents = offset < eventCount ? MIN(eventCount - offset, TRACE_MSP_CHUNK_EVENTS) : 0;
+
+            sbufWriteU32(dst, SystemCoreClock);
+            sbufWriteU8(dst, traceGetState());
+            sbufWriteU16(dst, eventCount);
+            sbufWriteU16(dst, offset);
+            sbufWriteU8(dst, chunkEvents);
+            for (int i = 0; i < chunkEvents; i++) {
+                const traceEvent_t *event = traceGetEvent(offset + i);
+                sbufWriteU32(dst, event->cycles);
+                sbufWriteU8(dst, event->type);
+                sbufWriteU8(dst, event->id);
+                sbufWriteU16(dst, event->arg);
+            }
+        }
+        break;
+#endif
+#if defined(USE_CRASH_LOG)
+    case MSP_CRASH_LOG:
+        {
+            const uint8_t offset = sbufBytesRemaining(src) ? sbufReadU8(src) : 0;
+            const bool clear = sbufBytesRemaining(src) && sbufReadU8(src);
+
+            const uint8_t entryCount = crashLogGetCount();
+            const uint8_t chunkEntries = offset < entryCount ? MIN(entryCount - offset, MSP_CRASH_LOG_CHUNK_ENTRIES) : 0;
+
+            sbufWriteU16(dst, crashLogGetBoot());
+            sbufWriteU8(dst, entryCount);
+            sbufWriteU8(dst, offset);
+            sbufWriteU8(dst, chunkEntries);
+            for (int i = 0; i < chunkEntries; i++) {
+                const crashLogEntry_t *entry = crashLogGetEntry(offset + i);
+                sbufWriteU32(dst, entry->timeMs);
+                sbufWriteU16(dst, entry->boot);
+                sbufWriteU16(dst, entry->count);
+                sbufWriteU8(dst, entry->type);
+                sbufWriteU8(dst, entry->task);
+                sbufWriteU8(dst, entry->flags);
+                sbufWriteU32(dst, entry->value);
+                sbufWriteU32(dst, entry->pc);
+                sbufWriteU32(dst, entry->lr);
+                sbufWriteU32(dst, entry->psr);
+            }
+
+            if (clear) {
+                crashLogClear();
+            }
+        }
+        break;
+#endif
     case MSP_REBOOT:
         if (sbufBytesRemaining(src)) {
             rebootMode = sbufReadU8(src);
@@ -1932,6 +2093,341 @@ static void mspFcDataFlashReadCommand(sbuf_t *dst, sbuf_t *src)
 
     serializeDataflashReadReply(dst, readAddress, readLength, useLegacyFormat, allowCompression);
 }
+
+/*
+ * MSP2_DATAFLASH_STREAM streams the dataflash content without a request per chunk. The request is
+ *   u32 address, u16 sequence, u16 chunk size, u8 window, u8 flags
+ * and each chunk reply is the sequence number as u16 followed by an MSP_DATAFLASH_READ reply.
+ *
+ * With DATAFLASH_STREAM_RESTART in the flags, or when no stream is active, the stream continues from the address
+ * with the chunk numbered sequence. Otherwise the request acknowledges the chunks before sequence, and up to window
+ * chunks after them are sent while the port is idle. A chunk with a length of 0 marks the end of the volume. The
+ * host keeps the address and sequence of the last chunk it received, so a lost chunk or a new connection resumes
+ * the stream with a restart from there. A window of 0 stops the stream.
+ */
+#define DATAFLASH_STREAM_COMPRESSION (1 << 0)
+#define DATAFLASH_STREAM_RESTART     (1 << 1)
+
+static struct {
+    uint32_t address;   // of the next chunk
+    uint16_t sequence;  // of the next chunk
+    uint16_t windowEnd; // sequence of the first chunk beyond the window
+    uint16_t chunkSize;
+    bool allowCompression;
+    bool active;
+} dataflashStream;
+
+static mspResult_e mspFcDataflashStreamCommand(sbuf_t *dst, sbuf_t *src)
+{
+    if (sbufBytesRemaining(src) >= 10) { // address, sequence, chunk size, window, flags
+        const uint32_t address = sbufReadU32(src);
+        const uint16_t sequence = sbufReadU16(src);
+        const uint16_t chunkSize = sbufReadU16(src);
+        const uint8_t window = sbufReadU8(src);
+        const uint8_t flags = sbufReadU8(src);
+
+        if (window == 0) {
+            dataflashStream.active = false;
+
+            return MSP_RESULT_ACK;
+        }
+        if ((flags & DATAFLASH_STREAM_RESTART) || !dataflashStream.active) {
+            dataflashStream.address = address;
+            dataflashStream.sequence = sequence;
+        }
+        dataflashStream.windowEnd = sequence + window;
+        dataflashStream.chunkSize = chunkSize;
+        dataflashStream.allowCompression = flags & DATAFLASH_STREAM_COMPRESSION;
+        dataflashStream.active = true;
+    } else if (sbufBytesRemaining(src) > 0 || !dataflashStream.active) {
+        return MSP_RESULT_ERROR;
+    }
+
+    // An empty command asks for the next chunk while the port is idle, there is none until the host acknowledges more
+    if ((int16_t)(dataflashStream.windowEnd - dataflashStream.sequence) <= 0) {
+        return MSP_RESULT_STREAM;
+    }
+
+    sbufWriteU16(dst, dataflashStream.sequence);
+    const uint16_t bytesRead = serializeDataflashReadReply(dst, dataflashStream.address, dataflashStream.chunkSize, false, dataflashStream.allowCompression);
+
+    dataflashStream.address += bytesRead;
+    dataflashStream.sequence++;
+    if (bytesRead == 0) {
+        // End of the volume
+        dataflashStream.active = false;
+
+        return MSP_RESULT_ACK;
+    }
+
+    return MSP_RESULT_STREAM;
+}
+#endif
+
+#ifdef USE_MSP_SETTINGS
+/*
+ * MSP2_GET_SETTINGS and MSP2_SET_SETTINGS read and write the settings of the CLI by their index in the value table,
+ * so that a whole configuration can be synchronised with a few packets. The index of a setting depends on the build,
+ * MSP2_GET_SETTINGS can return the names to map them.
+ *
+ * MSP2_GET_SETTINGS request: u8 flags, then a list of u16 indices
+ *   reply: u8 count, then for each setting u16 index, [u8 name length, name,] u8 size, value
+ *   The reply stops at the first setting that does not fit, the host asks again for the rest.
+ * MSP2_SET_SETTINGS request: a list of u16 index, u8 size, value
+ *   reply: u8 count. An invalid setting rejects the whole request, nothing is written.
+ *
+ * The values are little endian, of the size of the setting type, times the length for arrays. A bitset is a u8 of 0
+ * or 1, a string is its characters. The profile settings are those of the current profiles. Like with the CLI set
+ * command, the changes are saved with MSP_EEPROM_WRITE.
+ */
+#define MSP_SETTINGS_NAMES (1 << 0)
+
+static void *mspSettingPointer(const clivalue_t *value)
+{
+    const pgRegistry_t *pg = pgFind(value->pgn);
+    if (!pg) {
+        return NULL;
+    }
+
+    uint16_t offset = value->offset;
+    switch (value->type & VALUE_SECTION_MASK) {
+    case PROFILE_VALUE:
+        offset += sizeof(pidProfile_t) * getCurrentPidProfileIndex();
+
+        break;
+    case PROFILE_RATE_VALUE:
+        offset += sizeof(controlRateConfig_t) * getCurrentControlRateProfileIndex();
+
+        break;
+    }
+
+    return pg->address + offset;
+}
+
+static unsigned mspSettingTypeSize(const clivalue_t *value)
+{
+    switch (value->type & VALUE_TYPE_MASK) {
+    case VAR_UINT16:
+    case VAR_INT16:
+        return sizeof(uint16_t);
+    case VAR_UINT32:
+        return sizeof(uint32_t);
+    default:
+        return sizeof(uint8_t);
+    }
+}
+
+static uint32_t mspSettingReadWord(const void *ptr, unsigned size)
+{
+    switch (size) {
+    case sizeof(uint16_t):
+        return *(const uint16_t *)ptr;
+    case sizeof(uint32_t):
+        return *(const uint32_t *)ptr;
+    default:
+        return *(const uint8_t *)ptr;
+    }
+}
+
+static void mspSettingWriteWord(void *ptr, unsigned size, uint32_t word)
+{
+    switch (size) {
+    case sizeof(uint16_t):
+        *(uint16_t *)ptr = word;
+
+        break;
+    case sizeof(uint32_t):
+        *(uint32_t *)ptr = word;
+
+        break;
+    default:
+        *(uint8_t *)ptr = word;
+
+        break;
+    }
+}
+
+static unsigned mspSettingSize(const clivalue_t *value, const void *ptr)
+{
+    switch (value->type & VALUE_MODE_MASK) {
+    case MODE_ARRAY:
+        return mspSettingTypeSize(value) * value->config.array.length;
+    case MODE_BITSET:
+        return sizeof(uint8_t);
+    case MODE_STRING:
+        return strnlen((const char *)ptr, value->config.string.maxlength);
+    default:
+        return mspSettingTypeSize(value);
+    }
+}
+
+static mspResult_e mspFcGetSettingsCommand(sbuf_t *dst, sbuf_t *src)
+{
+    if (sbufBytesRemaining(src) < 1) {
+        return MSP_RESULT_ERROR;
+    }
+    const uint8_t flags = sbufReadU8(src);
+
+    uint8_t *countPtr = sbufPtr(dst);
+    sbufWriteU8(dst, 0);
+
+    uint8_t count = 0;
+    while (sbufBytesRemaining(src) >= 2 && count < UINT8_MAX) {
+        const uint16_t index = sbufReadU16(src);
+        if (index >= valueTableEntryCount) {
+            return MSP_RESULT_ERROR;
+        }
+        const clivalue_t *value = &valueTable[index];
+        const uint8_t *ptr = mspSettingPointer(value);
+        if (!ptr) {
+            return MSP_RESULT_ERROR;
+        }
+
+        const unsigned nameLength = (flags & MSP_SETTINGS_NAMES) ? strlen(value->name) : 0;
+        const unsigned size = mspSettingSize(value, ptr);
+        if (sbufBytesRemaining(dst) < (int)(sizeof(uint16_t) + ((flags & MSP_SETTINGS_NAMES) ? 1 + nameLength : 0) + 1 + size)) {
+            break;
+        }
+
+        sbufWriteU16(dst, index);
+        if (flags & MSP_SETTINGS_NAMES) {
+            sbufWriteU8(dst, nameLength);
+            sbufWriteData(dst, value->name, nameLength);
+        }
+        sbufWriteU8(dst, size);
+        if ((value->type & VALUE_MODE_MASK) == MODE_BITSET) {
+            sbufWriteU8(dst, (mspSettingReadWord(ptr, mspSettingTypeSize(value)) >> value->config.bitpos) & 1);
+        } else {
+            sbufWriteData(dst, ptr, size);
+        }
+        count++;
+    }
+    *countPtr = count;
+
+    return MSP_RESULT_ACK;
+}
+
+// Checks the value of a setting in a MSP2_SET_SETTINGS request, and writes it if write is set
+static bool mspSettingSet(const clivalue_t *value, const uint8_t *data, unsigned size, bool write)
+{
+    uint8_t *ptr = mspSettingPointer(value);
+    if (!ptr) {
+        return false;
+    }
+    const unsigned typeSize = mspSettingTypeSize(value);
+
+    switch (value->type & VALUE_MODE_MASK) {
+    case MODE_ARRAY:
+        if (size != typeSize * value->config.array.length) {
+            return false;
+        }
+        if (write) {
+            memcpy(ptr, data, size);
+        }
+
+        return true;
+    case MODE_STRING: {
+            const uint8_t maxLength = value->config.string.maxlength;
+            const bool updatable = (value->config.string.flags & STRING_FLAGS_WRITEONCE) == 0
+                || strnlen((const char *)ptr, maxLength) == 0
+                || (size == strnlen((const char *)ptr, maxLength) && memcmp(ptr, data, size) == 0);
+            if (!updatable || size > maxLength || (size > 0 && size < value->config.string.minlength)) {
+                return false;
+            }
+            if (write) {
+                memset(ptr, 0, maxLength);
+                memcpy(ptr, data, size);
+            }
+        }
+
+        return true;
+    case MODE_BITSET:
+        if (size != sizeof(uint8_t) || data[0] > 1) {
+            return false;
+        }
+        if (write) {
+            const uint32_t mask = 1 << value->config.bitpos;
+            const uint32_t word = mspSettingReadWord(ptr, typeSize);
+            mspSettingWriteWord(ptr, typeSize, data[0] ? word | mask : word & ~mask);
+        }
+
+        return true;
+    default:
+        break;
+    }
+
+    if (size != typeSize) {
+        return false;
+    }
+
+    uint32_t word = 0;
+    memcpy(&word, data, size);
+    bool valid;
+    if ((value->type & VALUE_MODE_MASK) == MODE_LOOKUP) {
+        valid = word < lookupTables[value->config.lookup.tableIndex].valueCount;
+    } else {
+        switch (value->type & VALUE_TYPE_MASK) {
+        case VAR_UINT32:
+            valid = word <= value->config.u32Max;
+
+            break;
+        case VAR_UINT8:
+        case VAR_UINT16:
+            valid = word >= value->config.minmaxUnsigned.min && word <= value->config.minmaxUnsigned.max;
+
+            break;
+        case VAR_INT8:
+            valid = (int8_t)word >= value->config.minmax.min && (int8_t)word <= value->config.minmax.max;
+
+            break;
+        default:
+            valid = (int16_t)word >= value->config.minmax.min && (int16_t)word <= value->config.minmax.max;
+
+            break;
+        }
+    }
+    if (valid && write) {
+        mspSettingWriteWord(ptr, typeSize, word);
+    }
+
+    return valid;
+}
+
+static mspResult_e mspFcSetSettingsCommand(sbuf_t *dst, sbuf_t *src)
+{
+    if (ARMING_FLAG(ARMED)) {
+        return MSP_RESULT_ERROR;
+    }
+
+    // check all the settings before writing any of them
+    for (int pass = 0; pass < 2; pass++) {
+        const bool write = pass == 1;
+        sbuf_t request = *src;
+        uint8_t count = 0;
+
+        while (sbufBytesRemaining(&request) > 0) {
+            if (sbufBytesRemaining(&request) < 3) {
+                return MSP_RESULT_ERROR;
+            }
+            const uint16_t index = sbufReadU16(&request);
+            const uint8_t size = sbufReadU8(&request);
+            if (index >= valueTableEntryCount || sbufBytesRemaining(&request) < size) {
+                return MSP_RESULT_ERROR;
+            }
+            if (!mspSettingSet(&valueTable[index], sbufConstPtr(&request), size, write)) {
+                return MSP_RESULT_ERROR;
+            }
+            sbufAdvance(&request, size);
+            count++;
+        }
+
+        if (write) {
+            sbufWriteU8(dst, count);
+        }
+    }
+
+    return MSP_RESULT_ACK;
+}
 #endif
 
 static mspResult_e mspProcessInCommand(uint8_t cmdMSP, sbuf_t *src)
@@ -2198,6 +2694,7 @@ static mspResult_e mspProcessInCommand(uint8_t cmdMSP, sbuf_t *src)
             servoParamsMutable(i)->rate = sbufReadU8(src);
             servoParamsMutable(i)->forwardFromChannel = sbufReadU8(src);
             servoParamsMutable(i)->reversedSources = sbufReadU32(src);
+            servoMixerCompile();
         }
 #endif
         break;
@@ -2374,11 +2871,13 @@ static mspResult_e mspProcessInCommand(uint8_t cmdMSP, sbuf_t *src)
 #endif
         }
 
-        // reinitialize the gyro filters with the new values
-        validateAndFixGyroConfig();
-        gyroInitFilters();
-        // reinitialize the PID filters with the new values
-        pidInitFilters(currentPidProfile);
+        // retune the gyro filters to the new values, they crossfade so this can be done in flight
+        PENDSV_BLOCK {
+            validateAndFixGyroConfig();
+            gyroRetuneFilters();
+            // reinitialize the PID filters with the new values
+            pidInitFilters(currentPidProfile);
+        }
 
         break;
     case MSP_SET_PID_ADVANCED:
@@ -2503,10 +3002,6 @@ static mspResult_e mspProcessInCommand(uint8_t cmdMSP, sbuf_t *src)
         break;
 
     case MSP_EEPROM_WRITE:
-        if (ARMING_FLAG(ARMED)) {
-            return MSP_RESULT_ERROR;
-        }
-
         if (featureMaskIsCopied) {
             writeEEPROMWithFeatures(featureMaskCopy);
         } else {
@@ -2710,10 +3205,6 @@ static mspResult_e mspProcessInCommand(uint8_t cmdMSP, sbuf_t *src)
 #ifdef USE_CAMERA_CONTROL
     case MSP_CAMERA_CONTROL:
         {
-            if (ARMING_FLAG(ARMED)) {
-                return MSP_RESULT_ERROR;
-            }
-
             const uint8_t key = sbufReadU8(src);
             cameraControlKeyPress(key, 0);
         }
@@ -3267,8 +3758,326 @@ static mspResult_e mspCommonProcessInCommand(uint8_t cmdMSP, sbuf_t *src, mspPos
     return MSP_RESULT_ACK;
 }
 
+typedef enum {
+    MSP_HANDLER_NONE = 0,
+    MSP_HANDLER_COMMON_OUT,
+    MSP_HANDLER_OUT,
+    MSP_HANDLER_OUT_WITH_ARG,
+    MSP_HANDLER_4WAY,
+    MSP_HANDLER_DATAFLASH_READ,
+    MSP_HANDLER_IN,
+} mspHandler_e;
+
+#define MSP_CMD_DISARMED_ONLY (1 << 0) // rejected with MSP_RESULT_ERROR while armed
+
+typedef struct mspCommand_s {
+    uint8_t handler : 4;    // mspHandler_e
+    uint8_t flags : 4;      // MSP_CMD_*
+    uint8_t minSize;        // payload bytes the handler reads unconditionally
+} mspCommand_t;
+
 /*
- * Returns MSP_RESULT_ACK, MSP_RESULT_ERROR or MSP_RESULT_NO_REPLY
+ * Every MSPv1 command this file knows about, indexed by command ID so the dispatcher goes
+ * straight to the handler switch instead of falling through each one in turn.
+ * Commands compiled out of a build keep their entry; their handler reports them as unknown.
+ */
+static const mspCommand_t mspCommands[256] = {
+    [MSP_API_VERSION]                  = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_FC_VARIANT]                   = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_FC_VERSION]                   = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_BOARD_INFO]                   = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_BUILD_INFO]                   = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_NAME]                         = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_NAME]                     = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_BATTERY_CONFIG]               = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_BATTERY_CONFIG]           = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_MODE_RANGES]                  = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_MODE_RANGE]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_FEATURE_CONFIG]               = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_FEATURE_CONFIG]           = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_BOARD_ALIGNMENT_CONFIG]       = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_BOARD_ALIGNMENT_CONFIG]   = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_CURRENT_METER_CONFIG]         = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_CURRENT_METER_CONFIG]     = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_MIXER_CONFIG]                 = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_MIXER_CONFIG]             = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_RX_CONFIG]                    = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_RX_CONFIG]                = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_LED_COLORS]                   = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_LED_COLORS]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_LED_STRIP_CONFIG]             = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_LED_STRIP_CONFIG]         = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_RSSI_CONFIG]                  = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_RSSI_CONFIG]              = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_ADJUSTMENT_RANGES]            = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_ADJUSTMENT_RANGE]         = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_CF_SERIAL_CONFIG]             = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_CF_SERIAL_CONFIG]         = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_VOLTAGE_METER_CONFIG]         = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_VOLTAGE_METER_CONFIG]     = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SONAR_ALTITUDE]               = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_PID_CONTROLLER]               = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_PID_CONTROLLER]           = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_ARMING_CONFIG]                = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_ARMING_CONFIG]            = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_RX_MAP]                       = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_RX_MAP]                   = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_REBOOT]                       = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_DATAFLASH_SUMMARY]            = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_DATAFLASH_READ]               = { MSP_HANDLER_DATAFLASH_READ, 0, 0 },
+    [MSP_DATAFLASH_ERASE]              = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_FAILSAFE_CONFIG]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_FAILSAFE_CONFIG]          = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_RXFAIL_CONFIG]                = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_RXFAIL_CONFIG]            = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SDCARD_SUMMARY]               = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_BLACKBOX_CONFIG]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_BLACKBOX_CONFIG]          = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_TRANSPONDER_CONFIG]           = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_TRANSPONDER_CONFIG]       = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_OSD_CONFIG]                   = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_OSD_CONFIG]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_OSD_CHAR_WRITE]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_VTX_CONFIG]                   = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_VTX_CONFIG]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_ADVANCED_CONFIG]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_ADVANCED_CONFIG]          = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_FILTER_CONFIG]                = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_FILTER_CONFIG]            = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_PID_ADVANCED]                 = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_PID_ADVANCED]             = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SENSOR_CONFIG]                = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_SENSOR_CONFIG]            = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_CAMERA_CONTROL]               = { MSP_HANDLER_IN,             MSP_CMD_DISARMED_ONLY, 1 },
+    [MSP_SET_ARMING_DISABLED]          = { MSP_HANDLER_IN,             0, 1 },
+    [MSP_STATUS]                       = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_RAW_IMU]                      = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SERVO]                        = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_MOTOR]                        = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_RC]                           = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_RAW_GPS]                      = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_COMP_GPS]                     = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_ATTITUDE]                     = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_ALTITUDE]                     = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_ANALOG]                       = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_RC_TUNING]                    = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_PID]                          = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_BOXNAMES]                     = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_PIDNAMES]                     = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_BOXIDS]                       = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_SERVO_CONFIGURATIONS]         = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_MOTOR_3D_CONFIG]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_RC_DEADBAND]                  = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SENSOR_ALIGNMENT]             = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_LED_STRIP_MODECOLOR]          = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_VOLTAGE_METERS]               = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_CURRENT_METERS]               = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_BATTERY_STATE]                = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_MOTOR_CONFIG]                 = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_GPS_CONFIG]                   = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_COMPASS_CONFIG]               = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_ESC_SENSOR_DATA]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_GPS_RESCUE]                   = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_GPS_RESCUE_PIDS]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_VTXTABLE_BAND]                = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_VTXTABLE_POWERLEVEL]          = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_MOTOR_TELEMETRY]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_TASK_PROFILE]                 = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_RC_LATENCY]                   = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_STACK_INFO]                   = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_TRACE]                        = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_CRASH_LOG]                    = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_ARMING_DISABLE_FLAGS]         = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_STATUS_EX]                    = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_UID]                          = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_GPSSVINFO]                    = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_COPY_PROFILE]                 = { MSP_HANDLER_IN,             0, 3 },
+    [MSP_BEEPER_CONFIG]                = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+    [MSP_SET_BEEPER_CONFIG]            = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_TX_INFO]                  = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_TX_INFO]                      = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_RAW_RC]                   = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_RAW_GPS]                  = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_PID]                      = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_RC_TUNING]                = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_ACC_CALIBRATION]              = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_MAG_CALIBRATION]              = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_RESET_CONF]                   = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_SELECT_SETTING]               = { MSP_HANDLER_IN,             0, 1 },
+    [MSP_SET_HEADING]                  = { MSP_HANDLER_IN,             0, 2 },
+    [MSP_SET_SERVO_CONFIGURATION]      = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_MOTOR]                    = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_MOTOR_3D_CONFIG]          = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_RC_DEADBAND]              = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_RESET_CURR_PID]           = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_SENSOR_ALIGNMENT]         = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_LED_STRIP_MODECOLOR]      = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_MOTOR_CONFIG]             = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_GPS_CONFIG]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_COMPASS_CONFIG]           = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_GPS_RESCUE]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_GPS_RESCUE_PIDS]          = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_VTXTABLE_BAND]            = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_VTXTABLE_POWERLEVEL]      = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_MULTIPLE_MSP]                 = { MSP_HANDLER_OUT_WITH_ARG,   0, 0 },
+    [MSP_MODE_RANGES_EXTRA]            = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_ACC_TRIM]                 = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_ACC_TRIM]                     = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SERVO_MIX_RULES]              = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_SERVO_MIX_RULE]           = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_4WAY_IF]                  = { MSP_HANDLER_4WAY,           0, 0 },
+    [MSP_SET_RTC]                      = { MSP_HANDLER_IN,             0, 6 },
+    [MSP_RTC]                          = { MSP_HANDLER_OUT,            0, 0 },
+    [MSP_SET_BOARD_INFO]               = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_SET_SIGNATURE]                = { MSP_HANDLER_IN,             0, 0 },
+    [MSP_EEPROM_WRITE]                 = { MSP_HANDLER_IN,             MSP_CMD_DISARMED_ONLY, 0 },
+    [MSP_DEBUG]                        = { MSP_HANDLER_COMMON_OUT,     0, 0 },
+};
+
+static mspResult_e mspFcDispatchCommand(uint8_t cmdMSP, sbuf_t *src, sbuf_t *dst, mspPostProcessFnPtr *mspPostProcessFn)
+{
+    const mspCommand_t *command = &mspCommands[cmdMSP];
+
+    if ((command->flags & MSP_CMD_DISARMED_ONLY) && ARMING_FLAG(ARMED)) {
+        return MSP_RESULT_ERROR;
+    }
+    if (sbufBytesRemaining(src) < command->minSize) {
+        return MSP_RESULT_ERROR;
+    }
+
+    switch (command->handler) {
+    case MSP_HANDLER_COMMON_OUT:
+        return mspCommonProcessOutCommand(cmdMSP, dst, mspPostProcessFn) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
+    case MSP_HANDLER_OUT:
+        return mspProcessOutCommand(cmdMSP, dst) ? MSP_RESULT_ACK : MSP_RESULT_ERROR;
+    case MSP_HANDLER_OUT_WITH_ARG: {
+        const mspResult_e ret = mspFcProcessOutCommandWithArg(cmdMSP, src, dst, mspPostProcessFn);
+        return ret == MSP_RESULT_CMD_UNKNOWN ? MSP_RESULT_ERROR : ret;
+    }
+#ifdef USE_SERIAL_4WAY_BLHELI_INTERFACE
+    case MSP_HANDLER_4WAY:
+        mspFc4waySerialCommand(dst, src, mspPostProcessFn);
+        return MSP_RESULT_ACK;
+#endif
+#ifdef USE_FLASHFS
+    case MSP_HANDLER_DATAFLASH_READ:
+        mspFcDataFlashReadCommand(dst, src);
+        return MSP_RESULT_ACK;
+#endif
+    case MSP_HANDLER_IN:
+        return mspCommonProcessInCommand(cmdMSP, src, mspPostProcessFn);
+    default:
+        // we do not know how to handle the (valid) message, indicate error MSP $M!
+        return MSP_RESULT_ERROR;
+    }
+}
+
+#ifdef USE_MSP_STREAMING
+/*
+ * MSP2_SUBSCRIBE makes the flight controller stream the replies to a set of commands without arguments, so that a
+ * ground station doesn't have to poll them.
+ *
+ * Request: u8 count, then count times u8 command and u16 interval in ms. A count of 0 cancels the subscription.
+ * The reply is the number of commands accepted as u8, commands that take arguments or are unknown are skipped.
+ *
+ * While the port is idle the most overdue command is answered with a reply of its own, one per pass of the serial
+ * task, so the total rate is bounded by serial_update_rate_hz and the baud rate. Any other traffic on the port is
+ * served in between, and a subscription is shared by all MSP ports.
+ */
+#define MSP_SUBSCRIPTION_COUNT 8
+
+typedef struct mspSubscription_s {
+    uint8_t cmd;
+    uint16_t intervalMs;
+    timeMs_t lastSentMs;
+} mspSubscription_t;
+
+static mspSubscription_t mspSubscriptions[MSP_SUBSCRIPTION_COUNT];
+static uint8_t mspSubscriptionCount;
+static uint8_t mspSubscriptionNext;
+
+static bool mspSubscriptionAllowed(uint8_t cmdMSP)
+{
+    const uint8_t handler = mspCommands[cmdMSP].handler;
+
+    return handler == MSP_HANDLER_COMMON_OUT || handler == MSP_HANDLER_OUT;
+}
+
+static mspResult_e mspFcSubscribeCommand(mspPacket_t *reply, sbuf_t *src)
+{
+    sbuf_t *dst = &reply->buf;
+
+    if (sbufBytesRemaining(src) > 0) {
+        const uint8_t count = sbufReadU8(src);
+        if (sbufBytesRemaining(src) < (int)(count * (sizeof(uint8_t) + sizeof(uint16_t)))) {
+            return MSP_RESULT_ERROR;
+        }
+
+        const timeMs_t now = millis();
+        mspSubscriptionCount = 0;
+        for (unsigned i = 0; i < count; i++) {
+            const uint8_t cmdMSP = sbufReadU8(src);
+            const uint16_t intervalMs = sbufReadU16(src);
+            if (mspSubscriptionCount < MSP_SUBSCRIPTION_COUNT && mspSubscriptionAllowed(cmdMSP)) {
+                mspSubscription_t *subscription = &mspSubscriptions[mspSubscriptionCount++];
+                subscription->cmd = cmdMSP;
+                subscription->intervalMs = intervalMs;
+                subscription->lastSentMs = now - intervalMs;
+            }
+        }
+        sbufWriteU8(dst, mspSubscriptionCount);
+
+        return mspSubscriptionCount ? MSP_RESULT_STREAM : MSP_RESULT_ACK;
+    }
+
+    if (!mspSubscriptionCount) {
+        return MSP_RESULT_ERROR;
+    }
+
+    // An empty command asks for the next reply while the port is idle
+    const timeMs_t now = millis();
+    mspSubscription_t *due = NULL;
+    int32_t dueOverdueMs = -1;
+    // Ties go round robin, starting after the last command sent
+    for (unsigned n = 0; n < mspSubscriptionCount; n++) {
+        const unsigned i = (mspSubscriptionNext + n) % mspSubscriptionCount;
+        const int32_t overdueMs = cmp32(now, mspSubscriptions[i].lastSentMs) - mspSubscriptions[i].intervalMs;
+        if (overdueMs > dueOverdueMs) {
+            due = &mspSubscriptions[i];
+            dueOverdueMs = overdueMs;
+            mspSubscriptionNext = i + 1;
+        }
+    }
+
+    if (due) {
+        uint8_t *head = dst->ptr;
+        sbuf_t noArgs = { .ptr = head, .end = head };
+        due->lastSentMs = now;
+        reply->cmd = due->cmd;
+        if (mspFcDispatchCommand(due->cmd, &noArgs, dst, NULL) != MSP_RESULT_ACK) {
+            // Compiled out of this build, the stream carries on without it
+            dst->ptr = head;
+            *due = mspSubscriptions[--mspSubscriptionCount];
+        }
+    }
+
+    return mspSubscriptionCount ? MSP_RESULT_STREAM : MSP_RESULT_ACK;
+}
+
+// Makes the subscribed replies to cmdMSP due now, for commands whose data changes at irregular times
+void mspFcSubscriptionTrigger(uint8_t cmdMSP)
+{
+    const timeMs_t now = millis();
+    for (unsigned i = 0; i < mspSubscriptionCount; i++) {
+        if (mspSubscriptions[i].cmd == cmdMSP) {
+            mspSubscriptions[i].lastSentMs = now - mspSubscriptions[i].intervalMs;
+        }
+    }
+}
+#endif
+
+/*
+ * Returns MSP_RESULT_ACK, MSP_RESULT_ERROR, MSP_RESULT_NO_REPLY or MSP_RESULT_STREAM
  */
 mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn)
 {
@@ -3279,24 +4088,26 @@ mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostPro
     // initialize reply by default
     reply->cmd = cmd->cmd;
 
-    if (mspCommonProcessOutCommand(cmdMSP, dst, mspPostProcessFn)) {
-        ret = MSP_RESULT_ACK;
-    } else if (mspProcessOutCommand(cmdMSP, dst)) {
-        ret = MSP_RESULT_ACK;
-    } else if ((ret = mspFcProcessOutCommandWithArg(cmdMSP, src, dst, mspPostProcessFn)) != MSP_RESULT_CMD_UNKNOWN) {
-        /* ret */;
-#ifdef USE_SERIAL_4WAY_BLHELI_INTERFACE
-    } else if (cmdMSP == MSP_SET_4WAY_IF) {
-        mspFc4waySerialCommand(dst, src, mspPostProcessFn);
-        ret = MSP_RESULT_ACK;
+    // MSPv2 commands have to be checked ahead of the MSPv1 commands that their truncated cmdMSP would alias
+#ifdef USE_MSP_SETTINGS
+    if (cmd->cmd == MSP2_GET_SETTINGS) {
+        ret = mspFcGetSettingsCommand(dst, src);
+    } else if (cmd->cmd == MSP2_SET_SETTINGS) {
+        ret = mspFcSetSettingsCommand(dst, src);
+    } else
 #endif
 #ifdef USE_FLASHFS
-    } else if (cmdMSP == MSP_DATAFLASH_READ) {
-        mspFcDataFlashReadCommand(dst, src);
-        ret = MSP_RESULT_ACK;
+    if (cmd->cmd == MSP2_DATAFLASH_STREAM) {
+        ret = mspFcDataflashStreamCommand(dst, src);
+    } else
 #endif
-    } else {
-        ret = mspCommonProcessInCommand(cmdMSP, src, mspPostProcessFn);
+#ifdef USE_MSP_STREAMING
+    if (cmd->cmd == MSP2_SUBSCRIBE) {
+        ret = mspFcSubscribeCommand(reply, src);
+    } else
+#endif
+    {
+        ret = mspFcDispatchCommand(cmdMSP, src, dst, mspPostProcessFn);
     }
     reply->result = ret;
     return ret;
@@ -39,6 +39,7 @@ typedef enum {
     MSP_RESULT_ERROR = -1,
     MSP_RESULT_NO_REPLY = 0,
     MSP_RESULT_CMD_UNKNOWN = -2,   // don't know how to process command, try next handler
+    MSP_RESULT_STREAM = 2,         // ACK, and the command is repeated with an empty payload while the port is idle to stream more replies, empty replies are not sent
 } mspResult_e;
 
 typedef enum {
@@ -63,3 +64,4 @@ typedef void (*mspProcessReplyFnPtr)(mspPacket_t *cmd);
 void mspInit(void);
 mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn);
 void mspFcProcessReply(mspPacket_t *reply);
+void mspFcSubscriptionTrigger(uint8_t cmdMSP);
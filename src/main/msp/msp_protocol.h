@@ -284,6 +284,12 @@
 #define MSP_VTXTABLE_BAND        137    //out message         vtxTable band/channel data
 #define MSP_VTXTABLE_POWERLEVEL  138    //out message         vtxTable powerLevel data
 #define MSP_MOTOR_TELEMETRY      139    //out message         Per-motor telemetry data (RPM, packet stats, ESC temp, etc.)
+#define MSP_TASK_PROFILE         140    //out message         Execution time and start lateness histograms of one scheduler task
+#define MSP_RC_LATENCY           141    //out message         Latency histogram of one stage between an RC frame and the motor outputs
+#define MSP_STACK_INFO           142    //out message         Stack high-water mark, interrupt nesting and sampled stack depth per task
+#define MSP_TRACE                143    //out message         One chunk of the scheduler and driver event trace, optionally freezing or rearming it
+#define MSP_CRASH_LOG            144    //out message         Entries of the overrun and fault log kept across reboots, optionally clearing it
+#define MSP_ARMING_DISABLE_FLAGS 145    //out message         Arming disable flags, a subscription gets them as soon as they change
 
 #define MSP_SET_RAW_RC           200    //in message          8 rc chan
 #define MSP_SET_RAW_GPS          201    //in message          fix, numsat, lat, lon, alt, speed
@@ -341,3 +347,9 @@
 #define MSP_RTC                  247    //out message         Gets the RTC clock
 #define MSP_SET_BOARD_INFO       248    //in message          Sets the board information for this board
 #define MSP_SET_SIGNATURE        249    //in message          Sets the signature of the board and serial number
+
+// MSPv2 commands, only valid in MSPv2 frames
+#define MSP2_DATAFLASH_STREAM    0x3010 //out message         Streams the content of the dataflash chip in acknowledged windows of chunks
+#define MSP2_GET_SETTINGS        0x3011 //out message         Reads a list of CLI settings by index
+#define MSP2_SET_SETTINGS        0x3012 //in message          Writes a list of CLI settings by index
+#define MSP2_SUBSCRIBE           0x3013 //in message          Streams the replies to a set of commands at the requested intervals
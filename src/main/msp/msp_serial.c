@@ -32,12 +32,15 @@
 #include "common/utils.h"
 #include "common/crc.h"
 
+#include "drivers/serial_usb_msp.h"
 #include "drivers/system.h"
 
 #include "io/serial.h"
 
 #include "msp/msp.h"
 
+#include "pg/usb.h"
+
 #include "msp_serial.h"
 
 static mspPort_t mspPorts[MAX_MSP_PORT_COUNT];
@@ -70,6 +73,25 @@ void mspSerialAllocatePorts(void)
 
         portConfig = findNextSerialPortConfig(FUNCTION_MSP);
     }
+
+#ifdef USE_USB_MSP_BULK
+    // The bulk interface is not a configurable serial port, it is always MSP when enabled
+    if (usbDevConfig()->mspBulk) {
+        serialPort_t *bulkPort = usbMspOpen();
+        mspPort_t *freeMspPort = NULL;
+        for (portIndex = 0; portIndex < MAX_MSP_PORT_COUNT; portIndex++) {
+            if (mspPorts[portIndex].port == bulkPort) {
+                return;
+            }
+            if (!mspPorts[portIndex].port && !freeMspPort) {
+                freeMspPort = &mspPorts[portIndex];
+            }
+        }
+        if (freeMspPort) {
+            resetMspPort(freeMspPort, bulkPort, false);
+        }
+    }
+#endif
 }
 
 void mspSerialReleasePortIfAllocated(serialPort_t *serialPort)
@@ -269,14 +291,6 @@ static bool mspSerialProcessReceivedData(mspPort_t *mspPort, uint8_t c)
     return true;
 }
 
-static uint8_t mspSerialChecksumBuf(uint8_t checksum, const uint8_t *data, int len)
-{
-    while (len-- > 0) {
-        checksum ^= *data++;
-    }
-    return checksum;
-}
-
 #define JUMBO_FRAME_SIZE_LIMIT 255
 static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, const uint8_t * data, int dataLen, const uint8_t * crc, int crcLen)
 {
@@ -288,6 +302,16 @@ static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, c
     if (!isSerialTransmitBufferEmpty(msp->port) && ((int)serialTxBytesFree(msp->port) < totalFrameLength))
         return 0;
 
+    // Frames that fit are built in place in the transmit buffer and the transmission is started once
+    uint8_t *frame = serialReserveWrite(msp->port, totalFrameLength);
+    if (frame) {
+        memcpy(frame, hdr, hdrLen);
+        memcpy(frame + hdrLen, data, dataLen);
+        memcpy(frame + hdrLen + dataLen, crc, crcLen);
+        serialCommitWrite(msp->port, totalFrameLength);
+        return totalFrameLength;
+    }
+
     // Transmit frame
     serialBeginWrite(msp->port);
     serialWriteBuf(msp->port, hdr, hdrLen);
@@ -327,8 +351,8 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
         }
 
         // Pre-calculate CRC
-        checksum = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
-        checksum = mspSerialChecksumBuf(checksum, sbufPtr(&packet->buf), dataLen);
+        checksum = crc8_xor_update(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
+        checksum = crc8_xor_update(checksum, sbufPtr(&packet->buf), dataLen);
         crcBuf[crcLen++] = checksum;
     }
     else if (mspVersion == MSP_V2_OVER_V1) {
@@ -365,9 +389,9 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
         crcBuf[crcLen++] = checksum;
 
         // V1 CRC: All headers + data payload + V2 CRC byte
-        checksum = mspSerialChecksumBuf(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
-        checksum = mspSerialChecksumBuf(checksum, sbufPtr(&packet->buf), dataLen);
-        checksum = mspSerialChecksumBuf(checksum, crcBuf, crcLen);
+        checksum = crc8_xor_update(0, hdrBuf + V1_CHECKSUM_STARTPOS, hdrLen - V1_CHECKSUM_STARTPOS);
+        checksum = crc8_xor_update(checksum, sbufPtr(&packet->buf), dataLen);
+        checksum = crc8_xor_update(checksum, crcBuf, crcLen);
         crcBuf[crcLen++] = checksum;
     }
     else if (mspVersion == MSP_V2_NATIVE) {
@@ -415,7 +439,13 @@ static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspPr
     mspPostProcessFnPtr mspPostProcessFn = NULL;
     const mspResult_e status = mspProcessCommandFn(&command, &reply, &mspPostProcessFn);
 
-    if (status != MSP_RESULT_NO_REPLY) {
+    if (status == MSP_RESULT_STREAM) {
+        msp->streamCmd = msp->cmdMSP;
+    } else if (msp->cmdMSP == msp->streamCmd) {
+        msp->streamCmd = 0;
+    }
+
+    if (status != MSP_RESULT_NO_REPLY && !(status == MSP_RESULT_STREAM && reply.buf.ptr == outBufHead)) {
         sbufSwitchToReader(&reply.buf, outBufHead); // change streambuf direction
         mspSerialEncode(msp, &reply, msp->mspVersion);
     }
@@ -423,6 +453,20 @@ static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspPr
     return mspPostProcessFn;
 }
 
+static void mspSerialProcessStream(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    // Wait for the previous reply to go out, the next one is sent as a frame of its own
+    if (!msp->streamCmd || msp->c_state != MSP_IDLE || !isSerialTransmitBufferEmpty(msp->port)) {
+        return;
+    }
+
+    // The command is repeated with an empty payload to get the next reply of the stream
+    msp->cmdMSP = msp->streamCmd;
+    msp->cmdFlags = 0;
+    msp->dataSize = 0;
+    mspSerialProcessReceivedCommand(msp, mspProcessCommandFn);
+}
+
 static void mspEvaluateNonMspData(mspPort_t * mspPort, uint8_t receivedChar)
 {
    if (receivedChar == serialConfig()->reboot_character) {
@@ -483,55 +527,84 @@ static void mspSerialProcessReceivedReply(mspPort_t *msp, mspProcessReplyFnPtr m
     msp->c_state = MSP_IDLE;
 }
 
+// Bytes taken from one port in a run, enough for a full frame with the largest payload
+#define MSP_PORT_RX_BYTE_BUDGET 256
+// Once a run has taken this long the remaining ports wait for the next run
+#define MSP_SERIAL_PROCESS_TIME_BUDGET_US 500
+
+static void mspSerialProcessPort(mspPort_t *mspPort, mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn, mspProcessReplyFnPtr mspProcessReplyFn)
+{
+    mspPostProcessFnPtr mspPostProcessFn = NULL;
+
+    if (serialRxBytesWaiting(mspPort->port)) {
+        // There are bytes incoming - abort pending request
+        mspPort->lastActivityMs = millis();
+        mspPort->pendingRequest = MSP_PENDING_NONE;
+
+        for (unsigned budget = MSP_PORT_RX_BYTE_BUDGET; budget && serialRxBytesWaiting(mspPort->port); budget--) {
+            const uint8_t c = serialRead(mspPort->port);
+            const bool consumed = mspSerialProcessReceivedData(mspPort, c);
+
+            if (!consumed && evaluateNonMspData == MSP_EVALUATE_NON_MSP_DATA) {
+                mspEvaluateNonMspData(mspPort, c);
+            }
+
+            if (mspPort->c_state == MSP_COMMAND_RECEIVED) {
+                if (mspPort->packetType == MSP_PACKET_COMMAND) {
+                    mspPostProcessFn = mspSerialProcessReceivedCommand(mspPort, mspProcessCommandFn);
+                } else if (mspPort->packetType == MSP_PACKET_REPLY) {
+                    mspSerialProcessReceivedReply(mspPort, mspProcessReplyFn);
+                }
+
+                mspPort->c_state = MSP_IDLE;
+                break; // process one command at a time so as not to block.
+            }
+        }
+
+        if (mspPostProcessFn) {
+            waitForSerialPortToFinishTransmitting(mspPort->port);
+            mspPostProcessFn(mspPort->port);
+        }
+    }
+    else {
+        mspProcessPendingRequest(mspPort);
+    }
+
+    if (!mspPostProcessFn) {
+        mspSerialProcessStream(mspPort, mspProcessCommandFn);
+    }
+}
+
 /*
  * Process MSP commands from serial ports configured as MSP ports.
  *
- * Called periodically by the scheduler.
+ * Called periodically by the scheduler. Each port gets a byte budget and the ports take turns at being
+ * first, so a port that is flooded or a slow command delays the other ports by one run at most.
  */
 void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn, mspProcessReplyFnPtr mspProcessReplyFn)
 {
-    for (uint8_t portIndex = 0; portIndex < MAX_MSP_PORT_COUNT; portIndex++) {
-        mspPort_t * const mspPort = &mspPorts[portIndex];
+    static uint8_t firstPortIndex;
+
+    const timeUs_t startUs = micros();
+
+    for (unsigned i = 0; i < MAX_MSP_PORT_COUNT; i++) {
+        mspPort_t * const mspPort = &mspPorts[(firstPortIndex + i) % MAX_MSP_PORT_COUNT];
         if (!mspPort->port) {
             continue;
         }
 
-        mspPostProcessFnPtr mspPostProcessFn = NULL;
-
-        if (serialRxBytesWaiting(mspPort->port)) {
-            // There are bytes incoming - abort pending request
-            mspPort->lastActivityMs = millis();
-            mspPort->pendingRequest = MSP_PENDING_NONE;
-
-            while (serialRxBytesWaiting(mspPort->port)) {
-                const uint8_t c = serialRead(mspPort->port);
-                const bool consumed = mspSerialProcessReceivedData(mspPort, c);
-
-                if (!consumed && evaluateNonMspData == MSP_EVALUATE_NON_MSP_DATA) {
-                    mspEvaluateNonMspData(mspPort, c);
-                }
-
-                if (mspPort->c_state == MSP_COMMAND_RECEIVED) {
-                    if (mspPort->packetType == MSP_PACKET_COMMAND) {
-                        mspPostProcessFn = mspSerialProcessReceivedCommand(mspPort, mspProcessCommandFn);
-                    } else if (mspPort->packetType == MSP_PACKET_REPLY) {
-                        mspSerialProcessReceivedReply(mspPort, mspProcessReplyFn);
-                    }
+        if (cmpTimeUs(micros(), startUs) >= MSP_SERIAL_PROCESS_TIME_BUDGET_US) {
+            mspPort->deferredBytes += serialRxBytesWaiting(mspPort->port);
+            continue;
+        }
 
-                    mspPort->c_state = MSP_IDLE;
-                    break; // process one command at a time so as not to block.
-                }
-            }
+        mspSerialProcessPort(mspPort, evaluateNonMspData, mspProcessCommandFn, mspProcessReplyFn);
 
-            if (mspPostProcessFn) {
-                waitForSerialPortToFinishTransmitting(mspPort->port);
-                mspPostProcessFn(mspPort->port);
-            }
-        }
-        else {
-            mspProcessPendingRequest(mspPort);
-        }
+        // whatever the byte budget left behind waits for the next run
+        mspPort->deferredBytes += serialRxBytesWaiting(mspPort->port);
     }
+
+    firstPortIndex = (firstPortIndex + 1) % MAX_MSP_PORT_COUNT;
 }
 
 bool mspSerialWaiting(void)
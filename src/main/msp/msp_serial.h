@@ -110,6 +110,8 @@ typedef struct mspPort_s {
     uint8_t checksum1;
     uint8_t checksum2;
     bool sharedWithTelemetry;
+    uint16_t streamCmd; // command repeated while the port is idle, 0 when not streaming
+    uint32_t deferredBytes; // received bytes left waiting at the end of a run, summed over the runs
 } mspPort_t;
 
 void mspSerialInit(void);
@@ -75,6 +75,7 @@
 
 #include "osd/osd.h"
 #include "osd/osd_elements.h"
+#include "osd/osd_warnings.h"
 
 #include "pg/pg.h"
 #include "pg/pg_ids.h"
@@ -110,10 +111,14 @@ float osdGForce = 0;
 #endif
 
 static bool showVisualBeeper = false;
+static bool drawingElements = false;    // a pass over the elements did not fit in its time slice
 
 static statistic_t stats;
 timeUs_t resumeRefreshAt = 0;
 #define REFRESH_1S    1000 * 1000
+// Elements are only rewritten when they change, the whole screen is redrawn this often to
+// restore a display that dropped characters (e.g. an MSP displayport that was power cycled)
+#define FULL_REDRAW_INTERVAL_US (1 * REFRESH_1S)
 
 static uint8_t armState;
 #ifdef USE_OSD_PROFILES
@@ -223,14 +228,22 @@ void changeOsdProfileIndex(uint8_t profileIndex)
 
 static void osdDrawElements(timeUs_t currentTimeUs)
 {
-    displayClearScreen(osdDisplayPort);
+    static timeUs_t fullRedrawAt = 0;
 
     // Hide OSD when OSDSW mode is active
     if (IS_RC_MODE_ACTIVE(BOXOSD)) {
+        if (!osdDisplayPort->cleared) {
+            displayClearScreen(osdDisplayPort);
+        }
         return;
     }
 
-    osdDrawActiveElements(osdDisplayPort, currentTimeUs);
+    if (cmp32(currentTimeUs, fullRedrawAt) >= 0) {
+        displayClearScreen(osdDisplayPort);
+        fullRedrawAt = currentTimeUs + FULL_REDRAW_INTERVAL_US;
+    }
+
+    drawingElements = !osdDrawActiveElements(osdDisplayPort, currentTimeUs);
 }
 
 const uint16_t osdTimerDefault[OSD_TIMER_COUNT] = {
@@ -782,6 +795,8 @@ STATIC_UNIT_TESTED void osdRefresh(timeUs_t currentTimeUs)
     static bool osdStatsVisible = false;
     static timeUs_t osdStatsRefreshTimeUs;
 
+    drawingElements = false;
+
     // detect arm/disarm
     if (armState != ARMING_FLAG(ARMED)) {
         if (ARMING_FLAG(ARMED)) {
@@ -805,7 +820,6 @@ STATIC_UNIT_TESTED void osdRefresh(timeUs_t currentTimeUs)
 
 
     if (ARMING_FLAG(ARMED)) {
-        osdUpdateStats();
         timeUs_t deltaT = currentTimeUs - lastTimeUs;
         osdFlyTime += deltaT;
         stats.armed_time += deltaT;
@@ -876,6 +890,21 @@ STATIC_UNIT_TESTED void osdRefresh(timeUs_t currentTimeUs)
     }
 }
 
+/*
+ * The stats and the warnings are evaluated in a slot of their own, the refresh only draws them.
+ */
+STATIC_UNIT_TESTED void osdUpdateWarningsAndStats(timeUs_t currentTimeUs)
+{
+    // armState is that of the last refresh, which resets the stats on arming
+    if (armState) {
+        osdUpdateStats();
+    }
+
+    osdWarningsUpdate(currentTimeUs);
+    // the warnings now hold the beeper until their next update
+    showVisualBeeper = false;
+}
+
 /*
  * Called periodically by the scheduler
  */
@@ -913,7 +942,11 @@ void osdUpdate(timeUs_t currentTimeUs)
 
     if (counter % DRAW_FREQ_DENOM == 0) {
         osdRefresh(currentTimeUs);
-        showVisualBeeper = false;
+    } else if (counter % DRAW_FREQ_DENOM == 1) {
+        osdUpdateWarningsAndStats(currentTimeUs);
+    } else if (drawingElements && !displayIsGrabbed(osdDisplayPort)) {
+        // draw the elements that did not fit in the time slice of the refresh
+        drawingElements = !osdDrawActiveElements(osdDisplayPort, currentTimeUs);
     } else {
         // rest of time redraw screen 10 chars per idle so it doesn't lock the main idle
         displayDrawScreen(osdDisplayPort);
@@ -132,6 +132,7 @@ typedef enum {
     OSD_PID_PROFILE_NAME,
     OSD_PROFILE_NAME,
     OSD_RSSI_DBM_VALUE,
+    OSD_LOOP_TIMING,
     OSD_ITEM_COUNT // MUST BE LAST
 } osd_items_e;
 
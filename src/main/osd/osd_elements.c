@@ -57,6 +57,7 @@
 #include "build/debug.h"
 
 #include "common/axis.h"
+#include "common/crc.h"
 #include "common/maths.h"
 #include "common/printf.h"
 #include "common/typeconversion.h"
@@ -73,6 +74,7 @@
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
 #include "fc/core.h"
+#include "fc/loop_timing.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
 #include "fc/rc_modes.h"
@@ -92,6 +94,7 @@
 
 #include "osd/osd.h"
 #include "osd/osd_elements.h"
+#include "osd/osd_warnings.h"
 
 #include "pg/motor.h"
 
@@ -159,6 +162,117 @@ static uint32_t blinkBits[(OSD_ITEM_COUNT + 31) / 32];
 #define IS_BLINK(item) (blinkBits[(item) / 32] & (1 << ((item) % 32)))
 #define BLINK(item) (IS_BLINK(item) && blinkState)
 
+// Change detection, an element is only written to the display when what it draws differs
+// from the previous pass, and only the characters it no longer covers are erased.
+// Elements that draw themselves collect their characters here so they can be compared first.
+#define OSD_ELEMENT_MAX_CELLS 48
+
+typedef struct osdElementCell_s {
+    uint8_t x;
+    uint8_t y;
+    char c;
+} osdElementCell_t;
+
+typedef struct osdElementArea_s {
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;  // 0 when nothing is drawn
+    uint8_t height;
+} osdElementArea_t;
+
+typedef struct osdElementCache_s {
+    osdElementArea_t area;
+    uint16_t crc;
+    bool dirty;     // overwritten or erased by another element, redraw even if unchanged
+} osdElementCache_t;
+
+static osdElementCache_t osdElementCache[OSD_ITEM_COUNT];
+static bool osdElementCacheValid = false;
+
+static osdElementCell_t osdElementCells[OSD_ELEMENT_MAX_CELLS];
+static unsigned osdElementCellCount;
+
+// Elements are drawn in slices of at most OSD_ELEMENT_DRAW_BUDGET_US, a pass over the active
+// elements may span several calls. Each element is drawn on every pass, every second pass or
+// every fourth pass depending on how quickly what it shows changes.
+#define OSD_ELEMENT_DRAW_BUDGET_US 100
+
+typedef enum {
+    OSD_ELEMENT_RATE_NORMAL = 0,
+    OSD_ELEMENT_RATE_FAST,
+    OSD_ELEMENT_RATE_SLOW,
+} osdElementRate_e;
+
+static const uint8_t osdElementRateDivider[] = {
+    [OSD_ELEMENT_RATE_NORMAL] = 2,
+    [OSD_ELEMENT_RATE_FAST]   = 1,
+    [OSD_ELEMENT_RATE_SLOW]   = 4,
+};
+
+// Elements not listed are OSD_ELEMENT_RATE_NORMAL
+static const uint8_t osdElementUpdateRate[OSD_ITEM_COUNT] = {
+    [OSD_RSSI_VALUE]              = OSD_ELEMENT_RATE_FAST,
+    [OSD_CROSSHAIRS]              = OSD_ELEMENT_RATE_SLOW,
+    [OSD_ARTIFICIAL_HORIZON]      = OSD_ELEMENT_RATE_FAST,
+    [OSD_HORIZON_SIDEBARS]        = OSD_ELEMENT_RATE_SLOW,
+    [OSD_CRAFT_NAME]              = OSD_ELEMENT_RATE_SLOW,
+    [OSD_THROTTLE_POS]            = OSD_ELEMENT_RATE_FAST,
+    [OSD_VTX_CHANNEL]             = OSD_ELEMENT_RATE_SLOW,
+    [OSD_MAH_DRAWN]               = OSD_ELEMENT_RATE_SLOW,
+    [OSD_ALTITUDE]                = OSD_ELEMENT_RATE_FAST,
+    [OSD_ROLL_PIDS]               = OSD_ELEMENT_RATE_SLOW,
+    [OSD_PITCH_PIDS]              = OSD_ELEMENT_RATE_SLOW,
+    [OSD_YAW_PIDS]                = OSD_ELEMENT_RATE_SLOW,
+    [OSD_PIDRATE_PROFILE]         = OSD_ELEMENT_RATE_SLOW,
+    [OSD_WARNINGS]                = OSD_ELEMENT_RATE_FAST,
+    [OSD_PITCH_ANGLE]             = OSD_ELEMENT_RATE_FAST,
+    [OSD_ROLL_ANGLE]              = OSD_ELEMENT_RATE_FAST,
+    [OSD_MAIN_BATT_USAGE]         = OSD_ELEMENT_RATE_SLOW,
+    [OSD_NUMERICAL_HEADING]       = OSD_ELEMENT_RATE_FAST,
+    [OSD_NUMERICAL_VARIO]         = OSD_ELEMENT_RATE_FAST,
+    [OSD_COMPASS_BAR]             = OSD_ELEMENT_RATE_FAST,
+    [OSD_ESC_TMP]                 = OSD_ELEMENT_RATE_SLOW,
+    [OSD_REMAINING_TIME_ESTIMATE] = OSD_ELEMENT_RATE_SLOW,
+    [OSD_RTC_DATETIME]            = OSD_ELEMENT_RATE_SLOW,
+    [OSD_CORE_TEMPERATURE]        = OSD_ELEMENT_RATE_SLOW,
+    [OSD_G_FORCE]                 = OSD_ELEMENT_RATE_FAST,
+    [OSD_LOG_STATUS]              = OSD_ELEMENT_RATE_SLOW,
+    [OSD_FLIP_ARROW]              = OSD_ELEMENT_RATE_FAST,
+    [OSD_LINK_QUALITY]            = OSD_ELEMENT_RATE_FAST,
+    [OSD_STICK_OVERLAY_LEFT]      = OSD_ELEMENT_RATE_FAST,
+    [OSD_STICK_OVERLAY_RIGHT]     = OSD_ELEMENT_RATE_FAST,
+    [OSD_DISPLAY_NAME]            = OSD_ELEMENT_RATE_SLOW,
+    [OSD_RATE_PROFILE_NAME]       = OSD_ELEMENT_RATE_SLOW,
+    [OSD_PID_PROFILE_NAME]        = OSD_ELEMENT_RATE_SLOW,
+    [OSD_PROFILE_NAME]            = OSD_ELEMENT_RATE_SLOW,
+    [OSD_RSSI_DBM_VALUE]          = OSD_ELEMENT_RATE_FAST,
+    [OSD_LOOP_TIMING]             = OSD_ELEMENT_RATE_SLOW,
+};
+
+static unsigned osdElementDrawIndex = 0;    // position in activeOsdElementArray of the pass in progress
+static unsigned osdElementPassCount = 0;
+static bool osdElementFullPass = false;     // draw every element regardless of its rate
+
+static void osdElementWriteChar(osdElementParms_t *element, uint8_t x, uint8_t y, char c)
+{
+    if (osdElementCellCount < OSD_ELEMENT_MAX_CELLS) {
+        osdElementCell_t *cell = &osdElementCells[osdElementCellCount++];
+        cell->x = x;
+        cell->y = y;
+        cell->c = c;
+    }
+    element->drawElement = false;
+}
+
+#if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_TELEMETRY)
+static void osdElementWrite(osdElementParms_t *element, uint8_t x, uint8_t y, const char *s)
+{
+    while (*s) {
+        osdElementWriteChar(element, x++, y, *s++);
+    }
+}
+#endif
+
 #if defined(USE_ESC_SENSOR) || defined(USE_DSHOT_TELEMETRY)
 typedef int (*getEscRpmOrFreqFnPtr)(int i);
 
@@ -189,9 +303,8 @@ static void renderOsdEscRpmOrFreq(getEscRpmOrFreqFnPtr escFnPtr, osdElementParms
     for (int i=0; i < getMotorCount(); i++) {
         char rpmStr[6];
         const int rpm = MIN((*escFnPtr)(i),99999);
-        const int len = tfp_sprintf(rpmStr, "%d", rpm);
-        rpmStr[len] = '\0';
-        displayWrite(element->osdDisplayPort, x, y + i, rpmStr);
+        i2aPadded(rpm, 0, ' ', rpmStr);
+        osdElementWrite(element, x, y + i, rpmStr);
     }
     element->drawElement = false;
 }
@@ -209,6 +322,20 @@ int osdConvertTemperatureToSelectedUnit(int tempInDegreesCelcius)
 }
 #endif
 
+// printf free "%c%*d%c" for the numeric elements redrawn on every pass, value is a fixed
+// point number with decimals digits after the decimal point. prefix and suffix may be SYM_NONE.
+static void osdFormatValue(char *buff, char prefix, int value, unsigned decimals, unsigned width, char pad, char suffix)
+{
+    if (prefix != SYM_NONE) {
+        *buff++ = prefix;
+    }
+    buff = fixed2a(value, decimals, width, pad, buff);
+    if (suffix != SYM_NONE) {
+        *buff++ = suffix;
+    }
+    *buff = '\0';
+}
+
 static void osdFormatAltitudeString(char * buff, int32_t altitudeCm)
 {
     const int alt = osdGetMetersToSelectedUnit(altitudeCm) / 10;
@@ -218,7 +345,7 @@ static void osdFormatAltitudeString(char * buff, int32_t altitudeCm)
         buff[pos++] = '-';
     else
         buff[pos++] = '+';
-    tfp_sprintf(buff + pos, "%01d.%01d%c", abs(alt) / 10 , abs(alt) % 10, osdGetMetersToSelectedUnitSymbol());
+    osdFormatValue(buff + pos, SYM_NONE, abs(alt), 1, 0, ' ', osdGetMetersToSelectedUnitSymbol());
 }
 
 #ifdef USE_GPS
@@ -235,7 +362,7 @@ static void osdFormatCoordinate(char *buff, char sym, int32_t val)
         buff[pos++] = '-';
         val = -val;
     }
-    tfp_sprintf(buff + pos, "%d.%07d", val / GPS_DEGREES_DIVIDER, val % GPS_DEGREES_DIVIDER);
+    fixed2a(val, 7, 0, ' ', buff + pos);
 }
 #endif // USE_GPS
 
@@ -263,20 +390,31 @@ void osdFormatDistanceString(char *ptr, int distance, char leadingSymbol)
     }
 
     if (convertedDistance < unitTransition) {
-        tfp_sprintf(ptr, "%d%c", convertedDistance, unitSymbol);
+        ptr = i2aPadded(convertedDistance, 0, ' ', ptr);
+        *ptr++ = unitSymbol;
     } else {
         const int displayDistance = convertedDistance * 100 / unitTransition;
         if (displayDistance >= 1000) { // >= 10 miles or km - 1 decimal place
-            tfp_sprintf(ptr, "%d.%d%c", displayDistance / 100, (displayDistance / 10) % 10, unitSymbolExtended);
+            ptr = fixed2a(displayDistance / 10, 1, 0, ' ', ptr);
         } else {                     // < 10 miles or km - 2 decimal places
-            tfp_sprintf(ptr, "%d.%02d%c", displayDistance / 100, displayDistance % 100, unitSymbolExtended);
+            ptr = fixed2a(displayDistance, 2, 0, ' ', ptr);
         }
+        *ptr++ = unitSymbolExtended;
     }
+    *ptr = '\0';
 }
 
 static void osdFormatPID(char * buff, const char * label, const pidf_t * pid)
 {
-    tfp_sprintf(buff, "%s %3d %3d %3d", label, pid->P, pid->I, pid->D);
+    const size_t labelLength = strlen(label);
+    memcpy(buff, label, labelLength);
+    buff += labelLength;
+    *buff++ = ' ';
+    buff = i2aPadded(pid->P, 3, ' ', buff);
+    *buff++ = ' ';
+    buff = i2aPadded(pid->I, 3, ' ', buff);
+    *buff++ = ' ';
+    i2aPadded(pid->D, 3, ' ', buff);
 }
 
 #ifdef USE_RTC_TIME
@@ -301,21 +439,23 @@ void osdFormatTime(char * buff, osd_timer_precision_e precision, timeUs_t time)
     const int minutes = seconds / 60;
     seconds = seconds % 60;
 
+    buff = i2aPadded(minutes, 2, '0', buff);
+    *buff++ = ':';
     switch (precision) {
     case OSD_TIMER_PREC_SECOND:
     default:
-        tfp_sprintf(buff, "%02d:%02d", minutes, seconds);
+        i2aPadded(seconds, 2, '0', buff);
         break;
     case OSD_TIMER_PREC_HUNDREDTHS:
         {
             const int hundredths = (time / 10000) % 100;
-            tfp_sprintf(buff, "%02d:%02d.%02d", minutes, seconds, hundredths);
+            fixed2a(seconds * 100 + hundredths, 2, 5, '0', buff);
             break;
         }
     case OSD_TIMER_PREC_TENTHS:
         {
             const int tenths = (time / 100000) % 10;
-            tfp_sprintf(buff, "%02d:%02d.%01d", minutes, seconds, tenths);
+            fixed2a(seconds * 10 + tenths, 1, 4, '0', buff);
             break;
         }
     }
@@ -518,7 +658,8 @@ static void osdElementAltitude(osdElementParms_t *element)
 static void osdElementAngleRollPitch(osdElementParms_t *element)
 {
     const int angle = (element->item == OSD_PITCH_ANGLE) ? attitude.values.pitch : attitude.values.roll;
-    tfp_sprintf(element->buff, "%c%c%02d.%01d", (element->item == OSD_PITCH_ANGLE) ? SYM_PITCH : SYM_ROLL , angle < 0 ? '-' : ' ', abs(angle / 10), abs(angle % 10));
+    element->buff[0] = (element->item == OSD_PITCH_ANGLE) ? SYM_PITCH : SYM_ROLL;
+    osdFormatValue(element->buff + 1, angle < 0 ? '-' : ' ', abs(angle), 1, 4, '0', SYM_NONE);
 }
 #endif
 
@@ -548,7 +689,7 @@ static void osdElementArtificialHorizon(osdElementParms_t *element)
     for (int x = -4; x <= 4; x++) {
         const int y = ((-rollAngle * x) / 64) - pitchAngle;
         if (y >= 0 && y <= 81) {
-            displayWriteChar(element->osdDisplayPort, element->elemPosX + x, element->elemPosY + (y / AH_SYMBOL_COUNT), (SYM_AH_BAR9_0 + (y % AH_SYMBOL_COUNT)));
+            osdElementWriteChar(element, element->elemPosX + x, element->elemPosY + (y / AH_SYMBOL_COUNT), (SYM_AH_BAR9_0 + (y % AH_SYMBOL_COUNT)));
         }
     }
 
@@ -560,7 +701,7 @@ static void osdElementAverageCellVoltage(osdElementParms_t *element)
 {
     const int cellV = getBatteryAverageCellVoltage();
     element->buff[0] = osdGetBatterySymbol(cellV);
-    tfp_sprintf(element->buff + 1, "%d.%02d%c", cellV / 100, cellV % 100, SYM_VOLT);
+    osdFormatValue(element->buff + 1, SYM_NONE, cellV, 2, 0, ' ', SYM_VOLT);
 }
 
 static void osdElementCompassBar(osdElementParms_t *element)
@@ -572,7 +713,8 @@ static void osdElementCompassBar(osdElementParms_t *element)
 #ifdef USE_ADC_INTERNAL
 static void osdElementCoreTemperature(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "C%c%3d%c", SYM_TEMPERATURE, osdConvertTemperatureToSelectedUnit(getCoreTemperatureCelsius()), osdGetTemperatureSymbolForSelectedUnit());
+    element->buff[0] = 'C';
+    osdFormatValue(element->buff + 1, SYM_TEMPERATURE, osdConvertTemperatureToSelectedUnit(getCoreTemperatureCelsius()), 0, 3, ' ', osdGetTemperatureSymbolForSelectedUnit());
 }
 #endif // USE_ADC_INTERNAL
 
@@ -648,12 +790,18 @@ static void osdElementCrosshairs(osdElementParms_t *element)
 static void osdElementCurrentDraw(osdElementParms_t *element)
 {
     const int32_t amperage = getAmperage();
-    tfp_sprintf(element->buff, "%3d.%02d%c", abs(amperage) / 100, abs(amperage) % 100, SYM_AMP);
+    osdFormatValue(element->buff, SYM_NONE, abs(amperage), 2, 6, ' ', SYM_AMP);
 }
 
 static void osdElementDebug(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "DBG %5d %5d %5d %5d", debug[0], debug[1], debug[2], debug[3]);
+    char *ptr = element->buff;
+    memcpy(ptr, "DBG", 3);
+    ptr += 3;
+    for (int i = 0; i < DEBUG16_VALUE_COUNT; i++) {
+        *ptr++ = ' ';
+        ptr = i2aPadded(debug[i], 5, ' ', ptr);
+    }
 }
 
 static void osdElementDisarmed(osdElementParms_t *element)
@@ -741,7 +889,8 @@ static void osdElementOsdProfileName(osdElementParms_t *element)
 static void osdElementEscTemperature(osdElementParms_t *element)
 {
     if (featureIsEnabled(FEATURE_ESC_SENSOR)) {
-        tfp_sprintf(element->buff, "E%c%3d%c", SYM_TEMPERATURE, osdConvertTemperatureToSelectedUnit(osdEscDataCombined->temperature), osdGetTemperatureSymbolForSelectedUnit());
+        element->buff[0] = 'E';
+        osdFormatValue(element->buff + 1, SYM_TEMPERATURE, osdConvertTemperatureToSelectedUnit(osdEscDataCombined->temperature), 0, 3, ' ', osdGetTemperatureSymbolForSelectedUnit());
     }
 }
 #endif // USE_ESC_SENSOR
@@ -790,7 +939,7 @@ static void osdElementFlymode(osdElementParms_t *element)
 static void osdElementGForce(osdElementParms_t *element)
 {
     const int gForce = lrintf(osdGForce * 10);
-    tfp_sprintf(element->buff, "%01d.%01dG", gForce / 10, gForce % 10);
+    osdFormatValue(element->buff, SYM_NONE, gForce, 1, 0, ' ', 'G');
 }
 #endif // USE_ACC
 
@@ -840,16 +989,18 @@ static void osdElementGpsLongitude(osdElementParms_t *element)
 
 static void osdElementGpsSats(osdElementParms_t *element)
 {
+    char *ptr = element->buff;
+    *ptr++ = SYM_SAT_L;
+    *ptr++ = SYM_SAT_R;
+    ptr = i2aPadded(gpsSol.numSat, 2, ' ', ptr);
     if (osdConfig()->gps_sats_show_hdop) {
-        tfp_sprintf(element->buff, "%c%c%2d %d.%d", SYM_SAT_L, SYM_SAT_R, gpsSol.numSat, gpsSol.hdop / 100, (gpsSol.hdop / 10) % 10);
-    } else {
-        tfp_sprintf(element->buff, "%c%c%2d", SYM_SAT_L, SYM_SAT_R, gpsSol.numSat);
+        osdFormatValue(ptr, ' ', gpsSol.hdop / 10, 1, 0, ' ', SYM_NONE);
     }
 }
 
 static void osdElementGpsSpeed(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "%c%3d%c", SYM_SPEED, osdGetSpeedToSelectedUnit(gpsConfig()->gps_use_3d_speed ? gpsSol.speed3d : gpsSol.groundSpeed), osdGetSpeedToSelectedUnitSymbol());
+    osdFormatValue(element->buff, SYM_SPEED, osdGetSpeedToSelectedUnit(gpsConfig()->gps_use_3d_speed ? gpsSol.speed3d : gpsSol.groundSpeed), 0, 3, ' ', osdGetSpeedToSelectedUnitSymbol());
 }
 #endif // USE_GPS
 
@@ -859,13 +1010,13 @@ static void osdElementHorizonSidebars(osdElementParms_t *element)
     const int8_t hudwidth = AH_SIDEBAR_WIDTH_POS;
     const int8_t hudheight = AH_SIDEBAR_HEIGHT_POS;
     for (int y = -hudheight; y <= hudheight; y++) {
-        displayWriteChar(element->osdDisplayPort, element->elemPosX - hudwidth, element->elemPosY + y, SYM_AH_DECORATION);
-        displayWriteChar(element->osdDisplayPort, element->elemPosX + hudwidth, element->elemPosY + y, SYM_AH_DECORATION);
+        osdElementWriteChar(element, element->elemPosX - hudwidth, element->elemPosY + y, SYM_AH_DECORATION);
+        osdElementWriteChar(element, element->elemPosX + hudwidth, element->elemPosY + y, SYM_AH_DECORATION);
     }
 
     // AH level indicators
-    displayWriteChar(element->osdDisplayPort, element->elemPosX - hudwidth + 1, element->elemPosY, SYM_AH_LEFT);
-    displayWriteChar(element->osdDisplayPort, element->elemPosX + hudwidth - 1, element->elemPosY, SYM_AH_RIGHT);
+    osdElementWriteChar(element, element->elemPosX - hudwidth + 1, element->elemPosY, SYM_AH_LEFT);
+    osdElementWriteChar(element, element->elemPosX + hudwidth - 1, element->elemPosY, SYM_AH_RIGHT);
 
     element->drawElement = false;  // element already drawn
 }
@@ -876,13 +1027,13 @@ static void osdElementLinkQuality(osdElementParms_t *element)
     uint16_t osdLinkQuality = 0;
     if (linkQualitySource == LQ_SOURCE_RX_PROTOCOL_CRSF) { // 0-300
         osdLinkQuality = rxGetLinkQuality()  / 3.41;
-        tfp_sprintf(element->buff, "%c%3d", SYM_LINK_QUALITY, osdLinkQuality);
+        osdFormatValue(element->buff, SYM_LINK_QUALITY, osdLinkQuality, 0, 3, ' ', SYM_NONE);
     } else { // 0-9
         osdLinkQuality = rxGetLinkQuality() * 10 / LINK_QUALITY_MAX_VALUE;
         if (osdLinkQuality >= 10) {
             osdLinkQuality = 9;
         }
-        tfp_sprintf(element->buff, "%c%1d", SYM_LINK_QUALITY, osdLinkQuality);
+        osdFormatValue(element->buff, SYM_LINK_QUALITY, osdLinkQuality, 0, 1, ' ', SYM_NONE);
     }
 }
 #endif // USE_RX_LINK_QUALITY_INFO
@@ -904,7 +1055,7 @@ static void osdElementLogStatus(osdElementParms_t *element)
 
 static void osdElementMahDrawn(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "%4d%c", getMAhDrawn(), SYM_MAH);
+    osdFormatValue(element->buff, SYM_NONE, getMAhDrawn(), 0, 4, ' ', SYM_MAH);
 }
 
 static void osdElementMainBatteryUsage(osdElementParms_t *element)
@@ -936,9 +1087,9 @@ static void osdElementMainBatteryVoltage(osdElementParms_t *element)
 
     element->buff[0] = osdGetBatterySymbol(getBatteryAverageCellVoltage());
     if (batteryVoltage >= 100) {
-        tfp_sprintf(element->buff + 1, "%d.%d%c", batteryVoltage / 10, batteryVoltage % 10, SYM_VOLT);
+        osdFormatValue(element->buff + 1, SYM_NONE, batteryVoltage, 1, 0, ' ', SYM_VOLT);
     } else {
-        tfp_sprintf(element->buff + 1, "%d.%d0%c", batteryVoltage / 10, batteryVoltage % 10, SYM_VOLT);
+        osdFormatValue(element->buff + 1, SYM_NONE, batteryVoltage * 10, 2, 0, ' ', SYM_VOLT);
     }
 }
 
@@ -959,7 +1110,7 @@ static void osdElementMotorDiagnostics(osdElementParms_t *element)
 static void osdElementNumericalHeading(osdElementParms_t *element)
 {
     const int heading = DECIDEGREES_TO_DEGREES(attitude.values.yaw);
-    tfp_sprintf(element->buff, "%c%03d", osdGetDirectionSymbolFromHeading(heading), heading);
+    osdFormatValue(element->buff, osdGetDirectionSymbolFromHeading(heading), heading, 0, 3, '0', SYM_NONE);
 }
 
 #ifdef USE_VARIO
@@ -976,7 +1127,7 @@ static void osdElementNumericalVario(osdElementParms_t *element)
     if (haveBaro || haveGps) {
         const int verticalSpeed = osdGetMetersToSelectedUnit(getEstimatedVario());
         const char directionSymbol = verticalSpeed < 0 ? SYM_ARROW_SMALL_DOWN : SYM_ARROW_SMALL_UP;
-        tfp_sprintf(element->buff, "%c%01d.%01d%c", directionSymbol, abs(verticalSpeed / 100), abs((verticalSpeed % 100) / 10), osdGetVarioToSelectedUnitSymbol());
+        osdFormatValue(element->buff, directionSymbol, abs(verticalSpeed) / 10, 1, 0, ' ', osdGetVarioToSelectedUnitSymbol());
     } else {
         // We use this symbol when we don't have a valid measure
         element->buff[0] = SYM_HYPHEN;
@@ -1007,7 +1158,7 @@ static void osdElementPidsYaw(osdElementParms_t *element)
 
 static void osdElementPower(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "%4dW", getAmperage() * getBatteryVoltage() / 10000);
+    osdFormatValue(element->buff, SYM_NONE, getAmperage() * getBatteryVoltage() / 10000, 0, 4, ' ', 'W');
 }
 
 static void osdElementRemainingTimeEstimate(osdElementParms_t *element)
@@ -1031,7 +1182,7 @@ static void osdElementRssi(osdElementParms_t *element)
         osdRssi = 99;
     }
 
-    tfp_sprintf(element->buff, "%c%2d", SYM_RSSI, osdRssi);
+    osdFormatValue(element->buff, SYM_RSSI, osdRssi, 0, 2, ' ', SYM_NONE);
 }
 
 #ifdef USE_RTC_TIME
@@ -1044,10 +1195,28 @@ static void osdElementRtcTime(osdElementParms_t *element)
 #ifdef USE_RX_RSSI_DBM
 static void osdElementRssiDbm(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "%c%3d", SYM_RSSI, getRssiDbm() * -1);
+    osdFormatValue(element->buff, SYM_RSSI, getRssiDbm() * -1, 0, 3, ' ', SYM_NONE);
 }
 #endif // USE_RX_RSSI_DBM
 
+#ifdef USE_LOOP_TIMING
+// 99th percentiles over the last second of loop jitter, gyro to PID and PID to motor latency in us
+static void osdElementLoopTiming(osdElementParms_t *element)
+{
+    static const char labels[LOOP_TIMING_COUNT] = { 'J', 'G', 'M' };
+    char *ptr = element->buff;
+
+    memcpy(ptr, "LT", 2);
+    ptr += 2;
+    for (int i = 0; i < LOOP_TIMING_COUNT; i++) {
+        *ptr++ = ' ';
+        *ptr++ = labels[i];
+        ptr = i2aPadded(MIN(loopTimingGetStats(i)->p99Us, 999), 3, ' ', ptr);
+    }
+    *ptr = '\0';
+}
+#endif // USE_LOOP_TIMING
+
 #ifdef USE_OSD_STICK_OVERLAY
 static void osdElementStickOverlay(osdElementParms_t *element)
 {
@@ -1059,11 +1228,11 @@ static void osdElementStickOverlay(osdElementParms_t *element)
         for (unsigned  y = 0; y < OSD_STICK_OVERLAY_HEIGHT; y++) {
             // draw the axes, vertical and horizonal
             if ((x == ((OSD_STICK_OVERLAY_WIDTH - 1) / 2)) && (y == (OSD_STICK_OVERLAY_HEIGHT - 1) / 2)) {
-                displayWriteChar(element->osdDisplayPort, xpos + x, ypos + y, SYM_STICK_OVERLAY_CENTER);
+                osdElementWriteChar(element, xpos + x, ypos + y, SYM_STICK_OVERLAY_CENTER);
             } else if (x == ((OSD_STICK_OVERLAY_WIDTH - 1) / 2)) {
-                displayWriteChar(element->osdDisplayPort, xpos + x, ypos + y, SYM_STICK_OVERLAY_VERTICAL);
+                osdElementWriteChar(element, xpos + x, ypos + y, SYM_STICK_OVERLAY_VERTICAL);
             } else if (y == ((OSD_STICK_OVERLAY_HEIGHT - 1) / 2)) {
-                displayWriteChar(element->osdDisplayPort, xpos + x, ypos + y, SYM_STICK_OVERLAY_HORIZONTAL);
+                osdElementWriteChar(element, xpos + x, ypos + y, SYM_STICK_OVERLAY_HORIZONTAL);
             }
         }
     }
@@ -1083,7 +1252,7 @@ static void osdElementStickOverlay(osdElementParms_t *element)
     const uint8_t cursorY = OSD_STICK_OVERLAY_VERTICAL_POSITIONS - 1 - scaleRange(constrain(rcData[vertical_channel], PWM_RANGE_MIN, PWM_RANGE_MAX - 1), PWM_RANGE_MIN, PWM_RANGE_MAX, 0, OSD_STICK_OVERLAY_VERTICAL_POSITIONS);
     const char cursor = SYM_STICK_OVERLAY_SPRITE_HIGH + (cursorY % OSD_STICK_OVERLAY_SPRITE_HEIGHT);
 
-    displayWriteChar(element->osdDisplayPort, xpos + cursorX, ypos + cursorY / OSD_STICK_OVERLAY_SPRITE_HEIGHT, cursor);
+    osdElementWriteChar(element, xpos + cursorX, ypos + cursorY / OSD_STICK_OVERLAY_SPRITE_HEIGHT, cursor);
 
     element->drawElement = false;  // element already drawn
 }
@@ -1091,7 +1260,7 @@ static void osdElementStickOverlay(osdElementParms_t *element)
 
 static void osdElementThrottlePosition(osdElementParms_t *element)
 {
-    tfp_sprintf(element->buff, "%c%3d", SYM_THR, calculateThrottlePercent());
+    osdFormatValue(element->buff, SYM_THR, calculateThrottlePercent(), 0, 3, ' ', SYM_NONE);
 }
 
 static void osdElementTimer(osdElementParms_t *element)
@@ -1135,261 +1304,19 @@ static void osdElementVtxChannel(osdElementParms_t *element)
 
 static void osdElementWarnings(osdElementParms_t *element)
 {
-#define OSD_WARNINGS_MAX_SIZE 12
-#define OSD_FORMAT_MESSAGE_BUFFER_SIZE (OSD_WARNINGS_MAX_SIZE + 1)
-
     STATIC_ASSERT(OSD_FORMAT_MESSAGE_BUFFER_SIZE <= OSD_ELEMENT_BUFFER_LENGTH, osd_warnings_size_exceeds_buffer_size);
 
-    const batteryState_e batteryState = getBatteryState();
-    const timeUs_t currentTimeUs = micros();
-
-    static timeUs_t armingDisabledUpdateTimeUs;
-    static unsigned armingDisabledDisplayIndex;
+    // osdWarningsUpdate() has evaluated the warnings, highest priority first
+    const osdActiveWarning_t *warning = osdWarningsGetActive(0);
 
     CLR_BLINK(OSD_WARNINGS);
 
-    // Cycle through the arming disabled reasons
-    if (osdWarnGetState(OSD_WARNING_ARMING_DISABLE)) {
-        if (IS_RC_MODE_ACTIVE(BOXARM) && isArmingDisabled()) {
-            const armingDisableFlags_e armSwitchOnlyFlag = 1 << (ARMING_DISABLE_FLAGS_COUNT - 1);
-            armingDisableFlags_e flags = getArmingDisableFlags();
-
-            // Remove the ARMSWITCH flag unless it's the only one
-            if ((flags & armSwitchOnlyFlag) && (flags != armSwitchOnlyFlag)) {
-                flags -= armSwitchOnlyFlag;
-            }
-
-            // Rotate to the next arming disabled reason after a 0.5 second time delay
-            // or if the current flag is no longer set
-            if ((currentTimeUs - armingDisabledUpdateTimeUs > 5e5) || !(flags & (1 << armingDisabledDisplayIndex))) {
-                if (armingDisabledUpdateTimeUs == 0) {
-                    armingDisabledDisplayIndex = ARMING_DISABLE_FLAGS_COUNT - 1;
-                }
-                armingDisabledUpdateTimeUs = currentTimeUs;
-
-                do {
-                    if (++armingDisabledDisplayIndex >= ARMING_DISABLE_FLAGS_COUNT) {
-                        armingDisabledDisplayIndex = 0;
-                    }
-                } while (!(flags & (1 << armingDisabledDisplayIndex)));
-            }
-
-            tfp_sprintf(element->buff, "%s", armingDisableFlagNames[armingDisabledDisplayIndex]);
-            return;
-        } else {
-            armingDisabledUpdateTimeUs = 0;
-        }
-    }
-
-#ifdef USE_DSHOT
-    if (isTryingToArm() && !ARMING_FLAG(ARMED)) {
-        int armingDelayTime = (getLastDshotBeaconCommandTimeUs() + DSHOT_BEACON_GUARD_DELAY_US - currentTimeUs) / 1e5;
-        if (armingDelayTime < 0) {
-            armingDelayTime = 0;
-        }
-        if (armingDelayTime >= (DSHOT_BEACON_GUARD_DELAY_US / 1e5 - 5)) {
-            tfp_sprintf(element->buff, " BEACON ON"); // Display this message for the first 0.5 seconds
-        } else {
-            tfp_sprintf(element->buff, "ARM IN %d.%d", armingDelayTime / 10, armingDelayTime % 10);
-        }
-        return;
-    }
-#endif // USE_DSHOT
-    if (osdWarnGetState(OSD_WARNING_FAIL_SAFE) && failsafeIsActive()) {
-        tfp_sprintf(element->buff, "FAIL SAFE");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-
-    // Warn when in flip over after crash mode
-    if (osdWarnGetState(OSD_WARNING_CRASH_FLIP) && isFlipOverAfterCrashActive()) {
-        tfp_sprintf(element->buff, "CRASH FLIP");
-        return;
-    }
-
-#ifdef USE_LAUNCH_CONTROL
-    // Warn when in launch control mode
-    if (osdWarnGetState(OSD_WARNING_LAUNCH_CONTROL) && isLaunchControlActive()) {
-#ifdef USE_ACC
-        if (sensors(SENSOR_ACC)) {
-            const int pitchAngle = constrain((attitude.raw[FD_PITCH] - accelerometerConfig()->accelerometerTrims.raw[FD_PITCH]) / 10, -90, 90);
-            tfp_sprintf(element->buff, "LAUNCH %d", pitchAngle);
-        } else
-#endif // USE_ACC
-        {
-            tfp_sprintf(element->buff, "LAUNCH");
-        }
-        return;
-    }
-#endif // USE_LAUNCH_CONTROL
-
-    // RSSI
-    if (osdWarnGetState(OSD_WARNING_RSSI) && (getRssiPercent() < osdConfig()->rssi_alarm)) {
-        tfp_sprintf(element->buff, "RSSI LOW");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-#ifdef USE_RX_RSSI_DBM
-    // rssi dbm
-    if (osdWarnGetState(OSD_WARNING_RSSI_DBM) && (getRssiDbm() > osdConfig()->rssi_dbm_alarm)) {
-        tfp_sprintf(element->buff, "RSSI DBM");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-#endif // USE_RX_RSSI_DBM
-
-#ifdef USE_RX_LINK_QUALITY_INFO
-    // Link Quality
-    if (osdWarnGetState(OSD_WARNING_LINK_QUALITY) && (rxGetLinkQualityPercent() < osdConfig()->link_quality_alarm)) {
-        tfp_sprintf(element->buff, "LINK QUALITY");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-#endif // USE_RX_LINK_QUALITY_INFO
-
-    if (osdWarnGetState(OSD_WARNING_BATTERY_CRITICAL) && batteryState == BATTERY_CRITICAL) {
-        tfp_sprintf(element->buff, " LAND NOW");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-
-#ifdef USE_GPS_RESCUE
-    if (osdWarnGetState(OSD_WARNING_GPS_RESCUE_UNAVAILABLE) &&
-       (ARMING_FLAG(ARMED) || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
-       (gpsRescueIsConfigured() || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
-       !gpsRescueIsDisabled() &&
-       !gpsRescueIsAvailable()) {
-        tfp_sprintf(element->buff, "RESCUE N/A");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-
-    if (osdWarnGetState(OSD_WARNING_GPS_RESCUE_DISABLED) &&
-       (ARMING_FLAG(ARMED) || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
-       (gpsRescueIsConfigured() || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
-       gpsRescueIsDisabled()) {
-
-        statistic_t *stats = osdGetStats();
-        if (cmpTimeUs(stats->armed_time, OSD_GPS_RESCUE_DISABLED_WARNING_DURATION_US) < 0) {
-            tfp_sprintf(element->buff, "RESCUE OFF");
-            SET_BLINK(OSD_WARNINGS);
-            return;
-        }
-    }
-
-    if (IS_RC_MODE_ACTIVE(BOXGPSRESCUE))
-    {
-        if (gpsRescueGetRescueState() == RESCUE_GPSLOST)
-            tfp_sprintf(element->buff, "GPS LOST");
-        else if (gpsRescueGetRescueState() == RESCUE_CRASH_FLIP_DETECTED)
-            tfp_sprintf(element->buff, "GPS CRASH");
-        else if (IS_FLIGHT_PLAN_MODE)
-            tfp_sprintf(element->buff, "FLTPLAN ON");
-        else
-            tfp_sprintf(element->buff, "GPS RESCUE");
-
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-       
-#endif // USE_GPS_RESCUE
-
-    // Show warning if in HEADFREE flight mode
-    if (FLIGHT_MODE(HEADFREE_MODE)) {
-        tfp_sprintf(element->buff, "HEADFREE");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-
-#ifdef USE_ADC_INTERNAL
-    const int16_t coreTemperature = getCoreTemperatureCelsius();
-    if (osdWarnGetState(OSD_WARNING_CORE_TEMPERATURE) && coreTemperature >= osdConfig()->core_temp_alarm) {
-        tfp_sprintf(element->buff, "CORE %c: %3d%c", SYM_TEMPERATURE, osdConvertTemperatureToSelectedUnit(coreTemperature), osdGetTemperatureSymbolForSelectedUnit());
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-#endif // USE_ADC_INTERNAL
-
-#ifdef USE_ESC_SENSOR
-    // Show warning if we lose motor output, the ESC is overheating or excessive current draw
-    if (featureIsEnabled(FEATURE_ESC_SENSOR) && osdWarnGetState(OSD_WARNING_ESC_FAIL)) {
-        char escWarningMsg[OSD_FORMAT_MESSAGE_BUFFER_SIZE];
-        unsigned pos = 0;
-
-        const char *title = "ESC";
-
-        // center justify message
-        while (pos < (OSD_WARNINGS_MAX_SIZE - (strlen(title) + getMotorCount())) / 2) {
-            escWarningMsg[pos++] = ' ';
-        }
-
-        strcpy(escWarningMsg + pos, title);
-        pos += strlen(title);
-
-        unsigned i = 0;
-        unsigned escWarningCount = 0;
-        while (i < getMotorCount() && pos < OSD_FORMAT_MESSAGE_BUFFER_SIZE - 1) {
-            escSensorData_t *escData = getEscSensorData(i);
-            const char motorNumber = '1' + i;
-            // if everything is OK just display motor number else R, T or C
-            char warnFlag = motorNumber;
-            if (ARMING_FLAG(ARMED) && osdConfig()->esc_rpm_alarm != ESC_RPM_ALARM_OFF && calcEscRpm(escData->rpm) <= osdConfig()->esc_rpm_alarm) {
-                warnFlag = 'R';
-            }
-            if (osdConfig()->esc_temp_alarm != ESC_TEMP_ALARM_OFF && escData->temperature >= osdConfig()->esc_temp_alarm) {
-                warnFlag = 'T';
-            }
-            if (ARMING_FLAG(ARMED) && osdConfig()->esc_current_alarm != ESC_CURRENT_ALARM_OFF && escData->current >= osdConfig()->esc_current_alarm) {
-                warnFlag = 'C';
-            }
-
-            escWarningMsg[pos++] = warnFlag;
-
-            if (warnFlag != motorNumber) {
-                escWarningCount++;
-            }
-
-            i++;
-        }
-
-        escWarningMsg[pos] = '\0';
-
-        if (escWarningCount > 0) {
-            tfp_sprintf(element->buff, "%s", escWarningMsg);
+    if (warning) {
+        strcpy(element->buff, warning->text);
+        if (warning->blink) {
             SET_BLINK(OSD_WARNINGS);
-            return;
         }
     }
-#endif // USE_ESC_SENSOR
-
-    if (osdWarnGetState(OSD_WARNING_BATTERY_WARNING) && batteryState == BATTERY_WARNING) {
-        tfp_sprintf(element->buff, "LOW BATTERY");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-
-#ifdef USE_RC_SMOOTHING_FILTER
-    // Show warning if rc smoothing hasn't initialized the filters
-    if (osdWarnGetState(OSD_WARNING_RC_SMOOTHING) && ARMING_FLAG(ARMED) && !rcSmoothingInitializationComplete()) {
-        tfp_sprintf(element->buff, "RCSMOOTHING");
-        SET_BLINK(OSD_WARNINGS);
-        return;
-    }
-#endif // USE_RC_SMOOTHING_FILTER
-
-    // Show warning if battery is not fresh
-    if (osdWarnGetState(OSD_WARNING_BATTERY_NOT_FULL) && !ARMING_FLAG(WAS_EVER_ARMED) && (getBatteryState() == BATTERY_OK)
-          && getBatteryAverageCellVoltage() < batteryConfig()->vbatfullcellvoltage) {
-        tfp_sprintf(element->buff, "BATT < FULL");
-        return;
-    }
-
-    // Visual beeper
-    if (osdWarnGetState(OSD_WARNING_VISUAL_BEEPER) && osdGetVisualBeeperState()) {
-        tfp_sprintf(element->buff, "  * * * *");
-        return;
-    }
-
 }
 
 // Define the order in which the elements are drawn.
@@ -1454,6 +1381,9 @@ static const uint8_t osdElementDisplayOrder[] = {
 #ifdef USE_RX_RSSI_DBM
     OSD_RSSI_DBM_VALUE,
 #endif
+#ifdef USE_LOOP_TIMING
+    OSD_LOOP_TIMING,
+#endif
 #ifdef USE_OSD_STICK_OVERLAY
     OSD_STICK_OVERLAY_LEFT,
     OSD_STICK_OVERLAY_RIGHT,
@@ -1571,6 +1501,9 @@ const osdElementDrawFn osdElementDrawFunction[OSD_ITEM_COUNT] = {
 #ifdef USE_RX_RSSI_DBM
     [OSD_RSSI_DBM_VALUE]          = osdElementRssiDbm,
 #endif
+#ifdef USE_LOOP_TIMING
+    [OSD_LOOP_TIMING]             = osdElementLoopTiming,
+#endif
 };
 
 static void osdAddActiveElement(osd_items_e element)
@@ -1586,6 +1519,7 @@ static void osdAddActiveElement(osd_items_e element)
 void osdAnalyzeActiveElements(void)
 {
     activeOsdElementCount = 0;
+    osdElementCacheValid = false;
 
 #ifdef USE_ACC
     if (sensors(SENSOR_ACC)) {
@@ -1623,51 +1557,220 @@ void osdAnalyzeActiveElements(void)
 #endif
 }
 
-static bool osdDrawSingleElement(displayPort_t *osdDisplayPort, uint8_t item)
+static bool osdElementAreasOverlap(const osdElementArea_t *a, const osdElementArea_t *b)
 {
-    if (BLINK(item)) {
-        return false;
+    return a->width && b->width
+        && a->x < b->x + b->width && b->x < a->x + a->width
+        && a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+// Elements from the given position in the draw order that overlap the area are redrawn
+static void osdElementMarkOverlapping(unsigned fromIndex, uint8_t item, const osdElementArea_t *area)
+{
+    for (unsigned i = fromIndex; i < activeOsdElementCount; i++) {
+        osdElementCache_t *cache = &osdElementCache[activeOsdElementArray[i]];
+        if (activeOsdElementArray[i] != item && osdElementAreasOverlap(&cache->area, area)) {
+            cache->dirty = true;
+        }
+    }
+}
+
+static void osdElementEraseArea(displayPort_t *osdDisplayPort, const osdElementArea_t *area)
+{
+    char spaces[OSD_ELEMENT_BUFFER_LENGTH];
+    memset(spaces, ' ', sizeof(spaces) - 1);
+    spaces[sizeof(spaces) - 1] = '\0';
+
+    const unsigned right = MIN(area->x + area->width, osdDisplayPort->cols);
+    const unsigned bottom = MIN(area->y + area->height, osdDisplayPort->rows);
+    for (unsigned y = area->y; y < bottom; y++) {
+        for (unsigned x = area->x; x < right; ) {
+            const unsigned len = MIN(right - x, sizeof(spaces) - 1);
+            displayWrite(osdDisplayPort, x, y, &spaces[sizeof(spaces) - 1 - len]);
+            x += len;
+        }
+    }
+}
+
+static void osdElementCellsArea(osdElementArea_t *area)
+{
+    if (osdElementCellCount == 0) {
+        // Nothing collected, report an empty area rather than a wrapped width
+        memset(area, 0, sizeof(*area));
+        return;
+    }
+
+    unsigned left = UINT8_MAX;
+    unsigned top = UINT8_MAX;
+    unsigned right = 0;
+    unsigned bottom = 0;
+
+    for (unsigned i = 0; i < osdElementCellCount; i++) {
+        left = MIN(left, osdElementCells[i].x);
+        top = MIN(top, osdElementCells[i].y);
+        right = MAX(right, osdElementCells[i].x + 1U);
+        bottom = MAX(bottom, osdElementCells[i].y + 1U);
+    }
+
+    area->x = left;
+    area->y = top;
+    area->width = MIN(right - left, UINT8_MAX + 0u);
+    area->height = MIN(bottom - top, UINT8_MAX + 0u);
+}
+
+// Write the collected characters, joining horizontal runs into a single string
+static void osdElementWriteCells(displayPort_t *osdDisplayPort)
+{
+    char run[OSD_ELEMENT_BUFFER_LENGTH];
+    unsigned runLength = 0;
+    const osdElementCell_t *runStart = NULL;
+
+    for (unsigned i = 0; i <= osdElementCellCount; i++) {
+        const osdElementCell_t *cell = (i < osdElementCellCount) ? &osdElementCells[i] : NULL;
+
+        if (runLength && (!cell || cell->y != runStart->y || cell->x != runStart->x + runLength || runLength == sizeof(run) - 1)) {
+            run[runLength] = '\0';
+            displayWrite(osdDisplayPort, runStart->x, runStart->y, run);
+            runLength = 0;
+        }
+        if (cell) {
+            if (!runLength) {
+                runStart = cell;
+            }
+            run[runLength++] = cell->c;
+        }
     }
+}
+
+static void osdDrawSingleElement(displayPort_t *osdDisplayPort, unsigned index)
+{
+    const uint8_t item = activeOsdElementArray[index];
+    osdElementCache_t *cache = &osdElementCache[item];
+    osdElementArea_t area = { 0 };
+    uint16_t crc = 0;
 
-    uint8_t elemPosX = OSD_X(osdConfig()->item_pos[item]);
-    uint8_t elemPosY = OSD_Y(osdConfig()->item_pos[item]);
     char buff[OSD_ELEMENT_BUFFER_LENGTH] = "";
 
     osdElementParms_t element;
     element.item = item;
-    element.elemPosX = elemPosX;
-    element.elemPosY = elemPosY;
+    element.elemPosX = OSD_X(osdConfig()->item_pos[item]);
+    element.elemPosY = OSD_Y(osdConfig()->item_pos[item]);
+    displayLayoutToScreen(osdDisplayPort, &element.elemPosX, &element.elemPosY);
     element.buff = (char *)&buff;
     element.osdDisplayPort = osdDisplayPort;
     element.drawElement = true;
 
-    // Call the element drawing function
-    osdElementDrawFunction[item](&element);
+    osdElementCellCount = 0;
+
+    // A blinking element that is hidden draws nothing, which erases it
+    if (!BLINK(item)) {
+        // Call the element drawing function
+        osdElementDrawFunction[item](&element);
+
+        if (element.drawElement) {
+            const unsigned len = strlen(buff);
+            if (len) {
+                area.x = element.elemPosX;
+                area.y = element.elemPosY;
+                area.width = len;
+                area.height = 1;
+                crc = crc16_ccitt_update(0, buff, len);
+            }
+        } else if (osdElementCellCount) {
+            osdElementCellsArea(&area);
+            crc = crc16_ccitt_update(0, osdElementCells, osdElementCellCount * sizeof(osdElementCell_t));
+        }
+    }
+
+    if (!cache->dirty && cache->crc == crc && memcmp(&cache->area, &area, sizeof(area)) == 0) {
+        return;
+    }
+
+    osdElementArea_t stale = cache->area;
+    if (element.drawElement && area.width && stale.height == 1 && stale.x == area.x && stale.y == area.y) {
+        // Text redrawn in place, only characters past its new end are stale
+        stale.x += MIN(stale.width, area.width);
+        stale.width -= MIN(stale.width, area.width);
+    }
+    if (stale.width) {
+        osdElementEraseArea(osdDisplayPort, &stale);
+        osdElementMarkOverlapping(0, item, &stale);
+    }
+
     if (element.drawElement) {
-        displayWrite(osdDisplayPort, elemPosX, elemPosY, buff);
+        if (area.width) {
+            displayWrite(osdDisplayPort, area.x, area.y, buff);
+        }
+    } else {
+        osdElementWriteCells(osdDisplayPort);
     }
+    // Elements later in the draw order stay on top of this one
+    osdElementMarkOverlapping(index + 1, item, &area);
 
-    return true;
+    cache->area = area;
+    cache->crc = crc;
+    cache->dirty = false;
+}
+
+static bool osdElementIsDue(unsigned index, uint8_t item)
+{
+    // Offset by the position so that elements of a class are spread over the passes
+    const unsigned divider = osdElementRateDivider[osdElementUpdateRate[item]];
+
+    return osdElementFullPass || IS_BLINK(item) || osdElementCache[item].dirty
+        || ((osdElementPassCount + index) % divider) == 0;
 }
 
-void osdDrawActiveElements(displayPort_t *osdDisplayPort, timeUs_t currentTimeUs)
+// Returns true when the pass over the active elements is complete, false when the time
+// budget ran out and the next call carries on from where this one stopped
+bool osdDrawActiveElements(displayPort_t *osdDisplayPort, timeUs_t currentTimeUs)
 {
+    if (osdElementDrawIndex == 0) {
 #ifdef USE_GPS
-    static bool lastGpsSensorState;
-    // Handle the case that the GPS_SENSOR may be delayed in activation
-    // or deactivate if communication is lost with the module.
-    const bool currentGpsSensorState = sensors(SENSOR_GPS);
-    if (lastGpsSensorState != currentGpsSensorState) {
-        lastGpsSensorState = currentGpsSensorState;
-        osdAnalyzeActiveElements();
-    }
+        static bool lastGpsSensorState;
+        // Handle the case that the GPS_SENSOR may be delayed in activation
+        // or deactivate if communication is lost with the module.
+        const bool currentGpsSensorState = sensors(SENSOR_GPS);
+        if (lastGpsSensorState != currentGpsSensorState) {
+            lastGpsSensorState = currentGpsSensorState;
+            osdAnalyzeActiveElements();
+        }
 #endif // USE_GPS
 
-    blinkState = (currentTimeUs / 200000) % 2;
+        blinkState = (currentTimeUs / 200000) % 2;
+        osdElementPassCount++;
+    }
 
-    for (unsigned i = 0; i < activeOsdElementCount; i++) {
-        osdDrawSingleElement(osdDisplayPort, activeOsdElementArray[i]);
+    // Nothing drawn survives a cleared screen, and a changed set of active elements
+    // may leave characters of the removed ones behind. Draw everything from a blank screen.
+    if (!osdElementCacheValid || osdDisplayPort->cleared) {
+        if (!osdDisplayPort->cleared) {
+            displayClearScreen(osdDisplayPort);
+        }
+        osdDisplayPort->cleared = false;
+        memset(osdElementCache, 0, sizeof(osdElementCache));
+        osdElementCacheValid = true;
+        osdElementDrawIndex = 0;
+        osdElementFullPass = true;
     }
+
+    const timeUs_t startTimeUs = micros();
+    bool drawn = false;
+
+    for (; osdElementDrawIndex < activeOsdElementCount; osdElementDrawIndex++) {
+        if (drawn && cmpTimeUs(micros(), startTimeUs) >= OSD_ELEMENT_DRAW_BUDGET_US) {
+            return false;
+        }
+        if (osdElementIsDue(osdElementDrawIndex, activeOsdElementArray[osdElementDrawIndex])) {
+            osdDrawSingleElement(osdDisplayPort, osdElementDrawIndex);
+            drawn = true;
+        }
+    }
+
+    osdElementDrawIndex = 0;
+    osdElementFullPass = false;
+
+    return true;
 }
 
 void osdResetAlarms(void)
@@ -46,6 +46,6 @@ int32_t osdGetSpeedToSelectedUnit(int32_t value);
 char osdGetSpeedToSelectedUnitSymbol(void);
 char osdGetTemperatureSymbolForSelectedUnit(void);
 void osdAnalyzeActiveElements(void);
-void osdDrawActiveElements(displayPort_t *osdDisplayPort, timeUs_t currentTimeUs);
+bool osdDrawActiveElements(displayPort_t *osdDisplayPort, timeUs_t currentTimeUs);
 void osdResetAlarms(void);
 void osdUpdateAlarms(void);
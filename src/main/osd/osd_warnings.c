@@ -0,0 +1,337 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The conditions behind the warnings element are evaluated here at the rate of osdWarningsUpdate(), away from the
+ * pass that draws the elements. The active warnings are kept in priority order, the element just prints the first.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_OSD
+
+#include "common/maths.h"
+#include "common/printf.h"
+#include "common/utils.h"
+
+#include "config/feature.h"
+
+#include "drivers/dshot.h"
+#include "drivers/max7456_symbols.h"
+
+#include "fc/config.h"
+#include "fc/core.h"
+#include "fc/rc.h"
+#include "fc/rc_modes.h"
+#include "fc/runtime_config.h"
+
+#include "flight/failsafe.h"
+#include "flight/gps_rescue.h"
+#include "flight/imu.h"
+#include "flight/mixer.h"
+
+#include "io/beeper.h"
+
+#include "osd/osd.h"
+#include "osd/osd_elements.h"
+#include "osd/osd_warnings.h"
+
+#include "rx/rx.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/adcinternal.h"
+#include "sensors/battery.h"
+#include "sensors/esc_sensor.h"
+#include "sensors/sensors.h"
+
+static osdActiveWarning_t activeWarnings[OSD_ACTIVE_WARNINGS_MAX];
+static unsigned activeWarningCount;
+
+// Append a warning below the ones added so far, returns its text buffer or NULL once the lower priorities are dropped
+static char *osdWarningAdd(const char *text, bool blink)
+{
+    if (activeWarningCount >= OSD_ACTIVE_WARNINGS_MAX) {
+        return NULL;
+    }
+
+    osdActiveWarning_t *warning = &activeWarnings[activeWarningCount++];
+    strncpy(warning->text, text, OSD_WARNINGS_MAX_SIZE);
+    warning->text[OSD_WARNINGS_MAX_SIZE] = '\0';
+    warning->blink = blink;
+
+    return warning->text;
+}
+
+static void osdWarningsCheckArmingDisabled(timeUs_t currentTimeUs)
+{
+    static timeUs_t armingDisabledUpdateTimeUs;
+    static unsigned armingDisabledDisplayIndex;
+
+    if (IS_RC_MODE_ACTIVE(BOXARM) && isArmingDisabled()) {
+        const armingDisableFlags_e armSwitchOnlyFlag = 1 << (ARMING_DISABLE_FLAGS_COUNT - 1);
+        armingDisableFlags_e flags = getArmingDisableFlags();
+
+        // Remove the ARMSWITCH flag unless it's the only one
+        if ((flags & armSwitchOnlyFlag) && (flags != armSwitchOnlyFlag)) {
+            flags -= armSwitchOnlyFlag;
+        }
+
+        // Rotate to the next arming disabled reason after a 0.5 second time delay
+        // or if the current flag is no longer set
+        if ((currentTimeUs - armingDisabledUpdateTimeUs > 5e5) || !(flags & (1 << armingDisabledDisplayIndex))) {
+            if (armingDisabledUpdateTimeUs == 0) {
+                armingDisabledDisplayIndex = ARMING_DISABLE_FLAGS_COUNT - 1;
+            }
+            armingDisabledUpdateTimeUs = currentTimeUs;
+
+            do {
+                if (++armingDisabledDisplayIndex >= ARMING_DISABLE_FLAGS_COUNT) {
+                    armingDisabledDisplayIndex = 0;
+                }
+            } while (!(flags & (1 << armingDisabledDisplayIndex)));
+        }
+
+        osdWarningAdd(armingDisableFlagNames[armingDisabledDisplayIndex], false);
+    } else {
+        armingDisabledUpdateTimeUs = 0;
+    }
+}
+
+#ifdef USE_ESC_SENSOR
+// Show warning if we lose motor output, the ESC is overheating or excessive current draw
+static void osdWarningsCheckEsc(void)
+{
+    char escWarningMsg[OSD_FORMAT_MESSAGE_BUFFER_SIZE];
+    unsigned pos = 0;
+
+    const char *title = "ESC";
+
+    // center justify message
+    while (pos < (OSD_WARNINGS_MAX_SIZE - (strlen(title) + getMotorCount())) / 2) {
+        escWarningMsg[pos++] = ' ';
+    }
+
+    strcpy(escWarningMsg + pos, title);
+    pos += strlen(title);
+
+    unsigned i = 0;
+    unsigned escWarningCount = 0;
+    while (i < getMotorCount() && pos < OSD_FORMAT_MESSAGE_BUFFER_SIZE - 1) {
+        escSensorData_t *escData = getEscSensorData(i);
+        const char motorNumber = '1' + i;
+        // if everything is OK just display motor number else R, T or C
+        char warnFlag = motorNumber;
+        if (ARMING_FLAG(ARMED) && osdConfig()->esc_rpm_alarm != ESC_RPM_ALARM_OFF && calcEscRpm(escData->rpm) <= osdConfig()->esc_rpm_alarm) {
+            warnFlag = 'R';
+        }
+        if (osdConfig()->esc_temp_alarm != ESC_TEMP_ALARM_OFF && escData->temperature >= osdConfig()->esc_temp_alarm) {
+            warnFlag = 'T';
+        }
+        if (ARMING_FLAG(ARMED) && osdConfig()->esc_current_alarm != ESC_CURRENT_ALARM_OFF && escData->current >= osdConfig()->esc_current_alarm) {
+            warnFlag = 'C';
+        }
+
+        escWarningMsg[pos++] = warnFlag;
+
+        if (warnFlag != motorNumber) {
+            escWarningCount++;
+        }
+
+        i++;
+    }
+
+    escWarningMsg[pos] = '\0';
+
+    if (escWarningCount > 0) {
+        osdWarningAdd(escWarningMsg, true);
+    }
+}
+#endif // USE_ESC_SENSOR
+
+/*
+ * Evaluate the warnings, highest priority first. Called by the OSD task in a slot of its own, so that the cost of the
+ * refresh that draws the elements stays bounded.
+ */
+void osdWarningsUpdate(timeUs_t currentTimeUs)
+{
+    const batteryState_e batteryState = getBatteryState();
+
+    activeWarningCount = 0;
+
+    // Cycle through the arming disabled reasons
+    if (osdWarnGetState(OSD_WARNING_ARMING_DISABLE)) {
+        osdWarningsCheckArmingDisabled(currentTimeUs);
+    }
+
+#ifdef USE_DSHOT
+    if (isTryingToArm() && !ARMING_FLAG(ARMED)) {
+        int armingDelayTime = (getLastDshotBeaconCommandTimeUs() + DSHOT_BEACON_GUARD_DELAY_US - currentTimeUs) / 1e5;
+        if (armingDelayTime < 0) {
+            armingDelayTime = 0;
+        }
+        if (armingDelayTime >= (DSHOT_BEACON_GUARD_DELAY_US / 1e5 - 5)) {
+            osdWarningAdd(" BEACON ON", false); // Display this message for the first 0.5 seconds
+        } else {
+            char *text = osdWarningAdd("", false);
+            if (text) {
+                tfp_sprintf(text, "ARM IN %d.%d", armingDelayTime / 10, armingDelayTime % 10);
+            }
+        }
+    }
+#endif // USE_DSHOT
+
+    if (osdWarnGetState(OSD_WARNING_FAIL_SAFE) && failsafeIsActive()) {
+        osdWarningAdd("FAIL SAFE", true);
+    }
+
+    // Warn when in flip over after crash mode
+    if (osdWarnGetState(OSD_WARNING_CRASH_FLIP) && isFlipOverAfterCrashActive()) {
+        osdWarningAdd("CRASH FLIP", false);
+    }
+
+#ifdef USE_LAUNCH_CONTROL
+    // Warn when in launch control mode
+    if (osdWarnGetState(OSD_WARNING_LAUNCH_CONTROL) && isLaunchControlActive()) {
+        char *text = osdWarningAdd("LAUNCH", false);
+#ifdef USE_ACC
+        if (text && sensors(SENSOR_ACC)) {
+            const int pitchAngle = constrain((attitude.raw[FD_PITCH] - accelerometerConfig()->accelerometerTrims.raw[FD_PITCH]) / 10, -90, 90);
+            tfp_sprintf(text, "LAUNCH %d", pitchAngle);
+        }
+#else
+        UNUSED(text);
+#endif // USE_ACC
+    }
+#endif // USE_LAUNCH_CONTROL
+
+    // RSSI
+    if (osdWarnGetState(OSD_WARNING_RSSI) && (getRssiPercent() < osdConfig()->rssi_alarm)) {
+        osdWarningAdd("RSSI LOW", true);
+    }
+#ifdef USE_RX_RSSI_DBM
+    // rssi dbm
+    if (osdWarnGetState(OSD_WARNING_RSSI_DBM) && (getRssiDbm() > osdConfig()->rssi_dbm_alarm)) {
+        osdWarningAdd("RSSI DBM", true);
+    }
+#endif // USE_RX_RSSI_DBM
+
+#ifdef USE_RX_LINK_QUALITY_INFO
+    // Link Quality
+    if (osdWarnGetState(OSD_WARNING_LINK_QUALITY) && (rxGetLinkQualityPercent() < osdConfig()->link_quality_alarm)) {
+        osdWarningAdd("LINK QUALITY", true);
+    }
+#endif // USE_RX_LINK_QUALITY_INFO
+
+    if (osdWarnGetState(OSD_WARNING_BATTERY_CRITICAL) && batteryState == BATTERY_CRITICAL) {
+        osdWarningAdd(" LAND NOW", true);
+    }
+
+#ifdef USE_GPS_RESCUE
+    if (osdWarnGetState(OSD_WARNING_GPS_RESCUE_UNAVAILABLE) &&
+       (ARMING_FLAG(ARMED) || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
+       (gpsRescueIsConfigured() || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
+       !gpsRescueIsDisabled() &&
+       !gpsRescueIsAvailable()) {
+        osdWarningAdd("RESCUE N/A", true);
+    }
+
+    if (osdWarnGetState(OSD_WARNING_GPS_RESCUE_DISABLED) &&
+       (ARMING_FLAG(ARMED) || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
+       (gpsRescueIsConfigured() || IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) &&
+       gpsRescueIsDisabled()) {
+
+        statistic_t *stats = osdGetStats();
+        if (cmpTimeUs(stats->armed_time, OSD_GPS_RESCUE_DISABLED_WARNING_DURATION_US) < 0) {
+            osdWarningAdd("RESCUE OFF", true);
+        }
+    }
+
+    if (IS_RC_MODE_ACTIVE(BOXGPSRESCUE)) {
+        if (gpsRescueGetRescueState() == RESCUE_GPSLOST) {
+            osdWarningAdd("GPS LOST", true);
+        } else if (gpsRescueGetRescueState() == RESCUE_CRASH_FLIP_DETECTED) {
+            osdWarningAdd("GPS CRASH", true);
+        } else if (IS_FLIGHT_PLAN_MODE) {
+            osdWarningAdd("FLTPLAN ON", true);
+        } else {
+            osdWarningAdd("GPS RESCUE", true);
+        }
+    }
+#endif // USE_GPS_RESCUE
+
+    // Show warning if in HEADFREE flight mode
+    if (FLIGHT_MODE(HEADFREE_MODE)) {
+        osdWarningAdd("HEADFREE", true);
+    }
+
+#ifdef USE_ADC_INTERNAL
+    const int16_t coreTemperature = getCoreTemperatureCelsius();
+    if (osdWarnGetState(OSD_WARNING_CORE_TEMPERATURE) && coreTemperature >= osdConfig()->core_temp_alarm) {
+        char *text = osdWarningAdd("", true);
+        if (text) {
+            tfp_sprintf(text, "CORE %c: %3d%c", SYM_TEMPERATURE, osdConvertTemperatureToSelectedUnit(coreTemperature), osdGetTemperatureSymbolForSelectedUnit());
+        }
+    }
+#endif // USE_ADC_INTERNAL
+
+#ifdef USE_ESC_SENSOR
+    if (featureIsEnabled(FEATURE_ESC_SENSOR) && osdWarnGetState(OSD_WARNING_ESC_FAIL)) {
+        osdWarningsCheckEsc();
+    }
+#endif // USE_ESC_SENSOR
+
+    if (osdWarnGetState(OSD_WARNING_BATTERY_WARNING) && batteryState == BATTERY_WARNING) {
+        osdWarningAdd("LOW BATTERY", true);
+    }
+
+#ifdef USE_RC_SMOOTHING_FILTER
+    // Show warning if rc smoothing hasn't initialized the filters
+    if (osdWarnGetState(OSD_WARNING_RC_SMOOTHING) && ARMING_FLAG(ARMED) && !rcSmoothingInitializationComplete()) {
+        osdWarningAdd("RCSMOOTHING", true);
+    }
+#endif // USE_RC_SMOOTHING_FILTER
+
+    // Show warning if battery is not fresh
+    if (osdWarnGetState(OSD_WARNING_BATTERY_NOT_FULL) && !ARMING_FLAG(WAS_EVER_ARMED) && (batteryState == BATTERY_OK)
+          && getBatteryAverageCellVoltage() < batteryConfig()->vbatfullcellvoltage) {
+        osdWarningAdd("BATT < FULL", false);
+    }
+
+    // Visual beeper
+    if (osdWarnGetState(OSD_WARNING_VISUAL_BEEPER) && osdGetVisualBeeperState()) {
+        osdWarningAdd("  * * * *", false);
+    }
+}
+
+unsigned osdWarningsActiveCount(void)
+{
+    return activeWarningCount;
+}
+
+const osdActiveWarning_t *osdWarningsGetActive(unsigned index)
+{
+    return index < activeWarningCount ? &activeWarnings[index] : NULL;
+}
+
+#endif // USE_OSD
@@ -0,0 +1,40 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/time.h"
+
+#define OSD_WARNINGS_MAX_SIZE 12
+#define OSD_FORMAT_MESSAGE_BUFFER_SIZE (OSD_WARNINGS_MAX_SIZE + 1)
+
+// The highest priority warnings kept, the warnings element only shows the first
+#define OSD_ACTIVE_WARNINGS_MAX 4
+
+typedef struct osdActiveWarning_s {
+    char text[OSD_FORMAT_MESSAGE_BUFFER_SIZE];
+    bool blink;
+} osdActiveWarning_t;
+
+void osdWarningsUpdate(timeUs_t currentTimeUs);
+unsigned osdWarningsActiveCount(void);
+const osdActiveWarning_t *osdWarningsGetActive(unsigned index);
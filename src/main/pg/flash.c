@@ -38,7 +38,7 @@
 #define FLASH_CS_PIN NONE
 #endif
 
-PG_REGISTER_WITH_RESET_FN(flashConfig_t, flashConfig, PG_FLASH_CONFIG, 0);
+PG_REGISTER_WITH_RESET_FN(flashConfig_t, flashConfig, PG_FLASH_CONFIG, 1);
 
 void pgResetFn_flashConfig(flashConfig_t *flashConfig)
 {
@@ -49,5 +49,7 @@ void pgResetFn_flashConfig(flashConfig_t *flashConfig)
 #if defined(USE_QUADSPI) && defined(FLASH_QUADSPI_INSTANCE)
     flashConfig->quadSpiDevice = QUADSPI_DEV_TO_CFG(quadSpiDeviceByInstance(FLASH_QUADSPI_INSTANCE));
 #endif
+    flashConfig->ring = false;
+    flashConfig->ringEraseAhead = 50;
 }
 #endif
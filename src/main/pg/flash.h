@@ -30,6 +30,8 @@ typedef struct flashConfig_s {
     ioTag_t csTag;
     uint8_t spiDevice;
     uint8_t quadSpiDevice;
+    uint8_t ring;            // log continuously, the oldest data is erased ahead of the write head
+    uint8_t ringEraseAhead;  // percentage of the flashfs kept erased ahead of the write head while not logging
 } flashConfig_t;
 
 PG_DECLARE(flashConfig_t, flashConfig);
@@ -35,6 +35,8 @@ typedef struct motorDevConfig_s {
     ioTag_t  ioTags[MAX_SUPPORTED_MOTORS];
     uint8_t  motorTransportProtocol;
     uint8_t  useDshotBitbang;
+    uint8_t  useDshotEdt;                   // Request extended telemetry (temperature, voltage, current) in the bidirectional DShot stream
+    uint16_t motorPwmSyncOffsetUs;          // Oneshot and multishot pulses start this long after the start of the PID loop, 0 starts them as soon as the motors are written
 } motorDevConfig_t;
 
 typedef struct motorConfig_s {
@@ -44,6 +46,7 @@ typedef struct motorConfig_s {
     uint16_t maxthrottle;                   // This is the maximum value for the ESCs at full power this value can be increased up to 2000
     uint16_t mincommand;                    // This is the value for the ESCs when they are not armed. In some cases, this value must be lowered down to 900 for some specific ESCs
     uint8_t motorPoleCount;                // Magnetic poles in the motors for calculating actual RPM from eRPM provided by ESC telemetry
+    uint8_t dshotAutoRate;                  // Move to a faster DShot rate at startup if the update and telemetry window does not fit the PID loop
 } motorConfig_t;
 
 PG_DECLARE(motorConfig_t, motorConfig);
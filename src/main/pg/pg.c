@@ -28,8 +28,55 @@
 
 #include "pg.h"
 
+// The registry is placed by the linker in link order, pgFind() looks PGs up through an
+// open addressing hash of it, built on first use. A slot holds the registry index + 1, 0 is empty.
+#define PG_INDEX_SIZE 256           // power of two, kept at least twice the number of PGs
+#define PG_INDEX_MASK (PG_INDEX_SIZE - 1)
+
+static uint8_t pgIndex[PG_INDEX_SIZE];
+static bool pgIndexInitialised = false;
+static bool pgIndexEnabled = false;
+
+static unsigned pgIndexSlot(pgn_t pgn)
+{
+    // Fibonacci hashing, the PGNs are mostly consecutive numbers
+    return ((uint32_t)pgn * 2654435761u) >> 24;
+}
+
+static void pgIndexInit(void)
+{
+    pgIndexInitialised = true;
+    if (PG_REGISTRY_SIZE > PG_INDEX_SIZE / 2) {
+        // fall back to the linear search
+        return;
+    }
+
+    PG_FOREACH(reg) {
+        unsigned slot = pgIndexSlot(pgN(reg));
+        while (pgIndex[slot]) {
+            slot = (slot + 1) & PG_INDEX_MASK;
+        }
+        pgIndex[slot] = reg - __pg_registry_start + 1;
+    }
+    pgIndexEnabled = true;
+}
+
 const pgRegistry_t* pgFind(pgn_t pgn)
 {
+    if (!pgIndexInitialised) {
+        pgIndexInit();
+    }
+
+    if (pgIndexEnabled) {
+        for (unsigned slot = pgIndexSlot(pgn); pgIndex[slot]; slot = (slot + 1) & PG_INDEX_MASK) {
+            const pgRegistry_t *reg = &__pg_registry_start[pgIndex[slot] - 1];
+            if (pgN(reg) == pgn) {
+                return reg;
+            }
+        }
+        return NULL;
+    }
+
     PG_FOREACH(reg) {
         if (pgN(reg) == pgn) {
             return reg;
@@ -149,7 +149,9 @@
 #define PG_SDIO_PIN_CONFIG 550
 #define PG_PULLUP_CONFIG 551
 #define PG_PULLDOWN_CONFIG 552
-#define PG_BETAFLIGHT_END 552
+#define PG_GYRO_CALIBRATION_CONFIG 553
+#define PG_DYN_NOTCH_MAP_CONFIG 554
+#define PG_BETAFLIGHT_END 554
 
 
 // OSD configuration (subject to change)
@@ -45,11 +45,12 @@ void pgResetFn_pwmConfig(pwmConfig_t *pwmConfig)
 #endif
 
 #ifdef USE_PPM
-PG_REGISTER_WITH_RESET_FN(ppmConfig_t, ppmConfig, PG_PPM_CONFIG, 0);
+PG_REGISTER_WITH_RESET_FN(ppmConfig_t, ppmConfig, PG_PPM_CONFIG, 1);
 
 void pgResetFn_ppmConfig(ppmConfig_t *ppmConfig)
 {
     ppmConfig->ioTag = timerioTagGetByUsage(TIM_USE_PPM, 0);
+    ppmConfig->dmaCapture = false;
 }
 #endif
 
@@ -27,6 +27,7 @@
 
 typedef struct ppmConfig_s {
     ioTag_t ioTag;
+    uint8_t dmaCapture;         // capture the edges by DMA and decode in the rx task, when the pin's timer allows it
 } ppmConfig_t;
 
 PG_DECLARE(ppmConfig_t, ppmConfig);
@@ -31,7 +31,7 @@ PG_REGISTER_WITH_RESET_TEMPLATE(sdioConfig_t, sdioConfig, PG_SDIO_CONFIG, 0);
 
 PG_RESET_TEMPLATE(sdioConfig_t, sdioConfig,
     .clockBypass = 0,
-    .useCache = 0,
+    .useCache = 1,
     .use4BitWidth = SDIO_USE_4BIT,
     .dmaopt = SDCARD_SDIO_DMA_OPT,
     .device = SDIO_DEV_TO_CFG(SDIO_DEVICE),
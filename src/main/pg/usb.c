@@ -28,12 +28,13 @@
 
 #include "usb.h"
 
-PG_REGISTER_WITH_RESET_TEMPLATE(usbDev_t, usbDevConfig, PG_USB_CONFIG, 0);
+PG_REGISTER_WITH_RESET_TEMPLATE(usbDev_t, usbDevConfig, PG_USB_CONFIG, 1);
 
 PG_RESET_TEMPLATE(usbDev_t, usbDevConfig,
     .type = DEFAULT,
     .mscButtonPin = IO_TAG(USB_MSC_BUTTON_PIN),
     .mscButtonUsePullup = MSC_BUTTON_IPU,
     .detectPin = IO_TAG(USB_DETECT_PIN),
+    .mspBulk = 0,
 );
 #endif
@@ -34,6 +34,7 @@ typedef struct usbDev_s {
     ioTag_t mscButtonPin;
     uint8_t mscButtonUsePullup;
     ioTag_t detectPin;
+    uint8_t mspBulk;            // add a vendor bulk interface dedicated to MSP next to the CDC VCP
 } usbDev_t;
 
 PG_DECLARE(usbDev_t, usbDevConfig);
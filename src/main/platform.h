@@ -175,6 +175,10 @@
 
 #include "target/common_pre.h"
 #include "target.h"
+#ifdef USE_SPECIALIZED_BUILD
+// generated by make SPECIALIZE=<diff file>, see src/utils/specialize_config.sh
+#include "specialized_build.h"
+#endif
 #include "target/common_deprecated_post.h"
 #include "target/common_post.h"
 #include "target/common_defaults_post.h"
@@ -26,7 +26,9 @@
 
 #include "common/maths.h"
 
+#include "drivers/exti.h"
 #include "drivers/io.h"
+#include "drivers/nvic.h"
 #include "drivers/rx/rx_cc2500.h"
 #include "drivers/time.h"
 
@@ -44,6 +46,11 @@
 #include "cc2500_common.h"
 
 static IO_t gdoPin;
+#ifdef USE_EXTI
+static extiCallbackRec_t gdoExtiCallbackRec;
+static volatile timeUs_t gdoAssertedAtUs;
+static volatile bool gdoAsserted;
+#endif
 #if defined(USE_RX_CC2500_SPI_PA_LNA)
 static IO_t txEnPin;
 static IO_t rxLnaEnPin;
@@ -74,6 +81,32 @@ bool cc2500getGdo(void)
     return IORead(gdoPin);
 }
 
+#ifdef USE_EXTI
+static void cc2500GdoExtiHandler(extiCallbackRec_t *cb)
+{
+    UNUSED(cb);
+
+    gdoAssertedAtUs = microsISR();
+    gdoAsserted = true;
+}
+#endif
+
+// The time the GDO pin went high for the packet in the FIFO, which the hop timing is based on.
+// Without the interrupt the packet is timed when it is found.
+timeUs_t cc2500getGdoTimeUs(void)
+{
+#ifdef USE_EXTI
+    if (gdoAsserted) {
+        const timeUs_t assertedAtUs = gdoAssertedAtUs;
+        gdoAsserted = false;
+
+        return assertedAtUs;
+    }
+#endif
+
+    return micros();
+}
+
 #if defined(USE_RX_CC2500_SPI_PA_LNA) && defined(USE_RX_CC2500_SPI_DIVERSITY)
 void cc2500switchAntennae(void)
 {
@@ -130,7 +163,13 @@ bool cc2500SpiInit(void)
     }
 
     IOInit(gdoPin, OWNER_RX_SPI_EXTI, 0);
+#ifdef USE_EXTI
+    EXTIHandlerInit(&gdoExtiCallbackRec, cc2500GdoExtiHandler);
+    EXTIConfig(gdoPin, &gdoExtiCallbackRec, NVIC_PRIO_MPU_INT_EXTI, IOCFG_IN_FLOATING, EXTI_TRIGGER_RISING);
+    EXTIEnable(gdoPin, true);
+#else
     IOConfigGPIO(gdoPin, IOCFG_IN_FLOATING);
+#endif
 #if defined(USE_RX_CC2500_SPI_PA_LNA)
     if (rxCc2500SpiConfig()->lnaEnIoTag) {
         rxLnaEnPin = IOGetByTag(rxCc2500SpiConfig()->lnaEnIoTag);
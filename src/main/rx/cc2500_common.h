@@ -20,11 +20,14 @@
 
 #pragma once
 
+#include "common/time.h"
+
 #include "rx/rx_spi.h"
 
 uint16_t cc2500getRssiDbm(void);
 void cc2500setRssiDbm(uint8_t value);
 bool cc2500getGdo(void);
+timeUs_t cc2500getGdoTimeUs(void);
 #if defined(USE_RX_CC2500_SPI_PA_LNA) && defined(USE_RX_CC2500_SPI_DIVERSITY)
 void cc2500switchAntennae(void);
 #endif
@@ -217,6 +217,7 @@ rx_spi_received_e frSkyDHandlePacket(uint8_t * const packet, uint8_t * const pro
     // here FS code could be
     case STATE_DATA:
         if (cc2500getGdo()) {
+            const timeUs_t packetReceivedAtUs = cc2500getGdoTimeUs();
             uint8_t ccLen = cc2500ReadReg(CC2500_3B_RXBYTES | CC2500_READ_BURST) & 0x7F;
             bool packetOk = false;
             if (ccLen >= 20) {
@@ -233,7 +234,7 @@ rx_spi_received_e frSkyDHandlePacket(uint8_t * const packet, uint8_t * const pro
                             cc2500setRssiDbm(packet[18]);
 #if defined(USE_RX_FRSKY_SPI_TELEMETRY)
                             if ((packet[3] % 4) == 2) {
-                                telemetryTimeUs = micros();
+                                telemetryTimeUs = packetReceivedAtUs;
                                 buildTelemetryFrame(packet);
                                 *protocolState = STATE_TELEMETRY;
                             } else
@@ -243,7 +244,7 @@ rx_spi_received_e frSkyDHandlePacket(uint8_t * const packet, uint8_t * const pro
                                 *protocolState = STATE_UPDATE;
                             }
                             ret = RX_SPI_RECEIVED_DATA;
-                            lastPacketReceivedTime = currentPacketReceivedTime;
+                            lastPacketReceivedTime = packetReceivedAtUs;
                         }
                     }
                 }
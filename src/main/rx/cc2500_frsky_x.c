@@ -368,6 +368,7 @@ rx_spi_received_e frSkyXHandlePacket(uint8_t * const packet, uint8_t * const pro
         // here FS code could be
     case STATE_DATA:
         if (cc2500getGdo() && (frameReceived == false)){
+            const timeUs_t packetReceivedAtUs = cc2500getGdoTimeUs();
             bool packetOk = false;
             uint8_t ccLen = cc2500ReadReg(CC2500_3B_RXBYTES | CC2500_READ_BURST) & 0x7F;
             if (ccLen >= packetLength) {
@@ -442,7 +443,7 @@ rx_spi_received_e frSkyXHandlePacket(uint8_t * const packet, uint8_t * const pro
                          receiveTelemetryRetryCount = 0;
                      }
 
-                    packetTimerUs = micros();
+                    packetTimerUs = packetReceivedAtUs;
                     frameReceived = true; // no need to process frame again.
                 }
                 if (!frameReceived) {
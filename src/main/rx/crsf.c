@@ -46,6 +46,8 @@
 #include "rx/rx.h"
 #include "rx/crsf.h"
 
+#include "scheduler/scheduler.h"
+
 #include "telemetry/crsf.h"
 
 #define CRSF_TIME_NEEDED_PER_FRAME_US   1100 // 700 ms + 400 ms for potential ad-hoc request
@@ -64,8 +66,10 @@ STATIC_UNIT_TESTED uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
 static serialPort_t *serialPort;
 static uint32_t crsfFrameStartAtUs = 0;
-static uint8_t telemetryBuf[CRSF_FRAME_SIZE_MAX];
+static uint8_t telemetryBuf[CRSF_TELEMETRY_BUFFER_SIZE];
 static uint8_t telemetryBufLen = 0;
+static timeUs_t rcFrameTimeUs = 0;
+static uint32_t rcFrameIntervalUs = 0;
 
 /*
  * CRSF protocol
@@ -116,6 +120,9 @@ struct crsfPayloadRcChannelsPacked_s {
 
 typedef struct crsfPayloadRcChannelsPacked_s crsfPayloadRcChannelsPacked_t;
 
+// RC channels of the last frame that passed the CRC check, copied in the receive ISR
+static crsfPayloadRcChannelsPacked_t crsfChannelDataFrame;
+
 #if defined(USE_CRSF_LINK_STATISTICS)
 /*
  * 0x14 Link statistics
@@ -224,6 +231,18 @@ STATIC_UNIT_TESTED uint8_t crsfFrameCRC(void)
     return crc;
 }
 
+// Averages the uplink frame interval, a gap longer than the link timeout restarts it
+static void crsfUpdateRcFrameTime(timeUs_t currentTimeUs)
+{
+    const timeDelta_t frameIntervalUs = cmpTimeUs(currentTimeUs, rcFrameTimeUs);
+    if (rcFrameTimeUs && frameIntervalUs > 0 && frameIntervalUs < CRSF_LINK_STATUS_UPDATE_TIMEOUT_US) {
+        rcFrameIntervalUs = rcFrameIntervalUs ? (rcFrameIntervalUs * 7 + frameIntervalUs) / 8 : (uint32_t)frameIntervalUs;
+    } else {
+        rcFrameIntervalUs = 0;
+    }
+    rcFrameTimeUs = currentTimeUs;
+}
+
 // Receive ISR callback, called back from serial port
 STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
 {
@@ -251,57 +270,64 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
 
     if (crsfFramePosition < fullFrameLength) {
         crsfFrame.bytes[crsfFramePosition++] = (uint8_t)c;
-        crsfFrameDone = crsfFramePosition < fullFrameLength ? false : true;
-        if (crsfFrameDone) {
+        if (crsfFramePosition >= fullFrameLength) {
             crsfFramePosition = 0;
-            if (crsfFrame.frame.type != CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
-                const uint8_t crc = crsfFrameCRC();
-                if (crc == crsfFrame.bytes[fullFrameLength - 1]) {
-                    switch (crsfFrame.frame.type)
-                    {
+            const uint8_t crc = crsfFrameCRC();
+            if (crc == crsfFrame.bytes[fullFrameLength - 1]) {
+                switch (crsfFrame.frame.type)
+                {
+                    case CRSF_FRAMETYPE_RC_CHANNELS_PACKED:
+                        // Validated and timestamped as soon as the last byte arrives, the RX task is woken
+                        // up and only has to unpack the channels
+                        if (crsfFrame.frame.frameLength == CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC) {
+                            memcpy(&crsfChannelDataFrame, &crsfFrame.frame.payload, sizeof(crsfChannelDataFrame));
+                            crsfUpdateRcFrameTime(currentTimeUs);
+                            crsfFrameDone = true;
+                            schedulerWakeTask(TASK_RX);
+                        }
+                        break;
 #if defined(USE_TELEMETRY_CRSF) && defined(USE_MSP_OVER_TELEMETRY)
-                        case CRSF_FRAMETYPE_MSP_REQ:
-                        case CRSF_FRAMETYPE_MSP_WRITE: {
-                            uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
-                            if (bufferCrsfMspFrame(frameStart, CRSF_FRAME_RX_MSP_FRAME_SIZE)) {
-                                crsfScheduleMspResponse();
-                            }
-                            break;
+                    case CRSF_FRAMETYPE_MSP_REQ:
+                    case CRSF_FRAMETYPE_MSP_WRITE: {
+                        uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
+                        if (bufferCrsfMspFrame(frameStart, CRSF_FRAME_RX_MSP_FRAME_SIZE)) {
+                            crsfScheduleMspResponse();
                         }
+                        break;
+                    }
 #endif
 #if defined(USE_CRSF_CMS_TELEMETRY)
-                        case CRSF_FRAMETYPE_DEVICE_PING:
-                            crsfScheduleDeviceInfoResponse();
-                            break;
-                        case CRSF_FRAMETYPE_DISPLAYPORT_CMD: {
-                            uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
-                            crsfProcessDisplayPortCmd(frameStart);
-                            break;
-                        }
+                    case CRSF_FRAMETYPE_DEVICE_PING:
+                        crsfScheduleDeviceInfoResponse();
+                        break;
+                    case CRSF_FRAMETYPE_DISPLAYPORT_CMD: {
+                        uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
+                        crsfProcessDisplayPortCmd(frameStart);
+                        break;
+                    }
 #endif
 #if defined(USE_CRSF_LINK_STATISTICS)
 
-                        case CRSF_FRAMETYPE_LINK_STATISTICS: {
-                             // if to FC and 10 bytes + CRSF_FRAME_ORIGIN_DEST_SIZE
-                             if ((rssiSource == RSSI_SOURCE_RX_PROTOCOL_CRSF) &&
-                                 (crsfFrame.frame.deviceAddress == CRSF_ADDRESS_FLIGHT_CONTROLLER) &&
-                                 (crsfFrame.frame.frameLength == CRSF_FRAME_ORIGIN_DEST_SIZE + CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE)) {
-                                 const crsfLinkStatistics_t* statsFrame = (const crsfLinkStatistics_t*)&crsfFrame.frame.payload;
-                                 handleCrsfLinkStatisticsFrame(statsFrame, currentTimeUs);
-                             }
-                            break;
-                        }
-#endif
-                        default:
-                            break;
+                    case CRSF_FRAMETYPE_LINK_STATISTICS: {
+                         // if to FC and 10 bytes + CRSF_FRAME_ORIGIN_DEST_SIZE
+                         if ((rssiSource == RSSI_SOURCE_RX_PROTOCOL_CRSF) &&
+                             (crsfFrame.frame.deviceAddress == CRSF_ADDRESS_FLIGHT_CONTROLLER) &&
+                             (crsfFrame.frame.frameLength == CRSF_FRAME_ORIGIN_DEST_SIZE + CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE)) {
+                             const crsfLinkStatistics_t* statsFrame = (const crsfLinkStatistics_t*)&crsfFrame.frame.payload;
+                             handleCrsfLinkStatisticsFrame(statsFrame, currentTimeUs);
+                         }
+                        break;
                     }
+#endif
+                    default:
+                        break;
                 }
             }
         }
     }
 }
 
-STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
+uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     UNUSED(rxRuntimeConfig);
 
@@ -310,37 +336,37 @@ STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 #endif
     if (crsfFrameDone) {
         crsfFrameDone = false;
-        if (crsfFrame.frame.type == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
-            // CRC includes type and payload of each frame
-            const uint8_t crc = crsfFrameCRC();
-            if (crc != crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]) {
-                return RX_FRAME_PENDING;
-            }
-            // unpack the RC channels
-            const crsfPayloadRcChannelsPacked_t* const rcChannels = (crsfPayloadRcChannelsPacked_t*)&crsfFrame.frame.payload;
-            crsfChannelData[0] = rcChannels->chan0;
-            crsfChannelData[1] = rcChannels->chan1;
-            crsfChannelData[2] = rcChannels->chan2;
-            crsfChannelData[3] = rcChannels->chan3;
-            crsfChannelData[4] = rcChannels->chan4;
-            crsfChannelData[5] = rcChannels->chan5;
-            crsfChannelData[6] = rcChannels->chan6;
-            crsfChannelData[7] = rcChannels->chan7;
-            crsfChannelData[8] = rcChannels->chan8;
-            crsfChannelData[9] = rcChannels->chan9;
-            crsfChannelData[10] = rcChannels->chan10;
-            crsfChannelData[11] = rcChannels->chan11;
-            crsfChannelData[12] = rcChannels->chan12;
-            crsfChannelData[13] = rcChannels->chan13;
-            crsfChannelData[14] = rcChannels->chan14;
-            crsfChannelData[15] = rcChannels->chan15;
-            return RX_FRAME_COMPLETE;
-        }
+        // unpack the RC channels, the frame was validated by the receive ISR
+        const crsfPayloadRcChannelsPacked_t* const rcChannels = &crsfChannelDataFrame;
+        crsfChannelData[0] = rcChannels->chan0;
+        crsfChannelData[1] = rcChannels->chan1;
+        crsfChannelData[2] = rcChannels->chan2;
+        crsfChannelData[3] = rcChannels->chan3;
+        crsfChannelData[4] = rcChannels->chan4;
+        crsfChannelData[5] = rcChannels->chan5;
+        crsfChannelData[6] = rcChannels->chan6;
+        crsfChannelData[7] = rcChannels->chan7;
+        crsfChannelData[8] = rcChannels->chan8;
+        crsfChannelData[9] = rcChannels->chan9;
+        crsfChannelData[10] = rcChannels->chan10;
+        crsfChannelData[11] = rcChannels->chan11;
+        crsfChannelData[12] = rcChannels->chan12;
+        crsfChannelData[13] = rcChannels->chan13;
+        crsfChannelData[14] = rcChannels->chan14;
+        crsfChannelData[15] = rcChannels->chan15;
+        return RX_FRAME_COMPLETE;
     }
     return RX_FRAME_PENDING;
 }
 
-STATIC_UNIT_TESTED uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
+static timeUs_t crsfFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    UNUSED(rxRuntimeConfig);
+
+    return rcFrameTimeUs;
+}
+
+uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
 {
     UNUSED(rxRuntimeConfig);
     /* conversion from RC value to PWM
@@ -354,11 +380,16 @@ STATIC_UNIT_TESTED uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConf
     return (0.62477120195241f * crsfChannelData[chan]) + 881;
 }
 
-void crsfRxWriteTelemetryData(const void *data, int len)
+// Appends a telemetry frame to the frames to be sent in the next telemetry window,
+// returns false if it does not fit.
+bool crsfRxWriteTelemetryData(const void *data, int len)
 {
-    len = MIN(len, (int)sizeof(telemetryBuf));
-    memcpy(telemetryBuf, data, len);
-    telemetryBufLen = len;
+    if (len > (int)sizeof(telemetryBuf) - telemetryBufLen) {
+        return false;
+    }
+    memcpy(telemetryBuf + telemetryBufLen, data, len);
+    telemetryBufLen += len;
+    return true;
 }
 
 void crsfRxSendTelemetryData(void)
@@ -381,6 +412,7 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = crsfReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = crsfFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = crsfFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -412,4 +444,13 @@ bool crsfRxIsActive(void)
 {
     return serialPort != NULL;
 }
+
+// Returns the averaged interval between the RC frames from the transmitter, 0 if the link is not up
+uint32_t crsfRxGetFrameIntervalUs(void)
+{
+    if (cmpTimeUs(micros(), rcFrameTimeUs) > CRSF_LINK_STATUS_UPDATE_TIMEOUT_US) {
+        return 0;
+    }
+    return rcFrameIntervalUs;
+}
 #endif
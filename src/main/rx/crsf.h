@@ -40,10 +40,14 @@ typedef union crsfFrame_u {
     crsfFrameDef_t frame;
 } crsfFrame_t;
 
-void crsfRxWriteTelemetryData(const void *data, int len);
+// enough for several of the small telemetry frames to be packed into one telemetry window
+#define CRSF_TELEMETRY_BUFFER_SIZE (2 * CRSF_FRAME_SIZE_MAX)
+
+bool crsfRxWriteTelemetryData(const void *data, int len);
 void crsfRxSendTelemetryData(void);
 
 struct rxConfig_s;
 struct rxRuntimeConfig_s;
 bool crsfRxInit(const struct rxConfig_s *initialRxConfig, struct rxRuntimeConfig_s *rxRuntimeConfig);
 bool crsfRxIsActive(void);
+uint32_t crsfRxGetFrameIntervalUs(void);
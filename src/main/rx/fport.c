@@ -126,9 +126,11 @@ static const smartPortPayload_t emptySmartPortFrame = { .frameId = 0, .valueId =
 
 #define NUM_RX_BUFFERS 3
 #define BUFFER_SIZE (FPORT_REQUEST_FRAME_LENGTH + 2 * sizeof(uint8_t))
+// Frames are buffered as received and unstuffed once complete, every byte may be escaped
+#define RAW_BUFFER_SIZE (2 * BUFFER_SIZE)
 
 typedef struct fportBuffer_s {
-    uint8_t data[BUFFER_SIZE];
+    uint8_t data[RAW_BUFFER_SIZE];
     uint8_t length;
 } fportBuffer_t;
 
@@ -165,7 +167,6 @@ static void fportDataReceive(uint16_t c, void *data)
     UNUSED(data);
 
     static timeUs_t frameStartAt = 0;
-    static bool escapedCharacter = false;
     static timeUs_t lastFrameReceivedUs = 0;
     static bool telemetryFrame = false;
 
@@ -197,27 +198,17 @@ static void fportDataReceive(uint16_t c, void *data)
 
             DEBUG_SET(DEBUG_FPORT, DEBUG_FPORT_FRAME_INTERVAL, currentTimeUs - lastFrameReceivedUs);
             lastFrameReceivedUs = currentTimeUs;
-
-            escapedCharacter = false;
         }
 
         frameStartAt = currentTimeUs;
         framePosition = 1;
     } else if (framePosition > 0) {
-        if (framePosition >= BUFFER_SIZE + 1) {
+        if (framePosition >= RAW_BUFFER_SIZE + 1) {
                 framePosition = 0;
 
                 reportFrameError(DEBUG_FPORT_ERROR_OVERSIZE);
         } else {
-            if (escapedCharacter) {
-                val = val ^ FPORT_ESCAPE_MASK;
-                escapedCharacter = false;
-            } else if (val == FPORT_ESCAPE_CHAR) {
-                escapedCharacter = true;
-
-                return;
-            }
-
+            // The length byte is never escaped, so the frame type is always the second byte received
             if (framePosition == 2 && val == FPORT_FRAME_TYPE_TELEMETRY_REQUEST) {
                 telemetryFrame = true;
             }
@@ -233,13 +224,29 @@ static void smartPortWriteFrameFport(const smartPortPayload_t *payload)
 {
     framePosition = 0;
 
-    uint16_t checksum = 0;
-    smartPortSendByte(FPORT_RESPONSE_FRAME_LENGTH, &checksum, fportPort);
-    smartPortSendByte(FPORT_FRAME_TYPE_TELEMETRY_RESPONSE, &checksum, fportPort);
-    smartPortWriteFrameSerial(payload, fportPort, checksum);
+    const uint8_t header[] = { FPORT_RESPONSE_FRAME_LENGTH, FPORT_FRAME_TYPE_TELEMETRY_RESPONSE };
+    smartPortWriteFrameSerial(payload, fportPort, header, sizeof(header));
 }
 #endif
 
+// Removes the byte stuffing in place, returns the unstuffed length
+static uint8_t unstuffFrame(uint8_t *data, uint8_t length)
+{
+    uint8_t unstuffedLength = 0;
+    for (unsigned i = 0; i < length; i++) {
+        if (data[i] == FPORT_ESCAPE_CHAR) {
+            if (++i == length) {
+                break;
+            }
+            data[unstuffedLength++] = data[i] ^ FPORT_ESCAPE_MASK;
+        } else {
+            data[unstuffedLength++] = data[i];
+        }
+    }
+
+    return unstuffedLength;
+}
+
 static bool checkChecksum(uint8_t *data, uint8_t length)
 {
     uint16_t checksum = 0;
@@ -266,9 +273,11 @@ static uint8_t fportFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 
 
     if (rxBufferReadIndex != rxBufferWriteIndex) {
-        uint8_t bufferLength = rxBuffer[rxBufferReadIndex].length;
+        const uint8_t bufferLength = unstuffFrame(rxBuffer[rxBufferReadIndex].data, rxBuffer[rxBufferReadIndex].length);
         uint8_t frameLength = rxBuffer[rxBufferReadIndex].data[0];
-        if (frameLength != bufferLength - 2) {
+        if (bufferLength > BUFFER_SIZE) {
+            reportFrameError(DEBUG_FPORT_ERROR_OVERSIZE);
+        } else if (frameLength != bufferLength - 2) {
             reportFrameError(DEBUG_FPORT_ERROR_SIZE);
         } else {
             if (!checkChecksum(&rxBuffer[rxBufferReadIndex].data[0], bufferLength)) {
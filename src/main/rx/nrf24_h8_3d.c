@@ -228,7 +228,9 @@ rx_spi_received_e h8_3dNrf24DataReceived(uint8_t *payload)
 {
     rx_spi_received_e ret = RX_SPI_RECEIVED_NONE;
     bool payloadReceived = false;
+    uint32_t timeNowUs = 0;
     if (NRF24L01_ReadPayloadIfAvailable(payload, payloadSize + CRC_LEN)) {
+        timeNowUs = NRF24L01_GetPacketTimeUs();
         const uint16_t crc = XN297_UnscramblePayload(payload, payloadSize, rxTxAddrXN297);
         if (h8_3dCrcOK(crc, payload)) {
             payloadReceived = true;
@@ -250,7 +252,9 @@ rx_spi_received_e h8_3dNrf24DataReceived(uint8_t *payload)
         }
         break;
     }
-    const uint32_t timeNowUs = micros();
+    if (ret != RX_SPI_RECEIVED_DATA) {
+        timeNowUs = micros();
+    }
     if ((ret == RX_SPI_RECEIVED_DATA) || (timeNowUs > timeOfLastHop + hopTimeout)) {
         h8_3dHopToNextChannel();
         timeOfLastHop = timeNowUs;
@@ -351,6 +351,7 @@ rx_spi_received_e inavNrf24DataReceived(uint8_t *payload)
         timeNowUs = micros();
         // read the payload, processing of payload is deferred
         if (NRF24L01_ReadPayloadIfAvailable(payload, payloadSize)) {
+            timeNowUs = NRF24L01_GetPacketTimeUs();
             receivedPowerSnapshot = NRF24L01_ReadReg(NRF24L01_09_RPD); // set to 1 if received power > -64dBm
             const bool bindPacket = inavCheckBindPacket(payload);
             if (bindPacket) {
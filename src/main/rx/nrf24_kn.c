@@ -148,7 +148,7 @@ void knNrf24SetRcDataFromPayload(uint16_t *rcData, const uint8_t *packet)
 
 static rx_spi_received_e readrx(uint8_t *packet)
 {
-    if (!(NRF24L01_ReadReg(NRF24L01_07_STATUS) & BV(NRF24L01_07_STATUS_RX_DR))) {
+    if (!NRF24L01_IsRxDataReady()) {
         uint32_t t = micros() - packet_timer;
         if (t > rx_timeout) {
 			if (bind_phase == PHASE_RECEIVED) {
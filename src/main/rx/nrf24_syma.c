@@ -259,7 +259,7 @@ rx_spi_received_e symaNrf24DataReceived(uint8_t *payload)
         // read the payload, processing of payload is deferred
         if (NRF24L01_ReadPayloadIfAvailable(payload, payloadSize)) {
             symaHopToNextChannel();
-            timeOfLastHop = micros();
+            timeOfLastHop = NRF24L01_GetPacketTimeUs();
             ret = RX_SPI_RECEIVED_DATA;
         }
         if (micros() > timeOfLastHop + hopTimeout) {
@@ -28,6 +28,7 @@
 
 #include "build/build_config.h"
 #include "build/debug.h"
+#include "build/trace.h"
 
 #include "common/maths.h"
 #include "common/utils.h"
@@ -43,6 +44,7 @@
 
 #include "fc/config.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/rc_modes.h"
 
 #include "flight/failsafe.h"
@@ -69,6 +71,19 @@
 #include "rx/rx_spi.h"
 #include "rx/targetcustomserial.h"
 
+#ifdef SPECIALIZED_RX_FRAME_STATUS_FN
+uint8_t SPECIALIZED_RX_FRAME_STATUS_FN(rxRuntimeConfig_t *rxRuntimeConfig);
+#define RX_FRAME_STATUS(config) CALL_DIRECT_IF((config)->rcFrameStatusFn, SPECIALIZED_RX_FRAME_STATUS_FN, config)
+#else
+#define RX_FRAME_STATUS(config) (config)->rcFrameStatusFn(config)
+#endif
+
+#ifdef SPECIALIZED_RX_READ_RAW_FN
+uint16_t SPECIALIZED_RX_READ_RAW_FN(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
+#define RX_READ_RAW(config, chan) CALL_DIRECT_IF((config)->rcReadRawFn, SPECIALIZED_RX_READ_RAW_FN, config, chan)
+#else
+#define RX_READ_RAW(config, chan) (config)->rcReadRawFn(config, chan)
+#endif
 
 const char rcChannelLetters[] = "AERT12345678abcdefgh";
 
@@ -100,6 +115,9 @@ static uint8_t rxChannelCount;
 
 static timeUs_t rxNextUpdateAtUs = 0;
 static uint32_t needRxSignalBefore = 0;
+static timeUs_t rxWatchdogDeadlineUs = 0;
+static bool rxWatchdogArmed = false;
+static uint16_t rxWatchdogExpiryCount = 0;
 static uint32_t needRxSignalMaxDelayUs;
 static uint32_t suspendRxSignalUntil = 0;
 static uint8_t  skipRxSamples = 0;
@@ -119,8 +137,27 @@ uint32_t rcInvalidPulsPeriod[MAX_SUPPORTED_RC_CHANNEL_COUNT];
 #define SKIP_RC_SAMPLES_ON_RESUME  2                // flush 2 samples to drop wrong measurements (timing independent)
 
 rxRuntimeConfig_t rxRuntimeConfig;
+// The receiver the channels are read from, switching receivers only changes this pointer
+static rxRuntimeConfig_t *activeRxRuntimeConfig = &rxRuntimeConfig;
 static uint8_t rcSampleIndex = 0;
 
+#ifdef USE_RX_DIVERSITY
+#define RX_DIVERSITY_STALE_FRAME_COUNT      3    // switch away from a receiver that missed this many of its frames
+#define RX_DIVERSITY_LINK_QUALITY_SHIFT     3    // each frame moves the link quality of its receiver 1/8 of the way
+#define RX_DIVERSITY_LINK_QUALITY_MARGIN    (LINK_QUALITY_MAX_VALUE / 4)    // link quality advantage needed to switch, more than a single lost frame
+
+// DEBUG_RX_DIVERSITY:
+// 0 - active receiver
+// 1 - link quality of receiver 0
+// 2 - link quality of receiver 1
+// 3 - number of receiver switches
+
+static rxRuntimeConfig_t rxRuntimeConfigDiversity;
+static bool rxDiversityEnabled = false;
+STATIC_UNIT_TESTED rxDiversityState_t rxDiversityState[RX_RECEIVER_COUNT];
+static uint16_t rxDiversitySwitchCount;
+#endif
+
 PG_REGISTER_ARRAY_WITH_RESET_FN(rxChannelRangeConfig_t, NON_AUX_CHANNEL_COUNT, rxChannelRangeConfigs, PG_RX_CHANNEL_RANGE_CONFIG, 0);
 void pgResetFn_rxChannelRangeConfigs(rxChannelRangeConfig_t *rxChannelRangeConfigs)
 {
@@ -179,6 +216,21 @@ STATIC_UNIT_TESTED bool isPulseValid(uint16_t pulseDuration)
             pulseDuration <= rxConfig()->rx_max_usec;
 }
 
+#ifdef USE_RX_DIVERSITY
+// Only providers that keep their state per receiver can run a second instance
+static bool serialRxSupportsDiversity(uint8_t serialrxProvider)
+{
+    switch (serialrxProvider) {
+#ifdef USE_SERIALRX_SBUS
+    case SERIALRX_SBUS:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+#endif
+
 #ifdef USE_SERIAL_RX
 bool serialRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 {
@@ -250,6 +302,18 @@ bool serialRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig
 }
 #endif
 
+#if defined(USE_PWM) || defined(USE_PPM)
+static uint16_t rcSamples[MAX_SUPPORTED_RX_PARALLEL_PWM_OR_PPM_CHANNEL_COUNT][PPM_AND_PWM_SAMPLE_COUNT];
+static intMovingAverage_t rcSampleAverage[MAX_SUPPORTED_RX_PARALLEL_PWM_OR_PPM_CHANNEL_COUNT];
+
+static void initChannelMovingAverages(void)
+{
+    for (int chan = 0; chan < MAX_SUPPORTED_RX_PARALLEL_PWM_OR_PPM_CHANNEL_COUNT; chan++) {
+        intMovingAverageInit(&rcSampleAverage[chan], PPM_AND_PWM_SAMPLE_COUNT, rcSamples[chan]);
+    }
+}
+#endif
+
 void rxInit(void)
 {
     rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
@@ -289,6 +353,12 @@ void rxInit(void)
             rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
             rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
         }
+#ifdef USE_RX_DIVERSITY
+        if (enabled && serialRxSupportsDiversity(rxConfig()->serialrx_provider) && findSerialPortConfig(FUNCTION_RX_SERIAL_2)) {
+            rxRuntimeConfigDiversity.receiverIndex = 1;
+            rxDiversityEnabled = serialRxInit(rxConfig(), &rxRuntimeConfigDiversity);
+        }
+#endif
     }
 #endif
 
@@ -312,6 +382,7 @@ void rxInit(void)
 #if defined(USE_PWM) || defined(USE_PPM)
     if (featureIsEnabled(FEATURE_RX_PPM | FEATURE_RX_PARALLEL_PWM)) {
         rxPwmInit(rxConfig(), &rxRuntimeConfig);
+        initChannelMovingAverages();
     }
 #endif
 
@@ -335,6 +406,27 @@ bool rxIsReceivingSignal(void)
     return rxSignalReceived;
 }
 
+// Returns the interval between the last two channel data frames as timestamped by the receiver
+// driver and how long ago the last one arrived, 0 if the driver does not timestamp its frames
+timeDelta_t rxGetFrameDelta(timeDelta_t *frameAgeUs)
+{
+    static timeUs_t previousFrameTimeUs = 0;
+    static timeDelta_t frameTimeDeltaUs = 0;
+
+    if (activeRxRuntimeConfig->rcFrameTimeUsFn) {
+        const timeUs_t frameTimeUs = activeRxRuntimeConfig->rcFrameTimeUsFn(activeRxRuntimeConfig);
+        *frameAgeUs = cmpTimeUs(micros(), frameTimeUs);
+
+        const timeDelta_t deltaUs = cmpTimeUs(frameTimeUs, previousFrameTimeUs);
+        if (deltaUs) {
+            frameTimeDeltaUs = deltaUs;
+            previousFrameTimeUs = frameTimeUs;
+        }
+    }
+
+    return frameTimeDeltaUs;
+}
+
 bool rxAreFlightChannelsValid(void)
 {
     return rxFlightChannelsValid;
@@ -365,16 +457,12 @@ void resumeRxPwmPpmSignal(void)
 #ifdef USE_RX_LINK_QUALITY_INFO
 #define LINK_QUALITY_SAMPLE_COUNT 16
 
+static uint16_t linkQualitySamples[LINK_QUALITY_SAMPLE_COUNT];
+static intMovingAverage_t linkQualityAverage = { .buf = linkQualitySamples, .windowSize = LINK_QUALITY_SAMPLE_COUNT };
+
 STATIC_UNIT_TESTED uint16_t updateLinkQualitySamples(uint16_t value)
 {
-    static uint16_t samples[LINK_QUALITY_SAMPLE_COUNT];
-    static uint8_t sampleIndex = 0;
-    static uint16_t sum = 0;
-
-    sum += value - samples[sampleIndex];
-    samples[sampleIndex] = value;
-    sampleIndex = (sampleIndex + 1) % LINK_QUALITY_SAMPLE_COUNT;
-    return sum / LINK_QUALITY_SAMPLE_COUNT;
+    return intMovingAverageUpdate(&linkQualityAverage, value);
 }
 #endif
 
@@ -388,18 +476,19 @@ static void setLinkQuality(bool validFrame, timeDelta_t currentDeltaTime)
 #endif
 
     if (rssiSource == RSSI_SOURCE_FRAME_ERRORS) {
-        static uint16_t tot_rssi = 0;
-        static uint16_t cnt_rssi = 0;
+        // Only count frames here, a sum of RSSI values would overflow on high rate links
+        static uint16_t validFrameCount = 0;
+        static uint16_t frameCount = 0;
         static timeDelta_t resample_time = 0;
 
         resample_time += currentDeltaTime;
-        tot_rssi += validFrame ? RSSI_MAX_VALUE : 0;
-        cnt_rssi++;
+        validFrameCount += validFrame;
+        frameCount++;
 
         if (resample_time >= FRAME_ERR_RESAMPLE_US) {
-            setRssi(tot_rssi / cnt_rssi, rssiSource);
-            tot_rssi = 0;
-            cnt_rssi = 0;
+            setRssi((uint32_t)validFrameCount * RSSI_MAX_VALUE / frameCount, rssiSource);
+            validFrameCount = 0;
+            frameCount = 0;
             resample_time -= FRAME_ERR_RESAMPLE_US;
         }
     }
@@ -414,15 +503,85 @@ void setLinkQualityDirect(uint16_t linkqualityValue)
 #endif
 }
 
+#ifdef USE_RX_DIVERSITY
+// Picks the receiver to use from the frame status each receiver reported in this update. A switch only
+// happens onto a good frame of the other receiver, when the active one has gone quiet for several of its
+// frame intervals or the other one has had a clearly better link for a while.
+STATIC_UNIT_TESTED uint8_t rxDiversitySelectReceiver(uint8_t activeReceiver, const uint8_t *frameStatus, timeUs_t currentTimeUs)
+{
+    for (int i = 0; i < RX_RECEIVER_COUNT; i++) {
+        if (frameStatus[i] & RX_FRAME_COMPLETE) {
+            rxDiversityState_t *state = &rxDiversityState[i];
+            const bool goodFrame = !(frameStatus[i] & (RX_FRAME_FAILSAFE | RX_FRAME_DROPPED));
+            const int sample = goodFrame ? LINK_QUALITY_MAX_VALUE : 0;
+            state->linkQuality += (sample - state->linkQuality) >> RX_DIVERSITY_LINK_QUALITY_SHIFT;
+            if (goodFrame) {
+                state->lastGoodFrameUs = currentTimeUs;
+            }
+        }
+    }
+
+    const uint8_t otherReceiver = activeReceiver ^ 1;
+    const uint8_t otherStatus = frameStatus[otherReceiver];
+    if ((otherStatus & RX_FRAME_COMPLETE) && !(otherStatus & (RX_FRAME_FAILSAFE | RX_FRAME_DROPPED))) {
+        const rxDiversityState_t *active = &rxDiversityState[activeReceiver];
+        const bool activeStale = cmpTimeUs(currentTimeUs, active->lastGoodFrameUs) > RX_DIVERSITY_STALE_FRAME_COUNT * active->frameIntervalUs;
+        const bool otherBetter = rxDiversityState[otherReceiver].linkQuality > active->linkQuality + RX_DIVERSITY_LINK_QUALITY_MARGIN;
+        if (activeStale || otherBetter) {
+            return otherReceiver;
+        }
+    }
+
+    return activeReceiver;
+}
+
+static uint8_t rxDiversityFrameStatus(timeUs_t currentTimeUs)
+{
+    rxRuntimeConfig_t *receivers[RX_RECEIVER_COUNT] = { &rxRuntimeConfig, &rxRuntimeConfigDiversity };
+    uint8_t frameStatus[RX_RECEIVER_COUNT];
+
+    // both receivers decode into their own channel buffers
+    for (int i = 0; i < RX_RECEIVER_COUNT; i++) {
+        frameStatus[i] = RX_FRAME_STATUS(receivers[i]);
+        rxDiversityState[i].frameIntervalUs = receivers[i]->rxRefreshRate;
+    }
+
+    const uint8_t activeReceiver = rxDiversitySelectReceiver(activeRxRuntimeConfig->receiverIndex, frameStatus, currentTimeUs);
+    if (activeReceiver != activeRxRuntimeConfig->receiverIndex) {
+        activeRxRuntimeConfig = receivers[activeReceiver];
+        rxDiversitySwitchCount++;
+    }
+
+    DEBUG_SET(DEBUG_RX_DIVERSITY, 0, activeReceiver);
+    DEBUG_SET(DEBUG_RX_DIVERSITY, 1, rxDiversityState[0].linkQuality);
+    DEBUG_SET(DEBUG_RX_DIVERSITY, 2, rxDiversityState[1].linkQuality);
+    DEBUG_SET(DEBUG_RX_DIVERSITY, 3, rxDiversitySwitchCount);
+
+    // auxiliary processing (telemetry) stays with the receiver on FUNCTION_RX_SERIAL
+    return (frameStatus[activeReceiver] & ~RX_FRAME_PROCESSING_REQUIRED) | (frameStatus[0] & RX_FRAME_PROCESSING_REQUIRED);
+}
+#endif
+
+// The watchdog holds the next moment at which signal loss handling has something to act on. It is
+// re-armed by every valid frame and, while the signal is lost, by the end of the channel hold and of
+// the failsafe delay, so none of these wait for the next 33Hz update of the RX task.
+static void rxWatchdogArm(timeUs_t deadlineUs)
+{
+    rxWatchdogDeadlineUs = deadlineUs;
+    rxWatchdogArmed = true;
+}
+
 bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
 {
     bool signalReceived = false;
     bool useDataDrivenProcessing = true;
+    timeUs_t frameTimeUs = currentTimeUs;
 
 #if defined(USE_PWM) || defined(USE_PPM)
     if (featureIsEnabled(FEATURE_RX_PPM)) {
         if (isPPMDataBeingReceived()) {
             signalReceived = true;
+            frameTimeUs = currentTimeUs;
             rxIsInFailsafeMode = false;
             needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
             resetPPMDataReceivedState();
@@ -430,6 +589,7 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
     } else if (featureIsEnabled(FEATURE_RX_PARALLEL_PWM)) {
         if (isPWMDataBeingReceived()) {
             signalReceived = true;
+            frameTimeUs = currentTimeUs;
             rxIsInFailsafeMode = false;
             needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
             useDataDrivenProcessing = false;
@@ -437,13 +597,18 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
     } else
 #endif
     {
-        const uint8_t frameStatus = rxRuntimeConfig.rcFrameStatusFn(&rxRuntimeConfig);
+#ifdef USE_RX_DIVERSITY
+        const uint8_t frameStatus = rxDiversityEnabled ? rxDiversityFrameStatus(currentTimeUs) : RX_FRAME_STATUS(&rxRuntimeConfig);
+#else
+        const uint8_t frameStatus = RX_FRAME_STATUS(&rxRuntimeConfig);
+#endif
         if (frameStatus & RX_FRAME_COMPLETE) {
             rxIsInFailsafeMode = (frameStatus & RX_FRAME_FAILSAFE) != 0;
             bool rxFrameDropped = (frameStatus & RX_FRAME_DROPPED) != 0;
             signalReceived = !(rxIsInFailsafeMode || rxFrameDropped);
             if (signalReceived) {
                 needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
+                frameTimeUs = activeRxRuntimeConfig->rcFrameTimeUsFn ? activeRxRuntimeConfig->rcFrameTimeUsFn(activeRxRuntimeConfig) : currentTimeUs;
             }
 
             setLinkQuality(signalReceived, currentDeltaTime);
@@ -456,10 +621,23 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
 
     if (signalReceived) {
         rxSignalReceived = true;
+        rxWatchdogArm(needRxSignalBefore);
+        TRACE_EVENT(TRACE_RX_FRAME, 0, 0);
+#ifdef USE_RC_LATENCY
+        rcLatencyFrameReceived(frameTimeUs);
+#else
+        UNUSED(frameTimeUs);
+#endif
     } else if (currentTimeUs >= needRxSignalBefore) {
         rxSignalReceived = false;
     }
 
+    if (rxWatchdogArmed && cmpTimeUs(currentTimeUs, rxWatchdogDeadlineUs) >= 0) {
+        rxWatchdogArmed = false;
+        rxDataProcessingRequired = true;
+        DEBUG_SET(DEBUG_RX_SIGNAL_LOSS, 2, ++rxWatchdogExpiryCount);
+    }
+
     if ((signalReceived && useDataDrivenProcessing) || cmpTimeUs(currentTimeUs, rxNextUpdateAtUs) > 0) {
         rxDataProcessingRequired = true;
     }
@@ -470,14 +648,9 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
 #if defined(USE_PWM) || defined(USE_PPM)
 static uint16_t calculateChannelMovingAverage(uint8_t chan, uint16_t sample)
 {
-    static int16_t rcSamples[MAX_SUPPORTED_RX_PARALLEL_PWM_OR_PPM_CHANNEL_COUNT][PPM_AND_PWM_SAMPLE_COUNT];
-    static int16_t rcDataMean[MAX_SUPPORTED_RX_PARALLEL_PWM_OR_PPM_CHANNEL_COUNT];
     static bool rxSamplesCollected = false;
 
-    const uint8_t currentSampleIndex = rcSampleIndex % PPM_AND_PWM_SAMPLE_COUNT;
-
-    // update the recent samples and compute the average of them
-    rcSamples[chan][currentSampleIndex] = sample;
+    const uint16_t average = intMovingAverageUpdate(&rcSampleAverage[chan], sample);
 
     // avoid returning an incorrect average which would otherwise occur before enough samples
     if (!rxSamplesCollected) {
@@ -487,11 +660,7 @@ static uint16_t calculateChannelMovingAverage(uint8_t chan, uint16_t sample)
         rxSamplesCollected = true;
     }
 
-    rcDataMean[chan] = 0;
-    for (int sampleIndex = 0; sampleIndex < PPM_AND_PWM_SAMPLE_COUNT; sampleIndex++) {
-        rcDataMean[chan] += rcSamples[chan][sampleIndex];
-    }
-    return rcDataMean[chan] / PPM_AND_PWM_SAMPLE_COUNT;
+    return average;
 }
 #endif
 
@@ -545,7 +714,7 @@ static void readRxChannelsApplyRanges(void)
         const uint8_t rawChannel = channel < RX_MAPPABLE_CHANNEL_COUNT ? rxConfig()->rcmap[channel] : channel;
 
         // sample the channel
-        uint16_t sample = rxRuntimeConfig.rcReadRawFn(&rxRuntimeConfig, rawChannel);
+        uint16_t sample = RX_READ_RAW(activeRxRuntimeConfig, rawChannel);
 
         // apply the rx calibration
         if (channel < NON_AUX_CHANNEL_COUNT) {
@@ -556,9 +725,11 @@ static void readRxChannelsApplyRanges(void)
     }
 }
 
-static void detectAndApplySignalLossBehaviour(void)
+static void detectAndApplySignalLossBehaviour(timeUs_t currentTimeUs)
 {
     const uint32_t currentTimeMs = millis();
+    bool holdingChannels = false;
+    uint32_t holdEndsAtMs = 0;
 
     const bool useValueFromRx = rxSignalReceived && !rxIsInFailsafeMode;
 
@@ -575,6 +746,10 @@ static void detectAndApplySignalLossBehaviour(void)
             rcInvalidPulsPeriod[channel] = currentTimeMs + MAX_INVALID_PULS_TIME;
         } else {
             if (cmp32(currentTimeMs, rcInvalidPulsPeriod[channel]) < 0) {
+                if (!holdingChannels || cmp32(rcInvalidPulsPeriod[channel], holdEndsAtMs) < 0) {
+                    holdEndsAtMs = rcInvalidPulsPeriod[channel];
+                    holdingChannels = true;
+                }
                 continue;           // skip to next channel to hold channel value MAX_INVALID_PULS_TIME
             } else {
                 sample = getRxfailValue(channel);   // after that apply rxfail value
@@ -603,6 +778,17 @@ static void detectAndApplySignalLossBehaviour(void)
             rcData[channel] = getRxfailValue(channel);
         }
     }
+
+    if (!useValueFromRx) {
+        uint32_t nextEventAtMs = failsafeRxLinkDownAtMs();
+        if (holdingChannels && cmp32(holdEndsAtMs, nextEventAtMs) < 0) {
+            nextEventAtMs = holdEndsAtMs;
+        }
+        if (cmp32(nextEventAtMs, currentTimeMs) > 0) {
+            rxWatchdogArm(currentTimeUs + (nextEventAtMs - currentTimeMs) * 1000);
+        }
+    }
+
     DEBUG_SET(DEBUG_RX_SIGNAL_LOSS, 3, rcData[THROTTLE]);
 }
 
@@ -629,7 +815,7 @@ bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
     }
 
     readRxChannelsApplyRanges();
-    detectAndApplySignalLossBehaviour();
+    detectAndApplySignalLossBehaviour(currentTimeUs);
 
     rcSampleIndex++;
 
@@ -657,17 +843,8 @@ void setRssiDirect(uint16_t newRssi, rssiSource_e source)
 
 #define RSSI_SAMPLE_COUNT 16
 
-static uint16_t updateRssiSamples(uint16_t value)
-{
-    static uint16_t samples[RSSI_SAMPLE_COUNT];
-    static uint8_t sampleIndex = 0;
-    static unsigned sum = 0;
-
-    sum += value - samples[sampleIndex];
-    samples[sampleIndex] = value;
-    sampleIndex = (sampleIndex + 1) % RSSI_SAMPLE_COUNT;
-    return sum / RSSI_SAMPLE_COUNT;
-}
+static uint16_t rssiSamples[RSSI_SAMPLE_COUNT];
+static intMovingAverage_t rssiAverage = { .buf = rssiSamples, .windowSize = RSSI_SAMPLE_COUNT };
 
 void setRssi(uint16_t rssiValue, rssiSource_e source)
 {
@@ -680,7 +857,7 @@ void setRssi(uint16_t rssiValue, rssiSource_e source)
         rssi = pt1FilterApply(&frameErrFilter, rssiValue);
     } else {
         // calculate new sample mean
-        rssi = updateRssiSamples(rssiValue);
+        rssi = intMovingAverageUpdate(&rssiAverage, rssiValue);
     }
 }
 
@@ -770,17 +947,8 @@ uint8_t getRssiDbm(void)
 
 #define RSSI_SAMPLE_COUNT_DBM 16
 
-static uint8_t updateRssiDbmSamples(uint8_t value)
-{
-    static uint16_t samplesdbm[RSSI_SAMPLE_COUNT_DBM];
-    static uint8_t sampledbmIndex = 0;
-    static unsigned sumdbm = 0;
-
-    sumdbm += value - samplesdbm[sampledbmIndex];
-    samplesdbm[sampledbmIndex] = value;
-    sampledbmIndex = (sampledbmIndex + 1) % RSSI_SAMPLE_COUNT_DBM;
-    return sumdbm / RSSI_SAMPLE_COUNT_DBM;
-}
+static uint16_t rssiDbmSamples[RSSI_SAMPLE_COUNT_DBM];
+static intMovingAverage_t rssiDbmAverage = { .buf = rssiDbmSamples, .windowSize = RSSI_SAMPLE_COUNT_DBM };
 
 void setRssiDbm(uint8_t rssiDbmValue, rssiSource_e source)
 {
@@ -788,7 +956,7 @@ void setRssiDbm(uint8_t rssiDbmValue, rssiSource_e source)
         return;
     }
 
-    rssi_dbm = updateRssiDbmSamples(rssiDbmValue);
+    rssi_dbm = intMovingAverageUpdate(&rssiDbmAverage, rssiDbmValue);
 }
 
 void setRssiDbmDirect(uint8_t newRssiDbm, rssiSource_e source)
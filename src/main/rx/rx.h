@@ -125,13 +125,30 @@ struct rxRuntimeConfig_s;
 typedef uint16_t (*rcReadRawDataFnPtr)(const struct rxRuntimeConfig_s *rxRuntimeConfig, uint8_t chan); // used by receiver driver to return channel data
 typedef uint8_t (*rcFrameStatusFnPtr)(struct rxRuntimeConfig_s *rxRuntimeConfig);
 typedef bool (*rcProcessFrameFnPtr)(const struct rxRuntimeConfig_s *rxRuntimeConfig);
+typedef timeUs_t (*rcGetFrameTimeUsFnPtr)(const struct rxRuntimeConfig_s *rxRuntimeConfig); // used by receiver driver to return the time the last channel data frame was received
+
+#ifdef USE_RX_DIVERSITY
+#define RX_RECEIVER_COUNT 2     // a second serial receiver of the same provider on FUNCTION_RX_SERIAL_2
+#else
+#define RX_RECEIVER_COUNT 1
+#endif
+
+#ifdef USE_RX_DIVERSITY
+typedef struct rxDiversityState_s {
+    timeUs_t lastGoodFrameUs;
+    timeDelta_t frameIntervalUs;
+    int16_t linkQuality;                // [0;LINK_QUALITY_MAX_VALUE]
+} rxDiversityState_t;
+#endif
 
 typedef struct rxRuntimeConfig_s {
+    uint8_t             receiverIndex; // which of the RX_RECEIVER_COUNT receivers this is, 0 is the one on FUNCTION_RX_SERIAL
     uint8_t             channelCount; // number of RC channels as reported by current input driver
     uint16_t            rxRefreshRate;
     rcReadRawDataFnPtr  rcReadRawFn;
     rcFrameStatusFnPtr  rcFrameStatusFn;
     rcProcessFrameFnPtr rcProcessFrameFn;
+    rcGetFrameTimeUsFnPtr rcFrameTimeUsFn;
     uint16_t            *channelData;
     void                *frameData;
 } rxRuntimeConfig_t;
@@ -161,6 +178,7 @@ void rxInit(void);
 bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 bool rxIsReceivingSignal(void);
 bool rxAreFlightChannelsValid(void);
+timeDelta_t rxGetFrameDelta(timeDelta_t *frameAgeUs);
 bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs);
 
 struct rxConfig_s;
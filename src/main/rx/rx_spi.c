@@ -33,6 +33,7 @@
 
 #include "drivers/rx/rx_spi.h"
 #include "drivers/rx/rx_nrf24l01.h"
+#include "drivers/time.h"
 
 #include "fc/config.h"
 
@@ -54,6 +55,7 @@
 uint16_t rxSpiRcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
 STATIC_UNIT_TESTED uint8_t rxSpiPayload[RX_SPI_MAX_PAYLOAD_SIZE];
 STATIC_UNIT_TESTED uint8_t rxSpiNewPacketAvailable; // set true when a new packet is received
+static timeUs_t rxSpiPacketTimeUs;
 
 typedef bool (*protocolInitFnPtr)(const rxSpiConfig_t *rxSpiConfig, rxRuntimeConfig_t *rxRuntimeConfig);
 typedef rx_spi_received_e (*protocolDataReceivedFnPtr)(uint8_t *payload);
@@ -184,6 +186,7 @@ static uint8_t rxSpiFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 
     if (result & RX_SPI_RECEIVED_DATA) {
         rxSpiNewPacketAvailable = true;
+        rxSpiPacketTimeUs = micros();
         status = RX_FRAME_COMPLETE;
     }
 
@@ -213,6 +216,13 @@ static bool rxSpiProcessFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
     return true;
 }
 
+static timeUs_t rxSpiFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    UNUSED(rxRuntimeConfig);
+
+    return rxSpiPacketTimeUs;
+}
+
 /*
  * Set and initialize the RX protocol
  */
@@ -233,6 +243,7 @@ bool rxSpiInit(const rxSpiConfig_t *rxSpiConfig, rxRuntimeConfig_t *rxRuntimeCon
     rxRuntimeConfig->rcReadRawFn = rxSpiReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = rxSpiFrameStatus;
     rxRuntimeConfig->rcProcessFrameFn = rxSpiProcessFrame;
+    rxRuntimeConfig->rcFrameTimeUsFn = rxSpiFrameTimeUs;
 
     return ret;
 }
@@ -104,6 +104,8 @@ typedef union sbusFrame_u {
 typedef struct sbusFrameData_s {
     sbusFrame_t frame;
     uint32_t startAtUs;
+    timeUs_t doneAtUs;
+    timeUs_t frameTimeUs;
     uint8_t position;
     bool done;
 } sbusFrameData_t;
@@ -134,18 +136,20 @@ static void sbusDataReceive(uint16_t c, void *data)
         if (sbusFrameData->position < SBUS_FRAME_SIZE) {
             sbusFrameData->done = false;
         } else {
+            sbusFrameData->doneAtUs = nowUs;
             sbusFrameData->done = true;
             DEBUG_SET(DEBUG_SBUS, DEBUG_SBUS_FRAME_TIME, sbusFrameTime);
         }
     }
 }
 
-static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
+uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     sbusFrameData_t *sbusFrameData = rxRuntimeConfig->frameData;
     if (!sbusFrameData->done) {
         return RX_FRAME_PENDING;
     }
+    sbusFrameData->frameTimeUs = sbusFrameData->doneAtUs;
     sbusFrameData->done = false;
 
     DEBUG_SET(DEBUG_SBUS, DEBUG_SBUS_FRAME_FLAGS, sbusFrameData->frame.frame.channels.flags);
@@ -153,14 +157,23 @@ static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     return sbusChannelsDecode(rxRuntimeConfig, &sbusFrameData->frame.frame.channels);
 }
 
-bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
+static timeUs_t sbusGetFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
 {
-    static uint16_t sbusChannelData[SBUS_MAX_CHANNEL];
-    static sbusFrameData_t sbusFrameData;
-    static uint32_t sbusBaudRate;
+    const sbusFrameData_t *sbusFrameData = rxRuntimeConfig->frameData;
+
+    return sbusFrameData->frameTimeUs;
+}
 
-    rxRuntimeConfig->channelData = sbusChannelData;
-    rxRuntimeConfig->frameData = &sbusFrameData;
+bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    // every receiver gets its own frame and channel buffers, see USE_RX_DIVERSITY
+    static uint16_t sbusChannelData[RX_RECEIVER_COUNT][SBUS_MAX_CHANNEL];
+    static sbusFrameData_t sbusFrameData[RX_RECEIVER_COUNT];
+    uint32_t sbusBaudRate;
+
+    const uint8_t receiverIndex = rxRuntimeConfig->receiverIndex;
+    rxRuntimeConfig->channelData = sbusChannelData[receiverIndex];
+    rxRuntimeConfig->frameData = &sbusFrameData[receiverIndex];
     sbusChannelsInit(rxConfig, rxRuntimeConfig);
 
     rxRuntimeConfig->channelCount = SBUS_MAX_CHANNEL;
@@ -174,22 +187,24 @@ bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     }
 
     rxRuntimeConfig->rcFrameStatusFn = sbusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = sbusGetFrameTimeUs;
 
-    const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
+    const serialPortFunction_e portFunction = receiverIndex ? FUNCTION_RX_SERIAL_2 : FUNCTION_RX_SERIAL;
+    const serialPortConfig_t *portConfig = findSerialPortConfig(portFunction);
     if (!portConfig) {
         return false;
     }
 
 #ifdef USE_TELEMETRY
-    bool portShared = telemetryCheckRxPortShared(portConfig);
+    bool portShared = !receiverIndex && telemetryCheckRxPortShared(portConfig);
 #else
     bool portShared = false;
 #endif
 
     serialPort_t *sBusPort = openSerialPort(portConfig->identifier,
-        FUNCTION_RX_SERIAL,
+        portFunction,
         sbusDataReceive,
-        &sbusFrameData,
+        rxRuntimeConfig->frameData,
         sbusBaudRate,
         portShared ? MODE_RXTX : MODE_RX,
         SBUS_PORT_OPTIONS | (rxConfig->serialrx_inverted ? 0 : SERIAL_INVERTED) | (rxConfig->halfDuplex ? SERIAL_BIDIR : 0)
@@ -41,25 +41,28 @@
 #define SBUS_DIGITAL_CHANNEL_MIN 173
 #define SBUS_DIGITAL_CHANNEL_MAX 1812
 
+#define SBUS_CHANNEL_BITS 11
+#define SBUS_CHANNEL_MASK ((1 << SBUS_CHANNEL_BITS) - 1)
+#define SBUS_PACKED_CHANNEL_COUNT 16
+
 uint8_t sbusChannelsDecode(rxRuntimeConfig_t *rxRuntimeConfig, const sbusChannels_t *channels)
 {
     uint16_t *sbusChannelData = rxRuntimeConfig->channelData;
-    sbusChannelData[0] = channels->chan0;
-    sbusChannelData[1] = channels->chan1;
-    sbusChannelData[2] = channels->chan2;
-    sbusChannelData[3] = channels->chan3;
-    sbusChannelData[4] = channels->chan4;
-    sbusChannelData[5] = channels->chan5;
-    sbusChannelData[6] = channels->chan6;
-    sbusChannelData[7] = channels->chan7;
-    sbusChannelData[8] = channels->chan8;
-    sbusChannelData[9] = channels->chan9;
-    sbusChannelData[10] = channels->chan10;
-    sbusChannelData[11] = channels->chan11;
-    sbusChannelData[12] = channels->chan12;
-    sbusChannelData[13] = channels->chan13;
-    sbusChannelData[14] = channels->chan14;
-    sbusChannelData[15] = channels->chan15;
+
+    // The channels are packed LSB first, so the whole block is unpacked through one bit
+    // accumulator instead of extracting each bitfield with its own unaligned shifts and masks
+    const uint8_t *packed = (const uint8_t *)channels;
+    uint32_t bits = 0;
+    unsigned bitCount = 0;
+    for (int i = 0; i < SBUS_PACKED_CHANNEL_COUNT; i++) {
+        while (bitCount < SBUS_CHANNEL_BITS) {
+            bits |= (uint32_t)*packed++ << bitCount;
+            bitCount += 8;
+        }
+        sbusChannelData[i] = bits & SBUS_CHANNEL_MASK;
+        bits >>= SBUS_CHANNEL_BITS;
+        bitCount -= SBUS_CHANNEL_BITS;
+    }
 
     if (channels->flags & SBUS_FLAG_CHANNEL_17) {
         sbusChannelData[16] = SBUS_DIGITAL_CHANNEL_MAX;
@@ -87,7 +90,7 @@ uint8_t sbusChannelsDecode(rxRuntimeConfig_t *rxRuntimeConfig, const sbusChannel
     return RX_FRAME_COMPLETE;
 }
 
-static uint16_t sbusChannelsReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
+uint16_t sbusChannelsReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
 {
     // Linear fitting values read from OpenTX-ppmus and comparing with values received by X4R
     // http://www.wolframalpha.com/input/?i=linear+fit+%7B173%2C+988%7D%2C+%7B1812%2C+2012%7D%2C+%7B993%2C+1500%7D
@@ -24,6 +24,8 @@
 
 #ifdef USE_SERIALRX_SRXL2
 
+#include "build/debug.h"
+
 #include "common/crc.h"
 #include "common/maths.h"
 #include "common/streambuf.h"
@@ -39,6 +41,8 @@
 #include "rx/srxl2_types.h"
 #include "io/spektrum_vtx_control.h"
 
+#include "scheduler/scheduler.h"
+
 #ifndef SRXL2_DEBUG
 #define SRXL2_DEBUG 0
 #endif
@@ -63,7 +67,8 @@
 #define SRXL2_PORT_OPTIONS             (SERIAL_STOPBITS_1 | SERIAL_PARITY_NO | SERIAL_BIDIR)
 #define SRXL2_PORT_MODE                MODE_RXTX
 
-#define SRXL2_REPLY_QUIESCENCE         (2 * 10 * 1000000 / SRXL2_PORT_BAUDRATE_DEFAULT) // 2 * (lastIdleTimestamp - lastReceiveTimestamp). Time taken to send 2 bytes
+#define SRXL2_REPLY_QUIESCENCE_CHARS   2 // 2 * (lastIdleTimestamp - lastReceiveTimestamp). Bus must be quiet for 2 bytes before replying
+#define SRXL2_REPLY_SLOT_US            1000 // a polled device must start its reply within this window, later replies collide with the next frame
 
 #define SRXL2_ID                       0xA6
 #define SRXL2_MAX_PACKET_LENGTH        80
@@ -105,10 +110,25 @@ static volatile bool transmittingTelemetry = false;
 static uint8_t writeBuffer[SRXL2_MAX_PACKET_LENGTH];
 static unsigned writeBufferIdx = 0;
 
+// Telemetry is staged ahead of the poll so that it can go out as soon as the bus master hands us the slot
+static uint8_t telemetryReply[SRXL2_MAX_PACKET_LENGTH];
+static unsigned telemetryReplyLen = 0;
+
+static volatile bool replySlotOpen = false;
+static volatile uint32_t replySlotTimestamp = 0;
+static uint32_t replyQuiescenceUs;
+static uint32_t pendingBaudRate = 0;
+
+static struct {
+    volatile uint16_t slotCount;    // polls addressed to us
+    uint16_t replyCount;            // telemetry replies started within the slot
+    uint16_t lateCount;             // slots the RX task reached after the window had closed
+    uint16_t emptyCount;            // slots with no telemetry staged
+} slotStats;
+
 static serialPort_t *serialPort;
 
 static uint8_t busMasterDeviceId = 0xFF;
-static bool telemetryRequested = false;
 
 static uint8_t telemetryFrame[22];
 
@@ -126,6 +146,13 @@ uint8_t globalResult = 0;
 
 // if 50ms with not activity, go to default baudrate and to step 1
 
+static void srxl2SetBaudRate(uint32_t baud)
+{
+    serialSetBaudRate(serialPort, baud);
+    replyQuiescenceUs = SRXL2_REPLY_QUIESCENCE_CHARS * 10 * 1000000 / baud;
+    pendingBaudRate = 0;
+}
+
 bool srxl2ProcessHandshake(const Srxl2Header* header)
 {
     const Srxl2HandshakeSubHeader* handshake = (Srxl2HandshakeSubHeader*)(header + 1);
@@ -133,8 +160,9 @@ bool srxl2ProcessHandshake(const Srxl2Header* header)
         DEBUG_PRINTF("broadcast handshake from %x\r\n", handshake->sourceDeviceId);
         busMasterDeviceId = handshake->sourceDeviceId;
 
-        if (handshake->baudSupported == 1) {
-            serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_HIGH);
+        // The switch is applied by srxl2ProcessFrame() once nothing of ours is left on the wire
+        if (handshake->baudSupported == 1 && baudRate) {
+            pendingBaudRate = SRXL2_PORT_BAUDRATE_HIGH;
             DEBUG_PRINTF("switching to %d baud\r\n", SRXL2_PORT_BAUDRATE_HIGH);
         }
 
@@ -197,11 +225,6 @@ void srxl2ProcessChannelData(const Srxl2ChannelDataHeader* channelData, rxRuntim
 bool srxl2ProcessControlData(const Srxl2Header* header, rxRuntimeConfig_t *rxRuntimeConfig)
 {
     const Srxl2ControlDataSubHeader* controlData = (Srxl2ControlDataSubHeader*)(header + 1);
-    const uint8_t ownId = (FlightController << 4) | unitId;
-    if (controlData->replyId == ownId) {
-        telemetryRequested = true;
-        DEBUG_PRINTF("command: %x replyId: %x ownId: %x\r\n", controlData->command, controlData->replyId, ownId);
-    }
 
     switch (controlData->command) {
     case ChannelData:
@@ -261,6 +284,7 @@ void srxl2Process(rxRuntimeConfig_t *rxRuntimeConfig)
     if (processBufferPtr->packet.header.id != SRXL2_ID || processBufferPtr->len != processBufferPtr->packet.header.length) {
         DEBUG_PRINTF("invalid header id: %x, or length: %x received vs %x expected \r\n", processBufferPtr->packet.header.id, processBufferPtr->len, processBufferPtr->packet.header.length);
         globalResult = RX_FRAME_DROPPED;
+        replySlotOpen = false;
         return;
     }
 
@@ -269,6 +293,7 @@ void srxl2Process(rxRuntimeConfig_t *rxRuntimeConfig)
     //Invalid if crc non-zero
     if (calculatedCrc) {
         globalResult = RX_FRAME_DROPPED;
+        replySlotOpen = false;
         DEBUG_PRINTF("crc mismatch %x\r\n", calculatedCrc);
         return;
     }
@@ -302,6 +327,17 @@ static void srxl2DataReceive(uint16_t character, void *data)
     }
 }
 
+// Called from the idle interrupt on a complete frame, the CRC is checked later by srxl2Process()
+static bool srxl2FramePollsUs(const struct rxBuf *buf)
+{
+    const Srxl2ControlDataSubHeader *controlData = (const Srxl2ControlDataSubHeader *)(&buf->packet.header + 1);
+
+    return buf->len >= sizeof(Srxl2Header) + sizeof(Srxl2ControlDataSubHeader)
+        && buf->packet.header.id == SRXL2_ID
+        && buf->packet.header.packetType == ControlData
+        && controlData->replyId == ((FlightController << 4) | unitId);
+}
+
 static void srxl2Idle()
 {
     if(transmittingTelemetry) { // Transmitting telemetry triggers idle interrupt as well. We dont want to change buffers then
@@ -321,11 +357,26 @@ static void srxl2Idle()
             readBufferPtr = &readBuffer[1];
         }
         processBufferPtr->len = readBufferIdx;
+
+        // Open the reply slot right at the bus turnaround and get the RX task to send into it
+        if (srxl2FramePollsUs(processBufferPtr)) {
+            replySlotTimestamp = lastReceiveTimestamp;
+            replySlotOpen = true;
+            slotStats.slotCount++;
+            schedulerWakeTask(TASK_RX);
+        }
     }
 
     readBufferIdx = 0;
 }
 
+// The bus master has stopped and the line has been quiet for long enough to drive it
+static bool srxl2BusQuiet(uint32_t now)
+{
+    return cmpTimeUs(lastIdleTimestamp, lastReceiveTimestamp) > 0
+        && cmpTimeUs(now, lastReceiveTimestamp) >= (timeDelta_t)replyQuiescenceUs;
+}
+
 static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     UNUSED(rxRuntimeConfig);
@@ -357,9 +408,9 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
                 uint32_t currentBaud = serialGetBaudRate(serialPort);
 
                 if(currentBaud == SRXL2_PORT_BAUDRATE_DEFAULT)
-                    serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_HIGH);
+                    srxl2SetBaudRate(SRXL2_PORT_BAUDRATE_HIGH);
                 else
-                    serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_DEFAULT);
+                    srxl2SetBaudRate(SRXL2_PORT_BAUDRATE_DEFAULT);
             }
         } else if (cmpTimeUs(now, timeoutTimestamp) >= 0) {
             // @todo if there was activity - detect baudrate and ListenForHandshake
@@ -383,7 +434,7 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
         }
 
         if (cmpTimeUs(now, fullTimeoutTimestamp) >= 0) {
-            serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_DEFAULT);
+            srxl2SetBaudRate(SRXL2_PORT_BAUDRATE_DEFAULT);
             DEBUG_PRINTF("case SendHandshake: switching to %d baud\r\n", SRXL2_PORT_BAUDRATE_DEFAULT);
             timeoutTimestamp = now + SRXL2_LISTEN_FOR_ACTIVITY_TIMEOUT_US;
             result = (result & ~RX_FRAME_PENDING) | RX_FRAME_FAILSAFE;
@@ -395,7 +446,7 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 
     case ListenForHandshake: {
         if (cmpTimeUs(now, timeoutTimestamp) >= 0)  {
-            serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_DEFAULT);
+            srxl2SetBaudRate(SRXL2_PORT_BAUDRATE_DEFAULT);
             DEBUG_PRINTF("case ListenForHandshake: switching to %d baud\r\n", SRXL2_PORT_BAUDRATE_DEFAULT);
             timeoutTimestamp = now + SRXL2_LISTEN_FOR_ACTIVITY_TIMEOUT_US;
             result = (result & ~RX_FRAME_PENDING) | RX_FRAME_FAILSAFE;
@@ -408,7 +459,7 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     case Running: {
         // frame timed out, reset state
         if (cmpTimeUs(now, lastValidPacketTimestamp) >= SRXL2_FRAME_TIMEOUT_US) {
-            serialSetBaudRate(serialPort, SRXL2_PORT_BAUDRATE_DEFAULT);
+            srxl2SetBaudRate(SRXL2_PORT_BAUDRATE_DEFAULT);
             DEBUG_PRINTF("case Running: switching to %d baud: %d %d\r\n", SRXL2_PORT_BAUDRATE_DEFAULT, now, lastValidPacketTimestamp);
             timeoutTimestamp = now + SRXL2_LISTEN_FOR_ACTIVITY_TIMEOUT_US;
             result = (result & ~RX_FRAME_PENDING) | RX_FRAME_FAILSAFE;
@@ -420,7 +471,9 @@ static uint8_t srxl2FrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     } break;
     };
 
-    if (writeBufferIdx) {
+    // Only ask for processing once the reply can actually go out, the check function runs on
+    // every scheduler pass so this starts the reply within a pass of the quiescence expiring
+    if (pendingBaudRate || ((writeBufferIdx || replySlotOpen) && srxl2BusQuiet(now))) {
         result |= RX_FRAME_PROCESSING_REQUIRED;
     }
 
@@ -431,26 +484,44 @@ static bool srxl2ProcessFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
 {
     UNUSED(rxRuntimeConfig);
 
-    if (writeBufferIdx == 0) {
-        return true;
+    const uint32_t now = micros();
+
+    if (pendingBaudRate && !transmittingTelemetry && isSerialTransmitBufferEmpty(serialPort)) {
+        srxl2SetBaudRate(pendingBaudRate);
     }
 
-    const uint32_t now = micros();
+    if (!srxl2BusQuiet(now)) {
+        DEBUG_PRINTF("bus not quiet yet, %d us since last receive, %d required\r\n", now - lastReceiveTimestamp, replyQuiescenceUs);
+        return !pendingBaudRate;
+    }
 
-    if (cmpTimeUs(lastIdleTimestamp, lastReceiveTimestamp) > 0) {
-        // time sufficient for at least 2 characters has passed
-        if (cmpTimeUs(now, lastReceiveTimestamp) > SRXL2_REPLY_QUIESCENCE) {
+    if (writeBufferIdx) {
+        // Handshake and bind replies take precedence over telemetry
+        transmittingTelemetry = true;
+        serialWriteBuf(serialPort, writeBuffer, writeBufferIdx);
+        writeBufferIdx = 0;
+        replySlotOpen = false;
+    } else if (replySlotOpen) {
+        replySlotOpen = false;
+        if (cmpTimeUs(now, replySlotTimestamp) > SRXL2_REPLY_SLOT_US) {
+            // Keep the reply staged for the next slot rather than colliding with the next frame
+            slotStats.lateCount++;
+        } else if (telemetryReplyLen) {
             transmittingTelemetry = true;
-            serialWriteBuf(serialPort, writeBuffer, writeBufferIdx);
-            writeBufferIdx = 0;
+            serialWriteBuf(serialPort, telemetryReply, telemetryReplyLen);
+            telemetryReplyLen = 0;
+            slotStats.replyCount++;
         } else {
-            DEBUG_PRINTF("not enough time to send 2 characters passed yet, %d us since last receive, %d required\r\n", now - lastReceiveTimestamp, SRXL2_REPLY_QUIESCENCE);
+            slotStats.emptyCount++;
         }
-    } else {
-        DEBUG_PRINTF("still receiving a frame, %d %d\r\n", lastIdleTimestamp, lastReceiveTimestamp);
+
+        DEBUG_SET(DEBUG_SRXL2, 0, slotStats.slotCount);
+        DEBUG_SET(DEBUG_SRXL2, 1, slotStats.replyCount);
+        DEBUG_SET(DEBUG_SRXL2, 2, slotStats.lateCount);
+        DEBUG_SET(DEBUG_SRXL2, 3, slotStats.emptyCount);
     }
 
-    return true;
+    return !pendingBaudRate;
 }
 
 static uint16_t srxl2ReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t channelIdx)
@@ -462,15 +533,20 @@ static uint16_t srxl2ReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t
     return SPEKTRUM_PULSE_OFFSET + ((rxRuntimeConfig->channelData[channelIdx] >> SRXL2_CHANNEL_SHIFT) >> 1);
 }
 
-void srxl2RxWriteData(const void *data, int len)
+static unsigned srxl2CopyWithCrc(uint8_t *dst, const void *data, int len)
 {
     const uint16_t crc = crc16_ccitt_update(0, (uint8_t*)data, len - 2);
     ((uint8_t*)data)[len-2] = ((uint8_t *) &crc)[1] & 0xFF;
     ((uint8_t*)data)[len-1] = ((uint8_t *) &crc)[0] & 0xFF;
-    
-    len = MIN(len, (int)sizeof(writeBuffer));
-    memcpy(writeBuffer, data, len);
-    writeBufferIdx = len;
+
+    len = MIN(len, SRXL2_MAX_PACKET_LENGTH);
+    memcpy(dst, data, len);
+    return len;
+}
+
+void srxl2RxWriteData(const void *data, int len)
+{
+    writeBufferIdx = srxl2CopyWithCrc(writeBuffer, data, len);
 }
 
 bool srxl2RxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
@@ -512,6 +588,7 @@ bool srxl2RxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     }
 
     serialPort->idleCallback = srxl2Idle;
+    replyQuiescenceUs = SRXL2_REPLY_QUIESCENCE_CHARS * 10 * 1000000 / SRXL2_PORT_BAUDRATE_DEFAULT;
 
     state = ListenForActivity;
     timeoutTimestamp = micros() + SRXL2_LISTEN_FOR_ACTIVITY_TIMEOUT_US;
@@ -528,9 +605,9 @@ bool srxl2RxIsActive(void)
     return serialPort;
 }
 
-bool srxl2TelemetryRequested(void)
+bool srxl2TelemetryBufferEmpty(void)
 {
-    return telemetryRequested;
+    return telemetryReplyLen == 0;
 }
 
 void srxl2InitializeFrame(sbuf_t *dst)
@@ -547,9 +624,8 @@ void srxl2InitializeFrame(sbuf_t *dst)
 void srxl2FinalizeFrame(sbuf_t *dst)
 {
   sbufSwitchToReader(dst, telemetryFrame);
-  // Include 2 additional bytes of length since we're letting the srxl2RxWriteData function add the CRC in
-  srxl2RxWriteData(sbufPtr(dst), sbufBytesRemaining(dst) + 2);
-  telemetryRequested = false;
+  // Include 2 additional bytes of length since we're letting srxl2CopyWithCrc add the CRC in
+  telemetryReplyLen = srxl2CopyWithCrc(telemetryReply, sbufPtr(dst), sbufBytesRemaining(dst) + 2);
 }
 
 void srxl2Bind(void)
@@ -11,7 +11,7 @@ struct sbuf_s;
 bool srxl2RxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig);
 bool srxl2RxIsActive(void);
 void srxl2RxWriteData(const void *data, int len);
-bool srxl2TelemetryRequested(void);
+bool srxl2TelemetryBufferEmpty(void);
 void srxl2InitializeFrame(struct sbuf_s *dst);
 void srxl2FinalizeFrame(struct sbuf_s *dst);
 void srxl2Bind(void);
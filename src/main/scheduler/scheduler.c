@@ -27,7 +27,9 @@
 #include "platform.h"
 
 #include "build/build_config.h"
+#include "build/crash_log.h"
 #include "build/debug.h"
+#include "build/trace.h"
 
 #include "scheduler/scheduler.h"
 
@@ -37,8 +39,12 @@
 #include "common/time.h"
 #include "common/utils.h"
 
+#include "drivers/irq_load.h"
+#include "drivers/system.h"
 #include "drivers/time.h"
 
+#include "fc/runtime_config.h"
+
 // DEBUG_SCHEDULER, timings for:
 // 0 - gyroUpdate()
 // 1 - pidController()
@@ -46,11 +52,14 @@
 // 3 - time spent executing check function
 
 static FAST_RAM_ZERO_INIT cfTask_t *currentTask = NULL;
+// Task that is run by schedulerExecuteTask() from an interrupt instead of from the queue
+static FAST_RAM_ZERO_INIT cfTask_t *interruptDrivenTask = NULL;
 
 static FAST_RAM_ZERO_INIT uint32_t totalWaitingTasks;
 static FAST_RAM_ZERO_INIT uint32_t totalWaitingTasksSamples;
 
 static FAST_RAM_ZERO_INIT bool calculateTaskStatistics;
+static FAST_RAM_ZERO_INIT bool deadlineAware;
 FAST_RAM_ZERO_INIT uint16_t averageSystemLoadPercent = 0;
 
 static FAST_RAM_ZERO_INIT int taskQueuePos = 0;
@@ -62,49 +71,75 @@ static FAST_RAM int periodCalculationBasisOffset = offsetof(cfTask_t, lastExecut
 
 STATIC_UNIT_TESTED FAST_RAM_ZERO_INIT cfTask_t* taskQueueArray[TASK_COUNT + 1]; // extra item for NULL pointer at end of queue
 
+// The task ids are dense compile time constants, so queue membership is a bit per id and the queue is
+// rebuilt from taskQueueOrder, the ids sorted by priority once, instead of being searched and shuffled.
+typedef uint64_t taskQueueMembers_t;
+#define TASK_QUEUE_MEMBER(task) ((taskQueueMembers_t)1 << ((task) - cfTasks))
+
+STATIC_ASSERT(TASK_COUNT <= sizeof(taskQueueMembers_t) * 8, task_ids_must_fit_queue_members);
+
+static FAST_RAM_ZERO_INIT taskQueueMembers_t taskQueueMembers;
+static FAST_RAM_ZERO_INIT uint8_t taskQueueOrder[TASK_COUNT];
+
+// A woken event-driven task is given the priority it would have after waiting this many periods
+#define TASK_WAKE_PRIORITY_BOOST 10
+
+// Highest static priority first, tasks of equal priority in id order
+static void queueSortOrder(void)
+{
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        int ii = taskId;
+        for (; ii > 0 && cfTasks[taskQueueOrder[ii - 1]].staticPriority < cfTasks[taskId].staticPriority; --ii) {
+            taskQueueOrder[ii] = taskQueueOrder[ii - 1];
+        }
+        taskQueueOrder[ii] = taskId;
+    }
+}
+
+static void queueRebuild(void)
+{
+    taskQueueSize = 0;
+    for (int ii = 0; ii < TASK_COUNT; ++ii) {
+        cfTask_t *task = &cfTasks[taskQueueOrder[ii]];
+        if (taskQueueMembers & TASK_QUEUE_MEMBER(task)) {
+            taskQueueArray[taskQueueSize++] = task;
+        }
+    }
+    taskQueueArray[taskQueueSize] = NULL;
+}
+
 void queueClear(void)
 {
     memset(taskQueueArray, 0, sizeof(taskQueueArray));
     taskQueuePos = 0;
     taskQueueSize = 0;
+    taskQueueMembers = 0;
+    queueSortOrder();
 }
 
 bool queueContains(cfTask_t *task)
 {
-    for (int ii = 0; ii < taskQueueSize; ++ii) {
-        if (taskQueueArray[ii] == task) {
-            return true;
-        }
-    }
-    return false;
+    return taskQueueMembers & TASK_QUEUE_MEMBER(task);
 }
 
 bool queueAdd(cfTask_t *task)
 {
-    if ((taskQueueSize >= TASK_COUNT) || queueContains(task)) {
+    if (queueContains(task)) {
         return false;
     }
-    for (int ii = 0; ii <= taskQueueSize; ++ii) {
-        if (taskQueueArray[ii] == NULL || taskQueueArray[ii]->staticPriority < task->staticPriority) {
-            memmove(&taskQueueArray[ii+1], &taskQueueArray[ii], sizeof(task) * (taskQueueSize - ii));
-            taskQueueArray[ii] = task;
-            ++taskQueueSize;
-            return true;
-        }
-    }
-    return false;
+    taskQueueMembers |= TASK_QUEUE_MEMBER(task);
+    queueRebuild();
+    return true;
 }
 
 bool queueRemove(cfTask_t *task)
 {
-    for (int ii = 0; ii < taskQueueSize; ++ii) {
-        if (taskQueueArray[ii] == task) {
-            memmove(&taskQueueArray[ii], &taskQueueArray[ii+1], sizeof(task) * (taskQueueSize - ii));
-            --taskQueueSize;
-            return true;
-        }
+    if (!queueContains(task)) {
+        return false;
     }
-    return false;
+    taskQueueMembers &= ~TASK_QUEUE_MEMBER(task);
+    queueRebuild();
+    return true;
 }
 
 /*
@@ -128,6 +163,10 @@ void taskSystemLoad(timeUs_t currentTimeUs)
 {
     UNUSED(currentTimeUs);
 
+#if defined(USE_IRQ_LOAD)
+    irqLoadUpdate();
+#endif
+
     // Calculate system load
     if (totalWaitingTasksSamples > 0) {
         averageSystemLoadPercent = 100 * totalWaitingTasks / totalWaitingTasksSamples;
@@ -137,6 +176,14 @@ void taskSystemLoad(timeUs_t currentTimeUs)
 #if defined(SIMULATOR_BUILD)
     averageSystemLoadPercent = 0;
 #endif
+
+    if (!ARMING_FLAG(ARMED)) {
+        if (averageSystemLoadPercent > 100) {
+            setArmingDisabled(ARMING_DISABLED_LOAD);
+        } else {
+            unsetArmingDisabled(ARMING_DISABLED_LOAD);
+        }
+    }
 }
 
 #if defined(USE_TASK_STATISTICS)
@@ -155,9 +202,81 @@ void getCheckFuncInfo(cfCheckFuncInfo_t *checkFuncInfo)
 }
 #endif
 
+#if defined(USE_TASK_PROFILER)
+static cfTaskProfile_t taskProfiles[TASK_COUNT];
+
+static uint8_t taskProfileBucket(uint32_t value, uint8_t shift)
+{
+    value >>= shift;
+    const int bucket = value ? 32 - __builtin_clz(value) : 0;
+    return MIN(bucket, TASK_PROFILER_BUCKET_COUNT - 1);
+}
+
+static void taskProfileAddSample(uint16_t *histogram, uint8_t bucket)
+{
+    if (histogram[bucket] == UINT16_MAX) {
+        // Halving all buckets when one saturates keeps the shape of the distribution
+        for (int ii = 0; ii < TASK_PROFILER_BUCKET_COUNT; ii++) {
+            histogram[ii] >>= 1;
+        }
+    }
+    histogram[bucket]++;
+}
+
+static void taskProfileRecord(const cfTask_t *task, uint32_t executionCycles, timeDelta_t startLateness)
+{
+    cfTaskProfile_t *profile = &taskProfiles[task - cfTasks];
+    taskProfileAddSample(profile->executionCycles, taskProfileBucket(executionCycles, TASK_PROFILER_EXECUTION_SHIFT));
+    taskProfileAddSample(profile->startLateness, taskProfileBucket(MAX(startLateness, 0), TASK_PROFILER_LATENESS_SHIFT));
+}
+
+const cfTaskProfile_t *getTaskProfile(cfTaskId_e taskId)
+{
+    if (taskId == TASK_SELF) {
+        return &taskProfiles[currentTask - cfTasks];
+    } else if (taskId < TASK_COUNT) {
+        return &taskProfiles[taskId];
+    } else {
+        return NULL;
+    }
+}
+
+void schedulerResetTaskProfile(cfTaskId_e taskId)
+{
+    if (taskId == TASK_SELF) {
+        memset(&taskProfiles[currentTask - cfTasks], 0, sizeof(cfTaskProfile_t));
+    } else if (taskId < TASK_COUNT) {
+        memset(&taskProfiles[taskId], 0, sizeof(cfTaskProfile_t));
+    }
+}
+
+// Returns the first bucket at which the cumulative sample count reaches the given percentile
+uint8_t taskProfilePercentileBucket(const uint16_t *histogram, uint8_t percentile)
+{
+    uint32_t totalSamples = 0;
+    for (int ii = 0; ii < TASK_PROFILER_BUCKET_COUNT; ii++) {
+        totalSamples += histogram[ii];
+    }
+    const uint32_t threshold = (totalSamples * percentile + 99) / 100;
+    uint32_t samples = 0;
+    for (int ii = 0; ii < TASK_PROFILER_BUCKET_COUNT; ii++) {
+        samples += histogram[ii];
+        if (samples >= threshold && samples > 0) {
+            return ii;
+        }
+    }
+    return 0;
+}
+
+uint32_t taskProfileBucketUpperBound(uint8_t bucket, uint8_t shift)
+{
+    return 1U << (bucket + shift);
+}
+#endif
+
 void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
 {
-    taskInfo->isEnabled = queueContains(&cfTasks[taskId]);
+    taskInfo->isEnabled = queueContains(&cfTasks[taskId]) || &cfTasks[taskId] == interruptDrivenTask;
     taskInfo->desiredPeriod = cfTasks[taskId].desiredPeriod;
     taskInfo->staticPriority = cfTasks[taskId].staticPriority;
 #if defined(USE_TASK_STATISTICS)
@@ -169,7 +288,9 @@ void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
     taskInfo->averageDeltaTime = cfTasks[taskId].movingSumDeltaTime / MOVING_SUM_COUNT;
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
     taskInfo->movingAverageCycleTime = cfTasks[taskId].movingAverageCycleTime;
+    taskInfo->deferredCount = cfTasks[taskId].deferredCount;
 #endif
+    taskInfo->executionBudget = cfTasks[taskId].executionBudget;
 }
 
 void rescheduleTask(cfTaskId_e taskId, uint32_t newPeriodMicros)
@@ -206,6 +327,18 @@ timeDelta_t getTaskDeltaTime(cfTaskId_e taskId)
     }
 }
 
+// Task selected by the last scheduler() pass, TASK_NONE when it found none
+cfTaskId_e getCurrentTaskId(void)
+{
+    return currentTask ? (cfTaskId_e)(currentTask - cfTasks) : TASK_NONE;
+}
+
+// True when the last scheduler() pass found no task ready to run
+bool schedulerIsIdle(void)
+{
+    return currentTask == NULL;
+}
+
 void schedulerSetCalulateTaskStatistics(bool calculateTaskStatisticsToUse)
 {
     calculateTaskStatistics = calculateTaskStatisticsToUse;
@@ -219,11 +352,13 @@ void schedulerResetTaskStatistics(cfTaskId_e taskId)
         currentTask->movingSumDeltaTime = 0;
         currentTask->totalExecutionTime = 0;
         currentTask->maxExecutionTime = 0;
+        currentTask->deferredCount = 0;
     } else if (taskId < TASK_COUNT) {
         cfTasks[taskId].movingSumExecutionTime = 0;
         cfTasks[taskId].movingSumDeltaTime = 0;
         cfTasks[taskId].totalExecutionTime = 0;
         cfTasks[taskId].maxExecutionTime = 0;
+        cfTasks[taskId].deferredCount = 0;
     }
 #else
     UNUSED(taskId);
@@ -255,6 +390,42 @@ void schedulerOptimizeRate(bool optimizeRate)
     periodCalculationBasisOffset = optimizeRate ? offsetof(cfTask_t, lastDesiredAt) : offsetof(cfTask_t, lastExecutedAt);
 }
 
+void schedulerSetDeadlineAware(bool deadlineAwareToUse)
+{
+    deadlineAware = deadlineAwareToUse;
+}
+
+bool schedulerIsDeadlineAware(void)
+{
+    return deadlineAware;
+}
+
+void schedulerSetTaskInterruptDriven(cfTaskId_e taskId, bool interruptDriven)
+{
+    if (taskId >= TASK_COUNT) {
+        return;
+    }
+    cfTask_t *task = &cfTasks[taskId];
+    if (interruptDriven) {
+        // Leave the queue first so the task is never run by both scheduler() and the interrupt
+        queueRemove(task);
+        interruptDrivenTask = task;
+    } else if (task == interruptDrivenTask) {
+        interruptDrivenTask = NULL;
+        queueAdd(task);
+    }
+}
+
+inline static timeDelta_t getTaskExecutionBudget(const cfTask_t *task)
+{
+#if defined(USE_TASK_STATISTICS)
+    // Tasks without a declared budget are judged by their measured average execution time
+    return MAX(task->executionBudget, (timeDelta_t)(task->movingSumExecutionTime / MOVING_SUM_COUNT));
+#else
+    return task->executionBudget;
+#endif
+}
+
 inline static timeUs_t getPeriodCalculationBasis(const cfTask_t* task)
 {
     if (task->staticPriority == TASK_PRIORITY_REALTIME) {
@@ -264,6 +435,98 @@ inline static timeUs_t getPeriodCalculationBasis(const cfTask_t* task)
     }
 }
 
+inline static void executeTask(cfTask_t *task, timeUs_t currentTimeUs)
+{
+#if defined(USE_TASK_PROFILER)
+    const timeDelta_t startLateness = task->checkFunc ?
+        cmpTimeUs(currentTimeUs, task->lastSignaledAt) :
+        cmpTimeUs(currentTimeUs, getPeriodCalculationBasis(task) + task->desiredPeriod);
+#endif
+    task->taskLatestDeltaTime = currentTimeUs - task->lastExecutedAt;
+#if defined(USE_TRACE)
+    const uint8_t traceTaskId = task - cfTasks;
+    if (task->staticPriority == TASK_PRIORITY_REALTIME && task->lastExecutedAt && task->taskLatestDeltaTime > 2 * task->desiredPeriod) {
+        traceTrigger(TRACE_TRIGGER_LOOP_OVERRUN, traceTaskId);
+    }
+#endif
+#if defined(USE_CRASH_LOG)
+    if (task->staticPriority == TASK_PRIORITY_REALTIME && task->lastExecutedAt && task->taskLatestDeltaTime > 2 * task->desiredPeriod) {
+        crashLogRecord(CRASH_LOG_LOOP_OVERRUN, task - cfTasks, task->taskLatestDeltaTime - task->desiredPeriod);
+    }
+#endif
+#if defined(USE_TASK_STATISTICS)
+    float period = currentTimeUs - task->lastExecutedAt;
+#endif
+    task->lastExecutedAt = currentTimeUs;
+    task->lastDesiredAt += (cmpTimeUs(currentTimeUs, task->lastDesiredAt) / task->desiredPeriod) * task->desiredPeriod;
+    task->dynamicPriority = 0;
+
+#if defined(USE_TRACE)
+    const uint32_t traceStartCycles = traceRecord(TRACE_TASK_START, traceTaskId, 0);
+#endif
+
+    // Execute task
+#if defined(USE_TASK_STATISTICS)
+    if (calculateTaskStatistics) {
+        const uint32_t irqCyclesBeforeTaskCall = irqLoadGetTotalCycles();
+        const timeUs_t currentTimeBeforeTaskCall = micros();
+#if defined(USE_TASK_PROFILER)
+        const uint32_t cyclesBeforeTaskCall = getCycleCounter();
+        task->taskFunc(currentTimeBeforeTaskCall);
+        const uint32_t taskCycles = getCycleCounter() - cyclesBeforeTaskCall;
+#else
+        task->taskFunc(currentTimeBeforeTaskCall);
+#endif
+        // Interrupts taken while the task ran are shown as interrupt load, not as task time
+        const uint32_t irqCycles = irqLoadGetTotalCycles() - irqCyclesBeforeTaskCall;
+#if defined(USE_TASK_PROFILER)
+        taskProfileRecord(task, taskCycles - MIN(irqCycles, taskCycles), startLateness);
+#endif
+        timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
+        if (irqCycles) {
+            taskExecutionTime -= MIN(clockCyclesToMicros(irqCycles), taskExecutionTime);
+        }
+        task->movingSumExecutionTime += taskExecutionTime - task->movingSumExecutionTime / MOVING_SUM_COUNT;
+        task->movingSumDeltaTime += task->taskLatestDeltaTime - task->movingSumDeltaTime / MOVING_SUM_COUNT;
+        task->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
+        task->maxExecutionTime = MAX(task->maxExecutionTime, taskExecutionTime);
+        task->movingAverageCycleTime += 0.05f * (period - task->movingAverageCycleTime);
+    } else
+#endif
+    {
+        task->taskFunc(currentTimeUs);
+    }
+
+#if defined(USE_TRACE)
+    const uint32_t traceEndCycles = traceRecord(TRACE_TASK_END, traceTaskId, 0);
+    if (task->executionBudget && clockCyclesToMicros(traceEndCycles - traceStartCycles) > (uint32_t)task->executionBudget) {
+        traceTrigger(TRACE_TRIGGER_TASK_BUDGET, traceTaskId);
+    }
+#endif
+}
+
+// Hint from an interrupt that the event an event-driven task waits for has happened. Once its checkFunc
+// confirms the event the task is run ahead of the other waiting tasks, as if it had waited for several periods.
+FAST_CODE void schedulerWakeTask(cfTaskId_e taskId)
+{
+    if (taskId < TASK_COUNT) {
+        cfTasks[taskId].wakeRequested = true;
+    }
+}
+
+// Runs a task outside of the queue, this is how the interrupt driven task is executed
+FAST_CODE void schedulerExecuteTask(cfTaskId_e taskId, timeUs_t currentTimeUs)
+{
+    if (taskId >= TASK_COUNT) {
+        return;
+    }
+    // The caller may have preempted a task that is still referring to itself as TASK_SELF
+    cfTask_t *preemptedTask = currentTask;
+    currentTask = &cfTasks[taskId];
+    executeTask(currentTask, currentTimeUs);
+    currentTask = preemptedTask;
+}
+
 FAST_CODE void scheduler(void)
 {
     // Cache currentTime
@@ -271,17 +534,24 @@ FAST_CODE void scheduler(void)
 
     // Check for realtime tasks
     bool outsideRealtimeGuardInterval = true;
+    timeDelta_t timeToNextRealtimeTask = INT32_MAX;
     for (const cfTask_t *task = queueFirst(); task != NULL && task->staticPriority >= TASK_PRIORITY_REALTIME; task = queueNext()) {
         const timeUs_t nextExecuteAt = getPeriodCalculationBasis(task) + task->desiredPeriod;
-        if ((timeDelta_t)(currentTimeUs - nextExecuteAt) >= 0) {
+        const timeDelta_t timeToNextExecute = cmpTimeUs(nextExecuteAt, currentTimeUs);
+        if (timeToNextExecute <= 0) {
             outsideRealtimeGuardInterval = false;
             break;
         }
+        timeToNextRealtimeTask = MIN(timeToNextRealtimeTask, timeToNextExecute);
     }
 
     // The task to be invoked
     cfTask_t *selectedTask = NULL;
     uint16_t selectedTaskDynamicPriority = 0;
+#if defined(USE_TASK_STATISTICS)
+    // The highest priority task held back because it would overrun the next realtime task
+    cfTask_t *deferredTask = NULL;
+#endif
 
     // Update task dynamic priorities
     uint16_t waitingTasks = 0;
@@ -314,17 +584,24 @@ FAST_CODE void scheduler(void)
                 task->lastSignaledAt = currentTimeBeforeCheckFuncCall;
                 task->taskAgeCycles = 1;
                 task->dynamicPriority = 1 + task->staticPriority;
+                if (task->wakeRequested) {
+                    task->wakeRequested = false;
+                    task->dynamicPriority = 1 + task->staticPriority * TASK_WAKE_PRIORITY_BOOST;
+                }
                 waitingTasks++;
             } else {
                 task->taskAgeCycles = 0;
             }
         } else {
             // Task is time-driven, dynamicPriority is last execution age (measured in desiredPeriods)
-            // Task age is calculated from last execution
-            task->taskAgeCycles = ((currentTimeUs - getPeriodCalculationBasis(task)) / task->desiredPeriod);
-            if (task->taskAgeCycles > 0) {
+            // Task age is calculated from last execution, the division is only needed once the task is due
+            const timeUs_t timeSinceBasis = currentTimeUs - getPeriodCalculationBasis(task);
+            if (timeSinceBasis >= (timeUs_t)task->desiredPeriod) {
+                task->taskAgeCycles = timeSinceBasis / task->desiredPeriod;
                 task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
                 waitingTasks++;
+            } else {
+                task->taskAgeCycles = 0;
             }
         }
 
@@ -333,13 +610,31 @@ FAST_CODE void scheduler(void)
                 (outsideRealtimeGuardInterval) ||
                 (task->taskAgeCycles > 1) ||
                 (task->staticPriority == TASK_PRIORITY_REALTIME);
-            if (taskCanBeChosenForScheduling) {
+            // In deadline aware mode a task only starts if its budget ends before the next realtime task is due,
+            // unless it is already more than one period late
+            const bool taskFitsBeforeDeadline =
+                (!deadlineAware) ||
+                (task->taskAgeCycles > 1) ||
+                (task->staticPriority == TASK_PRIORITY_REALTIME) ||
+                (getTaskExecutionBudget(task) < timeToNextRealtimeTask);
+            if (taskCanBeChosenForScheduling && taskFitsBeforeDeadline) {
                 selectedTaskDynamicPriority = task->dynamicPriority;
                 selectedTask = task;
             }
+#if defined(USE_TASK_STATISTICS)
+            else if (taskCanBeChosenForScheduling && (!deferredTask || task->dynamicPriority > deferredTask->dynamicPriority)) {
+                deferredTask = task;
+            }
+#endif
         }
     }
 
+#if defined(USE_TASK_STATISTICS)
+    if (deferredTask && deferredTask->dynamicPriority > selectedTaskDynamicPriority) {
+        deferredTask->deferredCount++;
+    }
+#endif
+
     totalWaitingTasksSamples++;
     totalWaitingTasks += waitingTasks;
 
@@ -347,30 +642,7 @@ FAST_CODE void scheduler(void)
 
     if (selectedTask) {
         // Found a task that should be run
-        selectedTask->taskLatestDeltaTime = currentTimeUs - selectedTask->lastExecutedAt;
-#if defined(USE_TASK_STATISTICS)
-        float period = currentTimeUs - selectedTask->lastExecutedAt;
-#endif
-        selectedTask->lastExecutedAt = currentTimeUs;
-        selectedTask->lastDesiredAt += (cmpTimeUs(currentTimeUs, selectedTask->lastDesiredAt) / selectedTask->desiredPeriod) * selectedTask->desiredPeriod;
-        selectedTask->dynamicPriority = 0;
-
-        // Execute task
-#if defined(USE_TASK_STATISTICS)
-        if (calculateTaskStatistics) {
-            const timeUs_t currentTimeBeforeTaskCall = micros();
-            selectedTask->taskFunc(currentTimeBeforeTaskCall);
-            const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
-            selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / MOVING_SUM_COUNT;
-            selectedTask->movingSumDeltaTime += selectedTask->taskLatestDeltaTime - selectedTask->movingSumDeltaTime / MOVING_SUM_COUNT;
-            selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
-            selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
-            selectedTask->movingAverageCycleTime += 0.05f * (period - selectedTask->movingAverageCycleTime);
-        } else
-#endif
-        {
-            selectedTask->taskFunc(currentTimeUs);
-        }
+        executeTask(selectedTask, currentTimeUs);
 
 #if defined(SCHEDULER_DEBUG)
         DEBUG_SET(DEBUG_SCHEDULER, 2, micros() - currentTimeUs - taskExecutionTime); // time spent in scheduler
@@ -26,6 +26,7 @@
 #define TASK_PERIOD_HZ(hz) (1000000 / (hz))
 #define TASK_PERIOD_MS(ms) ((ms) * 1000)
 #define TASK_PERIOD_US(us) (us)
+#define TASK_BUDGET_US(us) (us)
 
 
 typedef enum {
@@ -57,8 +58,22 @@ typedef struct {
     timeUs_t     averageExecutionTime;
     timeUs_t     averageDeltaTime;
     float        movingAverageCycleTime;
+    timeDelta_t  executionBudget;
+    uint32_t     deferredCount;
 } cfTaskInfo_t;
 
+#if defined(USE_TASK_PROFILER)
+// Histogram bucket 0 holds values below 2^shift, bucket n holds [2^(n-1+shift), 2^(n+shift)), the last bucket is open ended
+#define TASK_PROFILER_BUCKET_COUNT          16
+#define TASK_PROFILER_EXECUTION_SHIFT       7   // CPU cycles
+#define TASK_PROFILER_LATENESS_SHIFT        0   // microseconds
+
+typedef struct {
+    uint16_t executionCycles[TASK_PROFILER_BUCKET_COUNT];  // time spent in taskFunc, measured with the cycle counter
+    uint16_t startLateness[TASK_PROFILER_BUCKET_COUNT];    // time between the task becoming due and being started
+} cfTaskProfile_t;
+#endif
+
 typedef enum {
     /* Actual tasks */
     TASK_SYSTEM = 0,
@@ -93,6 +108,9 @@ typedef enum {
 #ifdef USE_DASHBOARD
     TASK_DASHBOARD,
 #endif
+#ifdef USE_BLACKBOX
+    TASK_BLACKBOX,
+#endif
 #ifdef USE_TELEMETRY
     TASK_TELEMETRY,
 #endif
@@ -136,6 +154,8 @@ typedef enum {
     TASK_PINIOBOX,
 #endif
 
+    TASK_DEFERRED_INIT,
+
     /* Count of real tasks */
     TASK_COUNT,
 
@@ -154,6 +174,7 @@ typedef struct {
     void (*taskFunc)(timeUs_t currentTimeUs);
     timeDelta_t desiredPeriod;      // target period of execution
     const uint8_t staticPriority;   // dynamicPriority grows in steps of this size, shouldn't be zero
+    timeDelta_t executionBudget;    // declared worst case execution time, used by the deadline aware scheduler
 
     // Scheduling
     uint16_t dynamicPriority;       // measurement of how old task was last executed, used to avoid task starvation
@@ -162,6 +183,7 @@ typedef struct {
     timeUs_t lastExecutedAt;        // last time of invocation
     timeUs_t lastSignaledAt;        // time of invocation event for event-driven tasks
     timeUs_t lastDesiredAt;         // time of last desired execution
+    volatile bool wakeRequested;    // set by schedulerWakeTask() from an interrupt
 
 #if defined(USE_TASK_STATISTICS)
     // Statistics
@@ -170,6 +192,7 @@ typedef struct {
     timeUs_t movingSumDeltaTime;  // moving sum over 32 samples
     timeUs_t maxExecutionTime;
     timeUs_t totalExecutionTime;    // total time consumed by task since boot
+    uint32_t deferredCount;         // number of times the task was held back to protect a realtime deadline
 #endif
 } cfTask_t;
 
@@ -184,11 +207,24 @@ timeDelta_t getTaskDeltaTime(cfTaskId_e taskId);
 void schedulerSetCalulateTaskStatistics(bool calculateTaskStatistics);
 void schedulerResetTaskStatistics(cfTaskId_e taskId);
 void schedulerResetTaskMaxExecutionTime(cfTaskId_e taskId);
+#if defined(USE_TASK_PROFILER)
+const cfTaskProfile_t *getTaskProfile(cfTaskId_e taskId);
+void schedulerResetTaskProfile(cfTaskId_e taskId);
+uint8_t taskProfilePercentileBucket(const uint16_t *histogram, uint8_t percentile);
+uint32_t taskProfileBucketUpperBound(uint8_t bucket, uint8_t shift);
+#endif
 
 void schedulerInit(void);
 void scheduler(void);
+cfTaskId_e getCurrentTaskId(void);
+bool schedulerIsIdle(void);
 void taskSystemLoad(timeUs_t currentTime);
 void schedulerOptimizeRate(bool optimizeRate);
+void schedulerSetDeadlineAware(bool deadlineAware);
+bool schedulerIsDeadlineAware(void);
+void schedulerSetTaskInterruptDriven(cfTaskId_e taskId, bool interruptDriven);
+void schedulerExecuteTask(cfTaskId_e taskId, timeUs_t currentTimeUs);
+void schedulerWakeTask(cfTaskId_e taskId);
 
 #define LOAD_PERCENTAGE_ONE 100
 
@@ -138,8 +138,11 @@ static uint16_t calibratingA = 0;      // the calibration is done is the main lo
 
 static flightDynamicsTrims_t *accelerationTrims;
 
+#define ACC_REDUCED_SAMPLING_INTERVAL_US 10000   // 100Hz, the rate of the attitude task
+
 static uint16_t accLpfCutHz = 0;
 static biquadFilter_t accFilter[XYZ_AXIS_COUNT];
+static uint32_t accFilterSamplingInterval;     // the sampling interval the lowpass is set up for
 
 bool accDetect(accDev_t *dev, accelerationSensor_e accHardwareToUse)
 {
@@ -331,7 +334,7 @@ bool accInit(uint32_t gyroSamplingInverval)
     }
 #endif
     acc.dev.accAlign = alignment;
-    buildRotationMatrixFromAlignment(customAlignment, &acc.dev.rotationMatrix);
+    buildSensorRotation(&acc.dev.rotation, alignment, customAlignment);
 
     if (!accDetect(&acc.dev, accelerometerConfig()->acc_hardware)) {
         return false;
@@ -351,6 +354,7 @@ bool accInit(uint32_t gyroSamplingInverval)
     default:
         acc.accSamplingInterval = 1000;
     }
+    accFilterSamplingInterval = acc.accSamplingInterval;
     if (accLpfCutHz) {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             biquadFilterInitLPF(&accFilter[axis], accLpfCutHz, acc.accSamplingInterval);
@@ -364,6 +368,22 @@ void accSetCalibrationCycles(uint16_t calibrationCyclesRequired)
     calibratingA = calibrationCyclesRequired;
 }
 
+#ifdef USE_GYRO_SPI_DMA
+// The acc shares the gyro's SPI bus, so once the gyro is read by DMA the acc must take its samples from the same transfer
+bool accCanUseGyroSpiDma(void)
+{
+    return !sensors(SENSOR_ACC) || acc.dev.dmaReadFn;
+}
+
+void accSetGyroSpiDma(struct gyroSpiDma_s *spiDma)
+{
+    if (spiDma && sensors(SENSOR_ACC)) {
+        acc.dev.spiDma = spiDma;
+        acc.dev.readFn = acc.dev.dmaReadFn;
+    }
+}
+#endif
+
 bool accIsCalibrationComplete(void)
 {
     return calibratingA == 0;
@@ -487,15 +507,11 @@ void accUpdate(timeUs_t currentTimeUs, rollAndPitchTrims_t *rollAndPitchTrims)
 
     if (accLpfCutHz) {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            acc.accADC[axis] = biquadFilterApply(&accFilter[axis], acc.accADC[axis]);
+            acc.accADC[axis] = biquadFilterApplyDF1(&accFilter[axis], acc.accADC[axis]);
         }
     }
 
-    if (acc.dev.accAlign == ALIGN_CUSTOM) {
-        alignSensorViaMatrix(acc.accADC, &acc.dev.rotationMatrix);
-    } else {
-        alignSensorViaRotation(acc.accADC, acc.dev.accAlign);
-    }
+    applySensorRotation(acc.accADC, &acc.dev.rotation);
 
     if (!accIsCalibrationComplete()) {
         performAcclerationCalibration(rollAndPitchTrims);
@@ -536,9 +552,42 @@ void setAccelerationTrims(flightDynamicsTrims_t *accelerationTrimsToUse)
     accelerationTrims = accelerationTrimsToUse;
 }
 
+// The full rate is only needed while the accelerometer steers the quad, in the self-level modes and
+// GPS rescue, and while it is calibrated. Otherwise the attitude is only displayed and checked, for
+// which the rate of the attitude task is enough, and the slower rate leaves the bus to the gyro.
+// Returns the interval the accelerometer is to be read at from now on.
+uint32_t accUpdateSamplingInterval(void)
+{
+    uint32_t samplingInterval = acc.accSamplingInterval;
+
+    const bool fullRate = !accIsCalibrationComplete() || AccInflightCalibrationActive
+        || (ARMING_FLAG(ARMED) && (FLIGHT_MODE(ANGLE_MODE) || FLIGHT_MODE(HORIZON_MODE) || FLIGHT_MODE(GPS_RESCUE_MODE)));
+    if (!fullRate) {
+        uint32_t reducedInterval = ACC_REDUCED_SAMPLING_INTERVAL_US;
+        if (accLpfCutHz) {
+            // stay well above the lowpass cutoff, so the filter keeps its response
+            reducedInterval = MIN(reducedInterval, 1000000U / (4 * accLpfCutHz));
+        }
+        samplingInterval = MAX(samplingInterval, reducedInterval);
+    }
+
+    if (samplingInterval != accFilterSamplingInterval) {
+        // the lowpass runs in direct form 1, so its state stays valid with the new coefficients
+        accFilterSamplingInterval = samplingInterval;
+        if (accLpfCutHz) {
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                biquadFilterUpdateLPF(&accFilter[axis], accLpfCutHz, samplingInterval);
+            }
+        }
+    }
+
+    return samplingInterval;
+}
+
 void accInitFilters(void)
 {
     accLpfCutHz = accelerometerConfig()->acc_lpf_hz;
+    accFilterSamplingInterval = acc.accSamplingInterval;
     if (acc.accSamplingInterval) {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             biquadFilterInitLPF(&accFilter[axis], accLpfCutHz, acc.accSamplingInterval);
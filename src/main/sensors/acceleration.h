@@ -78,6 +78,11 @@ PG_DECLARE(accelerometerConfig_t, accelerometerConfig);
 #endif
 
 bool accInit(uint32_t gyroTargetLooptime);
+#ifdef USE_GYRO_SPI_DMA
+bool accCanUseGyroSpiDma(void);
+struct gyroSpiDma_s;
+void accSetGyroSpiDma(struct gyroSpiDma_s *spiDma);
+#endif
 bool accIsCalibrationComplete(void);
 void accSetCalibrationCycles(uint16_t calibrationCyclesRequired);
 void resetRollAndPitchTrims(rollAndPitchTrims_t *rollAndPitchTrims);
@@ -86,4 +91,5 @@ bool accGetAccumulationAverage(float *accumulation);
 union flightDynamicsTrims_u;
 void setAccelerationTrims(union flightDynamicsTrims_u *accelerationTrimsToUse);
 void accInitFilters(void);
+uint32_t accUpdateSamplingInterval(void);
 void applyAccelerometerTrimsDelta(union rollAndPitchTrims_u *rollAndPitchTrimsDelta);
@@ -57,13 +57,12 @@
 
 baro_t baro;                        // barometer access functions
 
-PG_REGISTER_WITH_RESET_FN(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 1);
+PG_REGISTER_WITH_RESET_FN(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 2);
 
 void pgResetFn_barometerConfig(barometerConfig_t *barometerConfig)
 {
     barometerConfig->baro_sample_count = 21;
     barometerConfig->baro_noise_lpf = 600;
-    barometerConfig->baro_cf_vel = 985;
     barometerConfig->baro_hardware = BARO_DEFAULT;
 
     // For backward compatibility; ceate a valid default value for bus parameters
@@ -284,6 +283,7 @@ void baroSetCalibrationCycles(uint16_t calibrationCyclesRequired)
 }
 
 static bool baroReady = false;
+static bool baroSampleReady = false;
 
 #define PRESSURE_SAMPLES_MEDIAN 3
 
@@ -349,6 +349,18 @@ bool isBaroReady(void) {
     return baroReady;
 }
 
+// A pressure sample has been added to the filter since the last clearBaroSampleReady(),
+// the altitude estimator runs on this instead of on a fixed period
+bool isBaroSampleReady(void)
+{
+    return baroSampleReady;
+}
+
+void clearBaroSampleReady(void)
+{
+    baroSampleReady = false;
+}
+
 uint32_t baroUpdate(void)
 {
     static barometerState_e state = BAROMETER_NEEDS_PRESSURE_START;
@@ -361,9 +373,11 @@ uint32_t baroUpdate(void)
     switch (state) {
         default:
         case BAROMETER_NEEDS_TEMPERATURE_START:
-            baro.dev.start_ut(&baro.dev);
-            state = BAROMETER_NEEDS_TEMPERATURE_READ;
-            sleepTime = baro.dev.ut_delay;
+            // the start fails when a shared bus is busy, it is retried on the next run
+            if (baro.dev.start_ut(&baro.dev)) {
+                state = BAROMETER_NEEDS_TEMPERATURE_READ;
+                sleepTime = baro.dev.ut_delay;
+            }
             break;
 
         case BAROMETER_NEEDS_TEMPERATURE_READ:
@@ -379,9 +393,10 @@ uint32_t baroUpdate(void)
         break;
 
         case BAROMETER_NEEDS_PRESSURE_START:
-            baro.dev.start_up(&baro.dev);
-            state = BAROMETER_NEEDS_PRESSURE_READ;
-            sleepTime = baro.dev.up_delay;
+            if (baro.dev.start_up(&baro.dev)) {
+                state = BAROMETER_NEEDS_PRESSURE_READ;
+                sleepTime = baro.dev.up_delay;
+            }
         break;
 
         case BAROMETER_NEEDS_PRESSURE_READ:
@@ -399,6 +414,7 @@ uint32_t baroUpdate(void)
             baro.baroPressure = baroPressure;
             baro.baroTemperature = baroTemperature;
             baroPressureSum = recalculateBarometerTotal(barometerConfig()->baro_sample_count, baroPressureSum, baroPressure);
+            baroSampleReady = true;
             if (baro.dev.combined_read) {
                 state = BAROMETER_NEEDS_PRESSURE_START;
             } else {
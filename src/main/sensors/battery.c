@@ -42,6 +42,7 @@
 #include "io/beeper.h"
 
 #include "sensors/battery.h"
+#include "sensors/sample_bus.h"
 
 /**
  * terminology: meter vs sensors
@@ -120,10 +121,18 @@ PG_RESET_TEMPLATE(batteryConfig_t, batteryConfig,
     .vbatDurationForCritical = 0,
 );
 
-void batteryUpdateVoltage(timeUs_t currentTimeUs)
+static void batteryPublishSample(timeUs_t currentTimeUs)
 {
-    UNUSED(currentTimeUs);
+    const batterySample_t sample = {
+        .voltage = voltageMeter.filtered,
+        .amperage = currentMeter.amperage,
+        .mAhDrawn = currentMeter.mAhDrawn,
+    };
+    samplePublish(SAMPLE_BATTERY, &sample, currentTimeUs);
+}
 
+void batteryUpdateVoltage(timeUs_t currentTimeUs)
+{
     switch (batteryConfig()->voltageMeterSource) {
 #ifdef USE_ESC_SENSOR
         case VOLTAGE_METER_ESC:
@@ -148,6 +157,8 @@ void batteryUpdateVoltage(timeUs_t currentTimeUs)
         debug[0] = voltageMeter.unfiltered;
         debug[1] = voltageMeter.filtered;
     }
+
+    batteryPublishSample(currentTimeUs);
 }
 
 static void updateBatteryBeeperAlert(void)
@@ -407,9 +418,9 @@ void batteryInit(void)
 
 void batteryUpdateCurrentMeter(timeUs_t currentTimeUs)
 {
-    UNUSED(currentTimeUs);
     if (batteryCellCount == 0) {
         currentMeterReset(&currentMeter);
+        batteryPublishSample(currentTimeUs);
         return;
     }
 
@@ -455,6 +466,8 @@ void batteryUpdateCurrentMeter(timeUs_t currentTimeUs)
             currentMeterReset(&currentMeter);
             break;
     }
+
+    batteryPublishSample(currentTimeUs);
 }
 
 float calculateVbatPidCompensation(void) {
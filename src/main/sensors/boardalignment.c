@@ -64,6 +64,64 @@ void initBoardAlignment(const boardAlignment_t *boardAlignment)
     buildRotationMatrix(&rotationAngles, &boardRotation);
 }
 
+// Combines the sensor alignment with the board alignment, so that the samples are rotated once
+void buildSensorRotation(sensorRotation_t *rotation, sensor_align_e alignment, const sensorAlignment_t *customAlignment)
+{
+    sensorAlignment_t sensorAlignment = CUSTOM_ALIGN_CW0_DEG;
+    if (alignment == ALIGN_CUSTOM) {
+        sensorAlignment = *customAlignment;
+    } else {
+        buildAlignmentFromStandardAlignment(&sensorAlignment, alignment);
+    }
+
+    fp_rotationMatrix_t sensorRotation;
+    buildRotationMatrixFromAlignment(&sensorAlignment, &sensorRotation);
+
+    if (standardBoardAlignment) {
+        rotation->matrix = sensorRotation;
+    } else {
+        // rotating by the sensor and then by the board rotation is rotating by their product
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                rotation->matrix.m[i][j] = sensorRotation.m[i][0] * boardRotation.m[0][j]
+                    + sensorRotation.m[i][1] * boardRotation.m[1][j]
+                    + sensorRotation.m[i][2] * boardRotation.m[2][j];
+            }
+        }
+    }
+
+    // a rotation by multiples of 90 degrees only swaps and inverts axes
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        rotation->permutation[axis] = 0;
+        for (int source = 0; source < XYZ_AXIS_COUNT; source++) {
+            const float value = rotation->matrix.m[source][axis];
+            if (fabsf(value) > 0.999f) {
+                rotation->permutation[axis] = value > 0 ? source + 1 : -(source + 1);
+            } else if (fabsf(value) > 0.001f) {
+                rotation->permutation[axis] = 0;
+                break;
+            }
+        }
+        if (!rotation->permutation[axis]) {
+            memset(rotation->permutation, 0, sizeof(rotation->permutation));
+            break;
+        }
+    }
+}
+
+FAST_CODE void applySensorRotation(float *dest, const sensorRotation_t *rotation)
+{
+    if (rotation->permutation[X]) {
+        const float source[XYZ_AXIS_COUNT] = { dest[X], dest[Y], dest[Z] };
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const int sourceAxis = rotation->permutation[axis];
+            dest[axis] = sourceAxis > 0 ? source[sourceAxis - 1] : -source[-sourceAxis - 1];
+        }
+    } else {
+        applyRotation(dest, &rotation->matrix);
+    }
+}
+
 FAST_CODE static void alignBoard(float *vec)
 {
     applyRotation(vec, &boardRotation);
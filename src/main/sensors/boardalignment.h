@@ -22,6 +22,7 @@
 
 #include "common/axis.h"
 #include "common/maths.h"
+#include "common/sensor_alignment.h"
 
 #include "pg/pg.h"
 
@@ -35,5 +36,7 @@ PG_DECLARE(boardAlignment_t, boardAlignment);
 
 void alignSensorViaMatrix(float *dest, fp_rotationMatrix_t* rotationMatrix);
 void alignSensorViaRotation(float *dest, uint8_t rotation);
+void buildSensorRotation(sensorRotation_t *rotation, sensor_align_e alignment, const sensorAlignment_t *customAlignment);
+void applySensorRotation(float *dest, const sensorRotation_t *rotation);
 
 void initBoardAlignment(const boardAlignment_t *boardAlignment);
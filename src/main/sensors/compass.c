@@ -25,6 +25,7 @@
 #include "platform.h"
 
 #include "common/axis.h"
+#include "common/utils.h"
 
 #include "pg/pg.h"
 #include "pg/pg_ids.h"
@@ -40,8 +41,11 @@
 #include "drivers/compass/compass_hmc5883l.h"
 #include "drivers/compass/compass_qmc5883l.h"
 #include "drivers/compass/compass_lis3mdl.h"
+#include "drivers/exti.h"
 #include "drivers/io.h"
 #include "drivers/light_led.h"
+#include "drivers/nvic.h"
+#include "drivers/time.h"
 
 #include "fc/config.h"
 #include "fc/runtime_config.h"
@@ -58,6 +62,9 @@
 magDev_t magDev;
 mag_t mag;                   // mag access functions
 
+#define COMPASS_UPDATE_INTERVAL_US      (1000 * 100)    // polled at 10Hz without the data ready pin
+#define COMPASS_DATA_READY_TIMEOUT_US   (1000 * 100)
+
 PG_REGISTER_WITH_RESET_FN(compassConfig_t, compassConfig, PG_COMPASS_CONFIG, 1);
 
 void pgResetFn_compassConfig(compassConfig_t *compassConfig)
@@ -283,6 +290,37 @@ bool compassDetect(magDev_t *dev, sensor_align_e *alignment)
 }
 #endif // !SIMULATOR_BUILD
 
+#ifdef USE_MAG_DATA_READY_SIGNAL
+static void compassDataReadyExtiHandler(extiCallbackRec_t *cb)
+{
+    magDev_t *dev = container_of(cb, magDev_t, exti);
+    dev->dataReadyAtUs = micros();
+    dev->dataReady = true;
+}
+
+static void compassDataReadyInit(magDev_t *dev)
+{
+    if (dev->magIntExtiTag == IO_TAG_NONE) {
+        return;
+    }
+
+    const IO_t magIntIO = IOGetByTag(dev->magIntExtiTag);
+
+#ifdef ENSURE_MAG_DATA_READY_IS_HIGH
+    if (!IORead(magIntIO)) {
+        return;
+    }
+#endif
+
+    IOInit(magIntIO, OWNER_COMPASS_EXTI, 0);
+    EXTIHandlerInit(&dev->exti, compassDataReadyExtiHandler);
+    EXTIConfig(magIntIO, &dev->exti, NVIC_PRIO_MPU_INT_EXTI, IOCFG_IN_FLOATING, EXTI_TRIGGER_RISING);
+    EXTIEnable(magIntIO, true);
+
+    dev->dataReadyEnabled = true;
+}
+#endif
+
 bool compassInit(void)
 {
     // initialize and calibration. turn on led during mag calibration (calibration routine blinks it)
@@ -303,13 +341,17 @@ bool compassInit(void)
     LED1_OFF;
     magInit = 1;
 
+#ifdef USE_MAG_DATA_READY_SIGNAL
+    compassDataReadyInit(&magDev);
+#endif
+
     magDev.magAlignment = alignment;
 
     if (compassConfig()->mag_alignment != ALIGN_DEFAULT) {
         magDev.magAlignment = compassConfig()->mag_alignment;
     }
     
-    buildRotationMatrixFromAlignment(&compassConfig()->mag_customAlignment, &magDev.rotationMatrix);
+    buildSensorRotation(&magDev.rotation, magDev.magAlignment, &compassConfig()->mag_customAlignment);
 
     return true;
 }
@@ -319,20 +361,43 @@ bool compassIsHealthy(void)
     return (mag.magADC[X] != 0) && (mag.magADC[Y] != 0) && (mag.magADC[Z] != 0);
 }
 
+// With the data ready pin the compass is read when it has a sample, and until a started read has completed.
+// The timeout restarts the reads should an interrupt be missed, the pin only rises again after a read.
+bool compassUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    if (magDev.dataReadyEnabled) {
+        return magDev.dataReady || magDev.readPending || currentDeltaTimeUs >= COMPASS_DATA_READY_TIMEOUT_US;
+    }
+
+    return currentDeltaTimeUs >= COMPASS_UPDATE_INTERVAL_US;
+}
+
 void compassUpdate(timeUs_t currentTimeUs)
 {
     static timeUs_t tCal = 0;
     static flightDynamicsTrims_t magZeroTempMin;
     static flightDynamicsTrims_t magZeroTempMax;
+    static timeUs_t readSampleTimeUs;
 
-    magDev.read(&magDev, magADCRaw);
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        mag.magADC[axis] = magADCRaw[axis];
+    if (!magDev.readPending) {
+        // the sample is from the data ready interrupt, or from now when polled
+        readSampleTimeUs = magDev.dataReady ? magDev.dataReadyAtUs : currentTimeUs;
+        magDev.dataReady = false;
     }
-    if (magDev.magAlignment == ALIGN_CUSTOM) {
-        alignSensorViaMatrix(mag.magADC, &magDev.rotationMatrix);
-    } else {
-        alignSensorViaRotation(mag.magADC, magDev.magAlignment);
+
+    // the previous sample is kept while a read is in progress or when it has failed
+    const bool newSample = magDev.read(&magDev, magADCRaw);
+    if (!newSample && magDev.readPending) {
+        return;
+    }
+
+    if (newSample) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            mag.magADC[axis] = magADCRaw[axis];
+        }
+        applySensorRotation(mag.magADC, &magDev.rotation);
     }
 
     flightDynamicsTrims_t *magZero = &compassConfigMutable()->magZero;
@@ -346,10 +411,13 @@ void compassUpdate(timeUs_t currentTimeUs)
         DISABLE_STATE(CALIBRATE_MAG);
     }
 
-    if (magInit) {              // we apply offset only once mag calibration is done
-        mag.magADC[X] -= magZero->raw[X];
-        mag.magADC[Y] -= magZero->raw[Y];
-        mag.magADC[Z] -= magZero->raw[Z];
+    if (newSample) {
+        if (magInit) {              // we apply offset only once mag calibration is done
+            mag.magADC[X] -= magZero->raw[X];
+            mag.magADC[Y] -= magZero->raw[Y];
+            mag.magADC[Z] -= magZero->raw[Z];
+        }
+        mag.sampleTimeUs = readSampleTimeUs;
     }
 
     if (tCal != 0) {
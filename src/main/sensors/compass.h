@@ -42,6 +42,7 @@ typedef enum {
 typedef struct mag_s {
     float magADC[XYZ_AXIS_COUNT];
     float magneticDeclination;
+    timeUs_t sampleTimeUs;                  // when magADC was measured
 } mag_t;
 
 extern mag_t mag;
@@ -64,6 +65,7 @@ typedef struct compassConfig_s {
 PG_DECLARE(compassConfig_t, compassConfig);
 
 bool compassIsHealthy(void);
+bool compassUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 void compassUpdate(timeUs_t currentTime);
 bool compassInit(void);
 void compassPreInit(void);
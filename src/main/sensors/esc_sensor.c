@@ -21,6 +21,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include "platform.h"
 
@@ -35,6 +36,7 @@
 #include "pg/pg_ids.h"
 #include "pg/motor.h"
 
+#include "common/crc.h"
 #include "common/maths.h"
 #include "common/utils.h"
 
@@ -110,19 +112,28 @@ typedef enum {
 #define ESC_REQUEST_TIMEOUT 100         // 100 ms (data transfer takes only 900us)
 
 #define TELEMETRY_FRAME_SIZE 10
-static uint8_t telemetryBuffer[TELEMETRY_FRAME_SIZE] = { 0, };
 
-static volatile uint8_t *buffer;
-static volatile uint8_t bufferSize = 0;
-static volatile uint8_t bufferPosition = 0;
+// A port configured for the ESC sensor. With a port per motor, each ESC telemetry wire on a UART of its own,
+// all motors are polled at the same time, otherwise the motors share the first port and are polled in turn.
+typedef struct escSensorPort_s {
+    serialPort_t *port;
+    uint8_t *buffer;
+    uint8_t bufferSize;
+    uint8_t bufferPosition;
+    uint8_t motor;                      // motor whose frame is awaited
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+} escSensorPort_t;
 
-static serialPort_t *escSensorPort = NULL;
+static escSensorPort_t escSensorPorts[MAX_SUPPORTED_MOTORS];
+static uint8_t escSensorPortCount = 0;
 
 static escSensorData_t escSensorData[MAX_SUPPORTED_MOTORS];
 
 static escSensorTriggerState_t escSensorTriggerState = ESC_SENSOR_TRIGGER_STARTUP;
 static uint32_t escTriggerTimestamp;
-static uint8_t escSensorMotor = 0;      // motor index
+static uint8_t escSensorMotor = 0;      // motor index when the motors are polled in turn
+static uint8_t escSensorPollCount = 0;  // ports polled by the pending request
+static uint8_t escSensorPendingMask = 0;
 
 static escSensorData_t combinedEscSensorData;
 static bool combinedDataNeedsUpdate = true;
@@ -130,26 +141,62 @@ static bool combinedDataNeedsUpdate = true;
 static uint16_t totalTimeoutCount = 0;
 static uint16_t totalCrcErrorCount = 0;
 
+#ifdef USE_DSHOT_TELEMETRY
+static float escConsumption[MAX_SUPPORTED_MOTORS]; // mAh, integrated from the extended telemetry current
+static timeUs_t escConsumptionUpdatedUs;
+#endif
+
+static void escSensorPortStartRead(escSensorPort_t *escPort, uint8_t *frameBuffer, uint8_t frameLength)
+{
+    escPort->buffer = frameBuffer;
+    escPort->bufferPosition = 0;
+    escPort->bufferSize = frameLength;
+}
+
+// The ports have no receive callback so that a UART with an RX DMA stream fills its buffer without an interrupt
+// per byte, the bytes are collected here. Bytes that arrive with no read started are dropped,
+// KISS ESCs send some data during startup (maybe firmware version and serial number) which is ignored for now.
+static void escSensorPortReceive(escSensorPort_t *escPort)
+{
+    while (serialRxBytesWaiting(escPort->port)) {
+        const uint8_t c = serialRead(escPort->port);
+        if (escPort->bufferPosition < escPort->bufferSize) {
+            escPort->buffer[escPort->bufferPosition++] = c;
+        }
+    }
+}
+
+// Any ESC may answer a request made outside the polling, such as the ESC info command, so every port reads into the buffer
 void startEscDataRead(uint8_t *frameBuffer, uint8_t frameLength)
 {
-    buffer = frameBuffer;
-    bufferPosition = 0;
-    bufferSize = frameLength;
+    for (int i = 0; i < escSensorPortCount; i++) {
+        escSensorPortStartRead(&escSensorPorts[i], frameBuffer, frameLength);
+    }
 }
 
 uint8_t getNumberEscBytesRead(void)
 {
-    return bufferPosition;
+    uint8_t bytesRead = 0;
+    for (int i = 0; i < escSensorPortCount; i++) {
+        escSensorPortReceive(&escSensorPorts[i]);
+        bytesRead = MAX(bytesRead, escSensorPorts[i].bufferPosition);
+    }
+    return bytesRead;
 }
 
-static bool isFrameComplete(void)
+static bool isFrameComplete(const escSensorPort_t *escPort)
 {
-    return bufferPosition == bufferSize;
+    return escPort->bufferPosition == escPort->bufferSize;
 }
 
 bool isEscSensorActive(void)
 {
-    return escSensorPort != NULL;
+#ifdef USE_DSHOT_TELEMETRY
+    if (useDshotEdt) {
+        return true;
+    }
+#endif
+    return escSensorPortCount > 0;
 }
 
 escSensorData_t *getEscSensorData(uint8_t motorNumber)
@@ -192,86 +239,70 @@ escSensorData_t *getEscSensorData(uint8_t motorNumber)
     }
 }
 
-// Receive ISR callback
-static void escSensorDataReceive(uint16_t c, void *data)
-{
-    UNUSED(data);
-
-    // KISS ESC sends some data during startup, ignore this for now (maybe future use)
-    // startup data could be firmware version and serialnumber
-
-    if (isFrameComplete()) {
-        return;
-    }
-
-    buffer[bufferPosition++] = (uint8_t)c;
-}
-
 bool escSensorInit(void)
 {
-    serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_ESC_SENSOR);
-    if (!portConfig) {
-        return false;
-    }
-
-    portOptions_e options = SERIAL_NOT_INVERTED  | (escSensorConfig()->halfDuplex ? SERIAL_BIDIR : 0);
-
-    // Initialize serial port
-    escSensorPort = openSerialPort(portConfig->identifier, FUNCTION_ESC_SENSOR, escSensorDataReceive, NULL, ESC_SENSOR_BAUDRATE, MODE_RX, options);
-
     for (int i = 0; i < MAX_SUPPORTED_MOTORS; i = i + 1) {
         escSensorData[i].dataAge = ESC_DATA_INVALID;
     }
 
-    return escSensorPort != NULL;
-}
+#ifdef USE_DSHOT_TELEMETRY
+    if (useDshotEdt) {
+        // All ESC data comes with the bidirectional DShot telemetry, no serial port is needed
+        return true;
+    }
+#endif
 
-static uint8_t updateCrc8(uint8_t crc, uint8_t crc_seed)
-{
-    uint8_t crc_u = crc;
-    crc_u ^= crc_seed;
+    portOptions_e options = SERIAL_NOT_INVERTED  | (escSensorConfig()->halfDuplex ? SERIAL_BIDIR : 0);
 
-    for (int i=0; i<8; i++) {
-        crc_u = ( crc_u & 0x80 ) ? 0x7 ^ ( crc_u << 1 ) : ( crc_u << 1 );
+    // Initialize the serial ports, in the order of the motors they serve when there is one for each motor
+    escSensorPortCount = 0;
+    for (serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_ESC_SENSOR);
+        portConfig && escSensorPortCount < MAX_SUPPORTED_MOTORS;
+        portConfig = findNextSerialPortConfig(FUNCTION_ESC_SENSOR)) {
+
+        serialPort_t *port = openSerialPort(portConfig->identifier, FUNCTION_ESC_SENSOR, NULL, NULL, ESC_SENSOR_BAUDRATE, MODE_RX, options);
+        if (port) {
+            escSensorPorts[escSensorPortCount++].port = port;
+        }
     }
 
-    return (crc_u);
+    return escSensorPortCount > 0;
 }
 
 uint8_t calculateCrc8(const uint8_t *Buf, const uint8_t BufLen)
 {
-    uint8_t crc = 0;
-    for (int i = 0; i < BufLen; i++) {
-        crc = updateCrc8(Buf[i], crc);
-    }
-
-    return crc;
+    return crc8_poly_0x07_update(0, Buf, BufLen);
 }
 
-static uint8_t decodeEscFrame(void)
+static uint8_t decodeEscFrame(escSensorPort_t *escPort)
 {
-    if (!isFrameComplete()) {
+    escSensorPortReceive(escPort);
+
+    if (!isFrameComplete(escPort)) {
         return ESC_SENSOR_FRAME_PENDING;
     }
 
+    const uint8_t *telemetryBuffer = escPort->frame;
+    const uint8_t motor = escPort->motor;
+
     // Get CRC8 checksum
     uint16_t chksum = calculateCrc8(telemetryBuffer, TELEMETRY_FRAME_SIZE - 1);
     uint16_t tlmsum = telemetryBuffer[TELEMETRY_FRAME_SIZE - 1];     // last byte contains CRC value
     uint8_t frameStatus;
     if (chksum == tlmsum) {
-        escSensorData[escSensorMotor].dataAge = 0;
-        escSensorData[escSensorMotor].temperature = telemetryBuffer[0];
-        escSensorData[escSensorMotor].voltage = telemetryBuffer[1] << 8 | telemetryBuffer[2];
-        escSensorData[escSensorMotor].current = telemetryBuffer[3] << 8 | telemetryBuffer[4];
-        escSensorData[escSensorMotor].consumption = telemetryBuffer[5] << 8 | telemetryBuffer[6];
-        escSensorData[escSensorMotor].rpm = telemetryBuffer[7] << 8 | telemetryBuffer[8];
+        escSensorData[motor].dataAge = 0;
+        escSensorData[motor].temperature = telemetryBuffer[0];
+        escSensorData[motor].voltage = telemetryBuffer[1] << 8 | telemetryBuffer[2];
+        escSensorData[motor].current = telemetryBuffer[3] << 8 | telemetryBuffer[4];
+        escSensorData[motor].consumption = telemetryBuffer[5] << 8 | telemetryBuffer[6];
+        escSensorData[motor].rpm = telemetryBuffer[7] << 8 | telemetryBuffer[8];
 
         combinedDataNeedsUpdate = true;
 
         frameStatus = ESC_SENSOR_FRAME_COMPLETE;
 
-        DEBUG_SET(DEBUG_ESC_SENSOR_RPM, escSensorMotor, calcEscRpm(escSensorData[escSensorMotor].rpm) / 10); // output actual rpm/10 to fit in 16bit signed.
-        DEBUG_SET(DEBUG_ESC_SENSOR_TMP, escSensorMotor, escSensorData[escSensorMotor].temperature);
+        DEBUG_SET(DEBUG_ESC_SENSOR_RPM, motor, calcEscRpm(escSensorData[motor].rpm) / 10); // output actual rpm/10 to fit in 16bit signed.
+        DEBUG_SET(DEBUG_ESC_SENSOR_TMP, motor, escSensorData[motor].temperature);
     } else {
         frameStatus = ESC_SENSOR_FRAME_FAILED;
     }
@@ -279,10 +310,10 @@ static uint8_t decodeEscFrame(void)
     return frameStatus;
 }
 
-static void increaseDataAge(void)
+static void increaseDataAge(uint8_t motor)
 {
-    if (escSensorData[escSensorMotor].dataAge < ESC_DATA_INVALID) {
-        escSensorData[escSensorMotor].dataAge++;
+    if (escSensorData[motor].dataAge < ESC_DATA_INVALID) {
+        escSensorData[motor].dataAge++;
 
         combinedDataNeedsUpdate = true;
     }
@@ -296,13 +327,55 @@ static void selectNextMotor(void)
     }
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+// Updates the data of all motors at once from the extended DShot telemetry,
+// the serial telemetry can only poll one motor at a time.
+static void escSensorProcessDshotTelemetry(timeUs_t currentTimeUs)
+{
+    const timeDelta_t consumptionDeltaUs = escConsumptionUpdatedUs ? cmpTimeUs(currentTimeUs, escConsumptionUpdatedUs) : 0;
+    escConsumptionUpdatedUs = currentTimeUs;
+
+    for (int i = 0; i < getMotorCount(); i++) {
+        dshotTelemetryMotorState_t *motorState = &dshotTelemetryState.motorState[i];
+        escSensorData_t *escData = &escSensorData[i];
+
+        if (motorState->edtUpdated) {
+            motorState->edtUpdated = false;
+
+            escData->dataAge = 0;
+            escData->temperature = motorState->temperature;
+            escData->voltage = motorState->voltage;
+            escData->current = motorState->current;
+
+            DEBUG_SET(DEBUG_ESC_SENSOR_TMP, i, escData->temperature);
+        } else if (escData->dataAge < ESC_DATA_INVALID) {
+            escData->dataAge++;
+        }
+
+        // current in 0.01A, 1 mAh is 360 mA for 10 seconds
+        escConsumption[i] += escData->current * (consumptionDeltaUs / 3.6e8f);
+        escData->consumption = lrintf(escConsumption[i]);
+        escData->rpm = getDshotTelemetry(i);
+    }
+
+    combinedDataNeedsUpdate = true;
+}
+#endif
+
 // XXX Review ESC sensor under refactored motor handling
 
 void escSensorProcess(timeUs_t currentTimeUs)
 {
     const timeMs_t currentTimeMs = currentTimeUs / 1000;
 
-    if (!escSensorPort || !motorIsEnabled()) {
+#ifdef USE_DSHOT_TELEMETRY
+    if (useDshotEdt) {
+        escSensorProcessDshotTelemetry(currentTimeUs);
+        return;
+    }
+#endif
+
+    if (!escSensorPortCount || !motorIsEnabled()) {
         return;
     }
 
@@ -317,42 +390,63 @@ void escSensorProcess(timeUs_t currentTimeUs)
         case ESC_SENSOR_TRIGGER_READY:
             escTriggerTimestamp = currentTimeMs;
 
-            startEscDataRead(telemetryBuffer, TELEMETRY_FRAME_SIZE);
-            motorDmaOutput_t * const motor = getMotorDmaOutput(escSensorMotor);
-            motor->protocolControl.requestTelemetry = true;
+            // with a port per motor all motors answer at once, each on its own port
+            escSensorPollCount = escSensorPortCount >= getMotorCount() ? getMotorCount() : 1;
+            escSensorPendingMask = 0;
+            for (int i = 0; i < escSensorPollCount; i++) {
+                escSensorPort_t *escPort = &escSensorPorts[i];
+                escPort->motor = escSensorPollCount > 1 ? i : escSensorMotor;
+                // drop whatever arrived after the last frame was complete
+                escSensorPortReceive(escPort);
+                escSensorPortStartRead(escPort, escPort->frame, TELEMETRY_FRAME_SIZE);
+                getMotorDmaOutput(escPort->motor)->protocolControl.requestTelemetry = true;
+                escSensorPendingMask |= 1 << i;
+            }
             escSensorTriggerState = ESC_SENSOR_TRIGGER_PENDING;
 
-            DEBUG_SET(DEBUG_ESC_SENSOR, DEBUG_ESC_MOTOR_INDEX, escSensorMotor + 1);
+            DEBUG_SET(DEBUG_ESC_SENSOR, DEBUG_ESC_MOTOR_INDEX, escSensorPollCount > 1 ? 0 : escSensorMotor + 1);
 
             break;
         case ESC_SENSOR_TRIGGER_PENDING:
             if (currentTimeMs < escTriggerTimestamp + ESC_REQUEST_TIMEOUT) {
-                uint8_t state = decodeEscFrame();
-                switch (state) {
-                    case ESC_SENSOR_FRAME_COMPLETE:
-                        selectNextMotor();
-                        escSensorTriggerState = ESC_SENSOR_TRIGGER_READY;
-
-                        break;
-                    case ESC_SENSOR_FRAME_FAILED:
-                        increaseDataAge();
-
-                        selectNextMotor();
-                        escSensorTriggerState = ESC_SENSOR_TRIGGER_READY;
-
-                        DEBUG_SET(DEBUG_ESC_SENSOR, DEBUG_ESC_NUM_CRC_ERRORS, ++totalCrcErrorCount);
-                        break;
-                    case ESC_SENSOR_FRAME_PENDING:
-                        break;
+                for (int i = 0; i < escSensorPollCount; i++) {
+                    if (!(escSensorPendingMask & (1 << i))) {
+                        continue;
+                    }
+                    escSensorPort_t *escPort = &escSensorPorts[i];
+                    switch (decodeEscFrame(escPort)) {
+                        case ESC_SENSOR_FRAME_COMPLETE:
+                            escSensorPendingMask &= ~(1 << i);
+
+                            break;
+                        case ESC_SENSOR_FRAME_FAILED:
+                            increaseDataAge(escPort->motor);
+                            escSensorPendingMask &= ~(1 << i);
+
+                            DEBUG_SET(DEBUG_ESC_SENSOR, DEBUG_ESC_NUM_CRC_ERRORS, ++totalCrcErrorCount);
+                            break;
+                        case ESC_SENSOR_FRAME_PENDING:
+                            break;
+                    }
                 }
             } else {
-                // Move on to next ESC, we'll come back to this one
-                increaseDataAge();
+                // Move on, we'll come back to the motors that did not answer
+                for (int i = 0; i < escSensorPollCount; i++) {
+                    if (escSensorPendingMask & (1 << i)) {
+                        increaseDataAge(escSensorPorts[i].motor);
+                        escSensorPorts[i].bufferSize = 0;
+
+                        DEBUG_SET(DEBUG_ESC_SENSOR, DEBUG_ESC_NUM_TIMEOUTS, ++totalTimeoutCount);
+                    }
+                }
+                escSensorPendingMask = 0;
+            }
 
-                selectNextMotor();
+            if (!escSensorPendingMask) {
+                if (escSensorPollCount == 1) {
+                    selectNextMotor();
+                }
                 escSensorTriggerState = ESC_SENSOR_TRIGGER_READY;
-
-                DEBUG_SET(DEBUG_ESC_SENSOR, DEBUG_ESC_NUM_TIMEOUTS, ++totalTimeoutCount);
             }
 
             break;
@@ -26,11 +26,14 @@
 
 #include "platform.h"
 
+#include "build/crash_log.h"
 #include "build/debug.h"
+#include "build/trace.h"
 
 #include "common/axis.h"
 #include "common/maths.h"
 #include "common/filter.h"
+#include "common/utils.h"
 
 #include "config/feature.h"
 
@@ -62,12 +65,15 @@
 #include "drivers/accgyro/gyro_sync.h"
 #include "drivers/bus_spi.h"
 #include "drivers/io.h"
+#include "drivers/pendsv.h"
 
 #include "fc/config.h"
+#include "fc/dispatch.h"
 #include "fc/runtime_config.h"
 
 #ifdef USE_GYRO_DATA_ANALYSE
 #include "flight/gyroanalyse.h"
+#include "flight/pid.h"
 #endif
 #include "flight/rpm_filter.h"
 
@@ -84,9 +90,17 @@
 #define USE_GYRO_SLEW_LIMITER
 #endif
 
+#if defined(USE_GYRO_OVERFLOW_CHECK) || defined(USE_YAW_SPIN_RECOVERY)
+#define USE_GYRO_RANGE_CHECK
+#endif
+
 FAST_RAM_ZERO_INIT gyro_t gyro;
 static FAST_RAM_ZERO_INIT uint8_t gyroDebugMode;
 
+typedef void (*gyroFilterChainFnPtr)(void);
+static FAST_RAM_ZERO_INIT gyroFilterChainFnPtr gyroFilterChainFn;
+STATIC_UNIT_TESTED void gyroInitFilterChain(void);
+
 static FAST_RAM_ZERO_INIT uint8_t gyroToUse;
 static FAST_RAM_ZERO_INIT bool overflowDetected;
 #ifdef USE_GYRO_OVERFLOW_CHECK
@@ -97,11 +111,30 @@ static FAST_RAM_ZERO_INIT timeUs_t overflowTimeUs;
 static FAST_RAM_ZERO_INIT uint8_t overflowAxisMask;
 #endif
 
+#ifdef SPECIALIZED_GYRO_READ_FN
+bool SPECIALIZED_GYRO_READ_FN(gyroDev_t *gyro);
+#define GYRO_DEV_READ(gyroDev) CALL_DIRECT_IF((gyroDev)->readFn, SPECIALIZED_GYRO_READ_FN, gyroDev)
+#else
+#define GYRO_DEV_READ(gyroDev) (gyroDev)->readFn(gyroDev)
+#endif
+
 #ifdef USE_YAW_SPIN_RECOVERY
 static FAST_RAM_ZERO_INIT bool yawSpinDetected;
 static FAST_RAM_ZERO_INIT timeUs_t yawSpinTimeUs;
 #endif
 
+#ifdef USE_GYRO_RANGE_CHECK
+enum {
+    GYRO_RANGE_OVERFLOW_HIGH = (1 << 0),    // an axis is above the overflow reset threshold
+    GYRO_RANGE_YAW_SPIN_HIGH = (1 << 1),    // yaw is above the yaw spin reset threshold
+    GYRO_RANGE_YAW_SPIN      = (1 << 2),    // yaw is above the yaw spin threshold
+};
+
+// What the range checks found in the raw samples of this loop, gathered by gyroRemoveZero()
+static FAST_RAM_ZERO_INIT uint8_t gyroRangeFlags;
+static FAST_RAM_ZERO_INIT uint8_t gyroOverflowAxes;    // gyroOverflow_e of the checked axes above the overflow threshold
+#endif
+
 static FAST_RAM_ZERO_INIT float accumulatedMeasurements[XYZ_AXIS_COUNT];
 static FAST_RAM_ZERO_INIT float gyroPrevious[XYZ_AXIS_COUNT];
 static FAST_RAM_ZERO_INIT int accumulatedMeasurementCount;
@@ -111,8 +144,15 @@ static FAST_RAM_ZERO_INIT int16_t gyroSensorTemperature;
 static bool gyroHasOverflowProtection = true;
 
 static FAST_RAM_ZERO_INIT bool useDualGyroDebugging;
+#ifdef USE_MULTI_GYRO
+static FAST_RAM_ZERO_INIT bool gyroSharedAlignment;    // both gyros are mounted the same way, see gyroUpdateBoth()
+#endif
 static FAST_RAM_ZERO_INIT flight_dynamics_index_t gyroDebugAxis;
 
+#ifdef USE_GYRO_ODR_TRACKING
+static FAST_RAM_ZERO_INIT gyroOdrTracker_t gyroOdrTracker;
+#endif
+
 typedef struct gyroCalibration_s {
     float sum[XYZ_AXIS_COUNT];
     stdev_t var[XYZ_AXIS_COUNT];
@@ -120,10 +160,22 @@ typedef struct gyroCalibration_s {
 } gyroCalibration_t;
 
 bool firstArmingCalibrationWasStarted = false;
+#ifdef USE_GYRO_CALIBRATION_STORE
+static bool storeCalibration;   // the running calibration was not the first arming one, see gyroStoreCalibration()
+static volatile bool calibrationStorePending[GYRO_CALIBRATION_STORE_COUNT];   // set by the PID loop, handled by gyroCalibrationStoreUpdate()
+#endif
 
 typedef struct gyroSensor_s {
     gyroDev_t gyroDev;
     gyroCalibration_t calibration;
+#ifdef USE_GYRO_RANGE_CHECK
+    // limits of the range checks on the raw samples, see gyroInitSensorRangeCheck()
+    int32_t rangeCheckRaw;                          // below this no check needs a closer look
+    int32_t yawSpinTriggerRaw;
+    int32_t yawSpinResetRaw;
+    uint8_t yawAxis;                                // the sensor axis that mostly measures yaw
+    uint8_t overflowAxes[XYZ_AXIS_COUNT];           // gyroOverflow_e of the checked aligned axes each sensor axis feeds
+#endif
 } gyroSensor_t;
 
 STATIC_UNIT_TESTED FAST_RAM_ZERO_INIT gyroSensor_t gyroSensor1;
@@ -139,10 +191,19 @@ STATIC_UNIT_TESTED gyroDev_t * const gyroDevPtr = &gyroSensor1.gyroDev;
 #endif
 
 static void gyroInitSensorFilters(gyroSensor_t *gyroSensor);
-static void gyroInitLowpassFilterLpf(int slot, int type, uint16_t lpfHz);
+static void gyroInitLowpassFilterLpf(int slot, int type, uint16_t lpfHz, bool retune);
 
 #define DEBUG_GYRO_CALIBRATION 3
 
+// Calibration finishes early once a quarter of gyro_calib_duration has passed and the offset of
+// every axis is known to within this with 95% confidence, a still gyro gets there at once
+#define GYRO_CALIBRATION_MIN_FRACTION 4
+#define GYRO_CALIBRATION_ACCURACY_DPS 0.1f
+
+#define GYRO_CALIBRATION_SAVE_DELAY_US 500000 // let the calibration beep finish before the flash write stalls the loop
+
+#define GYRO_FILTER_CROSSFADE_US 5000 // duration of the coefficient crossfade of gyroRetuneFilters()
+
 #ifdef STM32F10X
 #define GYRO_SYNC_DENOM_DEFAULT 8
 #elif defined(USE_GYRO_SPI_MPU6000) || defined(USE_GYRO_SPI_MPU6500) || defined(USE_GYRO_SPI_ICM20601) || defined(USE_GYRO_SPI_ICM20649) \
@@ -155,7 +216,7 @@ static void gyroInitLowpassFilterLpf(int slot, int type, uint16_t lpfHz);
 #define GYRO_OVERFLOW_TRIGGER_THRESHOLD 31980  // 97.5% full scale (1950dps for 2000dps gyro)
 #define GYRO_OVERFLOW_RESET_THRESHOLD 30340    // 92.5% full scale (1850dps for 2000dps gyro)
 
-PG_REGISTER_WITH_RESET_FN(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 7);
+PG_REGISTER_WITH_RESET_FN(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 12);
 
 #ifndef GYRO_CONFIG_USE_GYRO_DEFAULT
 #define GYRO_CONFIG_USE_GYRO_DEFAULT GYRO_CONFIG_USE_GYRO_1
@@ -195,9 +256,23 @@ void pgResetFn_gyroConfig(gyroConfig_t *gyroConfig)
     gyroConfig->dyn_notch_width_percent = 8;
     gyroConfig->dyn_notch_q = 120;
     gyroConfig->dyn_notch_min_hz = 150;
+    gyroConfig->dyn_notch_window_size = DYN_NOTCH_WINDOW_SIZE_32;
+    gyroConfig->dyn_notch_count = 1;
     gyroConfig->gyro_filter_debug_axis = FD_ROLL;
+    gyroConfig->gyro_spi_dma = false;
+    gyroConfig->gyro_fifo = false;
+    gyroConfig->gyro_interleave = false;
 }
 
+#ifdef USE_GYRO_CALIBRATION_STORE
+PG_REGISTER_WITH_RESET_TEMPLATE(gyroCalibrationConfig_t, gyroCalibrationConfig, PG_GYRO_CALIBRATION_CONFIG, 0);
+
+PG_RESET_TEMPLATE(gyroCalibrationConfig_t, gyroCalibrationConfig,
+    .temperatureTolerance = 0,
+    .storedSensors = 0,
+);
+#endif
+
 #ifdef USE_MULTI_GYRO
 #define ACTIVE_GYRO ((gyroToUse == GYRO_CONFIG_USE_GYRO_2) ? &gyroSensor2 : &gyroSensor1)
 #else
@@ -228,6 +303,80 @@ const mpuDetectionResult_t *gyroMpuDetectionResult(void)
     return &ACTIVE_GYRO->gyroDev.mpuDetectionResult;
 }
 
+#ifdef USE_PID_LOOP_INTERRUPT
+// Returns false if the active gyro has no data ready interrupt to attach the callback to
+bool gyroSetDataReadyCallback(sensorGyroDataReadyFuncPtr callback)
+{
+    gyroDev_t *gyroDev = &ACTIVE_GYRO->gyroDev;
+    if (!gyroDev->exti.fn) {
+        return false;
+    }
+#ifdef USE_GYRO_FIFO
+    if (gyroDev->fifoEnabled) {
+        // the data ready interrupt is disabled while the samples are queued in the FIFO
+        return false;
+    }
+#endif
+    gyroDev->dataReadyFn = callback;
+    return true;
+}
+#endif
+
+#ifdef USE_LOOP_TIMING
+// 0 if the active gyro has no data ready interrupt
+FAST_CODE timeUs_t gyroGetDataReadyTimeUs(void)
+{
+    return ACTIVE_GYRO->gyroDev.dataReadyTimeUs;
+}
+#endif
+
+#ifdef USE_GYRO_SPI_DMA
+// Must only be called once all blocking traffic on the gyro bus (acc init included) has finished.
+// Returns NULL if the active gyro is not being read by DMA.
+static struct gyroSpiDma_s *gyroSensorSpiDmaStart(gyroSensor_t *gyroSensor)
+{
+    gyroDev_t *gyroDev = &gyroSensor->gyroDev;
+    if (!gyroDev->dmaInitFn) {
+        return NULL;
+    }
+#ifdef USE_GYRO_FIFO
+    if (gyroDev->fifoEnabled) {
+        return NULL;
+    }
+#endif
+    if (!gyroDev->dmaInitFn(gyroDev)) {
+        return NULL;
+    }
+    return gyroDev->spiDma;
+}
+
+struct gyroSpiDma_s *gyroSpiDmaStart(void)
+{
+    if (!gyroConfig()->gyro_spi_dma) {
+        return NULL;
+    }
+#ifdef USE_MULTI_GYRO
+    if (gyroToUse == GYRO_CONFIG_USE_GYRO_BOTH) {
+        // Gyros on separate buses are then read concurrently, gyros sharing a bus both stay on polled reads
+        gyroSensorSpiDmaStart(&gyroSensor2);
+    }
+#endif
+    return gyroSensorSpiDmaStart(ACTIVE_GYRO);
+}
+
+// True if every gyro in use is read by DMA, so a gyro read never waits for the bus.
+// The DMA is only started on a bus that the gyro has to itself.
+bool gyroIsReadByDma(void)
+{
+#ifdef USE_MULTI_GYRO
+    if (gyroToUse == GYRO_CONFIG_USE_GYRO_BOTH && !gyroSensor2.gyroDev.spiDma) {
+        return false;
+    }
+#endif
+    return ACTIVE_GYRO->gyroDev.spiDma != NULL;
+}
+#endif
+
 STATIC_UNIT_TESTED gyroHardware_e gyroDetect(gyroDev_t *dev)
 {
     gyroHardware_e gyroHardware = GYRO_DEFAULT;
@@ -403,18 +552,64 @@ static bool gyroDetectSensor(gyroSensor_t *gyroSensor, const gyroDeviceConfig_t
     return gyroHardware != GYRO_NONE;
 }
 
+#ifdef USE_GYRO_RANGE_CHECK
+// The range checks look at the raw samples in the sensor's own orientation, with the limits in raw
+// units. A sensor axis is checked for overflow if it feeds a checked aligned axis by more than half,
+// the yaw spin check watches the sensor axis that mostly measures yaw.
+static void gyroInitSensorRangeCheck(gyroSensor_t *gyroSensor)
+{
+    const fp_rotationMatrix_t *matrix = &gyroSensor->gyroDev.rotation.matrix;
+    int32_t rangeCheckRaw = INT32_MAX;
+
+    gyroSensor->yawAxis = X;
+    for (int sensorAxis = 0; sensorAxis < XYZ_AXIS_COUNT; sensorAxis++) {
+        if (fabsf(matrix->m[sensorAxis][Z]) > fabsf(matrix->m[gyroSensor->yawAxis][Z])) {
+            gyroSensor->yawAxis = sensorAxis;
+        }
+        gyroSensor->overflowAxes[sensorAxis] = 0;
+#ifdef USE_GYRO_OVERFLOW_CHECK
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            if (fabsf(matrix->m[sensorAxis][axis]) > 0.5f) {
+                gyroSensor->overflowAxes[sensorAxis] |= overflowAxisMask & (1 << axis);
+            }
+        }
+#endif
+    }
+
+#ifdef USE_GYRO_OVERFLOW_CHECK
+    rangeCheckRaw = MIN(rangeCheckRaw, GYRO_OVERFLOW_RESET_THRESHOLD);
+#endif
+#ifdef USE_YAW_SPIN_RECOVERY
+    gyroSensor->yawSpinTriggerRaw = gyroConfig()->yaw_spin_threshold / gyroSensor->gyroDev.scale;
+    gyroSensor->yawSpinResetRaw = (gyroConfig()->yaw_spin_threshold - 100) / gyroSensor->gyroDev.scale;
+    rangeCheckRaw = MIN(rangeCheckRaw, gyroSensor->yawSpinResetRaw);
+#endif
+    gyroSensor->rangeCheckRaw = rangeCheckRaw;
+}
+#endif // USE_GYRO_RANGE_CHECK
+
 static void gyroInitSensor(gyroSensor_t *gyroSensor, const gyroDeviceConfig_t *config)
 {
     gyroSensor->gyroDev.gyro_high_fsr = gyroConfig()->gyro_high_fsr;
     gyroSensor->gyroDev.gyroAlign = config->alignment;
-    buildRotationMatrixFromAlignment(&config->customAlignment, &gyroSensor->gyroDev.rotationMatrix);
+    buildSensorRotation(&gyroSensor->gyroDev.rotation, config->alignment, &config->customAlignment);
     gyroSensor->gyroDev.mpuIntExtiTag = config->extiTag;
 
     // Must set gyro targetLooptime before gyroDev.init and initialisation of filters
     gyro.targetLooptime = gyroSetSampleRate(&gyroSensor->gyroDev, gyroConfig()->gyro_hardware_lpf, gyroConfig()->gyro_sync_denom);
+#ifdef USE_GYRO_ODR_TRACKING
+    gyro.odrScale = 1.0f;
+#endif
     gyroSensor->gyroDev.hardware_lpf = gyroConfig()->gyro_hardware_lpf;
+#ifdef USE_GYRO_FIFO
+    gyroSensor->gyroDev.fifoEnabled = gyroConfig()->gyro_fifo && gyroSensor->gyroDev.fifoReadFn;
+#endif
     gyroSensor->gyroDev.initFn(&gyroSensor->gyroDev);
 
+#ifdef USE_GYRO_RANGE_CHECK
+    gyroInitSensorRangeCheck(gyroSensor);
+#endif
+
     // As new gyros are supported, be sure to add them below based on whether they are subject to the overflow/inversion bug
     // Any gyro not explicitly defined will default to not having built-in overflow protection as a safe alternative.
     switch (gyroSensor->gyroDev.gyroHardware) {
@@ -489,6 +684,12 @@ bool gyroInit(void)
     }
     firstArmingCalibrationWasStarted = false;
 
+#ifdef USE_GYRO_CALIBRATION_STORE
+    if (gyroCalibrationConfig()->temperatureTolerance) {
+        dispatchEnable();
+    }
+#endif
+
     gyroDetectionFlags = NO_GYROS_DETECTED;
 
     gyroToUse = gyroConfig()->gyro_to_use;
@@ -556,6 +757,23 @@ bool gyroInit(void)
     }
 #endif
 
+    gyro.filterLooptime = gyro.targetLooptime;
+#ifdef USE_GYRO_INTERLEAVE
+    // Needs the data ready times of both gyros, and a sample of each per loop
+    gyro.interleaved = gyroToUse == GYRO_CONFIG_USE_GYRO_BOTH && gyroConfig()->gyro_interleave && gyroConfig()->gyro_sync_denom == 1
+        && gyroSensor1.gyroDev.exti.fn && gyroSensor2.gyroDev.exti.fn;
+#ifdef USE_GYRO_FIFO
+    gyro.interleaved = gyro.interleaved && !gyroSensor1.gyroDev.fifoEnabled && !gyroSensor2.gyroDev.fifoEnabled;
+#endif
+    if (gyro.interleaved) {
+        gyro.filterLooptime = gyro.targetLooptime / 2;
+    }
+#endif
+#ifdef USE_MULTI_GYRO
+    gyroSharedAlignment = gyroToUse == GYRO_CONFIG_USE_GYRO_BOTH && !gyro.interleaved && !useDualGyroDebugging
+        && memcmp(&gyroSensor1.gyroDev.rotation, &gyroSensor2.gyroDev.rotation, sizeof(sensorRotation_t)) == 0;
+#endif
+
     gyroInitFilters();
     return true;
 }
@@ -569,6 +787,7 @@ gyroDetectionFlags_t getGyroDetectionFlags(void)
 static FAST_RAM uint8_t dynLpfFilter = DYN_LPF_NONE;
 static FAST_RAM_ZERO_INIT uint16_t dynLpfMin;
 static FAST_RAM_ZERO_INIT uint16_t dynLpfMax;
+static dynLpfCoeffs_t dynLpfCoeffs[DYN_LPF_THROTTLE_STEPS + 1];
 
 static void dynLpfFilterInit()
 {
@@ -589,23 +808,29 @@ static void dynLpfFilterInit()
     }
     dynLpfMin = gyroConfig()->dyn_lpf_gyro_min_hz;
     dynLpfMax = gyroConfig()->dyn_lpf_gyro_max_hz;
+    dynLpfCoeffsInit(dynLpfCoeffs, dynLpfFilter, dynLpfMin, dynLpfMax, gyro.filterLooptime);
 }
 #endif
 
-void gyroInitLowpassFilterLpf(int slot, int type, uint16_t lpfHz)
+// With retune a filter that stays enabled with the same type crossfades to the new cutoff,
+// see gyroRetuneFilters(), otherwise it is initialised with its state cleared
+void gyroInitLowpassFilterLpf(int slot, int type, uint16_t lpfHz, bool retune)
 {
-    filterApplyFnPtr *lowpassFilterApplyFn;
+    gyroFilterStage_e *lowpassFilterStage;
     gyroLowpassFilter_t *lowpassFilter = NULL;
+    gyroLowpassCrossfade_t *lowpassCrossfade = NULL;
 
     switch (slot) {
     case FILTER_LOWPASS:
-        lowpassFilterApplyFn = &gyro.lowpassFilterApplyFn;
-        lowpassFilter = gyro.lowpassFilter;
+        lowpassFilterStage = &gyro.lowpassFilterStage;
+        lowpassFilter = &gyro.lowpassFilter;
+        lowpassCrossfade = &gyro.lowpassCrossfade;
         break;
 
     case FILTER_LOWPASS2:
-        lowpassFilterApplyFn = &gyro.lowpass2FilterApplyFn;
-        lowpassFilter = gyro.lowpass2Filter;
+        lowpassFilterStage = &gyro.lowpass2FilterStage;
+        lowpassFilter = &gyro.lowpass2Filter;
+        lowpassCrossfade = &gyro.lowpass2Crossfade;
         break;
 
     default:
@@ -613,42 +838,77 @@ void gyroInitLowpassFilterLpf(int slot, int type, uint16_t lpfHz)
     }
 
     // Establish some common constants
-    const uint32_t gyroFrequencyNyquist = 1000000 / 2 / gyro.targetLooptime;
-    const float gyroDt = gyro.targetLooptime * 1e-6f;
+    const uint32_t gyroFrequencyNyquist = 1000000 / 2 / gyro.filterLooptime;
+    const float gyroDt = gyro.filterLooptime * 1e-6f;
 
     // Gain could be calculated a little later as it is specific to the pt1/bqrcf2/fkf branches
     const float gain = pt1FilterGain(lpfHz, gyroDt);
 
-    // Dereference the pointer to null before checking valid cutoff and filter
+    const gyroFilterStage_e previousStage = *lowpassFilterStage;
+
+    // Disable the stage before checking valid cutoff and filter
     // type. It will be overridden for positive cases.
-    *lowpassFilterApplyFn = nullFilterApply;
+    *lowpassFilterStage = GYRO_FILTER_STAGE_NONE;
 
     // If lowpass cutoff has been specified and is less than the Nyquist frequency
     if (lpfHz && lpfHz <= gyroFrequencyNyquist) {
         switch (type) {
         case FILTER_PT1:
-            *lowpassFilterApplyFn = (filterApplyFnPtr) pt1FilterApply;
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                pt1FilterInit(&lowpassFilter[axis].pt1FilterState, gain);
-            }
+            *lowpassFilterStage = GYRO_FILTER_STAGE_PT1;
             break;
         case FILTER_BIQUAD:
 #ifdef USE_DYN_LPF
-            *lowpassFilterApplyFn = (filterApplyFnPtr) biquadFilterApplyDF1;
+            *lowpassFilterStage = GYRO_FILTER_STAGE_BIQUAD_DF1;
 #else
-            *lowpassFilterApplyFn = (filterApplyFnPtr) biquadFilterApply;
+            *lowpassFilterStage = GYRO_FILTER_STAGE_BIQUAD;
 #endif
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                biquadFilterInitLPF(&lowpassFilter[axis].biquadFilterState, lpfHz, gyro.targetLooptime);
-            }
             break;
         }
     }
+
+    lowpassCrossfade->biquadCrossfade.steps = 0;
+    lowpassCrossfade->pt1Crossfade.steps = 0;
+
+    if (retune && *lowpassFilterStage == previousStage) {
+#ifdef USE_DYN_LPF
+        if (slot == FILTER_LOWPASS && gyroConfig()->dyn_lpf_gyro_min_hz > 0) {
+            // the dynamic lowpass moves the cutoff itself on every loop
+            return;
+        }
+#endif
+        switch (*lowpassFilterStage) {
+        case GYRO_FILTER_STAGE_PT1:
+            pt1Filter3CrossfadeStart(&lowpassCrossfade->pt1Crossfade, gain, gyro.filterCrossfadeSteps);
+            gyro.filterCrossfadeActive = true;
+            break;
+        case GYRO_FILTER_STAGE_BIQUAD:
+        case GYRO_FILTER_STAGE_BIQUAD_DF1:
+            biquadFilter3CrossfadeStartLPF(&lowpassCrossfade->biquadCrossfade, lpfHz, gyro.filterLooptime, gyro.filterCrossfadeSteps);
+            gyro.filterCrossfadeActive = true;
+            break;
+        default:
+            break;
+        }
+
+        return;
+    }
+
+    switch (*lowpassFilterStage) {
+    case GYRO_FILTER_STAGE_PT1:
+        pt1Filter3Init(&lowpassFilter->pt1FilterState, gain);
+        break;
+    case GYRO_FILTER_STAGE_BIQUAD:
+    case GYRO_FILTER_STAGE_BIQUAD_DF1:
+        biquadFilter3InitLPF(&lowpassFilter->biquadFilterState, lpfHz, gyro.filterLooptime);
+        break;
+    default:
+        break;
+    }
 }
 
 static uint16_t calculateNyquistAdjustedNotchHz(uint16_t notchHz, uint16_t notchCutoffHz)
 {
-    const uint32_t gyroFrequencyNyquist = 1000000 / 2 / gyro.targetLooptime;
+    const uint32_t gyroFrequencyNyquist = 1000000 / 2 / gyro.filterLooptime;
     if (notchHz > gyroFrequencyNyquist) {
         if (notchCutoffHz < gyroFrequencyNyquist) {
             notchHz = gyroFrequencyNyquist;
@@ -669,32 +929,22 @@ void gyroInitSlewLimiter(gyroSensor_t *gyroSensor) {
 }
 #endif
 
-static void gyroInitFilterNotch1(uint16_t notchHz, uint16_t notchCutoffHz)
-{
-    gyro.notchFilter1ApplyFn = nullFilterApply;
-
-    notchHz = calculateNyquistAdjustedNotchHz(notchHz, notchCutoffHz);
-
-    if (notchHz != 0 && notchCutoffHz != 0) {
-        gyro.notchFilter1ApplyFn = (filterApplyFnPtr)biquadFilterApply;
-        const float notchQ = filterGetNotchQ(notchHz, notchCutoffHz);
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&gyro.notchFilter1[axis], notchHz, gyro.targetLooptime, notchQ, FILTER_NOTCH);
-        }
-    }
-}
-
-static void gyroInitFilterNotch2(uint16_t notchHz, uint16_t notchCutoffHz)
+static void gyroInitFilterNotch(bool *enabled, biquadFilter3_t *notchFilter, biquadCrossfade_t *crossfade, uint16_t notchHz, uint16_t notchCutoffHz, bool retune)
 {
-    gyro.notchFilter2ApplyFn = nullFilterApply;
+    const bool wasEnabled = *enabled;
+    *enabled = false;
+    crossfade->steps = 0;
 
     notchHz = calculateNyquistAdjustedNotchHz(notchHz, notchCutoffHz);
 
     if (notchHz != 0 && notchCutoffHz != 0) {
-        gyro.notchFilter2ApplyFn = (filterApplyFnPtr)biquadFilterApply;
+        *enabled = true;
         const float notchQ = filterGetNotchQ(notchHz, notchCutoffHz);
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&gyro.notchFilter2[axis], notchHz, gyro.targetLooptime, notchQ, FILTER_NOTCH);
+        if (retune && wasEnabled) {
+            biquadFilter3CrossfadeStart(crossfade, notchHz, gyro.filterLooptime, notchQ, FILTER_NOTCH, gyro.filterCrossfadeSteps);
+            gyro.filterCrossfadeActive = true;
+        } else {
+            biquadFilter3Init(notchFilter, notchHz, gyro.filterLooptime, notchQ, FILTER_NOTCH);
         }
     }
 }
@@ -705,20 +955,30 @@ static bool isDynamicFilterActive(void)
     return featureIsEnabled(FEATURE_DYNAMIC_FILTER);
 }
 
-static void gyroInitFilterDynamicNotch()
+// The dynamic notches are retuned by the analyser, so with retune they are only initialised
+// when their number changes
+static void gyroInitFilterDynamicNotch(bool retune)
 {
-    gyro.notchFilterDynApplyFn = nullFilterApply;
-    gyro.notchFilterDynApplyFn2 = nullFilterApply;
+    const uint8_t previousCount = gyro.notchFilterDynCount;
+    gyro.notchFilterDynCount = 0;
 
     if (isDynamicFilterActive()) {
-        gyro.notchFilterDynApplyFn = (filterApplyFnPtr)biquadFilterApplyDF1; // must be this function, not DF2
-        if(gyroConfig()->dyn_notch_width_percent != 0) {
-            gyro.notchFilterDynApplyFn2 = (filterApplyFnPtr)biquadFilterApplyDF1; // must be this function, not DF2
+        // applied with biquadFilterApplyDF1, not DF2, as the coefficients change while running
+        // a single peak gets a pair of notches either side of it when dyn_notch_width_percent is set, more peaks get one notch each
+        const uint8_t peakCount = constrain(gyroConfig()->dyn_notch_count, 1, DYN_NOTCH_COUNT_MAX);
+        if (peakCount == 1) {
+            gyro.notchFilterDynCount = gyroConfig()->dyn_notch_width_percent != 0 ? 2 : 1;
+        } else {
+            gyro.notchFilterDynCount = peakCount;
+        }
+        if (retune && gyro.notchFilterDynCount == previousCount) {
+            return;
         }
         const float notchQ = filterGetNotchQ(DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, DYNAMIC_NOTCH_DEFAULT_CUTOFF_HZ); // any defaults OK here
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&gyro.notchFilterDyn[axis], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, gyro.targetLooptime, notchQ, FILTER_NOTCH);
-            biquadFilterInit(&gyro.notchFilterDyn2[axis], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, gyro.targetLooptime, notchQ, FILTER_NOTCH);
+            for (int i = 0; i < gyro.notchFilterDynCount; i++) {
+                biquadFilterInit(&gyro.notchFilterDyn[axis][i], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, gyro.filterLooptime, notchQ, FILTER_NOTCH);
+            }
         }
     }
 }
@@ -733,7 +993,7 @@ static void gyroInitSensorFilters(gyroSensor_t *gyroSensor)
 #endif
 }
 
-void gyroInitFilters(void)
+static void gyroConfigureFilters(bool retune)
 {
     uint16_t gyro_lowpass_hz = gyroConfig()->gyro_lowpass_hz;
 
@@ -743,29 +1003,79 @@ void gyroInitFilters(void)
     }
 #endif
 
+    gyro.filterCrossfadeActive = false;
+    gyro.filterCrossfadeSteps = MAX(GYRO_FILTER_CROSSFADE_US / gyro.targetLooptime, 1U);
+
     gyroInitLowpassFilterLpf(
       FILTER_LOWPASS,
       gyroConfig()->gyro_lowpass_type,
-      gyro_lowpass_hz
+      gyro_lowpass_hz,
+      retune
     );
 
     gyroInitLowpassFilterLpf(
       FILTER_LOWPASS2,
       gyroConfig()->gyro_lowpass2_type,
-      gyroConfig()->gyro_lowpass2_hz
+      gyroConfig()->gyro_lowpass2_hz,
+      retune
     );
 
-    gyroInitFilterNotch1(gyroConfig()->gyro_soft_notch_hz_1, gyroConfig()->gyro_soft_notch_cutoff_1);
-    gyroInitFilterNotch2(gyroConfig()->gyro_soft_notch_hz_2, gyroConfig()->gyro_soft_notch_cutoff_2);
+    gyroInitFilterNotch(&gyro.notchFilter1Enabled, &gyro.notchFilter1, &gyro.notchFilter1Crossfade,
+        gyroConfig()->gyro_soft_notch_hz_1, gyroConfig()->gyro_soft_notch_cutoff_1, retune);
+    gyroInitFilterNotch(&gyro.notchFilter2Enabled, &gyro.notchFilter2, &gyro.notchFilter2Crossfade,
+        gyroConfig()->gyro_soft_notch_hz_2, gyroConfig()->gyro_soft_notch_cutoff_2, retune);
 #ifdef USE_GYRO_DATA_ANALYSE
-    gyroInitFilterDynamicNotch();
+    gyroInitFilterDynamicNotch(retune);
 #endif
 #ifdef USE_DYN_LPF
     dynLpfFilterInit();
 #endif
 #ifdef USE_GYRO_DATA_ANALYSE
-    gyroDataAnalyseStateInit(&gyro.gyroAnalyseState, gyro.targetLooptime);
+    gyroDataAnalyseStateInit(&gyro.gyroAnalyseState, gyro.filterLooptime);
 #endif
+    gyroInitFilterChain();
+}
+
+void gyroInitFilters(void)
+{
+    PENDSV_BLOCK {
+        gyroConfigureFilters(false);
+    }
+}
+
+// Applies a change of the filter configuration while running, e.g. from MSP or the CMS. Unlike
+// gyroInitFilters() the lowpass and notch filters that stay enabled keep their state and move
+// to the new coefficients over GYRO_FILTER_CROSSFADE_US, so that the gyro signal does not jump.
+void gyroRetuneFilters(void)
+{
+    PENDSV_BLOCK {
+        gyroConfigureFilters(true);
+    }
+}
+
+// Advances the crossfades started by gyroRetuneFilters(), once per gyro sample
+static FAST_CODE_NOINLINE void gyroStepFilterCrossfades(void)
+{
+    bool active = false;
+
+    if (gyro.lowpassFilterStage == GYRO_FILTER_STAGE_PT1) {
+        active |= pt1Filter3CrossfadeStep(&gyro.lowpassFilter.pt1FilterState, &gyro.lowpassCrossfade.pt1Crossfade);
+    } else if (gyro.lowpassFilterStage != GYRO_FILTER_STAGE_NONE) {
+        active |= biquadFilter3CrossfadeStep(&gyro.lowpassFilter.biquadFilterState, &gyro.lowpassCrossfade.biquadCrossfade);
+    }
+    if (gyro.lowpass2FilterStage == GYRO_FILTER_STAGE_PT1) {
+        active |= pt1Filter3CrossfadeStep(&gyro.lowpass2Filter.pt1FilterState, &gyro.lowpass2Crossfade.pt1Crossfade);
+    } else if (gyro.lowpass2FilterStage != GYRO_FILTER_STAGE_NONE) {
+        active |= biquadFilter3CrossfadeStep(&gyro.lowpass2Filter.biquadFilterState, &gyro.lowpass2Crossfade.biquadCrossfade);
+    }
+    if (gyro.notchFilter1Enabled) {
+        active |= biquadFilter3CrossfadeStep(&gyro.notchFilter1, &gyro.notchFilter1Crossfade);
+    }
+    if (gyro.notchFilter2Enabled) {
+        active |= biquadFilter3CrossfadeStep(&gyro.notchFilter2, &gyro.notchFilter2Crossfade);
+    }
+
+    gyro.filterCrossfadeActive = active;
 }
 
 FAST_CODE bool isGyroSensorCalibrationComplete(const gyroSensor_t *gyroSensor)
@@ -824,6 +1134,13 @@ void gyroStartCalibration(bool isFirstArmingCalibration)
 #ifdef USE_MULTI_GYRO
         gyroSetCalibrationCycles(&gyroSensor2);
 #endif
+#ifdef USE_GYRO_CALIBRATION_STORE
+        storeCalibration = !isFirstArmingCalibration;
+        // the offsets of an earlier calibration that were not stored yet are about to be replaced
+        for (int i = 0; i < GYRO_CALIBRATION_STORE_COUNT; i++) {
+            calibrationStorePending[i] = false;
+        }
+#endif
 
         if (isFirstArmingCalibration) {
             firstArmingCalibrationWasStarted = true;
@@ -831,11 +1148,164 @@ void gyroStartCalibration(bool isFirstArmingCalibration)
     }
 }
 
+#ifdef USE_GYRO_CALIBRATION_STORE
+static int gyroCalibrationStoreIndex(const gyroSensor_t *gyroSensor)
+{
+#ifdef USE_MULTI_GYRO
+    if (gyroSensor == &gyroSensor2) {
+        return 1;
+    }
+#else
+    UNUSED(gyroSensor);
+#endif
+    return 0;
+}
+
+static bool gyroCalibrationReadTemperature(gyroSensor_t *gyroSensor)
+{
+    gyroDev_t *gyroDev = &gyroSensor->gyroDev;
+    return gyroDev->temperatureFn && gyroDev->temperatureFn(gyroDev, &gyroDev->temperature);
+}
+
+static void gyroCalibrationSave(dispatchEntry_t *self)
+{
+    UNUSED(self);
+
+    // Don't save if the user made config changes that have not yet been saved.
+    if (!ARMING_FLAG(ARMED) && !isConfigDirty()) {
+        writeEEPROM();
+    }
+}
+
+static dispatchEntry_t gyroCalibrationSaveEntry = {
+    gyroCalibrationSave, 0, NULL, false
+};
+
+// Called from the PID loop once the calibration is done, which may run from PendSV. The offsets are
+// stored later by gyroCalibrationStoreUpdate(). Not done for the first arming calibration, which would
+// write the flash on every flight.
+static void gyroStoreCalibration(gyroSensor_t *gyroSensor)
+{
+    if (storeCalibration && gyroCalibrationConfig()->temperatureTolerance) {
+        calibrationStorePending[gyroCalibrationStoreIndex(gyroSensor)] = true;
+    }
+}
+
+// Tags the offsets with the gyro temperature and saves them, so that the next boot at about the same
+// temperature can skip the calibration
+static void gyroStoreSensorCalibration(gyroSensor_t *gyroSensor)
+{
+    const int index = gyroCalibrationStoreIndex(gyroSensor);
+    if (!calibrationStorePending[index]) {
+        return;
+    }
+    calibrationStorePending[index] = false;
+
+    if (!gyroCalibrationReadTemperature(gyroSensor)) {
+        return;
+    }
+
+    gyroCalibrationConfig_t *config = gyroCalibrationConfigMutable();
+    config->temperature[index] = gyroSensor->gyroDev.temperature;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        config->zero[index][axis] = gyroSensor->gyroDev.gyroZero[axis];
+    }
+    config->zero[index][Z] += ((float)gyroConfig()->gyro_offset_yaw / 100);
+    config->storedSensors |= BIT(index);
+
+    dispatchAdd(&gyroCalibrationSaveEntry, GYRO_CALIBRATION_SAVE_DELAY_US);
+}
+
+static bool gyroRestoreSensorCalibration(gyroSensor_t *gyroSensor)
+{
+    const gyroCalibrationConfig_t *config = gyroCalibrationConfig();
+    const int index = gyroCalibrationStoreIndex(gyroSensor);
+
+    if (!config->temperatureTolerance || !(config->storedSensors & BIT(index)) || !gyroCalibrationReadTemperature(gyroSensor)
+        || ABS(gyroSensor->gyroDev.temperature - config->temperature[index]) > config->temperatureTolerance) {
+        return false;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyroSensor->gyroDev.gyroZero[axis] = config->zero[index][axis];
+    }
+    gyroSensor->gyroDev.gyroZero[Z] -= ((float)gyroConfig()->gyro_offset_yaw / 100);
+    gyroSensor->calibration.cyclesRemaining = 0;
+
+    return true;
+}
+#endif // USE_GYRO_CALIBRATION_STORE
+
+// Called from a task, the temperature read, the config write and dispatchAdd() can not be done in the PID loop
+void gyroCalibrationStoreUpdate(void)
+{
+#ifdef USE_GYRO_CALIBRATION_STORE
+    gyroStoreSensorCalibration(&gyroSensor1);
+#ifdef USE_MULTI_GYRO
+    gyroStoreSensorCalibration(&gyroSensor2);
+#endif
+#endif
+}
+
+// Called at boot in place of gyroStartCalibration(), returns false if a gyro in use
+// has no offsets stored at about its current temperature and has to be calibrated
+bool gyroRestoreCalibration(void)
+{
+#ifdef USE_GYRO_CALIBRATION_STORE
+    switch (gyroToUse) {
+    default:
+    case GYRO_CONFIG_USE_GYRO_1:
+        if (!gyroRestoreSensorCalibration(&gyroSensor1)) {
+            return false;
+        }
+        break;
+#ifdef USE_MULTI_GYRO
+    case GYRO_CONFIG_USE_GYRO_2:
+        if (!gyroRestoreSensorCalibration(&gyroSensor2)) {
+            return false;
+        }
+        break;
+    case GYRO_CONFIG_USE_GYRO_BOTH:
+        if (!gyroRestoreSensorCalibration(&gyroSensor1) || !gyroRestoreSensorCalibration(&gyroSensor2)) {
+            return false;
+        }
+        break;
+#endif
+    }
+
+    beeper(BEEPER_GYRO_CALIBRATED);
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool isFirstArmingGyroCalibrationRunning(void)
 {
     return firstArmingCalibrationWasStarted && !isGyroCalibrationComplete();
 }
 
+// The 95% confidence interval of a mean is about two standard errors either side, so the offsets are
+// accurate enough once 4 * variance / n < accuracy^2 on every axis. devPush() keeps the running
+// variance with Welford's method, so this costs no extra pass over the samples.
+static bool isGyroCalibrationAccurate(gyroSensor_t *gyroSensor)
+{
+    const int sampleCount = gyroSensor->calibration.var[X].m_n;
+    if (sampleCount < gyroCalculateCalibratingCycles() / GYRO_CALIBRATION_MIN_FRACTION) {
+        return false;
+    }
+
+    const float accuracy = GYRO_CALIBRATION_ACCURACY_DPS / gyroSensor->gyroDev.scale;
+    const float varianceLimit = sq(accuracy) * sampleCount / 4;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (devVariance(&gyroSensor->calibration.var[axis]) > varianceLimit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 STATIC_UNIT_TESTED void performGyroCalibration(gyroSensor_t *gyroSensor, uint8_t gyroMovementCalibrationThreshold)
 {
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
@@ -850,37 +1320,43 @@ STATIC_UNIT_TESTED void performGyroCalibration(gyroSensor_t *gyroSensor, uint8_t
         // Sum up CALIBRATING_GYRO_TIME_US readings
         gyroSensor->calibration.sum[axis] += gyroSensor->gyroDev.gyroADCRaw[axis];
         devPush(&gyroSensor->calibration.var[axis], gyroSensor->gyroDev.gyroADCRaw[axis]);
+    }
 
-        if (isOnFinalGyroCalibrationCycle(&gyroSensor->calibration)) {
-            const float stddev = devStandardDeviation(&gyroSensor->calibration.var[axis]);
-            // DEBUG_GYRO_CALIBRATION records the standard deviation of roll
-            // into the spare field - debug[3], in DEBUG_GYRO_RAW
-            if (axis == X) {
-                DEBUG_SET(DEBUG_GYRO_RAW, DEBUG_GYRO_CALIBRATION, lrintf(stddev));
-            }
+    if (!isOnFinalGyroCalibrationCycle(&gyroSensor->calibration) && !isGyroCalibrationAccurate(gyroSensor)) {
+        --gyroSensor->calibration.cyclesRemaining;
+        return;
+    }
 
-            // check deviation and startover in case the model was moved
-            if (gyroMovementCalibrationThreshold && stddev > gyroMovementCalibrationThreshold) {
-                gyroSetCalibrationCycles(gyroSensor);
-                return;
-            }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float stddev = devStandardDeviation(&gyroSensor->calibration.var[axis]);
+        // DEBUG_GYRO_CALIBRATION records the standard deviation of roll
+        // into the spare field - debug[3], in DEBUG_GYRO_RAW
+        if (axis == X) {
+            DEBUG_SET(DEBUG_GYRO_RAW, DEBUG_GYRO_CALIBRATION, lrintf(stddev));
+        }
 
-            // please take care with exotic boardalignment !!
-            gyroSensor->gyroDev.gyroZero[axis] = gyroSensor->calibration.sum[axis] / gyroCalculateCalibratingCycles();
-            if (axis == Z) {
-              gyroSensor->gyroDev.gyroZero[axis] -= ((float)gyroConfig()->gyro_offset_yaw / 100);
-            }
+        // check deviation and startover in case the model was moved
+        if (gyroMovementCalibrationThreshold && stddev > gyroMovementCalibrationThreshold) {
+            gyroSetCalibrationCycles(gyroSensor);
+            return;
         }
     }
 
-    if (isOnFinalGyroCalibrationCycle(&gyroSensor->calibration)) {
-        schedulerResetTaskStatistics(TASK_SELF); // so calibration cycles do not pollute tasks statistics
-        if (!firstArmingCalibrationWasStarted || (getArmingDisableFlags() & ~ARMING_DISABLED_CALIBRATING) == 0) {
-            beeper(BEEPER_GYRO_CALIBRATED);
-        }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        // please take care with exotic boardalignment !!
+        gyroSensor->gyroDev.gyroZero[axis] = gyroSensor->calibration.sum[axis] / gyroSensor->calibration.var[axis].m_n;
     }
-    --gyroSensor->calibration.cyclesRemaining;
+    gyroSensor->gyroDev.gyroZero[Z] -= ((float)gyroConfig()->gyro_offset_yaw / 100);
 
+#ifdef USE_GYRO_CALIBRATION_STORE
+    gyroStoreCalibration(gyroSensor);
+#endif
+
+    schedulerResetTaskStatistics(TASK_SELF); // so calibration cycles do not pollute tasks statistics
+    if (!firstArmingCalibrationWasStarted || (getArmingDisableFlags() & ~ARMING_DISABLED_CALIBRATING) == 0) {
+        beeper(BEEPER_GYRO_CALIBRATED);
+    }
+    gyroSensor->calibration.cyclesRemaining = 0;
 }
 
 #if defined(USE_GYRO_SLEW_LIMITER)
@@ -901,18 +1377,33 @@ FAST_CODE int32_t gyroSlewLimiter(gyroSensor_t *gyroSensor, int axis)
 }
 #endif
 
+#ifdef USE_GYRO_RANGE_CHECK
+// Only called for a raw sample close to a limit, so the checks cost one comparison per axis otherwise
+static FAST_CODE_NOINLINE void gyroCheckRawRange(const gyroSensor_t *gyroSensor, int axis, int32_t rawAbs)
+{
+#ifdef USE_GYRO_OVERFLOW_CHECK
+    if (rawAbs > GYRO_OVERFLOW_RESET_THRESHOLD) {
+        gyroRangeFlags |= GYRO_RANGE_OVERFLOW_HIGH;
+        if (rawAbs > GYRO_OVERFLOW_TRIGGER_THRESHOLD) {
+            gyroOverflowAxes |= gyroSensor->overflowAxes[axis];
+        }
+    }
+#endif
+#ifdef USE_YAW_SPIN_RECOVERY
+    if (axis == gyroSensor->yawAxis && rawAbs > gyroSensor->yawSpinResetRaw) {
+        gyroRangeFlags |= GYRO_RANGE_YAW_SPIN_HIGH;
+        if (rawAbs > gyroSensor->yawSpinTriggerRaw) {
+            gyroRangeFlags |= GYRO_RANGE_YAW_SPIN;
+        }
+    }
+#endif
+}
+#endif // USE_GYRO_RANGE_CHECK
+
 #ifdef USE_GYRO_OVERFLOW_CHECK
 static FAST_CODE_NOINLINE void handleOverflow(timeUs_t currentTimeUs)
 {
-    // This will need to be revised if we ever allow different sensor types to be 
-    // used simultaneously. In that case the scale might be different between sensors.
-    // It's complicated by the fact that we're using filtered gyro data here which is
-    // after both sensors are scaled and averaged.
-    const float gyroOverflowResetRate = GYRO_OVERFLOW_RESET_THRESHOLD * gyro.scale;
-
-    if ((abs(gyro.gyroADCf[X]) < gyroOverflowResetRate)
-          && (abs(gyro.gyroADCf[Y]) < gyroOverflowResetRate)
-          && (abs(gyro.gyroADCf[Z]) < gyroOverflowResetRate)) {
+    if (!(gyroRangeFlags & GYRO_RANGE_OVERFLOW_HIGH)) {
         // if we have 50ms of consecutive OK gyro vales, then assume yaw readings are OK again and reset overflowDetected
         // reset requires good OK values on all axes
         if (cmpTimeUs(currentTimeUs, overflowTimeUs) > 50000) {
@@ -934,25 +1425,11 @@ static FAST_CODE void checkForOverflow(timeUs_t currentTimeUs)
         handleOverflow(currentTimeUs);
     } else {
 #ifndef SIMULATOR_BUILD
-        // check for overflow in the axes set in overflowAxisMask
-        gyroOverflow_e overflowCheck = GYRO_OVERFLOW_NONE;
-
-        // This will need to be revised if we ever allow different sensor types to be 
-        // used simultaneously. In that case the scale might be different between sensors.
-        // It's complicated by the fact that we're using filtered gyro data here which is
-        // after both sensors are scaled and averaged.
-        const float gyroOverflowTriggerRate = GYRO_OVERFLOW_TRIGGER_THRESHOLD * gyro.scale;
-
-        if (abs(gyro.gyroADCf[X]) > gyroOverflowTriggerRate) {
-            overflowCheck |= GYRO_OVERFLOW_X;
-        }
-        if (abs(gyro.gyroADCf[Y]) > gyroOverflowTriggerRate) {
-            overflowCheck |= GYRO_OVERFLOW_Y;
-        }
-        if (abs(gyro.gyroADCf[Z]) > gyroOverflowTriggerRate) {
-            overflowCheck |= GYRO_OVERFLOW_Z;
-        }
-        if (overflowCheck & overflowAxisMask) {
+        // the raw samples of the axes set in overflowAxisMask were checked as they were read
+        if (gyroOverflowAxes) {
+#ifdef USE_CRASH_LOG
+            crashLogRecord(CRASH_LOG_GYRO_OVERFLOW, CRASH_LOG_NO_TASK, gyroOverflowAxes);
+#endif
             overflowDetected = true;
             overflowTimeUs = currentTimeUs;
 #ifdef USE_YAW_SPIN_RECOVERY
@@ -967,8 +1444,7 @@ static FAST_CODE void checkForOverflow(timeUs_t currentTimeUs)
 #ifdef USE_YAW_SPIN_RECOVERY
 static FAST_CODE_NOINLINE void handleYawSpin(timeUs_t currentTimeUs)
 {
-    const float yawSpinResetRate = gyroConfig()->yaw_spin_threshold - 100.0f;
-    if (abs(gyro.gyroADCf[Z]) < yawSpinResetRate) {
+    if (!(gyroRangeFlags & GYRO_RANGE_YAW_SPIN_HIGH)) {
         // testing whether 20ms of consecutive OK gyro yaw values is enough
         if (cmpTimeUs(currentTimeUs, yawSpinTimeUs) > 20000) {
             yawSpinDetected = false;
@@ -994,7 +1470,7 @@ static FAST_CODE void checkForYawSpin(timeUs_t currentTimeUs)
     } else {
 #ifndef SIMULATOR_BUILD
         // check for spin on yaw axis only
-         if (abs(gyro.gyroADCf[Z]) > gyroConfig()->yaw_spin_threshold) {
+        if (gyroRangeFlags & GYRO_RANGE_YAW_SPIN) {
             yawSpinDetected = true;
             yawSpinTimeUs = currentTimeUs;
         }
@@ -1003,50 +1479,313 @@ static FAST_CODE void checkForYawSpin(timeUs_t currentTimeUs)
 }
 #endif // USE_YAW_SPIN_RECOVERY
 
-static FAST_CODE FAST_CODE_NOINLINE void gyroUpdateSensor(gyroSensor_t *gyroSensor)
+// Inlined into the filter chains, where the stage is a constant for the specialised variants
+static inline void gyroLowpassFilterApply(gyroFilterStage_e stage, gyroLowpassFilter_t *filter, float *values)
 {
-    if (!gyroSensor->gyroDev.readFn(&gyroSensor->gyroDev)) {
+    switch (stage) {
+    case GYRO_FILTER_STAGE_PT1:
+        pt1Filter3Apply(&filter->pt1FilterState, values);
+        break;
+    case GYRO_FILTER_STAGE_BIQUAD:
+        biquadFilter3Apply(&filter->biquadFilterState, values);
+        break;
+    case GYRO_FILTER_STAGE_BIQUAD_DF1:
+        biquadFilter3ApplyDF1(&filter->biquadFilterState, values);
+        break;
+    default:
+        break;
+    }
+}
+
+// The generic filter chains handle any configuration
+#define GYRO_FILTER_RPM true
+#define GYRO_FILTER_DYN_NOTCH isDynamicFilterActive()
+#define GYRO_FILTER_STATIC_NOTCH true
+#define GYRO_FILTER_LOWPASS_STAGE gyro.lowpassFilterStage
+#define GYRO_FILTER_LOWPASS2_STAGE gyro.lowpass2FilterStage
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyro
+#define GYRO_FIFO_DECIMATE_FUNCTION_NAME decimateGyroFifo
+#define GYRO_FILTER_DEBUG_SET(mode, index, value) { UNUSED(mode); UNUSED(index); UNUSED(value); }
+#include "gyro_filter_impl.c"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FIFO_DECIMATE_FUNCTION_NAME
+#undef GYRO_FILTER_DEBUG_SET
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroDebug
+#define GYRO_FIFO_DECIMATE_FUNCTION_NAME decimateGyroFifoDebug
+#define GYRO_FILTER_DEBUG_SET DEBUG_SET
+#include "gyro_filter_impl.c"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FIFO_DECIMATE_FUNCTION_NAME
+#undef GYRO_FILTER_DEBUG_SET
+
+#undef GYRO_FILTER_RPM
+#undef GYRO_FILTER_DYN_NOTCH
+#undef GYRO_FILTER_STATIC_NOTCH
+#undef GYRO_FILTER_LOWPASS_STAGE
+#undef GYRO_FILTER_LOWPASS2_STAGE
+
+// Specialised filter chains for the default lowpass setup (dynamic PT1 lowpass 1 and PT1 lowpass 2)
+// without static notches, see gyroInitFilterChain()
+#define GYRO_FILTER_DEBUG_SET(mode, index, value) { UNUSED(mode); UNUSED(index); UNUSED(value); }
+#define GYRO_FILTER_STATIC_NOTCH false
+#define GYRO_FILTER_LOWPASS_STAGE GYRO_FILTER_STAGE_PT1
+#define GYRO_FILTER_LOWPASS2_STAGE GYRO_FILTER_STAGE_PT1
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Pt1
+#define GYRO_FILTER_RPM false
+#define GYRO_FILTER_DYN_NOTCH false
+#include "gyro_filter_impl.c"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_RPM
+#undef GYRO_FILTER_DYN_NOTCH
+
+#ifdef USE_RPM_FILTER
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Pt1Rpm
+#define GYRO_FILTER_RPM true
+#define GYRO_FILTER_DYN_NOTCH false
+#include "gyro_filter_impl.c"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_RPM
+#undef GYRO_FILTER_DYN_NOTCH
+#endif
+
+#ifdef USE_GYRO_DATA_ANALYSE
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Pt1DynNotch
+#define GYRO_FILTER_RPM false
+#define GYRO_FILTER_DYN_NOTCH true
+#include "gyro_filter_impl.c"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_RPM
+#undef GYRO_FILTER_DYN_NOTCH
+#endif
+
+#if defined(USE_RPM_FILTER) && defined(USE_GYRO_DATA_ANALYSE)
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Pt1RpmDynNotch
+#define GYRO_FILTER_RPM true
+#define GYRO_FILTER_DYN_NOTCH true
+#include "gyro_filter_impl.c"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_RPM
+#undef GYRO_FILTER_DYN_NOTCH
+#endif
+
+#undef GYRO_FILTER_DEBUG_SET
+#undef GYRO_FILTER_STATIC_NOTCH
+#undef GYRO_FILTER_LOWPASS_STAGE
+#undef GYRO_FILTER_LOWPASS2_STAGE
+
+// Picks the filter chain for the current configuration, must be called once the filters have been initialised
+STATIC_UNIT_TESTED void gyroInitFilterChain(void)
+{
+    gyroFilterChainFn = filterGyro;
+
+    if (gyro.notchFilter1Enabled || gyro.notchFilter2Enabled
+        || gyro.lowpassFilterStage != GYRO_FILTER_STAGE_PT1 || gyro.lowpass2FilterStage != GYRO_FILTER_STAGE_PT1) {
         return;
     }
+
+#ifdef USE_RPM_FILTER
+    const bool rpmFilterActive = isRpmFilterGyroEnabled();
+#else
+    const bool rpmFilterActive = false;
+#endif
+#ifdef USE_GYRO_DATA_ANALYSE
+    const bool dynNotchActive = isDynamicFilterActive();
+#else
+    const bool dynNotchActive = false;
+#endif
+
+    if (rpmFilterActive && dynNotchActive) {
+#if defined(USE_RPM_FILTER) && defined(USE_GYRO_DATA_ANALYSE)
+        gyroFilterChainFn = filterGyroPt1Pt1RpmDynNotch;
+#endif
+    } else if (rpmFilterActive) {
+#ifdef USE_RPM_FILTER
+        gyroFilterChainFn = filterGyroPt1Pt1Rpm;
+#endif
+    } else if (dynNotchActive) {
+#ifdef USE_GYRO_DATA_ANALYSE
+        gyroFilterChainFn = filterGyroPt1Pt1DynNotch;
+#endif
+    } else {
+        gyroFilterChainFn = filterGyroPt1Pt1;
+    }
+}
+
+// Returns false if the sensor had no new sample
+static FAST_CODE bool gyroReadSensor(gyroSensor_t *gyroSensor)
+{
+    if (!GYRO_DEV_READ(&gyroSensor->gyroDev)) {
+        return false;
+    }
     gyroSensor->gyroDev.dataReady = false;
 
-    if (isGyroSensorCalibrationComplete(gyroSensor)) {
-        // move 16-bit gyro data into 32-bit variables to avoid overflows in calculations
+#ifdef USE_GYRO_FIFO
+    if (gyroSensor->gyroDev.fifoSampleCount) {
+        if (gyroDebugMode == DEBUG_NONE) {
+            decimateGyroFifo(&gyroSensor->gyroDev);
+        } else {
+            decimateGyroFifoDebug(&gyroSensor->gyroDev);
+        }
+    }
+#endif
 
+    return true;
+}
+
+// The raw sample less the zero offset, in the sensor's own orientation.
+// The overflow and yaw spin checks look at the raw sample in the same pass.
+static FAST_CODE void gyroRemoveZero(gyroSensor_t *gyroSensor)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        // move 16-bit gyro data into 32-bit variables to avoid overflows in calculations
 #if defined(USE_GYRO_SLEW_LIMITER)
-        gyroSensor->gyroDev.gyroADC[X] = gyroSlewLimiter(gyroSensor, X) - gyroSensor->gyroDev.gyroZero[X];
-        gyroSensor->gyroDev.gyroADC[Y] = gyroSlewLimiter(gyroSensor, Y) - gyroSensor->gyroDev.gyroZero[Y];
-        gyroSensor->gyroDev.gyroADC[Z] = gyroSlewLimiter(gyroSensor, Z) - gyroSensor->gyroDev.gyroZero[Z];
+        const int32_t raw = gyroSlewLimiter(gyroSensor, axis);
 #else
-        gyroSensor->gyroDev.gyroADC[X] = gyroSensor->gyroDev.gyroADCRaw[X] - gyroSensor->gyroDev.gyroZero[X];
-        gyroSensor->gyroDev.gyroADC[Y] = gyroSensor->gyroDev.gyroADCRaw[Y] - gyroSensor->gyroDev.gyroZero[Y];
-        gyroSensor->gyroDev.gyroADC[Z] = gyroSensor->gyroDev.gyroADCRaw[Z] - gyroSensor->gyroDev.gyroZero[Z];
+        const int32_t raw = gyroSensor->gyroDev.gyroADCRaw[axis];
 #endif
+        gyroSensor->gyroDev.gyroADC[axis] = raw - gyroSensor->gyroDev.gyroZero[axis];
 
-        if (gyroSensor->gyroDev.gyroAlign == ALIGN_CUSTOM) {
-            alignSensorViaMatrix(gyroSensor->gyroDev.gyroADC, &gyroSensor->gyroDev.rotationMatrix);
-        } else {
-            alignSensorViaRotation(gyroSensor->gyroDev.gyroADC, gyroSensor->gyroDev.gyroAlign);
+#ifdef USE_GYRO_RANGE_CHECK
+        const int32_t rawAbs = ABS(raw);
+        if (rawAbs > gyroSensor->rangeCheckRaw) {
+            gyroCheckRawRange(gyroSensor, axis, rawAbs);
         }
+#endif
+    }
+}
+
+static FAST_CODE void gyroAlignOrCalibrate(gyroSensor_t *gyroSensor)
+{
+    if (isGyroSensorCalibrationComplete(gyroSensor)) {
+        gyroRemoveZero(gyroSensor);
+        applySensorRotation(gyroSensor->gyroDev.gyroADC, &gyroSensor->gyroDev.rotation);
     } else {
         performGyroCalibration(gyroSensor, gyroConfig()->gyroMovementCalibrationThreshold);
     }
 }
 
-#define GYRO_FILTER_FUNCTION_NAME filterGyro
-#define GYRO_FILTER_DEBUG_SET(mode, index, value) { UNUSED(mode); UNUSED(index); UNUSED(value); }
-#include "gyro_filter_impl.c"
-#undef GYRO_FILTER_FUNCTION_NAME
-#undef GYRO_FILTER_DEBUG_SET
+static FAST_CODE FAST_CODE_NOINLINE void gyroUpdateSensor(gyroSensor_t *gyroSensor)
+{
+    if (gyroReadSensor(gyroSensor)) {
+        gyroAlignOrCalibrate(gyroSensor);
+    }
+}
 
-#define GYRO_FILTER_FUNCTION_NAME filterGyroDebug
-#define GYRO_FILTER_DEBUG_SET DEBUG_SET
-#include "gyro_filter_impl.c"
-#undef GYRO_FILTER_FUNCTION_NAME
-#undef GYRO_FILTER_DEBUG_SET
+#ifdef USE_MULTI_GYRO
+/*
+ * Both gyros are the same hardware, so they share the scale and their samples are summed and scaled
+ * in one pass. When they are also mounted the same way, and neither interleaving nor the dual gyro
+ * debug modes need the aligned sample of each, the sum is aligned once instead of each sample.
+ */
+static FAST_CODE FAST_CODE_NOINLINE void gyroUpdateBoth(void)
+{
+    const bool newSample1 = gyroReadSensor(&gyroSensor1);
+    const bool newSample2 = gyroReadSensor(&gyroSensor2);
+
+    if (!isGyroSensorCalibrationComplete(&gyroSensor1) || !isGyroSensorCalibrationComplete(&gyroSensor2)) {
+        if (newSample1) {
+            gyroAlignOrCalibrate(&gyroSensor1);
+        }
+        if (newSample2) {
+            gyroAlignOrCalibrate(&gyroSensor2);
+        }
+        return;
+    }
+
+    if (newSample1) {
+        gyroRemoveZero(&gyroSensor1);
+    }
+    if (newSample2) {
+        gyroRemoveZero(&gyroSensor2);
+    }
+
+    const float halfScale = 0.5f * gyro.scale;
+    if (gyroSharedAlignment) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyro.gyroADC[axis] = (gyroSensor1.gyroDev.gyroADC[axis] + gyroSensor2.gyroDev.gyroADC[axis]) * halfScale;
+        }
+        applySensorRotation(gyro.gyroADC, &gyroSensor1.gyroDev.rotation);
+    } else {
+        if (newSample1) {
+            applySensorRotation(gyroSensor1.gyroDev.gyroADC, &gyroSensor1.gyroDev.rotation);
+        }
+        if (newSample2) {
+            applySensorRotation(gyroSensor2.gyroDev.gyroADC, &gyroSensor2.gyroDev.rotation);
+        }
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyro.gyroADC[axis] = (gyroSensor1.gyroDev.gyroADC[axis] + gyroSensor2.gyroDev.gyroADC[axis]) * halfScale;
+        }
+    }
+}
+#endif
+
+static FAST_CODE void gyroFilterSample(void)
+{
+    if (gyroDebugMode == DEBUG_NONE) {
+        gyroFilterChainFn();
+    } else {
+        filterGyroDebug();
+    }
+
+#ifdef USE_GYRO_DATA_ANALYSE
+    if (isDynamicFilterActive()) {
+        gyroDataAnalyse(&gyro.gyroAnalyseState, gyro.notchFilterDyn);
+    }
+#endif
+}
+
+#ifdef USE_GYRO_INTERLEAVE
+/*
+ * Feeds the samples of both gyros to the filter chain in the order they were taken, so the
+ * filters see twice the loop rate. The gyros run from their own clocks and their phase drifts,
+ * while their samples are less than a quarter of a period apart the average is fed twice instead.
+ */
+static FAST_CODE void gyroFilterInterleaved(void)
+{
+    const gyroSensor_t *first = &gyroSensor1;
+    const gyroSensor_t *second = &gyroSensor2;
+    const timeDelta_t phaseUs = cmpTimeUs(gyroSensor2.gyroDev.dataReadyTimeUs, gyroSensor1.gyroDev.dataReadyTimeUs);
+    if (phaseUs < 0) {
+        first = &gyroSensor2;
+        second = &gyroSensor1;
+    }
+    const uint32_t offsetUs = ABS(phaseUs);
+    const bool interleave = offsetUs >= gyro.targetLooptime / 4 && offsetUs <= gyro.targetLooptime * 3 / 4
+        && isGyroSensorCalibrationComplete(&gyroSensor1) && isGyroSensorCalibrationComplete(&gyroSensor2);
+
+    DEBUG_SET(DEBUG_DUAL_GYRO_DIFF, 3, phaseUs);
+
+    float average[XYZ_AXIS_COUNT];
+    memcpy(average, gyro.gyroADC, sizeof(average));
+
+    for (int i = 0; i < 2; i++) {
+        const gyroSensor_t *gyroSensor = i ? second : first;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyro.gyroADC[axis] = interleave ? gyroSensor->gyroDev.gyroADC[axis] * gyroSensor->gyroDev.scale : average[axis];
+        }
+        gyroFilterSample();
+    }
+}
+#endif
+
+#ifdef USE_GYRO_ODR_TRACKING
+static void gyroTrackOdr(const gyroDev_t *gyroDev)
+{
+    // the loop runs on every (mpuDividerDrops + 1)th sample of the gyro
+    const float nominalSamplePeriodUs = (float)gyro.targetLooptime / (gyroDev->mpuDividerDrops + 1);
+    if (gyroSyncTrackOdr(&gyroOdrTracker, gyroDev, nominalSamplePeriodUs)) {
+        gyro.odrScale = gyroOdrTracker.samplePeriodUs / nominalSamplePeriodUs;
+        pidSetLooptimeScale(gyro.odrScale);
+    }
+}
+#endif
 
 FAST_CODE void gyroUpdate(timeUs_t currentTimeUs)
 {
+    TRACE_EVENT(TRACE_GYRO_SAMPLE, 0, 0);
 
     switch (gyroToUse) {
     case GYRO_CONFIG_USE_GYRO_1:
@@ -1067,28 +1806,31 @@ FAST_CODE void gyroUpdate(timeUs_t currentTimeUs)
         }
         break;
     case GYRO_CONFIG_USE_GYRO_BOTH:
-        gyroUpdateSensor(&gyroSensor1);
-        gyroUpdateSensor(&gyroSensor2);
-        if (isGyroSensorCalibrationComplete(&gyroSensor1) && isGyroSensorCalibrationComplete(&gyroSensor2)) {
-            gyro.gyroADC[X] = ((gyroSensor1.gyroDev.gyroADC[X] * gyroSensor1.gyroDev.scale) + (gyroSensor2.gyroDev.gyroADC[X] * gyroSensor2.gyroDev.scale)) / 2.0f;
-            gyro.gyroADC[Y] = ((gyroSensor1.gyroDev.gyroADC[Y] * gyroSensor1.gyroDev.scale) + (gyroSensor2.gyroDev.gyroADC[Y] * gyroSensor2.gyroDev.scale)) / 2.0f;
-            gyro.gyroADC[Z] = ((gyroSensor1.gyroDev.gyroADC[Z] * gyroSensor1.gyroDev.scale) + (gyroSensor2.gyroDev.gyroADC[Z] * gyroSensor2.gyroDev.scale)) / 2.0f;
-        }
+        gyroUpdateBoth();
         break;
 #endif
     }
 
-    if (gyroDebugMode == DEBUG_NONE) {
-        filterGyro();
-    } else {
-        filterGyroDebug();
-    }
+#ifdef USE_GYRO_ODR_TRACKING
+#ifdef USE_MULTI_GYRO
+    gyroTrackOdr(gyroToUse == GYRO_CONFIG_USE_GYRO_2 ? &gyroSensor2.gyroDev : &gyroSensor1.gyroDev);
+#else
+    gyroTrackOdr(&gyroSensor1.gyroDev);
+#endif
+#endif
 
-#ifdef USE_GYRO_DATA_ANALYSE
-    if (isDynamicFilterActive()) {
-        gyroDataAnalyse(&gyro.gyroAnalyseState, gyro.notchFilterDyn, gyro.notchFilterDyn2);
+    if (gyro.filterCrossfadeActive) {
+        gyroStepFilterCrossfades();
     }
+
+#ifdef USE_GYRO_INTERLEAVE
+    if (gyro.interleaved) {
+        gyroFilterInterleaved();
+    } else
 #endif
+    {
+        gyroFilterSample();
+    }
 
     if (useDualGyroDebugging) {
         switch (gyroToUse) {
@@ -1136,6 +1878,11 @@ FAST_CODE void gyroUpdate(timeUs_t currentTimeUs)
     }
 #endif
 
+#ifdef USE_GYRO_RANGE_CHECK
+    gyroRangeFlags = 0;
+    gyroOverflowAxes = 0;
+#endif
+
     if (!overflowDetected) {
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
             // integrate using trapezium rule to avoid bias
@@ -1240,22 +1987,34 @@ float dynThrottle(float throttle) {
     return throttle * (1 - (throttle * throttle) / 3.0f) * 1.5f;
 }
 
-void dynLpfGyroUpdate(float throttle)
+uint16_t dynLpfCutoffHz(int throttleStep, uint16_t minHz, uint16_t maxHz)
+{
+    return fmax(dynThrottle((float)throttleStep / DYN_LPF_THROTTLE_STEPS) * maxHz, minHz);
+}
+
+// Calculates the coefficients for every throttle step, so that following the throttle is a table lookup
+void dynLpfCoeffsInit(dynLpfCoeffs_t *coeffs, uint8_t filterType, uint16_t minHz, uint16_t maxHz, uint32_t looptimeUs)
+{
+    for (int step = 0; step <= DYN_LPF_THROTTLE_STEPS; step++) {
+        const uint16_t cutoffHz = dynLpfCutoffHz(step, minHz, maxHz);
+        if (filterType == DYN_LPF_PT1) {
+            coeffs[step].pt1Gain = pt1FilterGain(cutoffHz, looptimeUs * 1e-6f);
+        } else if (filterType == DYN_LPF_BIQUAD) {
+            biquadLowpassCoeffsInit(&coeffs[step].biquad, cutoffHz, looptimeUs);
+        }
+    }
+}
+
+void dynLpfGyroUpdate(int throttleStep)
 {
     if (dynLpfFilter != DYN_LPF_NONE) {
-        const unsigned int cutoffFreq = fmax(dynThrottle(throttle) * dynLpfMax, dynLpfMin);
+        throttleStep = constrain(throttleStep, 0, DYN_LPF_THROTTLE_STEPS);
+        DEBUG_SET(DEBUG_DYN_LPF, 2, dynLpfCutoffHz(throttleStep, dynLpfMin, dynLpfMax));
 
         if (dynLpfFilter == DYN_LPF_PT1) {
-            DEBUG_SET(DEBUG_DYN_LPF, 2, cutoffFreq);
-            const float gyroDt = gyro.targetLooptime * 1e-6f;
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                pt1FilterUpdateCutoff(&gyro.lowpassFilter[axis].pt1FilterState, pt1FilterGain(cutoffFreq, gyroDt));
-            }
+            pt1Filter3UpdateCutoff(&gyro.lowpassFilter.pt1FilterState, dynLpfCoeffs[throttleStep].pt1Gain);
         } else if (dynLpfFilter == DYN_LPF_BIQUAD) {
-            DEBUG_SET(DEBUG_DYN_LPF, 2, cutoffFreq);
-            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-                biquadFilterUpdateLPF(&gyro.lowpassFilter[axis].biquadFilterState, cutoffFreq, gyro.targetLooptime);
-            }
+            biquadFilter3SetLowpassCoeffs(&gyro.lowpassFilter.biquadFilterState, &dynLpfCoeffs[throttleStep].biquad);
         }
     }
 }
@@ -37,39 +37,63 @@
 #define FILTER_FREQUENCY_MAX 4000 // maximum frequency for filter cutoffs (nyquist limit of 8K max sampling)
 
 typedef union gyroLowpassFilter_u {
-    pt1Filter_t pt1FilterState;
-    biquadFilter_t biquadFilterState;
+    pt1Filter3_t pt1FilterState;
+    biquadFilter3_t biquadFilterState;
 } gyroLowpassFilter_t;
 
+typedef union gyroLowpassCrossfade_u {
+    pt1Crossfade_t pt1Crossfade;
+    biquadCrossfade_t biquadCrossfade;
+} gyroLowpassCrossfade_t;
+
+typedef enum {
+    GYRO_FILTER_STAGE_NONE = 0,
+    GYRO_FILTER_STAGE_PT1,
+    GYRO_FILTER_STAGE_BIQUAD,       // direct form 2 transposed, for fixed coefficients
+    GYRO_FILTER_STAGE_BIQUAD_DF1,   // direct form 1, the coefficients may be updated while running
+} gyroFilterStage_e;
+
 typedef struct gyro_s {
     uint32_t targetLooptime;
+    uint32_t filterLooptime;           // time between the samples the filter chain sees, half the loop time when interleaved
+    bool interleaved;                  // both gyros are fed to the filter chain in turn, see gyro_interleave
     float scale;
     float gyroADC[XYZ_AXIS_COUNT];     // aligned, calibrated, scaled, but unfiltered data from the sensor(s)
     float gyroADCf[XYZ_AXIS_COUNT];    // filtered gyro data
 
     gyroDev_t *rawSensorDev;           // pointer to the sensor providing the raw data for DEBUG_GYRO_RAW
+#ifdef USE_GYRO_ODR_TRACKING
+    float odrScale;                    // measured over nominal sample period, see gyroSyncTrackOdr()
+#endif
 
     // lowpass gyro soft filter
-    filterApplyFnPtr lowpassFilterApplyFn;
-    gyroLowpassFilter_t lowpassFilter[XYZ_AXIS_COUNT];
+    gyroFilterStage_e lowpassFilterStage;
+    gyroLowpassFilter_t lowpassFilter;
 
     // lowpass2 gyro soft filter
-    filterApplyFnPtr lowpass2FilterApplyFn;
-    gyroLowpassFilter_t lowpass2Filter[XYZ_AXIS_COUNT];
+    gyroFilterStage_e lowpass2FilterStage;
+    gyroLowpassFilter_t lowpass2Filter;
 
-    // notch filters
-    filterApplyFnPtr notchFilter1ApplyFn;
-    biquadFilter_t notchFilter1[XYZ_AXIS_COUNT];
+    // static notch filters, biquad direct form 2 when enabled
+    bool notchFilter1Enabled;
+    biquadFilter3_t notchFilter1;
 
-    filterApplyFnPtr notchFilter2ApplyFn;
-    biquadFilter_t notchFilter2[XYZ_AXIS_COUNT];
+    bool notchFilter2Enabled;
+    biquadFilter3_t notchFilter2;
 
-    filterApplyFnPtr notchFilterDynApplyFn;
-    filterApplyFnPtr notchFilterDynApplyFn2;
-    biquadFilter_t notchFilterDyn[XYZ_AXIS_COUNT];
-    biquadFilter_t notchFilterDyn2[XYZ_AXIS_COUNT];
+    // coefficient crossfades of the filters above, started by gyroRetuneFilters()
+    bool filterCrossfadeActive;
+    uint16_t filterCrossfadeSteps;
+    gyroLowpassCrossfade_t lowpassCrossfade;
+    gyroLowpassCrossfade_t lowpass2Crossfade;
+    biquadCrossfade_t notchFilter1Crossfade;
+    biquadCrossfade_t notchFilter2Crossfade;
 
 #ifdef USE_GYRO_DATA_ANALYSE
+    // the dynamic notches track separate frequencies on each axis, biquad direct form 1
+    uint8_t notchFilterDynCount;
+    biquadFilter_t notchFilterDyn[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+
     gyroAnalyseState_t gyroAnalyseState;
 #endif
 } gyro_t;
@@ -89,6 +113,13 @@ enum {
     DYN_NOTCH_RANGE_AUTO
 };
 
+typedef enum {
+    DYN_NOTCH_WINDOW_SIZE_32 = 0,
+    DYN_NOTCH_WINDOW_SIZE_64,
+    DYN_NOTCH_WINDOW_SIZE_128,
+    DYN_NOTCH_WINDOW_SIZE_256
+} dynamicFilterWindowSize_e;
+
 #define DYN_NOTCH_RANGE_HZ_HIGH 2000
 #define DYN_NOTCH_RANGE_HZ_MEDIUM 1333
 #define DYN_NOTCH_RANGE_HZ_LOW 1000
@@ -151,21 +182,43 @@ typedef struct gyroConfig_s {
     uint8_t  dyn_notch_width_percent;
     uint16_t dyn_notch_q;
     uint16_t dyn_notch_min_hz;
+    uint8_t  dyn_notch_window_size;      // number of downsampled gyro samples analysed, a larger window gives a finer frequency resolution
+    uint8_t  dyn_notch_count;            // number of peaks tracked per axis, each with its own notch
     uint8_t  gyro_filter_debug_axis;
+    uint8_t  gyro_spi_dma;              // read the gyro with a non-blocking SPI DMA transfer on each data ready interrupt
+    uint8_t  gyro_fifo;                 // batch read the samples queued in the gyro FIFO and decimate them to the loop rate
+    uint8_t  gyro_interleave;           // with both gyros, filter their samples in turn at twice the loop rate instead of averaging them
 } gyroConfig_t;
 
 PG_DECLARE(gyroConfig_t, gyroConfig);
 
+#ifdef USE_GYRO_CALIBRATION_STORE
+#define GYRO_CALIBRATION_STORE_COUNT 2
+
+// Offsets of the last calibration, tagged with the gyro temperature they were taken at
+typedef struct gyroCalibrationConfig_s {
+    uint8_t  temperatureTolerance;      // boot uses the stored offsets if the gyro is within this many degrees of their temperature, 0 = off
+    uint8_t  storedSensors;             // bit per gyro sensor that has stored offsets
+    int16_t  temperature[GYRO_CALIBRATION_STORE_COUNT];
+    float    zero[GYRO_CALIBRATION_STORE_COUNT][XYZ_AXIS_COUNT];
+} gyroCalibrationConfig_t;
+
+PG_DECLARE(gyroCalibrationConfig_t, gyroCalibrationConfig);
+#endif
+
 void gyroPreInit(void);
 bool gyroInit(void);
 
 void gyroInitFilters(void);
+void gyroRetuneFilters(void);
 void gyroUpdate(timeUs_t currentTimeUs);
 bool gyroGetAccumulationAverage(float *accumulation);
 const busDevice_t *gyroSensorBus(void);
 struct mpuDetectionResult_s;
 const struct mpuDetectionResult_s *gyroMpuDetectionResult(void);
 void gyroStartCalibration(bool isFirstArmingCalibration);
+bool gyroRestoreCalibration(void);
+void gyroCalibrationStoreUpdate(void);
 bool isFirstArmingGyroCalibrationRunning(void);
 bool isGyroCalibrationComplete(void);
 void gyroReadTemperature(void);
@@ -176,7 +229,28 @@ bool gyroYawSpinDetected(void);
 uint16_t gyroAbsRateDps(int axis);
 uint8_t gyroReadRegister(uint8_t whichSensor, uint8_t reg);
 gyroDetectionFlags_t getGyroDetectionFlags(void);
+#ifdef USE_PID_LOOP_INTERRUPT
+bool gyroSetDataReadyCallback(sensorGyroDataReadyFuncPtr callback);
+#endif
+#ifdef USE_LOOP_TIMING
+timeUs_t gyroGetDataReadyTimeUs(void);
+#endif
+#ifdef USE_GYRO_SPI_DMA
+struct gyroSpiDma_s;
+struct gyroSpiDma_s *gyroSpiDmaStart(void);
+bool gyroIsReadByDma(void);
+#endif
 #ifdef USE_DYN_LPF
+#define DYN_LPF_THROTTLE_STEPS 100  // the dynamic lowpass cutoffs follow the throttle in 1% steps
+
+// the coefficients of a dynamic lowpass at one throttle step, precomputed for every step
+typedef union dynLpfCoeffs_u {
+    float pt1Gain;
+    biquadLowpassCoeffs_t biquad;
+} dynLpfCoeffs_t;
+
 float dynThrottle(float throttle);
-void dynLpfGyroUpdate(float throttle);
+uint16_t dynLpfCutoffHz(int throttleStep, uint16_t minHz, uint16_t maxHz);
+void dynLpfCoeffsInit(dynLpfCoeffs_t *coeffs, uint8_t filterType, uint16_t minHz, uint16_t maxHz, uint32_t looptimeUs);
+void dynLpfGyroUpdate(int throttleStep);
 #endif
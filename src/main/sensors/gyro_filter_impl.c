@@ -18,54 +18,102 @@
  * If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+ * Template for the gyro filter chain, included once per variant by gyro.c.
+ *
+ * GYRO_FILTER_FUNCTION_NAME        name of the filter chain function
+ * GYRO_FILTER_DEBUG_SET            DEBUG_SET, or a no-op for the variants used without a debug mode
+ * GYRO_FILTER_RPM                  whether the chain includes the RPM filter
+ * GYRO_FILTER_DYN_NOTCH            whether the chain includes the dynamic notches
+ * GYRO_FILTER_STATIC_NOTCH         whether the chain checks for the static notches
+ * GYRO_FILTER_LOWPASS_STAGE        gyroFilterStage_e of lowpass 1 and 2, either a constant
+ * GYRO_FILTER_LOWPASS2_STAGE       for a specialised variant or the configured stage
+ * GYRO_FIFO_DECIMATE_FUNCTION_NAME optional, name of the FIFO batch decimation function
+ *
+ * Stages whose condition is a compile time constant cost nothing when disabled.
+ */
+
 #include "platform.h"
 
+#if defined(USE_GYRO_FIFO) && defined(GYRO_FIFO_DECIMATE_FUNCTION_NAME)
+// Reduces the batch of samples read from the gyro FIFO to a single sample at the loop rate.
+// Averaging the batch is a boxcar decimation filter, unlike keeping only the latest
+// sample it does not alias the noise above the loop Nyquist frequency into the passband.
+static FAST_CODE void GYRO_FIFO_DECIMATE_FUNCTION_NAME(gyroDev_t *gyroDev)
+{
+    const int sampleCount = gyroDev->fifoSampleCount;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        int32_t sum = 0;
+        for (int i = 0; i < sampleCount; i++) {
+            sum += gyroDev->fifoADCRaw[i][axis];
+        }
+        gyroDev->gyroADCRaw[axis] = lrintf((float)sum / sampleCount);
+    }
+    GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_FIFO, 0, sampleCount);
+    GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_FIFO, 1, gyroDev->fifoADCRaw[sampleCount - 1][gyroDebugAxis]);
+    GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_FIFO, 2, gyroDev->gyroADCRaw[gyroDebugAxis]);
+
+    gyroDev->fifoSampleCount = 0;
+}
+#endif
+
 static FAST_CODE void GYRO_FILTER_FUNCTION_NAME(void)
 {
+    float gyroADCf[XYZ_AXIS_COUNT];
+
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_RAW, axis, gyro.rawSensorDev->gyroADCRaw[axis]);
         // scale gyro output to degrees per second
-        float gyroADCf = gyro.gyroADC[axis];
+        gyroADCf[axis] = gyro.gyroADC[axis];
         // DEBUG_GYRO_SCALED records the unfiltered, scaled gyro output
-        GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_SCALED, axis, lrintf(gyroADCf));
+        GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_SCALED, axis, lrintf(gyroADCf[axis]));
 
 #ifdef USE_GYRO_DATA_ANALYSE
-        if (isDynamicFilterActive()) {
+        if (GYRO_FILTER_DYN_NOTCH) {
             if (axis == gyroDebugAxis) {
-                GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 0, lrintf(gyroADCf));
-                GYRO_FILTER_DEBUG_SET(DEBUG_FFT_FREQ, 3, lrintf(gyroADCf));
-                GYRO_FILTER_DEBUG_SET(DEBUG_DYN_LPF, 0, lrintf(gyroADCf));
+                GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 0, lrintf(gyroADCf[axis]));
+                GYRO_FILTER_DEBUG_SET(DEBUG_FFT_FREQ, 3, lrintf(gyroADCf[axis]));
+                GYRO_FILTER_DEBUG_SET(DEBUG_DYN_LPF, 0, lrintf(gyroADCf[axis]));
             }
         }
 #endif
 
 #ifdef USE_RPM_FILTER
-        gyroADCf = rpmFilterGyro(axis, gyroADCf);
+        if (GYRO_FILTER_RPM) {
+            gyroADCf[axis] = rpmFilterGyro(axis, gyroADCf[axis]);
+        }
 #endif
+    }
 
+    // apply static notch filters and software lowpass filters, each stage filters all three axes
+    if (GYRO_FILTER_STATIC_NOTCH && gyro.notchFilter1Enabled) {
+        biquadFilter3Apply(&gyro.notchFilter1, gyroADCf);
+    }
+    if (GYRO_FILTER_STATIC_NOTCH && gyro.notchFilter2Enabled) {
+        biquadFilter3Apply(&gyro.notchFilter2, gyroADCf);
+    }
+    gyroLowpassFilterApply(GYRO_FILTER_LOWPASS_STAGE, &gyro.lowpassFilter, gyroADCf);
+    gyroLowpassFilterApply(GYRO_FILTER_LOWPASS2_STAGE, &gyro.lowpass2Filter, gyroADCf);
 
-        // apply static notch filters and software lowpass filters
-        gyroADCf = gyro.notchFilter1ApplyFn((filter_t *)&gyro.notchFilter1[axis], gyroADCf);
-        gyroADCf = gyro.notchFilter2ApplyFn((filter_t *)&gyro.notchFilter2[axis], gyroADCf);
-        gyroADCf = gyro.lowpassFilterApplyFn((filter_t *)&gyro.lowpassFilter[axis], gyroADCf);
-        gyroADCf = gyro.lowpass2FilterApplyFn((filter_t *)&gyro.lowpass2Filter[axis], gyroADCf);
-
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
 #ifdef USE_GYRO_DATA_ANALYSE
-        if (isDynamicFilterActive()) {
+        if (GYRO_FILTER_DYN_NOTCH) {
             if (axis == gyroDebugAxis) {
-                GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 1, lrintf(gyroADCf));
-                GYRO_FILTER_DEBUG_SET(DEBUG_FFT_FREQ, 2, lrintf(gyroADCf));
-                GYRO_FILTER_DEBUG_SET(DEBUG_DYN_LPF, 3, lrintf(gyroADCf));
+                GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 1, lrintf(gyroADCf[axis]));
+                GYRO_FILTER_DEBUG_SET(DEBUG_FFT_FREQ, 2, lrintf(gyroADCf[axis]));
+                GYRO_FILTER_DEBUG_SET(DEBUG_DYN_LPF, 3, lrintf(gyroADCf[axis]));
+            }
+            gyroDataAnalysePush(&gyro.gyroAnalyseState, axis, gyroADCf[axis]);
+            for (int i = 0; i < gyro.notchFilterDynCount; i++) {
+                gyroADCf[axis] = biquadFilterApplyDF1(&gyro.notchFilterDyn[axis][i], gyroADCf[axis]);
             }
-            gyroDataAnalysePush(&gyro.gyroAnalyseState, axis, gyroADCf);
-            gyroADCf = gyro.notchFilterDynApplyFn((filter_t *)&gyro.notchFilterDyn[axis], gyroADCf);
-            gyroADCf = gyro.notchFilterDynApplyFn2((filter_t *)&gyro.notchFilterDyn2[axis], gyroADCf);
         }
 #endif
 
         // DEBUG_GYRO_FILTERED records the scaled, filtered, after all software filtering has been applied.
-        GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_FILTERED, axis, lrintf(gyroADCf));
+        GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_FILTERED, axis, lrintf(gyroADCf[axis]));
 
-        gyro.gyroADCf[axis] = gyroADCf;
+        gyro.gyroADCf[axis] = gyroADCf[axis];
     }
 }
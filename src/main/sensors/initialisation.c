@@ -72,21 +72,49 @@ bool sensorsAutodetect(void)
     }
 #endif
 
+#ifdef USE_ADC_INTERNAL
+    adcInternalInit();
+#endif
+
+    return gyroDetected;
+}
+
+#ifdef USE_GYRO_SPI_DMA
+// The gyro DMA needs a bus of its own, so this is only called once every device has been set to its bus
+void sensorsGyroSpiDmaStart(void)
+{
+    if (!sensors(SENSOR_GYRO)) {
+        return;
+    }
+#ifdef USE_ACC
+    if (accCanUseGyroSpiDma()) {
+        accSetGyroSpiDma(gyroSpiDmaStart());
+    }
+#else
+    gyroSpiDmaStart();
+#endif
+}
+#endif
+
+// The auxiliary sensors are detected separately, the flight loop does not need them to start
+
+void sensorsAutodetectMag(void)
+{
 #ifdef USE_MAG
     compassInit();
 #endif
+}
 
+void sensorsAutodetectBaro(void)
+{
 #ifdef USE_BARO
     baroDetect(&baro.dev, barometerConfig()->baro_hardware);
 #endif
+}
 
+void sensorsAutodetectRangefinder(void)
+{
 #ifdef USE_RANGEFINDER
     rangefinderInit();
 #endif
-
-#ifdef USE_ADC_INTERNAL
-    adcInternalInit();
-#endif
-
-    return gyroDetected;
 }
@@ -22,3 +22,7 @@
 
 void sensorsPreInit(void);
 bool sensorsAutodetect(void);
+void sensorsAutodetectMag(void);
+void sensorsAutodetectBaro(void);
+void sensorsAutodetectRangefinder(void);
+void sensorsGyroSpiDmaStart(void);
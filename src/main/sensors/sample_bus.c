@@ -0,0 +1,101 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "sensors/sample_bus.h"
+
+#define SAMPLE_READ_ATTEMPTS 4
+
+// keep the compiler from moving the copy of the sample across the sequence updates
+#define SAMPLE_BARRIER() __asm__ volatile ("" : : : "memory")
+
+typedef union samplePayload_u {
+    attitudeSample_t attitude;
+    altitudeSample_t altitude;
+    batterySample_t battery;
+    gpsSample_t gps;
+} samplePayload_t;
+
+typedef struct sampleSlot_s {
+    volatile uint32_t sequence;     // odd while a publish is in progress
+    volatile bool published;
+    timeUs_t timeUs;
+    samplePayload_t payload;
+} sampleSlot_t;
+
+static const uint8_t sampleSize[SAMPLE_TOPIC_COUNT] = {
+    [SAMPLE_ATTITUDE] = sizeof(attitudeSample_t),
+    [SAMPLE_ALTITUDE] = sizeof(altitudeSample_t),
+    [SAMPLE_BATTERY] = sizeof(batterySample_t),
+    [SAMPLE_GPS] = sizeof(gpsSample_t),
+};
+
+static sampleSlot_t sampleSlots[SAMPLE_TOPIC_COUNT];
+
+void samplePublish(sampleTopic_e topic, const void *sample, timeUs_t timeUs)
+{
+    sampleSlot_t *slot = &sampleSlots[topic];
+
+    slot->sequence++;
+    SAMPLE_BARRIER();
+    slot->timeUs = timeUs;
+    memcpy(&slot->payload, sample, sampleSize[topic]);
+    SAMPLE_BARRIER();
+    slot->sequence++;
+    slot->published = true;
+}
+
+// Returns false, leaving sample and timeUs as they were, if the topic has not been published yet
+// or a publish kept it busy for all the attempts
+bool sampleRead(sampleTopic_e topic, void *sample, timeUs_t *timeUs)
+{
+    const sampleSlot_t *slot = &sampleSlots[topic];
+    samplePayload_t payload;
+
+    if (!slot->published) {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < SAMPLE_READ_ATTEMPTS; attempt++) {
+        const uint32_t sequence = slot->sequence;
+        if (sequence & 1) {
+            continue;
+        }
+        SAMPLE_BARRIER();
+        memcpy(&payload, &slot->payload, sampleSize[topic]);
+        const timeUs_t sampleTimeUs = slot->timeUs;
+        SAMPLE_BARRIER();
+        if (slot->sequence == sequence) {
+            memcpy(sample, &payload, sampleSize[topic]);
+            if (timeUs) {
+                *timeUs = sampleTimeUs;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
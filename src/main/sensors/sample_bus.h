@@ -0,0 +1,77 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Timestamped sensor samples shared between the tasks that produce them and the ones that use them.
+ *
+ * Each topic holds the latest sample of one producer. Publishing copies the sample into the slot of
+ * the topic under a sequence lock, the sequence is odd while the copy is in progress. Reading copies
+ * the sample out and retries if the sequence was odd or changed meanwhile, so a reader gets the
+ * values of a single update together with the time it was sampled, without blocking the producer.
+ *
+ * A reader that preempts a producer in the middle of a publish cannot wait for it, so reads give up
+ * after a few attempts and return false, an interrupt handler must keep its last good copy instead.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+typedef enum {
+    SAMPLE_ATTITUDE = 0,
+    SAMPLE_ALTITUDE,
+    SAMPLE_BATTERY,
+    SAMPLE_GPS,
+    SAMPLE_TOPIC_COUNT
+} sampleTopic_e;
+
+typedef struct attitudeSample_s {
+    int16_t roll;                   // decidegrees
+    int16_t pitch;                  // decidegrees
+    int16_t yaw;                    // decidegrees, 0..3599
+} attitudeSample_t;
+
+typedef struct altitudeSample_s {
+    int32_t estimatedAltitudeCm;
+    int16_t varioCms;
+} altitudeSample_t;
+
+typedef struct batterySample_s {
+    uint16_t voltage;               // 0.01V
+    int32_t amperage;               // 0.01A
+    int32_t mAhDrawn;
+} batterySample_t;
+
+typedef struct gpsSample_s {
+    int32_t lat;                    // degrees * 1e7
+    int32_t lon;                    // degrees * 1e7
+    int32_t altCm;                  // MSL
+    uint16_t groundSpeed;           // as in gpsSol_t
+    uint16_t groundCourse;          // as in gpsSol_t, decidegrees
+    uint8_t numSat;
+    bool fix;
+} gpsSample_t;
+
+void samplePublish(sampleTopic_e topic, const void *sample, timeUs_t timeUs);
+bool sampleRead(sampleTopic_e topic, void *sample, timeUs_t *timeUs);
@@ -468,7 +468,8 @@ void SystemInitPLLParameters(void)
     uint32_t currentOverclockLevel = persistentObjectRead(PERSISTENT_OBJECT_OVERCLOCK_LEVEL);
 
     if (currentOverclockLevel >= ARRAYLEN(overclockLevels)) {
-      return;
+      // Unknown level, run at the rated clock rather than with PLL parameters left unset
+      currentOverclockLevel = 0;
     }
 
     const pllConfig_t * const pll = overclockLevels + currentOverclockLevel;
@@ -494,6 +495,11 @@ void OverclockRebootIfNecessary(uint32_t overclockLevel)
   }
 }
 
+uint32_t SystemFlashLatency(uint32_t sysclkMhz)
+{
+    return (sysclkMhz - 1) / 30;
+}
+
 void systemClockSetHSEValue(uint32_t frequency)
 {
     uint32_t hse_value = persistentObjectRead(PERSISTENT_OBJECT_HSE_VALUE);
@@ -796,15 +802,9 @@ void SetSysClock(void)
     }
 #endif /* STM32F427_437x || STM32F429_439xx || STM32F446xx || STM32F469_479xx */
 
-#if defined(STM32F40_41xxx) || defined(STM32F427_437xx) || defined(STM32F429_439xx) || defined(STM32F446xx) || defined(STM32F469_479xx)
-    /* Configure Flash prefetch, Instruction cache, Data cache and wait state */
-    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN |FLASH_ACR_DCEN |FLASH_ACR_LATENCY_5WS;
-#endif /* STM32F40_41xxx || STM32F427_437x || STM32F429_439xx  || STM32F446xx || STM32F469_479xx */
-
-#if defined(STM32F401xx) || defined(STM32F410xx) || defined(STM32F411xE)
     /* Configure Flash prefetch, Instruction cache, Data cache and wait state */
-    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN |FLASH_ACR_DCEN |FLASH_ACR_LATENCY_2WS;
-#endif /* STM32F401xx || STM32F410xx || STM32F411xE*/
+    // One wait state per 30MHz of SYSCLK at 2.7V to 3.6V, overclocked levels included
+    FLASH->ACR = FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN | SystemFlashLatency(pll_input * pll_n / pll_p);
 
     /* Select the main PLL as system clock source */
     RCC->CFGR &= (uint32_t)((uint32_t)~(RCC_CFGR_SW));
@@ -39,6 +39,7 @@ extern void OverclockRebootIfNecessary(uint32_t overclockLevel);
 extern void systemClockSetHSEValue(uint32_t frequency);
 extern int SystemSYSCLKSource(void);
 extern int SystemPLLSource(void);
+extern uint32_t SystemFlashLatency(uint32_t sysclkMhz);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,195 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "shmlink.h"
+
+#define SHM_LINK_SPIN_COUNT  2000   // polls before the reader goes to sleep
+
+static void shmRingSleep(shmRing_t *ring, uint32_t head, const struct timespec *timeout)
+{
+#ifdef __linux__
+    // returns at once if head has already moved on
+    syscall(SYS_futex, &ring->head, FUTEX_WAIT, head, timeout, NULL, 0);
+#else
+    (void)ring;
+    (void)head;
+    (void)timeout;
+    const struct timespec poll = { .tv_sec = 0, .tv_nsec = 50000 };
+    nanosleep(&poll, NULL);
+#endif
+}
+
+static void shmRingWake(shmRing_t *ring)
+{
+#ifdef __linux__
+    if (atomic_load(&ring->waiting)) {
+        syscall(SYS_futex, &ring->head, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+#else
+    (void)ring;
+#endif
+}
+
+static uint64_t shmNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Wait until the producer moves head past tail, false on timeout
+static bool shmRingWait(shmRing_t *ring, uint32_t tail, uint32_t timeout_ms)
+{
+    for (int i = 0; i < SHM_LINK_SPIN_COUNT; i++) {
+        if (atomic_load_explicit(&ring->head, memory_order_acquire) != tail) {
+            return true;
+        }
+    }
+
+    const uint64_t deadline = shmNowNs() + timeout_ms * 1000000ULL;
+    bool ready = false;
+
+    atomic_store(&ring->waiting, 1);
+    while (!ready) {
+        const uint64_t now = shmNowNs();
+        if (now >= deadline) {
+            break;
+        }
+        const uint64_t remaining = deadline - now;
+        const struct timespec timeout = {
+            .tv_sec = remaining / 1000000000ULL,
+            .tv_nsec = remaining % 1000000000ULL,
+        };
+        shmRingSleep(ring, tail, &timeout);
+        ready = atomic_load_explicit(&ring->head, memory_order_acquire) != tail;
+    }
+    atomic_store(&ring->waiting, 0);
+
+    return ready || atomic_load_explicit(&ring->head, memory_order_acquire) != tail;
+}
+
+int shmLinkInit(shmLink_t *link, const char *name, bool isServer)
+{
+    memset(link, 0, sizeof(*link));
+
+    const int fd = shm_open(name, isServer ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+    if (fd == -1) {
+        return -1;
+    }
+
+    if (isServer && ftruncate(fd, sizeof(shmLinkShared_t)) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, sizeof(shmLinkShared_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    shmLinkShared_t *shared = base;
+    if (isServer) {
+        memset(shared, 0, sizeof(*shared));
+        shared->version = SHM_LINK_VERSION;
+        atomic_thread_fence(memory_order_release);
+        shared->magic = SHM_LINK_MAGIC;
+    } else if (shared->magic != SHM_LINK_MAGIC || shared->version != SHM_LINK_VERSION) {
+        munmap(base, sizeof(shmLinkShared_t));
+        return -2;
+    }
+
+    link->shared = shared;
+    link->isServer = isServer;
+    link->rx = isServer ? &shared->toServer : &shared->toClient;
+    link->tx = isServer ? &shared->toClient : &shared->toServer;
+
+    return 0;
+}
+
+int shmLinkRecv(shmLink_t *link, void *data, size_t size, uint32_t timeout_ms)
+{
+    shmRing_t *ring = link->rx;
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (atomic_load_explicit(&ring->head, memory_order_acquire) == tail && !shmRingWait(ring, tail, timeout_ms)) {
+        return -1;
+    }
+
+    const uint32_t index = tail & (SHM_LINK_SLOT_COUNT - 1);
+    size_t length = ring->length[index];
+    if (length > size) {
+        length = size;
+    }
+    memcpy(data, ring->slot[index], length);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return length;
+}
+
+int shmLinkSend(shmLink_t *link, const void *data, size_t size)
+{
+    shmRing_t *ring = link->tx;
+
+    if (size > SHM_LINK_SLOT_SIZE) {
+        return -1;
+    }
+
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= SHM_LINK_SLOT_COUNT) {
+        return -1; // reader is not keeping up, drop like a datagram
+    }
+
+    const uint32_t index = head & (SHM_LINK_SLOT_COUNT - 1);
+    memcpy(ring->slot[index], data, size);
+    ring->length[index] = size;
+    // sequentially consistent so the store cannot pass the load of waiting below
+    atomic_store(&ring->head, head + 1);
+    shmRingWake(ring);
+
+    return size;
+}
+
+void shmLinkClose(shmLink_t *link, const char *name)
+{
+    if (!link->shared) {
+        return;
+    }
+
+    munmap(link->shared, sizeof(shmLinkShared_t));
+    if (link->isServer) {
+        shm_unlink(name);
+    }
+    link->shared = NULL;
+}
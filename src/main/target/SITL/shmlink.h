@@ -0,0 +1,65 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Shared memory transport between SITL and a simulator on the same host.
+// The segment holds two single producer / single consumer rings, one per
+// direction, so a packet costs a copy and two atomic stores instead of a
+// socket syscall. A reader that finds its ring empty spins briefly and then
+// sleeps on a futex, which the writer only wakes when somebody is waiting.
+
+#define SHM_LINK_NAME        "/betaflight_sitl"
+#define SHM_LINK_MAGIC       0x4246534d // "BFSM"
+#define SHM_LINK_VERSION     1
+#define SHM_LINK_SLOT_COUNT  16         // power of two
+#define SHM_LINK_SLOT_SIZE   256        // large enough for fdm_packet and servo_packet
+
+typedef struct shmRing_s {
+    _Atomic uint32_t head;      // next slot to write, only advanced by the producer
+    _Atomic uint32_t tail;      // next slot to read, only advanced by the consumer
+    _Atomic uint32_t waiting;   // consumer is (about to be) asleep on head
+    uint32_t length[SHM_LINK_SLOT_COUNT];
+    uint8_t slot[SHM_LINK_SLOT_COUNT][SHM_LINK_SLOT_SIZE];
+} shmRing_t;
+
+typedef struct shmLinkShared_s {
+    uint32_t magic;
+    uint32_t version;
+    shmRing_t toServer;         // simulator -> SITL, fdm_packet
+    shmRing_t toClient;         // SITL -> simulator, servo_packet
+} shmLinkShared_t;
+
+typedef struct shmLink_s {
+    shmLinkShared_t *shared;
+    shmRing_t *rx;
+    shmRing_t *tx;
+    bool isServer;
+} shmLink_t;
+
+int shmLinkInit(shmLink_t *link, const char *name, bool isServer);
+int shmLinkRecv(shmLink_t *link, void *data, size_t size, uint32_t timeout_ms);
+int shmLinkSend(shmLink_t *link, const void *data, size_t size);
+void shmLinkClose(shmLink_t *link, const char *name);
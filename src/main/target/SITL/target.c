@@ -56,6 +56,7 @@ const timerHardware_t timerHardware[1]; // unused
 
 #include "dyad.h"
 #include "target/SITL/udplink.h"
+#include "target/SITL/shmlink.h"
 
 uint32_t SystemCoreClock;
 
@@ -66,7 +67,11 @@ static struct timespec start_time;
 static double simRate = 1.0;
 static pthread_t tcpWorker, udpWorker;
 static bool workerRunning = true;
+#if defined(SIMULATOR_SHM)
+static shmLink_t simLink;
+#else
 static udpLink_t stateLink, pwmLink;
+#endif
 static pthread_mutex_t updateLock;
 static pthread_mutex_t mainLoopLock;
 
@@ -76,11 +81,43 @@ int lockMainPID(void) {
     return pthread_mutex_trylock(&mainLoopLock);
 }
 
+#if defined(SIMULATOR_LOCKSTEP)
+// In lockstep mode time only advances with the simulation: every fdm packet
+// moves the virtual clock forward by its timestamp delta, and is answered by
+// exactly one servo packet once the main loop has run all tasks due at that
+// time. The packets are applied on the main loop thread, so runs are
+// deterministic and go as fast as the simulator can step.
+#define LOCKSTEP_FREERUN_US 10000 // advance in real time while no simulator is connected
+
+static uint64_t simTimeUs;
+static pthread_mutex_t stepLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t stepCond = PTHREAD_COND_INITIALIZER;
+static fdm_packet stepPkt;
+static bool stepPending = false;
+static bool stepApplied = false;
+#endif
+
 #define RAD2DEG (180.0 / M_PI)
 #define ACC_SCALE (256 / 9.80665)
 #define GYRO_SCALE (16.4)
+static int simSend(const servo_packet* pkt) {
+#if defined(SIMULATOR_SHM)
+    return shmLinkSend(&simLink, pkt, sizeof(servo_packet));
+#else
+    return udpSend(&pwmLink, pkt, sizeof(servo_packet));
+#endif
+}
+
+static int simRecv(fdm_packet* pkt, uint32_t timeout_ms) {
+#if defined(SIMULATOR_SHM)
+    return shmLinkRecv(&simLink, pkt, sizeof(fdm_packet), timeout_ms);
+#else
+    return udpRecv(&stateLink, pkt, sizeof(fdm_packet), timeout_ms);
+#endif
+}
+
 void sendMotorUpdate() {
-    udpSend(&pwmLink, &pwmPkt, sizeof(servo_packet));
+    simSend(&pwmPkt);
 }
 void updateState(const fdm_packet* pkt) {
     static double last_timestamp = 0; // in seconds
@@ -94,7 +131,9 @@ void updateState(const fdm_packet* pkt) {
     if (realtime_now > last_realtime + 500*1e3) { // 500ms timeout
         last_timestamp = pkt->timestamp;
         last_realtime = realtime_now;
+#if !defined(SIMULATOR_LOCKSTEP)
         sendMotorUpdate();
+#endif
         return;
     }
 
@@ -103,6 +142,10 @@ void updateState(const fdm_packet* pkt) {
         return;
     }
 
+#if defined(SIMULATOR_LOCKSTEP)
+    simTimeUs += lrint(deltaSim * 1e6);
+#endif
+
     int16_t x,y,z;
     x = constrain(-pkt->imu_linear_acceleration_xyz[0] * ACC_SCALE, -32767, 32767);
     y = constrain(-pkt->imu_linear_acceleration_xyz[1] * ACC_SCALE, -32767, 32767);
@@ -174,15 +217,68 @@ void updateState(const fdm_packet* pkt) {
 #endif
 }
 
+#if defined(SIMULATOR_LOCKSTEP)
+static void queueState(const fdm_packet* pkt) {
+    pthread_mutex_lock(&stepLock);
+    stepPkt = *pkt;
+    stepPending = true;
+    pthread_cond_signal(&stepCond);
+    pthread_mutex_unlock(&stepLock);
+}
+
+void simulatorLockstep(bool schedulerIdle) {
+    if (!schedulerIdle) {
+        return;
+    }
+
+    // everything due at the current step has run, answer it
+    if (stepApplied) {
+        stepApplied = false;
+        sendMotorUpdate();
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += LOCKSTEP_FREERUN_US * 1000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&stepLock);
+    while (!stepPending) {
+        if (pthread_cond_timedwait(&stepCond, &stepLock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    const bool newStep = stepPending;
+    fdm_packet pkt = stepPkt;
+    stepPending = false;
+    pthread_mutex_unlock(&stepLock);
+
+    if (newStep) {
+        updateState(&pkt);
+        stepApplied = true;
+    } else {
+        // keep CLI and MSP responsive without a simulator
+        simTimeUs += LOCKSTEP_FREERUN_US;
+    }
+}
+#endif
+
 static void* udpThread(void* data) {
     UNUSED(data);
     int n = 0;
 
     while (workerRunning) {
-        n = udpRecv(&stateLink, &fdmPkt, sizeof(fdm_packet), 100);
+        n = simRecv(&fdmPkt, 100);
         if (n == sizeof(fdm_packet)) {
 //            printf("[data]new fdm %d\n", n);
+#if defined(SIMULATOR_LOCKSTEP)
+            queueState(&fdmPkt);
+#else
             updateState(&fdmPkt);
+#endif
         }
     }
 
@@ -231,11 +327,16 @@ void systemInit(void) {
         exit(1);
     }
 
+#if defined(SIMULATOR_SHM)
+    ret = shmLinkInit(&simLink, SHM_LINK_NAME, true);
+    printf("start shared memory link %s...%d\n", SHM_LINK_NAME, ret);
+#else
     ret = udpInit(&pwmLink, "127.0.0.1", 9002, false);
     printf("init PwnOut UDP link...%d\n", ret);
 
     ret = udpInit(&stateLink, NULL, 9003, true);
     printf("start UDP server...%d\n", ret);
+#endif
 
     ret = pthread_create(&udpWorker, NULL, udpThread, NULL);
     if (ret != 0) {
@@ -252,6 +353,9 @@ void systemReset(void){
     workerRunning = false;
     pthread_join(tcpWorker, NULL);
     pthread_join(udpWorker, NULL);
+#if defined(SIMULATOR_SHM)
+    shmLinkClose(&simLink, SHM_LINK_NAME);
+#endif
     exit(0);
 }
 void systemResetToBootloader(bootloaderRequestType_e requestType) {
@@ -261,6 +365,9 @@ void systemResetToBootloader(bootloaderRequestType_e requestType) {
     workerRunning = false;
     pthread_join(tcpWorker, NULL);
     pthread_join(udpWorker, NULL);
+#if defined(SIMULATOR_SHM)
+    shmLinkClose(&simLink, SHM_LINK_NAME);
+#endif
     exit(0);
 }
 
@@ -303,6 +410,9 @@ uint64_t millis64_real() {
 }
 
 uint64_t micros64() {
+#if defined(SIMULATOR_LOCKSTEP)
+    return simTimeUs;
+#else
     static uint64_t last = 0;
     static uint64_t out = 0;
     uint64_t now = nanos64_real();
@@ -312,9 +422,13 @@ uint64_t micros64() {
 
     return out*1e-3;
 //    return micros64_real();
+#endif
 }
 
 uint64_t millis64() {
+#if defined(SIMULATOR_LOCKSTEP)
+    return simTimeUs / 1000;
+#else
     static uint64_t last = 0;
     static uint64_t out = 0;
     uint64_t now = nanos64_real();
@@ -324,12 +438,25 @@ uint64_t millis64() {
 
     return out*1e-6;
 //    return millis64_real();
+#endif
 }
 
 uint32_t micros(void) {
     return micros64() & 0xFFFFFFFF;
 }
 
+uint32_t getCycleCounter(void) {
+#if defined(SIMULATOR_LOCKSTEP)
+    return (simTimeUs * 500) & 0xFFFFFFFF;
+#else
+    return (nanos64_real() / 2) & 0xFFFFFFFF; // fake 500MHz, matching SystemCoreClock
+#endif
+}
+
+uint32_t clockCyclesToMicros(uint32_t clockCycles) {
+    return clockCycles / 500;
+}
+
 uint32_t millis(void) {
     return millis64() & 0xFFFFFFFF;
 }
@@ -342,7 +469,11 @@ void microsleep(uint32_t usec) {
 }
 
 void delayMicroseconds(uint32_t us) {
+#if defined(SIMULATOR_LOCKSTEP)
+    simTimeUs += us;
+#else
     microsleep(us / simRate);
+#endif
 }
 
 void delayMicroseconds_real(uint32_t us) {
@@ -350,11 +481,15 @@ void delayMicroseconds_real(uint32_t us) {
 }
 
 void delay(uint32_t ms) {
+#if defined(SIMULATOR_LOCKSTEP)
+    simTimeUs += (uint64_t)ms * 1000;
+#else
     uint64_t start = millis64();
 
     while ((millis64() - start) < ms) {
         microsleep(1000);
     }
+#endif
 }
 
 // Subtract the ‘struct timespec’ values X and Y,  storing the result in RESULT.
@@ -454,9 +589,11 @@ static void pwmCompleteMotorUpdate(void)
     pwmPkt.motor_speed[1] = motorsPwm[2] / outScale;
     pwmPkt.motor_speed[2] = motorsPwm[3] / outScale;
 
+#if !defined(SIMULATOR_LOCKSTEP) // answered from simulatorLockstep() once per fdm packet
     // get one "fdm_packet" can only send one "servo_packet"!!
     if (pthread_mutex_trylock(&updateLock) != 0) return;
-    udpSend(&pwmLink, &pwmPkt, sizeof(servo_packet));
+    simSend(&pwmPkt);
+#endif
 //    printf("[pwm]%u:%u,%u,%u,%u\n", idlePulse, motorsPwm[0], motorsPwm[1], motorsPwm[2], motorsPwm[3]);
 }
 
@@ -464,6 +601,9 @@ void pwmWriteServo(uint8_t index, float value) {
     servosPwm[index] = value;
 }
 
+void pwmCompleteServoUpdate(void) {
+}
+
 static motorDevice_t motorPwmDevice = {
     .vTable = {
         .convertExternalToMotor = pwmConvertFromExternal,
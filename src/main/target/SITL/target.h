@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -39,6 +40,10 @@
 //#define SIMULATOR_GYRO_SYNC
 //#define SIMULATOR_IMU_SYNC
 //#define SIMULATOR_GYROPID_SYNC
+// step time with the simulator's fdm packets instead of the wall clock
+//#define SIMULATOR_LOCKSTEP
+// exchange fdm/servo packets through shared memory (shmlink.h) instead of UDP
+//#define SIMULATOR_SHM
 
 // file name to save config
 #define EEPROM_FILENAME "eeprom.bin"
@@ -55,6 +60,10 @@
 #undef SCHEDULER_DELAY_LIMIT
 #define SCHEDULER_DELAY_LIMIT           1
 
+#define USE_TASK_PROFILER
+#define USE_RC_LATENCY
+#define USE_LOOP_TIMING
+
 #define USE_FAKE_LED
 
 #define USE_ACC
@@ -254,5 +263,6 @@ uint64_t micros64(void);
 uint64_t millis64(void);
 
 int lockMainPID(void);
+void simulatorLockstep(bool schedulerIdle);
 
 
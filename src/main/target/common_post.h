@@ -36,6 +36,10 @@
 #undef USE_ESC_SENSOR_TELEMETRY
 #endif
 
+#ifndef USE_GYRO_EXTI
+#undef USE_PID_LOOP_INTERRUPT
+#endif
+
 // XXX Followup implicit dependencies among DASHBOARD, display_xxx and USE_I2C.
 // XXX This should eventually be cleaned up.
 #ifndef USE_I2C
@@ -68,6 +72,7 @@
 
 
 #if !defined(USE_SERIAL_RX)
+#undef USE_RX_DIVERSITY
 #undef USE_SERIALRX_CRSF
 #undef USE_SERIALRX_IBUS
 #undef USE_SERIALRX_JETIEXBUS
@@ -175,6 +180,7 @@
 
 #if !defined(USE_VCP)
 #undef USE_USB_CDC_HID
+#undef USE_USB_MSP_BULK
 #undef USE_USB_MSC
 #endif
 
@@ -249,12 +255,18 @@
 
 #ifndef USE_BLACKBOX
 #undef USE_USB_MSC
+#undef USE_BLACKBOX_HEADER_CACHE
 #endif
 
 #if (!defined(USE_FLASHFS) || !defined(USE_RTC_TIME) || !defined(USE_USB_MSC) || !defined(USE_PERSISTENT_OBJECTS))
 #undef USE_PERSISTENT_MSC_RTC
 #endif
 
+// the crash log has to survive the reset after a fault
+#ifndef PERSISTENT
+#undef USE_CRASH_LOG
+#endif
+
 #if !defined(USE_SERIAL_4WAY_BLHELI_BOOTLOADER) && !defined(USE_SERIAL_4WAY_SK_BOOTLOADER)
 #undef  USE_SERIAL_4WAY_BLHELI_INTERFACE
 #elif !defined(USE_SERIAL_4WAY_BLHELI_INTERFACE) && (defined(USE_SERIAL_4WAY_BLHELI_BOOTLOADER) || defined(USE_SERIAL_4WAY_SK_BOOTLOADER))
@@ -273,9 +285,9 @@
 #define USE_WS2811_SINGLE_COLOUR
 #endif
 
-#if defined(SIMULATOR_BUILD) || defined(UNIT_TEST)
-// This feature uses 'arm_math.h', which does not exist for x86.
-#undef USE_GYRO_DATA_ANALYSE
+// Targets short of RAM can define USE_WS2811_HALF_BUFFER to refill a two LED DMA buffer from the DMA interrupt
+#if !defined(USE_LED_STRIP) || defined(USE_WS2811_SINGLE_COLOUR)
+#undef USE_WS2811_HALF_BUFFER
 #endif
 
 #ifndef USE_CMS
@@ -317,6 +329,24 @@
 
 #if !defined(USE_DMA_SPEC)
 #undef USE_TIMER_MGMT
+#undef USE_SOFTSERIAL_DMA
+#endif
+
+#if !defined(USE_DMA_SPEC) || !defined(USE_PPM)
+#undef USE_PPM_DMA
+#endif
+
+#if !defined(USE_DMA_SPEC) || !defined(USE_SPI)
+#undef USE_SPI_DMA
+#endif
+
+#if !defined(USE_SPI_DMA) || !defined(USE_GYRO_EXTI)
+#undef USE_GYRO_SPI_DMA
+#endif
+
+// The PID loop is only run from PendSV with the gyro read by DMA
+#ifndef USE_GYRO_SPI_DMA
+#undef USE_PID_LOOP_INTERRUPT
 #endif
 
 #if defined(USE_TIMER_MGMT)
@@ -358,6 +388,11 @@ extern uint8_t __config_start;   // configured via linker script when building b
 extern uint8_t __config_end;
 #endif
 
+#ifndef CONFIG_IN_FLASH
+// the journal appends to erased internal flash, the other config stores are rewritten as a whole anyway
+#undef USE_CONFIG_JOURNAL
+#endif
+
 #if defined(USE_EXST) && !defined(RAMBASED)
 #define USE_FLASH_BOOT_LOADER
 #endif
@@ -373,3 +408,18 @@ extern uint8_t __config_end;
 #if defined(USE_CUSTOM_DEFAULTS)
 #define USE_CUSTOM_DEFAULTS_ADDRESS
 #endif
+
+#if defined(USE_TRACE) && !defined(USE_IRQ_LOAD)
+// the interrupt load hooks record the interrupt trace events
+#define USE_IRQ_LOAD
+#endif
+
+#if !defined(USE_MULTI_GYRO) || !defined(USE_LOOP_TIMING)
+// interleaving needs the second gyro and the data ready time of each
+#undef USE_GYRO_INTERLEAVE
+#endif
+
+#if !defined(USE_LOOP_TIMING)
+// the gyro output data rate is measured from the data ready times
+#undef USE_GYRO_ODR_TRACKING
+#endif
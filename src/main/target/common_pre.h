@@ -21,6 +21,7 @@
 #pragma once
 
 #define USE_PARAMETER_GROUPS
+#define USE_CONFIG_JOURNAL
 // type conversion warnings.
 // -Wconversion can be turned on to enable the process of eliminating these warnings
 //#pragma GCC diagnostic warning "-Wconversion"
@@ -69,6 +70,8 @@
 #define USE_TIMER_MGMT
 #define USE_PERSISTENT_OBJECTS
 #define USE_CUSTOM_DEFAULTS_ADDRESS
+#define USE_SOFTSERIAL_DMA
+#define USE_PPM_DMA
 // Re-enable this after 4.0 has been released, and remove the define from STM32F4DISCOVERY
 //#define USE_SPI_TRANSACTION
 
@@ -76,6 +79,10 @@
 #define USE_OVERCLOCK
 #endif
 
+#if defined(STM32F411xE)
+#define USE_FAST_MATH_TABLES
+#endif
+
 #endif // STM32F4
 
 #ifdef STM32F7
@@ -94,6 +101,8 @@
 #define USE_OVERCLOCK
 #define USE_ADC_INTERNAL
 #define USE_USB_CDC_HID
+#define USE_USB_MSP_BULK
+#define USE_BLACKBOX_HEADER_CACHE
 #define USE_USB_MSC
 #define USE_PERSISTENT_MSC_RTC
 #define USE_MCO
@@ -116,6 +125,8 @@
 #define USE_GYRO_DATA_ANALYSE
 #define USE_ADC_INTERNAL
 #define USE_USB_CDC_HID
+#define USE_USB_MSP_BULK
+#define USE_BLACKBOX_HEADER_CACHE
 #define USE_DMA_SPEC
 #define USE_TIMER_MGMT
 #define USE_PERSISTENT_OBJECTS
@@ -124,20 +135,41 @@
 #if defined(STM32F4) || defined(STM32F7) || defined(STM32H7)
 #define TASK_GYROPID_DESIRED_PERIOD     125 // 125us = 8kHz
 #define SCHEDULER_DELAY_LIMIT           10
+#define USE_RX_DIVERSITY
+// Not part of any default build, as they cost time in the loop or the scheduler on every run. Enable
+// with EXTRA_FLAGS, e.g. EXTRA_FLAGS="-DUSE_TASK_PROFILER -DUSE_LOOP_TIMING":
+// USE_TASK_PROFILER, USE_RC_LATENCY, USE_LOOP_TIMING, STACK_CHECK, USE_CRASH_LOG (F4 and H7),
+// USE_PID_LOOP_INTERRUPT, USE_GYRO_FIFO, USE_GYRO_INTERLEAVE and USE_GYRO_ODR_TRACKING
 #else
 #define TASK_GYROPID_DESIRED_PERIOD     1000 // 1000us = 1kHz
 #define SCHEDULER_DELAY_LIMIT           100
 #endif
 
+#if defined(STM32F4) || defined(STM32F7)
+#define USE_SPI_DMA
+#define USE_GYRO_SPI_DMA
+#endif
+
 #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
 #define DEFAULT_AUX_CHANNEL_COUNT       MAX_AUX_CHANNEL_COUNT
 #else
 #define DEFAULT_AUX_CHANNEL_COUNT       6
 #endif
 
+#if defined(STM32F4) && defined(USE_FAST_CODE_SRAM)
+// F4 has no ITCM, but code runs from SRAM without flash wait states. The
+// linker copies the .tcm_code section there. Not part of any default build,
+// enable with EXTRA_FLAGS=-DUSE_FAST_CODE_SRAM.
+#define USE_ITCM_RAM
+#endif
+
 #ifdef USE_ITCM_RAM
 #define FAST_CODE                   __attribute__((section(".tcm_code")))
 #define FAST_CODE_NOINLINE          NOINLINE
+#elif defined(STM32F4)
+// Kept together at the start of the firmware, so the loop shares ART cache lines and prefetch instead of evicting itself
+#define FAST_CODE                   __attribute__((section(".text.hot.fast_code")))
+#define FAST_CODE_NOINLINE
 #else
 #define FAST_CODE
 #define FAST_CODE_NOINLINE
@@ -213,15 +245,19 @@
 #if (FLASH_SIZE > 128)
 #define USE_GYRO_OVERFLOW_CHECK
 #define USE_YAW_SPIN_RECOVERY
+#define USE_GYRO_CALIBRATION_STORE
 #define USE_DSHOT_DMAR
 #define USE_SERIALRX_FPORT      // FrSky FPort
 #define USE_TELEMETRY_CRSF
 #define USE_TELEMETRY_SRXL
+#define USE_MSP_SETTINGS
+#define USE_MSP_STREAMING
 
 #if ((FLASH_SIZE > 256) || (FEATURE_CUT_LEVEL < 12))
 #define USE_CMS
 #define USE_MSP_DISPLAYPORT
 #define USE_MSP_OVER_TELEMETRY
+#define USE_CRC_TABLES
 #define USE_LED_STRIP
 #endif
 
@@ -316,6 +352,7 @@
 #define USE_GYRO_DLPF_EXPERIMENTAL
 #define USE_OSD
 #define USE_OSD_OVER_MSP_DISPLAYPORT
+#define USE_MSP_DISPLAYPORT_COMPACT
 #define USE_MULTI_GYRO
 #define USE_OSD_ADJUSTMENTS
 #define USE_SENSOR_NAMES
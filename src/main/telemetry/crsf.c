@@ -28,6 +28,7 @@
 
 #include "build/atomic.h"
 #include "build/build_config.h"
+#include "build/debug.h"
 #include "build/version.h"
 
 #include "config/feature.h"
@@ -67,7 +68,12 @@
 #include "telemetry/crsf.h"
 
 
-#define CRSF_CYCLETIME_US                   100000 // 100ms, 10 Hz
+#define CRSF_TELEMETRY_WINDOW_US            20000  // 20ms, frames are packed into 50 Hz telemetry windows
+#define CRSF_TELEMETRY_BYTES_PER_RC_FRAME   2      // downlink bytes per second for every uplink frame per second
+#define CRSF_TELEMETRY_DEFAULT_BYTES_PER_S  120    // used until the uplink rate is known, about 10 frames per second
+#define CRSF_TELEMETRY_MIN_BYTES_PER_S      16
+#define CRSF_TELEMETRY_BUDGET_MAX           CRSF_TELEMETRY_BUFFER_SIZE
+#define CRSF_TELEMETRY_THROUGHPUT_PERIOD_US 1000000
 #define CRSF_DEVICEINFO_VERSION             0x01
 #define CRSF_DEVICEINFO_PARAMETER_COUNT     0
 
@@ -78,6 +84,12 @@ static bool crsfTelemetryEnabled;
 static bool deviceInfoReplyPending;
 static uint8_t crsfFrame[CRSF_FRAME_SIZE_MAX];
 
+STATIC_UNIT_TESTED int32_t crsfTelemetryBudget;           // bytes that may be sent, refilled at the downlink rate
+static uint16_t crsfTelemetryBytesSent;
+static uint16_t crsfTelemetryFramesSent;
+static uint16_t crsfTelemetryBytesPerSecond;  // achieved throughput over the last second
+static uint16_t crsfTelemetryFramesPerSecond;
+
 #if defined(USE_MSP_OVER_TELEMETRY)
 typedef struct mspBuffer_s {
     uint8_t bytes[CRSF_MSP_BUFFER_SIZE];
@@ -108,7 +120,8 @@ bool handleCrsfMspFrameBuffer(uint8_t payloadSize, mspResponseFnPtr responseFn)
 {
     bool requestHandled = false;
     if (!mspRxBuffer.len) {
-        return false;
+        // no new request frames, carry on with the reply in progress
+        return sendMspReply(payloadSize, responseFn);
     }
     int pos = 0;
     while (true) {
@@ -136,12 +149,19 @@ static void crsfInitializeFrame(sbuf_t *dst)
     sbufWriteU8(dst, CRSF_SYNC_BYTE);
 }
 
-static void crsfFinalize(sbuf_t *dst)
+static bool crsfFinalize(sbuf_t *dst)
 {
     crc8_dvb_s2_sbuf_append(dst, &crsfFrame[2]); // start at byte 2, since CRC does not include device address and frame length
     sbufSwitchToReader(dst, crsfFrame);
+    const int frameSize = sbufBytesRemaining(dst);
     // write the telemetry frame to the receiver.
-    crsfRxWriteTelemetryData(sbufPtr(dst), sbufBytesRemaining(dst));
+    if (!crsfRxWriteTelemetryData(sbufPtr(dst), frameSize)) {
+        return false;
+    }
+    crsfTelemetryBudget -= frameSize;
+    crsfTelemetryBytesSent += frameSize;
+    crsfTelemetryFramesSent++;
+    return true;
 }
 
 static int crsfFinalizeBuf(sbuf_t *dst, uint8_t *frame)
@@ -367,9 +387,7 @@ static void crsfFrameDisplayPortClear(sbuf_t *dst)
 
 #endif
 
-#define BV(x)  (1 << (x)) // bit value
-
-// schedule array to decide how often each type of frame is sent
+// frame types sent by the telemetry scheduler
 typedef enum {
     CRSF_FRAME_START_INDEX = 0,
     CRSF_FRAME_ATTITUDE_INDEX = CRSF_FRAME_START_INDEX,
@@ -379,8 +397,21 @@ typedef enum {
     CRSF_SCHEDULE_COUNT_MAX
 } crsfFrameTypeIndex_e;
 
+// Every telemetry window the priority of each frame grows by one plus a share of its change
+// rate, frames are then sent in order of priority for as long as the downlink budget allows.
+// Frames whose content changes are sent more often, the others still get their turn.
+typedef struct crsfScheduleEntry_s {
+    uint8_t frameIndex;
+    uint8_t priority;
+    uint8_t changeRate;     // how often the frame content was new when sent, 0 to 248
+    uint8_t lastCrc;
+} crsfScheduleEntry_t;
+
+#define CRSF_CHANGE_RATE_STEP       31
+#define CRSF_CHANGE_RATE_PRIORITY_SHIFT 5
+
 static uint8_t crsfScheduleCount;
-static uint8_t crsfSchedule[CRSF_SCHEDULE_COUNT_MAX];
+static crsfScheduleEntry_t crsfSchedule[CRSF_SCHEDULE_COUNT_MAX];
 
 #if defined(USE_MSP_OVER_TELEMETRY)
 
@@ -406,39 +437,72 @@ void crsfSendMspResponse(uint8_t *payload)
 }
 #endif
 
-static void processCrsf(void)
+static void crsfWriteScheduledFrame(sbuf_t *dst, uint8_t frameIndex)
 {
-    static uint8_t crsfScheduleIndex = 0;
-
-    const uint8_t currentSchedule = crsfSchedule[crsfScheduleIndex];
-
-    sbuf_t crsfPayloadBuf;
-    sbuf_t *dst = &crsfPayloadBuf;
-
-    if (currentSchedule & BV(CRSF_FRAME_ATTITUDE_INDEX)) {
-        crsfInitializeFrame(dst);
+    switch (frameIndex) {
+    default:
+    case CRSF_FRAME_ATTITUDE_INDEX:
         crsfFrameAttitude(dst);
-        crsfFinalize(dst);
-    }
-    if (currentSchedule & BV(CRSF_FRAME_BATTERY_SENSOR_INDEX)) {
-        crsfInitializeFrame(dst);
+        break;
+    case CRSF_FRAME_BATTERY_SENSOR_INDEX:
         crsfFrameBatterySensor(dst);
-        crsfFinalize(dst);
+        break;
+    case CRSF_FRAME_FLIGHT_MODE_INDEX:
+        crsfFrameFlightMode(dst);
+        break;
+#ifdef USE_GPS
+    case CRSF_FRAME_GPS_INDEX:
+        crsfFrameGps(dst);
+        break;
+#endif
     }
+}
 
-    if (currentSchedule & BV(CRSF_FRAME_FLIGHT_MODE_INDEX)) {
-        crsfInitializeFrame(dst);
-        crsfFrameFlightMode(dst);
-        crsfFinalize(dst);
+STATIC_UNIT_TESTED void processCrsf(void)
+{
+    for (int i = 0; i < crsfScheduleCount; i++) {
+        crsfScheduleEntry_t *entry = &crsfSchedule[i];
+        entry->priority = MIN(entry->priority + 1 + (entry->changeRate >> CRSF_CHANGE_RATE_PRIORITY_SHIFT), UINT8_MAX);
     }
-#ifdef USE_GPS
-    if (currentSchedule & BV(CRSF_FRAME_GPS_INDEX)) {
+
+    while (true) {
+        crsfScheduleEntry_t *next = NULL;
+        for (int i = 0; i < crsfScheduleCount; i++) {
+            crsfScheduleEntry_t *entry = &crsfSchedule[i];
+            if (entry->priority && (!next || entry->priority > next->priority)) {
+                next = entry;
+            }
+        }
+        if (!next) {
+            return;
+        }
+
+        sbuf_t crsfPayloadBuf;
+        sbuf_t *dst = &crsfPayloadBuf;
         crsfInitializeFrame(dst);
-        crsfFrameGps(dst);
-        crsfFinalize(dst);
+        crsfWriteScheduledFrame(dst, next->frameIndex);
+        // the highest priority frame waits for the budget, that keeps the larger frames from starving
+        if (sbufPtr(dst) - crsfFrame + 1 > crsfTelemetryBudget || !crsfFinalize(dst)) {
+            return;
+        }
+
+        const uint8_t crc = crsfFrame[crsfFrame[1] + 1];
+        next->changeRate -= next->changeRate >> 3;
+        if (crc != next->lastCrc) {
+            next->changeRate += CRSF_CHANGE_RATE_STEP;
+        }
+        next->lastCrc = crc;
+        next->priority = 0;
     }
-#endif
-    crsfScheduleIndex = (crsfScheduleIndex + 1) % crsfScheduleCount;
+}
+
+// Downlink rate in bytes per second, scaled with the rate of the uplink frames
+STATIC_UNIT_TESTED int crsfTelemetryBytesPerSecondBudget(uint32_t rcFrameIntervalUs)
+{
+    if (!rcFrameIntervalUs) {
+        return CRSF_TELEMETRY_DEFAULT_BYTES_PER_S;
+    }
+    return MAX(CRSF_TELEMETRY_BYTES_PER_RC_FRAME * 1000000 / (int)rcFrameIntervalUs, CRSF_TELEMETRY_MIN_BYTES_PER_S);
 }
 
 void crsfScheduleDeviceInfoResponse(void)
@@ -447,6 +511,27 @@ void crsfScheduleDeviceInfoResponse(void)
 }
 
 
+STATIC_UNIT_TESTED void initCrsfTelemetrySchedule(void)
+{
+    memset(crsfSchedule, 0, sizeof(crsfSchedule));
+    int index = 0;
+    if (sensors(SENSOR_ACC) && telemetryIsSensorEnabled(SENSOR_PITCH | SENSOR_ROLL | SENSOR_HEADING)) {
+        crsfSchedule[index++].frameIndex = CRSF_FRAME_ATTITUDE_INDEX;
+    }
+    if ((isBatteryVoltageConfigured() && telemetryIsSensorEnabled(SENSOR_VOLTAGE))
+        || (isAmperageConfigured() && telemetryIsSensorEnabled(SENSOR_CURRENT | SENSOR_FUEL))) {
+        crsfSchedule[index++].frameIndex = CRSF_FRAME_BATTERY_SENSOR_INDEX;
+    }
+    crsfSchedule[index++].frameIndex = CRSF_FRAME_FLIGHT_MODE_INDEX;
+#ifdef USE_GPS
+    if (featureIsEnabled(FEATURE_GPS)
+       && telemetryIsSensorEnabled(SENSOR_ALTITUDE | SENSOR_LAT_LONG | SENSOR_GROUND_SPEED | SENSOR_HEADING)) {
+        crsfSchedule[index++].frameIndex = CRSF_FRAME_GPS_INDEX;
+    }
+#endif
+    crsfScheduleCount = (uint8_t)index;
+}
+
 void initCrsfTelemetry(void)
 {
     // check if there is a serial port open for CRSF telemetry (ie opened by the CRSF RX)
@@ -458,6 +543,7 @@ void initCrsfTelemetry(void)
     }
 
     deviceInfoReplyPending = false;
+    crsfTelemetryBudget = 0;
 #if defined(USE_MSP_OVER_TELEMETRY)
     mspReplyPending = false;
 #endif
@@ -466,23 +552,8 @@ void initCrsfTelemetry(void)
     cmsDisplayPortRegister(displayPortCrsfInit());
 #endif
 
-    int index = 0;
-    if (sensors(SENSOR_ACC) && telemetryIsSensorEnabled(SENSOR_PITCH | SENSOR_ROLL | SENSOR_HEADING)) {
-        crsfSchedule[index++] = BV(CRSF_FRAME_ATTITUDE_INDEX);
-    }
-    if ((isBatteryVoltageConfigured() && telemetryIsSensorEnabled(SENSOR_VOLTAGE))
-        || (isAmperageConfigured() && telemetryIsSensorEnabled(SENSOR_CURRENT | SENSOR_FUEL))) {
-        crsfSchedule[index++] = BV(CRSF_FRAME_BATTERY_SENSOR_INDEX);
-    }
-    crsfSchedule[index++] = BV(CRSF_FRAME_FLIGHT_MODE_INDEX);
-#ifdef USE_GPS
-    if (featureIsEnabled(FEATURE_GPS)
-       && telemetryIsSensorEnabled(SENSOR_ALTITUDE | SENSOR_LAT_LONG | SENSOR_GROUND_SPEED | SENSOR_HEADING)) {
-        crsfSchedule[index++] = BV(CRSF_FRAME_GPS_INDEX);
-    }
-#endif
-    crsfScheduleCount = (uint8_t)index;
- }
+    initCrsfTelemetrySchedule();
+}
 
 bool checkCrsfTelemetryState(void)
 {
@@ -514,6 +585,38 @@ void crsfProcessDisplayPortCmd(uint8_t *frameStart)
 
 #endif
 
+// Refills the downlink budget at the rate the link allows and reports the achieved throughput
+static void crsfTelemetryUpdateBudget(timeUs_t currentTimeUs)
+{
+    static timeUs_t lastUpdateUs;
+    static timeUs_t throughputStartUs;
+    static uint32_t budgetRemainder;
+
+    const uint32_t rcFrameIntervalUs = crsfRxGetFrameIntervalUs();
+    const int bytesPerSecond = crsfTelemetryBytesPerSecondBudget(rcFrameIntervalUs);
+    const uint32_t elapsedUs = MIN(cmpTimeUs(currentTimeUs, lastUpdateUs), CRSF_TELEMETRY_THROUGHPUT_PERIOD_US);
+    lastUpdateUs = currentTimeUs;
+
+    budgetRemainder += bytesPerSecond * elapsedUs;
+    crsfTelemetryBudget = MIN(crsfTelemetryBudget + (int32_t)(budgetRemainder / 1000000), CRSF_TELEMETRY_BUDGET_MAX);
+    // the ad-hoc responses are sent regardless of the budget, do not let them hold off the telemetry for long
+    crsfTelemetryBudget = MAX(crsfTelemetryBudget, -CRSF_TELEMETRY_BUDGET_MAX);
+    budgetRemainder %= 1000000;
+
+    if (cmpTimeUs(currentTimeUs, throughputStartUs) >= CRSF_TELEMETRY_THROUGHPUT_PERIOD_US) {
+        throughputStartUs = currentTimeUs;
+        crsfTelemetryBytesPerSecond = crsfTelemetryBytesSent;
+        crsfTelemetryFramesPerSecond = crsfTelemetryFramesSent;
+        crsfTelemetryBytesSent = 0;
+        crsfTelemetryFramesSent = 0;
+
+        DEBUG_SET(DEBUG_CRSF_TELEMETRY, 0, bytesPerSecond);
+        DEBUG_SET(DEBUG_CRSF_TELEMETRY, 1, crsfTelemetryBytesPerSecond);
+        DEBUG_SET(DEBUG_CRSF_TELEMETRY, 2, crsfTelemetryFramesPerSecond);
+        DEBUG_SET(DEBUG_CRSF_TELEMETRY, 3, rcFrameIntervalUs);
+    }
+}
+
 /*
  * Called periodically by the scheduler
  */
@@ -529,6 +632,8 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
     // in between the RX frames.
     crsfRxSendTelemetryData();
 
+    crsfTelemetryUpdateBudget(currentTimeUs);
+
     // Send ad-hoc response frames as soon as possible
 #if defined(USE_MSP_OVER_TELEMETRY)
     if (mspReplyPending) {
@@ -573,9 +678,8 @@ void handleCrsfTelemetry(timeUs_t currentTimeUs)
     }
 #endif
 
-    // Actual telemetry data only needs to be sent at a low frequency, ie 10Hz
-    // Spread out scheduled frames evenly so each frame is sent at the same frequency.
-    if (currentTimeUs >= crsfLastCycleTime + (CRSF_CYCLETIME_US / crsfScheduleCount)) {
+    // Pack the scheduled frames into telemetry windows, as many as the downlink budget allows
+    if (cmpTimeUs(currentTimeUs, crsfLastCycleTime) >= CRSF_TELEMETRY_WINDOW_US) {
         crsfLastCycleTime = currentTimeUs;
         processCrsf();
     }
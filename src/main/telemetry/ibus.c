@@ -82,7 +82,7 @@ static serialPortConfig_t *ibusSerialPortConfig;
  * will keep track of how many rx chars that shall be discarded */
 static uint8_t outboundBytesToIgnoreOnRxCount = 0;
 
-static bool ibusTelemetryEnabled = false;
+static volatile bool ibusTelemetryEnabled = false;
 static portSharing_e ibusPortSharing;
 
 static uint8_t ibusReceiveBuffer[IBUS_RX_BUF_LEN] = { 0x0 };
@@ -104,25 +104,45 @@ void initIbusTelemetry(void)
 }
 
 
-void handleIbusTelemetry(void)
+static void ibusProcessByte(uint8_t c)
+{
+    if (outboundBytesToIgnoreOnRxCount) {
+        outboundBytesToIgnoreOnRxCount--;
+        return;
+    }
+
+    pushOntoTail(ibusReceiveBuffer, IBUS_RX_BUF_LEN, c);
+
+    if (isChecksumOkIa6b(ibusReceiveBuffer, IBUS_RX_BUF_LEN)) {
+        outboundBytesToIgnoreOnRxCount += respondToIbusRequestPrepared(ibusReceiveBuffer);
+    }
+}
+
+// Receive ISR callback, replies go out while the receiver is still listening regardless of the scheduler load
+static void ibusDataReceive(uint16_t c, void *data)
 {
+    UNUSED(data);
+
     if (!ibusTelemetryEnabled) {
+        // the port is open but the shared telemetry is not yet set up
         return;
     }
 
-    while (serialRxBytesWaiting(ibusSerialPort) > 0) {
-        uint8_t c = serialRead(ibusSerialPort);
+    ibusProcessByte(c);
+}
 
-        if (outboundBytesToIgnoreOnRxCount) {
-            outboundBytesToIgnoreOnRxCount--;
-            continue;
-        }
 
-        pushOntoTail(ibusReceiveBuffer, IBUS_RX_BUF_LEN, c);
+void handleIbusTelemetry(void)
+{
+    if (!ibusTelemetryEnabled) {
+        return;
+    }
+
+    prepareIbusMeasurements();
 
-        if (isChecksumOkIa6b(ibusReceiveBuffer, IBUS_RX_BUF_LEN)) {
-            outboundBytesToIgnoreOnRxCount += respondToIbusRequest(ibusReceiveBuffer);
-        }
+    // only ports that do not support a receive callback leave bytes to be read here
+    while (serialRxBytesWaiting(ibusSerialPort) > 0) {
+        ibusProcessByte(serialRead(ibusSerialPort));
     }
 }
 
@@ -157,7 +177,10 @@ void configureIbusTelemetryPort(void)
         return;
     }
 
-    ibusSerialPort = openSerialPort(ibusSerialPortConfig->identifier, FUNCTION_TELEMETRY_IBUS, NULL, NULL, IBUS_BAUDRATE, IBUS_UART_MODE, SERIAL_BIDIR | (telemetryConfig()->telemetry_inverted ? SERIAL_INVERTED : SERIAL_NOT_INVERTED));
+    outboundBytesToIgnoreOnRxCount = 0;
+    prepareIbusMeasurements();
+
+    ibusSerialPort = openSerialPort(ibusSerialPortConfig->identifier, FUNCTION_TELEMETRY_IBUS, ibusDataReceive, NULL, IBUS_BAUDRATE, IBUS_UART_MODE, SERIAL_BIDIR | (telemetryConfig()->telemetry_inverted ? SERIAL_INVERTED : SERIAL_NOT_INVERTED));
 
     if (!ibusSerialPort) {
         return;
@@ -165,15 +188,14 @@ void configureIbusTelemetryPort(void)
 
     initSharedIbusTelemetry(ibusSerialPort);
     ibusTelemetryEnabled = true;
-    outboundBytesToIgnoreOnRxCount = 0;
 }
 
 
 void freeIbusTelemetryPort(void)
 {
+    ibusTelemetryEnabled = false;
     closeSerialPort(ibusSerialPort);
     ibusSerialPort = NULL;
-    ibusTelemetryEnabled = false;
 }
 
 #endif
@@ -31,6 +31,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include "platform.h"
@@ -63,6 +64,7 @@ static uint16_t calculateChecksum(const uint8_t *ibusPacket);
 #define IBUS_HEADER_FOOTER_SIZE     4
 #define IBUS_2BYTE_SESNSOR          2
 #define IBUS_4BYTE_SESNSOR          4
+#define IBUS_MAX_SENSOR_LENGTH      14 // IBUS_SENSOR_TYPE_GPS_FULL
 
 typedef uint8_t ibusAddress_t;
 
@@ -128,6 +130,12 @@ static serialPort_t *ibusSerialPort = NULL;
 static ibusAddress_t ibusBaseAddress = INVALID_IBUS_ADDRESS;
 static uint8_t sendBuffer[IBUS_BUFFSIZE];
 
+// Measurement values prepared by the telemetry task for replies sent from the receive interrupt.
+// The task fills the inactive bank and then flips measurementBank, so the interrupt never copies
+// from a bank that is half rebuilt.
+static uint8_t measurementValues[2][IBUS_SENSOR_COUNT][IBUS_MAX_SENSOR_LENGTH];
+static volatile uint8_t measurementBank = 0;
+
 
 static void setValue(uint8_t* bufferPtr, uint8_t sensorType, uint8_t length);
 
@@ -430,13 +438,17 @@ static void setValue(uint8_t* bufferPtr, uint8_t sensorType, uint8_t length)
         bufferPtr[i] = value.byte[i];
     }
 }
-static void setIbusMeasurement(ibusAddress_t address)
+static void setIbusMeasurement(ibusAddress_t address, bool prepared)
 {
     uint8_t sensorID = getSensorID(address);
     uint8_t sensorLength = getSensorLength(sensorID);
     sendBuffer[0] = IBUS_HEADER_FOOTER_SIZE + sensorLength;
     sendBuffer[1] = IBUS_COMMAND_MEASUREMENT | address;
-    setValue(sendBuffer + 2, sensorID, sensorLength);
+    if (prepared) {
+        memcpy(sendBuffer + 2, measurementValues[measurementBank][address - ibusBaseAddress], sensorLength);
+    } else {
+        setValue(sendBuffer + 2, sensorID, sensorLength);
+    }
 }
 
 static bool isCommand(ibusCommand_e expected, const uint8_t *ibusPacket)
@@ -464,7 +476,7 @@ static bool theAddressIsWithinOurRange(ibusAddress_t returnAddress)
     telemetryConfig()->flysky_sensors[(returnAddress - ibusBaseAddress)] != IBUS_SENSOR_TYPE_NONE;
 }
 
-uint8_t respondToIbusRequest(uint8_t const * const ibusPacket)
+static uint8_t respond(uint8_t const * const ibusPacket, bool prepared)
 {
     ibusAddress_t returnAddress = getAddress(ibusPacket);
     autodetectFirstReceivedAddressAsBaseAddress(returnAddress);
@@ -477,13 +489,35 @@ uint8_t respondToIbusRequest(uint8_t const * const ibusPacket)
         } else if (isCommand(IBUS_COMMAND_SENSOR_TYPE, ibusPacket)) {
             setIbusSensorType(returnAddress);
         } else if (isCommand(IBUS_COMMAND_MEASUREMENT, ibusPacket)) {
-            setIbusMeasurement(returnAddress);
+            setIbusMeasurement(returnAddress, prepared);
         }
     }
     //transmit if content was set
     return transmitIbusPacket();
 }
 
+uint8_t respondToIbusRequest(uint8_t const * const ibusPacket)
+{
+    return respond(ibusPacket, false);
+}
+
+uint8_t respondToIbusRequestPrepared(uint8_t const * const ibusPacket)
+{
+    return respond(ibusPacket, true);
+}
+
+void prepareIbusMeasurements(void)
+{
+    const uint8_t bank = measurementBank ^ 1;
+    for (unsigned i = 0; i < IBUS_SENSOR_COUNT; i++) {
+        const uint8_t sensorID = telemetryConfig()->flysky_sensors[i];
+        if (sensorID != IBUS_SENSOR_TYPE_NONE) {
+            setValue(measurementValues[bank][i], sensorID, getSensorLength(sensorID));
+        }
+    }
+    measurementBank = bank;
+}
+
 
 void initSharedIbusTelemetry(serialPort_t *port)
 {
@@ -81,6 +81,9 @@ typedef enum {
 #if defined(USE_TELEMETRY) && defined(USE_TELEMETRY_IBUS)
 
 uint8_t respondToIbusRequest(uint8_t const * const ibusPacket);
+// answers measurement requests from the values of the last prepareIbusMeasurements(), for use from the receive interrupt
+uint8_t respondToIbusRequestPrepared(uint8_t const * const ibusPacket);
+void prepareIbusMeasurements(void);
 void initSharedIbusTelemetry(serialPort_t * port);
 
 #endif //defined(TELEMETRY) && defined(TELEMETRY_IBUS)
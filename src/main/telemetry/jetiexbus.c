@@ -65,6 +65,9 @@
 #define EXTEL_MAX_PAYLOAD   (EXTEL_MAX_LEN - EXTEL_OVERHEAD)
 #define EXBUS_MAX_REQUEST_BUFFER_SIZE   (EXBUS_OVERHEAD + EXTEL_MAX_LEN)
 
+#define EXTEL_VALUE_TEMPLATE_COUNT  8       // value messages in one round of all the sensors
+#define EXTEL_VALUE_TEMPLATE_UNUSED 0xFF
+
 enum exTelHeader_e {
     EXTEL_HEADER_SYNC = 0,
     EXTEL_HEADER_TYPE_LEN,
@@ -173,10 +176,21 @@ union{
 
 #define JETI_EX_SENSOR_COUNT (ARRAYLEN(jetiExSensors))
 
+// A value message with the header and the sensor id and type bytes in place, so that a request
+// only patches the value bytes, and the CRC8 is recalculated only if any of them changed.
+typedef struct exValueTemplate_s {
+    uint8_t startItem;                          // EXTEL_VALUE_TEMPLATE_UNUSED for a free template
+    uint8_t nextItem;
+    uint8_t itemCount;
+    uint8_t items[EXTEL_MAX_PAYLOAD / 2];       // every item takes at least an id and a value byte
+    uint8_t message[EXTEL_MAX_LEN];
+} exValueTemplate_t;
+
 static uint8_t jetiExBusTelemetryFrame[40];
 static uint8_t jetiExBusTransceiveState = EXBUS_TRANS_RX;
 static uint8_t firstActiveSensor = 0;
 static uint32_t exSensorEnabled = 0;
+static exValueTemplate_t exValueTemplates[EXTEL_VALUE_TEMPLATE_COUNT];
 
 static uint8_t sendJetiExBusTelemetry(uint8_t packetID, uint8_t item);
 static uint8_t getNextActiveSensor(uint8_t currentSensor);
@@ -192,8 +206,18 @@ uint8_t calcCRC8(uint8_t *pt, uint8_t msgLen)
     return(crc);
 }
 
+// the messages are grouped by the enabled sensors, drop the templates when they change
+static void resetValueTemplates(void)
+{
+    for (unsigned i = 0; i < EXTEL_VALUE_TEMPLATE_COUNT; i++) {
+        exValueTemplates[i].startItem = EXTEL_VALUE_TEMPLATE_UNUSED;
+    }
+}
+
 void enableGpsTelemetry(bool enable)
 {
+    resetValueTemplates();
+
     if (enable) {
         bitArraySet(&exSensorEnabled, EX_GPS_SATS);
         bitArraySet(&exSensorEnabled, EX_GPS_LONG);
@@ -304,37 +328,39 @@ uint32_t calcGpsDDMMmmm(int32_t value, bool isLong)
 
 int32_t getSensorValue(uint8_t sensor)
 {
+    const telemetrySnapshot_t *snapshot = telemetryGetSnapshot();
+
     switch (sensor) {
     case EX_VOLTAGE:
         return getLegacyBatteryVoltage();
         break;
 
     case EX_CURRENT:
-        return getAmperage();
+        return snapshot->amperage;
         break;
 
     case EX_ALTITUDE:
-        return getEstimatedAltitudeCm();
+        return snapshot->estimatedAltitudeCm;
         break;
 
     case EX_CAPACITY:
-        return getMAhDrawn();
+        return snapshot->mAhDrawn;
         break;
 
     case EX_POWER:
-        return (getBatteryVoltage() * getAmperage() / 1000);
+        return (snapshot->batteryVoltage * snapshot->amperage / 1000);
         break;
 
     case EX_ROLL_ANGLE:
-        return attitude.values.roll;
+        return snapshot->roll;
         break;
 
     case EX_PITCH_ANGLE:
-        return attitude.values.pitch;
+        return snapshot->pitch;
         break;
 
     case EX_HEADING:
-        return attitude.values.yaw;
+        return snapshot->yaw;
         break;
 
 #ifdef USE_VARIO
@@ -409,33 +435,22 @@ uint8_t getNextActiveSensor(uint8_t currentSensor)
     return currentSensor;
 }
 
-uint8_t createExTelemetryValueMessage(uint8_t *exMessage, uint8_t item)
+static void buildValueTemplate(exValueTemplate_t *template, uint8_t item)
 {
-    uint8_t startItem = item;
-    uint8_t sensorItemMaxGroup = (item & 0xF0) + 0x10;
-    uint8_t iCount;
-    uint8_t messageSize;
-    uint32_t sensorValue;
+    uint8_t *exMessage = template->message;
+    const uint8_t startItem = item;
+    const uint8_t sensorItemMaxGroup = (item & 0xF0) + 0x10;
 
+    memcpy(exMessage, &jetiExBusTelemetryFrame[EXBUS_HEADER_DATA], EXTEL_HEADER_ID);
     exMessage[EXTEL_HEADER_LSN_LB] = item & 0xF0;                       // Device ID
     uint8_t *p = &exMessage[EXTEL_HEADER_ID];
 
+    template->startItem = startItem;
+    template->itemCount = 0;
     while (item < sensorItemMaxGroup) {
+        template->items[template->itemCount++] = item;
         *p++ = ((item & 0x0F) << 4) | jetiExSensors[item].exDataType;   // Sensor ID (%16) | EX Data Type
-
-        sensorValue = getSensorValue(item);
-        iCount = exDataTypeLen[jetiExSensors[item].exDataType];
-
-        while (iCount > 1) {
-            *p++ = sensorValue;
-            sensorValue = sensorValue >> 8;
-            iCount--;
-        }
-        if (jetiExSensors[item].exDataType != EX_TYPE_GPS) {
-            *p++ = (sensorValue & 0x9F) | jetiExSensors[item].decimals;
-        } else {
-            *p++ = sensorValue;
-        }
+        p += exDataTypeLen[jetiExSensors[item].exDataType];             // value, patched on every request
 
         item = getNextActiveSensor(item);
 
@@ -447,11 +462,79 @@ uint8_t createExTelemetryValueMessage(uint8_t *exMessage, uint8_t item)
             break;
         }
     }
-    messageSize = (EXTEL_HEADER_LEN + (p-&exMessage[EXTEL_HEADER_ID]));
+    template->nextItem = item;
+
+    const uint8_t messageSize = (EXTEL_HEADER_LEN + (p-&exMessage[EXTEL_HEADER_ID]));
     exMessage[EXTEL_HEADER_TYPE_LEN] = EXTEL_DATA_MSG | messageSize;
-    exMessage[messageSize + EXTEL_CRC_LEN] = calcCRC8(&exMessage[EXTEL_HEADER_TYPE_LEN], messageSize);
+}
+
+static exValueTemplate_t *findValueTemplate(uint8_t item, bool *created)
+{
+    exValueTemplate_t *template = NULL;
+
+    for (unsigned i = 0; i < EXTEL_VALUE_TEMPLATE_COUNT; i++) {
+        if (exValueTemplates[i].startItem == item) {
+            *created = false;
+            return &exValueTemplates[i];
+        }
+        if (!template && exValueTemplates[i].startItem == EXTEL_VALUE_TEMPLATE_UNUSED) {
+            template = &exValueTemplates[i];
+        }
+    }
+
+    if (!template) {
+        // a round takes more messages than expected, start collecting them again
+        resetValueTemplates();
+        template = &exValueTemplates[0];
+    }
+    buildValueTemplate(template, item);
+    *created = true;
+
+    return template;
+}
+
+// Writes the value bytes of the sensor, returns true if any of them changed
+static bool patchSensorValue(uint8_t *p, uint8_t item)
+{
+    uint32_t sensorValue = getSensorValue(item);
+    uint8_t iCount = exDataTypeLen[jetiExSensors[item].exDataType];
+    uint8_t changed = 0;
+
+    while (iCount > 1) {
+        changed |= *p ^ (uint8_t)sensorValue;
+        *p++ = sensorValue;
+        sensorValue = sensorValue >> 8;
+        iCount--;
+    }
+    if (jetiExSensors[item].exDataType != EX_TYPE_GPS) {
+        sensorValue = (sensorValue & 0x9F) | jetiExSensors[item].decimals;
+    }
+    changed |= *p ^ (uint8_t)sensorValue;
+    *p = sensorValue;
+
+    return changed;
+}
+
+uint8_t createExTelemetryValueMessage(uint8_t *exMessage, uint8_t item)
+{
+    bool changed;
+    exValueTemplate_t *template = findValueTemplate(item, &changed);
+    uint8_t *p = &template->message[EXTEL_HEADER_ID];
+
+    for (unsigned i = 0; i < template->itemCount; i++) {
+        const uint8_t sensorItem = template->items[i];
+        p++;                                                            // Sensor ID | EX Data Type
+        changed |= patchSensorValue(p, sensorItem);
+        p += exDataTypeLen[jetiExSensors[sensorItem].exDataType];
+    }
+
+    const uint8_t messageSize = template->message[EXTEL_HEADER_TYPE_LEN] & EXTEL_UNMASK_TYPE;
+    if (changed) {
+        template->message[messageSize + EXTEL_CRC_LEN] = calcCRC8(&template->message[EXTEL_HEADER_TYPE_LEN], messageSize);
+    }
+    memcpy(exMessage, template->message, messageSize + EXTEL_SYNC_LEN + EXTEL_CRC_LEN);
 
-    return item;        // return the next item
+    return template->nextItem;        // return the next item
 }
 
 void createExBusMessage(uint8_t *exBusMessage, uint8_t *exMessage, uint8_t packetID)
@@ -89,17 +89,33 @@ static bool ltmEnabled;
 static portSharing_e ltmPortSharing;
 static uint8_t ltm_crc;
 
+// '$', 'T', the frame id, up to 14 bytes of payload and the checksum
+#define LTM_FRAME_SIZE_MAX 18
+
+// the frame is built in place in the transmit buffer and sent once complete
+static uint8_t *ltmFrame;
+static uint8_t ltmFrameLength;
+
+static void ltm_write(uint8_t v)
+{
+    if (ltmFrame && ltmFrameLength < LTM_FRAME_SIZE_MAX) {
+        ltmFrame[ltmFrameLength++] = v;
+    }
+}
+
 static void ltm_initialise_packet(uint8_t ltm_id)
 {
     ltm_crc = 0;
-    serialWrite(ltmPort, '$');
-    serialWrite(ltmPort, 'T');
-    serialWrite(ltmPort, ltm_id);
+    ltmFrame = serialReserveWrite(ltmPort, LTM_FRAME_SIZE_MAX);
+    ltmFrameLength = 0;
+    ltm_write('$');
+    ltm_write('T');
+    ltm_write(ltm_id);
 }
 
 static void ltm_serialise_8(uint8_t v)
 {
-    serialWrite(ltmPort, v);
+    ltm_write(v);
     ltm_crc ^= v;
 }
 
@@ -119,7 +135,11 @@ static void ltm_serialise_32(uint32_t v)
 
 static void ltm_finalise(void)
 {
-    serialWrite(ltmPort, ltm_crc);
+    ltm_write(ltm_crc);
+    if (ltmFrame) {
+        serialCommitWrite(ltmPort, ltmFrameLength);
+        ltmFrame = NULL;
+    }
 }
 
 /*
@@ -130,7 +150,6 @@ static void ltm_gframe(void)
 {
 #if defined(USE_GPS)
     uint8_t gps_fix_type = 0;
-    int32_t ltm_alt;
 
     if (!sensors(SENSOR_GPS))
         return;
@@ -146,13 +165,7 @@ static void ltm_gframe(void)
     ltm_serialise_32(gpsSol.llh.lat);
     ltm_serialise_32(gpsSol.llh.lon);
     ltm_serialise_8((uint8_t)(gpsSol.groundSpeed / 100));
-
-#if defined(USE_BARO) || defined(USE_RANGEFINDER)
-    ltm_alt = (sensors(SENSOR_RANGEFINDER) || sensors(SENSOR_BARO)) ? getEstimatedAltitudeCm() : gpsSol.llh.altCm;
-#else
-    ltm_alt = gpsSol.llh.altCm;
-#endif
-    ltm_serialise_32(ltm_alt);
+    ltm_serialise_32(telemetryGetSnapshot()->altitudeCm);
     ltm_serialise_8((gpsSol.numSat << 2) | gps_fix_type);
     ltm_finalise();
 #endif
@@ -188,7 +201,7 @@ static void ltm_sframe(void)
     if (failsafeIsActive())
         lt_statemode |= 2;
     ltm_initialise_packet('S');
-    ltm_serialise_16(getBatteryVoltage() * 10);    //vbat converted to mV
+    ltm_serialise_16(telemetryGetSnapshot()->batteryVoltage * 10);    //vbat converted to mV
     ltm_serialise_16(0);             //  current, not implemented
     ltm_serialise_8(constrain(scaleRange(getRssi(), 0, RSSI_MAX_VALUE, 0, 255), 0, 255));        // scaled RSSI (uchar)
     ltm_serialise_8(0);              // no airspeed
@@ -202,10 +215,12 @@ static void ltm_sframe(void)
  */
 static void ltm_aframe(void)
 {
+    const telemetrySnapshot_t *snapshot = telemetryGetSnapshot();
+
     ltm_initialise_packet('A');
-    ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.pitch));
-    ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.roll));
-    ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+    ltm_serialise_16(DECIDEGREES_TO_DEGREES(snapshot->pitch));
+    ltm_serialise_16(DECIDEGREES_TO_DEGREES(snapshot->roll));
+    ltm_serialise_16(DECIDEGREES_TO_DEGREES(snapshot->yaw));
     ltm_finalise();
 }
 
@@ -74,12 +74,15 @@
 
 // mavlink library uses unnames unions that's causes GCC to complain if -Wpedantic is used
 // until this is resolved in mavlink library - ignore -Wpedantic for mavlink code
+// only a single link is used; the library reserves a parser buffer per channel
+#define MAVLINK_COMM_NUM_BUFFERS 1
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 #include "common/mavlink.h"
 #pragma GCC diagnostic pop
 
-#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_TX
+#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_RXTX
 #define TELEMETRY_MAVLINK_MAXRATE 50
 #define TELEMETRY_MAVLINK_DELAY ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
 
@@ -91,8 +94,8 @@ static serialPortConfig_t *portConfig;
 static bool mavlinkTelemetryEnabled =  false;
 static portSharing_e mavlinkPortSharing;
 
-/* MAVLink datastream rates in Hz */
-static const uint8_t mavRates[] = {
+/* MAVLink datastream rates in Hz, ground stations can change them with REQUEST_DATA_STREAM */
+static uint8_t mavRates[] = {
     [MAV_DATA_STREAM_EXTENDED_STATUS] = 2, //2Hz
     [MAV_DATA_STREAM_RC_CHANNELS] = 5, //5Hz
     [MAV_DATA_STREAM_POSITION] = 2, //2Hz
@@ -107,6 +110,12 @@ static mavlink_message_t mavMsg;
 static uint8_t mavBuffer[MAVLINK_MAX_PACKET_LEN];
 static uint32_t lastMavlinkMessage = 0;
 
+// All messages due in one telemetry tick are collected here and handed to the
+// serial driver in a single write, so a DMA capable UART sends them as one burst.
+#define MAVLINK_BATCH_SIZE (2 * MAVLINK_MAX_PACKET_LEN)
+static uint8_t mavBatch[MAVLINK_BATCH_SIZE];
+static uint16_t mavBatchLength = 0;
+
 static int mavlinkStreamTrigger(enum MAV_DATA_STREAM streamNum)
 {
     uint8_t rate = (uint8_t) mavRates[streamNum];
@@ -130,20 +139,72 @@ static int mavlinkStreamTrigger(enum MAV_DATA_STREAM streamNum)
 }
 
 
+static void mavlinkFlush(void)
+{
+    if (mavBatchLength) {
+        serialWriteBuf(mavlinkPort, mavBatch, mavBatchLength);
+        mavBatchLength = 0;
+    }
+}
+
 static void mavlinkSerialWrite(uint8_t * buf, uint16_t length)
 {
-    for (int i = 0; i < length; i++)
-        serialWrite(mavlinkPort, buf[i]);
+    if (mavBatchLength + length > MAVLINK_BATCH_SIZE) {
+        mavlinkFlush();
+    }
+    memcpy(&mavBatch[mavBatchLength], buf, length);
+    mavBatchLength += length;
+}
+
+static void mavlinkSetStreamRate(uint8_t streamNum, uint8_t rate)
+{
+    mavRates[streamNum] = MIN(rate, TELEMETRY_MAVLINK_MAXRATE);
+    mavTicks[streamNum] = 0;
+}
+
+static void mavlinkHandleRequestDataStream(const mavlink_message_t *msg)
+{
+    mavlink_request_data_stream_t request;
+    mavlink_msg_request_data_stream_decode(msg, &request);
+
+    const uint8_t rate = request.start_stop ? MIN(request.req_message_rate, UINT8_MAX) : 0;
+
+    if (request.req_stream_id == MAV_DATA_STREAM_ALL) {
+        for (unsigned i = 0; i < MAXSTREAMS; i++) {
+            mavlinkSetStreamRate(i, rate);
+        }
+    } else if (request.req_stream_id < MAXSTREAMS) {
+        mavlinkSetStreamRate(request.req_stream_id, rate);
+    }
+}
+
+static void mavlinkProcessIncoming(void)
+{
+    // a port shared with the receiver belongs to the RX parser
+    if (mavlinkPort == telemetrySharedPort) {
+        return;
+    }
+
+    mavlink_message_t msg;
+    mavlink_status_t status;
+
+    while (serialRxBytesWaiting(mavlinkPort)) {
+        if (mavlink_parse_char(MAVLINK_COMM_0, serialRead(mavlinkPort), &msg, &status)) {
+            if (msg.msgid == MAVLINK_MSG_ID_REQUEST_DATA_STREAM) {
+                mavlinkHandleRequestDataStream(&msg);
+            }
+        }
+    }
 }
 
 static int16_t headingOrScaledMilliAmpereHoursDrawn(void)
 {
     if (isAmperageConfigured() && telemetryConfig()->mavlink_mah_as_heading_divisor > 0) {
         // In the Connex Prosight OSD, this goes between 0 and 999, so it will need to be scaled in that range.
-        return getMAhDrawn() / telemetryConfig()->mavlink_mah_as_heading_divisor;
+        return telemetryGetSnapshot()->mAhDrawn / telemetryConfig()->mavlink_mah_as_heading_divisor;
     }
     // heading Current heading in degrees, in compass units (0..360, 0=north)
-    return DECIDEGREES_TO_DEGREES(attitude.values.yaw);
+    return DECIDEGREES_TO_DEGREES(telemetryGetSnapshot()->yaw);
 }
 
 
@@ -227,9 +288,10 @@ void mavlinkSendSystemStatus(void)
     int8_t batteryRemaining = 100;
 
     if (getBatteryState() < BATTERY_NOT_PRESENT) {
-        batteryVoltage = isBatteryVoltageConfigured() ? getBatteryVoltage() * 10 : batteryVoltage;
-        batteryAmperage = isAmperageConfigured() ? getAmperage() : batteryAmperage;
-        batteryRemaining = isBatteryVoltageConfigured() ? calculateBatteryPercentageRemaining() : batteryRemaining;
+        const telemetrySnapshot_t *snapshot = telemetryGetSnapshot();
+        batteryVoltage = isBatteryVoltageConfigured() ? snapshot->batteryVoltage * 10 : batteryVoltage;
+        batteryAmperage = isAmperageConfigured() ? snapshot->amperage : batteryAmperage;
+        batteryRemaining = isBatteryVoltageConfigured() ? snapshot->batteryRemaining : batteryRemaining;
     }
 
     mavlink_msg_sys_status_pack(0, 200, &mavMsg,
@@ -353,11 +415,7 @@ void mavlinkSendPosition(void)
         // alt Altitude in 1E3 meters (millimeters) above MSL
         gpsSol.llh.altCm * 10,
         // relative_alt Altitude above ground in meters, expressed as * 1000 (millimeters)
-#if defined(USE_BARO) || defined(USE_RANGEFINDER)
-        (sensors(SENSOR_RANGEFINDER) || sensors(SENSOR_BARO)) ? getEstimatedAltitudeCm() * 10 : gpsSol.llh.altCm * 10,
-#else
-        gpsSol.llh.altCm * 10,
-#endif
+        telemetryGetSnapshot()->altitudeCm * 10,
         // Ground X Speed (Latitude), expressed as m/s * 100
         0,
         // Ground Y Speed (Longitude), expressed as m/s * 100
@@ -385,15 +443,16 @@ void mavlinkSendPosition(void)
 void mavlinkSendAttitude(void)
 {
     uint16_t msgLength;
+    const telemetrySnapshot_t *snapshot = telemetryGetSnapshot();
     mavlink_msg_attitude_pack(0, 200, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
         // roll Roll angle (rad)
-        DECIDEGREES_TO_RADIANS(attitude.values.roll),
+        DECIDEGREES_TO_RADIANS(snapshot->roll),
         // pitch Pitch angle (rad)
-        DECIDEGREES_TO_RADIANS(-attitude.values.pitch),
+        DECIDEGREES_TO_RADIANS(-snapshot->pitch),
         // yaw Yaw angle (rad)
-        DECIDEGREES_TO_RADIANS(attitude.values.yaw),
+        DECIDEGREES_TO_RADIANS(snapshot->yaw),
         // rollspeed Roll angular speed (rad/s)
         0,
         // pitchspeed Pitch angular speed (rad/s)
@@ -407,7 +466,7 @@ void mavlinkSendAttitude(void)
 void mavlinkSendHUDAndHeartbeat(void)
 {
     uint16_t msgLength;
-    float mavAltitude = 0;
+    float mavAltitude;
     float mavGroundSpeed = 0;
     float mavAirSpeed = 0;
     float mavClimbRate = 0;
@@ -419,24 +478,8 @@ void mavlinkSendHUDAndHeartbeat(void)
     }
 #endif
 
-    // select best source for altitude
-#if defined(USE_BARO) || defined(USE_RANGEFINDER)
-    if (sensors(SENSOR_RANGEFINDER) || sensors(SENSOR_BARO)) {
-        // Baro or sonar generally is a better estimate of altitude than GPS MSL altitude
-        mavAltitude = getEstimatedAltitudeCm() / 100.0;
-    }
-#if defined(USE_GPS)
-    else if (sensors(SENSOR_GPS)) {
-        // No sonar or baro, just display altitude above MLS
-        mavAltitude = gpsSol.llh.altCm / 100.0;
-    }
-#endif
-#elif defined(USE_GPS)
-    if (sensors(SENSOR_GPS)) {
-        // No sonar or baro, just display altitude above MLS
-        mavAltitude = gpsSol.llh.altCm / 100.0;
-    }
-#endif
+    // Baro or sonar generally is a better estimate of altitude than GPS MSL altitude
+    mavAltitude = telemetryGetSnapshot()->altitudeCm / 100.0f;
 
     mavlink_msg_vfr_hud_pack(0, 200, &mavMsg,
         // airspeed Current airspeed in m/s
@@ -555,6 +598,8 @@ void processMAVLinkTelemetry(void)
     if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA2)) {
         mavlinkSendHUDAndHeartbeat();
     }
+
+    mavlinkFlush();
 }
 
 void handleMAVLinkTelemetry(void)
@@ -567,6 +612,8 @@ void handleMAVLinkTelemetry(void)
         return;
     }
 
+    mavlinkProcessIncoming();
+
     uint32_t now = micros();
     if ((now - lastMavlinkMessage) >= TELEMETRY_MAVLINK_DELAY) {
         processMAVLinkTelemetry();
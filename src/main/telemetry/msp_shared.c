@@ -28,6 +28,7 @@
 
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "msp/msp.h"
@@ -38,6 +39,8 @@
 #include "telemetry/smartport.h"
 
 #define TELEMETRY_MSP_VERSION    1
+#define TELEMETRY_MSP_VERSION_WINDOWED 2 // replies are sent as a window of numbered chunks that the host acknowledges
+#define TELEMETRY_MSP_WINDOW_ACK 3       // acknowledgement of windowed reply chunks from the host
 #define TELEMETRY_MSP_VER_SHIFT  5
 #define TELEMETRY_MSP_VER_MASK   (0x7 << TELEMETRY_MSP_VER_SHIFT)
 #define TELEMETRY_MSP_ERROR_FLAG (1 << 5)
@@ -47,6 +50,9 @@
 
 #define TELEMETRY_REQUEST_SKIPS_AFTER_EEPROMWRITE 5
 
+// Chunks sent but not yet acknowledged, at most half the sequence space so that acknowledgements are unambiguous
+#define TELEMETRY_MSP_WINDOW_SIZE 8
+
 enum {
     TELEMETRY_MSP_VER_MISMATCH=0,
     TELEMETRY_MSP_CRC_ERROR=1,
@@ -60,6 +66,17 @@ static mspTxBuffer_t mspTxBuffer;
 static mspPacket_t mspRxPacket;
 static mspPacket_t mspTxPacket;
 
+typedef struct mspWindow_s {
+    bool active;            // the request asked for a windowed reply
+    uint8_t chunkCount;     // 0 until the reply has been split into chunks
+    uint8_t base;           // oldest chunk not acknowledged
+    uint8_t next;           // next chunk never sent
+    uint8_t resend;         // chunks to send again, bit 0 is base
+    uint16_t streamLength;  // reply payload plus checksum
+} mspWindow_t;
+
+STATIC_UNIT_TESTED mspWindow_t mspWindow;
+
 void initSharedMsp(void)
 {
     mspPackage.requestBuffer = (uint8_t *)&mspRxBuffer;
@@ -101,11 +118,60 @@ void sendMspErrorResponse(uint8_t error, int16_t cmd)
     sbufSwitchToReader(&mspPackage.responsePacket->buf, mspPackage.responseBuffer);
 }
 
+static bool mspWindowCanSend(void)
+{
+    return mspWindow.resend
+        || (mspWindow.next < mspWindow.chunkCount && mspWindow.next - mspWindow.base < TELEMETRY_MSP_WINDOW_SIZE);
+}
+
+// The acknowledgement carries the oldest chunk the host is missing and a bitmap of the chunks after it
+// that did arrive. Chunks below the highest one received were lost and are sent again. When nothing
+// after the missing chunk arrived the acknowledgement doubles as a timeout and everything in flight is
+// sent again.
+static bool mspWindowAcknowledge(uint8_t missingSeq, uint8_t receivedAfter)
+{
+    const uint8_t advance = (missingSeq - mspWindow.base) & TELEMETRY_MSP_SEQ_MASK;
+    if (advance > mspWindow.next - mspWindow.base) {
+        return mspWindowCanSend(); // stale acknowledgement
+    }
+
+    mspWindow.base += advance;
+    mspWindow.resend >>= advance;
+
+    if (mspWindow.base >= mspWindow.chunkCount) {
+        // the whole reply has arrived
+        mspWindow.chunkCount = 0;
+        mspWindow.base = 0;
+        mspWindow.next = 0;
+        mspWindow.resend = 0;
+        mspPackage.responsePacket->buf.ptr = mspPackage.responsePacket->buf.end;
+        return false;
+    }
+
+    const uint8_t inFlight = mspWindow.next - mspWindow.base;
+    if (inFlight) {
+        const uint8_t inFlightMask = (1 << inFlight) - 1;
+        const uint8_t received = (receivedAfter << 1) & inFlightMask;
+        uint8_t lost = inFlightMask;
+        if (received) {
+            lost = ~received & ((1 << (31 - __builtin_clz(received))) - 1);
+        }
+        mspWindow.resend = (mspWindow.resend | lost) & ~received;
+    }
+
+    return mspWindowCanSend();
+}
+
 bool handleMspFrame(uint8_t *frameStart, int frameLength, uint8_t *skipsBeforeResponse)
 {
     static uint8_t mspStarted = 0;
     static uint8_t lastSeq = 0;
 
+    if (((frameStart[0] & TELEMETRY_MSP_VER_MASK) >> TELEMETRY_MSP_VER_SHIFT) == TELEMETRY_MSP_WINDOW_ACK) {
+        return mspWindow.active && mspWindow.chunkCount && frameLength > 1
+            && mspWindowAcknowledge(frameStart[0] & TELEMETRY_MSP_SEQ_MASK, frameStart[1]);
+    }
+
     if (sbufBytesRemaining(&mspPackage.responsePacket->buf) > 0) {
         mspStarted = 0;
     }
@@ -121,12 +187,17 @@ bool handleMspFrame(uint8_t *frameStart, int frameLength, uint8_t *skipsBeforeRe
     const uint8_t seqNumber = header & TELEMETRY_MSP_SEQ_MASK;
     const uint8_t version = (header & TELEMETRY_MSP_VER_MASK) >> TELEMETRY_MSP_VER_SHIFT;
 
-    if (version != TELEMETRY_MSP_VERSION) {
+    if (version != TELEMETRY_MSP_VERSION && version != TELEMETRY_MSP_VERSION_WINDOWED) {
+        mspWindow.active = false;
         sendMspErrorResponse(TELEMETRY_MSP_VER_MISMATCH, 0);
         return true;
     }
 
     if (header & TELEMETRY_MSP_START_FLAG) {
+        // a new request abandons any reply still in progress
+        memset(&mspWindow, 0, sizeof(mspWindow));
+        mspWindow.active = version == TELEMETRY_MSP_VERSION_WINDOWED;
+
         // first packet in sequence
         uint8_t mspPayloadSize = sbufReadU8(frameBuf);
 
@@ -184,8 +255,74 @@ bool handleMspFrame(uint8_t *frameStart, int frameLength, uint8_t *skipsBeforeRe
     return true;
 }
 
+// Windowed replies are a stream of the payload followed by the checksum, split into chunks numbered
+// from 0. The first chunk also carries the payload size.
+static bool sendMspWindowedReply(uint8_t payloadSize, mspResponseFnPtr responseFn)
+{
+    sbuf_t *txBuf = &mspPackage.responsePacket->buf;
+    const uint8_t firstChunkSize = payloadSize - 2;
+    const uint8_t chunkSize = payloadSize - 1;
+
+    if (!mspWindow.chunkCount) {
+        const uint8_t size = sbufBytesRemaining(txBuf);
+        uint8_t replyChecksum = size ^ mspPackage.responsePacket->cmd;
+        for (int i = 0; i < size; i++) {
+            replyChecksum ^= mspPackage.responseBuffer[i];
+        }
+        mspPackage.responseBuffer[size] = replyChecksum;
+        mspWindow.streamLength = size + 1;
+        mspWindow.chunkCount = 1;
+        if (mspWindow.streamLength > firstChunkSize) {
+            mspWindow.chunkCount += (mspWindow.streamLength - firstChunkSize + chunkSize - 1) / chunkSize;
+        }
+    }
+
+    uint8_t chunk;
+    if (mspWindow.resend) {
+        const uint8_t offset = __builtin_ctz(mspWindow.resend);
+        mspWindow.resend &= ~(1 << offset);
+        chunk = mspWindow.base + offset;
+    } else if (mspWindowCanSend()) {
+        chunk = mspWindow.next++;
+    } else {
+        return false; // window full, wait for the host to acknowledge
+    }
+
+    uint8_t payloadOut[payloadSize];
+    memset(payloadOut, 0, payloadSize);
+    sbuf_t payload;
+    sbuf_t *payloadBuf = sbufInit(&payload, payloadOut, payloadOut + payloadSize);
+
+    uint8_t head = chunk & TELEMETRY_MSP_SEQ_MASK;
+    uint16_t offset;
+    uint8_t room;
+    if (chunk == 0) {
+        head |= TELEMETRY_MSP_START_FLAG;
+        if (mspPackage.responsePacket->result < 0) {
+            head |= TELEMETRY_MSP_ERROR_FLAG;
+        }
+        sbufWriteU8(payloadBuf, head);
+        sbufWriteU8(payloadBuf, mspWindow.streamLength - 1);
+        offset = 0;
+        room = firstChunkSize;
+    } else {
+        sbufWriteU8(payloadBuf, head);
+        offset = firstChunkSize + (chunk - 1) * chunkSize;
+        room = chunkSize;
+    }
+    sbufWriteData(payloadBuf, mspPackage.responseBuffer + offset, MIN(room, mspWindow.streamLength - offset));
+
+    responseFn(payloadOut);
+
+    return mspWindowCanSend();
+}
+
 bool sendMspReply(uint8_t payloadSize, mspResponseFnPtr responseFn)
 {
+    if (mspWindow.active) {
+        return sendMspWindowedReply(payloadSize, responseFn);
+    }
+
     static uint8_t checksum = 0;
     static uint8_t seq = 0;
 
@@ -272,39 +272,55 @@ smartPortPayload_t *smartPortDataReceive(uint16_t c, bool *clearToSend, smartPor
     return NULL;
 }
 
-void smartPortSendByte(uint8_t c, uint16_t *checksum, serialPort_t *port)
+bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload)
+{
+    return payload->frameId == FSSP_MSPC_FRAME_SMARTPORT || payload->frameId == FSSP_MSPC_FRAME_FPORT;
+}
+
+static uint8_t *smartPortEncodeByte(uint8_t c, uint16_t *checksum, uint8_t *buf)
 {
     // smart port escape sequence
     if (c == FSSP_DLE || c == FSSP_START_STOP) {
-        serialWrite(port, FSSP_DLE);
-        serialWrite(port, c ^ FSSP_DLE_XOR);
+        *buf++ = FSSP_DLE;
+        *buf++ = c ^ FSSP_DLE_XOR;
     } else {
-        serialWrite(port, c);
+        *buf++ = c;
     }
 
     if (checksum != NULL) {
         *checksum += c;
     }
-}
 
-bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload)
-{
-    return payload->frameId == FSSP_MSPC_FRAME_SMARTPORT || payload->frameId == FSSP_MSPC_FRAME_FPORT;
+    return buf;
 }
 
-void smartPortWriteFrameSerial(const smartPortPayload_t *payload, serialPort_t *port, uint16_t checksum)
+// Escapes and checksums the header bytes and the payload, the frame is built in place and sent with one write
+void smartPortWriteFrameSerial(const smartPortPayload_t *payload, serialPort_t *port, const uint8_t *header, unsigned headerLength)
 {
-    uint8_t *data = (uint8_t *)payload;
+    // every byte, the checksum included, may need to be escaped
+    uint8_t * const frame = serialReserveWrite(port, 2 * (headerLength + sizeof(smartPortPayload_t) + 1));
+    if (!frame) {
+        return;
+    }
+
+    uint8_t *p = frame;
+    uint16_t checksum = 0;
+    for (unsigned i = 0; i < headerLength; i++) {
+        p = smartPortEncodeByte(header[i], &checksum, p);
+    }
+    const uint8_t *data = (const uint8_t *)payload;
     for (unsigned i = 0; i < sizeof(smartPortPayload_t); i++) {
-        smartPortSendByte(*data++, &checksum, port);
+        p = smartPortEncodeByte(*data++, &checksum, p);
     }
     checksum = 0xff - ((checksum & 0xff) + (checksum >> 8));
-    smartPortSendByte((uint8_t)checksum, NULL, port);
+    p = smartPortEncodeByte((uint8_t)checksum, NULL, p);
+
+    serialCommitWrite(port, p - frame);
 }
 
 static void smartPortWriteFrameInternal(const smartPortPayload_t *payload)
 {
-    smartPortWriteFrameSerial(payload, smartPortSerialPort, 0);
+    smartPortWriteFrameSerial(payload, smartPortSerialPort, NULL, 0);
 }
 
 static void smartPortSendPackage(uint16_t id, uint32_t val)
@@ -800,7 +800,7 @@ void handleSrxlTelemetry(timeUs_t currentTimeUs)
 {
   if (srxl2) {
 #if defined(USE_SERIALRX_SRXL2)
-      if (srxl2TelemetryRequested()) {
+      if (srxl2TelemetryBufferEmpty()) {
           processSrxl(currentTimeUs);
       }
 #endif
@@ -36,16 +36,24 @@
 #include "drivers/serial.h"
 #include "drivers/serial_softserial.h"
 
+#include "io/gps.h"
 #include "io/serial.h"
 
 #include "fc/config.h"
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
 
+#include "flight/imu.h"
+#include "flight/position.h"
+
 #include "msp/msp_serial.h"
 
 #include "rx/rx.h"
 
+#include "sensors/battery.h"
+#include "sensors/sample_bus.h"
+#include "sensors/sensors.h"
+
 #include "telemetry/telemetry.h"
 #include "telemetry/frsky_hub.h"
 #include "telemetry/hott.h"
@@ -191,8 +199,57 @@ void telemetryCheckState(void)
 #endif
 }
 
+static telemetrySnapshot_t telemetrySnapshot;
+static bool telemetrySnapshotValid;
+
+const telemetrySnapshot_t *telemetryGetSnapshot(void)
+{
+    if (telemetrySnapshotValid) {
+        return &telemetrySnapshot;
+    }
+
+    // the samples keep their last good copy if a read fails, and read as zero until the first publish
+    static attitudeSample_t attitudeSample;
+    sampleRead(SAMPLE_ATTITUDE, &attitudeSample, NULL);
+    telemetrySnapshot.roll = attitudeSample.roll;
+    telemetrySnapshot.pitch = attitudeSample.pitch;
+    telemetrySnapshot.yaw = attitudeSample.yaw;
+
+    static batterySample_t batterySample;
+    sampleRead(SAMPLE_BATTERY, &batterySample, NULL);
+    telemetrySnapshot.batteryVoltage = batterySample.voltage;
+    telemetrySnapshot.amperage = batterySample.amperage;
+    telemetrySnapshot.mAhDrawn = batterySample.mAhDrawn;
+    telemetrySnapshot.batteryRemaining = calculateBatteryPercentageRemaining();
+
+    static altitudeSample_t altitudeSample;
+    sampleRead(SAMPLE_ALTITUDE, &altitudeSample, NULL);
+    telemetrySnapshot.estimatedAltitudeCm = altitudeSample.estimatedAltitudeCm;
+    telemetrySnapshot.altitudeCm = 0;
+#if defined(USE_BARO) || defined(USE_RANGEFINDER)
+    if (sensors(SENSOR_RANGEFINDER) || sensors(SENSOR_BARO)) {
+        telemetrySnapshot.altitudeCm = telemetrySnapshot.estimatedAltitudeCm;
+    } else
+#endif
+    {
+#ifdef USE_GPS
+        static gpsSample_t gpsSample;
+        if (sensors(SENSOR_GPS)) {
+            sampleRead(SAMPLE_GPS, &gpsSample, NULL);
+            telemetrySnapshot.altitudeCm = gpsSample.altCm;
+        }
+#endif
+    }
+
+    telemetrySnapshotValid = true;
+
+    return &telemetrySnapshot;
+}
+
 void telemetryProcess(uint32_t currentTime)
 {
+    telemetrySnapshotValid = false;
+
 #ifdef USE_TELEMETRY_FRSKY_HUB
     handleFrSkyHubTelemetry(currentTime);
 #else
@@ -87,6 +87,21 @@ typedef struct telemetryConfig_s {
 
 PG_DECLARE(telemetryConfig_t, telemetryConfig);
 
+// Flight values shared by the telemetry encoders. The snapshot is sampled on
+// first use in each telemetry task run, so every frame built in that run
+// reports the same state and the sources are read only once.
+typedef struct telemetrySnapshot_s {
+    int16_t roll;               // decidegrees
+    int16_t pitch;              // decidegrees
+    int16_t yaw;                // decidegrees, 0..3599
+    uint16_t batteryVoltage;    // 0.01V
+    int32_t amperage;           // 0.01A
+    int32_t mAhDrawn;
+    uint8_t batteryRemaining;   // percent
+    int32_t estimatedAltitudeCm;
+    int32_t altitudeCm;         // best available source: baro/rangefinder estimate, else GPS MSL
+} telemetrySnapshot_t;
+
 extern serialPort_t *telemetrySharedPort;
 
 void telemetryInit(void);
@@ -98,3 +113,5 @@ void telemetryProcess(uint32_t currentTime);
 bool telemetryDetermineEnabledState(portSharing_e portSharing);
 
 bool telemetryIsSensorEnabled(sensor_e sensor);
+
+const telemetrySnapshot_t *telemetryGetSnapshot(void);
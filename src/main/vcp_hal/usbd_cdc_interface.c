@@ -47,10 +47,14 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include <string.h>
+
 #include "platform.h"
 
 #include "build/atomic.h"
 
+#include "common/maths.h"
+
 #include "usbd_conf.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
@@ -67,7 +71,7 @@
 #define APP_RX_DATA_SIZE  2048
 #define APP_TX_DATA_SIZE  2048
 
-#define APP_TX_BLOCK_SIZE 512
+#define APP_TX_BLOCK_SIZE 1024
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -400,15 +404,24 @@ uint32_t CDC_Send_FreeBytes(void)
  */
 uint32_t CDC_Send_DATA(const uint8_t *ptrBuffer, uint32_t sendLength)
 {
-    for (uint32_t i = 0; i < sendLength; i++) {
-        while (CDC_Send_FreeBytes() == 0) {
+    // Copy each contiguous run at once and publish it with a single update of UserTxBufPtrIn,
+    // the transfer that is in flight only reads up to the value it saw when it started
+    uint32_t remaining = sendLength;
+    while (remaining > 0) {
+        uint32_t freeBytes;
+        while ((freeBytes = CDC_Send_FreeBytes()) == 0) {
             // block until there is free space in the ring buffer
             delay(1);
         }
+
+        const uint32_t run = MIN(MIN(remaining, freeBytes), APP_TX_DATA_SIZE - UserTxBufPtrIn);
+        memcpy((uint8_t *)&UserTxBuffer[UserTxBufPtrIn], ptrBuffer, run);
         ATOMIC_BLOCK(NVIC_BUILD_PRIORITY(6, 0)) { // Paranoia
-            UserTxBuffer[UserTxBufPtrIn] = ptrBuffer[i];
-            UserTxBufPtrIn = (UserTxBufPtrIn + 1) % APP_TX_DATA_SIZE;
+            UserTxBufPtrIn = (UserTxBufPtrIn + run) % APP_TX_DATA_SIZE;
         }
+
+        ptrBuffer += run;
+        remaining -= run;
     }
     return sendLength;
 }
@@ -0,0 +1,480 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Composite device with the CDC VCP used by the CLI and a vendor specific
+ * bulk interface that carries MSP only, so that high rate MSP streaming and
+ * dataflash reads do not share a pipe with the interactive CLI.
+ */
+
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_USB_MSP_BULK
+
+#include "build/atomic.h"
+
+#include "common/maths.h"
+
+#include "drivers/nvic.h"
+
+#include "usbd_conf.h"
+#include "usbd_desc.h"
+#include "usbd_ctlreq.h"
+#include "usbd_ioreq.h"
+#include "usbd_def.h"
+
+#include "usbd_cdc.h"
+#include "usbd_cdc_msp.h"
+
+#define USB_CDC_MSP_CONFIG_DESC_SIZ  (USB_CDC_CONFIG_DESC_SIZ + 8 + 9 + 7 + 7)
+
+#define CDC_COM_INTERFACE   0x0
+#define CDC_DATA_INTERFACE  0x1
+#define MSP_INTERFACE       0x2
+
+#define MSP_IN_EP           0x83
+#define MSP_OUT_EP          0x03
+#define MSP_PACKET_SIZE     64
+
+// Largest single IN transfer, split into packets by the core
+#define MSP_TX_BLOCK_SIZE   512
+
+#define MSP_RX_BUFFER_SIZE  1024
+#define MSP_TX_BUFFER_SIZE  2048
+
+#define USBD_VID             0x0483
+#define USBD_PID             0x3257
+
+__ALIGN_BEGIN uint8_t USBD_CDC_MSP_DeviceDescriptor[USB_LEN_DEV_DESC] __ALIGN_END =
+{
+  0x12,                                    /* bLength */
+  USB_DESC_TYPE_DEVICE,                    /* bDescriptorType */
+  0x00, 0x02,                              /* bcdUSB */
+  0xEF,                                    /* bDeviceClass: Miscellaneous, uses IAD */
+  0x02,                                    /* bDeviceSubClass */
+  0x01,                                    /* bDeviceProtocol */
+  USB_MAX_EP0_SIZE,                        /* bMaxPacketSize */
+  LOBYTE(USBD_VID), HIBYTE(USBD_VID),      /* idVendor */
+  LOBYTE(USBD_PID), HIBYTE(USBD_PID),      /* idProduct */
+  0x00, 0x02,                              /* bcdDevice rel. 2.00 */
+  USBD_IDX_MFC_STR,                        /* Index of manufacturer string */
+  USBD_IDX_PRODUCT_STR,                    /* Index of product string */
+  USBD_IDX_SERIAL_STR,                     /* Index of serial number string */
+  USBD_MAX_NUM_CONFIGURATION               /* bNumConfigurations */
+};
+
+__ALIGN_BEGIN static uint8_t USBD_CDC_MSP_CfgDesc[USB_CDC_MSP_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  0x09,                                    /* bLength: Configuration Descriptor size */
+  USB_DESC_TYPE_CONFIGURATION,             /* bDescriptorType: Configuration */
+  USB_CDC_MSP_CONFIG_DESC_SIZ,             /* wTotalLength */
+  0x00,
+  0x03,                                    /* bNumInterfaces: 2 for CDC, 1 for MSP */
+  0x01,                                    /* bConfigurationValue */
+  0x00,                                    /* iConfiguration */
+  0xC0,                                    /* bmAttributes: self powered */
+  0x32,                                    /* MaxPower 100 mA */
+
+  /* IAD to associate the two CDC interfaces */
+  0x08,                                    /* bLength */
+  0x0B,                                    /* bDescriptorType: IAD */
+  CDC_COM_INTERFACE,                       /* bFirstInterface */
+  0x02,                                    /* bInterfaceCount */
+  0x02,                                    /* bFunctionClass */
+  0x02,                                    /* bFunctionSubClass */
+  0x01,                                    /* bFunctionProtocol */
+  0x00,                                    /* iFunction */
+
+  /* CDC communication interface */
+  0x09,                                    /* bLength */
+  USB_DESC_TYPE_INTERFACE,                 /* bDescriptorType */
+  CDC_COM_INTERFACE,                       /* bInterfaceNumber */
+  0x00,                                    /* bAlternateSetting */
+  0x01,                                    /* bNumEndpoints */
+  0x02,                                    /* bInterfaceClass: Communication Interface Class */
+  0x02,                                    /* bInterfaceSubClass: Abstract Control Model */
+  0x01,                                    /* bInterfaceProtocol: Common AT commands */
+  0x00,                                    /* iInterface */
+
+  /* Header Functional Descriptor */
+  0x05,                                    /* bLength */
+  0x24,                                    /* bDescriptorType: CS_INTERFACE */
+  0x00,                                    /* bDescriptorSubtype: Header Func Desc */
+  0x10,                                    /* bcdCDC: spec release number */
+  0x01,
+
+  /* Call Management Functional Descriptor */
+  0x05,                                    /* bFunctionLength */
+  0x24,                                    /* bDescriptorType: CS_INTERFACE */
+  0x01,                                    /* bDescriptorSubtype: Call Management Func Desc */
+  0x00,                                    /* bmCapabilities: D0+D1 */
+  CDC_DATA_INTERFACE,                      /* bDataInterface */
+
+  /* ACM Functional Descriptor */
+  0x04,                                    /* bFunctionLength */
+  0x24,                                    /* bDescriptorType: CS_INTERFACE */
+  0x02,                                    /* bDescriptorSubtype: Abstract Control Management desc */
+  0x02,                                    /* bmCapabilities */
+
+  /* Union Functional Descriptor */
+  0x05,                                    /* bFunctionLength */
+  0x24,                                    /* bDescriptorType: CS_INTERFACE */
+  0x06,                                    /* bDescriptorSubtype: Union func desc */
+  CDC_COM_INTERFACE,                       /* bMasterInterface: Communication class interface */
+  CDC_DATA_INTERFACE,                      /* bSlaveInterface0: Data Class Interface */
+
+  /* CDC command endpoint */
+  0x07,                                    /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                  /* bDescriptorType: Endpoint */
+  CDC_CMD_EP,                              /* bEndpointAddress */
+  0x03,                                    /* bmAttributes: Interrupt */
+  LOBYTE(CDC_CMD_PACKET_SIZE),             /* wMaxPacketSize */
+  HIBYTE(CDC_CMD_PACKET_SIZE),
+  0xFF,                                    /* bInterval */
+
+  /* CDC data interface */
+  0x09,                                    /* bLength */
+  USB_DESC_TYPE_INTERFACE,                 /* bDescriptorType */
+  CDC_DATA_INTERFACE,                      /* bInterfaceNumber */
+  0x00,                                    /* bAlternateSetting */
+  0x02,                                    /* bNumEndpoints */
+  0x0A,                                    /* bInterfaceClass: CDC */
+  0x00,                                    /* bInterfaceSubClass */
+  0x00,                                    /* bInterfaceProtocol */
+  0x00,                                    /* iInterface */
+
+  /* CDC data OUT endpoint */
+  0x07,                                    /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                  /* bDescriptorType: Endpoint */
+  CDC_OUT_EP,                              /* bEndpointAddress */
+  0x02,                                    /* bmAttributes: Bulk */
+  LOBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),     /* wMaxPacketSize */
+  HIBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),
+  0x00,                                    /* bInterval: ignored for Bulk transfer */
+
+  /* CDC data IN endpoint */
+  0x07,                                    /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                  /* bDescriptorType: Endpoint */
+  CDC_IN_EP,                               /* bEndpointAddress */
+  0x02,                                    /* bmAttributes: Bulk */
+  LOBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),     /* wMaxPacketSize */
+  HIBYTE(CDC_DATA_FS_MAX_PACKET_SIZE),
+  0x00,                                    /* bInterval */
+
+  /* MSP vendor specific interface */
+  0x09,                                    /* bLength */
+  USB_DESC_TYPE_INTERFACE,                 /* bDescriptorType */
+  MSP_INTERFACE,                           /* bInterfaceNumber */
+  0x00,                                    /* bAlternateSetting */
+  0x02,                                    /* bNumEndpoints */
+  0xFF,                                    /* bInterfaceClass: Vendor specific */
+  0x00,                                    /* bInterfaceSubClass */
+  0x00,                                    /* bInterfaceProtocol */
+  0x00,                                    /* iInterface */
+
+  /* MSP OUT endpoint */
+  0x07,                                    /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                  /* bDescriptorType: Endpoint */
+  MSP_OUT_EP,                              /* bEndpointAddress */
+  0x02,                                    /* bmAttributes: Bulk */
+  LOBYTE(MSP_PACKET_SIZE),                 /* wMaxPacketSize */
+  HIBYTE(MSP_PACKET_SIZE),
+  0x00,                                    /* bInterval */
+
+  /* MSP IN endpoint */
+  0x07,                                    /* bLength */
+  USB_DESC_TYPE_ENDPOINT,                  /* bDescriptorType: Endpoint */
+  MSP_IN_EP,                               /* bEndpointAddress */
+  0x02,                                    /* bmAttributes: Bulk */
+  LOBYTE(MSP_PACKET_SIZE),                 /* wMaxPacketSize */
+  HIBYTE(MSP_PACKET_SIZE),
+  0x00,                                    /* bInterval */
+};
+
+__ALIGN_BEGIN static uint8_t USBD_CDC_MSP_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+  USB_LEN_DEV_QUALIFIER_DESC,
+  USB_DESC_TYPE_DEVICE_QUALIFIER,
+  0x00,
+  0x02,
+  0x00,
+  0x00,
+  0x00,
+  0x40,
+  0x01,
+  0x00,
+};
+
+static USBD_HandleTypeDef *mspDev;
+
+// OUT packets are received into mspRxPacket and copied into the receive ring. Reception stalls,
+// and the host is NAKed, while the ring has no room for a full packet.
+__ALIGN_BEGIN static uint8_t mspRxPacket[MSP_PACKET_SIZE] __ALIGN_END;
+static uint8_t mspRxBuffer[MSP_RX_BUFFER_SIZE];
+static volatile uint32_t mspRxHead;
+static volatile uint32_t mspRxTail;
+static volatile bool mspRxStalled;
+
+// IN transfers are sent straight from the transmit ring, the tail only moves when a transfer completes
+static uint8_t mspTxBuffer[MSP_TX_BUFFER_SIZE];
+static volatile uint32_t mspTxHead;
+static volatile uint32_t mspTxTail;
+static volatile uint32_t mspTxLength;
+static volatile bool mspTxBusy;
+
+static volatile bool mspConfigured;
+
+static uint8_t USBD_CDC_MSP_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t USBD_CDC_MSP_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t USBD_CDC_MSP_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+static uint8_t USBD_CDC_MSP_EP0_RxReady(USBD_HandleTypeDef *pdev);
+static uint8_t USBD_CDC_MSP_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t USBD_CDC_MSP_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t *USBD_CDC_MSP_GetFSCfgDesc(uint16_t *length);
+static uint8_t *USBD_CDC_MSP_GetDeviceQualifierDescriptor(uint16_t *length);
+
+USBD_ClassTypeDef USBD_CDC_MSP =
+{
+    USBD_CDC_MSP_Init,
+    USBD_CDC_MSP_DeInit,
+    USBD_CDC_MSP_Setup,
+    NULL,                 /* EP0_TxSent */
+    USBD_CDC_MSP_EP0_RxReady,
+    USBD_CDC_MSP_DataIn,
+    USBD_CDC_MSP_DataOut,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    USBD_CDC_MSP_GetFSCfgDesc,
+    NULL,
+    USBD_CDC_MSP_GetDeviceQualifierDescriptor,
+};
+
+static uint32_t mspRxFree(void)
+{
+    return MSP_RX_BUFFER_SIZE - 1 - ((mspRxHead - mspRxTail) & (MSP_RX_BUFFER_SIZE - 1));
+}
+
+// Called from the USB interrupt or with it masked
+static void mspStartTransmit(void)
+{
+    if (mspTxBusy || !mspConfigured || mspTxHead == mspTxTail) {
+        return;
+    }
+
+    const uint32_t tail = mspTxTail;
+    const uint32_t length = MIN(tail < mspTxHead ? mspTxHead - tail : MSP_TX_BUFFER_SIZE - tail, MSP_TX_BLOCK_SIZE);
+
+    mspTxLength = length;
+    mspTxBusy = true;
+    USBD_LL_Transmit(mspDev, MSP_IN_EP, &mspTxBuffer[tail], length);
+}
+
+static uint8_t USBD_CDC_MSP_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    USBD_CDC.Init(pdev, cfgidx);
+
+    mspDev = pdev;
+
+    USBD_LL_OpenEP(pdev, MSP_IN_EP, USBD_EP_TYPE_BULK, MSP_PACKET_SIZE);
+    pdev->ep_in[MSP_IN_EP & 0xFU].is_used = 1U;
+    USBD_LL_OpenEP(pdev, MSP_OUT_EP, USBD_EP_TYPE_BULK, MSP_PACKET_SIZE);
+    pdev->ep_out[MSP_OUT_EP & 0xFU].is_used = 1U;
+
+    mspRxHead = mspRxTail = 0;
+    mspRxStalled = false;
+    mspTxHead = mspTxTail = 0;
+    mspTxBusy = false;
+    mspConfigured = true;
+
+    USBD_LL_PrepareReceive(pdev, MSP_OUT_EP, mspRxPacket, MSP_PACKET_SIZE);
+
+    return USBD_OK;
+}
+
+static uint8_t USBD_CDC_MSP_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+    USBD_CDC.DeInit(pdev, cfgidx);
+
+    mspConfigured = false;
+
+    USBD_LL_CloseEP(pdev, MSP_IN_EP);
+    pdev->ep_in[MSP_IN_EP & 0xFU].is_used = 0U;
+    USBD_LL_CloseEP(pdev, MSP_OUT_EP);
+    pdev->ep_out[MSP_OUT_EP & 0xFU].is_used = 0U;
+
+    return USBD_OK;
+}
+
+static uint8_t USBD_CDC_MSP_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+    static uint8_t mspAltSetting = 0;
+
+    switch (req->bmRequest & USB_REQ_RECIPIENT_MASK) {
+    case USB_REQ_RECIPIENT_INTERFACE:
+        if (req->wIndex == MSP_INTERFACE) {
+            // The MSP interface has no class requests and a single alternate setting
+            if ((req->bmRequest & USB_REQ_TYPE_MASK) == USB_REQ_TYPE_STANDARD && req->bRequest == USB_REQ_GET_INTERFACE) {
+                USBD_CtlSendData(pdev, &mspAltSetting, 1);
+            }
+            return USBD_OK;
+        }
+        return USBD_CDC.Setup(pdev, req);
+    case USB_REQ_RECIPIENT_ENDPOINT:
+        if ((req->wIndex & 0x7F) == (MSP_IN_EP & 0x7F)) {
+            return USBD_OK;
+        }
+        return USBD_CDC.Setup(pdev, req);
+    }
+
+    return USBD_OK;
+}
+
+static uint8_t USBD_CDC_MSP_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+    return USBD_CDC.EP0_RxReady(pdev);
+}
+
+static uint8_t USBD_CDC_MSP_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    if (epnum != (MSP_IN_EP & 0x7F)) {
+        return USBD_CDC.DataIn(pdev, epnum);
+    }
+
+    const uint32_t length = mspTxLength;
+    mspTxTail = (mspTxTail + length) % MSP_TX_BUFFER_SIZE;
+    mspTxLength = 0;
+    mspTxBusy = false;
+
+    if (mspTxHead == mspTxTail && length && (length % MSP_PACKET_SIZE) == 0) {
+        // End the transfer with a zero length packet so the host returns the data it has
+        mspTxBusy = true;
+        USBD_LL_Transmit(pdev, MSP_IN_EP, NULL, 0);
+    } else {
+        mspStartTransmit();
+    }
+
+    return USBD_OK;
+}
+
+static uint8_t USBD_CDC_MSP_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+    if (epnum != (MSP_OUT_EP & 0x7F)) {
+        return USBD_CDC.DataOut(pdev, epnum);
+    }
+
+    const uint32_t count = USBD_LL_GetRxDataSize(pdev, epnum);
+    uint32_t head = mspRxHead;
+    for (uint32_t i = 0; i < count; i++) {
+        mspRxBuffer[head] = mspRxPacket[i];
+        head = (head + 1) % MSP_RX_BUFFER_SIZE;
+    }
+    mspRxHead = head;
+
+    if (mspRxFree() >= MSP_PACKET_SIZE) {
+        USBD_LL_PrepareReceive(pdev, MSP_OUT_EP, mspRxPacket, MSP_PACKET_SIZE);
+    } else {
+        mspRxStalled = true;
+    }
+
+    return USBD_OK;
+}
+
+static uint8_t *USBD_CDC_MSP_GetFSCfgDesc(uint16_t *length)
+{
+    *length = sizeof(USBD_CDC_MSP_CfgDesc);
+    return USBD_CDC_MSP_CfgDesc;
+}
+
+static uint8_t *USBD_CDC_MSP_GetDeviceQualifierDescriptor(uint16_t *length)
+{
+    *length = sizeof(USBD_CDC_MSP_DeviceQualifierDesc);
+    return USBD_CDC_MSP_DeviceQualifierDesc;
+}
+
+bool usbMspIsConfigured(void)
+{
+    return mspConfigured;
+}
+
+uint32_t usbMspRxBytesAvailable(void)
+{
+    return (mspRxHead - mspRxTail) & (MSP_RX_BUFFER_SIZE - 1);
+}
+
+uint32_t usbMspRead(uint8_t *buf, uint32_t len)
+{
+    uint32_t count = 0;
+    uint32_t tail = mspRxTail;
+    while (count < len && tail != mspRxHead) {
+        buf[count++] = mspRxBuffer[tail];
+        tail = (tail + 1) % MSP_RX_BUFFER_SIZE;
+    }
+    mspRxTail = tail;
+
+    if (mspRxStalled && mspRxFree() >= MSP_PACKET_SIZE) {
+        ATOMIC_BLOCK(NVIC_BUILD_PRIORITY(6, 0)) {
+            mspRxStalled = false;
+            USBD_LL_PrepareReceive(mspDev, MSP_OUT_EP, mspRxPacket, MSP_PACKET_SIZE);
+        }
+    }
+
+    return count;
+}
+
+uint32_t usbMspTxBytesFree(void)
+{
+    return MSP_TX_BUFFER_SIZE - 1 - ((mspTxHead - mspTxTail) & (MSP_TX_BUFFER_SIZE - 1));
+}
+
+// Copies as much as fits without blocking, the host may not be reading the MSP interface at all
+uint32_t usbMspWrite(const uint8_t *buf, uint32_t len)
+{
+    if (!mspConfigured) {
+        return 0;
+    }
+
+    len = MIN(len, usbMspTxBytesFree());
+
+    uint32_t remaining = len;
+    while (remaining > 0) {
+        const uint32_t head = mspTxHead;
+        const uint32_t run = MIN(remaining, MSP_TX_BUFFER_SIZE - head);
+        memcpy(&mspTxBuffer[head], buf, run);
+        mspTxHead = (head + run) % MSP_TX_BUFFER_SIZE;
+        buf += run;
+        remaining -= run;
+    }
+
+    ATOMIC_BLOCK(NVIC_BUILD_PRIORITY(6, 0)) {
+        mspStartTransmit();
+    }
+
+    return len;
+}
+
+bool usbMspTxIdle(void)
+{
+    return !mspTxBusy && mspTxHead == mspTxTail;
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "usbd_def.h"
+
+extern USBD_ClassTypeDef USBD_CDC_MSP;
+extern uint8_t USBD_CDC_MSP_DeviceDescriptor[USB_LEN_DEV_DESC];
+
+bool usbMspIsConfigured(void);
+uint32_t usbMspRxBytesAvailable(void);
+uint32_t usbMspRead(uint8_t *buf, uint32_t len);
+uint32_t usbMspTxBytesFree(void);
+uint32_t usbMspWrite(const uint8_t *buf, uint32_t len);
+bool usbMspTxIdle(void);
@@ -77,7 +77,11 @@
 #define USBD_SELF_POWERED                     1
 #define USBD_DEBUG_LEVEL                      0
 #define MSC_MEDIA_PACKET                      512U
+// Targets select the OTG_HS core with USE_USB_HS, on an external ULPI PHY or with
+// USE_USB_HS_IN_FS on the embedded full speed PHY
+#ifndef USE_USB_HS
 #define USE_USB_FS
+#endif
 
 /* Exported macro ------------------------------------------------------------*/
 /* Memory management macros */
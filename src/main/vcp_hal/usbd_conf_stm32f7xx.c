@@ -69,6 +69,24 @@
 /* Private variables ---------------------------------------------------------*/
 PCD_HandleTypeDef hpcd;
 
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+/* The composite devices use IN endpoints 1 to 3 and need the FIFO split four ways */
+static bool usbUseCompositeFifo(void)
+{
+  bool composite = false;
+#ifdef USE_USB_CDC_HID
+  composite = usbDevConfig()->type == COMPOSITE;
+#endif
+#ifdef USE_USB_MSP_BULK
+  composite = composite || usbDevConfig()->mspBulk;
+#endif
+#ifdef USE_USB_MSC
+  composite = composite && !mscCheckBoot();
+#endif
+  return composite;
+}
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
@@ -154,6 +172,9 @@ void HAL_PCD_MspInit(PCD_HandleTypeDef *hpcd)
       GPIO_InitStruct.Pull = GPIO_NOPULL;
       HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
     }
+
+    /* The embedded PHY is used, the core must not wait for a ULPI clock */
+    __HAL_RCC_USB_OTG_HS_ULPI_CLK_DISABLE();
 #else
     /* Configure USB FS GPIOs */
     __HAL_RCC_GPIOA_CLK_ENABLE();
@@ -413,25 +434,21 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
   HAL_PCD_Init(&hpcd);
 
 
-#ifdef USE_USB_CDC_HID
-#ifdef USE_USB_MSC
-  if (usbDevConfig()->type == COMPOSITE && !mscCheckBoot()) {
-#else
-  if (usbDevConfig()->type == COMPOSITE) {
-#endif
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+  if (usbUseCompositeFifo()) {
     HAL_PCDEx_SetRxFiFo(&hpcd, 0x80);
     HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x20);
     HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x40);
     HAL_PCDEx_SetTxFiFo(&hpcd, 2, 0x20);
     HAL_PCDEx_SetTxFiFo(&hpcd, 3, 0x40);
   } else {
-#endif /* CDC_HID */
+#endif /* CDC_HID || MSP_BULK */
   HAL_PCDEx_SetRxFiFo(&hpcd, 0x80);
   HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x40);
   HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x80);
-#ifdef USE_USB_CDC_HID
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
   }
-#endif /* CDC_HID */
+#endif /* CDC_HID || MSP_BULK */
 #endif
 
 #ifdef USE_USB_HS
@@ -452,12 +469,14 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
 
 #ifdef USE_USB_HS_IN_FS
   hpcd.Init.phy_itface = PCD_PHY_EMBEDDED;
+  /* The embedded PHY only runs at full speed, the classes must use full speed packet sizes */
+  hpcd.Init.speed = PCD_SPEED_FULL;
 #else
   hpcd.Init.phy_itface = PCD_PHY_ULPI;
+  hpcd.Init.speed = PCD_SPEED_HIGH;
 #endif
   hpcd.Init.Sof_enable = 0;
-  hpcd.Init.speed = PCD_SPEED_HIGH;
-  hpcd.Init.vbus_sensing_enable = 1;
+  hpcd.Init.vbus_sensing_enable = 0;
 
   /* Link The driver to the stack */
   hpcd.pData = pdev;
@@ -466,9 +485,22 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
   /* Initialize LL Driver */
   HAL_PCD_Init(&hpcd);
 
+  /* The OTG_HS core has 4KB of FIFO (0x400 words), four times the OTG_FS core */
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+  if (usbUseCompositeFifo()) {
+    HAL_PCDEx_SetRxFiFo(&hpcd, 0x180);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x40);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x100);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 2, 0x40);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 3, 0x100);
+  } else {
+#endif /* CDC_HID || MSP_BULK */
   HAL_PCDEx_SetRxFiFo(&hpcd, 0x200);
   HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x80);
   HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x174);
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+  }
+#endif /* CDC_HID || MSP_BULK */
 #endif
 
   return USBD_OK;
@@ -69,6 +69,24 @@
 /* Private macro ------------------------------------------------------------- */
 /* Private variables --------------------------------------------------------- */
 PCD_HandleTypeDef hpcd;
+
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+/* The composite devices use IN endpoints 1 to 3 and need the FIFO split four ways */
+static bool usbUseCompositeFifo(void)
+{
+  bool composite = false;
+#ifdef USE_USB_CDC_HID
+  composite = usbDevConfig()->type == COMPOSITE;
+#endif
+#ifdef USE_USB_MSP_BULK
+  composite = composite || usbDevConfig()->mspBulk;
+#endif
+#ifdef USE_USB_MSC
+  composite = composite && !mscCheckBoot();
+#endif
+  return composite;
+}
+#endif
 /* Private function prototypes ----------------------------------------------- */
 /* Private functions --------------------------------------------------------- */
 
@@ -137,7 +155,21 @@ void HAL_PCD_MspInit(PCD_HandleTypeDef * hpcd)
     }
     else if (hpcd->Instance == USB1_OTG_HS)
     {
-        /* Configure USB FS GPIOs */
+#ifdef USE_USB_HS_IN_FS
+        __HAL_RCC_GPIOB_CLK_ENABLE();
+
+        /* Configure DM DP Pins of the embedded full speed PHY */
+        GPIO_InitStruct.Pin = (GPIO_PIN_14 | GPIO_PIN_15);
+        GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+        GPIO_InitStruct.Pull = GPIO_NOPULL;
+        GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+        GPIO_InitStruct.Alternate = GPIO_AF12_OTG2_FS;
+        HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+        /* The embedded PHY is used, the core must not wait for a ULPI clock */
+        __HAL_RCC_USB1_OTG_HS_ULPI_CLK_DISABLE();
+#else
+        /* Configure USB HS GPIOs */
         __GPIOA_CLK_ENABLE();
         __GPIOB_CLK_ENABLE();
         __GPIOC_CLK_ENABLE();
@@ -189,12 +221,13 @@ void HAL_PCD_MspInit(PCD_HandleTypeDef * hpcd)
         GPIO_InitStruct.Alternate = GPIO_AF10_OTG2_HS;
         HAL_GPIO_Init(GPIOI, &GPIO_InitStruct);
         __HAL_RCC_USB1_OTG_HS_ULPI_CLK_ENABLE();
+#endif
 
         /* Enable USB HS Clocks */
         __HAL_RCC_USB1_OTG_HS_CLK_ENABLE();
 
-        /* Set USBHS Interrupt to the lowest priority */
-        HAL_NVIC_SetPriority(OTG_HS_IRQn, 1, 0);
+        /* Set USBHS Interrupt to the lowest priority, the same as the CDC transmit timer */
+        HAL_NVIC_SetPriority(OTG_HS_IRQn, 6, 0);
 
         /* Enable USBHS Interrupt */
         HAL_NVIC_EnableIRQ(OTG_HS_IRQn);
@@ -396,25 +429,21 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef * pdev)
     /* Initialize LL Driver */
     HAL_PCD_Init(&hpcd);
 
-#ifdef USE_USB_CDC_HID
-#ifdef USE_USB_MSC
-  if (usbDevConfig()->type == COMPOSITE && !mscCheckBoot()) {
-#else
-  if (usbDevConfig()->type == COMPOSITE) {
-#endif
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+  if (usbUseCompositeFifo()) {
     HAL_PCDEx_SetRxFiFo(&hpcd, 0x80);
     HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x20);
     HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x40);
     HAL_PCDEx_SetTxFiFo(&hpcd, 2, 0x20);
     HAL_PCDEx_SetTxFiFo(&hpcd, 3, 0x40);
   } else {
-#endif /* CDC_HID */
+#endif /* CDC_HID || MSP_BULK */
     HAL_PCDEx_SetRxFiFo(&hpcd, 0x80);
     HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x40);
     HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x80);
-#ifdef USE_USB_CDC_HID
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
   }
-#endif /* CDC_HID */
+#endif /* CDC_HID || MSP_BULK */
 
 #endif
 
@@ -432,9 +461,15 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef * pdev)
     hpcd.Init.dma_enable = 0;
     hpcd.Init.low_power_enable = 0;
     hpcd.Init.lpm_enable = 0;
+#ifdef USE_USB_HS_IN_FS
+    hpcd.Init.phy_itface = PCD_PHY_EMBEDDED;
+    /* The embedded PHY only runs at full speed, the classes must use full speed packet sizes */
+    hpcd.Init.speed = PCD_SPEED_FULL;
+#else
     hpcd.Init.phy_itface = PCD_PHY_ULPI;
-    hpcd.Init.Sof_enable = 0;
     hpcd.Init.speed = PCD_SPEED_HIGH;
+#endif
+    hpcd.Init.Sof_enable = 0;
     hpcd.Init.vbus_sensing_enable = 0;
 
     /* Link The driver to the stack */
@@ -444,9 +479,22 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef * pdev)
     /* Initialize LL Driver */
     HAL_PCD_Init(&hpcd);
 
+    /* The OTG_HS core has 4KB of FIFO (0x400 words), four times the OTG_FS core */
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+  if (usbUseCompositeFifo()) {
+    HAL_PCDEx_SetRxFiFo(&hpcd, 0x180);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x40);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x100);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 2, 0x40);
+    HAL_PCDEx_SetTxFiFo(&hpcd, 3, 0x100);
+  } else {
+#endif /* CDC_HID || MSP_BULK */
     HAL_PCDEx_SetRxFiFo(&hpcd, 0x200);
     HAL_PCDEx_SetTxFiFo(&hpcd, 0, 0x80);
     HAL_PCDEx_SetTxFiFo(&hpcd, 1, 0x174);
+#if defined(USE_USB_CDC_HID) || defined(USE_USB_MSP_BULK)
+  }
+#endif /* CDC_HID || MSP_BULK */
 #endif
 
     return USBD_OK;
@@ -124,6 +124,10 @@ __ALIGN_BEGIN uint8_t USBD_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END = {
 extern uint8_t USBD_HID_CDC_DeviceDescriptor[USB_LEN_DEV_DESC];
 #endif
 
+#ifdef USE_USB_MSP_BULK
+extern uint8_t USBD_CDC_MSP_DeviceDescriptor[USB_LEN_DEV_DESC];
+#endif
+
 #ifdef USE_USB_MSC
 
 #define USBD_PID_MSC     22314
@@ -197,6 +201,12 @@ uint8_t *USBD_VCP_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
     *length = sizeof(USBD_HID_CDC_DeviceDescriptor);
     return USBD_HID_CDC_DeviceDescriptor;
   }
+#endif
+#ifdef USE_USB_MSP_BULK
+  if (usbDevConfig()->mspBulk) {
+    *length = sizeof(USBD_CDC_MSP_DeviceDescriptor);
+    return USBD_CDC_MSP_DeviceDescriptor;
+  }
 #endif
   *length = sizeof(USBD_DeviceDesc);
   return (uint8_t*)USBD_DeviceDesc;
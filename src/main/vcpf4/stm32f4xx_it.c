@@ -67,9 +67,12 @@ void DebugMon_Handler(void)
   * @param  None
   * @retval None
   */
+#ifndef USE_PID_LOOP_INTERRUPT
+// drivers/pendsv.c owns the handler when the PID loop runs from PendSV
 void PendSV_Handler(void)
 {
 }
+#endif
 
 /******************************************************************************/
 /*                 STM32F4xx Peripherals Interrupt Handlers                   */
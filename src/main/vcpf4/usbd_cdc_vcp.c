@@ -21,8 +21,12 @@
 
 /* Includes ------------------------------------------------------------------*/
 
+#include <string.h>
+
 #include "platform.h"
 
+#include "common/maths.h"
+
 #include "usbd_cdc_vcp.h"
 #include "stm32f4xx_conf.h"
 #include "stdbool.h"
@@ -36,7 +40,6 @@ __ALIGN_BEGIN USB_OTG_CORE_HANDLE USB_OTG_dev __ALIGN_END;
 
 LINE_CODING g_lc;
 
-extern __IO uint8_t USB_Tx_State;
 __IO uint32_t bDeviceState = UNCONNECTED; /* USB device status */
 
 /* These are external variables imported from CDC core to be used for IN transfer management. */
@@ -207,19 +210,23 @@ uint32_t CDC_Send_FreeBytes(void)
 static uint16_t VCP_DataTx(const uint8_t* Buf, uint32_t Len)
 {
     /*
-        make sure that any paragraph end frame is not in play
-        could just check for: USB_CDC_ZLP, but better to be safe
-        and wait for any existing transmission to complete.
+        The IN transfer only reads the bytes up to APP_Rx_ptr_in that it saw when it
+        started, so the buffer is filled while the previous transfer is still being sent.
+        Each contiguous run is copied at once and published with a single update of
+        APP_Rx_ptr_in.
     */
-    while (USB_Tx_State != 0);
-
-    for (uint32_t i = 0; i < Len; i++) {
-        APP_Rx_Buffer[APP_Rx_ptr_in] = Buf[i];
-        APP_Rx_ptr_in = (APP_Rx_ptr_in + 1) % APP_RX_DATA_SIZE;
-
-        while (CDC_Send_FreeBytes() == 0) {
+    while (Len > 0) {
+        uint32_t freeBytes;
+        while ((freeBytes = CDC_Send_FreeBytes()) == 0) {
             delay(1);
         }
+
+        const uint32_t run = MIN(MIN(Len, freeBytes), APP_RX_DATA_SIZE - APP_Rx_ptr_in);
+        memcpy(&APP_Rx_Buffer[APP_Rx_ptr_in], Buf, run);
+        APP_Rx_ptr_in = (APP_Rx_ptr_in + run) % APP_RX_DATA_SIZE;
+
+        Buf += run;
+        Len -= run;
     }
 
     return USBD_OK;
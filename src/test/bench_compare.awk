@@ -0,0 +1,45 @@
+# Compares the kernel lines of a `make bench` run against the baseline.
+#
+# usage: awk -v tolerance=<percent> -f bench_compare.awk <baseline> <bench output>
+#
+# The baseline holds one "<kernel> <ns/call>" pair per line, the bench
+# output is scanned for "[ BENCH    ] <kernel> <ns> ns/call ..." lines.
+# Exits non zero if a kernel got slower than tolerance or did not run.
+
+FNR == NR {
+    if ($0 !~ /^#/ && NF >= 2) {
+        baseline[$1] = $2
+        order[++count] = $1
+    }
+    next
+}
+
+$1 == "[" && $2 == "BENCH" && $6 == "ns/call" {
+    measured[$4] = $5
+}
+
+END {
+    failed = 0
+    printf "\n%-28s %10s %10s %8s\n", "kernel", "baseline", "ns/call", "change"
+    for (i = 1; i <= count; i++) {
+        name = order[i]
+        if (!(name in measured)) {
+            printf "%-28s %10.2f %10s %8s  MISSING\n", name, baseline[name], "-", "-"
+            failed = 1
+            continue
+        }
+        change = (measured[name] - baseline[name]) * 100 / baseline[name]
+        verdict = ""
+        if (change > tolerance) {
+            verdict = "  SLOWER"
+            failed = 1
+        }
+        printf "%-28s %10.2f %10.2f %+7.1f%%%s\n", name, baseline[name], measured[name], change, verdict
+    }
+    for (name in measured) {
+        if (!(name in baseline)) {
+            printf "%-28s %10s %10.2f %8s  NEW\n", name, "-", measured[name], "-"
+        }
+    }
+    exit failed
+}
@@ -0,0 +1,810 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Offline replay of a blackbox log through the firmware gyro filter chain
+ * (lowpass, static notches, RPM filter, dynamic notch and dynamic lowpass)
+ * and the PID controller, to compare filter and PID settings without flying.
+ *
+ * usage: filter_replay [-j <jobs>] [-s <deg/s per LSB>] [-o <signals.csv>] <log.csv> [<configs.txt>]
+ *
+ * log.csv is the blackbox_decode output of a log recorded with
+ * debug_mode = GYRO_RAW, ideally at the full PID loop rate. The columns used are
+ *   time (us)        sample time, the loop time is the median spacing
+ *   debug[0..2]      raw gyro in sensor LSB, scaled with -s (default 2000 deg/s range)
+ *   setpoint[0..3]   optional, rate setpoints and throttle (0-1000) for the PID and dynamic lowpass
+ *   eRPM[0..3]       optional, dshot telemetry for the RPM filter, which is enabled when present
+ * The raw gyro is replayed in the sensor frame, so the axes only match the
+ * setpoints of boards whose gyro is mounted CW0.
+ *
+ * Each line of configs.txt is one configuration, a list of <setting>=<value>
+ * pairs applied over the firmware defaults, using the CLI setting names listed
+ * in replaySettings[] below and numeric values for lookups. Without a
+ * configs file the defaults are replayed once.
+ *
+ * One CSV line per configuration is written to stdout: the gyro and D term
+ * delay per axis, estimated as the lag of the best cross correlation with the
+ * unfiltered gyro and its derivative below 50Hz, and their noise as the RMS of
+ * the sample to sample change. -o writes the signals of the first configuration
+ * and -j spreads the configurations over that many processes.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/axis.h"
+#include "common/filter.h"
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "config/feature.h"
+
+#include "drivers/accgyro/accgyro.h"
+#include "drivers/accgyro/accgyro_fake.h"
+#include "drivers/dshot_command.h"
+#include "drivers/sensor.h"
+
+#include "fc/config.h"
+#include "fc/core.h"
+#include "fc/dispatch.h"
+#include "fc/rc_controls.h"
+#include "fc/runtime_config.h"
+
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/pid.h"
+#include "flight/rpm_filter.h"
+
+#include "io/beeper.h"
+
+#include "pg/motor.h"
+#include "pg/pg.h"
+#include "pg/pg_ids.h"
+
+#include "scheduler/scheduler.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/gyro.h"
+#include "sensors/sensors.h"
+
+#define REPLAY_MOTOR_COUNT          4
+#define REPLAY_MAX_DELAY_US         20000   // longest filter delay searched for
+#define REPLAY_DELAY_BAND_HZ        50      // delays are measured on the stick response, below the motor noise
+#define REPLAY_DELAY_DECIMATION     4       // coarse delay search step, still well above twice the band
+#define REPLAY_LINE_LENGTH          8192
+#define REPLAY_CALIBRATION_LIMIT    100000
+#define REPLAY_MAX_JOBS             256
+
+extern gyroDev_t * const gyroDevPtr;
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+attitudeEulerAngles_t attitude;
+
+PG_REGISTER(accelerometerConfig_t, accelerometerConfig, PG_ACCELEROMETER_CONFIG, 0);
+
+typedef struct replayLog_s {
+    int sampleCount;
+    uint32_t looptimeUs;
+    float (*gyro)[XYZ_AXIS_COUNT];          // deg/s
+    int16_t (*gyroRaw)[XYZ_AXIS_COUNT];
+    float (*setpoint)[4];                   // deg/s and throttle 0-1
+    uint16_t (*erpm)[REPLAY_MOTOR_COUNT];   // eRPM / 100, as dshot telemetry reports it
+    bool hasSetpoint;
+    bool hasErpm;
+} replayLog_t;
+
+typedef struct replayResult_s {
+    float gyroDelayUs[XYZ_AXIS_COUNT];
+    float gyroNoise[XYZ_AXIS_COUNT];
+    float dtermDelayUs[XYZ_AXIS_COUNT];
+    float dtermNoise[XYZ_AXIS_COUNT];
+} replayResult_t;
+
+typedef struct replayConfig_s {
+    int lineNumber;
+    char *text;
+    bool valid;
+} replayConfig_t;
+
+typedef enum {
+    REPLAY_UINT8,
+    REPLAY_UINT16,
+} replaySettingType_e;
+
+typedef struct replaySetting_s {
+    const char *name;
+    pgn_t pgn;
+    uint16_t offset;
+    replaySettingType_e type;
+} replaySetting_t;
+
+// The settings a configuration may change, named as in the CLI. Groups with
+// several copies, like the PID profiles, are changed in their first copy.
+static const replaySetting_t replaySettings[] = {
+    { "gyro_lowpass_type",          PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_lowpass_type),          REPLAY_UINT8 },
+    { "gyro_lowpass_hz",            PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_lowpass_hz),            REPLAY_UINT16 },
+    { "gyro_lowpass2_type",         PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_lowpass2_type),         REPLAY_UINT8 },
+    { "gyro_lowpass2_hz",           PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_lowpass2_hz),           REPLAY_UINT16 },
+    { "gyro_notch1_hz",             PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_soft_notch_hz_1),       REPLAY_UINT16 },
+    { "gyro_notch1_cutoff",         PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_soft_notch_cutoff_1),   REPLAY_UINT16 },
+    { "gyro_notch2_hz",             PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_soft_notch_hz_2),       REPLAY_UINT16 },
+    { "gyro_notch2_cutoff",         PG_GYRO_CONFIG,         offsetof(gyroConfig_t, gyro_soft_notch_cutoff_2),   REPLAY_UINT16 },
+    { "dyn_lpf_gyro_min_hz",        PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_lpf_gyro_min_hz),        REPLAY_UINT16 },
+    { "dyn_lpf_gyro_max_hz",        PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_lpf_gyro_max_hz),        REPLAY_UINT16 },
+    { "dyn_notch_range",            PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_notch_range),            REPLAY_UINT8 },
+    { "dyn_notch_width_percent",    PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_notch_width_percent),    REPLAY_UINT8 },
+    { "dyn_notch_q",                PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_notch_q),                REPLAY_UINT16 },
+    { "dyn_notch_min_hz",           PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_notch_min_hz),           REPLAY_UINT16 },
+    { "dyn_notch_window_size",      PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_notch_window_size),      REPLAY_UINT8 },
+    { "dyn_notch_count",            PG_GYRO_CONFIG,         offsetof(gyroConfig_t, dyn_notch_count),            REPLAY_UINT8 },
+    { "gyro_rpm_notch_harmonics",   PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, gyro_rpm_notch_harmonics),  REPLAY_UINT8 },
+    { "gyro_rpm_notch_q",           PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, gyro_rpm_notch_q),          REPLAY_UINT16 },
+    { "gyro_rpm_notch_min",         PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, gyro_rpm_notch_min),        REPLAY_UINT8 },
+    { "gyro_rpm_notch_mask",        PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, gyro_rpm_notch_mask),       REPLAY_UINT8 },
+    { "dterm_rpm_notch_harmonics",  PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, dterm_rpm_notch_harmonics), REPLAY_UINT8 },
+    { "dterm_rpm_notch_q",          PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, dterm_rpm_notch_q),         REPLAY_UINT16 },
+    { "dterm_rpm_notch_min",        PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, dterm_rpm_notch_min),       REPLAY_UINT8 },
+    { "dterm_rpm_notch_mask",       PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, dterm_rpm_notch_mask),      REPLAY_UINT8 },
+    { "rpm_notch_lpf",              PG_RPM_FILTER_CONFIG,   offsetof(rpmFilterConfig_t, rpm_lpf),                   REPLAY_UINT16 },
+    { "motor_poles",                PG_MOTOR_CONFIG,        offsetof(motorConfig_t, motorPoleCount),            REPLAY_UINT8 },
+    { "dyn_lpf_dterm_min_hz",       PG_PID_PROFILE,         offsetof(pidProfile_t, dyn_lpf_dterm_min_hz),       REPLAY_UINT16 },
+    { "dyn_lpf_dterm_max_hz",       PG_PID_PROFILE,         offsetof(pidProfile_t, dyn_lpf_dterm_max_hz),       REPLAY_UINT16 },
+    { "dterm_lowpass_type",         PG_PID_PROFILE,         offsetof(pidProfile_t, dterm_filter_type),          REPLAY_UINT8 },
+    { "dterm_lowpass_hz",           PG_PID_PROFILE,         offsetof(pidProfile_t, dterm_lowpass_hz),           REPLAY_UINT16 },
+    { "dterm_lowpass2_type",        PG_PID_PROFILE,         offsetof(pidProfile_t, dterm_filter2_type),         REPLAY_UINT8 },
+    { "dterm_lowpass2_hz",          PG_PID_PROFILE,         offsetof(pidProfile_t, dterm_lowpass2_hz),          REPLAY_UINT16 },
+    { "dterm_notch_hz",             PG_PID_PROFILE,         offsetof(pidProfile_t, dterm_notch_hz),             REPLAY_UINT16 },
+    { "dterm_notch_cutoff",         PG_PID_PROFILE,         offsetof(pidProfile_t, dterm_notch_cutoff),         REPLAY_UINT16 },
+    { "p_roll",                     PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_ROLL].P),            REPLAY_UINT8 },
+    { "i_roll",                     PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_ROLL].I),            REPLAY_UINT8 },
+    { "d_roll",                     PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_ROLL].D),            REPLAY_UINT8 },
+    { "f_roll",                     PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_ROLL].F),            REPLAY_UINT16 },
+    { "p_pitch",                    PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_PITCH].P),           REPLAY_UINT8 },
+    { "i_pitch",                    PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_PITCH].I),           REPLAY_UINT8 },
+    { "d_pitch",                    PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_PITCH].D),           REPLAY_UINT8 },
+    { "f_pitch",                    PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_PITCH].F),           REPLAY_UINT16 },
+    { "p_yaw",                      PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_YAW].P),             REPLAY_UINT8 },
+    { "i_yaw",                      PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_YAW].I),             REPLAY_UINT8 },
+    { "d_yaw",                      PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_YAW].D),             REPLAY_UINT8 },
+    { "f_yaw",                      PG_PID_PROFILE,         offsetof(pidProfile_t, pid[PID_YAW].F),             REPLAY_UINT16 },
+};
+
+static const replayLog_t *replayLog;
+static int replayIndex;
+static uint32_t replayFeatures;
+
+// Stubs for the firmware the filters and PID controller call into, fed from the log
+
+uint32_t micros(void) { return replayIndex * replayLog->looptimeUs; }
+uint32_t millis(void) { return micros() / 1000; }
+void beeper(beeperMode_e mode) { UNUSED(mode); }
+void beeperConfirmationBeeps(uint8_t beepCount) { UNUSED(beepCount); }
+void systemBeep(bool on) { UNUSED(on); }
+uint8_t detectedSensors[] = { GYRO_NONE, ACC_NONE };
+void schedulerResetTaskStatistics(cfTaskId_e taskId) { UNUSED(taskId); }
+timeDelta_t getGyroUpdateRate(void) { return gyro.targetLooptime; }
+bool featureIsEnabled(const uint32_t mask) { return replayFeatures & mask; }
+uint8_t getMotorCount(void) { return REPLAY_MOTOR_COUNT; }
+float getMotorMixRange(void) { return 0.0f; }
+float getThrottlePIDAttenuation(void) { return 1.0f; }
+bool isAirmodeActivated(void) { return true; }
+bool isLaunchControlActive(void) { return false; }
+void disarm(void) {}
+void dshotSetPidLoopTime(uint32_t pidLoopTime) { UNUSED(pidLoopTime); }
+bool isConfigDirty(void) { return false; }
+void writeEEPROM(void) {}
+void dispatchEnable(void) {}
+void dispatchAdd(dispatchEntry_t *entry, int delayUs) { UNUSED(entry); UNUSED(delayUs); }
+
+uint16_t getDshotTelemetry(uint8_t index)
+{
+    return replayLog->hasErpm ? replayLog->erpm[replayIndex][index] : 0;
+}
+
+uint8_t calculateThrottlePercentAbs(void)
+{
+    return replayLog->hasSetpoint ? lrintf(constrainf(replayLog->setpoint[replayIndex][FD_YAW + 1], 0.0f, 1.0f) * 100) : 0;
+}
+
+float getSetpointRate(int axis)
+{
+    return replayLog->hasSetpoint ? replayLog->setpoint[replayIndex][axis] : 0.0f;
+}
+
+float getRcDeflection(int axis)
+{
+    return getSetpointRate(axis) / 1000.0f;
+}
+
+float getRcDeflectionAbs(int axis)
+{
+    return fabsf(getRcDeflection(axis));
+}
+
+float applyFFLimit(int axis, float value, float Kp, float currentPidSetpoint)
+{
+    UNUSED(axis);
+    UNUSED(Kp);
+    UNUSED(currentPidSetpoint);
+    return value;
+}
+
+static double secondsSince(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static int compareUint32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int findColumn(char **names, int count, const char *name)
+{
+    for (int i = 0; i < count; i++) {
+        if (!strcmp(names[i], name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Splits a CSV line in place, trimming the spaces blackbox_decode puts after each comma
+static int splitCsv(char *line, char **fields, int maxFields)
+{
+    int count = 0;
+    char *field = line;
+    while (field && count < maxFields) {
+        char *next = strchr(field, ',');
+        if (next) {
+            *next++ = '\0';
+        }
+        while (*field == ' ') {
+            field++;
+        }
+        field[strcspn(field, "\r\n")] = '\0';
+        fields[count++] = field;
+        field = next;
+    }
+    return count;
+}
+
+static bool readLog(const char *path, float gyroScale, replayLog_t *log)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    static char header[REPLAY_LINE_LENGTH];
+    static char line[REPLAY_LINE_LENGTH];
+    char *names[256];
+    char *fields[256];
+
+    if (!fgets(header, sizeof(header), file)) {
+        fclose(file);
+        return false;
+    }
+    const int columnCount = splitCsv(header, names, ARRAYLEN(names));
+
+    int timeColumn = findColumn(names, columnCount, "time (us)");
+    int gyroColumn[XYZ_AXIS_COUNT];
+    int setpointColumn[4];
+    int erpmColumn[REPLAY_MOTOR_COUNT];
+    bool hasGyro = true;
+    log->hasSetpoint = true;
+    log->hasErpm = true;
+    for (int i = 0; i < 4; i++) {
+        char name[32];
+        if (i < XYZ_AXIS_COUNT) {
+            snprintf(name, sizeof(name), "debug[%d]", i);
+            gyroColumn[i] = findColumn(names, columnCount, name);
+            hasGyro = hasGyro && gyroColumn[i] >= 0;
+        }
+        snprintf(name, sizeof(name), "setpoint[%d]", i);
+        setpointColumn[i] = findColumn(names, columnCount, name);
+        log->hasSetpoint = log->hasSetpoint && setpointColumn[i] >= 0;
+        snprintf(name, sizeof(name), "eRPM[%d]", i);
+        erpmColumn[i] = findColumn(names, columnCount, name);
+        log->hasErpm = log->hasErpm && erpmColumn[i] >= 0;
+    }
+    if (timeColumn < 0 || !hasGyro) {
+        fprintf(stderr, "%s: needs the time (us) and debug[0..2] columns\n", path);
+        fclose(file);
+        return false;
+    }
+
+    int capacity = 65536;
+    uint32_t *timeUs = malloc(capacity * sizeof(*timeUs));
+    log->gyroRaw = malloc(capacity * sizeof(*log->gyroRaw));
+    log->setpoint = malloc(capacity * sizeof(*log->setpoint));
+    log->erpm = malloc(capacity * sizeof(*log->erpm));
+    log->sampleCount = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        if (splitCsv(line, fields, ARRAYLEN(fields)) < columnCount) {
+            continue;   // event lines and truncated frames
+        }
+        if (log->sampleCount == capacity) {
+            capacity *= 2;
+            timeUs = realloc(timeUs, capacity * sizeof(*timeUs));
+            log->gyroRaw = realloc(log->gyroRaw, capacity * sizeof(*log->gyroRaw));
+            log->setpoint = realloc(log->setpoint, capacity * sizeof(*log->setpoint));
+            log->erpm = realloc(log->erpm, capacity * sizeof(*log->erpm));
+        }
+        const int n = log->sampleCount++;
+        timeUs[n] = strtoul(fields[timeColumn], NULL, 10);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            log->gyroRaw[n][axis] = constrain(strtol(fields[gyroColumn[axis]], NULL, 10), INT16_MIN, INT16_MAX);
+        }
+        for (int i = 0; i < 4; i++) {
+            log->setpoint[n][i] = log->hasSetpoint ? strtof(fields[setpointColumn[i]], NULL) : 0.0f;
+            log->erpm[n][i] = log->hasErpm ? strtoul(fields[erpmColumn[i]], NULL, 10) : 0;
+        }
+        if (log->hasSetpoint) {
+            log->setpoint[n][FD_YAW + 1] /= 1000.0f;
+        }
+    }
+    fclose(file);
+
+    if (log->sampleCount < 2) {
+        fprintf(stderr, "%s: no samples\n", path);
+        free(timeUs);
+        return false;
+    }
+
+    // the median sample spacing is the loop time, robust to dropped frames
+    for (int i = 0; i < log->sampleCount - 1; i++) {
+        timeUs[i] = timeUs[i + 1] - timeUs[i];
+    }
+    qsort(timeUs, log->sampleCount - 1, sizeof(*timeUs), compareUint32);
+    log->looptimeUs = MAX(timeUs[(log->sampleCount - 1) / 2], 1U);
+    free(timeUs);
+
+    log->gyro = malloc(log->sampleCount * sizeof(*log->gyro));
+    for (int i = 0; i < log->sampleCount; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            log->gyro[i][axis] = log->gyroRaw[i][axis] * gyroScale;
+        }
+    }
+
+    return true;
+}
+
+static bool applySetting(const char *assignment)
+{
+    const char *equals = strchr(assignment, '=');
+    if (!equals) {
+        return false;
+    }
+    const size_t nameLength = equals - assignment;
+    const long value = strtol(equals + 1, NULL, 10);
+
+    if (nameLength == strlen("dynamic_filter") && !strncmp(assignment, "dynamic_filter", nameLength)) {
+        replayFeatures = value ? replayFeatures | FEATURE_DYNAMIC_FILTER : replayFeatures & ~FEATURE_DYNAMIC_FILTER;
+        return true;
+    }
+    if (nameLength == strlen("dshot_bidir") && !strncmp(assignment, "dshot_bidir", nameLength)) {
+        motorConfigMutable()->dev.useDshotTelemetry = value;
+        return true;
+    }
+
+    for (unsigned i = 0; i < ARRAYLEN(replaySettings); i++) {
+        const replaySetting_t *setting = &replaySettings[i];
+        if (strlen(setting->name) != nameLength || strncmp(setting->name, assignment, nameLength)) {
+            continue;
+        }
+        uint8_t *address = pgFind(setting->pgn)->address + setting->offset;
+        switch (setting->type) {
+        case REPLAY_UINT8:
+            *address = value;
+            break;
+        case REPLAY_UINT16:
+            *(uint16_t *)address = value;
+            break;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Resets to the defaults and applies a line of the configs file, false on an unknown setting
+static bool applyConfig(char *config, const replayLog_t *log)
+{
+    pgResetAll();
+    replayFeatures = FEATURE_DYNAMIC_FILTER;
+    motorConfigMutable()->dev.useDshotTelemetry = log->hasErpm;
+    pidConfigMutable()->pid_process_denom = 1;
+
+    for (char *token = strtok(config, " \t\r\n"); token; token = strtok(NULL, " \t\r\n")) {
+        if (!applySetting(token)) {
+            fprintf(stderr, "unknown setting '%s'\n", token);
+            return false;
+        }
+    }
+    return true;
+}
+
+static float correlate(const float *reference, const float *filtered, int stride, int count, int lag, int step)
+{
+    double sum = 0;
+    for (int i = 0; i + lag < count; i += step) {
+        sum += reference[i * stride] * filtered[(i + lag) * stride];
+    }
+    return fabs(sum);
+}
+
+// Lag in samples at which filtered correlates best with reference. Both are
+// band limited, so the search runs on every REPLAY_DELAY_DECIMATION-th sample
+// and lag first and is then refined around the best one, with a parabolic fit
+// between samples.
+static float estimateDelay(const float *reference, const float *filtered, int stride, int count, int maxLag)
+{
+    float best = -1.0f;
+    int bestLag = 0;
+
+    for (int lag = 0; lag <= maxLag; lag += REPLAY_DELAY_DECIMATION) {
+        const float correlation = correlate(reference, filtered, stride, count, lag, REPLAY_DELAY_DECIMATION);
+        if (correlation > best) {
+            best = correlation;
+            bestLag = lag;
+        }
+    }
+
+    const int firstLag = MAX(bestLag - REPLAY_DELAY_DECIMATION, 0);
+    const int lastLag = MIN(bestLag + REPLAY_DELAY_DECIMATION, maxLag);
+    float correlation[2 * REPLAY_DELAY_DECIMATION + 1];
+    best = -1.0f;
+    for (int lag = firstLag; lag <= lastLag; lag++) {
+        correlation[lag - firstLag] = correlate(reference, filtered, stride, count, lag, 1);
+        if (correlation[lag - firstLag] > best) {
+            best = correlation[lag - firstLag];
+            bestLag = lag;
+        }
+    }
+
+    if (bestLag > firstLag && bestLag < lastLag) {
+        const float left = correlation[bestLag - firstLag - 1];
+        const float centre = correlation[bestLag - firstLag];
+        const float right = correlation[bestLag - firstLag + 1];
+        const float denominator = left - 2 * centre + right;
+        if (denominator != 0.0f) {
+            return bestLag + 0.5f * (left - right) / denominator;
+        }
+    }
+    return bestLag;
+}
+
+// Forward and backward PT1, which band limits without shifting the signal in time
+static void smoothZeroPhase(float *values, int stride, int count, uint32_t looptimeUs)
+{
+    const float gain = pt1FilterGain(REPLAY_DELAY_BAND_HZ, looptimeUs * 1e-6f);
+    pt1Filter_t filter;
+
+    pt1FilterInit(&filter, gain);
+    filter.state = values[0];
+    for (int i = 0; i < count; i++) {
+        values[i * stride] = pt1FilterApply(&filter, values[i * stride]);
+    }
+    filter.state = values[(count - 1) * stride];
+    for (int i = count - 1; i >= 0; i--) {
+        values[i * stride] = pt1FilterApply(&filter, values[i * stride]);
+    }
+}
+
+static float differenceRms(const float *values, int stride, int count)
+{
+    double sum = 0;
+    for (int i = 1; i < count; i++) {
+        const float difference = values[i * stride] - values[(i - 1) * stride];
+        sum += difference * difference;
+    }
+    return sqrt(sum / MAX(count - 1, 1));
+}
+
+static void replayConfig(const replayLog_t *log, float (*gyroFiltered)[XYZ_AXIS_COUNT], float (*dterm)[XYZ_AXIS_COUNT], FILE *signals)
+{
+    replayLog = log;
+    gyro.targetLooptime = log->looptimeUs;
+    gyroInitFilters();
+    rpmFilterInit(rpmFilterConfig());
+    pidInit(pidProfiles(0));
+    pidStabilisationState(PID_STABILISATION_ON);
+
+    int dynLpfThrottle = -1;
+    for (replayIndex = 0; replayIndex < log->sampleCount; replayIndex++) {
+        const int16_t *raw = log->gyroRaw[replayIndex];
+        fakeGyroSet(gyroDevPtr, raw[X], raw[Y], raw[Z]);
+        gyroUpdate(micros());
+
+        if (log->hasSetpoint) {
+            const int throttle = lrintf(constrainf(log->setpoint[replayIndex][FD_YAW + 1], 0.0f, 1.0f) * DYN_LPF_THROTTLE_STEPS);
+            if (throttle != dynLpfThrottle) {
+                dynLpfGyroUpdate(throttle);
+                dynLpfDTermUpdate(throttle);
+                dynLpfThrottle = throttle;
+            }
+        }
+
+        pidController(pidProfiles(0), micros());
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroFiltered[replayIndex][axis] = gyro.gyroADCf[axis];
+            dterm[replayIndex][axis] = pidData[axis].D;
+        }
+
+        if (signals) {
+            fprintf(signals, "%u", micros());
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                fprintf(signals, ",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f", log->gyro[replayIndex][axis], gyro.gyroADCf[axis],
+                    pidData[axis].P, pidData[axis].I, pidData[axis].D, pidData[axis].F);
+            }
+            fprintf(signals, "\n");
+        }
+    }
+}
+
+// Noise is measured on the full signals, delays after band limiting them like the references
+static void analyse(const replayLog_t *log, float (*gyroFiltered)[XYZ_AXIS_COUNT], float (*dterm)[XYZ_AXIS_COUNT],
+    float (*gyroReference)[XYZ_AXIS_COUNT], float (*gyroDerivative)[XYZ_AXIS_COUNT], replayResult_t *result)
+{
+    const int maxLag = MIN(REPLAY_MAX_DELAY_US / (int)log->looptimeUs, log->sampleCount - 1);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        result->gyroNoise[axis] = differenceRms(&gyroFiltered[0][axis], XYZ_AXIS_COUNT, log->sampleCount);
+        result->dtermNoise[axis] = differenceRms(&dterm[0][axis], XYZ_AXIS_COUNT, log->sampleCount);
+
+        smoothZeroPhase(&gyroFiltered[0][axis], XYZ_AXIS_COUNT, log->sampleCount, log->looptimeUs);
+        smoothZeroPhase(&dterm[0][axis], XYZ_AXIS_COUNT, log->sampleCount, log->looptimeUs);
+        result->gyroDelayUs[axis] = estimateDelay(&gyroReference[0][axis], &gyroFiltered[0][axis], XYZ_AXIS_COUNT, log->sampleCount, maxLag) * log->looptimeUs;
+        result->dtermDelayUs[axis] = estimateDelay(&gyroDerivative[0][axis], &dterm[0][axis], XYZ_AXIS_COUNT, log->sampleCount, maxLag) * log->looptimeUs;
+    }
+}
+
+static void calibrateGyro(void)
+{
+    // the log is replayed as is, so calibrate to a zero offset
+    for (int i = 0; i < REPLAY_CALIBRATION_LIMIT && !isGyroCalibrationComplete(); i++) {
+        fakeGyroSet(gyroDevPtr, 0, 0, 0);
+        gyroUpdate(0);
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-j <jobs>] [-s <deg/s per LSB>] [-o <signals.csv>] <log.csv> [<configs.txt>]\n", name);
+}
+
+// Reads the configurations, numbered by their line, skipping blank lines and # comments
+static int readConfigs(const char *path, replayConfig_t **configs)
+{
+    int count = 0;
+    int capacity = 64;
+    *configs = malloc(capacity * sizeof(**configs));
+
+    if (!path) {
+        (*configs)[0] = (replayConfig_t){ .lineNumber = 1, .text = strdup("") };
+        return 1;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+    static char line[REPLAY_LINE_LENGTH];
+    for (int lineNumber = 1; fgets(line, sizeof(line), file); lineNumber++) {
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') {
+            continue;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            *configs = realloc(*configs, capacity * sizeof(**configs));
+        }
+        (*configs)[count++] = (replayConfig_t){ .lineNumber = lineNumber, .text = strdup(line) };
+    }
+    fclose(file);
+    return count;
+}
+
+static void printResult(int lineNumber, const replayResult_t *result)
+{
+    printf("%d", lineNumber);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        printf(",%.0f", result->gyroDelayUs[axis]);
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        printf(",%.3f", result->gyroNoise[axis]);
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        printf(",%.0f", result->dtermDelayUs[axis]);
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        printf(",%.3f", result->dtermNoise[axis]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    float gyroScale = 1.0f / 16.4f;
+    const char *signalsPath = NULL;
+    int jobs = 1;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; arg += 2) {
+        if (arg + 1 == argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (!strcmp(argv[arg], "-s")) {
+            gyroScale = strtof(argv[arg + 1], NULL);
+        } else if (!strcmp(argv[arg], "-o")) {
+            signalsPath = argv[arg + 1];
+        } else if (!strcmp(argv[arg], "-j")) {
+            jobs = constrain(atoi(argv[arg + 1]), 1, REPLAY_MAX_JOBS);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (arg == argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    static replayLog_t log;
+    if (!readLog(argv[arg], gyroScale, &log)) {
+        return 1;
+    }
+    replayLog = &log;
+
+    replayConfig_t *configs;
+    const int configCount = readConfigs(arg + 1 < argc ? argv[arg + 1] : NULL, &configs);
+    if (configCount < 0) {
+        return 1;
+    }
+
+    // check every configuration up front, so the workers only see valid ones
+    int firstValid = -1;
+    for (int i = 0; i < configCount; i++) {
+        char text[REPLAY_LINE_LENGTH];
+        strcpy(text, configs[i].text);
+        configs[i].valid = applyConfig(text, &log);
+        if (!configs[i].valid) {
+            fprintf(stderr, "config on line %d skipped\n", configs[i].lineNumber);
+        } else if (firstValid < 0) {
+            firstValid = i;
+        }
+    }
+
+    FILE *signals = NULL;
+    if (signalsPath) {
+        signals = fopen(signalsPath, "w");
+        if (!signals) {
+            perror(signalsPath);
+            return 1;
+        }
+        fprintf(signals, "time (us)");
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            fprintf(signals, ",gyroADC[%d],gyroADCf[%d],axisP[%d],axisI[%d],axisD[%d],axisF[%d]", axis, axis, axis, axis, axis, axis);
+        }
+        fprintf(signals, "\n");
+        fflush(signals);
+    }
+
+    float (*gyroFiltered)[XYZ_AXIS_COUNT] = malloc(log.sampleCount * sizeof(*gyroFiltered));
+    float (*dterm)[XYZ_AXIS_COUNT] = malloc(log.sampleCount * sizeof(*dterm));
+    float (*gyroReference)[XYZ_AXIS_COUNT] = malloc(log.sampleCount * sizeof(*gyroReference));
+    float (*gyroDerivative)[XYZ_AXIS_COUNT] = malloc(log.sampleCount * sizeof(*gyroDerivative));
+    memcpy(gyroReference, log.gyro, log.sampleCount * sizeof(*gyroReference));
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        smoothZeroPhase(&gyroReference[0][axis], XYZ_AXIS_COUNT, log.sampleCount, log.looptimeUs);
+    }
+    for (int i = 0; i < log.sampleCount; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroDerivative[i][axis] = i ? gyroReference[i][axis] - gyroReference[i - 1][axis] : 0.0f;
+        }
+    }
+
+    pgResetAll();
+    if (!gyroInit()) {
+        fprintf(stderr, "gyro init failed\n");
+        return 1;
+    }
+    gyroDevPtr->scale = gyroScale;
+    calibrateGyro();
+
+    fprintf(stderr, "%d samples at %u us, setpoints %s, eRPM %s\n", log.sampleCount, log.looptimeUs,
+        log.hasSetpoint ? "yes" : "no", log.hasErpm ? "yes" : "no");
+
+    // the workers are forked with the calibrated gyro and fill in a shared result table
+    replayResult_t *results = mmap(NULL, MAX(configCount, 1) * sizeof(*results), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int job = 0; job < jobs; job++) {
+        const pid_t child = jobs > 1 ? fork() : 0;
+        if (child < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (child > 0) {
+            continue;
+        }
+        for (int i = job; i < configCount; i += jobs) {
+            if (configs[i].valid) {
+                applyConfig(configs[i].text, &log);
+                replayConfig(&log, gyroFiltered, dterm, i == firstValid ? signals : NULL);
+                analyse(&log, gyroFiltered, dterm, gyroReference, gyroDerivative, &results[i]);
+            }
+        }
+        if (jobs > 1) {
+            if (signals) {
+                fflush(signals);
+            }
+            _exit(0);
+        }
+    }
+    while (wait(NULL) > 0) {
+    }
+
+    const double seconds = secondsSince(&start);
+
+    printf("config,gyro_delay_us[0],gyro_delay_us[1],gyro_delay_us[2],gyro_noise[0],gyro_noise[1],gyro_noise[2],"
+        "dterm_delay_us[0],dterm_delay_us[1],dterm_delay_us[2],dterm_noise[0],dterm_noise[1],dterm_noise[2]\n");
+    int replayed = 0;
+    for (int i = 0; i < configCount; i++) {
+        if (configs[i].valid) {
+            printResult(configs[i].lineNumber, &results[i]);
+            replayed++;
+        }
+    }
+    fprintf(stderr, "%d configs in %.2f s, %.0f configs per minute\n", replayed, seconds, replayed * 60.0 / MAX(seconds, 1e-9));
+
+    if (signals) {
+        fclose(signals);
+    }
+    return 0;
+}
@@ -416,3 +416,56 @@ TEST(AlignSensorTest, AlignmentBitmasks)
     EXPECT_EQ(2, ALIGNMENT_AXIS_ROTATIONS(bits, FD_PITCH));
     EXPECT_EQ(0, ALIGNMENT_AXIS_ROTATIONS(bits, FD_ROLL));
 }
+
+static void testSensorRotation(sensor_align_e alignment, bool expectPermutation)
+{
+    const float vectors[][XYZ_AXIS_COUNT] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 0.3f, -0.5f, 0.8f } };
+
+    sensorRotation_t rotation;
+    buildSensorRotation(&rotation, alignment, NULL);
+
+    EXPECT_EQ(expectPermutation, rotation.permutation[X] != 0) << "alignment: " << alignment;
+
+    for (unsigned i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        float expected[XYZ_AXIS_COUNT] = { vectors[i][X], vectors[i][Y], vectors[i][Z] };
+        float actual[XYZ_AXIS_COUNT] = { vectors[i][X], vectors[i][Y], vectors[i][Z] };
+
+        alignSensorViaRotation(expected, alignment);
+        applySensorRotation(actual, &rotation);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_NEAR(expected[axis], actual[axis], TOL) << "alignment: " << alignment << " axis: " << axis;
+        }
+    }
+}
+
+TEST(AlignSensorTest, SensorRotationWithStandardBoardAlignment)
+{
+    for (int alignment = CW0_DEG; alignment <= CW270_DEG_FLIP; alignment++) {
+        testSensorRotation((sensor_align_e)alignment, true);
+    }
+
+    // the driver provided alignment is not rotated
+    testSensorRotation(ALIGN_DEFAULT, true);
+}
+
+// these change the board alignment, so they run last
+TEST(AlignSensorTest, SensorRotationWithRightAngleBoardAlignment)
+{
+    boardAlignment_t boardAlignment = { .rollDegrees = 0, .pitchDegrees = 180, .yawDegrees = 90 };
+    initBoardAlignment(&boardAlignment);
+
+    for (int alignment = CW0_DEG; alignment <= CW270_DEG_FLIP; alignment++) {
+        testSensorRotation((sensor_align_e)alignment, true);
+    }
+}
+
+TEST(AlignSensorTest, SensorRotationWithBoardAlignment)
+{
+    boardAlignment_t boardAlignment = { .rollDegrees = 10, .pitchDegrees = -5, .yawDegrees = 45 };
+    initBoardAlignment(&boardAlignment);
+
+    for (int alignment = CW0_DEG; alignment <= CW270_DEG_FLIP; alignment++) {
+        testSensorRotation((sensor_align_e)alignment, false);
+    }
+}
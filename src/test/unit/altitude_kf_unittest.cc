@@ -0,0 +1,136 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "flight/altitude_kf.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define DT 0.01f    // 100Hz attitude task
+
+TEST(AltitudeKfTest, ConvergesToConstantMeasurement)
+{
+    altitudeKf_t kf;
+    altitudeKfInit(&kf, 50.0f, 2.0f);
+
+    for (int i = 0; i < 1000; i++) {
+        altitudeKfPredict(&kf, 0.0f, DT);
+        if (i % 4 == 0) {
+            altitudeKfUpdate(&kf, 1234.0f, 50.0f * 50.0f);
+        }
+    }
+
+    EXPECT_NEAR(1234.0f, kf.x[ALTITUDE_KF_ALTITUDE], 1.0f);
+    EXPECT_NEAR(0.0f, kf.x[ALTITUDE_KF_VELOCITY], 1.0f);
+    // the estimate is more certain than a single measurement
+    EXPECT_LT(kf.P[ALTITUDE_KF_ALTITUDE][ALTITUDE_KF_ALTITUDE], 50.0f * 50.0f);
+}
+
+TEST(AltitudeKfTest, TracksConstantClimb)
+{
+    altitudeKf_t kf;
+    altitudeKfInit(&kf, 50.0f, 2.0f);
+
+    const float climbRate = 200.0f;  // cm/s
+    float altitude = 0.0f;
+    for (int i = 0; i < 2000; i++) {
+        altitude += climbRate * DT;
+        altitudeKfPredict(&kf, 0.0f, DT);
+        if (i % 4 == 0) {
+            altitudeKfUpdate(&kf, altitude, 50.0f * 50.0f);
+        }
+    }
+
+    EXPECT_NEAR(altitude, kf.x[ALTITUDE_KF_ALTITUDE], 10.0f);
+    EXPECT_NEAR(climbRate, kf.x[ALTITUDE_KF_VELOCITY], 10.0f);
+}
+
+TEST(AltitudeKfTest, EstimatesAccelerometerBias)
+{
+    altitudeKf_t kf;
+    altitudeKfInit(&kf, 50.0f, 2.0f);
+
+    // hovering with an accelerometer that reads 30cm/s/s too high
+    for (int i = 0; i < 6000; i++) {
+        altitudeKfPredict(&kf, 30.0f, DT);
+        if (i % 4 == 0) {
+            altitudeKfUpdate(&kf, 0.0f, 50.0f * 50.0f);
+        }
+    }
+
+    EXPECT_NEAR(30.0f, kf.x[ALTITUDE_KF_ACC_BIAS], 3.0f);
+    EXPECT_NEAR(0.0f, kf.x[ALTITUDE_KF_VELOCITY], 5.0f);
+}
+
+TEST(AltitudeKfTest, AccelerationLeadsMeasurement)
+{
+    altitudeKf_t kf;
+    altitudeKfInit(&kf, 50.0f, 2.0f);
+
+    for (int i = 0; i < 1000; i++) {
+        altitudeKfPredict(&kf, 0.0f, DT);
+        altitudeKfUpdate(&kf, 0.0f, 50.0f * 50.0f);
+    }
+
+    // a step in acceleration shows in the velocity before the altitude measurements move much
+    for (int i = 0; i < 20; i++) {
+        altitudeKfPredict(&kf, 500.0f, DT);
+    }
+    EXPECT_NEAR(100.0f, kf.x[ALTITUDE_KF_VELOCITY], 5.0f);
+}
+
+TEST(AltitudeKfTest, CovarianceStaysSymmetric)
+{
+    altitudeKf_t kf;
+    altitudeKfInit(&kf, 50.0f, 2.0f);
+
+    for (int i = 0; i < 500; i++) {
+        altitudeKfPredict(&kf, sinf(i * 0.1f) * 100.0f, DT);
+        altitudeKfUpdate(&kf, i * 0.5f, (i % 2) ? 2500.0f : 90000.0f);
+    }
+
+    for (int i = 0; i < ALTITUDE_KF_STATE_COUNT; i++) {
+        EXPECT_GT(kf.P[i][i], 0.0f);
+        for (int j = 0; j < i; j++) {
+            EXPECT_NEAR(kf.P[i][j], kf.P[j][i], fabsf(kf.P[i][j]) * 1e-3f + 1e-3f);
+        }
+    }
+}
+
+TEST(AltitudeKfTest, SetAltitudeKeepsVelocity)
+{
+    altitudeKf_t kf;
+    altitudeKfInit(&kf, 50.0f, 2.0f);
+    kf.x[ALTITUDE_KF_ALTITUDE] = 500.0f;
+    kf.x[ALTITUDE_KF_VELOCITY] = 40.0f;
+
+    altitudeKfSetAltitude(&kf, 0.0f);
+
+    EXPECT_FLOAT_EQ(0.0f, kf.x[ALTITUDE_KF_ALTITUDE]);
+    EXPECT_FLOAT_EQ(40.0f, kf.x[ALTITUDE_KF_VELOCITY]);
+}
@@ -38,6 +38,7 @@ extern "C" {
     #include "flight/servos.h"
     #include "io/beeper.h"
     #include "io/gps.h"
+    #include "msp/msp.h"
     #include "rx/rx.h"
     #include "scheduler/scheduler.h"
     #include "sensors/acceleration.h"
@@ -72,6 +73,7 @@ extern "C" {
     rxRuntimeConfig_t rxRuntimeConfig = {};
     uint16_t GPS_distanceToHome = 0;
     int16_t GPS_directionToHome = 0;
+    float GPS_scaleLonDown = 1.0f;
     acc_t acc = {};
 }
 
@@ -1040,6 +1042,7 @@ extern "C" {
     void gyroStartCalibration(bool) {}
     bool isFirstArmingGyroCalibrationRunning(void) { return false; }
     void pidController(const pidProfile_t *, timeUs_t) {}
+    void imuPropagateAttitude(void) {}
     void pidStabilisationState(pidStabilisationState_e) {}
     void mixTable(timeUs_t , uint8_t) {};
     void writeMotors(void) {};
@@ -1060,6 +1063,7 @@ extern "C" {
     void mspSerialReleaseSharedTelemetryPorts(void) {}
     void telemetryCheckState(void) {}
     void mspSerialAllocatePorts(void) {}
+    void mspFcSubscriptionTrigger(uint8_t) {}
     void gyroReadTemperature(void) {}
     void updateRcCommands(void) {}
     void applyAltHold(void) {}
@@ -1068,6 +1072,7 @@ extern "C" {
     void processRcCommand(void) {}
     void updateGpsStateForHomeAndHoldMode(void) {}
     void blackboxUpdate(timeUs_t) {}
+    void blackboxLogIteration(timeUs_t) {}
     void transponderUpdate(timeUs_t) {}
     void GPS_reset_home_position(void) {}
     void accSetCalibrationCycles(uint16_t) {}
@@ -1090,4 +1095,5 @@ extern "C" {
     float getCosTiltAngle(void) { return 0.0f; }
     void pidSetItermReset(bool) {}
     void applyAccelerometerTrimsDelta(rollAndPitchTrims_t*) {}
+    bool isInitDeferredComplete(void) { return true; }
 }
@@ -15,7 +15,9 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 extern "C" {
     #include "platform.h"
@@ -32,6 +34,7 @@ extern "C" {
 }
 
 #include "unittest_macros.h"
+#include "unittest_benchmark.h"
 #include "gtest/gtest.h"
 
 
@@ -45,8 +48,16 @@ static uint8_t serialWriteBuffer[SERIAL_BUFFER_SIZE];
 
 serialPort_t serialTestInstance;
 
+// set by the benchmark to count the written bytes without storing them
+static bool serialDiscardWrites = false;
+static int serialDiscardedCount = 0;
+
 void serialWrite(serialPort_t *instance, uint8_t ch)
 {
+    if (serialDiscardWrites) {
+        serialDiscardedCount++;
+        return;
+    }
     EXPECT_EQ(instance, &serialTestInstance);
     EXPECT_LT(serialWritePos, sizeof(serialWriteBuffer));
     serialWriteBuffer[serialWritePos++] = ch;
@@ -54,6 +65,11 @@ void serialWrite(serialPort_t *instance, uint8_t ch)
 
 void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
 {
+    if (serialDiscardWrites) {
+        // a bulk write costs the device the same as a single byte write
+        serialDiscardedCount += count;
+        return;
+    }
     while(count--)
         serialWrite(instance, *data++);
 }
@@ -240,12 +256,144 @@ TEST(BlackboxTest, TestWriteTag2_3SVariable_BITS887)
     EXPECT_EQ(0, buf[3]); // ensure next byte has not been written
     buf += 3;
 }
+// Reads back a BITPACK_8S32 group, returns the number of bytes consumed
+static int unpackS32Group(const uint8_t *buffer, int32_t *values, int valueCount)
+{
+    const uint8_t *pos = buffer;
+    const int bitWidth = *pos++;
+    uint64_t bits = 0;
+    int bitCount = 0;
+
+    for (int i = 0; i < valueCount; i++) {
+        while (bitCount < bitWidth) {
+            bits |= (uint64_t)*pos++ << bitCount;
+            bitCount += 8;
+        }
+        const uint32_t zigzag = bitWidth ? bits & (0xFFFFFFFFu >> (32 - bitWidth)) : 0;
+        bits = bitWidth == 64 ? 0 : bits >> bitWidth;
+        bitCount -= bitWidth;
+        values[i] = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    }
+    return pos - buffer;
+}
+
+TEST(BlackboxEncodingTest, TestBitpackS32Group)
+{
+    uint8_t buffer[BLACKBOX_BITPACK_GROUP_MAX_BYTES];
+    int32_t decoded[BLACKBOX_BITPACK_GROUP_SIZE];
+
+    // all zero values need only the bit width byte
+    const int32_t zeros[4] = { 0, 0, 0, 0 };
+    EXPECT_EQ(1, blackboxBitpackS32Group(buffer, zeros, 4));
+    EXPECT_EQ(0, buffer[0]);
+
+    // zigzag 1, 2, 3 at 2 bits each: 01 10 11 -> 0x39
+    const int32_t small[3] = { -1, 1, -2 };
+    EXPECT_EQ(2, blackboxBitpackS32Group(buffer, small, 3));
+    EXPECT_EQ(2, buffer[0]);
+    EXPECT_EQ(0x39, buffer[1]);
+
+    // the largest value sets the width of the whole group
+    const int32_t mixed[8] = { 0, 1, -1, 300, -300, 7, -8000, 12 };
+    const int length = blackboxBitpackS32Group(buffer, mixed, 8);
+    EXPECT_EQ(14, buffer[0]); // zigzag of -8000 is 15999
+    EXPECT_EQ(1 + 8 * 14 / 8, length);
+    EXPECT_EQ(length, unpackS32Group(buffer, decoded, 8));
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(mixed[i], decoded[i]);
+    }
+
+    const int32_t extremes[2] = { INT32_MIN, INT32_MAX };
+    EXPECT_EQ(1 + 8, blackboxBitpackS32Group(buffer, extremes, 2));
+    EXPECT_EQ(32, buffer[0]);
+    unpackS32Group(buffer, decoded, 2);
+    EXPECT_EQ(INT32_MIN, decoded[0]);
+    EXPECT_EQ(INT32_MAX, decoded[1]);
+}
+
+TEST(BlackboxEncodingTest, TestWriteBitpackS32Array)
+{
+    serialTestResetBuffers();
+    int32_t values[11];
+    int32_t decoded[11];
+
+    for (int i = 0; i < 11; i++) {
+        values[i] = (i & 1) ? -i * 37 : i * 5;
+    }
+    blackboxWriteBitpackS32Array(values, 11);
+
+    // the array is split into a group of 8 followed by a group of 3
+    const int firstLength = unpackS32Group(serialWriteBuffer, decoded, 8);
+    const int secondLength = unpackS32Group(serialWriteBuffer + firstLength, decoded + 8, 3);
+    EXPECT_EQ(serialWritePos, firstLength + secondLength);
+    for (int i = 0; i < 11; i++) {
+        EXPECT_EQ(values[i], decoded[i]);
+    }
+}
+
+TEST(BlackboxEncodingTest, BenchmarkPackedInterframe)
+{
+    // the fields of an interframe that can be packed: P[3], D[3] and F[3], gyro[3] and motors[4],
+    // written with the variable byte encodings used so far and with BITPACK_8S32
+    static const int iterations = 200000;
+    static const int frameCount = 64;
+    int32_t frames[frameCount][16];
+
+    uint32_t seed = 1;
+    for (int n = 0; n < frameCount; n++) {
+        for (int i = 0; i < 16; i++) {
+            seed = seed * 1103515245 + 12345;
+            // P, D and F deltas are small, gyro and motor predictions are off by more
+            const int range = i < 9 ? 64 : 512;
+            frames[n][i] = (int32_t)((seed >> 16) % (2 * range)) - range;
+        }
+    }
+
+    serialTestResetBuffers();
+    serialDiscardWrites = true;
+
+    serialDiscardedCount = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < iterations; n++) {
+        int32_t *frame = frames[n % frameCount];
+        for (int i = 0; i < 3; i++) {
+            blackboxWriteSignedVB(frame[i]);
+        }
+        blackboxWriteSignedVBArray(frame + 3, 6);
+        blackboxWriteSignedVBArray(frame + 9, 3);
+        blackboxWriteSignedVBArray(frame + 12, 4);
+    }
+    const double vbNs = nanosecondsSince(&start) / iterations;
+    const double vbBytes = (double)serialDiscardedCount / iterations;
+
+    serialDiscardedCount = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < iterations; n++) {
+        int32_t *frame = frames[n % frameCount];
+        blackboxWriteBitpackS32Array(frame, 3);
+        blackboxWriteBitpackS32Array(frame + 3, 6);
+        blackboxWriteBitpackS32Array(frame + 9, 3);
+        blackboxWriteBitpackS32Array(frame + 12, 4);
+    }
+    const double packedNs = nanosecondsSince(&start) / iterations;
+    const double packedBytes = (double)serialDiscardedCount / iterations;
+
+    serialDiscardWrites = false;
+
+    printf("[ BENCH    ] variable byte %.1f ns %.1f bytes, bitpacked %.1f ns %.1f bytes per frame\n", vbNs, vbBytes, packedNs, packedBytes);
+
+    EXPECT_GT(vbBytes, 0);
+    EXPECT_GT(packedBytes, 0);
+}
+
 // STUBS
 extern "C" {
 PG_REGISTER(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 0);
 int32_t blackboxHeaderBudget;
 void mspSerialAllocatePorts(void) {}
 void blackboxWrite(uint8_t value) {serialWrite(blackboxPort, value);}
+void blackboxWriteBuf(const uint8_t *buf, int length) {serialWriteBuf(blackboxPort, buf, length);}
 int blackboxWriteString(const char *s)
 {
     const uint8_t *pos = (uint8_t*)s;
@@ -219,6 +219,106 @@ TEST(BlackboxTest, Test_8kHz)
     EXPECT_EQ(true, blackboxShouldLogPFrame());
 }
 
+TEST(BlackboxTest, TestSnapshotRingCountsDroppedFrames)
+{
+    blackboxConfigMutable()->p_ratio = 256;
+    // 8kHz PIDloop
+    targetPidLooptime = 125;
+    blackboxInit();
+    EXPECT_EQ(0, blackboxDroppedFrames);
+
+    // nothing drains the ring, so it fills up and the following frames are dropped
+    int snapshotCount = 0;
+    while (blackboxDroppedFrames == 0) {
+        ASSERT_LT(snapshotCount, 256);
+        blackboxSnapshotMainState(0, false);
+        ++snapshotCount;
+    }
+    EXPECT_GT(snapshotCount, 1);
+    EXPECT_EQ(true, blackboxSnapshotResync);
+    blackboxSnapshotMainState(0, false);
+    EXPECT_EQ(2, blackboxDroppedFrames);
+
+    // a new log starts with an empty ring
+    blackboxInit();
+    EXPECT_EQ(0, blackboxDroppedFrames);
+    EXPECT_EQ(false, blackboxSnapshotResync);
+    blackboxSnapshotMainState(0, false);
+    EXPECT_EQ(0, blackboxDroppedFrames);
+}
+
+TEST(BlackboxTest, TestDroppedFramesForceSlowFrame)
+{
+    blackboxConfigMutable()->p_ratio = 256;
+    targetPidLooptime = 125;
+    blackboxInit();
+    writeSlowFrameIfNeeded();
+    EXPECT_EQ(false, writeSlowFrameIfNeeded());
+
+    // the dropped frame count is logged in the slow frame as soon as it changes
+    while (blackboxDroppedFrames == 0) {
+        blackboxSnapshotMainState(0, false);
+    }
+    EXPECT_EQ(true, writeSlowFrameIfNeeded());
+    EXPECT_EQ(false, writeSlowFrameIfNeeded());
+}
+
+TEST(BlackboxTest, TestAdaptivePRate)
+{
+    blackboxConfigMutable()->p_ratio = 32;
+    // 1kHz PIDloop
+    targetPidLooptime = 1000;
+    blackboxInit();
+    EXPECT_EQ(1, blackboxPInterval);
+
+    // the device keeps up, the rate stays
+    blackboxUpdatePRate();
+    EXPECT_EQ(0, blackboxPRateShiftRequested);
+
+    // a dropped frame halves the P-frame rate, but only from the next I-frame on
+    while (blackboxDroppedFrames == 0) {
+        blackboxSnapshotMainState(0, false);
+    }
+    blackboxUpdatePRate();
+    EXPECT_EQ(1, blackboxPRateShiftRequested);
+    blackboxAdvanceIterationTimers();
+    EXPECT_EQ(0, blackboxPRateShift);
+    for (int ii = 1; ii < 32; ++ii) {
+        blackboxAdvanceIterationTimers();
+    }
+    EXPECT_EQ(true, blackboxShouldLogIFrame());
+    EXPECT_EQ(1, blackboxPRateShift);
+    blackboxAdvanceIterationTimers();
+    EXPECT_EQ(false, blackboxShouldLogPFrame());
+    blackboxAdvanceIterationTimers();
+    EXPECT_EQ(true, blackboxShouldLogPFrame());
+
+    // the full ring keeps the device behind, the rate is lowered again after a hold off
+    blackboxUpdatePRate();
+    EXPECT_EQ(1, blackboxPRateShiftRequested);
+    for (int ii = 0; ii < 1000; ++ii) {
+        blackboxUpdatePRate();
+    }
+    // down to I-frames and 1 in 16 iterations logged as P-frames
+    EXPECT_EQ(4, blackboxPRateShiftRequested);
+
+    // once the device keeps up the rate is raised a step at a time
+    blackboxInit();
+    blackboxPRateShiftRequested = 2;
+    int updates = 0;
+    while (blackboxPRateShiftRequested == 2) {
+        ASSERT_LT(updates, 10000);
+        blackboxUpdatePRate();
+        ++updates;
+    }
+    EXPECT_EQ(1, blackboxPRateShiftRequested);
+    EXPECT_GT(updates, 1000);
+    for (int ii = 0; ii < updates / 2; ++ii) {
+        blackboxUpdatePRate();
+    }
+    EXPECT_EQ(1, blackboxPRateShiftRequested);
+}
+
 TEST(BlackboxTest, Test_zero_p_ratio)
 {
     blackboxConfigMutable()->p_ratio = 0;
@@ -363,7 +463,6 @@ uint8_t stateFlags;
 const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000,
         400000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 2470000}; // see baudRate_e
 uint8_t debugMode;
-int32_t blackboxHeaderBudget;
 gpsSolutionData_t gpsSol;
 int32_t GPS_home[2];
 
@@ -387,6 +486,7 @@ bool isModeActivationConditionPresent(boxId_e) {return false;}
 uint32_t millis(void) {return 0;}
 bool sensors(uint32_t) {return false;}
 void serialWrite(serialPort_t *, uint8_t) {}
+void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
 uint32_t serialTxBytesFree(const serialPort_t *) {return 0;}
 bool isSerialTransmitBufferEmpty(const serialPort_t *) {return false;}
 bool featureIsEnabled(uint32_t) {return false;}
@@ -33,6 +33,7 @@ extern "C" {
     #include "drivers/buf_writer.h"
     #include "drivers/vtx_common.h"
     #include "fc/config.h"
+    #include "fc/init.h"
     #include "fc/rc_adjustments.h"
     #include "fc/runtime_config.h"
     #include "flight/mixer.h"
@@ -304,6 +305,9 @@ uint8_t __config_end = 0x10;
 uint16_t averageSystemLoadPercent = 0;
 
 timeDelta_t getTaskDeltaTime(cfTaskId_e){ return 0; }
+static const bootStageTime_t bootStageTime = { .name = "", .durationUs = 0, .deferred = false };
+const bootStageTime_t *getBootStageTime(bootStage_e) { return &bootStageTime; }
+timeUs_t getBootSchedulerStartUs(void) { return 0; }
 uint16_t currentRxRefreshRate = 9000;
 armingDisableFlags_e getArmingDisableFlags(void) { return ARMING_DISABLED_NO_GYRO; }
 
@@ -322,6 +326,7 @@ const char * const shortGitRevision = "MASTER";
 
 uint32_t serialRxBytesWaiting(const serialPort_t *) {return 0;}
 uint8_t serialRead(serialPort_t *){return 0;}
+uint32_t serialTxBytesFree(const serialPort_t *) {return 0;}
 
 void bufWriterAppend(bufWriter_t *, uint8_t ch){ printf("%c", ch); }
 void serialWriteBufShim(void *, const uint8_t *, int) {}
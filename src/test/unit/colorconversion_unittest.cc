@@ -0,0 +1,156 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/color.h"
+    #include "common/colorconversion.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_benchmark.h"
+#include "gtest/gtest.h"
+
+// The conversion without the kept result, hsvToRgb24() has to match it
+static rgbColor24bpp_t referenceHsvToRgb24(const hsvColor_t *c)
+{
+    rgbColor24bpp_t r = { .raw = { 0, 0, 0 } };
+
+    const uint16_t val = c->v;
+    const uint16_t sat = 255 - c->s;
+    const uint16_t hue = c->h;
+
+    if (sat == 0) {
+        r.rgb.r = val;
+        r.rgb.g = val;
+        r.rgb.b = val;
+        return r;
+    }
+
+    const uint32_t base = ((255 - sat) * val) >> 8;
+    switch (hue / 60) {
+    case 0:
+        r.rgb.r = val;
+        r.rgb.g = (((val - base) * hue) / 60) + base;
+        r.rgb.b = base;
+        break;
+    case 1:
+        r.rgb.r = (((val - base) * (60 - (hue % 60))) / 60) + base;
+        r.rgb.g = val;
+        r.rgb.b = base;
+        break;
+    case 2:
+        r.rgb.r = base;
+        r.rgb.g = val;
+        r.rgb.b = (((val - base) * (hue % 60)) / 60) + base;
+        break;
+    case 3:
+        r.rgb.r = base;
+        r.rgb.g = (((val - base) * (60 - (hue % 60))) / 60) + base;
+        r.rgb.b = val;
+        break;
+    case 4:
+        r.rgb.r = (((val - base) * (hue % 60)) / 60) + base;
+        r.rgb.g = base;
+        r.rgb.b = val;
+        break;
+    case 5:
+        r.rgb.r = val;
+        r.rgb.g = base;
+        r.rgb.b = (((val - base) * (60 - (hue % 60))) / 60) + base;
+        break;
+    }
+    return r;
+}
+
+TEST(ColorConversionUnittest, TestMatchesReference)
+{
+    int mismatches = 0;
+    for (int h = 0; h < 360; h++) {
+        for (int s = 0; s < 256; s += 3) {
+            for (int v = 0; v < 256; v++) {
+                const hsvColor_t hsv = { (uint16_t)h, (uint8_t)s, (uint8_t)v };
+                const rgbColor24bpp_t expected = referenceHsvToRgb24(&hsv);
+                const rgbColor24bpp_t *rgb = hsvToRgb24(&hsv);
+                if (rgb->rgb.r != expected.rgb.r || rgb->rgb.g != expected.rgb.g || rgb->rgb.b != expected.rgb.b) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    EXPECT_EQ(0, mismatches);
+}
+
+TEST(ColorConversionUnittest, TestRepeatedColour)
+{
+    const hsvColor_t red = { 0, 0, 255 };
+    const hsvColor_t blue = { 240, 0, 128 };
+
+    EXPECT_EQ(255, hsvToRgb24(&red)->rgb.r);
+    EXPECT_EQ(0, hsvToRgb24(&red)->rgb.b);
+
+    const rgbColor24bpp_t *rgb = hsvToRgb24(&blue);
+    EXPECT_EQ(0, rgb->rgb.r);
+    EXPECT_EQ(0, rgb->rgb.g);
+    EXPECT_EQ(128, rgb->rgb.b);
+
+    rgb = hsvToRgb24(&red);
+    EXPECT_EQ(255, rgb->rgb.r);
+    EXPECT_EQ(0, rgb->rgb.g);
+    EXPECT_EQ(0, rgb->rgb.b);
+}
+
+TEST(ColorConversionUnittest, TestThroughput)
+{
+    // a 64 LED strip in runs of 8 palette colours, as the LEDs of each direction or function are
+    hsvColor_t strip[64];
+    for (int i = 0; i < 64; i++) {
+        strip[i].h = (i / 8) * 30;
+        strip[i].s = 0;
+        strip[i].v = 255;
+    }
+    const int iterations = 20000;
+    volatile uint8_t sink = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < iterations; n++) {
+        for (int i = 0; i < 64; i++) {
+            sink += referenceHsvToRgb24(&strip[i]).rgb.g;
+        }
+    }
+    const double nsReference = nanosecondsSince(&start) / ((double)iterations * 64);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < iterations; n++) {
+        for (int i = 0; i < 64; i++) {
+            sink += hsvToRgb24(&strip[i])->rgb.g;
+        }
+    }
+    const double nsKept = nanosecondsSince(&start) / ((double)iterations * 64);
+
+    printf("[ BENCH    ] per LED: converted %5.2f ns, kept for runs %5.2f ns\n", nsReference, nsKept);
+}
@@ -21,12 +21,15 @@
 #include <limits.h>
 
 #include <math.h>
+#include <time.h>
 
 extern "C" {
     #include "common/filter.h"
+    #include "common/utils.h"
 }
 
 #include "unittest_macros.h"
+#include "unittest_benchmark.h"
 #include "gtest/gtest.h"
 
 TEST(FilterUnittest, TestPt1FilterInit)
@@ -114,3 +117,406 @@ TEST(FilterUnittest, TestSlewFilter)
     slewFilterApply(&filter, 200.0f);
     EXPECT_EQ(200, filter.state);
 }
+
+TEST(FilterUnittest, TestIntMovingAverage)
+{
+    uint16_t buf[4];
+    intMovingAverage_t filter;
+    intMovingAverageInit(&filter, 4, buf);
+
+    // the window starts out filled with zeros
+    EXPECT_EQ(250, intMovingAverageUpdate(&filter, 1000));
+    EXPECT_EQ(500, intMovingAverageUpdate(&filter, 1000));
+    EXPECT_EQ(750, intMovingAverageUpdate(&filter, 1000));
+    EXPECT_EQ(1000, intMovingAverageUpdate(&filter, 1000));
+
+    // older samples drop out of the sum as the window wraps
+    EXPECT_EQ(750, intMovingAverageUpdate(&filter, 0));
+    EXPECT_EQ(500, intMovingAverageUpdate(&filter, 0));
+    EXPECT_EQ(750, intMovingAverageUpdate(&filter, 2000));
+    EXPECT_EQ(1500, intMovingAverageUpdate(&filter, 4000));
+    EXPECT_EQ(1500, intMovingAverageUpdate(&filter, 0));
+    EXPECT_EQ(1500, intMovingAverageUpdate(&filter, 0));
+    EXPECT_EQ(1000, intMovingAverageUpdate(&filter, 0));
+    EXPECT_EQ(0, intMovingAverageUpdate(&filter, 0));
+}
+
+static const float filterTestInput[][XYZ_AXIS_COUNT] = {
+    { 100.0f, -50.0f, 10.0f }, { 300.0f, 20.0f, -30.0f }, { -200.0f, 80.0f, 5.0f }, { 50.0f, -70.0f, 0.0f },
+    { 0.0f, 0.0f, 400.0f }, { 1800.0f, -1800.0f, 900.0f }, { -20.0f, 30.0f, -40.0f }, { 10.0f, 10.0f, 10.0f },
+};
+
+TEST(FilterUnittest, TestPt1Filter3MatchesPt1Filter)
+{
+    const float k = pt1FilterGain(100.0f, 125e-6f);
+    pt1Filter3_t filter3;
+    pt1Filter_t filter[XYZ_AXIS_COUNT];
+
+    pt1Filter3Init(&filter3, k);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pt1FilterInit(&filter[axis], k);
+    }
+
+    for (unsigned i = 0; i < ARRAYLEN(filterTestInput); i++) {
+        float values[XYZ_AXIS_COUNT] = { filterTestInput[i][X], filterTestInput[i][Y], filterTestInput[i][Z] };
+        pt1Filter3Apply(&filter3, values);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_FLOAT_EQ(pt1FilterApply(&filter[axis], filterTestInput[i][axis]), values[axis]);
+        }
+    }
+}
+
+TEST(FilterUnittest, TestBiquadFilter3MatchesBiquadFilter)
+{
+    biquadFilter3_t notch3;
+    biquadFilter_t notch[XYZ_AXIS_COUNT];
+    biquadFilter3_t lowpass3;
+    biquadFilter_t lowpass[XYZ_AXIS_COUNT];
+
+    const float notchQ = filterGetNotchQ(260, 160);
+    biquadFilter3Init(&notch3, 260, 125, notchQ, FILTER_NOTCH);
+    biquadFilter3InitLPF(&lowpass3, 150, 125);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInit(&notch[axis], 260, 125, notchQ, FILTER_NOTCH);
+        biquadFilterInitLPF(&lowpass[axis], 150, 125);
+    }
+
+    for (unsigned i = 0; i < ARRAYLEN(filterTestInput); i++) {
+        float values[XYZ_AXIS_COUNT] = { filterTestInput[i][X], filterTestInput[i][Y], filterTestInput[i][Z] };
+        biquadFilter3Apply(&notch3, values);
+        biquadFilter3ApplyDF1(&lowpass3, values);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float expected = biquadFilterApplyDF1(&lowpass[axis], biquadFilterApply(&notch[axis], filterTestInput[i][axis]));
+            EXPECT_FLOAT_EQ(expected, values[axis]);
+        }
+
+        // a cutoff update keeps the state, as biquadFilterUpdateLPF does
+        biquadFilter3UpdateLPF(&lowpass3, 150 + 10 * i, 125);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterUpdateLPF(&lowpass[axis], 150 + 10 * i, 125);
+        }
+    }
+}
+
+TEST(FilterUnittest, TestBiquadLowpassCoeffsMatchUpdateLPF)
+{
+    biquadFilter3_t fromCoeffs;
+    biquadFilter3_t updated;
+    biquadFilter3InitLPF(&fromCoeffs, 100, 125);
+    biquadFilter3InitLPF(&updated, 100, 125);
+
+    for (int n = 0; n < 200; n++) {
+        float values[XYZ_AXIS_COUNT];
+        float expected[XYZ_AXIS_COUNT];
+        const float *input = filterTestInput[n % ARRAYLEN(filterTestInput)];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            values[axis] = expected[axis] = input[axis];
+        }
+        biquadFilter3ApplyDF1(&fromCoeffs, values);
+        biquadFilter3ApplyDF1(&updated, expected);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_FLOAT_EQ(expected[axis], values[axis]);
+        }
+
+        // retune while running, from precomputed coefficients and by calculating them
+        biquadLowpassCoeffs_t coeffs;
+        biquadLowpassCoeffsInit(&coeffs, 100 + 3 * (n % 100), 125);
+        biquadFilter3SetLowpassCoeffs(&fromCoeffs, &coeffs);
+        biquadFilter3UpdateLPF(&updated, 100 + 3 * (n % 100), 125);
+    }
+}
+
+#define TEST_RPM_NOTCH_MOTORS    4
+#define TEST_RPM_NOTCH_HARMONICS 3
+#define TEST_RPM_NOTCH_COUNT     (TEST_RPM_NOTCH_MOTORS * TEST_RPM_NOTCH_HARMONICS)
+
+static float testRpmNotchHz(int motor, int harmonic, int i)
+{
+    return (harmonic + 1) * (150.0f + 20.0f * motor + (i % 50));
+}
+
+TEST(FilterUnittest, TestBiquadNotchBankMatchesBiquadFilter)
+{
+    biquadNotchCoeffs_t coeffs[TEST_RPM_NOTCH_COUNT];
+    biquadNotchState_t state[XYZ_AXIS_COUNT][TEST_RPM_NOTCH_COUNT + 1];
+    biquadFilter_t notch[XYZ_AXIS_COUNT][TEST_RPM_NOTCH_COUNT];
+
+    for (int i = 0; i < TEST_RPM_NOTCH_COUNT; i++) {
+        const float hz = testRpmNotchHz(i / TEST_RPM_NOTCH_HARMONICS, i % TEST_RPM_NOTCH_HARMONICS, 0);
+        biquadNotchCoeffsUpdate(&coeffs[i], hz, 125, 5.0f);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterInit(&notch[axis][i], hz, 125, 5.0f, FILTER_NOTCH);
+        }
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadNotchStateInit(state[axis], TEST_RPM_NOTCH_COUNT);
+    }
+
+    for (int n = 0; n < 200; n++) {
+        const float *input = filterTestInput[n % ARRAYLEN(filterTestInput)];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            float expected = input[axis];
+            for (int i = 0; i < TEST_RPM_NOTCH_COUNT; i++) {
+                expected = biquadFilterApplyDF1(&notch[axis][i], expected);
+            }
+            const float result = biquadNotchBankApply(coeffs, state[axis], TEST_RPM_NOTCH_COUNT, input[axis]);
+            EXPECT_NEAR(expected, result, 0.05f);
+        }
+
+        // move one notch per sample while running, as the RPM filter does
+        const int i = n % TEST_RPM_NOTCH_COUNT;
+        const float hz = testRpmNotchHz(i / TEST_RPM_NOTCH_HARMONICS, i % TEST_RPM_NOTCH_HARMONICS, n);
+        biquadNotchCoeffsUpdate(&coeffs[i], hz, 125, 5.0f);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterUpdate(&notch[axis][i], hz, 125, 5.0f, FILTER_NOTCH);
+        }
+    }
+}
+
+// fixed point samples in Q16.16 degrees per second
+#define TEST_FIXED_ONE (1 << 16)
+
+TEST(FilterUnittest, TestPt1FilterFixedMatchesPt1Filter)
+{
+    const float k = pt1FilterGain(100.0f, 125e-6f);
+    pt1FilterFixed_t fixed;
+    pt1Filter_t filter;
+
+    pt1FilterFixedInit(&fixed, k);
+    pt1FilterInit(&filter, k);
+
+    for (int n = 0; n < 200; n++) {
+        const float input = filterTestInput[n % ARRAYLEN(filterTestInput)][X];
+        const float expected = pt1FilterApply(&filter, input);
+        const int32_t result = pt1FilterFixedApply(&fixed, lrintf(input * TEST_FIXED_ONE));
+        EXPECT_NEAR(expected, (float)result / TEST_FIXED_ONE, 0.01f);
+    }
+
+    // a step settles within the rounding deadband, half an LSB divided by the gain
+    pt1FilterFixedInit(&fixed, k);
+    int32_t result = 0;
+    for (int n = 0; n < 2000; n++) {
+        result = pt1FilterFixedApply(&fixed, 500 * TEST_FIXED_ONE);
+    }
+    EXPECT_NEAR(500 * TEST_FIXED_ONE, result, 0.5f / k + 1);
+}
+
+TEST(FilterUnittest, TestBiquadFilterFixedMatchesBiquadFilter)
+{
+    biquadFilterFixed_t notchFixed;
+    biquadFilter_t notch;
+    biquadFilterFixed_t lowpassFixed;
+    biquadFilter_t lowpass;
+
+    const float notchQ = filterGetNotchQ(260, 160);
+    biquadFilterFixedInit(&notchFixed, 260, 125, notchQ, FILTER_NOTCH);
+    biquadFilterInit(&notch, 260, 125, notchQ, FILTER_NOTCH);
+    biquadFilterFixedInitLPF(&lowpassFixed, 100, 125);
+    biquadFilterInitLPF(&lowpass, 100, 125);
+
+    for (int n = 0; n < 400; n++) {
+        const float input = filterTestInput[n % ARRAYLEN(filterTestInput)][Y];
+        const float expected = biquadFilterApplyDF1(&lowpass, biquadFilterApplyDF1(&notch, input));
+        const int32_t result = biquadFilterFixedApply(&lowpassFixed, biquadFilterFixedApply(&notchFixed, lrintf(input * TEST_FIXED_ONE)));
+        EXPECT_NEAR(expected, (float)result / TEST_FIXED_ONE, 0.05f);
+
+        // a cutoff update keeps the state, as biquadFilterUpdate does
+        if (n % 50 == 49) {
+            biquadFilterFixedUpdate(&lowpassFixed, 100 + n / 5, 125, 1.0f / sqrtf(2.0f), FILTER_LPF);
+            biquadFilterUpdate(&lowpass, 100 + n / 5, 125, 1.0f / sqrtf(2.0f), FILTER_LPF);
+        }
+    }
+}
+
+TEST(FilterUnittest, TestFilter3Crossfade)
+{
+    // filters settled on a constant input, which all of them pass with a gain of 1 before and after the retune
+    const float input[XYZ_AXIS_COUNT] = { 100.0f, -50.0f, 20.0f };
+    biquadFilter3_t lowpass;
+    biquadFilter3_t notch;
+    pt1Filter3_t pt1;
+    biquadFilter3InitLPF(&lowpass, 100, 125);
+    biquadFilter3Init(&notch, 260, 125, filterGetNotchQ(260, 160), FILTER_NOTCH);
+    pt1Filter3Init(&pt1, pt1FilterGain(100, 125e-6f));
+
+    float lowpassValues[XYZ_AXIS_COUNT];
+    float notchValues[XYZ_AXIS_COUNT];
+    float pt1Values[XYZ_AXIS_COUNT];
+    for (int i = 0; i < 2000; i++) {
+        memcpy(lowpassValues, input, sizeof(input));
+        memcpy(notchValues, input, sizeof(input));
+        memcpy(pt1Values, input, sizeof(input));
+        biquadFilter3ApplyDF1(&lowpass, lowpassValues);
+        biquadFilter3Apply(&notch, notchValues);
+        pt1Filter3Apply(&pt1, pt1Values);
+    }
+
+    biquadCrossfade_t lowpassCrossfade;
+    biquadCrossfade_t notchCrossfade;
+    pt1Crossfade_t pt1Crossfade;
+    biquadFilter3CrossfadeStartLPF(&lowpassCrossfade, 200, 125, 40);
+    biquadFilter3CrossfadeStart(&notchCrossfade, 200, 125, filterGetNotchQ(200, 120), FILTER_NOTCH, 40);
+    pt1Filter3CrossfadeStart(&pt1Crossfade, pt1FilterGain(200, 125e-6f), 40);
+
+    // the state is kept, the output does not jump while the coefficients move. Direct form 2 keeps
+    // its state in terms of the coefficients, so it moves a little, reinitialising it would move it by half.
+    for (int i = 0; i < 40; i++) {
+        EXPECT_TRUE(biquadFilter3CrossfadeStep(&lowpass, &lowpassCrossfade));
+        EXPECT_TRUE(biquadFilter3CrossfadeStep(&notch, &notchCrossfade));
+        EXPECT_TRUE(pt1Filter3CrossfadeStep(&pt1, &pt1Crossfade));
+
+        memcpy(lowpassValues, input, sizeof(input));
+        memcpy(notchValues, input, sizeof(input));
+        memcpy(pt1Values, input, sizeof(input));
+        biquadFilter3ApplyDF1(&lowpass, lowpassValues);
+        biquadFilter3Apply(&notch, notchValues);
+        pt1Filter3Apply(&pt1, pt1Values);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_NEAR(input[axis], lowpassValues[axis], fabsf(input[axis]) * 0.001f);
+            EXPECT_NEAR(input[axis], notchValues[axis], fabsf(input[axis]) * 0.05f);
+            EXPECT_NEAR(input[axis], pt1Values[axis], fabsf(input[axis]) * 0.001f);
+        }
+    }
+
+    EXPECT_FALSE(biquadFilter3CrossfadeStep(&lowpass, &lowpassCrossfade));
+    EXPECT_FALSE(biquadFilter3CrossfadeStep(&notch, &notchCrossfade));
+    EXPECT_FALSE(pt1Filter3CrossfadeStep(&pt1, &pt1Crossfade));
+
+    // and they end on the new coefficients
+    biquadFilter3_t expected;
+    biquadFilter3InitLPF(&expected, 200, 125);
+    EXPECT_FLOAT_EQ(expected.b0, lowpass.b0);
+    EXPECT_FLOAT_EQ(expected.b1, lowpass.b1);
+    EXPECT_FLOAT_EQ(expected.a1, lowpass.a1);
+    EXPECT_FLOAT_EQ(expected.a2, lowpass.a2);
+    biquadFilter3Init(&expected, 200, 125, filterGetNotchQ(200, 120), FILTER_NOTCH);
+    EXPECT_FLOAT_EQ(expected.b0, notch.b0);
+    EXPECT_FLOAT_EQ(expected.b1, notch.b1);
+    EXPECT_FLOAT_EQ(expected.a2, notch.a2);
+    EXPECT_FLOAT_EQ(pt1FilterGain(200, 125e-6f), pt1.k);
+}
+
+TEST(FilterUnittest, BenchmarkFilterChain)
+{
+    // compare a chain of two notches and two lowpass filters, applied per axis through function pointers
+    // as the gyro used to, against the same chain run one three axis stage at a time
+    static const int iterations = 200000;
+    static const filterApplyFnPtr notchApplyFn = (filterApplyFnPtr)biquadFilterApply;
+    static const filterApplyFnPtr lowpassApplyFn = (filterApplyFnPtr)pt1FilterApply;
+    static const filterApplyFnPtr lowpass2ApplyFn = (filterApplyFnPtr)biquadFilterApplyDF1;
+
+    biquadFilter_t notch1[XYZ_AXIS_COUNT], notch2[XYZ_AXIS_COUNT], lowpass2[XYZ_AXIS_COUNT];
+    pt1Filter_t lowpass[XYZ_AXIS_COUNT];
+    biquadFilter3_t notch1x3, notch2x3, lowpass2x3;
+    pt1Filter3_t lowpassx3;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInit(&notch1[axis], 260, 125, filterGetNotchQ(260, 160), FILTER_NOTCH);
+        biquadFilterInit(&notch2[axis], 400, 125, filterGetNotchQ(400, 300), FILTER_NOTCH);
+        pt1FilterInit(&lowpass[axis], pt1FilterGain(200, 125e-6f));
+        biquadFilterInitLPF(&lowpass2[axis], 250, 125);
+    }
+    biquadFilter3Init(&notch1x3, 260, 125, filterGetNotchQ(260, 160), FILTER_NOTCH);
+    biquadFilter3Init(&notch2x3, 400, 125, filterGetNotchQ(400, 300), FILTER_NOTCH);
+    pt1Filter3Init(&lowpassx3, pt1FilterGain(200, 125e-6f));
+    biquadFilter3InitLPF(&lowpass2x3, 250, 125);
+
+    float perAxis[XYZ_AXIS_COUNT];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        const float *input = filterTestInput[i % ARRAYLEN(filterTestInput)];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            float value = input[axis];
+            value = notchApplyFn((filter_t *)&notch1[axis], value);
+            value = notchApplyFn((filter_t *)&notch2[axis], value);
+            value = lowpassApplyFn((filter_t *)&lowpass[axis], value);
+            value = lowpass2ApplyFn((filter_t *)&lowpass2[axis], value);
+            perAxis[axis] = value;
+        }
+    }
+    const double nsPerAxis = nanosecondsSince(&start) / iterations;
+
+    float threeAxis[XYZ_AXIS_COUNT];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        const float *input = filterTestInput[i % ARRAYLEN(filterTestInput)];
+        threeAxis[X] = input[X];
+        threeAxis[Y] = input[Y];
+        threeAxis[Z] = input[Z];
+        biquadFilter3Apply(&notch1x3, threeAxis);
+        biquadFilter3Apply(&notch2x3, threeAxis);
+        pt1Filter3Apply(&lowpassx3, threeAxis);
+        biquadFilter3ApplyDF1(&lowpass2x3, threeAxis);
+    }
+    const double nsThreeAxis = nanosecondsSince(&start) / iterations;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_FLOAT_EQ(perAxis[axis], threeAxis[axis]);
+    }
+    printf("[ BENCH    ] per axis: %6.1f ns, three axis: %6.1f ns per gyro sample\n", nsPerAxis, nsThreeAxis);
+}
+
+TEST(FilterUnittest, BenchmarkRpmNotchBank)
+{
+    // compare the RPM filter notches kept as separate biquads per axis, updated through biquadFilterUpdate()
+    // and copied to the other axes, against the notch bank with coefficients shared by the axes
+    static const int iterations = 100000;
+    static biquadFilter_t notch[XYZ_AXIS_COUNT][TEST_RPM_NOTCH_COUNT];
+    static biquadNotchCoeffs_t coeffs[TEST_RPM_NOTCH_COUNT];
+    static biquadNotchState_t state[XYZ_AXIS_COUNT][TEST_RPM_NOTCH_COUNT + 1];
+
+    for (int i = 0; i < TEST_RPM_NOTCH_COUNT; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterInit(&notch[axis][i], testRpmNotchHz(i / TEST_RPM_NOTCH_HARMONICS, i % TEST_RPM_NOTCH_HARMONICS, 0), 125, 5.0f, FILTER_NOTCH);
+        }
+        biquadNotchCoeffsUpdate(&coeffs[i], testRpmNotchHz(i / TEST_RPM_NOTCH_HARMONICS, i % TEST_RPM_NOTCH_HARMONICS, 0), 125, 5.0f);
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadNotchStateInit(state[axis], TEST_RPM_NOTCH_COUNT);
+    }
+
+    float separate[XYZ_AXIS_COUNT];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < iterations; n++) {
+        const float *input = filterTestInput[n % ARRAYLEN(filterTestInput)];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            float value = input[axis];
+            for (int motor = 0; motor < TEST_RPM_NOTCH_MOTORS; motor++) {
+                for (int harmonic = 0; harmonic < TEST_RPM_NOTCH_HARMONICS; harmonic++) {
+                    value = biquadFilterApplyDF1(&notch[axis][motor * TEST_RPM_NOTCH_HARMONICS + harmonic], value);
+                }
+            }
+            separate[axis] = value;
+        }
+        const int i = n % TEST_RPM_NOTCH_COUNT;
+        biquadFilter_t *first = &notch[0][i];
+        biquadFilterUpdate(first, testRpmNotchHz(i / TEST_RPM_NOTCH_HARMONICS, i % TEST_RPM_NOTCH_HARMONICS, n), 125, 5.0f, FILTER_NOTCH);
+        for (int axis = 1; axis < XYZ_AXIS_COUNT; axis++) {
+            notch[axis][i].b0 = first->b0;
+            notch[axis][i].b1 = first->b1;
+            notch[axis][i].b2 = first->b2;
+            notch[axis][i].a1 = first->a1;
+            notch[axis][i].a2 = first->a2;
+        }
+    }
+    const double nsSeparate = nanosecondsSince(&start) / iterations;
+
+    float bank[XYZ_AXIS_COUNT];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < iterations; n++) {
+        const float *input = filterTestInput[n % ARRAYLEN(filterTestInput)];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            bank[axis] = biquadNotchBankApply(coeffs, state[axis], TEST_RPM_NOTCH_COUNT, input[axis]);
+        }
+        const int i = n % TEST_RPM_NOTCH_COUNT;
+        biquadNotchCoeffsUpdate(&coeffs[i], testRpmNotchHz(i / TEST_RPM_NOTCH_HARMONICS, i % TEST_RPM_NOTCH_HARMONICS, n), 125, 5.0f);
+    }
+    const double nsBank = nanosecondsSince(&start) / iterations;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(separate[axis], bank[axis], 0.05f);
+    }
+    printf("[ BENCH    ] separate biquads: %6.1f ns, notch bank: %6.1f ns per gyro sample (%d notches)\n", nsSeparate, nsBank, TEST_RPM_NOTCH_COUNT);
+}
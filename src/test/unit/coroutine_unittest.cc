@@ -0,0 +1,104 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "common/coroutine.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static coroutine_t co;
+static int stage;
+static bool flag;
+
+static coroutineState_e sequenceStep(timeUs_t currentTimeUs)
+{
+    COROUTINE_BEGIN(&co);
+    stage = 1;
+    COROUTINE_YIELD(&co);
+    stage = 2;
+    COROUTINE_WAIT_UNTIL(&co, flag);
+    stage = 3;
+    COROUTINE_DELAY_US(&co, currentTimeUs, 1000);
+    stage = 4;
+    COROUTINE_WAIT_UNTIL_TIMEOUT(&co, flag, currentTimeUs, 500);
+    if (flag) {
+        COROUTINE_RESTART(&co);
+    }
+    stage = 5;
+    COROUTINE_END(&co);
+}
+
+TEST(CoroutineUnittest, TestSequence)
+{
+    COROUTINE_INIT(&co);
+    stage = 0;
+    flag = false;
+
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(0));
+    EXPECT_EQ(1, stage);
+
+    // waits for the flag
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(10));
+    EXPECT_EQ(2, stage);
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(20));
+    EXPECT_EQ(2, stage);
+
+    // the delay starts from the step that reaches it
+    flag = true;
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(100));
+    EXPECT_EQ(3, stage);
+    flag = false;
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(1099));
+    EXPECT_EQ(3, stage);
+
+    // then times out waiting for the flag
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(1100));
+    EXPECT_EQ(4, stage);
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(1599));
+    EXPECT_EQ(4, stage);
+    EXPECT_EQ(COROUTINE_DONE, sequenceStep(1600));
+    EXPECT_EQ(5, stage);
+
+    // further steps do nothing
+    stage = 0;
+    EXPECT_EQ(COROUTINE_DONE, sequenceStep(2000));
+    EXPECT_EQ(0, stage);
+}
+
+TEST(CoroutineUnittest, TestRestart)
+{
+    COROUTINE_INIT(&co);
+    flag = true;
+
+    sequenceStep(0);
+    sequenceStep(10);
+    sequenceStep(20);
+
+    // the flag arrives before the timeout, which starts again from the beginning
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(1020));
+    EXPECT_EQ(4, stage);
+    EXPECT_EQ(COROUTINE_RUNNING, sequenceStep(1030));
+    EXPECT_EQ(1, stage);
+}
@@ -0,0 +1,120 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/crash_log.h"
+
+    #include "fc/runtime_config.h"
+
+    uint8_t armingFlags;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint32_t currentTimeMs;
+
+TEST(CrashLogTest, RepeatsShareTheNewestEntry)
+{
+    crashLogInit();
+    crashLogClear();
+    currentTimeMs = 100;
+
+    crashLogRecord(CRASH_LOG_LOOP_OVERRUN, 1, 300);
+    currentTimeMs = 200;
+    crashLogRecord(CRASH_LOG_LOOP_OVERRUN, 1, 700);
+    crashLogRecord(CRASH_LOG_LOOP_OVERRUN, 1, 500);
+
+    EXPECT_EQ(1, crashLogGetCount());
+    const crashLogEntry_t *entry = crashLogGetEntry(0);
+    EXPECT_EQ(CRASH_LOG_LOOP_OVERRUN, entry->type);
+    EXPECT_EQ(1, entry->task);
+    EXPECT_EQ(3, entry->count);
+    EXPECT_EQ(100u, entry->timeMs);
+    EXPECT_EQ(700u, entry->value);     // the worst of the repeats
+    EXPECT_EQ(0, entry->flags);
+
+    // a different event starts a new entry, and so does the same one again after it
+    ENABLE_ARMING_FLAG(ARMED);
+    crashLogRecord(CRASH_LOG_GYRO_OVERFLOW, CRASH_LOG_NO_TASK, 3);
+    crashLogRecord(CRASH_LOG_LOOP_OVERRUN, 1, 300);
+    DISABLE_ARMING_FLAG(ARMED);
+
+    EXPECT_EQ(3, crashLogGetCount());
+    EXPECT_EQ(CRASH_LOG_GYRO_OVERFLOW, crashLogGetEntry(1)->type);
+    EXPECT_EQ(CRASH_LOG_FLAG_ARMED, crashLogGetEntry(1)->flags);
+    EXPECT_EQ(1, crashLogGetEntry(2)->count);
+    EXPECT_EQ(NULL, crashLogGetEntry(3));
+}
+
+TEST(CrashLogTest, OldestEntriesAreOverwritten)
+{
+    crashLogInit();
+    crashLogClear();
+
+    for (int i = 0; i < CRASH_LOG_ENTRIES + 3; i++) {
+        crashLogRecord(CRASH_LOG_LOOP_OVERRUN, i, i);
+    }
+
+    EXPECT_EQ(CRASH_LOG_ENTRIES, crashLogGetCount());
+    EXPECT_EQ(3u, crashLogGetEntry(0)->value);
+    EXPECT_EQ(CRASH_LOG_ENTRIES + 2u, crashLogGetEntry(CRASH_LOG_ENTRIES - 1)->value);
+}
+
+TEST(CrashLogTest, FaultKeepsStackedRegistersAcrossReboot)
+{
+    crashLogInit();
+    crashLogClear();
+
+    const uint16_t boot = crashLogGetBoot();
+    const uint32_t stackedFrame[8] = { 0, 1, 2, 3, 12, 0x08001235, 0x08004560, 0x61000000 };
+    crashLogRecordFault(stackedFrame, 0x8200);
+
+    // the log lives in RAM that is not cleared by a reboot
+    crashLogInit();
+
+    EXPECT_EQ(boot + 1, crashLogGetBoot());
+    ASSERT_EQ(1, crashLogGetCount());
+    const crashLogEntry_t *entry = crashLogGetEntry(0);
+    EXPECT_EQ(CRASH_LOG_HARD_FAULT, entry->type);
+    EXPECT_EQ(boot, entry->boot);
+    EXPECT_EQ(0x8200u, entry->value);
+    EXPECT_EQ(0x08004560u, entry->pc);
+    EXPECT_EQ(0x08001235u, entry->lr);
+    EXPECT_EQ(0x61000000u, entry->psr);
+
+    // a fault in the new boot is not merged with the one before the reboot
+    crashLogRecordFault(stackedFrame, 0x8200);
+    EXPECT_EQ(2, crashLogGetCount());
+}
+
+// STUBS
+
+extern "C" {
+    uint32_t millis(void)
+    {
+        return currentTimeMs;
+    }
+}
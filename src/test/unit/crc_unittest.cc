@@ -0,0 +1,157 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/crc.h"
+    #include "common/streambuf.h"
+    #include "common/utils.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_benchmark.h"
+#include "gtest/gtest.h"
+
+static const uint8_t checkInput[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+// Bitwise references the tables have to match
+static uint8_t referenceCrc8(uint8_t crc, const uint8_t *data, unsigned length, uint8_t poly)
+{
+    for (unsigned i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ poly : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t referenceCrc16Ccitt(uint16_t crc, const uint8_t *data, unsigned length)
+{
+    for (unsigned i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+TEST(CrcUnittest, TestCheckValues)
+{
+    // check values of the catalogued CRCs for "123456789"
+    EXPECT_EQ(0xBC, crc8_dvb_s2_update(0, checkInput, sizeof(checkInput)));
+    EXPECT_EQ(0xF4, crc8_poly_0x07_update(0, checkInput, sizeof(checkInput)));
+    EXPECT_EQ(0xA2, crc8_poly_0x31_update(0, checkInput, sizeof(checkInput)));
+    EXPECT_EQ(0x31C3, crc16_ccitt_update(0, checkInput, sizeof(checkInput)));
+    EXPECT_EQ(0x31, crc8_xor_update(0, checkInput, sizeof(checkInput)));
+}
+
+TEST(CrcUnittest, TestMatchesBitwiseReference)
+{
+    for (unsigned value = 0; value < 256; value++) {
+        for (unsigned seed = 0; seed < 256; seed += 17) {
+            const uint8_t byte = value;
+            EXPECT_EQ(referenceCrc8(seed, &byte, 1, 0xD5), crc8_dvb_s2(seed, byte));
+            EXPECT_EQ(referenceCrc8(seed, &byte, 1, 0x07), crc8_poly_0x07(seed, byte));
+            EXPECT_EQ(referenceCrc8(seed, &byte, 1, 0x31), crc8_poly_0x31(seed, byte));
+            EXPECT_EQ(referenceCrc16Ccitt(seed << 8 | value, &byte, 1), crc16_ccitt(seed << 8 | value, byte));
+        }
+    }
+}
+
+TEST(CrcUnittest, TestXorEveryLengthAndAlignment)
+{
+    uint8_t data[40];
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = i * 37 + 11;
+    }
+
+    for (unsigned offset = 0; offset < 4; offset++) {
+        for (unsigned length = 0; length + offset <= sizeof(data); length++) {
+            uint8_t expected = 0x5A;
+            for (unsigned i = 0; i < length; i++) {
+                expected ^= data[offset + i];
+            }
+            EXPECT_EQ(expected, crc8_xor_update(0x5A, data + offset, length));
+        }
+    }
+}
+
+TEST(CrcUnittest, TestSbufAppend)
+{
+    uint8_t buffer[16];
+    sbuf_t sbuf = { .ptr = buffer, .end = ARRAYEND(buffer) };
+
+    sbufWriteData(&sbuf, checkInput, sizeof(checkInput));
+    crc8_dvb_s2_sbuf_append(&sbuf, buffer);
+    EXPECT_EQ(sizeof(checkInput) + 1, (unsigned)(sbuf.ptr - buffer));
+    EXPECT_EQ(0xBC, buffer[sizeof(checkInput)]);
+
+    sbuf.ptr = buffer + sizeof(checkInput);
+    crc16_ccitt_sbuf_append(&sbuf, buffer);
+    EXPECT_EQ(0x31C3, buffer[sizeof(checkInput)] | buffer[sizeof(checkInput) + 1] << 8);
+}
+
+TEST(CrcUnittest, TestThroughput)
+{
+    // a CRSF frame is at most 64 bytes, MSP replies are larger
+    static uint8_t frame[64];
+    for (unsigned i = 0; i < sizeof(frame); i++) {
+        frame[i] = i * 13 + 5;
+    }
+    const int iterations = 100000;
+    volatile uint32_t sink = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        sink += referenceCrc8(i, frame, sizeof(frame), 0xD5);
+    }
+    const double nsBitwise = nanosecondsSince(&start) / ((double)iterations * sizeof(frame));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        sink += crc8_dvb_s2_update(i, frame, sizeof(frame));
+    }
+    const double nsCrc8 = nanosecondsSince(&start) / ((double)iterations * sizeof(frame));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        sink += crc16_ccitt_update(i, frame, sizeof(frame));
+    }
+    const double nsCrc16 = nanosecondsSince(&start) / ((double)iterations * sizeof(frame));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        sink += crc8_xor_update(i, frame, sizeof(frame));
+    }
+    const double nsXor = nanosecondsSince(&start) / ((double)iterations * sizeof(frame));
+
+    printf("[ BENCH    ] per byte: crc8 bitwise %5.2f ns, crc8 table %5.2f ns, crc16 table %5.2f ns, xor %5.2f ns\n",
+        nsBitwise, nsCrc8, nsCrc16, nsXor);
+    EXPECT_LT(nsCrc8, nsBitwise);
+}
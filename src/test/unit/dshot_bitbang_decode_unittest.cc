@@ -0,0 +1,224 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <time.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "drivers/dshot.h"
+    #include "drivers/dshot_bitbang_decode.h"
+
+    bool useDshotEdt = false;
+}
+
+#include "unittest_macros.h"
+#include "unittest_benchmark.h"
+#include "gtest/gtest.h"
+
+#define SAMPLE_COUNT 140
+
+static const uint8_t gcrEncode[16] = {
+    0x19, 0x1b, 0x12, 0x13, 0x1d, 0x15, 0x16, 0x17,
+    0x1a, 0x09, 0x0a, 0x0b, 0x1e, 0x0d, 0x0e, 0x0f
+};
+
+// Returns the 21 bit telemetry frame for an eeem mmmm mmmm period, each set bit is a level change
+static uint32_t telemetryFrame(uint16_t period)
+{
+    uint32_t data = period << 4;
+    data |= 0xf ^ (((data >> 12) ^ (data >> 8) ^ (data >> 4)) & 0xf);
+
+    uint32_t frame = 1 << 20;
+    for (int nibble = 0; nibble < 4; nibble++) {
+        frame |= gcrEncode[(data >> (nibble * 4)) & 0xf] << (nibble * 5);
+    }
+    return frame;
+}
+
+static uint32_t expectedErpm(uint16_t period)
+{
+    const uint32_t value = (period & 0x1ff) << (period >> 9);
+    return (1000000 * 60 / 100 + value / 2) / value;
+}
+
+// Writes the frame to the pin starting at sample offset, the line idles high before and after it
+static void writeFrame(uint16_t buffer[], int pin, int offset, uint32_t frame, int samplesPerBit)
+{
+    const uint16_t mask = 1 << pin;
+    bool level = true;
+    int index = 0;
+
+    for (; index < offset; index++) {
+        buffer[index] |= mask;
+    }
+    for (int bit = 20; bit >= 0; bit--) {
+        if (frame & (1 << bit)) {
+            level = !level;
+        }
+        for (int i = 0; i < samplesPerBit && index < SAMPLE_COUNT; i++, index++) {
+            if (level) {
+                buffer[index] |= mask;
+            }
+        }
+    }
+    for (; index < SAMPLE_COUNT; index++) {
+        buffer[index] |= mask;
+    }
+}
+
+static void expectPortMatchesPinDecoder(uint16_t buffer[], uint32_t count, uint16_t pinMask)
+{
+    uint32_t values[BB_PORT_PIN_COUNT];
+    decode_bb_port(buffer, count, pinMask, values);
+
+    for (int pin = 0; pin < BB_PORT_PIN_COUNT; pin++) {
+        if (pinMask & (1 << pin)) {
+            EXPECT_EQ(decode_bb(buffer, count, pin), values[pin]) << "pin " << pin;
+        } else {
+            EXPECT_EQ(BB_NOEDGE, values[pin]);
+        }
+    }
+}
+
+TEST(DshotBitbangDecodeTest, DecodesTelemetryFrame)
+{
+    uint16_t buffer[SAMPLE_COUNT];
+    const uint16_t period = (2 << 9) | 300;
+
+    memset(buffer, 0, sizeof(buffer));
+    writeFrame(buffer, 5, 30, telemetryFrame(period), 3);
+
+    EXPECT_EQ(expectedErpm(period), decode_bb(buffer, SAMPLE_COUNT, 5));
+
+    uint32_t values[BB_PORT_PIN_COUNT];
+    decode_bb_port(buffer, SAMPLE_COUNT, 1 << 5, values);
+    EXPECT_EQ(expectedErpm(period), values[5]);
+}
+
+TEST(DshotBitbangDecodeTest, DecodesExtendedTelemetryFrame)
+{
+    uint16_t buffer[SAMPLE_COUNT];
+    const uint16_t frame = (DSHOT_EDT_TEMPERATURE << 8) | 45;
+
+    memset(buffer, 0, sizeof(buffer));
+    writeFrame(buffer, 2, 30, telemetryFrame(frame), 3);
+
+    // without extended telemetry enabled the frame is taken as a (non normalised) eRPM frame
+    useDshotEdt = false;
+    EXPECT_EQ(expectedErpm(frame), decode_bb(buffer, SAMPLE_COUNT, 2));
+
+    useDshotEdt = true;
+    EXPECT_EQ(DSHOT_TELEMETRY_EXTENDED_FRAME | frame, decode_bb(buffer, SAMPLE_COUNT, 2));
+
+    uint32_t values[BB_PORT_PIN_COUNT];
+    decode_bb_port(buffer, SAMPLE_COUNT, 1 << 2, values);
+    EXPECT_EQ(DSHOT_TELEMETRY_EXTENDED_FRAME | frame, values[2]);
+
+    // eRPM frames have the mantissa MSB set
+    const uint16_t erpmFrame = (2 << 9) | 300;
+    memset(buffer, 0, sizeof(buffer));
+    writeFrame(buffer, 2, 30, telemetryFrame(erpmFrame), 3);
+    EXPECT_EQ(expectedErpm(erpmFrame), decode_bb(buffer, SAMPLE_COUNT, 2));
+    useDshotEdt = false;
+}
+
+TEST(DshotBitbangDecodeTest, NoFrame)
+{
+    uint16_t buffer[SAMPLE_COUNT];
+
+    memset(buffer, 0xff, sizeof(buffer));
+
+    uint32_t values[BB_PORT_PIN_COUNT];
+    decode_bb_port(buffer, SAMPLE_COUNT, 0x000f, values);
+    for (int pin = 0; pin < 4; pin++) {
+        EXPECT_EQ(BB_NOEDGE, values[pin]);
+    }
+}
+
+TEST(DshotBitbangDecodeTest, PortMatchesPinDecoder)
+{
+    uint16_t buffer[SAMPLE_COUNT];
+    const uint16_t pinMask = (1 << 0) | (1 << 3) | (1 << 7) | (1 << 12);
+
+    srand(1);
+    for (int iteration = 0; iteration < 2000; iteration++) {
+        memset(buffer, 0, sizeof(buffer));
+        for (int pin = 0; pin < BB_PORT_PIN_COUNT; pin++) {
+            if (pinMask & (1 << pin)) {
+                const uint16_t period = rand() & 0xfff;
+                writeFrame(buffer, pin, 20 + rand() % 40, telemetryFrame(period), 2 + rand() % 3);
+            }
+        }
+        expectPortMatchesPinDecoder(buffer, SAMPLE_COUNT, pinMask);
+        expectPortMatchesPinDecoder(buffer, SAMPLE_COUNT - rand() % 40, pinMask);
+    }
+
+    // noise exercises the edge cases of the leading zero search and frame end
+    for (int iteration = 0; iteration < 2000; iteration++) {
+        const int runLength = 1 + rand() % 8;
+        for (int i = 0; i < SAMPLE_COUNT; i++) {
+            buffer[i] = (i % runLength) ? buffer[i - 1] : rand();
+        }
+        expectPortMatchesPinDecoder(buffer, SAMPLE_COUNT, 0xffff);
+    }
+}
+
+TEST(DshotBitbangDecodeTest, BenchmarkPortDecoder)
+{
+    uint16_t buffer[SAMPLE_COUNT];
+    const int pins[] = { 0, 1, 2, 3 };
+    const int iterations = 100000;
+
+    memset(buffer, 0, sizeof(buffer));
+    for (unsigned i = 0; i < ARRAYLEN(pins); i++) {
+        writeFrame(buffer, pins[i], 30 + i * 3, telemetryFrame((1 << 9) | (100 + i * 50)), 3);
+    }
+
+    volatile uint32_t sink = 0;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        for (unsigned i = 0; i < ARRAYLEN(pins); i++) {
+            sink += decode_bb(buffer, SAMPLE_COUNT, pins[i]);
+        }
+    }
+    const double nsPerPin = nanosecondsSince(&start) / iterations;
+
+    uint32_t values[BB_PORT_PIN_COUNT];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        decode_bb_port(buffer, SAMPLE_COUNT, 0x000f, values);
+        sink += values[0];
+    }
+    const double nsPort = nanosecondsSince(&start) / iterations;
+
+    printf("[ BENCH    ] 4 motors: %.1f ns per pin decode, %.1f ns port decode\n", nsPerPin, nsPort);
+    UNUSED(sink);
+}
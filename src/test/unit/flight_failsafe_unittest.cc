@@ -194,6 +194,7 @@ TEST(FlightFailsafeTest, TestFailsafeDetectsRxLossAndStartsLanding)
 
     // given
     sysTickUptime++;                                // adjust time to point just past the failure time to
+    EXPECT_EQ(sysTickUptime, failsafeRxLinkDownAtMs());
     failsafeOnValidDataFailed();                    // cause a lost link
 
     // when
@@ -59,6 +59,7 @@ extern "C" {
 
     extern quaternion q;
     extern float rMat[3][3];
+    extern uint32_t enabledSensors;
 
     PG_REGISTER(rcControlsConfig_t, rcControlsConfig, PG_RC_CONTROLS_CONFIG, 0);
     PG_REGISTER(barometerConfig_t, barometerConfig, PG_BAROMETER_CONFIG, 0);
@@ -196,6 +197,50 @@ TEST(FlightImuTest, TestSmallAngle)
     EXPECT_EQ(0, STATE(SMALL_ANGLE));
 }
 
+TEST(FlightImuTest, TestFastPropagation)
+{
+    // given
+    imuConfigMutable()->fast_propagation = true;
+    imuConfigure(800, 0);
+    enabledSensors = SENSOR_ACC;
+    acc.isAccelUpdatedAtLeastOnce = true;
+
+    // and
+    q.w = 1.0f;
+    q.x = 0.0f;
+    q.y = 0.0f;
+    q.z = 0.0f;
+    gyro.gyroADCf[X] = 0.0f;
+    gyro.gyroADCf[Y] = 0.0f;
+    gyro.gyroADCf[Z] = 90.0f;
+
+    // when, one second of 1kHz PID loops
+    for (int i = 0; i < 1000; i++) {
+        imuPropagateAttitude();
+    }
+
+    // expect 90 degrees around Z axis
+    EXPECT_NEAR(sqrt2over2, q.w, 1e-3);
+    EXPECT_NEAR(0.0f, q.x, 1e-3);
+    EXPECT_NEAR(0.0f, q.y, 1e-3);
+    EXPECT_NEAR(sqrt2over2, q.z, 1e-3);
+    EXPECT_NEAR(1.0f, rMat[1][0], 1e-3);
+
+    // given
+    imuConfigMutable()->fast_propagation = false;
+    imuConfigure(800, 0);
+    const float w = q.w;
+
+    // when
+    imuPropagateAttitude();
+
+    // expect the attitude to be left to the attitude task
+    EXPECT_FLOAT_EQ(w, q.w);
+
+    enabledSensors = 0;
+    gyro.gyroADCf[Z] = 0.0f;
+}
+
 // STUBS
 
 extern "C" {
@@ -209,6 +254,7 @@ mag_t mag;
 
 gpsSolutionData_t gpsSol;
 int16_t GPS_verticalSpeedInCmS;
+uint8_t GPS_update;
 
 uint8_t debugMode;
 int16_t debug[DEBUG16_VALUE_COUNT];
@@ -229,10 +275,11 @@ uint16_t disableFlightMode(flightModeFlags_e mask)
     return flightModeFlags &= ~(mask);
 }
 
+uint32_t enabledSensors;
+
 bool sensors(uint32_t mask)
 {
-    UNUSED(mask);
-    return false;
+    return enabledSensors & mask;
 };
 
 uint32_t millis(void) { return 0; }
@@ -242,8 +289,12 @@ bool compassIsHealthy(void) { return true; }
 bool isBaroCalibrationComplete(void) { return true; }
 void performBaroCalibrationCycle(void) {}
 int32_t baroCalculateAltitude(void) { return 0; }
+bool isBaroSampleReady(void) { return false; }
+void clearBaroSampleReady(void) {}
+baro_t baro;
 bool gyroGetAccumulationAverage(float *) { return false; }
 bool accGetAccumulationAverage(float *) { return false; }
 void mixerSetThrottleAngleCorrection(int) {};
+float pidGetDT(void) { return 0.001f; }
 bool gpsRescueIsRunning(void) { return false; }
 }
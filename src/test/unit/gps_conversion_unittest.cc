@@ -18,11 +18,13 @@
 #include <stdint.h>
 
 #include <limits.h>
+#include <math.h>
 
 //#ifdef DEBUG_GPS_CONVERSION
 
 extern "C" {
     #include "common/gps_conversion.h"
+    #include "common/maths.h"
 }
 
 #include "unittest_macros.h"
@@ -72,3 +74,147 @@ TEST(GpsConversionTest, GPSCoordToDegrees_NMEA_Values)
         EXPECT_EQ(result, expectation->degrees);
     }
 }
+
+static void nmeaFieldFromString(nmeaField_t *field, const char *s)
+{
+    nmeaFieldReset(field);
+    while (*s) {
+        nmeaFieldAddChar(field, *s++);
+    }
+}
+
+TEST(GpsConversionTest, NmeaFieldToDegreesMatchesCoordToDegrees)
+{
+    const char *coords[] = {
+        "0.0", "000.0", "00000.0000", "0.0001", "25599.9999", "25599.99999",
+        "5128.3727", "5321.6802", "00630.3372", "4807.038", "01131.000",
+    };
+
+    nmeaField_t field;
+    for (unsigned index = 0; index < sizeof(coords) / sizeof(coords[0]); index++) {
+        nmeaFieldFromString(&field, coords[index]);
+        EXPECT_EQ(GPS_coord_to_degrees(coords[index]), nmeaFieldToDegrees(&field)) << coords[index];
+    }
+}
+
+TEST(GpsConversionTest, NmeaFieldToFixed)
+{
+    nmeaField_t field;
+
+    nmeaFieldFromString(&field, "08");
+    EXPECT_EQ(8, nmeaFieldToFixed(&field, 0));
+
+    // further decimals are truncated
+    nmeaFieldFromString(&field, "545.47");
+    EXPECT_EQ(5454, nmeaFieldToFixed(&field, 1));
+
+    // missing decimals are padded
+    nmeaFieldFromString(&field, "123519.5");
+    EXPECT_EQ(12351950, nmeaFieldToFixed(&field, 2));
+
+    nmeaFieldFromString(&field, "-12.3");
+    EXPECT_EQ(-123, nmeaFieldToFixed(&field, 1));
+    EXPECT_EQ('-', field.first);
+
+    nmeaFieldFromString(&field, "");
+    EXPECT_EQ(0, nmeaFieldToFixed(&field, 1));
+    EXPECT_EQ(0, field.length);
+
+    nmeaFieldFromString(&field, "1234567890");
+    EXPECT_EQ(0, nmeaFieldToFixed(&field, 0));
+}
+
+TEST(GpsConversionTest, NmeaFieldSentenceId)
+{
+    nmeaField_t field;
+
+    nmeaFieldFromString(&field, "GNRMC");
+    EXPECT_EQ(5, field.length);
+    EXPECT_EQ('G', field.first);
+    EXPECT_EQ(NMEA_ID('N', 'R', 'M', 'C'), field.text);
+
+    nmeaFieldFromString(&field, "S");
+    EXPECT_EQ('S', field.first);
+}
+
+// Reference great circle distance (haversine) and initial bearing in double precision
+static void referenceDistanceBearing(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2, double *distCm, double *bearingDeg)
+{
+    const double earthRadiusCm = 637813700.0;   // WGS84 equatorial radius, 1.113195cm per 1e-7 degree
+    const double toRad = M_PI / 180.0 / 1e7;
+    const double phi1 = lat1 * toRad;
+    const double phi2 = lat2 * toRad;
+    const double dPhi = (lat2 - lat1) * toRad;
+    const double dLambda = ((double)lon2 - lon1) * toRad;
+
+    const double a = sin(dPhi / 2) * sin(dPhi / 2) + cos(phi1) * cos(phi2) * sin(dLambda / 2) * sin(dLambda / 2);
+    *distCm = 2 * earthRadiusCm * atan2(sqrt(a), sqrt(1 - a));
+    double bearing = atan2(sin(dLambda) * cos(phi2), cos(phi1) * sin(phi2) - sin(phi1) * cos(phi2) * cos(dLambda)) * 180.0 / M_PI;
+    *bearingDeg = bearing < 0 ? bearing + 360 : bearing;
+}
+
+typedef struct gpsLocalExpectation_s {
+    int32_t lat1, lon1;
+    int32_t lat2, lon2;
+} gpsLocalExpectation_t;
+
+TEST(GpsConversionTest, LocalOffsetAccuracy)
+{
+    const gpsLocalExpectation_t expectations[] = {
+        { 0, 0, 10000, 10000 },                                     // equator, ~16m
+        { 473977420, 85455940, 474000000, 85500000 },                // Zurich, ~400m
+        { 473977420, 85455940, 473977430, 85455940 },                // 1.1cm north
+        { -337000000, 1511000000, -337050000, 1511100000 },          // Sydney, far from the prime meridian
+        { 645000000, -1479000000, 645100000, -1478800000 },          // Alaska, high latitude
+        { 100000000, 1799990000, 100010000, -1799990000 },           // across the antimeridian
+        { 513000000, 0, 512900000, -50000 },                         // south west
+    };
+
+    for (unsigned index = 0; index < sizeof(expectations) / sizeof(expectations[0]); index++) {
+        const gpsLocalExpectation_t *e = &expectations[index];
+        // scaled with the latitude of the origin, as the rescue does with the home point
+        const float lonScale = gpsLongitudeScale(e->lat1);
+
+        gpsLocalOffset_t offset;
+        gpsLocalOffset(e->lat1, e->lon1, e->lat2, e->lon2, lonScale, &offset);
+
+        double distCm, bearingDeg;
+        referenceDistanceBearing(e->lat1, e->lon1, e->lat2, e->lon2, &distCm, &bearingDeg);
+
+        // within 0.5% or 2cm over a few km
+        EXPECT_NEAR(distCm, gpsLocalDistanceCm(&offset), fmax(2.0, distCm * 0.005)) << index;
+        if (distCm > 100) {
+            double bearingError = fabs(bearingDeg - gpsLocalBearing(&offset) / 100.0);
+            if (bearingError > 180) {
+                bearingError = 360 - bearingError;
+            }
+            EXPECT_LT(bearingError, 0.5) << index;
+        }
+    }
+}
+
+TEST(GpsConversionTest, LocalBearing)
+{
+    gpsLocalOffset_t offset;
+
+    offset = { 100, 0 };
+    EXPECT_EQ(0, gpsLocalBearing(&offset));
+    offset = { 0, 100 };
+    EXPECT_EQ(9000, gpsLocalBearing(&offset));
+    offset = { -100, 0 };
+    EXPECT_EQ(18000, gpsLocalBearing(&offset));
+    offset = { 0, -100 };
+    EXPECT_EQ(27000, gpsLocalBearing(&offset));
+    offset = { 100, -100 };
+    EXPECT_EQ(31500, gpsLocalBearing(&offset));
+}
+
+TEST(GpsConversionTest, DegreesToE7)
+{
+    EXPECT_EQ(473977420, gpsDegreesToE7("47.397742"));
+    EXPECT_EQ(-1234567891, gpsDegreesToE7("-123.4567891"));
+    EXPECT_EQ(1234567891, gpsDegreesToE7("123.45678912"));    // 10^-7 degree resolution
+    EXPECT_EQ(80000000, gpsDegreesToE7(" 8"));
+    EXPECT_EQ(0, gpsDegreesToE7(""));
+    EXPECT_EQ(0, gpsDegreesToE7("181.0"));
+}
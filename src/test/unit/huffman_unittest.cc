@@ -16,12 +16,16 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 extern "C" {
     #include "common/huffman.h"
 }
 
 #include "unittest_macros.h"
+#include "unittest_benchmark.h"
 #include "gtest/gtest.h"
 
 #define OUTBUF_LEN 128
@@ -546,6 +550,239 @@ TEST(HuffmanUnittest, TestHuffmanDecode)
     EXPECT_EQ(0x07, (int)outBuf[7]);
 }
 
+TEST(HuffmanUnittest, TestHuffmanMaxCodeLen)
+{
+    // HUFFMAN_MAX_CODE_LEN sizes the output buffers of the encoder users
+    int maxCodeLen = 0;
+    for (int ii = 0; ii < HUFFMAN_TABLE_SIZE; ++ii) {
+        if (huffmanTable[ii].codeLen > maxCodeLen) {
+            maxCodeLen = huffmanTable[ii].codeLen;
+        }
+    }
+    EXPECT_EQ(HUFFMAN_MAX_CODE_LEN, maxCodeLen);
+}
+
+static int writeSignedVB(uint8_t *buf, int32_t value)
+{
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    int len = 0;
+    while (zigzag > 127) {
+        buf[len++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    buf[len++] = zigzag;
+    return len;
+}
+
+TEST(HuffmanUnittest, TestHuffmanBlackboxFrames)
+{
+    // the body of blackbox P-frames, the variable byte encoded deltas of 26 fields, mostly small
+    static const int frameCount = 200;
+    uint8_t frame[26 * 5];
+    uint8_t compressed[(sizeof(frame) * HUFFMAN_MAX_CODE_LEN + 7) / 8];
+    uint8_t decompressed[sizeof(frame)];
+    int totalLength = 0;
+    int totalCompressedLength = 0;
+
+    uint32_t seed = 1;
+    for (int n = 0; n < frameCount; n++) {
+        int frameLength = 0;
+        for (int i = 0; i < 26; i++) {
+            seed = seed * 1103515245 + 12345;
+            // PID and RC deltas are within a few counts, gyro and motor predictions are off by more
+            const int range = i < 18 ? 4 : 80;
+            frameLength += writeSignedVB(frame + frameLength, (int32_t)((seed >> 16) % (2 * range)) - range);
+        }
+
+        const int compressedLength = huffmanEncodeBuf(compressed, sizeof(compressed), frame, frameLength, huffmanTable);
+        ASSERT_GT(compressedLength, 0);
+        EXPECT_EQ(frameLength, huffmanDecodeBuf(decompressed, sizeof(decompressed), compressed, compressedLength, frameLength, huffmanTree));
+        for (int i = 0; i < frameLength; i++) {
+            EXPECT_EQ(frame[i], decompressed[i]);
+        }
+
+        totalLength += frameLength;
+        totalCompressedLength += compressedLength;
+    }
+
+    printf("[ BENCH    ] blackbox frames %.1f bytes, compressed %.1f bytes\n",
+        (double)totalLength / frameCount, (double)totalCompressedLength / frameCount);
+    EXPECT_LT(totalCompressedLength, totalLength);
+}
+
+static huffmanDecodeTable_t decodeTable;
+
+TEST(HuffmanUnittest, TestHuffmanDecodeTable)
+{
+    huffmanInitDecodeTable(&decodeTable, huffmanTable);
+
+    // every code decodes back to its symbol from any HUFFMAN_MAX_CODE_LEN bits that start with it
+    for (int ii = 0; ii < HUFFMAN_TABLE_SIZE; ++ii) {
+        const int index = huffmanTable[ii].code >> (16 - HUFFMAN_MAX_CODE_LEN);
+        const int last = index + (1 << (HUFFMAN_MAX_CODE_LEN - huffmanTable[ii].codeLen)) - 1;
+        EXPECT_EQ(ii, decodeTable.entry[index].symbol);
+        EXPECT_EQ(huffmanTable[ii].codeLen, decodeTable.entry[index].codeLen);
+        EXPECT_EQ(ii, decodeTable.entry[last].symbol);
+    }
+
+    const uint8_t inBuf[HUFF_BUF_LEN3] = {0xec, 0xc6, 0x0e, 0xb8, 0xd8};
+    int len = huffmanDecodeBuf(outBuf, OUTBUF_LEN, inBuf, HUFF_BUF_LEN3, HUFF_BUF_COUNT3, &decodeTable);
+    EXPECT_EQ(8, len);
+    for (int ii = 0; ii < 8; ++ii) {
+        EXPECT_EQ(ii, (int)outBuf[ii]);
+    }
+
+    // the count does not fit in the output
+    EXPECT_EQ(-1, huffmanDecodeBuf(outBuf, 4, inBuf, HUFF_BUF_LEN3, HUFF_BUF_COUNT3, &decodeTable));
+
+    // stops at the EOF code, 11 000000000000 101
+    const uint8_t inBufEof[1] = {0xc0};
+    const uint8_t inBufEofEnd[2] = {0x02, 0x80};
+    huffmanDecodeState_t state = {
+        .inByte = inBufEof,
+        .inLen = sizeof(inBufEof),
+        .bits = 0,
+        .bitCount = 0,
+        .eof = false,
+    };
+    len = huffmanDecodeBufStreaming(&state, outBuf, OUTBUF_LEN, &decodeTable);
+    EXPECT_EQ(1, len);
+    EXPECT_FALSE(state.eof);
+    state.inByte = inBufEofEnd;
+    state.inLen = sizeof(inBufEofEnd);
+    len = huffmanDecodeBufStreaming(&state, outBuf, OUTBUF_LEN, &decodeTable);
+    EXPECT_EQ(0, len);
+    EXPECT_TRUE(state.eof);
+}
+
+static void fillTestData(uint8_t *buf, int len)
+{
+    // mostly small values, like the blackbox and flash data that is compressed
+    uint32_t seed = 7;
+    for (int ii = 0; ii < len; ++ii) {
+        seed = seed * 1103515245 + 12345;
+        const uint32_t r = seed >> 16;
+        buf[ii] = (r & 0x300) ? (r & 0x07) : (r & 0xff);
+    }
+}
+
+TEST(HuffmanUnittest, TestHuffmanRoundTripStreaming)
+{
+    huffmanInitDecodeTable(&decodeTable, huffmanTable);
+
+    static uint8_t data[4096];
+    static uint8_t compressed[(sizeof(data) * HUFFMAN_MAX_CODE_LEN + 7) / 8];
+    static uint8_t decompressed[sizeof(data)];
+    fillTestData(data, sizeof(data));
+
+    // encode in uneven chunks, as the MSP flash read does
+    huffmanState_t encodeState = {
+        .bytesWritten = 0,
+        .outByte = compressed,
+        .outBufLen = sizeof(compressed),
+        .outBit = 0x80,
+    };
+    *encodeState.outByte = 0;
+    for (int pos = 0, chunk = 1; pos < (int)sizeof(data); pos += chunk, chunk = chunk * 3 % 251 + 1) {
+        const int len = chunk < (int)sizeof(data) - pos ? chunk : (int)sizeof(data) - pos;
+        EXPECT_EQ(0, huffmanEncodeBufStreaming(&encodeState, data + pos, len, huffmanTable));
+    }
+    const int compressedLength = encodeState.bytesWritten + (encodeState.outBit != 0x80 ? 1 : 0);
+    EXPECT_EQ(compressedLength, huffmanEncodeBuf(compressed, sizeof(compressed), data, sizeof(data), huffmanTable));
+
+    // the tree decoder agrees with the table decoder
+    EXPECT_EQ((int)sizeof(data), huffmanDecodeBuf(decompressed, sizeof(decompressed), compressed, compressedLength, sizeof(data), huffmanTree));
+    EXPECT_EQ(0, memcmp(data, decompressed, sizeof(data)));
+
+    // decode a few input bytes at a time into a small output buffer
+    memset(decompressed, 0, sizeof(decompressed));
+    huffmanDecodeState_t decodeState = {
+        .inByte = compressed,
+        .inLen = 0,
+        .bits = 0,
+        .bitCount = 0,
+        .eof = false,
+    };
+    int inPos = 0;
+    int outCount = 0;
+    while (outCount < (int)sizeof(data) && !decodeState.eof) {
+        if (decodeState.inLen == 0 && inPos < compressedLength) {
+            const int len = 5 < compressedLength - inPos ? 5 : compressedLength - inPos;
+            decodeState.inByte = compressed + inPos;
+            decodeState.inLen = len;
+            inPos += len;
+        }
+        const int outLen = 7 < (int)sizeof(data) - outCount ? 7 : (int)sizeof(data) - outCount;
+        outCount += huffmanDecodeBufStreaming(&decodeState, decompressed + outCount, outLen, &decodeTable);
+    }
+    EXPECT_EQ(0, memcmp(data, decompressed, sizeof(data)));
+}
+
+TEST(HuffmanUnittest, TestHuffmanEncodeOverflow)
+{
+    static uint8_t data[64];
+    fillTestData(data, sizeof(data));
+    const int compressedLength = huffmanEncodeBuf(outBuf, OUTBUF_LEN, data, sizeof(data), huffmanTable);
+    ASSERT_GT(compressedLength, 2);
+    EXPECT_EQ(-1, huffmanEncodeBuf(outBuf, compressedLength - 1, data, sizeof(data), huffmanTable));
+
+    // an overflow leaves the state and the partly written byte as they were
+    uint8_t buf[4] = { 0 };
+    huffmanState_t state = {
+        .bytesWritten = 0,
+        .outByte = buf,
+        .outBufLen = sizeof(buf),
+        .outBit = 0x80,
+    };
+    const uint8_t inBuf[1] = {1}; // 101
+    EXPECT_EQ(0, huffmanEncodeBufStreaming(&state, inBuf, sizeof(inBuf), huffmanTable));
+    EXPECT_EQ(0x10, state.outBit);
+    EXPECT_EQ(0xa0, (int)buf[0]);
+    EXPECT_EQ(-1, huffmanEncodeBufStreaming(&state, data, sizeof(data), huffmanTable));
+    EXPECT_EQ(0, state.bytesWritten);
+    EXPECT_EQ(buf, state.outByte);
+    EXPECT_EQ(0x10, state.outBit);
+    EXPECT_EQ(0xa0, (int)buf[0]);
+}
+
+TEST(HuffmanUnittest, TestHuffmanThroughput)
+{
+    huffmanInitDecodeTable(&decodeTable, huffmanTable);
+
+    static uint8_t data[4096];
+    static uint8_t compressed[(sizeof(data) * HUFFMAN_MAX_CODE_LEN + 7) / 8];
+    static uint8_t decompressed[sizeof(data)];
+    fillTestData(data, sizeof(data));
+    const int iterations = 200;
+    const double megabytes = (double)iterations * sizeof(data) / 1e6;
+    volatile int sink = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int compressedLength = 0;
+    for (int i = 0; i < iterations; i++) {
+        compressedLength = huffmanEncodeBuf(compressed, sizeof(compressed), data, sizeof(data), huffmanTable);
+        sink += compressedLength;
+    }
+    const double encodeMBs = megabytes / (nanosecondsSince(&start) / 1e9);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        sink += huffmanDecodeBuf(decompressed, sizeof(decompressed), compressed, compressedLength, sizeof(data), huffmanTree);
+    }
+    const double treeMBs = megabytes / (nanosecondsSince(&start) / 1e9);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        sink += huffmanDecodeBuf(decompressed, sizeof(decompressed), compressed, compressedLength, sizeof(data), &decodeTable);
+    }
+    const double tableMBs = megabytes / (nanosecondsSince(&start) / 1e9);
+
+    printf("[ BENCH    ] encode %.1f MB/s, decode tree %.1f MB/s, decode table %.1f MB/s\n", encodeMBs, treeMBs, tableMBs);
+    EXPECT_EQ(0, memcmp(data, decompressed, sizeof(data)));
+    EXPECT_GT(tableMBs, treeMBs);
+}
+
 // STUBS
 
 extern "C" {
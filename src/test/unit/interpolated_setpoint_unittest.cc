@@ -0,0 +1,113 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "fc/rc.h"
+
+    #include "flight/interpolated_setpoint.h"
+    #include "flight/pid.h"
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+
+    uint16_t currentRxRefreshRate;
+    timeUs_t currentRxFrameTimeUs;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define PID_DT 0.000125f    // 8kHz
+
+static float rawSetpoint[XYZ_AXIS_COUNT];
+
+extern "C" {
+    float getRawSetpoint(int axis) { return rawSetpoint[axis]; }
+    float applyCurve(int, float deflection) { return 670.0f * deflection; }
+    float pidGetDT() { return PID_DT; }
+    float pidGetFfBoostFactor() { return 0.0f; }
+    float pidGetSpikeLimitInverse() { return 0.0f; }
+}
+
+static float applyFrame(int axis, timeUs_t frameTimeUs, float setpoint, ffInterpolationType_t type)
+{
+    rawSetpoint[axis] = setpoint;
+    currentRxFrameTimeUs = frameTimeUs;
+    return interpolatedSpApply(axis, true, type);
+}
+
+TEST(InterpolatedSetpointTest, FitIgnoresFrameTimingJitter)
+{
+    currentRxRefreshRate = 4000;
+
+    // a 500deg/s/s stick ramp received with up to 1ms of jitter on a 4ms link
+    const int jitterUs[] = { 0, 900, -700, 300, -1000, 600, 0, -400 };
+    float delta = 0;
+    for (int i = 0; i < 8; i++) {
+        const timeUs_t frameTimeUs = 100000 + i * 4000 + jitterUs[i];
+        delta = applyFrame(FD_ROLL, frameTimeUs, 0.5f * frameTimeUs * 1e-3f, FF_INTERPOLATE_FIT);
+        if (i >= 3) {
+            EXPECT_NEAR(500.0f * PID_DT, delta, 0.001f);
+        }
+    }
+
+    // differencing against the nominal frame interval follows the jitter
+    applyFrame(FD_PITCH, 100000, 50.0f, FF_INTERPOLATE_ON);
+    applyFrame(FD_PITCH, 104000, 52.0f, FF_INTERPOLATE_ON);
+    delta = applyFrame(FD_PITCH, 107100, 53.55f, FF_INTERPOLATE_ON);
+    EXPECT_GT(fabsf(500.0f * PID_DT - delta), 0.01f);
+}
+
+TEST(InterpolatedSetpointTest, FitFollowsAcceleratingSticks)
+{
+    currentRxRefreshRate = 2000;
+
+    // setpoint = 0.01 * t^2 (t in ms), its speed at the newest frame is 0.02 * t deg/ms
+    float delta = 0;
+    timeUs_t frameTimeUs = 0;
+    for (int i = 0; i < 6; i++) {
+        frameTimeUs = 2000 * i + (i % 2 ? 250 : 0);
+        const float t = frameTimeUs * 1e-3f;
+        delta = applyFrame(FD_YAW, frameTimeUs, 0.01f * t * t, FF_INTERPOLATE_FIT);
+    }
+    EXPECT_NEAR(0.02f * frameTimeUs * PID_DT, delta, 0.001f);
+}
+
+TEST(InterpolatedSetpointTest, FitStartsOverAfterALinkGap)
+{
+    currentRxRefreshRate = 4000;
+
+    for (int i = 0; i < 4; i++) {
+        applyFrame(FD_ROLL, 1000000 + i * 4000, 100.0f, FF_INTERPOLATE_FIT);
+    }
+
+    // after a gap the fit needs new frames, until then the last two frames are differenced
+    EXPECT_NEAR(100.0f * 250 * PID_DT, applyFrame(FD_ROLL, 2000000, 200.0f, FF_INTERPOLATE_FIT), 0.001f);
+    EXPECT_NEAR(0.0f, applyFrame(FD_ROLL, 2004000, 200.0f, FF_INTERPOLATE_FIT), 0.001f);
+}
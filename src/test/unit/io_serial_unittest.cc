@@ -61,6 +61,8 @@ extern "C" {
     uint32_t serialRxBytesWaiting(const serialPort_t *) { return 0; }
     uint8_t serialRead(serialPort_t *) { return 0; }
     void serialWrite(serialPort_t *, uint8_t) {}
+    uint32_t serialReadBuf(serialPort_t *, uint8_t *, uint32_t) { return 0; }
+    void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
 
     serialPort_t *usbVcpOpen(void) { return NULL; }
 
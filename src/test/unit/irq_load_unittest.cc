@@ -0,0 +1,91 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/irq_load.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint32_t cycleCounter;
+
+TEST(IrqLoadTest, NestedInterruptsAreChargedOnlyTheirOwnCycles)
+{
+    cycleCounter = 0;
+    irqLoadUpdate();
+    const uint32_t totalBefore = irqLoadGetTotalCycles();
+
+    irqLoadEnter(IRQ_LOAD_UART);
+    cycleCounter += 100;
+    irqLoadEnter(IRQ_LOAD_EXTI);           // preempted by the gyro exti
+    cycleCounter += 40;
+    irqLoadEnter(IRQ_LOAD_DMA);            // which is preempted by a dma
+    cycleCounter += 10;
+    irqLoadExit(IRQ_LOAD_DMA);
+    cycleCounter += 20;
+    irqLoadExit(IRQ_LOAD_EXTI);
+    cycleCounter += 30;
+    irqLoadExit(IRQ_LOAD_UART);
+
+    EXPECT_EQ(200u, irqLoadGetTotalCycles() - totalBefore);
+
+    cycleCounter = 1000;
+    irqLoadUpdate();
+
+    EXPECT_EQ(130, irqLoadGetPermille(IRQ_LOAD_UART));
+    EXPECT_EQ(60, irqLoadGetPermille(IRQ_LOAD_EXTI));
+    EXPECT_EQ(10, irqLoadGetPermille(IRQ_LOAD_DMA));
+}
+
+TEST(IrqLoadTest, LoadCoversTheTimeSinceTheLastUpdate)
+{
+    cycleCounter = 10000;
+    irqLoadUpdate();
+
+    irqLoadEnter(IRQ_LOAD_UART);
+    cycleCounter += 130;
+    irqLoadExit(IRQ_LOAD_UART);
+    irqLoadEnter(IRQ_LOAD_DSHOT_BITBANG);
+    cycleCounter += 100;
+    irqLoadExit(IRQ_LOAD_DSHOT_BITBANG);
+    cycleCounter = 11000;
+    irqLoadUpdate();
+
+    EXPECT_EQ(130, irqLoadGetPermille(IRQ_LOAD_UART));
+    EXPECT_EQ(100, irqLoadGetPermille(IRQ_LOAD_DSHOT_BITBANG));
+    EXPECT_EQ(0, irqLoadGetPermille(IRQ_LOAD_TIMER));
+    EXPECT_EQ(0, irqLoadGetPermille(IRQ_LOAD_COUNT));
+    EXPECT_STREQ("UART", irqLoadSourceName(IRQ_LOAD_UART));
+}
+
+// STUBS
+
+extern "C" {
+    uint32_t getCycleCounter(void)
+    {
+        return cycleCounter;
+    }
+}
@@ -0,0 +1,187 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host timings of the small kernels that run every gyro or rx cycle.
+// Each kernel prints one line in the format `make bench` compares
+// against src/test/bench_baseline.txt:
+//
+//   [ BENCH    ] <name> <ns> ns/call <cycles> cycles/call
+//
+// Larger kernels (pidController, blackbox encoding, scheduler, dshot
+// decode) are timed by the benchmarks in their own unit tests, which
+// `make bench` runs as well.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER
+#endif
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/crc.h"
+    #include "common/filter.h"
+    #include "common/utils.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_benchmark.h"
+#include "gtest/gtest.h"
+
+#define BENCH_LOOP_HZ       8000
+#define BENCH_ITERATIONS    200000
+#define BENCH_REPEATS       5       // best of, to reject preemption
+#define BENCH_NOTCH_COUNT   12      // 3 harmonics of 4 motors per axis
+#define BENCH_FRAME_SIZE    26      // CRSF rc channels frame
+
+typedef struct benchKernel_s {
+    const char *name;
+    void (*init)(void);
+    float (*run)(int i);
+} benchKernel_t;
+
+static biquadFilter_t biquad;
+static biquadFilter_t notch;
+static pt1Filter_t pt1;
+static biquadNotchCoeffs_t notchCoeffs[BENCH_NOTCH_COUNT];
+static biquadNotchState_t notchState[BENCH_NOTCH_COUNT + 1];
+static uint8_t frame[BENCH_FRAME_SIZE];
+
+static float sample(int i)
+{
+    return (i & 0xff) * 0.25f - 32.0f;
+}
+
+static void biquadInit(void)
+{
+    biquadFilterInitLPF(&biquad, 100, 1000000 / BENCH_LOOP_HZ);
+}
+
+static float biquadRun(int i)
+{
+    return biquadFilterApply(&biquad, sample(i));
+}
+
+static void notchInit(void)
+{
+    biquadFilterInit(&notch, 260, 1000000 / BENCH_LOOP_HZ, filterGetNotchQ(260, 160), FILTER_NOTCH);
+}
+
+static float notchRun(int i)
+{
+    return biquadFilterApplyDF1(&notch, sample(i));
+}
+
+static void pt1Init(void)
+{
+    pt1FilterInit(&pt1, pt1FilterGain(150, 1.0f / BENCH_LOOP_HZ));
+}
+
+static float pt1Run(int i)
+{
+    return pt1FilterApply(&pt1, sample(i));
+}
+
+static void notchBankInit(void)
+{
+    for (int i = 0; i < BENCH_NOTCH_COUNT; i++) {
+        biquadNotchCoeffsUpdate(&notchCoeffs[i], 150 + 40 * i, 1000000 / BENCH_LOOP_HZ, 5.0f);
+    }
+    biquadNotchStateInit(notchState, BENCH_NOTCH_COUNT);
+}
+
+static float notchBankRun(int i)
+{
+    return biquadNotchBankApply(notchCoeffs, notchState, BENCH_NOTCH_COUNT, sample(i));
+}
+
+static void frameInit(void)
+{
+    for (unsigned i = 0; i < sizeof(frame); i++) {
+        frame[i] = i * 13 + 5;
+    }
+}
+
+static float crc8Run(int i)
+{
+    return crc8_dvb_s2_update(i, frame, sizeof(frame));
+}
+
+static float crc16Run(int i)
+{
+    return crc16_ccitt_update(i, frame, sizeof(frame));
+}
+
+// Every kernel `make bench` tracks, one call is one gyro sample or one frame
+static const benchKernel_t kernels[] = {
+    { "biquadFilterApply",          biquadInit,     biquadRun },
+    { "biquadFilterApplyDF1_notch", notchInit,      notchRun },
+    { "pt1FilterApply",             pt1Init,        pt1Run },
+    { "biquadNotchBankApply_12",    notchBankInit,  notchBankRun },
+    { "crc8_dvb_s2_update_26",      frameInit,      crc8Run },
+    { "crc16_ccitt_update_26",      frameInit,      crc16Run },
+};
+
+static uint64_t cycleCount(void)
+{
+#ifdef HAS_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+TEST(KernelBenchmark, BenchmarkKernels)
+{
+    volatile float sink = 0;
+
+    for (unsigned k = 0; k < ARRAYLEN(kernels); k++) {
+        const benchKernel_t *kernel = &kernels[k];
+        double bestNs = 0;
+        double bestCycles = 0;
+
+        for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+            kernel->init();
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            const uint64_t startCycles = cycleCount();
+            for (int i = 0; i < BENCH_ITERATIONS; i++) {
+                sink += kernel->run(i);
+            }
+            const double cycles = (double)(cycleCount() - startCycles) / BENCH_ITERATIONS;
+            const double ns = nanosecondsSince(&start) / BENCH_ITERATIONS;
+
+            if (repeat == 0 || ns < bestNs) {
+                bestNs = ns;
+                bestCycles = cycles;
+            }
+        }
+
+        printf("[ BENCH    ] %-28s %8.2f ns/call %8.1f cycles/call\n", kernel->name, bestNs, bestCycles);
+        EXPECT_GT(bestNs, 0);
+    }
+    UNUSED(sink);
+}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "fc/loop_timing.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOPTIME_US 125
+
+// Runs one second of loops, every 100th one 20us late, with the given latencies
+static timeUs_t runWindow(timeUs_t timeUs, timeDelta_t gyroToPidUs, timeDelta_t pidToMotorUs)
+{
+    for (int i = 0; i < LOOP_TIMING_WINDOW_US / LOOPTIME_US; i++) {
+        const timeUs_t loopStartUs = timeUs + (i % 100 == 99 ? 20 : 0);
+        loopTimingLoopStarted(loopStartUs, LOOPTIME_US);
+        loopTimingPidStarted(loopStartUs + 10, loopStartUs + 10 - gyroToPidUs);
+        loopTimingMotorsWritten(loopStartUs + 10 + pidToMotorUs);
+        timeUs += LOOPTIME_US;
+    }
+    return timeUs;
+}
+
+TEST(LoopTimingTest, NothingUntilTheFirstWindowCompletes)
+{
+    loopTimingReset();
+
+    runWindow(1000, 30, 40);
+
+    for (int metric = 0; metric < LOOP_TIMING_COUNT; metric++) {
+        const loopTimingStats_t *stats = loopTimingGetStats((loopTimingMetric_e)metric);
+        EXPECT_EQ(0, stats->maxUs);
+        EXPECT_EQ(0, stats->p99Us);
+    }
+}
+
+TEST(LoopTimingTest, PublishesEachWindow)
+{
+    loopTimingReset();
+
+    timeUs_t timeUs = runWindow(1000, 30, 40);
+    timeUs = runWindow(timeUs, 30, 40);
+    loopTimingLoopStarted(timeUs, LOOPTIME_US);
+
+    // a late loop is 20us long and the one after it 20us short
+    const loopTimingStats_t *jitter = loopTimingGetStats(LOOP_TIMING_JITTER);
+    EXPECT_EQ(0, jitter->minUs);
+    EXPECT_EQ(0, jitter->avgUs);
+    EXPECT_EQ(20, jitter->maxUs);
+    EXPECT_EQ(20, jitter->p99Us);
+
+    const loopTimingStats_t *gyroToPid = loopTimingGetStats(LOOP_TIMING_GYRO_TO_PID);
+    EXPECT_EQ(30, gyroToPid->minUs);
+    EXPECT_EQ(30, gyroToPid->avgUs);
+    EXPECT_EQ(30, gyroToPid->maxUs);
+    EXPECT_EQ(30, gyroToPid->p99Us);
+
+    const loopTimingStats_t *pidToMotor = loopTimingGetStats(LOOP_TIMING_PID_TO_MOTOR);
+    EXPECT_EQ(40, pidToMotor->minUs);
+    EXPECT_EQ(40, pidToMotor->p99Us);
+
+    // the next window only has its own samples
+    timeUs = runWindow(timeUs + LOOPTIME_US, 50, 60);
+    loopTimingLoopStarted(timeUs, LOOPTIME_US);
+    EXPECT_EQ(50, loopTimingGetStats(LOOP_TIMING_GYRO_TO_PID)->minUs);
+    EXPECT_EQ(60, loopTimingGetStats(LOOP_TIMING_PID_TO_MOTOR)->avgUs);
+}
+
+TEST(LoopTimingTest, PercentileIgnoresTheSlowestPercent)
+{
+    loopTimingReset();
+
+    timeUs_t timeUs = 1000;
+    loopTimingLoopStarted(timeUs, LOOPTIME_US);
+    for (int i = 0; i < 1000; i++) {
+        loopTimingPidStarted(timeUs, timeUs - (i < 5 ? 90 : 20));
+    }
+    loopTimingLoopStarted(timeUs + LOOP_TIMING_WINDOW_US, LOOPTIME_US);
+
+    const loopTimingStats_t *stats = loopTimingGetStats(LOOP_TIMING_GYRO_TO_PID);
+    EXPECT_EQ(20, stats->minUs);
+    EXPECT_EQ(20, stats->p99Us);
+    EXPECT_EQ(90, stats->maxUs);
+}
+
+TEST(LoopTimingTest, LongTimesReportTheMaximum)
+{
+    loopTimingReset();
+
+    timeUs_t timeUs = 1000;
+    loopTimingLoopStarted(timeUs, LOOPTIME_US);
+    loopTimingPidStarted(timeUs, timeUs - 20);
+    loopTimingPidStarted(timeUs, timeUs - 500);
+    loopTimingLoopStarted(timeUs + LOOP_TIMING_WINDOW_US, LOOPTIME_US);
+
+    const loopTimingStats_t *stats = loopTimingGetStats(LOOP_TIMING_GYRO_TO_PID);
+    EXPECT_EQ(500, stats->maxUs);
+    EXPECT_EQ(500, stats->p99Us);
+    EXPECT_EQ(260, stats->avgUs);
+}
+
+TEST(LoopTimingTest, GyroWithoutDataReadyTimeIsSkipped)
+{
+    loopTimingReset();
+
+    timeUs_t timeUs = 1000;
+    loopTimingLoopStarted(timeUs, LOOPTIME_US);
+    loopTimingPidStarted(timeUs, 0);
+    loopTimingMotorsWritten(timeUs + 35);
+    loopTimingLoopStarted(timeUs + LOOP_TIMING_WINDOW_US, LOOPTIME_US);
+
+    EXPECT_EQ(0, loopTimingGetStats(LOOP_TIMING_GYRO_TO_PID)->maxUs);
+    EXPECT_EQ(35, loopTimingGetStats(LOOP_TIMING_PID_TO_MOTOR)->maxUs);
+}
@@ -273,3 +273,40 @@ TEST(MathsUnittest, TestFastTrigonometryACos)
     EXPECT_LE(error, 1e-4);
 }
 #endif
+
+#ifdef USE_FAST_MATH_TABLES
+TEST(MathsUnittest, TestTableTrigonometrySinCos)
+{
+    fastMathTablesInit();
+
+    double sinError = 0;
+    double cosError = 0;
+    for (float x = -10 * M_PI; x < 10 * M_PI; x += M_PI / 3000) {
+        sinError = MAX(sinError, fabs(sin_table(x) - sin(x)));
+        cosError = MAX(cosError, fabs(cos_table(x) - cos(x)));
+    }
+    printf("sin_table maximum absolute error = %e\n", sinError);
+    printf("cos_table maximum absolute error = %e\n", cosError);
+    EXPECT_LE(sinError, 8e-5);
+    EXPECT_LE(cosError, 8e-5);
+}
+
+TEST(MathsUnittest, TestTableTrigonometryATan2)
+{
+    fastMathTablesInit();
+
+    double error = 0;
+    for (float x = -1.0f; x < 1.0f; x += 0.01) {
+        for (float y = -1.0f; y < 1.0f; y += 0.001) {
+            error = MAX(error, fabs(atan2_table(y, x) - atan2(y, x)));
+        }
+    }
+    printf("atan2_table maximum absolute error = %e rads (%e degree)\n", error, error / M_PI * 180.0f);
+    EXPECT_LE(error, 1e-5);
+
+    EXPECT_FLOAT_EQ(0, atan2_table(0, 0));
+    EXPECT_NEAR(M_PI / 2, atan2_table(1, 0), 1e-6);
+    EXPECT_NEAR(-M_PI / 2, atan2_table(-1, 0), 1e-6);
+    EXPECT_NEAR(M_PI, atan2_table(0, -1), 1e-6);
+}
+#endif
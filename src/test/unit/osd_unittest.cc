@@ -63,6 +63,7 @@ extern "C" {
     #include "flight/mixer.h"
 
     void osdRefresh(timeUs_t currentTimeUs);
+    void osdUpdateWarningsAndStats(timeUs_t currentTimeUs);
     void osdFormatTime(char * buff, osd_timer_precision_e precision, timeUs_t time);
     int osdConvertTemperatureToSelectedUnit(int tempInDegreesCelcius);
 
@@ -367,6 +368,7 @@ TEST(OsdTest, TestStatsImperial)
     simulationBatteryVoltage = 1580;
     simulationAltitude = 100;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     rssi = 512;
@@ -376,6 +378,7 @@ TEST(OsdTest, TestStatsImperial)
     simulationBatteryVoltage = 1470;
     simulationAltitude = 150;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     rssi = 256;
@@ -385,6 +388,7 @@ TEST(OsdTest, TestStatsImperial)
     simulationBatteryVoltage = 1520;
     simulationAltitude = 200;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // and
@@ -436,11 +440,13 @@ TEST(OsdTest, TestStatsMetric)
     simulationBatteryVoltage = 1470;
     simulationAltitude = 200;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
     osdRefresh(simulationTime);
 
     simulationBatteryVoltage = 1520;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // and
@@ -492,11 +498,13 @@ TEST(OsdTest, TestStatsMetricDistanceUnits)
     simulationBatteryVoltage = 1470;
     simulationAltitude = 200;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
     osdRefresh(simulationTime);
 
     simulationBatteryVoltage = 1520;
     simulationTime += 1e6;
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // and
@@ -653,6 +661,37 @@ TEST(OsdTest, TestElementRssi)
     displayPortTestBufferSubstring(8, 1, "%c50", SYM_RSSI);
 }
 
+/*
+ * Tests that an element is only written to the display when it changes.
+ */
+TEST(OsdTest, TestElementRedrawnWhenChanged)
+{
+    // given
+    osdConfigMutable()->item_pos[OSD_RSSI_VALUE] = OSD_POS(8, 1) | OSD_PROFILE_1_FLAG;
+    osdConfigMutable()->rssi_alarm = 0;
+
+    osdAnalyzeActiveElements();
+
+    rssi = 1024;
+    displayClearScreen(&testDisplayPort);
+    osdRefresh(simulationTime);
+    displayPortTestBufferSubstring(8, 1, "%c99", SYM_RSSI);
+
+    // when
+    displayWrite(&testDisplayPort, 8, 1, "XXX");
+    osdRefresh(simulationTime);
+
+    // then
+    displayPortTestBufferSubstring(8, 1, "XXX");
+
+    // when
+    rssi = 512;
+    osdRefresh(simulationTime);
+
+    // then
+    displayPortTestBufferSubstring(8, 1, "%c50", SYM_RSSI);
+}
+
 /*
  * Tests the instantaneous battery current OSD element.
  */
@@ -939,6 +978,7 @@ TEST(OsdTest, TestElementWarningsBattery)
 
     // when
     displayClearScreen(&testDisplayPort);
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // then
@@ -951,6 +991,7 @@ TEST(OsdTest, TestElementWarningsBattery)
 
     // when
     displayClearScreen(&testDisplayPort);
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // then
@@ -963,6 +1004,7 @@ TEST(OsdTest, TestElementWarningsBattery)
 
     // when
     displayClearScreen(&testDisplayPort);
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // then
@@ -975,6 +1017,7 @@ TEST(OsdTest, TestElementWarningsBattery)
 
     // when
     displayClearScreen(&testDisplayPort);
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // then
@@ -987,6 +1030,7 @@ TEST(OsdTest, TestElementWarningsBattery)
 
     // when
     displayClearScreen(&testDisplayPort);
+    osdUpdateWarningsAndStats(simulationTime);
     osdRefresh(simulationTime);
 
     // then
@@ -84,6 +84,16 @@ TEST(ParameterGroupsfTest, Test_pgFind)
     EXPECT_EQ(400, motorConfig3.dev.motorPwmRate);
 }
 
+TEST(ParameterGroupsfTest, Test_pgFindAll)
+{
+    // every registered PG is found through the index, unregistered ones are not
+    PG_FOREACH(reg) {
+        EXPECT_EQ(reg, pgFind(pgN(reg)));
+    }
+    EXPECT_EQ(NULL, pgFind(PG_RESERVED_FOR_TESTING_1));
+    EXPECT_FALSE(pgResetCopy(NULL, PG_RESERVED_FOR_TESTING_1));
+}
+
 // STUBS
 
 extern "C" {
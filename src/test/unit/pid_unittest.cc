@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <time.h>
 #include <cmath>
 
 #include "unittest_macros.h"
@@ -86,6 +87,10 @@ extern "C" {
         UNUSED(currentPidSetpoint);
         return value;
     }
+
+    void pidControllerGeneric(const pidProfile_t *pidProfile, timeUs_t currentTimeUs);
+    void pidControllerItermRelax(const pidProfile_t *pidProfile, timeUs_t currentTimeUs);
+    void pidDtermFilterApply(float *values);
 }
 
 pidProfile_t *pidProfile;
@@ -619,8 +624,87 @@ TEST(pidControllerTest, testAbsoluteControl) {
     ASSERT_NEAR(-79.2, currentPidSetpoint, calculateTolerance(-79.2));
 }
 
+// The per axis filters the three axis D term filters replaced, as the reference for them
+typedef struct dtermReferenceFilters_s {
+    bool notchEnabled;
+    biquadFilter_t notch[XYZ_AXIS_COUNT];
+    lowpassFilterType_e lowpassType;
+    biquadFilter_t lowpassBiquad[XYZ_AXIS_COUNT];
+    pt1Filter_t lowpassPt1[XYZ_AXIS_COUNT];
+    lowpassFilterType_e lowpass2Type;
+    biquadFilter_t lowpass2Biquad[XYZ_AXIS_COUNT];
+    pt1Filter_t lowpass2Pt1[XYZ_AXIS_COUNT];
+} dtermReferenceFilters_t;
+
+static void initDtermReferenceFilters(dtermReferenceFilters_t *ref)
+{
+    ref->notchEnabled = pidProfile->dterm_notch_hz != 0;
+    ref->lowpassType = (lowpassFilterType_e)pidProfile->dterm_filter_type;
+    ref->lowpass2Type = (lowpassFilterType_e)pidProfile->dterm_filter2_type;
+    for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+        biquadFilterInit(&ref->notch[axis], pidProfile->dterm_notch_hz, targetPidLooptime,
+            filterGetNotchQ(pidProfile->dterm_notch_hz, pidProfile->dterm_notch_cutoff), FILTER_NOTCH);
+        biquadFilterInitLPF(&ref->lowpassBiquad[axis], pidProfile->dterm_lowpass_hz, targetPidLooptime);
+        pt1FilterInit(&ref->lowpassPt1[axis], pt1FilterGain(pidProfile->dterm_lowpass_hz, pidGetDT()));
+        biquadFilterInitLPF(&ref->lowpass2Biquad[axis], pidProfile->dterm_lowpass2_hz, targetPidLooptime);
+        pt1FilterInit(&ref->lowpass2Pt1[axis], pt1FilterGain(pidProfile->dterm_lowpass2_hz, pidGetDT()));
+    }
+}
+
+static float applyDtermReferenceFilters(dtermReferenceFilters_t *ref, int axis, float value)
+{
+    if (ref->notchEnabled) {
+        value = biquadFilterApply(&ref->notch[axis], value);
+    }
+    value = ref->lowpassType == FILTER_PT1 ? pt1FilterApply(&ref->lowpassPt1[axis], value) : biquadFilterApply(&ref->lowpassBiquad[axis], value);
+    if (pidProfile->dterm_lowpass2_hz) {
+        value = ref->lowpass2Type == FILTER_PT1 ? pt1FilterApply(&ref->lowpass2Pt1[axis], value) : biquadFilterApply(&ref->lowpass2Biquad[axis], value);
+    }
+    return value;
+}
+
+static void checkDtermFilterEquivalence(void)
+{
+    // a loop fast enough for all the test cutoffs to be below its Nyquist frequency
+    gyro.targetLooptime = 500;
+    dtermReferenceFilters_t ref;
+    pidInit(pidProfile);
+    initDtermReferenceFilters(&ref);
+
+    for (int loop = 0; loop < 500; loop++) {
+        float values[XYZ_AXIS_COUNT];
+        float expected[XYZ_AXIS_COUNT];
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            // a different mix of a low and a high frequency on each axis
+            values[axis] = 300.0f * sinf(0.05f * loop + axis) + 40.0f * sinf(2.1f * loop * (axis + 1));
+            expected[axis] = applyDtermReferenceFilters(&ref, axis, values[axis]);
+        }
+        pidDtermFilterApply(values);
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            EXPECT_FLOAT_EQ(expected[axis], values[axis]);
+        }
+    }
+}
+
 TEST(pidControllerTest, testDtermFiltering) {
-// TODO
+    // the default test profile, notch and biquad lowpass
+    resetTest();
+    checkDtermFilterEquivalence();
+
+    // pt1 then biquad, without the notch
+    resetTest();
+    pidProfile->dterm_notch_hz = 0;
+    pidProfile->dterm_filter_type = FILTER_PT1;
+    pidProfile->dterm_lowpass2_hz = 200;
+    pidProfile->dterm_filter2_type = FILTER_BIQUAD;
+    checkDtermFilterEquivalence();
+
+    // notch and both lowpass filters pt1
+    resetTest();
+    pidProfile->dterm_filter_type = FILTER_PT1;
+    pidProfile->dterm_lowpass2_hz = 150;
+    pidProfile->dterm_filter2_type = FILTER_PT1;
+    checkDtermFilterEquivalence();
 }
 
 TEST(pidControllerTest, testItermRotationHandling) {
@@ -779,3 +863,130 @@ TEST(pidControllerTest, testLaunchControl) {
     ASSERT_NEAR(44.84,  pidData[FD_YAW].P,   calculateTolerance(44.84));
     ASSERT_NEAR(1.56,   pidData[FD_YAW].I,  calculateTolerance(1.56));
 }
+
+typedef void (*pidControllerFnPtr)(const pidProfile_t *pidProfile, timeUs_t currentTimeUs);
+
+#define CONTROLLER_TEST_STIMULUS_LENGTH 256
+
+static float stickStimulus[CONTROLLER_TEST_STIMULUS_LENGTH][XYZ_AXIS_COUNT];
+static float gyroStimulus[CONTROLLER_TEST_STIMULUS_LENGTH][XYZ_AXIS_COUNT];
+
+// Moves the sticks and the gyro along a sine wave, so that all the PID terms are active
+static void runControllerLoop(pidControllerFnPtr controllerFn, int loop)
+{
+    const int i = loop % CONTROLLER_TEST_STIMULUS_LENGTH;
+    for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+        setStickPosition(axis, stickStimulus[i][axis]);
+        gyro.gyroADCf[axis] = gyroStimulus[i][axis];
+    }
+    controllerFn(pidProfile, currentTestTime());
+}
+
+static void resetControllerTest(void)
+{
+    for (int i = 0; i < CONTROLLER_TEST_STIMULUS_LENGTH; i++) {
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            const float phase = 2 * M_PIf * i / CONTROLLER_TEST_STIMULUS_LENGTH + axis;
+            stickStimulus[i][axis] = 0.3f * sinf(phase);
+            gyroStimulus[i][axis] = 500.0f * sinf(phase - 0.3f);
+        }
+    }
+
+    resetTest();
+    pidProfile->iterm_relax = ITERM_RELAX_RP;
+    pidInit(pidProfile);
+    ENABLE_ARMING_FLAG(ARMED);
+    pidStabilisationState(PID_STABILISATION_ON);
+}
+
+TEST(pidControllerTest, testControllerVariantsMatch) {
+    static const int loops = 200;
+    static pidAxisData_t expected[loops][XYZ_AXIS_COUNT];
+
+    resetControllerTest();
+    for (int loop = 0; loop < loops; loop++) {
+        runControllerLoop(pidControllerGeneric, loop);
+        memcpy(expected[loop], pidData, sizeof(expected[loop]));
+    }
+
+    resetControllerTest();
+    for (int loop = 0; loop < loops; loop++) {
+        runControllerLoop(pidControllerItermRelax, loop);
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            EXPECT_FLOAT_EQ(expected[loop][axis].P, pidData[axis].P);
+            EXPECT_FLOAT_EQ(expected[loop][axis].I, pidData[axis].I);
+            EXPECT_FLOAT_EQ(expected[loop][axis].D, pidData[axis].D);
+            EXPECT_FLOAT_EQ(expected[loop][axis].F, pidData[axis].F);
+            EXPECT_FLOAT_EQ(expected[loop][axis].Sum, pidData[axis].Sum);
+        }
+    }
+}
+
+static double benchmarkController(pidControllerFnPtr controllerFn)
+{
+    static const int iterations = 200000;
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int loop = 0; loop < iterations; loop++) {
+        runControllerLoop(controllerFn, loop);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((now.tv_sec - start.tv_sec) * 1e9 + (now.tv_nsec - start.tv_nsec)) / iterations;
+}
+
+TEST(pidControllerTest, BenchmarkController) {
+    // the default profile, through the generic controller and the variant picked for it
+    resetControllerTest();
+    const double nsGeneric = benchmarkController(pidControllerGeneric);
+    resetControllerTest();
+    const double nsItermRelax = benchmarkController(pidControllerItermRelax);
+    resetControllerTest();
+    const double nsDefault = benchmarkController(pidController);
+
+    // absolute control is only handled by the generic controller
+    resetControllerTest();
+    pidProfile->abs_control_gain = 10;
+    pidInit(pidProfile);
+    const double nsAbsoluteControl = benchmarkController(pidController);
+
+    printf("[ BENCH    ] default profile: generic %6.1f ns, iterm relax variant %6.1f ns, pidController() %6.1f ns per loop\n",
+        nsGeneric, nsItermRelax, nsDefault);
+    printf("[ BENCH    ] absolute control profile: pidController() %6.1f ns per loop\n", nsAbsoluteControl);
+}
+
+TEST(pidControllerTest, testChangeProfile) {
+    resetTest();
+    ENABLE_ARMING_FLAG(ARMED);
+    pidStabilisationState(PID_STABILISATION_ON);
+
+    pidProfile_t *nextProfile = pidProfilesMutable(2);
+    memcpy(nextProfile, pidProfile, sizeof(pidProfile_t));
+    nextProfile->pid[FD_ROLL].P *= 2;
+
+    // ramp the roll gyro, the D term is then held by the notch and lowpass filter state
+    for (int loop = 0; loop < 100; loop++) {
+        gyro.gyroADCf[FD_ROLL] += 1.0f;
+        pidController(pidProfile, currentTestTime());
+    }
+    const float previousP = pidData[FD_ROLL].P;
+    const float previousD = pidData[FD_ROLL].D;
+    ASSERT_NE(0, previousD);
+
+    // the filters are the same in both profiles, so their state carries over the switch
+    pidChangeProfile(pidProfile, nextProfile);
+    gyro.gyroADCf[FD_ROLL] += 1.0f;
+    pidController(nextProfile, currentTestTime());
+
+    ASSERT_NEAR(2 * previousP, pidData[FD_ROLL].P, calculateTolerance(2 * previousP));
+    ASSERT_NEAR(previousD, pidData[FD_ROLL].D, calculateTolerance(previousD));
+
+    // a change of the lowpass cutoff reinitialises it, resetting its state disturbs the D term
+    pidProfile->dterm_lowpass_hz = 50;
+    pidChangeProfile(nextProfile, pidProfile);
+    gyro.gyroADCf[FD_ROLL] += 1.0f;
+    pidController(pidProfile, currentTestTime());
+
+    ASSERT_NEAR(previousP, pidData[FD_ROLL].P, calculateTolerance(previousP));
+    EXPECT_GT(fabsf(pidData[FD_ROLL].D - previousD), calculateTolerance(previousD));
+}
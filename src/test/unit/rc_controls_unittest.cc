@@ -191,6 +191,81 @@ TEST_F(RcControlsModesTest, updateActivatedModesUsingValidAuxConfigurationAndRXV
     }
 }
 
+TEST_F(RcControlsModesTest, updateActivatedModesFollowsChangedChannels)
+{
+    // given
+    memset(modeActivationConditionsMutable(0), 0, sizeof(modeActivationCondition_t) * MAX_MODE_ACTIVATION_CONDITION_COUNT);
+
+    // mode 1 needs both AUX1 and AUX2 high
+    modeActivationConditionsMutable(0)->modeId = (boxId_e)1;
+    modeActivationConditionsMutable(0)->auxChannelIndex = AUX1 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditionsMutable(0)->range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditionsMutable(0)->range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+    modeActivationConditionsMutable(0)->modeLogic = MODELOGIC_AND;
+
+    modeActivationConditionsMutable(1)->modeId = (boxId_e)1;
+    modeActivationConditionsMutable(1)->auxChannelIndex = AUX2 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditionsMutable(1)->range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditionsMutable(1)->range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+    modeActivationConditionsMutable(1)->modeLogic = MODELOGIC_AND;
+
+    // mode 2 needs AUX1 low or AUX3 high
+    modeActivationConditionsMutable(2)->modeId = (boxId_e)2;
+    modeActivationConditionsMutable(2)->auxChannelIndex = AUX1 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditionsMutable(2)->range.startStep = CHANNEL_VALUE_TO_STEP(900);
+    modeActivationConditionsMutable(2)->range.endStep = CHANNEL_VALUE_TO_STEP(1300);
+
+    modeActivationConditionsMutable(3)->modeId = (boxId_e)2;
+    modeActivationConditionsMutable(3)->auxChannelIndex = AUX3 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditionsMutable(3)->range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditionsMutable(3)->range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+
+    // and
+    rcData[AUX1] = PWM_RANGE_MAX;
+    rcData[AUX2] = PWM_RANGE_MIN;
+    rcData[AUX3] = PWM_RANGE_MIN;
+    analyzeModeActivationConditions();
+
+    // when
+    updateActivatedModes();
+
+    // then
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE((boxId_e)1));
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE((boxId_e)2));
+
+    // when
+    rcData[AUX2] = PWM_RANGE_MAX;
+    updateActivatedModes();
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE((boxId_e)1));
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE((boxId_e)2));
+
+    // when
+    rcData[AUX1] = PWM_RANGE_MIN;
+    updateActivatedModes();
+
+    // then
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE((boxId_e)1));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE((boxId_e)2));
+
+    // when
+    rcData[AUX3] = PWM_RANGE_MAX;
+    rcData[AUX1] = PWM_RANGE_MAX;
+    updateActivatedModes();
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE((boxId_e)1));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE((boxId_e)2));
+
+    // when nothing moved
+    updateActivatedModes();
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE((boxId_e)1));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE((boxId_e)2));
+}
+
 enum {
     COUNTER_QUEUE_CONFIRMATION_BEEP,
     COUNTER_CHANGE_CONTROL_RATE_PROFILE
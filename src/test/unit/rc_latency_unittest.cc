@@ -0,0 +1,121 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "fc/rc_latency.h"
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint32_t totalSamples(const rcLatencyStats_t *stats)
+{
+    uint32_t samples = 0;
+    for (int i = 0; i < RC_LATENCY_BUCKET_COUNT; i++) {
+        samples += stats->histogram[i];
+    }
+    return samples;
+}
+
+TEST(RcLatencyTest, RecordsEachStageOncePerFrame)
+{
+    rcLatencyReset();
+
+    rcLatencyFrameReceived(10000);
+    rcLatencyStageReached(RC_LATENCY_STAGE_RX, 10250);
+    rcLatencyStageReached(RC_LATENCY_STAGE_SETPOINT, 10400);
+    rcLatencyStageReached(RC_LATENCY_STAGE_MOTOR, 10450);
+
+    // later PID loops without a new frame are not counted
+    rcLatencyStageReached(RC_LATENCY_STAGE_SETPOINT, 10525);
+    rcLatencyStageReached(RC_LATENCY_STAGE_MOTOR, 10575);
+
+    EXPECT_EQ(250, rcLatencyGetStats(RC_LATENCY_STAGE_RX)->lastLatencyUs);
+    EXPECT_EQ(400, rcLatencyGetStats(RC_LATENCY_STAGE_SETPOINT)->lastLatencyUs);
+    EXPECT_EQ(450, rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR)->lastLatencyUs);
+
+    EXPECT_EQ(1, rcLatencyGetStats(RC_LATENCY_STAGE_RX)->histogram[250 / RC_LATENCY_BUCKET_WIDTH_US]);
+    EXPECT_EQ(1, rcLatencyGetStats(RC_LATENCY_STAGE_SETPOINT)->histogram[400 / RC_LATENCY_BUCKET_WIDTH_US]);
+    EXPECT_EQ(1, rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR)->histogram[450 / RC_LATENCY_BUCKET_WIDTH_US]);
+    for (int stage = 0; stage < RC_LATENCY_STAGE_COUNT; stage++) {
+        EXPECT_EQ(1, totalSamples(rcLatencyGetStats((rcLatencyStage_e)stage)));
+    }
+}
+
+TEST(RcLatencyTest, StagesNeedTheStagesBeforeThem)
+{
+    rcLatencyReset();
+
+    // the motors are written before the PID loop picked up the new frame
+    rcLatencyFrameReceived(20000);
+    rcLatencyStageReached(RC_LATENCY_STAGE_RX, 20100);
+    rcLatencyStageReached(RC_LATENCY_STAGE_MOTOR, 20125);
+    EXPECT_EQ(0, totalSamples(rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR)));
+
+    rcLatencyStageReached(RC_LATENCY_STAGE_SETPOINT, 20250);
+    rcLatencyStageReached(RC_LATENCY_STAGE_MOTOR, 20300);
+    EXPECT_EQ(300, rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR)->lastLatencyUs);
+    EXPECT_EQ(1, totalSamples(rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR)));
+}
+
+TEST(RcLatencyTest, LongLatenciesGoToTheLastBucket)
+{
+    rcLatencyReset();
+
+    rcLatencyFrameReceived(0xFFFFF000);   // the frame time wraps
+    rcLatencyStageReached(RC_LATENCY_STAGE_RX, 0x00010000);
+
+    const rcLatencyStats_t *stats = rcLatencyGetStats(RC_LATENCY_STAGE_RX);
+    EXPECT_EQ(0x11000, stats->lastLatencyUs);
+    EXPECT_EQ(1, stats->histogram[RC_LATENCY_BUCKET_COUNT - 1]);
+}
+
+TEST(RcLatencyTest, SaturationHalvesTheHistogram)
+{
+    rcLatencyReset();
+
+    timeUs_t timeUs = 0;
+    for (int i = 0; i < UINT16_MAX; i++) {
+        rcLatencyFrameReceived(timeUs);
+        rcLatencyStageReached(RC_LATENCY_STAGE_RX, timeUs + 50);
+        timeUs += 1000;
+    }
+    for (int i = 0; i < 2; i++) {
+        rcLatencyFrameReceived(timeUs);
+        rcLatencyStageReached(RC_LATENCY_STAGE_RX, timeUs + 150);
+    }
+    rcLatencyFrameReceived(timeUs);
+    rcLatencyStageReached(RC_LATENCY_STAGE_RX, timeUs + 50);
+
+    const rcLatencyStats_t *stats = rcLatencyGetStats(RC_LATENCY_STAGE_RX);
+    EXPECT_EQ(UINT16_MAX / 2 + 1, stats->histogram[0]);
+    EXPECT_EQ(1, stats->histogram[1]);
+}
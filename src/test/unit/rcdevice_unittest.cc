@@ -708,6 +708,42 @@ TEST(RCDeviceTest, Test5KeyOSDCableSimulationProtocol)
     }
 }
 
+TEST(RCDeviceTest, Test5KeyOSDCableSimulationPipelined)
+{
+    resetRCDeviceStatus();
+
+    memset(&testData, 0, sizeof(testData));
+    testData.isRunCamSplitOpenPortSupported = true;
+    testData.isRunCamSplitPortConfigurated = true;
+    testData.isAllowBufferReadWrite = true;
+    testData.maxTimesOfRespDataAvailable = 0;
+    uint8_t responseData[] = { 0xCC, 0x01, 0x37, 0x00, 0xBD };
+    addResponseData(responseData, sizeof(responseData), true);
+    rcdeviceInit();
+    testData.millis += 3001;
+    rcdeviceReceive(millis() * 1000);
+    testData.millis += minTimeout;
+    testData.responseDataReadPos = 0;
+    testData.indexOfCurrentRespBuf = 0;
+    rcdeviceReceive(millis() * 1000);
+    testData.millis += minTimeout;
+    EXPECT_EQ(true, camDevice->isReady);
+    clearResponseBuff();
+
+    // the release goes out before the press is answered, both responses are dispatched in one pass
+    rcdeviceSend5KeyOSDCableSimualtionEvent(RCDEVICE_CAM_KEY_RIGHT);
+    rcdeviceSend5KeyOSDCableSimualtionEvent(RCDEVICE_CAM_KEY_RELEASE);
+    EXPECT_EQ(2, waitingResponseQueue.itemCount);
+
+    uint8_t responseDataOfPressAndRelease[] = { 0xCC, 0xA5, 0xCC, 0xA5 };
+    addResponseData(responseDataOfPressAndRelease, sizeof(responseDataOfPressAndRelease), true);
+    isButtonPressed = true;
+    rcdeviceReceive(millis() * 1000);
+    EXPECT_EQ(0, waitingResponseQueue.itemCount);
+    EXPECT_EQ(false, isButtonPressed);
+    clearResponseBuff();
+}
+
 TEST(RCDeviceTest, Test5KeyOSDCableSimulationWithout5KeyFeatureSupport)
 {
     resetRCDeviceStatus();
@@ -39,13 +39,15 @@ extern "C" {
     #include "rx/rx.h"
     #include "rx/crsf.h"
 
+    #include "scheduler/scheduler.h"
+
     #include "telemetry/msp_shared.h"
 
     rssiSource_e rssiSource;
 
     void crsfDataReceive(uint16_t c);
     uint8_t crsfFrameCRC(void);
-    uint8_t crsfFrameStatus(void);
+    uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig);
     uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
 
     extern bool crsfFrameDone;
@@ -53,6 +55,7 @@ extern "C" {
     extern uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
     uint32_t dummyTimeUs;
+    int rxTaskWakeCount;
 
     PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
 }
@@ -118,17 +121,28 @@ TEST(CrossFireTest, CRC)
     EXPECT_EQ(crc1, crc2);
 }
 
+// Feeds a frame to the receive ISR a byte at a time
+static void crsfReceiveFrame(const crsfFrame_t *frame)
+{
+    const int frameLength = frame->frame.frameLength + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH;
+    for (int ii = 0; ii < frameLength; ++ii) {
+        crsfDataReceive(frame->bytes[ii]);
+    }
+}
+
 TEST(CrossFireTest, TestCrsfFrameStatus)
 {
-    crsfFrameDone = true;
+    crsfFrameDone = false;
     crsfFrame.frame.deviceAddress = CRSF_ADDRESS_CRSF_RECEIVER;
-    crsfFrame.frame.frameLength = 0;
+    crsfFrame.frame.frameLength = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;
     crsfFrame.frame.type = CRSF_FRAMETYPE_RC_CHANNELS_PACKED;
     memset(crsfFrame.frame.payload, 0, CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE);
     const uint8_t crc = crsfFrameCRC();
     crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = crc;
+    const crsfFrame_t frame = crsfFrame;
+    crsfReceiveFrame(&frame);
 
-    const uint8_t status = crsfFrameStatus();
+    const uint8_t status = crsfFrameStatus(NULL);
     EXPECT_EQ(RX_FRAME_COMPLETE, status);
     EXPECT_EQ(false, crsfFrameDone);
 
@@ -148,7 +162,7 @@ TEST(CrossFireTest, TestCrsfFrameStatus)
  */
 TEST(CrossFireTest, TestCrsfFrameStatusUnpacking)
 {
-    crsfFrameDone = true;
+    crsfFrameDone = false;
     crsfFrame.frame.deviceAddress = CRSF_ADDRESS_CRSF_RECEIVER;
     crsfFrame.frame.frameLength = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;;
     crsfFrame.frame.type = CRSF_FRAMETYPE_RC_CHANNELS_PACKED;
@@ -177,8 +191,10 @@ TEST(CrossFireTest, TestCrsfFrameStatusUnpacking)
     crsfFrame.frame.payload[21] = 0;
     const uint8_t crc = crsfFrameCRC();
     crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = crc;
+    const crsfFrame_t frame = crsfFrame;
+    crsfReceiveFrame(&frame);
 
-    const uint8_t status = crsfFrameStatus();
+    const uint8_t status = crsfFrameStatus(NULL);
     EXPECT_EQ(RX_FRAME_COMPLETE, status);
     EXPECT_EQ(false, crsfFrameDone);
 
@@ -220,9 +236,9 @@ TEST(CrossFireTest, TestCapturedData)
 {
     //const int frameCount = sizeof(capturedData) / sizeof(crsfRcChannelsFrame_t);
     const crsfRcChannelsFrame_t *framePtr = (const crsfRcChannelsFrame_t*)capturedData;
-    crsfFrame = *(const crsfFrame_t*)framePtr;
-    crsfFrameDone = true;
-    uint8_t status = crsfFrameStatus();
+    crsfFrameDone = false;
+    crsfReceiveFrame((const crsfFrame_t*)framePtr);
+    uint8_t status = crsfFrameStatus(NULL);
     EXPECT_EQ(RX_FRAME_COMPLETE, status);
     EXPECT_EQ(false, crsfFrameDone);
     EXPECT_EQ(RX_FRAME_COMPLETE, status);
@@ -242,9 +258,9 @@ TEST(CrossFireTest, TestCapturedData)
     EXPECT_EQ(1495, crsfReadRawRC(NULL, 3));
 
     ++framePtr;
-    crsfFrame = *(const crsfFrame_t*)framePtr;
-    crsfFrameDone = true;
-    status = crsfFrameStatus();
+    crsfFrameDone = false;
+    crsfReceiveFrame((const crsfFrame_t*)framePtr);
+    status = crsfFrameStatus(NULL);
     EXPECT_EQ(RX_FRAME_COMPLETE, status);
     EXPECT_EQ(false, crsfFrameDone);
     EXPECT_EQ(RX_FRAME_COMPLETE, status);
@@ -279,6 +295,37 @@ TEST(CrossFireTest, TestCrsfDataReceive)
     EXPECT_EQ(crc, crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]);
 }
 
+TEST(CrossFireTest, TestCrsfFrameValidatedInIsr)
+{
+    rxRuntimeConfig_t rxRuntimeConfig;
+    memset(&rxRuntimeConfig, 0, sizeof(rxRuntimeConfig));
+    crsfRxInit(rxConfig(), &rxRuntimeConfig);
+    ASSERT_NE(nullptr, rxRuntimeConfig.rcFrameTimeUsFn);
+
+    // a valid frame is timestamped when its last byte arrives and wakes up the RX task
+    crsfFrameDone = false;
+    rxTaskWakeCount = 0;
+    dummyTimeUs = 1000000;
+    crsfReceiveFrame((const crsfFrame_t*)capturedData);
+    EXPECT_EQ(true, crsfFrameDone);
+    EXPECT_EQ(1, rxTaskWakeCount);
+    EXPECT_EQ(1000000, rxRuntimeConfig.rcFrameTimeUsFn(&rxRuntimeConfig));
+    EXPECT_EQ(RX_FRAME_COMPLETE, crsfFrameStatus(NULL));
+
+    // a corrupted frame is dropped by the ISR
+    crsfFrame_t frame = *(const crsfFrame_t*)capturedData;
+    frame.frame.payload[0] ^= 0x01;
+    dummyTimeUs += 6667;
+    crsfReceiveFrame(&frame);
+    EXPECT_EQ(false, crsfFrameDone);
+    EXPECT_EQ(1, rxTaskWakeCount);
+    EXPECT_EQ(1000000, rxRuntimeConfig.rcFrameTimeUsFn(&rxRuntimeConfig));
+    EXPECT_EQ(RX_FRAME_PENDING, crsfFrameStatus(NULL));
+    EXPECT_EQ(189, crsfChannelData[0]);
+
+    dummyTimeUs = 0;
+}
+
 // STUBS
 
 extern "C" {
@@ -291,6 +338,7 @@ bool telemetryCheckRxPortShared(const serialPortConfig_t *) {return false;}
 serialPort_t *telemetrySharedPort = NULL;
 void crsfScheduleDeviceInfoResponse(void) {};
 void crsfScheduleMspResponse(void) {};
+void schedulerWakeTask(cfTaskId_e taskId) { if (taskId == TASK_RX) rxTaskWakeCount++; }
 bool bufferMspFrame(uint8_t *, int) {return true;}
 bool isBatteryVoltageAvailable(void) { return true; }
 bool isAmperageAvailable(void) { return true; }
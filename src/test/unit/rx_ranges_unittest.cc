@@ -223,24 +223,9 @@ void failsafeOnValidDataFailed(void)
 {
 }
 
-float pt1FilterGain(float f_cut, float dT)
+uint32_t failsafeRxLinkDownAtMs(void)
 {
-    UNUSED(f_cut);
-    UNUSED(dT);
-    return 0.0;
-}
-
-void pt1FilterInit(pt1Filter_t *filter, float k)
-{
-    UNUSED(filter);
-    UNUSED(k);
-}
-
-float pt1FilterApply(pt1Filter_t *filter, float input)
-{
-    UNUSED(filter);
-    UNUSED(input);
-    return 0.0;
+    return 0;
 }
 
 }
@@ -35,6 +35,7 @@ extern "C" {
     #include "pg/pg.h"
     #include "pg/pg_ids.h"
     #include "io/beeper.h"
+    #include "io/serial.h"
 
     boxBitmask_t rcModeActivationMask;
     int16_t debug[DEBUG16_VALUE_COUNT];
@@ -42,6 +43,9 @@ extern "C" {
 
     bool isPulseValid(uint16_t pulseDuration);
 
+    extern rxDiversityState_t rxDiversityState[RX_RECEIVER_COUNT];
+    uint8_t rxDiversitySelectReceiver(uint8_t activeReceiver, const uint8_t *frameStatus, timeUs_t currentTimeUs);
+
     PG_RESET_TEMPLATE(featureConfig_t, featureConfig,
         .enabledFeatures = 0
     );
@@ -202,11 +206,84 @@ TEST(RxTest, TestInvalidFlightChannels)
 }
 #endif
 
+#define RX_FRAME_INTERVAL_US 10000
+
+static void resetDiversityState(void)
+{
+    for (int i = 0; i < RX_RECEIVER_COUNT; i++) {
+        rxDiversityState[i].lastGoodFrameUs = 0;
+        rxDiversityState[i].frameIntervalUs = RX_FRAME_INTERVAL_US;
+        rxDiversityState[i].linkQuality = LINK_QUALITY_MAX_VALUE;
+    }
+}
+
+TEST(RxTest, DiversityStaysOnTheActiveReceiverWhileItIsGood)
+{
+    resetDiversityState();
+
+    uint8_t active = 0;
+    for (timeUs_t timeUs = RX_FRAME_INTERVAL_US; timeUs < 100 * RX_FRAME_INTERVAL_US; timeUs += RX_FRAME_INTERVAL_US) {
+        const uint8_t frameStatus[RX_RECEIVER_COUNT] = { RX_FRAME_COMPLETE, RX_FRAME_COMPLETE };
+        active = rxDiversitySelectReceiver(active, frameStatus, timeUs);
+        EXPECT_EQ(0, active);
+    }
+}
+
+TEST(RxTest, DiversitySwitchesAwayFromAQuietReceiver)
+{
+    resetDiversityState();
+
+    uint8_t active = 0;
+    timeUs_t timeUs = RX_FRAME_INTERVAL_US;
+    const uint8_t bothGood[RX_RECEIVER_COUNT] = { RX_FRAME_COMPLETE, RX_FRAME_COMPLETE };
+    active = rxDiversitySelectReceiver(active, bothGood, timeUs);
+
+    // receiver 0 stops sending, its frames stay pending
+    const uint8_t onlySecond[RX_RECEIVER_COUNT] = { RX_FRAME_PENDING, RX_FRAME_COMPLETE };
+    for (int i = 0; i < 3; i++) {
+        timeUs += RX_FRAME_INTERVAL_US;
+        active = rxDiversitySelectReceiver(active, onlySecond, timeUs);
+        EXPECT_EQ(0, active);
+    }
+    timeUs += RX_FRAME_INTERVAL_US;
+    active = rxDiversitySelectReceiver(active, onlySecond, timeUs);
+    EXPECT_EQ(1, active);
+
+    // and stays on receiver 1 once receiver 0 is back
+    timeUs += RX_FRAME_INTERVAL_US;
+    active = rxDiversitySelectReceiver(active, bothGood, timeUs);
+    EXPECT_EQ(1, active);
+}
+
+TEST(RxTest, DiversitySwitchesToTheBetterLink)
+{
+    resetDiversityState();
+
+    // receiver 0 drops every other frame, but never goes quiet for long
+    uint8_t active = 0;
+    int switchedAfter = 0;
+    for (int i = 1; i < 50 && !switchedAfter; i++) {
+        const uint8_t frameStatus[RX_RECEIVER_COUNT] = { (uint8_t)(RX_FRAME_COMPLETE | (i % 2 ? RX_FRAME_DROPPED : 0)), RX_FRAME_COMPLETE };
+        active = rxDiversitySelectReceiver(active, frameStatus, i * RX_FRAME_INTERVAL_US);
+        if (active) {
+            switchedAfter = i;
+        }
+    }
+    EXPECT_EQ(1, active);
+    EXPECT_GT(switchedAfter, 1);
+
+    // a failsafe frame of the other receiver never causes a switch
+    resetDiversityState();
+    const uint8_t frameStatus[RX_RECEIVER_COUNT] = { RX_FRAME_PENDING, RX_FRAME_COMPLETE | RX_FRAME_FAILSAFE };
+    EXPECT_EQ(0, rxDiversitySelectReceiver(0, frameStatus, 100 * RX_FRAME_INTERVAL_US));
+}
+
 // STUBS
 
 extern "C" {
     void failsafeOnValidDataFailed() {}
     void failsafeOnValidDataReceived() {}
+    uint32_t failsafeRxLinkDownAtMs(void) { return 0; }
 
     void failsafeOnRxSuspend(uint32_t ) {}
     void failsafeOnRxResume(void) {}
@@ -235,23 +312,5 @@ extern "C" {
     void xBusInit(const rxConfig_t *, rxRuntimeConfig_t *) {}
     void rxMspInit(const rxConfig_t *, rxRuntimeConfig_t *) {}
     void rxPwmInit(const rxConfig_t *, rxRuntimeConfig_t *) {}
-    float pt1FilterGain(float f_cut, float dT)
-    {
-        UNUSED(f_cut);
-        UNUSED(dT);
-        return 0.0;
-    }
-
-    void pt1FilterInit(pt1Filter_t *filter, float k)
-    {
-        UNUSED(filter);
-        UNUSED(k);
-    }
-
-    float pt1FilterApply(pt1Filter_t *filter, float input)
-    {
-        UNUSED(filter);
-        UNUSED(input);
-        return 0.0;
-    }
+    serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return NULL; }
 }
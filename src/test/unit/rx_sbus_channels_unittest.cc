@@ -0,0 +1,118 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "pg/rx.h"
+
+    #include "rx/rx.h"
+    #include "rx/sbus_channels.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint16_t channelData[SBUS_MAX_CHANNEL];
+
+static uint8_t decode(const sbusChannels_t *channels)
+{
+    rxRuntimeConfig_t rxRuntimeConfig;
+    memset(&rxRuntimeConfig, 0, sizeof(rxRuntimeConfig));
+    rxRuntimeConfig.channelData = channelData;
+
+    return sbusChannelsDecode(&rxRuntimeConfig, channels);
+}
+
+TEST(SbusChannelsTest, UnpacksTheBitfieldLayout)
+{
+    sbusChannels_t channels;
+    memset(&channels, 0, sizeof(channels));
+    channels.chan0 = 173;
+    channels.chan1 = 1811;
+    channels.chan2 = 0x7FF;
+    channels.chan3 = 0x555;
+    channels.chan4 = 0x2AA;
+    channels.chan5 = 1;
+    channels.chan6 = 0x400;
+    channels.chan7 = 992;
+    channels.chan8 = 0;
+    channels.chan9 = 1234;
+    channels.chan10 = 0x0F0;
+    channels.chan11 = 0x70F;
+    channels.chan12 = 321;
+    channels.chan13 = 1500;
+    channels.chan14 = 2000;
+    channels.chan15 = 0x7FE;
+
+    EXPECT_EQ(RX_FRAME_COMPLETE, decode(&channels));
+
+    const uint16_t expected[16] = {
+        173, 1811, 0x7FF, 0x555, 0x2AA, 1, 0x400, 992, 0, 1234, 0x0F0, 0x70F, 321, 1500, 2000, 0x7FE
+    };
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(expected[i], channelData[i]);
+    }
+    EXPECT_EQ(173, channelData[16]);
+    EXPECT_EQ(173, channelData[17]);
+}
+
+TEST(SbusChannelsTest, UnpacksTheWireFormat)
+{
+    // channel n set to n + 1, packed LSB first as sent by the receiver
+    uint8_t frame[SBUS_CHANNEL_DATA_LENGTH];
+    memset(frame, 0, sizeof(frame));
+    for (int channel = 0; channel < 16; channel++) {
+        for (int bit = 0; bit < 11; bit++) {
+            if ((channel + 1) & (1 << bit)) {
+                const int position = channel * 11 + bit;
+                frame[position / 8] |= 1 << (position % 8);
+            }
+        }
+    }
+    frame[SBUS_CHANNEL_DATA_LENGTH - 1] = (1 << 0) | (1 << 1);
+
+    sbusChannels_t channels;
+    memcpy(&channels, frame, sizeof(channels));
+    EXPECT_EQ(RX_FRAME_COMPLETE, decode(&channels));
+
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(i + 1, channelData[i]);
+    }
+    EXPECT_EQ(1812, channelData[16]);
+    EXPECT_EQ(1812, channelData[17]);
+}
+
+TEST(SbusChannelsTest, ReportsTheFrameFlags)
+{
+    sbusChannels_t channels;
+    memset(&channels, 0, sizeof(channels));
+
+    channels.flags = SBUS_FLAG_SIGNAL_LOSS;
+    EXPECT_EQ(RX_FRAME_COMPLETE | RX_FRAME_DROPPED, decode(&channels));
+
+    channels.flags = SBUS_FLAG_FAILSAFE_ACTIVE | SBUS_FLAG_SIGNAL_LOSS;
+    EXPECT_EQ(RX_FRAME_COMPLETE | RX_FRAME_FAILSAFE, decode(&channels));
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "sensors/sample_bus.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+TEST(SampleBusUnittest, TestReadBeforePublish)
+{
+    attitudeSample_t sample = { .roll = 1, .pitch = 2, .yaw = 3 };
+    timeUs_t timeUs = 42;
+
+    EXPECT_FALSE(sampleRead(SAMPLE_ATTITUDE, &sample, &timeUs));
+
+    // left as they were
+    EXPECT_EQ(1, sample.roll);
+    EXPECT_EQ(2, sample.pitch);
+    EXPECT_EQ(3, sample.yaw);
+    EXPECT_EQ(42, timeUs);
+}
+
+TEST(SampleBusUnittest, TestPublishAndRead)
+{
+    const batterySample_t published = { .voltage = 1680, .amperage = 2550, .mAhDrawn = 340 };
+    samplePublish(SAMPLE_BATTERY, &published, 1000);
+
+    batterySample_t sample;
+    timeUs_t timeUs;
+    EXPECT_TRUE(sampleRead(SAMPLE_BATTERY, &sample, &timeUs));
+    EXPECT_EQ(1680, sample.voltage);
+    EXPECT_EQ(2550, sample.amperage);
+    EXPECT_EQ(340, sample.mAhDrawn);
+    EXPECT_EQ(1000, timeUs);
+
+    // the timestamp is optional
+    EXPECT_TRUE(sampleRead(SAMPLE_BATTERY, &sample, NULL));
+}
+
+TEST(SampleBusUnittest, TestLatestSampleWins)
+{
+    const altitudeSample_t altitudes[] = {
+        { .estimatedAltitudeCm = 100, .varioCms = 3 },
+        { .estimatedAltitudeCm = -250, .varioCms = -40 },
+    };
+    samplePublish(SAMPLE_ALTITUDE, &altitudes[0], 125);
+    samplePublish(SAMPLE_ALTITUDE, &altitudes[1], 250);
+
+    altitudeSample_t sample;
+    timeUs_t timeUs;
+    EXPECT_TRUE(sampleRead(SAMPLE_ALTITUDE, &sample, &timeUs));
+    EXPECT_EQ(-250, sample.estimatedAltitudeCm);
+    EXPECT_EQ(-40, sample.varioCms);
+    EXPECT_EQ(250, timeUs);
+
+    // topics are independent
+    gpsSample_t gpsSample;
+    EXPECT_FALSE(sampleRead(SAMPLE_GPS, &gpsSample, NULL));
+}
@@ -0,0 +1,412 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Runs the real task table of fc/tasks.c through the real scheduler for a few
+// simulated seconds, with every task replaced by a model that only consumes
+// time. Shows how late the gyro task starts and how far the low priority
+// tasks fall behind under each scheduler policy.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "blackbox/blackbox.h"
+    #include "build/debug.h"
+    #include "cli/cli.h"
+    #include "config/feature.h"
+    #include "fc/core.h"
+    #include "fc/rc.h"
+    #include "fc/runtime_config.h"
+    #include "fc/tasks.h"
+    #include "io/serial.h"
+    #include "msp/msp.h"
+    #include "msp/msp_serial.h"
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+    #include "pg/rx.h"
+    #include "rx/rx.h"
+    #include "scheduler/scheduler.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/battery.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define SIM_DURATION_US             2000000
+#define SIM_SCHEDULER_OVERHEAD_US   2       // one pass of scheduler() over the queue
+#define SIM_GYRO_LOOPTIME_US        125     // 8k gyro and PID loop
+#define SIM_LATENESS_BUCKETS        256     // microseconds, the last bucket is open ended
+
+// Execution time of a task. Most runs take typicalUs give or take a quarter,
+// one run in spikeOneIn takes anything up to maxUs. The figures are roughly
+// what the CLI `tasks` command shows on an F405 flying 8k/8k with GPS, baro,
+// mag, blackbox, telemetry and a LED strip, edit them to try other targets.
+// An eventPeriodUs makes the checkFunc of an event driven task signal at
+// that rate, as a CRSF receiver or a mag with its own data rate would.
+typedef struct taskModel_s {
+    cfTaskId_e taskId;
+    uint16_t typicalUs;
+    uint16_t maxUs;
+    uint16_t spikeOneIn;
+    uint32_t eventPeriodUs;
+} taskModel_t;
+
+static const taskModel_t taskModels[] = {
+    { TASK_SYSTEM,          2,      5,      50,     0 },
+    { TASK_MAIN,            2,      10,     50,     0 },
+    { TASK_GYROPID,         62,     85,     20,     0 },
+    { TASK_ACCEL,           8,      16,     50,     0 },
+    { TASK_ATTITUDE,        22,     45,     50,     0 },
+    { TASK_RX,              28,     95,     20,     6667 },    // CRSF at 150Hz
+    { TASK_SERIAL,          4,      350,    100,    0 },       // configurator traffic
+    { TASK_DISPATCH,        1,      3,      50,     0 },
+    { TASK_BATTERY_VOLTAGE, 4,      12,     50,     0 },
+    { TASK_BATTERY_CURRENT, 3,      10,     50,     0 },
+    { TASK_BATTERY_ALERTS,  5,      20,     50,     0 },
+    { TASK_BEEPER,          2,      6,      50,     0 },
+    { TASK_GPS,             10,     160,    20,     0 },       // a burst of UBX
+    { TASK_COMPASS,         45,     180,    20,     13333 },   // I2C at 75Hz
+    { TASK_BARO,            20,     140,    10,     0 },       // I2C
+    { TASK_ALTITUDE,        12,     30,     50,     25000 },
+    { TASK_DASHBOARD,       90,     900,    10,     0 },       // I2C OLED
+    { TASK_BLACKBOX,        35,     160,    20,     0 },
+    { TASK_TELEMETRY,       6,      70,     20,     0 },
+    { TASK_LEDSTRIP,        18,     140,    20,     0 },
+    { TASK_TRANSPONDER,     3,      10,     50,     0 },
+    { TASK_CMS,             5,      45,     50,     0 },
+};
+
+typedef struct schedulerPolicy_s {
+    const char *name;
+    bool optimizeRate;
+    bool deadlineAware;
+} schedulerPolicy_t;
+
+typedef struct taskStats_s {
+    uint32_t runs;
+    timeUs_t lastRunAt;
+    timeUs_t maxGapUs;
+    uint32_t pendingEvents;
+    timeUs_t nextEventAt;
+} taskStats_t;
+
+typedef struct simulationResult_s {
+    uint32_t gyroRuns;
+    uint32_t gyroLateness[SIM_LATENESS_BUCKETS];
+    uint32_t gyroMissed;            // starts at least a whole period late
+    uint32_t gyroMaxLatenessUs;
+    int starvedTasks;               // tasks that fell below a third of their rate
+} simulationResult_t;
+
+static timeUs_t simulatedTime;
+static uint32_t randomState;
+static const taskModel_t *modelForTask[TASK_COUNT];
+static taskStats_t taskStats[TASK_COUNT];
+static simulationResult_t result;
+static uint8_t initialTasks[sizeof(cfTasks)];    // cfTask_t has a const member, so copy it as bytes
+static bool initialTasksSaved;
+
+// xorshift32, every run of a policy sees the same execution times
+static uint32_t simRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static uint32_t simExecutionTime(const taskModel_t *model)
+{
+    if (model->spikeOneIn && simRandom() % model->spikeOneIn == 0) {
+        return model->typicalUs + simRandom() % (model->maxUs - model->typicalUs + 1);
+    }
+    const uint32_t spread = model->typicalUs / 2;
+    return model->typicalUs - spread / 2 + (spread ? simRandom() % (spread + 1) : 0);
+}
+
+static void simRecordGyro(timeUs_t currentTimeUs)
+{
+    const taskStats_t *stats = &taskStats[TASK_GYROPID];
+    if (stats->runs == 0) {
+        return;
+    }
+    const int32_t lateness = cmpTimeUs(currentTimeUs, stats->lastRunAt + SIM_GYRO_LOOPTIME_US);
+    const uint32_t latenessUs = lateness > 0 ? lateness : 0;
+    result.gyroLateness[MIN(latenessUs, (uint32_t)SIM_LATENESS_BUCKETS - 1)]++;
+    result.gyroMaxLatenessUs = MAX(result.gyroMaxLatenessUs, latenessUs);
+    if (latenessUs >= SIM_GYRO_LOOPTIME_US) {
+        result.gyroMissed++;
+    }
+    result.gyroRuns++;
+}
+
+// One taskFunc and checkFunc per task, as the scheduler does not pass the task to them
+template<int taskId>
+static void simTaskFunc(timeUs_t currentTimeUs)
+{
+    taskStats_t *stats = &taskStats[taskId];
+    if (taskId == TASK_GYROPID) {
+        simRecordGyro(currentTimeUs);
+    }
+    if (stats->runs) {
+        stats->maxGapUs = MAX(stats->maxGapUs, currentTimeUs - stats->lastRunAt);
+    }
+    stats->lastRunAt = currentTimeUs;
+    stats->runs++;
+    stats->pendingEvents = 0;
+    simulatedTime += simExecutionTime(modelForTask[taskId]);
+}
+
+template<int taskId>
+static bool simCheckFunc(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentDeltaTimeUs);
+    taskStats_t *stats = &taskStats[taskId];
+    while (cmpTimeUs(currentTimeUs, stats->nextEventAt) >= 0) {
+        stats->pendingEvents++;
+        stats->nextEventAt += modelForTask[taskId]->eventPeriodUs;
+    }
+    return stats->pendingEvents > 0;
+}
+
+template<int taskId>
+static void simInstallTask(void)
+{
+    simInstallTask<taskId - 1>();
+    cfTask_t *task = &cfTasks[taskId];
+    const taskModel_t *model = modelForTask[taskId];
+    if (!model) {
+        return;
+    }
+    task->taskFunc = simTaskFunc<taskId>;
+    if (task->checkFunc) {
+        task->checkFunc = simCheckFunc<taskId>;
+        taskStats[taskId].nextEventAt = simulatedTime + model->eventPeriodUs;
+    }
+}
+
+template<>
+void simInstallTask<-1>(void)
+{
+}
+
+static bool getTaskEnabled(int taskId)
+{
+    cfTaskInfo_t taskInfo;
+    getTaskInfo((cfTaskId_e)taskId, &taskInfo);
+    return taskInfo.isEnabled && modelForTask[taskId];
+}
+
+// Event driven tasks are expected to keep up with their events rather than their fallback period
+static uint32_t simTaskPeriod(int taskId)
+{
+    return modelForTask[taskId]->eventPeriodUs ? modelForTask[taskId]->eventPeriodUs : (uint32_t)cfTasks[taskId].desiredPeriod;
+}
+
+static void simulate(const schedulerPolicy_t *policy)
+{
+    if (!initialTasksSaved) {
+        memcpy(initialTasks, cfTasks, sizeof(cfTasks));
+        initialTasksSaved = true;
+    }
+    memcpy((void *)cfTasks, initialTasks, sizeof(cfTasks));
+    memset(taskStats, 0, sizeof(taskStats));
+    memset(modelForTask, 0, sizeof(modelForTask));
+    memset(&result, 0, sizeof(result));
+    randomState = 0x2545f491;
+    simulatedTime = 10000;
+
+    // Enough configuration for fcTasksInit() to enable every modelled task
+    gyro.targetLooptime = SIM_GYRO_LOOPTIME_US;
+    acc.accSamplingInterval = TASK_PERIOD_HZ(1000);
+    batteryConfigMutable()->voltageMeterSource = VOLTAGE_METER_ADC;
+    batteryConfigMutable()->currentMeterSource = CURRENT_METER_ADC;
+    blackboxConfigMutable()->device = BLACKBOX_DEVICE_SERIAL;
+    rxConfigMutable()->serialrx_provider = SERIALRX_CRSF;
+    serialConfigMutable()->serial_update_rate_hz = 100;
+
+    for (unsigned i = 0; i < ARRAYLEN(taskModels); i++) {
+        modelForTask[taskModels[i].taskId] = &taskModels[i];
+    }
+
+    fcTasksInit();
+    schedulerOptimizeRate(policy->optimizeRate);
+    schedulerSetDeadlineAware(policy->deadlineAware);
+    setTaskEnabled(TASK_DEFERRED_INIT, false);
+    simInstallTask<TASK_COUNT - 1>();
+
+    const timeUs_t startTime = simulatedTime;
+    while (cmpTimeUs(simulatedTime, startTime + SIM_DURATION_US) < 0) {
+        scheduler();
+        simulatedTime += SIM_SCHEDULER_OVERHEAD_US;
+    }
+
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        if (getTaskEnabled(taskId) && taskId != TASK_GYROPID && taskStats[taskId].runs * 3 < SIM_DURATION_US / simTaskPeriod(taskId)) {
+            result.starvedTasks++;
+        }
+    }
+}
+
+static uint32_t gyroLatenessPercentile(int percentile)
+{
+    const uint32_t target = (uint64_t)result.gyroRuns * percentile / 100;
+    uint32_t count = 0;
+    for (int i = 0; i < SIM_LATENESS_BUCKETS; i++) {
+        count += result.gyroLateness[i];
+        if (count >= target) {
+            return i;
+        }
+    }
+    return SIM_LATENESS_BUCKETS - 1;
+}
+
+static void printResult(const schedulerPolicy_t *policy)
+{
+    printf("[ SIM      ] %s: gyro %u Hz, lateness p50 %u us p99 %u us max %u us, %u missed, %d starved\n",
+        policy->name, (unsigned)(result.gyroRuns * 1000000ULL / SIM_DURATION_US),
+        (unsigned)gyroLatenessPercentile(50), (unsigned)gyroLatenessPercentile(99),
+        (unsigned)result.gyroMaxLatenessUs, (unsigned)result.gyroMissed, result.starvedTasks);
+
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        if (!getTaskEnabled(taskId)) {
+            continue;
+        }
+        cfTaskInfo_t taskInfo;
+        getTaskInfo((cfTaskId_e)taskId, &taskInfo);
+        printf("[ SIM      ]     %-16s %-7s %5u Hz of %5u, longest gap %6u us\n",
+            taskInfo.taskName, taskInfo.subTaskName ? taskInfo.subTaskName : "",
+            (unsigned)(taskStats[taskId].runs * 1000000ULL / SIM_DURATION_US),
+            (unsigned)(1000000 / simTaskPeriod(taskId)), (unsigned)taskStats[taskId].maxGapUs);
+    }
+}
+
+class SchedulerSimulation : public ::testing::TestWithParam<schedulerPolicy_t> {};
+
+TEST_P(SchedulerSimulation, GyroLatenessAndStarvation)
+{
+    // given
+    const schedulerPolicy_t policy = GetParam();
+
+    // when
+    simulate(&policy);
+    printResult(&policy);
+
+    // then
+    // every modelled task is enabled, so the simulation covers the whole table
+    for (unsigned i = 0; i < ARRAYLEN(taskModels); i++) {
+        cfTaskInfo_t taskInfo;
+        getTaskInfo(taskModels[i].taskId, &taskInfo);
+        EXPECT_TRUE(taskInfo.isEnabled) << taskInfo.taskName;
+        EXPECT_GT(taskStats[taskModels[i].taskId].runs, 0U) << taskInfo.taskName;
+    }
+
+    // the gyro keeps nearly its full rate, and only the long tasks make it miss a loop
+    EXPECT_GT(result.gyroRuns, (uint32_t)(SIM_DURATION_US / SIM_GYRO_LOOPTIME_US * 8 / 10));
+    EXPECT_LT(result.gyroMissed, result.gyroRuns / 100);
+
+    // the deadline aware scheduler may halve the rate of a long task, but no task falls further behind
+    EXPECT_EQ(0, result.starvedTasks);
+}
+
+static const schedulerPolicy_t policies[] = {
+    { "default",                false,  false },
+    { "optimize rate",          true,   false },
+    { "deadline aware",         false,  true },
+    { "optimize rate, deadline", true,  true },
+};
+
+INSTANTIATE_TEST_CASE_P(Policies, SchedulerSimulation, ::testing::ValuesIn(policies));
+
+// STUBS
+
+extern "C" {
+    uint8_t armingFlags;
+    void setArmingDisabled(armingDisableFlags_e) {}
+    void unsetArmingDisabled(armingDisableFlags_e) {}
+    bool cliMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+    uint8_t debugMode;
+    bool isRXDataNew;
+    uint16_t currentRxRefreshRate;
+    timeUs_t currentRxFrameTimeUs;
+
+    acc_t acc;
+    gyro_t gyro;
+
+    PG_REGISTER(accelerometerConfig_t, accelerometerConfig, PG_ACCELEROMETER_CONFIG, 0);
+    PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+    PG_REGISTER(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 0);
+    PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
+    PG_REGISTER(serialConfig_t, serialConfig, PG_SERIAL_CONFIG, 0);
+
+    timeUs_t micros(void) { return simulatedTime; }
+    uint32_t getCycleCounter(void) { return simulatedTime * 100; }
+    uint32_t clockCyclesToMicros(uint32_t clockCycles) { return clockCycles / 100; }
+
+    bool featureIsEnabled(uint32_t) { return true; }
+    bool sensors(uint32_t) { return true; }
+    bool dispatchIsEnabled(void) { return true; }
+    bool isInitDeferredComplete(void) { return true; }
+    bool usbCableIsInserted(void) { return false; }
+    uint8_t usbVcpIsConnected(void) { return 0; }
+
+    // The task functions and checkFuncs are replaced by the models before the scheduler runs
+    void taskMainPidLoop(timeUs_t) {}
+    void accUpdate(timeUs_t, rollAndPitchTrims_t *) {}
+    void gyroCalibrationStoreUpdate(void) {}
+    uint32_t accUpdateSamplingInterval(void) { return acc.accSamplingInterval; }
+    void imuUpdateAttitude(timeUs_t) {}
+    bool rxUpdateCheck(timeUs_t, timeDelta_t) { return false; }
+    bool processRx(timeUs_t) { return false; }
+    timeDelta_t rxGetFrameDelta(timeDelta_t *) { return 0; }
+    void updateRcCommands(void) {}
+    void updateArmingStatus(void) {}
+    void mspSerialProcess(mspEvaluateNonMspData_e, mspProcessCommandFnPtr, mspProcessReplyFnPtr) {}
+    mspResult_e mspFcProcessCommand(mspPacket_t *, mspPacket_t *, mspPostProcessFnPtr *) { return MSP_RESULT_NO_REPLY; }
+    void mspFcProcessReply(mspPacket_t *) {}
+    void dispatchProcess(uint32_t) {}
+    void batteryUpdateVoltage(timeUs_t) {}
+    void batteryUpdateCurrentMeter(timeUs_t) {}
+    void batteryUpdatePresence(void) {}
+    void batteryUpdateStates(timeUs_t) {}
+    void batteryUpdateAlarms(void) {}
+    void beeperUpdate(timeUs_t) {}
+    void gpsUpdate(timeUs_t) {}
+    bool compassUpdateCheck(timeUs_t, timeDelta_t) { return false; }
+    void compassUpdate(timeUs_t) {}
+    uint32_t baroUpdate(void) { return 0; }
+    bool calculateEstimatedAltitudeCheck(timeUs_t, timeDelta_t) { return false; }
+    void calculateEstimatedAltitude(timeUs_t) {}
+    void dashboardUpdate(timeUs_t) {}
+    void blackboxUpdate(timeUs_t) {}
+    void subTaskTelemetryPollSensors(timeUs_t) {}
+    void telemetryProcess(uint32_t) {}
+    void ledStripUpdate(timeUs_t) {}
+    void transponderUpdate(timeUs_t) {}
+    void cmsHandler(timeUs_t) {}
+    void initDeferredUpdate(timeUs_t) {}
+}
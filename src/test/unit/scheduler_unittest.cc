@@ -16,13 +16,18 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 extern "C" {
     #include "platform.h"
+    #include "fc/runtime_config.h"
     #include "scheduler/scheduler.h"
 }
 
 #include "unittest_macros.h"
+#include "unittest_benchmark.h"
 #include "gtest/gtest.h"
 
 const int TEST_PID_LOOP_TIME = 650;
@@ -38,6 +43,10 @@ const int TEST_DISPATCH_TIME = 1;
 #define TASK_PERIOD_HZ(hz) (1000000 / (hz))
 
 extern "C" {
+    uint8_t armingFlags;
+    void setArmingDisabled(armingDisableFlags_e) {}
+    void unsetArmingDisabled(armingDisableFlags_e) {}
+
     cfTask_t * unittest_scheduler_selectedTask;
     uint8_t unittest_scheduler_selectedTaskDynPrio;
     uint16_t unittest_scheduler_waitingTasks;
@@ -45,6 +54,8 @@ extern "C" {
     // set up micros() to simulate time
     uint32_t simulatedTime = 0;
     uint32_t micros(void) { return simulatedTime; }
+    // simulate a 100MHz cycle counter
+    uint32_t getCycleCounter(void) { return simulatedTime * 100; }
 
     // set up tasks to take a simulated representative time to execute
     void taskMainPidLoop(timeUs_t) { simulatedTime += TEST_PID_LOOP_TIME; }
@@ -393,3 +404,162 @@ TEST(SchedulerUnittest, TestTwoTasks)
     scheduler();
     EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
 }
+
+TEST(SchedulerUnittest, TestDeadlineAwareDefersTask)
+{
+    // disable all tasks except TASK_GYROPID and TASK_ACCEL
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_ACCEL, true);
+    setTaskEnabled(TASK_GYROPID, true);
+    schedulerResetTaskStatistics(TASK_ACCEL);
+    cfTasks[TASK_ACCEL].executionBudget = 300;
+    schedulerSetDeadlineAware(true);
+
+    // TASK_ACCEL is due now, TASK_GYROPID is due in 200us
+    static const uint32_t startTime = 40000;
+    simulatedTime = startTime;
+    cfTasks[TASK_GYROPID].lastExecutedAt = startTime - 800;
+    cfTasks[TASK_ACCEL].lastExecutedAt = startTime - 10000;
+
+    // TASK_ACCEL would overrun TASK_GYROPID, so nothing should run
+    scheduler();
+    EXPECT_EQ(static_cast<cfTask_t*>(0), unittest_scheduler_selectedTask);
+    EXPECT_EQ(1, cfTasks[TASK_ACCEL].deferredCount);
+
+    // TASK_GYROPID runs when it is due
+    simulatedTime += 200;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_GYROPID], unittest_scheduler_selectedTask);
+
+    // there is now 350us until TASK_GYROPID is due again, so TASK_ACCEL fits
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
+    EXPECT_EQ(1, cfTasks[TASK_ACCEL].deferredCount);
+
+    cfTaskInfo_t taskInfo;
+    getTaskInfo(TASK_ACCEL, &taskInfo);
+    EXPECT_EQ(300, taskInfo.executionBudget);
+    EXPECT_EQ(1, taskInfo.deferredCount);
+
+    // without deadline awareness TASK_ACCEL runs as soon as it is due
+    schedulerSetDeadlineAware(false);
+    simulatedTime = startTime + 20000;
+    cfTasks[TASK_GYROPID].lastExecutedAt = simulatedTime - 800;
+    cfTasks[TASK_ACCEL].lastExecutedAt = simulatedTime - 10000;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
+    EXPECT_EQ(1, cfTasks[TASK_ACCEL].deferredCount);
+
+    cfTasks[TASK_ACCEL].executionBudget = 0;
+}
+
+TEST(SchedulerUnittest, TestInterruptDrivenTask)
+{
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_GYROPID, true);
+    schedulerSetTaskInterruptDriven(TASK_GYROPID, true);
+
+    // the task has left the queue but is still reported as enabled
+    EXPECT_FALSE(queueContains(&cfTasks[TASK_GYROPID]));
+    cfTaskInfo_t taskInfo;
+    getTaskInfo(TASK_GYROPID, &taskInfo);
+    EXPECT_TRUE(taskInfo.isEnabled);
+
+    // the scheduler no longer runs it, even when it is overdue
+    cfTasks[TASK_GYROPID].lastExecutedAt = 1000;
+    simulatedTime = 4000;
+    scheduler();
+    EXPECT_EQ(static_cast<cfTask_t*>(0), unittest_scheduler_selectedTask);
+    EXPECT_EQ(1000, cfTasks[TASK_GYROPID].lastExecutedAt);
+
+    // running it from the interrupt keeps its statistics up to date
+    const timeUs_t totalExecutionTime = cfTasks[TASK_GYROPID].totalExecutionTime;
+    schedulerExecuteTask(TASK_GYROPID, simulatedTime);
+    EXPECT_EQ(3000, cfTasks[TASK_GYROPID].taskLatestDeltaTime);
+    EXPECT_EQ(4000, cfTasks[TASK_GYROPID].lastExecutedAt);
+    EXPECT_EQ(totalExecutionTime + TEST_PID_LOOP_TIME, cfTasks[TASK_GYROPID].totalExecutionTime);
+
+    schedulerSetTaskInterruptDriven(TASK_GYROPID, false);
+    EXPECT_TRUE(queueContains(&cfTasks[TASK_GYROPID]));
+}
+
+TEST(SchedulerUnittest, BenchmarkTaskSelection)
+{
+    // measure the cost of a scheduler pass in which no task is due, as the number of queued tasks grows
+    static const int iterations = 100000;
+    static uint8_t savedTasks[sizeof(cfTasks)];
+    memcpy(savedTasks, cfTasks, sizeof(cfTasks));
+
+    simulatedTime = 1000000;
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        cfTasks[taskId].checkFunc = NULL;
+        cfTasks[taskId].desiredPeriod = 1000000;
+        cfTasks[taskId].lastExecutedAt = simulatedTime;
+        cfTasks[taskId].dynamicPriority = 0;
+    }
+
+    queueClear();
+    for (int taskCount = 1; taskCount <= TASK_COUNT; ++taskCount) {
+        queueAdd(&cfTasks[taskCount - 1]);
+        EXPECT_EQ(taskCount, taskQueueSize);
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int ii = 0; ii < iterations; ++ii) {
+            scheduler();
+        }
+        const double nsPerPass = nanosecondsSince(&start) / iterations;
+        EXPECT_EQ(static_cast<cfTask_t*>(0), unittest_scheduler_selectedTask);
+        printf("[ BENCH    ] %2d tasks: %7.1f ns per scheduler pass\n", taskCount, nsPerPass);
+    }
+
+    queueClear();
+    memcpy(cfTasks, savedTasks, sizeof(cfTasks));
+}
+
+TEST(SchedulerUnittest, TestTaskProfiler)
+{
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+        schedulerResetTaskProfile(static_cast<cfTaskId_e>(taskId));
+    }
+    setTaskEnabled(TASK_GYROPID, true);
+
+    // TASK_GYROPID was due at 2000, so it starts 2000us late
+    cfTasks[TASK_GYROPID].lastExecutedAt = 1000;
+    simulatedTime = 4000;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_GYROPID], unittest_scheduler_selectedTask);
+
+    const cfTaskProfile_t *profile = getTaskProfile(TASK_GYROPID);
+    // 650us at 100MHz is 65000 cycles, which falls into [2^15, 2^16)
+    EXPECT_EQ(1, profile->executionCycles[9]);
+    // 2000us falls into [2^10, 2^11)
+    EXPECT_EQ(1, profile->startLateness[11]);
+
+    EXPECT_EQ(9, taskProfilePercentileBucket(profile->executionCycles, 50));
+    EXPECT_EQ(9, taskProfilePercentileBucket(profile->executionCycles, 99));
+    EXPECT_EQ(65536, taskProfileBucketUpperBound(9, TASK_PROFILER_EXECUTION_SHIFT));
+    EXPECT_EQ(2048, taskProfileBucketUpperBound(11, TASK_PROFILER_LATENESS_SHIFT));
+
+    // run on time, 99 more times
+    for (int ii = 0; ii < 99; ++ii) {
+        simulatedTime = cfTasks[TASK_GYROPID].lastExecutedAt + 1000;
+        scheduler();
+    }
+    EXPECT_EQ(100, profile->executionCycles[9]);
+    EXPECT_EQ(99, profile->startLateness[0]);
+    EXPECT_EQ(0, taskProfilePercentileBucket(profile->startLateness, 50));
+    EXPECT_EQ(0, taskProfilePercentileBucket(profile->startLateness, 99));
+    EXPECT_EQ(11, taskProfilePercentileBucket(profile->startLateness, 100));
+
+    schedulerResetTaskProfile(TASK_GYROPID);
+    EXPECT_EQ(0, profile->executionCycles[9]);
+    EXPECT_EQ(0, profile->startLateness[11]);
+}
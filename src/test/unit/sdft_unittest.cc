@@ -0,0 +1,116 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+
+extern "C" {
+    #include "common/maths.h"
+    #include "common/sdft.h"
+    #include "common/utils.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define SDFT_TEST_R 0.9999f // must match SDFT_R
+
+static float testSample(int n, float bin, int sampleCount)
+{
+    return 100.0f * sinf(2.0f * M_PIf * bin * n / sampleCount) + 20.0f;
+}
+
+// the damped sliding DFT is a weighted DFT of the last sampleCount samples
+static void referenceDft(int pushed, int sampleCount, float bin, int k, float *re, float *im)
+{
+    *re = 0;
+    *im = 0;
+    for (int j = 0; j < sampleCount; j++) {
+        const float x = testSample(pushed - 1 - j, bin, sampleCount) * powf(SDFT_TEST_R, j);
+        const float phase = 2.0f * M_PIf * k * (j + 1) / sampleCount;
+        *re += x * cosf(phase);
+        *im += x * sinf(phase);
+    }
+}
+
+TEST(SdftUnittest, TestSdftInit)
+{
+    static sdft_t sdft;
+
+    sdftInit(&sdft, 64, 4, 40);
+    EXPECT_EQ(64, sdft.sampleCount);
+    EXPECT_EQ(4, sdft.startBin);
+    EXPECT_EQ(32, sdft.endBin); // limited to the Nyquist bin
+
+    sdftInit(&sdft, 2 * SDFT_SAMPLE_SIZE_MAX, 0, SDFT_SAMPLE_SIZE_MAX);
+    EXPECT_EQ(SDFT_SAMPLE_SIZE_MAX, sdft.sampleCount);
+    EXPECT_EQ(SDFT_SAMPLE_SIZE_MAX / 2, sdft.endBin);
+}
+
+TEST(SdftUnittest, TestSdftMatchesDft)
+{
+    static sdft_t sdft;
+    const int sampleCounts[] = { 32, 64, 128, 256 };
+
+    for (unsigned i = 0; i < ARRAYLEN(sampleCounts); i++) {
+        const int sampleCount = sampleCounts[i];
+        const float bin = sampleCount / 8 + 0.3f;
+        sdftInit(&sdft, sampleCount, 2, sampleCount / 2);
+
+        const float tolerance = 0.1f * sampleCount; // 0.2% of the peak
+        const int pushed = 3 * sampleCount + 7;
+        for (int n = 0; n < pushed; n++) {
+            sdftPush(&sdft, testSample(n, bin, sampleCount));
+        }
+
+        for (int k = 2; k <= sampleCount / 2; k++) {
+            float re, im;
+            referenceDft(pushed, sampleCount, bin, k, &re, &im);
+            EXPECT_NEAR(re, sdft.re[k], tolerance) << "sampleCount " << sampleCount << " bin " << k;
+            EXPECT_NEAR(im, sdft.im[k], tolerance) << "sampleCount " << sampleCount << " bin " << k;
+        }
+    }
+}
+
+TEST(SdftUnittest, TestSdftWinMagnitudePeak)
+{
+    static sdft_t sdft;
+    static float magnitude[SDFT_BIN_COUNT_MAX];
+    const int sampleCount = 128;
+    const int bin = 23;
+
+    sdftInit(&sdft, sampleCount, 2, sampleCount / 2);
+    for (int n = 0; n < 2 * sampleCount; n++) {
+        sdftPush(&sdft, testSample(n, bin, sampleCount));
+    }
+    sdftWinMagnitude(&sdft, magnitude);
+
+    // a tone centred on a bin spreads into the bins either side of it with the Hann window, and no further
+    int binMax = 3;
+    for (int k = 3; k < sampleCount / 2; k++) {
+        if (magnitude[k] > magnitude[binMax]) {
+            binMax = k;
+        }
+    }
+    EXPECT_EQ(bin, binMax);
+    EXPECT_NEAR(magnitude[bin] / 2, magnitude[bin - 1], magnitude[bin] * 0.02f);
+    EXPECT_NEAR(magnitude[bin] / 2, magnitude[bin + 1], magnitude[bin] * 0.02f);
+    EXPECT_LT(magnitude[bin + 3], magnitude[bin] * 0.02f);
+    EXPECT_LT(magnitude[bin - 3], magnitude[bin] * 0.02f);
+}
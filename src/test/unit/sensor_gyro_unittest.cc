@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include <limits.h>
 #include <algorithm>
@@ -32,6 +33,7 @@ extern "C" {
     #include "drivers/accgyro/accgyro_fake.h"
     #include "drivers/accgyro/accgyro_mpu.h"
     #include "drivers/sensor.h"
+    #include "fc/dispatch.h"
     #include "io/beeper.h"
     #include "pg/pg.h"
     #include "pg/pg_ids.h"
@@ -110,6 +112,87 @@ TEST(SensorGyro, Calibrate)
     EXPECT_EQ(7, gyroDevPtr->gyroZero[Z]);
 }
 
+TEST(SensorGyro, CalibrateFinishesEarlyWhenStill)
+{
+    pgResetAll();
+    gyroInit();
+    const int calibrationCycles = gyroConfig()->gyroCalibrationDuration * 10000 / gyro.targetLooptime;
+    fakeGyroSet(gyroDevPtr, 5, 6, 7);
+    gyroStartCalibration(false);
+    int cycles = 0;
+    while (!isGyroCalibrationComplete()) {
+        gyroDevPtr->readFn(gyroDevPtr);
+        performGyroCalibration(gyroSensorPtr, 32);
+        cycles++;
+    }
+    // a still gyro is accurate at once, so only the minimum quarter of the duration is spent
+    EXPECT_EQ(calibrationCycles / 4, cycles);
+    EXPECT_EQ(5, gyroDevPtr->gyroZero[X]);
+    EXPECT_EQ(6, gyroDevPtr->gyroZero[Y]);
+    EXPECT_EQ(7, gyroDevPtr->gyroZero[Z]);
+}
+
+TEST(SensorGyro, CalibrateNoisyRunsFullDuration)
+{
+    pgResetAll();
+    gyroInit();
+    const int calibrationCycles = gyroConfig()->gyroCalibrationDuration * 10000 / gyro.targetLooptime;
+    gyroStartCalibration(false);
+    int cycles = 0;
+    while (!isGyroCalibrationComplete()) {
+        // noise below the movement threshold, but too much to pin the offset down early
+        const int16_t noise = (cycles & 1) ? 10 : -10;
+        fakeGyroSet(gyroDevPtr, 5 + noise, 6 - noise, 7 + noise);
+        gyroDevPtr->readFn(gyroDevPtr);
+        performGyroCalibration(gyroSensorPtr, 32);
+        cycles++;
+    }
+    EXPECT_EQ(calibrationCycles, cycles);
+    EXPECT_NEAR(5, gyroDevPtr->gyroZero[X], 0.01);
+    EXPECT_NEAR(6, gyroDevPtr->gyroZero[Y], 0.01);
+    EXPECT_NEAR(7, gyroDevPtr->gyroZero[Z], 0.01);
+}
+
+TEST(SensorGyro, CalibrationStoreAndRestore)
+{
+    pgResetAll();
+    gyroInit();
+
+    // nothing stored yet
+    gyroCalibrationConfigMutable()->temperatureTolerance = 5;
+    EXPECT_FALSE(gyroRestoreCalibration());
+
+    fakeGyroSet(gyroDevPtr, 5, 6, 7);
+    gyroStartCalibration(false);
+    while (!isGyroCalibrationComplete()) {
+        gyroDevPtr->readFn(gyroDevPtr);
+        performGyroCalibration(gyroSensorPtr, 32);
+    }
+    // the PID loop only flags the offsets, they are stored from a task
+    EXPECT_EQ(0, gyroCalibrationConfig()->storedSensors);
+    gyroCalibrationStoreUpdate();
+    EXPECT_EQ(1, gyroCalibrationConfig()->storedSensors);
+    EXPECT_EQ(gyroDevPtr->temperature, gyroCalibrationConfig()->temperature[0]);
+    EXPECT_FLOAT_EQ(5, gyroCalibrationConfig()->zero[0][X]);
+    EXPECT_FLOAT_EQ(6, gyroCalibrationConfig()->zero[0][Y]);
+    EXPECT_FLOAT_EQ(7, gyroCalibrationConfig()->zero[0][Z]);
+
+    // a boot at about the same temperature picks the offsets up without calibrating
+    gyroDevPtr->gyroZero[X] = gyroDevPtr->gyroZero[Y] = gyroDevPtr->gyroZero[Z] = 0;
+    EXPECT_TRUE(gyroRestoreCalibration());
+    EXPECT_TRUE(isGyroCalibrationComplete());
+    EXPECT_FLOAT_EQ(5, gyroDevPtr->gyroZero[X]);
+    EXPECT_FLOAT_EQ(6, gyroDevPtr->gyroZero[Y]);
+    EXPECT_FLOAT_EQ(7, gyroDevPtr->gyroZero[Z]);
+
+    // but not when the gyro is at a different temperature, or the store is off
+    gyroCalibrationConfigMutable()->temperature[0] = gyroDevPtr->temperature + 6;
+    EXPECT_FALSE(gyroRestoreCalibration());
+    gyroCalibrationConfigMutable()->temperature[0] = gyroDevPtr->temperature;
+    gyroCalibrationConfigMutable()->temperatureTolerance = 0;
+    EXPECT_FALSE(gyroRestoreCalibration());
+}
+
 TEST(SensorGyro, Update)
 {
     pgResetAll();
@@ -149,6 +232,64 @@ TEST(SensorGyro, Update)
     EXPECT_NEAR(90 * gyroDevPtr->scale, gyro.gyroADCf[Z], 1e-3);
 }
 
+TEST(SensorGyro, YawSpinDetection)
+{
+    pgResetAll();
+    gyroInit();
+    gyroDevPtr->readFn = fakeGyroRead;
+    gyroStartCalibration(false);
+    while (!isGyroCalibrationComplete()) {
+        fakeGyroSet(gyroDevPtr, 0, 0, 0);
+        gyroUpdate(0);
+    }
+
+    // the raw yaw sample is checked against the threshold converted to raw units
+    const int16_t yawSpinRaw = gyroConfig()->yaw_spin_threshold / gyroDevPtr->scale;
+    fakeGyroSet(gyroDevPtr, 0, 0, yawSpinRaw);
+    gyroUpdate(1000);
+    EXPECT_FALSE(gyroYawSpinDetected());
+    fakeGyroSet(gyroDevPtr, 0, 0, -(yawSpinRaw + 1));
+    gyroUpdate(2000);
+    EXPECT_TRUE(gyroYawSpinDetected());
+
+    // a high rate on another axis does not count
+    fakeGyroSet(gyroDevPtr, yawSpinRaw + 1, 0, 0);
+    gyroUpdate(3000);
+    EXPECT_TRUE(gyroYawSpinDetected());
+
+    // released after 20ms below the reset threshold
+    fakeGyroSet(gyroDevPtr, 0, 0, 0);
+    gyroUpdate(21000);
+    EXPECT_TRUE(gyroYawSpinDetected());
+    fakeGyroSet(gyroDevPtr, 0, 0, 0);
+    gyroUpdate(23000);
+    EXPECT_FALSE(gyroYawSpinDetected());
+}
+
+static bool fakeGyroReadFifo(gyroDev_t *gyro)
+{
+    static const int16_t samples[][XYZ_AXIS_COUNT] = { { 10, -20, 100 }, { 20, -40, 101 }, { 30, -60, 103 } };
+
+    memcpy(gyro->fifoADCRaw, samples, sizeof(samples));
+    gyro->fifoSampleCount = ARRAYLEN(samples);
+    return true;
+}
+
+TEST(SensorGyro, FifoDecimate)
+{
+    pgResetAll();
+    gyroInit();
+    gyroDevPtr->readFn = fakeGyroReadFifo;
+    gyroStartCalibration(false);
+
+    // the batch is averaged into a single sample, also while calibrating
+    gyroUpdate(0);
+    EXPECT_EQ(20, gyroDevPtr->gyroADCRaw[X]);
+    EXPECT_EQ(-40, gyroDevPtr->gyroADCRaw[Y]);
+    EXPECT_EQ(101, gyroDevPtr->gyroADCRaw[Z]); // rounded
+    EXPECT_EQ(0, gyroDevPtr->fifoSampleCount);
+}
+
 // STUBS
 
 extern "C" {
@@ -160,4 +301,9 @@ timeDelta_t getGyroUpdateRate(void) {return gyro.targetLooptime;}
 void sensorsSet(uint32_t) {}
 void schedulerResetTaskStatistics(cfTaskId_e) {}
 int getArmingDisableFlags(void) {return 0;}
+uint8_t armingFlags = 0;
+bool isConfigDirty(void) {return false;}
+void writeEEPROM(void) {}
+void dispatchEnable(void) {}
+void dispatchAdd(dispatchEntry_t *, int) {}
 }
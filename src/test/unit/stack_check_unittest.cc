@@ -0,0 +1,151 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "drivers/stack_check.h"
+
+    #include "scheduler/scheduler.h"
+
+    void stackScanInit(const uint32_t *low, const uint32_t *high);
+    uint32_t stackScanSlice(unsigned words);
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+
+    char _estack;
+    char _Min_Stack_Size;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_STACK_WORDS 64
+
+static uint32_t stack[TEST_STACK_WORDS];
+static uint32_t stackPointer;
+static cfTaskId_e currentTaskId = TASK_NONE;
+
+static void paintStack(void)
+{
+    for (int i = 0; i < TEST_STACK_WORDS; i++) {
+        stack[i] = 0xa5a5a5a5;
+    }
+    stackScanInit(stack, stack + TEST_STACK_WORDS);
+}
+
+static void useStack(int words)
+{
+    for (int i = TEST_STACK_WORDS - words; i < TEST_STACK_WORDS; i++) {
+        stack[i] = i;
+    }
+}
+
+static uint32_t scanPass(unsigned words)
+{
+    uint32_t used = 0;
+    for (int i = 0; i < TEST_STACK_WORDS; i++) {
+        used = stackScanSlice(words);
+    }
+    return used;
+}
+
+TEST(StackCheckTest, UnusedStackReportsNothing)
+{
+    paintStack();
+    EXPECT_EQ(0u, scanPass(8));
+}
+
+TEST(StackCheckTest, SliceBoundsTheWork)
+{
+    paintStack();
+    useStack(10);
+
+    // the first 54 words are still painted, so six slices of eight do not reach the used ones
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(0u, stackScanSlice(8));
+    }
+    EXPECT_EQ(10 * sizeof(uint32_t), stackScanSlice(8));
+}
+
+TEST(StackCheckTest, HighWaterMarkOnlyGrows)
+{
+    paintStack();
+    useStack(10);
+    EXPECT_EQ(10 * sizeof(uint32_t), scanPass(16));
+
+    // a deeper call later is found on the next pass
+    useStack(40);
+    EXPECT_EQ(40 * sizeof(uint32_t), scanPass(16));
+
+    // the paint is gone, so shallower use afterwards keeps the mark
+    EXPECT_EQ(40 * sizeof(uint32_t), scanPass(16));
+}
+
+TEST(StackCheckTest, IsrDepthIsAttributedToThePreemptedTask)
+{
+    stackCheckResetIsrStats();
+
+    currentTaskId = (cfTaskId_e)1;
+    stackPointer = (uint32_t)(uintptr_t)&_estack - 300;
+    stackCheckIsrEnter();
+
+    // a nested interrupt counts towards nesting and depth but not the task
+    stackPointer -= 200;
+    stackCheckIsrEnter();
+    stackCheckIsrExit();
+    stackCheckIsrExit();
+
+    currentTaskId = (cfTaskId_e)2;
+    stackPointer = (uint32_t)(uintptr_t)&_estack - 100;
+    stackCheckIsrEnter();
+    stackCheckIsrExit();
+
+    EXPECT_EQ(2, stackCheckGetIsrStats()->maxNesting);
+    EXPECT_EQ(500u, stackCheckGetIsrStats()->maxDepth);
+    EXPECT_EQ(300u, stackCheckGetTaskDepth(1));
+    EXPECT_EQ(100u, stackCheckGetTaskDepth(2));
+    EXPECT_EQ(0u, stackCheckGetTaskDepth(0));
+    EXPECT_EQ(0u, stackCheckGetTaskDepth(TASK_COUNT));
+
+    stackCheckResetIsrStats();
+    EXPECT_EQ(0, stackCheckGetIsrStats()->maxNesting);
+    EXPECT_EQ(0u, stackCheckGetTaskDepth(1));
+}
+
+// STUBS
+
+extern "C" {
+    uint32_t __get_MSP(void)
+    {
+        return stackPointer;
+    }
+
+    cfTaskId_e getCurrentTaskId(void)
+    {
+        return currentTaskId;
+    }
+}
@@ -55,6 +55,8 @@ extern "C" {
     #include "rx/rx.h"
     #include "rx/crsf.h"
 
+    #include "scheduler/scheduler.h"
+
     #include "sensors/battery.h"
     #include "sensors/sensors.h"
 
@@ -90,6 +92,16 @@ extern "C" {
     extern mspPackage_t mspPackage;
     extern uint8_t checksum;
 
+    typedef struct mspWindow_s {
+        bool active;
+        uint8_t chunkCount;
+        uint8_t base;
+        uint8_t next;
+        uint8_t resend;
+        uint16_t streamLength;
+    } mspWindow_t;
+    extern mspWindow_t mspWindow;
+
     uint32_t dummyTimeUs;
 
 }
@@ -247,14 +259,218 @@ TEST(CrossFireMSPTest, SendMspReply) {
     EXPECT_EQ(0x71, sbufReadU8(&payloadOutputBuf)); // CRC
 }
 
+#define TEST_LARGE_REPLY_CMD   0x71
+#define TEST_LARGE_REPLY_SIZE  200
+#define TEST_CHUNK_SIZE        8     // payload size of each reply chunk, small enough to need many chunks
+#define TEST_MAX_CHUNKS        64
+
+static uint8_t testChunk[TEST_CHUNK_SIZE];
+static bool testChunkSent;
+
+static void testCaptureChunk(uint8_t *payload)
+{
+    memcpy(testChunk, payload, TEST_CHUNK_SIZE);
+    testChunkSent = true;
+}
+
+static bool testRequestLargeReply(uint8_t version)
+{
+    static uint8_t seq = 0;
+    uint8_t request[] = { (uint8_t)((version << 5) | 0x10 | (seq++ & 0x0F)), 0, TEST_LARGE_REPLY_CMD, TEST_LARGE_REPLY_CMD };
+    return handleMspFrame(request, sizeof(request), NULL);
+}
+
+static bool testAcknowledge(uint8_t missingChunk, uint8_t receivedAfter)
+{
+    uint8_t ack[] = { (uint8_t)((3 << 5) | (missingChunk & 0x0F)), receivedAfter };
+    return handleMspFrame(ack, sizeof(ack), NULL);
+}
+
+// deterministic loss pattern so that the benchmark gives the same figures on every run
+static uint32_t testLinkState;
+
+static bool testLinkDropsFrame(int lossPercent)
+{
+    testLinkState = testLinkState * 1664525 + 1013904223;
+    return (int)((testLinkState >> 16) % 100) < lossPercent;
+}
+
+// Receives windowed chunks on the host side, keeps track of which arrived and reassembles the reply
+typedef struct testWindowHost_s {
+    bool received[TEST_MAX_CHUNKS];
+    uint8_t stream[TEST_MAX_CHUNKS * TEST_CHUNK_SIZE];
+    int missing;        // oldest chunk not received
+    int chunkCount;     // known once the first chunk has arrived
+    int streamLength;
+} testWindowHost_t;
+
+static void testWindowHostReceive(testWindowHost_t *host)
+{
+    const uint8_t head = testChunk[0];
+    // the chunk number is the 4 bit sequence relative to the oldest missing chunk
+    const int chunk = host->missing + ((head - host->missing) & 0x0F);
+    if (chunk >= TEST_MAX_CHUNKS) {
+        return;
+    }
+    if (head & 0x10) {
+        host->streamLength = testChunk[1] + 1;
+        host->chunkCount = 1 + (host->streamLength - (TEST_CHUNK_SIZE - 2) + TEST_CHUNK_SIZE - 2) / (TEST_CHUNK_SIZE - 1);
+        memcpy(host->stream, &testChunk[2], TEST_CHUNK_SIZE - 2);
+    } else {
+        memcpy(&host->stream[TEST_CHUNK_SIZE - 2 + (chunk - 1) * (TEST_CHUNK_SIZE - 1)], &testChunk[1], TEST_CHUNK_SIZE - 1);
+    }
+    host->received[chunk] = true;
+    while (host->received[host->missing]) {
+        host->missing++;
+    }
+}
+
+static uint8_t testWindowHostReceivedAfter(const testWindowHost_t *host)
+{
+    uint8_t receivedAfter = 0;
+    for (int i = 0; i < 8; i++) {
+        if (host->received[host->missing + 1 + i]) {
+            receivedAfter |= 1 << i;
+        }
+    }
+    return receivedAfter;
+}
+
+static bool testWindowHostDone(const testWindowHost_t *host)
+{
+    return host->chunkCount && host->missing >= host->chunkCount;
+}
+
+static void testCheckLargeReply(const uint8_t *stream, int streamLength)
+{
+    EXPECT_EQ(TEST_LARGE_REPLY_SIZE + 1, streamLength);
+    uint8_t expectedChecksum = TEST_LARGE_REPLY_SIZE ^ TEST_LARGE_REPLY_CMD;
+    for (int i = 0; i < TEST_LARGE_REPLY_SIZE; i++) {
+        EXPECT_EQ((uint8_t)(i * 7), stream[i]);
+        expectedChecksum ^= stream[i];
+    }
+    EXPECT_EQ(expectedChecksum, stream[TEST_LARGE_REPLY_SIZE]);
+}
+
+TEST(CrossFireMSPTest, WindowedReplyLimitsChunksInFlight)
+{
+    initSharedMsp();
+    EXPECT_TRUE(testRequestLargeReply(2));
+
+    // only a window worth of chunks goes out before the host acknowledges
+    int sent = 0;
+    while (sendMspReply(TEST_CHUNK_SIZE, &testCaptureChunk)) {
+        sent++;
+    }
+    sent++;
+    EXPECT_EQ(8, sent);
+    testChunkSent = false;
+    EXPECT_FALSE(sendMspReply(TEST_CHUNK_SIZE, &testCaptureChunk));
+    EXPECT_FALSE(testChunkSent);
+    EXPECT_EQ(8, mspWindow.next);
+
+    // chunk 2 was lost, everything else arrived: only chunk 2 is sent again, then the window moves on
+    EXPECT_TRUE(testAcknowledge(2, 0x1F));
+    testChunkSent = false;
+    sendMspReply(TEST_CHUNK_SIZE, &testCaptureChunk);
+    EXPECT_TRUE(testChunkSent);
+    EXPECT_EQ(2, testChunk[0] & 0x0F);
+    EXPECT_EQ(8, mspWindow.next);
+    sendMspReply(TEST_CHUNK_SIZE, &testCaptureChunk);
+    EXPECT_EQ(8, testChunk[0] & 0x0F);
+    EXPECT_EQ(9, mspWindow.next);
+
+    // an acknowledgement with nothing received past the missing chunk resends all chunks in flight
+    EXPECT_TRUE(testAcknowledge(8, 0));
+    EXPECT_EQ(0x01, mspWindow.resend);
+}
+
+TEST(CrossFireMSPTest, BenchmarkWindowedReplyOverLossyLink)
+{
+    // Transfer a reply of TEST_LARGE_REPLY_SIZE bytes in TEST_CHUNK_SIZE chunks over a link losing a
+    // tenth of the downlink frames, once as single replies that the host requests again on any loss and
+    // once windowed with selective retransmission. One downlink frame is sent per slot, the host
+    // acknowledges every four slots and a new request costs one round trip of two slots.
+    static const int lossPercent = 10;
+    static const int maxSlots = 5000;
+
+    testLinkState = 1;
+    int singleSlots = 0;
+    int singleRequests = 0;
+    bool singleDone = false;
+    while (!singleDone && singleSlots < maxSlots) {
+        initSharedMsp();
+        testRequestLargeReply(1);
+        singleRequests++;
+        singleSlots += 2;
+
+        uint8_t stream[TEST_MAX_CHUNKS * TEST_CHUNK_SIZE];
+        int streamLength = 0;
+        int expectedLength = 0;
+        bool lost = false;
+        bool pending = true;
+        while (pending) {
+            pending = sendMspReply(TEST_CHUNK_SIZE, &testCaptureChunk);
+            singleSlots++;
+            if (testLinkDropsFrame(lossPercent)) {
+                lost = true;
+            } else if (testChunk[0] & 0x10) {
+                expectedLength = testChunk[1] + 1;
+                memcpy(stream, &testChunk[2], TEST_CHUNK_SIZE - 2);
+                streamLength = TEST_CHUNK_SIZE - 2;
+            } else {
+                memcpy(&stream[streamLength], &testChunk[1], TEST_CHUNK_SIZE - 1);
+                streamLength += TEST_CHUNK_SIZE - 1;
+            }
+        }
+        if (!lost) {
+            testCheckLargeReply(stream, expectedLength);
+            singleDone = true;
+        }
+    }
+
+    testLinkState = 1;
+    initSharedMsp();
+    testRequestLargeReply(2);
+    int windowedSlots = 2;
+    testWindowHost_t host;
+    memset(&host, 0, sizeof(host));
+    bool pending = true;
+    while (!testWindowHostDone(&host) && windowedSlots < maxSlots) {
+        if (pending) {
+            testChunkSent = false;
+            pending = sendMspReply(TEST_CHUNK_SIZE, &testCaptureChunk);
+            if (testChunkSent && !testLinkDropsFrame(lossPercent)) {
+                testWindowHostReceive(&host);
+            }
+        }
+        windowedSlots++;
+        if (windowedSlots % 4 == 0) {
+            pending = testAcknowledge(host.missing, testWindowHostReceivedAfter(&host));
+        }
+    }
+    EXPECT_TRUE(testWindowHostDone(&host));
+    testCheckLargeReply(host.stream, host.streamLength);
+    EXPECT_FALSE(testAcknowledge(host.missing, 0));
+    EXPECT_EQ(0, mspWindow.chunkCount);
+
+    printf("[ BENCHMARK] %d byte reply, %d%% loss: single %d slots (%d requests%s), windowed %d slots\n",
+        TEST_LARGE_REPLY_SIZE, lossPercent, singleSlots, singleRequests, singleDone ? "" : ", not completed", windowedSlots);
+
+    EXPECT_LT(windowedSlots, singleSlots);
+}
+
 // STUBS
 
 extern "C" {
 
+    int16_t debug[DEBUG16_VALUE_COUNT];
+    uint8_t debugMode;
     gpsSolutionData_t gpsSol;
     attitudeEulerAngles_t attitude = { { 0, 0, 0 } };
 
     uint32_t micros(void) {return dummyTimeUs;}
+    void schedulerWakeTask(cfTaskId_e) {}
     serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return NULL;}
     serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return NULL;}
     bool isBatteryVoltageConfigured(void) { return true; }
@@ -296,6 +512,10 @@ extern "C" {
             for (unsigned int ii=1; ii<=30; ii++) {
                 sbufWriteU8(dst, ii);
             }
+        } else if (cmdMSP == TEST_LARGE_REPLY_CMD) {
+            for (unsigned int ii = 0; ii < TEST_LARGE_REPLY_SIZE; ii++) {
+                sbufWriteU8(dst, ii * 7);
+            }
         } else if (cmdMSP == 0xCA) {
             return MSP_RESULT_ACK;
         }
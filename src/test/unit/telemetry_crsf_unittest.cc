@@ -57,6 +57,8 @@ extern "C" {
     #include "sensors/sensors.h"
     #include "sensors/acceleration.h"
 
+    #include "scheduler/scheduler.h"
+
     #include "telemetry/crsf.h"
     #include "telemetry/telemetry.h"
     #include "telemetry/msp_shared.h"
@@ -74,6 +76,15 @@ extern "C" {
     PG_REGISTER(systemConfig_t, systemConfig, PG_SYSTEM_CONFIG, 0);
     PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
     PG_REGISTER(accelerometerConfig_t, accelerometerConfig, PG_ACCELEROMETER_CONFIG, 0);
+
+    extern int32_t crsfTelemetryBudget;
+    void initCrsfTelemetrySchedule(void);
+    void processCrsf(void);
+    int crsfTelemetryBytesPerSecondBudget(uint32_t rcFrameIntervalUs);
+
+    uint8_t testFrameTypes[CRSF_TELEMETRY_BUFFER_SIZE];
+    int testFrameCount = 0;
+    int testWriteCount = 0;
 }
 
 #include "unittest_macros.h"
@@ -294,11 +305,85 @@ TEST(TelemetryCrsfTest, TestFlightMode)
     EXPECT_EQ(crfsCrc(frame, frameLen), frame[7]);
 }
 
+static void resetWrittenFrames(void)
+{
+    testFrameCount = 0;
+    testWriteCount = 0;
+}
+
+static int countWrittenFrames(uint8_t frameType)
+{
+    int count = 0;
+    for (int i = 0; i < testFrameCount; i++) {
+        if (testFrameTypes[i] == frameType) {
+            count++;
+        }
+    }
+    return count;
+}
+
+TEST(TelemetryCrsfTest, TestSchedulerBudget)
+{
+    sensorsSet(SENSOR_ACC);
+    initCrsfTelemetrySchedule();
+    resetWrittenFrames();
+
+    // nothing is sent without a budget
+    crsfTelemetryBudget = 0;
+    processCrsf();
+    crsfRxSendTelemetryData();
+    EXPECT_EQ(0, testFrameCount);
+
+    // with enough budget all the frames are packed into one window
+    crsfTelemetryBudget = CRSF_TELEMETRY_BUFFER_SIZE;
+    processCrsf();
+    crsfRxSendTelemetryData();
+    EXPECT_EQ(1, testWriteCount);
+    EXPECT_EQ(1, countWrittenFrames(CRSF_FRAMETYPE_ATTITUDE));
+    EXPECT_EQ(1, countWrittenFrames(CRSF_FRAMETYPE_BATTERY_SENSOR));
+    EXPECT_EQ(1, countWrittenFrames(CRSF_FRAMETYPE_FLIGHT_MODE));
+    EXPECT_EQ(1, countWrittenFrames(CRSF_FRAMETYPE_GPS));
+    EXPECT_GT(crsfTelemetryBudget, 0);
+    EXPECT_LT(crsfTelemetryBudget, CRSF_TELEMETRY_BUFFER_SIZE);
+}
+
+TEST(TelemetryCrsfTest, TestSchedulerPrefersChangingFrames)
+{
+    sensorsSet(SENSOR_ACC);
+    initCrsfTelemetrySchedule();
+    resetWrittenFrames();
+
+    // about one frame per window, the attitude changes every window and the others do not
+    crsfTelemetryBudget = 0;
+    for (int window = 0; window < 400; window++) {
+        attitude.values.roll = window;
+        crsfTelemetryBudget += 12;
+        processCrsf();
+        crsfRxSendTelemetryData();
+    }
+
+    const int attitudeFrames = countWrittenFrames(CRSF_FRAMETYPE_ATTITUDE);
+    const int flightModeFrames = countWrittenFrames(CRSF_FRAMETYPE_FLIGHT_MODE);
+    EXPECT_GT(flightModeFrames, 0);
+    EXPECT_GT(countWrittenFrames(CRSF_FRAMETYPE_BATTERY_SENSOR), 0);
+    EXPECT_GT(countWrittenFrames(CRSF_FRAMETYPE_GPS), 0);
+    EXPECT_GT(attitudeFrames, 2 * flightModeFrames);
+}
+
+TEST(TelemetryCrsfTest, TestSchedulerLinkRate)
+{
+    EXPECT_EQ(120, crsfTelemetryBytesPerSecondBudget(0));  // link rate not known yet
+    EXPECT_EQ(299, crsfTelemetryBytesPerSecondBudget(6667)); // 150Hz
+    EXPECT_EQ(100, crsfTelemetryBytesPerSecondBudget(20000)); // 50Hz
+    EXPECT_EQ(16, crsfTelemetryBytesPerSecondBudget(250000)); // 4Hz
+}
+
 // STUBS
 
 extern "C" {
 
 int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
 
 const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000, 400000}; // see baudRate_e
 
@@ -320,7 +405,13 @@ uint32_t serialRxBytesWaiting(const serialPort_t *) {return 0;}
 uint32_t serialTxBytesFree(const serialPort_t *) {return 0;}
 uint8_t serialRead(serialPort_t *) {return 0;}
 void serialWrite(serialPort_t *, uint8_t) {}
-void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
+void serialWriteBuf(serialPort_t *, const uint8_t *data, int count)
+{
+    testWriteCount++;
+    for (int pos = 0; pos < count && testFrameCount < CRSF_TELEMETRY_BUFFER_SIZE; pos += data[pos + 1] + 2) {
+        testFrameTypes[testFrameCount++] = data[pos + 2];
+    }
+}
 void serialSetMode(serialPort_t *, portMode_e) {}
 serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return NULL;}
 void closeSerialPort(serialPort_t *) {}
@@ -371,6 +462,7 @@ int32_t getMAhDrawn(void){
 bool sendMspReply(uint8_t, mspResponseFnPtr) { return false; }
 bool handleMspFrame(uint8_t *, int, uint8_t *)  { return false; }
 void crsfScheduleMspResponse(void) {};
+void schedulerWakeTask(cfTaskId_e) {}
 bool isBatteryVoltageConfigured(void) { return true; }
 bool isAmperageConfigured(void) { return true; }
 
@@ -144,8 +144,8 @@ static serialPortStub_t serialReadStub;
 #define SERIAL_PORT_DUMMY_IDENTIFIER  (serialPortIdentifier_e)0x1234
 serialPort_t serialTestInstance;
 serialPortConfig_t serialTestInstanceConfig = {
-    .identifier = SERIAL_PORT_DUMMY_IDENTIFIER,
-    .functionMask = 0
+    .functionMask = 0,
+    .identifier = SERIAL_PORT_DUMMY_IDENTIFIER
 };
 
 static serialPortConfig_t *findSerialPortConfig_stub_retval;
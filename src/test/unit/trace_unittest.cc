@@ -0,0 +1,103 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/trace.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint32_t cycleCounter;
+
+static void recordEvents(int count)
+{
+    for (int i = 0; i < count; i++) {
+        cycleCounter += 10;
+        traceRecord(TRACE_GYRO_SAMPLE, 0, i);
+    }
+}
+
+TEST(TraceTest, EventsAreReadOldestFirst)
+{
+    traceRearm();
+    cycleCounter = 0;
+
+    recordEvents(3);
+
+    EXPECT_EQ(TRACE_STATE_RUNNING, traceGetState());
+    EXPECT_EQ(3, traceGetEventCount());
+    EXPECT_EQ(10u, traceGetEvent(0)->cycles);
+    EXPECT_EQ(TRACE_GYRO_SAMPLE, traceGetEvent(0)->type);
+    EXPECT_EQ(2, traceGetEvent(2)->arg);
+    EXPECT_EQ(NULL, traceGetEvent(3));
+
+    // once the buffer wraps the oldest events are overwritten
+    recordEvents(TRACE_BUFFER_EVENTS);
+
+    EXPECT_EQ(TRACE_BUFFER_EVENTS, traceGetEventCount());
+    EXPECT_EQ(0, traceGetEvent(0)->arg);
+    EXPECT_EQ(TRACE_BUFFER_EVENTS - 1, traceGetEvent(TRACE_BUFFER_EVENTS - 1)->arg);
+}
+
+TEST(TraceTest, TriggerFreezesHalfABufferLater)
+{
+    traceRearm();
+    cycleCounter = 0;
+
+    recordEvents(TRACE_BUFFER_EVENTS);
+    traceTrigger(TRACE_TRIGGER_LOOP_OVERRUN, 7);
+    EXPECT_EQ(TRACE_STATE_TRIGGERED, traceGetState());
+
+    // a second trigger while the first is recording is ignored
+    traceTrigger(TRACE_TRIGGER_TASK_BUDGET, 3);
+
+    recordEvents(TRACE_BUFFER_EVENTS / 2 - 1);
+    EXPECT_EQ(TRACE_STATE_FROZEN, traceGetState());
+
+    const uint32_t lastCycles = traceGetEvent(TRACE_BUFFER_EVENTS - 1)->cycles;
+    recordEvents(10);
+    EXPECT_EQ(lastCycles, traceGetEvent(TRACE_BUFFER_EVENTS - 1)->cycles);
+    EXPECT_EQ(0u, traceRecord(TRACE_RX_FRAME, 0, 0));
+
+    // the trigger is in the middle of the frozen buffer
+    const traceEvent_t *trigger = traceGetEvent(TRACE_BUFFER_EVENTS / 2);
+    EXPECT_EQ(TRACE_TRIGGER, trigger->type);
+    EXPECT_EQ(TRACE_TRIGGER_LOOP_OVERRUN, trigger->id);
+    EXPECT_EQ(7, trigger->arg);
+
+    traceRearm();
+    EXPECT_EQ(TRACE_STATE_RUNNING, traceGetState());
+    EXPECT_EQ(0, traceGetEventCount());
+}
+
+// STUBS
+
+extern "C" {
+    uint32_t getCycleCounter(void)
+    {
+        return cycleCounter;
+    }
+}
@@ -0,0 +1,157 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/printf.h"
+    #include "common/typeconversion.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+TEST(TypeConversionTest, TestUnsignedPadded)
+{
+    char buff[16];
+
+    EXPECT_EQ(buff + 1, ui2aPadded(0, 0, ' ', buff));
+    EXPECT_STREQ("0", buff);
+
+    ui2aPadded(7, 3, ' ', buff);
+    EXPECT_STREQ("  7", buff);
+
+    ui2aPadded(7, 3, '0', buff);
+    EXPECT_STREQ("007", buff);
+
+    // the width is a minimum, as with printf
+    ui2aPadded(12345, 3, ' ', buff);
+    EXPECT_STREQ("12345", buff);
+
+    ui2aPadded(4294967295u, 0, ' ', buff);
+    EXPECT_STREQ("4294967295", buff);
+}
+
+TEST(TypeConversionTest, TestSignedPadded)
+{
+    char buff[16];
+
+    i2aPadded(-5, 3, ' ', buff);
+    EXPECT_STREQ(" -5", buff);
+
+    // zero padding is inserted after the sign
+    i2aPadded(-5, 3, '0', buff);
+    EXPECT_STREQ("-05", buff);
+
+    i2aPadded(-2147483647 - 1, 0, ' ', buff);
+    EXPECT_STREQ("-2147483648", buff);
+}
+
+TEST(TypeConversionTest, TestFixedPoint)
+{
+    char buff[16];
+
+    EXPECT_EQ(buff + 5, fixed2a(1234, 2, 0, ' ', buff));
+    EXPECT_STREQ("12.34", buff);
+
+    fixed2a(5, 2, 0, ' ', buff);
+    EXPECT_STREQ("0.05", buff);
+
+    fixed2a(-5, 1, 0, ' ', buff);
+    EXPECT_STREQ("-0.5", buff);
+
+    fixed2a(1234, 2, 7, ' ', buff);
+    EXPECT_STREQ("  12.34", buff);
+
+    fixed2a(-95, 1, 5, '0', buff);
+    EXPECT_STREQ("-09.5", buff);
+
+    fixed2a(-1801234567, 7, 0, ' ', buff);
+    EXPECT_STREQ("-180.1234567", buff);
+
+    // appending to the returned end
+    char *end = fixed2a(42, 1, 0, ' ', buff);
+    *end++ = 'V';
+    *end = '\0';
+    EXPECT_STREQ("4.2V", buff);
+}
+
+TEST(TypeConversionTest, TestMatchesPrintf)
+{
+    char expected[24];
+    char actual[24];
+
+    for (int value = -1200; value <= 1200; value += 7) {
+        tfp_sprintf(expected, "%3d", value);
+        i2aPadded(value, 3, ' ', actual);
+        EXPECT_STREQ(expected, actual);
+
+        if (value >= 0) {
+            tfp_sprintf(expected, "%05d", value);
+            i2aPadded(value, 5, '0', actual);
+            EXPECT_STREQ(expected, actual);
+
+            tfp_sprintf(expected, "%d.%02d", value / 100, value % 100);
+            fixed2a(value, 2, 0, ' ', actual);
+            EXPECT_STREQ(expected, actual);
+
+            tfp_sprintf(expected, "%3d.%01d", value / 10, value % 10);
+            fixed2a(value, 1, 5, ' ', actual);
+            EXPECT_STREQ(expected, actual);
+        }
+    }
+}
+
+// Not a pass/fail test, reports the cost of the formatters used by the OSD against tfp_sprintf
+TEST(TypeConversionTest, BenchmarkAgainstPrintf)
+{
+    const int iterations = 200000;
+    char buff[24];
+    volatile char sink = 0;
+
+    const auto printfStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        tfp_sprintf(buff, "%3d.%02d%c", i / 100, i % 100, 'A');
+        sink = sink + buff[0];
+    }
+    const auto printfEnd = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        char *end = fixed2a(i, 2, 6, ' ', buff);
+        *end++ = 'A';
+        *end = '\0';
+        sink = sink + buff[0];
+    }
+    const auto fixedEnd = std::chrono::steady_clock::now();
+
+    const double printfNs = std::chrono::duration<double, std::nano>(printfEnd - printfStart).count() / iterations;
+    const double fixedNs = std::chrono::duration<double, std::nano>(fixedEnd - printfEnd).count() / iterations;
+    printf("tfp_sprintf %.1fns, fixed2a %.1fns per call\n", printfNs, fixedNs);
+
+    EXPECT_GT(printfNs, 0);
+    EXPECT_GT(fixedNs, 0);
+}
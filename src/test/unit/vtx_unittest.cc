@@ -38,6 +38,7 @@ extern "C" {
     #include "flight/servos.h"
     #include "io/beeper.h"
     #include "io/gps.h"
+    #include "msp/msp.h"
     #include "io/vtx.h"
     #include "rx/rx.h"
     #include "scheduler/scheduler.h"
@@ -134,6 +135,7 @@ extern "C" {
     void gyroStartCalibration(bool) {}
     bool isFirstArmingGyroCalibrationRunning(void) { return false; }
     void pidController(const pidProfile_t *, timeUs_t) {}
+    void imuPropagateAttitude(void) {}
     void pidStabilisationState(pidStabilisationState_e) {}
     void mixTable(timeUs_t , uint8_t) {};
     void writeMotors(void) {};
@@ -154,6 +156,7 @@ extern "C" {
     void mspSerialReleaseSharedTelemetryPorts(void) {}
     void telemetryCheckState(void) {}
     void mspSerialAllocatePorts(void) {}
+    void mspFcSubscriptionTrigger(uint8_t) {}
     void gyroReadTemperature(void) {}
     void updateRcCommands(void) {}
     void applyAltHold(void) {}
@@ -162,6 +165,7 @@ extern "C" {
     void processRcCommand(void) {}
     void updateGpsStateForHomeAndHoldMode(void) {}
     void blackboxUpdate(timeUs_t) {}
+    void blackboxLogIteration(timeUs_t) {}
     void transponderUpdate(timeUs_t) {}
     void GPS_reset_home_position(void) {}
     void accSetCalibrationCycles(uint16_t) {}
@@ -178,4 +182,5 @@ extern "C" {
     void osdSuppressStats(bool) {}
     void pidSetItermReset(bool) {}
     void applyAccelerometerTrimsDelta(rollAndPitchTrims_t*) {}
+    bool isInitDeferredComplete(void) { return true; }
 }
@@ -34,6 +34,8 @@ extern "C" {
     void updateLEDDMABuffer(ledStripFormatRGB_e ledFormat, rgbColor24bpp_t *color, unsigned ledIndex);
 }
 
+static int hsvToRgb24Calls;
+
 TEST(WS2812, updateDMABuffer) {
     // given
     rgbColor24bpp_t color1 = { .raw = {0xFF,0xAA,0x55} };
@@ -75,10 +77,64 @@ TEST(WS2812, updateDMABuffer) {
     byteIndex++;
 }
 
+TEST(WS2812, updateStripConvertsChangedLedsOnly) {
+    // given
+    const hsvColor_t black = { 0, 0, 0 };
+    const hsvColor_t white = { 0, 0, 255 };
+    setUsedLedCount(8);
+    ws2811LedStripEnable();
+    setStripColor(&black);
+
+    // when
+    hsvToRgb24Calls = 0;
+    ws2811LedDataTransferInProgress = false;
+    ws2811UpdateStrip(LED_GRB);
+
+    // then
+    EXPECT_EQ(WS2811_DATA_BUFFER_SIZE, hsvToRgb24Calls);
+
+    // when
+    setLedHsv(3, &white);
+    hsvToRgb24Calls = 0;
+    ws2811LedDataTransferInProgress = false;
+    ws2811UpdateStrip(LED_GRB);
+
+    // then only LED 3 is converted and patched
+    EXPECT_EQ(1, hsvToRgb24Calls);
+    for (int bit = 0; bit < WS2811_BITS_PER_LED; bit++) {
+        EXPECT_EQ(bit >= 8 && bit < 16 ? BIT_COMPARE_1 : BIT_COMPARE_0, ledStripDMABuffer[3 * WS2811_BITS_PER_LED + bit]);
+        EXPECT_EQ(BIT_COMPARE_0, ledStripDMABuffer[2 * WS2811_BITS_PER_LED + bit]);
+    }
+
+    // when nothing changed
+    hsvToRgb24Calls = 0;
+    ws2811LedDataTransferInProgress = false;
+    ws2811UpdateStrip(LED_GRB);
+
+    // then
+    EXPECT_EQ(0, hsvToRgb24Calls);
+
+    // when the colour order changes every LED is rebuilt
+    ws2811LedDataTransferInProgress = false;
+    ws2811UpdateStrip(LED_RGB);
+
+    // then
+    EXPECT_EQ(WS2811_DATA_BUFFER_SIZE, hsvToRgb24Calls);
+    for (int bit = 0; bit < WS2811_BITS_PER_LED; bit++) {
+        EXPECT_EQ(bit < 8 ? BIT_COMPARE_1 : BIT_COMPARE_0, ledStripDMABuffer[3 * WS2811_BITS_PER_LED + bit]);
+    }
+}
+
+
 extern "C" {
 rgbColor24bpp_t* hsvToRgb24(const hsvColor_t *c) {
-    UNUSED(c);
-    return NULL;
+    static rgbColor24bpp_t rgb;
+
+    hsvToRgb24Calls++;
+    rgb.rgb.r = c->v;
+    rgb.rgb.g = c->s;
+    rgb.rgb.b = c->h;
+    return &rgb;
 }
 
 bool ws2811LedStripHardwareInit(ioTag_t ioTag) {
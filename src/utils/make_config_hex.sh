@@ -4,6 +4,12 @@
 #
 # This will only work if the target was built with 'CUSTOM_DEFAULTS_EXTENDED'
 #
+# The input file is the CLI text of the defaults, optionally preceded by the pre-parsed
+# blob printed by 'defaults export' (converted with 'xxd -r -p'), which is applied
+# without replaying the text when it matches the firmware:
+#
+#   cat blob.bin defaults.txt > input_file
+#
 # Usage: make_config_hex <input file> <output directory> <config area start address>
 # Choose the config area start address from:
 #
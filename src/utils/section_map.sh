@@ -0,0 +1,161 @@
+#!/bin/bash
+
+# Report the memory section of every function and variable of a firmware ELF,
+# with the budget of the fast memory sections and placement suggestions
+#
+# Usage: section_map.sh <objdump> <elf file> <output file> [profile]
+#
+# The optional profile weights the symbols with the samples of a profiling run,
+# one symbol per line with its weight first and its name last, e.g. the output of
+#
+#   perf record -F 10000 obj/main/<fork>_SITL.elf
+#   perf report --no-children --sort symbol --stdio
+#
+# or of PC sampling on the target, converted to "<samples> <symbol>" lines.
+#
+# The fast sections are:
+#
+#   .tcm_code                   FAST_CODE, ITCM on F7 and H7
+#   .fastram_data, .fastram_bss FAST_RAM and FAST_RAM_ZERO_INIT, DTCM on F7 and H7, CCM on F405
+#
+# The suggestions list the functions with the most samples per byte outside of
+# .tcm_code, which are the ones to mark FAST_CODE first, and the FAST_CODE
+# functions without any samples, which only take up ITCM.
+
+OBJDUMP=$1
+ELF_FILE=$2
+OUTPUT_FILE=$3
+PROFILE_FILE=$4
+
+if [ -z "${OBJDUMP}" ] || [ ! -f "${ELF_FILE}" ] || [ -z "${OUTPUT_FILE}" ]; then
+    echo "Usage: $0 <objdump> <elf file> <output file> [profile]"
+    exit 1
+fi
+
+if [ -n "${PROFILE_FILE}" ] && [ ! -f "${PROFILE_FILE}" ]; then
+    echo "Profile ${PROFILE_FILE} not found"
+    exit 1
+fi
+
+# objdump -t lines are "<address> <flags> <section>\t<size> <name>"
+${OBJDUMP} -t ${ELF_FILE} | awk -v profile="${PROFILE_FILE}" '
+function hexToDecimal(hex,    value, i) {
+    value = 0;
+    for (i = 1; i <= length(hex); i++) {
+        value = value * 16 + index("0123456789abcdef", tolower(substr(hex, i, 1))) - 1;
+    }
+    return value;
+}
+
+# the compiler suffixes the clones it makes, e.g. ".part.0", ".constprop.0" or ".lto_priv.0"
+function baseName(name) {
+    sub(/\..*$/, "", name);
+    return name;
+}
+
+function memoryOf(section) {
+    if (section == ".tcm_code") {
+        return "ITCM";
+    }
+    if (section ~ /^\.fastram_/) {
+        return "FASTRAM";
+    }
+    if (section ~ /^\.(text|rodata|isr_vector|pg_registry|pg_resetdata)/) {
+        return "FLASH";
+    }
+    if (section ~ /^\.(data|bss|sram2|persistent_data|DMA_RAM|DMA_RW_AXI)/) {
+        return "RAM";
+    }
+    return "OTHER";
+}
+
+BEGIN {
+    if (profile != "") {
+        while ((getline line < profile) > 0) {
+            fieldCount = split(line, fields, " ");
+            if (fieldCount < 2) {
+                continue;
+            }
+            weight = fields[1];
+            sub(/%$/, "", weight);
+            if (weight !~ /^[0-9]+(\.[0-9]+)?$/) {
+                continue;
+            }
+            samples[baseName(fields[fieldCount])] += weight;
+            totalSamples += weight;
+        }
+        close(profile);
+    }
+}
+
+{
+    split($0, parts, "\t");
+    headCount = split(parts[1], head, " ");
+    if (headCount < 3 || (head[headCount - 1] != "F" && head[headCount - 1] != "O")) {
+        next;
+    }
+    section = head[headCount];
+    tailCount = split(parts[2], tail, " ");
+    size = hexToDecimal(tail[1]);
+    name = tail[tailCount];
+    if (size == 0 || name == "") {
+        next;
+    }
+
+    count++;
+    symbolName[count] = name;
+    symbolSize[count] = size;
+    symbolSection[count] = section;
+    symbolMemory[count] = memoryOf(section);
+    symbolIsCode[count] = head[headCount - 1] == "F";
+    symbolSamples[count] = (baseName(name) in samples) ? samples[baseName(name)] : 0;
+
+    sectionSize[section] += size;
+    sectionCount[section]++;
+}
+
+END {
+    printf("# Section budget\n");
+    printf("%-24s %-8s %10s %8s\n", "section", "memory", "bytes", "symbols");
+    fflush();
+    for (section in sectionSize) {
+        printf("%-24s %-8s %10d %8d\n", section, memoryOf(section), sectionSize[section], sectionCount[section]) | "sort -k2,2 -k3,3nr";
+    }
+    close("sort -k2,2 -k3,3nr");
+
+    printf("\n# Symbols, by samples then size\n");
+    printf("%10s %8s %-8s %-24s %s\n", "samples", "bytes", "memory", "section", "name");
+    fflush();
+    for (i = 1; i <= count; i++) {
+        printf("%10.2f %8d %-8s %-24s %s\n", symbolSamples[i], symbolSize[i], symbolMemory[i], symbolSection[i], symbolName[i]) | "sort -k1,1nr -k2,2nr";
+    }
+    close("sort -k1,1nr -k2,2nr");
+
+    if (totalSamples == 0) {
+        printf("\n# No profile given, no placement suggestions\n");
+        exit;
+    }
+
+    printf("\n# Functions to mark FAST_CODE, by samples per byte\n");
+    printf("%10s %8s %s\n", "samples", "bytes", "name");
+    fflush();
+    for (i = 1; i <= count; i++) {
+        if (symbolIsCode[i] && symbolMemory[i] == "FLASH" && symbolSamples[i] > 0) {
+            printf("%.6f %10.2f %8d %s\n", symbolSamples[i] / symbolSize[i], symbolSamples[i], symbolSize[i], symbolName[i]) | "sort -k1,1nr | cut -d\" \" -f2-";
+        }
+    }
+    close("sort -k1,1nr | cut -d\" \" -f2-");
+
+    printf("\n# FAST_CODE functions without samples\n");
+    printf("%8s %s\n", "bytes", "name");
+    fflush();
+    for (i = 1; i <= count; i++) {
+        if (symbolIsCode[i] && symbolMemory[i] == "ITCM" && symbolSamples[i] == 0) {
+            printf("%8d %s\n", symbolSize[i], symbolName[i]) | "sort -k1,1nr";
+        }
+    }
+    close("sort -k1,1nr");
+}
+' > ${OUTPUT_FILE}
+
+echo "Section map written to ${OUTPUT_FILE}"
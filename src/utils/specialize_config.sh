@@ -0,0 +1,194 @@
+#!/bin/bash
+
+# Create the header of a specialized build from the 'diff all' of a configured board
+#
+# The header removes the gyro / acc drivers, serial RX protocols and telemetry
+# stacks the configuration does not use, and names the driver functions of the
+# gyro read, RX frame and motor write paths so that they are called directly
+# instead of through the driver function pointers.
+#
+# Only settings that appear in the diff are used. Drivers selected by autodetection,
+# e.g. the gyro on most boards, are kept unless the gyro is given on the command line
+# with the name used by 'set acc_hardware', or set with 'set acc_hardware' in the diff.
+#
+# Usage: specialize_config.sh <diff file> <output file> [gyro]
+
+DIFF_FILE=$1
+OUTPUT_FILE=$2
+GYRO=$3
+
+if [ ! -f "${DIFF_FILE}" ] || [ -z "${OUTPUT_FILE}" ]; then
+    echo "Usage: $0 <diff file> <output file> [gyro]"
+    exit 1
+fi
+
+tr -d '\r' < ${DIFF_FILE} | awk -v gyro="${GYRO}" -v diffFile="${DIFF_FILE}" '
+function undefineExcept(list, keep,    names, count, i) {
+    count = split(list, names, " ");
+    for (i = 1; i <= count; i++) {
+        if (index(" " keep " ", " " names[i] " ") == 0) {
+            printf("#undef %s\n", names[i]);
+        }
+    }
+}
+
+function bitwiseOr(a, b,    result, bit) {
+    result = 0;
+    for (bit = 1; a > 0 || b > 0; bit *= 2) {
+        if (a % 2 == 1 || b % 2 == 1) {
+            result += bit;
+        }
+        a = int(a / 2);
+        b = int(b / 2);
+    }
+    return result;
+}
+
+function hasFunction(mask) {
+    return int(serialFunctions / mask) % 2 == 1;
+}
+
+$1 == "set" && $3 == "=" {
+    setting[$2] = toupper($4);
+}
+
+$1 == "serial" && $3 ~ /^[0-9]+$/ {
+    serialFunctions = bitwiseOr(serialFunctions, $3);
+}
+
+$1 == "feature" {
+    feature[toupper($2)] = 1;
+}
+
+END {
+    printf("// Generated by specialize_config.sh from %s, do not edit\n\n", diffFile);
+    printf("#pragma once\n");
+
+    if (gyro == "" && setting["acc_hardware"] != "" && setting["acc_hardware"] != "AUTO") {
+        gyro = setting["acc_hardware"];
+    }
+    gyro = toupper(gyro);
+
+    gyroDrivers["MPU6050"] = "USE_GYRO_MPU6050 USE_ACC_MPU6050";
+    gyroDrivers["MPU3050"] = "USE_GYRO_MPU3050";
+    gyroDrivers["L3GD20"] = "USE_GYRO_L3GD20";
+    gyroDrivers["L3G4200D"] = "USE_GYRO_L3G4200D";
+    gyroDrivers["MPU6000"] = "USE_GYRO_SPI_MPU6000 USE_ACC_SPI_MPU6000";
+    gyroDrivers["MPU6500"] = "USE_GYRO_MPU6500 USE_ACC_MPU6500 USE_GYRO_SPI_MPU6500 USE_ACC_SPI_MPU6500";
+    gyroDrivers["ICM20601"] = "USE_GYRO_MPU6500 USE_ACC_MPU6500 USE_GYRO_SPI_MPU6500 USE_ACC_SPI_MPU6500 USE_GYRO_SPI_ICM20601";
+    gyroDrivers["ICM20602"] = gyroDrivers["MPU6500"];
+    gyroDrivers["ICM20608G"] = gyroDrivers["MPU6500"];
+    gyroDrivers["MPU9250"] = "USE_GYRO_SPI_MPU9250 USE_ACC_SPI_MPU9250";
+    gyroDrivers["ICM20649"] = "USE_GYRO_SPI_ICM20649 USE_ACC_SPI_ICM20649";
+    gyroDrivers["ICM20689"] = "USE_GYRO_SPI_ICM20689 USE_ACC_SPI_ICM20689";
+    gyroDrivers["BMI160"] = "USE_ACCGYRO_BMI160";
+
+    gyroReadFn["MPU6050"] = "mpuGyroRead";
+    gyroReadFn["MPU6000"] = "mpuGyroReadSPI";
+    gyroReadFn["MPU6500"] = "mpuGyroReadSPI";
+    gyroReadFn["ICM20601"] = "mpuGyroReadSPI";
+    gyroReadFn["ICM20602"] = "mpuGyroReadSPI";
+    gyroReadFn["ICM20608G"] = "mpuGyroReadSPI";
+    gyroReadFn["MPU9250"] = "mpuGyroReadSPI";
+    gyroReadFn["ICM20649"] = "icm20649GyroReadSPI";
+    gyroReadFn["ICM20689"] = "mpuGyroReadSPI";
+
+    if (gyro in gyroDrivers) {
+        printf("\n// gyro %s\n", gyro);
+        undefineExcept("USE_GYRO_MPU6050 USE_ACC_MPU6050 USE_GYRO_MPU3050 USE_GYRO_L3GD20 USE_GYRO_L3G4200D " \
+            "USE_GYRO_SPI_MPU6000 USE_ACC_SPI_MPU6000 USE_GYRO_MPU6500 USE_ACC_MPU6500 USE_GYRO_SPI_MPU6500 USE_ACC_SPI_MPU6500 " \
+            "USE_GYRO_SPI_ICM20601 USE_GYRO_SPI_MPU9250 USE_ACC_SPI_MPU9250 USE_GYRO_SPI_ICM20649 USE_ACC_SPI_ICM20649 " \
+            "USE_GYRO_SPI_ICM20689 USE_ACC_SPI_ICM20689 USE_ACCGYRO_BMI160 " \
+            "USE_ACC_ADXL345 USE_ACC_BMA280 USE_ACC_LSM303DLHC USE_ACC_MMA8452 USE_FAKE_GYRO USE_FAKE_ACC", gyroDrivers[gyro]);
+        if (gyro in gyroReadFn) {
+            printf("#define SPECIALIZED_GYRO_READ_FN %s\n", gyroReadFn[gyro]);
+        }
+    } else if (gyro != "") {
+        printf("\n// gyro %s is not known, all gyro drivers are kept\n", gyro);
+    }
+
+    provider = setting["serialrx_provider"];
+    rxProtocol["SPEK1024"] = "USE_SERIALRX_SPEKTRUM";
+    rxProtocol["SPEK2048"] = "USE_SERIALRX_SPEKTRUM";
+    rxProtocol["SRXL"] = "USE_SERIALRX_SPEKTRUM";
+    rxProtocol["SBUS"] = "USE_SERIALRX_SBUS";
+    rxProtocol["SUMD"] = "USE_SERIALRX_SUMD";
+    rxProtocol["SUMH"] = "USE_SERIALRX_SUMH";
+    rxProtocol["XB-B"] = "USE_SERIALRX_XBUS";
+    rxProtocol["XB-B-RJ01"] = "USE_SERIALRX_XBUS";
+    rxProtocol["IBUS"] = "USE_SERIALRX_IBUS";
+    rxProtocol["JETIEXBUS"] = "USE_SERIALRX_JETIEXBUS";
+    rxProtocol["CRSF"] = "USE_SERIALRX_CRSF";
+    rxProtocol["CUSTOM"] = "USE_SERIALRX_TARGET";
+    rxProtocol["FPORT"] = "USE_SERIALRX_FPORT";
+    rxProtocol["SRXL2"] = "USE_SERIALRX_SRXL2";
+
+    // telemetry that runs on the RX port of the protocol
+    rxTelemetry["SPEK1024"] = "USE_TELEMETRY_SRXL";
+    rxTelemetry["SPEK2048"] = "USE_TELEMETRY_SRXL";
+    rxTelemetry["SRXL"] = "USE_TELEMETRY_SRXL";
+    rxTelemetry["SRXL2"] = "USE_TELEMETRY_SRXL";
+    rxTelemetry["JETIEXBUS"] = "USE_TELEMETRY_JETIEXBUS";
+    rxTelemetry["CRSF"] = "USE_TELEMETRY_CRSF";
+    rxTelemetry["FPORT"] = "USE_TELEMETRY_SMARTPORT";
+    rxTelemetry["IBUS"] = "USE_TELEMETRY_IBUS";
+
+    rxFrameStatusFn["SBUS"] = "sbusFrameStatus";
+    rxFrameStatusFn["CRSF"] = "crsfFrameStatus";
+    rxReadRawFn["SBUS"] = "sbusChannelsReadRawRC";
+    rxReadRawFn["FPORT"] = "sbusChannelsReadRawRC";
+    rxReadRawFn["CRSF"] = "crsfReadRawRC";
+
+    if ("RX_SPI" in feature || "RX_PPM" in feature || "RX_PARALLEL_PWM" in feature || "RX_MSP" in feature) {
+        printf("\n// no serial RX\n");
+        printf("#undef USE_SERIALRX\n");
+    } else if (provider in rxProtocol) {
+        printf("\n// serial RX %s\n", provider);
+        undefineExcept("USE_SERIALRX_SPEKTRUM USE_SERIALRX_SBUS USE_SERIALRX_SUMD USE_SERIALRX_SUMH USE_SERIALRX_XBUS " \
+            "USE_SERIALRX_IBUS USE_SERIALRX_JETIEXBUS USE_SERIALRX_CRSF USE_SERIALRX_TARGET USE_SERIALRX_FPORT " \
+            "USE_SERIALRX_SRXL2", rxProtocol[provider]);
+        if (provider in rxFrameStatusFn) {
+            printf("#define SPECIALIZED_RX_FRAME_STATUS_FN %s\n", rxFrameStatusFn[provider]);
+        }
+        if (provider in rxReadRawFn) {
+            printf("#define SPECIALIZED_RX_READ_RAW_FN %s\n", rxReadRawFn[provider]);
+        }
+    }
+    if (!("RX_SPI" in feature)) {
+        printf("#undef USE_RX_SPI\n");
+    }
+
+    if ("-TELEMETRY" in feature) {
+        printf("\n// no telemetry\n");
+        printf("#undef USE_TELEMETRY\n");
+    } else if (provider in rxProtocol) {
+        keep = rxTelemetry[provider];
+        keep = keep (hasFunction(4) ? " USE_TELEMETRY_FRSKY_HUB" : "");
+        keep = keep (hasFunction(8) ? " USE_TELEMETRY_HOTT" : "");
+        keep = keep (hasFunction(16) ? " USE_TELEMETRY_LTM" : "");
+        keep = keep (hasFunction(32) ? " USE_TELEMETRY_SMARTPORT" : "");
+        keep = keep (hasFunction(512) ? " USE_TELEMETRY_MAVLINK" : "");
+        keep = keep (hasFunction(4096) ? " USE_TELEMETRY_IBUS" : "");
+        printf("\n// telemetry on the serial ports and the RX port\n");
+        undefineExcept("USE_TELEMETRY_FRSKY_HUB USE_TELEMETRY_HOTT USE_TELEMETRY_LTM USE_TELEMETRY_SMARTPORT " \
+            "USE_TELEMETRY_MAVLINK USE_TELEMETRY_IBUS USE_TELEMETRY_SRXL USE_TELEMETRY_JETIEXBUS USE_TELEMETRY_CRSF", keep);
+    }
+
+    protocol = setting["motor_pwm_protocol"];
+    bitbang = setting["dshot_bitbang"];
+    if (protocol ~ /^(DSHOT|PROSHOT)/) {
+        printf("\n// motor protocol %s, bitbang %s\n", protocol, bitbang == "" ? "AUTO" : bitbang);
+        if (bitbang == "OFF") {
+            printf("#undef USE_DSHOT_BITBANG\n");
+            printf("#define SPECIALIZED_MOTOR_WRITE_FN dshotWrite\n");
+        } else if (bitbang == "ON") {
+            printf("#define SPECIALIZED_MOTOR_WRITE_FN bbWrite\n");
+        }
+    } else if (protocol != "") {
+        printf("\n// motor protocol %s\n", protocol);
+        printf("#define SPECIALIZED_MOTOR_WRITE_FN pwmWriteStandard\n");
+    }
+}
+' > ${OUTPUT_FILE}
+
+echo "Specialized build header written to ${OUTPUT_FILE}"
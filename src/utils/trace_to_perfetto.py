@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+
+# Download the event trace of a flight controller built with USE_TRACE and
+# write it as a Chrome trace file, which chrome://tracing and
+# https://ui.perfetto.dev open
+#
+# Usage: trace_to_perfetto.py [--freeze] [--rearm] [--tasks <file>] <serial port> <output.json>
+#
+#   --freeze    freeze the trace now instead of waiting for an overrun trigger
+#   --rearm     restart recording once the trace is downloaded
+#   --tasks     output of the CLI `tasks` command, to name the tasks by their id
+#
+# The trace is read with MSP_TRACE, 30 events per request. Events are
+# timestamped with the cycle counter, converted to microseconds with the
+# core clock the flight controller reports.
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+import serial
+
+MSP_TRACE = 143
+
+MSP_TRACE_READ = 0
+MSP_TRACE_FREEZE = 1
+MSP_TRACE_REARM = 2
+
+TRACE_TASK_START = 0
+TRACE_TASK_END = 1
+TRACE_ISR_ENTER = 2
+TRACE_ISR_EXIT = 3
+TRACE_DMA_COMPLETE = 4
+TRACE_RX_FRAME = 5
+TRACE_GYRO_SAMPLE = 6
+TRACE_TRIGGER = 7
+
+STATES = ["running", "triggered", "frozen"]
+TRIGGERS = ["manual", "loop overrun", "task budget"]
+
+# irqLoadSource_e
+ISR_NAMES = ["EXTI", "DMA", "DSHOT_BB", "MAX7456", "UART", "TIMER", "PID_LOOP"]
+
+# Chrome trace threads, one per kind of activity
+TID_TASKS = 1
+TID_ISR = 2
+TID_EVENTS = 3
+
+
+def msp_request(port, command, payload):
+    frame = struct.pack("<BB", len(payload), command) + payload
+    checksum = 0
+    for byte in frame:
+        checksum ^= byte
+    port.write(b"$M<" + frame + bytes([checksum]))
+
+    header = port.read(5)
+    if len(header) < 5 or header[:2] != b"$M":
+        raise IOError("no MSP reply")
+    if header[2:3] == b"!":
+        raise IOError("MSP_TRACE not supported, build with USE_TRACE")
+    size = header[3]
+    data = port.read(size + 1)
+    if len(data) < size + 1 or header[4] != command:
+        raise IOError("short or unexpected MSP reply")
+    return data[:size]
+
+
+def read_chunk(port, offset, action):
+    reply = msp_request(port, MSP_TRACE, struct.pack("<HB", offset, action))
+    clock, state, count, offset, chunk = struct.unpack_from("<IBHHB", reply)
+    events = [struct.unpack_from("<IBBH", reply, 10 + 8 * i) for i in range(chunk)]
+    return clock, state, count, events
+
+
+def read_task_names(filename):
+    names = {}
+    with open(filename) as f:
+        for line in f:
+            match = re.match(r"\s*(\d+) - \(\s*([^)]+)\)", line)
+            if match:
+                names[int(match.group(1))] = match.group(2).strip()
+    return names
+
+
+def to_chrome_trace(events, clock, task_names):
+    trace = []
+    cycles_per_us = clock / 1e6
+    last_cycles = None
+    unwrapped = 0
+
+    for cycles, kind, ident, arg in events:
+        # the cycle counter wraps every few seconds, the trace covers a few milliseconds
+        if last_cycles is not None:
+            unwrapped += (cycles - last_cycles) & 0xffffffff
+        last_cycles = cycles
+        ts = unwrapped / cycles_per_us
+
+        if kind in (TRACE_TASK_START, TRACE_TASK_END):
+            name = task_names.get(ident, "task %d" % ident)
+            phase = "B" if kind == TRACE_TASK_START else "E"
+            trace.append({"name": name, "ph": phase, "ts": ts, "pid": 1, "tid": TID_TASKS})
+        elif kind in (TRACE_ISR_ENTER, TRACE_ISR_EXIT):
+            name = ISR_NAMES[ident] if ident < len(ISR_NAMES) else "irq %d" % ident
+            phase = "B" if kind == TRACE_ISR_ENTER else "E"
+            trace.append({"name": name, "ph": phase, "ts": ts, "pid": 1, "tid": TID_ISR})
+        elif kind == TRACE_DMA_COMPLETE:
+            trace.append({"name": "DMA %d" % ident, "ph": "i", "s": "t", "ts": ts, "pid": 1, "tid": TID_EVENTS})
+        elif kind == TRACE_RX_FRAME:
+            trace.append({"name": "RX frame", "ph": "i", "s": "t", "ts": ts, "pid": 1, "tid": TID_EVENTS})
+        elif kind == TRACE_GYRO_SAMPLE:
+            trace.append({"name": "gyro", "ph": "i", "s": "t", "ts": ts, "pid": 1, "tid": TID_EVENTS})
+        elif kind == TRACE_TRIGGER:
+            reason = TRIGGERS[ident] if ident < len(TRIGGERS) else "trigger %d" % ident
+            trace.append({"name": "TRIGGER " + reason, "ph": "i", "s": "g", "ts": ts, "pid": 1, "tid": TID_EVENTS,
+                          "args": {"task": task_names.get(arg, arg)}})
+
+    for tid, name in ((TID_TASKS, "tasks"), (TID_ISR, "interrupts"), (TID_EVENTS, "events")):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}})
+
+    return {"traceEvents": trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Download the USE_TRACE event trace as a Chrome trace file")
+    parser.add_argument("--freeze", action="store_true", help="freeze the trace now")
+    parser.add_argument("--rearm", action="store_true", help="restart recording after the download")
+    parser.add_argument("--tasks", help="output of the CLI tasks command, to name the tasks")
+    parser.add_argument("port")
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    task_names = read_task_names(args.tasks) if args.tasks else {}
+
+    with serial.Serial(args.port, 115200, timeout=1) as port:
+        clock, state, count, events = read_chunk(port, 0, MSP_TRACE_FREEZE if args.freeze else MSP_TRACE_READ)
+        # a trigger keeps recording for half a buffer, which takes milliseconds
+        while STATES[state] == "triggered":
+            clock, state, count, events = read_chunk(port, 0, MSP_TRACE_READ)
+        if STATES[state] != "frozen":
+            print("trace is %s, the events still change while they are read" % STATES[state], file=sys.stderr)
+        while len(events) < count:
+            _, _, _, chunk = read_chunk(port, len(events), MSP_TRACE_READ)
+            if not chunk:
+                break
+            events += chunk
+        if args.rearm:
+            read_chunk(port, 0, MSP_TRACE_REARM)
+
+    with open(args.output, "w") as f:
+        json.dump(to_chrome_trace(events, clock, task_names), f)
+
+    print("%d events written to %s" % (len(events), args.output))
+
+
+if __name__ == "__main__":
+    main()